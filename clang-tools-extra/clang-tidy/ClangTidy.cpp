@@ -45,6 +45,8 @@
 #include "llvm/Support/Process.h"
 #include "llvm/Support/Signals.h"
 #include <algorithm>
+#include <mutex>
+#include <thread>
 #include <utility>
 
 #if CLANG_TIDY_ENABLE_STATIC_ANALYZER
@@ -394,6 +396,16 @@ ClangTidyASTConsumerFactory::CreateASTConsumer(
   std::vector<std::unique_ptr<ClangTidyCheck>> Checks =
       CheckFactories->createChecks(&Context);
 
+  // Keep every Count-th check, so that the subsets are balanced.
+  unsigned PartitionIndex = Context.getCheckPartitionIndex();
+  unsigned PartitionCount = Context.getCheckPartitionCount();
+  if (PartitionCount > 1) {
+    std::vector<std::unique_ptr<ClangTidyCheck>> AllChecks;
+    AllChecks.swap(Checks);
+    for (unsigned I = PartitionIndex; I < AllChecks.size(); I += PartitionCount)
+      Checks.push_back(std::move(AllChecks[I]));
+  }
+
   ast_matchers::MatchFinder::MatchFinderOptions FinderOptions;
 
   std::unique_ptr<ClangTidyProfiling> Profiling;
@@ -429,8 +441,9 @@ ClangTidyASTConsumerFactory::CreateASTConsumer(
 
 #if CLANG_TIDY_ENABLE_STATIC_ANALYZER
   AnalyzerOptionsRef AnalyzerOptions = Compiler.getAnalyzerOpts();
-  AnalyzerOptions->CheckersAndPackages = getAnalyzerCheckersAndPackages(
-      Context, Context.canEnableAnalyzerAlphaCheckers());
+  if (PartitionIndex == 0)
+    AnalyzerOptions->CheckersAndPackages = getAnalyzerCheckersAndPackages(
+        Context, Context.canEnableAnalyzerAlphaCheckers());
   if (!AnalyzerOptions->CheckersAndPackages.empty()) {
     setStaticAnalyzerCheckerOpts(Context.getOptions(), AnalyzerOptions);
     AnalyzerOptions->AnalysisStoreOpt = RegionStoreModel;
@@ -497,12 +510,40 @@ getCheckOptions(const ClangTidyOptions &Options,
   return Factory.getCheckOptions();
 }
 
+namespace {
+/// Forwards to the options of a context that the contexts running subsets of
+/// the checks of a translation unit in parallel share.
+class SharedOptionsProvider : public ClangTidyOptionsProvider {
+public:
+  SharedOptionsProvider(ClangTidyContext &Context, std::mutex &Mutex)
+      : Context(Context), Mutex(Mutex) {}
+
+  const ClangTidyGlobalOptions &getGlobalOptions() override {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    return Context.getGlobalOptions();
+  }
+
+  std::vector<OptionsSource> getRawOptions(StringRef FileName) override {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    std::vector<OptionsSource> Result;
+    Result.emplace_back(Context.getOptionsForFile(FileName),
+                        "shared clang-tidy options");
+    return Result;
+  }
+
+private:
+  ClangTidyContext &Context;
+  std::mutex &Mutex;
+};
+} // namespace
+
 std::vector<ClangTidyError>
 runClangTidy(clang::tidy::ClangTidyContext &Context,
              const CompilationDatabase &Compilations,
              ArrayRef<std::string> InputFiles,
              llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> BaseFS,
-             bool EnableCheckProfile, llvm::StringRef StoreCheckProfile) {
+             bool EnableCheckProfile, llvm::StringRef StoreCheckProfile,
+             unsigned ParallelChecks) {
   ClangTool Tool(Compilations, InputFiles,
                  std::make_shared<PCHContainerOperations>(), BaseFS);
 
@@ -550,8 +591,38 @@ runClangTidy(clang::tidy::ClangTidyContext &Context,
                        DiagnosticConsumer *DiagConsumer) override {
       // Explicitly ask to define __clang_analyzer__ macro.
       Invocation->getPreprocessorOpts().SetUpStaticAnalyzer = true;
-      return FrontendActionFactory::runInvocation(
-          Invocation, Files, PCHContainerOps, DiagConsumer);
+      // The module headers are expanded into the shared file system, so run
+      // the checks of modular code on a single thread.
+      if (Partitions.empty() || Invocation->getLangOpts()->Modules)
+        return FrontendActionFactory::runInvocation(
+            Invocation, Files, PCHContainerOps, DiagConsumer);
+
+      // The matchers and the checks modify the AST context, e.g. its parent
+      // map, so each subset of the checks runs on its own parse of the
+      // translation unit.
+      std::vector<char> Results(Partitions.size());
+      auto RunPartition = [&](size_t I) {
+        IntrusiveRefCntPtr<FileManager> PartitionFiles(new FileManager(
+            Files->getFileSystemOpts(), &Files->getVirtualFileSystem()));
+        Results[I] = Partitions[I].first->runInvocation(
+            std::make_shared<CompilerInvocation>(*Invocation),
+            PartitionFiles.get(), PCHContainerOps, Partitions[I].second);
+      };
+      std::vector<std::thread> Threads;
+      for (size_t I = 1; I < Partitions.size(); ++I)
+        Threads.emplace_back(RunPartition, I);
+      RunPartition(0);
+      for (std::thread &T : Threads)
+        T.join();
+      return llvm::all_of(Results, [](char Result) { return Result; });
+    }
+
+    /// Runs the checks with the factories of \p Partitions, each with its own
+    /// diagnostic consumer, instead of the factory of this context.
+    void setPartitions(
+        std::vector<std::pair<ActionFactory *, DiagnosticConsumer *>>
+            Partitions) {
+      this->Partitions = std::move(Partitions);
     }
 
   private:
@@ -568,10 +639,54 @@ runClangTidy(clang::tidy::ClangTidyContext &Context,
     };
 
     ClangTidyASTConsumerFactory ConsumerFactory;
+    std::vector<std::pair<ActionFactory *, DiagnosticConsumer *>> Partitions;
+  };
+
+  /// A context that runs a subset of the checks.
+  struct CheckPartition {
+    CheckPartition(ClangTidyContext &Parent, std::mutex &OptionsMutex,
+                   unsigned Index, unsigned Count,
+                   IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> BaseFS)
+        : Context(std::make_unique<SharedOptionsProvider>(Parent, OptionsMutex),
+                  Parent.canEnableAnalyzerAlphaCheckers()),
+          DiagConsumer(Context, /*ExternalDiagEngine=*/nullptr,
+                       /*RemoveIncompatibleErrors=*/false),
+          DE(new DiagnosticIDs(), new DiagnosticOptions(), &DiagConsumer,
+             /*ShouldOwnClient=*/false),
+          Factory(Context, BaseFS) {
+      Context.setDiagnosticsEngine(&DE);
+      Context.setCheckPartition(Index, Count);
+    }
+
+    ClangTidyContext Context;
+    ClangTidyDiagnosticConsumer DiagConsumer;
+    DiagnosticsEngine DE;
+    ActionFactory Factory;
   };
 
   ActionFactory Factory(Context, BaseFS);
+  std::mutex OptionsMutex;
+  std::vector<std::unique_ptr<CheckPartition>> Partitions;
+  // The profiles of the subsets would be reported separately, so profile the
+  // checks on a single thread.
+  if (ParallelChecks > 1 && !EnableCheckProfile) {
+    std::vector<std::pair<ActionFactory *, DiagnosticConsumer *>> Factories;
+    for (unsigned I = 0; I < ParallelChecks; ++I) {
+      Partitions.push_back(std::make_unique<CheckPartition>(
+          Context, OptionsMutex, I, ParallelChecks, BaseFS));
+      Factories.emplace_back(&Partitions.back()->Factory,
+                             &Partitions.back()->DiagConsumer);
+    }
+    Factory.setPartitions(std::move(Factories));
+  }
   Tool.run(&Factory);
+
+  // The errors are sorted by take(), so they don't depend on the order the
+  // subsets of the checks finished in.
+  for (const auto &Partition : Partitions) {
+    Context.addStats(Partition->Context.getStats());
+    DiagConsumer.addErrors(Partition->DiagConsumer.take());
+  }
   return DiagConsumer.take();
 }
 
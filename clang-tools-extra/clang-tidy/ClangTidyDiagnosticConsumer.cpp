@@ -224,6 +224,14 @@ ClangTidyOptions ClangTidyContext::getOptionsForFile(StringRef File) const {
       OptionsProvider->getOptions(File), 0);
 }
 
+void ClangTidyContext::addStats(const ClangTidyStats &Other) {
+  Stats.ErrorsDisplayed += Other.ErrorsDisplayed;
+  Stats.ErrorsIgnoredCheckFilter += Other.ErrorsIgnoredCheckFilter;
+  Stats.ErrorsIgnoredNOLINT += Other.ErrorsIgnoredNOLINT;
+  Stats.ErrorsIgnoredNonUserCode += Other.ErrorsIgnoredNonUserCode;
+  Stats.ErrorsIgnoredLineFilter += Other.ErrorsIgnoredLineFilter;
+}
+
 void ClangTidyContext::setEnableProfiling(bool P) { Profile = P; }
 
 void ClangTidyContext::setProfileStoragePrefix(StringRef Prefix) {
@@ -384,6 +392,15 @@ void ClangTidyDiagnosticConsumer::HandleDiagnostic(
   if (LastErrorWasIgnored && DiagLevel == DiagnosticsEngine::Note)
     return;
 
+  // The context running the first subset of the checks reports the compiler
+  // diagnostics of the translation unit.
+  if (Context.getCheckPartitionIndex() != 0 &&
+      DiagLevel != DiagnosticsEngine::Note &&
+      !Context.CheckNamesByDiagnosticID.count(Info.getID())) {
+    LastErrorWasIgnored = true;
+    return;
+  }
+
   if (shouldSuppressDiagnostic(DiagLevel, Info, Context)) {
     ++Context.Stats.ErrorsIgnoredNOLINT;
     // Ignored a warning, should ignore related notes as well
@@ -744,8 +761,18 @@ struct EqualClangTidyError {
 };
 } // end anonymous namespace
 
+void ClangTidyDiagnosticConsumer::addErrors(
+    std::vector<ClangTidyError> NewErrors) {
+  AddedErrors.insert(AddedErrors.end(),
+                     std::make_move_iterator(NewErrors.begin()),
+                     std::make_move_iterator(NewErrors.end()));
+}
+
 std::vector<ClangTidyError> ClangTidyDiagnosticConsumer::take() {
   finalizeLastError();
+  Errors.insert(Errors.end(), std::make_move_iterator(AddedErrors.begin()),
+                std::make_move_iterator(AddedErrors.end()));
+  AddedErrors.clear();
 
   llvm::stable_sort(Errors, LessClangTidyError());
   Errors.erase(std::unique(Errors.begin(), Errors.end(), EqualClangTidyError()),
@@ -150,6 +150,10 @@ public:
   /// counters.
   const ClangTidyStats &getStats() const { return Stats; }
 
+  /// Adds the counters of another context, e.g. one that ran another subset
+  /// of the checks on the same translation units.
+  void addStats(const ClangTidyStats &Other);
+
   /// Control profile collection in clang-tidy.
   void setEnableProfiling(bool Profile);
   bool getEnableProfiling() const { return Profile; }
@@ -159,6 +163,18 @@ public:
   llvm::Optional<ClangTidyProfiling::StorageParams>
   getProfileStorageParams() const;
 
+  /// Restricts the checks created for each translation unit to the subset
+  /// \p Index of \p Count subsets, so that several contexts can run the checks
+  /// of a translation unit in parallel. Only the subset 0 reports the
+  /// compiler diagnostics and runs the static analyzer.
+  void setCheckPartition(unsigned Index, unsigned Count) {
+    assert(Index < Count && "Invalid check partition");
+    CheckPartitionIndex = Index;
+    CheckPartitionCount = Count;
+  }
+  unsigned getCheckPartitionIndex() const { return CheckPartitionIndex; }
+  unsigned getCheckPartitionCount() const { return CheckPartitionCount; }
+
   /// Should be called when starting to process new translation unit.
   void setCurrentBuildDirectory(StringRef BuildDirectory) {
     CurrentBuildDirectory = std::string(BuildDirectory);
@@ -209,6 +225,9 @@ private:
   bool Profile;
   std::string ProfilePrefix;
 
+  unsigned CheckPartitionIndex = 0;
+  unsigned CheckPartitionCount = 1;
+
   bool AllowEnablingAnalyzerAlphaCheckers;
 };
 
@@ -246,6 +265,11 @@ public:
   // Retrieve the diagnostics that were captured.
   std::vector<ClangTidyError> take();
 
+  /// Adds the errors captured by another consumer, e.g. one that ran another
+  /// subset of the checks on the same translation units. \c take() sorts and
+  /// deduplicates them along with the errors of this consumer.
+  void addErrors(std::vector<ClangTidyError> NewErrors);
+
 private:
   void finalizeLastError();
   void removeIncompatibleErrors();
@@ -266,6 +290,7 @@ private:
   DiagnosticsEngine *ExternalDiagEngine;
   bool RemoveIncompatibleErrors;
   std::vector<ClangTidyError> Errors;
+  std::vector<ClangTidyError> AddedErrors;
   std::unique_ptr<llvm::Regex> HeaderFilter;
   bool LastErrorRelatesToUserCode;
   bool LastErrorPassesLineFilter;
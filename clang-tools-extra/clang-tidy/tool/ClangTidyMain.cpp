@@ -206,6 +206,16 @@ these per-TU profiles are instead stored as JSON.
                                               cl::value_desc("prefix"),
                                               cl::cat(ClangTidyCategory));
 
+static cl::opt<unsigned> ParallelChecks("parallel-checks", cl::desc(R"(
+Split the checks into the given number of
+subsets, and run them in parallel for each file.
+Each subset parses the file on its own, so this
+speeds up files where the checks take most of
+the time, at the cost of memory.
+)"),
+                                        cl::init(1),
+                                        cl::cat(ClangTidyCategory));
+
 /// This option allows enabling the experimental alpha checkers from the static
 /// analyzer. This option is set to false and not visible in help, because it is
 /// highly not recommended for users.
@@ -483,7 +493,7 @@ int clangTidyMain(int argc, const char **argv) {
                            AllowEnablingAnalyzerAlphaCheckers);
   std::vector<ClangTidyError> Errors =
       runClangTidy(Context, OptionsParser->getCompilations(), PathList, BaseFS,
-                   EnableCheckProfile, ProfilePrefix);
+                   EnableCheckProfile, ProfilePrefix, ParallelChecks);
   bool FoundErrors = llvm::find_if(Errors, [](const ClangTidyError &E) {
                        return E.DiagLevel == ClangTidyError::Error;
                      }) != Errors.end();
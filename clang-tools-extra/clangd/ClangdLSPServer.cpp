@@ -178,6 +178,7 @@ public:
     } else if (auto Handler = Notifications.lookup(Method)) {
       Handler(std::move(Params));
       Server.maybeExportMemoryProfile();
+      Server.maybeCleanupMemory();
     } else {
       log("unhandled notification {0}", Method);
     }
@@ -1295,6 +1296,18 @@ void ClangdLSPServer::maybeExportMemoryProfile() {
   NextProfileTime = Now + ProfileInterval;
 }
 
+void ClangdLSPServer::maybeCleanupMemory() {
+  // Memory cleanup is probably expensive, throttle it.
+  static constexpr auto MemoryCleanupInterval = std::chrono::minutes(1);
+  if (!Opts.MemoryCleanup)
+    return;
+  auto Now = std::chrono::steady_clock::now();
+  if (Now < NextMemoryCleanupTime)
+    return;
+  Opts.MemoryCleanup();
+  NextMemoryCleanupTime = Now + MemoryCleanupInterval;
+}
+
 // FIXME: This function needs to be properly tested.
 void ClangdLSPServer::onChangeConfiguration(
     const DidChangeConfigurationParams &Params) {
@@ -1503,6 +1516,7 @@ ClangdLSPServer::ClangdLSPServer(class Transport &Transp,
 
   // Delay first profile until we've finished warming up.
   NextProfileTime = std::chrono::steady_clock::now() + std::chrono::minutes(1);
+  NextMemoryCleanupTime = NextProfileTime;
 }
 
 ClangdLSPServer::~ClangdLSPServer() {
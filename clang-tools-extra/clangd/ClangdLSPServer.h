@@ -57,6 +57,10 @@ public:
     std::function<bool(const Tweak &)> TweakFilter = [](const Tweak &T) {
       return !T.hidden(); // only enable non-hidden tweaks.
     };
+
+    /// Called periodically to release memory to the OS, e.g. once evicted
+    /// ASTs have been freed. No cleanup is done if it's null.
+    std::function<void()> MemoryCleanup = nullptr;
   };
 
   ClangdLSPServer(Transport &Transp, const ThreadsafeFS &TFS,
@@ -188,6 +192,12 @@ private:
   /// requests.
   std::chrono::steady_clock::time_point NextProfileTime;
 
+  /// Runs Opts.MemoryCleanup if it hasn't run recently.
+  void maybeCleanupMemory();
+
+  /// Timepoint until which memory cleanup is off, to throttle it.
+  std::chrono::steady_clock::time_point NextMemoryCleanupTime;
+
   /// Since initialization of CDBs and ClangdServer is done lazily, the
   /// following context captures the one used while creating ClangdLSPServer and
   /// passes it to above mentioned object instances to make sure they share the
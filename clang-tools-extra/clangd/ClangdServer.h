@@ -95,6 +95,9 @@ public:
     /// Reuse even stale preambles, and rebuild them in the background.
     /// This improves latency at the cost of accuracy.
     bool AsyncPreambleBuilds = true;
+    /// Skip the function bodies preceding the edit when rebuilding the AST
+    /// for diagnostics. Diagnostics introduced there by the edit may be missed.
+    bool SkipUnchangedBodies = false;
 
     /// If true, ClangdServer builds a dynamic in-memory index for symbols in
     /// opened files and uses the index to augment code completion results.
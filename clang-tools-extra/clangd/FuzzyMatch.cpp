@@ -185,16 +185,19 @@ bool FuzzyMatcher::init(llvm::StringRef NewWord) {
   std::copy(NewWord.begin(), NewWord.begin() + WordN, Word);
   if (PatN == 0)
     return true;
-  for (int I = 0; I < WordN; ++I)
-    LowWord[I] = lower(Word[I]);
-
-  // Cheap subsequence check.
+  // Cheap subsequence check, lowering the word as we go.
   for (int W = 0, P = 0; P != PatN; ++W) {
     if (W == WordN)
       return false;
+    LowWord[W] = lower(Word[W]);
     if (LowWord[W] == LowPat[P])
-      ++P;
+      FirstMatch[P++] = W;
   }
+  for (int W = FirstMatch[PatN - 1] + 1; W < WordN; ++W)
+    LowWord[W] = lower(Word[W]);
+  for (int W = WordN - 1, P = PatN - 1; P >= 0; --W)
+    if (LowWord[W] == LowPat[P])
+      LastMatch[P--] = W;
 
   // FIXME: some words are hard to tokenize algorithmically.
   // e.g. vsprintf is V S Print F, and should match [pri] but not [int].
@@ -213,6 +216,11 @@ bool FuzzyMatcher::init(llvm::StringRef NewWord) {
 // and 3 being a great one. So we treat the score range as [0, 3 * PatN].
 // This range is not strict: we can apply larger bonuses/penalties, or penalize
 // non-matched characters.
+//
+// Only the states that can be part of a complete match are computed: Pat[P]
+// is matched after FirstMatch[P] - 1 and up to LastMatch[P], and skipping
+// word characters after Pat[P] is useful until LastMatch[P + 1].
+// The others are left unreachable or stale, and never read.
 void FuzzyMatcher::buildGraph() {
   for (int W = 0; W < WordN; ++W) {
     Scores[0][W + 1][Miss] = {Scores[0][W][Miss].Score - skipPenalty(W, Miss),
@@ -220,7 +228,11 @@ void FuzzyMatcher::buildGraph() {
     Scores[0][W + 1][Match] = {AwfulScore, Miss};
   }
   for (int P = 0; P < PatN; ++P) {
-    for (int W = P; W < WordN; ++W) {
+    // Pat[..P] can't be matched by Word[..FirstMatch[P]].
+    Scores[P + 1][FirstMatch[P]][Miss] = {AwfulScore, Miss};
+    Scores[P + 1][FirstMatch[P]][Match] = {AwfulScore, Miss};
+    int End = P + 1 < PatN ? LastMatch[P + 1] : WordN;
+    for (int W = FirstMatch[P]; W < End; ++W) {
       auto &Score = Scores[P + 1][W + 1], &PreMiss = Scores[P + 1][W];
 
       auto MatchMissScore = PreMiss[Match].Score;
@@ -233,6 +245,10 @@ void FuzzyMatcher::buildGraph() {
                         ? ScoreInfo{MatchMissScore, Match}
                         : ScoreInfo{MissMissScore, Miss};
 
+      if (W > LastMatch[P]) { // The rest of the pattern can't be matched.
+        Score[Match] = {AwfulScore, Miss};
+        continue;
+      }
       auto &PreMatch = Scores[P][W];
       auto MatchMatchScore =
           allowMatch(P, W, Match)
@@ -384,7 +400,9 @@ llvm::SmallString<256> FuzzyMatcher::dumpLast(llvm::raw_ostream &OS) const {
     for (Action A : {Miss, Match}) {
       OS << ((I && A == Miss) ? Pat[I - 1] : ' ') << "|";
       for (int J = 0; J <= WordN; ++J) {
-        if (!isAwful(Scores[I][J][A].Score))
+        bool Computed = I == 0 || (J > FirstMatch[I - 1] &&
+                                   J <= (I < PatN ? LastMatch[I] : WordN));
+        if (Computed && !isAwful(Scores[I][J][A].Score))
           OS << llvm::format("%3d%c", Scores[I][J][A].Score,
                              Scores[I][J][A].Prev == Match ? '*' : ' ');
         else
@@ -119,6 +119,11 @@ private:
   CharRole WordRole[MaxWord]; // Word segmentation info
   CharTypeSet WordTypeSet;    // Bitmask of 1<<CharType for all Word characters
   bool WordContainsPattern;   // Simple substring check
+  // Range of Word characters each Pattern character can match in a complete
+  // match: a greedy match of the pattern from the start of the word (first)
+  // and from its end (last). buildGraph() only fills that part of the table.
+  int FirstMatch[MaxPat];
+  int LastMatch[MaxPat];
 
   // Cumulative best-match score table.
   // Boundary conditions are filled in by the constructor.
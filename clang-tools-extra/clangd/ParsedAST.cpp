@@ -45,6 +45,8 @@
 #include "clang/Tooling/CompilationDatabase.h"
 #include "clang/Tooling/Syntax/Tokens.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
@@ -69,8 +71,9 @@ template <class T> std::size_t getUsedBytes(const std::vector<T> &Vec) {
 
 class DeclTrackingASTConsumer : public ASTConsumer {
 public:
-  DeclTrackingASTConsumer(std::vector<Decl *> &TopLevelDecls)
-      : TopLevelDecls(TopLevelDecls) {}
+  DeclTrackingASTConsumer(std::vector<Decl *> &TopLevelDecls,
+                          const llvm::DenseSet<unsigned> &SkippedBodies)
+      : TopLevelDecls(TopLevelDecls), SkippedBodies(SkippedBodies) {}
 
   bool HandleTopLevelDecl(DeclGroupRef DG) override {
     for (Decl *D : DG) {
@@ -90,24 +93,75 @@ public:
     return true;
   }
 
+  // Only called when FrontendOptions::SkipFunctionBodies is set.
+  bool shouldSkipFunctionBody(Decl *D) override {
+    const auto *FD = D->getAsFunction();
+    if (!FD || !FD->getDeclContext()->getRedeclContext()->isFileContext())
+      return false;
+    auto &SM = D->getASTContext().getSourceManager();
+    SourceLocation Loc = D->getLocation();
+    return Loc.isFileID() && SM.isWrittenInMainFile(Loc) &&
+           SkippedBodies.count(SM.getFileOffset(Loc));
+  }
+
 private:
   std::vector<Decl *> &TopLevelDecls;
+  const llvm::DenseSet<unsigned> &SkippedBodies;
 };
 
 class ClangdFrontendAction : public SyntaxOnlyAction {
 public:
+  ClangdFrontendAction(llvm::DenseSet<unsigned> SkippedBodies)
+      : SkippedBodies(std::move(SkippedBodies)) {}
+
   std::vector<Decl *> takeTopLevelDecls() { return std::move(TopLevelDecls); }
 
 protected:
   std::unique_ptr<ASTConsumer>
   CreateASTConsumer(CompilerInstance &CI, llvm::StringRef InFile) override {
-    return std::make_unique<DeclTrackingASTConsumer>(/*ref*/ TopLevelDecls);
+    return std::make_unique<DeclTrackingASTConsumer>(/*ref*/ TopLevelDecls,
+                                                     SkippedBodies);
   }
 
 private:
   std::vector<Decl *> TopLevelDecls;
+  // Offsets of the names of the functions whose bodies are skipped.
+  llvm::DenseSet<unsigned> SkippedBodies;
 };
 
+// Collects the bodies of the functions defined at namespace scope in the main
+// file. The skipped ones are taken from the previous build.
+void collectFunctionBodies(llvm::ArrayRef<Decl *> Decls,
+                           const SourceManager &SM,
+                           const llvm::DenseMap<unsigned, unsigned> &Previous,
+                           std::vector<FunctionBody> &Bodies) {
+  for (Decl *D : Decls) {
+    if (isa<NamespaceDecl>(D) || isa<LinkageSpecDecl>(D)) {
+      const auto *DC = cast<DeclContext>(D);
+      collectFunctionBodies(
+          std::vector<Decl *>(DC->decls_begin(), DC->decls_end()), SM,
+          Previous, Bodies);
+      continue;
+    }
+    const auto *FD = D->getAsFunction();
+    if (!FD || !D->getLocation().isFileID() ||
+        !SM.isWrittenInMainFile(D->getLocation()))
+      continue;
+    unsigned NameOffset = SM.getFileOffset(D->getLocation());
+    if (FD->hasSkippedBody()) {
+      auto It = Previous.find(NameOffset);
+      if (It != Previous.end())
+        Bodies.push_back({NameOffset, It->second});
+      continue;
+    }
+    const Stmt *Body = FD->getBody();
+    if (!Body || !Body->getEndLoc().isFileID() ||
+        !SM.isWrittenInMainFile(Body->getEndLoc()))
+      continue;
+    Bodies.push_back({NameOffset, SM.getFileOffset(Body->getEndLoc()) + 1});
+  }
+}
+
 // When using a preamble, only preprocessor events outside its bounds are seen.
 // This is almost what we want: replaying transitive preprocessing wastes time.
 // However this confuses clang-tidy checks: they don't see any #includes!
@@ -241,7 +295,8 @@ llvm::Optional<ParsedAST>
 ParsedAST::build(llvm::StringRef Filename, const ParseInputs &Inputs,
                  std::unique_ptr<clang::CompilerInvocation> CI,
                  llvm::ArrayRef<Diag> CompilerInvocationDiags,
-                 std::shared_ptr<const PreambleData> Preamble) {
+                 std::shared_ptr<const PreambleData> Preamble,
+                 const ReusedBuild *Reuse) {
   trace::Span Tracer("BuildAST");
   SPAN_ATTACH(Tracer, "File", Filename);
 
@@ -260,6 +315,18 @@ ParsedAST::build(llvm::StringRef Filename, const ParseInputs &Inputs,
   // breaks many features. Disable it for the main-file (not preamble).
   CI->getLangOpts()->DelayedTemplateParsing = false;
 
+  // The functions defined before the edit can keep their previous bodies.
+  llvm::DenseSet<unsigned> SkippedBodies;
+  llvm::DenseMap<unsigned, unsigned> PreviousBodies;
+  if (Reuse) {
+    for (const FunctionBody &Body : Reuse->Bodies) {
+      PreviousBodies[Body.NameOffset] = Body.EndOffset;
+      if (Body.EndOffset <= Reuse->EditOffset)
+        SkippedBodies.insert(Body.NameOffset);
+    }
+    CI->getFrontendOpts().SkipFunctionBodies = !SkippedBodies.empty();
+  }
+
   StoreDiags ASTDiags;
 
   llvm::Optional<PreamblePatch> Patch;
@@ -274,7 +341,7 @@ ParsedAST::build(llvm::StringRef Filename, const ParseInputs &Inputs,
   if (!Clang)
     return None;
 
-  auto Action = std::make_unique<ClangdFrontendAction>();
+  auto Action = std::make_unique<ClangdFrontendAction>(SkippedBodies);
   const FrontendInputFile &MainInput = Clang->getFrontendOpts().Inputs[0];
   if (!Action->BeginSourceFile(*Clang, MainInput)) {
     log("BeginSourceFile() failed when building AST for {0}",
@@ -444,10 +511,49 @@ ParsedAST::build(llvm::StringRef Filename, const ParseInputs &Inputs,
     std::vector<Diag> D = ASTDiags.take(CTContext.getPointer());
     Diags.insert(Diags.end(), D.begin(), D.end());
   }
-  return ParsedAST(Inputs.Version, std::move(Preamble), std::move(Clang),
+
+  std::vector<FunctionBody> Bodies;
+  collectFunctionBodies(ParsedDecls, Clang->getSourceManager(), PreviousBodies,
+                        Bodies);
+  bool HasSkippedBodies = !SkippedBodies.empty();
+  if (HasSkippedBodies) {
+    // The skipped bodies keep their previous diagnostics. The rest of the text
+    // before the edit only keeps the diagnostics it previously had: the uses
+    // in skipped bodies aren't seen, which mustn't cause -Wunused-function.
+    const SourceManager &SM = Clang->getSourceManager();
+    auto ToPosition = [&](unsigned Offset) {
+      return sourceLocToPosition(
+          SM, SM.getComposedLoc(SM.getMainFileID(), Offset));
+    };
+    std::vector<Range> SkippedRanges;
+    for (const FunctionBody &Body : Bodies)
+      if (SkippedBodies.count(Body.NameOffset))
+        SkippedRanges.push_back(
+            {ToPosition(Body.NameOffset), ToPosition(Body.EndOffset)});
+    auto InSkippedBody = [&](const Diag &D) {
+      return llvm::any_of(SkippedRanges,
+                          [&](const Range &R) { return R.contains(D.Range); });
+    };
+    auto PreviouslyReported = [&](const Diag &D) {
+      return llvm::any_of(Reuse->Diags, [&](const Diag &Old) {
+        return Old.Range == D.Range && Old.Message == D.Message;
+      });
+    };
+    Position Edit = ToPosition(Reuse->EditOffset);
+    llvm::erase_if(Diags, [&](const Diag &D) {
+      return D.Range.end <= Edit &&
+             (InSkippedBody(D) || !PreviouslyReported(D));
+    });
+    llvm::copy_if(Reuse->Diags, std::back_inserter(Diags), InSkippedBody);
+  }
+
+  ParsedAST Result(Inputs.Version, std::move(Preamble), std::move(Clang),
                    std::move(Action), std::move(Tokens), std::move(Macros),
                    std::move(ParsedDecls), std::move(Diags),
                    std::move(Includes), std::move(CanonIncludes));
+  Result.FunctionBodies = std::move(Bodies);
+  Result.HasSkippedBodies = HasSkippedBodies;
+  return std::move(Result);
 }
 
 ParsedAST::ParsedAST(ParsedAST &&Other) = default;
@@ -44,17 +44,41 @@ namespace clang {
 namespace clangd {
 class SymbolIndex;
 
+/// The body of a function defined at namespace scope in the main file.
+struct FunctionBody {
+  /// Offset of the name of the function, which identifies it across builds.
+  unsigned NameOffset;
+  /// Offset just past the closing brace of the body.
+  unsigned EndOffset;
+};
+
+/// What a build of the main file can reuse from the previous build of the same
+/// file, with the same command and preamble, when the text before EditOffset
+/// is unchanged. That text is parsed the same way, so the bodies of the
+/// functions it defines are skipped and keep their previous diagnostics.
+struct ReusedBuild {
+  /// Offset of the first change since the previous build.
+  unsigned EditOffset = 0;
+  /// Function bodies of the previous build.
+  std::vector<FunctionBody> Bodies;
+  /// Diagnostics of the previous build.
+  std::vector<Diag> Diags;
+};
+
 /// Stores and provides access to parsed AST.
 class ParsedAST {
 public:
   /// Attempts to run Clang and store the parsed AST.
   /// If \p Preamble is non-null it is reused during parsing.
   /// This function does not check if preamble is valid to reuse.
+  /// If \p Reuse is non-null, the bodies that can be reused aren't parsed and
+  /// the resulting AST is only fit for diagnostics.
   static llvm::Optional<ParsedAST>
   build(llvm::StringRef Filename, const ParseInputs &Inputs,
         std::unique_ptr<clang::CompilerInvocation> CI,
         llvm::ArrayRef<Diag> CompilerInvocationDiags,
-        std::shared_ptr<const PreambleData> Preamble);
+        std::shared_ptr<const PreambleData> Preamble,
+        const ReusedBuild *Reuse = nullptr);
 
   ParsedAST(ParsedAST &&Other);
   ParsedAST &operator=(ParsedAST &&Other);
@@ -89,6 +113,14 @@ public:
 
   const std::vector<Diag> &getDiagnostics() const;
 
+  /// Bodies of the functions defined at namespace scope in the main file,
+  /// including the skipped ones.
+  llvm::ArrayRef<FunctionBody> getFunctionBodies() const {
+    return FunctionBodies;
+  }
+  /// Whether some function bodies weren't parsed, see ReusedBuild.
+  bool hasSkippedBodies() const { return HasSkippedBodies; }
+
   /// Returns the estimated size of the AST and the accessory structures, in
   /// bytes. Does not include the size of the preamble.
   std::size_t getUsedBytes() const;
@@ -142,6 +174,8 @@ private:
   // Top-level decls inside the current file. Not that this does not include
   // top-level decls from the preamble.
   std::vector<Decl *> LocalTopLevelDecls;
+  std::vector<FunctionBody> FunctionBodies;
+  bool HasSkippedBodies = false;
   IncludeStructure Includes;
   CanonicalIncludes CanonIncludes;
 };
@@ -10,6 +10,7 @@
 #include "Compiler.h"
 #include "Headers.h"
 #include "SourceCode.h"
+#include "support/Cancellation.h"
 #include "support/Logger.h"
 #include "support/ThreadsafeFS.h"
 #include "support/Trace.h"
@@ -75,7 +76,8 @@ public:
   CanonicalIncludes takeCanonicalIncludes() { return std::move(CanonIncludes); }
 
   void AfterExecute(CompilerInstance &CI) override {
-    if (!ParsedCallback)
+    // Don't run the callback on the partial AST of a cancelled build.
+    if (!ParsedCallback || Cancelled)
       return;
     trace::Span Tracer("Running PreambleCallback");
     ParsedCallback(CI.getASTContext(), CI.getPreprocessorPtr(), CanonIncludes);
@@ -114,9 +116,16 @@ public:
     return true;
   }
 
+  bool shouldCancel() override {
+    // The preamble thread cancels the build when a newer version arrives.
+    Cancelled = isCancelled();
+    return Cancelled;
+  }
+
 private:
   PathRef File;
   PreambleParsedCallback ParsedCallback;
+  bool Cancelled = false;
   IncludeStructure Includes;
   CanonicalIncludes CanonIncludes;
   MainFileMacros Macros;
@@ -362,11 +371,14 @@ buildPreamble(PathRef FileName, CompilerInvocation CI,
         SerializedDeclsCollector.takeIncludes(),
         SerializedDeclsCollector.takeMacros(), std::move(StatCache),
         SerializedDeclsCollector.takeCanonicalIncludes());
-  } else {
-    elog("Could not build a preamble for file {0} version {1}", FileName,
-         Inputs.Version);
-    return nullptr;
   }
+  if (BuiltPreamble.getError() == BuildPreambleError::Cancelled)
+    vlog("Cancelled preamble build for file {0} version {1}", FileName,
+         Inputs.Version);
+  else
+    elog("Could not build a preamble for file {0} version {1}: {2}", FileName,
+         Inputs.Version, BuiltPreamble.getError().message());
+  return nullptr;
 }
 
 bool isPreambleCompatible(const PreambleData &Preamble,
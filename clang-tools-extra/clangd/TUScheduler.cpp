@@ -105,40 +105,49 @@ llvm::Optional<llvm::StringRef> TUScheduler::getFileBeingProcessedInContext() {
 }
 
 /// An LRU cache of idle ASTs.
-/// Because we want to limit the overall number of these we retain, the cache
-/// owns ASTs (and may evict them) while their workers are idle.
+/// Because we want to limit the overall number and size of these we retain,
+/// the cache owns ASTs (and may evict them) while their workers are idle.
 /// Workers borrow ASTs when active, and return them when done.
 class TUScheduler::ASTCache {
 public:
   using Key = const ASTWorker *;
 
-  ASTCache(unsigned MaxRetainedASTs) : MaxRetainedASTs(MaxRetainedASTs) {}
+  ASTCache(const ASTRetentionPolicy &Policy)
+      : MaxRetainedASTs(Policy.MaxRetainedASTs),
+        MaxRetainedBytes(Policy.MaxRetainedBytes) {}
 
   /// Returns result of getUsedBytes() for the AST cached by \p K.
   /// If no AST is cached, 0 is returned.
   std::size_t getUsedBytes(Key K) {
     std::lock_guard<std::mutex> Lock(Mut);
     auto It = findByKey(K);
-    if (It == LRU.end() || !It->second)
+    if (It == LRU.end())
       return 0;
-    return It->second->getUsedBytes();
+    return It->UsedBytes;
   }
 
-  /// Store the value in the pool, possibly removing the last used AST.
-  /// The value should not be in the pool when this function is called.
+  /// Store the value in the pool, possibly removing the least recently used
+  /// ASTs. The value should not be in the pool when this function is called.
   void put(Key K, std::unique_ptr<ParsedAST> V) {
+    // Measure the AST outside the lock.
+    std::size_t UsedBytes = V ? V->getUsedBytes() : 0;
     std::unique_lock<std::mutex> Lock(Mut);
     assert(findByKey(K) == LRU.end());
 
-    LRU.insert(LRU.begin(), {K, std::move(V)});
-    if (LRU.size() <= MaxRetainedASTs)
-      return;
-    // We're past the limit, remove the last element.
-    std::unique_ptr<ParsedAST> ForCleanup = std::move(LRU.back().second);
-    LRU.pop_back();
-    // Run the expensive destructor outside the lock.
+    LRU.insert(LRU.begin(), {K, std::move(V), UsedBytes});
+    TotalBytes += UsedBytes;
+    std::vector<std::unique_ptr<ParsedAST>> ForCleanup;
+    // Evict past the limits, but always keep the AST that was just put.
+    while (LRU.size() > MaxRetainedASTs ||
+           (MaxRetainedBytes && TotalBytes > MaxRetainedBytes &&
+            LRU.size() > 1)) {
+      TotalBytes -= LRU.back().UsedBytes;
+      ForCleanup.push_back(std::move(LRU.back().AST));
+      LRU.pop_back();
+    }
+    // Run the expensive destructors outside the lock.
     Lock.unlock();
-    ForCleanup.reset();
+    ForCleanup.clear();
   }
 
   /// Returns the cached value for \p K, or llvm::None if the value is not in
@@ -157,7 +166,8 @@ public:
     }
     if (AccessMetric)
       AccessMetric->record(1, "hit");
-    std::unique_ptr<ParsedAST> V = std::move(Existing->second);
+    std::unique_ptr<ParsedAST> V = std::move(Existing->AST);
+    TotalBytes -= Existing->UsedBytes;
     LRU.erase(Existing);
     // GCC 4.8 fails to compile `return V;`, as it tries to call the copy
     // constructor of unique_ptr, so we call the move ctor explicitly to avoid
@@ -166,17 +176,23 @@ public:
   }
 
 private:
-  using KVPair = std::pair<Key, std::unique_ptr<ParsedAST>>;
+  struct Entry {
+    Key K;
+    std::unique_ptr<ParsedAST> AST;
+    std::size_t UsedBytes; // AST->getUsedBytes(), computed once.
+  };
 
-  std::vector<KVPair>::iterator findByKey(Key K) {
-    return llvm::find_if(LRU, [K](const KVPair &P) { return P.first == K; });
+  std::vector<Entry>::iterator findByKey(Key K) {
+    return llvm::find_if(LRU, [K](const Entry &E) { return E.K == K; });
   }
 
   std::mutex Mut;
   unsigned MaxRetainedASTs;
+  std::size_t MaxRetainedBytes;
   /// Items sorted in LRU order, i.e. first item is the most recently accessed
   /// one.
-  std::vector<KVPair> LRU; /* GUARDED_BY(Mut) */
+  std::vector<Entry> LRU;     /* GUARDED_BY(Mut) */
+  std::size_t TotalBytes = 0; /* GUARDED_BY(Mut) */
 };
 
 namespace {
@@ -250,6 +266,10 @@ public:
         return !NextReq || NextReq->WantDiags != WantDiagnostics::Yes;
       });
       NextReq = std::move(Req);
+      // The build in progress is stale now, stop it unless its diagnostics
+      // were explicitly requested.
+      if (CancelCurrentReq)
+        CancelCurrentReq();
     }
     // Let the worker thread know there's a request, notify_one is safe as there
     // should be a single worker thread waiting on it.
@@ -274,6 +294,12 @@ public:
         // Note that we don't make use of the ContextProvider here.
         // Preamble tasks are always scheduled by ASTWorker tasks, and we
         // reuse the context/config that was created at that level.
+        auto Task = cancelableTask();
+        WithContext Cancelable(std::move(Task.first));
+        if (CurrentReq->WantDiags != WantDiagnostics::Yes) {
+          std::lock_guard<std::mutex> Lock(Mutex);
+          CancelCurrentReq = std::move(Task.second);
+        }
 
         // Build the preamble and let the waiters know about it.
         build(std::move(*CurrentReq));
@@ -282,6 +308,7 @@ public:
       {
         std::lock_guard<std::mutex> Lock(Mutex);
         CurrentReq.reset();
+        CancelCurrentReq = nullptr;
         IsEmpty = !NextReq.hasValue();
       }
       if (IsEmpty) {
@@ -338,6 +365,8 @@ private:
   bool Done = false;                  /* GUARDED_BY(Mutex) */
   llvm::Optional<Request> NextReq;    /* GUARDED_BY(Mutex) */
   llvm::Optional<Request> CurrentReq; /* GUARDED_BY(Mutex) */
+  // Cancels the build of CurrentReq, if it may be dropped.
+  Canceler CancelCurrentReq; /* GUARDED_BY(Mutex) */
   // Signaled whenever a thread populates NextReq or worker thread builds a
   // Preamble.
   mutable std::condition_variable ReqCV; /* GUARDED_BY(Mutex) */
@@ -422,6 +451,9 @@ private:
   /// Publishes diagnostics for \p Inputs. It will build an AST or reuse the
   /// cached one if applicable. Assumes LatestPreamble is compatible for \p
   /// Inputs.
+  /// Returns what a build of \p Inputs for diagnostics can reuse from the
+  /// previous one, if anything. Consumes LastDiagnosticsBuild.
+  llvm::Optional<ReusedBuild> takeReusedBuild(const ParseInputs &Inputs);
   void generateDiagnostics(std::unique_ptr<CompilerInvocation> Invocation,
                            ParseInputs Inputs, std::vector<Diag> CIDiags);
 
@@ -470,6 +502,17 @@ private:
   Semaphore &Barrier;
   /// Whether the 'onMainAST' callback ran for the current FileInputs.
   bool RanASTCallback = false;
+  const bool SkipUnchangedBodies;
+  /// The last AST built for diagnostics, as far as the next one can reuse it.
+  /// Only accessed by the worker thread.
+  struct DiagnosticsBuild {
+    std::string Contents;
+    tooling::CompileCommand Command;
+    std::weak_ptr<const PreambleData> Preamble;
+    std::vector<FunctionBody> Bodies;
+    std::vector<Diag> Diags;
+  };
+  llvm::Optional<DiagnosticsBuild> LastDiagnosticsBuild;
   /// Guards members used by both TUScheduler and the worker thread.
   mutable std::mutex Mutex;
   /// File inputs, currently being used by the worker.
@@ -577,7 +620,8 @@ ASTWorker::ASTWorker(PathRef FileName, const GlobalCompilationDatabase &CDB,
                      ParsingCallbacks &Callbacks)
     : IdleASTs(LRUCache), RunSync(RunSync), UpdateDebounce(Opts.UpdateDebounce),
       FileName(FileName), ContextProvider(Opts.ContextProvider), CDB(CDB),
-      Callbacks(Callbacks), Barrier(Barrier), Done(false),
+      Callbacks(Callbacks), Barrier(Barrier),
+      SkipUnchangedBodies(Opts.SkipUnchangedBodies), Done(false),
       Status(FileName, Callbacks),
       PreamblePeer(FileName, Callbacks, Opts.StorePreamblesInMemory,
                    RunSync || !Opts.AsyncPreambleBuilds, Status, *this) {
@@ -733,7 +777,11 @@ void PreambleThread::build(Request Req) {
   Status.update([&](TUStatus &Status) {
     Status.PreambleActivity = PreambleAction::Building;
   });
-  auto _ = llvm::make_scope_exit([this, &Req] {
+  bool Cancelled = false;
+  auto _ = llvm::make_scope_exit([this, &Req, &Cancelled] {
+    // NextReq superseded a cancelled build, it will notify ASTPeer instead.
+    if (Cancelled)
+      return;
     ASTPeer.updatePreamble(std::move(Req.CI), std::move(Req.Inputs),
                            LatestBuild, std::move(Req.CIDiags),
                            std::move(Req.WantDiags));
@@ -752,7 +800,7 @@ void PreambleThread::build(Request Req) {
          FileName, Inputs.Version, LatestBuild->Version);
   }
 
-  LatestBuild = clang::clangd::buildPreamble(
+  auto Preamble = clang::clangd::buildPreamble(
       FileName, *Req.CI, Inputs, StoreInMemory,
       [this, Version(Inputs.Version)](ASTContext &Ctx,
                                       std::shared_ptr<clang::Preprocessor> PP,
@@ -760,6 +808,13 @@ void PreambleThread::build(Request Req) {
         Callbacks.onPreambleAST(FileName, Version, Ctx, std::move(PP),
                                 CanonIncludes);
       });
+  // Keep the previous preamble if the build was cancelled for NextReq.
+  if (!Preamble && isCancelled()) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Cancelled = NextReq.hasValue();
+  }
+  if (!Cancelled)
+    LatestBuild = std::move(Preamble);
 }
 
 void ASTWorker::updatePreamble(std::unique_ptr<CompilerInvocation> CI,
@@ -815,6 +870,27 @@ void ASTWorker::updatePreamble(std::unique_ptr<CompilerInvocation> CI,
   RequestsCV.notify_all();
 }
 
+llvm::Optional<ReusedBuild>
+ASTWorker::takeReusedBuild(const ParseInputs &Inputs) {
+  if (!LastDiagnosticsBuild)
+    return llvm::None;
+  DiagnosticsBuild Last = std::move(*LastDiagnosticsBuild);
+  LastDiagnosticsBuild.reset();
+  // A different preamble, or command, may parse the same text differently.
+  if (Last.Command != Inputs.CompileCommand ||
+      Last.Preamble.lock() != *LatestPreamble)
+    return llvm::None;
+  ReusedBuild Reuse;
+  Reuse.EditOffset =
+      std::mismatch(Last.Contents.begin(), Last.Contents.end(),
+                    Inputs.Contents.begin(), Inputs.Contents.end())
+          .second -
+      Inputs.Contents.begin();
+  Reuse.Bodies = std::move(Last.Bodies);
+  Reuse.Diags = std::move(Last.Diags);
+  return std::move(Reuse);
+}
+
 void ASTWorker::generateDiagnostics(
     std::unique_ptr<CompilerInvocation> Invocation, ParseInputs Inputs,
     std::vector<Diag> CIDiags) {
@@ -854,9 +930,17 @@ void ASTWorker::generateDiagnostics(
       IdleASTs.take(this, &ASTAccessForDiag);
   if (!AST || !InputsAreLatest) {
     auto RebuildStartTime = DebouncePolicy::clock::now();
-    llvm::Optional<ParsedAST> NewAST = ParsedAST::build(
-        FileName, Inputs, std::move(Invocation), CIDiags, *LatestPreamble);
+    llvm::Optional<ReusedBuild> Reuse;
+    if (SkipUnchangedBodies)
+      Reuse = takeReusedBuild(Inputs);
+    llvm::Optional<ParsedAST> NewAST =
+        ParsedAST::build(FileName, Inputs, std::move(Invocation), CIDiags,
+                         *LatestPreamble, Reuse ? &*Reuse : nullptr);
     auto RebuildDuration = DebouncePolicy::clock::now() - RebuildStartTime;
+    if (SkipUnchangedBodies && NewAST)
+      LastDiagnosticsBuild = DiagnosticsBuild{
+          Inputs.Contents, Inputs.CompileCommand, *LatestPreamble,
+          NewAST->getFunctionBodies(), NewAST->getDiagnostics()};
     ++ASTBuildCount;
     // Try to record the AST-build time, to inform future update debouncing.
     // This is best-effort only: if the lock is held, don't bother.
@@ -906,7 +990,9 @@ void ASTWorker::generateDiagnostics(
   // queue can't reuse the AST.
   if (InputsAreLatest) {
     RanASTCallback = *AST != nullptr;
-    IdleASTs.put(this, std::move(*AST));
+    // An AST with skipped bodies is only fit for diagnostics.
+    if (!*AST || !(*AST)->hasSkippedBodies())
+      IdleASTs.put(this, std::move(*AST));
   }
 }
 
@@ -1235,8 +1321,7 @@ TUScheduler::TUScheduler(const GlobalCompilationDatabase &CDB,
       Callbacks(Callbacks ? move(Callbacks)
                           : std::make_unique<ParsingCallbacks>()),
       Barrier(Opts.AsyncThreadsCount),
-      IdleASTs(
-          std::make_unique<ASTCache>(Opts.RetentionPolicy.MaxRetainedASTs)) {
+      IdleASTs(std::make_unique<ASTCache>(Opts.RetentionPolicy)) {
   // Avoid null checks everywhere.
   if (!Opts.ContextProvider) {
     this->Opts.ContextProvider = [](llvm::StringRef) {
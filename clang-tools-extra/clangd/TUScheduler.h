@@ -60,6 +60,9 @@ struct ASTRetentionPolicy {
   /// Maximum number of ASTs to be retained in memory when there are no pending
   /// requests for them.
   unsigned MaxRetainedASTs = 3;
+  /// Maximum memory used by the retained ASTs, in bytes. 0 means no limit.
+  /// The most recently used AST is retained even if it is bigger than that.
+  size_t MaxRetainedBytes = 0;
 };
 
 /// Clangd may wait after an update to see if another one comes along.
@@ -197,6 +200,11 @@ public:
     /// No-op if AsyncThreadsCount is 0.
     bool AsyncPreambleBuilds = true;
 
+    /// Whether the ASTs built for diagnostics skip the function bodies that
+    /// precede the first edit since the previous build, see ReusedBuild.
+    /// Diagnostics that the edit introduces before itself may be missed.
+    bool SkipUnchangedBodies = false;
+
     /// Used to create a context that wraps each single operation.
     /// Typically to inject per-file configuration.
     /// If the path is empty, context sholud be "generic".
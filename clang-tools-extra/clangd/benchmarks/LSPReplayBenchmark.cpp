@@ -0,0 +1,225 @@
+//===--- LSPReplayBenchmark.cpp - Clangd end-to-end benchmarks --*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Replays an LSP session recorded with clangd's -input-mirror-file against an
+// in-process ClangdLSPServer, and reports the latency percentiles of each kind
+// of request and the peak memory usage.
+//
+// Notifications (didOpen, didChange...) are sent right away, but each call is
+// sent once the previous one got its reply, so the latencies are those seen by
+// a user waiting for each result. The session refers to the files it was
+// recorded on, so it should be replayed on a fixed corpus at the same paths.
+//
+//===----------------------------------------------------------------------===//
+
+#include "../ClangdLSPServer.h"
+#include "../Transport.h"
+#include "../support/Logger.h"
+#include "../support/ThreadsafeFS.h"
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Process.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+const char *SessionFilename;
+
+namespace clang {
+namespace clangd {
+namespace {
+
+// Splits the recorded input stream into its JSON messages.
+std::vector<std::string> readMessages() {
+  auto Buffer = llvm::MemoryBuffer::getFile(SessionFilename);
+  if (!Buffer) {
+    llvm::errs() << "Error when reading " << SessionFilename << ": "
+                 << Buffer.getError().message() << "\n";
+    exit(1);
+  }
+  std::vector<std::string> Messages;
+  llvm::StringRef Input = (*Buffer)->getBuffer();
+  static constexpr llvm::StringLiteral Header = "Content-Length:";
+  while (true) {
+    size_t Pos = Input.find(Header);
+    if (Pos == llvm::StringRef::npos)
+      break;
+    Input = Input.drop_front(Pos + Header.size()).ltrim();
+    unsigned long long Length;
+    if (llvm::consumeUnsignedInteger(Input, 10, Length))
+      break;
+    Pos = Input.find("\r\n\r\n");
+    if (Pos == llvm::StringRef::npos)
+      break;
+    Input = Input.drop_front(Pos + 4);
+    Messages.push_back(Input.take_front(Length).str());
+    Input = Input.drop_front(Length);
+  }
+  return Messages;
+}
+
+// Feeds the recorded messages to the server and times its replies.
+// Calls made by the server are dropped, as are the recorded replies to them.
+class ReplayTransport : public Transport {
+public:
+  ReplayTransport(llvm::ArrayRef<std::string> Messages) : Messages(Messages) {}
+
+  void notify(llvm::StringRef Method, llvm::json::Value Params) override {}
+  void call(llvm::StringRef Method, llvm::json::Value Params,
+            llvm::json::Value ID) override {}
+
+  void reply(llvm::json::Value ID,
+             llvm::Expected<llvm::json::Value> Result) override {
+    if (!Result)
+      llvm::consumeError(Result.takeError());
+    auto Now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> Lock(Mu);
+    auto It = Pending.find(key(ID));
+    if (It == Pending.end())
+      return;
+    Latencies[It->second.first].push_back(
+        std::chrono::duration<double, std::milli>(Now - It->second.second)
+            .count());
+    Pending.erase(It);
+    CV.notify_all();
+  }
+
+  llvm::Error loop(MessageHandler &Handler) override {
+    for (const std::string &Message : Messages) {
+      auto JSON = llvm::json::parse(Message);
+      if (!JSON) {
+        llvm::consumeError(JSON.takeError());
+        continue;
+      }
+      auto *Object = JSON->getAsObject();
+      if (!Object)
+        continue;
+      auto Method = Object->getString("method");
+      if (!Method)
+        continue;
+      llvm::json::Value Params = nullptr;
+      if (const llvm::json::Value *P = Object->get("params"))
+        Params = *P;
+      const llvm::json::Value *ID = Object->get("id");
+      if (!ID) {
+        if (!Handler.onNotify(*Method, std::move(Params)))
+          return llvm::Error::success();
+      } else {
+        std::string Key = key(*ID);
+        {
+          std::lock_guard<std::mutex> Lock(Mu);
+          Pending[Key] = {Method->str(), std::chrono::steady_clock::now()};
+        }
+        Handler.onCall(*Method, std::move(Params), *ID);
+        std::unique_lock<std::mutex> Lock(Mu);
+        if (!CV.wait_for(Lock, std::chrono::minutes(1),
+                         [&] { return !Pending.count(Key); })) {
+          llvm::errs() << "No reply to " << *Method << " " << Key << "\n";
+          Pending.erase(Key);
+        }
+      }
+      PeakMemory = std::max(PeakMemory, llvm::sys::Process::GetMallocUsage());
+    }
+    // The session was cut short, shut the server down.
+    Handler.onCall("shutdown", nullptr, "replay-shutdown");
+    Handler.onNotify("exit", nullptr);
+    return llvm::Error::success();
+  }
+
+  // Adds the latencies of the replies, by method, and the peak memory seen.
+  void collect(llvm::StringMap<std::vector<double>> &AllLatencies,
+               size_t &AllPeakMemory) {
+    std::lock_guard<std::mutex> Lock(Mu);
+    for (auto &Method : Latencies)
+      llvm::append_range(AllLatencies[Method.first()], Method.second);
+    AllPeakMemory = std::max(AllPeakMemory, PeakMemory);
+  }
+
+private:
+  static std::string key(const llvm::json::Value &ID) {
+    return llvm::formatv("{0}", ID).str();
+  }
+
+  llvm::ArrayRef<std::string> Messages;
+  std::mutex Mu;
+  std::condition_variable CV;
+  // Method and start time of the calls awaiting a reply, by ID.
+  std::map<std::string,
+           std::pair<std::string, std::chrono::steady_clock::time_point>>
+      Pending;
+  llvm::StringMap<std::vector<double>> Latencies;
+  size_t PeakMemory = 0;
+};
+
+double percentile(llvm::ArrayRef<double> Sorted, unsigned P) {
+  return Sorted[std::min(Sorted.size() - 1, Sorted.size() * P / 100)];
+}
+
+static void ReplaySession(benchmark::State &State) {
+  const auto Messages = readMessages();
+  llvm::StringMap<std::vector<double>> Latencies;
+  size_t PeakMemory = 0;
+  for (auto _ : State) {
+    ReplayTransport Transport(Messages);
+    RealThreadsafeFS TFS;
+    ClangdLSPServer::Options Opts;
+    // Indexing the whole corpus would dominate the measurements.
+    Opts.BackgroundIndex = false;
+    {
+      ClangdLSPServer Server(Transport, TFS, Opts);
+      Server.run();
+    }
+    Transport.collect(Latencies, PeakMemory);
+  }
+
+  for (auto &Method : Latencies) {
+    std::vector<double> &Sorted = Method.second;
+    llvm::sort(Sorted);
+    // Turn textDocument/completion into completion.
+    llvm::StringRef Name = Method.first();
+    Name = Name.substr(Name.rfind('/') + 1);
+    State.counters[(Name + "_p50_ms").str()] = percentile(Sorted, 50);
+    State.counters[(Name + "_p99_ms").str()] = percentile(Sorted, 99);
+  }
+  State.counters["peak_malloc_mb"] = PeakMemory / (1024.0 * 1024.0);
+}
+BENCHMARK(ReplaySession)->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace clangd
+} // namespace clang
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    llvm::errs() << "Usage: " << argv[0]
+                 << " session.mirror BENCHMARK_OPTIONS...\n";
+    return -1;
+  }
+  SessionFilename = argv[1];
+  // Only print the errors of the server.
+  clang::clangd::StreamLogger Logger(llvm::errs(),
+                                     clang::clangd::Logger::Error);
+  clang::clangd::LoggingSession LoggingSession(Logger);
+  // Trim the first argument of the benchmark invocation and pretend no
+  // arguments were passed in the first place.
+  argv[1] = argv[0];
+  ++argv;
+  --argc;
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+}
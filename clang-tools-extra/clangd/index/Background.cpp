@@ -156,7 +156,7 @@ static llvm::StringRef filenameWithoutExtension(llvm::StringRef Path) {
 
 BackgroundQueue::Task BackgroundIndex::indexFileTask(std::string Path) {
   std::string Tag = filenameWithoutExtension(Path).str();
-  BackgroundQueue::Task T([this, Path(std::move(Path))] {
+  BackgroundQueue::Task T([this, Path] {
     llvm::Optional<WithContext> WithProvidedContext;
     if (ContextProvider)
       WithProvidedContext.emplace(ContextProvider(Path));
@@ -168,12 +168,26 @@ BackgroundQueue::Task BackgroundIndex::indexFileTask(std::string Path) {
   });
   T.QueuePri = IndexFile;
   T.Tag = std::move(Tag);
+  T.Path = std::move(Path);
   return T;
 }
 
 void BackgroundIndex::boostRelated(llvm::StringRef Path) {
   if (isHeaderFile(Path))
     Queue.boost(filenameWithoutExtension(Path), IndexBoostedFile);
+  std::lock_guard<std::mutex> Lock(BoostedFilesMu);
+  if (BoostedFiles.insert(Path).second)
+    Queue.setProximity(
+        std::vector<std::string>(BoostedFiles.keys().begin(),
+                                 BoostedFiles.keys().end()));
+}
+
+void BackgroundIndex::unboostRelated(llvm::StringRef Path) {
+  std::lock_guard<std::mutex> Lock(BoostedFilesMu);
+  if (BoostedFiles.erase(Path))
+    Queue.setProximity(
+        std::vector<std::string>(BoostedFiles.keys().begin(),
+                                 BoostedFiles.keys().end()));
 }
 
 /// Given index results from a TU, only update symbols coming from files that
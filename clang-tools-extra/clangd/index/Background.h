@@ -9,6 +9,7 @@
 #ifndef LLVM_CLANG_TOOLS_EXTRA_CLANGD_INDEX_BACKGROUND_H
 #define LLVM_CLANG_TOOLS_EXTRA_CLANGD_INDEX_BACKGROUND_H
 
+#include "FileDistance.h"
 #include "GlobalCompilationDatabase.h"
 #include "SourceCode.h"
 #include "index/BackgroundRebuild.h"
@@ -23,6 +24,7 @@
 #include "support/Trace.h"
 #include "clang/Tooling/CompilationDatabase.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/Threading.h"
 #include <atomic>
 #include <condition_variable>
@@ -31,6 +33,7 @@
 #include <queue>
 #include <string>
 #include <thread>
+#include <tuple>
 #include <vector>
 
 namespace clang {
@@ -76,8 +79,15 @@ public:
     llvm::ThreadPriority ThreadPri = llvm::ThreadPriority::Background;
     unsigned QueuePri = 0; // Higher-priority tasks will run first.
     std::string Tag;       // Allows priority to be boosted later.
-
-    bool operator<(const Task &O) const { return QueuePri < O.QueuePri; }
+    std::string Path;      // The file the task works on, if any.
+    // Among tasks with the same QueuePri, those with a lower Distance will run
+    // first. It is the distance from Path to the files set by setProximity().
+    unsigned Distance = 0;
+
+    bool operator<(const Task &O) const {
+      return std::make_tuple(QueuePri, O.Distance) <
+             std::make_tuple(O.QueuePri, Distance);
+    }
   };
 
   // Describes the number of tasks processed by the queue.
@@ -98,6 +108,10 @@ public:
   // lower priority.
   // Reducing the boost of a tag affects future tasks but not current ones.
   void boost(llvm::StringRef Tag, unsigned NewPriority);
+  // Favor the current and new tasks whose Path is close to one of Files
+  // (typically, the files open in the editor) over the tasks with the same
+  // priority. Replaces the files of the previous call.
+  void setProximity(const std::vector<std::string> &Files);
 
   // Process items on the queue until the queue is stopped.
   // If the queue becomes empty, OnIdle will be called (on one worker).
@@ -114,6 +128,7 @@ public:
 
 private:
   void notifyProgress() const; // Requires lock Mu
+  void setDistance(Task &T);   // Requires lock Mu
 
   std::mutex Mu;
   Stats Stat;
@@ -121,6 +136,7 @@ private:
   bool ShouldStop = false;
   std::vector<Task> Queue; // max-heap
   llvm::StringMap<unsigned> Boosts;
+  llvm::Optional<FileDistance> Proximity;
   std::function<void(Stats)> OnProgress;
 };
 
@@ -159,7 +175,11 @@ public:
 
   /// Boosts priority of indexing related to Path.
   /// Typically used to index TUs when headers are opened.
+  /// Until unboostRelated(Path), files near Path are also indexed before the
+  /// files farther away.
   void boostRelated(llvm::StringRef Path);
+  /// Stops favoring the files near Path, typically when it is closed.
+  void unboostRelated(llvm::StringRef Path);
 
   // Cause background threads to stop after ther current task, any remaining
   // tasks will be discarded.
@@ -218,6 +238,9 @@ private:
     LoadShards,
   };
   BackgroundQueue Queue;
+  // The files passed to boostRelated(), whose neighbours are indexed first.
+  llvm::StringSet<> BoostedFiles;
+  std::mutex BoostedFilesMu;
   AsyncTaskRunner ThreadPool;
   GlobalCompilationDatabase::CommandChanged::Subscription CommandsChanged;
 };
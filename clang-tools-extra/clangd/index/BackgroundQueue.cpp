@@ -76,6 +76,7 @@ void BackgroundQueue::push(Task T) {
   {
     std::lock_guard<std::mutex> Lock(Mu);
     T.QueuePri = std::max(T.QueuePri, Boosts.lookup(T.Tag));
+    setDistance(T);
     Queue.push_back(std::move(T));
     std::push_heap(Queue.begin(), Queue.end());
     ++Stat.Enqueued;
@@ -87,8 +88,10 @@ void BackgroundQueue::push(Task T) {
 void BackgroundQueue::append(std::vector<Task> Tasks) {
   {
     std::lock_guard<std::mutex> Lock(Mu);
-    for (Task &T : Tasks)
+    for (Task &T : Tasks) {
       T.QueuePri = std::max(T.QueuePri, Boosts.lookup(T.Tag));
+      setDistance(T);
+    }
     std::move(Tasks.begin(), Tasks.end(), std::back_inserter(Queue));
     std::make_heap(Queue.begin(), Queue.end());
     Stat.Enqueued += Tasks.size();
@@ -116,6 +119,26 @@ void BackgroundQueue::boost(llvm::StringRef Tag, unsigned NewPriority) {
   // No need to signal, only rearranged items in the queue.
 }
 
+void BackgroundQueue::setProximity(const std::vector<std::string> &Files) {
+  std::lock_guard<std::mutex> Lock(Mu);
+  if (Files.empty()) {
+    Proximity.reset();
+  } else {
+    llvm::StringMap<SourceParams> Sources;
+    for (const std::string &File : Files)
+      Sources[File] = SourceParams();
+    Proximity.emplace(std::move(Sources));
+  }
+  for (Task &T : Queue)
+    setDistance(T);
+  std::make_heap(Queue.begin(), Queue.end());
+  // No need to signal, only rearranged items in the queue.
+}
+
+void BackgroundQueue::setDistance(Task &T) {
+  T.Distance = Proximity && !T.Path.empty() ? Proximity->distance(T.Path) : 0;
+}
+
 bool BackgroundQueue::blockUntilIdleForTest(
     llvm::Optional<double> TimeoutSeconds) {
   std::unique_lock<std::mutex> Lock(Mu);
@@ -35,6 +35,7 @@
 #include "llvm/Support/Error.h"
 #include "llvm/Support/Threading.h"
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
@@ -53,7 +54,10 @@ bool BackgroundIndexRebuilder::enoughTUsToRebuild() const {
   if (!ActiveVersion)                         // never built
     return IndexedTUs == TUsBeforeFirstBuild; // use low threshold
   // rebuild if we've reached the (higher) threshold
-  return IndexedTUs >= IndexedTUsAtLastRebuild + TUsBeforeRebuild;
+  unsigned Threshold =
+      std::max(TUsBeforeRebuild, (TotalLoadedShards + IndexedTUs) /
+                                     IndexFractionBeforeRebuild);
+  return IndexedTUs >= IndexedTUsAtLastRebuild + Threshold;
 }
 
 void BackgroundIndexRebuilder::indexedTU() {
@@ -85,6 +89,7 @@ void BackgroundIndexRebuilder::loadedShard(size_t ShardCount) {
   std::lock_guard<std::mutex> Lock(Mu);
   assert(Loading);
   LoadedShards += ShardCount;
+  TotalLoadedShards += ShardCount;
 }
 void BackgroundIndexRebuilder::doneLoading() {
   maybeRebuild("after loading index from disk", [this] {
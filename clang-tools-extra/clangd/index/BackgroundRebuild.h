@@ -73,6 +73,10 @@ public:
   // Thresholds for rebuilding as TUs get indexed. Exposed for testing.
   const unsigned TUsBeforeFirstBuild; // Typically one per worker thread.
   const unsigned TUsBeforeRebuild = 100;
+  // Each rebuild processes the whole index, so once the index is large, wait
+  // until 1/IndexFractionBeforeRebuild of its files have been indexed instead.
+  // This bounds the total rebuild work to a small multiple of the index size.
+  const unsigned IndexFractionBeforeRebuild = 10;
 
 private:
   // Run Check under the lock, and rebuild if it returns true.
@@ -91,6 +95,7 @@ private:
   // Are we loading shards? May be multiple concurrent sessions.
   unsigned Loading = 0;
   unsigned LoadedShards; // In the current loading session.
+  unsigned TotalLoadedShards = 0; // In all loading sessions.
 
   SwapIndex *Target;
   FileSymbols *Source;
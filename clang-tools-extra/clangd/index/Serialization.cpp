@@ -440,6 +440,68 @@ readCompileCommand(Reader CmdReader, llvm::ArrayRef<llvm::StringRef> Strings) {
   return Cmd;
 }
 
+// POSTING LISTS ENCODING
+// The posting lists that Dex builds for the symbols, ready to be used:
+//  - the slab position of the symbol with each DocID: count + varint each
+//  - the number of tokens: varint
+//  - for each token:
+//    - kind: 1 byte
+//    - data: varint length + bytes
+//    - chunks: count + (head: 4 bytes, payload: 28 bytes) each
+// Symbols are referred to by their position in the SymbolSlab, so the section
+// must be read with the symbols it was written with.
+
+void writePostingLists(const dex::StoredPostingLists &Lists,
+                       llvm::raw_ostream &OS) {
+  writeVar(Lists.Symbols.size(), OS);
+  for (uint32_t Position : Lists.Symbols)
+    writeVar(Position, OS);
+  writeVar(Lists.Lists.size(), OS);
+  for (const auto &List : Lists.Lists) {
+    OS.write(static_cast<uint8_t>(List.first.kind()));
+    writeVar(List.first.data().size(), OS);
+    OS << List.first.data();
+    writeVar(List.second.size(), OS);
+    for (const dex::Chunk &C : List.second) {
+      write32(C.Head, OS);
+      OS.write(reinterpret_cast<const char *>(C.Payload.data()),
+               C.Payload.size());
+    }
+  }
+}
+
+llvm::Optional<dex::StoredPostingLists> readPostingLists(Reader &Data) {
+  dex::StoredPostingLists Lists;
+  if (!Data.consumeSize(Lists.Symbols))
+    return llvm::None;
+  for (uint32_t &Position : Lists.Symbols)
+    Position = Data.consumeVar();
+  uint32_t NumTokens = Data.consumeVar();
+  if (NumTokens > Data.rest().size())
+    return llvm::None;
+  Lists.Lists.reserve(NumTokens);
+  for (uint32_t I = 0; I < NumTokens && !Data.err(); ++I) {
+    uint8_t Kind = Data.consume8();
+    if (Kind > static_cast<uint8_t>(dex::Token::Kind::Sentinel))
+      return llvm::None;
+    llvm::StringRef TokenData = Data.consume(Data.consumeVar());
+    std::vector<dex::Chunk> Chunks;
+    if (!Data.consumeSize(Chunks))
+      return llvm::None;
+    for (dex::Chunk &C : Chunks) {
+      C.Head = Data.consume32();
+      llvm::StringRef Payload = Data.consume(C.Payload.size());
+      std::copy(Payload.begin(), Payload.end(), C.Payload.begin());
+    }
+    Lists.Lists.emplace_back(
+        dex::Token(static_cast<dex::Token::Kind>(Kind), TokenData),
+        std::move(Chunks));
+  }
+  if (Data.err())
+    return llvm::None;
+  return std::move(Lists);
+}
+
 // FILE ENCODING
 // A file is a RIFF chunk with type 'CdIx'.
 // It contains the sections:
@@ -448,6 +510,7 @@ readCompileCommand(Reader CmdReader, llvm::ArrayRef<llvm::StringRef> Strings) {
 //   - stri: string table
 //   - symb: symbols
 //   - refs: references to symbols
+//   - dexp: Dex posting lists of the symbols (optional)
 
 // The current versioning scheme is simple - non-current versions are rejected.
 // If you make a breaking change, bump this version number to invalidate stored
@@ -541,6 +604,12 @@ llvm::Expected<IndexFileIn> readRIFF(llvm::StringRef Data) {
     for (llvm::StringRef C : Cmd.CommandLine)
       Result.Cmd->CommandLine.emplace_back(C);
   }
+  if (Chunks.count("dexp")) {
+    Reader PostingListsReader(Chunks.lookup("dexp"));
+    Result.PostingLists = readPostingLists(PostingListsReader);
+    if (!Result.PostingLists)
+      return error("malformed or truncated posting lists");
+  }
   return std::move(Result);
 }
 
@@ -663,6 +732,16 @@ void writeRIFF(const IndexFileOut &Data, llvm::raw_ostream &OS) {
     RIFF.Chunks.push_back({riff::fourCC("cmdl"), CmdlSection});
   }
 
+  std::string PostingListsSection;
+  if (Data.PostingLists) {
+    {
+      llvm::raw_string_ostream PostingListsOS(PostingListsSection);
+      writePostingLists(dex::Dex::buildPostingLists(*Data.Symbols),
+                        PostingListsOS);
+    }
+    RIFF.Chunks.push_back({riff::fourCC("dexp"), PostingListsSection});
+  }
+
   OS << RIFF;
 }
 
@@ -707,6 +786,7 @@ std::unique_ptr<SymbolIndex> loadIndex(llvm::StringRef SymbolFilename,
   SymbolSlab Symbols;
   RefSlab Refs;
   RelationSlab Relations;
+  llvm::Optional<dex::StoredPostingLists> PostingLists;
   {
     trace::Span Tracer("ParseIndex");
     if (auto I = readIndexFile(Buffer->get()->getBuffer())) {
@@ -716,6 +796,8 @@ std::unique_ptr<SymbolIndex> loadIndex(llvm::StringRef SymbolFilename,
         Refs = std::move(*I->Refs);
       if (I->Relations)
         Relations = std::move(*I->Relations);
+      if (I->PostingLists)
+        PostingLists = std::move(*I->PostingLists);
     } else {
       elog("Bad index file: {0}", I.takeError());
       return nullptr;
@@ -727,10 +809,16 @@ std::unique_ptr<SymbolIndex> loadIndex(llvm::StringRef SymbolFilename,
   size_t NumRelations = Relations.size();
 
   trace::Span Tracer("BuildIndex");
-  auto Index = UseDex ? dex::Dex::build(std::move(Symbols), std::move(Refs),
-                                        std::move(Relations))
-                      : MemIndex::build(std::move(Symbols), std::move(Refs),
-                                        std::move(Relations));
+  std::unique_ptr<SymbolIndex> Index;
+  if (!UseDex)
+    Index = MemIndex::build(std::move(Symbols), std::move(Refs),
+                            std::move(Relations));
+  else if (PostingLists)
+    Index = dex::Dex::build(std::move(Symbols), std::move(Refs),
+                            std::move(Relations), std::move(*PostingLists));
+  else
+    Index = dex::Dex::build(std::move(Symbols), std::move(Refs),
+                            std::move(Relations));
   vlog("Loaded {0} from {1} with estimated memory usage {2} bytes\n"
        "  - number of symbols: {3}\n"
        "  - number of refs: {4}\n"
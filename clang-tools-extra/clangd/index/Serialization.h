@@ -27,6 +27,7 @@
 #include "Headers.h"
 #include "Index.h"
 #include "index/Symbol.h"
+#include "index/dex/PostingList.h"
 #include "clang/Tooling/CompilationDatabase.h"
 #include "llvm/Support/Error.h"
 
@@ -47,6 +48,8 @@ struct IndexFileIn {
   llvm::Optional<IncludeGraph> Sources;
   // This contains only the Directory and CommandLine.
   llvm::Optional<tooling::CompileCommand> Cmd;
+  // The Dex posting lists of the symbols, if they were stored.
+  llvm::Optional<dex::StoredPostingLists> PostingLists;
 };
 // Parse an index file. The input must be a RIFF or YAML file.
 llvm::Expected<IndexFileIn> readIndexFile(llvm::StringRef);
@@ -58,9 +61,11 @@ struct IndexFileOut {
   const RelationSlab *Relations = nullptr;
   // Keys are URIs of the source files.
   const IncludeGraph *Sources = nullptr;
-  // TODO: Support serializing Dex posting lists.
   IndexFileFormat Format = IndexFileFormat::RIFF;
   const tooling::CompileCommand *Cmd = nullptr;
+  // Whether to store the Dex posting lists of the symbols, so that loading the
+  // index doesn't have to build them again. Only supported by RIFF.
+  bool PostingLists = false;
 
   IndexFileOut() = default;
   IndexFileOut(const IndexFileIn &I)
@@ -68,7 +73,8 @@ struct IndexFileOut {
         Refs(I.Refs ? I.Refs.getPointer() : nullptr),
         Relations(I.Relations ? I.Relations.getPointer() : nullptr),
         Sources(I.Sources ? I.Sources.getPointer() : nullptr),
-        Cmd(I.Cmd ? I.Cmd.getPointer() : nullptr) {}
+        Cmd(I.Cmd ? I.Cmd.getPointer() : nullptr),
+        PostingLists(I.PostingLists.hasValue()) {}
 };
 // Serializes an index file.
 llvm::raw_ostream &operator<<(llvm::raw_ostream &OS, const IndexFileOut &O);
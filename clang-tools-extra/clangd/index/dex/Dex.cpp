@@ -14,6 +14,7 @@
 #include "index/dex/Iterator.h"
 #include "support/Logger.h"
 #include "support/Trace.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Support/ScopedPrinter.h"
 #include <algorithm>
@@ -33,6 +34,62 @@ std::unique_ptr<SymbolIndex> Dex::build(SymbolSlab Symbols, RefSlab Refs,
                                 Size);
 }
 
+std::unique_ptr<SymbolIndex> Dex::build(SymbolSlab Symbols, RefSlab Refs,
+                                        RelationSlab Rels,
+                                        StoredPostingLists Lists) {
+  trace::Span Tracer("DexLoadPostingLists");
+  // The stored posting lists come from an index file: check that they match
+  // the symbols before trusting them.
+  size_t NumSymbols = Symbols.size();
+  bool Valid = Lists.Symbols.size() == NumSymbols;
+  std::vector<const Symbol *> SortedSymbols;
+  if (Valid) {
+    SortedSymbols.reserve(NumSymbols);
+    llvm::BitVector Seen(NumSymbols);
+    for (uint32_t Position : Lists.Symbols) {
+      if (Position >= NumSymbols || Seen[Position]) {
+        Valid = false;
+        break;
+      }
+      Seen.set(Position);
+      SortedSymbols.push_back(&*(Symbols.begin() + Position));
+    }
+  }
+  using TokenInfo = llvm::DenseMapInfo<Token>;
+  llvm::DenseMap<Token, PostingList> InvertedIndex(Lists.Lists.size());
+  for (auto &List : Lists.Lists) {
+    if (!Valid)
+      break;
+    Valid = !TokenInfo::isEqual(List.first, TokenInfo::getEmptyKey()) &&
+            !TokenInfo::isEqual(List.first, TokenInfo::getTombstoneKey()) &&
+            PostingList::validChunks(List.second, NumSymbols);
+    InvertedIndex.try_emplace(std::move(List.first), std::move(List.second));
+  }
+  if (!Valid) {
+    elog("Stored posting lists don't match the symbols, building them again");
+    return build(std::move(Symbols), std::move(Refs), std::move(Rels));
+  }
+
+  auto Size = Symbols.bytes() + Refs.bytes();
+  auto Data = std::make_pair(std::move(Symbols), std::move(Refs));
+  auto Index = std::make_unique<Dex>(llvm::ArrayRef<Symbol>(), Data.second,
+                                     Rels, std::move(Data), Size);
+  Index->useIndex(std::move(SortedSymbols), std::move(InvertedIndex));
+  return std::move(Index);
+}
+
+StoredPostingLists Dex::buildPostingLists(const SymbolSlab &Symbols) {
+  Dex Index(Symbols, RefSlab(), RelationSlab());
+  StoredPostingLists Result;
+  Result.Symbols.reserve(Index.Symbols.size());
+  for (const Symbol *Sym : Index.Symbols)
+    Result.Symbols.push_back(Sym - &*Symbols.begin());
+  Result.Lists.reserve(Index.InvertedIndex.size());
+  for (const auto &List : Index.InvertedIndex)
+    Result.Lists.emplace_back(List.first, List.second.chunks().vec());
+  return Result;
+}
+
 namespace {
 
 // Mark symbols which are can be used for code completion.
@@ -125,6 +182,19 @@ void Dex::buildIndex() {
   InvertedIndex = Builder.build();
 }
 
+void Dex::useIndex(std::vector<const Symbol *> Symbols,
+                   llvm::DenseMap<Token, PostingList> InvertedIndex) {
+  this->Symbols = std::move(Symbols);
+  this->Corpus = dex::Corpus(this->Symbols.size());
+  SymbolQuality.resize(this->Symbols.size());
+  for (size_t I = 0; I < this->Symbols.size(); ++I) {
+    const Symbol *Sym = this->Symbols[I];
+    LookupTable[Sym->ID] = Sym;
+    SymbolQuality[I] = quality(*Sym);
+  }
+  this->InvertedIndex = std::move(InvertedIndex);
+}
+
 std::unique_ptr<Iterator> Dex::iterator(const Token &Tok) const {
   auto It = InvertedIndex.find(Tok);
   return It == InvertedIndex.end() ? Corpus.none()
@@ -34,11 +34,9 @@ namespace clangd {
 namespace dex {
 
 /// In-memory Dex trigram-based index implementation.
-// FIXME(kbobyrev): Introduce serialization and deserialization of the symbol
-// index so that it can be loaded from the disk. Since static index is not
-// changed frequently, it's safe to assume that it has to be built only once
-// (when the clangd process starts). Therefore, it can be easier to store built
-// index on disk and then load it if available.
+/// The posting lists can be stored in the index file along with the symbols
+/// (see StoredPostingLists), so that loading a static index doesn't have to
+/// build them again.
 class Dex : public SymbolIndex {
 public:
   // All data must outlive this index.
@@ -69,6 +67,15 @@ public:
 
   /// Builds an index from slabs. The index takes ownership of the slab.
   static std::unique_ptr<SymbolIndex> build(SymbolSlab, RefSlab, RelationSlab);
+  /// Builds an index from slabs and the posting lists that were stored for
+  /// the symbols, instead of building them again. Falls back to building them
+  /// if they don't match the symbols.
+  static std::unique_ptr<SymbolIndex> build(SymbolSlab, RefSlab, RelationSlab,
+                                            StoredPostingLists);
+
+  /// Returns the posting lists of an index of \p Symbols, to be stored with
+  /// the symbols.
+  static StoredPostingLists buildPostingLists(const SymbolSlab &Symbols);
 
   bool
   fuzzyFind(const FuzzyFindRequest &Req,
@@ -88,6 +95,10 @@ public:
 
 private:
   void buildIndex();
+  /// Uses \p InvertedIndex for \p Symbols, sorted by DocID, instead of
+  /// building it.
+  void useIndex(std::vector<const Symbol *> Symbols,
+                llvm::DenseMap<Token, PostingList> InvertedIndex);
   std::unique_ptr<Iterator> iterator(const Token &Tok) const;
   std::unique_ptr<Iterator>
   createFileProximityIterator(llvm::ArrayRef<std::string> ProximityPaths) const;
@@ -93,25 +93,29 @@ private:
     if (ReachedEnd)
       return;
     auto SyncID = Children.front()->peek();
-    // Indicates whether any child needs to be advanced to new SyncID.
-    bool NeedsAdvance = false;
-    do {
-      NeedsAdvance = false;
-      for (auto &Child : Children) {
-        Child->advanceTo(SyncID);
-        ReachedEnd |= Child->reachedEnd();
-        // If any child reaches end And iterator can not match any other items.
-        // In this case, just terminate the process.
-        if (ReachedEnd)
-          return;
-        // If any child goes beyond given ID (i.e. ID is not the common item),
-        // all children should be advanced to the next common item.
-        if (Child->peek() > SyncID) {
-          SyncID = Child->peek();
-          NeedsAdvance = true;
-        }
+    // Advance the children in turn, wrapping around, until all of them point
+    // to SyncID. Agreeing counts the children visited last which point to
+    // SyncID: a child that goes beyond it only restarts the count, instead of
+    // advancing all the children from the front again.
+    size_t Agreeing = 1;
+    for (size_t I = 1; Agreeing < Children.size();
+         I = I + 1 == Children.size() ? 0 : I + 1) {
+      auto &Child = Children[I];
+      Child->advanceTo(SyncID);
+      ReachedEnd |= Child->reachedEnd();
+      // If any child reaches end And iterator can not match any other items.
+      // In this case, just terminate the process.
+      if (ReachedEnd)
+        return;
+      // If any child goes beyond given ID (i.e. ID is not the common item),
+      // all children should be advanced to the next common item.
+      if (Child->peek() > SyncID) {
+        SyncID = Child->peek();
+        Agreeing = 1;
+      } else {
+        ++Agreeing;
       }
-    } while (NeedsAdvance);
+    }
   }
 
   /// AndIterator owns its children and ensures that all of them point to the
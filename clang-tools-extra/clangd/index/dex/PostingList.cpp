@@ -18,6 +18,32 @@ namespace clangd {
 namespace dex {
 namespace {
 
+static constexpr size_t BitsPerEncodingByte = 7;
+
+/// Decodes the DocIDs of \p C into \p Out. This is the inner loop of the
+/// posting list iterators; most deltas fit in a single byte, which skips the
+/// loop over continuation bytes.
+void decodeChunk(const Chunk &C, llvm::SmallVectorImpl<DocID> &Out) {
+  Out.clear();
+  DocID Current = C.Head;
+  Out.push_back(Current);
+  const uint8_t *Byte = C.Payload.data();
+  const uint8_t *End = Byte + C.Payload.size();
+  // A zero byte terminates the stream, as 0 is not a valid delta.
+  while (Byte != End && *Byte != 0) {
+    uint8_t Encoding = *Byte++;
+    DocID Delta = Encoding & 0x7f;
+    for (unsigned Shift = BitsPerEncodingByte; (Encoding & 0x80) && Byte != End;
+         Shift += BitsPerEncodingByte) {
+      assert(Shift < 32 && "Malformed VByte encoding sequence.");
+      Encoding = *Byte++;
+      Delta |= DocID(Encoding & 0x7f) << Shift;
+    }
+    Current += Delta;
+    Out.push_back(Current);
+  }
+}
+
 /// Implements iterator of PostingList chunks. This requires iterating over two
 /// levels: the first level iterator iterates over the chunks and decompresses
 /// them on-the-fly when the contents of chunk are to be seen.
@@ -26,7 +52,7 @@ public:
   explicit ChunkIterator(const Token *Tok, llvm::ArrayRef<Chunk> Chunks)
       : Tok(Tok), Chunks(Chunks), CurrentChunk(Chunks.begin()) {
     if (!Chunks.empty()) {
-      DecompressedChunk = CurrentChunk->decompress();
+      decodeChunk(*CurrentChunk, DecompressedChunk);
       CurrentID = DecompressedChunk.begin();
     }
   }
@@ -94,7 +120,7 @@ private:
     ++CurrentChunk;
     if (CurrentChunk == Chunks.end()) // Reached the end of PostingList.
       return;
-    DecompressedChunk = CurrentChunk->decompress();
+    decodeChunk(*CurrentChunk, DecompressedChunk);
     CurrentID = DecompressedChunk.begin();
   }
 
@@ -102,11 +128,23 @@ private:
   void advanceToChunk(DocID ID) {
     if ((CurrentChunk != Chunks.end() - 1) &&
         ((CurrentChunk + 1)->Head <= ID)) {
+      // Intersections mostly advance by short distances, so gallop: probe the
+      // chunks at exponentially growing distances, and only binary search
+      // between the last two probes. Low->Head <= ID holds throughout.
+      auto Low = CurrentChunk + 1;
+      size_t Step = 1;
+      while (size_t(Chunks.end() - Low) > Step && (Low + Step)->Head <= ID) {
+        Low += Step;
+        Step *= 2;
+      }
+      auto High =
+          size_t(Chunks.end() - Low) > Step ? Low + Step : Chunks.end();
+      // Find the last chunk which starts at or before ID.
       CurrentChunk =
-          std::partition_point(CurrentChunk + 1, Chunks.end(),
-                               [&](const Chunk &C) { return C.Head < ID; });
-      --CurrentChunk;
-      DecompressedChunk = CurrentChunk->decompress();
+          std::partition_point(Low + 1, High,
+                               [&](const Chunk &C) { return C.Head <= ID; }) -
+          1;
+      decodeChunk(*CurrentChunk, DecompressedChunk);
       CurrentID = DecompressedChunk.begin();
     }
   }
@@ -125,8 +163,6 @@ private:
   static constexpr size_t ApproxEntriesPerChunk = 15;
 };
 
-static constexpr size_t BitsPerEncodingByte = 7;
-
 /// Writes a variable length DocID into the buffer and updates the buffer size.
 /// If it doesn't fit, returns false and doesn't write to the buffer.
 bool encodeVByte(DocID Delta, llvm::MutableArrayRef<uint8_t> &Payload) {
@@ -182,43 +218,46 @@ std::vector<Chunk> encodeStream(llvm::ArrayRef<DocID> Documents) {
   return std::vector<Chunk>(Result); // no move, shrink-to-fit
 }
 
-/// Reads variable length DocID from the buffer and updates the buffer size. If
-/// the stream is terminated, return None.
-llvm::Optional<DocID> readVByte(llvm::ArrayRef<uint8_t> &Bytes) {
-  if (Bytes.front() == 0 || Bytes.empty())
-    return None;
-  DocID Result = 0;
-  bool HasNextByte = true;
-  for (size_t Length = 0; HasNextByte && !Bytes.empty(); ++Length) {
-    assert(Length <= 5 && "Malformed VByte encoding sequence.");
-    // Write meaningful bits to the correct place in the document decoding.
-    Result |= (Bytes.front() & 0x7f) << (BitsPerEncodingByte * Length);
-    if ((Bytes.front() & 0x80) == 0)
-      HasNextByte = false;
-    Bytes = Bytes.drop_front();
-  }
-  return Result;
-}
-
 } // namespace
 
 llvm::SmallVector<DocID, Chunk::PayloadSize + 1> Chunk::decompress() const {
-  llvm::SmallVector<DocID, Chunk::PayloadSize + 1> Result{Head};
-  llvm::ArrayRef<uint8_t> Bytes(Payload);
-  DocID Delta;
-  for (DocID Current = Head; !Bytes.empty(); Current += Delta) {
-    auto MaybeDelta = readVByte(Bytes);
-    if (!MaybeDelta)
-      break;
-    Delta = *MaybeDelta;
-    Result.push_back(Current + Delta);
-  }
-  return llvm::SmallVector<DocID, Chunk::PayloadSize + 1>{Result};
+  llvm::SmallVector<DocID, Chunk::PayloadSize + 1> Result;
+  decodeChunk(*this, Result);
+  return Result;
 }
 
 PostingList::PostingList(llvm::ArrayRef<DocID> Documents)
     : Chunks(encodeStream(Documents)) {}
 
+PostingList::PostingList(std::vector<Chunk> Chunks)
+    : Chunks(std::move(Chunks)) {}
+
+bool PostingList::validChunks(llvm::ArrayRef<Chunk> Chunks, DocID Limit) {
+  if (Chunks.empty())
+    return false;
+  // The first DocID of each chunk must follow the last one of the previous.
+  DocID Next = 0;
+  for (const Chunk &C : Chunks) {
+    // Chunk::decompress() expects each delta to fit in 5 bytes, the last of
+    // which only has 4 bits.
+    unsigned Length = 0;
+    for (uint8_t Byte : C.Payload) {
+      if (Length == 0 && Byte == 0)
+        break;
+      if (++Length == 5 && Byte > 0x0f)
+        return false;
+      if (!(Byte & 0x80))
+        Length = 0;
+    }
+    for (DocID Doc : C.decompress()) {
+      if (Doc < Next || Doc >= Limit)
+        return false;
+      Next = Doc + 1;
+    }
+  }
+  return true;
+}
+
 std::unique_ptr<Iterator> PostingList::iterator(const Token *Tok) const {
   return std::make_unique<ChunkIterator>(Tok, Chunks);
 }
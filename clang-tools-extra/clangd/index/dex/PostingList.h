@@ -24,6 +24,7 @@
 #define LLVM_CLANG_TOOLS_EXTRA_CLANGD_INDEX_DEX_POSTINGLIST_H
 
 #include "Iterator.h"
+#include "Token.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallVector.h"
 #include <cstdint>
@@ -32,7 +33,6 @@
 namespace clang {
 namespace clangd {
 namespace dex {
-class Token;
 
 /// NOTE: This is an implementation detail.
 ///
@@ -59,6 +59,14 @@ static_assert(sizeof(Chunk) == 32, "Chunk should take 32 bytes of memory.");
 class PostingList {
 public:
   explicit PostingList(llvm::ArrayRef<DocID> Documents);
+  /// Constructs a posting list from the chunks of another one, e.g. stored in
+  /// an index file. Chunks that were not checked with validChunks() must come
+  /// from a PostingList.
+  explicit PostingList(std::vector<Chunk> Chunks);
+
+  /// Returns true if \p Chunks encode increasing DocIDs smaller than \p Limit,
+  /// like the chunks of a PostingList do.
+  static bool validChunks(llvm::ArrayRef<Chunk> Chunks, DocID Limit);
 
   /// Constructs DocumentIterator over given posting list. DocumentIterator will
   /// go through the chunks and decompress them on-the-fly when necessary.
@@ -68,10 +76,21 @@ public:
   /// Returns in-memory size of external storage.
   size_t bytes() const { return Chunks.capacity() * sizeof(Chunk); }
 
+  llvm::ArrayRef<Chunk> chunks() const { return Chunks; }
+
 private:
   const std::vector<Chunk> Chunks;
 };
 
+/// The posting lists of a Dex index in their compressed form, as stored in
+/// index files so that loading an index doesn't have to build them again.
+struct StoredPostingLists {
+  /// The symbol with DocID I is at position Symbols[I] in the SymbolSlab.
+  std::vector<uint32_t> Symbols;
+  /// The chunks of the posting list of each token.
+  std::vector<std::pair<Token, std::vector<Chunk>>> Lists;
+};
+
 } // namespace dex
 } // namespace clangd
 } // namespace clang
@@ -15,13 +15,19 @@
 #include "support/Logger.h"
 #include "support/Trace.h"
 #include "clang/Basic/Version.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 namespace clang {
 namespace clangd {
@@ -58,16 +64,110 @@ class IndexClient : public clangd::SymbolIndex {
       remote::v1::SymbolIndex::Stub::*)(grpc::ClientContext *,
                                         const RequestT &);
 
+  /// The replies to a request, kept for CacheTTL after it completes.
+  /// Identical requests made while it is in flight wait for its replies.
+  struct CacheEntry {
+    bool InFlight = true;
+    bool FinalResult = false;
+    std::vector<std::string> SerializedReplies;
+    std::chrono::steady_clock::time_point Expiry;
+  };
+
+  /// If the replies to \p Key are cached, or will be once an identical request
+  /// in flight completes, returns them. Otherwise, returns None and marks the
+  /// request as in flight if there is room in the cache.
+  llvm::Optional<CacheEntry> lookupCache(const std::string &Key) const {
+    std::unique_lock<std::mutex> Lock(CacheMutex);
+    while (true) {
+      auto It = Cache.find(Key);
+      if (It == Cache.end())
+        break;
+      if (It->second.InFlight) {
+        CacheCV.wait(Lock);
+        continue; // The request may have failed and been erased.
+      }
+      if (It->second.Expiry > std::chrono::steady_clock::now())
+        return It->second;
+      Cache.erase(It);
+      break;
+    }
+    if (Cache.size() >= MaxCacheEntries) {
+      auto Now = std::chrono::steady_clock::now();
+      for (auto It = Cache.begin(); It != Cache.end();) {
+        auto Next = std::next(It);
+        if (!It->second.InFlight && It->second.Expiry <= Now)
+          Cache.erase(It);
+        It = Next;
+      }
+    }
+    if (Cache.size() < MaxCacheEntries)
+      Cache.try_emplace(Key);
+    return llvm::None;
+  }
+
+  /// Stores the replies to the request in flight for \p Key, or forgets it if
+  /// it failed, and wakes up the identical requests waiting for it.
+  void updateCache(const std::string &Key, bool Succeeded,
+                   CacheEntry Result) const {
+    {
+      std::lock_guard<std::mutex> Lock(CacheMutex);
+      auto It = Cache.find(Key);
+      if (It != Cache.end()) {
+        if (Succeeded) {
+          Result.InFlight = false;
+          Result.Expiry = std::chrono::steady_clock::now() + CacheTTL;
+          It->second = std::move(Result);
+        } else {
+          Cache.erase(It);
+        }
+      }
+    }
+    CacheCV.notify_all();
+  }
+
   template <typename RequestT, typename ReplyT, typename ClangdRequestT,
             typename CallbackT>
   bool streamRPC(ClangdRequestT Request,
                  StreamingCall<RequestT, ReplyT> RPCCall,
                  CallbackT Callback) const {
     updateConnectionStatus();
-    bool FinalResult = false;
     trace::Span Tracer(RequestT::descriptor()->name());
     const auto RPCRequest = ProtobufMarshaller->toProtobuf(Request);
     SPAN_ATTACH(Tracer, "Request", RPCRequest.DebugString());
+    unsigned Successful = 0;
+    unsigned FailedToParse = 0;
+    auto HandleReply = [&](const ReplyT &Reply) {
+      auto Response = ProtobufMarshaller->fromProtobuf(Reply.stream_result());
+      if (!Response) {
+        elog("Received invalid {0}: {1}. Reason: {2}",
+             ReplyT::descriptor()->name(), Reply.stream_result().DebugString(),
+             Response.takeError());
+        ++FailedToParse;
+        return;
+      }
+      Callback(*Response);
+      ++Successful;
+    };
+
+    // Repeated requests, e.g. hovering the same symbol twice, are answered
+    // from the cache to save a round trip.
+    std::string CacheKey = RequestT::descriptor()->name();
+    CacheKey += ':';
+    CacheKey += RPCRequest.SerializeAsString();
+    if (llvm::Optional<CacheEntry> Cached = lookupCache(CacheKey)) {
+      for (const std::string &Serialized : Cached->SerializedReplies) {
+        ReplyT Reply;
+        if (Reply.ParseFromString(Serialized))
+          HandleReply(Reply);
+      }
+      vlog("Remote index [{0}]: {1} => {2} cached results.", ServerAddress,
+           RequestT::descriptor()->name(), Successful);
+      SPAN_ATTACH(Tracer, "Cached", true);
+      SPAN_ATTACH(Tracer, "Successful", Successful);
+      return Cached->FinalResult;
+    }
+
+    CacheEntry Result;
     grpc::ClientContext Context;
     Context.AddMetadata("version", clang::getClangToolFullVersion("clangd"));
     std::chrono::system_clock::time_point StartTime =
@@ -78,30 +178,23 @@ class IndexClient : public clangd::SymbolIndex {
     dlog("Sending {0}: {1}", RequestT::descriptor()->name(),
          RPCRequest.DebugString());
     ReplyT Reply;
-    unsigned Successful = 0;
-    unsigned FailedToParse = 0;
     while (Reader->Read(&Reply)) {
       if (!Reply.has_stream_result()) {
-        FinalResult = Reply.final_result().has_more();
-        continue;
-      }
-      auto Response = ProtobufMarshaller->fromProtobuf(Reply.stream_result());
-      if (!Response) {
-        elog("Received invalid {0}: {1}. Reason: {2}",
-             ReplyT::descriptor()->name(), Reply.stream_result().DebugString(),
-             Response.takeError());
-        ++FailedToParse;
+        Result.FinalResult = Reply.final_result().has_more();
         continue;
       }
-      Callback(*Response);
-      ++Successful;
+      Result.SerializedReplies.push_back(Reply.SerializeAsString());
+      HandleReply(Reply);
     }
     auto Millis = std::chrono::duration_cast<std::chrono::milliseconds>(
                       std::chrono::system_clock::now() - StartTime)
                       .count();
     vlog("Remote index [{0}]: {1} => {2} results in {3}ms.", ServerAddress,
          RequestT::descriptor()->name(), Successful, Millis);
-    SPAN_ATTACH(Tracer, "Status", Reader->Finish().ok());
+    bool FinalResult = Result.FinalResult;
+    bool Succeeded = Reader->Finish().ok();
+    updateCache(CacheKey, Succeeded, std::move(Result));
+    SPAN_ATTACH(Tracer, "Status", Succeeded);
     SPAN_ATTACH(Tracer, "Successful", Successful);
     SPAN_ATTACH(Tracer, "Failed to parse", FailedToParse);
     updateConnectionStatus();
@@ -164,14 +257,27 @@ private:
   std::unique_ptr<Marshaller> ProtobufMarshaller;
   // Each request will be terminated if it takes too long.
   std::chrono::milliseconds DeadlineWaitingTime;
+  // Replies are reused for this long. The remote index is a snapshot that is
+  // reloaded rarely, so this mostly trades memory for latency.
+  static constexpr std::chrono::seconds CacheTTL = std::chrono::seconds(30);
+  static constexpr size_t MaxCacheEntries = 1000;
+  mutable std::mutex CacheMutex;
+  mutable std::condition_variable CacheCV;
+  mutable llvm::StringMap<CacheEntry> Cache; /* GUARDED_BY(CacheMutex) */
 };
 
+constexpr std::chrono::seconds IndexClient::CacheTTL;
+constexpr size_t IndexClient::MaxCacheEntries;
+
 } // namespace
 
 std::unique_ptr<clangd::SymbolIndex> getClient(llvm::StringRef Address,
                                                llvm::StringRef ProjectRoot) {
-  const auto Channel =
-      grpc::CreateChannel(Address.str(), grpc::InsecureChannelCredentials());
+  grpc::ChannelArguments Args;
+  // Most of the traffic is symbol names and paths, which compress well.
+  Args.SetCompressionAlgorithm(GRPC_COMPRESS_GZIP);
+  const auto Channel = grpc::CreateCustomChannel(
+      Address.str(), grpc::InsecureChannelCredentials(), Args);
   return std::unique_ptr<clangd::SymbolIndex>(
       new IndexClient(Channel, Address, ProjectRoot));
 }
@@ -10,6 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "SourceCode.h"
+#include "URI.h"
+#include "index/Background.h"
+#include "index/FileIndex.h"
 #include "index/IndexAction.h"
 #include "index/Merge.h"
 #include "index/Ref.h"
@@ -17,12 +21,18 @@
 #include "index/Symbol.h"
 #include "index/SymbolCollector.h"
 #include "support/Logger.h"
+#include "clang/Frontend/CompilerInvocation.h"
 #include "clang/Tooling/ArgumentsAdjusters.h"
 #include "clang/Tooling/CommonOptionsParser.h"
 #include "clang/Tooling/Execution.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
 
 namespace clang {
 namespace clangd {
@@ -36,14 +46,142 @@ static llvm::cl::opt<IndexFileFormat>
                                        "binary RIFF format")),
            llvm::cl::init(IndexFileFormat::RIFF));
 
+static llvm::cl::opt<std::string> ShardRoot(
+    "shard-root",
+    llvm::cl::desc(
+        "Also store the index as per-file shards in "
+        "<shard-root>/.cache/clangd/index as TUs are indexed, and skip the TUs "
+        "whose files haven't changed since their shards were written. Compile "
+        "flags aren't compared, remove the shards after changing them."),
+    llvm::cl::init(""));
+
+// Returns the direct includes of the files in the include graph, as paths.
+std::vector<std::string> directIncludes(const IncludeGraph &IG) {
+  std::vector<std::string> Includes;
+  for (const auto &Node : IG) {
+    for (llvm::StringRef Include : Node.getValue().DirectIncludes) {
+      if (auto Path = URI::resolve(Include))
+        Includes.push_back(std::move(*Path));
+      else
+        elog("Failed to resolve URI {0}: {1}", Include, Path.takeError());
+    }
+  }
+  return Includes;
+}
+
+// Whether the stored shards of MainFile and of the files it includes,
+// transitively, were written for the current contents of these files.
+bool isUpToDate(const BackgroundIndexStorage &Storage, PathRef MainFile) {
+  std::vector<std::string> Worklist = {MainFile.str()};
+  llvm::StringSet<> Seen = {MainFile};
+  while (!Worklist.empty()) {
+    std::string Path = Worklist.back();
+    Worklist.pop_back();
+    auto Shard = Storage.loadShard(Path);
+    if (!Shard || !Shard->Sources)
+      return false;
+    auto Node = Shard->Sources->find(URI::create(Path).toString());
+    auto Buffer = llvm::MemoryBuffer::getFile(Path);
+    if (Node == Shard->Sources->end() || !Buffer ||
+        Node->getValue().Digest != digest((*Buffer)->getBuffer()))
+      return false;
+    for (std::string &Include : directIncludes(*Shard->Sources))
+      if (Seen.insert(Include).second)
+        Worklist.push_back(std::move(Include));
+  }
+  return true;
+}
+
+// Loads the shards of MainFiles and of the files they include, transitively,
+// and merges them. The shards are read in parallel.
+IndexFileIn mergeShards(const BackgroundIndexStorage &Storage,
+                        llvm::ArrayRef<std::string> MainFiles) {
+  std::mutex Mu;
+  llvm::StringSet<> Seen;
+  SymbolSlab::Builder Symbols;
+  RefSlab::Builder Refs;
+  RelationSlab::Builder Relations;
+  llvm::ThreadPool Pool;
+  std::function<void(std::string)> Load = [&](std::string Path) {
+    auto Shard = Storage.loadShard(Path);
+    if (!Shard) {
+      elog("Missing index shard for {0}", Path);
+      return;
+    }
+    std::vector<std::string> Includes;
+    if (Shard->Sources)
+      Includes = directIncludes(*Shard->Sources);
+    std::lock_guard<std::mutex> Lock(Mu);
+    if (Shard->Symbols)
+      for (const auto &Sym : *Shard->Symbols) {
+        if (const auto *Existing = Symbols.find(Sym.ID))
+          Symbols.insert(mergeSymbol(*Existing, Sym));
+        else
+          Symbols.insert(Sym);
+      }
+    if (Shard->Refs)
+      for (const auto &Sym : *Shard->Refs)
+        for (const auto &Ref : Sym.second)
+          Refs.insert(Sym.first, Ref);
+    if (Shard->Relations)
+      for (const auto &R : *Shard->Relations)
+        Relations.insert(R);
+    for (std::string &Include : Includes)
+      if (Seen.insert(Include).second)
+        Pool.async(Load, std::move(Include));
+  };
+  {
+    std::lock_guard<std::mutex> Lock(Mu);
+    for (const std::string &MainFile : MainFiles)
+      if (Seen.insert(MainFile).second)
+        Pool.async(Load, MainFile);
+  }
+  Pool.wait();
+
+  IndexFileIn Result;
+  Result.Symbols = std::move(Symbols).build();
+  Result.Refs = std::move(Refs).build();
+  Result.Relations = std::move(Relations).build();
+  return Result;
+}
+
 class IndexActionFactory : public tooling::FrontendActionFactory {
 public:
-  IndexActionFactory(IndexFileIn &Result) : Result(Result) {}
+  IndexActionFactory(IndexFileIn &Result,
+                     const BackgroundIndexStorage *Storage = nullptr)
+      : Result(Result), Storage(Storage) {}
+
+  // With shards, skips the TUs whose shards are up to date.
+  bool runInvocation(std::shared_ptr<CompilerInvocation> Invocation,
+                     FileManager *Files,
+                     std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+                     DiagnosticConsumer *DiagConsumer) override {
+    if (Storage && Invocation->getFrontendOpts().Inputs.size() == 1) {
+      llvm::SmallString<256> MainFile(
+          Invocation->getFrontendOpts().Inputs[0].getFile());
+      llvm::sys::fs::make_absolute(MainFile);
+      llvm::sys::path::remove_dots(MainFile, /*remove_dot_dot=*/true);
+      {
+        std::lock_guard<std::mutex> Lock(MainFilesMu);
+        MainFiles.push_back(std::string(MainFile));
+      }
+      if (isUpToDate(*Storage, MainFile)) {
+        vlog("Skipping {0}, its shards are up to date", MainFile);
+        return true;
+      }
+    }
+    return FrontendActionFactory::runInvocation(
+        std::move(Invocation), Files, std::move(PCHContainerOps), DiagConsumer);
+  }
 
   std::unique_ptr<FrontendAction> create() override {
+    // With shards, the results of each TU are stored rather than merged, in
+    // the shards of the files it is the first to see.
+    auto TUIndex = std::make_shared<IndexFileIn>();
+    auto TUFiles = std::make_shared<llvm::StringSet<>>();
     SymbolCollector::Options Opts;
     Opts.CountReferences = true;
-    Opts.FileFilter = [&](const SourceManager &SM, FileID FID) {
+    Opts.FileFilter = [this, TUFiles](const SourceManager &SM, FileID FID) {
       const auto *F = SM.getFileEntryForID(FID);
       if (!F)
         return false; // Skip invalid files.
@@ -51,11 +189,39 @@ public:
       if (!AbsPath)
         return false; // Skip files without absolute path.
       std::lock_guard<std::mutex> Lock(FilesMu);
-      return Files.insert(*AbsPath).second; // Skip already processed files.
+      if (!Files.insert(*AbsPath).second)
+        return false; // Skip already processed files.
+      if (Storage)
+        TUFiles->insert(*AbsPath);
+      return true;
     };
+    std::function<void(IncludeGraph)> IncludeGraphCallback;
+    if (Storage)
+      IncludeGraphCallback = [this, TUIndex, TUFiles](IncludeGraph IG) {
+        // This is called last, once the slabs of the TU are set.
+        TUIndex->Sources = std::move(IG);
+        FileShardedIndex ShardedIndex(std::move(*TUIndex));
+        for (llvm::StringRef Uri : ShardedIndex.getAllSources()) {
+          auto Path = URI::resolve(Uri);
+          if (!Path) {
+            elog("Failed to resolve URI {0}: {1}", Uri, Path.takeError());
+            continue;
+          }
+          if (!TUFiles->count(*Path))
+            continue; // Another TU stores the shard of this file.
+          if (auto Err =
+                  Storage->storeShard(*Path, *ShardedIndex.getShard(Uri)))
+            elog("Failed to write index shard for {0}: {1}", *Path,
+                 std::move(Err));
+        }
+      };
     return createStaticIndexingAction(
         Opts,
-        [&](SymbolSlab S) {
+        [this, TUIndex](SymbolSlab S) {
+          if (Storage) {
+            TUIndex->Symbols = std::move(S);
+            return;
+          }
           // Merge as we go.
           std::lock_guard<std::mutex> Lock(SymbolsMu);
           for (const auto &Sym : S) {
@@ -65,7 +231,11 @@ public:
               Symbols.insert(Sym);
           }
         },
-        [&](RefSlab S) {
+        [this, TUIndex](RefSlab S) {
+          if (Storage) {
+            TUIndex->Refs = std::move(S);
+            return;
+          }
           std::lock_guard<std::mutex> Lock(RefsMu);
           for (const auto &Sym : S) {
             // Deduplication happens during insertion.
@@ -73,18 +243,26 @@ public:
               Refs.insert(Sym.first, Ref);
           }
         },
-        [&](RelationSlab S) {
+        [this, TUIndex](RelationSlab S) {
+          if (Storage) {
+            TUIndex->Relations = std::move(S);
+            return;
+          }
           std::lock_guard<std::mutex> Lock(RelsMu);
           for (const auto &R : S) {
             Relations.insert(R);
           }
         },
-        /*IncludeGraphCallback=*/nullptr);
+        std::move(IncludeGraphCallback));
   }
 
   // Awkward: we write the result in the destructor, because the executor
   // takes ownership so it's the easiest way to get our data back out.
   ~IndexActionFactory() {
+    if (Storage) {
+      Result = mergeShards(*Storage, MainFiles);
+      return;
+    }
     Result.Symbols = std::move(Symbols).build();
     Result.Refs = std::move(Refs).build();
     Result.Relations = std::move(Relations).build();
@@ -92,6 +270,9 @@ public:
 
 private:
   IndexFileIn &Result;
+  const BackgroundIndexStorage *Storage;
+  std::mutex MainFilesMu;
+  std::vector<std::string> MainFiles;
   std::mutex FilesMu;
   llvm::StringSet<> Files;
   std::mutex SymbolsMu;
@@ -120,6 +301,12 @@ int main(int argc, const char **argv) {
 
   $ clangd-indexer File1.cpp File2.cpp ... FileN.cpp > clangd.dex
 
+  Example usage for incremental reindexing, which keeps per-file shards in
+  /path/to/project/.cache/clangd/index:
+
+  $ clangd-indexer --executor=all-TUs --shard-root=/path/to/project \
+      compile_commands.json > clangd.dex
+
   Note: only symbols from header files will be indexed.
   )";
 
@@ -131,10 +318,22 @@ int main(int argc, const char **argv) {
     return 1;
   }
 
-  // Collect symbols found in each translation unit, merging as we go.
+  clang::clangd::BackgroundIndexStorage::Factory StorageFactory;
+  clang::clangd::BackgroundIndexStorage *Storage = nullptr;
+  if (!clang::clangd::ShardRoot.empty()) {
+    StorageFactory =
+        clang::clangd::BackgroundIndexStorage::createDiskBackedStorageFactory(
+            [](clang::clangd::PathRef) {
+              return clang::clangd::ProjectInfo{clang::clangd::ShardRoot};
+            });
+    Storage = StorageFactory(clang::clangd::ShardRoot);
+  }
+
+  // Collect symbols found in each translation unit, merging as we go, or
+  // storing them in shards and merging these at the end.
   clang::clangd::IndexFileIn Data;
   auto Err = Executor->get()->execute(
-      std::make_unique<clang::clangd::IndexActionFactory>(Data),
+      std::make_unique<clang::clangd::IndexActionFactory>(Data, Storage),
       clang::tooling::getStripPluginsAdjuster());
   if (Err) {
     clang::clangd::elog("{0}", std::move(Err));
@@ -143,6 +342,7 @@ int main(int argc, const char **argv) {
   // Emit collected data.
   clang::clangd::IndexFileOut Out(Data);
   Out.Format = clang::clangd::Format;
+  Out.PostingLists = true;
   llvm::outs() << Out;
   return 0;
 }
@@ -50,6 +50,10 @@
 #include <unistd.h>
 #endif
 
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
 namespace clang {
 namespace clangd {
 
@@ -476,6 +480,17 @@ opt<bool> AsyncPreamble{
     Hidden,
 };
 
+opt<bool> SkipUnchangedBodies{
+    "skip-unchanged-bodies",
+    cat(Misc),
+    desc("When rebuilding the AST for diagnostics after an edit, skip the "
+         "bodies of the functions that precede it and keep their previous "
+         "diagnostics. Diagnostics the edit causes before itself may be "
+         "missed."),
+    init(ClangdServer::Options().SkipUnchangedBodies),
+    Hidden,
+};
+
 opt<bool> EnableConfig{
     "enable-config",
     cat(Misc),
@@ -497,6 +512,37 @@ opt<bool> CollectMainFileRefs{
     init(ClangdServer::Options().CollectMainFileRefs),
 };
 
+opt<unsigned> MaxRetainedASTMemory{
+    "max-retained-ast-memory",
+    cat(Misc),
+    desc("Limit in MB on the memory used by the ASTs of idle files, in "
+         "addition to their number. 0 means no limit"),
+    init(0),
+};
+
+#if defined(__GLIBC__) && CLANGD_MALLOC_TRIM
+opt<bool> EnableMallocTrim{
+    "malloc-trim",
+    cat(Misc),
+    desc("Release memory periodically via malloc_trim(3)."),
+    init(true),
+};
+
+std::function<void()> getMemoryCleanupFunction() {
+  if (!EnableMallocTrim)
+    return nullptr;
+  // Leave a few MB at the top of the heap: it is insignificant and will most
+  // likely be needed by the main thread.
+  constexpr size_t MallocTrimPad = 20'000'000;
+  return [] {
+    if (malloc_trim(MallocTrimPad))
+      vlog("Released memory via malloc_trim");
+  };
+}
+#else
+std::function<void()> getMemoryCleanupFunction() { return nullptr; }
+#endif
+
 #if CLANGD_ENABLE_REMOTE
 opt<std::string> RemoteIndexAddress{
     "remote-index-address",
@@ -794,6 +840,9 @@ clangd accepts flags on the commandline, and in the CLANGD_FLAGS environment var
     Opts.StaticIndex = PAI.get();
   }
   Opts.AsyncThreadsCount = WorkerThreadsCount;
+  Opts.RetentionPolicy.MaxRetainedBytes =
+      size_t(MaxRetainedASTMemory) * 1024 * 1024;
+  Opts.MemoryCleanup = getMemoryCleanupFunction();
   Opts.BuildRecoveryAST = RecoveryAST;
   Opts.PreserveRecoveryASTType = RecoveryASTType;
   Opts.FoldingRanges = FoldingRanges;
@@ -855,6 +904,7 @@ clangd accepts flags on the commandline, and in the CLANGD_FLAGS environment var
     Opts.ClangTidyProvider = ClangTidyOptProvider;
   }
   Opts.AsyncPreambleBuilds = AsyncPreamble;
+  Opts.SkipUnchangedBodies = SkipUnchangedBodies;
   Opts.SuggestMissingIncludes = SuggestMissingIncludes;
   Opts.QueryDriverGlobs = std::move(QueryDriverGlobs);
   Opts.TweakFilter = [&](const Tweak &T) {
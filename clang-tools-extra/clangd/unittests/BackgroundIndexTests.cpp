@@ -762,6 +762,20 @@ TEST_F(BackgroundIndexRebuilderTest, LoadingShards) {
   EXPECT_TRUE(checkRebuild([&] { Rebuilder.doneLoading(); }));
 }
 
+TEST_F(BackgroundIndexRebuilderTest, LargeIndex) {
+  // Loading many shards makes the rebuilds after indexing TUs less frequent.
+  unsigned Threshold = 10 * Rebuilder.TUsBeforeRebuild;
+  Rebuilder.startLoading();
+  Rebuilder.loadedShard(Threshold * Rebuilder.IndexFractionBeforeRebuild);
+  EXPECT_TRUE(checkRebuild([&] { Rebuilder.doneLoading(); }));
+  for (unsigned I = 0; I < Threshold; ++I)
+    EXPECT_FALSE(checkRebuild([&] { Rebuilder.indexedTU(); }));
+  unsigned I = 0;
+  while (I < Threshold && !checkRebuild([&] { Rebuilder.indexedTU(); }))
+    ++I;
+  EXPECT_LT(I, Threshold);
+}
+
 TEST(BackgroundQueueTest, Priority) {
   // Create high and low priority tasks.
   // Once a bunch of high priority tasks have run, the queue is stopped.
@@ -829,6 +843,37 @@ TEST(BackgroundQueueTest, Boost) {
   }
 }
 
+TEST(BackgroundQueueTest, Proximity) {
+  std::string Sequence;
+  auto MakeTask = [&](char Name, llvm::StringRef Path) {
+    BackgroundQueue::Task T([&Sequence, Name] { Sequence.push_back(Name); });
+    T.Path = testPath(Path);
+    return T;
+  };
+  std::vector<BackgroundQueue::Task> Tasks = {
+      MakeTask('A', "a/x.cc"), MakeTask('B', "b/x.cc"),
+      MakeTask('C', "b/c/x.cc")};
+  Tasks.emplace_back([&] { Sequence.push_back('D'); });
+  Tasks.back().QueuePri = 1;
+
+  {
+    BackgroundQueue Q;
+    Q.setProximity({testPath("b/c/y.cc")});
+    Q.append(Tasks);
+    Q.work([&] { Q.stop(); });
+    EXPECT_EQ("DCBA", Sequence) << "closer files first, after priority";
+  }
+  Sequence.clear();
+  {
+    BackgroundQueue Q;
+    Q.append(Tasks);
+    Q.setProximity({testPath("a/y.cc")});
+    Q.work([&] { Q.stop(); });
+    EXPECT_EQ('D', Sequence[0]);
+    EXPECT_EQ('A', Sequence[1]) << "proximity set after enqueueing";
+  }
+}
+
 TEST(BackgroundQueueTest, Progress) {
   using testing::AnyOf;
   BackgroundQueue::Stats S;
@@ -499,6 +499,72 @@ TEST(Dex, FuzzyFind) {
                                    "other::A"));
 }
 
+TEST(DexIterators, AdvanceToAcrossChunks) {
+  // Large gaps between the DocIDs spread them over many chunks.
+  std::vector<DocID> Docs;
+  for (DocID Doc = 0; Doc < 1000000; Doc += 1000)
+    Docs.push_back(Doc);
+  const PostingList L(Docs);
+  ASSERT_GT(L.chunks().size(), 10U);
+
+  auto DocIterator = L.iterator();
+  for (DocID Target : {1U, 1000U, 2500U, 3000U, 41000U, 41001U, 99000U}) {
+    DocIterator->advanceTo(Target);
+    ASSERT_FALSE(DocIterator->reachedEnd());
+    EXPECT_EQ(DocIterator->peek(), (Target + 999) / 1000 * 1000);
+  }
+  DocIterator->advanceTo(999001);
+  EXPECT_TRUE(DocIterator->reachedEnd());
+
+  // Intersect with a list which only matches in a few chunks.
+  Corpus C{1000000};
+  const PostingList L2({3000, 3500, 41000, 99000, 999000});
+  auto And = C.intersect(L.iterator(), L2.iterator());
+  EXPECT_THAT(consumeIDs(*And), ElementsAre(3000U, 41000U, 99000U, 999000U));
+}
+
+TEST(DexIterators, ValidChunks) {
+  const PostingList L({4, 7, 8, 20, 42, 100, 1000});
+  EXPECT_TRUE(PostingList::validChunks(L.chunks(), 1001));
+  EXPECT_FALSE(PostingList::validChunks(L.chunks(), 1000));
+  EXPECT_FALSE(PostingList::validChunks({}, 1000));
+
+  std::vector<Chunk> Chunks = L.chunks().vec();
+  Chunks.front().Payload.fill(0xff);
+  EXPECT_FALSE(PostingList::validChunks(Chunks, 1001));
+}
+
+TEST(Dex, StoredPostingLists) {
+  SymbolSlab Symbols = generateSymbols({"ns::ABC", "ns::BCD", "other::ABC"});
+  StoredPostingLists Lists = Dex::buildPostingLists(Symbols);
+  EXPECT_EQ(Lists.Symbols.size(), Symbols.size());
+
+  auto Index = Dex::build(generateSymbols({"ns::ABC", "ns::BCD", "other::ABC"}),
+                          RefSlab(), RelationSlab(), std::move(Lists));
+  FuzzyFindRequest Req;
+  Req.Query = "ABC";
+  Req.Scopes = {"ns::"};
+  EXPECT_THAT(match(*Index, Req), UnorderedElementsAre("ns::ABC"));
+  Req.AnyScope = true;
+  EXPECT_THAT(match(*Index, Req),
+              UnorderedElementsAre("ns::ABC", "other::ABC"));
+  EXPECT_THAT(lookup(*Index, SymbolID("ns::BCD")),
+              UnorderedElementsAre("ns::BCD"));
+}
+
+TEST(Dex, MismatchedStoredPostingLists) {
+  // Posting lists stored for other symbols are built again.
+  StoredPostingLists Lists =
+      Dex::buildPostingLists(generateSymbols({"ns::ABC", "ns::BCD"}));
+  auto Index = Dex::build(generateSymbols({"ns::ABC", "ns::BCD", "other::ABC"}),
+                          RefSlab(), RelationSlab(), std::move(Lists));
+  FuzzyFindRequest Req;
+  Req.Query = "ABC";
+  Req.AnyScope = true;
+  EXPECT_THAT(match(*Index, Req),
+              UnorderedElementsAre("ns::ABC", "other::ABC"));
+}
+
 TEST(DexTest, DexLimitedNumMatches) {
   auto I = Dex::build(generateNumSymbols(0, 100), RefSlab(), RelationSlab());
   FuzzyFindRequest Req;
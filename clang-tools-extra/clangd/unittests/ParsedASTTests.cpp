@@ -636,6 +636,53 @@ TEST(ParsedASTTest, PatchesDeletedIncludes) {
                 testPath("foo.cpp"))));
 }
 
+TEST(ParsedASTTest, SkipsBodiesBeforeEdit) {
+  TestTU TU;
+  TU.ExtraArgs = {"-Wunused-function"};
+  TU.Code = R"cpp(
+    static void helper() {}
+    void before() { helper(); undefined(); }
+    void after() {}
+  )cpp";
+  MockFS FS;
+  StoreDiags Diags;
+  auto Inputs = TU.inputs(FS);
+  auto Previous =
+      ParsedAST::build(testPath(TU.Filename), Inputs,
+                       buildCompilerInvocation(Inputs, Diags), {}, nullptr);
+  ASSERT_TRUE(Previous);
+  EXPECT_FALSE(Previous->hasSkippedBodies());
+  EXPECT_EQ(Previous->getFunctionBodies().size(), 3u);
+
+  Annotations Edited(R"cpp(
+    static void helper() {}
+    void before() { helper(); undefined(); }
+    void after() {^ alsoUndefined(); }
+  )cpp");
+  ReusedBuild Reuse;
+  Reuse.EditOffset =
+      llvm::cantFail(positionToOffset(Edited.code(), Edited.point()));
+  Reuse.Bodies = Previous->getFunctionBodies();
+  Reuse.Diags = Previous->getDiagnostics();
+  TU.Code = Edited.code().str();
+  Inputs = TU.inputs(FS);
+  auto AST = ParsedAST::build(testPath(TU.Filename), Inputs,
+                              buildCompilerInvocation(Inputs, Diags), {},
+                              nullptr, &Reuse);
+  ASSERT_TRUE(AST);
+  EXPECT_TRUE(AST->hasSkippedBodies());
+  EXPECT_TRUE(cast<FunctionDecl>(findDecl(*AST, "before")).hasSkippedBody());
+  EXPECT_FALSE(cast<FunctionDecl>(findDecl(*AST, "after")).hasSkippedBody());
+  EXPECT_EQ(AST->getFunctionBodies().size(), 3u);
+  // The error in the skipped body is kept, helper() isn't reported as unused.
+  EXPECT_THAT(AST->getDiagnostics(),
+              testing::UnorderedElementsAre(
+                  testing::Field(&Diag::Message,
+                                 testing::HasSubstr("'undefined'")),
+                  testing::Field(&Diag::Message,
+                                 testing::HasSubstr("'alsoUndefined'"))));
+}
+
 } // namespace
 } // namespace clangd
 } // namespace clang
@@ -15,6 +15,8 @@
 #include "TestFS.h"
 #include "TestTU.h"
 #include "XRefs.h"
+#include "support/Cancellation.h"
+#include "support/Context.h"
 #include "clang/Format/Format.h"
 #include "clang/Frontend/PrecompiledPreamble.h"
 #include "clang/Lex/PreprocessorOptions.h"
@@ -227,6 +229,30 @@ std::string getPreamblePatch(llvm::StringRef Baseline,
       .str();
 }
 
+TEST(PreambleTest, CancelledBuild) {
+  MockFS FS;
+  IgnoreDiagnostics Diags;
+  auto TU = TestTU::withCode(R"cpp(
+    #include "a.h"
+    int main() { return x; }
+  )cpp");
+  TU.AdditionalFiles["a.h"] = "int x;";
+  auto PI = TU.inputs(FS);
+  auto CI = buildCompilerInvocation(PI, Diags);
+  ASSERT_TRUE(CI);
+
+  auto Task = cancelableTask();
+  WithContext Cancelable(std::move(Task.first));
+  Task.second();
+  bool RanCallback = false;
+  auto Preamble = buildPreamble(
+      TU.Filename, *CI, PI, true,
+      [&](ASTContext &, std::shared_ptr<Preprocessor>,
+          const CanonicalIncludes &) { RanCallback = true; });
+  EXPECT_EQ(Preamble, nullptr);
+  EXPECT_FALSE(RanCallback) << "the AST of a cancelled build is incomplete";
+}
+
 TEST(PreamblePatchTest, Define) {
   // BAR should be defined while parsing the AST.
   struct {
@@ -10,6 +10,7 @@
 #include "RIFF.h"
 #include "index/Index.h"
 #include "index/Serialization.h"
+#include "index/dex/Dex.h"
 #include "support/Logger.h"
 #include "clang/Tooling/CompilationDatabase.h"
 #include "llvm/ADT/ScopeExit.h"
@@ -235,6 +236,29 @@ TEST(SerializationTest, BinaryConversions) {
               UnorderedElementsAreArray(YAMLFromRelations(*In->Relations)));
 }
 
+TEST(SerializationTest, PostingListsTest) {
+  auto In = readIndexFile(YAML);
+  EXPECT_TRUE(bool(In)) << In.takeError();
+
+  IndexFileOut Out(*In);
+  Out.Format = IndexFileFormat::RIFF;
+  Out.PostingLists = true;
+  std::string Serialized = llvm::to_string(Out);
+
+  auto In2 = readIndexFile(Serialized);
+  ASSERT_TRUE(bool(In2)) << In2.takeError();
+  ASSERT_TRUE(In2->Symbols);
+  ASSERT_TRUE(In2->PostingLists);
+  dex::StoredPostingLists Expected = dex::Dex::buildPostingLists(*In->Symbols);
+  EXPECT_EQ(In2->PostingLists->Symbols, Expected.Symbols);
+  ASSERT_EQ(In2->PostingLists->Lists.size(), Expected.Lists.size());
+  for (size_t I = 0; I < Expected.Lists.size(); ++I) {
+    EXPECT_EQ(In2->PostingLists->Lists[I].first, Expected.Lists[I].first);
+    EXPECT_EQ(In2->PostingLists->Lists[I].second.size(),
+              Expected.Lists[I].second.size());
+  }
+}
+
 TEST(SerializationTest, SrcsTest) {
   auto In = readIndexFile(YAML);
   EXPECT_TRUE(bool(In)) << In.takeError();
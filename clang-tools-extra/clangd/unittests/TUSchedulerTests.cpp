@@ -597,6 +597,25 @@ TEST_F(TUSchedulerTests, EvictedAST) {
 // We send "empty" changes to TUScheduler when we think some external event
 // *might* have invalidated current state (e.g. a header was edited).
 // Verify that this doesn't evict our cache entries.
+TEST_F(TUSchedulerTests, EvictedASTBySize) {
+  auto Opts = optsForTest();
+  Opts.AsyncThreadsCount = 1;
+  Opts.RetentionPolicy.MaxRetainedASTs = 3;
+  // Any AST is bigger than that, only the most recently used one is kept.
+  Opts.RetentionPolicy.MaxRetainedBytes = 1;
+  TUScheduler S(CDB, Opts);
+
+  auto Foo = testPath("foo.cpp");
+  auto Bar = testPath("bar.cpp");
+  updateWithCallback(S, Foo, "int x;", WantDiagnostics::Yes, [] {});
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  EXPECT_THAT(S.getFilesWithCachedAST(), ElementsAre(Foo));
+
+  updateWithCallback(S, Bar, "int y;", WantDiagnostics::Yes, [] {});
+  ASSERT_TRUE(S.blockUntilIdle(timeoutSeconds(10)));
+  EXPECT_THAT(S.getFilesWithCachedAST(), ElementsAre(Bar));
+}
+
 TEST_F(TUSchedulerTests, NoopChangesDontThrashCache) {
   auto Opts = optsForTest();
   Opts.RetentionPolicy.MaxRetainedASTs = 1;
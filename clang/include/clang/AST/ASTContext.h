@@ -636,7 +636,12 @@ public:
   }
 
   void *Allocate(size_t Size, unsigned Align = 8) const {
-    return BumpAlloc.Allocate(Size, Align);
+    void *Mem = BumpAlloc.Allocate(Size, Align);
+    if (LLVM_UNLIKELY(TrackLastAllocation)) {
+      LastAllocation = Mem;
+      LastAllocationSize = Size;
+    }
+    return Mem;
   }
   template <typename T> T *Allocate(size_t Num = 1) const {
     return static_cast<T *>(Allocate(Num * sizeof(T), alignof(T)));
@@ -649,6 +654,17 @@ public:
     return BumpAlloc.getTotalMemory();
   }
 
+  /// Return the number of bytes handed out for AST nodes and type
+  /// information, which doesn't include the unused part of the slabs.
+  size_t getASTAllocatedBytes() const { return BumpAlloc.getBytesAllocated(); }
+
+  /// Whether to record the most recent allocation of all the ASTContexts,
+  /// which lets the statistics of the statements account for the trailing
+  /// objects they are allocated with.
+  static bool TrackLastAllocation;
+  static const void *LastAllocation;
+  static size_t LastAllocationSize;
+
   /// Return the total memory used for various side tables.
   size_t getSideTableAllocatedMemory() const;
 
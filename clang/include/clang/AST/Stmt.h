@@ -1156,7 +1156,7 @@ public:
     static_assert(sizeof(*this) % alignof(void *) == 0,
                   "Insufficient alignment!");
     StmtBits.sClass = SC;
-    if (StatisticsEnabled) Stmt::addStmtClass(SC);
+    if (StatisticsEnabled) Stmt::addStmtClass(SC, this);
   }
 
   StmtClass getStmtClass() const {
@@ -1173,7 +1173,7 @@ public:
   SourceLocation getEndLoc() const LLVM_READONLY;
 
   // global temp stats (until we have a per-module visitor)
-  static void addStmtClass(const StmtClass s);
+  static void addStmtClass(const StmtClass s, const Stmt *S = nullptr);
   static void EnableStatistics();
   static void PrintStats();
 
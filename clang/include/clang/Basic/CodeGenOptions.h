@@ -55,6 +55,7 @@ public:
     NoLibrary,  // Don't use any vector library.
     Accelerate, // Use the Accelerate framework.
     LIBMVEC,    // GLIBC vector math library.
+    LLVMLibc,   // LLVM libc vector math functions.
     MASSV,      // IBM MASS vector library.
     SVML        // Intel short vector math library.
   };
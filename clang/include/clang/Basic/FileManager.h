@@ -147,6 +147,13 @@ public:
   /// Returns the number of unique real file entries cached by the file manager.
   size_t getNumUniqueRealFiles() const { return UniqueRealFiles.size(); }
 
+  /// Checks whether the results of all the lookups made so far, including
+  /// the failed ones, still match the file system, bypassing the stat cache.
+  ///
+  /// This is what makes it safe for a later compilation to reuse the file
+  /// manager. Virtual files are never considered up to date.
+  bool isUpToDate();
+
   /// Lookup, cache, and verify the specified directory (real or
   /// virtual).
   ///
@@ -0,0 +1,109 @@
+//===- PersistentStatCache.h - On-disk cache of stats -----------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// Defines the PersistentStatCache class, an on-disk cache of the 'stat'
+/// results and include guards of headers that is shared by the compiler
+/// invocations of a build session.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_BASIC_PERSISTENTSTATCACHE_H
+#define LLVM_CLANG_BASIC_PERSISTENTSTATCACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace clang {
+
+class FileSystemStatCache;
+
+/// An on-disk cache of the results of the 'stat' calls made by the
+/// FileManager, including the failed ones, and of the include guards detected
+/// by the preprocessor.
+///
+/// The cache lives in a file that is memory mapped when the cache is loaded,
+/// and is meant to be shared by all the compiler invocations that run on a
+/// machine during a build session: the results are only trusted if the file
+/// was written after the session started, and nothing that is cached is ever
+/// checked against the file system again. The name of the file is derived from
+/// the state of the virtual file system, so that invocations that see the
+/// file system differently don't share results.
+///
+/// Each invocation adds what it learned to the cache by writing a new file
+/// that replaces the old one atomically; concurrent invocations may lose
+/// each other's additions, but never corrupt the cache.
+class PersistentStatCache {
+public:
+  /// A cached result.
+  struct Entry {
+    /// Whether the result of the 'stat' call for the path is known.
+    bool HasStat = false;
+    /// The status of the path, or None if it doesn't exist.
+    llvm::Optional<llvm::vfs::Status> Status;
+    /// The macro that guards the whole file, if any.
+    std::string IncludeGuard;
+  };
+
+  ~PersistentStatCache();
+
+  /// Loads the cache file \p CacheFile, or starts from an empty cache if it
+  /// doesn't exist, is malformed, or was written before \p SessionTimestamp
+  /// (in seconds since the epoch).
+  static std::shared_ptr<PersistentStatCache> load(StringRef CacheFile,
+                                                   uint64_t SessionTimestamp);
+
+  /// Returns the name of the cache file in \p CacheDir for the given key,
+  /// which describes the state of the virtual file system.
+  static std::string getCacheFileName(StringRef CacheDir, StringRef Key);
+
+  /// Creates a FileSystemStatCache that answers from \p Cache and records
+  /// the results of the calls it forwards to the file system in it.
+  static std::unique_ptr<FileSystemStatCache>
+  createFileSystemStatCache(std::shared_ptr<PersistentStatCache> Cache);
+
+  /// Returns the cached result for \p Path, if any.
+  llvm::Optional<Entry> lookup(StringRef Path) const;
+
+  /// Records the status of \p Path, or that it doesn't exist.
+  void addStatus(StringRef Path, const llvm::vfs::Status *Status);
+
+  /// Returns the cached include guard of \p Path, or an empty string.
+  std::string getIncludeGuard(StringRef Path) const;
+
+  /// Records that \p Path is guarded by \p Macro.
+  void addIncludeGuard(StringRef Path, StringRef Macro);
+
+  /// Writes the cache file if anything was added to the cache.
+  llvm::Error write();
+
+  StringRef getCacheFile() const { return CacheFile; }
+
+private:
+  class OnDiskTable;
+
+  PersistentStatCache(StringRef CacheFile);
+
+  std::string CacheFile;
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+  std::unique_ptr<OnDiskTable> Table;
+  /// The results that aren't in the cache file yet.
+  llvm::StringMap<Entry> NewEntries;
+};
+
+} // namespace clang
+
+#endif // LLVM_CLANG_BASIC_PERSISTENTSTATCACHE_H
@@ -232,7 +232,7 @@ private:
   class ASTLoader {
   public:
     ASTLoader(CompilerInstance &CI, StringRef CTUDir,
-              StringRef InvocationListFilePath);
+              StringRef InvocationListFilePath, StringRef ASTCacheDir = "");
 
     /// Load the ASTUnit by its identifier found in the index file. If the
     /// indentifier is suffixed with '.ast' it is considered a dump. Otherwise
@@ -253,6 +253,9 @@ private:
     LoadResultTy loadFromDump(StringRef Identifier);
     /// Loads an AST from a source-file.
     LoadResultTy loadFromSource(StringRef Identifier);
+    /// Loads the AST of a source-file that an earlier on-demand parse stored
+    /// in the ASTCacheDir. Returns nullptr if it is missing or out of date.
+    std::unique_ptr<ASTUnit> loadFromCache(StringRef CachePath);
 
     CompilerInstance &CI;
     StringRef CTUDir;
@@ -260,6 +263,9 @@ private:
     /// format, and contains a mapping from source files to compiler invocations
     /// that produce the AST used for analysis.
     StringRef InvocationListFilePath;
+    /// The directory where the ASTs parsed on-demand are stored for the other
+    /// analyzer processes, or empty.
+    StringRef ASTCacheDir;
     /// In case of on-demand parsing, the invocations for parsing the source
     /// files is stored.
     llvm::Optional<InvocationListTy> InvocationList;
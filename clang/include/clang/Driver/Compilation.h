@@ -22,6 +22,7 @@
 #include <iterator>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <vector>
 
@@ -120,6 +121,10 @@ class Compilation {
   /// class Command and the exit status of the corresponding child process.
   std::function<void(const Command &, int)> PostCallback;
 
+  /// Serializes the output and the callbacks of the jobs that run in
+  /// parallel.
+  mutable std::mutex JobOutputMutex;
+
   /// Whether we're compiling for diagnostic purposes.
   bool ForDiagnostics = false;
 
@@ -299,6 +304,17 @@ public:
       const JobList &Jobs,
       SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const;
 
+private:
+  /// Executes \p Jobs like ExecuteJobs, but runs up to \p NumThreads of them
+  /// at the same time. A job starts once the jobs that produce its input
+  /// files are done.
+  void ExecuteJobsInParallel(
+      const JobList &Jobs,
+      SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands,
+      unsigned NumThreads) const;
+
+public:
+
   /// initCompilationForDiagnostics - Remove stale state and suppress output
   /// so compilation can be reexecuted to generate additional diagnostic
   /// information (e.g., preprocessed source(s)).
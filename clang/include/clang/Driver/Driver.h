@@ -211,6 +211,10 @@ public:
   typedef int (*CC1ToolFunc)(SmallVectorImpl<const char *> &ArgV);
   CC1ToolFunc CC1Main = nullptr;
 
+  /// The maximum number of jobs of a compilation that may run at the same
+  /// time, set by -parallel-jobs=.
+  unsigned NumParallelJobs = 1;
+
 private:
   /// Raw target triple.
   std::string TargetTriple;
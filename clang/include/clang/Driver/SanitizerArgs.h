@@ -30,6 +30,7 @@ class SanitizerArgs {
   std::vector<std::string> CoverageAllowlistFiles;
   std::vector<std::string> CoverageBlocklistFiles;
   int CoverageFeatures = 0;
+  unsigned CoverageSamplePeriod = 0;
   int MsanTrackOrigins = 0;
   bool MsanUseAfterDtor = true;
   bool CfiCrossDso = false;
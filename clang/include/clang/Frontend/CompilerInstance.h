@@ -46,6 +46,7 @@ class FileManager;
 class FrontendAction;
 class InMemoryModuleCache;
 class Module;
+class PersistentStatCache;
 class Preprocessor;
 class Sema;
 class SourceManager;
@@ -85,6 +86,10 @@ class CompilerInstance : public ModuleLoader {
   /// The file manager.
   IntrusiveRefCntPtr<FileManager> FileMgr;
 
+  /// The cache of file system lookups shared with the other compilations of
+  /// the build session, if any.
+  std::shared_ptr<PersistentStatCache> StatCache;
+
   /// The source manager.
   IntrusiveRefCntPtr<SourceManager> SourceMgr;
 
@@ -245,6 +245,9 @@ public:
   /// Output time trace profile.
   unsigned TimeTrace : 1;
 
+  /// Record the memory allocated by each scope of the time trace profile.
+  unsigned TimeTraceMemory : 1;
+
   /// Show the -version text.
   unsigned ShowVersion : 1;
 
@@ -450,8 +453,9 @@ public:
 public:
   FrontendOptions()
       : DisableFree(false), RelocatablePCH(false), ShowHelp(false),
-        ShowStats(false), TimeTrace(false), ShowVersion(false),
-        FixWhatYouCan(false), FixOnlyWarnings(false), FixAndRecompile(false),
+        ShowStats(false), TimeTrace(false), TimeTraceMemory(false),
+        ShowVersion(false), FixWhatYouCan(false), FixOnlyWarnings(false),
+        FixAndRecompile(false),
         FixToTemporaries(false), ARCMTMigrateEmitARCErrors(false),
         SkipFunctionBodies(false), UseGlobalModuleIndex(true),
         GenerateGlobalModuleIndex(true), ASTDumpDecls(false),
@@ -127,6 +127,26 @@ public:
                         IntrusiveRefCntPtr<llvm::vfs::FileSystem> &VFS,
                         llvm::MemoryBuffer *MainFileBuffer) const;
 
+  /// Writes the preamble into \p StoreDir, a directory shared by the tools
+  /// that build preambles for the same files (e.g. clangd and clang-tidy), so
+  /// that they can load it with LoadFromStore() instead of building it again.
+  /// The entry is keyed by the options of \p Invocation that affect the PCH
+  /// and by the contents of the preamble, and is written atomically.
+  std::error_code SaveToStore(StringRef StoreDir,
+                              const CompilerInvocation &Invocation) const;
+
+  /// Loads the preamble that SaveToStore() wrote into \p StoreDir for the
+  /// same invocation and preamble contents, if CanReuse() is true for it.
+  /// The loaded preamble is stored in memory.
+  /// Returns no_such_file_or_directory if there is no such preamble in the
+  /// store, and BuildPreambleError::StoredPreambleInvalid if it can't be used.
+  /// The PreambleCallbacks are not run for a loaded preamble, so the clients
+  /// that need the information they collect must build the preamble instead.
+  static llvm::ErrorOr<PrecompiledPreamble>
+  LoadFromStore(StringRef StoreDir, const CompilerInvocation &Invocation,
+                const llvm::MemoryBuffer *MainFileBuffer,
+                PreambleBounds Bounds, llvm::vfs::FileSystem *VFS);
+
 private:
   PrecompiledPreamble(PCHStorage Storage, std::vector<char> PreambleBytes,
                       bool PreambleEndsAtStartOfLine,
@@ -299,6 +319,10 @@ public:
   /// Only used if FrontendOpts::SkipFunctionBodies is true.
   /// See ASTConsumer::shouldSkipFunctionBody.
   virtual bool shouldSkipFunctionBody(Decl *D) { return true; }
+  /// Polled after each TopLevelDecl. If it returns true, parsing stops and the
+  /// build fails with BuildPreambleError::Cancelled, e.g. because the main
+  /// file has changed since the build started.
+  virtual bool shouldCancel() { return false; }
 };
 
 enum class BuildPreambleError {
@@ -306,7 +330,9 @@ enum class BuildPreambleError {
   CouldntCreateTargetInfo,
   BeginSourceFileFailed,
   CouldntEmitPCH,
-  BadInputs
+  BadInputs,
+  StoredPreambleInvalid,
+  Cancelled
 };
 
 class BuildPreambleErrorCategory final : public std::error_category {
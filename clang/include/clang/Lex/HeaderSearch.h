@@ -42,6 +42,7 @@ class HeaderSearchOptions;
 class IdentifierInfo;
 class LangOptions;
 class Module;
+class PersistentStatCache;
 class Preprocessor;
 class TargetInfo;
 
@@ -253,6 +254,10 @@ class HeaderSearch {
   /// Entity used to look up stored header file information.
   ExternalHeaderFileInfoSource *ExternalSource = nullptr;
 
+  /// The cache of include guards shared with the other compilations of the
+  /// build session, if any.
+  std::shared_ptr<PersistentStatCache> StatCache;
+
 public:
   HeaderSearch(std::shared_ptr<HeaderSearchOptions> HSOpts,
                SourceManager &SourceMgr, DiagnosticsEngine &Diags,
@@ -359,6 +364,13 @@ public:
     ExternalSource = ES;
   }
 
+  /// Set the cache in which the include guards found by this compilation are
+  /// recorded, and where the include guards found by the other compilations
+  /// of the build session are looked up.
+  void setPersistentStatCache(std::shared_ptr<PersistentStatCache> Cache) {
+    StatCache = std::move(Cache);
+  }
+
   /// Set the target information for the header search, if not
   /// already known.
   void setTarget(const TargetInfo &Target);
@@ -469,9 +481,7 @@ public:
   /// This is used by the multiple-include optimization to eliminate
   /// no-op \#includes.
   void SetFileControllingMacro(const FileEntry *File,
-                               const IdentifierInfo *ControllingMacro) {
-    getFileInfo(File).ControllingMacro = ControllingMacro;
-  }
+                               const IdentifierInfo *ControllingMacro);
 
   /// Return true if this is the first time encountering this header.
   bool FirstTimeLexingFile(const FileEntry *File) {
@@ -170,6 +170,13 @@ public:
   /// loading.
   uint64_t BuildSessionTimestamp = 0;
 
+  /// The directory of the cache of file system lookups and include guards
+  /// shared by the compilations of a build session, if any.
+  ///
+  /// The cache is only trusted if it was written during the current build
+  /// session (see \c BuildSessionTimestamp).
+  std::string StatCachePath;
+
   /// The set of macro names that should be ignored for the purposes
   /// of computing the module hash.
   llvm::SmallSetVector<llvm::CachedHashString, 16> ModulesIgnoreMacros;
@@ -1270,6 +1270,13 @@ public:
   /// The number of SFINAE diagnostics that have been trapped.
   unsigned NumSFINAEErrors;
 
+  /// The number of function definitions that have been instantiated.
+  unsigned NumFunctionInstantiations = 0;
+
+  /// The number of function definitions that didn't need to be instantiated
+  /// because an AST file already provided them.
+  unsigned NumFunctionInstantiationsFromAST = 0;
+
   typedef llvm::DenseMap<ParmVarDecl *, llvm::TinyPtrVector<ParmVarDecl *>>
     UnparsedDefaultArgInstantiationsMap;
 
@@ -8968,6 +8975,40 @@ public:
   /// eagerly.
   SmallVector<PendingImplicitInstantiation, 1> LateParsedInstantiations;
 
+  /// The AST memory allocated by the instantiations of a template, when
+  /// statistics are collected.
+  struct TemplateInstantiationMemory {
+    unsigned NumInstantiations = 0;
+    /// Includes the memory of the instantiations they trigger.
+    size_t Bytes = 0;
+  };
+
+  /// The AST memory allocated by the instantiations of each template pattern.
+  llvm::DenseMap<const Decl *, TemplateInstantiationMemory>
+      InstantiationMemory;
+
+  /// Records the AST memory allocated over its lifetime in
+  /// InstantiationMemory, when statistics are collected.
+  class InstantiationMemoryScope {
+  public:
+    InstantiationMemoryScope(Sema &S, const Decl *Pattern)
+        : S(S), Pattern(S.CollectStats ? Pattern->getCanonicalDecl() : nullptr),
+          StartBytes(S.Context.getASTAllocatedBytes()) {}
+
+    ~InstantiationMemoryScope() {
+      if (!Pattern)
+        return;
+      TemplateInstantiationMemory &Memory = S.InstantiationMemory[Pattern];
+      ++Memory.NumInstantiations;
+      Memory.Bytes += S.Context.getASTAllocatedBytes() - StartBytes;
+    }
+
+  private:
+    Sema &S;
+    const Decl *Pattern;
+    size_t StartBytes;
+  };
+
   class GlobalEagerInstantiationScope {
   public:
     GlobalEagerInstantiationScope(Sema &S, bool Enabled)
@@ -159,8 +159,9 @@ public:
   /// Reads a declarator info from the given record, advancing Idx.
   TypeSourceInfo *readTypeSourceInfo();
 
-  /// Reads the location information for a type.
-  void readTypeLoc(TypeLoc TL);
+  /// Reads the location information for a type, which is part of
+  /// \p OuterSeq if not null, or a new sequence otherwise.
+  void readTypeLoc(TypeLoc TL, SourceLocationSequence *OuterSeq = nullptr);
 
 
   /// Map a local type ID within a given AST file to a global type ID.
@@ -271,13 +272,13 @@ public:
   void readOMPChildren(OMPChildren *Data);
 
   /// Read a source location, advancing Idx.
-  SourceLocation readSourceLocation() {
-    return Reader->ReadSourceLocation(*F, Record, Idx);
+  SourceLocation readSourceLocation(SourceLocationSequence *Seq = nullptr) {
+    return Reader->ReadSourceLocation(*F, Record, Idx, Seq);
   }
 
   /// Read a source range, advancing Idx.
-  SourceRange readSourceRange() {
-    return Reader->ReadSourceRange(*F, Record, Idx);
+  SourceRange readSourceRange(SourceLocationSequence *Seq = nullptr) {
+    return Reader->ReadSourceRange(*F, Record, Idx, Seq);
   }
 
   /// Read an arbitrary constant value, advancing Idx.
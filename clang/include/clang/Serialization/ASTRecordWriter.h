@@ -126,17 +126,19 @@ public:
   /// to emit.
   void AddFunctionDefinition(const FunctionDecl *FD);
 
-  /// Emit a source location.
-  void AddSourceLocation(SourceLocation Loc) {
-    return Writer->AddSourceLocation(Loc, *Record);
+  /// Emit a source location, as part of the sequence \p Seq if not null.
+  void AddSourceLocation(SourceLocation Loc,
+                         SourceLocationSequence *Seq = nullptr) {
+    return Writer->AddSourceLocation(Loc, *Record, Seq);
   }
   void writeSourceLocation(SourceLocation Loc) {
     AddSourceLocation(Loc);
   }
 
-  /// Emit a source range.
-  void AddSourceRange(SourceRange Range) {
-    return Writer->AddSourceRange(Range, *Record);
+  /// Emit a source range, as part of the sequence \p Seq if not null.
+  void AddSourceRange(SourceRange Range,
+                      SourceLocationSequence *Seq = nullptr) {
+    return Writer->AddSourceRange(Range, *Record, Seq);
   }
 
   void writeBool(bool Value) {
@@ -202,7 +204,9 @@ public:
   void AddTypeSourceInfo(TypeSourceInfo *TInfo);
 
   /// Emits source location information for a type. Does not emit the type.
-  void AddTypeLoc(TypeLoc TL);
+  /// The locations are emitted as part of \p OuterSeq if not null, or as a
+  /// new sequence otherwise.
+  void AddTypeLoc(TypeLoc TL, SourceLocationSequence *OuterSeq = nullptr);
 
   /// Emits a template argument location info.
   void AddTemplateArgumentLocInfo(TemplateArgument::ArgKind Kind,
@@ -23,6 +23,7 @@
 #include "clang/Serialization/ASTBitCodes.h"
 #include "clang/Serialization/ASTDeserializationListener.h"
 #include "clang/Serialization/PCHContainerOperations.h"
+#include "clang/Serialization/SourceLocationEncoding.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
@@ -584,11 +585,13 @@ public:
   /// Emit a token.
   void AddToken(const Token &Tok, RecordDataImpl &Record);
 
-  /// Emit a source location.
-  void AddSourceLocation(SourceLocation Loc, RecordDataImpl &Record);
+  /// Emit a source location, as part of the sequence \p Seq if not null.
+  void AddSourceLocation(SourceLocation Loc, RecordDataImpl &Record,
+                         SourceLocationSequence *Seq = nullptr);
 
-  /// Emit a source range.
-  void AddSourceRange(SourceRange Range, RecordDataImpl &Record);
+  /// Emit a source range, as part of the sequence \p Seq if not null.
+  void AddSourceRange(SourceRange Range, RecordDataImpl &Record,
+                      SourceLocationSequence *Seq = nullptr);
 
   /// Emit a reference to an identifier.
   void AddIdentifierRef(const IdentifierInfo *II, RecordDataImpl &Record);
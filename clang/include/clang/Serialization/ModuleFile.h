@@ -273,6 +273,10 @@ public:
   /// SLocEntries that we're going to preload.
   SmallVector<uint64_t, 4> PreloadSLocEntries;
 
+  /// The SOURCE_MANAGER_LINE_TABLE record, which is only parsed once a file
+  /// with line directives is loaded from this AST file.
+  SmallVector<uint64_t, 0> PendingLineTable;
+
   /// Remapping table for source locations in this module.
   ContinuousRangeMap<uint32_t, int, 2> SLocRemap;
 
@@ -492,6 +496,20 @@ public:
   /// List of modules which this module depends on
   llvm::SetVector<ModuleFile *> Imports;
 
+  // === Statistics ===
+
+  /// The number of entities deserialized from this AST file, which tell what
+  /// the translation unit actually used from it.
+  unsigned NumSLocEntriesRead = 0;
+  unsigned NumTypesRead = 0;
+  unsigned NumDeclsRead = 0;
+  unsigned NumIdentifiersRead = 0;
+  unsigned NumMacrosRead = 0;
+  unsigned NumPreprocessedEntitiesRead = 0;
+
+  /// Whether the line table of this AST file was parsed.
+  bool ReadLineTable = false;
+
   /// Determine whether this module was directly imported at
   /// any point during translation.
   bool isDirectlyImported() const { return DirectlyImported; }
@@ -16,12 +16,49 @@
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/VirtualFileSystem.h"
+#include <atomic>
 #include <mutex>
+#include <string>
 
 namespace clang {
 namespace tooling {
 namespace dependencies {
 
+/// An on-disk cache of minimized sources that is shared by the dependency
+/// scanners that run on a machine, so that a scanner only needs to minimize
+/// the files that changed since the last scan.
+///
+/// The entries are keyed by a hash of the original contents of the files:
+/// they stay valid for as long as the contents don't change, and a scanner
+/// still reads every file but doesn't minimize it again. Each entry lives in
+/// its own file that is written atomically, which lets concurrent processes
+/// share the cache without any locking.
+class MinimizedSourceCache {
+public:
+  explicit MinimizedSourceCache(StringRef CacheDir);
+
+  /// \returns The key of the entry for a file with the given contents.
+  static std::string getKey(StringRef Source);
+
+  /// Reads the entry for \p Key into \p MinimizedContents and \p Mapping.
+  ///
+  /// \returns True if the entry was found.
+  bool lookup(StringRef Key, SmallVectorImpl<char> &MinimizedContents,
+              PreprocessorSkippedRangeMapping &Mapping) const;
+
+  /// Adds an entry for \p Key to the cache. Failures to write the entry are
+  /// ignored, since the cache is only an optimization.
+  void store(StringRef Key, StringRef MinimizedContents,
+             const PreprocessorSkippedRangeMapping &Mapping) const;
+
+  StringRef getCacheDir() const { return CacheDir; }
+
+private:
+  std::string getEntryPath(StringRef Key) const;
+
+  std::string CacheDir;
+};
+
 /// An in-memory representation of a file system entity that is of interest to
 /// the dependency scanning filesystem.
 ///
@@ -46,9 +83,13 @@ public:
   /// mismatching size of the file. If file is not minimized, the full file is
   /// read and copied into memory to ensure that it's not memory mapped to avoid
   /// running out of file descriptors.
-  static CachedFileSystemEntry createFileEntry(StringRef Filename,
-                                               llvm::vfs::FileSystem &FS,
-                                               bool Minimize = true);
+  ///
+  /// If \p PersistentCache is not null, the minimized contents are looked up
+  /// in it before minimizing the file, and added to it otherwise.
+  static CachedFileSystemEntry
+  createFileEntry(StringRef Filename, llvm::vfs::FileSystem &FS,
+                  bool Minimize = true,
+                  const MinimizedSourceCache *PersistentCache = nullptr);
 
   /// Create an entry that represents a directory on the filesystem.
   static CachedFileSystemEntry createDirectoryEntry(llvm::vfs::Status &&Stat);
@@ -114,7 +155,11 @@ public:
     CachedFileSystemEntry Value;
   };
 
-  DependencyScanningFilesystemSharedCache();
+  /// Creates a cache that is only shared by the threads of this process, or by
+  /// all the processes that use the same \p PersistentCacheDir if it is not
+  /// empty.
+  explicit DependencyScanningFilesystemSharedCache(
+      StringRef PersistentCacheDir = "");
 
   /// Returns a cache entry for the corresponding key.
   ///
@@ -122,6 +167,25 @@ public:
   /// thread safe call.
   SharedFileSystemEntry &get(StringRef Key);
 
+  /// Drops the cached entries of the files whose name (the last component of
+  /// their path) is in \p FileNames, or of all the files if \p FileNames is
+  /// null, and bumps the generation of the cache.
+  ///
+  /// Matching on the name errs on the side of invalidating too much, but
+  /// doesn't depend on how the path of a file was spelled when it was looked
+  /// up. This must not be called while a worker is scanning.
+  void invalidate(const llvm::StringSet<> *FileNames);
+
+  /// \returns The number of times the cache was invalidated. Workers compare
+  /// it to the generation they last saw to discard their own caches.
+  unsigned getGeneration() const { return Generation; }
+
+  /// \returns The on-disk cache of minimized sources, or null if there is
+  /// none.
+  const MinimizedSourceCache *getPersistentCache() const {
+    return PersistentCache.get();
+  }
+
 private:
   struct CacheShard {
     std::mutex CacheLock;
@@ -129,6 +193,8 @@ private:
   };
   std::unique_ptr<CacheShard[]> CacheShards;
   unsigned NumShards;
+  std::atomic<unsigned> Generation{0};
+  std::unique_ptr<MinimizedSourceCache> PersistentCache;
 };
 
 /// A virtual file system optimized for the dependency discovery.
@@ -156,6 +222,10 @@ public:
   /// The set of files that should not be minimized.
   llvm::StringSet<> IgnoredFiles;
 
+  /// Forgets the entries that were looked up in the shared cache, which must
+  /// be done when the shared cache is invalidated.
+  void clearLocalCache() { Cache.clear(); }
+
 private:
   void setCachedEntry(StringRef Filename, const CachedFileSystemEntry *Entry) {
     bool IsInserted = Cache.try_emplace(Filename, Entry).second;
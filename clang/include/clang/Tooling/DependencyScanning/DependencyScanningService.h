@@ -46,9 +46,12 @@ enum class ScanningOutputFormat {
 /// the invidual dependency scanning workers.
 class DependencyScanningService {
 public:
+  /// If \p MinimizedSourceCacheDir is not empty, the minimized sources are
+  /// also cached in that directory, and reused by later scans.
   DependencyScanningService(ScanningMode Mode, ScanningOutputFormat Format,
                             bool ReuseFileManager = true,
-                            bool SkipExcludedPPRanges = true);
+                            bool SkipExcludedPPRanges = true,
+                            StringRef MinimizedSourceCacheDir = "");
 
   ScanningMode getMode() const { return Mode; }
 
@@ -85,11 +85,15 @@ public:
   /// file format that is specified in the options (-MD is the default) and
   /// return it.
   ///
+  /// If \p FileDeps is not null, the files the input depends on are also
+  /// added to it.
+  ///
   /// \returns A \c StringError with the diagnostic output if clang errors
   /// occurred, dependency file contents otherwise.
   llvm::Expected<std::string>
   getDependencyFile(const tooling::CompilationDatabase &Compilations,
-                    StringRef CWD);
+                    StringRef CWD,
+                    std::vector<std::string> *FileDeps = nullptr);
 
   /// Collect the full module depenedency graph for the input, ignoring any
   /// modules which have already been seen.
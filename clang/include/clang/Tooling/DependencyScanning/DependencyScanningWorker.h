@@ -64,6 +64,10 @@ public:
                                   DependencyConsumer &Consumer);
 
 private:
+  /// Discards the state that depends on the contents of the file system if
+  /// the shared cache was invalidated since the last invocation.
+  void discardStaleState();
+
   IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts;
   std::shared_ptr<PCHContainerOperations> PCHContainerOps;
   std::unique_ptr<ExcludedPreprocessorDirectiveSkipMapping> PPSkipMappings;
@@ -77,6 +81,9 @@ private:
   /// worker. If null, the file manager will not be reused.
   llvm::IntrusiveRefCntPtr<FileManager> Files;
   ScanningOutputFormat Format;
+  DependencyScanningFilesystemSharedCache &SharedCache;
+  /// The generation of the shared cache the state of the worker is based on.
+  unsigned CacheGeneration;
 };
 
 } // end namespace dependencies
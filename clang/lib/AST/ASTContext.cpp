@@ -953,6 +953,10 @@ static bool isAddrSpaceMapManglingEnabled(const TargetInfo &TI,
   llvm_unreachable("getAddressSpaceMapMangling() doesn't cover anything.");
 }
 
+bool ASTContext::TrackLastAllocation = false;
+const void *ASTContext::LastAllocation = nullptr;
+size_t ASTContext::LastAllocationSize = 0;
+
 ASTContext::ASTContext(LangOptions &LOpts, SourceManager &SM,
                        IdentifierTable &idents, SelectorTable &sels,
                        Builtin::Context &builtins)
@@ -36,6 +36,7 @@
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
@@ -51,6 +52,8 @@ static struct StmtClassNameTable {
   const char *Name;
   unsigned Counter;
   unsigned Size;
+  /// The memory the nodes were allocated with, trailing objects included.
+  uint64_t Bytes;
 } StmtClassInfo[Stmt::lastStmtConstant+1];
 
 static StmtClassNameTable &getStmtInfoTableEntry(Stmt::StmtClass E) {
@@ -108,26 +111,55 @@ void Stmt::PrintStats() {
   }
   llvm::errs() << "  " << sum << " stmts/exprs total.\n";
   sum = 0;
+  uint64_t Allocated = 0;
   for (int i = 0; i != Stmt::lastStmtConstant+1; i++) {
     if (StmtClassInfo[i].Name == nullptr) continue;
     if (StmtClassInfo[i].Counter == 0) continue;
     llvm::errs() << "    " << StmtClassInfo[i].Counter << " "
                  << StmtClassInfo[i].Name << ", " << StmtClassInfo[i].Size
                  << " each (" << StmtClassInfo[i].Counter*StmtClassInfo[i].Size
-                 << " bytes)\n";
+                 << " bytes, " << StmtClassInfo[i].Bytes << " allocated)\n";
     sum += StmtClassInfo[i].Counter*StmtClassInfo[i].Size;
+    Allocated += StmtClassInfo[i].Bytes;
   }
 
   llvm::errs() << "Total bytes = " << sum << "\n";
-}
-
-void Stmt::addStmtClass(StmtClass s) {
-  ++getStmtInfoTableEntry(s).Counter;
+  llvm::errs() << "Total bytes allocated = " << Allocated << "\n";
+
+  // The node kinds that take the most memory, which are the ones worth
+  // shrinking.
+  SmallVector<const StmtClassNameTable *, 16> Hottest;
+  for (const StmtClassNameTable &Info : StmtClassInfo)
+    if (Info.Name && Info.Counter)
+      Hottest.push_back(&Info);
+  llvm::sort(Hottest, [](const StmtClassNameTable *LHS,
+                         const StmtClassNameTable *RHS) {
+    return LHS->Bytes > RHS->Bytes;
+  });
+  if (Hottest.size() > 10)
+    Hottest.resize(10);
+  llvm::errs() << "  Node kinds with the most memory:\n";
+  for (const StmtClassNameTable *Info : Hottest)
+    llvm::errs() << "    " << Info->Name << ": " << Info->Bytes << " bytes, "
+                 << llvm::format("%.1f", double(Info->Bytes) / Info->Counter)
+                 << " per node\n";
+}
+
+void Stmt::addStmtClass(StmtClass s, const Stmt *S) {
+  StmtClassNameTable &Info = getStmtInfoTableEntry(s);
+  ++Info.Counter;
+  // Nodes created by ASTContext allocations are constructed right after
+  // them, which tells the memory their trailing objects take.
+  if (S && S == ASTContext::LastAllocation)
+    Info.Bytes += ASTContext::LastAllocationSize;
+  else
+    Info.Bytes += Info.Size;
 }
 
 bool Stmt::StatisticsEnabled = false;
 void Stmt::EnableStatistics() {
   StatisticsEnabled = true;
+  ASTContext::TrackLastAllocation = true;
 }
 
 static std::pair<Stmt::Likelihood, const Attr *>
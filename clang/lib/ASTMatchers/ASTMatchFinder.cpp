@@ -556,8 +556,8 @@ public:
                          AncestorMatchMode MatchMode) override {
     // Reset the cache outside of the recursive call to make sure we
     // don't invalidate any iterators.
-    if (ResultCache.size() > MaxMemoizationEntries)
-      ResultCache.clear();
+    if (AncestorResultCache.size() > MaxMemoizationEntries)
+      AncestorResultCache.clear();
     if (MatchMode == AncestorMatchMode::AMM_ParentOnly)
       return matchesParentOf(Node, Matcher, Builder);
     return matchesAnyAncestorOf(Node, Ctx, Matcher, Builder);
@@ -808,7 +808,7 @@ private:
     // When returning, update the memoization cache.
     auto Finish = [&](bool Matched) {
       for (const auto &Key : Keys) {
-        MemoizedMatchResult &CachedResult = ResultCache[Key];
+        MemoizedMatchResult &CachedResult = AncestorResultCache[Key];
         CachedResult.ResultOfMatch = Matched;
         CachedResult.Nodes = *Builder;
       }
@@ -828,8 +828,8 @@ private:
         Keys.back().Type = MatchType::Ancestors;
 
         // Check the cache.
-        MemoizationMap::iterator I = ResultCache.find(Keys.back());
-        if (I != ResultCache.end()) {
+        MemoizationMap::iterator I = AncestorResultCache.find(Keys.back());
+        if (I != AncestorResultCache.end()) {
           Keys.pop_back(); // Don't populate the cache for the matching node!
           *Builder = I->second.Nodes;
           return Finish(I->second.ResultOfMatch);
@@ -979,6 +979,12 @@ private:
   // Maps (matcher, node) -> the match result for memoization.
   typedef std::map<MatchKey, MemoizedMatchResult> MemoizationMap;
   MemoizationMap ResultCache;
+  // Same for the ancestor matches. They are kept apart from the child and
+  // descendant matches, which are far more numerous when many matchers are
+  // registered, so that the results for the chains of single parents survive
+  // for the other nodes of the chain, whichever registered matcher they come
+  // from.
+  MemoizationMap AncestorResultCache;
 };
 
 static CXXRecordDecl *
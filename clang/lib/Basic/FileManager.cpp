@@ -67,6 +67,39 @@ void FileManager::setStatCache(std::unique_ptr<FileSystemStatCache> statCache) {
 
 void FileManager::clearStatCache() { StatCache.reset(); }
 
+bool FileManager::isUpToDate() {
+  if (!VirtualFileEntries.empty() || !BypassFileEntries.empty())
+    return false;
+
+  llvm::vfs::Status Status;
+  for (const auto &Entry : SeenDirEntries) {
+    bool Exists =
+        !getNoncachedStatValue(Entry.first(), Status) && Status.isDirectory();
+    if (Exists != bool(Entry.second))
+      return false;
+  }
+
+  for (const auto &Entry : SeenFileEntries) {
+    bool Exists =
+        !getNoncachedStatValue(Entry.first(), Status) && !Status.isDirectory();
+    if (Exists != bool(Entry.second))
+      return false;
+    if (!Exists)
+      continue;
+
+    // Redirections to another name are checked through that name.
+    const FileEntry *FE = Entry.second->V.dyn_cast<FileEntry *>();
+    if (!FE)
+      continue;
+    if (FE->getUniqueID() != Status.getUniqueID() ||
+        FE->getSize() != static_cast<off_t>(Status.getSize()) ||
+        FE->getModificationTime() !=
+            llvm::sys::toTimeT(Status.getLastModificationTime()))
+      return false;
+  }
+  return true;
+}
+
 /// Retrieve the directory that the given file name resides in.
 /// Filename can point to either a real file or a virtual file.
 static llvm::Expected<DirectoryEntryRef>
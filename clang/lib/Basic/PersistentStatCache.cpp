@@ -0,0 +1,354 @@
+//===- PersistentStatCache.cpp - On-disk cache of stats -------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the PersistentStatCache class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/PersistentStatCache.h"
+#include "clang/Basic/FileSystemStatCache.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/DJB.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/OnDiskHashTable.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace clang;
+using namespace llvm::support;
+
+// The cache file starts with a magic number, a version and the offset of the
+// buckets of an on-disk hash table, whose payload follows. The table maps a
+// path to its entry:
+//
+//   uint8  Kind           (0: no stat, 1: missing, 2: exists)
+//   if exists:
+//   uint64 Device, File   (the unique ID)
+//   int64  ModTime        (nanoseconds since the epoch)
+//   uint32 User, Group
+//   uint64 Size
+//   uint8  Type, IsVFSMapped
+//   uint32 Permissions
+//   uint16 NameLength     (0 if the status has the name of the path)
+//   char   Name[NameLength]
+//   endif
+//   uint16 GuardLength
+//   char   Guard[GuardLength]
+static const char CacheMagic[4] = {'C', 'S', 'T', 'C'};
+static const uint32_t CacheVersion = 1;
+static const unsigned CacheHeaderSize = 12;
+
+enum EntryKind : uint8_t { EK_NoStat, EK_Missing, EK_Exists };
+
+namespace {
+
+class StatCacheReaderTrait {
+public:
+  using external_key_type = StringRef;
+  using internal_key_type = StringRef;
+  using data_type = PersistentStatCache::Entry;
+  using hash_value_type = uint32_t;
+  using offset_type = uint32_t;
+
+  static bool EqualKey(internal_key_type A, internal_key_type B) {
+    return A == B;
+  }
+
+  static hash_value_type ComputeHash(internal_key_type Key) {
+    return llvm::djbHash(Key);
+  }
+
+  static internal_key_type GetInternalKey(external_key_type Key) { return Key; }
+  static external_key_type GetExternalKey(internal_key_type Key) { return Key; }
+
+  static std::pair<offset_type, offset_type>
+  ReadKeyDataLength(const unsigned char *&D) {
+    unsigned KeyLen = endian::readNext<uint16_t, little, unaligned>(D);
+    unsigned DataLen = endian::readNext<uint16_t, little, unaligned>(D);
+    return std::make_pair(KeyLen, DataLen);
+  }
+
+  static internal_key_type ReadKey(const unsigned char *D, offset_type N) {
+    return StringRef(reinterpret_cast<const char *>(D), N);
+  }
+
+  static data_type ReadData(internal_key_type Key, const unsigned char *D,
+                            offset_type) {
+    data_type Result;
+    uint8_t Kind = *D++;
+    Result.HasStat = Kind != EK_NoStat;
+    if (Kind == EK_Exists) {
+      uint64_t Device = endian::readNext<uint64_t, little, unaligned>(D);
+      uint64_t File = endian::readNext<uint64_t, little, unaligned>(D);
+      int64_t ModTime = endian::readNext<int64_t, little, unaligned>(D);
+      uint32_t User = endian::readNext<uint32_t, little, unaligned>(D);
+      uint32_t Group = endian::readNext<uint32_t, little, unaligned>(D);
+      uint64_t Size = endian::readNext<uint64_t, little, unaligned>(D);
+      auto Type = static_cast<llvm::sys::fs::file_type>(*D++);
+      bool IsVFSMapped = *D++;
+      auto Perms = static_cast<llvm::sys::fs::perms>(
+          endian::readNext<uint32_t, little, unaligned>(D));
+      unsigned NameLen = endian::readNext<uint16_t, little, unaligned>(D);
+      StringRef Name =
+          NameLen ? StringRef(reinterpret_cast<const char *>(D), NameLen)
+                  : Key;
+      D += NameLen;
+      Result.Status = llvm::vfs::Status(
+          Name, llvm::sys::fs::UniqueID(Device, File),
+          llvm::sys::TimePoint<>(std::chrono::nanoseconds(ModTime)), User,
+          Group, Size, Type, Perms);
+      Result.Status->IsVFSMapped = IsVFSMapped;
+    }
+    unsigned GuardLen = endian::readNext<uint16_t, little, unaligned>(D);
+    Result.IncludeGuard =
+        std::string(reinterpret_cast<const char *>(D), GuardLen);
+    return Result;
+  }
+};
+
+class StatCacheWriterTrait {
+public:
+  using key_type = StringRef;
+  using key_type_ref = StringRef;
+  using data_type = PersistentStatCache::Entry;
+  using data_type_ref = const PersistentStatCache::Entry &;
+  using hash_value_type = uint32_t;
+  using offset_type = uint32_t;
+
+  static hash_value_type ComputeHash(key_type_ref Key) {
+    return llvm::djbHash(Key);
+  }
+
+  static StringRef getStatusName(key_type_ref Key, data_type_ref Data) {
+    StringRef Name = Data.Status->getName();
+    return Name == Key ? StringRef() : Name;
+  }
+
+  std::pair<offset_type, offset_type>
+  EmitKeyDataLength(raw_ostream &Out, key_type_ref Key, data_type_ref Data) {
+    endian::Writer LE(Out, little);
+    unsigned DataLen = 1 + 2 + Data.IncludeGuard.size();
+    if (Data.Status)
+      DataLen += 8 + 8 + 8 + 4 + 4 + 8 + 1 + 1 + 4 + 2 +
+                 getStatusName(Key, Data).size();
+    LE.write<uint16_t>(Key.size());
+    LE.write<uint16_t>(DataLen);
+    return std::make_pair(Key.size(), DataLen);
+  }
+
+  void EmitKey(raw_ostream &Out, key_type_ref Key, offset_type) {
+    Out << Key;
+  }
+
+  void EmitData(raw_ostream &Out, key_type_ref Key, data_type_ref Data,
+                offset_type) {
+    endian::Writer LE(Out, little);
+    if (!Data.HasStat) {
+      LE.write<uint8_t>(EK_NoStat);
+    } else if (!Data.Status) {
+      LE.write<uint8_t>(EK_Missing);
+    } else {
+      const llvm::vfs::Status &Status = *Data.Status;
+      LE.write<uint8_t>(EK_Exists);
+      LE.write<uint64_t>(Status.getUniqueID().getDevice());
+      LE.write<uint64_t>(Status.getUniqueID().getFile());
+      LE.write<int64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              Status.getLastModificationTime().time_since_epoch())
+              .count());
+      LE.write<uint32_t>(Status.getUser());
+      LE.write<uint32_t>(Status.getGroup());
+      LE.write<uint64_t>(Status.getSize());
+      LE.write<uint8_t>(static_cast<uint8_t>(Status.getType()));
+      LE.write<uint8_t>(Status.IsVFSMapped);
+      LE.write<uint32_t>(Status.getPermissions());
+      StringRef Name = getStatusName(Key, Data);
+      LE.write<uint16_t>(Name.size());
+      Out << Name;
+    }
+    LE.write<uint16_t>(Data.IncludeGuard.size());
+    Out << Data.IncludeGuard;
+  }
+};
+
+/// A FileSystemStatCache that answers from a PersistentStatCache, and records
+/// the results of the calls it forwards to the file system in it.
+class PersistentStatCacheAdaptor : public FileSystemStatCache {
+  std::shared_ptr<PersistentStatCache> Cache;
+
+public:
+  PersistentStatCacheAdaptor(std::shared_ptr<PersistentStatCache> Cache)
+      : Cache(std::move(Cache)) {}
+
+  std::error_code getStat(StringRef Path, llvm::vfs::Status &Status,
+                          bool isFile, std::unique_ptr<llvm::vfs::File> *F,
+                          llvm::vfs::FileSystem &FS) override {
+    if (llvm::Optional<PersistentStatCache::Entry> E = Cache->lookup(Path)) {
+      if (E->HasStat) {
+        if (!E->Status)
+          return std::make_error_code(std::errc::no_such_file_or_directory);
+        Status = *E->Status;
+        return std::error_code();
+      }
+    }
+
+    std::error_code EC = get(Path, Status, isFile, F, nullptr, FS);
+    if (!EC || EC == std::errc::is_a_directory ||
+        EC == std::errc::not_a_directory)
+      // The status has been filled in even if it isn't what the client
+      // wanted; FileSystemStatCache::get checks that on every lookup.
+      Cache->addStatus(Path, &Status);
+    else if (EC == std::errc::no_such_file_or_directory)
+      Cache->addStatus(Path, nullptr);
+    return EC;
+  }
+};
+
+} // namespace
+
+class PersistentStatCache::OnDiskTable {
+public:
+  using TableType = llvm::OnDiskIterableChainedHashTable<StatCacheReaderTrait>;
+
+  std::unique_ptr<TableType> Table;
+};
+
+PersistentStatCache::PersistentStatCache(StringRef CacheFile)
+    : CacheFile(CacheFile) {}
+
+PersistentStatCache::~PersistentStatCache() = default;
+
+std::shared_ptr<PersistentStatCache>
+PersistentStatCache::load(StringRef CacheFile, uint64_t SessionTimestamp) {
+  std::shared_ptr<PersistentStatCache> Cache(
+      new PersistentStatCache(CacheFile));
+
+  // Results from a previous build session can't be trusted.
+  llvm::sys::fs::file_status Status;
+  if (llvm::sys::fs::status(CacheFile, Status) ||
+      uint64_t(llvm::sys::toTimeT(Status.getLastModificationTime())) <
+          SessionTimestamp)
+    return Cache;
+
+  auto BufferOrErr =
+      llvm::MemoryBuffer::getFile(CacheFile, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (!BufferOrErr)
+    return Cache;
+  std::unique_ptr<llvm::MemoryBuffer> Buffer = std::move(*BufferOrErr);
+
+  StringRef Data = Buffer->getBuffer();
+  if (Data.size() < CacheHeaderSize ||
+      memcmp(Data.data(), CacheMagic, sizeof(CacheMagic)) != 0)
+    return Cache;
+  const auto *Base =
+      reinterpret_cast<const unsigned char *>(Buffer->getBufferStart());
+  const unsigned char *D = Base + sizeof(CacheMagic);
+  uint32_t Version = endian::readNext<uint32_t, little, unaligned>(D);
+  uint32_t BucketOffset = endian::readNext<uint32_t, little, unaligned>(D);
+  // The buckets hold the number of buckets and entries, and must be aligned.
+  if (Version != CacheVersion || BucketOffset < CacheHeaderSize ||
+      BucketOffset % 4 != 0 || BucketOffset + 8 > Data.size())
+    return Cache;
+
+  Cache->Table = std::make_unique<OnDiskTable>();
+  Cache->Table->Table.reset(OnDiskTable::TableType::Create(
+      Base + BucketOffset, Base + CacheHeaderSize, Base));
+  Cache->Buffer = std::move(Buffer);
+  return Cache;
+}
+
+std::string PersistentStatCache::getCacheFileName(StringRef CacheDir,
+                                                  StringRef Key) {
+  SmallString<128> Path(CacheDir);
+  llvm::sys::path::append(Path, "stat-" + Key + ".cache");
+  return std::string(Path.str());
+}
+
+std::unique_ptr<FileSystemStatCache>
+PersistentStatCache::createFileSystemStatCache(
+    std::shared_ptr<PersistentStatCache> Cache) {
+  return std::make_unique<PersistentStatCacheAdaptor>(std::move(Cache));
+}
+
+llvm::Optional<PersistentStatCache::Entry>
+PersistentStatCache::lookup(StringRef Path) const {
+  auto Known = NewEntries.find(Path);
+  if (Known != NewEntries.end())
+    return Known->second;
+
+  if (!Table)
+    return None;
+  auto Pos = Table->Table->find(Path);
+  if (Pos == Table->Table->end())
+    return None;
+  return *Pos;
+}
+
+void PersistentStatCache::addStatus(StringRef Path,
+                                    const llvm::vfs::Status *Status) {
+  Entry E = lookup(Path).getValueOr(Entry());
+  E.HasStat = true;
+  E.Status.reset();
+  if (Status)
+    E.Status = *Status;
+  NewEntries[Path] = std::move(E);
+}
+
+std::string PersistentStatCache::getIncludeGuard(StringRef Path) const {
+  if (llvm::Optional<Entry> E = lookup(Path))
+    return E->IncludeGuard;
+  return std::string();
+}
+
+void PersistentStatCache::addIncludeGuard(StringRef Path, StringRef Macro) {
+  Entry E = lookup(Path).getValueOr(Entry());
+  if (E.IncludeGuard == Macro)
+    return;
+  E.IncludeGuard = std::string(Macro);
+  NewEntries[Path] = std::move(E);
+}
+
+llvm::Error PersistentStatCache::write() {
+  if (NewEntries.empty())
+    return llvm::Error::success();
+
+  llvm::OnDiskChainedHashTableGenerator<StatCacheWriterTrait> Generator;
+  StatCacheWriterTrait Trait;
+  // Keep the entries of the table alive until the new table is emitted.
+  std::vector<std::pair<StringRef, Entry>> OldEntries;
+  if (Table) {
+    auto Data = Table->Table->data_begin();
+    for (auto Key = Table->Table->key_begin(), End = Table->Table->key_end();
+         Key != End; ++Key, ++Data)
+      if (!NewEntries.count(*Key))
+        OldEntries.emplace_back(*Key, *Data);
+  }
+  for (const auto &E : OldEntries)
+    Generator.insert(E.first, E.second, Trait);
+  for (const auto &E : NewEntries)
+    Generator.insert(E.first(), E.second, Trait);
+
+  SmallString<0> Contents;
+  llvm::raw_svector_ostream OS(Contents);
+  OS.write(CacheMagic, sizeof(CacheMagic));
+  endian::Writer LE(OS, little);
+  LE.write<uint32_t>(CacheVersion);
+  LE.write<uint32_t>(0);
+  uint32_t BucketOffset = Generator.Emit(OS, Trait);
+  endian::write32le(&Contents[8], BucketOffset);
+
+  StringRef Dir = llvm::sys::path::parent_path(CacheFile);
+  if (!Dir.empty())
+    if (std::error_code EC = llvm::sys::fs::create_directories(Dir))
+      return llvm::errorCodeToError(EC);
+  return llvm::writeFileAtomically(CacheFile + "-%%%%%%%%", CacheFile,
+                                   Contents);
+}
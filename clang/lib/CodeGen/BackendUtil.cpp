@@ -231,6 +231,7 @@ getSancovOptsFromCGOpts(const CodeGenOptions &CGOpts) {
   Opts.InlineBoolFlag = CGOpts.SanitizeCoverageInlineBoolFlag;
   Opts.PCTable = CGOpts.SanitizeCoveragePCTable;
   Opts.StackDepth = CGOpts.SanitizeCoverageStackDepth;
+  Opts.SamplePeriod = CGOpts.SanitizeCoverageSamplePeriod;
   return Opts;
 }
 
@@ -382,6 +383,20 @@ static TargetLibraryInfoImpl *createTLII(llvm::Triple &TargetTriple,
         break;
     }
     break;
+  case CodeGenOptions::LLVMLibc:
+    switch (TargetTriple.getArch()) {
+    default:
+      break;
+    case llvm::Triple::x86_64:
+      TLII->addVectorizableFunctionsFromVecLib(
+          TargetLibraryInfoImpl::LLVMLIBC_X86);
+      break;
+    case llvm::Triple::aarch64:
+      TLII->addVectorizableFunctionsFromVecLib(
+          TargetLibraryInfoImpl::LLVMLIBC_AARCH64);
+      break;
+    }
+    break;
   case CodeGenOptions::MASSV:
     TLII->addVectorizableFunctionsFromVecLib(TargetLibraryInfoImpl::MASSV);
     break;
@@ -611,6 +626,10 @@ getInstrProfOptions(const CodeGenOptions &CodeGenOpts,
   Options.NoRedZone = CodeGenOpts.DisableRedZone;
   Options.InstrProfileOutput = CodeGenOpts.InstrProfileOutput;
   Options.Atomic = CodeGenOpts.AtomicProfileUpdate;
+  // Keep loop counter updates in registers and flush them at the loop exits,
+  // which saves a load and a store of a (possibly shared) counter per
+  // iteration.
+  Options.DoCounterPromotion = CodeGenOpts.OptimizationLevel > 0;
   return Options;
 }
 
@@ -993,6 +1012,12 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
 
   // Run passes. For now we do all passes at once, but eventually we
   // would like to have the option of streaming code generation.
+  //
+  // FIXME: Streaming the functions to a backend thread while Sema keeps
+  // parsing needs more than a pass pipeline that runs on one function: CodeGen
+  // still changes finished functions (deferred replacements, aliases, the
+  // removal of unused declarations in CodeGenModule::Release), and both sides
+  // would share the non thread-safe LLVMContext of the module.
 
   {
     PrettyStackTraceString CrashInfo("Per-function optimization");
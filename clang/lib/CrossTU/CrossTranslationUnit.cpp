@@ -24,6 +24,8 @@
 #include "llvm/ADT/Triple.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/YAMLParser.h"
@@ -365,7 +367,8 @@ void CrossTranslationUnitContext::emitCrossTUDiagnostics(const IndexError &IE) {
 CrossTranslationUnitContext::ASTUnitStorage::ASTUnitStorage(
     CompilerInstance &CI)
     : Loader(CI, CI.getAnalyzerOpts()->CTUDir,
-             CI.getAnalyzerOpts()->CTUInvocationList),
+             CI.getAnalyzerOpts()->CTUInvocationList,
+             CI.getAnalyzerOpts()->CTUASTCacheDir),
       LoadGuard(CI.getASTContext().getLangOpts().CPlusPlus
                     ? CI.getAnalyzerOpts()->CTUImportCppThreshold
                     : CI.getAnalyzerOpts()->CTUImportThreshold) {}
@@ -503,8 +506,10 @@ llvm::Expected<ASTUnit *> CrossTranslationUnitContext::loadExternalAST(
 }
 
 CrossTranslationUnitContext::ASTLoader::ASTLoader(
-    CompilerInstance &CI, StringRef CTUDir, StringRef InvocationListFilePath)
-    : CI(CI), CTUDir(CTUDir), InvocationListFilePath(InvocationListFilePath) {}
+    CompilerInstance &CI, StringRef CTUDir, StringRef InvocationListFilePath,
+    StringRef ASTCacheDir)
+    : CI(CI), CTUDir(CTUDir), InvocationListFilePath(InvocationListFilePath),
+      ASTCacheDir(ASTCacheDir) {}
 
 CrossTranslationUnitContext::LoadResultTy
 CrossTranslationUnitContext::ASTLoader::load(StringRef Identifier) {
@@ -569,6 +574,24 @@ CrossTranslationUnitContext::ASTLoader::loadFromSource(
 
   const InvocationListTy::mapped_type &InvocationCommand = Invocation->second;
 
+  // The cached AST is named after the source file and its invocation, so
+  // that an AST is only reused for the same command-line.
+  SmallString<256> CachePath;
+  if (!ASTCacheDir.empty()) {
+    llvm::MD5 Hash;
+    Hash.update(SourceFilePath);
+    for (const std::string &CmdPart : InvocationCommand) {
+      Hash.update(llvm::ArrayRef<uint8_t>{0});
+      Hash.update(CmdPart);
+    }
+    llvm::MD5::MD5Result Result;
+    Hash.final(Result);
+    CachePath = ASTCacheDir;
+    llvm::sys::path::append(CachePath, Result.digest() + ".ast");
+    if (std::unique_ptr<ASTUnit> Unit = loadFromCache(CachePath))
+      return std::move(Unit);
+  }
+
   SmallVector<const char *, 32> CommandLineArgs(InvocationCommand.size());
   std::transform(InvocationCommand.begin(), InvocationCommand.end(),
                  CommandLineArgs.begin(),
@@ -581,10 +604,32 @@ CrossTranslationUnitContext::ASTLoader::loadFromSource(
   IntrusiveRefCntPtr<DiagnosticsEngine> Diags(
       new DiagnosticsEngine{DiagID, &*DiagOpts, DiagClient});
 
-  return std::unique_ptr<ASTUnit>(ASTUnit::LoadFromCommandLine(
+  std::unique_ptr<ASTUnit> Unit(ASTUnit::LoadFromCommandLine(
       CommandLineArgs.begin(), (CommandLineArgs.end()),
       CI.getPCHContainerOperations(), Diags,
       CI.getHeaderSearchOpts().ResourceDir));
+
+  // Failing to store the AST only costs the other processes a parse.
+  if (Unit && !CachePath.empty() &&
+      !Unit->getDiagnostics().hasErrorOccurred() &&
+      !llvm::sys::fs::create_directories(ASTCacheDir))
+    Unit->Save(CachePath);
+  return std::move(Unit);
+}
+
+std::unique_ptr<ASTUnit>
+CrossTranslationUnitContext::ASTLoader::loadFromCache(StringRef CachePath) {
+  if (!llvm::sys::fs::exists(CachePath))
+    return nullptr;
+  // The AST is out of date if a file it was built from changed since. The
+  // reader reports it, and the source-file is parsed again.
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
+  IntrusiveRefCntPtr<DiagnosticsEngine> Diags(
+      new DiagnosticsEngine(DiagID, &*DiagOpts, new IgnoringDiagConsumer()));
+  return ASTUnit::LoadFromASTFile(
+      std::string(CachePath), CI.getPCHContainerOperations()->getRawReader(),
+      ASTUnit::LoadEverything, Diags, CI.getFileSystemOpts());
 }
 
 llvm::Expected<InvocationListTy>
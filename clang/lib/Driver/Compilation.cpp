@@ -18,6 +18,7 @@
 #include "llvm/ADT/None.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/OptSpecifier.h"
@@ -25,8 +26,10 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cassert>
+#include <condition_variable>
 #include <string>
 #include <system_error>
+#include <thread>
 #include <utility>
 
 using namespace clang;
@@ -165,6 +168,7 @@ int Compilation::ExecuteCommand(const Command &C,
                                 const Command *&FailingCommand) const {
   if ((getDriver().CCPrintOptions ||
        getArgs().hasArg(options::OPT_v)) && !getDriver().CCGenDiagnostics) {
+    std::lock_guard<std::mutex> Lock(JobOutputMutex);
     raw_ostream *OS = &llvm::errs();
     std::unique_ptr<llvm::raw_fd_ostream> OwnedStream;
 
@@ -193,6 +197,7 @@ int Compilation::ExecuteCommand(const Command &C,
   std::string Error;
   bool ExecutionFailed;
   int Res = C.Execute(Redirects, &Error, &ExecutionFailed);
+  std::lock_guard<std::mutex> Lock(JobOutputMutex);
   if (PostCallback)
     PostCallback(C, Res);
   if (!Error.empty()) {
@@ -237,6 +242,10 @@ static bool InputsOk(const Command &C,
 
 void Compilation::ExecuteJobs(const JobList &Jobs,
                               FailingCommandList &FailingCommands) const {
+  if (TheDriver.NumParallelJobs > 1 && Jobs.size() > 1)
+    return ExecuteJobsInParallel(Jobs, FailingCommands,
+                                 TheDriver.NumParallelJobs);
+
   // According to UNIX standard, driver need to continue compiling all the
   // inputs on the command line even one of them failed.
   // In all but CLMode, execute all the jobs unless the necessary inputs for the
@@ -254,6 +263,83 @@ void Compilation::ExecuteJobs(const JobList &Jobs,
   }
 }
 
+void Compilation::ExecuteJobsInParallel(const JobList &Jobs,
+                                        FailingCommandList &FailingCommands,
+                                        unsigned NumThreads) const {
+  // The jobs are listed in an order where each job comes after the jobs that
+  // produce its inputs.
+  SmallVector<const Command *, 8> Commands;
+  std::vector<SmallVector<unsigned, 2>> Dependencies;
+  llvm::StringMap<unsigned> Producers;
+  for (const auto &Job : Jobs) {
+    SmallVector<unsigned, 2> Deps;
+    for (const char *Input : Job.getInputFilenames()) {
+      auto It = Producers.find(Input);
+      if (It != Producers.end())
+        Deps.push_back(It->second);
+    }
+    for (const std::string &Output : Job.getOutputFilenames())
+      Producers[Output] = Commands.size();
+    Commands.push_back(&Job);
+    Dependencies.push_back(std::move(Deps));
+  }
+
+  enum JobState { Pending, Running, Finished };
+  std::vector<JobState> States(Commands.size(), Pending);
+  std::mutex Mutex;
+  std::condition_variable JobFinished;
+  bool Stop = false;
+
+  auto RunJobs = [&]() {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    while (true) {
+      // Pick the first job whose dependencies are done.
+      bool HasPending = false;
+      Optional<unsigned> Next;
+      for (unsigned I = 0, E = Commands.size(); I != E && !Next; ++I) {
+        if (States[I] != Pending)
+          continue;
+        HasPending = true;
+        if (llvm::all_of(Dependencies[I],
+                         [&](unsigned D) { return States[D] == Finished; }))
+          Next = I;
+      }
+      if (Stop || !HasPending)
+        return;
+      if (!Next) {
+        JobFinished.wait(Lock);
+        continue;
+      }
+
+      const Command &Job = *Commands[*Next];
+      States[*Next] = Running;
+      int Res = 0;
+      const Command *FailingCommand = nullptr;
+      if (InputsOk(Job, FailingCommands)) {
+        Lock.unlock();
+        Res = ExecuteCommand(Job, FailingCommand);
+        Lock.lock();
+      }
+      States[*Next] = Finished;
+      if (Res) {
+        FailingCommands.push_back(std::make_pair(Res, FailingCommand));
+        // Bail as soon as one command fails in cl driver mode.
+        if (TheDriver.IsCLMode())
+          Stop = true;
+      }
+      JobFinished.notify_all();
+    }
+  };
+
+  std::vector<std::thread> Threads;
+  for (unsigned I = 1, E = std::min<size_t>(NumThreads, Commands.size());
+       I < E; ++I)
+    Threads.emplace_back(RunJobs);
+  RunJobs();
+  for (std::thread &Thread : Threads)
+    Thread.join();
+}
+
 void Compilation::initCompilationForDiagnostics() {
   ForDiagnostics = true;
 
@@ -1071,6 +1071,18 @@ Compilation *Driver::BuildCompilation(ArrayRef<const char *> ArgList) {
   // Ignore -pipe.
   Args.ClaimAllArgs(options::OPT_pipe);
 
+  if (const Arg *A = Args.getLastArg(options::OPT_parallel_jobs_EQ)) {
+    StringRef Value = A->getValue();
+    if (Value.getAsInteger(10, NumParallelJobs) || NumParallelJobs == 0) {
+      Diag(diag::err_drv_invalid_int_value) << A->getAsString(Args) << Value;
+      NumParallelJobs = 1;
+    }
+  }
+  // The in-process cc1 isn't thread-safe, so jobs that run in parallel must
+  // run in their own processes.
+  if (NumParallelJobs > 1)
+    CC1Main = nullptr;
+
   // Extract -ccc args.
   //
   // FIXME: We need to figure out where this behavior should live. Most of it
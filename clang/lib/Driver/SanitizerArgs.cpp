@@ -759,6 +759,13 @@ SanitizerArgs::SanitizerArgs(const ToolChain &TC,
         D, Args, CoverageBlocklistFiles,
         options::OPT_fsanitize_coverage_blocklist, OptSpecifier(),
         clang::diag::err_drv_malformed_sanitizer_coverage_blacklist);
+
+    if (Arg *A =
+            Args.getLastArg(options::OPT_fsanitize_coverage_sample_period_EQ)) {
+      StringRef S = A->getValue();
+      if (S.getAsInteger(0, CoverageSamplePeriod))
+        D.Diag(clang::diag::err_drv_invalid_value) << A->getAsString(Args) << S;
+    }
   }
 
   SharedRuntime =
@@ -968,6 +975,9 @@ void SanitizerArgs::addArgs(const ToolChain &TC, const llvm::opt::ArgList &Args,
       Args, CmdArgs, "-fsanitize-coverage-allowlist=", CoverageAllowlistFiles);
   addSpecialCaseListOpt(
       Args, CmdArgs, "-fsanitize-coverage-blocklist=", CoverageBlocklistFiles);
+  if (CoverageSamplePeriod > 1)
+    CmdArgs.push_back(Args.MakeArgString("-fsanitize-coverage-sample-period=" +
+                                         Twine(CoverageSamplePeriod)));
 
   if (TC.getTriple().isOSWindows() && needsUbsanRt()) {
     // Instruct the code generator to embed linker directives in the object file
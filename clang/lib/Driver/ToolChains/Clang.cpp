@@ -3453,6 +3453,14 @@ static void RenderModulesOptions(Compilation &C, const Driver &D,
                     options::OPT_fmodules_validate_once_per_build_session);
   }
 
+  if (Args.getLastArg(options::OPT_fheader_stat_cache_path_EQ)) {
+    if (!Args.getLastArg(options::OPT_fbuild_session_timestamp,
+                         options::OPT_fbuild_session_file))
+      D.Diag(diag::err_drv_header_stat_cache_requires_timestamp);
+
+    Args.AddLastArg(CmdArgs, options::OPT_fheader_stat_cache_path_EQ);
+  }
+
   if (Args.hasFlag(options::OPT_fmodules_validate_system_headers,
                    options::OPT_fno_modules_validate_system_headers,
                    ImplicitModules))
@@ -5512,6 +5520,7 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   Args.AddLastArg(CmdArgs, options::OPT_ftime_report_EQ);
   Args.AddLastArg(CmdArgs, options::OPT_ftime_trace);
   Args.AddLastArg(CmdArgs, options::OPT_ftime_trace_granularity_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_ftime_trace_memory);
   Args.AddLastArg(CmdArgs, options::OPT_ftrapv);
   Args.AddLastArg(CmdArgs, options::OPT_malign_double);
   Args.AddLastArg(CmdArgs, options::OPT_fno_temp_file);
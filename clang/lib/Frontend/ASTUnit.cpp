@@ -1385,6 +1385,8 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
     } else {
       switch (static_cast<BuildPreambleError>(NewPreamble.getError().value())) {
       case BuildPreambleError::CouldntCreateTempFile:
+      case BuildPreambleError::StoredPreambleInvalid:
+      case BuildPreambleError::Cancelled:
         // Try again next time.
         PreambleRebuildCountdown = 1;
         return nullptr;
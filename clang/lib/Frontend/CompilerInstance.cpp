@@ -14,6 +14,7 @@
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/LangStandard.h"
+#include "clang/Basic/PersistentStatCache.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/Stack.h"
 #include "clang/Basic/TargetInfo.h"
@@ -36,6 +37,8 @@
 #include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/GlobalModuleIndex.h"
 #include "clang/Serialization/InMemoryModuleCache.h"
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/BuryPointer.h"
 #include "llvm/Support/CrashRecoveryContext.h"
@@ -311,6 +314,23 @@ CompilerInstance::createDiagnostics(DiagnosticOptions *Opts,
 
 // File Manager
 
+/// Computes the key of the persistent stat cache, which covers everything that
+/// changes how the paths seen by the compiler map to files.
+static std::string getStatCacheKey(const CompilerInvocation &Invocation,
+                                   llvm::vfs::FileSystem &VFS) {
+  llvm::hash_code Code = llvm::hash_value(getClangFullRepositoryVersion());
+  if (llvm::ErrorOr<std::string> CWD = VFS.getCurrentWorkingDirectory())
+    Code = llvm::hash_combine(Code, *CWD);
+  Code = llvm::hash_combine(Code, Invocation.getFileSystemOpts().WorkingDir);
+  for (const std::string &File :
+       Invocation.getHeaderSearchOpts().VFSOverlayFiles) {
+    Code = llvm::hash_combine(Code, File);
+    if (auto Buffer = llvm::MemoryBuffer::getFile(File))
+      Code = llvm::hash_combine(Code, (*Buffer)->getBuffer());
+  }
+  return llvm::APInt(64, Code).toString(36, /*Signed=*/false);
+}
+
 FileManager *CompilerInstance::createFileManager(
     IntrusiveRefCntPtr<llvm::vfs::FileSystem> VFS) {
   if (!VFS)
@@ -318,7 +338,18 @@ FileManager *CompilerInstance::createFileManager(
                   : createVFSFromCompilerInvocation(getInvocation(),
                                                     getDiagnostics());
   assert(VFS && "FileManager has no VFS?");
-  FileMgr = new FileManager(getFileSystemOpts(), std::move(VFS));
+  FileMgr = new FileManager(getFileSystemOpts(), VFS);
+
+  const HeaderSearchOptions &HSOpts = getHeaderSearchOpts();
+  if (!HSOpts.StatCachePath.empty()) {
+    if (!StatCache)
+      StatCache = PersistentStatCache::load(
+          PersistentStatCache::getCacheFileName(
+              HSOpts.StatCachePath, getStatCacheKey(getInvocation(), *VFS)),
+          HSOpts.BuildSessionTimestamp);
+    FileMgr->setStatCache(
+        PersistentStatCache::createFileSystemStatCache(StatCache));
+  }
   return FileMgr.get();
 }
 
@@ -396,6 +427,7 @@ void CompilerInstance::createPreprocessor(TranslationUnitKind TUKind) {
   HeaderSearch *HeaderInfo =
       new HeaderSearch(getHeaderSearchOptsPtr(), getSourceManager(),
                        getDiagnostics(), getLangOpts(), &getTarget());
+  HeaderInfo->setPersistentStatCache(StatCache);
   PP = std::make_shared<Preprocessor>(Invocation->getPreprocessorOptsPtr(),
                                       getDiagnostics(), getLangOpts(),
                                       getSourceManager(), *HeaderInfo, *this,
@@ -995,6 +1027,12 @@ bool CompilerInstance::ExecuteAction(FrontendAction &Act) {
     }
   }
 
+  // Share what we learned about the file system with the other compilations.
+  if (StatCache)
+    if (llvm::Error Err = StatCache->write())
+      getDiagnostics().Report(diag::warn_fe_unable_to_write_header_stat_cache)
+          << StatCache->getCacheFile() << llvm::toString(std::move(Err));
+
   // Notify the diagnostic client that all files were processed.
   getDiagnostics().getClient()->finish();
 
@@ -707,6 +707,14 @@ static void parseAnalyzerConfigs(AnalyzerOptions &AnOpts,
     Diags->Report(diag::err_analyzer_config_invalid_input)
         << "track-conditions-debug" << "'track-conditions' to also be enabled";
 
+  if (AnOpts.ShardCount == 0)
+    Diags->Report(diag::err_analyzer_config_invalid_input)
+        << "shard-count" << "a positive number";
+
+  if (AnOpts.ShardIndex >= std::max(AnOpts.ShardCount, 1u))
+    Diags->Report(diag::err_analyzer_config_invalid_input)
+        << "shard-index" << "a number lower than 'shard-count'";
+
   if (!AnOpts.CTUDir.empty() && !llvm::sys::fs::is_directory(AnOpts.CTUDir))
     Diags->Report(diag::err_analyzer_config_invalid_input) << "ctu-dir"
                                                            << "a filename";
@@ -881,6 +889,8 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
       Opts.setVecLib(CodeGenOptions::Accelerate);
     else if (Name == "libmvec")
       Opts.setVecLib(CodeGenOptions::LIBMVEC);
+    else if (Name == "llvmlibc")
+      Opts.setVecLib(CodeGenOptions::LLVMLibc);
     else if (Name == "MASSV")
       Opts.setVecLib(CodeGenOptions::MASSV);
     else if (Name == "SVML")
@@ -1209,6 +1219,8 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
       Args.getAllArgValues(OPT_fsanitize_coverage_allowlist);
   Opts.SanitizeCoverageBlocklistFiles =
       Args.getAllArgValues(OPT_fsanitize_coverage_blocklist);
+  Opts.SanitizeCoverageSamplePeriod = getLastArgIntValue(
+      Args, OPT_fsanitize_coverage_sample_period_EQ, 0, Diags);
   Opts.SanitizeMemoryTrackOrigins =
       getLastArgIntValue(Args, OPT_fsanitize_memory_track_origins_EQ, 0, Diags);
   Opts.SSPBufferSize =
@@ -2044,6 +2056,8 @@ static void ParseHeaderSearchArgs(HeaderSearchOptions &Opts, ArgList &Args,
       getLastArgIntValue(Args, OPT_fmodules_prune_after, 31 * 24 * 60 * 60);
   Opts.BuildSessionTimestamp =
       getLastArgUInt64Value(Args, OPT_fbuild_session_timestamp, 0);
+  Opts.StatCachePath =
+      std::string(Args.getLastArgValue(OPT_fheader_stat_cache_path_EQ));
   if (const Arg *A = Args.getLastArg(OPT_fmodule_format_EQ))
     Opts.ModuleFormat = A->getValue();
 
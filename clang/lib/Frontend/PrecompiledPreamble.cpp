@@ -20,6 +20,7 @@
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Frontend/FrontendOptions.h"
 #include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/HeaderSearchOptions.h"
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Lex/PreprocessorOptions.h"
@@ -30,7 +31,9 @@
 #include "llvm/ADT/iterator_range.h"
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Support/CrashRecoveryContext.h"
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/VirtualFileSystem.h"
@@ -202,6 +205,7 @@ public:
                                                  StringRef InFile) override;
 
   bool hasEmittedPreamblePCH() const { return HasEmittedPreamblePCH; }
+  bool isCancelled() const { return Cancelled; }
 
   void setEmittedPreamblePCH(ASTWriter &Writer) {
     this->HasEmittedPreamblePCH = true;
@@ -222,6 +226,7 @@ private:
   friend class PrecompilePreambleConsumer;
 
   bool HasEmittedPreamblePCH = false;
+  bool Cancelled = false;
   std::string *InMemStorage;
   PreambleCallbacks &Callbacks;
 };
@@ -241,6 +246,11 @@ public:
 
   bool HandleTopLevelDecl(DeclGroupRef DG) override {
     Action.Callbacks.HandleTopLevelDecl(DG);
+    // Returning false stops the parser before the PCH is emitted.
+    if (Action.Callbacks.shouldCancel()) {
+      Action.Cancelled = true;
+      return false;
+    }
     return true;
   }
 
@@ -300,6 +310,88 @@ template <class T> bool moveOnNoError(llvm::ErrorOr<T> Val, T &Output) {
   return true;
 }
 
+/// The magic number at the start of the preambles in a preamble store.
+const char StoredPreambleMagic[] = "CLPREAM1";
+
+/// Returns the path of the preamble in \p StoreDir for \p Invocation and the
+/// preamble contents. The preambles are content-addressed: the name hashes
+/// the options that affect the PCH and the preamble itself, so that the tools
+/// that build a preamble for the same file with the same options share it.
+std::string getStoredPreamblePath(StringRef StoreDir,
+                                  const CompilerInvocation &Invocation,
+                                  StringRef PreambleContents,
+                                  bool PreambleEndsAtStartOfLine) {
+  llvm::MD5 Hash;
+  auto AddString = [&Hash](StringRef S) {
+    Hash.update(S);
+    Hash.update(StringRef("\0", 1));
+  };
+  // The module hash covers the compiler version, the language, target and
+  // preprocessor options, but not the include paths.
+  AddString(Invocation.getModuleHash());
+  AddString(Invocation.getFrontendOpts().Inputs[0].getFile());
+  for (const auto &Entry : Invocation.getHeaderSearchOpts().UserEntries) {
+    AddString(Entry.Path);
+    uint8_t EntryFlags[] = {uint8_t(Entry.Group), Entry.IsFramework,
+                            Entry.IgnoreSysRoot};
+    Hash.update(EntryFlags);
+  }
+  uint8_t Flags[] = {Invocation.getFrontendOpts().SkipFunctionBodies,
+                     PreambleEndsAtStartOfLine};
+  Hash.update(Flags);
+  Hash.update(PreambleContents);
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+
+  llvm::SmallString<128> Path(StoreDir);
+  llvm::sys::path::append(Path, Result.digest() + ".preamble");
+  return std::string(Path.str());
+}
+
+/// Reads the fields of a preamble in a preamble store, as written by
+/// PrecompiledPreamble::SaveToStore.
+class StoredPreambleReader {
+public:
+  StoredPreambleReader(StringRef Data) : Data(Data) {}
+
+  /// Whether the data was too short for one of the fields.
+  bool failed() const { return Failed; }
+  bool atEnd() const { return Data.empty(); }
+
+  template <typename T> T readInt() {
+    if (Data.size() < sizeof(T)) {
+      Failed = true;
+      return 0;
+    }
+    T Value = llvm::support::endian::read<T, llvm::support::little,
+                                          llvm::support::unaligned>(
+        Data.data());
+    Data = Data.drop_front(sizeof(T));
+    return Value;
+  }
+
+  StringRef readBytes(uint64_t Size) {
+    if (Data.size() < Size) {
+      Failed = true;
+      return StringRef();
+    }
+    StringRef Bytes = Data.take_front(Size);
+    Data = Data.drop_front(Size);
+    return Bytes;
+  }
+
+  StringRef readString() { return readBytes(readInt<uint32_t>()); }
+
+private:
+  StringRef Data;
+  bool Failed = false;
+};
+
+void writeStoredString(llvm::support::endian::Writer &W, StringRef S) {
+  W.write<uint32_t>(S.size());
+  W.OS << S;
+}
+
 } // namespace
 
 PreambleBounds clang::ComputePreambleBounds(const LangOptions &LangOpts,
@@ -444,6 +536,8 @@ llvm::ErrorOr<PrecompiledPreamble> PrecompiledPreamble::Build(
 
   Act->EndSourceFile();
 
+  if (Act->isCancelled())
+    return BuildPreambleError::Cancelled;
   if (!Act->hasEmittedPreamblePCH())
     return BuildPreambleError::CouldntEmitPCH;
 
@@ -625,6 +719,103 @@ void PrecompiledPreamble::OverridePreamble(
   configurePreamble(Bounds, CI, VFS, MainFileBuffer);
 }
 
+std::error_code
+PrecompiledPreamble::SaveToStore(StringRef StoreDir,
+                                 const CompilerInvocation &Invocation) const {
+  StringRef PCH;
+  std::unique_ptr<llvm::MemoryBuffer> PCHFile;
+  if (Storage.getKind() == PCHStorage::Kind::InMemory) {
+    PCH = Storage.asMemory().Data;
+  } else {
+    assert(Storage.getKind() == PCHStorage::Kind::TempFile);
+    auto Buf = llvm::MemoryBuffer::getFile(Storage.asFile().getFilePath());
+    if (!Buf)
+      return Buf.getError();
+    PCHFile = std::move(*Buf);
+    PCH = PCHFile->getBuffer();
+  }
+
+  if (std::error_code EC = llvm::sys::fs::create_directories(StoreDir))
+    return EC;
+  std::string Path = getStoredPreamblePath(StoreDir, Invocation, getContents(),
+                                           PreambleEndsAtStartOfLine);
+  // Other processes may load or save the same preamble at the same time, so
+  // only make the entry visible once it is complete.
+  llvm::Error Err = llvm::writeFileAtomically(
+      Path + "-%%%%%%%%", Path, [&](llvm::raw_ostream &OS) {
+        llvm::support::endian::Writer W(OS, llvm::support::little);
+        OS << StoredPreambleMagic;
+        W.write<uint8_t>(PreambleEndsAtStartOfLine);
+        writeStoredString(W, getContents());
+        W.write<uint32_t>(FilesInPreamble.size());
+        for (const auto &F : FilesInPreamble) {
+          writeStoredString(W, F.getKey());
+          W.write<uint64_t>(F.second.Size);
+          W.write<int64_t>(F.second.ModTime);
+          W.write(llvm::makeArrayRef(F.second.MD5.Bytes));
+        }
+        W.write<uint32_t>(MissingFiles.size());
+        for (const auto &F : MissingFiles)
+          writeStoredString(W, F.getKey());
+        W.write<uint64_t>(PCH.size());
+        OS << PCH;
+        return llvm::Error::success();
+      });
+  return errorToErrorCode(std::move(Err));
+}
+
+llvm::ErrorOr<PrecompiledPreamble> PrecompiledPreamble::LoadFromStore(
+    StringRef StoreDir, const CompilerInvocation &Invocation,
+    const llvm::MemoryBuffer *MainFileBuffer, PreambleBounds Bounds,
+    llvm::vfs::FileSystem *VFS) {
+  assert(VFS && "VFS is null");
+  if (Invocation.getFrontendOpts().Inputs.size() != 1)
+    return BuildPreambleError::BadInputs;
+
+  std::string Path = getStoredPreamblePath(
+      StoreDir, Invocation, MainFileBuffer->getBuffer().take_front(Bounds.Size),
+      Bounds.PreambleEndsAtStartOfLine);
+  auto Buf = llvm::MemoryBuffer::getFile(Path, /*FileSize=*/-1,
+                                         /*RequiresNullTerminator=*/false);
+  if (!Buf)
+    return Buf.getError();
+
+  StoredPreambleReader Reader((*Buf)->getBuffer());
+  if (Reader.readBytes(strlen(StoredPreambleMagic)) != StoredPreambleMagic)
+    return BuildPreambleError::StoredPreambleInvalid;
+  bool PreambleEndsAtStartOfLine = Reader.readInt<uint8_t>();
+  StringRef Contents = Reader.readString();
+  std::vector<char> PreambleBytes(Contents.begin(), Contents.end());
+
+  llvm::StringMap<PreambleFileHash> FilesInPreamble;
+  for (uint32_t I = 0, E = Reader.readInt<uint32_t>();
+       I != E && !Reader.failed(); ++I) {
+    PreambleFileHash &Hash = FilesInPreamble[Reader.readString()];
+    Hash.Size = Reader.readInt<uint64_t>();
+    Hash.ModTime = Reader.readInt<int64_t>();
+    StringRef MD5 = Reader.readBytes(Hash.MD5.Bytes.size());
+    std::copy(MD5.begin(), MD5.end(), Hash.MD5.Bytes.begin());
+  }
+  llvm::StringSet<> MissingFiles;
+  for (uint32_t I = 0, E = Reader.readInt<uint32_t>();
+       I != E && !Reader.failed(); ++I)
+    MissingFiles.insert(Reader.readString());
+
+  InMemoryPreamble Memory;
+  Memory.Data = std::string(Reader.readBytes(Reader.readInt<uint64_t>()));
+  if (Reader.failed() || !Reader.atEnd())
+    return BuildPreambleError::StoredPreambleInvalid;
+
+  PrecompiledPreamble Preamble(
+      PCHStorage(std::move(Memory)), std::move(PreambleBytes),
+      PreambleEndsAtStartOfLine, std::move(FilesInPreamble),
+      std::move(MissingFiles));
+  // The headers may have changed since the preamble was stored.
+  if (!Preamble.CanReuse(Invocation, MainFileBuffer, Bounds, VFS))
+    return BuildPreambleError::StoredPreambleInvalid;
+  return std::move(Preamble);
+}
+
 PrecompiledPreamble::PrecompiledPreamble(
     PCHStorage Storage, std::vector<char> PreambleBytes,
     bool PreambleEndsAtStartOfLine,
@@ -884,6 +1075,10 @@ std::string BuildPreambleErrorCategory::message(int condition) const {
     return "Could not emit PCH";
   case BuildPreambleError::BadInputs:
     return "Command line arguments must contain exactly one source file";
+  case BuildPreambleError::StoredPreambleInvalid:
+    return "Stored preamble is corrupt or out of date";
+  case BuildPreambleError::Cancelled:
+    return "Preamble build was cancelled";
   }
   llvm_unreachable("unexpected BuildPreambleError");
 }
@@ -15,6 +15,7 @@
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/IdentifierTable.h"
 #include "clang/Basic/Module.h"
+#include "clang/Basic/PersistentStatCache.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Lex/DirectoryLookup.h"
 #include "clang/Lex/ExternalPreprocessorSource.h"
@@ -1341,6 +1342,14 @@ bool HeaderSearch::ShouldEnterIncludeFile(Preprocessor &PP,
       ++NumMultiIncludeFileOptzn;
       return false;
     }
+  } else if (StatCache && !ModulesEnabled && !FileInfo.NumIncludes) {
+    // The file hasn't been entered by this compilation, but another one may
+    // have found the macro that guards it.
+    std::string Guard = StatCache->getIncludeGuard(File->getName());
+    if (!Guard.empty() && PP.isMacroDefined(Guard)) {
+      ++NumMultiIncludeFileOptzn;
+      return false;
+    }
   }
 
   // Increment the number of times this file has been included.
@@ -1349,6 +1358,13 @@ bool HeaderSearch::ShouldEnterIncludeFile(Preprocessor &PP,
   return true;
 }
 
+void HeaderSearch::SetFileControllingMacro(
+    const FileEntry *File, const IdentifierInfo *ControllingMacro) {
+  getFileInfo(File).ControllingMacro = ControllingMacro;
+  if (StatCache)
+    StatCache->addIncludeGuard(File->getName(), ControllingMacro->getName());
+}
+
 size_t HeaderSearch::getTotalMemory() const {
   return SearchDirs.capacity()
     + llvm::capacity_in_bytes(FileInfo)
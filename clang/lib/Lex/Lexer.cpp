@@ -47,8 +47,161 @@
 #include <tuple>
 #include <utility>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif __ALTIVEC__
+#include <altivec.h>
+#undef bool
+#elif defined(__ARM_NEON) && !defined(__ARM_BIG_ENDIAN)
+#include <arm_neon.h>
+#endif
+
 using namespace clang;
 
+//===----------------------------------------------------------------------===//
+// Vectorized Scanning
+//===----------------------------------------------------------------------===//
+
+// The fast paths below scan the input 16 bytes at a time for the first byte
+// that ends a run of identifier characters, whitespace, a line comment or the
+// body of a raw string.  They only look at bytes before the end of the buffer,
+// and leave the last few bytes, as well as the handling of the byte they stop
+// at, to the scalar loops that follow them.
+#if defined(__SSE2__)
+#define LEXER_VECTOR_SCAN 1
+using ByteVector = __m128i;
+
+static ByteVector loadBytes(const char *Ptr) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(Ptr));
+}
+static ByteVector matchByte(ByteVector V, char C) {
+  return _mm_cmpeq_epi8(V, _mm_set1_epi8(C));
+}
+/// Matches the bytes in [Lo, Hi], which must both be ASCII characters.  The
+/// comparison is signed, so non-ASCII bytes never match.
+static ByteVector matchRange(ByteVector V, char Lo, char Hi) {
+  return _mm_and_si128(_mm_cmpgt_epi8(V, _mm_set1_epi8(Lo - 1)),
+                       _mm_cmplt_epi8(V, _mm_set1_epi8(Hi + 1)));
+}
+static ByteVector unionOf(ByteVector A, ByteVector B) {
+  return _mm_or_si128(A, B);
+}
+static ByteVector toLower(ByteVector V) {
+  return _mm_or_si128(V, _mm_set1_epi8(0x20));
+}
+/// Returns the index of the first matched byte of \p Match, or 16.
+static unsigned firstMatch(ByteVector Match) {
+  unsigned Mask = _mm_movemask_epi8(Match);
+  return Mask ? llvm::countTrailingZeros(Mask) : 16;
+}
+/// Returns the index of the first byte of \p Match that isn't matched, or 16.
+static unsigned firstMismatch(ByteVector Match) {
+  unsigned Mask = _mm_movemask_epi8(Match) ^ 0xFFFF;
+  return Mask ? llvm::countTrailingZeros(Mask) : 16;
+}
+#elif defined(__ARM_NEON) && !defined(__ARM_BIG_ENDIAN)
+#define LEXER_VECTOR_SCAN 1
+using ByteVector = uint8x16_t;
+
+static ByteVector loadBytes(const char *Ptr) {
+  return vld1q_u8(reinterpret_cast<const uint8_t *>(Ptr));
+}
+static ByteVector matchByte(ByteVector V, char C) {
+  return vceqq_u8(V, vdupq_n_u8(C));
+}
+/// Matches the bytes in [Lo, Hi], which must both be ASCII characters.
+static ByteVector matchRange(ByteVector V, char Lo, char Hi) {
+  return vandq_u8(vcgeq_u8(V, vdupq_n_u8(Lo)), vcleq_u8(V, vdupq_n_u8(Hi)));
+}
+static ByteVector unionOf(ByteVector A, ByteVector B) { return vorrq_u8(A, B); }
+static ByteVector toLower(ByteVector V) {
+  return vorrq_u8(V, vdupq_n_u8(0x20));
+}
+/// Returns the index of the first matched byte of \p Match, or 16.
+static unsigned firstMatch(ByteVector Match) {
+  // Narrow each byte of the match to a nibble of a 64-bit mask.
+  uint64_t Mask = vget_lane_u64(
+      vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(Match), 4)), 0);
+  return Mask ? llvm::countTrailingZeros(Mask) / 4 : 16;
+}
+/// Returns the index of the first byte of \p Match that isn't matched, or 16.
+static unsigned firstMismatch(ByteVector Match) {
+  return firstMatch(vmvnq_u8(Match));
+}
+#endif
+
+/// Skips the characters of \p CurPtr that aren't matched by \p StopAt, up to
+/// the last 16 bytes before \p BufferEnd.
+template <typename MatchFn>
+static const char *vectorScan(const char *CurPtr, const char *BufferEnd,
+                              MatchFn StopAt) {
+#ifdef LEXER_VECTOR_SCAN
+  while (BufferEnd - CurPtr >= 16) {
+    unsigned Index = StopAt(loadBytes(CurPtr));
+    if (Index != 16)
+      return CurPtr + Index;
+    CurPtr += 16;
+  }
+#endif
+  return CurPtr;
+}
+
+/// Skips identifier body characters, that is [_A-Za-z0-9].
+static const char *skipIdentifierBody(const char *CurPtr,
+                                      const char *BufferEnd) {
+#ifdef LEXER_VECTOR_SCAN
+  return vectorScan(CurPtr, BufferEnd, [](ByteVector V) {
+    return firstMismatch(
+        unionOf(unionOf(matchRange(toLower(V), 'a', 'z'),
+                        matchRange(V, '0', '9')),
+                matchByte(V, '_')));
+  });
+#else
+  return CurPtr;
+#endif
+}
+
+/// Skips horizontal whitespace, that is ' ', '\t', '\v' and '\f'.
+static const char *skipHorizontalWhitespace(const char *CurPtr,
+                                            const char *BufferEnd) {
+#ifdef LEXER_VECTOR_SCAN
+  return vectorScan(CurPtr, BufferEnd, [](ByteVector V) {
+    return firstMismatch(
+        unionOf(unionOf(matchByte(V, ' '), matchByte(V, '\t')),
+                matchRange(V, '\v', '\f')));
+  });
+#else
+  return CurPtr;
+#endif
+}
+
+/// Skips the body of a line comment, stopping at a newline or a null
+/// character.
+static const char *skipLineCommentBody(const char *CurPtr,
+                                       const char *BufferEnd) {
+#ifdef LEXER_VECTOR_SCAN
+  return vectorScan(CurPtr, BufferEnd, [](ByteVector V) {
+    return firstMatch(unionOf(unionOf(matchByte(V, '\n'), matchByte(V, '\r')),
+                              matchByte(V, '\0')));
+  });
+#else
+  return CurPtr;
+#endif
+}
+
+/// Skips the body of a raw string, stopping at a ')' that may end it or at a
+/// null character.
+static const char *skipRawStringBody(const char *CurPtr,
+                                     const char *BufferEnd) {
+#ifdef LEXER_VECTOR_SCAN
+  return vectorScan(CurPtr, BufferEnd, [](ByteVector V) {
+    return firstMatch(unionOf(matchByte(V, ')'), matchByte(V, '\0')));
+  });
+#else
+  return CurPtr;
+#endif
+}
+
 //===----------------------------------------------------------------------===//
 // Token Class Implementation
 //===----------------------------------------------------------------------===//
@@ -1642,6 +1795,7 @@ bool Lexer::tryConsumeIdentifierUTF8Char(const char *&CurPtr) {
 bool Lexer::LexIdentifier(Token &Result, const char *CurPtr) {
   // Match [_A-Za-z0-9]*, we have already matched [_A-Za-z$]
   unsigned Size;
+  CurPtr = skipIdentifierBody(CurPtr, BufferEnd);
   unsigned char C = *CurPtr++;
   while (isIdentifierBody(C))
     C = *CurPtr++;
@@ -2018,6 +2172,7 @@ bool Lexer::LexRawStringLiteral(Token &Result, const char *CurPtr,
   CurPtr += PrefixLen + 1; // skip over prefix and '('
 
   while (true) {
+    CurPtr = skipRawStringBody(CurPtr, BufferEnd);
     char C = *CurPtr++;
 
     if (C == ')') {
@@ -2211,6 +2366,10 @@ bool Lexer::SkipWhitespace(Token &Result, const char *CurPtr,
   // Skip consecutive spaces efficiently.
   while (true) {
     // Skip horizontal whitespace very aggressively.
+    if (isHorizontalWhitespace(Char)) {
+      CurPtr = skipHorizontalWhitespace(CurPtr, BufferEnd);
+      Char = *CurPtr;
+    }
     while (isHorizontalWhitespace(Char))
       Char = *++CurPtr;
 
@@ -2288,6 +2447,7 @@ bool Lexer::SkipLineComment(Token &Result, const char *CurPtr,
   // character that ends the line comment.
   char C;
   while (true) {
+    CurPtr = skipLineCommentBody(CurPtr, BufferEnd);
     C = *CurPtr;
     // Skip over characters in the fast loop.
     while (C != 0 &&                // Potentially EOF.
@@ -2495,13 +2655,6 @@ static bool isEndOfBlockCommentWithEscapedNewLine(const char *CurPtr,
   return true;
 }
 
-#ifdef __SSE2__
-#include <emmintrin.h>
-#elif __ALTIVEC__
-#include <altivec.h>
-#undef bool
-#endif
-
 /// We have just read from input the / and * characters that started a comment.
 /// Read until we find the * and / characters that terminate the comment.
 /// Note that we don't bother decoding trigraphs or escaped newlines in block
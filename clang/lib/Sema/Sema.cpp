@@ -502,6 +502,29 @@ void Sema::addExternalSource(ExternalSemaSource *E) {
 void Sema::PrintStats() const {
   llvm::errs() << "\n*** Semantic Analysis Stats:\n";
   llvm::errs() << NumSFINAEErrors << " SFINAE diagnostics trapped.\n";
+  llvm::errs() << NumFunctionInstantiations
+               << " function definitions instantiated, "
+               << NumFunctionInstantiationsFromAST
+               << " more loaded from AST files.\n";
+
+  // The templates whose instantiations allocate the most AST memory.
+  SmallVector<std::pair<const Decl *, TemplateInstantiationMemory>, 16>
+      Templates(InstantiationMemory.begin(), InstantiationMemory.end());
+  llvm::sort(Templates, [](const auto &LHS, const auto &RHS) {
+    return LHS.second.Bytes > RHS.second.Bytes;
+  });
+  if (Templates.size() > 20)
+    Templates.resize(20);
+  if (!Templates.empty())
+    llvm::errs() << "Templates whose instantiations allocate the most AST "
+                    "memory (including the instantiations they trigger):\n";
+  for (const auto &Template : Templates) {
+    llvm::errs() << "  " << Template.second.Bytes << " bytes in "
+                 << Template.second.NumInstantiations << " instantiations of ";
+    if (const auto *ND = dyn_cast<NamedDecl>(Template.first))
+      ND->printQualifiedName(llvm::errs());
+    llvm::errs() << "\n";
+  }
 
   BumpAlloc.PrintStats();
   AnalysisWarnings.PrintStats();
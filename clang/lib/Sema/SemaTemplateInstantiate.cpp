@@ -2641,6 +2641,7 @@ Sema::InstantiateClass(SourceLocation PointOfInstantiation,
   });
 
   Pattern = PatternDef;
+  InstantiationMemoryScope MemoryScope(*this, Pattern);
 
   // Record the point of instantiation.
   if (MemberSpecializationInfo *MSInfo
@@ -4699,8 +4699,13 @@ void Sema::InstantiateFunctionDefinition(SourceLocation PointOfInstantiation,
   const FunctionDecl *ExistingDefn = nullptr;
   if (Function->isDefined(ExistingDefn,
                           /*CheckForPendingFriendDefinition=*/true)) {
-    if (ExistingDefn->isThisDeclarationADefinition())
+    if (ExistingDefn->isThisDeclarationADefinition()) {
+      // A PCH or module that instantiated the function already gave us its
+      // definition.
+      if (ExistingDefn->isFromASTFile())
+        ++NumFunctionInstantiationsFromAST;
       return;
+    }
 
     // If we're asked to instantiate a function whose body comes from an
     // instantiated friend declaration, attach the instantiated body to the
@@ -4768,6 +4773,8 @@ void Sema::InstantiateFunctionDefinition(SourceLocation PointOfInstantiation,
                                    /*Qualified=*/true);
     return Name;
   });
+  InstantiationMemoryScope MemoryScope(*this, PatternDecl);
+  ++NumFunctionInstantiations;
 
   // If we're performing recursive template instantiation, create our own
   // queue of pending implicit instantiations that we will instantiate later,
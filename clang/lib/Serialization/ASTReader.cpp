@@ -1469,6 +1469,7 @@ bool ASTReader::ReadSLocEntry(int ID) {
   unsigned BaseOffset = F->SLocEntryBaseOffset;
 
   ++NumSLocEntriesRead;
+  ++F->NumSLocEntriesRead;
   Expected<llvm::BitstreamEntry> MaybeEntry = SLocEntryCursor.advance();
   if (!MaybeEntry) {
     Error(MaybeEntry.takeError());
@@ -1521,8 +1522,19 @@ bool ASTReader::ReadSLocEntry(int ID) {
     SrcMgr::FileInfo &FileInfo =
           const_cast<SrcMgr::FileInfo&>(SourceMgr.getSLocEntry(FID).getFile());
     FileInfo.NumCreatedFIDs = Record[5];
-    if (Record[3])
+    if (Record[3]) {
       FileInfo.setHasLineDirectives();
+      if (!F->PendingLineTable.empty()) {
+        RecordData LineTable(F->PendingLineTable.begin(),
+                             F->PendingLineTable.end());
+        F->PendingLineTable.clear();
+        F->ReadLineTable = true;
+        if (ParseLineTable(*F, LineTable)) {
+          Error("malformed SOURCE_MANAGER_LINE_TABLE in AST file");
+          return true;
+        }
+      }
+    }
 
     unsigned NumFileDecls = Record[7];
     if (NumFileDecls && ContextObj) {
@@ -1775,6 +1787,7 @@ MacroInfo *ASTReader::ReadMacroRecord(ModuleFile &F, uint64_t Offset) {
       }
 
       ++NumMacrosRead;
+      ++F.NumMacrosRead;
       break;
     }
 
@@ -3399,10 +3412,10 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
       break;
 
     case SOURCE_MANAGER_LINE_TABLE:
-      if (ParseLineTable(F, Record)) {
-        Error("malformed SOURCE_MANAGER_LINE_TABLE in AST file");
-        return Failure;
-      }
+      // The line table is only needed to compute presumed locations in the
+      // files with line directives, so only parse it once one of them is
+      // loaded.
+      F.PendingLineTable.assign(Record.begin(), Record.end());
       break;
 
     case SOURCE_LOCATION_PRELOADS: {
@@ -5923,6 +5936,7 @@ PreprocessedEntity *ASTReader::ReadPreprocessedEntity(unsigned Index) {
   ModuleFile &M = *PPInfo.first;
   unsigned LocalIndex = PPInfo.second;
   const PPEntityOffset &PPOffs = M.PreprocessedEntityOffsets[LocalIndex];
+  ++M.NumPreprocessedEntitiesRead;
 
   if (!PP.getPreprocessingRecord()) {
     Error("no preprocessing record");
@@ -6369,6 +6383,7 @@ QualType ASTReader::readTypeRecord(unsigned Index) {
   ASTContext &Context = *ContextObj;
   RecordLocation Loc = TypeCursorForIndex(Index);
   BitstreamCursor &DeclsCursor = Loc.F->DeclsCursor;
+  ++Loc.F->NumTypesRead;
 
   // Keep track of where we are in the stream, then jump back there
   // after reading this type.
@@ -6415,10 +6430,10 @@ namespace clang {
 
 class TypeLocReader : public TypeLocVisitor<TypeLocReader> {
   ASTRecordReader &Reader;
+  SourceLocationSequence *Seq;
 
-  SourceLocation readSourceLocation() {
-    return Reader.readSourceLocation();
-  }
+  SourceLocation readSourceLocation() { return Reader.readSourceLocation(Seq); }
+  SourceRange readSourceRange() { return Reader.readSourceRange(Seq); }
 
   TypeSourceInfo *GetTypeSourceInfo() {
     return Reader.readTypeSourceInfo();
@@ -6433,7 +6448,8 @@ class TypeLocReader : public TypeLocVisitor<TypeLocReader> {
   }
 
 public:
-  TypeLocReader(ASTRecordReader &Reader) : Reader(Reader) {}
+  TypeLocReader(ASTRecordReader &Reader, SourceLocationSequence *Seq)
+      : Reader(Reader), Seq(Seq) {}
 
   // We want compile-time assurance that we've enumerated all of
   // these, so unfortunately we have to declare them first, then
@@ -6530,7 +6546,7 @@ void TypeLocReader::VisitDependentAddressSpaceTypeLoc(
     DependentAddressSpaceTypeLoc TL) {
 
     TL.setAttrNameLoc(readSourceLocation());
-    TL.setAttrOperandParensRange(Reader.readSourceRange());
+    TL.setAttrOperandParensRange(readSourceRange());
     TL.setAttrExprOperand(Reader.readExpr());
 }
 
@@ -6554,7 +6570,7 @@ void TypeLocReader::VisitExtVectorTypeLoc(ExtVectorTypeLoc TL) {
 
 void TypeLocReader::VisitConstantMatrixTypeLoc(ConstantMatrixTypeLoc TL) {
   TL.setAttrNameLoc(readSourceLocation());
-  TL.setAttrOperandParensRange(Reader.readSourceRange());
+  TL.setAttrOperandParensRange(readSourceRange());
   TL.setAttrRowOperand(Reader.readExpr());
   TL.setAttrColumnOperand(Reader.readExpr());
 }
@@ -6562,7 +6578,7 @@ void TypeLocReader::VisitConstantMatrixTypeLoc(ConstantMatrixTypeLoc TL) {
 void TypeLocReader::VisitDependentSizedMatrixTypeLoc(
     DependentSizedMatrixTypeLoc TL) {
   TL.setAttrNameLoc(readSourceLocation());
-  TL.setAttrOperandParensRange(Reader.readSourceRange());
+  TL.setAttrOperandParensRange(readSourceRange());
   TL.setAttrRowOperand(Reader.readExpr());
   TL.setAttrColumnOperand(Reader.readExpr());
 }
@@ -6571,7 +6587,7 @@ void TypeLocReader::VisitFunctionTypeLoc(FunctionTypeLoc TL) {
   TL.setLocalRangeBegin(readSourceLocation());
   TL.setLParenLoc(readSourceLocation());
   TL.setRParenLoc(readSourceLocation());
-  TL.setExceptionSpecRange(Reader.readSourceRange());
+  TL.setExceptionSpecRange(readSourceRange());
   TL.setLocalRangeEnd(readSourceLocation());
   for (unsigned i = 0, e = TL.getNumParams(); i != e; ++i) {
     TL.setParam(i, Reader.readDeclAs<ParmVarDecl>());
@@ -6764,8 +6780,9 @@ void TypeLocReader::VisitDependentExtIntTypeLoc(
 }
 
 
-void ASTRecordReader::readTypeLoc(TypeLoc TL) {
-  TypeLocReader TLR(*this);
+void ASTRecordReader::readTypeLoc(TypeLoc TL, SourceLocationSequence *Seq) {
+  SourceLocationSequence::State LocSeq(Seq);
+  TypeLocReader TLR(*this, LocSeq);
   for (; !TL.isNull(); TL = TL.getNextTypeLoc())
     TLR.Visit(TL);
 }
@@ -7756,6 +7773,33 @@ void ASTReader::PrintStats() {
     GlobalIndex->printStats();
   }
 
+  // Report what was read from each AST file, to tell which of them the
+  // translation unit actually used.
+  std::fprintf(stderr, "\n*** Per-AST file statistics:\n");
+  for (ModuleFile &F : ModuleMgr) {
+    std::fprintf(stderr, "  %s:\n", F.FileName.c_str());
+    bool ReadAnything = F.ReadLineTable;
+    auto PrintReadCount = [&](const char *Name, unsigned Read, unsigned Total) {
+      if (!Read)
+        return;
+      std::fprintf(stderr, "    %u/%u %s read (%f%%)\n", Read, Total, Name,
+                   ((float)Read / Total * 100));
+      ReadAnything = true;
+    };
+    PrintReadCount("source location entries", F.NumSLocEntriesRead,
+                   F.LocalNumSLocEntries);
+    PrintReadCount("types", F.NumTypesRead, F.LocalNumTypes);
+    PrintReadCount("declarations", F.NumDeclsRead, F.LocalNumDecls);
+    PrintReadCount("identifiers", F.NumIdentifiersRead, F.LocalNumIdentifiers);
+    PrintReadCount("macros", F.NumMacrosRead, F.LocalNumMacros);
+    PrintReadCount("preprocessed entities", F.NumPreprocessedEntitiesRead,
+                   F.NumPreprocessedEntities);
+    if (F.ReadLineTable)
+      std::fprintf(stderr, "    line table read\n");
+    if (!ReadAnything)
+      std::fprintf(stderr, "    nothing read\n");
+  }
+
   std::fprintf(stderr, "\n");
   dump();
   std::fprintf(stderr, "\n");
@@ -8487,6 +8531,7 @@ IdentifierInfo *ASTReader::DecodeIdentifierInfo(IdentifierID ID) {
                        | (((unsigned) StrLenPtr[1]) << 8)) - 1;
     auto &II = PP.getIdentifierTable().get(StringRef(Str, StrLen));
     IdentifiersLoaded[ID] = &II;
+    ++M->NumIdentifiersRead;
     markIdentifierFromAST(*this,  II);
     if (DeserializationListener)
       DeserializationListener->IdentifierRead(ID + 1, &II);
@@ -8935,9 +8980,9 @@ ASTRecordReader::readNestedNameSpecifierLoc() {
 
 SourceRange
 ASTReader::ReadSourceRange(ModuleFile &F, const RecordData &Record,
-                           unsigned &Idx) {
-  SourceLocation beg = ReadSourceLocation(F, Record, Idx);
-  SourceLocation end = ReadSourceLocation(F, Record, Idx);
+                           unsigned &Idx, SourceLocationSequence *Seq) {
+  SourceLocation beg = ReadSourceLocation(F, Record, Idx, Seq);
+  SourceLocation end = ReadSourceLocation(F, Record, Idx, Seq);
   return SourceRange(beg, end);
 }
 
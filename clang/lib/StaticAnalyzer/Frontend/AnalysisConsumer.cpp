@@ -441,6 +441,7 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
   SetOfConstDecls Visited;
   SetOfConstDecls VisitedAsTopLevel;
   llvm::ReversePostOrderTraversal<clang::CallGraph*> RPOT(&CG);
+  unsigned Position = 0;
   for (llvm::ReversePostOrderTraversal<clang::CallGraph*>::rpo_iterator
          I = RPOT.begin(), E = RPOT.end(); I != E; ++I) {
     NumFunctionTopLevel++;
@@ -452,6 +453,12 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
     if (!D)
       continue;
 
+    // Skip the functions of the other shards. The shard of a function only
+    // depends on its position in the call graph, which is the same for all
+    // the shards, so that every function is a candidate in exactly one shard.
+    if (Position++ % Opts->ShardCount != Opts->ShardIndex)
+      continue;
+
     // Skip the functions which have been processed already or previously
     // inlined.
     if (shouldSkipFunction(D, Visited, VisitedAsTopLevel))
@@ -485,17 +492,23 @@ static bool isBisonFile(ASTContext &C) {
 void AnalysisConsumer::runAnalysisOnTranslationUnit(ASTContext &C) {
   BugReporter BR(*Mgr);
   TranslationUnitDecl *TU = C.getTranslationUnitDecl();
-  if (SyntaxCheckTimer)
-    SyntaxCheckTimer->startTimer();
-  checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
-  if (SyntaxCheckTimer)
-    SyntaxCheckTimer->stopTimer();
+  // The other shards only run the path-sensitive analysis of their share of
+  // the functions.
+  const bool IsFirstShard = Opts->ShardIndex == 0;
+  if (IsFirstShard) {
+    if (SyntaxCheckTimer)
+      SyntaxCheckTimer->startTimer();
+    checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
+    if (SyntaxCheckTimer)
+      SyntaxCheckTimer->stopTimer();
+  }
 
   // Run the AST-only checks using the order in which functions are defined.
   // If inlining is not turned on, use the simplest function order for path
-  // sensitive analyzes as well.
-  RecVisitorMode = AM_Syntax;
-  if (!Mgr->shouldInlineCall())
+  // sensitive analyzes as well. In that case, the first shard analyzes all
+  // the functions.
+  RecVisitorMode = IsFirstShard ? AM_Syntax : AM_None;
+  if (!Mgr->shouldInlineCall() && IsFirstShard)
     RecVisitorMode |= AM_Path;
   RecVisitorBR = &BR;
 
@@ -506,15 +519,18 @@ void AnalysisConsumer::runAnalysisOnTranslationUnit(ASTContext &C) {
   // random access.  By doing so, we automatically compensate for iterators
   // possibly being invalidated, although this is a bit slower.
   const unsigned LocalTUDeclsSize = LocalTUDecls.size();
-  for (unsigned i = 0 ; i < LocalTUDeclsSize ; ++i) {
-    TraverseDecl(LocalTUDecls[i]);
+  if (RecVisitorMode != AM_None) {
+    for (unsigned i = 0 ; i < LocalTUDeclsSize ; ++i) {
+      TraverseDecl(LocalTUDecls[i]);
+    }
   }
 
   if (Mgr->shouldInlineCall())
     HandleDeclsCallGraph(LocalTUDeclsSize);
 
   // After all decls handled, run checkers on the entire TranslationUnit.
-  checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
+  if (IsFirstShard)
+    checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
 
   BR.FlushReports();
   RecVisitorBR = nullptr;
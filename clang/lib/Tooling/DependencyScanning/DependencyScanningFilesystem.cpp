@@ -8,15 +8,101 @@
 
 #include "clang/Tooling/DependencyScanning/DependencyScanningFilesystem.h"
 #include "clang/Lex/DependencyDirectivesSourceMinimizer.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileUtilities.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SHA1.h"
 #include "llvm/Support/Threading.h"
 
 using namespace clang;
 using namespace tooling;
 using namespace dependencies;
 
+MinimizedSourceCache::MinimizedSourceCache(StringRef CacheDir)
+    : CacheDir(CacheDir) {}
+
+std::string MinimizedSourceCache::getKey(StringRef Source) {
+  return llvm::toHex(llvm::SHA1::hash(llvm::arrayRefFromStringRef(Source)),
+                     /*LowerCase=*/true);
+}
+
+std::string MinimizedSourceCache::getEntryPath(StringRef Key) const {
+  SmallString<256> Path(CacheDir);
+  llvm::sys::path::append(Path, Key + ".min");
+  return std::string(Path.str());
+}
+
+// An entry starts with a header made of the magic number, the version of the
+// format and the number of skipped ranges, followed by the offset and length
+// of each skipped range and by the minimized contents.
+static const char MinimizedSourceCacheMagic[] = {'C', 'S', 'M', 'N'};
+// Bump this whenever the format or the output of the minimizer changes.
+static const uint32_t MinimizedSourceCacheVersion = 1;
+
+bool MinimizedSourceCache::lookup(
+    StringRef Key, SmallVectorImpl<char> &MinimizedContents,
+    PreprocessorSkippedRangeMapping &Mapping) const {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> MaybeBuffer =
+      llvm::MemoryBuffer::getFile(getEntryPath(Key), /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (!MaybeBuffer)
+    return false;
+  StringRef Data = (*MaybeBuffer)->getBuffer();
+  const size_t HeaderSize = sizeof(MinimizedSourceCacheMagic) + 8;
+  if (Data.size() < HeaderSize ||
+      !Data.startswith(StringRef(MinimizedSourceCacheMagic,
+                                 sizeof(MinimizedSourceCacheMagic))))
+    return false;
+  const char *Ptr = Data.data() + sizeof(MinimizedSourceCacheMagic);
+  using namespace llvm::support;
+  if (endian::readNext<uint32_t, little, unaligned>(Ptr) !=
+      MinimizedSourceCacheVersion)
+    return false;
+  uint64_t NumRanges = endian::readNext<uint32_t, little, unaligned>(Ptr);
+  if (Data.size() - HeaderSize < NumRanges * 8)
+    return false;
+
+  Mapping.clear();
+  for (uint64_t I = 0; I != NumRanges; ++I) {
+    uint32_t Offset = endian::readNext<uint32_t, little, unaligned>(Ptr);
+    Mapping[Offset] = endian::readNext<uint32_t, little, unaligned>(Ptr);
+  }
+  MinimizedContents.assign(Ptr, Data.end());
+  return true;
+}
+
+void MinimizedSourceCache::store(
+    StringRef Key, StringRef MinimizedContents,
+    const PreprocessorSkippedRangeMapping &Mapping) const {
+  std::string Entry;
+  llvm::raw_string_ostream OS(Entry);
+  OS.write(MinimizedSourceCacheMagic, sizeof(MinimizedSourceCacheMagic));
+  llvm::support::endian::Writer W(OS, llvm::support::little);
+  W.write<uint32_t>(MinimizedSourceCacheVersion);
+  W.write<uint32_t>(Mapping.size());
+  for (const auto &Range : Mapping) {
+    W.write<uint32_t>(Range.first);
+    W.write<uint32_t>(Range.second);
+  }
+  OS << MinimizedContents;
+  OS.flush();
+
+  // The directory usually exists, so only try to create it when the write
+  // fails.
+  std::string Path = getEntryPath(Key);
+  std::string TempPathModel = Path + "-%%%%%%%%";
+  if (llvm::Error E = llvm::writeFileAtomically(TempPathModel, Path, Entry)) {
+    llvm::consumeError(std::move(E));
+    if (llvm::sys::fs::create_directories(CacheDir))
+      return;
+    llvm::consumeError(llvm::writeFileAtomically(TempPathModel, Path, Entry));
+  }
+}
+
 CachedFileSystemEntry CachedFileSystemEntry::createFileEntry(
-    StringRef Filename, llvm::vfs::FileSystem &FS, bool Minimize) {
+    StringRef Filename, llvm::vfs::FileSystem &FS, bool Minimize,
+    const MinimizedSourceCache *PersistentCache) {
   // Load the file and its content from the file system.
   llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>> MaybeFile =
       FS.openFileForRead(Filename);
@@ -33,22 +119,53 @@ CachedFileSystemEntry CachedFileSystemEntry::createFileEntry(
     return MaybeBuffer.getError();
 
   llvm::SmallString<1024> MinimizedFileContents;
-  // Minimize the file down to directives that might affect the dependencies.
+  PreprocessorSkippedRangeMapping Mapping;
   const auto &Buffer = *MaybeBuffer;
-  SmallVector<minimize_source_to_dependency_directives::Token, 64> Tokens;
-  if (!Minimize || minimizeSourceToDependencyDirectives(
-                       Buffer->getBuffer(), MinimizedFileContents, Tokens)) {
-    // Use the original file unless requested otherwise, or
-    // if the minimization failed.
-    // FIXME: Propage the diagnostic if desired by the client.
-    CachedFileSystemEntry Result;
-    Result.MaybeStat = std::move(*Stat);
-    Result.Contents.reserve(Buffer->getBufferSize() + 1);
-    Result.Contents.append(Buffer->getBufferStart(), Buffer->getBufferEnd());
-    // Implicitly null terminate the contents for Clang's lexer.
-    Result.Contents.push_back('\0');
-    Result.Contents.pop_back();
-    return Result;
+  std::string CacheKey;
+  if (Minimize && PersistentCache)
+    CacheKey = MinimizedSourceCache::getKey(Buffer->getBuffer());
+  if (!CacheKey.empty() &&
+      PersistentCache->lookup(CacheKey, MinimizedFileContents, Mapping)) {
+    // The contents from the cache are not null terminated.
+    MinimizedFileContents.push_back('\0');
+    MinimizedFileContents.pop_back();
+  } else {
+    // Minimize the file down to directives that might affect the dependencies.
+    SmallVector<minimize_source_to_dependency_directives::Token, 64> Tokens;
+    if (!Minimize || minimizeSourceToDependencyDirectives(
+                         Buffer->getBuffer(), MinimizedFileContents, Tokens)) {
+      // Use the original file unless requested otherwise, or
+      // if the minimization failed.
+      // FIXME: Propage the diagnostic if desired by the client.
+      CachedFileSystemEntry Result;
+      Result.MaybeStat = std::move(*Stat);
+      Result.Contents.reserve(Buffer->getBufferSize() + 1);
+      Result.Contents.append(Buffer->getBufferStart(), Buffer->getBufferEnd());
+      // Implicitly null terminate the contents for Clang's lexer.
+      Result.Contents.push_back('\0');
+      Result.Contents.pop_back();
+      return Result;
+    }
+
+    // Compute the skipped PP ranges that speedup skipping over inactive
+    // preprocessor blocks.
+    llvm::SmallVector<minimize_source_to_dependency_directives::SkippedRange,
+                      32>
+        SkippedRanges;
+    minimize_source_to_dependency_directives::computeSkippedRanges(
+        Tokens, SkippedRanges);
+    for (const auto &Range : SkippedRanges) {
+      if (Range.Length < 16) {
+        // Ignore small ranges as non-profitable.
+        // FIXME: This is a heuristic, its worth investigating the tradeoffs
+        // when it should be applied.
+        continue;
+      }
+      Mapping[Range.Offset] = Range.Length;
+    }
+
+    if (!CacheKey.empty())
+      PersistentCache->store(CacheKey, MinimizedFileContents, Mapping);
   }
 
   CachedFileSystemEntry Result;
@@ -69,23 +186,6 @@ CachedFileSystemEntry CachedFileSystemEntry::createFileEntry(
   // Now make the null terminator implicit again, so that Clang's lexer can find
   // it right where the buffer ends.
   Result.Contents.pop_back();
-
-  // Compute the skipped PP ranges that speedup skipping over inactive
-  // preprocessor blocks.
-  llvm::SmallVector<minimize_source_to_dependency_directives::SkippedRange, 32>
-      SkippedRanges;
-  minimize_source_to_dependency_directives::computeSkippedRanges(Tokens,
-                                                                 SkippedRanges);
-  PreprocessorSkippedRangeMapping Mapping;
-  for (const auto &Range : SkippedRanges) {
-    if (Range.Length < 16) {
-      // Ignore small ranges as non-profitable.
-      // FIXME: This is a heuristic, its worth investigating the tradeoffs
-      // when it should be applied.
-      continue;
-    }
-    Mapping[Range.Offset] = Range.Length;
-  }
   Result.PPSkippedRangeMapping = std::move(Mapping);
 
   return Result;
@@ -100,7 +200,7 @@ CachedFileSystemEntry::createDirectoryEntry(llvm::vfs::Status &&Stat) {
 }
 
 DependencyScanningFilesystemSharedCache::
-    DependencyScanningFilesystemSharedCache() {
+    DependencyScanningFilesystemSharedCache(StringRef PersistentCacheDir) {
   // This heuristic was chosen using a empirical testing on a
   // reasonably high core machine (iMacPro 18 cores / 36 threads). The cache
   // sharding gives a performance edge by reducing the lock contention.
@@ -109,6 +209,9 @@ DependencyScanningFilesystemSharedCache::
   NumShards =
       std::max(2u, llvm::hardware_concurrency().compute_thread_count() / 4);
   CacheShards = std::make_unique<CacheShard[]>(NumShards);
+  if (!PersistentCacheDir.empty())
+    PersistentCache =
+        std::make_unique<MinimizedSourceCache>(PersistentCacheDir);
 }
 
 /// Returns a cache entry for the corresponding key.
@@ -123,6 +226,22 @@ DependencyScanningFilesystemSharedCache::get(StringRef Key) {
   return It.first->getValue();
 }
 
+void DependencyScanningFilesystemSharedCache::invalidate(
+    const llvm::StringSet<> *FileNames) {
+  for (unsigned I = 0; I != NumShards; ++I) {
+    CacheShard &Shard = CacheShards[I];
+    std::unique_lock<std::mutex> LockGuard(Shard.CacheLock);
+    for (auto &Entry : Shard.Cache) {
+      if (FileNames &&
+          !FileNames->count(llvm::sys::path::filename(Entry.getKey())))
+        continue;
+      std::unique_lock<std::mutex> ValueGuard(Entry.getValue().ValueLock);
+      Entry.getValue().Value = CachedFileSystemEntry();
+    }
+  }
+  ++Generation;
+}
+
 /// Whitelist file extensions that should be minimized, treating no extension as
 /// a source file that should be minimized.
 ///
@@ -185,7 +304,8 @@ DependencyScanningWorkerFilesystem::getOrCreateFileSystemEntry(
             std::move(*MaybeStatus));
       else
         CacheEntry = CachedFileSystemEntry::createFileEntry(
-            Filename, FS, !KeepOriginalSource);
+            Filename, FS, !KeepOriginalSource,
+            SharedCache.getPersistentCache());
     }
 
     Result = &CacheEntry;
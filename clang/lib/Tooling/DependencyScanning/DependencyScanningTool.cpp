@@ -29,7 +29,8 @@ DependencyScanningTool::DependencyScanningTool(
     : Worker(Service) {}
 
 llvm::Expected<std::string> DependencyScanningTool::getDependencyFile(
-    const tooling::CompilationDatabase &Compilations, StringRef CWD) {
+    const tooling::CompilationDatabase &Compilations, StringRef CWD,
+    std::vector<std::string> *FileDeps) {
   /// Prints out all of the gathered dependencies into a string.
   class MakeDependencyPrinterConsumer : public DependencyConsumer {
   public:
@@ -71,6 +72,10 @@ llvm::Expected<std::string> DependencyScanningTool::getDependencyFile(
       Generator.printDependencies(S);
     }
 
+    std::vector<std::string> takeDependencies() {
+      return std::move(Dependencies);
+    }
+
   private:
     std::unique_ptr<DependencyOutputOptions> Opts;
     std::vector<std::string> Dependencies;
@@ -91,6 +96,12 @@ llvm::Expected<std::string> DependencyScanningTool::getDependencyFile(
     return std::move(Result);
   std::string Output;
   Consumer.printDependencies(Output);
+  if (FileDeps) {
+    std::vector<std::string> Dependencies = Consumer.takeDependencies();
+    FileDeps->insert(FileDeps->end(),
+                     std::make_move_iterator(Dependencies.begin()),
+                     std::make_move_iterator(Dependencies.end()));
+  }
   return Output;
 }
 
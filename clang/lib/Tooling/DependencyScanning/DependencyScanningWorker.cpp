@@ -151,7 +151,8 @@ private:
 
 DependencyScanningWorker::DependencyScanningWorker(
     DependencyScanningService &Service)
-    : Format(Service.getFormat()) {
+    : Format(Service.getFormat()), SharedCache(Service.getSharedCache()),
+      CacheGeneration(SharedCache.getGeneration()) {
   DiagOpts = new DiagnosticOptions();
   PCHContainerOps = std::make_shared<PCHContainerOperations>();
   RealFS = llvm::vfs::createPhysicalFileSystem();
@@ -180,9 +181,25 @@ static llvm::Error runWithDiags(
                                              llvm::inconvertibleErrorCode());
 }
 
+void DependencyScanningWorker::discardStaleState() {
+  unsigned Generation = SharedCache.getGeneration();
+  if (Generation == CacheGeneration)
+    return;
+  CacheGeneration = Generation;
+  if (DepFS)
+    DepFS->clearLocalCache();
+  // The skip mappings are keyed by the address of the buffers, which may be
+  // reused by the buffers of the new entries.
+  if (PPSkipMappings)
+    PPSkipMappings->clear();
+  if (Files)
+    Files = new FileManager(FileSystemOptions(), RealFS);
+}
+
 llvm::Error DependencyScanningWorker::computeDependencies(
     const std::string &Input, StringRef WorkingDirectory,
     const CompilationDatabase &CDB, DependencyConsumer &Consumer) {
+  discardStaleState();
   RealFS->setCurrentWorkingDirectory(WorkingDirectory);
   return runWithDiags(DiagOpts.get(), [&](DiagnosticConsumer &DC) {
     /// Create the tool that uses the underlying file system to ensure that any
@@ -89,6 +89,16 @@
 // CHECK-STACK-DEPTH-PC-GUARD: -fsanitize-coverage-trace-pc-guard
 // CHECK-STACK-DEPTH-PC-GUARD: -fsanitize-coverage-stack-depth
 
+// RUN: %clang -target x86_64-linux-gnu -fsanitize-coverage=inline-8bit-counters \
+// RUN:     -fsanitize-coverage-sample-period=100 %s -### 2>&1 | \
+// RUN:     FileCheck %s --check-prefix=CHECK-SAMPLE-PERIOD
+// RUN: %clang -target x86_64-linux-gnu -fsanitize-coverage=inline-8bit-counters \
+// RUN:     -fsanitize-coverage-sample-period=x %s -### 2>&1 | \
+// RUN:     FileCheck %s --check-prefix=CHECK-SAMPLE-PERIOD-INVALID
+// CHECK-SAMPLE-PERIOD: -fsanitize-coverage-inline-8bit-counters
+// CHECK-SAMPLE-PERIOD: -fsanitize-coverage-sample-period=100
+// CHECK-SAMPLE-PERIOD-INVALID: error: invalid value 'x' in '-fsanitize-coverage-sample-period=x'
+
 // RUN: %clang -target x86_64-linux-gnu -fsanitize=address -fsanitize-coverage=trace-cmp,indirect-calls %s -### 2>&1 | FileCheck %s --check-prefix=CHECK-NO-TYPE-NECESSARY
 // CHECK-NO-TYPE-NECESSARY-NOT: error:
 // CHECK-NO-TYPE-NECESSARY: -fsanitize-coverage-indirect-calls
@@ -6,12 +6,15 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "clang/Basic/CharInfo.h"
+#include "clang/DirectoryWatcher/DirectoryWatcher.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Tooling/CommonOptionsParser.h"
 #include "clang/Tooling/DependencyScanning/DependencyScanningService.h"
 #include "clang/Tooling/DependencyScanning/DependencyScanningTool.h"
 #include "clang/Tooling/DependencyScanning/DependencyScanningWorker.h"
 #include "clang/Tooling/JSONCompilationDatabase.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileUtilities.h"
 #include "llvm/Support/InitLLVM.h"
@@ -20,6 +23,7 @@
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/Threading.h"
+#include <cstdio>
 #include <mutex>
 #include <thread>
 
@@ -160,6 +164,20 @@ llvm::cl::opt<bool> SkipExcludedPPRanges(
         "until reaching the end directive."),
     llvm::cl::init(true), llvm::cl::cat(DependencyScannerCategory));
 
+llvm::cl::opt<std::string> MinimizedSourceCacheDir(
+    "minimized-source-cache-path",
+    llvm::cl::desc("Cache the minimized sources in the given directory, and "
+                   "reuse the sources minimized by earlier scans."),
+    llvm::cl::value_desc("directory"),
+    llvm::cl::cat(DependencyScannerCategory));
+
+llvm::cl::opt<bool> ServerMode(
+    "server",
+    llvm::cl::desc("Keep running and answer the scan requests read from the "
+                   "standard input, only rescanning the translation units "
+                   "whose dependencies changed since the previous request."),
+    llvm::cl::init(false), llvm::cl::cat(DependencyScannerCategory));
+
 llvm::cl::opt<bool> Verbose("v", llvm::cl::Optional,
                             llvm::cl::desc("Use verbose output."),
                             llvm::cl::init(false),
@@ -192,6 +210,17 @@ private:
   tooling::CompileCommand Command;
 };
 
+/// Prints the error of a failed dependency scan.
+static void reportScanningError(StringRef Input, llvm::Error E,
+                                SharedStream &Errs) {
+  llvm::handleAllErrors(std::move(E), [&Input, &Errs](llvm::StringError &Err) {
+    Errs.applyLocked([&](raw_ostream &OS) {
+      OS << "Error while scanning dependencies for " << Input << ":\n";
+      OS << Err.getMessage();
+    });
+  });
+}
+
 /// Takes the result of a dependency scan and prints error / dependency files
 /// based on the result.
 ///
@@ -201,13 +230,7 @@ handleMakeDependencyToolResult(const std::string &Input,
                                llvm::Expected<std::string> &MaybeFile,
                                SharedStream &OS, SharedStream &Errs) {
   if (!MaybeFile) {
-    llvm::handleAllErrors(
-        MaybeFile.takeError(), [&Input, &Errs](llvm::StringError &Err) {
-          Errs.applyLocked([&](raw_ostream &OS) {
-            OS << "Error while scanning dependencies for " << Input << ":\n";
-            OS << Err.getMessage();
-          });
-        });
+    reportScanningError(Input, MaybeFile.takeError(), Errs);
     return true;
   }
   OS.applyLocked([&](raw_ostream &OS) { OS << *MaybeFile; });
@@ -390,6 +413,270 @@ static bool handleFullDependencyToolResult(
   return false;
 }
 
+/// Answers the requests of a build system, keeping the results of the scans
+/// until the files they depend on change.
+///
+/// Each line of the standard input is a request: "scan" prints the
+/// dependencies of all the translation units of the compilation database,
+/// "scan <file>" those of the translation units of <file>, and "quit" exits.
+/// The response to a scan is the list of the dependency files, in the order of
+/// the compilation database, followed by an empty line. Errors are reported on
+/// the standard error as in the batch mode, and failed scans are never reused.
+///
+/// The directories of the dependencies are watched for changes, which
+/// invalidate the results and the cached files that have the same file name as
+/// the changed files. This is conservative, but also catches the headers that
+/// are created in an include directory that comes first in the search path.
+class ScanningServer {
+public:
+  ScanningServer(
+      DependencyScanningService &Service,
+      ArrayRef<SingleCommandCompilationDatabase> Inputs, llvm::ThreadPool &Pool,
+      ArrayRef<std::unique_ptr<DependencyScanningTool>> WorkerTools)
+      : Service(Service), Inputs(Inputs), Pool(Pool), WorkerTools(WorkerTools),
+        Results(Inputs.size()) {}
+
+  /// Answers requests until the end of the input.
+  void run(raw_ostream &OS, SharedStream &Errs);
+
+private:
+  struct ScanResult {
+    bool Valid = false;
+    std::string DependencyFile;
+    std::vector<std::string> FileDeps;
+  };
+
+  /// Scans the inputs with the given indices whose results are not valid.
+  void scan(ArrayRef<size_t> Indices, SharedStream &Errs);
+
+  /// Invalidates what the changes reported since the last call affect.
+  void applyChanges();
+
+  /// Starts watching the directory \p Dir if it isn't watched yet.
+  void watch(StringRef Dir, SharedStream &Errs);
+
+  DependencyScanningService &Service;
+  ArrayRef<SingleCommandCompilationDatabase> Inputs;
+  llvm::ThreadPool &Pool;
+  ArrayRef<std::unique_ptr<DependencyScanningTool>> WorkerTools;
+  std::vector<ScanResult> Results;
+  /// The inputs with a valid result that depend on a file with a given name.
+  llvm::StringMap<llvm::DenseSet<unsigned>> Dependents;
+  /// False if a directory couldn't be watched, in which case nothing is kept
+  /// from one request to the next.
+  bool CanWatch = true;
+
+  std::mutex ChangesLock;
+  /// The names of the files that changed since the last request.
+  llvm::StringSet<> ChangedFileNames;
+  /// Whether a watcher was invalidated, and changes may have been missed.
+  bool MissedChanges = false;
+
+  /// Declared last so that the watchers are stopped before the state they
+  /// report the changes to is destroyed.
+  llvm::StringMap<std::unique_ptr<DirectoryWatcher>> Watchers;
+};
+
+/// Reads a line from \p F without the trailing newline.
+///
+/// \returns False at the end of the input.
+static bool readLine(FILE *F, std::string &Line) {
+  Line.clear();
+  char Buffer[4096];
+  while (fgets(Buffer, sizeof(Buffer), F)) {
+    Line += Buffer;
+    if (!Line.empty() && Line.back() == '\n') {
+      Line.pop_back();
+      return true;
+    }
+  }
+  return !Line.empty();
+}
+
+void ScanningServer::run(raw_ostream &OS, SharedStream &Errs) {
+  // The absolute path of the input file of each command.
+  std::vector<std::string> InputFiles;
+  for (const SingleCommandCompilationDatabase &Input : Inputs) {
+    tooling::CompileCommand Cmd = Input.getAllCompileCommands()[0];
+    SmallString<256> Path(Cmd.Filename);
+    llvm::sys::fs::make_absolute(Cmd.Directory, Path);
+    llvm::sys::path::remove_dots(Path, /*remove_dot_dot=*/true);
+    InputFiles.push_back(std::string(Path.str()));
+  }
+
+  std::string Line;
+  while (readLine(stdin, Line)) {
+    StringRef Request = StringRef(Line).trim();
+    if (Request.empty())
+      continue;
+    if (Request == "quit")
+      return;
+
+    if (!Request.consume_front("scan") ||
+        (!Request.empty() && !isWhitespace(Request.front()))) {
+      Errs.applyLocked([&](raw_ostream &OS) {
+        OS << "error: unknown request '" << Line << "'\n";
+      });
+      OS << "\n";
+      OS.flush();
+      continue;
+    }
+    StringRef File = Request.trim();
+
+    std::vector<size_t> Indices;
+    SmallString<256> Path(File);
+    if (!File.empty()) {
+      llvm::sys::fs::make_absolute(Path);
+      llvm::sys::path::remove_dots(Path, /*remove_dot_dot=*/true);
+    }
+    for (size_t I = 0, E = InputFiles.size(); I != E; ++I)
+      if (File.empty() || InputFiles[I] == Path)
+        Indices.push_back(I);
+
+    applyChanges();
+    scan(Indices, Errs);
+    for (size_t Index : Indices) {
+      ScanResult &Result = Results[Index];
+      if (Result.Valid)
+        OS << Result.DependencyFile;
+    }
+    OS << "\n";
+    OS.flush();
+  }
+}
+
+void ScanningServer::scan(ArrayRef<size_t> Indices, SharedStream &Errs) {
+  std::vector<size_t> Pending;
+  for (size_t Index : Indices)
+    if (!Results[Index].Valid)
+      Pending.push_back(Index);
+
+  std::mutex Lock;
+  size_t Next = 0;
+  for (unsigned I = 0; I < Pool.getThreadCount(); ++I) {
+    Pool.async([this, I, &Lock, &Next, &Pending, &Errs]() {
+      while (true) {
+        size_t Index;
+        {
+          std::unique_lock<std::mutex> LockGuard(Lock);
+          if (Next >= Pending.size())
+            return;
+          Index = Pending[Next++];
+        }
+        const SingleCommandCompilationDatabase &Input = Inputs[Index];
+        tooling::CompileCommand Cmd = Input.getAllCompileCommands()[0];
+        ScanResult &Result = Results[Index];
+        Result.FileDeps.clear();
+        auto MaybeFile = WorkerTools[I]->getDependencyFile(
+            Input, Cmd.Directory, &Result.FileDeps);
+        if (!MaybeFile) {
+          reportScanningError(Cmd.Filename, MaybeFile.takeError(), Errs);
+          continue;
+        }
+        Result.DependencyFile = std::move(*MaybeFile);
+        for (std::string &Dep : Result.FileDeps) {
+          SmallString<256> Path(Dep);
+          llvm::sys::fs::make_absolute(Cmd.Directory, Path);
+          llvm::sys::path::remove_dots(Path, /*remove_dot_dot=*/true);
+          Dep = std::string(Path.str());
+        }
+        Result.Valid = true;
+      }
+    });
+  }
+  Pool.wait();
+
+  for (size_t Index : Pending) {
+    ScanResult &Result = Results[Index];
+    if (!Result.Valid)
+      continue;
+    for (const std::string &Dep : Result.FileDeps) {
+      Dependents[llvm::sys::path::filename(Dep)].insert(Index);
+      watch(llvm::sys::path::parent_path(Dep), Errs);
+    }
+  }
+}
+
+void ScanningServer::applyChanges() {
+  llvm::StringSet<> FileNames;
+  bool InvalidateAll;
+  {
+    std::unique_lock<std::mutex> LockGuard(ChangesLock);
+    std::swap(FileNames, ChangedFileNames);
+    InvalidateAll = MissedChanges || !CanWatch;
+    MissedChanges = false;
+  }
+
+  if (InvalidateAll) {
+    for (ScanResult &Result : Results)
+      Result.Valid = false;
+    Dependents.clear();
+    // Start over with new watchers, since the ones that missed changes are
+    // no longer reliable.
+    Watchers.clear();
+    CanWatch = true;
+    Service.getSharedCache().invalidate(nullptr);
+    return;
+  }
+
+  if (FileNames.empty())
+    return;
+  for (const auto &FileName : FileNames) {
+    auto It = Dependents.find(FileName.getKey());
+    if (It == Dependents.end())
+      continue;
+    for (unsigned Index : It->getValue())
+      Results[Index].Valid = false;
+    Dependents.erase(It);
+  }
+  Service.getSharedCache().invalidate(&FileNames);
+}
+
+void ScanningServer::watch(StringRef Dir, SharedStream &Errs) {
+  if (!CanWatch || Dir.empty() || Watchers.count(Dir))
+    return;
+
+  auto Receiver = [this](ArrayRef<DirectoryWatcher::Event> Events,
+                         bool IsInitial) {
+    // The initial events list the files that are already in the directory.
+    if (IsInitial)
+      return;
+    std::unique_lock<std::mutex> LockGuard(ChangesLock);
+    for (const DirectoryWatcher::Event &E : Events) {
+      switch (E.Kind) {
+      case DirectoryWatcher::Event::EventKind::Removed:
+      case DirectoryWatcher::Event::EventKind::Modified:
+        ChangedFileNames.insert(E.Filename);
+        break;
+      case DirectoryWatcher::Event::EventKind::WatchedDirRemoved:
+      case DirectoryWatcher::Event::EventKind::WatcherGotInvalidated:
+        MissedChanges = true;
+        break;
+      }
+    }
+  };
+
+  // DirectoryWatcher::create doesn't return an error for a path that isn't a
+  // directory.
+  llvm::Expected<std::unique_ptr<DirectoryWatcher>> Watcher =
+      llvm::sys::fs::is_directory(Dir)
+          ? DirectoryWatcher::create(Dir, Receiver,
+                                     /*WaitForInitialSync=*/false)
+          : llvm::createStringError(
+                std::make_error_code(std::errc::not_a_directory),
+                "not a directory");
+  if (!Watcher) {
+    std::string Message = llvm::toString(Watcher.takeError());
+    Errs.applyLocked([&](raw_ostream &OS) {
+      OS << "warning: unable to watch '" << Dir << "' for changes: " << Message
+         << "; the results will not be reused\n";
+    });
+    CanWatch = false;
+    return;
+  }
+  Watchers[Dir] = std::move(*Watcher);
+}
+
 int main(int argc, const char **argv) {
   llvm::InitLLVM X(argc, argv);
   llvm::cl::HideUnrelatedOptions(DependencyScannerCategory);
@@ -485,7 +772,8 @@ int main(int argc, const char **argv) {
   SharedStream DependencyOS(llvm::outs());
 
   DependencyScanningService Service(ScanMode, Format, ReuseFileManager,
-                                    SkipExcludedPPRanges);
+                                    SkipExcludedPPRanges,
+                                    MinimizedSourceCacheDir);
   llvm::ThreadPool Pool(llvm::hardware_concurrency(NumThreads));
   std::vector<std::unique_ptr<DependencyScanningTool>> WorkerTools;
   for (unsigned I = 0; I < Pool.getThreadCount(); ++I)
@@ -496,6 +784,16 @@ int main(int argc, const char **argv) {
        AdjustingCompilations->getAllCompileCommands())
     Inputs.emplace_back(Cmd);
 
+  if (ServerMode) {
+    if (Format != ScanningOutputFormat::Make) {
+      llvm::errs() << "error: -server requires -format=make\n";
+      return 1;
+    }
+    ScanningServer Server(Service, Inputs, Pool, WorkerTools);
+    Server.run(llvm::outs(), Errs);
+    return 0;
+  }
+
   std::atomic<bool> HadErrors(false);
   FullDeps FD;
   std::mutex Lock;
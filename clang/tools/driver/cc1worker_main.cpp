@@ -0,0 +1,244 @@
+//===-- cc1worker_main.cpp - Clang persistent CC1 worker ------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This is the entry point to the clang -cc1worker functionality, which runs
+// many -cc1 jobs in a single process so that their startup costs are paid
+// once, and reuses what they loaded when it is safe to do so.
+//
+// The worker speaks the JSON flavor of the Bazel persistent worker protocol:
+// each line of its standard input is a work request of the form
+//
+//   {"arguments": ["-cc1", "-triple", ...], "requestId": 1}
+//
+// and it answers each of them, in order, with a line on its standard output
+// of the form
+//
+//   {"exitCode": 0, "output": "<diagnostics>", "requestId": 1}
+//
+// The arguments may name response files. The jobs must not write to the
+// standard output, which belongs to the protocol. The worker exits when its
+// input is closed.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/LLVM.h"
+#include "clang/CodeGen/ObjectFilePCHContainerOperations.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Frontend/TextDiagnosticBuffer.h"
+#include "clang/Frontend/TextDiagnosticPrinter.h"
+#include "clang/FrontendTool/Utils.h"
+#include "clang/Lex/PreprocessorOptions.h"
+#include "clang/Serialization/InMemoryModuleCache.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/StringSaver.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <iostream>
+#include <string>
+
+using namespace clang;
+
+namespace {
+
+/// The state that outlives the jobs of a worker.
+class CC1Worker {
+public:
+  CC1Worker(const char *Argv0, void *MainAddr)
+      : Argv0(Argv0), MainAddr(MainAddr),
+        PCHOps(std::make_shared<PCHContainerOperations>()) {
+    // Register the support for object-file-wrapped Clang modules.
+    PCHOps->registerWriter(std::make_unique<ObjectFilePCHContainerWriter>());
+    PCHOps->registerReader(std::make_unique<ObjectFilePCHContainerReader>());
+  }
+
+  /// Runs the -cc1 job with the arguments \p Args, and returns its exit code.
+  /// The diagnostics of the job are written to \p Output.
+  int runJob(ArrayRef<const char *> Args, raw_ostream &Output);
+
+private:
+  /// Drops the file manager and the module cache of the previous jobs, unless
+  /// they can be trusted by the job run with \p Invocation.
+  void discardStaleState(const CompilerInvocation &Invocation);
+
+  const char *Argv0;
+  void *MainAddr;
+  std::shared_ptr<PCHContainerOperations> PCHOps;
+
+  /// The file manager of the previous job, and the options it was created
+  /// for.
+  IntrusiveRefCntPtr<FileManager> FileMgr;
+  std::string FileMgrWorkingDir;
+  std::vector<std::string> FileMgrVFSOverlayFiles;
+
+  /// The PCMs loaded and built by the previous jobs. They are only valid
+  /// along with the file manager that was used to validate them.
+  IntrusiveRefCntPtr<InMemoryModuleCache> ModuleCache;
+
+  /// The -mllvm options of the first job that had any. They set the state of
+  /// the process, so every later job must agree with them.
+  Optional<std::vector<std::string>> LLVMArgs;
+};
+
+} // end anonymous namespace
+
+void CC1Worker::discardStaleState(const CompilerInvocation &Invocation) {
+  if (!FileMgr)
+    return;
+
+  // The file manager caches the results of all the lookups made by the
+  // previous jobs. It is only safe to reuse if it has the same view of the
+  // file system and none of these results has changed since. The PCMs in the
+  // module cache were validated against the files the file manager saw, so
+  // they go away with it.
+  const PreprocessorOptions &PPOpts = Invocation.getPreprocessorOpts();
+  if (FileMgrWorkingDir != Invocation.getFileSystemOpts().WorkingDir ||
+      FileMgrVFSOverlayFiles !=
+          Invocation.getHeaderSearchOpts().VFSOverlayFiles ||
+      !PPOpts.RemappedFiles.empty() || !PPOpts.RemappedFileBuffers.empty() ||
+      !FileMgr->isUpToDate()) {
+    FileMgr = nullptr;
+    ModuleCache = nullptr;
+  }
+}
+
+int CC1Worker::runJob(ArrayRef<const char *> Args, raw_ostream &Output) {
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
+
+  // Buffer diagnostics from argument parsing so that we can output them using a
+  // well formed diagnostic object.
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+  TextDiagnosticBuffer *DiagsBuffer = new TextDiagnosticBuffer;
+  DiagnosticsEngine Diags(DiagID, &*DiagOpts, DiagsBuffer);
+  auto Invocation = std::make_shared<CompilerInvocation>();
+  bool Success =
+      CompilerInvocation::CreateFromArgs(*Invocation, Args, Diags, Argv0);
+
+  // Nothing the job allocates may outlive it: the worker would leak it.
+  Invocation->getFrontendOpts().DisableFree = false;
+  Invocation->getCodeGenOpts().DisableFree = false;
+
+  // Infer the builtin include path if unspecified.
+  if (Invocation->getHeaderSearchOpts().UseBuiltinIncludes &&
+      Invocation->getHeaderSearchOpts().ResourceDir.empty())
+    Invocation->getHeaderSearchOpts().ResourceDir =
+        CompilerInvocation::GetResourcesPath(Argv0, MainAddr);
+
+  discardStaleState(*Invocation);
+  if (!ModuleCache)
+    ModuleCache = new InMemoryModuleCache;
+  CompilerInstance Clang(PCHOps, ModuleCache.get());
+  Clang.setInvocation(std::move(Invocation));
+
+  // Create the actual diagnostics engine.
+  Clang.createDiagnostics(
+      new TextDiagnosticPrinter(Output, &Clang.getDiagnosticOpts()));
+  if (!Clang.hasDiagnostics())
+    return 1;
+
+  DiagsBuffer->FlushDiagnostics(Clang.getDiagnostics());
+  if (!Success)
+    return 1;
+
+  // The -mllvm options set the state of the whole process, so all the jobs
+  // must agree on them.
+  const std::vector<std::string> &JobLLVMArgs =
+      Clang.getFrontendOpts().LLVMArgs;
+  if (!LLVMArgs && !JobLLVMArgs.empty())
+    LLVMArgs = JobLLVMArgs;
+  if (LLVMArgs && *LLVMArgs != JobLLVMArgs) {
+    Output << "error: the -mllvm options of a job can't differ from those of "
+              "the previous jobs of the worker\n";
+    return 1;
+  }
+  llvm::cl::ResetAllOptionOccurrences();
+
+  if (FileMgr) {
+    Clang.setFileManager(FileMgr.get());
+  } else {
+    FileMgrWorkingDir = Clang.getFileSystemOpts().WorkingDir;
+    FileMgrVFSOverlayFiles = Clang.getHeaderSearchOpts().VFSOverlayFiles;
+  }
+
+  Success = ExecuteCompilerInvocation(&Clang);
+
+  // If any timers were active but haven't been destroyed yet, print their
+  // results now.
+  llvm::TimerGroup::printAll(Output);
+  llvm::TimerGroup::clearAll();
+
+  if (Clang.hasFileManager())
+    FileMgr = &Clang.getFileManager();
+  return !Success;
+}
+
+int cc1worker_main(ArrayRef<const char *> Argv, const char *Argv0,
+                   void *MainAddr) {
+  if (!Argv.empty()) {
+    llvm::errs() << "error: -cc1worker takes no arguments; the arguments of "
+                    "the jobs are read from the standard input\n";
+    return 1;
+  }
+
+  llvm::InitializeAllTargets();
+  llvm::InitializeAllTargetMCs();
+  llvm::InitializeAllAsmPrinters();
+  llvm::InitializeAllAsmParsers();
+
+  CC1Worker Worker(Argv0, MainAddr);
+  std::string Line;
+  while (std::getline(std::cin, Line)) {
+    if (StringRef(Line).trim().empty())
+      continue;
+
+    llvm::Expected<llvm::json::Value> Request = llvm::json::parse(Line);
+    if (!Request) {
+      llvm::errs() << "error: malformed work request: "
+                   << llvm::toString(Request.takeError()) << "\n";
+      return 1;
+    }
+    const llvm::json::Object *Obj = Request->getAsObject();
+    const llvm::json::Array *Arguments =
+        Obj ? Obj->getArray("arguments") : nullptr;
+    if (!Arguments) {
+      llvm::errs() << "error: work request without arguments\n";
+      return 1;
+    }
+
+    llvm::BumpPtrAllocator A;
+    llvm::StringSaver Saver(A);
+    SmallVector<const char *, 256> Args;
+    for (const llvm::json::Value &Arg : *Arguments)
+      if (Optional<StringRef> S = Arg.getAsString())
+        Args.push_back(Saver.save(*S).data());
+    llvm::cl::ExpandResponseFiles(Saver, &llvm::cl::TokenizeGNUCommandLine,
+                                  Args, /*MarkEOLs=*/false);
+    ArrayRef<const char *> JobArgs = Args;
+    if (!JobArgs.empty() && StringRef(JobArgs.front()) == "-cc1")
+      JobArgs = JobArgs.drop_front();
+
+    std::string Output;
+    llvm::raw_string_ostream OS(Output);
+    int ExitCode = Worker.runJob(JobArgs, OS);
+    OS.flush();
+
+    llvm::json::Object Response{{"exitCode", ExitCode}, {"output", Output}};
+    if (Optional<int64_t> Id = Obj->getInteger("requestId"))
+      Response["requestId"] = *Id;
+    llvm::outs() << llvm::json::Value(std::move(Response)) << "\n";
+    llvm::outs().flush();
+  }
+  return 0;
+}
@@ -583,4 +583,25 @@ TEST_F(FileManagerTest, getBypassFile) {
       &expectedToOptional(Manager.getFileRef("/tmp/test"))->getFileEntry());
 }
 
+TEST_F(FileManagerTest, isUpToDate) {
+  auto FS = IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem>(
+      new llvm::vfs::InMemoryFileSystem);
+  FS->addFile("/tmp/a.h", 0, llvm::MemoryBuffer::getMemBuffer("a"));
+
+  FileManager Manager(FileSystemOptions(), FS);
+  ASSERT_TRUE(Manager.getFile("/tmp/a.h"));
+  ASSERT_FALSE(Manager.getFile("/tmp/b.h"));
+  ASSERT_FALSE(Manager.getDirectory("/tmp/dir"));
+  EXPECT_TRUE(Manager.isUpToDate());
+
+  // A file that was looked up but didn't exist shows up.
+  FS->addFile("/tmp/b.h", 0, llvm::MemoryBuffer::getMemBuffer("b"));
+  EXPECT_FALSE(Manager.isUpToDate());
+
+  // Virtual files don't come from the file system.
+  FileManager VirtualManager(FileSystemOptions(), FS);
+  VirtualManager.getVirtualFile("/tmp/c.h", 1, 0);
+  EXPECT_FALSE(VirtualManager.isUpToDate());
+}
+
 } // anonymous namespace
@@ -0,0 +1,115 @@
+//===- unittests/Basic/PersistentStatCacheTest.cpp ------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/PersistentStatCache.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/FileSystemOptions.h"
+#include "clang/Basic/FileSystemStatCache.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include "gtest/gtest.h"
+#include <ctime>
+
+using namespace llvm;
+using namespace clang;
+
+namespace {
+
+class PersistentStatCacheTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_FALSE(sys::fs::createUniqueDirectory("stat-cache-test", CacheDir));
+    CacheFile = PersistentStatCache::getCacheFileName(CacheDir, "key");
+  }
+
+  void TearDown() override { sys::fs::remove_directories(CacheDir); }
+
+  /// Returns a file manager that looks \p FS up through \p Cache.
+  IntrusiveRefCntPtr<FileManager>
+  createFileManager(IntrusiveRefCntPtr<vfs::FileSystem> FS,
+                    std::shared_ptr<PersistentStatCache> Cache) {
+    IntrusiveRefCntPtr<FileManager> FileMgr =
+        new FileManager(FileSystemOptions(), std::move(FS));
+    FileMgr->setStatCache(
+        PersistentStatCache::createFileSystemStatCache(std::move(Cache)));
+    return FileMgr;
+  }
+
+  SmallString<128> CacheDir;
+  std::string CacheFile;
+};
+
+TEST_F(PersistentStatCacheTest, ResultsAreShared) {
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> FS(new vfs::InMemoryFileSystem);
+  FS->addFile("/dir/foo.h", 0, MemoryBuffer::getMemBuffer("#pragma once\n"));
+
+  {
+    std::shared_ptr<PersistentStatCache> Cache =
+        PersistentStatCache::load(CacheFile, /*SessionTimestamp=*/0);
+    IntrusiveRefCntPtr<FileManager> FileMgr = createFileManager(FS, Cache);
+    EXPECT_TRUE(FileMgr->getFile("/dir/foo.h"));
+    EXPECT_FALSE(FileMgr->getFile("/dir/bar.h"));
+    Cache->addIncludeGuard("/dir/foo.h", "FOO_H");
+    ASSERT_FALSE(bool(Cache->write()));
+  }
+
+  // A later compilation gets the results without looking at the file system.
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> EmptyFS(
+      new vfs::InMemoryFileSystem);
+  EmptyFS->addFile("/dir/bar.h", 0, MemoryBuffer::getMemBuffer(""));
+  std::shared_ptr<PersistentStatCache> Cache =
+      PersistentStatCache::load(CacheFile, /*SessionTimestamp=*/0);
+  IntrusiveRefCntPtr<FileManager> FileMgr = createFileManager(EmptyFS, Cache);
+  auto Foo = FileMgr->getFile("/dir/foo.h");
+  ASSERT_TRUE(Foo);
+  EXPECT_EQ(13, (*Foo)->getSize());
+  EXPECT_FALSE(FileMgr->getFile("/dir/bar.h"));
+  EXPECT_EQ("FOO_H", Cache->getIncludeGuard("/dir/foo.h"));
+  EXPECT_EQ("", Cache->getIncludeGuard("/dir/bar.h"));
+}
+
+TEST_F(PersistentStatCacheTest, WritesMergeTheCachedResults) {
+  {
+    std::shared_ptr<PersistentStatCache> Cache =
+        PersistentStatCache::load(CacheFile, /*SessionTimestamp=*/0);
+    Cache->addIncludeGuard("/a.h", "A_H");
+    ASSERT_FALSE(bool(Cache->write()));
+  }
+  {
+    std::shared_ptr<PersistentStatCache> Cache =
+        PersistentStatCache::load(CacheFile, /*SessionTimestamp=*/0);
+    Cache->addIncludeGuard("/b.h", "B_H");
+    ASSERT_FALSE(bool(Cache->write()));
+  }
+
+  std::shared_ptr<PersistentStatCache> Cache =
+      PersistentStatCache::load(CacheFile, /*SessionTimestamp=*/0);
+  EXPECT_EQ("A_H", Cache->getIncludeGuard("/a.h"));
+  EXPECT_EQ("B_H", Cache->getIncludeGuard("/b.h"));
+  Optional<PersistentStatCache::Entry> E = Cache->lookup("/a.h");
+  ASSERT_TRUE(E);
+  EXPECT_FALSE(E->HasStat);
+}
+
+TEST_F(PersistentStatCacheTest, CacheFromAnEarlierSessionIsIgnored) {
+  {
+    std::shared_ptr<PersistentStatCache> Cache =
+        PersistentStatCache::load(CacheFile, /*SessionTimestamp=*/0);
+    Cache->addIncludeGuard("/a.h", "A_H");
+    ASSERT_FALSE(bool(Cache->write()));
+  }
+
+  uint64_t NextHour = std::time(nullptr) + 3600;
+  std::shared_ptr<PersistentStatCache> Cache =
+      PersistentStatCache::load(CacheFile, NextHour);
+  EXPECT_FALSE(Cache->lookup("/a.h"));
+}
+
+} // namespace
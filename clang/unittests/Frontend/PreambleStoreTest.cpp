@@ -0,0 +1,115 @@
+//====-- unittests/Frontend/PreambleStoreTest.cpp - Preamble store tests --===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/TargetOptions.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Frontend/PCHContainerOperations.h"
+#include "clang/Frontend/PrecompiledPreamble.h"
+#include "clang/Lex/PreprocessorOptions.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace clang;
+
+namespace {
+
+const char MainName[] = "//./main.cpp";
+const char HeaderName[] = "//./header.h";
+const char MainContents[] = "#include \"//./header.h\"\n"
+                            "int main() { return ZERO; }\n";
+
+class PreambleStoreTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    ASSERT_FALSE(sys::fs::createUniqueDirectory("preamble-store", StoreDir));
+
+    Invocation = std::make_shared<CompilerInvocation>();
+    Invocation->getFrontendOpts().Inputs.push_back(
+        FrontendInputFile(MainName, Language::CXX));
+    Invocation->getTargetOpts().Triple = "i386-unknown-linux-gnu";
+    MainBuffer = MemoryBuffer::getMemBufferCopy(MainContents, MainName);
+    Bounds = ComputePreambleBounds(*Invocation->getLangOpts(), *MainBuffer, 0);
+
+    setHeader("#define ZERO 0\n");
+  }
+
+  void TearDown() override { sys::fs::remove_directories(StoreDir); }
+
+  void setHeader(StringRef Contents) {
+    FS = new vfs::InMemoryFileSystem();
+    FS->setCurrentWorkingDirectory("//./");
+    FS->addFile(MainName, 1, MemoryBuffer::getMemBufferCopy(MainContents));
+    FS->addFile(HeaderName, 1, MemoryBuffer::getMemBufferCopy(Contents));
+  }
+
+  ErrorOr<PrecompiledPreamble> build() {
+    IntrusiveRefCntPtr<DiagnosticsEngine> Diags =
+        CompilerInstance::createDiagnostics(new DiagnosticOptions,
+                                            new DiagnosticConsumer);
+    PreambleCallbacks Callbacks;
+    return PrecompiledPreamble::Build(
+        *Invocation, MainBuffer.get(), Bounds, *Diags, FS,
+        std::make_shared<PCHContainerOperations>(), /*StoreInMemory=*/true,
+        Callbacks);
+  }
+
+  ErrorOr<PrecompiledPreamble> load() {
+    return PrecompiledPreamble::LoadFromStore(StoreDir, *Invocation,
+                                              MainBuffer.get(), Bounds,
+                                              FS.get());
+  }
+
+  SmallString<128> StoreDir;
+  std::shared_ptr<CompilerInvocation> Invocation;
+  std::unique_ptr<MemoryBuffer> MainBuffer;
+  PreambleBounds Bounds = {0, false};
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> FS;
+};
+
+TEST_F(PreambleStoreTest, LoadsSavedPreamble) {
+  EXPECT_EQ(load().getError(),
+            std::make_error_code(std::errc::no_such_file_or_directory));
+
+  ErrorOr<PrecompiledPreamble> Built = build();
+  ASSERT_TRUE(Built);
+  ASSERT_FALSE(Built->SaveToStore(StoreDir, *Invocation));
+
+  ErrorOr<PrecompiledPreamble> Loaded = load();
+  ASSERT_TRUE(Loaded);
+  EXPECT_EQ(Loaded->getContents(), Built->getContents());
+  EXPECT_EQ(Loaded->getSize(), Built->getSize());
+  EXPECT_TRUE(Loaded->CanReuse(*Invocation, MainBuffer.get(), Bounds,
+                               FS.get()));
+}
+
+TEST_F(PreambleStoreTest, RejectsOutOfDatePreamble) {
+  ErrorOr<PrecompiledPreamble> Built = build();
+  ASSERT_TRUE(Built);
+  ASSERT_FALSE(Built->SaveToStore(StoreDir, *Invocation));
+
+  setHeader("#define ZERO (1 - 1)\n");
+  EXPECT_EQ(load().getError(),
+            make_error_code(BuildPreambleError::StoredPreambleInvalid));
+}
+
+TEST_F(PreambleStoreTest, KeysPreamblesByOptions) {
+  ErrorOr<PrecompiledPreamble> Built = build();
+  ASSERT_TRUE(Built);
+  ASSERT_FALSE(Built->SaveToStore(StoreDir, *Invocation));
+
+  Invocation->getPreprocessorOpts().addMacroDef("ONE=1");
+  EXPECT_EQ(load().getError(),
+            std::make_error_code(std::errc::no_such_file_or_directory));
+}
+
+} // anonymous namespace
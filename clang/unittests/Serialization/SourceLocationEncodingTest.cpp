@@ -0,0 +1,132 @@
+//===- SourceLocationEncodingTest.cpp - SourceLocationEncoding tests ------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Serialization/SourceLocationEncoding.h"
+#include "gtest/gtest.h"
+#include <climits>
+#include <vector>
+
+using namespace llvm;
+using namespace clang;
+
+namespace {
+
+using LocSeq = SourceLocationSequence;
+
+// Convert a single source location into encoded form and back.
+// If ExpectedEncoded is provided, verify the encoded value too.
+// Loc is the raw (in-memory) form of SourceLocation.
+void roundTrip(uint32_t Loc, llvm::Optional<uint64_t> ExpectedEncoded = None) {
+  uint64_t ActualEncoded =
+      SourceLocationEncoding::encode(SourceLocation::getFromRawEncoding(Loc));
+  if (ExpectedEncoded)
+    ASSERT_EQ(ActualEncoded, *ExpectedEncoded) << "Encoding " << Loc;
+  uint32_t DecodedEncoded =
+      SourceLocationEncoding::decode(ActualEncoded).getRawEncoding();
+  ASSERT_EQ(DecodedEncoded, Loc) << "Decoding " << ActualEncoded;
+}
+
+// As above, but use sequence encoding for a series of locations.
+void roundTrip(std::vector<uint32_t> Locs,
+               std::vector<uint64_t> ExpectedEncoded = {}) {
+  std::vector<uint64_t> ActualEncoded;
+  {
+    LocSeq::State Seq;
+    for (uint32_t L : Locs)
+      ActualEncoded.push_back(SourceLocationEncoding::encode(
+          SourceLocation::getFromRawEncoding(L), Seq));
+    if (!ExpectedEncoded.empty())
+      ASSERT_EQ(ActualEncoded, ExpectedEncoded)
+          << "Encoding " << testing::PrintToString(Locs);
+  }
+  std::vector<uint32_t> DecodedEncoded;
+  {
+    LocSeq::State Seq;
+    for (uint64_t L : ActualEncoded) {
+      SourceLocation Loc = SourceLocationEncoding::decode(L, Seq);
+      DecodedEncoded.push_back(Loc.getRawEncoding());
+    }
+    ASSERT_EQ(DecodedEncoded, Locs)
+        << "Decoding " << testing::PrintToString(ActualEncoded);
+  }
+}
+
+constexpr uint32_t MacroBit = 1u << 31;
+constexpr uint32_t Big = MacroBit >> 1;
+
+TEST(SourceLocationEncoding, Individual) {
+  roundTrip(1, 2);
+  roundTrip(100, 200);
+  roundTrip(MacroBit, 1);
+  roundTrip(MacroBit | 5, 11);
+  roundTrip(Big);
+  roundTrip(Big + 1);
+  roundTrip(MacroBit | Big);
+  roundTrip(MacroBit | (Big + 1));
+}
+
+TEST(SourceLocationEncoding, Sequence) {
+  roundTrip({1, 2, 3, 3, 2, 1},
+            {2, // 1
+             5, // +2 (+1 of non-raw)
+             5, // +2
+             1, // +0
+             4, // +2
+             4} // +2
+  );
+  roundTrip({100, 0, 100},
+            {200, // 100
+             0,   // 0
+             1}   // +0
+  );
+
+  roundTrip({1, Big}, {2, ((Big - 1) << 2) + 1});
+  roundTrip({2, MacroBit | Big}, {4, ((Big - 1) << 2) - 1});
+
+  roundTrip({3, MacroBit | 5, MacroBit | 4, 3},
+            {6,  // 3
+             11, // +5 (+2 of non-raw + set macro bit)
+             4,  // +2
+             6}  // -3 (-2 of non-raw, clear macro bit)
+  );
+
+  roundTrip(
+      {123 | MacroBit, 1, 9, Big, Big + 1, 0, MacroBit | Big, 0});
+}
+
+TEST(SourceLocationEncoding, NestedSequences) {
+  // A nested sequence continues the sequence it is part of, so decoding must
+  // mirror the nesting of the encoder.
+  std::vector<uint64_t> Encoded;
+  {
+    LocSeq::State Outer;
+    Encoded.push_back(SourceLocationEncoding::encode(
+        SourceLocation::getFromRawEncoding(10), Outer));
+    {
+      LocSeq::State Inner(Outer);
+      Encoded.push_back(SourceLocationEncoding::encode(
+          SourceLocation::getFromRawEncoding(11), Inner));
+    }
+    Encoded.push_back(SourceLocationEncoding::encode(
+        SourceLocation::getFromRawEncoding(12), Outer));
+  }
+  EXPECT_EQ(std::vector<uint64_t>({20, 5, 5}), Encoded);
+
+  LocSeq::State Outer;
+  EXPECT_EQ(10u, SourceLocationEncoding::decode(Encoded[0], Outer)
+                     .getRawEncoding());
+  {
+    LocSeq::State Inner(Outer);
+    EXPECT_EQ(11u, SourceLocationEncoding::decode(Encoded[1], Inner)
+                       .getRawEncoding());
+  }
+  EXPECT_EQ(12u, SourceLocationEncoding::decode(Encoded[2], Outer)
+                     .getRawEncoding());
+}
+
+} // namespace
@@ -14,8 +14,10 @@
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Tooling/CompilationDatabase.h"
+#include "clang/Tooling/DependencyScanning/DependencyScanningFilesystem.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TargetRegistry.h"
@@ -203,5 +205,96 @@ TEST(DependencyScanner, ScanDepsReuseFilemanagerHasInclude) {
   EXPECT_EQ(convert_to_slash(Deps[5]), "/root/symlink.h");
 }
 
+TEST(DependencyScanner, MinimizedSourceCacheIsShared) {
+  llvm::SmallString<128> CacheDir;
+  ASSERT_FALSE(
+      llvm::sys::fs::createUniqueDirectory("minimized-cache", CacheDir));
+  StringRef Source = "#include \"b.h\"\nint x;\n";
+
+  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> VFS(
+      new llvm::vfs::InMemoryFileSystem);
+  VFS->addFile("/a.h", 0, llvm::MemoryBuffer::getMemBuffer(Source));
+  {
+    dependencies::DependencyScanningFilesystemSharedCache SharedCache(
+        CacheDir);
+    dependencies::DependencyScanningWorkerFilesystem DepFS(SharedCache, VFS,
+                                                           nullptr);
+    auto File = DepFS.openFileForRead("/a.h");
+    ASSERT_TRUE(File);
+    auto Buffer = (*File)->getBuffer("/a.h");
+    ASSERT_TRUE(Buffer);
+    EXPECT_EQ("#include \"b.h\"\n", (*Buffer)->getBuffer());
+  }
+
+  // An entry that is already in the cache is used instead of minimizing the
+  // file again.
+  dependencies::MinimizedSourceCache Cache(CacheDir);
+  std::string Key = dependencies::MinimizedSourceCache::getKey(Source);
+  SmallString<64> Contents;
+  PreprocessorSkippedRangeMapping Mapping;
+  ASSERT_TRUE(Cache.lookup(Key, Contents, Mapping));
+  EXPECT_EQ("#include \"b.h\"\n", Contents);
+  Cache.store(Key, "#include \"c.h\"\n", Mapping);
+
+  dependencies::DependencyScanningFilesystemSharedCache SharedCache(CacheDir);
+  dependencies::DependencyScanningWorkerFilesystem DepFS(SharedCache, VFS,
+                                                         nullptr);
+  auto Status = DepFS.status("/a.h");
+  ASSERT_TRUE(Status);
+  EXPECT_EQ(15u, Status->getSize());
+  auto File = DepFS.openFileForRead("/a.h");
+  ASSERT_TRUE(File);
+  auto Buffer = (*File)->getBuffer("/a.h");
+  ASSERT_TRUE(Buffer);
+  EXPECT_EQ("#include \"c.h\"\n", (*Buffer)->getBuffer());
+
+  llvm::sys::fs::remove_directories(CacheDir);
+}
+
+TEST(DependencyScanner, InvalidateSharedCache) {
+  auto readFile = [](dependencies::DependencyScanningWorkerFilesystem &DepFS,
+                     StringRef Path) -> std::string {
+    auto File = DepFS.openFileForRead(Path);
+    if (!File)
+      return "<error>";
+    auto Buffer = (*File)->getBuffer(Path);
+    if (!Buffer)
+      return "<error>";
+    return std::string((*Buffer)->getBuffer());
+  };
+
+  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> OldFS(
+      new llvm::vfs::InMemoryFileSystem);
+  OldFS->addFile("/a.h", 0, llvm::MemoryBuffer::getMemBuffer("#define A 1\n"));
+  OldFS->addFile("/b.h", 0, llvm::MemoryBuffer::getMemBuffer("#define B 1\n"));
+  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> NewFS(
+      new llvm::vfs::InMemoryFileSystem);
+  NewFS->addFile("/a.h", 0, llvm::MemoryBuffer::getMemBuffer("#define A 2\n"));
+  NewFS->addFile("/b.h", 0, llvm::MemoryBuffer::getMemBuffer("#define B 2\n"));
+
+  dependencies::DependencyScanningFilesystemSharedCache SharedCache;
+  dependencies::DependencyScanningWorkerFilesystem OldDepFS(SharedCache, OldFS,
+                                                            nullptr);
+  EXPECT_EQ("#define A 1\n", readFile(OldDepFS, "/a.h"));
+  EXPECT_EQ("#define B 1\n", readFile(OldDepFS, "/b.h"));
+
+  dependencies::DependencyScanningWorkerFilesystem NewDepFS(SharedCache, NewFS,
+                                                            nullptr);
+  EXPECT_EQ("#define A 1\n", readFile(NewDepFS, "/a.h"));
+
+  unsigned Generation = SharedCache.getGeneration();
+  llvm::StringSet<> FileNames;
+  FileNames.insert("a.h");
+  SharedCache.invalidate(&FileNames);
+  EXPECT_NE(Generation, SharedCache.getGeneration());
+  NewDepFS.clearLocalCache();
+  EXPECT_EQ("#define A 2\n", readFile(NewDepFS, "/a.h"));
+  EXPECT_EQ("#define B 1\n", readFile(NewDepFS, "/b.h"));
+
+  SharedCache.invalidate(nullptr);
+  NewDepFS.clearLocalCache();
+  EXPECT_EQ("#define B 2\n", readFile(NewDepFS, "/b.h"));
+}
+
 } // end namespace tooling
 } // end namespace clang
@@ -1152,6 +1152,26 @@ void LsanMetadata::set_tag(ChunkTag value) {
   m->lsan_tag = value;
 }
 
+bool LsanMetadata::compare_exchange_tag(ChunkTag expected, ChunkTag value) {
+  __asan::AsanChunk *m = reinterpret_cast<__asan::AsanChunk *>(metadata_);
+  // lsan_tag is in the byte after chunk_state, along with other bit fields
+  // that do not change while the world is stopped.
+  atomic_uint8_t *bits = &m->chunk_state + 1;
+  __asan::ChunkHeader h;
+  u8 old_bits = atomic_load(bits, memory_order_relaxed);
+  for (;;) {
+    internal_memcpy(reinterpret_cast<u8 *>(&h) + 1, &old_bits, 1);
+    if (h.lsan_tag != expected)
+      return false;
+    h.lsan_tag = value;
+    u8 new_bits;
+    internal_memcpy(&new_bits, reinterpret_cast<u8 *>(&h) + 1, 1);
+    if (atomic_compare_exchange_weak(bits, &old_bits, new_bits,
+                                     memory_order_relaxed))
+      return true;
+  }
+}
+
 uptr LsanMetadata::requested_size() const {
   __asan::AsanChunk *m = reinterpret_cast<__asan::AsanChunk *>(metadata_);
   return m->UsedSize();
@@ -149,6 +149,8 @@ void InitializeFlags() {
     f->check_initialization_order = true;
   }
   CHECK_LE((uptr)common_flags()->malloc_context_size, kStackTraceMax);
+  CHECK_GE(f->malloc_context_sample_rate, 1);
+  CHECK_GE(f->unsampled_malloc_context_size, 0);
   CHECK_LE(f->min_uar_stack_size_log, f->max_uar_stack_size_log);
   CHECK_GE(f->redzone, 16);
   CHECK_GE(f->max_redzone, f->redzone);
@@ -26,6 +26,18 @@ u32 GetMallocContextSize() {
   return atomic_load(&malloc_context_size, memory_order_acquire);
 }
 
+u32 GetSampledMallocContextSize() {
+  u32 size = GetMallocContextSize();
+  u32 rate = flags()->malloc_context_sample_rate;
+  u32 unsampled_size = flags()->unsampled_malloc_context_size;
+  if (LIKELY(rate <= 1) || size <= unsampled_size)
+    return size;
+  AsanThread *t = GetCurrentThread();
+  if (!t || t->SampleMallocContext(rate))
+    return size;
+  return unsampled_size;
+}
+
 namespace {
 
 // ScopedUnwinding is a scope for stacktracing member of a context
@@ -25,6 +25,10 @@ static const u32 kDefaultMallocContextSize = 30;
 
 void SetMallocContextSize(u32 size);
 u32 GetMallocContextSize();
+// Returns the number of frames to collect for the current allocation or
+// deallocation, which is smaller than GetMallocContextSize() for the ones not
+// sampled by malloc_context_sample_rate.
+u32 GetSampledMallocContextSize();
 
 } // namespace __asan
 
@@ -60,8 +64,9 @@ u32 GetMallocContextSize();
 #define GET_STACK_TRACE_THREAD                                    \
   GET_STACK_TRACE(kStackTraceMax, true)
 
-#define GET_STACK_TRACE_MALLOC                                                 \
-  GET_STACK_TRACE(GetMallocContextSize(), common_flags()->fast_unwind_on_malloc)
+#define GET_STACK_TRACE_MALLOC                                           \
+  const u32 stack_max_size = GetSampledMallocContextSize();              \
+  GET_STACK_TRACE(stack_max_size, common_flags()->fast_unwind_on_malloc)
 
 #define GET_STACK_TRACE_FREE GET_STACK_TRACE_MALLOC
 
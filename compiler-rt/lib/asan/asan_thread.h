@@ -127,6 +127,14 @@ class AsanThread {
   bool isUnwinding() const { return unwinding_; }
   void setUnwinding(bool b) { unwinding_ = b; }
 
+  // Returns true for one in every `rate` calls.
+  bool SampleMallocContext(u32 rate) {
+    if (++malloc_context_sample_counter_ < rate)
+      return false;
+    malloc_context_sample_counter_ = 0;
+    return true;
+  }
+
   AsanThreadLocalMallocStorage &malloc_storage() { return malloc_storage_; }
   AsanStats &stats() { return stats_; }
 
@@ -167,6 +175,7 @@ class AsanThread {
   AsanThreadLocalMallocStorage malloc_storage_;
   AsanStats stats_;
   bool unwinding_;
+  u32 malloc_context_sample_counter_;
   uptr extra_spill_area_;
 };
 
@@ -18,6 +18,7 @@
 #include "FuzzerMutate.h"
 #include "FuzzerPlatform.h"
 #include "FuzzerRandom.h"
+#include "FuzzerSharedCorpus.h"
 #include "FuzzerTracePC.h"
 #include <algorithm>
 #include <atomic>
@@ -290,6 +291,11 @@ static int RunInMultipleProcesses(const Vector<std::string> &Args,
   Command Cmd(Args);
   Cmd.removeFlag("jobs");
   Cmd.removeFlag("workers");
+  // Let the jobs share their new inputs without rescanning the corpus.
+  auto SharedCorpusPath = TempPath("SharedCorpus", ".bin");
+  SharedCorpus Shared;
+  if (Shared.Open(SharedCorpusPath))
+    Cmd.addFlag("shared_corpus", SharedCorpusPath);
   Vector<std::thread> V;
   std::thread Pulse(PulseThread);
   Pulse.detach();
@@ -297,6 +303,7 @@ static int RunInMultipleProcesses(const Vector<std::string> &Args,
     V.push_back(std::thread(WorkerThread, std::ref(Cmd), &Counter, NumJobs, &HasErrors));
   for (auto &T : V)
     T.join();
+  RemoveFile(SharedCorpusPath);
   return HasErrors ? 1 : 0;
 }
 
@@ -767,6 +774,8 @@ int FuzzerDriver(int *argc, char ***argv, UserCallback Callback) {
     Options.CollectDataFlow = Flags.collect_data_flow;
   if (Flags.stop_file)
     Options.StopFile = Flags.stop_file;
+  if (Flags.shared_corpus)
+    Options.SharedCorpusPath = Flags.shared_corpus;
   Options.Entropic = Flags.entropic;
   Options.EntropicFeatureFrequencyThreshold =
       (size_t)Flags.entropic_feature_frequency_threshold;
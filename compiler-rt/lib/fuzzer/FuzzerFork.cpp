@@ -14,6 +14,7 @@
 #include "FuzzerInternal.h"
 #include "FuzzerMerge.h"
 #include "FuzzerSHA1.h"
+#include "FuzzerSharedCorpus.h"
 #include "FuzzerTracePC.h"
 #include "FuzzerUtil.h"
 
@@ -92,6 +93,8 @@ struct GlobalEnv {
   std::string TempDir;
   std::string DFTDir;
   std::string DataFlowBinary;
+  std::string SharedCorpusPath;
+  SharedCorpus Shared;
   Set<uint32_t> Features, Cov;
   Set<std::string> FilesWithDFT;
   Vector<std::string> Files;
@@ -121,7 +124,13 @@ struct GlobalEnv {
     Cmd.removeFlag("collect_data_flow");
     for (auto &C : CorpusDirs) // Remove all corpora from the args.
       Cmd.removeArgument(C);
-    Cmd.addFlag("reload", "0");  // working in an isolated dir, no reload.
+    if (SharedCorpusPath.empty()) {
+      Cmd.addFlag("reload", "0");  // working in an isolated dir, no reload.
+    } else {
+      // Pick up the inputs found by the other jobs as they go.
+      Cmd.addFlag("reload", "1");
+      Cmd.addFlag("shared_corpus", SharedCorpusPath);
+    }
     Cmd.addFlag("print_final_stats", "1");
     Cmd.addFlag("print_funcs", "0");  // no need to spend time symbolizing.
     Cmd.addFlag("max_total_time", std::to_string(std::min((size_t)300, JobId)));
@@ -221,6 +230,8 @@ struct GlobalEnv {
     }
     Features.insert(NewFeatures.begin(), NewFeatures.end());
     Cov.insert(NewCov.begin(), NewCov.end());
+    if (Shared.IsOpen())
+      Shared.AddFeatures({NewFeatures.begin(), NewFeatures.end()});
     for (auto Idx : NewCov)
       if (auto *TE = TPC.PCTableEntryByIdx(Idx))
         if (TPC.PcIsFuncEntry(TE))
@@ -318,6 +329,13 @@ void FuzzWithFork(Random &Rand, const FuzzingOptions &Options,
                         {}, &Env.Cov, CFPath, false);
     RemoveFile(CFPath);
   }
+  // The jobs only save the inputs with features that are new to all of them.
+  Env.SharedCorpusPath = DirPlusFile(Env.TempDir, "shared_corpus");
+  if (Env.Shared.Open(Env.SharedCorpusPath))
+    Env.Shared.AddFeatures({Env.Features.begin(), Env.Features.end()});
+  else
+    Env.SharedCorpusPath.clear();
+
   Printf("INFO: -fork=%d: %zd seed inputs, starting to fuzz in %s\n", NumJobs,
          Env.Files.size(), Env.TempDir.c_str());
 
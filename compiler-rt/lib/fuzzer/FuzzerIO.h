@@ -103,6 +103,11 @@ void RenameFile(const std::string &OldPath, const std::string &NewPath);
 intptr_t GetHandleFromFd(int fd);
 
 void MkDir(const std::string &Path);
+
+// Maps Size bytes of the file at Path, creating and zero-filling it if needed,
+// so that writes are seen by all the processes that map it. Returns nullptr on
+// failure.
+void *MapSharedFile(const std::string &Path, size_t Size);
 void RmDir(const std::string &Path);
 
 const std::string &getDevNull();
@@ -15,9 +15,11 @@
 #include <cstdarg>
 #include <cstdio>
 #include <dirent.h>
+#include <fcntl.h>
 #include <fstream>
 #include <iterator>
 #include <libgen.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -175,6 +177,23 @@ const std::string &getDevNull() {
   return devNull;
 }
 
+void *MapSharedFile(const std::string &Path, size_t Size) {
+  int Fd = open(Path.c_str(), O_RDWR | O_CREAT, 0600);
+  if (Fd < 0)
+    return nullptr;
+  void *Res = nullptr;
+  struct stat St;
+  // Several processes may open the file at once, only ever grow it.
+  if (!fstat(Fd, &St) &&
+      (St.st_size >= static_cast<off_t>(Size) || !ftruncate(Fd, Size))) {
+    Res = mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, 0);
+    if (Res == MAP_FAILED)
+      Res = nullptr;
+  }
+  close(Fd);
+  return Res;
+}
+
 }  // namespace fuzzer
 
 #endif // LIBFUZZER_POSIX
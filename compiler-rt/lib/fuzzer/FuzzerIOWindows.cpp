@@ -420,6 +420,25 @@ const std::string &getDevNull() {
   return devNull;
 }
 
+void *MapSharedFile(const std::string &Path, size_t Size) {
+  HANDLE File = CreateFileA(Path.c_str(), GENERIC_READ | GENERIC_WRITE,
+                            FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                            OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (File == INVALID_HANDLE_VALUE)
+    return nullptr;
+  // The mapping grows the file to Size (zero-filled) if it is smaller.
+  HANDLE Mapping =
+      CreateFileMappingA(File, nullptr, PAGE_READWRITE,
+                         static_cast<DWORD>(static_cast<uint64_t>(Size) >> 32),
+                         static_cast<DWORD>(Size), nullptr);
+  CloseHandle(File);
+  if (!Mapping)
+    return nullptr;
+  void *Res = MapViewOfFile(Mapping, FILE_MAP_ALL_ACCESS, 0, 0, Size);
+  CloseHandle(Mapping);
+  return Res;
+}
+
 }  // namespace fuzzer
 
 #endif // LIBFUZZER_WINDOWS
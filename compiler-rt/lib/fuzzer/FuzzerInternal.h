@@ -17,6 +17,7 @@
 #include "FuzzerInterface.h"
 #include "FuzzerOptions.h"
 #include "FuzzerSHA1.h"
+#include "FuzzerSharedCorpus.h"
 #include "FuzzerValueBitMap.h"
 #include <algorithm>
 #include <atomic>
@@ -111,6 +112,10 @@ private:
 
   void AllocateCurrentUnitData();
   uint8_t *CurrentUnitData = nullptr;
+  // The heap buffer that ExecuteCallback passes the inputs in, reused by
+  // all runs. An input is copied to its end.
+  uint8_t *InputBuffer = nullptr;
+  size_t InputBufferSize = 0;
   std::atomic<size_t> CurrentUnitSize;
   uint8_t BaseSha1[kSHA1NumBytes];  // Checksum of the base unit.
 
@@ -143,6 +148,12 @@ private:
 
   Vector<uint32_t> UniqFeatureSetTmp;
 
+  // Features and inputs shared with the other processes of -fork or -jobs.
+  SharedCorpus Shared;
+  // True if the last input added to the corpus only has features already
+  // found by other processes, so there is no need to save it.
+  bool LastUnitIsKnownToOthers = false;
+
   // Need to know our own thread.
   static thread_local bool IsMyThread;
 };
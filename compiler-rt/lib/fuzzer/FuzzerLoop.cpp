@@ -153,6 +153,10 @@ Fuzzer::Fuzzer(UserCallback CB, InputCorpus &Corpus, MutationDispatcher &MD,
     TPC.PrintModuleInfo();
   if (!Options.OutputCorpus.empty() && Options.ReloadIntervalSec)
     EpochOfLastReadOfOutputCorpus = GetEpoch(Options.OutputCorpus);
+  if (!Options.SharedCorpusPath.empty() &&
+      !Shared.Open(Options.SharedCorpusPath))
+    Printf("WARNING: failed to map the shared corpus %s\n",
+           Options.SharedCorpusPath.c_str());
   MaxInputLen = MaxMutationLen = Options.MaxLen;
   TmpMaxMutationLen = 0;  // Will be set once we load the corpus.
   AllocateCurrentUnitData();
@@ -411,12 +415,22 @@ void Fuzzer::CheckExitOnSrcPosOrItem() {
 }
 
 void Fuzzer::RereadOutputCorpus(size_t MaxSize) {
-  if (Options.OutputCorpus.empty() || !Options.ReloadIntervalSec)
+  if (!Options.ReloadIntervalSec)
     return;
   Vector<Unit> AdditionalCorpus;
-  ReadDirToVectorOfUnits(Options.OutputCorpus.c_str(), &AdditionalCorpus,
-                         &EpochOfLastReadOfOutputCorpus, MaxSize,
-                         /*ExitOnError*/ false);
+  if (Shared.IsOpen()) {
+    // The other processes publish their new inputs, no need to scan the
+    // corpus for them.
+    for (auto &Path : Shared.TakeNewInputs()) {
+      auto U = FileToVector(Path, MaxSize, /*ExitOnError*/ false);
+      if (!U.empty())
+        AdditionalCorpus.push_back(std::move(U));
+    }
+  } else if (!Options.OutputCorpus.empty()) {
+    ReadDirToVectorOfUnits(Options.OutputCorpus.c_str(), &AdditionalCorpus,
+                           &EpochOfLastReadOfOutputCorpus, MaxSize,
+                           /*ExitOnError*/ false);
+  }
   if (Options.Verbosity >= 2)
     Printf("Reload: read %zd new units.\n", AdditionalCorpus.size());
   bool Reloaded = false;
@@ -528,8 +542,12 @@ bool Fuzzer::RunOne(const uint8_t *Data, size_t Size, bool MayDeleteFile,
         Corpus.AddToCorpus({Data, Data + Size}, NumNewFeatures, MayDeleteFile,
                            TPC.ObservedFocusFunction(), ForceAddToCorpus,
                            TimeOfUnit, UniqFeatureSetTmp, DFT, II);
-    WriteFeatureSetToFile(Options.FeaturesDir, Sha1ToString(NewII->Sha1),
-                          NewII->UniqFeatureSet);
+    LastUnitIsKnownToOthers = Shared.IsOpen() &&
+                              !Shared.AddFeatures(NewII->UniqFeatureSet) &&
+                              !ForceAddToCorpus;
+    if (!LastUnitIsKnownToOthers)
+      WriteFeatureSetToFile(Options.FeaturesDir, Sha1ToString(NewII->Sha1),
+                            NewII->UniqFeatureSet);
     WriteEdgeToMutationGraphFile(Options.MutationGraphFile, NewII, II,
                                  MD.MutationSequence());
     return true;
@@ -538,6 +556,7 @@ bool Fuzzer::RunOne(const uint8_t *Data, size_t Size, bool MayDeleteFile,
       II->DataFlowTraceForFocusFunction.empty() &&
       FoundUniqFeaturesOfII == II->UniqFeatureSet.size() &&
       II->U.size() > Size) {
+    LastUnitIsKnownToOthers = false;
     auto OldFeaturesFile = Sha1ToString(II->Sha1);
     Corpus.Replace(II, {Data, Data + Size});
     RenameFeatureSetFile(Options.FeaturesDir, OldFeaturesFile,
@@ -579,9 +598,22 @@ void Fuzzer::ExecuteCallback(const uint8_t *Data, size_t Size) {
   TPC.RecordInitialStack();
   TotalNumberOfRuns++;
   assert(InFuzzingThread());
-  // We copy the contents of Unit into a separate heap buffer
-  // so that we reliably find buffer overflows in it.
-  uint8_t *DataCopy = new uint8_t[Size];
+  // We copy the contents of Unit to the end of a separate heap buffer
+  // so that we reliably find buffer overflows in it. The buffer is reused,
+  // and with ASan the rest of it is poisoned to also find underflows and
+  // uses of the input after the run.
+  if (!InputBuffer || Size > InputBufferSize) {
+    if (EF->__asan_unpoison_memory_region)
+      EF->__asan_unpoison_memory_region(InputBuffer, InputBufferSize);
+    delete[] InputBuffer;
+    InputBufferSize = std::max(Size, MaxInputLen);
+    InputBuffer = new uint8_t[InputBufferSize];
+    if (EF->__asan_poison_memory_region)
+      EF->__asan_poison_memory_region(InputBuffer, InputBufferSize);
+  }
+  uint8_t *DataCopy = InputBuffer + InputBufferSize - Size;
+  if (EF->__asan_unpoison_memory_region)
+    EF->__asan_unpoison_memory_region(DataCopy, Size);
   memcpy(DataCopy, Data, Size);
   if (EF->__msan_unpoison)
     EF->__msan_unpoison(DataCopy, Size);
@@ -606,7 +638,8 @@ void Fuzzer::ExecuteCallback(const uint8_t *Data, size_t Size) {
   if (!LooseMemeq(DataCopy, Data, Size))
     CrashOnOverwrittenData();
   CurrentUnitSize = 0;
-  delete[] DataCopy;
+  if (EF->__asan_poison_memory_region)
+    EF->__asan_poison_memory_region(DataCopy, Size);
 }
 
 std::string Fuzzer::WriteToOutputCorpus(const Unit &U) {
@@ -649,7 +682,11 @@ void Fuzzer::ReportNewCoverage(InputInfo *II, const Unit &U) {
   II->NumSuccessfullMutations++;
   MD.RecordSuccessfulMutationSequence();
   PrintStatusForNewUnit(U, II->Reduced ? "REDUCE" : "NEW   ");
-  WriteToOutputCorpus(U);
+  if (!LastUnitIsKnownToOthers) {
+    auto Path = WriteToOutputCorpus(U);
+    if (Shared.IsOpen() && !Path.empty())
+      Shared.Publish(Path);
+  }
   NumberOfNewUnitsAdded++;
   CheckExitOnSrcPosOrItem(); // Check only after the unit is saved to corpus.
   LastCorpusUpdateRun = TotalNumberOfRuns;
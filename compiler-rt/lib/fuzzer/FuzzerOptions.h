@@ -61,6 +61,7 @@ struct FuzzingOptions {
   std::string FeaturesDir;
   std::string MutationGraphFile;
   std::string StopFile;
+  std::string SharedCorpusPath;
   bool SaveArtifacts = true;
   bool PrintNEW = true; // Print a status line when new units are found;
   bool PrintNewCovPcs = false;
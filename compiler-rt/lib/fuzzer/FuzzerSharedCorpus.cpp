@@ -0,0 +1,97 @@
+//===- FuzzerSharedCorpus.cpp - corpus shared by processes ----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+// Corpus state shared by the fuzzing processes of one host.
+//===----------------------------------------------------------------------===//
+
+#include "FuzzerSharedCorpus.h"
+#include "FuzzerCorpus.h"
+#include "FuzzerIO.h"
+
+#include <cstring>
+
+namespace fuzzer {
+
+const size_t SharedCorpus::kQueueSize;
+const size_t SharedCorpus::kMaxPathLen;
+
+struct SharedCorpus::Layout {
+  std::atomic<uint64_t> Features[InputCorpus::kFeatureSetSize / 64];
+  std::atomic<uint64_t> NumUsers;
+  std::atomic<uint64_t> NumPublished;
+  Entry Queue[kQueueSize];
+};
+
+bool SharedCorpus::Open(const std::string &Path) {
+  // The file starts zeroed, which is a valid state of all the atomics.
+  State = static_cast<Layout *>(MapSharedFile(Path, sizeof(Layout)));
+  if (!State)
+    return false;
+  Id = State->NumUsers.fetch_add(1, std::memory_order_relaxed) + 1;
+  NextToRead = State->NumPublished.load(std::memory_order_acquire);
+  return true;
+}
+
+bool SharedCorpus::AddFeatures(const Vector<uint32_t> &Features) {
+  bool Res = false;
+  for (auto Ft : Features) {
+    uint32_t Idx = Ft % InputCorpus::kFeatureSetSize;
+    uint64_t Mask = 1ULL << (Idx % 64);
+    auto &Word = State->Features[Idx / 64];
+    // Most features are already known, avoid dirtying their cache lines.
+    if (Word.load(std::memory_order_relaxed) & Mask)
+      continue;
+    if (!(Word.fetch_or(Mask, std::memory_order_relaxed) & Mask))
+      Res = true;
+  }
+  return Res;
+}
+
+bool SharedCorpus::HasFeature(uint32_t Feature) const {
+  uint32_t Idx = Feature % InputCorpus::kFeatureSetSize;
+  return State->Features[Idx / 64].load(std::memory_order_relaxed) &
+         (1ULL << (Idx % 64));
+}
+
+void SharedCorpus::Publish(const std::string &Path) {
+  if (Path.size() >= kMaxPathLen)
+    return;
+  uint64_t N = State->NumPublished.fetch_add(1, std::memory_order_relaxed);
+  Entry &E = State->Queue[N % kQueueSize];
+  E.Seq.store(2 * N + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  E.Owner = Id;
+  memcpy(E.Path, Path.c_str(), Path.size() + 1);
+  E.Seq.store(2 * N + 2, std::memory_order_release);
+}
+
+Vector<std::string> SharedCorpus::TakeNewInputs() {
+  Vector<std::string> Res;
+  uint64_t End = State->NumPublished.load(std::memory_order_acquire);
+  if (End - NextToRead > kQueueSize)
+    NextToRead = End - kQueueSize;  // The older entries are overwritten.
+  for (; NextToRead < End; NextToRead++) {
+    Entry &E = State->Queue[NextToRead % kQueueSize];
+    uint64_t Seq = E.Seq.load(std::memory_order_acquire);
+    // Skip the entries that are still being written or already overwritten,
+    // sharing inputs is best effort.
+    if (Seq != 2 * NextToRead + 2)
+      continue;
+    char Path[kMaxPathLen];
+    uint64_t Owner = E.Owner;
+    memcpy(Path, E.Path, kMaxPathLen);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (E.Seq.load(std::memory_order_relaxed) != Seq)
+      continue;
+    Path[kMaxPathLen - 1] = 0;
+    if (Owner != Id)
+      Res.push_back(Path);
+  }
+  return Res;
+}
+
+}  // namespace fuzzer
@@ -0,0 +1,66 @@
+//===- FuzzerSharedCorpus.h - corpus shared by processes --------*- C++ -* ===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+// Corpus state shared by the fuzzing processes of one host.
+//
+// With -fork or -jobs, all processes map one file (see -shared_corpus) that
+// holds
+//   * a bitmap of the features found by any of them. An input is only saved
+//     to the output corpus, and so only merged by the -fork parent, if one of
+//     its features is new to all processes, not just to the one that ran it.
+//   * a queue of the paths of such inputs. On -reload, the other processes
+//     run the inputs from the queue instead of scanning the corpus directory.
+// Both are best effort. The queue is a ring, and a process that falls behind
+// it still gets the inputs it missed with the next job or merge.
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_FUZZER_SHARED_CORPUS_H
+#define LLVM_FUZZER_SHARED_CORPUS_H
+
+#include "FuzzerDefs.h"
+
+#include <atomic>
+
+namespace fuzzer {
+
+class SharedCorpus {
+public:
+  // Maps the state at Path, creating it if needed. Returns false if shared
+  // memory is not supported or the file could not be mapped.
+  bool Open(const std::string &Path);
+  bool IsOpen() const { return State != nullptr; }
+
+  // Marks Features as found. Returns true if any of them was not found
+  // before by any process.
+  bool AddFeatures(const Vector<uint32_t> &Features);
+  bool HasFeature(uint32_t Feature) const;
+
+  // Makes the input at Path visible to the other processes.
+  void Publish(const std::string &Path);
+  // Returns the inputs published by the other processes since the last call.
+  Vector<std::string> TakeNewInputs();
+
+  static const size_t kQueueSize = 1 << 12;
+  static const size_t kMaxPathLen = 496;
+
+private:
+  struct Entry {
+    // 2 * N + 1 while the N-th input is being written, 2 * N + 2 after.
+    std::atomic<uint64_t> Seq;
+    uint64_t Owner;
+    char Path[kMaxPathLen];
+  };
+  struct Layout;
+
+  Layout *State = nullptr;
+  uint64_t Id = 0;  // Tells apart the users of the state.
+  uint64_t NextToRead = 0;
+};
+
+}  // namespace fuzzer
+
+#endif  // LLVM_FUZZER_SHARED_CORPUS_H
@@ -158,6 +158,14 @@ private:
   size_t NumModules;  // linker-initialized.
   size_t NumInline8bitCounters;
 
+  // The inline counters that the last CollectFeatures found non-zero, so that
+  // ClearInlineCounters does not need to write all of them. More than
+  // kMaxNonZeroCounters means that they were not tracked: there were too many,
+  // or the counters were not collected since they were last cleared.
+  static const size_t kMaxNonZeroCounters = 1 << 14;
+  mutable uint8_t *NonZeroCounters[kMaxNonZeroCounters];
+  mutable size_t NumNonZeroCounters = kMaxNonZeroCounters + 1;
+
   template <class Callback>
   void IterateCounterRegions(Callback CB) {
     for (size_t m = 0; m < NumModules; m++)
@@ -192,14 +200,21 @@ size_t ForEachNonZeroByte(const uint8_t *Begin, const uint8_t *End,
     if (uint8_t V = *P)
       Handle8bitCounter(FirstFeature, P - Begin, V);
 
-  // Iterate by Step bytes at a time.
-  for (; P < End; P += Step)
-    if (LargeType Bundle = *reinterpret_cast<const LargeType *>(P)) {
+  // Iterate by Step bytes at a time, skipping 4 * Step zero bytes at once:
+  // counters are sparse, and most runs only touch a few of them.
+  for (; P + Step <= End; P += Step) {
+    auto W = reinterpret_cast<const LargeType *>(P);
+    if (P + 4 * Step <= End && !(W[0] | W[1] | W[2] | W[3])) {
+      P += 3 * Step;
+      continue;
+    }
+    if (LargeType Bundle = *W) {
       Bundle = HostToLE(Bundle);
       for (size_t I = 0; I < Step; I++, Bundle >>= 8)
         if (uint8_t V = Bundle & 0xff)
           Handle8bitCounter(FirstFeature, P - Begin + I, V);
     }
+  }
 
   // Iterate by 1 byte until the end.
   for (; P < End; P++)
@@ -248,12 +263,21 @@ void TracePC::CollectFeatures(Callback HandleFeature) const {
 
   size_t FirstFeature = 0;
 
+  NumNonZeroCounters = 0;
   for (size_t i = 0; i < NumModules; i++) {
     for (size_t r = 0; r < Modules[i].NumRegions; r++) {
       if (!Modules[i].Regions[r].Enabled) continue;
-      FirstFeature += 8 * ForEachNonZeroByte(Modules[i].Regions[r].Start,
-                                             Modules[i].Regions[r].Stop,
-                                             FirstFeature, Handle8bitCounter);
+      uint8_t *Start = Modules[i].Regions[r].Start;
+      auto HandleInline8bitCounter = [&](size_t FirstFeature, size_t Idx,
+                                         uint8_t Counter) {
+        if (NumNonZeroCounters < kMaxNonZeroCounters)
+          NonZeroCounters[NumNonZeroCounters] = Start + Idx;
+        NumNonZeroCounters++;
+        Handle8bitCounter(FirstFeature, Idx, Counter);
+      };
+      FirstFeature += 8 * ForEachNonZeroByte(Start, Modules[i].Regions[r].Stop,
+                                             FirstFeature,
+                                             HandleInline8bitCounter);
     }
   }
 
@@ -15,6 +15,7 @@
 #include "FuzzerMerge.h"
 #include "FuzzerMutate.h"
 #include "FuzzerRandom.h"
+#include "FuzzerSharedCorpus.h"
 #include "FuzzerTracePC.h"
 #include "gtest/gtest.h"
 #include <memory>
@@ -893,6 +894,12 @@ TEST(Fuzzer, ForEachNonZeroByte) {
   Expected = {          {109, 2}, {118, 3}, {120, 4},
               {135, 5}, {137, 6}, {146, 7}};
   EXPECT_EQ(Res, Expected);
+
+  // The end is not aligned and is in a word with other non-zero bytes.
+  Res.clear();
+  ForEachNonZeroByte(Ar + 40, Ar + N + 3, 140, CB);
+  Expected = {{146, 7}, {163, 8}, {164, 9}, {165, 9}, {166, 9}};
+  EXPECT_EQ(Res, Expected);
 }
 
 // FuzzerCommand unit tests. The arguments in the two helper methods below must
@@ -1089,6 +1096,46 @@ TEST(Entropic, UpdateFrequency) {
     EXPECT_LT(II->FeatureFreqs[Index - 1].first, II->FeatureFreqs[Index].first);
 }
 
+TEST(SharedCorpus, FeaturesAndInputs) {
+  std::string Path = TempPath("SharedCorpusTest", ".bin");
+  SharedCorpus A, B;
+  ASSERT_TRUE(A.Open(Path));
+  ASSERT_TRUE(B.Open(Path));
+
+  EXPECT_TRUE(A.AddFeatures({1, 42, 1 << 20}));
+  EXPECT_TRUE(B.HasFeature(42));
+  EXPECT_FALSE(B.HasFeature(43));
+  EXPECT_FALSE(B.AddFeatures({1, 1 << 20}));
+  EXPECT_TRUE(B.AddFeatures({1, 43}));
+  EXPECT_TRUE(A.HasFeature(43));
+
+  A.Publish("a1");
+  A.Publish("a2");
+  B.Publish("b1");
+  Vector<std::string> Expected = {"a1", "a2"};
+  EXPECT_EQ(B.TakeNewInputs(), Expected);
+  EXPECT_TRUE(B.TakeNewInputs().empty());
+  Expected = {"b1"};
+  EXPECT_EQ(A.TakeNewInputs(), Expected);
+
+  // A reader that falls behind only gets the inputs still in the queue.
+  for (size_t i = 0; i < SharedCorpus::kQueueSize + 10; i++)
+    A.Publish(std::to_string(i));
+  auto Inputs = B.TakeNewInputs();
+  EXPECT_EQ(Inputs.size(), SharedCorpus::kQueueSize);
+  EXPECT_EQ(Inputs.front(), "10");
+  // Too long paths are not shared.
+  A.Publish(std::string(SharedCorpus::kMaxPathLen, 'x'));
+  EXPECT_TRUE(B.TakeNewInputs().empty());
+
+  // A new user only gets the inputs published after it joined.
+  SharedCorpus C;
+  ASSERT_TRUE(C.Open(Path));
+  EXPECT_TRUE(C.TakeNewInputs().empty());
+  EXPECT_TRUE(C.HasFeature(1));
+  RemoveFile(Path);
+}
+
 double SubAndSquare(double X, double Y) {
   double R = X - Y;
   R = R * R;
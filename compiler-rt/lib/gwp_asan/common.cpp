@@ -41,7 +41,9 @@ void AllocationMetadata::RecordAllocation(uintptr_t AllocAddr,
                                           size_t AllocSize) {
   Addr = AllocAddr;
   Size = AllocSize;
-  IsDeallocated = false;
+  // Slots are reserved without a lock, so publish the address and size before
+  // the allocation is seen as live by iterate().
+  __atomic_store_n(&IsDeallocated, false, __ATOMIC_RELEASE);
 
   AllocationTrace.ThreadID = getThreadID();
   DeallocationTrace.TraceSize = 0;
@@ -32,6 +32,12 @@ size_t roundUpTo(size_t Size, size_t Boundary) {
 uintptr_t getPageAddr(uintptr_t Ptr, uintptr_t PageSize) {
   return Ptr & ~(PageSize - 1);
 }
+
+constexpr unsigned kWordBits = sizeof(uintptr_t) * 8;
+
+uintptr_t rotateRight(uintptr_t Word, unsigned N) {
+  return N == 0 ? Word : (Word >> N) | (Word << (kWordBits - N));
+}
 } // anonymous namespace
 
 // Gets the singleton implementation of this class. Thread-compatible until
@@ -76,11 +82,12 @@ void GuardedPoolAllocator::init(const options::Options &Opts) {
   Metadata = reinterpret_cast<AllocationMetadata *>(
       map(BytesRequired, kGwpAsanMetadataName));
 
-  // Allocate memory and set up the free pages queue.
-  BytesRequired = roundUpTo(
-      State.MaxSimultaneousAllocations * sizeof(*FreeSlots), PageSize);
+  // Allocate memory for the free slots bitmap. It starts out empty, as slots
+  // are handed out in order until each of them has been used once.
+  BytesRequired =
+      roundUpTo(getNumFreeSlotShards() * sizeof(*FreeSlots), PageSize);
   FreeSlots =
-      reinterpret_cast<size_t *>(map(BytesRequired, kGwpAsanFreeSlotsName));
+      reinterpret_cast<uintptr_t *>(map(BytesRequired, kGwpAsanFreeSlotsName));
 
   // Multiply the sample rate by 2 to give a good, fast approximation for (1 /
   // SampleRate) chance of sampling.
@@ -102,9 +109,15 @@ void GuardedPoolAllocator::init(const options::Options &Opts) {
     installAtFork();
 }
 
-void GuardedPoolAllocator::disable() { PoolMutex.lock(); }
+void GuardedPoolAllocator::disable() {
+  PoolMutex.lock();
+  __atomic_store_n(&Disabled, true, __ATOMIC_SEQ_CST);
+}
 
-void GuardedPoolAllocator::enable() { PoolMutex.unlock(); }
+void GuardedPoolAllocator::enable() {
+  __atomic_store_n(&Disabled, false, __ATOMIC_SEQ_CST);
+  PoolMutex.unlock();
+}
 
 void GuardedPoolAllocator::iterate(void *Base, size_t Size, iterate_callback Cb,
                                    void *Arg) {
@@ -130,11 +143,11 @@ void GuardedPoolAllocator::uninitTestOnly() {
     Metadata = nullptr;
   }
   if (FreeSlots) {
-    unmap(FreeSlots,
-          roundUpTo(State.MaxSimultaneousAllocations * sizeof(*FreeSlots),
-                    State.PageSize));
+    unmap(FreeSlots, roundUpTo(getNumFreeSlotShards() * sizeof(*FreeSlots),
+                               State.PageSize));
     FreeSlots = nullptr;
   }
+  NumSampledAllocations = 0;
   *getThreadLocals() = ThreadLocalPackedVariables();
 }
 
@@ -156,12 +169,12 @@ void *GuardedPoolAllocator::allocate(size_t Size) {
   if (Size == 0 || Size > State.maximumAllocationSize())
     return nullptr;
 
-  size_t Index;
-  {
-    ScopedLock L(PoolMutex);
-    Index = reserveSlot();
-  }
+  // While disabled, leave the pool alone and let the supporting allocator
+  // service the allocation.
+  if (GWP_ASAN_UNLIKELY(__atomic_load_n(&Disabled, __ATOMIC_ACQUIRE)))
+    return nullptr;
 
+  size_t Index = reserveSlot();
   if (Index == kInvalidSlotID)
     return nullptr;
 
@@ -202,6 +215,7 @@ void GuardedPoolAllocator::trapOnAddress(uintptr_t Address, Error E) {
 void GuardedPoolAllocator::stop() {
   getThreadLocals()->RecursiveGuard = true;
   PoolMutex.tryLock();
+  __atomic_store_n(&Disabled, true, __ATOMIC_SEQ_CST);
 }
 
 void GuardedPoolAllocator::deallocate(void *Ptr) {
@@ -210,44 +224,47 @@ void GuardedPoolAllocator::deallocate(void *Ptr) {
   size_t Slot = State.getNearestSlot(UPtr);
   uintptr_t SlotStart = State.slotToAddr(Slot);
   AllocationMetadata *Meta = addrToMetadata(UPtr);
+
+  // Unlike allocations, the deallocation can't be handed to the supporting
+  // allocator, so wait until the allocator is enabled again.
+  if (GWP_ASAN_UNLIKELY(__atomic_load_n(&Disabled, __ATOMIC_ACQUIRE))) {
+    ScopedLock L(PoolMutex);
+  }
+
   if (Meta->Addr != UPtr) {
     // If multiple errors occur at the same time, use the first one.
     ScopedLock L(PoolMutex);
     trapOnAddress(UPtr, Error::INVALID_FREE);
   }
 
-  // Intentionally scope the mutex here, so that other threads can access the
-  // pool during the expensive markInaccessible() call.
-  {
+  // Mark the allocation as deallocated in a single atomic step, so that only
+  // one of two racing deallocations of the same pointer gets past here.
+  if (__atomic_exchange_n(&Meta->IsDeallocated, true, __ATOMIC_ACQ_REL)) {
     ScopedLock L(PoolMutex);
-    if (Meta->IsDeallocated) {
-      trapOnAddress(UPtr, Error::DOUBLE_FREE);
-    }
+    trapOnAddress(UPtr, Error::DOUBLE_FREE);
+  }
 
-    // Ensure that the deallocation is recorded before marking the page as
-    // inaccessible. Otherwise, a racy use-after-free will have inconsistent
-    // metadata.
-    Meta->RecordDeallocation();
+  // Ensure that the deallocation is recorded before marking the page as
+  // inaccessible. Otherwise, a racy use-after-free will have inconsistent
+  // metadata.
+  Meta->RecordDeallocation();
 
-    // Ensure that the unwinder is not called if the recursive flag is set,
-    // otherwise non-reentrant unwinders may deadlock.
-    if (!getThreadLocals()->RecursiveGuard) {
-      ScopedRecursiveGuard SRG;
-      Meta->DeallocationTrace.RecordBacktrace(Backtrace);
-    }
+  // Ensure that the unwinder is not called if the recursive flag is set,
+  // otherwise non-reentrant unwinders may deadlock.
+  if (!getThreadLocals()->RecursiveGuard) {
+    ScopedRecursiveGuard SRG;
+    Meta->DeallocationTrace.RecordBacktrace(Backtrace);
   }
 
   deallocateInGuardedPool(reinterpret_cast<void *>(SlotStart),
                           State.maximumAllocationSize());
 
-  // And finally, lock again to release the slot back into the pool.
-  ScopedLock L(PoolMutex);
+  // And finally, release the slot back into the pool.
   freeSlot(Slot);
 }
 
 size_t GuardedPoolAllocator::getSize(const void *Ptr) {
   assert(pointerIsMine(Ptr));
-  ScopedLock L(PoolMutex);
   AllocationMetadata *Meta = addrToMetadata(reinterpret_cast<uintptr_t>(Ptr));
   assert(Meta->Addr == reinterpret_cast<uintptr_t>(Ptr));
   return Meta->Size;
@@ -257,24 +274,55 @@ AllocationMetadata *GuardedPoolAllocator::addrToMetadata(uintptr_t Ptr) const {
   return &Metadata[State.getNearestSlot(Ptr)];
 }
 
+size_t GuardedPoolAllocator::getNumFreeSlotShards() const {
+  return (State.MaxSimultaneousAllocations + kSlotsPerShard - 1) /
+         kSlotsPerShard;
+}
+
 size_t GuardedPoolAllocator::reserveSlot() {
   // Avoid potential reuse of a slot before we have made at least a single
   // allocation in each slot. Helps with our use-after-free detection.
-  if (NumSampledAllocations < State.MaxSimultaneousAllocations)
-    return NumSampledAllocations++;
-
-  if (FreeSlotsLength == 0)
-    return kInvalidSlotID;
+  size_t Fresh = __atomic_load_n(&NumSampledAllocations, __ATOMIC_RELAXED);
+  while (Fresh < State.MaxSimultaneousAllocations) {
+    if (__atomic_compare_exchange_n(&NumSampledAllocations, &Fresh, Fresh + 1,
+                                    /*weak=*/true, __ATOMIC_RELAXED,
+                                    __ATOMIC_RELAXED))
+      return Fresh;
+  }
 
-  size_t ReservedIndex = getRandomUnsigned32() % FreeSlotsLength;
-  size_t SlotIndex = FreeSlots[ReservedIndex];
-  FreeSlots[ReservedIndex] = FreeSlots[--FreeSlotsLength];
-  return SlotIndex;
+  // Pick a random shard, and a random position within it to search for a free
+  // slot from. If the shard is empty, move on to the next one.
+  const size_t NumShards = getNumFreeSlotShards();
+  size_t Shard = getRandomUnsigned32() % NumShards;
+  const unsigned Start = getRandomUnsigned32() % kSlotsPerShard;
+  for (size_t i = 0; i < NumShards; ++i) {
+    uintptr_t *Word = &FreeSlots[Shard];
+    uintptr_t Free = __atomic_load_n(Word, __ATOMIC_RELAXED);
+    while (Free != 0) {
+      const unsigned Bit =
+          (__builtin_ctzll(rotateRight(Free, Start)) + Start) % kSlotsPerShard;
+      // Acquire pairs with the release in freeSlot(), so that the previous
+      // owner is done with the slot's metadata and mappings.
+      if (__atomic_compare_exchange_n(Word, &Free,
+                                      Free & ~(static_cast<uintptr_t>(1) << Bit),
+                                      /*weak=*/true, __ATOMIC_ACQUIRE,
+                                      __ATOMIC_RELAXED))
+        return Shard * kSlotsPerShard + Bit;
+    }
+    if (++Shard == NumShards)
+      Shard = 0;
+  }
+  return kInvalidSlotID;
 }
 
 void GuardedPoolAllocator::freeSlot(size_t SlotIndex) {
-  assert(FreeSlotsLength < State.MaxSimultaneousAllocations);
-  FreeSlots[FreeSlotsLength++] = SlotIndex;
+  assert(SlotIndex < State.MaxSimultaneousAllocations);
+  const uintptr_t Mask = static_cast<uintptr_t>(1)
+                         << (SlotIndex % kSlotsPerShard);
+  uintptr_t Old = __atomic_fetch_or(&FreeSlots[SlotIndex / kSlotsPerShard],
+                                    Mask, __ATOMIC_RELEASE);
+  assert((Old & Mask) == 0);
+  (void)Old;
 }
 
 uint32_t GuardedPoolAllocator::getRandomUnsigned32() {
@@ -56,14 +56,18 @@ public:
 
   // Functions exported for libmemunreachable's use on Android. disable()
   // installs a lock in the allocator that prevents any thread from being able
-  // to allocate memory, until enable() is called.
+  // to allocate memory, until enable() is called. Allocations made while the
+  // allocator is disabled fall back to the supporting allocator, and
+  // deallocations wait for enable().
   void disable();
   void enable();
 
   typedef void (*iterate_callback)(uintptr_t base, size_t size, void *arg);
   // Execute the callback Cb for every allocation the lies in [Base, Base +
   // Size). Must be called while the allocator is disabled. The callback can not
-  // allocate.
+  // allocate. An allocation that another thread is still in the middle of
+  // making or freeing when the allocator is disabled is only reported if its
+  // metadata was recorded and it has not been marked as deallocated.
   void iterate(void *Base, size_t Size, iterate_callback Cb, void *Arg);
 
   // This function is used to signal the allocator to indefinitely stop
@@ -160,12 +164,15 @@ private:
   AllocationMetadata *addrToMetadata(uintptr_t Ptr) const;
 
   // Reserve a slot for a new guarded allocation. Returns kInvalidSlotID if no
-  // slot is available to be reserved.
+  // slot is available to be reserved. Lock-free.
   size_t reserveSlot();
 
-  // Unreserve the guarded slot.
+  // Unreserve the guarded slot. Lock-free.
   void freeSlot(size_t SlotIndex);
 
+  // Returns the number of words in the `FreeSlots` bitmap.
+  size_t getNumFreeSlotShards() const;
+
   // Raise a SEGV and set the corresponding fields in the Allocator's State in
   // order to tell the crash handler what happened. Used when errors are
   // detected internally (Double Free, Invalid Free).
@@ -178,20 +185,29 @@ private:
 
   gwp_asan::AllocatorState State;
 
-  // A mutex to protect the guarded slot and metadata pool for this class.
+  // Slots are reserved and freed without taking a lock, so that sampled
+  // allocations on different threads don't serialise on each other. This mutex
+  // is only held while the allocator is disabled or stopped, and while
+  // reporting an internally detected error.
   Mutex PoolMutex;
+  // Set while PoolMutex is held by disable() or stop(), so that allocate() and
+  // deallocate() only need to look at the mutex in that case.
+  bool Disabled = false;
   // Record the number allocations that we've sampled. We store this amount so
   // that we don't randomly choose to recycle a slot that previously had an
-  // allocation before all the slots have been utilised.
+  // allocation before all the slots have been utilised. Updated atomically.
   size_t NumSampledAllocations = 0;
   // Pointer to the allocation metadata (allocation/deallocation stack traces),
   // if any.
   AllocationMetadata *Metadata = nullptr;
 
-  // Pointer to an array of free slot indexes.
-  size_t *FreeSlots = nullptr;
-  // The current length of the list of free slots.
-  size_t FreeSlotsLength = 0;
+  // Bitmap of the free slots that have been used before, where bit N of word W
+  // is set if slot (W * kSlotsPerShard + N) is free. Each word is a shard of
+  // the pool that is updated with a single compare-and-swap. reserveSlot()
+  // starts at a random shard, which both spreads concurrent reservations over
+  // the pool and keeps the reuse of slots unpredictable.
+  static constexpr size_t kSlotsPerShard = sizeof(uintptr_t) * 8;
+  uintptr_t *FreeSlots = nullptr;
 
   // See options.{h, inc} for more information.
   bool PerfectlyRightAlign = false;
@@ -38,6 +38,17 @@ TEST_F(DefaultGuardedPoolAllocator, Fork) {
       "");
 }
 
+// While disabled, allocations are left to the supporting allocator.
+TEST_F(DefaultGuardedPoolAllocator, DisableFallsBack) {
+  GPA.disable();
+  EXPECT_EQ(GPA.allocate(Size), nullptr);
+  GPA.enable();
+
+  void *P = GPA.allocate(Size);
+  EXPECT_NE(P, nullptr);
+  GPA.deallocate(P);
+}
+
 namespace {
 pthread_mutex_t Mutex;
 pthread_cond_t Conditional = PTHREAD_COND_INITIALIZER;
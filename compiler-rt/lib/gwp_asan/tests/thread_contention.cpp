@@ -12,6 +12,7 @@
 // non-opt builds of clang.
 #include <atomic>
 #include <cstdlib>
+#include <set>
 #include <thread>
 #include <vector>
 
@@ -67,3 +68,50 @@ TEST_F(CustomGuardedPoolAllocator, ThreadContention) {
   InitNumSlots(NumThreads);
   runThreadContentionTest(NumThreads, NumIterations, &GPA);
 }
+
+// Each thread takes slots until the pool is exhausted. Every slot must be
+// handed out exactly once, both while fresh slots are used in order and once
+// they are recycled from the free slots.
+void asyncExhaustTask(gwp_asan::GuardedPoolAllocator *GPA,
+                      std::atomic<bool> *StartingGun,
+                      std::vector<void *> *Ptrs) {
+  while (!*StartingGun) {
+    // Wait for starting gun.
+  }
+
+  while (void *Ptr = GPA->allocate(1))
+    Ptrs->push_back(Ptr);
+}
+
+void runExhaustPoolTest(unsigned NumThreads, unsigned NumSlots,
+                        gwp_asan::GuardedPoolAllocator *GPA) {
+  std::atomic<bool> StartingGun{false};
+  std::vector<std::thread> Threads;
+  std::vector<std::vector<void *>> Ptrs(NumThreads);
+
+  for (unsigned i = 0; i < NumThreads; ++i)
+    Threads.emplace_back(asyncExhaustTask, GPA, &StartingGun, &Ptrs[i]);
+
+  StartingGun = true;
+
+  for (auto &T : Threads)
+    T.join();
+
+  std::set<void *> Unique;
+  for (auto &ThreadPtrs : Ptrs) {
+    for (void *Ptr : ThreadPtrs) {
+      EXPECT_TRUE(Unique.insert(Ptr).second);
+      GPA->deallocate(Ptr);
+    }
+  }
+  EXPECT_EQ(NumSlots, Unique.size());
+}
+
+TEST_F(CustomGuardedPoolAllocator, ThreadsExhaustPool) {
+  unsigned NumThreads = 4;
+  // Several shards of the free slots bitmap, the last one partially used.
+  unsigned NumSlots = 150;
+  InitNumSlots(NumSlots);
+  for (unsigned i = 0; i < 3; ++i)
+    runExhaustPoolTest(NumThreads, NumSlots, &GPA);
+}
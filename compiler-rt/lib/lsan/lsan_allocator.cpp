@@ -283,6 +283,25 @@ void LsanMetadata::set_tag(ChunkTag value) {
   reinterpret_cast<ChunkMetadata *>(metadata_)->tag = value;
 }
 
+bool LsanMetadata::compare_exchange_tag(ChunkTag expected, ChunkTag value) {
+  // The tag is in the byte after |allocated|, along with bits of
+  // |requested_size|, which do not change while the world is stopped.
+  atomic_uint8_t *bits = reinterpret_cast<atomic_uint8_t *>(metadata_) + 1;
+  ChunkMetadata m;
+  u8 old_bits = atomic_load(bits, memory_order_relaxed);
+  for (;;) {
+    internal_memcpy(reinterpret_cast<u8 *>(&m) + 1, &old_bits, 1);
+    if (m.tag != expected)
+      return false;
+    m.tag = value;
+    u8 new_bits;
+    internal_memcpy(&new_bits, reinterpret_cast<u8 *>(&m) + 1, 1);
+    if (atomic_compare_exchange_weak(bits, &old_bits, new_bits,
+                                     memory_order_relaxed))
+      return true;
+  }
+}
+
 uptr LsanMetadata::requested_size() const {
   return reinterpret_cast<ChunkMetadata *>(metadata_)->requested_size;
 }
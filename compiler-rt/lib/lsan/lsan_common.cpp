@@ -167,7 +167,9 @@ void ScanRangeForPointers(uptr begin, uptr end,
     // Pointers to self don't count. This matters when tag == kIndirectlyLeaked.
     if (chunk == begin) continue;
     LsanMetadata m(chunk);
-    if (m.tag() == kReachable || m.tag() == kIgnored) continue;
+    ChunkTag old_tag = m.tag();
+    if (old_tag == kReachable || old_tag == kIgnored || old_tag == tag)
+      continue;
 
     // Do this check relatively late so we can log only the interesting cases.
     if (!flags()->use_poisoned && WordIsPoisoned(pp)) {
@@ -178,7 +180,10 @@ void ScanRangeForPointers(uptr begin, uptr end,
       continue;
     }
 
-    m.set_tag(tag);
+    // Other scan threads may tag the chunk at the same time. Only the one
+    // that does adds it to its frontier.
+    if (!m.compare_exchange_tag(old_tag, tag))
+      continue;
     LOG_POINTERS("%p: found %p pointing into chunk %p-%p of size %zu.\n", pp, p,
                  chunk, chunk + m.requested_size(), m.requested_size());
     if (frontier)
@@ -369,7 +374,118 @@ static void ProcessRootRegions(Frontier *frontier) {
   }
 }
 
+// The number of threads to scan the heap with.
+static uptr GetScanThreads() {
+  const uptr kMaxScanThreads = 64;
+  uptr n = flags()->scan_threads > 0 ? flags()->scan_threads
+                                     : GetNumberOfCPUsCached();
+  return Max<uptr>(1, Min(n, kMaxScanThreads));
+}
+
+// A range of the heap left to scan by a parallel flood fill.
+struct ScanRange {
+  uptr begin;
+  uptr end;
+};
+
+// Chunks larger than this are scanned in pieces of this size, so that the
+// threads of a parallel flood fill can share them.
+static const uptr kScanPieceSize = 1 << 20;
+
+// State shared by the threads of a parallel flood fill. Each thread works off
+// its own frontier, and moves half of it to |ranges| while other threads have
+// nothing to do. The flood fill is over when all the threads are idle.
+struct ParallelFloodFill {
+  ChunkTag tag;
+  StaticSpinMutex mutex;
+  InternalMmapVector<ScanRange> ranges;
+  // Mirror |ranges.size()| and the number of idle threads, which are only
+  // changed with |mutex| held, for the threads to poll.
+  atomic_uintptr_t num_ranges;
+  atomic_uintptr_t num_idle;
+};
+
+// Takes a range to scan from |ff|, or returns false when the flood fill is
+// over.
+static bool TakeScanRange(ParallelFloodFill *ff, uptr num_threads,
+                          ScanRange *range) {
+  bool idle = false;
+  for (;;) {
+    {
+      SpinMutexLock l(&ff->mutex);
+      if (ff->ranges.size()) {
+        *range = ff->ranges.back();
+        ff->ranges.pop_back();
+        if (range->end - range->begin > kScanPieceSize) {
+          ff->ranges.push_back({range->begin + kScanPieceSize, range->end});
+          range->end = range->begin + kScanPieceSize;
+        }
+        atomic_store_relaxed(&ff->num_ranges, ff->ranges.size());
+        if (idle)
+          atomic_store_relaxed(&ff->num_idle,
+                               atomic_load_relaxed(&ff->num_idle) - 1);
+        return true;
+      }
+      if (!idle) {
+        idle = true;
+        atomic_store_relaxed(&ff->num_idle,
+                             atomic_load_relaxed(&ff->num_idle) + 1);
+      }
+      if (atomic_load_relaxed(&ff->num_idle) == num_threads)
+        return false;
+    }
+    while (!atomic_load_relaxed(&ff->num_ranges) &&
+           atomic_load_relaxed(&ff->num_idle) != num_threads)
+      internal_sched_yield();
+  }
+}
+
+// Moves the last |n| chunks of |frontier| to |ff|.
+static void ShareScanRanges(ParallelFloodFill *ff, Frontier *frontier,
+                            uptr n) {
+  SpinMutexLock l(&ff->mutex);
+  for (uptr i = frontier->size() - n; i < frontier->size(); i++) {
+    uptr chunk = (*frontier)[i];
+    ff->ranges.push_back({chunk, chunk + LsanMetadata(chunk).requested_size()});
+  }
+  frontier->resize(frontier->size() - n);
+  atomic_store_relaxed(&ff->num_ranges, ff->ranges.size());
+}
+
+static void FloodFillThread(void *arg, uptr num_threads) {
+  ParallelFloodFill *ff = reinterpret_cast<ParallelFloodFill *>(arg);
+  Frontier frontier;
+  ScanRange range;
+  while (TakeScanRange(ff, num_threads, &range)) {
+    ScanRangeForPointers(range.begin, range.end, &frontier, "HEAP", ff->tag);
+    while (frontier.size()) {
+      if (frontier.size() > 1 && atomic_load_relaxed(&ff->num_idle))
+        ShareScanRanges(ff, &frontier, frontier.size() / 2);
+      uptr next_chunk = frontier.back();
+      frontier.pop_back();
+      uptr end = next_chunk + LsanMetadata(next_chunk).requested_size();
+      if (end - next_chunk > kScanPieceSize) {
+        SpinMutexLock l(&ff->mutex);
+        ff->ranges.push_back({next_chunk + kScanPieceSize, end});
+        atomic_store_relaxed(&ff->num_ranges, ff->ranges.size());
+        end = next_chunk + kScanPieceSize;
+      }
+      ScanRangeForPointers(next_chunk, end, &frontier, "HEAP", ff->tag);
+    }
+  }
+}
+
 static void FloodFillTag(Frontier *frontier, ChunkTag tag) {
+  uptr num_threads = GetScanThreads();
+  if (num_threads > 1 && frontier->size()) {
+    ParallelFloodFill ff;
+    ff.tag = tag;
+    ff.mutex.Init();
+    atomic_store_relaxed(&ff.num_idle, 0);
+    ShareScanRanges(&ff, frontier, frontier->size());
+    RunScanThreads(FloodFillThread, &ff, num_threads);
+    return;
+  }
   while (frontier->size()) {
     uptr next_chunk = frontier->back();
     frontier->pop_back();
@@ -390,6 +506,52 @@ static void MarkIndirectlyLeakedCb(uptr chunk, void *arg) {
   }
 }
 
+// ForEachChunk callback. Collects the chunks that MarkIndirectlyLeakedCb
+// would scan.
+static void CollectLeakedCb(uptr chunk, void *arg) {
+  chunk = GetUserBegin(chunk);
+  LsanMetadata m(chunk);
+  if (m.allocated() && m.tag() != kReachable)
+    reinterpret_cast<Frontier *>(arg)->push_back(chunk);
+}
+
+struct MarkIndirectlyLeakedParam {
+  Frontier leaked;
+  atomic_uintptr_t next;
+};
+
+static void MarkIndirectlyLeakedThread(void *arg, uptr num_threads) {
+  MarkIndirectlyLeakedParam *param =
+      reinterpret_cast<MarkIndirectlyLeakedParam *>(arg);
+  const uptr kBatchSize = 64;
+  for (;;) {
+    uptr begin = atomic_fetch_add(&param->next, kBatchSize,
+                                  memory_order_relaxed);
+    if (begin >= param->leaked.size())
+      return;
+    uptr end = Min(begin + kBatchSize, param->leaked.size());
+    for (uptr i = begin; i < end; i++) {
+      uptr chunk = param->leaked[i];
+      ScanRangeForPointers(chunk, chunk + LsanMetadata(chunk).requested_size(),
+                           /* frontier */ nullptr, "HEAP", kIndirectlyLeaked);
+    }
+  }
+}
+
+// Marks the chunks that are reachable from leaked chunks as indirectly
+// leaked.
+static void MarkIndirectlyLeaked() {
+  uptr num_threads = GetScanThreads();
+  if (num_threads == 1) {
+    ForEachChunk(MarkIndirectlyLeakedCb, nullptr);
+    return;
+  }
+  MarkIndirectlyLeakedParam param;
+  ForEachChunk(CollectLeakedCb, &param.leaked);
+  atomic_store_relaxed(&param.next, 0);
+  RunScanThreads(MarkIndirectlyLeakedThread, &param, num_threads);
+}
+
 // ForEachChunk callback. If chunk is marked as ignored, adds its address to
 // frontier.
 static void CollectIgnoredCb(uptr chunk, void *arg) {
@@ -492,7 +654,7 @@ static void ClassifyAllChunks(SuspendedThreadsList const &suspended_threads,
   // Iterate over leaked chunks and mark those that are reachable from other
   // leaked chunks.
   LOG_POINTERS("Scanning leaked chunks.\n");
-  ForEachChunk(MarkIndirectlyLeakedCb, nullptr);
+  MarkIndirectlyLeaked();
 }
 
 // ForEachChunk callback. Resets the tags to pre-leak-check state.
@@ -121,6 +121,11 @@ typedef InternalMmapVector<uptr> Frontier;
 void InitializePlatformSpecificModules();
 void ProcessGlobalRegions(Frontier *frontier);
 void ProcessPlatformSpecificAllocations(Frontier *frontier);
+// Runs |callback| on up to |num_threads| threads, the current one included,
+// and waits for them. Called while the world is stopped, when the usual ways
+// to start threads may deadlock. Tells each thread how many of them run.
+typedef void (*ScanThreadCallback)(void *arg, uptr num_threads);
+void RunScanThreads(ScanThreadCallback callback, void *arg, uptr num_threads);
 
 struct RootRegion {
   uptr begin;
@@ -259,6 +264,9 @@ class LsanMetadata {
   bool allocated() const;
   ChunkTag tag() const;
   void set_tag(ChunkTag value);
+  // Atomically sets the tag to |value| if it is |expected|. Used by the
+  // threads that scan the heap in parallel.
+  bool compare_exchange_tag(ChunkTag expected, ChunkTag value);
   uptr requested_size() const;
   u32 stack_trace_id() const;
  private:
@@ -47,6 +47,10 @@ void ProcessGlobalRegions(Frontier *frontier) {}
 // Nothing to do here.
 void ProcessPlatformSpecificAllocations(Frontier *frontier) {}
 
+void RunScanThreads(ScanThreadCallback callback, void *arg, uptr num_threads) {
+  callback(arg, 1);
+}
+
 // On Fuchsia, we can intercept _Exit gracefully, and return a failing exit
 // code if required at that point.  Calling Die() here is undefined
 // behavior and causes rare race conditions.
@@ -16,12 +16,18 @@
 #include "lsan_common.h"
 
 #if CAN_SANITIZE_LEAKS && (SANITIZER_LINUX || SANITIZER_NETBSD)
+#include <errno.h>
 #include <link.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
 
 #include "sanitizer_common/sanitizer_common.h"
 #include "sanitizer_common/sanitizer_flags.h"
 #include "sanitizer_common/sanitizer_getauxval.h"
 #include "sanitizer_common/sanitizer_linux.h"
+#include "sanitizer_common/sanitizer_posix.h"
 #include "sanitizer_common/sanitizer_stackdepot.h"
 
 namespace __lsan {
@@ -108,6 +114,68 @@ LoadedModule *GetLinker() { return linker; }
 
 void ProcessPlatformSpecificAllocations(Frontier *frontier) {}
 
+#if SANITIZER_LINUX
+struct ScanThreadParam {
+  ScanThreadCallback callback;
+  void *arg;
+  atomic_uintptr_t num_threads;
+};
+
+static int ScanThread(void *arg) {
+  internal_prctl(PR_SET_PDEATHSIG, SIGKILL, 0, 0, 0);
+  ScanThreadParam *param = reinterpret_cast<ScanThreadParam *>(arg);
+  uptr num_threads;
+  while (!(num_threads = atomic_load(&param->num_threads,
+                                     memory_order_acquire)))
+    internal_sched_yield();
+  param->callback(param->arg, num_threads);
+  return 0;
+}
+
+// We run in the tracer, and the threads that pthread_create() needs may be
+// stopped while holding its locks, so start the scan threads the way
+// StopTheWorld() starts the tracer. They share the tracer's TLS, which the
+// scan does not use.
+void RunScanThreads(ScanThreadCallback callback, void *arg, uptr num_threads) {
+  const uptr kStackSize = 256 << 10;
+  const uptr kGuardSize = GetPageSizeCached();
+  ScanThreadParam param;
+  param.callback = callback;
+  param.arg = arg;
+  atomic_store(&param.num_threads, 0, memory_order_relaxed);
+  uptr stacks_size = (num_threads - 1) * (kStackSize + kGuardSize);
+  uptr stacks = stacks_size ? (uptr)MmapOrDie(stacks_size, "ScanThreads") : 0;
+  InternalMmapVector<uptr> pids;
+  for (uptr i = 0; i + 1 < num_threads; i++) {
+    uptr guard = stacks + i * (kStackSize + kGuardSize);
+    CHECK(MprotectNoAccess(guard, kGuardSize));
+    int local_errno;
+    uptr pid = internal_clone(
+        ScanThread, (void *)(guard + kGuardSize + kStackSize),
+        CLONE_VM | CLONE_FS | CLONE_FILES | CLONE_UNTRACED, &param,
+        nullptr /* parent_tidptr */, nullptr /* newtls */,
+        nullptr /* child_tidptr */);
+    if (internal_iserror(pid, &local_errno)) {
+      VReport(1, "Failed spawning a scan thread (errno %d).\n", local_errno);
+      break;
+    }
+    pids.push_back(pid);
+  }
+  atomic_store(&param.num_threads, pids.size() + 1, memory_order_release);
+  callback(arg, pids.size() + 1);
+  for (uptr pid : pids) {
+    uptr waitpid_status;
+    HANDLE_EINTR(waitpid_status, internal_waitpid(pid, nullptr, __WALL));
+  }
+  if (stacks_size)
+    UnmapOrDie((void *)stacks, stacks_size);
+}
+#else
+void RunScanThreads(ScanThreadCallback callback, void *arg, uptr num_threads) {
+  callback(arg, 1);
+}
+#endif
+
 struct DoStopTheWorldParam {
   StopTheWorldCallback callback;
   void *argument;
@@ -188,6 +188,10 @@ void ProcessPlatformSpecificAllocations(Frontier *frontier) {
   }
 }
 
+void RunScanThreads(ScanThreadCallback callback, void *arg, uptr num_threads) {
+  callback(arg, 1);
+}
+
 // On darwin, we can intercept _exit gracefully, and return a failing exit code
 // if required at that point. Calling Die() here is undefined behavior and
 // causes rare race conditions.
@@ -26,6 +26,7 @@
 #include "sanitizer_common/sanitizer_internal_defs.h"
 #include "sanitizer_common/sanitizer_list.h"
 #include "sanitizer_common/sanitizer_stackdepot.h"
+#include "sanitizer_common/sanitizer_symbolizer.h"
 
 #include <sched.h>
 #include <stdlib.h>
@@ -166,6 +167,23 @@ AllocatorCache *GetAllocatorCache(MemprofThreadLocalMallocStorage *ms) {
   return &ms->allocator_cache;
 }
 
+// Prints the symbolized allocation stack of a MemInfoBlock, one frame per line
+// and innermost frame first, including the frames of inlined functions. The
+// compiler reads these lines back together with the terse MIB lines.
+static void PrintAllocStack(u64 id) {
+  StackTrace stack = StackDepotGet(id);
+  for (uptr i = 0; i < stack.size; i++) {
+    uptr pc = StackTrace::GetPreviousInstructionPc(stack.trace[i]);
+    SymbolizedStack *frames = Symbolizer::GetOrInit()->SymbolizePC(pc);
+    for (SymbolizedStack *cur = frames; cur; cur = cur->next) {
+      const AddressInfo &info = cur->info;
+      Printf("STK:%llu/%s/%d/%d\n", id, info.function ? info.function : "??",
+             info.line, info.column);
+    }
+    frames->ClearAll();
+  }
+}
+
 struct MemInfoBlock {
   u32 alloc_count;
   u64 total_access_count, min_access_count, max_access_count;
@@ -213,6 +231,8 @@ struct MemInfoBlock {
       Printf("%d.%02d/%u/%u/", p / 100, p % 100, min_lifetime, max_lifetime);
       Printf("%u/%u/%u/%u\n", num_migrated_cpu, num_lifetime_overlaps,
              num_same_alloc_cpu, num_same_dealloc_cpu);
+      if (flags()->print_alloc_stacks)
+        PrintAllocStack(id);
     } else {
       p = total_size * 100 / alloc_count;
       Printf("Memory allocation stack id = %llu\n", id);
@@ -540,6 +540,16 @@ static void relocateCounters(void) {
       (uintptr_t)__llvm_profile_begin_counters() + CountersOffset;
 }
 
+#if !defined(__Fuchsia__) && !defined(_WIN32)
+static void warnNoCounterRelocation(void) {
+#if !defined(__APPLE__)
+  PROF_NOTE("%s", "Continuous mode does not need a fixed section layout if the "
+                  "image is compiled with `-mllvm "
+                  "-runtime-counter-relocation`.\n");
+#endif
+}
+#endif
+
 static void initializeProfileForContinuousMode(void) {
   if (!__llvm_profile_is_continuous_mode_enabled())
     return;
@@ -559,16 +569,20 @@ static void initializeProfileForContinuousMode(void) {
   uint64_t DataSize = __llvm_profile_get_data_size(DataBegin, DataEnd);
   uint64_t CountersSize = CountersEnd - CountersBegin;
 
-  /* Check that the counter and data sections in this image are page-aligned. */
+  /* Check that the counter and data sections in this image are page-aligned.
+   * Images built with runtime counter relocation do not need this, as their
+   * counters are redirected into a mapping of the profile instead. */
   unsigned PageSize = getpagesize();
   if ((intptr_t)CountersBegin % PageSize != 0) {
     PROF_ERR("Counters section not page-aligned (start = %p, pagesz = %u).\n",
              CountersBegin, PageSize);
+    warnNoCounterRelocation();
     return;
   }
   if ((intptr_t)DataBegin % PageSize != 0) {
     PROF_ERR("Data section not page-aligned (start = %p, pagesz = %u).\n",
              DataBegin, PageSize);
+    warnNoCounterRelocation();
     return;
   }
 
@@ -13,6 +13,7 @@
 #include "sanitizer_stackdepot.h"
 
 #include "sanitizer_common.h"
+#include "sanitizer_flags.h"
 #include "sanitizer_hash.h"
 #include "sanitizer_stackdepotbase.h"
 
@@ -22,7 +23,10 @@ struct StackDepotNode {
   StackDepotNode *link;
   u32 id;
   atomic_uint32_t hash_and_use_count; // hash_bits : 12; use_count : 20;
-  u32 size;
+  u32 size : 31;
+  // If set, the frames are delta-encoded (see compress_stack_depot). stack[0]
+  // then caches the decoded frames and the encoding follows it.
+  u32 packed : 1;
   u32 tag;
   uptr stack[1];  // [size]
 
@@ -41,12 +45,40 @@ struct StackDepotNode {
     if ((hash & kHashMask) != hash_bits || args.size != size || args.tag != tag)
       return false;
     uptr i = 0;
+    if (packed) {
+      const u8 *p = packed_data();
+      uptr pc = 0;
+      for (; i < size; i++) {
+        p = DecodeFrame(p, &pc);
+        if (pc != args.trace[i]) return false;
+      }
+      return true;
+    }
     for (; i < size; i++) {
       if (stack[i] != args.trace[i]) return false;
     }
     return true;
   }
+  // Returns the space taken by the delta encoding of args, or 0 if the frames
+  // are to be stored as is.
+  static uptr packed_size(const args_type &args) {
+    if (!common_flags()->compress_stack_depot)
+      return 0;
+    uptr res = 0;
+    uptr prev = 0;
+    for (uptr i = 0; i < args.size; i++) {
+      u8 buf[kMaxFrameSize];
+      res += EncodeFrame(buf, prev, args.trace[i]) - buf;
+      prev = args.trace[i];
+    }
+    // Keep the nodes aligned, the depot uses the lsb of node pointers. stack[0]
+    // is taken by the pointer to the decoded frames.
+    res = RoundUpTo(res, sizeof(uptr));
+    return res < (args.size - 1) * sizeof(uptr) ? res : 0;
+  }
   static uptr storage_size(const args_type &args) {
+    if (uptr bytes = packed_size(args))
+      return sizeof(StackDepotNode) + bytes;
     return sizeof(StackDepotNode) + (args.size - 1) * sizeof(uptr);
   }
   static u32 hash(const args_type &args) {
@@ -61,14 +93,70 @@ struct StackDepotNode {
     atomic_store(&hash_and_use_count, hash & kHashMask, memory_order_relaxed);
     size = args.size;
     tag = args.tag;
-    internal_memcpy(stack, args.trace, size * sizeof(uptr));
+    packed = packed_size(args) != 0;
+    if (!packed) {
+      internal_memcpy(stack, args.trace, size * sizeof(uptr));
+      return;
+    }
+    atomic_store(unpacked(), 0, memory_order_relaxed);
+    u8 *p = packed_data();
+    uptr prev = 0;
+    for (uptr i = 0; i < size; i++) {
+      p = EncodeFrame(p, prev, args.trace[i]);
+      prev = args.trace[i];
+    }
   }
-  args_type load() const {
-    return args_type(&stack[0], size, tag);
+  args_type load() {
+    if (!packed)
+      return args_type(&stack[0], size, tag);
+    // Decode the frames on first use and keep them, so that the returned
+    // trace stays valid for as long as the depot, as for unpacked nodes.
+    uptr v = atomic_load(unpacked(), memory_order_acquire);
+    if (!v) {
+      uptr *frames = (uptr *)PersistentAlloc(size * sizeof(uptr));
+      const u8 *p = packed_data();
+      uptr pc = 0;
+      for (uptr i = 0; i < size; i++) {
+        p = DecodeFrame(p, &pc);
+        frames[i] = pc;
+      }
+      // A racing load() may have decoded them first; its copy wins.
+      if (atomic_compare_exchange_strong(unpacked(), &v, (uptr)frames,
+                                         memory_order_acq_rel))
+        v = (uptr)frames;
+    }
+    return args_type((const uptr *)v, size, tag);
   }
   StackDepotHandle get_handle() { return StackDepotHandle(this); }
 
   typedef StackDepotHandle handle_type;
+
+ private:
+  // A frame is stored as the zigzag LEB128 encoding of its difference from
+  // the previous frame. Frames of a trace mostly lie in the same module, so
+  // that typically takes 3-4 bytes instead of 8.
+  static const uptr kMaxFrameSize = (sizeof(uptr) * 8 + 6) / 7;
+
+  static u8 *EncodeFrame(u8 *p, uptr prev, uptr pc) {
+    uptr delta = pc - prev;
+    uptr v = (delta << 1) ^ (uptr)((sptr)delta >> (sizeof(uptr) * 8 - 1));
+    for (; v >= 0x80; v >>= 7) *p++ = (u8)(v | 0x80);
+    *p++ = (u8)v;
+    return p;
+  }
+  static const u8 *DecodeFrame(const u8 *p, uptr *pc) {
+    uptr v = 0;
+    for (uptr shift = 0;; shift += 7) {
+      u8 b = *p++;
+      v |= (uptr)(b & 0x7f) << shift;
+      if (!(b & 0x80)) break;
+    }
+    *pc += (v >> 1) ^ (0 - (v & 1));
+    return p;
+  }
+  atomic_uintptr_t *unpacked() { return (atomic_uintptr_t *)&stack[0]; }
+  u8 *packed_data() { return (u8 *)&stack[1]; }
+  const u8 *packed_data() const { return (const u8 *)&stack[1]; }
 };
 
 COMPILER_CHECK(StackDepotNode::kMaxUseCount == (u32)kStackDepotMaxUseCount);
@@ -108,31 +108,48 @@ StackDepotBase<Node, kReservedBits, kTabSizeLog>::Put(args_type args,
   // First, try to find the existing stack.
   Node *node = find(s, args, h);
   if (node) return node->get_handle();
-  // If failed, lock, retry and insert new.
-  Node *s2 = lock(p);
-  if (s2 != s) {
-    node = find(s2, args, h);
-    if (node) {
-      unlock(p, s2);
-      return node->get_handle();
+  // If failed, publish a new node with a CAS on the bucket head. Readers never
+  // block, and writers only wait for LockAll(), which sets the head lsb.
+  Node *new_node = nullptr;
+  for (int i = 0;; i++) {
+    uptr cmp = atomic_load(p, memory_order_acquire);
+    if (cmp & 1) {
+      if (i < 10)
+        proc_yield(10);
+      else
+        internal_sched_yield();
+      continue;
+    }
+    Node *s2 = (Node *)cmp;
+    if (s2 != s) {
+      // Somebody inserted concurrently, possibly the same stack. A node we
+      // have already built is then leaked, as is its id, but such races are
+      // rare.
+      node = find(s2, args, h);
+      if (node) return node->get_handle();
+      s = s2;
     }
+    if (!new_node) {
+      uptr part = (h % kTabSize) / kPartSize;
+      u32 id = atomic_fetch_add(&seq[part], 1, memory_order_relaxed) + 1;
+      CHECK_LT(id, kMaxId);
+      id |= part << kPartShift;
+      CHECK_NE(id, 0);
+      CHECK_EQ(id & (((u32)-1) >> kReservedBits), id);
+      uptr memsz = Node::storage_size(args);
+      new_node = (Node *)PersistentAlloc(memsz);
+      stats.allocated += memsz;
+      new_node->id = id;
+      new_node->store(args, h);
+    }
+    new_node->link = s2;
+    if (atomic_compare_exchange_weak(p, &cmp, (uptr)new_node,
+                                     memory_order_release))
+      break;
   }
-  uptr part = (h % kTabSize) / kPartSize;
-  u32 id = atomic_fetch_add(&seq[part], 1, memory_order_relaxed) + 1;
   stats.n_uniq_ids++;
-  CHECK_LT(id, kMaxId);
-  id |= part << kPartShift;
-  CHECK_NE(id, 0);
-  CHECK_EQ(id & (((u32)-1) >> kReservedBits), id);
-  uptr memsz = Node::storage_size(args);
-  s = (Node *)PersistentAlloc(memsz);
-  stats.allocated += memsz;
-  s->id = id;
-  s->store(args, h);
-  s->link = s2;
-  unlock(p, s);
   if (inserted) *inserted = true;
-  return s->get_handle();
+  return new_node->get_handle();
 }
 
 template <class Node, int kReservedBits, int kTabSizeLog>
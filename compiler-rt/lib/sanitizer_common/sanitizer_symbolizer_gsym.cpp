@@ -0,0 +1,450 @@
+//===-- sanitizer_symbolizer_gsym.cpp -------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file is shared between AddressSanitizer and ThreadSanitizer
+// run-time libraries.
+// GSYM implementation of symbolizer parts. The lookup follows
+// llvm/lib/DebugInfo/GSYM (GsymReader, FunctionInfo, LineTable and InlineInfo
+// lookups), but works on the mapped file without any allocation but the
+// strings of the resulting frames.
+//===----------------------------------------------------------------------===//
+
+#include "sanitizer_platform.h"
+
+#if SANITIZER_POSIX
+#include "sanitizer_flags.h"
+#include "sanitizer_posix.h"
+#include "sanitizer_symbolizer_gsym.h"
+
+#include <sys/mman.h>
+
+namespace __sanitizer {
+
+namespace {
+
+const u32 kGsymMagic = 0x4753594d;  // 'GSYM'
+const u16 kGsymVersion = 1;
+const uptr kGsymHeaderSize = 48;
+const uptr kGsymMaxUUIDSize = 20;
+
+// FunctionInfo data types.
+enum { kEndOfList = 0, kLineTableInfo = 1, kInlineInfo = 2 };
+// Line table opcodes.
+enum { kEndSequence = 0, kSetFile = 1, kAdvancePC = 2, kAdvanceLine = 3,
+       kFirstSpecial = 4 };
+
+// Bounds-checked reader of native-endian GSYM data. Once a read runs past the
+// end, all reads return 0 and failed() is true.
+class GsymData {
+ public:
+  GsymData(const u8 *data, uptr size) : data_(data), size_(size) {}
+
+  bool failed() const { return failed_; }
+  uptr offset() const { return offset_; }
+  void seek(uptr offset) {
+    if (offset > size_)
+      failed_ = true;
+    else
+      offset_ = offset;
+  }
+  void skip(uptr size) { seek(size > size_ ? size_ + 1 : offset_ + size); }
+  const u8 *data() const { return data_; }
+  uptr size() const { return size_; }
+
+  template <typename T>
+  T read() {
+    T v = 0;
+    if (failed_ || size_ - offset_ < sizeof(T)) {
+      failed_ = true;
+      return 0;
+    }
+    internal_memcpy(&v, data_ + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return v;
+  }
+
+  u64 readUnsigned(uptr size) {
+    switch (size) {
+      case 1: return read<u8>();
+      case 2: return read<u16>();
+      case 4: return read<u32>();
+      case 8: return read<u64>();
+    }
+    failed_ = true;
+    return 0;
+  }
+
+  u64 readULEB() {
+    u64 v = 0;
+    for (unsigned shift = 0; !failed_; shift += 7) {
+      u8 byte = read<u8>();
+      if (shift < 64)
+        v |= (u64)(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        break;
+    }
+    return v;
+  }
+
+  s64 readSLEB() {
+    u64 v = 0;
+    unsigned shift = 0;
+    u8 byte = 0;
+    do {
+      byte = read<u8>();
+      if (shift < 64)
+        v |= (u64)(byte & 0x7f) << shift;
+      shift += 7;
+    } while ((byte & 0x80) && !failed_);
+    if (shift < 64 && (byte & 0x40))
+      v |= ~(u64)0 << shift;
+    return (s64)v;
+  }
+
+ private:
+  const u8 *data_;
+  uptr size_;
+  uptr offset_ = 0;
+  bool failed_ = false;
+};
+
+struct GsymHeader {
+  u64 base_address;
+  u32 num_addresses;
+  u32 strtab_offset;
+  u32 strtab_size;
+  u8 addr_off_size;
+  uptr addr_offsets;
+  uptr addr_info_offsets;
+  u32 num_files;
+  uptr files;
+};
+
+bool ParseHeader(GsymData *d, GsymHeader *h) {
+  if (d->read<u32>() != kGsymMagic || d->read<u16>() != kGsymVersion)
+    return false;
+  h->addr_off_size = d->read<u8>();
+  u8 uuid_size = d->read<u8>();
+  h->base_address = d->read<u64>();
+  h->num_addresses = d->read<u32>();
+  h->strtab_offset = d->read<u32>();
+  h->strtab_size = d->read<u32>();
+  if (d->failed() || uuid_size > kGsymMaxUUIDSize)
+    return false;
+  if (h->addr_off_size != 1 && h->addr_off_size != 2 &&
+      h->addr_off_size != 4 && h->addr_off_size != 8)
+    return false;
+  h->addr_offsets = RoundUpTo(kGsymHeaderSize, h->addr_off_size);
+  d->seek(h->addr_offsets);
+  d->skip((uptr)h->num_addresses * h->addr_off_size);
+  h->addr_info_offsets = RoundUpTo(d->offset(), 4);
+  d->seek(h->addr_info_offsets);
+  d->skip((uptr)h->num_addresses * sizeof(u32));
+  h->num_files = d->read<u32>();
+  h->files = d->offset();
+  d->skip((uptr)h->num_files * 2 * sizeof(u32));
+  if (d->failed() || h->strtab_offset > d->size() ||
+      h->strtab_size > d->size() - h->strtab_offset)
+    return false;
+  return true;
+}
+
+// Returns the string at |offset| of the string table, or null if it is not
+// a valid, null-terminated string.
+const char *GetString(const GsymData &d, const GsymHeader &h, u32 offset) {
+  if (offset >= h.strtab_size)
+    return nullptr;
+  const char *s = (const char *)d.data() + h.strtab_offset + offset;
+  uptr max_len = h.strtab_size - offset;
+  return internal_strnlen(s, max_len) < max_len ? s : nullptr;
+}
+
+// Returns the "dir/base" path of the |index|-th file, or null.
+char *GetFile(const GsymData &d, const GsymHeader &h, u32 index) {
+  if (index == 0 || index >= h.num_files)
+    return nullptr;
+  GsymData f(d.data(), d.size());
+  f.seek(h.files + (uptr)index * 2 * sizeof(u32));
+  const char *dir = GetString(d, h, f.read<u32>());
+  const char *base = GetString(d, h, f.read<u32>());
+  if (f.failed() || !base || !base[0])
+    return nullptr;
+  if (!dir || !dir[0])
+    return internal_strdup(base);
+  uptr dir_len = internal_strlen(dir);
+  uptr base_len = internal_strlen(base);
+  char *path = (char *)InternalAlloc(dir_len + base_len + 2);
+  internal_memcpy(path, dir, dir_len);
+  path[dir_len] = '/';
+  internal_memcpy(path + dir_len + 1, base, base_len + 1);
+  return path;
+}
+
+// Finds the index of the function that may contain |addr|: the last one that
+// starts at or before it.
+bool FindFunction(const GsymData &d, const GsymHeader &h, u64 addr,
+                  u32 *index) {
+  if (addr < h.base_address)
+    return false;
+  u64 rel = addr - h.base_address;
+  GsymData a(d.data(), d.size());
+  uptr lo = 0, hi = h.num_addresses;
+  while (lo < hi) {
+    uptr mid = lo + (hi - lo) / 2;
+    a.seek(h.addr_offsets + mid * h.addr_off_size);
+    if (a.readUnsigned(h.addr_off_size) <= rel)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo == 0 || a.failed())
+    return false;
+  *index = lo - 1;
+  return true;
+}
+
+// Runs the line table of the function at |func_addr| up to |addr|.
+bool LookupLine(GsymData *d, u64 func_addr, u64 addr, u32 *file, u32 *line) {
+  s64 min_delta = d->readSLEB();
+  s64 max_delta = d->readSLEB();
+  s64 line_range = max_delta - min_delta + 1;
+  u64 row_addr = func_addr;
+  u32 row_file = 1;
+  u32 row_line = (u32)d->readULEB();
+  bool found = false;
+  if (line_range <= 0)
+    return false;
+  while (!d->failed()) {
+    u8 op = d->read<u8>();
+    if (op == kEndSequence) {
+      break;
+    } else if (op == kSetFile) {
+      row_file = (u32)d->readULEB();
+      continue;
+    } else if (op == kAdvanceLine) {
+      row_line += (u32)d->readSLEB();
+      continue;
+    } else if (op == kAdvancePC) {
+      row_addr += d->readULEB();
+    } else {
+      u8 adjusted = op - kFirstSpecial;
+      row_line += (u32)(min_delta + adjusted % line_range);
+      row_addr += adjusted / line_range;
+    }
+    // A new row.
+    if (addr < row_addr || d->failed())
+      break;
+    *file = row_file;
+    *line = row_line;
+    found = true;
+    if (addr == row_addr)
+      break;
+  }
+  return found;
+}
+
+struct GsymLocation {
+  u32 name;
+  u32 file;
+  u32 line;
+};
+
+const uptr kMaxGsymLocations = 64;
+
+struct InlineLookup {
+  GsymData *d;
+  u64 addr;
+  GsymLocation *locs;
+  uptr num_locs;
+};
+
+// Skips an InlineInfo and its children. Returns false at the end of a list of
+// siblings.
+bool SkipInlineInfo(GsymData *d, bool skipped_ranges, uptr depth) {
+  if (!skipped_ranges) {
+    u64 num_ranges = d->readULEB();
+    if (num_ranges == 0)
+      return false;
+    for (u64 i = 0; i < num_ranges && !d->failed(); i++) {
+      d->readULEB();
+      d->readULEB();
+    }
+  }
+  bool has_children = d->read<u8>();
+  d->read<u32>();
+  d->readULEB();
+  d->readULEB();
+  if (has_children) {
+    if (depth >= kMaxGsymLocations) {
+      d->seek(d->size() + 1);
+      return false;
+    }
+    while (!d->failed() && SkipInlineInfo(d, false, depth + 1)) {
+    }
+  }
+  return !d->failed();
+}
+
+// Adds a location for each inlined call that contains the address, innermost
+// first. Returns false if the InlineInfo does not contain it, so that the
+// caller moves on to its next sibling.
+bool LookupInline(InlineLookup *l, u64 base_addr, uptr depth) {
+  GsymData *d = l->d;
+  u64 num_ranges = d->readULEB();
+  if (num_ranges == 0)
+    return true;
+  u64 first_start = 0;
+  bool contains = false;
+  for (u64 i = 0; i < num_ranges && !d->failed(); i++) {
+    u64 start = base_addr + d->readULEB();
+    u64 size = d->readULEB();
+    if (i == 0)
+      first_start = start;
+    if (l->addr >= start && l->addr - start < size)
+      contains = true;
+  }
+  if (!contains) {
+    SkipInlineInfo(d, true, depth);
+    return d->failed();
+  }
+  bool has_children = d->read<u8>();
+  u32 name = d->read<u32>();
+  u32 call_file = (u32)d->readULEB();
+  u32 call_line = (u32)d->readULEB();
+  if (has_children && depth < kMaxGsymLocations) {
+    while (!d->failed() && !LookupInline(l, first_start, depth + 1)) {
+    }
+  }
+  if (d->failed() || call_file == 0 || l->num_locs == kMaxGsymLocations)
+    return true;
+  GsymLocation *callee = &l->locs[l->num_locs - 1];
+  l->locs[l->num_locs++] = {callee->name, call_file, call_line};
+  callee->name = name;
+  return true;
+}
+
+}  // namespace
+
+bool GsymSymbolizer::SymbolizeFromData(const u8 *data, uptr size,
+                                       uptr module_offset, bool inline_frames,
+                                       SymbolizedStack *stack) {
+  GsymData d(data, size);
+  GsymHeader h;
+  u32 index;
+  if (!ParseHeader(&d, &h) || !FindFunction(d, h, module_offset, &index))
+    return false;
+
+  d.seek(h.addr_info_offsets + (uptr)index * sizeof(u32));
+  d.seek(d.read<u32>());
+  u64 func_addr = h.base_address;
+  {
+    GsymData a(data, size);
+    a.seek(h.addr_offsets + (uptr)index * h.addr_off_size);
+    func_addr += a.readUnsigned(h.addr_off_size);
+  }
+  u32 func_size = d.read<u32>();
+  u32 func_name = d.read<u32>();
+  if (d.failed() || func_name == 0 ||
+      (func_size && module_offset - func_addr >= func_size))
+    return false;
+
+  GsymLocation locs[kMaxGsymLocations];
+  locs[0] = {func_name, 0, 0};
+  uptr num_locs = 1;
+  GsymData inline_data(nullptr, 0);
+  bool has_inline_data = false;
+  while (!d.failed()) {
+    u32 type = d.read<u32>();
+    u32 length = d.read<u32>();
+    if (type == kEndOfList || d.failed() || length > size - d.offset())
+      break;
+    GsymData info(data + d.offset(), length);
+    if (type == kLineTableInfo) {
+      LookupLine(&info, func_addr, module_offset, &locs[0].file,
+                 &locs[0].line);
+    } else if (type == kInlineInfo) {
+      inline_data = info;
+      has_inline_data = true;
+    }
+    d.skip(length);
+  }
+  if (locs[0].file && inline_frames && has_inline_data) {
+    InlineLookup l = {&inline_data, module_offset, locs, num_locs};
+    LookupInline(&l, func_addr, 0);
+    num_locs = l.num_locs;
+  }
+
+  SymbolizedStack *last = stack;
+  for (uptr i = 0; i < num_locs; i++) {
+    SymbolizedStack *cur = stack;
+    if (i) {
+      cur = SymbolizedStack::New(stack->info.address);
+      cur->info.FillModuleInfo(stack->info.module, stack->info.module_offset,
+                               stack->info.module_arch);
+      last->next = cur;
+      last = cur;
+    }
+    AddressInfo *info = &cur->info;
+    if (const char *name = GetString(d, h, locs[i].name))
+      info->function = internal_strdup(DemangleSwiftAndCXX(name));
+    info->file = GetFile(d, h, locs[i].file);
+    info->line = locs[i].line;
+  }
+  return true;
+}
+
+GsymSymbolizer *GsymSymbolizer::get(LowLevelAllocator *alloc) {
+  if (!common_flags()->symbolize_gsym)
+    return nullptr;
+  return new(*alloc) GsymSymbolizer();
+}
+
+const GsymSymbolizer::Module *GsymSymbolizer::GetModule(
+    const char *module_name) {
+  if (last_module_ < modules_.size() &&
+      !internal_strcmp(modules_[last_module_].name, module_name))
+    return &modules_[last_module_];
+  for (uptr i = 0; i < modules_.size(); i++) {
+    if (!internal_strcmp(modules_[i].name, module_name)) {
+      last_module_ = i;
+      return &modules_[i];
+    }
+  }
+
+  Module module = {internal_strdup(module_name), nullptr, 0};
+  InternalScopedString path(kMaxPathLength);
+  path.append("%s.gsym", module_name);
+  fd_t fd = OpenFile(path.data(), RdOnly);
+  if (fd != kInvalidFd) {
+    uptr size = internal_filesize(fd);
+    if (size != (uptr)-1 && size >= kGsymHeaderSize) {
+      uptr map = internal_mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (!internal_iserror(map)) {
+        module.data = (const u8 *)map;
+        module.size = size;
+        VReport(2, "Using GSYM file %s\n", path.data());
+      }
+    }
+    CloseFile(fd);
+  }
+  last_module_ = modules_.size();
+  modules_.push_back(module);
+  return &modules_[last_module_];
+}
+
+bool GsymSymbolizer::SymbolizePC(uptr addr, SymbolizedStack *stack) {
+  const Module *module = GetModule(stack->info.module);
+  return module->data &&
+         SymbolizeFromData(module->data, module->size,
+                           stack->info.module_offset,
+                           common_flags()->symbolize_inline_frames, stack);
+}
+
+}  // namespace __sanitizer
+
+#endif  // SANITIZER_POSIX
@@ -0,0 +1,57 @@
+//===-- sanitizer_symbolizer_gsym.h -----------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file is shared between AddressSanitizer and ThreadSanitizer
+// run-time libraries.
+// Header for the GSYM symbolizer, which symbolizes PCs in-process from the
+// GSYM file (see llvm/DebugInfo/GSYM) that llvm-gsymutil wrote next to a
+// module, instead of asking an external symbolizer.
+//===----------------------------------------------------------------------===//
+#ifndef SANITIZER_SYMBOLIZER_GSYM_H
+#define SANITIZER_SYMBOLIZER_GSYM_H
+
+#include "sanitizer_common.h"
+#include "sanitizer_symbolizer_internal.h"
+
+namespace __sanitizer {
+
+class GsymSymbolizer final : public SymbolizerTool {
+ public:
+  static GsymSymbolizer *get(LowLevelAllocator *alloc);
+
+  bool SymbolizePC(uptr addr, SymbolizedStack *stack) override;
+
+  bool SymbolizeData(uptr addr, DataInfo *info) override { return false; }
+
+  // Fills |stack|, pre-filled with the module name and offset, from the GSYM
+  // data at [data, data + size). Returns false if the data is not a valid
+  // GSYM file or does not describe the offset. Only reads the data and
+  // allocates the strings of the frames, so that it can be used on a file
+  // mapped read-only.
+  static bool SymbolizeFromData(const u8 *data, uptr size, uptr module_offset,
+                                bool inline_frames, SymbolizedStack *stack);
+
+ private:
+  GsymSymbolizer() {}
+
+  struct Module {
+    char *name;
+    // Null if the module has no valid GSYM file.
+    const u8 *data;
+    uptr size;
+  };
+  const Module *GetModule(const char *module_name);
+
+  // Modules are looked up and mapped once, and stay mapped for the lifetime
+  // of the process, so later reports only pay for the lookups.
+  InternalMmapVector<Module> modules_;
+  uptr last_module_ = 0;
+};
+
+}  // namespace __sanitizer
+#endif  // SANITIZER_SYMBOLIZER_GSYM_H
@@ -12,6 +12,7 @@
 #include "sanitizer_common/sanitizer_stackdepot.h"
 
 #include "gtest/gtest.h"
+#include "sanitizer_common/sanitizer_flags.h"
 #include "sanitizer_common/sanitizer_internal_defs.h"
 #include "sanitizer_common/sanitizer_libc.h"
 
@@ -65,6 +66,38 @@ TEST(SanitizerCommon, StackDepotSeveral) {
   EXPECT_NE(i1, i2);
 }
 
+TEST(SanitizerCommon, StackDepotCompressed) {
+  CommonFlags old_flags;
+  old_flags.CopyFrom(*common_flags());
+  CommonFlags cf;
+  cf.CopyFrom(old_flags);
+  cf.compress_stack_depot = true;
+  OverrideCommonFlags(cf);
+
+  uptr array1[] = {0x7f0000001000, 0x7f0000000f00, 0x561234567890, 0,
+                   (uptr)-1, 0x7f0000001000};
+  StackTrace s1(array1, ARRAY_SIZE(array1));
+  uptr array2[] = {0x7f0000001000, 0x7f0000000f00, 0x561234567890, 0,
+                   (uptr)-1, 0x7f0000001001};
+  StackTrace s2(array2, ARRAY_SIZE(array2));
+  u32 i1 = StackDepotPut(s1);
+  u32 i2 = StackDepotPut(s2);
+  EXPECT_NE(i1, i2);
+  EXPECT_EQ(i1, StackDepotPut(s1));
+  EXPECT_EQ(i2, StackDepotPut(s2));
+  for (int i = 0; i < 2; i++) {
+    StackTrace stack = StackDepotGet(i1);
+    EXPECT_EQ(ARRAY_SIZE(array1), stack.size);
+    EXPECT_EQ(0, internal_memcmp(stack.trace, array1, sizeof(array1)));
+    stack = StackDepotGet(i2);
+    EXPECT_EQ(ARRAY_SIZE(array2), stack.size);
+    EXPECT_EQ(0, internal_memcmp(stack.trace, array2, sizeof(array2)));
+  }
+  EXPECT_EQ(StackDepotGet(i1).trace, StackDepotGet(i1).trace);
+
+  OverrideCommonFlags(old_flags);
+}
+
 #if SANITIZER_WINDOWS
 // CaptureStderr does not work on Windows.
 #define Maybe_StackDepotPrint DISABLED_StackDepotPrint
@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "sanitizer_common/sanitizer_allocator_internal.h"
+#include "sanitizer_common/sanitizer_symbolizer_gsym.h"
 #include "sanitizer_common/sanitizer_symbolizer_internal.h"
 #include "gtest/gtest.h"
 
@@ -68,4 +69,81 @@ TEST(Symbolizer, DemangleSwiftAndCXX) {
 }
 #endif
 
+#if SANITIZER_POSIX
+// A GSYM file with a function foo at [0x1000, 0x1020) whose line table maps
+// [0x1000, 0x1010) to /src/a.c:10 and the rest to line 15, and into which
+// bar is inlined at [0x1010, 0x1018) from line 12.
+static const u8 kGsym[] = {
+    // Header: magic, version, address offset size, UUID size, base address,
+    // number of addresses, string table offset and size, UUID.
+    0x4d, 0x59, 0x53, 0x47, 1, 0, 4, 0,
+    0x00, 0x10, 0, 0, 0, 0, 0, 0,
+    1, 0, 0, 0, 127, 0, 0, 0, 18, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    // Address offsets, function info offsets.
+    0, 0, 0, 0, 76, 0, 0, 0,
+    // Files: none, /src/a.c.
+    2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 5, 0, 0, 0, 10, 0, 0, 0,
+    // Function info: size, name.
+    0x20, 0, 0, 0, 1, 0, 0, 0,
+    // Line table: min and max line deltas, first line, a row at 0x1000,
+    // advance line by 5, a row at 0x1010, end.
+    1, 0, 0, 0, 9, 0, 0, 0,
+    0x7f, 2, 10, 5, 3, 5, 2, 0x10, 0,
+    // Inline info: one range at 0x10 of size 8, no children, name bar, call
+    // file and line.
+    2, 0, 0, 0, 10, 0, 0, 0,
+    1, 0x10, 8, 0, 14, 0, 0, 0, 1, 12,
+    // End of the function info.
+    0, 0, 0, 0, 0, 0, 0, 0,
+    // String table.
+    0, 'f', 'o', 'o', 0, '/', 's', 'r', 'c', 0, 'a', '.', 'c', 0,
+    'b', 'a', 'r', 0,
+};
+
+static SymbolizedStack *SymbolizeGsym(uptr offset) {
+  SymbolizedStack *stack = SymbolizedStack::New(offset);
+  stack->info.FillModuleInfo("module", offset, kModuleArchUnknown);
+  if (!GsymSymbolizer::SymbolizeFromData(kGsym, sizeof(kGsym), offset, true,
+                                         stack)) {
+    stack->ClearAll();
+    return nullptr;
+  }
+  return stack;
+}
+
+TEST(Symbolizer, Gsym) {
+  ASSERT_EQ(145U, sizeof(kGsym));
+  EXPECT_EQ(nullptr, SymbolizeGsym(0xfff));
+  EXPECT_EQ(nullptr, SymbolizeGsym(0x1020));
+
+  SymbolizedStack *stack = SymbolizeGsym(0x1004);
+  ASSERT_NE(nullptr, stack);
+  EXPECT_STREQ("foo", stack->info.function);
+  EXPECT_STREQ("/src/a.c", stack->info.file);
+  EXPECT_EQ(10, stack->info.line);
+  EXPECT_EQ(nullptr, stack->next);
+  stack->ClearAll();
+
+  stack = SymbolizeGsym(0x1012);
+  ASSERT_NE(nullptr, stack);
+  EXPECT_STREQ("bar", stack->info.function);
+  EXPECT_STREQ("/src/a.c", stack->info.file);
+  EXPECT_EQ(15, stack->info.line);
+  ASSERT_NE(nullptr, stack->next);
+  EXPECT_STREQ("foo", stack->next->info.function);
+  EXPECT_STREQ("/src/a.c", stack->next->info.file);
+  EXPECT_EQ(12, stack->next->info.line);
+  EXPECT_EQ(nullptr, stack->next->next);
+  stack->ClearAll();
+
+  // Truncated files are rejected rather than read past their end.
+  for (uptr size = 0; size < sizeof(kGsym) - 18; size++) {
+    SymbolizedStack *stack = SymbolizedStack::New(0x1012);
+    GsymSymbolizer::SymbolizeFromData(kGsym, size, 0x1012, true, stack);
+    stack->ClearAll();
+  }
+}
+#endif
+
 }  // namespace __sanitizer
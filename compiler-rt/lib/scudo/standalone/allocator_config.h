@@ -17,6 +17,7 @@
 #include "secondary.h"
 #include "size_class_map.h"
 #include "tsd_exclusive.h"
+#include "tsd_per_cpu.h"
 #include "tsd_shared.h"
 
 namespace scudo {
@@ -27,7 +28,9 @@ struct DefaultConfig {
   using SizeClassMap = DefaultSizeClassMap;
 #if SCUDO_CAN_USE_PRIMARY64
   // 1GB Regions
-  typedef SizeClassAllocator64<SizeClassMap, 30U> Primary;
+  typedef SizeClassAllocator64<SizeClassMap, 30U, INT32_MIN, INT32_MAX, false,
+                               SCUDO_USE_HUGE_PAGES>
+      Primary;
 #else
   // 512KB regions
   typedef SizeClassAllocator32<SizeClassMap, 19U> Primary;
@@ -39,7 +42,12 @@ struct DefaultConfig {
   static const s32 SecondaryCacheMinReleaseToOsIntervalMs = INT32_MIN;
   static const s32 SecondaryCacheMaxReleaseToOsIntervalMs = INT32_MAX;
 
+#if SCUDO_USE_PER_CPU_TSDS
+  template <class A>
+  using TSDRegistryT = TSDRegistryPerCPUT<A, 64U>; // Per-CPU, max 64 TSDs.
+#else
   template <class A> using TSDRegistryT = TSDRegistryExT<A>; // Exclusive
+#endif
 };
 
 struct AndroidConfig {
@@ -100,4 +100,48 @@ BENCHMARK_TEMPLATE(BM_malloc_free_loop, scudo::FuchsiaConfig)
     ->Range(MinIters, MaxIters);
 #endif
 
+// Android's shared TSDs, but picked by the CPU a thread runs on rather than
+// assigned to the thread.
+struct AndroidPerCPUConfig : scudo::AndroidConfig {
+  template <class A>
+  using TSDRegistryT = scudo::TSDRegistryPerCPUT<A, 64U>;
+};
+
+// Many threads allocating and freeing at once through one allocator, as in a
+// server with many more threads than CPUs.
+template <typename Config>
+static void BM_malloc_free_threaded(benchmark::State &State) {
+  using AllocatorT = scudo::Allocator<Config>;
+  // Shared by all the threads of all the runs, and never torn down, like the
+  // allocator of a process.
+  static AllocatorT *Allocator = [] {
+    auto *A = new AllocatorT;
+    A->reset();
+    return A;
+  }();
+
+  const size_t NBytes = State.range(0);
+  void *Ptrs[16];
+
+  for (auto _ : State) {
+    for (void *&Ptr : Ptrs) {
+      Ptr = Allocator->allocate(NBytes, scudo::Chunk::Origin::Malloc);
+      benchmark::DoNotOptimize(Ptr);
+    }
+    for (void *&Ptr : Ptrs)
+      Allocator->deallocate(Ptr, scudo::Chunk::Origin::Malloc);
+  }
+
+  State.SetItemsProcessed(uint64_t(State.iterations()) * ARRAY_SIZE(Ptrs));
+}
+
+BENCHMARK_TEMPLATE(BM_malloc_free_threaded, scudo::AndroidConfig)
+    ->Arg(64)
+    ->ThreadRange(1, 256)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_malloc_free_threaded, AndroidPerCPUConfig)
+    ->Arg(64)
+    ->ThreadRange(1, 256)
+    ->UseRealTime();
+
 BENCHMARK_MAIN();
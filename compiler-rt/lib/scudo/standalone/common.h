@@ -129,6 +129,11 @@ inline uptr getPageSizeCached() {
 // Returns 0 if the number of CPUs could not be determined.
 u32 getNumberOfCPUs();
 
+// Returns the CPU the calling thread is running on, or 0 if that cannot be
+// determined. The thread may have migrated by the time this returns, so the
+// result is only a hint.
+u32 getCurrentCPU();
+
 const char *getEnv(const char *Name);
 
 u64 getMonotonicTime();
@@ -146,6 +151,8 @@ bool getRandom(void *Buffer, uptr Length, bool Blocking = false);
 #define MAP_NOACCESS (1U << 1)
 #define MAP_RESIZABLE (1U << 2)
 #define MAP_MEMTAG (1U << 3)
+// Hints that the mapping should be backed by huge pages, where supported.
+#define MAP_HUGEPAGE (1U << 4)
 
 // Our platform memory mapping use is restricted to 3 scenarios:
 // - reserve memory at a random address (MAP_NOACCESS);
@@ -70,6 +70,12 @@ void *map(void *Addr, uptr Size, UNUSED const char *Name, uptr Flags,
       dieOnMapUnmapError(errno == ENOMEM);
     return nullptr;
   }
+#if defined(MADV_HUGEPAGE)
+  // This is only a hint: transparent huge pages might be disabled, in which
+  // case the mapping is backed by regular pages.
+  if (Flags & MAP_HUGEPAGE)
+    madvise(P, Size, MADV_HUGEPAGE);
+#endif
 #if SCUDO_ANDROID
   if (!(Flags & MAP_NOACCESS))
     prctl(ANDROID_PR_SET_VMA, ANDROID_PR_SET_VMA_ANON_NAME, P, Size, Name);
@@ -139,6 +145,39 @@ u32 getNumberOfCPUs() {
   return static_cast<u32>(CPU_COUNT(&CPUs));
 }
 
+#if !SCUDO_ANDROID && (defined(__x86_64__) || defined(__aarch64__))
+// glibc 2.35 and later register a restartable sequences area for every thread,
+// __rseq_offset bytes from the thread pointer, in which the kernel keeps the
+// number of the CPU the thread runs on.
+extern "C" WEAK const ptrdiff_t __rseq_offset;
+extern "C" WEAK const unsigned int __rseq_size;
+
+struct RseqArea {
+  u32 CPUIdStart;
+  s32 CPUId; // Negative while the area is not registered.
+};
+#endif
+
+u32 getCurrentCPU() {
+#if !SCUDO_ANDROID && (defined(__x86_64__) || defined(__aarch64__))
+  if (&__rseq_size != nullptr && __rseq_size != 0) {
+    uptr ThreadPointer;
+#if defined(__x86_64__)
+    __asm__("mov %%fs:0, %0" : "=r"(ThreadPointer));
+#else
+    __asm__("mrs %0, tpidr_el0" : "=r"(ThreadPointer));
+#endif
+    const volatile RseqArea *Rseq =
+        reinterpret_cast<RseqArea *>(ThreadPointer + __rseq_offset);
+    const s32 CPU = Rseq->CPUId;
+    if (LIKELY(CPU >= 0))
+      return static_cast<u32>(CPU);
+  }
+#endif
+  const int CPU = sched_getcpu();
+  return CPU < 0 ? 0U : static_cast<u32>(CPU);
+}
+
 u32 getThreadID() {
 #if SCUDO_ANDROID
   return static_cast<u32>(gettid());
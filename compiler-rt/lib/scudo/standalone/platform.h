@@ -47,6 +47,19 @@
 #define SCUDO_CAN_USE_PRIMARY64 (SCUDO_WORDSIZE == 64U)
 #endif
 
+// Whether the default configuration caches blocks per CPU rather than per
+// thread, which saves memory and keeps throughput with many more threads than
+// CPUs.
+#ifndef SCUDO_USE_PER_CPU_TSDS
+#define SCUDO_USE_PER_CPU_TSDS 0
+#endif
+
+// Whether the Primary of the default configuration is backed by transparent
+// huge pages, which trades some RSS for fewer TLB misses.
+#ifndef SCUDO_USE_HUGE_PAGES
+#define SCUDO_USE_HUGE_PAGES 0
+#endif
+
 #ifndef SCUDO_MIN_ALIGNMENT_LOG
 // We force malloc-type functions to be aligned to std::max_align_t, but there
 // is no reason why the minimum alignment for all other functions can't be 8
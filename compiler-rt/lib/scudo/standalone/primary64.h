@@ -39,17 +39,22 @@ namespace scudo {
 //
 // The memory used by this allocator is never unmapped, but can be partially
 // released if the platform allows for it.
+//
+// With UseHugePages, Regions start on a huge page boundary, are mapped in
+// huge page increments and advised to be backed by transparent huge pages.
+// Memory is then only released to the OS in whole huge pages, so that a
+// release never splits one.
 
 template <class SizeClassMapT, uptr RegionSizeLog,
           s32 MinReleaseToOsIntervalMs = INT32_MIN,
           s32 MaxReleaseToOsIntervalMs = INT32_MAX,
-          bool MaySupportMemoryTagging = false>
+          bool MaySupportMemoryTagging = false, bool UseHugePages = false>
 class SizeClassAllocator64 {
 public:
   typedef SizeClassMapT SizeClassMap;
   typedef SizeClassAllocator64<
       SizeClassMap, RegionSizeLog, MinReleaseToOsIntervalMs,
-      MaxReleaseToOsIntervalMs, MaySupportMemoryTagging>
+      MaxReleaseToOsIntervalMs, MaySupportMemoryTagging, UseHugePages>
       ThisT;
   typedef SizeClassAllocatorLocalCache<ThisT> CacheT;
   typedef typename CacheT::TransferBatch TransferBatch;
@@ -74,11 +79,15 @@ public:
     if (UNLIKELY(!getRandom(reinterpret_cast<void *>(&Seed), sizeof(Seed))))
       Seed = static_cast<u32>(Time ^ (PrimaryBase >> 12));
     const uptr PageSize = getPageSizeCached();
+    const uptr RegionAlignment = UseHugePages ? HugePageSize : PageSize;
     for (uptr I = 0; I < NumClasses; I++) {
       RegionInfo *Region = getRegionInfo(I);
-      // The actual start of a region is offseted by a random number of pages.
+      // The actual start of a region is offseted by a random number of pages
+      // (or huge pages).
       Region->RegionBeg =
-          getRegionBaseByClassId(I) + (getRandomModN(&Seed, 16) + 1) * PageSize;
+          roundUpTo(getRegionBaseByClassId(I) +
+                        (getRandomModN(&Seed, 16) + 1) * RegionAlignment,
+                    RegionAlignment);
       Region->RandState = getRandomU32(&Seed);
       // Releasing smaller size classes doesn't necessarily yield to a
       // meaningful RSS impact: there are more blocks per page, they are
@@ -270,8 +279,13 @@ private:
   static const uptr NumClasses = SizeClassMap::NumClasses;
   static const uptr PrimarySize = RegionSize * NumClasses;
 
+  // Size of the transparent huge pages backing the Regions with UseHugePages.
+  static const uptr HugePageSize = 1UL << 21;
+  static_assert(!UseHugePages || RegionSizeLog >= 26U,
+                "Regions must fit their random offset");
+
   // Call map for user memory with at least this size.
-  static const uptr MapSizeIncrement = 1UL << 18;
+  static const uptr MapSizeIncrement = UseHugePages ? HugePageSize : 1UL << 18;
   // Fill at most this number of batches from the newly map'd memory.
   static const u32 MaxNumBatches = SCUDO_ANDROID ? 4U : 8U;
 
@@ -351,7 +365,8 @@ private:
       if (!map(reinterpret_cast<void *>(RegionBeg + MappedUser), UserMapSize,
                "scudo:primary",
                MAP_ALLOWNOMEM | MAP_RESIZABLE |
-                   (useMemoryTagging(Options.load()) ? MAP_MEMTAG : 0),
+                   (useMemoryTagging(Options.load()) ? MAP_MEMTAG : 0) |
+                   (UseHugePages ? MAP_HUGEPAGE : 0),
                &Region->Data))
         return nullptr;
       Region->MappedUser += UserMapSize;
@@ -416,17 +431,19 @@ private:
                                  bool Force = false) {
     const uptr BlockSize = getSizeByClassId(ClassId);
     const uptr PageSize = getPageSizeCached();
+    // The smallest amount of memory that can be released.
+    const uptr ReleaseGranularity = UseHugePages ? HugePageSize : PageSize;
 
     CHECK_GE(Region->Stats.PoppedBlocks, Region->Stats.PushedBlocks);
     const uptr BytesInFreeList =
         Region->AllocatedUser -
         (Region->Stats.PoppedBlocks - Region->Stats.PushedBlocks) * BlockSize;
-    if (BytesInFreeList < PageSize)
+    if (BytesInFreeList < ReleaseGranularity)
       return 0; // No chance to release anything.
     const uptr BytesPushed = (Region->Stats.PushedBlocks -
                               Region->ReleaseInfo.PushedBlocksAtLastRelease) *
                              BlockSize;
-    if (BytesPushed < PageSize)
+    if (BytesPushed < ReleaseGranularity)
       return 0; // Nothing new to release.
 
     // Releasing smaller blocks is expensive, so we want to make sure that a
@@ -456,7 +473,7 @@ private:
     ReleaseRecorder Recorder(Region->RegionBeg, &Region->Data);
     releaseFreeMemoryToOS(Region->FreeList, Region->RegionBeg,
                           Region->AllocatedUser, 1U, BlockSize, &Recorder,
-                          SkipRegion);
+                          SkipRegion, ReleaseGranularity);
 
     if (Recorder.getReleasedRangesCount() > 0) {
       Region->ReleaseInfo.PushedBlocksAtLastRelease =
@@ -139,26 +139,44 @@ private:
   static uptr StaticBuffer[StaticBufferCount];
 };
 
+// Turns the sequence of pages reported free into ranges to release. When a
+// Granularity larger than a page is given, only granules (aligned relative to
+// the first page) that are free in their entirety are released, so that huge
+// pages backing the memory are never split. Runs of adjacent free granules are
+// reported as a single range.
 template <class ReleaseRecorderT> class FreePagesRangeTracker {
 public:
-  explicit FreePagesRangeTracker(ReleaseRecorderT *Recorder)
-      : Recorder(Recorder), PageSizeLog(getLog2(getPageSizeCached())) {}
+  explicit FreePagesRangeTracker(ReleaseRecorderT *Recorder,
+                                 uptr Granularity = 0)
+      : Recorder(Recorder), PageSizeLog(getLog2(getPageSizeCached())),
+        GranuleMask((Max(Granularity, getPageSizeCached()) >> PageSizeLog) -
+                    1) {
+    DCHECK(isPowerOfTwo(GranuleMask + 1));
+  }
 
   void processNextPage(bool Freed) {
-    if (Freed) {
+    GranuleFreed &= Freed;
+    CurrentPage++;
+    if ((CurrentPage & GranuleMask) != 0)
+      return;
+    if (GranuleFreed) {
       if (!InRange) {
-        CurrentRangeStatePage = CurrentPage;
+        CurrentRangeStatePage = CurrentPage - (GranuleMask + 1);
         InRange = true;
       }
+      CurrentRangeEndPage = CurrentPage;
     } else {
       closeOpenedRange();
     }
-    CurrentPage++;
+    GranuleFreed = true;
   }
 
   void skipPages(uptr N) {
     closeOpenedRange();
     CurrentPage += N;
+    // A granule partially skipped can't be released.
+    if (N)
+      GranuleFreed = (CurrentPage & GranuleMask) == 0;
   }
 
   void finish() { closeOpenedRange(); }
@@ -167,23 +185,27 @@ private:
   void closeOpenedRange() {
     if (InRange) {
       Recorder->releasePageRangeToOS((CurrentRangeStatePage << PageSizeLog),
-                                     (CurrentPage << PageSizeLog));
+                                     (CurrentRangeEndPage << PageSizeLog));
       InRange = false;
     }
   }
 
   ReleaseRecorderT *const Recorder;
   const uptr PageSizeLog;
+  const uptr GranuleMask;
   bool InRange = false;
+  bool GranuleFreed = true;
   uptr CurrentPage = 0;
   uptr CurrentRangeStatePage = 0;
+  uptr CurrentRangeEndPage = 0;
 };
 
 template <class TransferBatchT, class ReleaseRecorderT, typename SkipRegionT>
 NOINLINE void
 releaseFreeMemoryToOS(const IntrusiveList<TransferBatchT> &FreeList, uptr Base,
                       uptr RegionSize, uptr NumberOfRegions, uptr BlockSize,
-                      ReleaseRecorderT *Recorder, SkipRegionT SkipRegion) {
+                      ReleaseRecorderT *Recorder, SkipRegionT SkipRegion,
+                      uptr ReleaseGranularity = 0) {
   const uptr PageSize = getPageSizeCached();
 
   // Figure out the number of chunks per page and whether we can take a fast
@@ -285,7 +307,8 @@ releaseFreeMemoryToOS(const IntrusiveList<TransferBatchT> &FreeList, uptr Base,
 
   // Iterate over pages detecting ranges of pages with chunk Counters equal
   // to the expected number of chunks for the particular page.
-  FreePagesRangeTracker<ReleaseRecorderT> RangeTracker(Recorder);
+  FreePagesRangeTracker<ReleaseRecorderT> RangeTracker(Recorder,
+                                                       ReleaseGranularity);
   if (SameBlockCountPerPage) {
     // Fast path, every page has the same number of chunks affecting it.
     for (uptr I = 0; I < NumberOfRegions; I++) {
@@ -60,6 +60,8 @@ TEST(ScudoPrimaryTest, BasicPrimary) {
   testPrimary<scudo::SizeClassAllocator64<SizeClassMap, 24U>>();
   testPrimary<scudo::SizeClassAllocator64<SizeClassMap, 24U, INT32_MIN,
                                           INT32_MAX, true>>();
+  testPrimary<scudo::SizeClassAllocator64<SizeClassMap, 26U, INT32_MIN,
+                                          INT32_MAX, false, true>>();
 }
 
 // The 64-bit SizeClassAllocator can be easily OOM'd with small region sizes.
@@ -242,3 +244,33 @@ TEST(ScudoPrimaryTest, ReleaseToOS) {
   testReleaseToOS<scudo::SizeClassAllocator64<SizeClassMap, 24U, INT32_MIN,
                                               INT32_MAX, true>>();
 }
+
+// Memory of a Primary backed by huge pages is released in whole huge pages.
+TEST(ScudoPrimaryTest, ReleaseToOSHugePages) {
+  using Primary =
+      scudo::SizeClassAllocator64<scudo::DefaultSizeClassMap, 26U, INT32_MIN,
+                                  INT32_MAX, false, true>;
+  auto Deleter = [](Primary *P) {
+    P->unmapTestOnly();
+    delete P;
+  };
+  std::unique_ptr<Primary, decltype(Deleter)> Allocator(new Primary, Deleter);
+  Allocator->init(/*ReleaseToOsInterval=*/-1);
+  typename Primary::CacheT Cache;
+  Cache.init(nullptr, Allocator.get());
+  const scudo::uptr Size = scudo::getPageSizeCached() * 2;
+  const scudo::uptr ClassId = Primary::SizeClassMap::getClassIdBySize(Size);
+  const scudo::uptr HugePageSize = 1UL << 21;
+  std::vector<void *> V;
+  for (scudo::uptr I = 0; I < 4 * HugePageSize / Size; I++) {
+    void *P = Cache.allocate(ClassId);
+    EXPECT_NE(P, nullptr);
+    V.push_back(P);
+  }
+  for (void *P : V)
+    Cache.deallocate(ClassId, P);
+  Cache.destroy(nullptr);
+  const scudo::uptr Released = Allocator->releaseToOS();
+  EXPECT_GE(Released, 2 * HugePageSize);
+  EXPECT_EQ(Released % HugePageSize, 0U);
+}
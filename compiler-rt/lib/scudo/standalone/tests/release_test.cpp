@@ -115,6 +115,32 @@ TEST(ScudoReleaseTest, FreePagesRangeTracker) {
   }
 }
 
+TEST(ScudoReleaseTest, FreePagesRangeTrackerGranularity) {
+  // With a granularity of 4 pages, only fully free granules are released, and
+  // adjacent ones are released as a single range.
+  const char *TestCases[][2] = {
+      {"xxx", ""},
+      {"xxxx", "xxxx"},
+      {"xxxxxxx", "xxxx"},
+      {".xxxxxxx", "....xxxx"},
+      {"xxxxxxxxxxxx", "xxxxxxxxxxxx"},
+      {"xxxx.xxxxxxxxxxx", "xxxx....xxxxxxxx"},
+      {"x.x.x.x.x.x.x.x.", ""},
+      {"..xxxxxx..xxxxxxxxxx", "....xxxx....xxxxxxxx"},
+  };
+  typedef scudo::FreePagesRangeTracker<StringRangeRecorder> RangeTracker;
+  const scudo::uptr Granularity = 4 * scudo::getPageSizeCached();
+
+  for (auto TestCase : TestCases) {
+    StringRangeRecorder Recorder;
+    RangeTracker Tracker(&Recorder, Granularity);
+    for (scudo::uptr I = 0; TestCase[0][I] != 0; I++)
+      Tracker.processNextPage(TestCase[0][I] == 'x');
+    Tracker.finish();
+    EXPECT_STREQ(TestCase[1], Recorder.ReportedPages.c_str());
+  }
+}
+
 class ReleasedPagesRecorder {
 public:
   std::set<scudo::uptr> ReportedPages;
@@ -9,6 +9,7 @@
 #include "tests/scudo_unit_test.h"
 
 #include "tsd_exclusive.h"
+#include "tsd_per_cpu.h"
 #include "tsd_shared.h"
 
 #include <condition_variable>
@@ -16,6 +17,10 @@
 #include <set>
 #include <thread>
 
+#if SCUDO_LINUX
+#include <sched.h>
+#endif
+
 // We mock out an allocator with a TSD registry, mostly using empty stubs. The
 // cache contains a single volatile uptr, to be able to test that several
 // concurrent threads will not access or modify the same cache at the same time.
@@ -61,6 +66,11 @@ struct ExclusiveCaches {
   using TSDRegistryT = scudo::TSDRegistryExT<Allocator>;
 };
 
+struct PerCPUCaches {
+  template <class Allocator>
+  using TSDRegistryT = scudo::TSDRegistryPerCPUT<Allocator, 4U>;
+};
+
 TEST(ScudoTSDTest, TSDRegistryInit) {
   using AllocatorT = MockAllocator<OneCache>;
   auto Deleter = [](AllocatorT *A) {
@@ -110,6 +120,7 @@ template <class AllocatorT> static void testRegistry() {
 TEST(ScudoTSDTest, TSDRegistryBasic) {
   testRegistry<MockAllocator<OneCache>>();
   testRegistry<MockAllocator<SharedCaches>>();
+  testRegistry<MockAllocator<PerCPUCaches>>();
 #if !SCUDO_FUCHSIA
   testRegistry<MockAllocator<ExclusiveCaches>>();
 #endif
@@ -169,6 +180,7 @@ template <class AllocatorT> static void testRegistryThreaded() {
 TEST(ScudoTSDTest, TSDRegistryThreaded) {
   testRegistryThreaded<MockAllocator<OneCache>>();
   testRegistryThreaded<MockAllocator<SharedCaches>>();
+  testRegistryThreaded<MockAllocator<PerCPUCaches>>();
 #if !SCUDO_FUCHSIA
   testRegistryThreaded<MockAllocator<ExclusiveCaches>>();
 #endif
@@ -243,3 +255,45 @@ TEST(ScudoTSDTest, TSDRegistryTSDsCount) {
   // We should get 16 distinct TSDs back.
   EXPECT_EQ(Pointers.size(), 16U);
 }
+
+#if SCUDO_LINUX
+TEST(ScudoTSDTest, TSDRegistryPerCPU) {
+  using AllocatorT = MockAllocator<PerCPUCaches>;
+  auto Deleter = [](AllocatorT *A) {
+    A->unmapTestOnly();
+    delete A;
+  };
+  std::unique_ptr<AllocatorT, decltype(Deleter)> Allocator(new AllocatorT,
+                                                           Deleter);
+  Allocator->reset();
+  auto Registry = Allocator->getTSDRegistry();
+  Registry->initThreadMaybe(Allocator.get(), /*MinimalInit=*/false);
+
+  cpu_set_t Original;
+  ASSERT_EQ(sched_getaffinity(0, sizeof(Original), &Original), 0);
+  // Threads running on the same CPU get the same TSD, and threads running on
+  // CPUs that map to different TSDs do not.
+  std::set<void *> TSDs;
+  std::set<int> Slots;
+  for (int CPU = 0; CPU < CPU_SETSIZE && Slots.size() < 4U; CPU++) {
+    if (!CPU_ISSET(CPU, &Original))
+      continue;
+    cpu_set_t One;
+    CPU_ZERO(&One);
+    CPU_SET(CPU, &One);
+    if (sched_setaffinity(0, sizeof(One), &One) != 0)
+      continue;
+    EXPECT_EQ(scudo::getCurrentCPU(), static_cast<scudo::u32>(CPU));
+    bool UnlockRequired;
+    auto TSD = Registry->getTSDAndLock(&UnlockRequired);
+    EXPECT_TRUE(UnlockRequired);
+    TSD->unlock();
+    EXPECT_EQ(Registry->getTSDAndLock(&UnlockRequired), TSD);
+    TSD->unlock();
+    TSDs.insert(TSD);
+    Slots.insert(CPU % 4);
+  }
+  ASSERT_EQ(sched_setaffinity(0, sizeof(Original), &Original), 0);
+  EXPECT_EQ(TSDs.size(), Slots.size());
+}
+#endif
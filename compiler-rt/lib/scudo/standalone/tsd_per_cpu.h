@@ -0,0 +1,104 @@
+//===-- tsd_per_cpu.h -------------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SCUDO_TSD_PER_CPU_H_
+#define SCUDO_TSD_PER_CPU_H_
+
+#include "tsd.h"
+
+namespace scudo {
+
+// A registry that hands each allocation the TSD of the CPU it runs on, rather
+// than one assigned to the thread. Any number of threads then share as many
+// caches as there are CPUs, and the lock of a TSD is only contended when its
+// owner was preempted or migrated while holding it, or when there are more
+// CPUs than TSDs.
+template <class Allocator, u32 TSDsArraySize> struct TSDRegistryPerCPUT {
+  void initLinkerInitialized(Allocator *Instance) {
+    Instance->initLinkerInitialized();
+    for (u32 I = 0; I < TSDsArraySize; I++)
+      TSDs[I].initLinkerInitialized(Instance);
+    Initialized = true;
+  }
+  void init(Allocator *Instance) {
+    memset(this, 0, sizeof(*this));
+    initLinkerInitialized(Instance);
+  }
+
+  void unmapTestOnly() { *getTlsPtr() = 0; }
+
+  ALWAYS_INLINE void initThreadMaybe(Allocator *Instance,
+                                     UNUSED bool MinimalInit) {
+    if (LIKELY(*getTlsPtr() & ThreadInitialized))
+      return;
+    initThread(Instance);
+  }
+
+  ALWAYS_INLINE TSD<Allocator> *getTSDAndLock(bool *UnlockRequired) {
+    *UnlockRequired = true;
+    TSD<Allocator> *TSD = &TSDs[getCurrentCPU() % TSDsArraySize];
+    TSD->lock();
+    return TSD;
+  }
+
+  void disable() {
+    Mutex.lock();
+    for (u32 I = 0; I < TSDsArraySize; I++)
+      TSDs[I].lock();
+  }
+
+  void enable() {
+    for (s32 I = static_cast<s32>(TSDsArraySize - 1); I >= 0; I--)
+      TSDs[I].unlock();
+    Mutex.unlock();
+  }
+
+  bool setOption(Option O, sptr Value) {
+    if (O == Option::ThreadDisableMemInit)
+      setDisableMemInit(Value);
+    // Not supported by the TSD Registry, but not an error either.
+    return true;
+  }
+
+  bool getDisableMemInit() const { return *getTlsPtr() & DisableMemInit; }
+
+private:
+  static const uptr DisableMemInit = 1U << 0;
+  static const uptr ThreadInitialized = 1U << 1;
+
+  ALWAYS_INLINE uptr *getTlsPtr() const {
+    static thread_local uptr ThreadState;
+    return &ThreadState;
+  }
+
+  void setDisableMemInit(bool B) {
+    *getTlsPtr() &= ~DisableMemInit;
+    *getTlsPtr() |= B ? DisableMemInit : 0;
+  }
+
+  void initOnceMaybe(Allocator *Instance) {
+    ScopedLock L(Mutex);
+    if (LIKELY(Initialized))
+      return;
+    initLinkerInitialized(Instance); // Sets Initialized.
+  }
+
+  NOINLINE void initThread(Allocator *Instance) {
+    initOnceMaybe(Instance);
+    *getTlsPtr() |= ThreadInitialized;
+    Instance->callPostInitCallback();
+  }
+
+  bool Initialized;
+  HybridMutex Mutex;
+  TSD<Allocator> TSDs[TSDsArraySize];
+};
+
+} // namespace scudo
+
+#endif // SCUDO_TSD_PER_CPU_H_
@@ -94,6 +94,14 @@ static atomic_uint32_t *ref_ptr(ClockBlock *cb) {
   return reinterpret_cast<atomic_uint32_t *>(&cb->table[ClockBlock::kRefIdx]);
 }
 
+static atomic_uint32_t *block_ptr(ClockBlock *cb, uptr bi) {
+  return reinterpret_cast<atomic_uint32_t *>(
+      &cb->table[ClockBlock::kBlockIdx - bi]);
+}
+
+// What the elements of second level blocks that are not allocated read as.
+static const ClockElem kZeroClock[ClockBlock::kClockCount] = {};
+
 // Drop reference to the first level block idx.
 static void UnrefClockBlock(ClockCache *c, u32 idx, uptr blocks) {
   ClockBlock *cb = ctx->clock_alloc.Map(idx);
@@ -107,8 +115,11 @@ static void UnrefClockBlock(ClockCache *c, u32 idx, uptr blocks) {
       return;
   }
   // First level block owns second level blocks, so them as well.
-  for (uptr i = 0; i < blocks; i++)
-    ctx->clock_alloc.Free(c, cb->table[ClockBlock::kBlockIdx - i]);
+  for (uptr i = 0; i < blocks; i++) {
+    u32 block = atomic_load_relaxed(block_ptr(cb, i));
+    if (block)
+      ctx->clock_alloc.Free(c, block);
+  }
   ctx->clock_alloc.Free(c, idx);
 }
 
@@ -164,19 +175,25 @@ void ThreadClock::acquire(ClockCache *c, SyncClock *src) {
     // O(N) acquire.
     CPP_STAT_INC(StatClockAcquireFull);
     nclk_ = max(nclk_, nclk);
-    u64 *dst_pos = &clk_[0];
-    for (ClockElem &src_elem : *src) {
-      u64 epoch = src_elem.epoch;
-      if (*dst_pos < epoch) {
-        *dst_pos = epoch;
-        acquired = true;
+    for (uptr ri = 0; ri < src->nranges(); ri++) {
+      // Nothing to acquire from blocks that are not allocated.
+      const ClockElem *src_pos = src->range(ri);
+      if (!src_pos)
+        continue;
+      u64 *dst_pos = &clk_[ri * ClockBlock::kClockCount];
+      const u64 *dst_end = dst_pos + src->range_size(ri);
+      for (; dst_pos < dst_end; dst_pos++, src_pos++) {
+        u64 epoch = src_pos->epoch;
+        if (*dst_pos < epoch) {
+          *dst_pos = epoch;
+          acquired = true;
+        }
       }
-      dst_pos++;
     }
 
     // Remember that this thread has acquired this clock.
     if (nclk > tid_)
-      src->elem(tid_).reused = reused_;
+      src->elem_alloc(c, tid_).reused = reused_;
   }
 
   if (acquired) {
@@ -207,17 +224,26 @@ void ThreadClock::releaseStoreAcquire(ClockCache *c, SyncClock *sc) {
 
   sc->Unshare(c);
   // Update sc->clk_.
-  sc->FlushDirty();
-  uptr i = 0;
-  for (ClockElem &ce : *sc) {
-    u64 tmp = clk_[i];
-    if (clk_[i] < ce.epoch) {
-      clk_[i] = ce.epoch;
-      acquired = true;
+  sc->FlushDirty(c);
+  for (uptr ri = 0; ri < sc->nranges(); ri++) {
+    const uptr first = ri * ClockBlock::kClockCount;
+    const uptr n = sc->range_size(ri);
+    ClockElem *ce = sc->range(ri);
+    if (!ce) {
+      // Both clocks are zero, there is nothing to exchange.
+      if (IsZeroRange(first, n))
+        continue;
+      ce = sc->alloc_range(c, ri);
+    }
+    for (uptr i = first; i < first + n; i++, ce++) {
+      u64 tmp = clk_[i];
+      if (clk_[i] < ce->epoch) {
+        clk_[i] = ce->epoch;
+        acquired = true;
+      }
+      ce->epoch = tmp;
+      ce->reused = 0;
     }
-    ce.epoch = tmp;
-    ce.reused = 0;
-    i++;
   }
   sc->release_store_tid_ = kInvalidTid;
   sc->release_store_reused_ = 0;
@@ -264,12 +290,20 @@ void ThreadClock::release(ClockCache *c, SyncClock *dst) {
   if (acquired)
     CPP_STAT_INC(StatClockReleaseAcquired);
   // Update dst->clk_.
-  dst->FlushDirty();
-  uptr i = 0;
-  for (ClockElem &ce : *dst) {
-    ce.epoch = max(ce.epoch, clk_[i]);
-    ce.reused = 0;
-    i++;
+  dst->FlushDirty(c);
+  for (uptr ri = 0; ri < dst->nranges(); ri++) {
+    const uptr first = ri * ClockBlock::kClockCount;
+    const uptr n = dst->range_size(ri);
+    ClockElem *ce = dst->range(ri);
+    if (!ce) {
+      if (IsZeroRange(first, n))
+        continue;
+      ce = dst->alloc_range(c, ri);
+    }
+    for (uptr i = first; i < first + n; i++, ce++) {
+      ce->epoch = max(ce->epoch, clk_[i]);
+      ce->reused = 0;
+    }
   }
   // Clear 'acquired' flag in the remaining elements.
   if (nclk_ < dst->size_)
@@ -279,7 +313,7 @@ void ThreadClock::release(ClockCache *c, SyncClock *dst) {
   // If we've acquired dst, remember this fact,
   // so that we don't need to acquire it on next acquire.
   if (acquired)
-    dst->elem(tid_).reused = reused_;
+    dst->elem_alloc(c, tid_).reused = reused_;
 }
 
 void ThreadClock::ReleaseStore(ClockCache *c, SyncClock *dst) {
@@ -307,7 +341,7 @@ void ThreadClock::ReleaseStore(ClockCache *c, SyncClock *dst) {
     dst->release_store_tid_ = tid_;
     dst->release_store_reused_ = reused_;
     // Rememeber that we don't need to acquire it in future.
-    dst->elem(tid_).reused = reused_;
+    dst->elem_alloc(c, tid_).reused = reused_;
     // Grab a reference.
     atomic_fetch_add(ref_ptr(dst->tab_), 1, memory_order_relaxed);
     return;
@@ -330,18 +364,31 @@ void ThreadClock::ReleaseStore(ClockCache *c, SyncClock *dst) {
   dst->Unshare(c);
   // Note: dst can be larger than this ThreadClock.
   // This is fine since clk_ beyond size is all zeros.
-  uptr i = 0;
-  for (ClockElem &ce : *dst) {
-    ce.epoch = clk_[i];
-    ce.reused = 0;
-    i++;
+  for (uptr ri = 0; ri < dst->nranges(); ri++) {
+    const uptr first = ri * ClockBlock::kClockCount;
+    const uptr n = dst->range_size(ri);
+    ClockElem *ce = dst->range(ri);
+    if (IsZeroRange(first, n)) {
+      // Second level blocks that become zero are dropped.
+      if (ri < dst->blocks_)
+        dst->free_range(c, ri);
+      else
+        internal_memset(ce, 0, n * sizeof(*ce));
+      continue;
+    }
+    if (!ce)
+      ce = dst->alloc_range(c, ri);
+    for (uptr i = first; i < first + n; i++, ce++) {
+      ce->epoch = clk_[i];
+      ce->reused = 0;
+    }
   }
   for (uptr i = 0; i < kDirtyTids; i++)
     dst->dirty_[i].tid = kInvalidTid;
   dst->release_store_tid_ = tid_;
   dst->release_store_reused_ = reused_;
   // Rememeber that we don't need to acquire it in future.
-  dst->elem(tid_).reused = reused_;
+  dst->elem_alloc(c, tid_).reused = reused_;
 
   // If the resulting clock is cachable, cache it for future release operations.
   // The clock is always cachable if we released to an empty sync object.
@@ -381,10 +428,15 @@ void ThreadClock::UpdateCurrentThread(ClockCache *c, SyncClock *dst) const {
   // We are going to touch dst elements, so we need to unshare it.
   dst->Unshare(c);
   CPP_STAT_INC(StatClockReleaseSlow);
-  dst->elem(tid_).epoch = clk_[tid_];
-  for (uptr i = 0; i < dst->size_; i++)
-    dst->elem(i).reused = 0;
-  dst->FlushDirty();
+  dst->elem_alloc(c, tid_).epoch = clk_[tid_];
+  for (uptr ri = 0; ri < dst->nranges(); ri++) {
+    ClockElem *ce = dst->range(ri);
+    if (!ce)
+      continue;
+    for (uptr i = 0, n = dst->range_size(ri); i < n; i++)
+      ce[i].reused = 0;
+  }
+  dst->FlushDirty(c);
 }
 
 // Checks whether the current thread has already acquired src.
@@ -401,6 +453,17 @@ bool ThreadClock::IsAlreadyAcquired(const SyncClock *src) const {
   return true;
 }
 
+// Checks whether the clock elements [first, first + n) are all zero.
+bool ThreadClock::IsZeroRange(uptr first, uptr n) const {
+  if (first >= nclk_)
+    return true;
+  for (uptr i = first; i < first + n; i++) {
+    if (clk_[i])
+      return false;
+  }
+  return true;
+}
+
 // Checks whether the current thread has acquired anything
 // from other clocks after releasing to dst (directly or indirectly).
 bool ThreadClock::HasAcquiredAfterRelease(const SyncClock *dst) const {
@@ -477,35 +540,41 @@ void SyncClock::Resize(ClockCache *c, uptr nclk) {
     atomic_store_relaxed(ref_ptr(tab_), 1);
     size_ = 1;
   } else if (size_ > blocks_ * ClockBlock::kClockCount) {
-    u32 idx = ctx->clock_alloc.Alloc(c);
-    ClockBlock *new_cb = ctx->clock_alloc.Map(idx);
     uptr top = size_ - blocks_ * ClockBlock::kClockCount;
     CHECK_LT(top, ClockBlock::kClockCount);
     const uptr move = top * sizeof(tab_->clock[0]);
-    internal_memcpy(&new_cb->clock[0], tab_->clock, move);
-    internal_memset(&new_cb->clock[top], 0, sizeof(*new_cb) - move);
+    // There is no need for a second level block if the elements are all zero.
+    u32 idx = 0;
+    for (uptr i = 0; i < top; i++) {
+      if (tab_->clock[i].epoch || tab_->clock[i].reused) {
+        idx = ctx->clock_alloc.Alloc(c);
+        break;
+      }
+    }
+    if (idx) {
+      ClockBlock *new_cb = ctx->clock_alloc.Map(idx);
+      internal_memcpy(&new_cb->clock[0], tab_->clock, move);
+      internal_memset(&new_cb->clock[top], 0, sizeof(*new_cb) - move);
+    }
     internal_memset(tab_->clock, 0, move);
     append_block(idx);
   }
   // At this point we have first level table allocated and all clock elements
   // are evacuated from it to a second level block.
-  // Add second level tables as necessary.
-  while (nclk > capacity()) {
-    u32 idx = ctx->clock_alloc.Alloc(c);
-    ClockBlock *cb = ctx->clock_alloc.Map(idx);
-    internal_memset(cb, 0, sizeof(*cb));
-    append_block(idx);
-  }
+  // Add second level tables as necessary, they are allocated once an element
+  // in them is set.
+  while (nclk > capacity())
+    append_block(0);
   size_ = nclk;
 }
 
 // Flushes all dirty elements into the main clock array.
-void SyncClock::FlushDirty() {
+void SyncClock::FlushDirty(ClockCache *c) {
   for (unsigned i = 0; i < kDirtyTids; i++) {
     Dirty *dirty = &dirty_[i];
     if (dirty->tid != kInvalidTid) {
       CHECK_LT(dirty->tid, size_);
-      elem(dirty->tid).epoch = dirty->epoch;
+      elem_alloc(c, dirty->tid).epoch = dirty->epoch;
       dirty->tid = kInvalidTid;
     }
   }
@@ -540,11 +609,13 @@ void SyncClock::Unshare(ClockCache *c) {
   ResetImpl();
   // Allocate brand new clock in the current object.
   Resize(c, old.size_);
-  // Now copy state back into this object.
-  Iter old_iter(&old);
-  for (ClockElem &ce : *this) {
-    ce = *old_iter;
-    ++old_iter;
+  // Now copy state back into this object. The layout only depends on the size,
+  // so the ranges of both clocks match.
+  DCHECK_EQ(blocks_, old.blocks_);
+  for (uptr ri = 0; ri < nranges(); ri++) {
+    const ClockElem *ce = old.range(ri);
+    if (ce)
+      internal_memcpy(alloc_range(c, ri), ce, range_size(ri) * sizeof(*ce));
   }
   release_store_tid_ = old.release_store_tid_;
   release_store_reused_ = old.release_store_reused_;
@@ -566,18 +637,71 @@ ALWAYS_INLINE bool SyncClock::Cachable() const {
 }
 
 // elem linearizes the two-level structure into linear array.
-// Note: this is used only for one time accesses, vector operations use
-// the iterator as it is much faster.
-ALWAYS_INLINE ClockElem &SyncClock::elem(unsigned tid) const {
+// Note: this is used only for one time accesses, vector operations go over
+// the ranges as it is much faster.
+ALWAYS_INLINE const ClockElem &SyncClock::elem(unsigned tid) const {
+  DCHECK_LT(tid, size_);
+  const uptr block = tid / ClockBlock::kClockCount;
+  DCHECK_LE(block, blocks_);
+  const ClockElem *elems = range(block);
+  if (!elems)
+    return kZeroClock[0];
+  return elems[tid % ClockBlock::kClockCount];
+}
+
+// Same as elem, but for updates: allocates the block of the element if needed.
+ALWAYS_INLINE ClockElem &SyncClock::elem_alloc(ClockCache *c, unsigned tid) {
   DCHECK_LT(tid, size_);
   const uptr block = tid / ClockBlock::kClockCount;
   DCHECK_LE(block, blocks_);
-  tid %= ClockBlock::kClockCount;
-  if (block == blocks_)
-    return tab_->clock[tid];
-  u32 idx = get_block(block);
+  return alloc_range(c, block)[tid % ClockBlock::kClockCount];
+}
+
+ALWAYS_INLINE uptr SyncClock::nranges() const {
+  return blocks_ + (size_ > blocks_ * ClockBlock::kClockCount ? 1 : 0);
+}
+
+ALWAYS_INLINE uptr SyncClock::range_size(uptr ri) const {
+  DCHECK_LT(ri, nranges());
+  return min(size_ - ri * ClockBlock::kClockCount, ClockBlock::kClockCount);
+}
+
+ALWAYS_INLINE ClockElem *SyncClock::range(uptr ri) const {
+  DCHECK_LE(ri, blocks_);
+  if (ri == blocks_)
+    return tab_->clock;
+  u32 idx = get_block(ri);
+  if (!idx)
+    return nullptr;
+  return ctx->clock_alloc.Map(idx)->clock;
+}
+
+ClockElem *SyncClock::alloc_range(ClockCache *c, uptr ri) {
+  ClockElem *elems = range(ri);
+  if (elems)
+    return elems;
+  u32 idx = ctx->clock_alloc.Alloc(c);
   ClockBlock *cb = ctx->clock_alloc.Map(idx);
-  return cb->clock[tid];
+  internal_memset(cb, 0, sizeof(*cb));
+  // Acquire may allocate the block while holding only a shared lock, so
+  // another thread may have done it in the meantime.
+  u32 cmp = 0;
+  if (!atomic_compare_exchange_strong(block_ptr(tab_, ri), &cmp, idx,
+                                      memory_order_acq_rel)) {
+    ctx->clock_alloc.Free(c, idx);
+    cb = ctx->clock_alloc.Map(cmp);
+  }
+  return cb->clock;
+}
+
+void SyncClock::free_range(ClockCache *c, uptr ri) {
+  DCHECK_LT(ri, blocks_);
+  DCHECK(!IsShared());
+  u32 idx = get_block(ri);
+  if (idx) {
+    atomic_store_relaxed(block_ptr(tab_, ri), 0);
+    ctx->clock_alloc.Free(c, idx);
+  }
 }
 
 ALWAYS_INLINE uptr SyncClock::capacity() const {
@@ -593,13 +717,13 @@ ALWAYS_INLINE uptr SyncClock::capacity() const {
 ALWAYS_INLINE u32 SyncClock::get_block(uptr bi) const {
   DCHECK(size_);
   DCHECK_LT(bi, blocks_);
-  return tab_->table[ClockBlock::kBlockIdx - bi];
+  return atomic_load(block_ptr(tab_, bi), memory_order_acquire);
 }
 
 ALWAYS_INLINE void SyncClock::append_block(u32 idx) {
   uptr bi = blocks_++;
   CHECK_EQ(get_block(bi), 0);
-  tab_->table[ClockBlock::kBlockIdx - bi] = idx;
+  atomic_store_relaxed(block_ptr(tab_, bi), idx);
 }
 
 // Used only by tests.
@@ -635,9 +759,8 @@ void SyncClock::Iter::Next() {
   block_++;
   if (block_ < parent_->blocks_) {
     // Iterate over the next second level block.
-    u32 idx = parent_->get_block(block_);
-    ClockBlock *cb = ctx->clock_alloc.Map(idx);
-    pos_ = &cb->clock[0];
+    const ClockElem *elems = parent_->range(block_);
+    pos_ = elems ? elems : &kZeroClock[0];
     end_ = pos_ + min(parent_->size_ - block_ * ClockBlock::kClockCount,
         ClockBlock::kClockCount);
     return;
@@ -39,18 +39,19 @@ class SyncClock {
 
   // Clock element iterator.
   // Note: it iterates only over the table without regard to dirty entries.
+  // Elements of second level blocks that are not allocated read as zeros.
   class Iter {
    public:
-    explicit Iter(SyncClock* parent);
+    explicit Iter(const SyncClock* parent);
     Iter& operator++();
     bool operator!=(const Iter& other);
-    ClockElem &operator*();
+    const ClockElem &operator*();
 
    private:
-    SyncClock *parent_;
+    const SyncClock *parent_;
     // [pos_, end_) is the current continuous range of clock elements.
-    ClockElem *pos_;
-    ClockElem *end_;
+    const ClockElem *pos_;
+    const ClockElem *end_;
     int block_;  // Current number of second level block.
 
     NOINLINE void Next();
@@ -103,6 +104,13 @@ class SyncClock {
   //                                        | clk64 ... clk127 |
   //                                        +------------------+
   //
+  // A second level block whose elements are all zero does not need to be
+  // allocated: its idx is then 0. With thousands of threads most sync objects
+  // are only touched by a few of them, so this saves both the memory and the
+  // time to scan the blocks on acquire. Blocks are allocated when an element
+  // in them is set, including by acquire which may run under a shared lock,
+  // so idx entries are only updated with atomic operations.
+  //
   // Note: dirty entries, if active, always override what's stored in the clock.
   ClockBlock *tab_;
   u32 tab_idx_;
@@ -113,11 +121,21 @@ class SyncClock {
   bool IsShared() const;
   bool Cachable() const;
   void ResetImpl();
-  void FlushDirty();
+  void FlushDirty(ClockCache *c);
   uptr capacity() const;
   u32 get_block(uptr bi) const;
   void append_block(u32 idx);
-  ClockElem &elem(unsigned tid) const;
+  const ClockElem &elem(unsigned tid) const;
+  ClockElem &elem_alloc(ClockCache *c, unsigned tid);
+
+  // The clock elements are split in ranges of up to kClockCount elements:
+  // one per second level block, and the elements in the first level block.
+  uptr nranges() const;
+  uptr range_size(uptr ri) const;
+  // Returns nullptr if the range is in a block that is not allocated.
+  ClockElem *range(uptr ri) const;
+  ClockElem *alloc_range(ClockCache *c, uptr ri);
+  void free_range(ClockCache *c, uptr ri);
 };
 
 // The clock that lives in threads.
@@ -213,6 +231,7 @@ class ThreadClock {
   u64 clk_[kMaxTidInClock];  // Fixed size vector clock.
 
   bool IsAlreadyAcquired(const SyncClock *src) const;
+  bool IsZeroRange(uptr first, uptr n) const;
   bool HasAcquiredAfterRelease(const SyncClock *dst) const;
   void UpdateCurrentThread(ClockCache *c, SyncClock *dst) const;
 };
@@ -255,7 +274,7 @@ ALWAYS_INLINE uptr SyncClock::size() const {
   return size_;
 }
 
-ALWAYS_INLINE SyncClock::Iter::Iter(SyncClock* parent)
+ALWAYS_INLINE SyncClock::Iter::Iter(const SyncClock* parent)
     : parent_(parent)
     , pos_(nullptr)
     , end_(nullptr)
@@ -275,7 +294,7 @@ ALWAYS_INLINE bool SyncClock::Iter::operator!=(const SyncClock::Iter& other) {
   return parent_ != other.parent_;
 }
 
-ALWAYS_INLINE ClockElem &SyncClock::Iter::operator*() {
+ALWAYS_INLINE const ClockElem &SyncClock::Iter::operator*() {
   return *pos_;
 }
 }  // namespace __tsan
@@ -73,8 +73,16 @@ const unsigned kMaxTidInClock = kMaxTid;  // Go does not track freed memory.
 #endif
 const uptr kShadowStackSize = 64 * 1024;
 
-// Count of shadow values in a shadow cell.
-const uptr kShadowCnt = 4;
+// Count of shadow values in a shadow cell. A build with TSAN_SHADOW_COUNT=2
+// halves the shadow memory, at the cost of remembering fewer accesses to each
+// 8 bytes of memory, and thus possibly missing some races.
+#ifndef TSAN_SHADOW_COUNT
+# define TSAN_SHADOW_COUNT 4
+#endif
+#if TSAN_SHADOW_COUNT != 2 && TSAN_SHADOW_COUNT != 4
+# error "TSAN_SHADOW_COUNT must be 2 or 4"
+#endif
+const uptr kShadowCnt = TSAN_SHADOW_COUNT;
 
 // That many user bytes are mapped onto a single shadow cell.
 const uptr kShadowCell = 8;
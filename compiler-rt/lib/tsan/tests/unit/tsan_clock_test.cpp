@@ -67,7 +67,7 @@ TEST(Clock, Iter) {
     if (size != 0)
       vector.release(&cache, &sync);
     uptr i = 0;
-    for (ClockElem &ce : sync) {
+    for (const ClockElem &ce : sync) {
       ASSERT_LT(i, size);
       ASSERT_EQ(sync.get_clean(i), ce.epoch);
       i++;
@@ -297,6 +297,43 @@ TEST(Clock, Growth2) {
   }
 }
 
+TEST(Clock, Sparse) {
+  // Blocks of elements that are all zero are not allocated, but still read as
+  // zeros, and are allocated as elements in them are set.
+  ThreadClock vector1(1);
+  vector1.tick();
+  ThreadClock vector2(300);
+  vector2.tick();
+  SyncClock sync;
+  vector2.release(&cache, &sync);
+  ASSERT_EQ(sync.size(), 301U);
+  for (uptr i = 0; i < 300; i++)
+    ASSERT_EQ(sync.get(i), 0ULL);
+  ASSERT_EQ(sync.get(300), 1ULL);
+  vector1.acquire(&cache, &sync);
+  ASSERT_EQ(vector1.size(), 301U);
+  ASSERT_EQ(vector1.get(300), 1ULL);
+  vector1.tick();
+  vector1.release(&cache, &sync);
+  ASSERT_EQ(sync.get(1), 2ULL);
+  ASSERT_EQ(sync.get(300), 1ULL);
+  uptr i = 0;
+  for (const ClockElem &ce : sync) {
+    ASSERT_EQ(ce.epoch, i == 1 ? 2ULL : i == 300 ? 1ULL : 0ULL);
+    i++;
+  }
+  ASSERT_EQ(i, 301U);
+  // A release-store of a clock that does not have thread 1 clears it.
+  vector2.tick();
+  vector2.ReleaseStore(&cache, &sync);
+  ASSERT_EQ(sync.get(1), 0ULL);
+  ASSERT_EQ(sync.get(300), 2ULL);
+  vector1.acquire(&cache, &sync);
+  ASSERT_EQ(vector1.get(1), 2ULL);
+  ASSERT_EQ(vector1.get(300), 2ULL);
+  sync.Reset(&cache);
+}
+
 const uptr kThreads = 4;
 const uptr kClocks = 4;
 
@@ -17,6 +17,7 @@
 #include <future>
 #include <thread>
 #include <unistd.h>
+#include <vector>
 
 namespace __xray {
 namespace {
@@ -120,6 +121,44 @@ TEST(BufferQueueTest, Apply) {
   ASSERT_EQ(Count, 10);
 }
 
+TEST(BufferQueueTest, StreamingDrain) {
+  bool Success = false;
+  BufferQueue Buffers(kSize, 2, Success, /*Streaming=*/true);
+  ASSERT_TRUE(Success);
+  BufferQueue::Buffer B0, B1;
+  ASSERT_EQ(Buffers.getBuffer(B0), BufferQueue::ErrorCode::Ok);
+  ASSERT_EQ(Buffers.getBuffer(B1), BufferQueue::ErrorCode::Ok);
+  atomic_store(B0.Extents, 1, memory_order_release);
+  atomic_store(B1.Extents, 2, memory_order_release);
+  auto *D0 = B0.Data;
+  ASSERT_EQ(Buffers.releaseBuffer(B0), BufferQueue::ErrorCode::Ok);
+
+  // Released buffers are not handed out again until they have been drained.
+  EXPECT_EQ(Buffers.getBuffer(B0), BufferQueue::ErrorCode::NotEnoughMemory);
+  ASSERT_EQ(Buffers.releaseBuffer(B1), BufferQueue::ErrorCode::Ok);
+
+  // We drain them in the order they were released.
+  std::vector<uint64_t> Drained;
+  EXPECT_EQ(Buffers.drain([&](const BufferQueue::Buffer &B) {
+    Drained.push_back(atomic_load(B.Extents, memory_order_acquire));
+  }),
+            2u);
+  EXPECT_THAT(Drained, ::testing::ElementsAre(1u, 2u));
+  EXPECT_EQ(Buffers.drain([](const BufferQueue::Buffer &) {}), 0u);
+
+  // Once drained, buffers are neither applied to nor iterated over again.
+  auto Count = 0;
+  Buffers.apply([&](const BufferQueue::Buffer &) { ++Count; });
+  EXPECT_EQ(Count, 0);
+  EXPECT_EQ(Buffers.cbegin(), Buffers.cend());
+
+  ASSERT_EQ(Buffers.getBuffer(B0), BufferQueue::ErrorCode::Ok);
+  EXPECT_EQ(B0.Data, D0);
+  ASSERT_EQ(Buffers.releaseBuffer(B0), BufferQueue::ErrorCode::Ok);
+  Buffers.apply([&](const BufferQueue::Buffer &) { ++Count; });
+  EXPECT_EQ(Count, 1);
+}
+
 TEST(BufferQueueTest, GenerationalSupport) {
   bool Success = false;
   BufferQueue Buffers(kSize, 10, Success);
@@ -159,6 +159,14 @@ private:
   // Count of buffers that have been handed out through 'getBuffer'.
   size_t LiveBuffers;
 
+  // Whether released buffers are kept from being handed out again until they
+  // have been drained.
+  bool Streaming;
+
+  // Count of released buffers that have not been drained yet. These are the
+  // ones just before 'First'.
+  size_t Undrained;
+
   // We use a generation number to identify buffers and which generation they're
   // associated with.
   atomic_uint64_t Generation;
@@ -195,8 +203,9 @@ public:
   }
 
   /// Initialise a queue of size |N| with buffers of size |B|. We report success
-  /// through |Success|.
-  BufferQueue(size_t B, size_t N, bool &Success);
+  /// through |Success|. A |Streaming| queue does not hand out a released
+  /// buffer again until it has been drained.
+  BufferQueue(size_t B, size_t N, bool &Success, bool Streaming = false);
 
   /// Updates |Buf| to contain the pointer to an appropriate buffer. Returns an
   /// error in case there are no available buffers to return when we will run
@@ -206,7 +215,8 @@ public:
   ///   - BufferQueue is not finalising.
   ///
   /// Returns:
-  ///   - ErrorCode::NotEnoughMemory on exceeding MaxSize.
+  ///   - ErrorCode::NotEnoughMemory on exceeding MaxSize, or when all the
+  ///     buffers not handed out are waiting to be drained.
   ///   - ErrorCode::Ok when we find a Buffer.
   ///   - ErrorCode::QueueFinalizing or ErrorCode::AlreadyFinalized on
   ///     a finalizing/finalized BufferQueue.
@@ -221,13 +231,14 @@ public:
   ErrorCode releaseBuffer(Buffer &Buf);
 
   /// Initializes the buffer queue, starting a new generation. We can re-set the
-  /// size of buffers with |BS| along with the buffer count with |BC|.
+  /// size of buffers with |BS| along with the buffer count with |BC|, and
+  /// whether the queue is |Streaming|.
   ///
   /// Returns:
   ///   - ErrorCode::Ok when we successfully initialize the buffer. This
   ///   requires that the buffer queue is previously finalized.
   ///   - ErrorCode::AlreadyInitialized when the buffer queue is not finalized.
-  ErrorCode init(size_t BS, size_t BC);
+  ErrorCode init(size_t BS, size_t BC, bool Streaming = false);
 
   bool finalizing() const {
     return atomic_load(&Finalizing, memory_order_acquire);
@@ -258,6 +269,37 @@ public:
       Fn(*I);
   }
 
+  /// Applies the provided function F to each Buffer released since the last
+  /// call to drain(...), oldest first, and then lets a streaming queue hand
+  /// those buffers out again. Drained buffers are no longer marked 'used', so
+  /// apply(...) and the iterators skip them. Returns the number of buffers
+  /// drained.
+  ///
+  /// Only one thread may drain the queue at a time, and not concurrently with
+  /// init(...).
+  template <class F> size_t drain(F Fn) XRAY_NEVER_INSTRUMENT {
+    size_t Start = 0;
+    size_t Count = 0;
+    {
+      SpinMutexLock G(&Mutex);
+      Count = Undrained;
+      Start = (First - Buffers) + BufferCount - Count;
+    }
+
+    // The buffers in [Start, Start + Count) stay put until we account for
+    // them below: releases only write at 'First', and getBuffer(...) does not
+    // hand out undrained buffers.
+    for (size_t I = 0; I != Count; ++I) {
+      auto &R = Buffers[(Start + I) % BufferCount];
+      Fn(static_cast<const Buffer &>(R.Buff));
+      R.Used = false;
+    }
+
+    SpinMutexLock G(&Mutex);
+    Undrained -= Count;
+    return Count;
+  }
+
   using const_iterator = Iterator<const Buffer>;
   using iterator = Iterator<Buffer>;
 
@@ -89,6 +89,13 @@ static atomic_uint64_t TicksPerSec{0};
 static atomic_sint32_t LogFlushStatus = {
     XRayLogFlushStatus::XRAY_LOG_NOT_FLUSHING};
 
+// When streaming, the log the buffers go to as they are released, and the
+// thread writing them out.
+static LogWriter *StreamWriter = nullptr;
+static pthread_t StreamThread;
+static bool StreamThreadStarted = false;
+static atomic_uint8_t StreamStop{0};
+
 // This function will initialize the thread-local data structure used by the FDR
 // logging implementation and return a reference to it. The implementation
 // details require a bit of care to maintain.
@@ -275,6 +282,54 @@ XRayBuffer fdrIterator(const XRayBuffer B) {
   return Result;
 }
 
+// Starting at version 2 of the FDR logging implementation, we only write the
+// records identified by the extents of the buffer. We use the Extents from the
+// Buffer and write that out as the first record in the buffer.  We still use a
+// Metadata record, but fill in the extents instead for the data.
+static void writeBuffer(LogWriter *LW,
+                        const BufferQueue::Buffer &B) XRAY_NEVER_INSTRUMENT {
+  MetadataRecord ExtentsRecord;
+  auto BufferExtents = atomic_load(B.Extents, memory_order_acquire);
+  DCHECK(BufferExtents <= B.Size);
+  ExtentsRecord.Type = uint8_t(RecordType::Metadata);
+  ExtentsRecord.RecordKind =
+      uint8_t(MetadataRecord::RecordKinds::BufferExtents);
+  internal_memcpy(ExtentsRecord.Data, &BufferExtents, sizeof(BufferExtents));
+  if (BufferExtents > 0) {
+    LW->WriteAll(reinterpret_cast<char *>(&ExtentsRecord),
+                 reinterpret_cast<char *>(&ExtentsRecord) +
+                     sizeof(MetadataRecord));
+    LW->WriteAll(reinterpret_cast<char *>(B.Data),
+                 reinterpret_cast<char *>(B.Data) + BufferExtents);
+  }
+}
+
+static void writeHeader(LogWriter *LW) XRAY_NEVER_INSTRUMENT {
+  XRayFileHeader Header = fdrCommonHeaderInfo();
+  Header.FdrData = FdrAdditionalHeaderData{BQ->ConfiguredBufferSize()};
+  LW->WriteAll(reinterpret_cast<char *>(&Header),
+               reinterpret_cast<char *>(&Header) + sizeof(Header));
+}
+
+static void closeStreamWriter() XRAY_NEVER_INSTRUMENT {
+  if (StreamWriter == nullptr)
+    return;
+  LogWriter::Close(StreamWriter);
+  StreamWriter = nullptr;
+}
+
+// The streaming thread periodically writes out the buffers released since it
+// last looked, which lets the logging threads have them back. It keeps going
+// until the log is flushed.
+static void *streamBuffers(void *) XRAY_NEVER_INSTRUMENT {
+  while (!atomic_load(&StreamStop, memory_order_acquire)) {
+    SleepForMillis(fdrFlags()->stream_interval_ms);
+    BQ->drain(
+        [](const BufferQueue::Buffer &B) { writeBuffer(StreamWriter, B); });
+  }
+  return nullptr;
+}
+
 // Must finalize before flushing.
 XRayLogFlushStatus fdrLoggingFlush() XRAY_NEVER_INSTRUMENT {
   if (atomic_load(&LoggingStatus, memory_order_acquire) !=
@@ -303,6 +358,13 @@ XRayLogFlushStatus fdrLoggingFlush() XRAY_NEVER_INSTRUMENT {
   // finalised before attempting to flush the log.
   SleepForMillis(fdrFlags()->grace_period_ms);
 
+  // The streaming thread has to stop before we write out what it left behind.
+  if (StreamThreadStarted) {
+    atomic_store(&StreamStop, 1, memory_order_release);
+    pthread_join(StreamThread, nullptr);
+    StreamThreadStarted = false;
+  }
+
   // At this point, we're going to uninstall the iterator implementation, before
   // we decide to do anything further with the global buffer queue.
   __xray_log_remove_buffer_iterator();
@@ -320,6 +382,20 @@ XRayLogFlushStatus fdrLoggingFlush() XRAY_NEVER_INSTRUMENT {
       TLD.Controller->flush();
   });
 
+  if (StreamWriter != nullptr) {
+    // The header and the buffers released before now have already been
+    // written, so we only need to write the rest of the buffers.
+    auto &TLD = getThreadLocalData();
+    if (TLD.Controller != nullptr)
+      TLD.Controller->flush();
+    BQ->drain(
+        [](const BufferQueue::Buffer &B) { writeBuffer(StreamWriter, B); });
+    closeStreamWriter();
+    atomic_store(&LogFlushStatus, XRayLogFlushStatus::XRAY_LOG_FLUSHED,
+                 memory_order_release);
+    return XRayLogFlushStatus::XRAY_LOG_FLUSHED;
+  }
+
   if (fdrFlags()->no_file_flush) {
     if (Verbosity())
       Report("XRay FDR: Not flushing to file, 'no_file_flush=true'.\n");
@@ -345,10 +421,7 @@ XRayLogFlushStatus fdrLoggingFlush() XRAY_NEVER_INSTRUMENT {
     return Result;
   }
 
-  XRayFileHeader Header = fdrCommonHeaderInfo();
-  Header.FdrData = FdrAdditionalHeaderData{BQ->ConfiguredBufferSize()};
-  LW->WriteAll(reinterpret_cast<char *>(&Header),
-               reinterpret_cast<char *>(&Header) + sizeof(Header));
+  writeHeader(LW);
 
   // Release the current thread's buffer before we attempt to write out all the
   // buffers. This ensures that in case we had only a single thread going, that
@@ -357,27 +430,7 @@ XRayLogFlushStatus fdrLoggingFlush() XRAY_NEVER_INSTRUMENT {
   if (TLD.Controller != nullptr)
     TLD.Controller->flush();
 
-  BQ->apply([&](const BufferQueue::Buffer &B) {
-    // Starting at version 2 of the FDR logging implementation, we only write
-    // the records identified by the extents of the buffer. We use the Extents
-    // from the Buffer and write that out as the first record in the buffer.  We
-    // still use a Metadata record, but fill in the extents instead for the
-    // data.
-    MetadataRecord ExtentsRecord;
-    auto BufferExtents = atomic_load(B.Extents, memory_order_acquire);
-    DCHECK(BufferExtents <= B.Size);
-    ExtentsRecord.Type = uint8_t(RecordType::Metadata);
-    ExtentsRecord.RecordKind =
-        uint8_t(MetadataRecord::RecordKinds::BufferExtents);
-    internal_memcpy(ExtentsRecord.Data, &BufferExtents, sizeof(BufferExtents));
-    if (BufferExtents > 0) {
-      LW->WriteAll(reinterpret_cast<char *>(&ExtentsRecord),
-                   reinterpret_cast<char *>(&ExtentsRecord) +
-                       sizeof(MetadataRecord));
-      LW->WriteAll(reinterpret_cast<char *>(B.Data),
-                   reinterpret_cast<char *>(B.Data) + BufferExtents);
-    }
-  });
+  BQ->apply([&](const BufferQueue::Buffer &B) { writeBuffer(LW, B); });
 
   atomic_store(&LogFlushStatus, XRayLogFlushStatus::XRAY_LOG_FLUSHED,
                memory_order_release);
@@ -660,19 +713,33 @@ XRayLogInitStatus fdrLoggingInit(size_t, size_t, void *Options,
   *fdrFlags() = FDRFlags;
   auto BufferSize = FDRFlags.buffer_size;
   auto BufferMax = FDRFlags.buffer_max;
+  bool Streaming = FDRFlags.stream_interval_ms > 0 && !FDRFlags.no_file_flush;
+  if (Streaming) {
+    StreamWriter = internal_strlen(FDRFlags.stream_socket) == 0
+                       ? LogWriter::Open()
+                       : LogWriter::Connect(FDRFlags.stream_socket);
+    if (StreamWriter == nullptr) {
+      Report("XRay FDR: Cannot open the log to stream to; keeping buffers "
+             "until the log is flushed.\n");
+      Streaming = false;
+    }
+  }
 
   if (BQ == nullptr) {
     bool Success = false;
     BQ = reinterpret_cast<BufferQueue *>(&BufferQueueStorage);
-    new (BQ) BufferQueue(BufferSize, BufferMax, Success);
+    new (BQ) BufferQueue(BufferSize, BufferMax, Success, Streaming);
     if (!Success) {
       Report("BufferQueue init failed.\n");
+      closeStreamWriter();
       return XRayLogInitStatus::XRAY_LOG_UNINITIALIZED;
     }
   } else {
-    if (BQ->init(BufferSize, BufferMax) != BufferQueue::ErrorCode::Ok) {
+    if (BQ->init(BufferSize, BufferMax, Streaming) !=
+        BufferQueue::ErrorCode::Ok) {
       if (Verbosity())
         Report("Failed to re-initialize global buffer queue. Init failed.\n");
+      closeStreamWriter();
       return XRayLogInitStatus::XRAY_LOG_UNINITIALIZED;
     }
   }
@@ -716,6 +783,17 @@ XRayLogInitStatus fdrLoggingInit(size_t, size_t, void *Options,
   // Install the buffer iterator implementation.
   __xray_log_set_buffer_iterator(fdrIterator);
 
+  // Start writing out the log before any thread releases a buffer into it.
+  if (Streaming) {
+    writeHeader(StreamWriter);
+    atomic_store(&StreamStop, 0, memory_order_release);
+    StreamThreadStarted =
+        pthread_create(&StreamThread, nullptr, streamBuffers, nullptr) == 0;
+    if (!StreamThreadStarted)
+      Report("XRay FDR: Cannot start the streaming thread; buffers will be "
+             "written out when the log is flushed.\n");
+  }
+
   atomic_store(&LoggingStatus, XRayLogInitStatus::XRAY_LOG_INITIALIZED,
                memory_order_release);
 
@@ -22,6 +22,10 @@
 #include <iterator>
 #include <stdlib.h>
 #include <sys/types.h>
+#if !SANITIZER_FUCHSIA
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
 #include <tuple>
 #include <unistd.h>
 #include <utility>
@@ -140,7 +144,15 @@ void LogWriter::WriteAll(const char *Begin, const char *End) XRAY_NEVER_INSTRUME
   if (Begin == End)
     return;
   auto TotalBytes = std::distance(Begin, End);
-  while (auto Written = write(Fd, Begin, TotalBytes)) {
+  // A collector going away should not take the traced process down with a
+  // SIGPIPE.
+#ifdef MSG_NOSIGNAL
+  const int SendFlags = MSG_NOSIGNAL;
+#else
+  const int SendFlags = 0;
+#endif
+  while (auto Written = Socket ? send(Fd, Begin, TotalBytes, SendFlags)
+                               : write(Fd, Begin, TotalBytes)) {
     if (Written < 0) {
       if (errno == EINTR)
         continue; // Try again.
@@ -190,6 +202,38 @@ LogWriter *LogWriter::Open() XRAY_NEVER_INSTRUMENT {
   return LW;
 }
 
+LogWriter *LogWriter::Connect(const char *Path) XRAY_NEVER_INSTRUMENT {
+  sockaddr_un Addr = {};
+  Addr.sun_family = AF_UNIX;
+  if (internal_strlen(Path) >= sizeof(Addr.sun_path)) {
+    Report("XRay socket path too long: %s\n", Path);
+    return nullptr;
+  }
+  internal_strncpy(Addr.sun_path, Path, sizeof(Addr.sun_path) - 1);
+
+  int Fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (Fd == -1) {
+    Report("XRay: Failed creating a socket; errno = %d\n", errno);
+    return nullptr;
+  }
+  if (connect(Fd, reinterpret_cast<sockaddr *>(&Addr), sizeof(Addr)) == -1) {
+    Report("XRay: Failed connecting to '%s'; errno = %d; not logging events.\n",
+           Path, errno);
+    internal_close(Fd);
+    return nullptr;
+  }
+#ifdef SO_NOSIGPIPE
+  int One = 1;
+  setsockopt(Fd, SOL_SOCKET, SO_NOSIGPIPE, &One, sizeof(One));
+#endif
+  if (Verbosity())
+    Report("XRay: Streaming log to '%s'\n", Path);
+
+  LogWriter *LW = allocate<LogWriter>();
+  new (LW) LogWriter(Fd, /*Socket=*/true);
+  return LW;
+}
+
 void LogWriter::Close(LogWriter *LW) {
   LW->~LogWriter();
   deallocate(LW);
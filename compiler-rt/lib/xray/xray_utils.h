@@ -31,7 +31,7 @@ public:
 #if SANITIZER_FUCHSIA
  LogWriter(zx_handle_t Vmo) : Vmo(Vmo) {}
 #else
-  explicit LogWriter(int Fd) : Fd(Fd) {}
+  explicit LogWriter(int Fd, bool Socket = false) : Fd(Fd), Socket(Socket) {}
 #endif
  ~LogWriter();
 
@@ -42,6 +42,10 @@ public:
 
  // Returns a new log instance initialized using the flag-provided values.
  static LogWriter *Open();
+#if !SANITIZER_FUCHSIA
+ // Returns a new log instance writing to the Unix domain socket at |Path|.
+ static LogWriter *Connect(const char *Path);
+#endif
  // Closes and deallocates the log instance.
  static void Close(LogWriter *LogWriter);
 
@@ -51,6 +55,7 @@ private:
  uint64_t Offset = 0;
 #else
  int Fd = -1;
+ bool Socket = false;
 #endif
 };
 
@@ -0,0 +1,42 @@
+// Test that scanning the heap with several threads finds the same leaks.
+// RUN: LSAN_BASE="use_stacks=0:use_registers=0"
+// RUN: %clangxx_lsan %s -o %t
+// RUN: %env_lsan_opts=$LSAN_BASE:"scan_threads=1" not %run %t 2>&1 | FileCheck %s
+// RUN: %env_lsan_opts=$LSAN_BASE:"scan_threads=8" not %run %t 2>&1 | FileCheck %s
+
+#include <stdlib.h>
+
+struct Node {
+  Node *next;
+  Node *other;
+};
+
+Node **reachable;
+Node *volatile sink;
+
+// A list of |n| nodes, linked to each other both ways.
+static Node *MakeList(int n) {
+  Node *head = nullptr;
+  for (int i = 0; i < n; i++) {
+    Node *node = (Node *)calloc(1, sizeof(Node));
+    node->next = head;
+    if (head)
+      head->other = node;
+    head = node;
+  }
+  return head;
+}
+
+int main() {
+  // Larger than the pieces that the threads share big chunks in.
+  const int kNumLists = 1 << 18;
+  reachable = (Node **)malloc(kNumLists * sizeof(Node *));
+  for (int i = 0; i < kNumLists; i++)
+    reachable[i] = MakeList(i % 16 == 0 ? 64 : 1);
+  for (int i = 0; i < 10; i++)
+    sink = MakeList(100);
+  sink = nullptr;
+  return 0;
+}
+// CHECK: LeakSanitizer: detected memory leaks
+// CHECK: SUMMARY: {{(Leak|Address)}}Sanitizer: 16000 byte(s) leaked in 1000 allocation(s)
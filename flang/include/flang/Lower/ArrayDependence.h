@@ -0,0 +1,39 @@
+//===-- Lower/ArrayDependence.h -- array assignment overlap -----*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef FORTRAN_LOWER_ARRAYDEPENDENCE_H
+#define FORTRAN_LOWER_ARRAYDEPENDENCE_H
+
+#include "flang/Evaluate/expression.h"
+#include <optional>
+#include <vector>
+
+namespace Fortran::lower {
+
+/// Check whether the array assignment `lhs = rhs` can be lowered to loops
+/// that store each element as soon as it is computed, without first
+/// evaluating \p rhs into a temporary.
+///
+/// That is the case when no element of \p lhs is read by \p rhs after it has
+/// been stored. References to other variables that cannot be storage
+/// associated with \p lhs never overlap it. References to sections of the
+/// same array are compared dimension by dimension: with the same stride,
+/// sections whose lower bounds differ by a constant are a constant number of
+/// iterations apart, and iterating over the right dimensions in reverse
+/// order reads every element before it is stored.
+///
+/// Returns, for each dimension of \p lhs, whether its loop has to run in
+/// reverse order, or std::nullopt when a temporary is needed, including
+/// whenever the analysis cannot prove that it is not.
+std::optional<std::vector<bool>> analyzeArrayAssignment(
+    const evaluate::Expr<evaluate::SomeType> &lhs,
+    const evaluate::Expr<evaluate::SomeType> &rhs);
+
+} // namespace Fortran::lower
+
+#endif // FORTRAN_LOWER_ARRAYDEPENDENCE_H
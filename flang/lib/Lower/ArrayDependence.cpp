@@ -0,0 +1,279 @@
+//===-- ArrayDependence.cpp -----------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "flang/Lower/ArrayDependence.h"
+#include "flang/Evaluate/fold.h"
+#include "flang/Evaluate/tools.h"
+#include "flang/Evaluate/traverse.h"
+#include "flang/Semantics/scope.h"
+#include "flang/Semantics/symbol.h"
+#include "flang/Semantics/tools.h"
+#include <algorithm>
+
+namespace {
+using SubscriptExpr =
+    Fortran::evaluate::Expr<Fortran::evaluate::SubscriptInteger>;
+
+/// A reference to a variable in the right-hand side of an assignment.
+struct Reference {
+  const Fortran::semantics::Symbol *symbol;
+  /// The subscripts of an array element or section of a whole array, or
+  /// null for a reference to the whole array.
+  const Fortran::evaluate::ArrayRef *arrayRef;
+  /// Set for references that the analysis cannot see through: components,
+  /// coindexed objects, and arguments to transformational intrinsics, which
+  /// may read any element of their arguments at any time.
+  bool opaque;
+};
+
+/// Collects the references of the right-hand side of an array assignment.
+/// Fails on references to procedures other than intrinsics, which may read
+/// the left-hand side through host or use association.
+class ReferenceCollector
+    : public Fortran::evaluate::AllTraverse<ReferenceCollector, true> {
+public:
+  using Base = Fortran::evaluate::AllTraverse<ReferenceCollector, true>;
+  ReferenceCollector() : Base{*this} {}
+  using Base::operator();
+
+  bool operator()(const Fortran::semantics::Symbol &symbol) const {
+    references.push_back({&symbol, nullptr, opaqueDepth > 0});
+    return true;
+  }
+  bool operator()(const Fortran::evaluate::ArrayRef &x) const {
+    if (!x.base().IsSymbol()) {
+      references.push_back({&x.GetFirstSymbol(), nullptr, true});
+      return (*this)(x.subscript());
+    }
+    references.push_back({&x.GetFirstSymbol(), &x, opaqueDepth > 0});
+    // Subscripts are read for each element: any reference in them is opaque.
+    ++opaqueDepth;
+    bool result{(*this)(x.subscript())};
+    --opaqueDepth;
+    return result;
+  }
+  bool operator()(const Fortran::evaluate::Component &x) const {
+    ++opaqueDepth;
+    bool result{(*this)(x.base())};
+    --opaqueDepth;
+    return result;
+  }
+  bool operator()(const Fortran::evaluate::CoarrayRef &x) const {
+    references.push_back({&x.GetFirstSymbol(), nullptr, true});
+    return true;
+  }
+  bool operator()(const Fortran::evaluate::ProcedureRef &x) const {
+    if (!x.proc().GetSpecificIntrinsic())
+      return false;
+    if (x.IsElemental())
+      return (*this)(x.arguments());
+    ++opaqueDepth;
+    bool result{(*this)(x.arguments())};
+    --opaqueDepth;
+    return result;
+  }
+
+  mutable std::vector<Reference> references;
+
+private:
+  mutable int opaqueDepth{0};
+};
+} // namespace
+
+/// Is \p symbol in a COMMON block or an EQUIVALENCE set, where its storage
+/// may be shared with another variable?
+static bool isStorageAssociated(const Fortran::semantics::Symbol &symbol) {
+  if (Fortran::semantics::InCommonBlock(symbol))
+    return true;
+  for (const auto &set : symbol.owner().equivalenceSets())
+    for (const auto &object : set)
+      if (&object.symbol == &symbol)
+        return true;
+  return false;
+}
+
+/// May the storage of \p x and \p y overlap?
+static bool mayAlias(const Fortran::semantics::Symbol &x,
+                     const Fortran::semantics::Symbol &y) {
+  const auto &ux = x.GetUltimate();
+  const auto &uy = y.GetUltimate();
+  if (&ux == &uy)
+    return true;
+  if (ux.has<Fortran::semantics::AssocEntityDetails>() ||
+      uy.has<Fortran::semantics::AssocEntityDetails>())
+    return true;
+  auto isTarget = [](const Fortran::semantics::Symbol &s) {
+    return Fortran::semantics::IsPointer(s) ||
+           s.attrs().test(Fortran::semantics::Attr::TARGET);
+  };
+  if ((Fortran::semantics::IsPointer(ux) && isTarget(uy)) ||
+      (Fortran::semantics::IsPointer(uy) && isTarget(ux)))
+    return true;
+  return isStorageAssociated(ux) && isStorageAssociated(uy);
+}
+
+/// Return the subscripts of a reference to an array of rank \p rank, with
+/// `:` for each dimension of a reference to the whole array.
+static std::vector<Fortran::evaluate::Subscript>
+getSubscripts(const Fortran::evaluate::ArrayRef *arrayRef, int rank) {
+  if (arrayRef)
+    return arrayRef->subscript();
+  return std::vector<Fortran::evaluate::Subscript>(
+      rank, Fortran::evaluate::Subscript{Fortran::evaluate::Triplet{}});
+}
+
+/// Return the constant difference `y - x` between two subscript expressions,
+/// if any.
+static std::optional<std::int64_t>
+getDifference(const std::optional<SubscriptExpr> &x,
+              const std::optional<SubscriptExpr> &y) {
+  if (!x || !y)
+    return x || y ? std::nullopt : std::optional<std::int64_t>{0};
+  if (*x == *y)
+    return 0;
+  auto cx = Fortran::evaluate::ToInt64(*x);
+  auto cy = Fortran::evaluate::ToInt64(*y);
+  if (cx && cy)
+    return *cy - *cx;
+  return std::nullopt;
+}
+
+namespace {
+/// How an element read by the right-hand side relates to the elements stored
+/// by the left-hand side of an assignment.
+struct Dependence {
+  /// Never any of them.
+  bool independent{false};
+  /// Otherwise, the element read at iteration `i` of the loops over the
+  /// dimensions of the left-hand side is stored at iteration `i + distance`.
+  std::vector<std::int64_t> distance;
+};
+} // namespace
+
+/// Compare the subscripts of the left-hand side \p lhs of an assignment of
+/// rank \p rank with those of the reference \p rhs to the same array.
+static std::optional<Dependence>
+getDependence(const Fortran::evaluate::ArrayRef *lhs,
+              const Fortran::evaluate::ArrayRef *rhs,
+              const Fortran::semantics::Symbol &array, int rank) {
+  auto lhsSubscripts = getSubscripts(lhs, array.Rank());
+  auto rhsSubscripts = getSubscripts(rhs, array.Rank());
+  if (lhsSubscripts.size() != rhsSubscripts.size())
+    return std::nullopt;
+  Dependence result;
+  for (std::size_t j = 0; j < lhsSubscripts.size(); ++j) {
+    const auto &lhsSubscript = lhsSubscripts[j].u;
+    const auto &rhsSubscript = rhsSubscripts[j].u;
+    if (const auto *lhsTriplet =
+            std::get_if<Fortran::evaluate::Triplet>(&lhsSubscript)) {
+      const auto *rhsTriplet =
+          std::get_if<Fortran::evaluate::Triplet>(&rhsSubscript);
+      if (!rhsTriplet)
+        return std::nullopt;
+      auto stride = Fortran::evaluate::ToInt64(lhsTriplet->stride());
+      if (!stride || *stride == 0 ||
+          stride != Fortran::evaluate::ToInt64(rhsTriplet->stride()))
+        return std::nullopt;
+      auto offset = getDifference(lhsTriplet->lower(), rhsTriplet->lower());
+      if (!offset)
+        return std::nullopt;
+      if (*offset % *stride != 0) {
+        // The sections interleave without sharing any element.
+        result.independent = true;
+        return result;
+      }
+      result.distance.push_back(*offset / *stride);
+      continue;
+    }
+    const auto &lhsIndex =
+        std::get<Fortran::evaluate::IndirectSubscriptIntegerExpr>(lhsSubscript)
+            .value();
+    const auto *rhsIndex =
+        std::get_if<Fortran::evaluate::IndirectSubscriptIntegerExpr>(
+            &rhsSubscript);
+    // Vector subscripts may select any element in any order.
+    if (!rhsIndex || lhsIndex.Rank() > 0 || rhsIndex->value().Rank() > 0)
+      return std::nullopt;
+    auto difference = getDifference(lhsIndex, rhsIndex->value());
+    if (!difference)
+      return std::nullopt;
+    if (*difference != 0) {
+      result.independent = true;
+      return result;
+    }
+  }
+  if (static_cast<int>(result.distance.size()) != rank)
+    return std::nullopt;
+  return result;
+}
+
+std::optional<std::vector<bool>> Fortran::lower::analyzeArrayAssignment(
+    const evaluate::Expr<evaluate::SomeType> &lhs,
+    const evaluate::Expr<evaluate::SomeType> &rhs) {
+  auto lhsDataRef = evaluate::ExtractDataRef(lhs);
+  if (!lhsDataRef)
+    return std::nullopt;
+  const semantics::Symbol &lhsSymbol = lhsDataRef->GetFirstSymbol();
+  const evaluate::ArrayRef *lhsArrayRef = nullptr;
+  bool lhsOpaque = false;
+  if (const auto *arrayRef = std::get_if<evaluate::ArrayRef>(&lhsDataRef->u)) {
+    lhsArrayRef = arrayRef;
+    lhsOpaque = !arrayRef->base().IsSymbol();
+    // The subscripts of the left-hand side are evaluated before any store.
+    for (const auto &subscript : arrayRef->subscript())
+      if (const auto *index =
+              std::get_if<evaluate::IndirectSubscriptIntegerExpr>(
+                  &subscript.u))
+        if (index->value().Rank() > 0)
+          return std::nullopt;
+  } else if (!std::holds_alternative<evaluate::SymbolRef>(lhsDataRef->u)) {
+    lhsOpaque = true;
+  }
+
+  ReferenceCollector collector;
+  if (!collector(rhs))
+    return std::nullopt;
+
+  int rank = lhs.Rank();
+  std::vector<std::vector<std::int64_t>> distances;
+  for (const Reference &ref : collector.references) {
+    if (!mayAlias(*ref.symbol, lhsSymbol))
+      continue;
+    if (ref.opaque || lhsOpaque ||
+        &ref.symbol->GetUltimate() != &lhsSymbol.GetUltimate())
+      return std::nullopt;
+    auto dependence =
+        getDependence(lhsArrayRef, ref.arrayRef, lhsSymbol.GetUltimate(), rank);
+    if (!dependence)
+      return std::nullopt;
+    if (!dependence->independent)
+      distances.push_back(std::move(dependence->distance));
+  }
+
+  // Loops are nested with the last dimension outermost. Going from the
+  // outermost loop inwards, run each loop in the direction in which every
+  // read is ordered before the store to the same element, given the
+  // directions chosen for the loops around it.
+  std::vector<bool> reversed(rank, false);
+  for (int k = rank - 1; k >= 0 && !distances.empty(); --k) {
+    bool forward = false;
+    bool backward = false;
+    for (const auto &distance : distances) {
+      forward |= distance[k] > 0;
+      backward |= distance[k] < 0;
+    }
+    if (forward && backward)
+      return std::nullopt;
+    reversed[k] = backward;
+    distances.erase(
+        std::remove_if(distances.begin(), distances.end(),
+                       [&](const auto &distance) { return distance[k] != 0; }),
+        distances.end());
+  }
+  return reversed;
+}
@@ -235,19 +235,28 @@ static bool DescriptorIO(IoStatementState &io, const Descriptor &descriptor) {
         return unf->Receive(&x, totalBytes, elementBytes);
       }
     } else { // non-contiguous unformatted I/O
-      for (std::size_t j{0}; j < numElements; ++j) {
+      // Transfer each run of elements that are contiguous along the first
+      // dimension as one block.
+      const auto &dim0{descriptor.GetDimension(0)};
+      std::size_t runElements{1};
+      if (dim0.ByteStride() == static_cast<SubscriptValue>(elementBytes)) {
+        runElements = dim0.Extent();
+      }
+      auto runBytes{runElements * elementBytes};
+      for (std::size_t j{0}; j < numElements; j += runElements) {
         char &x{ExtractElement<char>(io, descriptor, subscripts)};
         if constexpr (DIR == Direction::Output) {
-          if (!unf->Emit(&x, elementBytes, elementBytes)) {
+          if (!unf->Emit(&x, runBytes, elementBytes)) {
             return false;
           }
         } else {
-          if (!unf->Receive(&x, elementBytes, elementBytes)) {
+          if (!unf->Receive(&x, runBytes, elementBytes)) {
             return false;
           }
         }
+        subscripts[0] += runElements - 1;
         if (!descriptor.IncrementSubscripts(subscripts) &&
-            j + 1 < numElements) {
+            j + runElements < numElements) {
           io.GetIoErrorHandler().Crash(
               "DescriptorIO: subscripts out of bounds");
         }
@@ -23,6 +23,14 @@
 #include <unistd.h>
 #endif
 
+// Asynchronous transfers run on threads of their own where positional
+// transfers, which leave the shared file position alone, are available.
+#if USE_PTHREADS && (_XOPEN_SOURCE >= 500 || _POSIX_C_SOURCE >= 200809L)
+#define ASYNCHRONOUS_THREADS 1
+#else
+#define ASYNCHRONOUS_THREADS 0
+#endif
+
 namespace Fortran::runtime::io {
 
 void OpenFile::set_path(OwningPtr<char> &&path, std::size_t bytes) {
@@ -126,7 +134,7 @@ void OpenFile::Open(OpenStatus status, std::optional<Action> action,
     }
   }
   RUNTIME_CHECK(handler, action.has_value());
-  pending_.reset();
+  DropPending();
   if (position == Position::Append && !RawSeekToEnd()) {
     handler.SignalErrno();
   }
@@ -157,7 +165,7 @@ void OpenFile::Predefine(int fd) {
   position_ = 0;
   knownSize_.reset();
   nextId_ = 0;
-  pending_.reset();
+  DropPending();
   mayRead_ = fd == 0;
   mayWrite_ = fd != 0;
   mayPosition_ = false;
@@ -165,7 +173,7 @@ void OpenFile::Predefine(int fd) {
 
 void OpenFile::Close(CloseStatus status, IoErrorHandler &handler) {
   CheckOpen(handler);
-  pending_.reset();
+  DropPending();
   knownSize_.reset();
   switch (status) {
   case CloseStatus::Keep:
@@ -262,11 +270,14 @@ void OpenFile::Truncate(FileOffset at, IoErrorHandler &handler) {
   }
 }
 
-// The operation is performed immediately; the results are saved
-// to be claimed by a later WAIT statement.
-// TODO: True asynchronicity
+// The operation runs on a thread of its own, or is performed immediately
+// where there are no threads; either way, the results are saved to be
+// claimed by a later WAIT statement.
 int OpenFile::ReadAsynchronously(
     FileOffset at, char *buffer, std::size_t bytes, IoErrorHandler &handler) {
+#if ASYNCHRONOUS_THREADS
+  return StartTransfer(true, at, buffer, bytes, handler);
+#else
   CheckOpen(handler);
   int iostat{0};
   for (std::size_t got{0}; got < bytes;) {
@@ -291,11 +302,14 @@ int OpenFile::ReadAsynchronously(
     }
   }
   return PendingResult(handler, iostat);
+#endif
 }
 
-// TODO: True asynchronicity
 int OpenFile::WriteAsynchronously(FileOffset at, const char *buffer,
     std::size_t bytes, IoErrorHandler &handler) {
+#if ASYNCHRONOUS_THREADS
+  return StartTransfer(false, at, const_cast<char *>(buffer), bytes, handler);
+#else
   CheckOpen(handler);
   int iostat{0};
   for (std::size_t put{0}; put < bytes;) {
@@ -317,6 +331,7 @@ int OpenFile::WriteAsynchronously(FileOffset at, const char *buffer,
     }
   }
   return PendingResult(handler, iostat);
+#endif
 }
 
 void OpenFile::Wait(int id, IoErrorHandler &handler) {
@@ -324,6 +339,7 @@ void OpenFile::Wait(int id, IoErrorHandler &handler) {
   Pending *prev{nullptr};
   for (Pending *p{pending_.get()}; p; p = (prev = p)->next.get()) {
     if (p->id == id) {
+      Join(*p);
       ioStat = p->ioStat;
       if (prev) {
         prev->next.reset(p->next.release());
@@ -342,6 +358,7 @@ void OpenFile::WaitAll(IoErrorHandler &handler) {
   while (true) {
     int ioStat;
     if (pending_) {
+      Join(*pending_);
       ioStat = pending_->ioStat;
       pending_.reset(pending_->next.release());
     } else {
@@ -395,6 +412,68 @@ int OpenFile::PendingResult(const Terminator &terminator, int iostat) {
   return id;
 }
 
+int OpenFile::StartTransfer(bool isRead, FileOffset at, char *buffer,
+    std::size_t bytes, IoErrorHandler &handler) {
+  CheckOpen(handler);
+  int id{PendingResult(handler, 0)};
+#if USE_PTHREADS
+  Pending &p{*pending_};
+  p.isRead = isRead;
+  p.fd = fd_;
+  p.at = at;
+  p.buffer = buffer;
+  p.bytes = bytes;
+  if (::pthread_create(&p.thread, nullptr, &RunTransfer, &p) == 0) {
+    p.running = true;
+  } else {
+    RunTransfer(&p); // no thread to spare; transfer now
+  }
+#endif
+  return id;
+}
+
+void *OpenFile::RunTransfer(void *arg) {
+#if ASYNCHRONOUS_THREADS
+  Pending &p{*static_cast<Pending *>(arg)};
+  for (std::size_t done{0}; done < p.bytes;) {
+    auto chunk{p.isRead
+            ? ::pread(p.fd, p.buffer + done, p.bytes - done, p.at + done)
+            : ::pwrite(p.fd, p.buffer + done, p.bytes - done, p.at + done)};
+    if (chunk == 0 && p.isRead) {
+      p.ioStat = FORTRAN_RUNTIME_IOSTAT_END;
+      break;
+    }
+    if (chunk < 0) {
+      auto err{errno};
+      if (err != EAGAIN && err != EWOULDBLOCK && err != EINTR) {
+        p.ioStat = err;
+        break;
+      }
+    } else {
+      done += chunk;
+    }
+  }
+#endif
+  return nullptr;
+}
+
+void OpenFile::Join(Pending &p) {
+#if USE_PTHREADS
+  if (p.running) {
+    ::pthread_join(p.thread, nullptr);
+    p.running = false;
+  }
+#endif
+}
+
+// Transfers still in progress must not outlive their file.
+void OpenFile::DropPending() {
+  while (pending_) {
+    Join(*pending_);
+    pending_.reset(pending_->next.release());
+  }
+}
+
 bool IsATerminal(int fd) { return ::isatty(fd); }
 
 #ifdef WIN32
@@ -12,6 +12,7 @@
 #define FORTRAN_RUNTIME_FILE_H_
 
 #include "io-error.h"
+#include "lock.h"
 #include "memory.h"
 #include <cinttypes>
 #include <optional>
@@ -59,7 +60,7 @@ public:
   // Truncates the file
   void Truncate(FileOffset, IoErrorHandler &);
 
-  // Asynchronous transfers
+  // Asynchronous transfers; they run on threads of their own where possible
   int ReadAsynchronously(FileOffset, char *, std::size_t, IoErrorHandler &);
   int WriteAsynchronously(
       FileOffset, const char *, std::size_t, IoErrorHandler &);
@@ -71,6 +72,16 @@ private:
     int id;
     int ioStat{0};
     OwningPtr<Pending> next;
+#if USE_PTHREADS
+    // The transfer, which runs on a thread of its own until it is joined
+    bool isRead{false};
+    int fd{-1};
+    FileOffset at{0};
+    char *buffer{nullptr};
+    std::size_t bytes{0};
+    bool running{false};
+    pthread_t thread;
+#endif
   };
 
   void CheckOpen(const Terminator &);
@@ -78,6 +89,11 @@ private:
   bool RawSeek(FileOffset);
   bool RawSeekToEnd();
   int PendingResult(const Terminator &, int);
+  int StartTransfer(bool isRead, FileOffset, char *, std::size_t,
+      IoErrorHandler &);
+  static void *RunTransfer(void *);
+  void Join(Pending &);
+  void DropPending();
 
   int fd_{-1};
   OwningPtr<char> path_;
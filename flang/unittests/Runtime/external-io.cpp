@@ -1,12 +1,14 @@
 // Sanity test for all external I/O modes
 
 #include "testing.h"
+#include "../../runtime/descriptor.h"
 #include "../../runtime/io-api.h"
 #include "../../runtime/main.h"
 #include "../../runtime/stop.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstring>
 
+using namespace Fortran::runtime;
 using namespace Fortran::runtime::io;
 
 void TestDirectUnformatted() {
@@ -306,6 +308,67 @@ void TestSequentialVariableUnformatted() {
   llvm::errs() << "end TestSequentialVariableUnformatted()\n";
 }
 
+void TestSequentialUnformattedSection() {
+  llvm::errs() << "begin TestSequentialUnformattedSection()\n";
+  // OPEN(NEWUNIT=unit,ACCESS='SEQUENTIAL',ACTION='READWRITE',&
+  //   FORM='UNFORMATTED',STATUS='SCRATCH')
+  auto io{IONAME(BeginOpenNewUnit)(__FILE__, __LINE__)};
+  IONAME(SetAccess)
+  (io, "SEQUENTIAL", 10) || (Fail() << "SetAccess(SEQUENTIAL)", 0);
+  IONAME(SetAction)
+  (io, "READWRITE", 9) || (Fail() << "SetAction(READWRITE)", 0);
+  IONAME(SetForm)
+  (io, "UNFORMATTED", 11) || (Fail() << "SetForm(UNFORMATTED)", 0);
+  IONAME(SetStatus)(io, "SCRATCH", 7) || (Fail() << "SetStatus(SCRATCH)", 0);
+  int unit{-1};
+  IONAME(GetNewUnit)(io, unit) || (Fail() << "GetNewUnit()", 0);
+  llvm::errs() << "unit=" << unit << '\n';
+  IONAME(EndIoStatement)
+  (io) == IostatOk || (Fail() << "EndIoStatement() for OpenNewUnit", 0);
+  // INTEGER*8 :: A(4,3) = RESHAPE([(j,j=0,11)],[4,3])
+  static constexpr int rows{4}, columns{3};
+  std::int64_t array[columns][rows];
+  for (int j{0}; j < rows * columns; ++j) {
+    array[j / rows][j % rows] = j;
+  }
+  // WRITE(UNIT=unit) A(1:3,1:3:2)
+  SubscriptValue extent[2]{3, 2};
+  auto section{Descriptor::Create(
+      TypeCategory::Integer, sizeof array[0][0], &array, 2, extent)};
+  section->GetDimension(0).SetBounds(1, 3).SetByteStride(sizeof array[0][0]);
+  section->GetDimension(1).SetBounds(1, 2).SetByteStride(2 * sizeof array[0]);
+  io = IONAME(BeginUnformattedOutput)(unit, __FILE__, __LINE__);
+  IONAME(OutputDescriptor)(io, *section) || (Fail() << "OutputDescriptor()", 0);
+  IONAME(EndIoStatement)
+  (io) == IostatOk || (Fail() << "EndIoStatement() for OutputDescriptor", 0);
+  // REWIND(UNIT=unit)
+  io = IONAME(BeginRewind)(unit, __FILE__, __LINE__);
+  IONAME(EndIoStatement)
+  (io) == IostatOk || (Fail() << "EndIoStatement() for Rewind", 0);
+  // READ(UNIT=unit) BUFFER(0:5)
+  std::int64_t buffer[6];
+  io = IONAME(BeginUnformattedInput)(unit, __FILE__, __LINE__);
+  IONAME(InputUnformattedBlock)
+  (io, reinterpret_cast<char *>(&buffer), sizeof buffer, sizeof *buffer) ||
+      (Fail() << "InputUnformattedBlock()", 0);
+  IONAME(EndIoStatement)
+  (io) == IostatOk ||
+      (Fail() << "EndIoStatement() for InputUnformattedBlock", 0);
+  for (int k{0}; k < 6; ++k) {
+    std::int64_t expect{array[2 * (k / 3)][k % 3]};
+    if (buffer[k] != expect) {
+      Fail() << "Read back [" << k << "]=" << buffer[k]
+             << " from array section record, expected " << expect << '\n';
+    }
+  }
+  // CLOSE(UNIT=unit,STATUS='DELETE')
+  io = IONAME(BeginClose)(unit, __FILE__, __LINE__);
+  IONAME(SetStatus)(io, "DELETE", 6) || (Fail() << "SetStatus(DELETE)", 0);
+  IONAME(EndIoStatement)
+  (io) == IostatOk || (Fail() << "EndIoStatement() for Close", 0);
+  llvm::errs() << "end TestSequentialUnformattedSection()\n";
+}
+
 void TestDirectFormatted() {
   llvm::errs() << "begin TestDirectFormatted()\n";
   // OPEN(NEWUNIT=unit,ACCESS='DIRECT',ACTION='READWRITE',&
@@ -462,6 +525,7 @@ int main() {
   TestDirectUnformattedSwapped();
   TestSequentialFixedUnformatted();
   TestSequentialVariableUnformatted();
+  TestSequentialUnformattedSection();
   TestDirectFormatted();
   TestSequentialVariableFormatted();
   TestStreamUnformatted();
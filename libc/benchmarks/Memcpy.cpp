@@ -12,14 +12,41 @@
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/raw_ostream.h"
 #include <memory>
+#include <vector>
 
 namespace __llvm_libc {
 extern void *memcpy(void *__restrict, const void *__restrict, size_t);
+#if defined(LIBC_BENCHMARK_X86_VARIANTS)
+namespace x86 {
+void MemcpySse2(char *__restrict, const char *__restrict, size_t, size_t);
+void MemcpyAvx2(char *__restrict, const char *__restrict, size_t, size_t);
+void MemcpyAvx512f(char *__restrict, const char *__restrict, size_t, size_t);
+} // namespace x86
+#endif
 } // namespace __llvm_libc
 
 namespace llvm {
 namespace libc_benchmarks {
 
+#if defined(LIBC_BENCHMARK_X86_VARIANTS)
+// The variants among which memcpy is selected at run time, called with a
+// `rep movsb` threshold. Comparing the variants without `rep movsb` to the
+// `rep movsb` one gives the threshold to use on the host microarchitecture.
+using VariantPrototype = void (*)(char *__restrict, const char *__restrict,
+                                  size_t, size_t);
+
+template <VariantPrototype Variant, size_t RepMovsbThreshold>
+static void *callVariant(void *Dst, const void *Src, size_t Size) {
+  Variant(static_cast<char *>(Dst), static_cast<const char *>(Src), Size,
+          RepMovsbThreshold);
+  return Dst;
+}
+
+namespace x86 = __llvm_libc::x86;
+
+static constexpr size_t kNoRepMovsb = static_cast<size_t>(-1);
+#endif
+
 // The context encapsulates the buffers, parameters and the measure.
 struct MemcpyContext : public BenchmarkRunner {
   using FunctionPrototype = void *(*)(void *, const void *, size_t);
@@ -42,14 +69,35 @@ struct MemcpyContext : public BenchmarkRunner {
   }
 
   ArrayRef<StringRef> getFunctionNames() const override {
+#if defined(LIBC_BENCHMARK_X86_VARIANTS)
+    static const std::vector<StringRef> kFunctionNames = [] {
+      std::vector<StringRef> Names = {"memcpy", "memcpy_sse2",
+                                      "memcpy_rep_movsb"};
+      if (__builtin_cpu_supports("avx2"))
+        Names.push_back("memcpy_avx2");
+      if (__builtin_cpu_supports("avx512f"))
+        Names.push_back("memcpy_avx512f");
+      return Names;
+    }();
+#else
     static std::array<StringRef, 1> kFunctionNames = {"memcpy"};
+#endif
     return kFunctionNames;
   }
 
   BenchmarkResult benchmark(const BenchmarkOptions &Options,
                             StringRef FunctionName, size_t Size) override {
-    FunctionPrototype Function = StringSwitch<FunctionPrototype>(FunctionName)
-                                     .Case("memcpy", &__llvm_libc::memcpy);
+    FunctionPrototype Function =
+        StringSwitch<FunctionPrototype>(FunctionName)
+            .Case("memcpy", &__llvm_libc::memcpy)
+#if defined(LIBC_BENCHMARK_X86_VARIANTS)
+            .Case("memcpy_sse2", &callVariant<x86::MemcpySse2, kNoRepMovsb>)
+            .Case("memcpy_avx2", &callVariant<x86::MemcpyAvx2, kNoRepMovsb>)
+            .Case("memcpy_avx512f",
+                  &callVariant<x86::MemcpyAvx512f, kNoRepMovsb>)
+            .Case("memcpy_rep_movsb", &callVariant<x86::MemcpySse2, 0>)
+#endif
+            .Default(nullptr);
     return llvm::libc_benchmarks::benchmark(
         Options, PP, [this, Function, Size](ParameterType p) {
           Function(DstBuffer + p.DstOffset, SrcBuffer + p.SrcOffset, Size);
@@ -11,14 +11,40 @@
 #include "LibcMemoryBenchmarkMain.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/raw_ostream.h"
+#include <vector>
 
 namespace __llvm_libc {
 void *memset(void *, int, size_t);
+#if defined(LIBC_BENCHMARK_X86_VARIANTS)
+namespace x86 {
+void MemsetSse2(char *, unsigned char, size_t, size_t);
+void MemsetAvx2(char *, unsigned char, size_t, size_t);
+void MemsetAvx512f(char *, unsigned char, size_t, size_t);
+} // namespace x86
+#endif
 } // namespace __llvm_libc
 
 namespace llvm {
 namespace libc_benchmarks {
 
+#if defined(LIBC_BENCHMARK_X86_VARIANTS)
+// The variants among which memset is selected at run time, called with a
+// `rep stosb` threshold. Comparing the variants without `rep stosb` to the
+// `rep stosb` one gives the threshold to use on the host microarchitecture.
+using VariantPrototype = void (*)(char *, unsigned char, size_t, size_t);
+
+template <VariantPrototype Variant, size_t RepStosbThreshold>
+static void *callVariant(void *Dst, int Value, size_t Size) {
+  Variant(static_cast<char *>(Dst), static_cast<unsigned char>(Value), Size,
+          RepStosbThreshold);
+  return Dst;
+}
+
+namespace x86 = __llvm_libc::x86;
+
+static constexpr size_t kNoRepStosb = static_cast<size_t>(-1);
+#endif
+
 // The context encapsulates the buffers, parameters and the measure.
 struct MemsetContext : public BenchmarkRunner {
   using FunctionPrototype = void *(*)(void *, int, size_t);
@@ -39,14 +65,35 @@ struct MemsetContext : public BenchmarkRunner {
   }
 
   ArrayRef<StringRef> getFunctionNames() const override {
+#if defined(LIBC_BENCHMARK_X86_VARIANTS)
+    static const std::vector<StringRef> kFunctionNames = [] {
+      std::vector<StringRef> Names = {"memset", "memset_sse2",
+                                      "memset_rep_stosb"};
+      if (__builtin_cpu_supports("avx2"))
+        Names.push_back("memset_avx2");
+      if (__builtin_cpu_supports("avx512f"))
+        Names.push_back("memset_avx512f");
+      return Names;
+    }();
+#else
     static std::array<StringRef, 1> kFunctionNames = {"memset"};
+#endif
     return kFunctionNames;
   }
 
   BenchmarkResult benchmark(const BenchmarkOptions &Options,
                             StringRef FunctionName, size_t Size) override {
-    FunctionPrototype Function = StringSwitch<FunctionPrototype>(FunctionName)
-                                     .Case("memset", &__llvm_libc::memset);
+    FunctionPrototype Function =
+        StringSwitch<FunctionPrototype>(FunctionName)
+            .Case("memset", &__llvm_libc::memset)
+#if defined(LIBC_BENCHMARK_X86_VARIANTS)
+            .Case("memset_sse2", &callVariant<x86::MemsetSse2, kNoRepStosb>)
+            .Case("memset_avx2", &callVariant<x86::MemsetAvx2, kNoRepStosb>)
+            .Case("memset_avx512f",
+                  &callVariant<x86::MemsetAvx512f, kNoRepStosb>)
+            .Case("memset_rep_stosb", &callVariant<x86::MemsetSse2, 0>)
+#endif
+            .Default(nullptr);
     return llvm::libc_benchmarks::benchmark(
         Options, PP, [this, Function, Size](ParameterType p) {
           Function(DstBuffer + p.DstOffset, MemsetValue, Size);
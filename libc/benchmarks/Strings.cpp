@@ -0,0 +1,123 @@
+//===-- Benchmark string functions implementation -------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "LibcBenchmark.h"
+#include "LibcMemoryBenchmark.h"
+#include "LibcMemoryBenchmarkMain.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cstring>
+
+namespace __llvm_libc {
+size_t strlen(const char *);
+char *strchr(const char *, int);
+void *memchr(const void *, int, size_t);
+int strcmp(const char *, const char *);
+} // namespace __llvm_libc
+
+namespace llvm {
+namespace libc_benchmarks {
+
+// The functions are called on strings of `Size` characters that don't contain
+// the searched character, so they all read the whole string. The `system_`
+// ones are the functions of the host libc.
+using FunctionPrototype = uintptr_t (*)(const char *, const char *, size_t);
+
+template <size_t (*Strlen)(const char *)>
+static uintptr_t callStrlen(const char *A, const char *, size_t) {
+  return Strlen(A);
+}
+
+template <typename Result, Result (*Strchr)(const char *, int)>
+static uintptr_t callStrchr(const char *A, const char *, size_t) {
+  return reinterpret_cast<uintptr_t>(Strchr(A, 'z'));
+}
+
+template <typename Result, Result (*Memchr)(const void *, int, size_t)>
+static uintptr_t callMemchr(const char *A, const char *, size_t Size) {
+  return reinterpret_cast<uintptr_t>(Memchr(A, 'z', Size));
+}
+
+template <int (*Strcmp)(const char *, const char *)>
+static uintptr_t callStrcmp(const char *A, const char *B, size_t) {
+  return Strcmp(A, B);
+}
+
+// The context encapsulates the buffers, parameters and the measure.
+struct StringsContext : public BenchmarkRunner {
+  struct ParameterType {
+    uint32_t Offset = 0;
+  };
+
+  // Both buffers hold the same strings, which end every `Size.To + 1` bytes.
+  // The offsets are chosen so that the strings have `Size` characters, hence
+  // `AddressAlignment` is not used.
+  explicit StringsContext(const StudyConfiguration &Conf)
+      : ABuffer(Conf.BufferSize), BBuffer(Conf.BufferSize), PP(*this) {
+    const size_t Stride = Conf.Size.To + 1;
+    for (size_t I = Stride - 1; I < Conf.BufferSize; I += Stride)
+      Terminators.push_back(I);
+    if (Terminators.empty())
+      llvm::report_fatal_error("Unable to fit the strings in the buffer");
+    TerminatorSelector =
+        std::uniform_int_distribution<size_t>(0, Terminators.size() - 1);
+    ::memset(ABuffer.begin(), 'a', Conf.BufferSize);
+    for (const auto I : Terminators)
+      ABuffer[I] = '\0';
+    ::memcpy(BBuffer.begin(), ABuffer.begin(), Conf.BufferSize);
+  }
+
+  // Needed by the ParameterProvider to update the current batch of parameter.
+  void Randomize(MutableArrayRef<ParameterType> Parameters) {
+    for (auto &P : Parameters)
+      P.Offset = Terminators[TerminatorSelector(Gen)] - CurrentSize;
+  }
+
+  ArrayRef<StringRef> getFunctionNames() const override {
+    static std::array<StringRef, 8> kFunctionNames = {
+        "strlen", "system_strlen", "strchr", "system_strchr",
+        "memchr", "system_memchr", "strcmp", "system_strcmp"};
+    return kFunctionNames;
+  }
+
+  BenchmarkResult benchmark(const BenchmarkOptions &Options,
+                            StringRef FunctionName, size_t Size) override {
+    CurrentSize = Size;
+    FunctionPrototype Function =
+        StringSwitch<FunctionPrototype>(FunctionName)
+            .Case("strlen", &callStrlen<__llvm_libc::strlen>)
+            .Case("system_strlen", &callStrlen<::strlen>)
+            .Case("strchr", &callStrchr<char *, __llvm_libc::strchr>)
+            .Case("system_strchr", &callStrchr<const char *, ::strchr>)
+            .Case("memchr", &callMemchr<void *, __llvm_libc::memchr>)
+            .Case("system_memchr", &callMemchr<const void *, ::memchr>)
+            .Case("strcmp", &callStrcmp<__llvm_libc::strcmp>)
+            .Case("system_strcmp", &callStrcmp<::strcmp>)
+            .Default(nullptr);
+    return llvm::libc_benchmarks::benchmark(
+        Options, PP, [this, Function, Size](ParameterType p) {
+          return Function(ABuffer + p.Offset, BBuffer + p.Offset, Size);
+        });
+  }
+
+private:
+  std::default_random_engine Gen;
+  std::uniform_int_distribution<size_t> TerminatorSelector;
+  SmallVector<uint32_t, 16> Terminators;
+  size_t CurrentSize = 0;
+  AlignedBuffer ABuffer;
+  AlignedBuffer BBuffer;
+  SmallParameterProvider<StringsContext> PP;
+};
+
+std::unique_ptr<BenchmarkRunner> getRunner(const StudyConfiguration &Conf) {
+  return std::make_unique<StringsContext>(Conf);
+}
+
+} // namespace libc_benchmarks
+} // namespace llvm
@@ -0,0 +1,50 @@
+//===-- Vector variants of the math functions for AArch64 -----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/math/cosf.h"
+#include "src/math/expf.h"
+#include "src/math/logf.h"
+#include "src/math/sinf.h"
+#include "src/math/vector_math_utils.h"
+
+// The functions follow the AArch64 vector function ABI, so that loops compiled
+// with -fveclib=llvmlibc call them: `_ZGVnN4v_<name>` is the unmasked Advanced
+// SIMD variant taking and returning 4 floats. They use the vector procedure
+// call standard, which preserves more of the vector registers.
+
+namespace __llvm_libc {
+namespace vector {
+
+using V4 = Vectors<4>;
+
+extern "C" {
+
+__attribute__((aarch64_vector_pcs, flatten)) V4::Float
+_ZGVnN4v_expf(V4::Float x) {
+  return apply<Expf<2>, 4>(x, expf);
+}
+
+__attribute__((aarch64_vector_pcs, flatten)) V4::Float
+_ZGVnN4v_logf(V4::Float x) {
+  return apply<Logf<2>, 4>(x, logf);
+}
+
+__attribute__((aarch64_vector_pcs, flatten)) V4::Float
+_ZGVnN4v_sinf(V4::Float x) {
+  return apply<Sinf<2>, 4>(x, sinf);
+}
+
+__attribute__((aarch64_vector_pcs, flatten)) V4::Float
+_ZGVnN4v_cosf(V4::Float x) {
+  return apply<Cosf<2>, 4>(x, cosf);
+}
+
+} // extern "C"
+
+} // namespace vector
+} // namespace __llvm_libc
@@ -0,0 +1,49 @@
+//===-- Implemention of log and friends' utils ----------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "log_utils.h"
+
+#include "math_utils.h"
+
+namespace __llvm_libc {
+
+const LogfDataTable logf_data = {
+    // The range of z is split into N subintervals of 2^(23 - LOGF_TABLE_BITS)
+    // float values each. For the ith one:
+    //   tab[i].invc = 1/c
+    //   tab[i].logc = (double)log(c)
+    // where c is the center of the subinterval, except for the subinterval
+    // that contains 1 where c = 1 so that log(1) is exactly 0. logc is
+    // computed as -log(invc) with 50 digits and rounded to nearest.
+    {
+        {as_double(0x3ff661ec6a5122f9), as_double(0xbfd57bf753c8d1fb)},
+        {as_double(0x3ff571ed3c506b3a), as_double(0xbfd2bef07cdc9355)},
+        {as_double(0x3ff49539e3b2d067), as_double(0xbfd01eae5626c691)},
+        {as_double(0x3ff3c995a47babe7), as_double(0xbfcb31d8575bce3b)},
+        {as_double(0x3ff30d190130d190), as_double(0xbfc6574ebe8c1339)},
+        {as_double(0x3ff25e22708092f1), as_double(0xbfc1aa2b7e23f729)},
+        {as_double(0x3ff1bb4a4046ed29), as_double(0xbfba4e7640b1bc38)},
+        {as_double(0x3ff12358e75d3033), as_double(0xbfb1973bd1465561)},
+        {as_double(0x3ff0953f39010954), as_double(0xbfa252f32f8d1840)},
+        {as_double(0x3ff0000000000000), as_double(0x0000000000000000)},
+        {as_double(0x3fee573ac901e574), as_double(0x3fab42dd711971b9)},
+        {as_double(0x3feca4b3055ee191), as_double(0x3fbc5e548f5bc743)},
+        {as_double(0x3feb2036406c80d9), as_double(0x3fc526e5e3a1b438)},
+        {as_double(0x3fe9c2d14ee4a102), as_double(0x3fcbc286742d8cd4)},
+        {as_double(0x3fe886e5f0abb04a), as_double(0x3fd1058bf9ae4ad4)},
+        {as_double(0x3fe767dce434a9b1), as_double(0x3fd404308686a7e4)},
+    },
+    // ln2
+    as_double(0x3fe62e42fefa39ef),
+    // poly: the coefficients of r^2 to r^5 of the Taylor series of log1p(r).
+    // |r| < 0x1.e6p-6, so the truncation error is below 2^-33.
+    {as_double(0xbfe0000000000000), as_double(0x3fd5555555555555),
+     as_double(0xbfd0000000000000), as_double(0x3fc999999999999a)},
+};
+
+} // namespace __llvm_libc
@@ -0,0 +1,34 @@
+//===-- Collection of utils for log and friends -----------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIBC_SRC_MATH_LOG_UTILS_H
+#define LLVM_LIBC_SRC_MATH_LOG_UTILS_H
+
+#include <stdint.h>
+
+#define LOGF_TABLE_BITS 4
+#define LOGF_POLY_ORDER 4
+
+// x = 2^k z with z in [LOGF_OFF, 2 * LOGF_OFF), i.e. [0x1.66p-1, 0x1.66p0).
+#define LOGF_OFF 0x3f330000
+
+namespace __llvm_libc {
+
+struct LogfDataTable {
+  struct {
+    double invc, logc;
+  } tab[1 << LOGF_TABLE_BITS];
+  double ln2;
+  double poly[LOGF_POLY_ORDER];
+};
+
+extern const LogfDataTable logf_data;
+
+} // namespace __llvm_libc
+
+#endif // LLVM_LIBC_SRC_MATH_LOG_UTILS_H
@@ -0,0 +1,69 @@
+//===-- Single-precision log function -------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "log_utils.h"
+#include "math_utils.h"
+
+#include "src/__support/common.h"
+#include <math.h>
+
+#include <stdint.h>
+
+#define T logf_data.tab
+#define A logf_data.poly
+#define Ln2 logf_data.ln2
+#define N (1 << LOGF_TABLE_BITS)
+
+namespace __llvm_libc {
+
+float LLVM_LIBC_ENTRYPOINT(logf)(float x) {
+  double_t z, r, r2, y, y0, invc, logc;
+  uint32_t ix, iz, tmp;
+  int k, i;
+
+  ix = as_uint32_bits(x);
+  // Avoids -0 for log(1) when rounding downward.
+  if (unlikely(ix == 0x3f800000))
+    return 0.0f;
+  if (unlikely(ix - 0x00800000 >= 0x7f800000 - 0x00800000)) {
+    // x < 0x1p-126 or inf or nan.
+    if (ix * 2 == 0)
+      return divzero<float>(1);
+    if (ix == 0x7f800000) // log(inf) == inf.
+      return x;
+    if ((ix & 0x80000000) || ix * 2 >= 0xff000000)
+      return invalid(x);
+    // x is subnormal, normalize it.
+    ix = as_uint32_bits(x * as_float(0x4b000000)); // x * 0x1p23f
+    ix -= 23 << 23;
+  }
+
+  // x = 2^k z where z is in [OFF, 2 * OFF) and exact. The range is split into
+  // N subintervals, the ith one contains z and c is near its center.
+  tmp = ix - LOGF_OFF;
+  i = (tmp >> (23 - LOGF_TABLE_BITS)) % N;
+  k = static_cast<int32_t>(tmp) >> 23; // arithmetic shift
+  iz = ix - (tmp & 0xff800000);
+  invc = T[i].invc;
+  logc = T[i].logc;
+  z = static_cast<double_t>(as_float(iz));
+
+  // log(x) = log1p(z/c - 1) + log(c) + k*Ln2
+  r = z * invc - 1;
+  y0 = logc + static_cast<double_t>(k) * Ln2;
+
+  // log1p(r) ~= r + A0*r^2 + A1*r^3 + A2*r^4 + A3*r^5
+  r2 = r * r;
+  y = A[2] + A[3] * r;
+  y = A[1] + y * r;
+  y = A[0] + y * r;
+  y = y * r2 + (y0 + r);
+  return static_cast<float>(y);
+}
+
+} // namespace __llvm_libc
@@ -0,0 +1,204 @@
+//===-- Vector variants of the single-precision functions -------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIBC_SRC_MATH_VECTOR_MATH_UTILS_H
+#define LLVM_LIBC_SRC_MATH_VECTOR_MATH_UTILS_H
+
+#include "exp_utils.h"
+#include "log_utils.h"
+#include "math_utils.h"
+#include "sincosf_utils.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+// The vector variants evaluate the algorithms of the scalar functions on all
+// of the lanes at once, with the same operations in double precision, so they
+// return the same results. The lanes that need the slow paths of the scalar
+// functions (large arguments, infinities, NaNs, ...) are computed by calling
+// the scalar function once the vector is done, which also sets errno and the
+// floating point exceptions for them.
+//
+// The lanes are processed in chunks of `kChunk` doubles, which should be the
+// number of doubles in a vector register of the target.
+
+namespace __llvm_libc {
+namespace vector {
+
+template <size_t kLanes> struct Vectors {
+  typedef float Float __attribute__((vector_size(kLanes * sizeof(float))));
+  typedef double Double __attribute__((vector_size(kLanes * sizeof(double))));
+  typedef int32_t Int32 __attribute__((vector_size(kLanes * sizeof(int32_t))));
+  typedef int64_t Int64 __attribute__((vector_size(kLanes * sizeof(int64_t))));
+  typedef uint32_t UInt32
+      __attribute__((vector_size(kLanes * sizeof(uint32_t))));
+  typedef uint64_t UInt64
+      __attribute__((vector_size(kLanes * sizeof(uint64_t))));
+};
+
+// Returns `Function::Kernel(x)` for the lanes of `x` that are not flagged by
+// `Function::IsSpecial`, and `scalar(x)` for the others. The functions operate
+// on `kChunk` lanes, the chunks of `x` are processed one after the other.
+template <typename Function, size_t kLanes>
+static inline typename Vectors<kLanes>::Float
+apply(typename Vectors<kLanes>::Float x, float (*scalar)(float)) {
+  using Chunk = typename Function::V;
+  constexpr size_t kChunk = sizeof(typename Chunk::Float) / sizeof(float);
+  static_assert(kLanes % kChunk == 0, "lanes must be a multiple of chunks");
+
+  typename Vectors<kLanes>::Float result;
+  uint32_t special[kLanes];
+  uint32_t any_special = 0;
+  for (size_t i = 0; i < kLanes; i += kChunk) {
+    typename Chunk::Float chunk;
+    __builtin_memcpy(&chunk, reinterpret_cast<const float *>(&x) + i,
+                     sizeof(chunk));
+    const typename Chunk::UInt32 chunk_special =
+        Function::IsSpecial((typename Chunk::UInt32)chunk);
+    // The kernels are not evaluated on the special lanes, they may not be
+    // valid inputs for their conversions.
+    chunk = chunk_special ? typename Chunk::Float{} : chunk;
+    const typename Chunk::Float chunk_result = __builtin_convertvector(
+        Function::Kernel(chunk), typename Chunk::Float);
+    __builtin_memcpy(reinterpret_cast<float *>(&result) + i, &chunk_result,
+                     sizeof(chunk_result));
+    __builtin_memcpy(special + i, &chunk_special, sizeof(chunk_special));
+    for (size_t lane = 0; lane < kChunk; ++lane)
+      any_special |= chunk_special[lane];
+  }
+
+  if (unlikely(any_special))
+    for (size_t i = 0; i < kLanes; ++i)
+      if (special[i])
+        result[i] = scalar(x[i]);
+  return result;
+}
+
+// The vectors of `kChunk` doubles below are the ones of the scalar functions
+// and their tables, see expf.cpp, logf.cpp and sinf.cpp.
+
+template <size_t kChunk> struct Expf {
+  using V = Vectors<kChunk>;
+
+  static typename V::UInt32 IsSpecial(typename V::UInt32 ix) {
+    // |x| >= 88 or x is nan.
+    return (typename V::UInt32)(((ix >> 20) & 0x7ff) >= top12_bits(88.0f));
+  }
+
+  static typename V::Double Kernel(typename V::Float x) {
+    const typename V::Double xd =
+        __builtin_convertvector(x, typename V::Double);
+    typename V::Double z = exp2f_data.invln2_scaled * xd;
+    typename V::Double kd = z + exp2f_data.shift;
+    const typename V::UInt64 ki = (typename V::UInt64)kd;
+    kd -= exp2f_data.shift;
+    const typename V::Double r = z - kd;
+
+    typename V::UInt64 t;
+    for (size_t i = 0; i < kChunk; ++i)
+      t[i] = exp2f_data.tab[ki[i] % N];
+    t += ki << (52 - EXP2F_TABLE_BITS);
+    const typename V::Double s = (typename V::Double)t;
+    const double *C = exp2f_data.poly_scaled;
+    z = C[0] * r + C[1];
+    const typename V::Double r2 = r * r;
+    typename V::Double y = C[2] * r + 1;
+    y = z * r2 + y;
+    return y * s;
+  }
+};
+
+template <size_t kChunk> struct Logf {
+  using V = Vectors<kChunk>;
+
+  static typename V::UInt32 IsSpecial(typename V::UInt32 ix) {
+    // x < 0x1p-126 or inf or nan, and log(1) which is 0 in all rounding modes.
+    return (typename V::UInt32)(ix - 0x00800000 >= 0x7f800000 - 0x00800000) |
+           (typename V::UInt32)(ix == 0x3f800000);
+  }
+
+  static typename V::Double Kernel(typename V::Float x) {
+    const typename V::UInt32 ix = (typename V::UInt32)x;
+    const typename V::UInt32 tmp = ix - LOGF_OFF;
+    const typename V::UInt32 i =
+        (tmp >> (23 - LOGF_TABLE_BITS)) % (1 << LOGF_TABLE_BITS);
+    const typename V::Int32 k = (typename V::Int32)tmp >> 23;
+    const typename V::UInt32 iz = ix - (tmp & 0xff800000);
+
+    typename V::Double invc, logc;
+    for (size_t lane = 0; lane < kChunk; ++lane) {
+      invc[lane] = logf_data.tab[i[lane]].invc;
+      logc[lane] = logf_data.tab[i[lane]].logc;
+    }
+    const typename V::Double z = __builtin_convertvector(
+        (typename V::Float)iz, typename V::Double);
+
+    const typename V::Double r = z * invc - 1;
+    const typename V::Double y0 =
+        logc + __builtin_convertvector(k, typename V::Double) * logf_data.ln2;
+
+    const double *A = logf_data.poly;
+    const typename V::Double r2 = r * r;
+    typename V::Double y = A[2] + A[3] * r;
+    y = A[1] + y * r;
+    y = A[0] + y * r;
+    return y * r2 + (y0 + r);
+  }
+};
+
+// sinf and cosf differ by the quadrant, the vector variants use the fast
+// range reduction for all of the lanes that don't need the large one.
+template <size_t kChunk, int kQuadrantOffset> struct SinCosf {
+  using V = Vectors<kChunk>;
+
+  static typename V::UInt32 IsSpecial(typename V::UInt32 ix) {
+    // |x| >= 120, inf or nan.
+    return (typename V::UInt32)(((ix >> 20) & 0x7ff) >= abstop12(120.0f));
+  }
+
+  static typename V::Double Kernel(typename V::Float y) {
+    const sincos_t *p = &__sincosf_table[0];
+    typename V::Double x = __builtin_convertvector(y, typename V::Double);
+
+    // reduce_fast
+    const typename V::Double r = x * p->hpi_inv;
+    const typename V::Int32 n =
+        (__builtin_convertvector(r, typename V::Int32) + 0x800000) >> 24;
+    x = x - __builtin_convertvector(n, typename V::Double) * p->hpi;
+
+    // sinf_poly, for both polynomials. The second entry of the table negates
+    // the cosine, and the sine polynomial is odd.
+    const typename V::Double x2 = x * x;
+    const typename V::Double x3 = x * x2;
+    const typename V::Double s1 = p->s2 + x2 * p->s3;
+    const typename V::Double x7 = x3 * x2;
+    const typename V::Double s = x + x3 * p->s1;
+    const typename V::Double sin = s + x7 * s1;
+
+    const typename V::Double x4 = x2 * x2;
+    const typename V::Double c2 = p->c3 + x2 * p->c4;
+    const typename V::Double c1 = p->c0 + x2 * p->c1;
+    const typename V::Double x6 = x4 * x2;
+    const typename V::Double c = c1 + x4 * p->c2;
+    const typename V::Double cos = c + x6 * c2;
+
+    // The quadrants 0 to 3 give sin, cos, -sin and -cos.
+    const typename V::Int64 quadrant =
+        __builtin_convertvector(n + kQuadrantOffset, typename V::Int64);
+    const typename V::Double result = (quadrant & 1) ? cos : sin;
+    return (quadrant & 2) ? -result : result;
+  }
+};
+
+template <size_t kChunk> using Sinf = SinCosf<kChunk, 0>;
+template <size_t kChunk> using Cosf = SinCosf<kChunk, 1>;
+
+} // namespace vector
+} // namespace __llvm_libc
+
+#endif // LLVM_LIBC_SRC_MATH_VECTOR_MATH_UTILS_H
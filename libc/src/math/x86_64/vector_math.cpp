@@ -0,0 +1,88 @@
+//===-- Vector variants of the math functions for x86-64 ------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/math/cosf.h"
+#include "src/math/expf.h"
+#include "src/math/logf.h"
+#include "src/math/sinf.h"
+#include "src/math/vector_math_utils.h"
+
+// The functions follow the x86 vector function ABI of libmvec, so that loops
+// compiled with -fveclib=llvmlibc call them: `_ZGV<isa>N<lanes>v_<name>` where
+// the isa is `b` for SSE2, `d` for AVX2 and `e` for AVX-512, the unmasked
+// variants taking and returning a vector register.
+
+namespace __llvm_libc {
+namespace vector {
+
+using V4 = Vectors<4>;
+using V8 = Vectors<8>;
+using V16 = Vectors<16>;
+
+extern "C" {
+
+__attribute__((flatten)) V4::Float _ZGVbN4v_expf(V4::Float x) {
+  return apply<Expf<2>, 4>(x, expf);
+}
+
+__attribute__((target("avx2"), flatten)) V8::Float
+_ZGVdN8v_expf(V8::Float x) {
+  return apply<Expf<4>, 8>(x, expf);
+}
+
+__attribute__((target("avx512f"), flatten)) V16::Float
+_ZGVeN16v_expf(V16::Float x) {
+  return apply<Expf<8>, 16>(x, expf);
+}
+
+__attribute__((flatten)) V4::Float _ZGVbN4v_logf(V4::Float x) {
+  return apply<Logf<2>, 4>(x, logf);
+}
+
+__attribute__((target("avx2"), flatten)) V8::Float
+_ZGVdN8v_logf(V8::Float x) {
+  return apply<Logf<4>, 8>(x, logf);
+}
+
+__attribute__((target("avx512f"), flatten)) V16::Float
+_ZGVeN16v_logf(V16::Float x) {
+  return apply<Logf<8>, 16>(x, logf);
+}
+
+__attribute__((flatten)) V4::Float _ZGVbN4v_sinf(V4::Float x) {
+  return apply<Sinf<2>, 4>(x, sinf);
+}
+
+__attribute__((target("avx2"), flatten)) V8::Float
+_ZGVdN8v_sinf(V8::Float x) {
+  return apply<Sinf<4>, 8>(x, sinf);
+}
+
+__attribute__((target("avx512f"), flatten)) V16::Float
+_ZGVeN16v_sinf(V16::Float x) {
+  return apply<Sinf<8>, 16>(x, sinf);
+}
+
+__attribute__((flatten)) V4::Float _ZGVbN4v_cosf(V4::Float x) {
+  return apply<Cosf<2>, 4>(x, cosf);
+}
+
+__attribute__((target("avx2"), flatten)) V8::Float
+_ZGVdN8v_cosf(V8::Float x) {
+  return apply<Cosf<4>, 8>(x, cosf);
+}
+
+__attribute__((target("avx512f"), flatten)) V16::Float
+_ZGVeN16v_cosf(V16::Float x) {
+  return apply<Cosf<8>, 16>(x, cosf);
+}
+
+} // extern "C"
+
+} // namespace vector
+} // namespace __llvm_libc
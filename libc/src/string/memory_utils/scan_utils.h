@@ -0,0 +1,263 @@
+//===-- Block scanning of strings and buffers -------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIBC_SRC_STRING_MEMORY_UTILS_SCAN_UTILS_H
+#define LLVM_LIBC_SRC_STRING_MEMORY_UTILS_SCAN_UTILS_H
+
+#include "src/string/memory_utils/utils.h"
+
+#include <stddef.h> // size_t
+#include <stdint.h> // uintptr_t
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// The string functions look for the terminating null character, so they can't
+// know how many bytes they may read. They read whole blocks anyway, which is
+// safe as long as a block never spans two pages: the bytes after the end of
+// the string are on a page that holds at least one byte of the string, hence
+// readable. Blocks are either loaded from addresses aligned to their size,
+// which divides the page size, or checked against `CrossesPage`.
+//
+// The bytes read past the end of the objects are never used for the result,
+// but tools that check every memory access (e.g. AddressSanitizer, valgrind)
+// report them.
+
+namespace __llvm_libc {
+
+// The smallest page size of the supported targets.
+static constexpr size_t kMinPageSize = 4096;
+
+// A block is a group of bytes that is loaded and compared at once. Comparisons
+// return a mask with `kBitsPerByte` bits set for each matching byte, the bits
+// of the byte at index `i` coming before the ones of the byte at index `i + 1`.
+//
+// struct Block {
+//   static constexpr size_t kSize;
+//   static constexpr size_t kBitsPerByte;
+//   using Type;
+//   using Mask;
+//   static Type Load(const unsigned char *ptr); // ptr need not be aligned.
+//   static Type Splat(unsigned char value);
+//   static Mask Zeros(Type block);              // bytes equal to zero
+//   static Mask Equals(Type lhs, Type rhs);     // bytes that are the same
+//   static Mask Differs(Type lhs, Type rhs);    // bytes that differ
+// };
+
+// Bytes in a general purpose register. The masks flag the most significant
+// bit of the bytes, so the byte order of the target must be little endian.
+struct WordBlock {
+  using Type = uintptr_t;
+  using Mask = uintptr_t;
+  static constexpr size_t kSize = sizeof(Type);
+  static constexpr size_t kBitsPerByte = 8;
+  static constexpr Type kLows = static_cast<Type>(-1) / 0xFF; // 0x0101...
+  static constexpr Type kHighs = kLows << 7;                   // 0x8080...
+
+  static Type Load(const unsigned char *ptr) {
+    Type value;
+    __builtin_memcpy(&value, ptr, sizeof(value));
+    return value;
+  }
+  static Type Splat(unsigned char value) { return kLows * value; }
+  // Adding 0x7F to the low seven bits of a byte carries into its high bit
+  // unless they are zero, without carrying into the next byte. Unlike the
+  // usual `(value - kLows) & ~value & kHighs`, no byte is wrongly flagged.
+  static Mask NonZeros(Type value) {
+    return (((value & ~kHighs) + ~kHighs) | value) & kHighs;
+  }
+  static Mask Zeros(Type value) { return NonZeros(value) ^ kHighs; }
+  static Mask Equals(Type lhs, Type rhs) { return Zeros(lhs ^ rhs); }
+  static Mask Differs(Type lhs, Type rhs) { return NonZeros(lhs ^ rhs); }
+};
+
+#if defined(__SSE2__)
+
+struct Sse2Block {
+  using Type = __m128i;
+  using Mask = uint32_t;
+  static constexpr size_t kSize = 16;
+  static constexpr size_t kBitsPerByte = 1;
+
+  static Type Load(const unsigned char *ptr) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+  }
+  static Type Splat(unsigned char value) { return _mm_set1_epi8(value); }
+  static Mask Zeros(Type value) {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(value, _mm_setzero_si128()));
+  }
+  static Mask Equals(Type lhs, Type rhs) {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(lhs, rhs));
+  }
+  static Mask Differs(Type lhs, Type rhs) { return Equals(lhs, rhs) ^ 0xFFFFU; }
+};
+
+#endif // __SSE2__
+
+#if defined(__AVX2__)
+
+struct Avx2Block {
+  using Type = __m256i;
+  using Mask = uint32_t;
+  static constexpr size_t kSize = 32;
+  static constexpr size_t kBitsPerByte = 1;
+
+  static Type Load(const unsigned char *ptr) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ptr));
+  }
+  static Type Splat(unsigned char value) { return _mm256_set1_epi8(value); }
+  static Mask Zeros(Type value) {
+    return _mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(value, _mm256_setzero_si256()));
+  }
+  static Mask Equals(Type lhs, Type rhs) {
+    return _mm256_movemask_epi8(_mm256_cmpeq_epi8(lhs, rhs));
+  }
+  static Mask Differs(Type lhs, Type rhs) { return ~Equals(lhs, rhs); }
+};
+
+#endif // __AVX2__
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+
+// NEON has no equivalent of `movemask`. Narrowing the comparison result with
+// a shift by four keeps four bits of every byte in a 64-bit mask.
+struct NeonBlock {
+  using Type = uint8x16_t;
+  using Mask = uint64_t;
+  static constexpr size_t kSize = 16;
+  static constexpr size_t kBitsPerByte = 4;
+
+  static Type Load(const unsigned char *ptr) { return vld1q_u8(ptr); }
+  static Type Splat(unsigned char value) { return vdupq_n_u8(value); }
+  static Mask ToMask(uint8x16_t comparison) {
+    const uint8x8_t narrowed =
+        vshrn_n_u16(vreinterpretq_u16_u8(comparison), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0);
+  }
+  static Mask Zeros(Type value) { return ToMask(vceqzq_u8(value)); }
+  static Mask Equals(Type lhs, Type rhs) { return ToMask(vceqq_u8(lhs, rhs)); }
+  static Mask Differs(Type lhs, Type rhs) {
+    return ToMask(vmvnq_u8(vceqq_u8(lhs, rhs)));
+  }
+};
+
+#endif // __ARM_NEON && __aarch64__
+
+// The widest block of the target. The scanning functions fall back to byte
+// loops when it is not defined.
+#if defined(__AVX2__)
+#define LLVM_LIBC_HAS_SCAN_BLOCK
+using ScanBlock = Avx2Block;
+#elif defined(__SSE2__)
+#define LLVM_LIBC_HAS_SCAN_BLOCK
+using ScanBlock = Sse2Block;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define LLVM_LIBC_HAS_SCAN_BLOCK
+using ScanBlock = NeonBlock;
+#elif defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define LLVM_LIBC_HAS_SCAN_BLOCK
+using ScanBlock = WordBlock;
+#endif
+
+// Returns the index of the first byte flagged in the non zero `mask`.
+template <typename Block>
+static inline size_t FirstIndex(typename Block::Mask mask) {
+  return __builtin_ctzll(mask) / Block::kBitsPerByte;
+}
+
+// Returns whether loading a block at `ptr` may read two pages.
+template <typename Block> static inline bool CrossesPage(const void *ptr) {
+  return offset_from_last_aligned<kMinPageSize>(ptr) >
+         static_cast<intptr_t>(kMinPageSize - Block::kSize);
+}
+
+// Returns the first byte from `src` on for which `match` flags a byte in the
+// mask of its block. One of the bytes must be flagged. `match` is called on
+// aligned blocks, the first one may start before `src`.
+template <typename Block, typename Match>
+static inline const unsigned char *FindFirst(const unsigned char *src,
+                                             Match match) {
+  const size_t misalignment = offset_from_last_aligned<Block::kSize>(src);
+  const unsigned char *block = src - misalignment;
+  // Discards the bytes before `src`.
+  typename Block::Mask mask =
+      match(Block::Load(block)) >> (misalignment * Block::kBitsPerByte);
+  if (mask)
+    return src + FirstIndex<Block>(mask);
+  for (;;) {
+    block += Block::kSize;
+    mask = match(Block::Load(block));
+    if (mask)
+      return block + FirstIndex<Block>(mask);
+  }
+}
+
+// Same as FindFirst but only looks at the first `count` bytes from `src`,
+// returns nullptr if none is flagged.
+template <typename Block, typename Match>
+static inline const unsigned char *
+FindFirst(const unsigned char *src, size_t count, Match match) {
+  if (count == 0)
+    return nullptr;
+  const size_t misalignment = offset_from_last_aligned<Block::kSize>(src);
+  const unsigned char *block = src - misalignment;
+  typename Block::Mask mask =
+      match(Block::Load(block)) >> (misalignment * Block::kBitsPerByte);
+  if (mask) {
+    const size_t index = FirstIndex<Block>(mask);
+    return index < count ? src + index : nullptr;
+  }
+  // The offsets are relative to the first block, `count` may be as large as
+  // SIZE_MAX when the byte is known to be present.
+  const size_t end = count > static_cast<size_t>(-1) - misalignment
+                         ? static_cast<size_t>(-1)
+                         : count + misalignment;
+  for (size_t offset = Block::kSize; offset < end; offset += Block::kSize) {
+    mask = match(Block::Load(block + offset));
+    if (mask) {
+      const size_t index = offset + FirstIndex<Block>(mask);
+      return index < end ? block + index : nullptr;
+    }
+  }
+  return nullptr;
+}
+
+// Returns the difference of the first bytes of the strings `lhs` and `rhs`
+// that differ, or 0 if the strings are the same. As the strings are usually
+// not aligned the same way, blocks are loaded unaligned and the bytes close to
+// the end of a page are compared one at a time.
+template <typename Block>
+static inline int CompareStrings(const unsigned char *lhs,
+                                 const unsigned char *rhs) {
+  for (;;) {
+    if (CrossesPage<Block>(lhs) || CrossesPage<Block>(rhs)) {
+      if (*lhs != *rhs || *lhs == 0)
+        return *lhs - *rhs;
+      ++lhs;
+      ++rhs;
+      continue;
+    }
+    const typename Block::Type a = Block::Load(lhs);
+    const typename Block::Type b = Block::Load(rhs);
+    const typename Block::Mask mask = Block::Zeros(a) | Block::Differs(a, b);
+    if (mask) {
+      const size_t index = FirstIndex<Block>(mask);
+      return lhs[index] - rhs[index];
+    }
+    lhs += Block::kSize;
+    rhs += Block::kSize;
+  }
+}
+
+} // namespace __llvm_libc
+
+#endif // LLVM_LIBC_SRC_STRING_MEMORY_UTILS_SCAN_UTILS_H
@@ -9,6 +9,7 @@
 #include "src/string/strchr.h"
 
 #include "src/__support/common.h"
+#include "src/string/memory_utils/scan_utils.h"
 
 namespace __llvm_libc {
 
@@ -17,8 +18,17 @@ char *LLVM_LIBC_ENTRYPOINT(strchr)(const char *src, int c) {
   unsigned char *str =
       const_cast<unsigned char *>(reinterpret_cast<const unsigned char *>(src));
   const unsigned char ch = c;
+#if defined(LLVM_LIBC_HAS_SCAN_BLOCK)
+  // Stops at the first occurrence of `ch` or at the end of the string.
+  const ScanBlock::Type pattern = ScanBlock::Splat(ch);
+  str = const_cast<unsigned char *>(
+      FindFirst<ScanBlock>(str, [pattern](ScanBlock::Type block) {
+        return ScanBlock::Zeros(block) | ScanBlock::Equals(block, pattern);
+      }));
+#else
   for (; *str && *str != ch; ++str)
     ;
+#endif
   return *str == ch ? reinterpret_cast<char *>(str) : nullptr;
 }
 
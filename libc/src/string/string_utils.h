@@ -9,6 +9,7 @@
 #ifndef LIBC_SRC_STRING_STRING_UTILS_H
 #define LIBC_SRC_STRING_STRING_UTILS_H
 
+#include "src/string/memory_utils/scan_utils.h"
 #include "utils/CPP/Bitset.h"
 #include <stddef.h> // size_t
 
@@ -18,19 +19,36 @@ namespace internal {
 // Returns the length of a string, denoted by the first occurrence
 // of a null terminator.
 static inline size_t string_length(const char *src) {
+#if defined(LLVM_LIBC_HAS_SCAN_BLOCK)
+  const unsigned char *str = reinterpret_cast<const unsigned char *>(src);
+  const unsigned char *end =
+      FindFirst<ScanBlock>(str, [](ScanBlock::Type block) {
+        return ScanBlock::Zeros(block);
+      });
+  return end - str;
+#else
   size_t length;
   for (length = 0; *src; ++src, ++length)
     ;
   return length;
+#endif
 }
 
 // Returns the first occurrence of 'ch' within the first 'n' characters of
 // 'src'. If 'ch' is not found, returns nullptr.
 static inline void *find_first_character(const unsigned char *src,
                                          unsigned char ch, size_t n) {
+#if defined(LLVM_LIBC_HAS_SCAN_BLOCK)
+  const ScanBlock::Type pattern = ScanBlock::Splat(ch);
+  return const_cast<unsigned char *>(
+      FindFirst<ScanBlock>(src, n, [pattern](ScanBlock::Type block) {
+        return ScanBlock::Equals(block, pattern);
+      }));
+#else
   for (; n && *src != ch; --n, ++src)
     ;
   return n ? const_cast<unsigned char *>(src) : nullptr;
+#endif
 }
 
 // Returns the maximum length span that contains only characters not found in
@@ -0,0 +1,63 @@
+//===-- Runtime detection of x86 cpu features -------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIBC_SRC_STRING_X86_CPU_FEATURES_H
+#define LLVM_LIBC_SRC_STRING_X86_CPU_FEATURES_H
+
+#include <cpuid.h>
+
+namespace __llvm_libc {
+namespace x86 {
+
+// The cpu features used to select the implementation of the memory functions.
+struct CpuFeatures {
+  bool avx2 = false;
+  bool avx512f = false;
+  // Enhanced REP MOVSB/STOSB, i.e. `rep movsb` and `rep stosb` are fast for
+  // large sizes.
+  bool erms = false;
+};
+
+// Returns the features of the running cpu. Vector extensions are reported only
+// if the operating system saves their registers across context switches.
+static inline CpuFeatures GetCpuFeatures() {
+  // Leaf 1, ecx.
+  constexpr unsigned kOsxsave = 1U << 27;
+  constexpr unsigned kAvx = 1U << 28;
+  // Leaf 7, ebx.
+  constexpr unsigned kAvx2 = 1U << 5;
+  constexpr unsigned kErms = 1U << 9;
+  constexpr unsigned kAvx512f = 1U << 16;
+  // XCR0, the register states enabled by the operating system.
+  constexpr unsigned kXcr0SseAvx = 0x6;  // XMM and YMM
+  constexpr unsigned kXcr0Avx512 = 0xe0; // opmask, ZMM0-15 and ZMM16-31
+
+  CpuFeatures features;
+  unsigned eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    return features;
+  unsigned xcr0 = 0;
+  if (ecx & kOsxsave) {
+    unsigned xcr0_high;
+    asm("xgetbv" : "=a"(xcr0), "=d"(xcr0_high) : "c"(0));
+  }
+  const bool os_avx = (ecx & kAvx) && (xcr0 & kXcr0SseAvx) == kXcr0SseAvx;
+  const bool os_avx512 = os_avx && (xcr0 & kXcr0Avx512) == kXcr0Avx512;
+
+  if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+    return features;
+  features.avx2 = os_avx && (ebx & kAvx2);
+  features.avx512f = os_avx512 && (ebx & kAvx512f);
+  features.erms = ebx & kErms;
+  return features;
+}
+
+} // namespace x86
+} // namespace __llvm_libc
+
+#endif // LLVM_LIBC_SRC_STRING_X86_CPU_FEATURES_H
@@ -0,0 +1,144 @@
+//===-- Implementation of memcmp ------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/string/memcmp.h"
+#include "src/__support/common.h"
+#include <immintrin.h>
+#include <stddef.h> // size_t
+
+#if defined(LLVM_LIBC_X86_RUNTIME_DISPATCH)
+#include "src/string/x86/cpu_features.h"
+#endif
+
+namespace __llvm_libc {
+
+static inline int CompareBytes(const unsigned char *lhs,
+                               const unsigned char *rhs, size_t count) {
+  for (size_t i = 0; i < count; ++i)
+    if (lhs[i] != rhs[i])
+      return lhs[i] - rhs[i];
+  return 0;
+}
+
+// Returns the difference of the first mismatching bytes of the `kBlockSize`
+// bytes at `lhs` and `rhs`, or 0 if they are the same.
+template <size_t kBlockSize>
+static inline int CompareBlock(const unsigned char *lhs,
+                               const unsigned char *rhs);
+
+template <>
+inline int CompareBlock<16>(const unsigned char *lhs,
+                            const unsigned char *rhs) {
+  const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lhs));
+  const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rhs));
+  const unsigned mismatch = _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) ^ 0xFFFFU;
+  if (mismatch == 0)
+    return 0;
+  const unsigned i = __builtin_ctz(mismatch);
+  return lhs[i] - rhs[i];
+}
+
+template <>
+__attribute__((target("avx2"))) inline int
+CompareBlock<32>(const unsigned char *lhs, const unsigned char *rhs) {
+  const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs));
+  const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs));
+  const unsigned mismatch =
+      ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+  if (mismatch == 0)
+    return 0;
+  const unsigned i = __builtin_ctz(mismatch);
+  return lhs[i] - rhs[i];
+}
+
+// Compares blocks of `kBlockSize` bytes, the last one overlapping the previous
+// ones. As the bytes before the last block are known to be the same, the first
+// mismatch within the last block is also the first mismatch of the buffers.
+template <size_t kBlockSize>
+static inline int memcmp_x86(const unsigned char *lhs, const unsigned char *rhs,
+                             size_t count) {
+  if (count < kBlockSize) {
+    if (kBlockSize > 16 && count >= 16) {
+      if (int result = CompareBlock<16>(lhs, rhs))
+        return result;
+      return CompareBlock<16>(lhs + count - 16, rhs + count - 16);
+    }
+    return CompareBytes(lhs, rhs, count);
+  }
+  size_t offset = 0;
+  for (; offset + kBlockSize < count; offset += kBlockSize)
+    if (int result = CompareBlock<kBlockSize>(lhs + offset, rhs + offset))
+      return result;
+  return CompareBlock<kBlockSize>(lhs + count - kBlockSize,
+                                  rhs + count - kBlockSize);
+}
+
+#if defined(LLVM_LIBC_X86_RUNTIME_DISPATCH)
+
+// The variants and their selection follow the ones of memcpy, see
+// src/string/x86/memcpy.cpp. Comparing 64-byte blocks requires AVX512BW and
+// the mismatches are found in the first 32 bytes for most of the calls, so
+// there is no AVX-512 variant.
+namespace x86 {
+
+__attribute__((flatten)) int MemcmpSse2(const unsigned char *lhs,
+                                        const unsigned char *rhs,
+                                        size_t count) {
+  return memcmp_x86<16>(lhs, rhs, count);
+}
+
+__attribute__((target("avx2"), flatten)) int
+MemcmpAvx2(const unsigned char *lhs, const unsigned char *rhs, size_t count) {
+  return memcmp_x86<32>(lhs, rhs, count);
+}
+
+} // namespace x86
+
+using MemcmpFunction = int (*)(const unsigned char *, const unsigned char *,
+                               size_t);
+
+static int ResolveAndCompare(const unsigned char *lhs,
+                             const unsigned char *rhs, size_t count);
+
+// The selected variant, which is the resolver until the first call. Threads
+// racing on the first call store the same value.
+static MemcmpFunction selected_memcmp = ResolveAndCompare;
+
+static int ResolveAndCompare(const unsigned char *lhs,
+                             const unsigned char *rhs, size_t count) {
+  MemcmpFunction function =
+      x86::GetCpuFeatures().avx2 ? x86::MemcmpAvx2 : x86::MemcmpSse2;
+  __atomic_store_n(&selected_memcmp, function, __ATOMIC_RELEASE);
+  return function(lhs, rhs, count);
+}
+
+int LLVM_LIBC_ENTRYPOINT(memcmp)(const void *lhs, const void *rhs,
+                                 size_t count) {
+  MemcmpFunction function = __atomic_load_n(&selected_memcmp, __ATOMIC_ACQUIRE);
+  return function(reinterpret_cast<const unsigned char *>(lhs),
+                  reinterpret_cast<const unsigned char *>(rhs), count);
+}
+
+#else // LLVM_LIBC_X86_RUNTIME_DISPATCH
+
+#if defined(__AVX2__)
+#define BEST_SIZE 32
+#else
+#define BEST_SIZE 16
+#endif
+
+int LLVM_LIBC_ENTRYPOINT(memcmp)(const void *lhs, const void *rhs,
+                                 size_t count) {
+  return memcmp_x86<BEST_SIZE>(reinterpret_cast<const unsigned char *>(lhs),
+                               reinterpret_cast<const unsigned char *>(rhs),
+                               count);
+}
+
+#endif // LLVM_LIBC_X86_RUNTIME_DISPATCH
+
+} // namespace __llvm_libc
@@ -10,6 +10,10 @@
 #include "src/__support/common.h"
 #include "src/string/memory_utils/memcpy_utils.h"
 
+#if defined(LLVM_LIBC_X86_RUNTIME_DISPATCH)
+#include "src/string/x86/cpu_features.h"
+#endif
+
 namespace __llvm_libc {
 
 static void CopyRepMovsb(char *__restrict dst, const char *__restrict src,
@@ -21,11 +25,8 @@ static void CopyRepMovsb(char *__restrict dst, const char *__restrict src,
   asm volatile("rep movsb" : "+D"(dst), "+S"(src), "+c"(count) : : "memory");
 }
 
-#if defined(__AVX__)
-#define BEST_SIZE 64
-#else
-#define BEST_SIZE 32
-#endif
+// A `rep_movsb_threshold` that disables the use of `rep movsb`.
+static constexpr size_t kNoRepMovsb = static_cast<size_t>(-1);
 
 // Design rationale
 // ================
@@ -45,8 +46,12 @@ static void CopyRepMovsb(char *__restrict dst, const char *__restrict src,
 //   implementation parameters.
 // - As compilers and processors get better, the generated code is improved
 //   with little change on the code side.
-static void memcpy_x86(char *__restrict dst, const char *__restrict src,
-                       size_t count) {
+//
+// `kBestSize` is the size of the blocks copied in the loop over large buffers,
+// and `rep_movsb_threshold` the size from which `rep movsb` is used instead.
+template <size_t kBestSize>
+static inline void memcpy_x86(char *__restrict dst, const char *__restrict src,
+                              size_t count, size_t rep_movsb_threshold) {
   if (count == 0)
     return;
   if (count == 1)
@@ -67,24 +72,121 @@ static void memcpy_x86(char *__restrict dst, const char *__restrict src,
     return CopyBlockOverlap<32>(dst, src, count);
   if (count < 128)
     return CopyBlockOverlap<64>(dst, src, count);
-#if defined(__AVX__)
-  if (count < 256)
+  if (kBestSize >= 64 && count < 256)
     return CopyBlockOverlap<128>(dst, src, count);
-#endif
-  // kRepMovsBSize == -1 : Only CopyAligned is used.
-  // kRepMovsBSize ==  0 : Only RepMovsb is used.
-  // else CopyAligned is used to to kRepMovsBSize and then RepMovsb.
-  constexpr size_t kRepMovsBSize = -1;
-  if (count <= kRepMovsBSize)
-    return CopyAlignedBlocks<BEST_SIZE>(dst, src, count);
+  if (kBestSize >= 128 && count < 512)
+    return CopyBlockOverlap<256>(dst, src, count);
+  if (count < rep_movsb_threshold)
+    return CopyAlignedBlocks<kBestSize>(dst, src, count);
   return CopyRepMovsb(dst, src, count);
 }
 
+#if defined(LLVM_LIBC_X86_RUNTIME_DISPATCH)
+
+// The implementation is selected at run time, on the first call, among variants
+// compiled for different vector extensions, so that a single libc runs at its
+// best on all x86-64 cpus. Each variant is compiled with its extension enabled
+// and flattened, so that the building blocks are inlined and use the widest
+// vectors. The selection goes through a function pointer rather than an ifunc
+// so that it also works in static executables, which do not process IRELATIVE
+// relocations unless the startup code does.
+//
+// On cpus with ERMS, `rep movsb` is used from a size that grows with the vector
+// width, as wider vector copies remain competitive for longer. These defaults
+// can be tuned for a given microarchitecture by measuring the variants with the
+// memcpy benchmark, see libc/benchmarks, and overridden at build time.
+#if defined(LLVM_LIBC_MEMCPY_X86_REP_MOVSB_THRESHOLD)
+static constexpr size_t kRepMovsbThresholdSse2 =
+    LLVM_LIBC_MEMCPY_X86_REP_MOVSB_THRESHOLD;
+static constexpr size_t kRepMovsbThresholdAvx2 =
+    LLVM_LIBC_MEMCPY_X86_REP_MOVSB_THRESHOLD;
+static constexpr size_t kRepMovsbThresholdAvx512f =
+    LLVM_LIBC_MEMCPY_X86_REP_MOVSB_THRESHOLD;
+#else
+static constexpr size_t kRepMovsbThresholdSse2 = 2048;
+static constexpr size_t kRepMovsbThresholdAvx2 = 4096;
+static constexpr size_t kRepMovsbThresholdAvx512f = 8192;
+#endif
+
+namespace x86 {
+
+__attribute__((flatten)) void
+MemcpySse2(char *__restrict dst, const char *__restrict src, size_t count,
+           size_t rep_movsb_threshold) {
+  memcpy_x86<32>(dst, src, count, rep_movsb_threshold);
+}
+
+__attribute__((target("avx2"), flatten)) void
+MemcpyAvx2(char *__restrict dst, const char *__restrict src, size_t count,
+           size_t rep_movsb_threshold) {
+  memcpy_x86<64>(dst, src, count, rep_movsb_threshold);
+}
+
+__attribute__((target("avx512f"), flatten)) void
+MemcpyAvx512f(char *__restrict dst, const char *__restrict src, size_t count,
+              size_t rep_movsb_threshold) {
+  memcpy_x86<128>(dst, src, count, rep_movsb_threshold);
+}
+
+} // namespace x86
+
+using MemcpyFunction = void (*)(char *__restrict, const char *__restrict,
+                                size_t, size_t);
+
+static void ResolveAndCopy(char *__restrict dst, const char *__restrict src,
+                           size_t count, size_t);
+
+// The selected variant, which is the resolver until the first call. Threads
+// racing on the first call store the same values.
+static MemcpyFunction selected_memcpy = ResolveAndCopy;
+static size_t selected_rep_movsb_threshold = kNoRepMovsb;
+
+static void ResolveAndCopy(char *__restrict dst, const char *__restrict src,
+                           size_t count, size_t) {
+  const x86::CpuFeatures features = x86::GetCpuFeatures();
+  MemcpyFunction function = x86::MemcpySse2;
+  size_t threshold = kRepMovsbThresholdSse2;
+  if (features.avx512f) {
+    function = x86::MemcpyAvx512f;
+    threshold = kRepMovsbThresholdAvx512f;
+  } else if (features.avx2) {
+    function = x86::MemcpyAvx2;
+    threshold = kRepMovsbThresholdAvx2;
+  }
+  if (!features.erms)
+    threshold = kNoRepMovsb;
+  __atomic_store_n(&selected_rep_movsb_threshold, threshold, __ATOMIC_RELAXED);
+  __atomic_store_n(&selected_memcpy, function, __ATOMIC_RELEASE);
+  function(dst, src, count, threshold);
+}
+
+void *LLVM_LIBC_ENTRYPOINT(memcpy)(void *__restrict dst,
+                                   const void *__restrict src, size_t size) {
+  MemcpyFunction function = __atomic_load_n(&selected_memcpy, __ATOMIC_ACQUIRE);
+  function(reinterpret_cast<char *>(dst), reinterpret_cast<const char *>(src),
+           size,
+           __atomic_load_n(&selected_rep_movsb_threshold, __ATOMIC_RELAXED));
+  return dst;
+}
+
+#else // LLVM_LIBC_X86_RUNTIME_DISPATCH
+
+#if defined(__AVX__)
+#define BEST_SIZE 64
+#else
+#define BEST_SIZE 32
+#endif
+
 void *LLVM_LIBC_ENTRYPOINT(memcpy)(void *__restrict dst,
                                    const void *__restrict src, size_t size) {
-  memcpy_x86(reinterpret_cast<char *>(dst), reinterpret_cast<const char *>(src),
-             size);
+  // kNoRepMovsb : Only CopyAligned is used.
+  // 0           : Only RepMovsb is used.
+  // else CopyAligned is used up to the threshold and then RepMovsb.
+  memcpy_x86<BEST_SIZE>(reinterpret_cast<char *>(dst),
+                        reinterpret_cast<const char *>(src), size, kNoRepMovsb);
   return dst;
 }
 
+#endif // LLVM_LIBC_X86_RUNTIME_DISPATCH
+
 } // namespace __llvm_libc
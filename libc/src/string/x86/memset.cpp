@@ -0,0 +1,155 @@
+//===-- Implementation of memset ------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "src/string/memset.h"
+#include "src/__support/common.h"
+#include "src/string/memory_utils/memset_utils.h"
+
+#if defined(LLVM_LIBC_X86_RUNTIME_DISPATCH)
+#include "src/string/x86/cpu_features.h"
+#endif
+
+namespace __llvm_libc {
+
+static void SetRepStosb(char *dst, unsigned char value, size_t count) {
+  asm volatile("rep stosb" : "+D"(dst), "+c"(count) : "a"(value) : "memory");
+}
+
+// A `rep_stosb_threshold` that disables the use of `rep stosb`.
+static constexpr size_t kNoRepStosb = static_cast<size_t>(-1);
+
+// Same as GeneralPurposeMemset, with wider blocks when the vector extensions
+// allow it. `kBestSize` is the size of the blocks set in the loop over large
+// buffers, and `rep_stosb_threshold` the size from which `rep stosb` is used
+// instead.
+template <size_t kBestSize>
+static inline void memset_x86(char *dst, unsigned char value, size_t count,
+                              size_t rep_stosb_threshold) {
+  if (count == 0)
+    return;
+  if (count == 1)
+    return SetBlock<1>(dst, value);
+  if (count == 2)
+    return SetBlock<2>(dst, value);
+  if (count == 3)
+    return SetBlock<3>(dst, value);
+  if (count == 4)
+    return SetBlock<4>(dst, value);
+  if (count <= 8)
+    return SetBlockOverlap<4>(dst, value, count);
+  if (count <= 16)
+    return SetBlockOverlap<8>(dst, value, count);
+  if (count <= 32)
+    return SetBlockOverlap<16>(dst, value, count);
+  if (count <= 64)
+    return SetBlockOverlap<32>(dst, value, count);
+  if (count <= 128)
+    return SetBlockOverlap<64>(dst, value, count);
+  if (kBestSize >= 64 && count <= 256)
+    return SetBlockOverlap<128>(dst, value, count);
+  if (kBestSize >= 128 && count <= 512)
+    return SetBlockOverlap<256>(dst, value, count);
+  if (count < rep_stosb_threshold)
+    return SetAlignedBlocks<kBestSize>(dst, value, count);
+  return SetRepStosb(dst, value, count);
+}
+
+#if defined(LLVM_LIBC_X86_RUNTIME_DISPATCH)
+
+// The variants and their selection follow the ones of memcpy, see
+// src/string/x86/memcpy.cpp. The `rep stosb` thresholds can be tuned with the
+// memset benchmark and overridden at build time.
+#if defined(LLVM_LIBC_MEMSET_X86_REP_STOSB_THRESHOLD)
+static constexpr size_t kRepStosbThresholdSse2 =
+    LLVM_LIBC_MEMSET_X86_REP_STOSB_THRESHOLD;
+static constexpr size_t kRepStosbThresholdAvx2 =
+    LLVM_LIBC_MEMSET_X86_REP_STOSB_THRESHOLD;
+static constexpr size_t kRepStosbThresholdAvx512f =
+    LLVM_LIBC_MEMSET_X86_REP_STOSB_THRESHOLD;
+#else
+static constexpr size_t kRepStosbThresholdSse2 = 2048;
+static constexpr size_t kRepStosbThresholdAvx2 = 4096;
+static constexpr size_t kRepStosbThresholdAvx512f = 8192;
+#endif
+
+namespace x86 {
+
+__attribute__((flatten)) void MemsetSse2(char *dst, unsigned char value,
+                                         size_t count,
+                                         size_t rep_stosb_threshold) {
+  memset_x86<32>(dst, value, count, rep_stosb_threshold);
+}
+
+__attribute__((target("avx2"), flatten)) void
+MemsetAvx2(char *dst, unsigned char value, size_t count,
+           size_t rep_stosb_threshold) {
+  memset_x86<64>(dst, value, count, rep_stosb_threshold);
+}
+
+__attribute__((target("avx512f"), flatten)) void
+MemsetAvx512f(char *dst, unsigned char value, size_t count,
+              size_t rep_stosb_threshold) {
+  memset_x86<128>(dst, value, count, rep_stosb_threshold);
+}
+
+} // namespace x86
+
+using MemsetFunction = void (*)(char *, unsigned char, size_t, size_t);
+
+static void ResolveAndSet(char *dst, unsigned char value, size_t count,
+                          size_t);
+
+// The selected variant, which is the resolver until the first call. Threads
+// racing on the first call store the same values.
+static MemsetFunction selected_memset = ResolveAndSet;
+static size_t selected_rep_stosb_threshold = kNoRepStosb;
+
+static void ResolveAndSet(char *dst, unsigned char value, size_t count,
+                          size_t) {
+  const x86::CpuFeatures features = x86::GetCpuFeatures();
+  MemsetFunction function = x86::MemsetSse2;
+  size_t threshold = kRepStosbThresholdSse2;
+  if (features.avx512f) {
+    function = x86::MemsetAvx512f;
+    threshold = kRepStosbThresholdAvx512f;
+  } else if (features.avx2) {
+    function = x86::MemsetAvx2;
+    threshold = kRepStosbThresholdAvx2;
+  }
+  if (!features.erms)
+    threshold = kNoRepStosb;
+  __atomic_store_n(&selected_rep_stosb_threshold, threshold, __ATOMIC_RELAXED);
+  __atomic_store_n(&selected_memset, function, __ATOMIC_RELEASE);
+  function(dst, value, count, threshold);
+}
+
+void *LLVM_LIBC_ENTRYPOINT(memset)(void *dst, int value, size_t count) {
+  MemsetFunction function = __atomic_load_n(&selected_memset, __ATOMIC_ACQUIRE);
+  function(reinterpret_cast<char *>(dst), static_cast<unsigned char>(value),
+           count,
+           __atomic_load_n(&selected_rep_stosb_threshold, __ATOMIC_RELAXED));
+  return dst;
+}
+
+#else // LLVM_LIBC_X86_RUNTIME_DISPATCH
+
+#if defined(__AVX__)
+#define BEST_SIZE 64
+#else
+#define BEST_SIZE 32
+#endif
+
+void *LLVM_LIBC_ENTRYPOINT(memset)(void *dst, int value, size_t count) {
+  memset_x86<BEST_SIZE>(reinterpret_cast<char *>(dst),
+                        static_cast<unsigned char>(value), count, kNoRepStosb);
+  return dst;
+}
+
+#endif // LLVM_LIBC_X86_RUNTIME_DISPATCH
+
+} // namespace __llvm_libc
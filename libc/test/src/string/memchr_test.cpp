@@ -120,3 +120,21 @@ TEST(MemChrTest, SignedCharacterFound) {
   // Should find the first character 'c'.
   ASSERT_EQ(actual[0], c);
 }
+
+TEST(MemChrTest, Sweep) {
+  static constexpr size_t kMaxSize = 128;
+  char src[kMaxSize];
+  for (size_t i = 0; i < kMaxSize; ++i)
+    src[i] = 'a';
+
+  // The character is found at every position, but only within `size` bytes.
+  for (size_t pos = 0; pos < kMaxSize; ++pos) {
+    src[pos] = 'X';
+    for (size_t start = 0; start <= pos; ++start) {
+      ASSERT_EQ(call_memchr(src + start, 'X', pos - start),
+                static_cast<const char *>(nullptr));
+      ASSERT_EQ(call_memchr(src + start, 'X', kMaxSize - start), src + pos);
+    }
+    src[pos] = 'a';
+  }
+}
@@ -32,3 +32,24 @@ TEST(MemcmpTest, LhsAfterRhsLexically) {
   const char *rhs = "ab";
   EXPECT_EQ(__llvm_libc::memcmp(lhs, rhs, 2), 1);
 }
+
+TEST(MemcmpTest, Sweep) {
+  static constexpr size_t kMaxSize = 1024;
+  char lhs[kMaxSize];
+  char rhs[kMaxSize];
+
+  for (size_t i = 0; i < kMaxSize; ++i)
+    lhs[i] = rhs[i] = 'a';
+
+  for (size_t count = 0; count <= kMaxSize; ++count)
+    ASSERT_EQ(__llvm_libc::memcmp(lhs, rhs, count), 0);
+
+  // A single mismatch is found at every position, whatever the size.
+  for (size_t diff = 0; diff < kMaxSize; ++diff) {
+    rhs[diff] = 'b';
+    for (size_t count = diff + 1; count <= kMaxSize; count += 7)
+      ASSERT_EQ(__llvm_libc::memcmp(lhs, rhs, count), 'a' - 'b');
+    ASSERT_EQ(__llvm_libc::memcmp(lhs, rhs, diff), 0);
+    rhs[diff] = 'a';
+  }
+}
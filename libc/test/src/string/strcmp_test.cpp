@@ -95,3 +95,25 @@ TEST(StrCmpTest, StringArgumentSwapChangesSign) {
   // 'a' - 'b' = -1.
   ASSERT_EQ(result, -1);
 }
+
+TEST(StrCmpTest, Sweep) {
+  static constexpr size_t kMaxSize = 128;
+  char lhs[kMaxSize + 1];
+  char rhs[kMaxSize + 2];
+
+  // The strings start at different alignments.
+  for (size_t i = 0; i < kMaxSize; ++i)
+    lhs[i] = rhs[i + 1] = 'a';
+  lhs[kMaxSize] = rhs[kMaxSize + 1] = '\0';
+  ASSERT_EQ(__llvm_libc::strcmp(lhs, rhs + 1), 0);
+
+  // A single mismatch is found at every position.
+  for (size_t diff = 0; diff < kMaxSize; ++diff) {
+    rhs[diff + 1] = 'b';
+    ASSERT_EQ(__llvm_libc::strcmp(lhs, rhs + 1), 'a' - 'b');
+    ASSERT_EQ(__llvm_libc::strcmp(rhs + 1, lhs), 'b' - 'a');
+    rhs[diff + 1] = '\0';
+    ASSERT_EQ(__llvm_libc::strcmp(lhs, rhs + 1), 'a');
+    rhs[diff + 1] = 'a';
+  }
+}
@@ -22,3 +22,21 @@ TEST(StrLenTest, AnyString) {
   size_t result = __llvm_libc::strlen(any);
   ASSERT_EQ((size_t)12, result);
 }
+
+TEST(StrLenTest, Sweep) {
+  static constexpr size_t kMaxSize = 128;
+  char buffer[kMaxSize + 1];
+  for (size_t i = 0; i < kMaxSize; ++i)
+    buffer[i] = 'a';
+  buffer[kMaxSize] = '\0';
+
+  // Every start alignment and length.
+  for (size_t start = 0; start <= kMaxSize; ++start) {
+    for (size_t length = 0; start + length < kMaxSize; ++length) {
+      buffer[start + length] = '\0';
+      ASSERT_EQ(__llvm_libc::strlen(buffer + start), length);
+      buffer[start + length] = 'a';
+    }
+    ASSERT_EQ(__llvm_libc::strlen(buffer + start), kMaxSize - start);
+  }
+}
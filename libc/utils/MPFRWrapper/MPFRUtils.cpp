@@ -119,6 +119,12 @@ public:
     return result;
   }
 
+  MPFRNumber log() const {
+    MPFRNumber result;
+    mpfr_log(result.value, value, MPFR_RNDN);
+    return result;
+  }
+
   MPFRNumber floor() const {
     MPFRNumber result;
     mpfr_floor(result.value, value);
@@ -267,6 +273,8 @@ unaryOperation(Operation op, InputType input) {
     return mpfrInput.exp2();
   case Operation::Floor:
     return mpfrInput.floor();
+  case Operation::Log:
+    return mpfrInput.log();
   case Operation::Round:
     return mpfrInput.round();
   case Operation::Sin:
@@ -29,6 +29,7 @@ enum class Operation : int {
   Exp,
   Exp2,
   Floor,
+  Log,
   Round,
   Sin,
   Sqrt,
@@ -47,6 +47,31 @@ void BM_ConstructIterIter(benchmark::State& st, Container, GenInputs gen) {
     }
 }
 
+// Grows a container from empty with value-initialized elements, so that the
+// time goes to the reallocations.
+template <class Container>
+void BM_EmplaceBack(benchmark::State& st, Container) {
+    const auto size = st.range(0);
+    for (auto _ : st) {
+        Container c;
+        for (auto i = size; i != 0; --i)
+            c.emplace_back();
+        DoNotOptimizeData(c);
+    }
+}
+
+// Moves the elements to a larger buffer and back.
+template <class Container, class GenInputs>
+void BM_Reallocate(benchmark::State& st, Container, GenInputs gen) {
+    auto in = gen(st.range(0));
+    Container c(in.begin(), in.end());
+    for (auto _ : st) {
+        c.reserve(c.capacity() * 2);
+        c.shrink_to_fit();
+        DoNotOptimizeData(c);
+    }
+}
+
 template <class Container, class GenInputs>
 void BM_InsertValue(benchmark::State& st, Container c, GenInputs gen) {
     auto in = gen(st.range(0));
@@ -12,6 +12,12 @@
 #include "benchmark/benchmark.h"
 #include "test_macros.h"
 
+#if defined(_LIBCPP_HAS_PARALLEL_ALGORITHMS) && TEST_STD_VER > 14
+#include <execution>
+#include <numeric>
+#define HAS_PARALLEL_ALGORITHMS
+#endif
+
 namespace {
 
 enum class ValueType { Uint32, Uint64, Pair, Tuple, String };
@@ -21,6 +27,11 @@ struct AllValueTypes : EnumValuesAsTuple<AllValueTypes, ValueType, 5> {
       "tuple<uint32, uint64, uint32>", "string"};
 };
 
+struct IntegralValueTypes
+    : EnumValuesAsTuple<IntegralValueTypes, ValueType, 2> {
+  static constexpr const char* Names[] = {"uint32", "uint64"};
+};
+
 template <class V>
 using Value = std::conditional_t<
     V() == ValueType::Uint32, uint32_t,
@@ -309,6 +320,85 @@ struct PopHeap {
   };
 };
 
+#ifdef HAS_PARALLEL_ALGORITHMS
+template <class ValueType, class Order>
+struct ParallelSort {
+  size_t Quantity;
+
+  void run(benchmark::State& state) const {
+    runOpOnCopies<ValueType>(
+        state, Quantity, Order(), BatchSize::CountElements, [](auto& Copy) {
+          std::sort(std::execution::par, Copy.begin(), Copy.end());
+        });
+  }
+
+  bool skip() const { return Order() == ::Order::Heap; }
+
+  std::string name() const {
+    return "BM_ParallelSort" + ValueType::name() + Order::name() + "_" +
+           std::to_string(Quantity);
+  };
+};
+
+template <class ValueType, class Order>
+struct ParallelStableSort {
+  size_t Quantity;
+
+  void run(benchmark::State& state) const {
+    runOpOnCopies<ValueType>(
+        state, Quantity, Order(), BatchSize::CountElements, [](auto& Copy) {
+          std::stable_sort(std::execution::par, Copy.begin(), Copy.end());
+        });
+  }
+
+  bool skip() const { return Order() == ::Order::Heap; }
+
+  std::string name() const {
+    return "BM_ParallelStableSort" + ValueType::name() + Order::name() + "_" +
+           std::to_string(Quantity);
+  };
+};
+
+template <class ValueType>
+struct ParallelForEach {
+  size_t Quantity;
+
+  void run(benchmark::State& state) const {
+    runOpOnCopies<ValueType>(
+        state, Quantity, Order::Random, BatchSize::CountElements,
+        [](auto& Copy) {
+          std::for_each(std::execution::par, Copy.begin(), Copy.end(),
+                        [](auto& V) { V = V * 31 + 7; });
+        });
+  }
+
+  std::string name() const {
+    return "BM_ParallelForEach" + ValueType::name() + "_" +
+           std::to_string(Quantity);
+  };
+};
+
+template <class ValueType>
+struct ParallelTransformReduce {
+  size_t Quantity;
+
+  void run(benchmark::State& state) const {
+    runOpOnCopies<ValueType>(
+        state, Quantity, Order::Random, BatchSize::CountElements,
+        [](auto& Copy) {
+          benchmark::DoNotOptimize(std::transform_reduce(
+              std::execution::par, Copy.begin(), Copy.end(), uint64_t(0),
+              std::plus<>(), [](auto V) { return uint64_t(V) * V; }));
+        });
+  }
+
+  std::string name() const {
+    return "BM_ParallelTransformReduce" + ValueType::name() + "_" +
+           std::to_string(Quantity);
+  };
+};
+#endif
+
 } // namespace
 
 int main(int argc, char** argv) {
@@ -333,5 +423,15 @@ int main(int argc, char** argv) {
       Quantities);
   makeCartesianProductBenchmark<PushHeap, AllValueTypes, AllOrders>(Quantities);
   makeCartesianProductBenchmark<PopHeap, AllValueTypes>(Quantities);
+#ifdef HAS_PARALLEL_ALGORITHMS
+  makeCartesianProductBenchmark<ParallelSort, AllValueTypes, AllOrders>(
+      Quantities);
+  makeCartesianProductBenchmark<ParallelStableSort, AllValueTypes, AllOrders>(
+      Quantities);
+  makeCartesianProductBenchmark<ParallelForEach, IntegralValueTypes>(
+      Quantities);
+  makeCartesianProductBenchmark<ParallelTransformReduce, IntegralValueTypes>(
+      Quantities);
+#endif
   benchmark::RunSpecifiedBenchmarks();
 }
\ No newline at end of file
@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/benchmark.h"
+
+#include <atomic>
+#include <barrier>
+#include <cstdint>
+#include <semaphore>
+#include <thread>
+
+// Two threads hand a counter back and forth, each waiting for the other's
+// increment. The 32-bit atomics wait in place, the others through the
+// contention table of the library.
+template <class T>
+static void BM_AtomicWaitPingPong(benchmark::State& st) {
+  std::atomic<T> a(0);
+  std::atomic<bool> done(false);
+  std::thread other([&] {
+    T v = 0;
+    while (true) {
+      a.wait(v);
+      if (done.load())
+        return;
+      v = a.load() + 1;
+      a.store(v);
+      a.notify_one();
+    }
+  });
+  T v = 0;
+  for (auto _ : st) {
+    a.store(++v);
+    a.notify_one();
+    while (a.load() == v)
+      a.wait(v);
+    v = a.load();
+  }
+  done.store(true);
+  a.store(++v);
+  a.notify_one();
+  other.join();
+}
+BENCHMARK_TEMPLATE(BM_AtomicWaitPingPong, std::int32_t)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_AtomicWaitPingPong, std::uint32_t)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_AtomicWaitPingPong, std::uint8_t)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_AtomicWaitPingPong, std::int64_t)->UseRealTime();
+
+static std::barrier<>* Barrier;
+
+// The threads of the benchmark meet at a barrier on each iteration, the way
+// the workers of a thread pool do between the steps of a computation.
+static void BM_BarrierArriveAndWait(benchmark::State& st) {
+  if (st.thread_index == 0)
+    Barrier = new std::barrier<>(st.threads);
+  for (auto _ : st)
+    Barrier->arrive_and_wait();
+  if (st.thread_index == 0)
+    delete Barrier;
+}
+BENCHMARK(BM_BarrierArriveAndWait)->ThreadRange(2, 16)->UseRealTime();
+
+static void BM_SemaphoreReleaseAcquire(benchmark::State& st) {
+  std::counting_semaphore<> sem(0);
+  std::atomic<bool> done(false);
+  std::thread other([&] {
+    while (!done.load())
+      sem.release();
+  });
+  for (auto _ : st)
+    sem.acquire();
+  done.store(true);
+  other.join();
+}
+BENCHMARK(BM_SemaphoreReleaseAcquire)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/benchmark.h"
+
+#include <list>
+#include <memory_resource>
+#include <vector>
+
+struct NewDeleteResource {
+  std::pmr::memory_resource* get() { return std::pmr::new_delete_resource(); }
+};
+
+struct UnsynchronizedPoolResource {
+  std::pmr::unsynchronized_pool_resource Res;
+  std::pmr::memory_resource* get() { return &Res; }
+};
+
+struct SynchronizedPoolResource {
+  std::pmr::synchronized_pool_resource Res;
+  std::pmr::memory_resource* get() { return &Res; }
+};
+
+struct MonotonicBufferResource {
+  std::pmr::monotonic_buffer_resource Res;
+  std::pmr::memory_resource* get() { return &Res; }
+};
+
+// Allocates and deallocates batches of blocks of the same size, the pools
+// serve them from their free lists once warmed up.
+template <class Resource>
+static void BM_AllocateAndDeallocate(benchmark::State& st) {
+  const size_t alloc_size = st.range(0);
+  Resource R;
+  std::pmr::memory_resource* Res = R.get();
+  void* Blocks[64];
+  while (st.KeepRunning()) {
+    for (auto& p : Blocks) {
+      p = Res->allocate(alloc_size);
+      benchmark::DoNotOptimize(p);
+    }
+    for (auto p : Blocks)
+      Res->deallocate(p, alloc_size);
+  }
+}
+
+template <class Resource>
+static void BM_ListPushBack(benchmark::State& st) {
+  const size_t count = st.range(0);
+  while (st.KeepRunning()) {
+    Resource R;
+    std::pmr::list<int> L(R.get());
+    for (size_t i = 0; i != count; ++i)
+      L.push_back(i);
+    benchmark::DoNotOptimize(L);
+  }
+}
+
+template <class Resource>
+static void BM_VectorOfVectors(benchmark::State& st) {
+  const size_t count = st.range(0);
+  while (st.KeepRunning()) {
+    Resource R;
+    std::pmr::vector<std::pmr::vector<int>> V(R.get());
+    for (size_t i = 0; i != count; ++i)
+      V.emplace_back(i % 16, 42);
+    benchmark::DoNotOptimize(V);
+  }
+}
+
+static int RegisterMemoryResourceBenchmarks() {
+  using FnType = void(*)(benchmark::State&);
+  struct {
+    const char* name;
+    FnType func;
+    int from, to;
+  } TestCases[] = {
+      {"BM_NewDelete", &BM_AllocateAndDeallocate<NewDeleteResource>, 8, 4096},
+      {"BM_UnsynchronizedPool", &BM_AllocateAndDeallocate<UnsynchronizedPoolResource>, 8, 4096},
+      {"BM_SynchronizedPool", &BM_AllocateAndDeallocate<SynchronizedPoolResource>, 8, 4096},
+      {"BM_MonotonicBuffer", &BM_AllocateAndDeallocate<MonotonicBufferResource>, 8, 4096},
+      {"BM_ListPushBack_NewDelete", &BM_ListPushBack<NewDeleteResource>, 64, 8192},
+      {"BM_ListPushBack_UnsynchronizedPool", &BM_ListPushBack<UnsynchronizedPoolResource>, 64, 8192},
+      {"BM_ListPushBack_MonotonicBuffer", &BM_ListPushBack<MonotonicBufferResource>, 64, 8192},
+      {"BM_VectorOfVectors_NewDelete", &BM_VectorOfVectors<NewDeleteResource>, 64, 8192},
+      {"BM_VectorOfVectors_UnsynchronizedPool", &BM_VectorOfVectors<UnsynchronizedPoolResource>, 64, 8192},
+      {"BM_VectorOfVectors_MonotonicBuffer", &BM_VectorOfVectors<MonotonicBufferResource>, 64, 8192},
+  };
+  for (auto TC : TestCases) {
+    benchmark::RegisterBenchmark(TC.name, TC.func)->Range(TC.from, TC.to);
+  }
+  return 0;
+}
+int Sink = RegisterMemoryResourceBenchmarks();
+
+BENCHMARK_MAIN();
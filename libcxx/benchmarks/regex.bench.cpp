@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/benchmark.h"
+
+#include <regex>
+#include <string>
+#include <vector>
+
+// Lines of a log, one in ten of which has an error.
+static std::vector<std::string> makeLines() {
+  std::vector<std::string> Lines;
+  for (int I = 0; I != 1000; ++I) {
+    std::string L = "2021-01-01 12:00:00 host" + std::to_string(I % 17) + " ";
+    L += I % 10 == 0 ? "error: code " + std::to_string(I) : "request served in " + std::to_string(I % 97) + "ms";
+    Lines.push_back(L);
+  }
+  return Lines;
+}
+
+static void BM_RegexSearch(benchmark::State& st, std::regex::flag_type Flags) {
+  const std::vector<std::string> Lines = makeLines();
+  const std::regex Re("host[0-9]+ error: code ([0-9]+)", Flags);
+  for (auto _ : st)
+    for (const std::string& L : Lines)
+      benchmark::DoNotOptimize(std::regex_search(L, Re));
+  st.SetItemsProcessed(st.iterations() * Lines.size());
+}
+
+static void BM_RegexSearchSubmatches(benchmark::State& st, std::regex::flag_type Flags) {
+  const std::vector<std::string> Lines = makeLines();
+  const std::regex Re("host([0-9]+) (error: code|request served in) ([0-9]+)", Flags);
+  std::smatch M;
+  for (auto _ : st)
+    for (const std::string& L : Lines)
+      benchmark::DoNotOptimize(std::regex_search(L, M, Re));
+  st.SetItemsProcessed(st.iterations() * Lines.size());
+}
+
+// Exponential for the backtracking matcher.
+static void BM_RegexMatchNested(benchmark::State& st, std::regex::flag_type Flags) {
+  const std::string S(st.range(0), 'a');
+  const std::regex Re("(a|aa)*b", Flags);
+  for (auto _ : st)
+    benchmark::DoNotOptimize(std::regex_match(S, Re));
+}
+
+BENCHMARK_CAPTURE(BM_RegexSearch, backtracking, std::regex::ECMAScript);
+BENCHMARK_CAPTURE(BM_RegexSearch, optimize, std::regex::ECMAScript | std::regex::optimize);
+BENCHMARK_CAPTURE(BM_RegexSearchSubmatches, backtracking, std::regex::ECMAScript);
+BENCHMARK_CAPTURE(BM_RegexSearchSubmatches, optimize, std::regex::ECMAScript | std::regex::optimize);
+BENCHMARK_CAPTURE(BM_RegexMatchNested, backtracking, std::regex::ECMAScript)->Arg(10)->Arg(20);
+BENCHMARK_CAPTURE(BM_RegexMatchNested, optimize, std::regex::ECMAScript | std::regex::optimize)->Arg(10)->Arg(20)->Arg(1000);
+
+BENCHMARK_MAIN();
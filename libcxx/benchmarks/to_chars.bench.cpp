@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "benchmark/benchmark.h"
+
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+// Doubles of all magnitudes, from their random bits.
+static std::vector<double> makeDoubles() {
+  std::mt19937_64 Gen(42);
+  std::vector<double> Values;
+  while (Values.size() < 1024) {
+    const uint64_t Bits = Gen();
+    double D;
+    std::memcpy(&D, &Bits, sizeof(D));
+    if (D == D && D - D == 0)
+      Values.push_back(D);
+  }
+  return Values;
+}
+
+// Doubles with a few decimal digits, the common case of printed values.
+static std::vector<double> makeShortDoubles() {
+  std::mt19937_64 Gen(42);
+  std::vector<double> Values;
+  for (int I = 0; I != 1024; ++I)
+    Values.push_back(static_cast<double>(Gen() % 1000000) / 1000);
+  return Values;
+}
+
+static void BM_ToCharsShortest(benchmark::State& st, std::vector<double> (*gen)()) {
+  const std::vector<double> Values = gen();
+  char Buf[64];
+  for (auto _ : st)
+    for (double D : Values)
+      benchmark::DoNotOptimize(std::to_chars(Buf, Buf + sizeof(Buf), D));
+  st.SetItemsProcessed(st.iterations() * Values.size());
+}
+
+// snprintf has no shortest round trip format, %.17g is its closest one.
+static void BM_SnprintfShortest(benchmark::State& st, std::vector<double> (*gen)()) {
+  const std::vector<double> Values = gen();
+  char Buf[64];
+  for (auto _ : st)
+    for (double D : Values)
+      benchmark::DoNotOptimize(std::snprintf(Buf, sizeof(Buf), "%.17g", D));
+  st.SetItemsProcessed(st.iterations() * Values.size());
+}
+
+static void BM_ToCharsPrecision(benchmark::State& st, std::chars_format Fmt) {
+  const std::vector<double> Values = makeDoubles();
+  const int Precision = st.range(0);
+  char Buf[2048];
+  for (auto _ : st)
+    for (double D : Values)
+      benchmark::DoNotOptimize(std::to_chars(Buf, Buf + sizeof(Buf), D, Fmt, Precision));
+  st.SetItemsProcessed(st.iterations() * Values.size());
+}
+
+static void BM_SnprintfPrecision(benchmark::State& st, const char* Fmt) {
+  const std::vector<double> Values = makeDoubles();
+  const int Precision = st.range(0);
+  char Buf[2048];
+  for (auto _ : st)
+    for (double D : Values)
+      benchmark::DoNotOptimize(std::snprintf(Buf, sizeof(Buf), Fmt, Precision, D));
+  st.SetItemsProcessed(st.iterations() * Values.size());
+}
+
+static std::vector<std::string> makeStrings(std::vector<double> (*gen)()) {
+  std::vector<std::string> Strings;
+  char Buf[64];
+  for (double D : gen())
+    Strings.emplace_back(Buf, std::to_chars(Buf, Buf + sizeof(Buf), D).ptr);
+  return Strings;
+}
+
+static void BM_FromChars(benchmark::State& st, std::vector<double> (*gen)()) {
+  const std::vector<std::string> Strings = makeStrings(gen);
+  for (auto _ : st)
+    for (const std::string& S : Strings) {
+      double D;
+      benchmark::DoNotOptimize(std::from_chars(S.data(), S.data() + S.size(), D));
+      benchmark::DoNotOptimize(D);
+    }
+  st.SetItemsProcessed(st.iterations() * Strings.size());
+}
+
+static void BM_Strtod(benchmark::State& st, std::vector<double> (*gen)()) {
+  const std::vector<std::string> Strings = makeStrings(gen);
+  for (auto _ : st)
+    for (const std::string& S : Strings)
+      benchmark::DoNotOptimize(std::strtod(S.c_str(), nullptr));
+  st.SetItemsProcessed(st.iterations() * Strings.size());
+}
+
+BENCHMARK_CAPTURE(BM_ToCharsShortest, random, makeDoubles);
+BENCHMARK_CAPTURE(BM_ToCharsShortest, short, makeShortDoubles);
+BENCHMARK_CAPTURE(BM_SnprintfShortest, random, makeDoubles);
+BENCHMARK_CAPTURE(BM_SnprintfShortest, short, makeShortDoubles);
+
+BENCHMARK_CAPTURE(BM_ToCharsPrecision, scientific, std::chars_format::scientific)->Arg(6)->Arg(17)->Arg(100);
+BENCHMARK_CAPTURE(BM_SnprintfPrecision, scientific, "%.*e")->Arg(6)->Arg(17)->Arg(100);
+BENCHMARK_CAPTURE(BM_ToCharsPrecision, fixed, std::chars_format::fixed)->Arg(6)->Arg(17)->Arg(100);
+BENCHMARK_CAPTURE(BM_SnprintfPrecision, fixed, "%.*f")->Arg(6)->Arg(17)->Arg(100);
+BENCHMARK_CAPTURE(BM_ToCharsPrecision, general, std::chars_format::general)->Arg(6)->Arg(17);
+BENCHMARK_CAPTURE(BM_SnprintfPrecision, general, "%.*g")->Arg(6)->Arg(17);
+BENCHMARK_CAPTURE(BM_ToCharsPrecision, hex, std::chars_format::hex)->Arg(6)->Arg(13);
+BENCHMARK_CAPTURE(BM_SnprintfPrecision, hex, "%.*a")->Arg(6)->Arg(13);
+
+BENCHMARK_CAPTURE(BM_FromChars, random, makeDoubles);
+BENCHMARK_CAPTURE(BM_FromChars, short, makeShortDoubles);
+BENCHMARK_CAPTURE(BM_Strtod, random, makeDoubles);
+BENCHMARK_CAPTURE(BM_Strtod, short, makeShortDoubles);
+
+BENCHMARK_MAIN();
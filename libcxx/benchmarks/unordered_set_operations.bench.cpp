@@ -304,4 +304,58 @@ BENCHMARK_CAPTURE(BM_EmplaceDuplicate,
     std::unordered_set<std::string>{},
     getRandomCStringInputs)->Arg(TestNumInputs);
 
+//----------------------------------------------------------------------------//
+//                         __flat_hash_set
+// ---------------------------------------------------------------------------//
+
+BENCHMARK_CAPTURE(BM_InsertValue,
+    flat_hash_set_uint32,
+    std::__flat_hash_set<uint32_t>{},
+    getRandomIntegerInputs<uint32_t>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_InsertValue,
+    flat_hash_set_top_bits_uint32,
+    std::__flat_hash_set<uint32_t>{},
+    getSortedTopBitsIntegerInputs<uint32_t>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_InsertValueRehash,
+    flat_hash_set_string,
+    std::__flat_hash_set<std::string>{},
+    getRandomStringInputs)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_Find,
+    flat_hash_set_random_uint64,
+    std::__flat_hash_set<uint64_t>{},
+    getRandomIntegerInputs<uint64_t>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_Find,
+    flat_hash_set_sorted_uint64,
+    std::__flat_hash_set<uint64_t>{},
+    getSortedIntegerInputs<uint64_t>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_Find,
+    flat_hash_set_top_bits_uint64,
+    std::__flat_hash_set<uint64_t>{},
+    getSortedTopBitsIntegerInputs<uint64_t>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_FindRehash,
+    flat_hash_set_sorted_large_uint64,
+    std::__flat_hash_set<uint64_t>{},
+    getSortedLargeIntegerInputs<uint64_t>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_Find,
+    flat_hash_set_string,
+    std::__flat_hash_set<std::string>{},
+    getRandomStringInputs)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_InsertDuplicate,
+    flat_hash_set_int,
+    std::__flat_hash_set<int>{},
+    getRandomIntegerInputs<int>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_EmplaceDuplicate,
+    flat_hash_set_string,
+    std::__flat_hash_set<std::string>{},
+    getRandomStringInputs)->Arg(TestNumInputs);
+
 BENCHMARK_MAIN();
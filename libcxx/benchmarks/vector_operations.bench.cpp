@@ -3,6 +3,8 @@
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
+#include <string>
 
 #include "benchmark/benchmark.h"
 
@@ -36,5 +38,30 @@ BENCHMARK_CAPTURE(BM_ConstructIterIter,
   std::vector<std::string>{},
   getRandomStringInputs)->Arg(TestNumInputs);
 
+BENCHMARK_CAPTURE(BM_EmplaceBack,
+  vector_size_t,
+  std::vector<size_t>{})->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_EmplaceBack,
+  vector_string,
+  std::vector<std::string>{})->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_EmplaceBack,
+  vector_unique_ptr,
+  std::vector<std::unique_ptr<int>>{})->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_EmplaceBack,
+  vector_shared_ptr,
+  std::vector<std::shared_ptr<int>>{})->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_Reallocate,
+  vector_size_t,
+  std::vector<size_t>{},
+  getRandomIntegerInputs<size_t>)->Arg(TestNumInputs);
+
+BENCHMARK_CAPTURE(BM_Reallocate,
+  vector_string,
+  std::vector<std::string>{},
+  getRandomStringInputs)->Arg(TestNumInputs);
 
 BENCHMARK_MAIN();
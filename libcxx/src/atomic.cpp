@@ -10,8 +10,8 @@
 #ifndef _LIBCPP_HAS_NO_THREADS
 
 #include <climits>
+#include <cstdint>
 #include <atomic>
-#include <functional>
 
 #ifdef __linux__
 
@@ -81,23 +81,45 @@ static void __libcpp_platform_wake_by_address(__cxx_atomic_contention_t const vo
 
 #endif // __linux__
 
-static constexpr size_t __libcpp_contention_table_size = (1 << 8);  /* < there's no magic in this number */
+static constexpr int __libcpp_contention_table_bits = 10;
+static constexpr size_t __libcpp_contention_table_size = size_t(1) << __libcpp_contention_table_bits;
+
+/* The waiters spin on the monitored value before parking, for a number of polls learnt per entry:
+   it doubles when a wait ends while spinning, and halves when the waiter has to park. The notifiers
+   of a spinning waiter skip the system call. */
+static constexpr __cxx_contention_t __libcpp_contention_min_spin = 16;
+static constexpr __cxx_contention_t __libcpp_contention_max_spin = 4096;
 
 struct alignas(64) /*  aim to avoid false sharing */ __libcpp_contention_table_entry
 {
     __cxx_atomic_contention_t __contention_state;
     __cxx_atomic_contention_t __platform_state;
+    __cxx_atomic_contention_t __spin_budget;
     inline constexpr __libcpp_contention_table_entry() :
-        __contention_state(0), __platform_state(0) { }
+        __contention_state(0), __platform_state(0), __spin_budget(__libcpp_contention_min_spin * 8) { }
 };
 
 static __libcpp_contention_table_entry __libcpp_contention_table[ __libcpp_contention_table_size ];
 
-static hash<void const volatile*> __libcpp_contention_hasher;
-
 static __libcpp_contention_table_entry* __libcpp_contention_state(void const volatile * p)
 {
-    return &__libcpp_contention_table[__libcpp_contention_hasher(p) & (__libcpp_contention_table_size - 1)];
+    // Fibonacci hashing: the index is taken from the high bits of the product, which all the bits
+    // of the address contribute to.
+#if UINTPTR_MAX > 0xFFFFFFFF
+    uintptr_t const __h = reinterpret_cast<uintptr_t>(p) * uintptr_t(0x9E3779B97F4A7C15ull);
+#else
+    uintptr_t const __h = reinterpret_cast<uintptr_t>(p) * uintptr_t(0x9E3779B9u);
+#endif
+    return &__libcpp_contention_table[__h >> (sizeof(uintptr_t) * CHAR_BIT - __libcpp_contention_table_bits)];
+}
+
+static inline void __libcpp_cpu_relax()
+{
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
 }
 
 /* Given an atomic to track contention and an atomic to actually wait on, which may be
@@ -117,14 +139,26 @@ static __cxx_contention_t __libcpp_contention_monitor_for_wait(__cxx_atomic_cont
     // We will monitor this value.
     return __cxx_atomic_load(__platform_state, memory_order_acquire);
 }
-static void __libcpp_contention_wait(__cxx_atomic_contention_t volatile* __contention_state,
+static void __libcpp_contention_wait(__libcpp_contention_table_entry* __entry,
                                      __cxx_atomic_contention_t const volatile* __platform_state,
                                      __cxx_contention_t __old_value)
 {
-    __cxx_atomic_fetch_add(__contention_state, __cxx_contention_t(1), memory_order_seq_cst);
+    __cxx_contention_t const __budget = __cxx_atomic_load(&__entry->__spin_budget, memory_order_relaxed);
+    for(__cxx_contention_t __i = 0; __i < __budget; ++__i) {
+        if(!__cxx_nonatomic_compare_equal(__cxx_atomic_load(__platform_state, memory_order_relaxed), __old_value)) {
+            if(__budget < __libcpp_contention_max_spin)
+                __cxx_atomic_store(&__entry->__spin_budget, __budget * 2, memory_order_relaxed);
+            return;
+        }
+        __libcpp_cpu_relax();
+    }
+    if(__budget > __libcpp_contention_min_spin)
+        __cxx_atomic_store(&__entry->__spin_budget, __budget / 2, memory_order_relaxed);
+
+    __cxx_atomic_fetch_add(&__entry->__contention_state, __cxx_contention_t(1), memory_order_seq_cst);
     // We sleep as long as the monitored value hasn't changed.
     __libcpp_platform_wait_on_address(__platform_state, __old_value);
-    __cxx_atomic_fetch_sub(__contention_state, __cxx_contention_t(1), memory_order_release);
+    __cxx_atomic_fetch_sub(&__entry->__contention_state, __cxx_contention_t(1), memory_order_release);
 }
 
 /* When the incoming atomic is the wrong size for the platform wait size, need to
@@ -155,7 +189,7 @@ _LIBCPP_EXPORTED_FROM_ABI
 void __libcpp_atomic_wait(void const volatile* __location, __cxx_contention_t __old_value)
 {
     auto const __entry = __libcpp_contention_state(__location);
-    __libcpp_contention_wait(&__entry->__contention_state, &__entry->__platform_state, __old_value);
+    __libcpp_contention_wait(__entry, &__entry->__platform_state, __old_value);
 }
 
 /* When the incoming atomic happens to be the platform wait size, we still need to use the
@@ -179,7 +213,7 @@ __cxx_contention_t __libcpp_atomic_monitor(__cxx_atomic_contention_t const volat
 _LIBCPP_EXPORTED_FROM_ABI
 void __libcpp_atomic_wait(__cxx_atomic_contention_t const volatile* __location, __cxx_contention_t __old_value)
 {
-    __libcpp_contention_wait(&__libcpp_contention_state(__location)->__contention_state, __location, __old_value);
+    __libcpp_contention_wait(__libcpp_contention_state(__location), __location, __old_value);
 }
 
 _LIBCPP_END_NAMESPACE_STD
@@ -0,0 +1,148 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef _LIBCPP_SRC_INCLUDE_BIG_INTEGER_H
+#define _LIBCPP_SRC_INCLUDE_BIG_INTEGER_H
+
+#include "__config"
+#include "__debug"
+#include "cstdint"
+
+_LIBCPP_BEGIN_NAMESPACE_STD
+
+// A fixed capacity unsigned integer, for the exact conversions between
+// binary floating-point and decimal in <charconv>. 4096 bits are enough for
+// all the values those compare or print, the largest being the products of
+// the 800 decimal digits taken into account when parsing by a power of 5.
+class __big_integer {
+public:
+  static const int __capacity = 128;
+
+  __big_integer() : __size_(0) {}
+
+  explicit __big_integer(uint64_t __value) : __size_(0) {
+    while (__value != 0) {
+      __limbs_[__size_++] = static_cast<uint32_t>(__value);
+      __value >>= 32;
+    }
+  }
+
+  bool __is_zero() const { return __size_ == 0; }
+
+  void __mul_small(uint32_t __m) {
+    uint64_t __carry = 0;
+    for (int __i = 0; __i != __size_; ++__i) {
+      const uint64_t __p = static_cast<uint64_t>(__limbs_[__i]) * __m + __carry;
+      __limbs_[__i] = static_cast<uint32_t>(__p);
+      __carry = __p >> 32;
+    }
+    __push_carry(__carry);
+  }
+
+  void __add_small(uint32_t __a) {
+    uint64_t __carry = __a;
+    for (int __i = 0; __carry != 0 && __i != __size_; ++__i) {
+      const uint64_t __s = static_cast<uint64_t>(__limbs_[__i]) + __carry;
+      __limbs_[__i] = static_cast<uint32_t>(__s);
+      __carry = __s >> 32;
+    }
+    __push_carry(__carry);
+  }
+
+  void __mul_pow5(uint32_t __n) {
+    // 5^13 is the largest power of 5 that fits in 32 bits.
+    for (; __n >= 13; __n -= 13)
+      __mul_small(1220703125u);
+    static const uint32_t __small_pow5[13] = {
+        1,      5,       25,      125,      625,      3125,     15625,
+        78125,  390625,  1953125, 9765625,  48828125, 244140625};
+    if (__n != 0)
+      __mul_small(__small_pow5[__n]);
+  }
+
+  void __shift_left(uint32_t __n) {
+    if (__size_ == 0)
+      return;
+    const int __limbs = static_cast<int>(__n / 32);
+    const uint32_t __bits = __n % 32;
+    _LIBCPP_ASSERT(__size_ + __limbs + 1 <= __capacity,
+                   "__big_integer overflow");
+    if (__bits == 0) {
+      for (int __i = __size_ - 1; __i >= 0; --__i)
+        __limbs_[__i + __limbs] = __limbs_[__i];
+    } else {
+      __limbs_[__size_ + __limbs] = __limbs_[__size_ - 1] >> (32 - __bits);
+      for (int __i = __size_ - 1; __i > 0; --__i)
+        __limbs_[__i + __limbs] =
+            (__limbs_[__i] << __bits) | (__limbs_[__i - 1] >> (32 - __bits));
+      __limbs_[__limbs] = __limbs_[0] << __bits;
+    }
+    for (int __i = 0; __i != __limbs; ++__i)
+      __limbs_[__i] = 0;
+    __size_ += __limbs + (__bits != 0);
+    __trim();
+  }
+
+  // Divides by __d and returns the remainder.
+  uint32_t __div_small(uint32_t __d) {
+    uint64_t __rem = 0;
+    for (int __i = __size_ - 1; __i >= 0; --__i) {
+      const uint64_t __cur = (__rem << 32) | __limbs_[__i];
+      __limbs_[__i] = static_cast<uint32_t>(__cur / __d);
+      __rem = __cur % __d;
+    }
+    __trim();
+    return static_cast<uint32_t>(__rem);
+  }
+
+  // Removes the bits from __k up and returns them, they must fit in 32 bits.
+  uint32_t __take_bits_from(uint32_t __k) {
+    const int __limb = static_cast<int>(__k / 32);
+    const uint32_t __bit = __k % 32;
+    if (__limb >= __size_)
+      return 0;
+    uint64_t __high = __limbs_[__limb];
+    if (__limb + 1 < __size_)
+      __high |= static_cast<uint64_t>(__limbs_[__limb + 1]) << 32;
+    _LIBCPP_ASSERT(__limb + 2 >= __size_ && (__high >> __bit) >> 32 == 0,
+                   "bits do not fit");
+    __limbs_[__limb] &= (uint32_t(1) << __bit) - 1;
+    __size_ = __limb + 1;
+    __trim();
+    return static_cast<uint32_t>(__high >> __bit);
+  }
+
+  friend int __compare(const __big_integer& __x, const __big_integer& __y) {
+    if (__x.__size_ != __y.__size_)
+      return __x.__size_ < __y.__size_ ? -1 : 1;
+    for (int __i = __x.__size_ - 1; __i >= 0; --__i)
+      if (__x.__limbs_[__i] != __y.__limbs_[__i])
+        return __x.__limbs_[__i] < __y.__limbs_[__i] ? -1 : 1;
+    return 0;
+  }
+
+private:
+  void __push_carry(uint64_t __carry) {
+    if (__carry != 0) {
+      _LIBCPP_ASSERT(__size_ < __capacity, "__big_integer overflow");
+      __limbs_[__size_++] = static_cast<uint32_t>(__carry);
+    }
+  }
+
+  void __trim() {
+    while (__size_ != 0 && __limbs_[__size_ - 1] == 0)
+      --__size_;
+  }
+
+  uint32_t __limbs_[__capacity];
+  int __size_;
+};
+
+_LIBCPP_END_NAMESPACE_STD
+
+#endif // _LIBCPP_SRC_INCLUDE_BIG_INTEGER_H
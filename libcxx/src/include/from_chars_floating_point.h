@@ -0,0 +1,454 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef _LIBCPP_SRC_INCLUDE_FROM_CHARS_FLOATING_POINT_H
+#define _LIBCPP_SRC_INCLUDE_FROM_CHARS_FLOATING_POINT_H
+
+#include "__config"
+#include "charconv"
+#include "cstdint"
+#include "cstring"
+#include "limits"
+
+#include "big_integer.h"
+#include "from_chars_pow5_table.h"
+#include "ryu/common.h"              // for __ryu_umul128
+#include "to_chars_floating_point.h" // for __float_traits
+
+_LIBCPP_BEGIN_NAMESPACE_STD
+
+// The decimal exponents beyond which a value always overflows, or always
+// rounds to zero: a value below 10^__min_exponent10 is less than half the
+// smallest subnormal.
+template <class _Fp>
+struct __decimal_range;
+
+template <>
+struct __decimal_range<float> {
+  static const int __max_exponent10 = 39;
+  static const int __min_exponent10 = -46;
+};
+
+template <>
+struct __decimal_range<double> {
+  static const int __max_exponent10 = 309;
+  static const int __min_exponent10 = -324;
+};
+
+struct __uint192 {
+  uint64_t __w[3]; // least significant first
+};
+
+inline int __bit_length(const __uint192& __x) {
+  for (int __i = 2; __i >= 0; --__i)
+    if (__x.__w[__i] != 0)
+      return 64 * __i + 64 - __builtin_clzll(__x.__w[__i]);
+  return 0;
+}
+
+inline bool __bit(const __uint192& __x, int __i) {
+  return __i < 192 && ((__x.__w[__i / 64] >> (__i % 64)) & 1) != 0;
+}
+
+// Returns whether any of the bits below __i is set.
+inline bool __any_bit_below(const __uint192& __x, int __i) {
+  for (int __j = 0; __j != 3; ++__j) {
+    if (__i <= 64 * __j)
+      return false;
+    const uint64_t __mask = __i >= 64 * __j + 64
+                                ? ~uint64_t(0)
+                                : (uint64_t(1) << (__i - 64 * __j)) - 1;
+    if ((__x.__w[__j] & __mask) != 0)
+      return true;
+  }
+  return false;
+}
+
+// Returns the 64 bits from __i up.
+inline uint64_t __bits_from(const __uint192& __x, int __i) {
+  if (__i >= 192)
+    return 0;
+  const int __j = __i / 64;
+  const int __s = __i % 64;
+  uint64_t __r = __x.__w[__j] >> __s;
+  if (__s != 0 && __j < 2)
+    __r |= __x.__w[__j + 1] << (64 - __s);
+  return __r;
+}
+
+inline void __add(__uint192& __x, uint64_t __lo, uint64_t __hi) {
+  __x.__w[0] += __lo;
+  const uint64_t __c0 = __x.__w[0] < __lo;
+  __x.__w[1] += __hi;
+  const uint64_t __c1 = __x.__w[1] < __hi;
+  __x.__w[1] += __c0;
+  __x.__w[2] += __c1 + (__x.__w[1] < __c0);
+}
+
+// Returns __w * {__hi, __lo}.
+inline __uint192 __multiply(uint64_t __w, uint64_t __hi, uint64_t __lo) {
+  __uint192 __x;
+  uint64_t __high0;
+  __x.__w[0] = __ryu_umul128(__w, __lo, &__high0);
+  __x.__w[1] = __ryu_umul128(__w, __hi, &__x.__w[2]);
+  __x.__w[2] += (__x.__w[1] += __high0) < __high0;
+  return __x;
+}
+
+// Returns the bits of the positive infinity of _Fp.
+template <class _Fp>
+uint64_t __infinity_bits() {
+  typedef __float_traits<_Fp> _Traits;
+  return uint64_t((1 << _Traits::__exponent_bits) - 1)
+         << _Traits::__mantissa_bits;
+}
+
+// Rounds __x * 2^__e half to even to _Fp, returning its bits without the
+// sign: those of infinity on overflow, or zero.
+template <class _Fp>
+uint64_t __round_to_bits(const __uint192& __x, int __e) {
+  typedef __float_traits<_Fp> _Traits;
+  const int __mantissa_bits = _Traits::__mantissa_bits;
+  const int __max_exponent = _Traits::__exponent_bias;
+  const int __min_exponent = 1 - _Traits::__exponent_bias;
+  const uint64_t __infinity = __infinity_bits<_Fp>();
+
+  const int __length = __bit_length(__x);
+  if (__length == 0)
+    return 0;
+  int __exponent = __length - 1 + __e;
+  if (__exponent > __max_exponent)
+    return __infinity;
+  if (__exponent < __min_exponent)
+    __exponent = __min_exponent;
+
+  // The number of bits below the last one of the mantissa.
+  const int __shift = __exponent - __mantissa_bits - __e;
+  uint64_t __m;
+  if (__shift <= 0) {
+    __m = __x.__w[0] << -__shift;
+  } else {
+    __m = __bits_from(__x, __shift);
+    if (__bit(__x, __shift - 1) &&
+        ((__m & 1) != 0 || __any_bit_below(__x, __shift - 1)))
+      ++__m;
+    if ((__m >> (__mantissa_bits + 1)) != 0) {
+      __m >>= 1;
+      if (++__exponent > __max_exponent)
+        return __infinity;
+    }
+  }
+  if ((__m >> __mantissa_bits) == 0)
+    return __m; // subnormal
+  return (uint64_t(__exponent + _Traits::__exponent_bias) << __mantissa_bits) |
+         (__m & ((uint64_t(1) << __mantissa_bits) - 1));
+}
+
+inline bool __is_digit(char __c, bool __hex) {
+  if ('0' <= __c && __c <= '9')
+    return true;
+  return __hex && (('a' <= __c && __c <= 'f') || ('A' <= __c && __c <= 'F'));
+}
+
+inline uint32_t __digit_value(char __c) {
+  if (__c <= '9')
+    return __c - '0';
+  return (__c | 0x20) - 'a' + 10;
+}
+
+// Returns whether [__p, __last) starts with the lower case __s, ignoring
+// case.
+inline bool __starts_with(const char* __p, const char* __last,
+                          const char* __s, size_t __n) {
+  if (static_cast<size_t>(__last - __p) < __n)
+    return false;
+  for (size_t __i = 0; __i != __n; ++__i)
+    if ((__p[__i] | 0x20) != __s[__i])
+      return false;
+  return true;
+}
+
+// The significand of a number being parsed, the digits in [__first, __last)
+// with an optional point after the first __int_digits of them.
+struct __significand {
+  const char* __first;
+  const char* __last;
+  long long __int_digits;
+  bool __hex;
+};
+
+// The first up to __max significant digits of a significand, __index being
+// the index of the first of them among all the digits, and __truncated
+// whether any of the remaining digits is not zero.
+struct __leading_digits {
+  uint64_t __value;
+  long long __index;
+  int __count;
+  bool __truncated;
+};
+
+inline __leading_digits __read_leading_digits(const __significand& __s,
+                                              int __max) {
+  __leading_digits __r = {0, 0, 0, false};
+  const uint32_t __base = __s.__hex ? 16 : 10;
+  for (const char* __p = __s.__first; __p != __s.__last; ++__p) {
+    if (*__p == '.')
+      continue;
+    const uint32_t __d = __digit_value(*__p);
+    if (__r.__count == __max) {
+      if (__d != 0) {
+        __r.__truncated = true;
+        break;
+      }
+    } else if (__r.__count != 0 || __d != 0) {
+      __r.__value = __r.__value * __base + __d;
+      ++__r.__count;
+    } else {
+      ++__r.__index;
+    }
+  }
+  return __r;
+}
+
+// Returns the sign of __d * 10^__q - __h * 2^__k.
+inline int __compare_exact(const __big_integer& __d, int __q, uint64_t __h,
+                           int __k) {
+  __big_integer __left = __d;
+  __big_integer __right(__h);
+  if (__q >= 0)
+    __left.__mul_pow5(static_cast<uint32_t>(__q));
+  else
+    __right.__mul_pow5(static_cast<uint32_t>(-__q));
+  if (__q > __k)
+    __left.__shift_left(static_cast<uint32_t>(__q - __k));
+  else
+    __right.__shift_left(static_cast<uint32_t>(__k - __q));
+  return __compare(__left, __right);
+}
+
+// Returns the bits of the decimal significand times 10^__exponent rounded to
+// _Fp, given those of a value rounded from below it by at most a few units.
+// Compares the exact value with the halfway points above the candidate.
+template <class _Fp>
+uint64_t __round_exact_decimal(const __significand& __s, long long __exponent,
+                               uint64_t __bits) {
+  typedef __float_traits<_Fp> _Traits;
+  // Halfway points have at most 767 significant digits, so the first 800
+  // digits followed by a 1 standing for any other nonzero ones round the
+  // same as the whole significand.
+  const int __max_digits = 800;
+  __big_integer __d;
+  long long __index = 0;
+  int __count = 0;
+  uint32_t __chunk = 0;
+  int __chunk_digits = 0;
+  bool __truncated = false;
+  for (const char* __p = __s.__first; __p != __s.__last; ++__p) {
+    if (*__p == '.')
+      continue;
+    const uint32_t __v = static_cast<uint32_t>(*__p - '0');
+    if (__count == __max_digits) {
+      if (__v != 0) {
+        __truncated = true;
+        break;
+      }
+    } else if (__count != 0 || __v != 0) {
+      __chunk = __chunk * 10 + __v;
+      ++__count;
+      if (++__chunk_digits == 9) {
+        __d.__mul_small(1000000000);
+        __d.__add_small(__chunk);
+        __chunk = 0;
+        __chunk_digits = 0;
+      }
+    } else {
+      ++__index;
+    }
+  }
+  if (__truncated) {
+    __chunk = __chunk * 10 + 1;
+    ++__chunk_digits;
+  }
+  if (__chunk_digits != 0) {
+    uint32_t __scale = 10;
+    while (--__chunk_digits != 0)
+      __scale *= 10;
+    __d.__mul_small(__scale);
+    __d.__add_small(__chunk);
+  }
+  const int __q = static_cast<int>(__exponent + __s.__int_digits - __index -
+                                   __count - __truncated);
+
+  for (; __bits != __infinity_bits<_Fp>(); ++__bits) {
+    const uint32_t __e =
+        static_cast<uint32_t>(__bits >> _Traits::__mantissa_bits);
+    uint64_t __m = __bits & ((uint64_t(1) << _Traits::__mantissa_bits) - 1);
+    int __k = 1 - _Traits::__exponent_bias - _Traits::__mantissa_bits;
+    if (__e != 0) {
+      __m |= uint64_t(1) << _Traits::__mantissa_bits;
+      __k += static_cast<int>(__e) - 1;
+    }
+    // The halfway point to the next value is (2 * __m + 1) * 2^(__k - 1).
+    const int __c = __compare_exact(__d, __q, 2 * __m + 1, __k - 1);
+    if (__c < 0 || (__c == 0 && (__m & 1) == 0))
+      break;
+  }
+  return __bits;
+}
+
+// Returns the bits of the decimal significand times 10^__exponent rounded to
+// _Fp, the bits of infinity when it overflows.
+template <class _Fp>
+uint64_t __decimal_to_bits(const __significand& __s, long long __exponent) {
+  const __leading_digits __w = __read_leading_digits(__s, 19);
+  if (__w.__value == 0)
+    return 0;
+  // The value is about __w.__value * 10^__q.
+  const long long __q =
+      __exponent + __s.__int_digits - __w.__index - __w.__count;
+  if (__q + __w.__count - 1 >= __decimal_range<_Fp>::__max_exponent10)
+    return __infinity_bits<_Fp>();
+  if (__q + __w.__count <= __decimal_range<_Fp>::__min_exponent10)
+    return 0;
+
+  // 10^__q is in [__t, __t + 1) * 2^__e, so the value is in [__lo, __hi) *
+  // 2^__e. When rounding both bounds gives the same result, it is the one of
+  // the value too.
+  const int __qi = static_cast<int>(__q);
+  const uint64_t* __t = __POW5_128[__qi - __POW5_128_MIN_EXPONENT];
+  // floor(log2(5^__q)) - 127 + __q
+  const int __e = ((__qi * 217706) >> 16) - 127;
+  const __uint192 __lo = __multiply(__w.__value, __t[0], __t[1]);
+  const uint64_t __lo_bits = __round_to_bits<_Fp>(__lo, __e);
+  const bool __exact_power = 0 <= __qi && __qi <= 55;
+  if (__exact_power && !__w.__truncated)
+    return __lo_bits;
+  __uint192 __hi = __lo;
+  if (!__exact_power)
+    __add(__hi, __w.__value, 0);
+  if (__w.__truncated) {
+    __add(__hi, __t[1], __t[0]);
+    __add(__hi, 1, 0);
+  }
+  if (__round_to_bits<_Fp>(__hi, __e) == __lo_bits)
+    return __lo_bits;
+  return __round_exact_decimal<_Fp>(__s, __exponent, __lo_bits);
+}
+
+// Returns the bits of the hexadecimal significand times 2^__exponent rounded
+// to _Fp.
+template <class _Fp>
+uint64_t __hex_to_bits(const __significand& __s, long long __exponent) {
+  const __leading_digits __w = __read_leading_digits(__s, 16);
+  if (__w.__value == 0)
+    return 0;
+  long long __e =
+      __exponent + 4 * (__s.__int_digits - __w.__index - __w.__count);
+  // Far enough to overflow or round to zero in any case.
+  const long long __bound = 4 * 1024;
+  if (__e > __bound)
+    __e = __bound;
+  else if (__e < -__bound)
+    __e = -__bound;
+  // One more bit below those of the digits, set when some are dropped.
+  __uint192 __x = {
+      {(__w.__value << 1) | __w.__truncated, __w.__value >> 63, 0}};
+  return __round_to_bits<_Fp>(__x, static_cast<int>(__e) - 1);
+}
+
+// Implements from_chars for float and double.
+template <class _Fp>
+from_chars_result __floating_from_chars(const char* __first,
+                                        const char* __last, _Fp& __value,
+                                        chars_format __fmt) {
+  typedef numeric_limits<_Fp> _Limits;
+  const char* __p = __first;
+  const bool __negative = __p != __last && *__p == '-';
+  if (__negative)
+    ++__p;
+
+  if (__starts_with(__p, __last, "inf", 3)) {
+    __p += 3;
+    if (__starts_with(__p, __last, "inity", 5))
+      __p += 5;
+    __value = __negative ? -_Limits::infinity() : _Limits::infinity();
+    return {__p, errc()};
+  }
+  if (__starts_with(__p, __last, "nan", 3)) {
+    __p += 3;
+    if (__p != __last && *__p == '(') {
+      const char* __q = __p + 1;
+      while (__q != __last &&
+             (__is_digit(*__q, false) || *__q == '_' ||
+              ('a' <= (*__q | 0x20) && (*__q | 0x20) <= 'z')))
+        ++__q;
+      if (__q != __last && *__q == ')')
+        __p = __q + 1;
+    }
+    __value = __negative ? -_Limits::quiet_NaN() : _Limits::quiet_NaN();
+    return {__p, errc()};
+  }
+
+  __significand __s;
+  __s.__hex = __fmt == chars_format::hex;
+  __s.__first = __p;
+  while (__p != __last && __is_digit(*__p, __s.__hex))
+    ++__p;
+  __s.__int_digits = __p - __s.__first;
+  bool __has_digits = __s.__int_digits != 0;
+  if (__p != __last && *__p == '.') {
+    ++__p;
+    if (__p != __last && __is_digit(*__p, __s.__hex))
+      __has_digits = true;
+    while (__p != __last && __is_digit(*__p, __s.__hex))
+      ++__p;
+  }
+  if (!__has_digits)
+    return {__first, errc::invalid_argument};
+  __s.__last = __p;
+
+  long long __exponent = 0;
+  bool __has_exponent = false;
+  if (__fmt != chars_format::fixed && __p != __last &&
+      (*__p | 0x20) == (__s.__hex ? 'p' : 'e')) {
+    const char* __q = __p + 1;
+    const bool __negative_exponent = __q != __last && *__q == '-';
+    if (__q != __last && (*__q == '+' || *__q == '-'))
+      ++__q;
+    if (__q != __last && __is_digit(*__q, false)) {
+      for (; __q != __last && __is_digit(*__q, false); ++__q)
+        if (__exponent < 100000000)
+          __exponent = 10 * __exponent + (*__q - '0');
+      if (__negative_exponent)
+        __exponent = -__exponent;
+      __has_exponent = true;
+      __p = __q;
+    }
+  }
+  if (__fmt == chars_format::scientific && !__has_exponent)
+    return {__first, errc::invalid_argument};
+
+  typedef __float_traits<_Fp> _Traits;
+  const uint64_t __bits = __s.__hex ? __hex_to_bits<_Fp>(__s, __exponent)
+                                    : __decimal_to_bits<_Fp>(__s, __exponent);
+  if (__bits == __infinity_bits<_Fp>())
+    return {__p, errc::result_out_of_range};
+  if (__bits == 0 && __read_leading_digits(__s, 1).__value != 0)
+    return {__p, errc::result_out_of_range};
+
+  typedef typename _Traits::__uint_type _Uint;
+  _Uint __ieee = static_cast<_Uint>(__bits);
+  if (__negative)
+    __ieee |= _Uint(1) << (_Traits::__mantissa_bits + _Traits::__exponent_bits);
+  memcpy(&__value, &__ieee, sizeof(__value));
+  return {__p, errc()};
+}
+
+_LIBCPP_END_NAMESPACE_STD
+
+#endif // _LIBCPP_SRC_INCLUDE_FROM_CHARS_FLOATING_POINT_H
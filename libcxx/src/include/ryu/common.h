@@ -0,0 +1,119 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// Adapted from Ryu (https://github.com/ulfjack/ryu), Copyright 2018 Ulf Adams,
+// available under the Apache License 2.0 and the Boost Software License 1.0.
+
+#ifndef _LIBCPP_SRC_INCLUDE_RYU_COMMON_H
+#define _LIBCPP_SRC_INCLUDE_RYU_COMMON_H
+
+#include "__config"
+#include "__debug"
+#include "cstdint"
+
+_LIBCPP_BEGIN_NAMESPACE_STD
+
+// Returns ceil(log2(5^__e)), or 1 for __e == 0. Exact for 0 <= __e <= 3528.
+inline int32_t __pow5bits(const int32_t __e) {
+  return static_cast<int32_t>(
+      ((static_cast<uint32_t>(__e) * 1217359) >> 19) + 1);
+}
+
+// Returns floor(log10(2^__e)). Exact for 0 <= __e <= 1650.
+inline uint32_t __log10Pow2(const int32_t __e) {
+  return (static_cast<uint32_t>(__e) * 78913) >> 18;
+}
+
+// Returns floor(log10(5^__e)). Exact for 0 <= __e <= 2620.
+inline uint32_t __log10Pow5(const int32_t __e) {
+  return (static_cast<uint32_t>(__e) * 732923) >> 20;
+}
+
+inline uint32_t __pow5Factor(uint64_t __value) {
+  uint32_t __count = 0;
+  for (;;) {
+    const uint64_t __q = __value / 5;
+    const uint32_t __r = static_cast<uint32_t>(__value - 5 * __q);
+    if (__r != 0)
+      break;
+    __value = __q;
+    ++__count;
+  }
+  return __count;
+}
+
+// Returns whether __value is divisible by 5^__p.
+inline bool __multipleOfPowerOf5(const uint64_t __value, const uint32_t __p) {
+  return __pow5Factor(__value) >= __p;
+}
+
+// Returns whether __value is divisible by 2^__p.
+inline bool __multipleOfPowerOf2(const uint64_t __value, const uint32_t __p) {
+  return (__value & ((uint64_t(1) << __p) - 1)) == 0;
+}
+
+// Returns the low 64 bits of __a * __b, and its high 64 bits in *__high.
+inline uint64_t __ryu_umul128(const uint64_t __a, const uint64_t __b,
+                              uint64_t* const __high) {
+#ifndef _LIBCPP_HAS_NO_INT128
+  const __uint128_t __p = static_cast<__uint128_t>(__a) * __b;
+  *__high = static_cast<uint64_t>(__p >> 64);
+  return static_cast<uint64_t>(__p);
+#else
+  const uint64_t __a_lo = static_cast<uint32_t>(__a);
+  const uint64_t __a_hi = __a >> 32;
+  const uint64_t __b_lo = static_cast<uint32_t>(__b);
+  const uint64_t __b_hi = __b >> 32;
+
+  const uint64_t __b00 = __a_lo * __b_lo;
+  const uint64_t __b01 = __a_lo * __b_hi;
+  const uint64_t __b10 = __a_hi * __b_lo;
+  const uint64_t __b11 = __a_hi * __b_hi;
+
+  const uint64_t __mid1 = __b10 + (__b00 >> 32);
+  const uint64_t __mid2 = __b01 + static_cast<uint32_t>(__mid1);
+
+  *__high = __b11 + (__mid1 >> 32) + (__mid2 >> 32);
+  return (__mid2 << 32) | static_cast<uint32_t>(__b00);
+#endif
+}
+
+// Returns the 128-bit (__hi, __lo) shifted right by 0 < __dist < 64.
+inline uint64_t __ryu_shiftright128(const uint64_t __lo, const uint64_t __hi,
+                                    const uint32_t __dist) {
+  _LIBCPP_ASSERT(0 < __dist && __dist < 64, "shift out of range");
+  return (__hi << (64 - __dist)) | (__lo >> __dist);
+}
+
+inline uint32_t __decimalLength9(const uint32_t __v) {
+  if (__v >= 100000000) { return 9; }
+  if (__v >= 10000000) { return 8; }
+  if (__v >= 1000000) { return 7; }
+  if (__v >= 100000) { return 6; }
+  if (__v >= 10000) { return 5; }
+  if (__v >= 1000) { return 4; }
+  if (__v >= 100) { return 3; }
+  if (__v >= 10) { return 2; }
+  return 1;
+}
+
+inline uint32_t __decimalLength17(const uint64_t __v) {
+  if (__v >= 10000000000000000u) { return 17; }
+  if (__v >= 1000000000000000u) { return 16; }
+  if (__v >= 100000000000000u) { return 15; }
+  if (__v >= 10000000000000u) { return 14; }
+  if (__v >= 1000000000000u) { return 13; }
+  if (__v >= 100000000000u) { return 12; }
+  if (__v >= 10000000000u) { return 11; }
+  if (__v >= 1000000000u) { return 10; }
+  return __decimalLength9(static_cast<uint32_t>(__v));
+}
+
+_LIBCPP_END_NAMESPACE_STD
+
+#endif // _LIBCPP_SRC_INCLUDE_RYU_COMMON_H
@@ -0,0 +1,41 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// Adapted from Ryu (https://github.com/ulfjack/ryu), Copyright 2018 Ulf Adams,
+// available under the Apache License 2.0 and the Boost Software License 1.0.
+
+#ifndef _LIBCPP_SRC_INCLUDE_RYU_RYU_H
+#define _LIBCPP_SRC_INCLUDE_RYU_RYU_H
+
+#include "__config"
+#include "cstdint"
+
+_LIBCPP_BEGIN_NAMESPACE_STD
+
+// A decimal value __mantissa * 10^__exponent.
+struct __floating_decimal_64 {
+  uint64_t __mantissa;
+  int32_t __exponent;
+};
+
+struct __floating_decimal_32 {
+  uint32_t __mantissa;
+  int32_t __exponent;
+};
+
+// Returns the decimal with the fewest digits that reads back as the finite
+// nonzero value of the given IEEE fields, the closest one when there are
+// several.
+_LIBCPP_HIDDEN __floating_decimal_64 __d2d(uint64_t __ieee_mantissa,
+                                           uint32_t __ieee_exponent);
+_LIBCPP_HIDDEN __floating_decimal_32 __f2d(uint32_t __ieee_mantissa,
+                                           uint32_t __ieee_exponent);
+
+_LIBCPP_END_NAMESPACE_STD
+
+#endif // _LIBCPP_SRC_INCLUDE_RYU_RYU_H
@@ -0,0 +1,532 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef _LIBCPP_SRC_INCLUDE_TO_CHARS_FLOATING_POINT_H
+#define _LIBCPP_SRC_INCLUDE_TO_CHARS_FLOATING_POINT_H
+
+#include "__config"
+#include "__debug"
+#include "charconv"
+#include "cstddef"
+#include "cstdint"
+#include "cstring"
+
+#include "big_integer.h"
+#include "ryu/ryu.h"
+
+_LIBCPP_BEGIN_NAMESPACE_STD
+
+template <class _Tp>
+struct __float_traits;
+
+template <>
+struct __float_traits<float> {
+  typedef uint32_t __uint_type;
+  static const int __mantissa_bits = 23;
+  static const int __exponent_bits = 8;
+  static const int __exponent_bias = 127;
+  // The number of hexadecimal digits after the point in the hex format.
+  static const int __hex_digits = 6;
+};
+
+template <>
+struct __float_traits<double> {
+  typedef uint64_t __uint_type;
+  static const int __mantissa_bits = 52;
+  static const int __exponent_bits = 11;
+  static const int __exponent_bias = 1023;
+  static const int __hex_digits = 13;
+};
+
+// The fields of an IEEE binary floating-point value.
+struct __float_fields {
+  bool __negative;
+  uint64_t __mantissa;
+  uint32_t __exponent;
+  bool __is_special; // infinity or NaN
+
+  // The value is __m2 * 2^__e2 when it is finite.
+  uint64_t __m2;
+  int __e2;
+};
+
+template <class _Fp>
+__float_fields __decompose(_Fp __value) {
+  typedef __float_traits<_Fp> _Traits;
+  typename _Traits::__uint_type __bits;
+  static_assert(sizeof(__bits) == sizeof(__value), "");
+  memcpy(&__bits, &__value, sizeof(__bits));
+
+  const uint32_t __max_exponent = (uint32_t(1) << _Traits::__exponent_bits) - 1;
+  __float_fields __f;
+  const int __mantissa_bits = _Traits::__mantissa_bits;
+  __f.__negative =
+      (__bits >> (__mantissa_bits + _Traits::__exponent_bits)) != 0;
+  __f.__mantissa = __bits & ((uint64_t(1) << __mantissa_bits) - 1);
+  __f.__exponent =
+      static_cast<uint32_t>(__bits >> __mantissa_bits) & __max_exponent;
+  __f.__is_special = __f.__exponent == __max_exponent;
+  if (__f.__exponent == 0) {
+    __f.__m2 = __f.__mantissa;
+    __f.__e2 = 1 - _Traits::__exponent_bias - __mantissa_bits;
+  } else {
+    __f.__m2 = __f.__mantissa | (uint64_t(1) << __mantissa_bits);
+    __f.__e2 = static_cast<int>(__f.__exponent) - _Traits::__exponent_bias -
+               __mantissa_bits;
+  }
+  return __f;
+}
+
+inline __floating_decimal_64 __shortest_decimal(const __float_fields& __f,
+                                                double) {
+  return __d2d(__f.__mantissa, __f.__exponent);
+}
+
+inline __floating_decimal_64 __shortest_decimal(const __float_fields& __f,
+                                                float) {
+  const __floating_decimal_32 __d =
+      __f2d(static_cast<uint32_t>(__f.__mantissa), __f.__exponent);
+  __floating_decimal_64 __r;
+  __r.__mantissa = __d.__mantissa;
+  __r.__exponent = __d.__exponent;
+  return __r;
+}
+
+// Bounds checked output to [__first, __last). Once the output does not fit,
+// nothing more is written and the result is value_too_large.
+class __chars_output {
+public:
+  __chars_output(char* __first, char* __last)
+      : __ptr_(__first), __last_(__last), __overflow_(false) {}
+
+  void __put(char __c) {
+    if (__ptr_ == __last_)
+      __overflow_ = true;
+    else
+      *__ptr_++ = __c;
+  }
+
+  void __put(const char* __s, long long __n) {
+    if (__n <= 0)
+      return;
+    if (__reserve(__n)) {
+      memcpy(__ptr_, __s, static_cast<size_t>(__n));
+      __ptr_ += __n;
+    }
+  }
+
+  void __fill(char __c, long long __n) {
+    if (__n <= 0)
+      return;
+    if (__reserve(__n)) {
+      memset(__ptr_, __c, static_cast<size_t>(__n));
+      __ptr_ += __n;
+    }
+  }
+
+  to_chars_result __result() const {
+    if (__overflow_)
+      return {__last_, errc::value_too_large};
+    return {__ptr_, errc()};
+  }
+
+private:
+  bool __reserve(long long __n) {
+    if (__n > __last_ - __ptr_) {
+      __overflow_ = true;
+      __ptr_ = __last_;
+      return false;
+    }
+    return true;
+  }
+
+  char* __ptr_;
+  char* __last_;
+  bool __overflow_;
+};
+
+inline void __put_exponent(__chars_output& __out, char __marker,
+                           int __exponent, bool __two_digits) {
+  __out.__put(__marker);
+  __out.__put(__exponent < 0 ? '-' : '+');
+  const uint32_t __abs =
+      __exponent < 0 ? -static_cast<uint32_t>(__exponent) : __exponent;
+  if (__two_digits && __abs < 10)
+    __out.__put('0');
+  char __buffer[10];
+  __out.__put(__buffer, __itoa::__u32toa(__abs, __buffer) - __buffer);
+}
+
+// Writes __n digits of __d, those past __size being zeros.
+inline void __put_digits(__chars_output& __out, const char* __d, int __size,
+                         long long __first, long long __n) {
+  long long __stored = __first < __size ? __size - __first : 0;
+  if (__stored > __n)
+    __stored = __n;
+  __out.__put(__d + __first, __stored);
+  __out.__fill('0', __n - __stored);
+}
+
+// Writes the decimal value 0.d[0]d[1]... * 10^(__x + 1) in the fixed format,
+// with __fraction digits after the point.
+inline void __put_fixed(__chars_output& __out, const char* __d, int __size,
+                        int __x, long long __fraction) {
+  if (__x < 0)
+    __out.__put('0');
+  else
+    __put_digits(__out, __d, __size, 0, __x + 1);
+  if (__fraction <= 0)
+    return;
+  __out.__put('.');
+  long long __zeros = __x < -1 ? -1 - static_cast<long long>(__x) : 0;
+  if (__zeros > __fraction)
+    __zeros = __fraction;
+  __out.__fill('0', __zeros);
+  __put_digits(__out, __d, __size, __x < 0 ? 0 : __x + 1, __fraction - __zeros);
+}
+
+// Writes the same value in the scientific format.
+inline void __put_scientific(__chars_output& __out, const char* __d,
+                             int __size, int __x, long long __fraction) {
+  __out.__put(__size > 0 ? __d[0] : '0');
+  if (__fraction > 0) {
+    __out.__put('.');
+    __put_digits(__out, __d, __size, 1, __fraction);
+  }
+  __put_exponent(__out, 'e', __x, true);
+}
+
+// The decimal digits of the exact nonzero value __m2 * 2^__e2, from its first
+// significant digit on, generated as far as they are needed.
+class __exact_decimal {
+public:
+  // The most digits stored, reached by fixed formatting of the smallest
+  // subnormal double, whose value has 1074 decimal places.
+  static const int __capacity = 1152;
+
+  __exact_decimal(uint64_t __m2, int __e2) : __k_(0), __size_(0), __x_(-1) {
+    _LIBCPP_ASSERT(__m2 != 0, "the value must be nonzero");
+    if (__e2 >= 0) {
+      if (__e2 <= 11) {
+        __put_integer(__m2 << __e2);
+      } else {
+        __big_integer __i(__m2);
+        __i.__shift_left(static_cast<uint32_t>(__e2));
+        __put_integer(__i);
+      }
+      return;
+    }
+    __k_ = static_cast<uint32_t>(-__e2);
+    if (__k_ < 64) {
+      __put_integer(__m2 >> __k_);
+      __m2 &= (uint64_t(1) << __k_) - 1;
+    }
+    __fraction_ = __big_integer(__m2);
+    if (__size_ == 0) {
+      // Skip the zeros after the point.
+      uint32_t __chunk;
+      while ((__chunk = __next_chunk()) == 0)
+        __x_ -= 9;
+      __size_ =
+          static_cast<int>(__itoa::__u32toa(__chunk, __digits_) - __digits_);
+      __x_ -= 9 - __size_;
+    }
+  }
+
+  const char* __digits() const { return __digits_; }
+  int __size() const { return __size_; }
+  // The value is 0.d[0]d[1]... * 10^(__exponent() + 1).
+  int __exponent() const { return __x_; }
+
+  // Rounds half to even to the first __cut digits, keeping none when __cut
+  // is not positive. Trailing digits equal to zero may be dropped.
+  void __round(long long __cut) {
+    __extend(__cut + 1);
+    if (__cut >= __size_)
+      return;
+    if (__cut < 0) {
+      __size_ = 0;
+      return;
+    }
+    const char __next = __digits_[__cut];
+    const bool __odd = __cut > 0 && (__digits_[__cut - 1] - '0') % 2 != 0;
+    const bool __up =
+        __next > '5' || (__next == '5' && (__odd || __is_sticky(__cut + 1)));
+    __size_ = static_cast<int>(__cut);
+    if (!__up)
+      return;
+    while (__size_ > 0 && __digits_[__size_ - 1] == '9')
+      --__size_;
+    if (__size_ == 0) {
+      __digits_[0] = '1';
+      __size_ = 1;
+      ++__x_;
+    } else {
+      ++__digits_[__size_ - 1];
+    }
+  }
+
+  void __strip_trailing_zeros() {
+    while (__size_ > 0 && __digits_[__size_ - 1] == '0')
+      --__size_;
+  }
+
+private:
+  void __put_integer(uint64_t __i) {
+    if (__i == 0)
+      return;
+    __size_ = static_cast<int>(__itoa::__u64toa(__i, __digits_) - __digits_);
+    __x_ = __size_ - 1;
+  }
+
+  void __put_integer(__big_integer& __i) {
+    uint32_t __chunks[40];
+    int __n = 0;
+    while (!__i.__is_zero())
+      __chunks[__n++] = __i.__div_small(1000000000);
+    __size_ = static_cast<int>(__itoa::__u32toa(__chunks[--__n], __digits_) -
+                               __digits_);
+    while (__n != 0)
+      __put_chunk(__chunks[--__n]);
+    __x_ = __size_ - 1;
+  }
+
+  void __put_chunk(uint32_t __chunk) {
+    _LIBCPP_ASSERT(__size_ + 9 <= __capacity, "too many digits");
+    for (int __i = 8; __i >= 0; --__i) {
+      __digits_[__size_ + __i] = static_cast<char>('0' + __chunk % 10);
+      __chunk /= 10;
+    }
+    __size_ += 9;
+  }
+
+  // Returns the next 9 digits of the fraction.
+  uint32_t __next_chunk() {
+    __fraction_.__mul_small(1000000000);
+    return __fraction_.__take_bits_from(__k_);
+  }
+
+  void __extend(long long __n) {
+    while (__size_ < __n && !__fraction_.__is_zero())
+      __put_chunk(__next_chunk());
+  }
+
+  bool __is_sticky(int __from) const {
+    for (int __i = __from; __i < __size_; ++__i)
+      if (__digits_[__i] != '0')
+        return true;
+    return !__fraction_.__is_zero();
+  }
+
+  // The fraction is __fraction_ / 2^__k_.
+  __big_integer __fraction_;
+  uint32_t __k_;
+  int __size_;
+  int __x_;
+  char __digits_[__capacity];
+};
+
+inline void __put_special(__chars_output& __out, const __float_fields& __f) {
+  if (__f.__mantissa == 0)
+    __out.__put("inf", 3);
+  else
+    __out.__put("nan", 3);
+}
+
+// Writes the shortest fixed form of the value, whose shortest decimal is
+// __d * 10^__e with __n digits in __d. Integers too large for that many
+// digits are written exactly, like printf does.
+inline void __put_shortest_fixed(__chars_output& __out,
+                                 const __float_fields& __f, const char* __d,
+                                 int __n, int __e) {
+  if (__e > 0) {
+    __exact_decimal __exact(__f.__m2, __f.__e2);
+    __out.__put(__exact.__digits(), __exact.__size());
+  } else if (__n + __e > 0) {
+    __out.__put(__d, __n + __e);
+    if (__e != 0) {
+      __out.__put('.');
+      __out.__put(__d + __n + __e, -__e);
+    }
+  } else {
+    __out.__put("0.", 2);
+    __out.__fill('0', -(__n + __e));
+    __out.__put(__d, __n);
+  }
+}
+
+inline void __put_shortest_scientific(__chars_output& __out, const char* __d,
+                                      int __n, int __x) {
+  __out.__put(__d[0]);
+  if (__n > 1) {
+    __out.__put('.');
+    __out.__put(__d + 1, __n - 1);
+  }
+  __put_exponent(__out, 'e', __x, true);
+}
+
+// Writes the hex form, with __precision digits after the point or the
+// fewest exact ones when __precision is negative.
+template <class _Fp>
+void __put_hex(__chars_output& __out, const __float_fields& __f,
+               int __precision) {
+  typedef __float_traits<_Fp> _Traits;
+  int __n = _Traits::__hex_digits;
+  uint64_t __mantissa = __f.__mantissa << (4 * __n - _Traits::__mantissa_bits);
+  uint32_t __leading = __f.__exponent != 0;
+  int __exponent = 0;
+  if (__f.__exponent != 0)
+    __exponent = static_cast<int>(__f.__exponent) - _Traits::__exponent_bias;
+  else if (__f.__mantissa != 0)
+    __exponent = 1 - _Traits::__exponent_bias;
+
+  if (__precision < 0) {
+    while (__n > 0 && (__mantissa & 0xf) == 0) {
+      __mantissa >>= 4;
+      --__n;
+    }
+  } else if (__precision < __n) {
+    // Round half to even, the leading digit may become 2.
+    const int __dropped = 4 * (__n - __precision);
+    uint64_t __all = (uint64_t(__leading) << (4 * __n)) | __mantissa;
+    const uint64_t __rest = __all & ((uint64_t(1) << __dropped) - 1);
+    const uint64_t __half = uint64_t(1) << (__dropped - 1);
+    __all >>= __dropped;
+    if (__rest > __half || (__rest == __half && (__all & 1) != 0))
+      ++__all;
+    __n = __precision;
+    __leading = static_cast<uint32_t>(__all >> (4 * __n));
+    __mantissa = __all & ((uint64_t(1) << (4 * __n)) - 1);
+  }
+
+  __out.__put(static_cast<char>('0' + __leading));
+  if (__n > 0 || __precision > 0)
+    __out.__put('.');
+  for (int __i = __n - 1; __i >= 0; --__i)
+    __out.__put("0123456789abcdef"[(__mantissa >> (4 * __i)) & 0xf]);
+  if (__precision > __n)
+    __out.__fill('0', __precision - __n);
+  __put_exponent(__out, 'p', __exponent, false);
+}
+
+// Implements to_chars without a precision, __fmt being chars_format() for the
+// overload without a format.
+template <class _Fp>
+to_chars_result __floating_to_chars_shortest(char* __first, char* __last,
+                                             _Fp __value, chars_format __fmt) {
+  const __float_fields __f = __decompose(__value);
+  __chars_output __out(__first, __last);
+  if (__f.__negative)
+    __out.__put('-');
+
+  if (__f.__is_special) {
+    __put_special(__out, __f);
+  } else if (__fmt == chars_format::hex) {
+    __put_hex<_Fp>(__out, __f, -1);
+  } else if (__f.__m2 == 0) {
+    if (__fmt == chars_format::scientific)
+      __out.__put("0e+00", 5);
+    else
+      __out.__put('0');
+  } else {
+    const __floating_decimal_64 __v = __shortest_decimal(__f, __value);
+    char __d[24];
+    const int __n =
+        static_cast<int>(__itoa::__u64toa(__v.__mantissa, __d) - __d);
+    const int __e = __v.__exponent;
+    const int __x = __e + __n - 1;
+
+    bool __fixed;
+    if (__fmt == chars_format::fixed) {
+      __fixed = true;
+    } else if (__fmt == chars_format::scientific) {
+      __fixed = false;
+    } else if (__fmt == chars_format::general) {
+      // Like printf's %g with the default precision of 6.
+      __fixed = -4 <= __x && __x < 6;
+    } else {
+      // The shorter of the two, preferring fixed on a tie.
+      int __fixed_length = 2 - __e; // 0.ddd
+      if (__e >= 0)
+        __fixed_length = __n + __e; // ddd000
+      else if (__n + __e > 0)
+        __fixed_length = __n + 1; // dd.d
+      const int __scientific_length =
+          __n + (__n > 1) + (__x <= -100 || __x >= 100 ? 5 : 4);
+      __fixed = __fixed_length <= __scientific_length;
+    }
+
+    if (__fixed)
+      __put_shortest_fixed(__out, __f, __d, __n, __e);
+    else
+      __put_shortest_scientific(__out, __d, __n, __x);
+  }
+  return __out.__result();
+}
+
+// Implements to_chars with a precision, the output being exact, rounded half
+// to even.
+template <class _Fp>
+to_chars_result __floating_to_chars_precision(char* __first, char* __last,
+                                              _Fp __value, chars_format __fmt,
+                                              int __precision) {
+  if (__precision < 0) {
+    if (__fmt == chars_format::hex)
+      return __floating_to_chars_shortest(__first, __last, __value,
+                                          chars_format::hex);
+    __precision = 6;
+  }
+
+  const __float_fields __f = __decompose(__value);
+  __chars_output __out(__first, __last);
+  if (__f.__negative)
+    __out.__put('-');
+
+  if (__f.__is_special) {
+    __put_special(__out, __f);
+  } else if (__fmt == chars_format::hex) {
+    __put_hex<_Fp>(__out, __f, __precision);
+  } else if (__f.__m2 == 0) {
+    if (__fmt == chars_format::fixed)
+      __put_fixed(__out, nullptr, 0, -1, __precision);
+    else if (__fmt == chars_format::scientific)
+      __put_scientific(__out, nullptr, 0, 0, __precision);
+    else
+      __out.__put('0');
+  } else {
+    __exact_decimal __exact(__f.__m2, __f.__e2);
+    if (__fmt == chars_format::fixed) {
+      __exact.__round(static_cast<long long>(__exact.__exponent()) + 1 +
+                      __precision);
+      __put_fixed(__out, __exact.__digits(), __exact.__size(),
+                  __exact.__exponent(), __precision);
+    } else if (__fmt == chars_format::scientific) {
+      __exact.__round(static_cast<long long>(__precision) + 1);
+      __put_scientific(__out, __exact.__digits(), __exact.__size(),
+                       __exact.__exponent(), __precision);
+    } else {
+      // Like printf's %g: __precision significant digits, in the fixed format
+      // when the exponent is in [-4, __precision), without trailing zeros.
+      if (__precision == 0)
+        __precision = 1;
+      __exact.__round(__precision);
+      __exact.__strip_trailing_zeros();
+      const int __x = __exact.__exponent();
+      const int __size = __exact.__size();
+      if (-4 <= __x && __x < __precision)
+        __put_fixed(__out, __exact.__digits(), __size, __x, __size - 1 - __x);
+      else
+        __put_scientific(__out, __exact.__digits(), __size, __x, __size - 1);
+    }
+  }
+  return __out.__result();
+}
+
+_LIBCPP_END_NAMESPACE_STD
+
+#endif // _LIBCPP_SRC_INCLUDE_TO_CHARS_FLOATING_POINT_H
@@ -0,0 +1,630 @@
+//===------------------------ memory_resource.cpp -------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "memory_resource"
+#include "bit"
+
+#ifndef _LIBCPP_HAS_NO_ATOMIC_HEADER
+#include "atomic"
+#elif !defined(_LIBCPP_HAS_NO_THREADS)
+#include "mutex"
+#if defined(__ELF__) && defined(_LIBCPP_LINK_PTHREAD_LIB)
+#pragma comment(lib, "pthread")
+#endif
+#endif
+
+_LIBCPP_BEGIN_NAMESPACE_STD
+
+namespace pmr
+{
+
+// memory_resource
+
+memory_resource::~memory_resource() {}
+
+// new_delete_resource()
+
+class _LIBCPP_TYPE_VIS __new_delete_memory_resource_imp
+    : public memory_resource
+{
+    void *do_allocate(size_t __size, size_t __align) override {
+        return _VSTD::__libcpp_allocate(__size, __align);
+    }
+
+    void do_deallocate(void *__p, size_t __n, size_t __align) override {
+      _VSTD::__libcpp_deallocate(__p, __n, __align);
+    }
+
+    bool do_is_equal(memory_resource const & __other) const _NOEXCEPT override
+        { return &__other == this; }
+
+public:
+    ~__new_delete_memory_resource_imp() override = default;
+};
+
+// null_memory_resource()
+
+class _LIBCPP_TYPE_VIS __null_memory_resource_imp
+    : public memory_resource
+{
+public:
+    ~__null_memory_resource_imp() override = default;
+
+protected:
+    void* do_allocate(size_t, size_t) override {
+        __throw_bad_alloc();
+    }
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(memory_resource const & __other) const _NOEXCEPT override
+    { return &__other == this; }
+};
+
+namespace {
+
+union ResourceInitHelper {
+  struct {
+    __new_delete_memory_resource_imp new_delete_res;
+    __null_memory_resource_imp       null_res;
+  } resources;
+  char dummy;
+  _LIBCPP_CONSTEXPR_AFTER_CXX11 ResourceInitHelper() : resources() {}
+  ~ResourceInitHelper() {}
+};
+
+// The resources are never destroyed, so that they can be used by the
+// destructors of other static objects.
+_LIBCPP_SAFE_STATIC ResourceInitHelper res_init _LIBCPP_INIT_PRIORITY_MAX;
+
+} // end namespace
+
+
+memory_resource * new_delete_resource() _NOEXCEPT {
+    return &res_init.resources.new_delete_res;
+}
+
+memory_resource * null_memory_resource() _NOEXCEPT {
+    return &res_init.resources.null_res;
+}
+
+// default_memory_resource()
+
+static memory_resource *
+__default_memory_resource(bool set = false, memory_resource * new_res = nullptr) _NOEXCEPT
+{
+#ifndef _LIBCPP_HAS_NO_ATOMIC_HEADER
+    _LIBCPP_SAFE_STATIC static atomic<memory_resource*> __res =
+        ATOMIC_VAR_INIT(&res_init.resources.new_delete_res);
+    if (set) {
+        new_res = new_res ? new_res : new_delete_resource();
+        return _VSTD::atomic_exchange_explicit(
+            &__res, new_res, memory_order_acq_rel);
+    }
+    else {
+        return _VSTD::atomic_load_explicit(
+            &__res, memory_order_acquire);
+    }
+#elif !defined(_LIBCPP_HAS_NO_THREADS)
+    _LIBCPP_SAFE_STATIC static memory_resource * res = &res_init.resources.new_delete_res;
+    static mutex res_lock;
+    if (set) {
+        new_res = new_res ? new_res : new_delete_resource();
+        lock_guard<mutex> guard(res_lock);
+        memory_resource * old_res = res;
+        res = new_res;
+        return old_res;
+    } else {
+        lock_guard<mutex> guard(res_lock);
+        return res;
+    }
+#else
+    _LIBCPP_SAFE_STATIC static memory_resource* res = &res_init.resources.new_delete_res;
+    if (set) {
+        new_res = new_res ? new_res : new_delete_resource();
+        memory_resource * old_res = res;
+        res = new_res;
+        return old_res;
+    } else {
+        return res;
+    }
+#endif
+}
+
+memory_resource * get_default_resource() _NOEXCEPT
+{
+    return __default_memory_resource();
+}
+
+memory_resource * set_default_resource(memory_resource * __new_res) _NOEXCEPT
+{
+    return __default_memory_resource(true, __new_res);
+}
+
+// 23.12.5, mem.res.pool
+
+static size_t __roundup(size_t __count, size_t __alignment)
+{
+    const size_t __mask = __alignment - 1;
+    return (__count + __mask) & ~__mask;
+}
+
+// The chunks obtained from the upstream resource end with a footer that links
+// them together, so that release() can return them.
+struct unsynchronized_pool_resource::__adhoc_pool::__chunk_footer {
+    __chunk_footer *__next_;
+    char *__start_;
+    size_t __align_;
+    size_t __allocation_size() {
+        return (reinterpret_cast<char*>(this) - __start_) + sizeof(*this);
+    }
+};
+
+void unsynchronized_pool_resource::__adhoc_pool::__release_ptr(
+    memory_resource *__upstream)
+{
+    while (__first_ != nullptr) {
+        __chunk_footer *__next = __first_->__next_;
+        __upstream->deallocate(__first_->__start_,
+                               __first_->__allocation_size(),
+                               __first_->__align_);
+        __first_ = __next;
+    }
+}
+
+void *unsynchronized_pool_resource::__adhoc_pool::__do_allocate(
+    memory_resource *__upstream, size_t __bytes, size_t __align)
+{
+    const size_t __footer_size = sizeof(__chunk_footer);
+    const size_t __footer_align = alignof(__chunk_footer);
+
+    if (__align < __footer_align)
+        __align = __footer_align;
+
+    const size_t __aligned_capacity =
+        __roundup(__bytes, __footer_align) + __footer_size;
+
+    void *__result = __upstream->allocate(__aligned_capacity, __align);
+
+    __chunk_footer *__h = reinterpret_cast<__chunk_footer *>(
+        static_cast<char *>(__result) + __aligned_capacity - __footer_size);
+    __h->__next_ = __first_;
+    __h->__start_ = static_cast<char *>(__result);
+    __h->__align_ = __align;
+    __first_ = __h;
+    return __result;
+}
+
+void unsynchronized_pool_resource::__adhoc_pool::__do_deallocate(
+    memory_resource *__upstream, void *__p, size_t, size_t)
+{
+    _LIBCPP_ASSERT(__first_ != nullptr,
+                   "deallocating a block that was not allocated with this allocator");
+    if (__first_->__start_ == __p) {
+        __chunk_footer *__next = __first_->__next_;
+        __upstream->deallocate(__p, __first_->__allocation_size(),
+                               __first_->__align_);
+        __first_ = __next;
+        return;
+    }
+    for (__chunk_footer *__h = __first_; __h->__next_ != nullptr;
+         __h = __h->__next_) {
+        if (__h->__next_->__start_ == __p) {
+            __chunk_footer *__next = __h->__next_->__next_;
+            __upstream->deallocate(__p, __h->__next_->__allocation_size(),
+                                   __h->__next_->__align_);
+            __h->__next_ = __next;
+            return;
+        }
+    }
+    _LIBCPP_ASSERT(false,
+                   "deallocating a block that was not allocated with this allocator");
+}
+
+// The blocks of a fixed pool all have the same power of two size. The free
+// blocks are linked through their first bytes, the most recently deallocated
+// block being reused first since it is likely to be in the cache.
+class unsynchronized_pool_resource::__fixed_pool {
+    struct __chunk_footer {
+        __chunk_footer *__next_;
+        char *__start_;
+        size_t __align_;
+        size_t __allocation_size() {
+            return (reinterpret_cast<char*>(this) - __start_) + sizeof(*this);
+        }
+    };
+
+    struct __vacancy_header {
+        __vacancy_header *__next_vacancy_;
+    };
+
+    __chunk_footer *__first_chunk_ = nullptr;
+    __vacancy_header *__first_vacancy_ = nullptr;
+
+public:
+    explicit __fixed_pool() = default;
+
+    void __release_ptr(memory_resource *__upstream) {
+        __first_vacancy_ = nullptr;
+        while (__first_chunk_ != nullptr) {
+            __chunk_footer *__next = __first_chunk_->__next_;
+            __upstream->deallocate(__first_chunk_->__start_,
+                                   __first_chunk_->__allocation_size(),
+                                   __first_chunk_->__align_);
+            __first_chunk_ = __next;
+        }
+    }
+
+    void *__try_allocate_from_vacancies() {
+        if (__first_vacancy_ != nullptr) {
+            void *__result = __first_vacancy_;
+            __first_vacancy_ = __first_vacancy_->__next_vacancy_;
+            return __result;
+        }
+        return nullptr;
+    }
+
+    void *__allocate_in_new_chunk(memory_resource *__upstream,
+                                  size_t __block_size, size_t __chunk_size) {
+        _LIBCPP_ASSERT(__chunk_size % __block_size == 0, "");
+        static_assert(__default_alignment >= alignof(max_align_t), "");
+        static_assert(__default_alignment >= alignof(__chunk_footer), "");
+        static_assert(__default_alignment >= alignof(__vacancy_header), "");
+
+        const size_t __footer_size = sizeof(__chunk_footer);
+        const size_t __footer_align = alignof(__chunk_footer);
+
+        const size_t __aligned_capacity =
+            __roundup(__chunk_size, __footer_align) + __footer_size;
+
+        // The blocks are aligned to their size up to the alignment of the
+        // chunk, which allows over-aligned blocks in the pools.
+        size_t __align = __block_size;
+        if (__align < __default_alignment)
+            __align = __default_alignment;
+        else if (__align > __max_alignment)
+            __align = __max_alignment;
+
+        char *__result = static_cast<char *>(
+            __upstream->allocate(__aligned_capacity, __align));
+
+        __chunk_footer *__h = reinterpret_cast<__chunk_footer *>(
+            __result + __aligned_capacity - __footer_size);
+        __h->__next_ = __first_chunk_;
+        __h->__start_ = __result;
+        __h->__align_ = __align;
+        __first_chunk_ = __h;
+
+        // The first block is returned, the others are linked in address
+        // order so that the next allocations walk the chunk forwards.
+        __vacancy_header *__next_vh = __first_vacancy_;
+        for (size_t __i = __chunk_size - __block_size; __i != 0;
+             __i -= __block_size) {
+            __vacancy_header *__vh =
+                reinterpret_cast<__vacancy_header *>(__result + __i);
+            __vh->__next_vacancy_ = __next_vh;
+            __next_vh = __vh;
+        }
+        __first_vacancy_ = __next_vh;
+        return __result;
+    }
+
+    void __evacuate(void *__p) {
+        __vacancy_header *__vh = static_cast<__vacancy_header *>(__p);
+        __vh->__next_vacancy_ = __first_vacancy_;
+        __first_vacancy_ = __vh;
+    }
+
+    size_t __previous_chunk_size_in_bytes() const {
+        return __first_chunk_ ? __first_chunk_->__allocation_size() : 0;
+    }
+
+    static const size_t __default_alignment = alignof(max_align_t);
+    static const size_t __max_alignment = 4096;
+};
+
+size_t unsynchronized_pool_resource::__pool_block_size(int __i) const
+{
+    return size_t(1) << __log2_pool_block_size(__i);
+}
+
+int unsynchronized_pool_resource::__log2_pool_block_size(int __i) const
+{
+    return __i + __log2_smallest_block_size;
+}
+
+int unsynchronized_pool_resource::__pool_index(size_t __bytes,
+                                               size_t __align) const
+{
+    // The blocks of a pool are aligned to their size, so the pool is the one
+    // of the smallest power of two that is at least `__bytes` and `__align`,
+    // the first pool holding blocks of 8 bytes.
+    if (__bytes < __align)
+        __bytes = __align;
+    if (__align > __fixed_pool::__max_alignment ||
+        __bytes > __pool_block_size(__num_fixed_pools_ - 1))
+        return __num_fixed_pools_;
+    if (__bytes <= __smallest_block_size)
+        return 0;
+    return (numeric_limits<size_t>::digits - __libcpp_clz(__bytes - 1)) -
+           __log2_smallest_block_size;
+}
+
+unsynchronized_pool_resource::unsynchronized_pool_resource(
+    const pool_options& __opts, memory_resource* __upstream)
+    : __res_(__upstream), __fixed_pools_(nullptr)
+{
+    size_t __largest_block_size;
+    if (__opts.largest_required_pool_block == 0)
+        __largest_block_size = __default_largest_block_size;
+    else if (__opts.largest_required_pool_block < __smallest_block_size)
+        __largest_block_size = __smallest_block_size;
+    else if (__opts.largest_required_pool_block > __max_largest_block_size)
+        __largest_block_size = __max_largest_block_size;
+    else
+        __largest_block_size = __opts.largest_required_pool_block;
+
+    if (__opts.max_blocks_per_chunk == 0)
+        __options_max_blocks_per_chunk_ = __max_blocks_per_chunk;
+    else if (__opts.max_blocks_per_chunk < __min_blocks_per_chunk)
+        __options_max_blocks_per_chunk_ = __min_blocks_per_chunk;
+    else if (__opts.max_blocks_per_chunk > __max_blocks_per_chunk)
+        __options_max_blocks_per_chunk_ = __max_blocks_per_chunk;
+    else
+        __options_max_blocks_per_chunk_ = __opts.max_blocks_per_chunk;
+
+    __num_fixed_pools_ = 1;
+    size_t __capacity = __smallest_block_size;
+    while (__capacity < __largest_block_size) {
+        __capacity <<= 1;
+        __num_fixed_pools_ += 1;
+    }
+}
+
+unsynchronized_pool_resource::~unsynchronized_pool_resource()
+{
+    release();
+}
+
+pool_options unsynchronized_pool_resource::options() const
+{
+    pool_options __p;
+    __p.max_blocks_per_chunk = __options_max_blocks_per_chunk_;
+    __p.largest_required_pool_block = __pool_block_size(__num_fixed_pools_ - 1);
+    return __p;
+}
+
+void unsynchronized_pool_resource::release()
+{
+    __adhoc_pool_.__release_ptr(__res_);
+    if (__fixed_pools_ != nullptr) {
+        const int __n = __num_fixed_pools_;
+        for (int __i = 0; __i < __n; ++__i)
+            __fixed_pools_[__i].__release_ptr(__res_);
+        __res_->deallocate(__fixed_pools_,
+                           __num_fixed_pools_ * sizeof(__fixed_pool),
+                           alignof(__fixed_pool));
+        __fixed_pools_ = nullptr;
+    }
+}
+
+void* unsynchronized_pool_resource::do_allocate(size_t __bytes, size_t __align)
+{
+    // If the pool selected for a block of size bytes is unable to satisfy the
+    // memory request from its own internal data structures, it will call
+    // upstream_resource()->allocate() to obtain more memory. If bytes is larger
+    // than that which the largest pool can handle, then memory will be
+    // allocated using upstream_resource()->allocate().
+    const int __i = __pool_index(__bytes, __align);
+    if (__i == __num_fixed_pools_)
+        return __adhoc_pool_.__do_allocate(__res_, __bytes, __align);
+
+    if (__fixed_pools_ == nullptr) {
+        __fixed_pools_ = static_cast<__fixed_pool*>(
+            __res_->allocate(__num_fixed_pools_ * sizeof(__fixed_pool),
+                             alignof(__fixed_pool)));
+        __fixed_pool *__first = __fixed_pools_;
+        __fixed_pool *__last = __fixed_pools_ + __num_fixed_pools_;
+        for (__fixed_pool *__pool = __first; __pool != __last; ++__pool)
+            ::new ((void*)__pool) __fixed_pool;
+    }
+    if (void *__result = __fixed_pools_[__i].__try_allocate_from_vacancies())
+        return __result;
+
+    // Each chunk of a pool is 25% larger than the previous one, up to the
+    // limits of the options, so that the number of upstream allocations grows
+    // logarithmically with the number of blocks.
+    const int __log2_block_size = __log2_pool_block_size(__i);
+    const size_t __prev_chunk_size_in_blocks =
+        __fixed_pools_[__i].__previous_chunk_size_in_bytes() >> __log2_block_size;
+
+    size_t __chunk_size_in_blocks;
+    if (__prev_chunk_size_in_blocks == 0) {
+        __chunk_size_in_blocks = __min_bytes_per_chunk >> __log2_block_size;
+        if (__chunk_size_in_blocks < __min_blocks_per_chunk)
+            __chunk_size_in_blocks = __min_blocks_per_chunk;
+    } else {
+        static_assert(__max_bytes_per_chunk <=
+                          SIZE_MAX - (__max_bytes_per_chunk / 4),
+                      "unsigned overflow is possible");
+        __chunk_size_in_blocks =
+            __prev_chunk_size_in_blocks + (__prev_chunk_size_in_blocks / 4);
+    }
+
+    size_t __max_blocks = __max_bytes_per_chunk >> __log2_block_size;
+    if (__max_blocks > __options_max_blocks_per_chunk_)
+        __max_blocks = __options_max_blocks_per_chunk_;
+    if (__chunk_size_in_blocks > __max_blocks)
+        __chunk_size_in_blocks = __max_blocks;
+
+    return __fixed_pools_[__i].__allocate_in_new_chunk(
+        __res_, __pool_block_size(__i),
+        __chunk_size_in_blocks << __log2_block_size);
+}
+
+void unsynchronized_pool_resource::do_deallocate(void* __p, size_t __bytes,
+                                                 size_t __align)
+{
+    // Returns the memory at p to the pool. It is unspecified if, or under
+    // what circumstances, this operation will result in a call to
+    // upstream_resource()->deallocate().
+    const int __i = __pool_index(__bytes, __align);
+    if (__i == __num_fixed_pools_)
+        return __adhoc_pool_.__do_deallocate(__res_, __p, __bytes, __align);
+    _LIBCPP_ASSERT(__fixed_pools_ != nullptr,
+                   "deallocating a block that was not allocated with this allocator");
+    __fixed_pools_[__i].__evacuate(__p);
+}
+
+bool unsynchronized_pool_resource::do_is_equal(
+    const memory_resource& __other) const _NOEXCEPT
+{
+    return &__other == this;
+}
+
+synchronized_pool_resource::~synchronized_pool_resource() {}
+
+void synchronized_pool_resource::release()
+{
+#if !defined(_LIBCPP_HAS_NO_THREADS)
+    unique_lock<mutex> __lk(__mut_);
+#endif
+    __unsync_.release();
+}
+
+void* synchronized_pool_resource::do_allocate(size_t __bytes, size_t __align)
+{
+#if !defined(_LIBCPP_HAS_NO_THREADS)
+    unique_lock<mutex> __lk(__mut_);
+#endif
+    return __unsync_.allocate(__bytes, __align);
+}
+
+void synchronized_pool_resource::do_deallocate(void* __p, size_t __bytes,
+                                               size_t __align)
+{
+#if !defined(_LIBCPP_HAS_NO_THREADS)
+    unique_lock<mutex> __lk(__mut_);
+#endif
+    __unsync_.deallocate(__p, __bytes, __align);
+}
+
+bool synchronized_pool_resource::do_is_equal(
+    const memory_resource& __other) const _NOEXCEPT
+{
+    return &__other == this;
+}
+
+// 23.12.6, mem.res.monotonic.buffer
+
+// Moves `__ptr` down by at least `__size` bytes to a multiple of `__align` and
+// returns it, or returns nullptr if that is more than `__space` bytes down.
+static void *__align_down(size_t __align, size_t __size, char *&__ptr,
+                          size_t __space)
+{
+    if (__size > __space)
+        return nullptr;
+    char *__new_ptr = reinterpret_cast<char *>(
+        reinterpret_cast<uintptr_t>(__ptr - __size) & ~(__align - 1));
+    if (__new_ptr < __ptr - __space)
+        return nullptr;
+    __ptr = __new_ptr;
+    return __new_ptr;
+}
+
+void *monotonic_buffer_resource::__initial_descriptor::__try_allocate_from_chunk(
+    size_t __bytes, size_t __align)
+{
+    if (!__cur_)
+        return nullptr;
+    return __align_down(__align, __bytes, __cur_, __cur_ - __start_);
+}
+
+void *monotonic_buffer_resource::__chunk_footer::__try_allocate_from_chunk(
+    size_t __bytes, size_t __align)
+{
+    return __align_down(__align, __bytes, __cur_, __cur_ - __start_);
+}
+
+monotonic_buffer_resource::~monotonic_buffer_resource()
+{
+    release();
+}
+
+void monotonic_buffer_resource::release()
+{
+    if (__initial_.__start_ != nullptr)
+        __initial_.__cur_ = __initial_.__end_;
+    while (__chunks_ != nullptr) {
+        __chunk_footer *__next = __chunks_->__next_;
+        __res_->deallocate(__chunks_->__start_, __chunks_->__allocation_size(),
+                           __chunks_->__align_);
+        __chunks_ = __next;
+    }
+}
+
+void *monotonic_buffer_resource::do_allocate(size_t __bytes, size_t __align)
+{
+    const size_t __footer_size = sizeof(__chunk_footer);
+    const size_t __footer_align = alignof(__chunk_footer);
+
+    // Only the most recent chunk is looked at, the previous ones are
+    // considered full.
+    if (__chunks_ == nullptr) {
+        if (void *__result = __initial_.__try_allocate_from_chunk(__bytes, __align))
+            return __result;
+    } else if (void *__result =
+                   __chunks_->__try_allocate_from_chunk(__bytes, __align)) {
+        return __result;
+    }
+
+    size_t __previous_capacity;
+    if (__chunks_ != nullptr) {
+        __previous_capacity = __chunks_->__allocation_size();
+    } else {
+        __previous_capacity = __initial_.__start_ != nullptr
+                                  ? __initial_.__end_ - __initial_.__start_
+                                  : __initial_.__size_;
+        __previous_capacity =
+            __roundup(__previous_capacity, __footer_align) + __footer_size;
+    }
+
+    if (__align < __footer_align)
+        __align = __footer_align;
+
+    // The chunks grow geometrically. As the chunk is aligned to `__align`,
+    // `__bytes` aligned down from its end always fit.
+    size_t __aligned_capacity =
+        __roundup(__bytes, __footer_align) + __footer_size;
+    if (__aligned_capacity <= __previous_capacity) {
+        const size_t __newsize = 2 * (__previous_capacity - __footer_size);
+        __aligned_capacity = __roundup(__newsize, __footer_align) + __footer_size;
+    }
+
+    char *__start =
+        static_cast<char *>(__res_->allocate(__aligned_capacity, __align));
+    char *__end = __start + __aligned_capacity - __footer_size;
+    __chunk_footer *__footer = reinterpret_cast<__chunk_footer *>(__end);
+    __footer->__next_ = __chunks_;
+    __footer->__start_ = __start;
+    __footer->__cur_ = __end;
+    __footer->__align_ = __align;
+    __chunks_ = __footer;
+
+    return __chunks_->__try_allocate_from_chunk(__bytes, __align);
+}
+
+void monotonic_buffer_resource::do_deallocate(void*, size_t, size_t) {}
+
+bool monotonic_buffer_resource::do_is_equal(
+    const memory_resource& __other) const _NOEXCEPT
+{
+    return this == &__other;
+}
+
+} // namespace pmr
+
+_LIBCPP_END_NAMESPACE_STD
@@ -0,0 +1,274 @@
+//===---------------------- parallel_algorithms.cpp -----------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "__config"
+#include "__parallel_algorithms"
+
+#if defined(_LIBCPP_PARALLEL_ALGORITHMS_OPENMP)
+#  include <omp.h>
+#elif !defined(_LIBCPP_HAS_NO_THREADS)
+#  include "condition_variable"
+#  include "memory"
+#  include "mutex"
+#  include "thread"
+#endif
+
+_LIBCPP_BEGIN_NAMESPACE_STD
+
+#if defined(_LIBCPP_PARALLEL_ALGORITHMS_OPENMP)
+
+// The calls are chunked by OpenMP, the nested ones run serially on the
+// calling thread.
+
+unsigned __libcpp_parallel_concurrency() _NOEXCEPT
+{
+    return static_cast<unsigned>(omp_get_max_threads());
+}
+
+void __libcpp_parallel_for(size_t __n, size_t __grain,
+                           void (*__body)(void*, size_t, size_t), void* __ctx)
+{
+    if (omp_in_parallel() || omp_get_max_threads() == 1) {
+        __body(__ctx, 0, __n);
+        return;
+    }
+    const size_t __chunks = (__n + __grain - 1) / __grain;
+#pragma omp parallel for schedule(dynamic)
+    for (size_t __i = 0; __i < __chunks; ++__i)
+        __body(__ctx, __i * __grain, _VSTD::min(__n, (__i + 1) * __grain));
+}
+
+#elif !defined(_LIBCPP_HAS_NO_THREADS)
+
+// A work-stealing thread pool, started on the first call. The range of a call
+// is split evenly between the calling thread and the workers, each of them
+// taking grains from the front of its own part. Once done with it, they steal
+// the back half of the largest remaining part, so that the threads stay busy
+// until the end whatever the cost of the grains.
+//
+// One call runs at a time: the calls made while the pool is busy, by other
+// threads or from the bodies of the running call, run serially on the
+// calling thread.
+
+namespace
+{
+
+struct __slot
+{
+    mutex __mut_;
+    size_t __begin_;
+    size_t __end_;
+};
+
+struct __job
+{
+    void (*__body_)(void*, size_t, size_t);
+    void* __ctx_;
+    size_t __grain_;
+    __slot* __slots_;
+    unsigned __num_slots_;
+    // Guarded by the mutex of the pool.
+    unsigned __next_slot_;
+    unsigned __active_;
+};
+
+class __thread_pool
+{
+public:
+    __thread_pool();
+
+    unsigned __concurrency() const { return __num_workers_ + 1; }
+
+    void __run(size_t __n, size_t __grain,
+               void (*__body)(void*, size_t, size_t), void* __ctx);
+
+private:
+    void __work();
+
+    static void __participate(__job& __j, unsigned __index);
+    static bool __steal(__job& __j, unsigned __index);
+
+    mutex __mut_;
+    condition_variable __work_cv_;
+    condition_variable __done_cv_;
+    // The running call, while the workers can join it.
+    __job* __job_;
+    unsigned long long __generation_;
+    bool __busy_;
+    unsigned __num_workers_;
+};
+
+__thread_pool::__thread_pool()
+    : __job_(nullptr), __generation_(0), __busy_(false), __num_workers_(0)
+{
+    const unsigned __hardware = thread::hardware_concurrency();
+    while (__num_workers_ + 1 < __hardware) {
+#ifndef _LIBCPP_NO_EXCEPTIONS
+        try {
+#endif
+            thread(&__thread_pool::__work, this).detach();
+#ifndef _LIBCPP_NO_EXCEPTIONS
+        } catch (...) {
+            break;
+        }
+#endif
+        ++__num_workers_;
+    }
+}
+
+void __thread_pool::__work()
+{
+    unique_lock<mutex> __lk(__mut_);
+    unsigned long long __seen = __generation_;
+    for (;;) {
+        __work_cv_.wait(__lk, [&]() { return __generation_ != __seen; });
+        __seen = __generation_;
+        __job* __j = __job_;
+        if (__j == nullptr || __j->__next_slot_ == __j->__num_slots_)
+            continue;
+        const unsigned __index = __j->__next_slot_++;
+        ++__j->__active_;
+        __lk.unlock();
+        __participate(*__j, __index);
+        __lk.lock();
+        if (--__j->__active_ == 0)
+            __done_cv_.notify_all();
+    }
+}
+
+void __thread_pool::__participate(__job& __j, unsigned __index)
+{
+    __slot& __mine = __j.__slots_[__index];
+    for (;;) {
+        unique_lock<mutex> __lk(__mine.__mut_);
+        if (__mine.__begin_ == __mine.__end_) {
+            __lk.unlock();
+            if (!__steal(__j, __index))
+                return;
+            continue;
+        }
+        const size_t __b = __mine.__begin_;
+        const size_t __e = __b + _VSTD::min(__j.__grain_, __mine.__end_ - __b);
+        __mine.__begin_ = __e;
+        __lk.unlock();
+        __j.__body_(__j.__ctx_, __b, __e);
+    }
+}
+
+bool __thread_pool::__steal(__job& __j, unsigned __index)
+{
+    unsigned __victim = __index;
+    size_t __largest = 0;
+    for (unsigned __i = 0; __i != __j.__num_slots_; ++__i) {
+        if (__i == __index)
+            continue;
+        __slot& __s = __j.__slots_[__i];
+        lock_guard<mutex> __lk(__s.__mut_);
+        if (__s.__end_ - __s.__begin_ > __largest) {
+            __largest = __s.__end_ - __s.__begin_;
+            __victim = __i;
+        }
+    }
+    if (__largest == 0)
+        return false;
+
+    size_t __b, __e;
+    {
+        __slot& __s = __j.__slots_[__victim];
+        lock_guard<mutex> __lk(__s.__mut_);
+        const size_t __left = __s.__end_ - __s.__begin_;
+        if (__left == 0)
+            return true; // Taken meanwhile, look again.
+        __e = __s.__end_;
+        __b = __left <= __j.__grain_ ? __s.__begin_
+                                      : __s.__begin_ + __left / 2;
+        __s.__end_ = __b;
+    }
+    __slot& __mine = __j.__slots_[__index];
+    lock_guard<mutex> __lk(__mine.__mut_);
+    __mine.__begin_ = __b;
+    __mine.__end_ = __e;
+    return true;
+}
+
+void __thread_pool::__run(size_t __n, size_t __grain,
+                          void (*__body)(void*, size_t, size_t), void* __ctx)
+{
+    const unsigned __num_slots = __num_workers_ + 1;
+    if (__num_slots == 1 || __n <= __grain) {
+        __body(__ctx, 0, __n);
+        return;
+    }
+    unique_ptr<__slot[]> __slots(new __slot[__num_slots]);
+    for (unsigned __i = 0; __i != __num_slots; ++__i) {
+        __slots[__i].__begin_ = __i * (__n / __num_slots) +
+                                _VSTD::min<size_t>(__i, __n % __num_slots);
+        __slots[__i].__end_ = (__i + 1) * (__n / __num_slots) +
+                              _VSTD::min<size_t>(__i + 1, __n % __num_slots);
+    }
+    __job __j = {__body, __ctx, __grain, __slots.get(), __num_slots, 1, 0};
+    bool __busy;
+    {
+        lock_guard<mutex> __lk(__mut_);
+        __busy = __busy_;
+        if (!__busy) {
+            __busy_ = true;
+            __job_ = &__j;
+            ++__generation_;
+        }
+    }
+    if (__busy) {
+        __body(__ctx, 0, __n);
+        return;
+    }
+    __work_cv_.notify_all();
+
+    __participate(__j, 0);
+
+    unique_lock<mutex> __lk(__mut_);
+    __job_ = nullptr;
+    __done_cv_.wait(__lk, [&]() { return __j.__active_ == 0; });
+    __busy_ = false;
+}
+
+__thread_pool& __get_thread_pool()
+{
+    // Never destroyed, the detached workers use it until the process exits.
+    static __thread_pool* __pool = new __thread_pool;
+    return *__pool;
+}
+
+} // namespace
+
+unsigned __libcpp_parallel_concurrency() _NOEXCEPT
+{
+    return __get_thread_pool().__concurrency();
+}
+
+void __libcpp_parallel_for(size_t __n, size_t __grain,
+                           void (*__body)(void*, size_t, size_t), void* __ctx)
+{
+    __get_thread_pool().__run(__n, __grain, __body, __ctx);
+}
+
+#else // _LIBCPP_HAS_NO_THREADS
+
+unsigned __libcpp_parallel_concurrency() _NOEXCEPT
+{
+    return 1;
+}
+
+void __libcpp_parallel_for(size_t __n, size_t,
+                           void (*__body)(void*, size_t, size_t), void* __ctx)
+{
+    __body(__ctx, 0, __n);
+}
+
+#endif
+
+_LIBCPP_END_NAMESPACE_STD
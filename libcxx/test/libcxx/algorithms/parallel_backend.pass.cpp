@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++03, c++11, c++14
+// UNSUPPORTED: libcpp-has-no-threads
+
+// <execution>
+
+// The parallel algorithms running on the backend of the library, with ranges
+// split in many blocks, nested parallel calls and calls from several threads.
+
+#include <algorithm>
+#include <cassert>
+#include <execution>
+#include <functional>
+#include <numeric>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "test_macros.h"
+
+#if defined(_LIBCPP_HAS_PARALLEL_ALGORITHMS) &&                               \
+    !defined(_LIBCPP_PARALLEL_ALGORITHMS_USE_PSTL)
+
+static void test_sort(std::size_t n) {
+  std::vector<std::pair<int, std::size_t> > v(n);
+  for (std::size_t i = 0; i != n; ++i)
+    v[i] = std::make_pair(int((i * 7919) % 101), i);
+  auto by_first = [](const std::pair<int, std::size_t>& x,
+                     const std::pair<int, std::size_t>& y) {
+    return x.first < y.first;
+  };
+
+  auto expected = v;
+  std::stable_sort(expected.begin(), expected.end(), by_first);
+  auto stable = v;
+  std::stable_sort(std::execution::par, stable.begin(), stable.end(),
+                   by_first);
+  assert(stable == expected);
+
+  auto sorted = v;
+  std::sort(std::execution::par_unseq, sorted.begin(), sorted.end());
+  assert(std::is_sorted(sorted.begin(), sorted.end()));
+}
+
+static void test_reductions(std::size_t n) {
+  std::vector<long long> v(n);
+  std::iota(v.begin(), v.end(), 1);
+  const long long sum = (long long)n * ((long long)n + 1) / 2;
+  assert(std::reduce(std::execution::par, v.begin(), v.end()) == sum);
+  assert(std::transform_reduce(std::execution::par, v.begin(), v.end(), 0LL,
+                               std::plus<>(),
+                               [](long long x) { return 2 * x; }) == 2 * sum);
+  assert(std::count_if(std::execution::par, v.begin(), v.end(),
+                       [](long long x) { return x % 2 == 0; }) ==
+         (long long)n / 2);
+  if (n != 0) {
+    assert(std::find(std::execution::par, v.begin(), v.end(), (long long)n) ==
+           v.end() - 1);
+    assert(std::any_of(std::execution::par, v.begin(), v.end(),
+                       [](long long x) { return x == 1; }));
+  }
+  assert(std::none_of(std::execution::par, v.begin(), v.end(),
+                      [](long long x) { return x <= 0; }));
+}
+
+static void test_nested() {
+  std::vector<int> outer(3000, 1);
+  std::vector<int> inner(1000, 1);
+  std::vector<int> counts(outer.size());
+  std::transform(std::execution::par, outer.begin(), outer.end(),
+                 counts.begin(), [&](int x) {
+                   return x * std::reduce(std::execution::par, inner.begin(),
+                                          inner.end());
+                 });
+  assert(std::count(counts.begin(), counts.end(), 1000) == 3000);
+}
+
+int main(int, char**) {
+  for (std::size_t n : {0, 1, 511, 512, 513, 4096, 100000, 300001}) {
+    test_sort(n);
+    test_reductions(n);
+  }
+  test_nested();
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t != 4; ++t)
+    threads.emplace_back([] {
+      test_sort(50000);
+      test_reductions(50000);
+    });
+  for (auto& thread : threads)
+    thread.join();
+
+  return 0;
+}
+
+#else
+
+int main(int, char**) { return 0; }
+
+#endif
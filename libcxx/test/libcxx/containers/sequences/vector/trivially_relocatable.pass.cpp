@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++03
+
+// <vector>
+
+// The vector moves the trivially relocatable elements by copying their bytes
+// when it reallocates, without moving nor destroying them one by one.
+
+#include <vector>
+#include <cassert>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include "test_macros.h"
+#include "min_allocator.h"
+
+struct Counted {
+  typedef Counted __trivially_relocatable;
+
+  static int moves;
+  static int destructions;
+
+  int* value;
+
+  explicit Counted(int v) : value(new int(v)) {}
+  Counted(Counted&& other) : value(other.value) { other.value = nullptr; ++moves; }
+  ~Counted() { delete value; ++destructions; }
+};
+
+int Counted::moves = 0;
+int Counted::destructions = 0;
+
+#if _LIBCPP_DEBUG_LEVEL != 2
+static_assert(std::__libcpp_is_trivially_relocatable<std::string>::value, "");
+static_assert(std::__libcpp_is_trivially_relocatable<std::vector<int> >::value, "");
+#endif
+static_assert(std::__libcpp_is_trivially_relocatable<std::unique_ptr<int> >::value, "");
+static_assert(std::__libcpp_is_trivially_relocatable<std::unique_ptr<int[]> >::value, "");
+static_assert(std::__libcpp_is_trivially_relocatable<std::shared_ptr<int> >::value, "");
+static_assert(std::__libcpp_is_trivially_relocatable<std::weak_ptr<int> >::value, "");
+
+static_assert(std::__allocator_can_relocate<std::allocator<Counted> >::value, "");
+static_assert(!std::__allocator_can_relocate<min_allocator<Counted> >::value, "");
+
+int main(int, char**)
+{
+    {
+        std::vector<Counted> v;
+        for (int i = 0; i != 100; ++i)
+            v.emplace_back(i);
+        assert(Counted::moves == 0);
+        assert(Counted::destructions == 0);
+        v.emplace(v.begin() + 50, -1);
+        v.reserve(v.capacity() * 2);
+        v.shrink_to_fit();
+        assert(Counted::destructions == 0);
+        assert(v.size() == 101);
+        for (int i = 0; i != 50; ++i)
+            assert(*v[i].value == i);
+        assert(*v[50].value == -1);
+        for (int i = 51; i != 101; ++i)
+            assert(*v[i].value == i - 1);
+    }
+    assert(Counted::destructions == 101);
+    {
+        // Short and long strings alike.
+        std::vector<std::string> v;
+        for (int i = 0; i != 100; ++i)
+            v.push_back(std::string(i, char('a' + i % 26)));
+        v.insert(v.begin() + 10, std::string(1000, 'x'));
+        assert(v.size() == 101);
+        for (int i = 0; i != 10; ++i)
+            assert(v[i] == std::string(i, char('a' + i % 26)));
+        assert(v[10] == std::string(1000, 'x'));
+        for (int i = 11; i != 101; ++i)
+            assert(v[i] == std::string(i - 1, char('a' + (i - 1) % 26)));
+    }
+    {
+        std::shared_ptr<int> p = std::make_shared<int>(42);
+        {
+            std::vector<std::shared_ptr<int> > v;
+            for (int i = 0; i != 100; ++i)
+                v.push_back(p);
+            assert(p.use_count() == 101);
+        }
+        assert(p.use_count() == 1);
+    }
+    {
+        std::vector<std::unique_ptr<int> > v;
+        for (int i = 0; i != 100; ++i)
+            v.push_back(std::unique_ptr<int>(new int(i)));
+        for (int i = 0; i != 100; ++i)
+            assert(*v[i] == i);
+    }
+
+  return 0;
+}
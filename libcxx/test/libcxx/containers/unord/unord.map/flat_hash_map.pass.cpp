@@ -0,0 +1,156 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// <unordered_map>
+
+// class __flat_hash_map
+
+// UNSUPPORTED: c++03
+
+// Check the libc++ extension __flat_hash_map: insertion, lookup and erasure
+// through the growths of the table, and with the deleted slots left by the
+// erasures.
+
+#include <unordered_map>
+#include <string>
+#include <cassert>
+
+#include "test_macros.h"
+#include "test_allocator.h"
+
+// Every key in the same group, the lookups must probe past the full ones.
+struct BadHash {
+    std::size_t operator()(int) const { return 42; }
+};
+
+template <class Map>
+void test_int_map() {
+    Map m;
+    assert(m.empty());
+    assert(m.begin() == m.end());
+    assert(m.find(1) == m.end());
+    assert(m.erase(1) == 0);
+
+    for (int i = 0; i < 1000; ++i) {
+        auto r = m.insert(typename Map::value_type(i, 2 * i));
+        assert(r.second);
+        assert(r.first->first == i);
+        assert(r.first->second == 2 * i);
+    }
+    assert(m.size() == 1000);
+    assert(m.load_factor() <= m.max_load_factor());
+    for (int i = 0; i < 1000; ++i) {
+        assert(m.find(i) != m.end());
+        assert(m.at(i) == 2 * i);
+    }
+    assert(!m.insert(typename Map::value_type(5, 0)).second);
+    assert(m[5] == 10);
+
+    // Erase the odd keys and insert them back, reusing the deleted slots.
+    for (int i = 1; i < 1000; i += 2)
+        assert(m.erase(i) == 1);
+    assert(m.size() == 500);
+    for (int i = 0; i < 1000; ++i)
+        assert(m.contains(i) == (i % 2 == 0));
+    for (int i = 1; i < 1000; i += 2)
+        assert(m.try_emplace(i, 3 * i).second);
+    assert(m.size() == 1000);
+    for (int i = 0; i < 1000; ++i)
+        assert(m.at(i) == (i % 2 == 0 ? 2 * i : 3 * i));
+
+    std::size_t n = 0;
+    for (auto it = m.begin(); it != m.end(); ++it)
+        ++n;
+    assert(n == m.size());
+
+    // Erasing while iterating visits every element once.
+    for (auto it = m.begin(); it != m.end();) {
+        if (it->first % 3 == 0)
+            it = m.erase(it);
+        else
+            ++it;
+    }
+    assert(m.size() == 666);
+    for (int i = 0; i < 1000; ++i)
+        assert(m.count(i) == (i % 3 != 0 ? 1u : 0u));
+
+    m.clear();
+    assert(m.empty());
+    assert(m.begin() == m.end());
+    assert(m.find(1) == m.end());
+}
+
+int main(int, char**) {
+    test_int_map<std::__flat_hash_map<int, int> >();
+    test_int_map<std::__flat_hash_map<int, int, BadHash> >();
+    test_int_map<std::__flat_hash_map<int, int, std::hash<int>,
+                                      std::equal_to<int>,
+                                      test_allocator<std::pair<const int, int> > > >();
+
+    {
+        // Many erasures and insertions at a constant size, the deleted slots
+        // must not fill the table.
+        std::__flat_hash_map<int, int> m;
+        for (int i = 0; i < 100000; ++i) {
+            m[i] = i;
+            if (i >= 10)
+                assert(m.erase(i - 10) == 1);
+        }
+        assert(m.size() == 10);
+        assert(m.capacity() <= 64);
+    }
+    {
+        std::__flat_hash_map<std::string, std::string> m;
+        for (int i = 0; i < 100; ++i)
+            m.insert_or_assign(std::to_string(i), std::string(50, 'a' + i % 26));
+        assert(m.size() == 100);
+        assert(m["42"] == std::string(50, 'a' + 42 % 26));
+        assert(!m.insert_or_assign("42", "x").second);
+        assert(m.at("42") == "x");
+
+        std::__flat_hash_map<std::string, std::string> c = m;
+        assert(c == m);
+        c.erase("42");
+        assert(c != m);
+        std::__flat_hash_map<std::string, std::string> d = std::move(c);
+        assert(c.empty());
+        assert(d.size() == 99);
+        c = d;
+        assert(c == d);
+        c.swap(m);
+        assert(c.size() == 100 && m.size() == 99);
+    }
+    {
+        // The arguments refer to an element moved by the growth of the table.
+        std::__flat_hash_map<std::string, std::string> m;
+        m.reserve(7);
+        for (int i = 0; i < 7; ++i)
+            m.emplace(std::to_string(i), std::string(50, 'b'));
+        assert(m.capacity() == 8);
+        const std::string& v = m.begin()->second;
+        assert(m.try_emplace("7", v).second);
+        assert(m.capacity() == 16);
+        assert(m.at("7") == std::string(50, 'b'));
+    }
+    {
+        std::__flat_hash_map<int, std::string> m = {{1, "one"}, {2, "two"}};
+        assert(m.size() == 2);
+        assert(m.emplace(3, "three").second);
+        assert(!m.emplace(std::make_pair(3, "drei")).second);
+        assert(m.at(3) == "three");
+#ifndef TEST_HAS_NO_EXCEPTIONS
+        try {
+            m.at(4);
+            assert(false);
+        } catch (const std::out_of_range&) {
+        }
+#endif
+    }
+
+    return 0;
+}
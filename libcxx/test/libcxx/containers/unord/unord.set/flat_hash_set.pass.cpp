@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// <unordered_set>
+
+// class __flat_hash_set
+
+// UNSUPPORTED: c++03
+
+// Check the libc++ extension __flat_hash_set, and that the hash of the integer
+// keys, the identity, is mixed before it picks a group: keys differing only in
+// their high bits stay cheap to find.
+
+#include <unordered_set>
+#include <string>
+#include <cassert>
+
+#include "test_macros.h"
+
+// Counts the key comparisons.
+struct CountingEqual {
+    static int calls;
+    bool operator()(unsigned long long x, unsigned long long y) const {
+        ++calls;
+        return x == y;
+    }
+};
+int CountingEqual::calls = 0;
+
+int main(int, char**) {
+    {
+        typedef std::__flat_hash_set<unsigned long long,
+                                     std::hash<unsigned long long>,
+                                     CountingEqual> Set;
+        Set s;
+        for (unsigned long long i = 0; i < 4096; ++i)
+            assert(s.insert(i << 40).second);
+        assert(s.size() == 4096);
+        CountingEqual::calls = 0;
+        for (unsigned long long i = 0; i < 4096; ++i)
+            assert(s.find(i << 40) != s.end());
+        assert(CountingEqual::calls < 2 * 4096);
+        CountingEqual::calls = 0;
+        for (unsigned long long i = 0; i < 4096; ++i)
+            assert(s.find((i << 40) + 1) == s.end());
+        assert(CountingEqual::calls < 4096);
+    }
+    {
+        std::__flat_hash_set<std::string> s;
+        for (int i = 0; i < 500; ++i)
+            assert(s.emplace(std::to_string(i)).second);
+        assert(!s.insert("7").second);
+        assert(s.erase("7") == 1);
+        assert(s.erase("7") == 0);
+        assert(s.count("7") == 0);
+        assert(s.insert("7").second);
+        assert(s.size() == 500);
+
+        std::__flat_hash_set<std::string> c(s.begin(), s.end());
+        assert(c == s);
+        c.rehash(0);
+        assert(c == s);
+        c.rehash(4096);
+        assert(c.capacity() >= 4096);
+        assert(c == s);
+        c.erase(c.begin(), c.end());
+        assert(c.empty());
+        c.rehash(0);
+        assert(c.capacity() == 0);
+    }
+    {
+        std::__flat_hash_set<int> s = {3, 1, 4, 1, 5, 9, 2, 6};
+        assert(s.size() == 7);
+        int sum = 0;
+        for (int x : s)
+            sum += x;
+        assert(sum == 30);
+    }
+
+    return 0;
+}
@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// <regex>
+// UNSUPPORTED: c++03
+
+// An ECMAScript regex constructed with regex_constants::optimize is matched
+// without backtracking, and finds the same matches as one without it.
+
+#include <regex>
+#include <cassert>
+#include <string>
+#include "test_macros.h"
+
+template <class CharT>
+void compare(const CharT* pattern, const CharT* text,
+             std::regex_constants::syntax_option_type op = std::regex::ECMAScript,
+             std::regex_constants::match_flag_type flags = std::regex_constants::match_default) {
+  const std::basic_regex<CharT> slow(pattern, op);
+  const std::basic_regex<CharT> fast(pattern, op | std::regex::optimize);
+  const std::basic_string<CharT> s(text);
+  std::match_results<const CharT*> ms, mf;
+
+  bool b = std::regex_search(s.data(), s.data() + s.size(), ms, slow, flags);
+  assert(std::regex_search(s.data(), s.data() + s.size(), mf, fast, flags) == b);
+  assert(std::regex_search(s.data(), s.data() + s.size(), fast, flags) == b);
+  assert(ms.size() == mf.size());
+  for (std::size_t i = 0; i < ms.size(); ++i) {
+    assert(ms[i].matched == mf[i].matched);
+    if (ms[i].matched) {
+      assert(ms.position(i) == mf.position(i));
+      assert(ms.length(i) == mf.length(i));
+    }
+  }
+
+  b = std::regex_match(s.data(), s.data() + s.size(), ms, slow, flags);
+  assert(std::regex_match(s.data(), s.data() + s.size(), mf, fast, flags) == b);
+  assert(std::regex_match(s.data(), s.data() + s.size(), fast, flags) == b);
+  assert(ms.size() == mf.size());
+  for (std::size_t i = 0; i < ms.size(); ++i) {
+    assert(ms[i].matched == mf[i].matched);
+    if (ms[i].matched) {
+      assert(ms.position(i) == mf.position(i));
+      assert(ms.length(i) == mf.length(i));
+    }
+  }
+
+  typedef std::regex_iterator<const CharT*> I;
+  I is(s.data(), s.data() + s.size(), slow, flags);
+  I it(s.data(), s.data() + s.size(), fast, flags);
+  for (; is != I(); ++is, ++it) {
+    assert(it != I());
+    assert(is->position(0) == it->position(0));
+    assert(is->length(0) == it->length(0));
+  }
+  assert(it == I());
+}
+
+int main(int, char**) {
+  compare("(a|b)*c", "xxababcx");
+  compare("(a|ab)(c|bcd)(d*)", "abcd");
+  compare("(a+)(b+)?", "aaac aab");
+  compare("(a+?)(b*?)c", "aaabbc");
+  compare("a{2,3}?b{0,2}", "aaaabbb");
+  compare("(?:x(y)?)+", "xyxx");
+  compare("(a*)*b", "aaab");
+  compare("(a*)+", "aaa b");
+  compare("(.{2,}?|[ab]*?)+", "abb ");
+  compare("((a)|b)+", "ab");
+  compare("[^a-c]+|c", "abcdef");
+  compare("^ab|cd$", "ab\ncd", std::regex::multiline);
+  compare("\\bfoo\\B", "foofoo foox foo");
+  compare("AB(c)", "xabcx", std::regex::icase);
+  compare("a|", "bab", std::regex::ECMAScript, std::regex_constants::match_not_null);
+  compare("b*", "aab", std::regex::ECMAScript, std::regex_constants::match_continuous);
+  compare("^a", "aa", std::regex::ECMAScript, std::regex_constants::match_not_bol);
+  compare(L"(\u00e9|e)+t", L"\u00e9et\u0101t");
+
+  // Back references are matched by backtracking.
+  compare("(a+)b\\1", "aabaa");
+  compare("(?=(a+))a*b\\1", "baaabac");
+
+  // The inputs on which backtracking takes exponential time or a lot of
+  // memory.
+  std::string s(30, 'a');
+  assert(!std::regex_search(s, std::regex("(a|aa)*b", std::regex::optimize)));
+  assert(std::regex_search(
+      "aaaaaaaaaaaaaaaaaaaa",
+      std::regex("a?a?a?a?a?a?a?a?a?a?a?a?a?a?a?a?a?a?a?a?aaaaaaaaaaaaaaaaaaaa",
+                 std::regex::optimize)));
+  s.assign(1000000, 'a');
+  std::smatch m;
+  assert(std::regex_match(s, m, std::regex("(a|b)*c?", std::regex::optimize)));
+  assert(m.length(0) == 1000000);
+  assert(m.position(1) == 999999);
+
+  return 0;
+}
@@ -0,0 +1,49 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// <type_traits>
+
+// __libcpp_is_trivially_relocatable<T>
+
+#include <type_traits>
+
+#include "test_macros.h"
+
+struct Trivial { int i; };
+
+struct NonTrivialMove {
+  NonTrivialMove(const NonTrivialMove&);
+};
+
+struct NonTrivialDestructor {
+  ~NonTrivialDestructor();
+};
+
+struct OptedIn {
+  typedef OptedIn __trivially_relocatable;
+  OptedIn(const OptedIn&);
+  ~OptedIn();
+};
+
+struct OptedOut {
+  typedef void __trivially_relocatable;
+  OptedOut(const OptedOut&);
+  ~OptedOut();
+};
+
+// The typedef only counts for the class that declares it.
+struct Derived : OptedIn {};
+
+static_assert(std::__libcpp_is_trivially_relocatable<int>::value, "");
+static_assert(std::__libcpp_is_trivially_relocatable<int*>::value, "");
+static_assert(std::__libcpp_is_trivially_relocatable<Trivial>::value, "");
+static_assert(!std::__libcpp_is_trivially_relocatable<NonTrivialMove>::value, "");
+static_assert(!std::__libcpp_is_trivially_relocatable<NonTrivialDestructor>::value, "");
+static_assert(std::__libcpp_is_trivially_relocatable<OptedIn>::value, "");
+static_assert(!std::__libcpp_is_trivially_relocatable<OptedOut>::value, "");
+static_assert(!std::__libcpp_is_trivially_relocatable<Derived>::value, "");
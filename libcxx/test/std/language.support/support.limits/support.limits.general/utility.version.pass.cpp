@@ -126,17 +126,11 @@
 #   error "__cpp_lib_integer_sequence should have the value 201304L in c++17"
 # endif
 
-# if !defined(_LIBCPP_VERSION)
-#   ifndef __cpp_lib_to_chars
-#     error "__cpp_lib_to_chars should be defined in c++17"
-#   endif
-#   if __cpp_lib_to_chars != 201611L
-#     error "__cpp_lib_to_chars should have the value 201611L in c++17"
-#   endif
-# else // _LIBCPP_VERSION
-#   ifdef __cpp_lib_to_chars
-#     error "__cpp_lib_to_chars should not be defined because it is unimplemented in libc++!"
-#   endif
+# ifndef __cpp_lib_to_chars
+#   error "__cpp_lib_to_chars should be defined in c++17"
+# endif
+# if __cpp_lib_to_chars != 201611L
+#   error "__cpp_lib_to_chars should have the value 201611L in c++17"
 # endif
 
 # ifndef __cpp_lib_tuples_by_type
@@ -189,17 +183,11 @@
 #   error "__cpp_lib_integer_sequence should have the value 201304L in c++2a"
 # endif
 
-# if !defined(_LIBCPP_VERSION)
-#   ifndef __cpp_lib_to_chars
-#     error "__cpp_lib_to_chars should be defined in c++2a"
-#   endif
-#   if __cpp_lib_to_chars != 201611L
-#     error "__cpp_lib_to_chars should have the value 201611L in c++2a"
-#   endif
-# else // _LIBCPP_VERSION
-#   ifdef __cpp_lib_to_chars
-#     error "__cpp_lib_to_chars should not be defined because it is unimplemented in libc++!"
-#   endif
+# ifndef __cpp_lib_to_chars
+#   error "__cpp_lib_to_chars should be defined in c++2a"
+# endif
+# if __cpp_lib_to_chars != 201611L
+#   error "__cpp_lib_to_chars should have the value 201611L in c++2a"
 # endif
 
 # ifndef __cpp_lib_tuples_by_type
@@ -0,0 +1,158 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++03, c++11, c++14
+
+// The floating-point overloads are defined in the dylib.
+// XFAIL: with_system_cxx_lib=macosx
+
+// <charconv>
+
+// from_chars_result from_chars(const char* first, const char* last,
+//                              Floating& value,
+//                              chars_format fmt = chars_format::general);
+
+#include <charconv>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+
+#include "test_macros.h"
+
+template <class T>
+void test(const char* s, std::chars_format fmt, T expected, std::size_t len = std::size_t(-1)) {
+  if (len == std::size_t(-1))
+    len = std::strlen(s);
+  T value = T(-7);
+  std::from_chars_result r = std::from_chars(s, s + std::strlen(s), value, fmt);
+  assert(r.ec == std::errc());
+  assert(r.ptr == s + len);
+  if (std::isnan(expected))
+    assert(std::isnan(value) && std::signbit(value) == std::signbit(expected));
+  else
+    assert(value == expected && std::signbit(value) == std::signbit(expected));
+}
+
+template <class T>
+void test_error(const char* s, std::chars_format fmt, std::errc ec, std::size_t len) {
+  T value = T(-7);
+  std::from_chars_result r = std::from_chars(s, s + std::strlen(s), value, fmt);
+  assert(r.ec == ec);
+  assert(r.ptr == s + len);
+  assert(value == T(-7));
+}
+
+void test_patterns() {
+  const std::chars_format fixed = std::chars_format::fixed;
+  const std::chars_format scientific = std::chars_format::scientific;
+  const std::chars_format general = std::chars_format::general;
+  const std::chars_format hex = std::chars_format::hex;
+
+  test("1", general, 1.0);
+  test("-1.5", general, -1.5);
+  test("-0", general, -0.0);
+  test(".5", general, 0.5);
+  test("5.", general, 5.0);
+  test("1e3", general, 1000.0);
+  test("1E-3", general, 0.001);
+  test("1e+3", general, 1000.0);
+  test("1e", general, 1.0, 1);
+  test("1e+", general, 1.0, 1);
+  test("1.5x", general, 1.5, 3);
+  test("0e999999999999", general, 0.0);
+  test("000000000000000000000000000000000000000001e-5", general, 1e-5);
+  test("1e3", fixed, 1.0, 1);
+  test("1e3", scientific, 1000.0);
+  test("1p3", hex, 8.0);
+  test("1.8P1", hex, 3.0);
+  test("ff.8p-3", hex, 31.9375);
+  test("0x1p3", hex, 0.0, 1);
+  test("1p", hex, 1.0, 1);
+  test("1e3", hex, 0x1e3 * 1.0);
+
+  test("inf", general, std::numeric_limits<double>::infinity());
+  test("-INFINITY", scientific, -std::numeric_limits<double>::infinity());
+  test("infin", fixed, std::numeric_limits<double>::infinity(), 3);
+  test("nan", hex, std::numeric_limits<double>::quiet_NaN());
+  test("-NaN(abc_1)", general, -std::numeric_limits<double>::quiet_NaN());
+  test("nan(a b)", general, std::numeric_limits<double>::quiet_NaN(), 3);
+  test("nan(", general, std::numeric_limits<double>::quiet_NaN(), 3);
+
+  test_error<double>("", general, std::errc::invalid_argument, 0);
+  test_error<double>("-", general, std::errc::invalid_argument, 0);
+  test_error<double>(".", general, std::errc::invalid_argument, 0);
+  test_error<double>("+1", general, std::errc::invalid_argument, 0);
+  test_error<double>(" 1", general, std::errc::invalid_argument, 0);
+  test_error<double>("e5", general, std::errc::invalid_argument, 0);
+  test_error<double>("1", scientific, std::errc::invalid_argument, 0);
+  test_error<double>("1e", scientific, std::errc::invalid_argument, 0);
+  test_error<double>("p3", hex, std::errc::invalid_argument, 0);
+}
+
+void test_rounding() {
+  const std::chars_format general = std::chars_format::general;
+  const std::chars_format hex = std::chars_format::hex;
+
+  test("0.1", general, 0.1);
+  test("0.1", general, 0.1f);
+  test("9007199254740993", general, 9007199254740992.0);
+  test("9007199254740993.0000000000000000000000001", general, 9007199254740994.0);
+  test("9007199254740995", general, 9007199254740996.0);
+  // 1 + 2^-53 is halfway between 1 and the next double.
+  test("1.00000000000000011102230246251565404236316680908203125", general, 1.0);
+  test("1.00000000000000011102230246251565404236316680908203126", general, 1.0000000000000002);
+  test("1.00000000000000011102230246251565404236316680908203124", general, 1.0);
+  test("1.7976931348623157e308", general, 1.7976931348623157e308);
+  test("1.797693134862315807e308", general, 1.7976931348623157e308);
+  test("2.2250738585072011e-308", general, 2.225073858507201e-308);
+  test("4.9406564584124654e-324", general, 5e-324);
+  test("2.4703282292062328e-324", general, 5e-324);
+  test("3.4028235e38", general, 3.4028235e38f);
+  test("1e-45", general, 1e-45f);
+  test("7.0064923216240862e-46", general, 1e-45f);
+
+  test_error<double>("1.fffffffffffff8p1023", hex, std::errc::result_out_of_range, 21);
+  test("1.fffffffffffff7ffffp1023", hex, 1.7976931348623157e308);
+  test_error<double>("0.00000000000008p-1022", hex, std::errc::result_out_of_range, 22);
+  test("0.00000000000008000001p-1022", hex, 5e-324);
+  test("1.000001p0", hex, 1.0f);
+  test("1.000003p0", hex, 1.0000002f);
+}
+
+void test_range() {
+  const std::chars_format general = std::chars_format::general;
+
+  test_error<double>("1e400", general, std::errc::result_out_of_range, 5);
+  test_error<double>("-1e400", general, std::errc::result_out_of_range, 6);
+  test_error<double>("1.7976931348623159e308", general, std::errc::result_out_of_range, 22);
+  test_error<double>("1e-400", general, std::errc::result_out_of_range, 6);
+  test_error<double>("2.4703282292062327e-324", general, std::errc::result_out_of_range, 23);
+  test_error<double>("1e2147483648", general, std::errc::result_out_of_range, 12);
+  test_error<float>("3.4028236e38", general, std::errc::result_out_of_range, 12);
+  test_error<float>("7e-46", general, std::errc::result_out_of_range, 5);
+}
+
+void test_long_double() {
+  long double value = 0;
+  const char s[] = "1.5";
+  std::from_chars_result r = std::from_chars(s, s + 3, value);
+  assert(r.ec == std::errc());
+  assert(r.ptr == s + 3);
+  assert(value == 1.5L);
+}
+
+int main(int, char**) {
+  test_patterns();
+  test_rounding();
+  test_range();
+  test_long_double();
+
+  return 0;
+}
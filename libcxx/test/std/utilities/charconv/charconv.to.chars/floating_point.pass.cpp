@@ -0,0 +1,216 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++03, c++11, c++14
+
+// The floating-point overloads are defined in the dylib.
+// XFAIL: with_system_cxx_lib=macosx
+
+// <charconv>
+
+// to_chars_result to_chars(char* first, char* last, Floating value);
+// to_chars_result to_chars(char* first, char* last, Floating value,
+//                          chars_format fmt);
+// to_chars_result to_chars(char* first, char* last, Floating value,
+//                          chars_format fmt, int precision);
+
+#include <charconv>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "test_macros.h"
+
+void check(const char* expected, std::to_chars_result r, char* first) {
+  const size_t len = std::strlen(expected);
+  assert(r.ec == std::errc());
+  assert(r.ptr == first + len);
+  assert(std::memcmp(first, expected, len) == 0);
+}
+
+template <class T>
+void test(T value, const char* expected) {
+  char buf[2048];
+  const size_t len = std::strlen(expected);
+  check(expected, std::to_chars(buf, buf + sizeof(buf), value), buf);
+  std::to_chars_result r = std::to_chars(buf, buf + len - 1, value);
+  assert(r.ec == std::errc::value_too_large);
+  assert(r.ptr == buf + len - 1);
+}
+
+template <class T>
+void test(T value, std::chars_format fmt, const char* expected) {
+  char buf[2048];
+  const size_t len = std::strlen(expected);
+  check(expected, std::to_chars(buf, buf + sizeof(buf), value, fmt), buf);
+  std::to_chars_result r = std::to_chars(buf, buf + len - 1, value, fmt);
+  assert(r.ec == std::errc::value_too_large);
+  assert(r.ptr == buf + len - 1);
+}
+
+template <class T>
+void test(T value, std::chars_format fmt, int precision, const char* expected) {
+  char buf[2048];
+  const size_t len = std::strlen(expected);
+  check(expected, std::to_chars(buf, buf + sizeof(buf), value, fmt, precision), buf);
+  std::to_chars_result r = std::to_chars(buf, buf + len - 1, value, fmt, precision);
+  assert(r.ec == std::errc::value_too_large);
+  assert(r.ptr == buf + len - 1);
+}
+
+void test_shortest() {
+  const std::chars_format fixed = std::chars_format::fixed;
+  const std::chars_format scientific = std::chars_format::scientific;
+  const std::chars_format general = std::chars_format::general;
+  const std::chars_format hex = std::chars_format::hex;
+
+  // Without a format, the shorter of fixed and scientific, fixed on a tie.
+  test(0.0, "0");
+  test(-0.0, "-0");
+  test(1.0, "1");
+  test(0.1, "0.1");
+  test(100.0, "100");
+  test(0.0001, "1e-04");
+  test(0.001, "0.001");
+  test(1e16, "1e+16");
+  test(123456.0, "123456");
+  test(12345678901234567168.0, "12345678901234567168");
+  test(1.7976931348623157e308, "1.7976931348623157e+308");
+  test(5e-324, "5e-324");
+  test(0.1f, "0.1");
+  test(3.4028235e38f, "3.4028235e+38");
+  test(1e-45f, "1e-45");
+
+  test(1.0, fixed, "1");
+  test(0.5, fixed, "0.5");
+  test(123.456, fixed, "123.456");
+  test(0.0001, fixed, "0.0001");
+  test(1e23, fixed, "99999999999999991611392");
+  test(1e22, fixed, "10000000000000000000000");
+  test(1e21f, fixed, "1000000020040877342720");
+
+  test(0.0, scientific, "0e+00");
+  test(1.0, scientific, "1e+00");
+  test(123.456, scientific, "1.23456e+02");
+  test(1e100, scientific, "1e+100");
+  test(-2.5e-7, scientific, "-2.5e-07");
+  test(5e-324, scientific, "5e-324");
+  test(1.17549435e-38f, scientific, "1.1754944e-38");
+
+  test(100.0, general, "100");
+  test(123456.0, general, "123456");
+  test(1234567.0, general, "1.234567e+06");
+  test(0.0001, general, "0.0001");
+  test(0.00001, general, "1e-05");
+  test(1e16, general, "1e+16");
+
+  test(0.0, hex, "0p+0");
+  test(-0.0, hex, "-0p+0");
+  test(1.0, hex, "1p+0");
+  test(3.0, hex, "1.8p+1");
+  test(0.1, hex, "1.999999999999ap-4");
+  test(5e-324, hex, "0.0000000000001p-1022");
+  test(2.2250738585072014e-308, hex, "1p-1022");
+  test(1.7976931348623157e308, hex, "1.fffffffffffffp+1023");
+  test(0.1f, hex, "1.99999ap-4");
+  test(1e-45f, hex, "0.000002p-126");
+}
+
+void test_precision() {
+  const std::chars_format fixed = std::chars_format::fixed;
+  const std::chars_format scientific = std::chars_format::scientific;
+  const std::chars_format general = std::chars_format::general;
+  const std::chars_format hex = std::chars_format::hex;
+
+  test(0.0, fixed, 3, "0.000");
+  test(1.5, fixed, -1, "1.500000");
+  test(123.456, fixed, 2, "123.46");
+  test(0.125, fixed, 2, "0.12");
+  test(0.375, fixed, 2, "0.38");
+  // Rounding is half to even on the exact binary value.
+  test(0.5, fixed, 0, "0");
+  test(1.5, fixed, 0, "2");
+  test(2.5, fixed, 0, "2");
+  test(0.1, fixed, 0, "0");
+  test(0.05, fixed, 1, "0.1");
+  test(0.0001, fixed, 2, "0.00");
+  test(0.006, fixed, 2, "0.01");
+  test(999.9999, fixed, 2, "1000.00");
+  test(0.1, fixed, 30, "0.100000000000000005551115123126");
+  test(1e23, fixed, 1, "99999999999999991611392.0");
+  test(5e-324, fixed, 330, "0.000000000000000000000000000000000000000000000000000000000000000000000000000000"
+                           "00000000000000000000000000000000000000000000000000000000000000000000000000000000"
+                           "00000000000000000000000000000000000000000000000000000000000000000000000000000000"
+                           "00000000000000000000000000000000000000000000000000000000000000000000000000000000"
+                           "000004940656");
+  test(0.1f, fixed, 10, "0.1000000015");
+
+  test(0.0, scientific, 3, "0.000e+00");
+  test(1.5, scientific, -1, "1.500000e+00");
+  test(9.5, scientific, 0, "1e+01");
+  test(0.5, scientific, 0, "5e-01");
+  test(123.456, scientific, 3, "1.235e+02");
+  test(-1e-300, scientific, 2, "-1.00e-300");
+  test(1e300, scientific, 20, "1.00000000000000005250e+300");
+  test(3.4028235e38f, scientific, 9, "3.402823466e+38");
+
+  test(0.0, general, 3, "0");
+  test(-0.0, general, 0, "-0");
+  test(1.5, general, -1, "1.5");
+  test(123456789.0, general, 3, "1.23e+08");
+  test(0.0001, general, 3, "0.0001");
+  test(100.0, general, 6, "100");
+  test(0.00001, general, 6, "1e-05");
+  test(999999.5, general, 6, "1e+06");
+  test(123.456, general, 100, "123.4560000000000030695446184836328029632568359375");
+
+  test(0.0, hex, 3, "0.000p+0");
+  test(1.5, hex, -1, "1.8p+0");
+  test(3.0, hex, 0, "2p+1");
+  test(1.0, hex, 2, "1.00p+0");
+  test(0.1, hex, 3, "1.99ap-4");
+  test(0.1, hex, 20, "1.999999999999a0000000p-4");
+  test(1.9999999999999998, hex, 0, "2p+0");
+  test(1.7976931348623157e308, hex, 0, "2p+1023");
+  test(5e-324, hex, 0, "0p-1022");
+  test(5e-324, hex, 3, "0.000p-1022");
+  test(0.1f, hex, 3, "1.99ap-4");
+}
+
+void test_special() {
+  const std::chars_format formats[] = {std::chars_format::fixed, std::chars_format::scientific,
+                                       std::chars_format::general, std::chars_format::hex};
+  const double inf = std::numeric_limits<double>::infinity();
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  test(inf, "inf");
+  test(-inf, "-inf");
+  test(nan, "nan");
+  test(std::copysign(nan, -1.0), "-nan");
+  test(std::numeric_limits<float>::infinity(), "inf");
+  for (std::chars_format fmt : formats) {
+    test(inf, fmt, "inf");
+    test(-inf, fmt, 3, "-inf");
+    test(nan, fmt, "nan");
+    test(std::numeric_limits<float>::quiet_NaN(), fmt, 3, "nan");
+  }
+}
+
+void test_long_double() {
+  test(1.5L, "1.5");
+  test(0.1L, std::chars_format::scientific, 3, "1.000e-01");
+}
+
+int main(int, char**) {
+  test_shortest();
+  test_precision();
+  test_special();
+  test_long_double();
+
+  return 0;
+}
@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++03, c++11, c++14
+
+// <memory_resource>
+
+// template <class T> class polymorphic_allocator;
+
+// The containers of std::pmr pass their resource to the elements that use a
+// polymorphic allocator.
+
+#include <memory_resource>
+#include <cassert>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "test_macros.h"
+
+int main(int, char**) {
+  std::pmr::monotonic_buffer_resource mono;
+  {
+    std::pmr::vector<std::pmr::string> v(&mono);
+    v.emplace_back("a string that does not fit in the small buffer");
+    v.push_back(std::pmr::string("another one, also too long for the buffer"));
+    assert(v.get_allocator().resource() == &mono);
+    assert(v[0].get_allocator().resource() == &mono);
+    assert(v[1].get_allocator().resource() == &mono);
+  }
+  {
+    std::pmr::map<int, std::pmr::vector<int>> m(&mono);
+    m[1].push_back(1);
+    m.emplace(std::piecewise_construct, std::forward_as_tuple(2),
+              std::forward_as_tuple(3, 4));
+    assert(m[1].get_allocator().resource() == &mono);
+    assert(m[2].get_allocator().resource() == &mono);
+    assert(m[2].size() == 3);
+  }
+  {
+    std::pmr::polymorphic_allocator<int> a(&mono);
+    std::pmr::polymorphic_allocator<double> b(a);
+    assert(a == b);
+    assert(b.resource() == &mono);
+    std::pmr::polymorphic_allocator<int> c;
+    assert(c.resource() == std::pmr::get_default_resource());
+    assert(a != c);
+    assert(a.select_on_container_copy_construction().resource() ==
+           std::pmr::get_default_resource());
+  }
+
+  return 0;
+}
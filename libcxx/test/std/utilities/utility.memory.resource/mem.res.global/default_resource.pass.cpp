@@ -0,0 +1,56 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++03, c++11, c++14
+
+// <memory_resource>
+
+// memory_resource* get_default_resource() noexcept;
+// memory_resource* set_default_resource(memory_resource* r) noexcept;
+// memory_resource* new_delete_resource() noexcept;
+// memory_resource* null_memory_resource() noexcept;
+
+#include <memory_resource>
+#include <cassert>
+#include <new>
+
+#include "test_macros.h"
+
+int main(int, char**) {
+  using namespace std::pmr;
+  static_assert(noexcept(get_default_resource()), "");
+  static_assert(noexcept(set_default_resource(nullptr)), "");
+
+  memory_resource* p = get_default_resource();
+  assert(p != nullptr);
+  assert(p == new_delete_resource());
+  assert(*p == *new_delete_resource());
+  assert(*p != *null_memory_resource());
+
+  memory_resource* old = set_default_resource(null_memory_resource());
+  assert(old == new_delete_resource());
+  assert(get_default_resource() == null_memory_resource());
+
+  old = set_default_resource(nullptr);
+  assert(old == null_memory_resource());
+  assert(get_default_resource() == new_delete_resource());
+
+  void* block = new_delete_resource()->allocate(100, 64);
+  assert(reinterpret_cast<std::uintptr_t>(block) % 64 == 0);
+  new_delete_resource()->deallocate(block, 100, 64);
+
+#ifndef TEST_HAS_NO_EXCEPTIONS
+  try {
+    TEST_IGNORE_NODISCARD null_memory_resource()->allocate(1);
+    assert(false);
+  } catch (const std::bad_alloc&) {
+  }
+#endif
+
+  return 0;
+}
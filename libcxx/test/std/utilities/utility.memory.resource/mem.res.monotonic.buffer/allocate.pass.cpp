@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++03, c++11, c++14
+
+// <memory_resource>
+
+// class monotonic_buffer_resource;
+
+// The allocations are served from the initial buffer until it is exhausted,
+// then from chunks of growing size obtained from the upstream resource, which
+// release() returns.
+
+#include <memory_resource>
+#include <cassert>
+#include <cstdint>
+
+#include "test_macros.h"
+
+struct CountingResource : std::pmr::memory_resource {
+  int allocations = 0;
+  int live = 0;
+
+  void* do_allocate(std::size_t bytes, std::size_t align) override {
+    ++allocations;
+    ++live;
+    return std::pmr::new_delete_resource()->allocate(bytes, align);
+  }
+  void do_deallocate(void* p, std::size_t bytes, std::size_t align) override {
+    --live;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+  }
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return &other == this;
+  }
+};
+
+static bool in_buffer(void* p, const char* buffer, std::size_t size) {
+  return static_cast<char*>(p) >= buffer && static_cast<char*>(p) < buffer + size;
+}
+
+int main(int, char**) {
+  CountingResource upstream;
+  alignas(16) char buffer[256];
+  {
+    std::pmr::monotonic_buffer_resource mono(buffer, sizeof(buffer), &upstream);
+    assert(mono.upstream_resource() == &upstream);
+
+    void* p = mono.allocate(100, 8);
+    assert(in_buffer(p, buffer, sizeof(buffer)));
+    p = mono.allocate(1, 64);
+    assert(in_buffer(p, buffer, sizeof(buffer)));
+    assert(reinterpret_cast<std::uintptr_t>(p) % 64 == 0);
+    mono.deallocate(p, 1, 64);
+    assert(upstream.allocations == 0);
+
+    for (int i = 0; i < 1000; ++i) {
+      p = mono.allocate(32, 16);
+      assert(reinterpret_cast<std::uintptr_t>(p) % 16 == 0);
+    }
+    // The chunks grow geometrically.
+    assert(upstream.allocations > 0 && upstream.allocations < 10);
+
+    p = mono.allocate(100000, 4096);
+    assert(reinterpret_cast<std::uintptr_t>(p) % 4096 == 0);
+
+    mono.release();
+    assert(upstream.live == 0);
+    p = mono.allocate(100, 8);
+    assert(in_buffer(p, buffer, sizeof(buffer)));
+  }
+  {
+    std::pmr::monotonic_buffer_resource mono(0, &upstream);
+    void* p = mono.allocate(1, 1);
+    assert(p != nullptr);
+    assert(upstream.live == 1);
+  }
+  assert(upstream.live == 0);
+
+  return 0;
+}
@@ -0,0 +1,55 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++03, c++11, c++14
+
+// <memory_resource>
+
+// UNSUPPORTED: libcpp-has-no-threads
+
+// class synchronized_pool_resource;
+
+// The resource can be shared by threads.
+
+#include <memory_resource>
+#include <cassert>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "test_macros.h"
+
+int main(int, char**) {
+  std::pmr::synchronized_pool_resource pool;
+  assert(pool.upstream_resource() == std::pmr::get_default_resource());
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&pool, t] {
+      std::vector<char*> blocks;
+      for (int i = 0; i < 10000; ++i) {
+        const std::size_t size = i % 100 + 1;
+        char* p = static_cast<char*>(pool.allocate(size));
+        std::memset(p, t, size);
+        blocks.push_back(p);
+        if (i % 3 == 0) {
+          for (std::size_t j = 0; j < size; ++j)
+            assert(p[j] == t);
+          pool.deallocate(p, size);
+          blocks.pop_back();
+        }
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  pool.release();
+
+  return 0;
+}
@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// UNSUPPORTED: c++03, c++11, c++14
+
+// <memory_resource>
+
+// class unsynchronized_pool_resource;
+
+// The small blocks are carved out of chunks obtained from the upstream
+// resource and reused once deallocated, the large ones are forwarded to the
+// upstream resource.
+
+#include <memory_resource>
+#include <cassert>
+#include <cstdint>
+
+#include "test_macros.h"
+
+struct CountingResource : std::pmr::memory_resource {
+  int allocations = 0;
+  int live = 0;
+
+  void* do_allocate(std::size_t bytes, std::size_t align) override {
+    ++allocations;
+    ++live;
+    return std::pmr::new_delete_resource()->allocate(bytes, align);
+  }
+  void do_deallocate(void* p, std::size_t bytes, std::size_t align) override {
+    --live;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+  }
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+    return &other == this;
+  }
+};
+
+int main(int, char**) {
+  CountingResource upstream;
+  {
+    std::pmr::unsynchronized_pool_resource pool(
+        std::pmr::pool_options{0, 256}, &upstream);
+    assert(pool.upstream_resource() == &upstream);
+    assert(pool.options().largest_required_pool_block >= 256);
+    assert(upstream.allocations == 0);
+
+    void* blocks[100];
+    for (int i = 0; i < 100; ++i) {
+      blocks[i] = pool.allocate(24, 8);
+      assert(reinterpret_cast<std::uintptr_t>(blocks[i]) % 8 == 0);
+    }
+    const int after_first_round = upstream.allocations;
+    assert(after_first_round > 0 && after_first_round < 10);
+
+    for (int i = 0; i < 100; ++i)
+      pool.deallocate(blocks[i], 24, 8);
+    for (int i = 0; i < 100; ++i)
+      blocks[i] = pool.allocate(24, 8);
+    assert(upstream.allocations == after_first_round);
+
+    // Over-aligned blocks are pooled as well.
+    void* aligned = pool.allocate(8, 128);
+    assert(reinterpret_cast<std::uintptr_t>(aligned) % 128 == 0);
+    pool.deallocate(aligned, 8, 128);
+
+    const int live_before_large = upstream.live;
+    void* large = pool.allocate(4096);
+    assert(upstream.live == live_before_large + 1);
+    pool.deallocate(large, 4096);
+    assert(upstream.live == live_before_large);
+
+    pool.release();
+    assert(upstream.live == 0);
+
+    blocks[0] = pool.allocate(24, 8);
+    assert(upstream.live > 0);
+  }
+  assert(upstream.live == 0);
+
+  return 0;
+}
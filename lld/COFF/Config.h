@@ -152,6 +152,9 @@ struct Configuration {
   // Used for /opt:lldltopartitions=N
   unsigned ltoPartitions = 1;
 
+  // Used for /lldghashcache:path
+  StringRef ghashCache;
+
   // Used for /opt:lldltocache=path
   StringRef ltoCache;
   // Used for /opt:lldltocachepolicy=policy
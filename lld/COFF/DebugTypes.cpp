@@ -25,9 +25,13 @@
 #include "llvm/DebugInfo/PDB/Native/PDBFile.h"
 #include "llvm/DebugInfo/PDB/Native/TpiHashing.h"
 #include "llvm/DebugInfo/PDB/Native/TpiStream.h"
+#include "llvm/Support/CachePruning.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/xxhash.h"
 
 using namespace llvm;
 using namespace llvm::codeview;
@@ -570,15 +574,95 @@ void TpiSource::clear() {
 // Parellel GHash type merging implementation.
 //===----------------------------------------------------------------------===//
 
+// With /lldghashcache, the global hashes of an object file without .debug$H
+// and the bit vector telling which of its records are items are stored in a
+// cache directory, so that relinking doesn't need to hash and walk the type
+// records of unchanged objects again. Entries are keyed by a hash of the type
+// records and have the following format:
+//
+//   ulittle32_t count
+//   GloballyHashedType hashes[count]
+//   uint8_t isItemBits[(count + 7) / 8]
+//
+// The file names have the llvmcache- prefix so that the directory can be
+// pruned like a ThinLTO cache.
+static std::string getGHashCachePath(ArrayRef<uint8_t> debugTypes) {
+  return (config->ghashCache + "/llvmcache-ghash-" +
+          utohexstr(xxHash64(debugTypes)) + "-" + Twine(debugTypes.size()))
+      .str();
+}
+
+bool TpiSource::loadCachedGHashes(StringRef path) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> mbOrErr =
+      MemoryBuffer::getFile(path, /*FileSize=*/-1,
+                            /*RequiresNullTerminator=*/false);
+  if (!mbOrErr)
+    return false;
+  ArrayRef<uint8_t> data = arrayRefFromStringRef((*mbOrErr)->getBuffer());
+  if (data.size() < 4)
+    return false;
+  uint32_t count = support::endian::read32le(data.data());
+  size_t hashesSize = size_t(count) * sizeof(GloballyHashedType);
+  if (data.size() != 4 + hashesSize + (count + 7) / 8)
+    return false;
+
+  std::vector<GloballyHashedType> hashes(count);
+  memcpy(hashes.data(), data.data() + 4, hashesSize);
+  assignGHashesFromVector(std::move(hashes));
+
+  const uint8_t *bits = data.data() + 4 + hashesSize;
+  isItemIndex.resize(count);
+  for (uint32_t i = 0; i != count; ++i)
+    if (bits[i / 8] & (1 << (i % 8)))
+      isItemIndex.set(i);
+  return true;
+}
+
+void TpiSource::saveCachedGHashes(StringRef path) const {
+  std::string data(4 + ghashes.size() * sizeof(GloballyHashedType) +
+                       (ghashes.size() + 7) / 8,
+                   '\0');
+  support::endian::write32le(&data[0], ghashes.size());
+  memcpy(&data[4], ghashes.data(), ghashes.size() * sizeof(GloballyHashedType));
+  char *bits = &data[4 + ghashes.size() * sizeof(GloballyHashedType)];
+  for (uint32_t i = 0, e = ghashes.size(); i != e; ++i)
+    if (isItemIndex.test(i))
+      bits[i / 8] |= 1 << (i % 8);
+
+  // Write to a temporary file first so that a concurrent link never reads a
+  // partially written entry.
+  SmallString<128> tempPath;
+  int fd;
+  if (sys::fs::createUniqueFile(path + ".tmp%%%%%%%", fd, tempPath))
+    return;
+  {
+    raw_fd_ostream os(fd, /*shouldClose=*/true);
+    os << data;
+  }
+  if (sys::fs::rename(tempPath, path))
+    sys::fs::remove(tempPath);
+}
+
 void TpiSource::loadGHashes() {
   if (Optional<ArrayRef<uint8_t>> debugH = getDebugH(file)) {
     ghashes = getHashesFromDebugH(*debugH);
     ownedGHashes = false;
   } else {
+    std::string cachePath;
+    if (!config->ghashCache.empty()) {
+      cachePath = getGHashCachePath(file->debugTypes);
+      if (loadCachedGHashes(cachePath))
+        return;
+    }
+
     CVTypeArray types;
     BinaryStreamReader reader(file->debugTypes, support::little);
     cantFail(reader.readArray(types, reader.getLength()));
     assignGHashesFromVector(GloballyHashedType::hashTypes(types));
+    fillIsItemIndexFromDebugT();
+    if (!cachePath.empty())
+      saveCachedGHashes(cachePath);
+    return;
   }
 
   fillIsItemIndexFromDebugT();
@@ -1028,6 +1112,11 @@ void TypeMerger::mergeTypesWithGHash() {
                     [&](TpiSource *source) { source->loadGHashes(); });
   }
 
+  // Keep the ghash cache from growing without bound. The default policy
+  // removes entries that haven't been used for a week.
+  if (!config->ghashCache.empty())
+    pruneCache(config->ghashCache, CachePruningPolicy());
+
   ScopedTimer t2(mergeGHashTimer);
   GHashState ghashState;
 
@@ -1080,11 +1169,28 @@ void TypeMerger::mergeTypesWithGHash() {
   // - item records
   //   - source 0, type 1...
   //   - source 1, type 0...
+  //
+  // The table is scanned in parallel slices whose cells are then concatenated
+  // in order.
+  const size_t sliceSize = 1 << 20;
+  size_t numSlices = (tableSize + sliceSize - 1) / sliceSize;
+  std::vector<std::vector<GHashCell>> slices(numSlices);
+  parallelForEachN(0, numSlices, [&](size_t i) {
+    ArrayRef<GHashCell> cells = makeArrayRef(ghashState.table.table, tableSize)
+                                    .slice(i * sliceSize)
+                                    .take_front(sliceSize);
+    for (const GHashCell &cell : cells)
+      if (!cell.isEmpty())
+        slices[i].push_back(cell);
+  });
+  size_t numEntries = 0;
+  for (const std::vector<GHashCell> &slice : slices)
+    numEntries += slice.size();
   std::vector<GHashCell> entries;
-  for (const GHashCell &cell :
-       makeArrayRef(ghashState.table.table, tableSize)) {
-    if (!cell.isEmpty())
-      entries.push_back(cell);
+  entries.reserve(numEntries);
+  for (std::vector<GHashCell> &slice : slices) {
+    entries.insert(entries.end(), slice.begin(), slice.end());
+    std::vector<GHashCell>().swap(slice);
   }
   parallelSort(entries, std::less<GHashCell>());
   log(formatv("ghash table load factor: {0:p} (size {1} / capacity {2})\n",
@@ -1106,20 +1212,32 @@ void TypeMerger::mergeTypesWithGHash() {
   // merging will skip indices not on this list. Store the destination PDB type
   // index for these unique types in the tpiMap for each source. The entries for
   // non-unique types will be filled in prior to type merging.
-  for (uint32_t i = 0, e = entries.size(); i < e; ++i) {
-    auto &cell = entries[i];
-    uint32_t tpiSrcIdx = cell.getTpiSrcIdx();
+  //
+  // The entries of a source are contiguous within the type records and within
+  // the item records, so sources are processed in parallel. Each entry updates
+  // its own cell of the table.
+  parallelForEachN(0, TpiSource::instances.size(), [&](size_t tpiSrcIdx) {
     TpiSource *source = TpiSource::instances[tpiSrcIdx];
-    source->uniqueTypes.push_back(cell.getGHashIdx());
-
-    // Update the ghash table to store the destination PDB type index in the
-    // table.
-    uint32_t pdbTypeIndex = i < numTypes ? i : i - numTypes;
-    uint32_t ghashCellIndex =
-        source->indexMapStorage[cell.getGHashIdx()].toArrayIndex();
-    ghashState.table.table[ghashCellIndex] =
-        GHashCell(cell.isItem(), cell.getTpiSrcIdx(), pdbTypeIndex);
-  }
+    for (bool isItem : {false, true}) {
+      auto begin = std::lower_bound(entries.begin(), entries.end(),
+                                    GHashCell(isItem, tpiSrcIdx, 0));
+      auto end = std::lower_bound(begin, entries.end(),
+                                  GHashCell(isItem, tpiSrcIdx + 1, 0));
+      for (auto it = begin; it != end; ++it) {
+        const GHashCell &cell = *it;
+        uint32_t i = it - entries.begin();
+        source->uniqueTypes.push_back(cell.getGHashIdx());
+
+        // Update the ghash table to store the destination PDB type index in
+        // the table.
+        uint32_t pdbTypeIndex = i < numTypes ? i : i - numTypes;
+        uint32_t ghashCellIndex =
+            source->indexMapStorage[cell.getGHashIdx()].toArrayIndex();
+        ghashState.table.table[ghashCellIndex] =
+            GHashCell(cell.isItem(), cell.getTpiSrcIdx(), pdbTypeIndex);
+      }
+    }
+  });
 
   // In parallel, remap all types.
   for_each(TpiSource::dependencySources, [&](TpiSource *source) {
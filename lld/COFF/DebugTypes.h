@@ -94,6 +94,11 @@ protected:
   // Walk over file->debugTypes and fill in the isItemIndex bit vector.
   void fillIsItemIndexFromDebugT();
 
+  // Read or write the ghashes and the isItemIndex bit vector of this source
+  // in the /lldghashcache directory.
+  bool loadCachedGHashes(StringRef path);
+  void saveCachedGHashes(StringRef path) const;
+
 public:
   bool remapTypesInSymbolRecord(MutableArrayRef<uint8_t> rec);
 
@@ -1586,6 +1586,14 @@ void LinkerDriver::link(ArrayRef<const char *> argsArr) {
   if (args.hasArg(OPT_kill_at))
     config->killAt = true;
 
+  // Handle /lldghashcache
+  if (auto *arg = args.getLastArg(OPT_lldghashcache)) {
+    config->ghashCache = arg->getValue();
+    if (std::error_code ec = sys::fs::create_directories(config->ghashCache))
+      error("/lldghashcache: cannot create " + config->ghashCache + ": " +
+            ec.message());
+  }
+
   // Handle /lldltocache
   if (auto *arg = args.getLastArg(OPT_lldltocache))
     config->ltoCache = arg->getValue();
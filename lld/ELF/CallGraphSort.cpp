@@ -41,9 +41,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "CallGraphSort.h"
+#include "InputFiles.h"
 #include "OutputSections.h"
 #include "SymbolTable.h"
 #include "Symbols.h"
+#include "llvm/ADT/DenseSet.h"
 
 #include <numeric>
 
@@ -176,6 +178,76 @@ static void mergeClusters(std::vector<Cluster> &cs, Cluster &into, int intoIdx,
   from.weight = 0;
 }
 
+// With -fbasic-block-sections, the entry block of a function stays in the
+// function section, and the other sections of the function are defined by
+// symbols named <function>.<N>, <function>.cold and <function>.eh. Profiles
+// only describe whole functions, so we place the numbered sections of a
+// function right after its entry section, and the cold and exception handling
+// parts of all functions after all clusters.
+static void
+addBasicBlockSections(std::vector<const InputSectionBase *> &order) {
+  // Index the basic block sections by the file and name of their function.
+  // Numbered sections sort before the cold and exception handling ones.
+  using BBSection = std::pair<uint64_t, const InputSectionBase *>;
+  DenseMap<std::pair<const InputFile *, StringRef>, std::vector<BBSection>>
+      bbSections;
+  for (InputFile *file : objectFiles) {
+    for (Symbol *sym : file->getSymbols()) {
+      auto *d = dyn_cast<Defined>(sym);
+      if (!d || d->file != file || sym->isSection())
+        continue;
+      auto *isec = dyn_cast_or_null<InputSectionBase>(d->section);
+      if (!isec || !(isec->flags & ELF::SHF_EXECINSTR))
+        continue;
+      StringRef base, suffix;
+      std::tie(base, suffix) = sym->getName().rsplit('.');
+      if (base.empty() || suffix.empty())
+        continue;
+      uint64_t rank;
+      if (suffix == "cold")
+        rank = UINT64_MAX - 1;
+      else if (suffix == "eh")
+        rank = UINT64_MAX;
+      else if (!to_integer(suffix, rank, 10) || rank >= UINT64_MAX - 1)
+        continue;
+      bbSections[{file, base}].emplace_back(rank, isec);
+    }
+  }
+  if (bbSections.empty())
+    return;
+
+  DenseSet<const InputSectionBase *> placed;
+  for (const InputSectionBase *isec : order)
+    placed.insert(isec);
+
+  std::vector<const InputSectionBase *> newOrder;
+  std::vector<const InputSectionBase *> coldParts;
+  for (const InputSectionBase *isec : order) {
+    newOrder.push_back(isec);
+    for (Symbol *sym : isec->file->getSymbols()) {
+      auto *d = dyn_cast<Defined>(sym);
+      if (!d || d->section != isec || !d->isFunc())
+        continue;
+      auto it = bbSections.find({isec->file, sym->getName()});
+      if (it == bbSections.end())
+        continue;
+      llvm::sort(it->second, [](const BBSection &a, const BBSection &b) {
+        return a.first < b.first;
+      });
+      for (const BBSection &bb : it->second) {
+        if (!placed.insert(bb.second).second)
+          continue;
+        if (bb.first >= UINT64_MAX - 1)
+          coldParts.push_back(bb.second);
+        else
+          newOrder.push_back(bb.second);
+      }
+    }
+  }
+  newOrder.insert(newOrder.end(), coldParts.begin(), coldParts.end());
+  order = std::move(newOrder);
+}
+
 // Group InputSections into clusters using the Call-Chain Clustering heuristic
 // then sort the clusters by density.
 DenseMap<const InputSectionBase *, int> CallGraphSort::run() {
@@ -221,16 +293,22 @@ DenseMap<const InputSectionBase *, int> CallGraphSort::run() {
     return clusters[a].getDensity() > clusters[b].getDensity();
   });
 
-  DenseMap<const InputSectionBase *, int> orderMap;
-  int curOrder = 1;
+  std::vector<const InputSectionBase *> order;
   for (int leader : sorted) {
     for (int i = leader;;) {
-      orderMap[sections[i]] = curOrder++;
+      order.push_back(sections[i]);
       i = clusters[i].next;
       if (i == leader)
         break;
     }
   }
+  if (config->callGraphBBSections)
+    addBasicBlockSections(order);
+
+  DenseMap<const InputSectionBase *, int> orderMap;
+  int curOrder = 1;
+  for (const InputSectionBase *isec : order)
+    orderMap[isec] = curOrder++;
   if (!config->printSymbolOrder.empty()) {
     std::error_code ec;
     raw_fd_ostream os(config->printSymbolOrder, ec, sys::fs::OF_None);
@@ -240,20 +318,14 @@ DenseMap<const InputSectionBase *, int> CallGraphSort::run() {
     }
 
     // Print the symbols ordered by C3, in the order of increasing curOrder
-    // Instead of sorting all the orderMap, just repeat the loops above.
-    for (int leader : sorted)
-      for (int i = leader;;) {
-        // Search all the symbols in the file of the section
-        // and find out a Defined symbol with name that is within the section.
-        for (Symbol *sym : sections[i]->file->getSymbols())
-          if (!sym->isSection()) // Filter out section-type symbols here.
-            if (auto *d = dyn_cast<Defined>(sym))
-              if (sections[i] == d->section)
-                os << sym->getName() << "\n";
-        i = clusters[i].next;
-        if (i == leader)
-          break;
-      }
+    for (const InputSectionBase *isec : order)
+      // Search all the symbols in the file of the section
+      // and find out a Defined symbol with name that is within the section.
+      for (Symbol *sym : isec->file->getSymbols())
+        if (!sym->isSection()) // Filter out section-type symbols here.
+          if (auto *d = dyn_cast<Defined>(sym))
+            if (isec == d->section)
+              os << sym->getName() << "\n";
   }
 
   return orderMap;
@@ -18,6 +18,7 @@
 #include "llvm/BinaryFormat/ELF.h"
 #include "llvm/Support/CachePruning.h"
 #include "llvm/Support/CodeGen.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/GlobPattern.h"
 #include <atomic>
@@ -120,7 +121,9 @@ struct Configuration {
   llvm::StringRef soName;
   llvm::StringRef sysroot;
   llvm::StringRef thinLTOCacheDir;
+  llvm::StringRef thinLTODistributor;
   llvm::StringRef thinLTOIndexOnlyArg;
+  llvm::StringRef thinLTORemoteCacheDir;
   llvm::StringRef ltoBasicBlockSections;
   std::pair<llvm::StringRef, llvm::StringRef> thinLTOObjectSuffixReplace;
   std::pair<llvm::StringRef, llvm::StringRef> thinLTOPrefixReplace;
@@ -129,7 +132,9 @@ struct Configuration {
   std::vector<llvm::StringRef> auxiliaryList;
   std::vector<llvm::StringRef> filterList;
   std::vector<llvm::StringRef> searchPaths;
+  std::vector<llvm::StringRef> startupOrderingFile;
   std::vector<llvm::StringRef> symbolOrderingFile;
+  std::vector<llvm::StringRef> thinLTODistributorArgs;
   std::vector<llvm::StringRef> thinLTOModulesToCompile;
   std::vector<llvm::StringRef> undefined;
   std::vector<SymbolVersion> dynamicList;
@@ -145,14 +150,16 @@ struct Configuration {
   bool asNeeded = false;
   bool bsymbolic;
   bool bsymbolicFunctions;
+  bool callGraphBBSections;
   bool callGraphProfileSort;
   bool checkSections;
-  bool compressDebugSections;
+  llvm::Optional<llvm::compression::Format> compressDebugSections;
   bool cref;
   std::vector<std::pair<llvm::GlobPattern, uint64_t>> deadRelocInNonAlloc;
   bool defineCommon;
   bool demangle = true;
   bool dependentLibraries;
+  bool directOutput;
   bool disableVerify;
   bool ehFrameHdr;
   bool emitLLVM;
@@ -165,12 +172,14 @@ struct Configuration {
   bool formatBinary = false;
   bool fortranCommon;
   bool gcSections;
+  bool debugNames;
   bool gdbIndex;
   bool gnuHash = false;
   bool gnuUnique;
   bool hasDynSymTab;
   bool ignoreDataAddressEquality;
   bool ignoreFunctionAddressEquality;
+  bool incremental;
   bool ltoCSProfileGenerate;
   bool ltoDebugPassManager;
   bool ltoEmitAsm;
@@ -182,6 +191,7 @@ struct Configuration {
   bool mmapOutputFile;
   bool nmagic;
   bool noDynamicLinker = false;
+  bool noKeepMemory;
   bool noinhibitExec;
   bool nostdlib;
   bool oFormatBinary;
@@ -257,6 +267,7 @@ struct Configuration {
   uint16_t emachine = llvm::ELF::EM_NONE;
   llvm::Optional<uint64_t> imageBase;
   uint64_t commonPageSize;
+  uint64_t incrementalArgsHash = 0;
   uint64_t maxPageSize;
   uint64_t mipsGotSize;
   uint64_t zStackSize;
@@ -45,6 +45,7 @@ template <class ELFT> LLDDwarfObj<ELFT>::LLDDwarfObj(ObjFile<ELFT> *obj) {
                 .Case(".debug_rnglists", &rnglistsSection)
                 .Case(".debug_str_offsets", &strOffsetsSection)
                 .Case(".debug_line", &lineSection)
+                .Case(".debug_names", &namesSection)
                 .Default(nullptr)) {
       m->Data = toStringRef(sec->data());
       m->sec = sec;
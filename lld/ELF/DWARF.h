@@ -68,6 +68,10 @@ public:
     return gnuPubtypesSection;
   }
 
+  const LLDDWARFSection &getNamesSection() const override {
+    return namesSection;
+  }
+
   StringRef getFileName() const override { return ""; }
   StringRef getAbbrevSection() const override { return abbrevSection; }
   StringRef getStrSection() const override { return strSection; }
@@ -94,6 +98,7 @@ private:
   LLDDWARFSection rnglistsSection;
   LLDDWARFSection strOffsetsSection;
   LLDDWARFSection lineSection;
+  LLDDWARFSection namesSection;
   LLDDWARFSection addrSection;
   StringRef abbrevSection;
   StringRef strSection;
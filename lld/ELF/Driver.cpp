@@ -48,18 +48,24 @@
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Config/llvm-config.h"
+#include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/LLVMContext.h"
 #include "llvm/LTO/LTO.h"
+#include "llvm/ProfileData/InstrProfReader.h"
+#include "llvm/ProfileData/SampleProfReader.h"
 #include "llvm/Remarks/HotnessThresholdParser.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/GlobPattern.h"
 #include "llvm/Support/LEB128.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TarWriter.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
 #include <cstdlib>
 #include <utility>
 
@@ -348,6 +354,8 @@ static void checkOptions() {
       error("-r and -shared may not be used together");
     if (config->gdbIndex)
       error("-r and --gdb-index may not be used together");
+    if (config->debugNames)
+      error("-r and --debug-names may not be used together");
     if (config->icf != ICFLevel::None)
       error("-r and --icf may not be used together");
     if (config->pie)
@@ -688,6 +696,17 @@ static StringRef getDynamicLinker(opt::InputArgList &args) {
   return arg->getValue();
 }
 
+// Returns a hash of the command line, which --incremental uses to tell
+// whether the previous output was linked with the same options.
+static uint64_t getArgsHash(opt::InputArgList &args) {
+  std::string s;
+  for (opt::Arg *arg : args) {
+    s += arg->getAsString(args);
+    s += '\0';
+  }
+  return xxHash64(s);
+}
+
 static ICFLevel getICF(opt::InputArgList &args) {
   auto *arg = args.getLastArg(OPT_icf_none, OPT_icf_safe, OPT_icf_all);
   if (!arg || arg->getOption().getID() == OPT_icf_none)
@@ -857,15 +876,173 @@ template <class ELFT> static void readCallGraphsFromObjectFiles() {
   }
 }
 
-static bool getCompressDebugSections(opt::InputArgList &args) {
+namespace {
+// Call counts and entry counts of functions, by name, read from a sample or
+// instrumentation profile.
+struct ProfileCallGraph {
+  MapVector<std::pair<StringRef, StringRef>, uint64_t> calls;
+  MapVector<StringRef, uint64_t> entries;
+};
+} // namespace
+
+// Adds the call targets recorded in a sample profile, including those in the
+// bodies of functions inlined into it, as calls from the given function.
+static void addSampleCalls(ProfileCallGraph &cg, StringRef caller,
+                           const sampleprof::FunctionSamples &fs) {
+  for (const auto &body : fs.getBodySamples())
+    for (const auto &target : body.second.getCallTargets())
+      cg.calls[{caller, target.first()}] += target.second;
+  for (const auto &callsite : fs.getCallsiteSamples())
+    for (const auto &inlined : callsite.second)
+      addSampleCalls(cg, caller, inlined.second);
+}
+
+static void readSampleProfile(sampleprof::SampleProfileReader &reader,
+                              ProfileCallGraph &cg) {
+  for (const auto &it : reader.getProfiles()) {
+    const sampleprof::FunctionSamples &fs = it.second;
+    cg.entries[fs.getName()] += fs.getHeadSamples();
+    addSampleCalls(cg, fs.getName(), fs);
+  }
+}
+
+// Instrumentation profiles only record indirect call targets. For front-end
+// and entry-block instrumentation, the first counter is the number of calls
+// to the function; otherwise we use the largest counter as an estimate.
+static void readInstrProfile(InstrProfReader &reader, ProfileCallGraph &cg) {
+  bool hasEntryCount =
+      !reader.isIRLevelProfile() || reader.instrEntryBBEnabled();
+  InstrProfSymtab &symtab = reader.getSymtab();
+  for (const NamedInstrProfRecord &rec : reader) {
+    StringRef name = saver.save(rec.Name);
+    if (!rec.Counts.empty())
+      cg.entries[name] += hasEntryCount
+                              ? rec.Counts[0]
+                              : *std::max_element(rec.Counts.begin(),
+                                                  rec.Counts.end());
+
+    for (uint32_t i = 0, e = rec.getNumValueSites(IPVK_IndirectCallTarget);
+         i != e; ++i) {
+      uint32_t n = rec.getNumValueDataForSite(IPVK_IndirectCallTarget, i);
+      std::unique_ptr<InstrProfValueData[]> vd =
+          rec.getValueForSite(IPVK_IndirectCallTarget, i);
+      for (uint32_t j = 0; j != n; ++j) {
+        StringRef target = symtab.getFuncName(vd[j].Value);
+        if (!target.empty())
+          cg.calls[{name, target}] += vd[j].Count;
+      }
+    }
+  }
+  if (Error e = reader.getError())
+    error(toString(std::move(e)));
+}
+
+// Read the call graph from a profile file created by llvm-profdata or
+// llvm-profgen. Function entry counts that are not accounted for by the
+// calls in the profile, e.g. calls from code without samples, are added as
+// self edges, which give weight to the node without adding a predecessor.
+static void readCallGraphProfileData(MemoryBufferRef mb) {
+  ProfileCallGraph cg;
+  bool useMD5 = false;
+
+  LLVMContext ctx;
+  ctx.setDiagnosticHandlerCallBack(
+      [](const DiagnosticInfo &di, void *) { diagnosticHandler(di); });
+  std::unique_ptr<MemoryBuffer> buf = MemoryBuffer::getMemBuffer(mb, false);
+  auto sampleOrErr = sampleprof::SampleProfileReader::create(buf, ctx);
+  std::unique_ptr<sampleprof::SampleProfileReader> sampleReader;
+  std::unique_ptr<InstrProfReader> instrReader;
+  if (sampleOrErr) {
+    sampleReader = std::move(*sampleOrErr);
+    if (std::error_code ec = sampleReader->read()) {
+      error(mb.getBufferIdentifier() + ": " + ec.message());
+      return;
+    }
+    useMD5 = sampleReader->useMD5();
+    readSampleProfile(*sampleReader, cg);
+  } else {
+    auto instrOrErr =
+        InstrProfReader::create(MemoryBuffer::getMemBuffer(mb, false));
+    if (!instrOrErr) {
+      error(mb.getBufferIdentifier() + ": " +
+            toString(instrOrErr.takeError()));
+      return;
+    }
+    instrReader = std::move(*instrOrErr);
+    readInstrProfile(*instrReader, cg);
+  }
+
+  // Sample profiles use names without suffixes such as .llvm.<hash>, and
+  // may only have MD5 hashes of the names. Names of local functions in
+  // instrumentation profiles are prefixed with the source file name.
+  DenseMap<StringRef, Symbol *> map;
+  for (InputFile *file : objectFiles) {
+    for (Symbol *sym : file->getSymbols()) {
+      StringRef name = sym->getName();
+      map[name] = sym;
+      StringRef canonical =
+          sampleprof::FunctionSamples::getCanonicalFnName(name, "selected");
+      map.try_emplace(canonical, sym);
+      if (useMD5)
+        map.try_emplace(saver.save(Twine(MD5Hash(canonical))), sym);
+    }
+  }
+
+  auto findSection = [&](StringRef name) -> InputSectionBase * {
+    Symbol *sym = map.lookup(name);
+    if (!sym) {
+      size_t pos = name.find_last_of(":;");
+      if (pos != StringRef::npos)
+        sym = map.lookup(name.substr(pos + 1));
+    }
+    if (!sym)
+      return nullptr;
+    if (Defined *dr = dyn_cast<Defined>(sym))
+      return dyn_cast_or_null<InputSectionBase>(dr->section);
+    return nullptr;
+  };
+
+  DenseMap<InputSectionBase *, uint64_t> incoming;
+  for (const auto &c : cg.calls) {
+    if (InputSectionBase *from = findSection(c.first.first)) {
+      if (InputSectionBase *to = findSection(c.first.second)) {
+        config->callGraphProfile[std::make_pair(from, to)] += c.second;
+        incoming[to] += c.second;
+      }
+    }
+  }
+
+  for (const auto &e : cg.entries) {
+    InputSectionBase *isec = findSection(e.first);
+    if (!isec)
+      continue;
+    uint64_t &count = incoming[isec];
+    if (e.second > count) {
+      config->callGraphProfile[std::make_pair(isec, isec)] += e.second - count;
+      count = e.second;
+    }
+  }
+}
+
+static Optional<compression::Format>
+getCompressDebugSections(opt::InputArgList &args) {
   StringRef s = args.getLastArgValue(OPT_compress_debug_sections, "none");
   if (s == "none")
-    return false;
-  if (s != "zlib")
+    return None;
+
+  compression::Format format;
+  if (s == "zlib") {
+    format = compression::Format::Zlib;
+  } else if (s == "zstd") {
+    format = compression::Format::Zstd;
+  } else {
     error("unknown --compress-debug-sections value: " + s);
-  if (!zlib::isAvailable())
-    error("--compress-debug-sections: zlib is not available");
-  return true;
+    return None;
+  }
+  if (!compression::isAvailable(format))
+    error("--compress-debug-sections: " + Twine(compression::getName(format)) +
+          " is not available");
+  return format;
 }
 
 static StringRef getAliasSpelling(opt::Arg *arg) {
@@ -951,6 +1128,7 @@ static void readConfigs(opt::InputArgList &args) {
   config->demangle = args.hasFlag(OPT_demangle, OPT_no_demangle, true);
   config->dependencyFile = args.getLastArgValue(OPT_dependency_file);
   config->dependentLibraries = args.hasFlag(OPT_dependent_libraries, OPT_no_dependent_libraries, true);
+  config->directOutput = args.hasArg(OPT_direct_output);
   config->disableVerify = args.hasArg(OPT_disable_verify);
   config->discard = getDiscard(args);
   config->dwoDir = args.getLastArgValue(OPT_plugin_opt_dwo_dir_eq);
@@ -959,6 +1137,9 @@ static void readConfigs(opt::InputArgList &args) {
       args.hasFlag(OPT_eh_frame_hdr, OPT_no_eh_frame_hdr, false);
   config->emitLLVM = args.hasArg(OPT_plugin_opt_emit_llvm, false);
   config->emitRelocs = args.hasArg(OPT_emit_relocs);
+  config->callGraphBBSections =
+      args.hasFlag(OPT_call_graph_bb_sections, OPT_no_call_graph_bb_sections,
+                   false);
   config->callGraphProfileSort = args.hasFlag(
       OPT_call_graph_profile_sort, OPT_no_call_graph_profile_sort, true);
   config->enableNewDtags =
@@ -983,11 +1164,17 @@ static void readConfigs(opt::InputArgList &args) {
   config->gcSections = args.hasFlag(OPT_gc_sections, OPT_no_gc_sections, false);
   config->gnuUnique = args.hasFlag(OPT_gnu_unique, OPT_no_gnu_unique, true);
   config->gdbIndex = args.hasFlag(OPT_gdb_index, OPT_no_gdb_index, false);
+  config->debugNames =
+      args.hasFlag(OPT_debug_names, OPT_no_debug_names, false);
   config->icf = getICF(args);
   config->ignoreDataAddressEquality =
       args.hasArg(OPT_ignore_data_address_equality);
   config->ignoreFunctionAddressEquality =
       args.hasArg(OPT_ignore_function_address_equality);
+  config->incremental =
+      args.hasFlag(OPT_incremental, OPT_no_incremental, false);
+  if (config->incremental)
+    config->incrementalArgsHash = getArgsHash(args);
   config->init = args.getLastArgValue(OPT_init, "_init");
   config->ltoAAPipeline = args.getLastArgValue(OPT_lto_aa_pipeline);
   config->ltoCSProfileGenerate = args.hasArg(OPT_lto_cs_profile_generate);
@@ -1017,6 +1204,7 @@ static void readConfigs(opt::InputArgList &args) {
   config->mmapOutputFile =
       args.hasFlag(OPT_mmap_output_file, OPT_no_mmap_output_file, true);
   config->nmagic = args.hasFlag(OPT_nmagic, OPT_no_nmagic, false);
+  config->noKeepMemory = args.hasArg(OPT_no_keep_memory);
   config->noinhibitExec = args.hasArg(OPT_noinhibit_exec);
   config->nostdlib = args.hasArg(OPT_nostdlib);
   config->oFormatBinary = isOutputFormatBinary(args);
@@ -1067,6 +1255,9 @@ static void readConfigs(opt::InputArgList &args) {
   config->thinLTOCachePolicy = CHECK(
       parseCachePruningPolicy(args.getLastArgValue(OPT_thinlto_cache_policy)),
       "--thinlto-cache-policy: invalid cache policy");
+  config->thinLTODistributor = args.getLastArgValue(OPT_thinlto_distributor_eq);
+  config->thinLTODistributorArgs =
+      args::getStrings(args, OPT_thinlto_distributor_arg_eq);
   config->thinLTOEmitImportsFiles = args.hasArg(OPT_thinlto_emit_imports_files);
   config->thinLTOIndexOnly = args.hasArg(OPT_thinlto_index_only) ||
                              args.hasArg(OPT_thinlto_index_only_eq);
@@ -1077,6 +1268,8 @@ static void readConfigs(opt::InputArgList &args) {
       getOldNewOptions(args, OPT_thinlto_prefix_replace_eq);
   config->thinLTOModulesToCompile =
       args::getStrings(args, OPT_thinlto_single_module_eq);
+  config->thinLTORemoteCacheDir =
+      args.getLastArgValue(OPT_thinlto_remote_cache_dir);
   config->timeTraceEnabled = args.hasArg(OPT_time_trace);
   config->timeTraceGranularity =
       args::getInteger(args, OPT_time_trace_granularity, 500);
@@ -1239,6 +1432,9 @@ static void readConfigs(opt::InputArgList &args) {
     if (args.hasArg(OPT_call_graph_ordering_file))
       error("--symbol-ordering-file and --call-graph-order-file "
             "may not be used together");
+    if (args.hasArg(OPT_call_graph_profile_data))
+      error("--symbol-ordering-file and --call-graph-profile-data "
+            "may not be used together");
     if (Optional<MemoryBufferRef> buffer = readFile(arg->getValue())){
       config->symbolOrderingFile = getSymbolOrderingFile(*buffer);
       // Also need to disable CallGraphProfileSort to prevent
@@ -1247,6 +1443,17 @@ static void readConfigs(opt::InputArgList &args) {
     }
   }
 
+  // A startup trace may mention a symbol many times; only the first touch
+  // matters.
+  if (auto *arg = args.getLastArg(OPT_startup_ordering_file)) {
+    if (Optional<MemoryBufferRef> buffer = readFile(arg->getValue())) {
+      SetVector<StringRef> names;
+      for (StringRef s : args::getLines(*buffer))
+        names.insert(s);
+      config->startupOrderingFile = names.takeVector();
+    }
+  }
+
   assert(config->versionDefinitions.empty());
   config->versionDefinitions.push_back({"local", (uint16_t)VER_NDX_LOCAL, {}});
   config->versionDefinitions.push_back(
@@ -1356,8 +1563,53 @@ static bool isFormatBinary(StringRef s) {
   return false;
 }
 
+// Start reading the input files given on the command line in the background,
+// so that waiting for the pages of a file overlaps with processing the files
+// before it. Libraries are located the same way as in createFiles(), which
+// depends on the -Bstatic and -Bdynamic options seen so far.
+static void prefetchInputFiles(opt::InputArgList &args) {
+  if (parallel::strategy.ThreadsRequested == 1)
+    return;
+
+  std::vector<std::string> paths;
+  bool isStatic = config->isStatic;
+  std::vector<bool> stack;
+  for (auto *arg : args) {
+    switch (arg->getOption().getID()) {
+    case OPT_library:
+      if (Optional<std::string> path = searchLibrary(arg->getValue()))
+        paths.push_back(*path);
+      break;
+    case OPT_INPUT:
+      paths.push_back(arg->getValue());
+      break;
+    case OPT_Bstatic:
+    case OPT_omagic:
+    case OPT_nmagic:
+      config->isStatic = true;
+      break;
+    case OPT_Bdynamic:
+      config->isStatic = false;
+      break;
+    case OPT_push_state:
+      stack.push_back(config->isStatic);
+      break;
+    case OPT_pop_state:
+      if (!stack.empty()) {
+        config->isStatic = stack.back();
+        stack.pop_back();
+      }
+      break;
+    }
+  }
+  config->isStatic = isStatic;
+  prefetchFiles(paths);
+}
+
 void LinkerDriver::createFiles(opt::InputArgList &args) {
   llvm::TimeTraceScope timeScope("Load input files");
+  prefetchInputFiles(args);
+
   // For --{push,pop}-state.
   std::vector<std::tuple<bool, bool, bool>> stack;
 
@@ -1457,6 +1709,7 @@ void LinkerDriver::createFiles(opt::InputArgList &args) {
       break;
     }
   }
+  endPrefetch();
 
   if (files.empty() && errorCount() == 0)
     error("no input files");
@@ -2346,6 +2599,9 @@ template <class ELFT> void LinkerDriver::link(opt::InputArgList &args) {
     if (auto *arg = args.getLastArg(OPT_call_graph_ordering_file))
       if (Optional<MemoryBufferRef> buffer = readFile(arg->getValue()))
         readCallGraph(*buffer);
+    if (auto *arg = args.getLastArg(OPT_call_graph_profile_data))
+      if (Optional<MemoryBufferRef> buffer = readFile(arg->getValue()))
+        readCallGraphProfileData(*buffer);
     readCallGraphsFromObjectFiles<ELFT>();
   }
 
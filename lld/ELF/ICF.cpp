@@ -47,7 +47,8 @@
 // 3. If we split an equivalence class in step 2, two relocations
 //    previously target the same equivalence class may now target
 //    different equivalence classes. Therefore, we repeat step 2 until a
-//    convergence is obtained.
+//    convergence is obtained. Only classes referring to a section whose
+//    class changed in the previous round are visited again.
 //
 // 4. For each equivalence class C, pick an arbitrary section in C, and
 //    merge all the other sections in C with it.
@@ -81,6 +82,7 @@
 #include "Symbols.h"
 #include "SyntheticSections.h"
 #include "Writer.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/BinaryFormat/ELF.h"
 #include "llvm/Object/ELF.h"
@@ -88,7 +90,6 @@
 #include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/xxhash.h"
 #include <algorithm>
-#include <atomic>
 
 using namespace llvm;
 using namespace llvm::ELF;
@@ -122,10 +123,27 @@ private:
 
   void forEachClass(llvm::function_ref<void(size_t, size_t)> fn);
 
+  template <class RelTy>
+  void collectTargets(const InputSection *isec, ArrayRef<RelTy> rels,
+                      uint32_t *out);
+
+  void buildUsers();
+
+  size_t findClassBegin(size_t end);
+
+  void segregateWorklist(uint32_t eqClassBase);
+
   std::vector<InputSection *> sections;
 
-  // We repeat the main loop while `Repeat` is true.
-  std::atomic<bool> repeat;
+  // Index of each section in Sections vector at the time buildUsers() was
+  // called. Sections are reordered within their classes later, so this is
+  // only used to look up users.
+  llvm::DenseMap<const InputSection *, uint32_t> sectionIndex;
+
+  // users[userBegin[i], userBegin[i + 1]) are the sections whose relocations
+  // refer to the section with index I.
+  std::vector<uint32_t> userBegin;
+  std::vector<InputSection *> users;
 
   // The main loop counter.
   int cnt = 0;
@@ -226,10 +244,6 @@ void ICF<ELFT>::segregate(size_t begin, size_t end, uint32_t eqClassBase,
     for (size_t i = begin; i < mid; ++i)
       sections[i]->eqClass[next] = eqClassBase + mid;
 
-    // If we created a group, we need to iterate the main loop again.
-    if (mid != end)
-      repeat = true;
-
     begin = mid;
   }
 }
@@ -433,6 +447,147 @@ void ICF<ELFT>::forEachClass(llvm::function_ref<void(size_t, size_t)> fn) {
   ++cnt;
 }
 
+// Stores the index of the section referred to by each relocation to Out, or
+// UINT32_MAX if the relocation doesn't refer to a section subject to ICF.
+template <class ELFT>
+template <class RelTy>
+void ICF<ELFT>::collectTargets(const InputSection *isec, ArrayRef<RelTy> rels,
+                               uint32_t *out) {
+  for (const RelTy &rel : rels) {
+    *out = UINT32_MAX;
+    Symbol &s = isec->template getFile<ELFT>()->getRelocTargetSym(rel);
+    if (auto *d = dyn_cast<Defined>(&s)) {
+      if (auto *relSec = dyn_cast_or_null<InputSection>(d->section)) {
+        auto it = sectionIndex.find(relSec);
+        if (it != sectionIndex.end())
+          *out = it->second;
+      }
+    }
+    ++out;
+  }
+}
+
+// Build the reverse relocation graph, so that when a class is split we can
+// tell which classes may need to be split next.
+template <class ELFT> void ICF<ELFT>::buildUsers() {
+  size_t n = sections.size();
+  sectionIndex.reserve(n);
+  for (size_t i = 0; i != n; ++i)
+    sectionIndex[sections[i]] = i;
+
+  // Resolve relocation targets in parallel.
+  std::vector<size_t> relBegin(n + 1);
+  for (size_t i = 0; i != n; ++i)
+    relBegin[i + 1] = relBegin[i] + sections[i]->numRelocations;
+  std::vector<uint32_t> targets(relBegin[n]);
+  parallelForEachN(0, n, [&](size_t i) {
+    InputSection *s = sections[i];
+    uint32_t *out = targets.data() + relBegin[i];
+    if (s->areRelocsRela)
+      collectTargets(s, s->template relas<ELFT>(), out);
+    else
+      collectTargets(s, s->template rels<ELFT>(), out);
+  });
+
+  // Invert the graph with a counting sort.
+  userBegin.assign(n + 1, 0);
+  for (uint32_t t : targets)
+    if (t != UINT32_MAX)
+      ++userBegin[t + 1];
+  for (size_t i = 0; i != n; ++i)
+    userBegin[i + 1] += userBegin[i];
+
+  users.resize(userBegin[n]);
+  std::vector<uint32_t> pos(userBegin.begin(), userBegin.end() - 1);
+  for (size_t i = 0; i != n; ++i)
+    for (size_t j = relBegin[i]; j != relBegin[i + 1]; ++j)
+      if (targets[j] != UINT32_MAX)
+        users[pos[targets[j]]++] = sections[i];
+}
+
+// Returns the start of the class that ends at End.
+template <class ELFT> size_t ICF<ELFT>::findClassBegin(size_t end) {
+  uint32_t eqClass = sections[end - 1]->eqClass[current];
+  size_t begin = end - 1;
+  while (begin != 0 && sections[begin - 1]->eqClass[current] == eqClass)
+    --begin;
+  return begin;
+}
+
+// Split classes by comparing relocations until convergence is obtained.
+//
+// A class whose members refer to classes that didn't change since it was
+// last segregated cannot be split, so rather than visiting every class in
+// each round, we keep a worklist of classes that refer to a section whose
+// class changed in the previous round. On large programs, most classes are
+// settled after the first round, and later rounds only touch a small part of
+// Sections vector.
+//
+// Classes are identified by the end of their range in Sections vector, which
+// is their ID minus eqClassBase. Each round reads eqClass[0] and writes
+// eqClass[1] so that classes can be segregated in parallel, then copies the
+// new classes back to eqClass[0].
+template <class ELFT>
+void ICF<ELFT>::segregateWorklist(uint32_t eqClassBase) {
+  buildUsers();
+
+  std::vector<uint32_t> worklist;
+  forEachClassRange(0, sections.size(), [&](size_t begin, size_t end) {
+    if (end - begin > 1)
+      worklist.push_back(end);
+  });
+
+  std::vector<bool> queued(sections.size() + 1);
+  while (!worklist.empty()) {
+    size_t numClasses = worklist.size();
+    std::vector<size_t> begins(numClasses);
+    parallelForEachN(0, numClasses, [&](size_t i) {
+      begins[i] = findClassBegin(worklist[i]);
+    });
+
+    parallelForEachN(0, numClasses, [&](size_t i) {
+      segregate(begins[i], worklist[i], eqClassBase, false);
+    });
+
+    // Commit new classes and remember the sections that moved.
+    std::vector<std::vector<InputSection *>> changed(numClasses);
+    parallelForEachN(0, numClasses, [&](size_t i) {
+      for (size_t j = begins[i], end = worklist[i]; j != end; ++j) {
+        InputSection *s = sections[j];
+        if (s->eqClass[0] != s->eqClass[1]) {
+          s->eqClass[0] = s->eqClass[1];
+          changed[i].push_back(s);
+        }
+      }
+    });
+    ++cnt;
+
+    // Collect the classes that refer to the moved sections. Classes of a
+    // single section cannot be split and are skipped.
+    std::vector<std::vector<uint32_t>> dirty(numClasses);
+    parallelForEachN(0, numClasses, [&](size_t i) {
+      for (InputSection *s : changed[i]) {
+        uint32_t idx = sectionIndex.lookup(s);
+        for (size_t j = userBegin[idx]; j != userBegin[idx + 1]; ++j) {
+          uint32_t end = users[j]->eqClass[0] - eqClassBase;
+          if (end >= 2 && sections[end - 2]->eqClass[0] == users[j]->eqClass[0])
+            dirty[i].push_back(end);
+        }
+      }
+    });
+
+    worklist.clear();
+    for (ArrayRef<uint32_t> ends : dirty)
+      for (uint32_t end : ends)
+        if (!queued[end]) {
+          queued[end] = true;
+          worklist.push_back(end);
+        }
+    for (uint32_t end : worklist)
+      queued[end] = false;
+  }
+}
+
 // Combine the hashes of the sections referenced by the given section into its
 // hash.
 template <class ELFT, class RelTy>
@@ -520,13 +675,14 @@ template <class ELFT> void ICF<ELFT>::run() {
     segregate(begin, end, eqClassBase, true);
   });
 
-  // Split groups by comparing relocations until convergence is obtained.
-  do {
-    repeat = false;
-    forEachClass([&](size_t begin, size_t end) {
-      segregate(begin, end, eqClassBase, false);
-    });
-  } while (repeat);
+  // The worklist rounds use eqClass[0] as the current class and eqClass[1] as
+  // the next one regardless of threading.
+  parallelForEach(sections, [&](InputSection *s) {
+    s->eqClass[0] = s->eqClass[1] = s->eqClass[next];
+  });
+  current = 0;
+  next = 1;
+  segregateWorklist(eqClassBase);
 
   log("ICF needed " + Twine(cnt) + " iterations");
 
@@ -0,0 +1,255 @@
+//===- Incremental.cpp ----------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements --incremental. After each link, we write a state file
+// next to the output which records a hash of the command line, a hash of the
+// contents of every input file and a fingerprint of the layout: the address,
+// offset and size of every output and input section, the address and the
+// GOT/PLT/dynsym slots of every global symbol and the offsets of merged
+// strings.
+//
+// On the next link, once addresses have been assigned, we compute the same
+// state. If the command line and the layout are unchanged and the output file
+// hasn't been touched since, the contents of an input section depend only on
+// its own bytes, because every symbol it refers to is at the same address as
+// before. Sections of unchanged input files are then already correct in the
+// output, so we open it in place and write only the sections of the changed
+// files, the synthetic sections and the headers.
+//
+// Anything that moves a section or a symbol, e.g. a section that grows,
+// changes the fingerprint and falls back to writing the whole output.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Incremental.h"
+#include "Config.h"
+#include "InputFiles.h"
+#include "InputSection.h"
+#include "OutputSections.h"
+#include "SymbolTable.h"
+#include "Symbols.h"
+#include "lld/Common/ErrorHandler.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Parallel.h"
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+
+using namespace llvm;
+using namespace lld;
+using namespace lld::elf;
+
+namespace {
+struct LinkState {
+  uint64_t argsHash = 0;
+  uint64_t layoutHash = 0;
+  uint64_t outputSize = 0;
+  int64_t outputModTime = 0;
+  std::vector<std::pair<std::string, uint64_t>> files;
+};
+
+// Hashes a sequence of integers and strings.
+class Fingerprint {
+public:
+  void add(uint64_t v) { buf.append((const char *)&v, sizeof(v)); }
+  void add(StringRef s) {
+    add(s.size());
+    buf.append(s.begin(), s.end());
+  }
+  uint64_t get() const { return xxHash64(buf); }
+
+private:
+  std::string buf;
+};
+} // namespace
+
+static std::string getStatePath() {
+  return (config->outputFile + ".incremental").str();
+}
+
+// Returns the input files whose sections may be written to the output.
+static std::vector<InputFile *> getInputFiles() {
+  std::vector<InputFile *> files(objectFiles.begin(), objectFiles.end());
+  files.insert(files.end(), binaryFiles.begin(), binaryFiles.end());
+  return files;
+}
+
+static uint64_t computeLayoutHash(ArrayRef<InputFile *> files) {
+  DenseMap<const InputFile *, uint64_t> fileIndex;
+  for (size_t i = 0; i < files.size(); ++i)
+    fileIndex[files[i]] = i;
+
+  Fingerprint fp;
+  for (OutputSection *sec : outputSections) {
+    fp.add(sec->name);
+    fp.add(sec->addr);
+    fp.add(sec->offset);
+    fp.add(sec->size);
+    fp.add(sec->type);
+    fp.add(sec->flags);
+    for (InputSection *isec : getInputSections(sec)) {
+      fp.add(isec->file ? fileIndex.lookup(isec->file) : UINT64_MAX);
+      fp.add(isec->name);
+      fp.add(isec->outSecOff);
+      fp.add(isec->getSize());
+    }
+  }
+
+  // Relocations referring to merged strings are resolved to the offsets of
+  // the pieces in the synthetic section, which depend on all input files.
+  for (InputSectionBase *sec : inputSections)
+    if (auto *ms = dyn_cast<MergeInputSection>(sec))
+      for (const SectionPiece &piece : ms->pieces)
+        fp.add(piece.live ? piece.outputOff : UINT64_MAX);
+
+  for (Symbol *sym : symtab->symbols()) {
+    fp.add(sym->getName());
+    fp.add(sym->kind());
+    fp.add(sym->isDefined() ? sym->getVA() : 0);
+    fp.add(sym->gotIndex);
+    fp.add(sym->pltIndex);
+    fp.add(sym->dynsymIndex);
+    fp.add(sym->isPreemptible);
+    fp.add(sym->isInIplt);
+    fp.add(sym->needsPltAddr);
+  }
+  return fp.get();
+}
+
+static LinkState computeState(ArrayRef<InputFile *> files, uint64_t fileSize) {
+  LinkState state;
+  state.argsHash = config->incrementalArgsHash;
+  state.layoutHash = computeLayoutHash(files);
+  state.outputSize = fileSize;
+  state.files.resize(files.size());
+  parallelForEachN(0, files.size(), [&](size_t i) {
+    state.files[i] = {toString(files[i]), xxHash64(files[i]->mb.getBuffer())};
+  });
+  return state;
+}
+
+// The state file is a text file of the following form:
+//
+//   lld-incremental 1
+//   args <hash>
+//   layout <hash>
+//   output <size> <modification time>
+//   file <hash> <name>
+//   ...
+static Optional<LinkState> readState() {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> mbOrErr =
+      MemoryBuffer::getFile(getStatePath());
+  if (!mbOrErr)
+    return None;
+
+  SmallVector<StringRef, 0> lines;
+  (*mbOrErr)->getBuffer().split(lines, '\n', -1, /*KeepEmpty=*/false);
+  if (lines.size() < 4 || lines[0] != "lld-incremental 1")
+    return None;
+
+  LinkState state;
+  StringRef rest;
+  if (!lines[1].consume_front("args ") ||
+      lines[1].getAsInteger(16, state.argsHash) ||
+      !lines[2].consume_front("layout ") ||
+      lines[2].getAsInteger(16, state.layoutHash) ||
+      !lines[3].consume_front("output "))
+    return None;
+  std::tie(lines[3], rest) = lines[3].split(' ');
+  if (lines[3].getAsInteger(10, state.outputSize) ||
+      rest.getAsInteger(10, state.outputModTime))
+    return None;
+
+  for (StringRef line : makeArrayRef(lines).drop_front(4)) {
+    StringRef hash;
+    if (!line.consume_front("file "))
+      return None;
+    std::tie(hash, rest) = line.split(' ');
+    uint64_t h;
+    if (hash.getAsInteger(16, h))
+      return None;
+    state.files.emplace_back(rest.str(), h);
+  }
+  return state;
+}
+
+static bool getOutputStatus(uint64_t &size, int64_t &modTime) {
+  sys::fs::file_status st;
+  if (sys::fs::status(config->outputFile, st) ||
+      st.type() != sys::fs::file_type::regular_file)
+    return false;
+  size = st.getSize();
+  modTime = st.getLastModificationTime().time_since_epoch().count();
+  return true;
+}
+
+// The state of this link, computed by canPatchOutput().
+static Optional<LinkState> currentState;
+
+bool elf::canPatchOutput(uint64_t fileSize) {
+  llvm::TimeTraceScope timeScope("Check incremental state");
+  std::vector<InputFile *> files = getInputFiles();
+  currentState = computeState(files, fileSize);
+
+  // The old state no longer describes the output once we start writing it.
+  Optional<LinkState> old = readState();
+  sys::fs::remove(getStatePath());
+
+  // Sections that refer to other sections through their contents rather
+  // than through the layout can't be reused.
+  if (!old || !config->mmapOutputFile || config->relocatable ||
+      config->emitRelocs)
+    return false;
+
+  uint64_t size;
+  int64_t modTime;
+  if (!getOutputStatus(size, modTime) || size != fileSize ||
+      old->outputSize != fileSize || old->outputModTime != modTime ||
+      old->argsHash != currentState->argsHash ||
+      old->layoutHash != currentState->layoutHash ||
+      old->files.size() != files.size())
+    return false;
+
+  for (size_t i = 0; i < files.size(); ++i)
+    if (old->files[i].first != currentState->files[i].first)
+      return false;
+
+  size_t numChanged = 0;
+  for (size_t i = 0; i < files.size(); ++i) {
+    if (old->files[i].second == currentState->files[i].second)
+      files[i]->incrementalUnchanged = true;
+    else
+      ++numChanged;
+  }
+  log("patching " + config->outputFile + ": " + Twine(numChanged) +
+      " of " + Twine(files.size()) + " input files changed");
+  return true;
+}
+
+void elf::writeIncrementalState() {
+  if (!currentState)
+    currentState = computeState(getInputFiles(), 0);
+  if (!getOutputStatus(currentState->outputSize, currentState->outputModTime))
+    return;
+
+  std::error_code ec;
+  raw_fd_ostream os(getStatePath(), ec, sys::fs::OF_None);
+  if (ec) {
+    warn("cannot write " + getStatePath() + ": " + ec.message());
+    return;
+  }
+  os << "lld-incremental 1\n";
+  os << "args " << utohexstr(currentState->argsHash) << "\n";
+  os << "layout " << utohexstr(currentState->layoutHash) << "\n";
+  os << "output " << currentState->outputSize << " "
+     << currentState->outputModTime << "\n";
+  for (const std::pair<std::string, uint64_t> &file : currentState->files)
+    os << "file " << utohexstr(file.second) << " " << file.first << "\n";
+}
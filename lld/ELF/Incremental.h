@@ -0,0 +1,26 @@
+//===- Incremental.h --------------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLD_ELF_INCREMENTAL_H
+#define LLD_ELF_INCREMENTAL_H
+
+#include <cstdint>
+
+namespace lld {
+namespace elf {
+// Returns true if the output of the previous --incremental link can be
+// patched in place instead of being rewritten. If so, the input files whose
+// sections are unchanged are marked so that their sections aren't written.
+bool canPatchOutput(uint64_t fileSize);
+
+// Records the state of this link next to the output file.
+void writeIncrementalState();
+} // namespace elf
+} // namespace lld
+
+#endif
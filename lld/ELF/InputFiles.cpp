@@ -26,9 +26,12 @@
 #include "llvm/Support/ARMAttributeParser.h"
 #include "llvm/Support/ARMBuildAttributes.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/RISCVAttributeParser.h"
 #include "llvm/Support/TarWriter.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace llvm;
@@ -104,18 +107,129 @@ InputFile::InputFile(Kind k, MemoryBufferRef m)
     ++nextGroupId;
 }
 
-Optional<MemoryBufferRef> elf::readFile(StringRef path) {
-  llvm::TimeTraceScope timeScope("Load input files", path);
+namespace {
+// An input file read ahead of the driver.
+struct PrefetchedFile {
+  std::shared_future<void> done;
+  ErrorOr<std::unique_ptr<MemoryBuffer>> mb = std::error_code();
+};
+} // namespace
+
+static std::unique_ptr<ThreadPool> prefetchPool;
+static StringMap<PrefetchedFile> prefetchedFiles;
 
+static StringRef getChrootedPath(StringRef path) {
   // The --chroot option changes our virtual root directory.
   // This is useful when you are dealing with files created by --reproduce.
   if (!config->chroot.empty() && path.startswith("/"))
-    path = saver.save(config->chroot + path);
+    return saver.save(config->chroot + path);
+  return path;
+}
+
+// Reads a byte of each page of the given data to bring it into memory.
+static void touchPages(StringRef data) {
+  static const size_t pageSize = sys::Process::getPageSizeEstimate();
+  for (size_t i = 0; i < data.size(); i += pageSize)
+    (void)*(volatile const char *)(data.data() + i);
+}
+
+// Input files stay mapped for the whole link and are read over and over, so
+// let the large ones be backed by huge pages. Which parts are worth reading
+// ahead is only known once the file is identified: see touchInputFile.
+static constexpr unsigned inputHints = MemoryBuffer::AH_HugePages;
+
+// Brings into memory the parts of an input file the driver reads while
+// resolving symbols: all of a relocatable object file, everything but code
+// and data of a shared object, and the index of an archive. Archive members
+// are only read once they get extracted.
+static void touchInputFile(MemoryBufferRef mb) {
+  switch (identify_magic(mb.getBuffer())) {
+  case file_magic::archive: {
+    Expected<std::unique_ptr<Archive>> file = Archive::create(mb);
+    if (!file) {
+      consumeError(file.takeError());
+      return;
+    }
+    touchPages((*file)->getSymbolTable());
+    return;
+  }
+  case file_magic::elf_shared_object: {
+    Expected<std::unique_ptr<ObjectFile>> obj =
+        ObjectFile::createELFObjectFile(mb);
+    if (!obj) {
+      consumeError(obj.takeError());
+      return;
+    }
+    for (const SectionRef &sec : (*obj)->sections()) {
+      uint32_t type = ELFSectionRef(sec).getType();
+      if (type == SHT_PROGBITS || type == SHT_NOBITS)
+        continue;
+      if (Expected<StringRef> data = sec.getContents())
+        touchPages(*data);
+      else
+        consumeError(data.takeError());
+    }
+    return;
+  }
+  case file_magic::unknown:
+    return;
+  default:
+    touchPages(mb.getBuffer());
+  }
+}
+
+void elf::prefetchFiles(ArrayRef<std::string> paths) {
+  if (paths.empty())
+    return;
+  prefetchPool = std::make_unique<ThreadPool>(parallel::strategy);
+
+  // Create all entries first so that the tasks never see the map change.
+  std::vector<PrefetchedFile *> entries;
+  std::vector<StringRef> entryPaths;
+  for (const std::string &p : paths) {
+    StringRef path = getChrootedPath(p);
+    auto res = prefetchedFiles.try_emplace(path);
+    if (res.second) {
+      entries.push_back(&res.first->second);
+      entryPaths.push_back(res.first->first());
+    }
+  }
+
+  for (size_t i = 0; i < entries.size(); ++i) {
+    PrefetchedFile *entry = entries[i];
+    StringRef path = entryPaths[i];
+    entry->done = prefetchPool->async([=] {
+      entry->mb = MemoryBuffer::getFile(path, -1, false, false, inputHints);
+      if (*entry->mb)
+        touchInputFile((*entry->mb)->getMemBufferRef());
+    });
+  }
+}
+
+void elf::endPrefetch() {
+  if (!prefetchPool)
+    return;
+  prefetchPool->wait();
+  prefetchPool.reset();
+  prefetchedFiles.clear();
+}
+
+Optional<MemoryBufferRef> elf::readFile(StringRef path) {
+  llvm::TimeTraceScope timeScope("Load input files", path);
+  path = getChrootedPath(path);
 
   log(path);
   config->dependencyFiles.insert(llvm::CachedHashString(path));
 
-  auto mbOrErr = MemoryBuffer::getFile(path, -1, false);
+  ErrorOr<std::unique_ptr<MemoryBuffer>> mbOrErr = std::error_code();
+  auto it = prefetchedFiles.find(path);
+  if (it != prefetchedFiles.end()) {
+    it->second.done.wait();
+    mbOrErr = std::move(it->second.mb);
+    prefetchedFiles.erase(it);
+  } else {
+    mbOrErr = MemoryBuffer::getFile(path, -1, false, false, inputHints);
+  }
   if (auto ec = mbOrErr.getError()) {
     error("cannot open " + path + ": " + ec.message());
     return None;
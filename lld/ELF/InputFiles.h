@@ -50,6 +50,13 @@ extern std::unique_ptr<llvm::TarWriter> tar;
 // Opens a given file.
 llvm::Optional<MemoryBufferRef> readFile(StringRef path);
 
+// Starts reading the given files on background threads. readFile() then
+// takes the buffers read ahead instead of opening the files again.
+void prefetchFiles(ArrayRef<std::string> paths);
+
+// Waits for the background reads and drops the buffers that weren't used.
+void endPrefetch();
+
 // Add symbols in File to the symbol table.
 void parseFile(InputFile *file);
 
@@ -115,6 +122,11 @@ public:
   // True if this is an argument for --just-symbols. Usually false.
   bool justSymbols = false;
 
+  // True if the contents of this file haven't changed since the previous
+  // --incremental link, whose output is being patched. The sections of this
+  // file are then already in the output and are not written again.
+  bool incrementalUnchanged = false;
+
   // outSecOff of .got2 in the current file. This is used by PPC32 -fPIC/-fPIE
   // to compute offsets in PLT call stubs.
   uint32_t ppc32Got2OutSecOff = 0;
@@ -23,6 +23,8 @@
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/Memory.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Threading.h"
 #include "llvm/Support/xxhash.h"
 #include <algorithm>
@@ -85,10 +87,12 @@ InputSectionBase::InputSectionBase(InputFile *file, uint64_t flags,
   // If that's the case, demangle section name so that we can handle a
   // section as if it weren't compressed.
   if ((flags & SHF_COMPRESSED) || name.startswith(".zdebug")) {
-    if (!zlib::isAvailable())
-      error(toString(file) + ": contains a compressed section, " +
-            "but zlib is not available");
     parseCompressedHeader();
+    compression::Format format = zstdCompressed ? compression::Format::Zstd
+                                                : compression::Format::Zlib;
+    if (!compression::isAvailable(format))
+      error(toString(file) + ": contains a compressed section, but " +
+            compression::getName(format) + " is not available");
   }
 }
 
@@ -143,6 +147,12 @@ size_t InputSectionBase::getSize() const {
   return rawData.size() - bytesDropped;
 }
 
+Error InputSectionBase::uncompressRawData(char *buf, size_t &size) const {
+  return compression::uncompress(zstdCompressed ? compression::Format::Zstd
+                                                : compression::Format::Zlib,
+                                 toStringRef(rawData), buf, size);
+}
+
 void InputSectionBase::uncompress() const {
   size_t size = uncompressedSize;
   char *uncompressedBuf;
@@ -152,13 +162,25 @@ void InputSectionBase::uncompress() const {
     uncompressedBuf = bAlloc.Allocate<char>(size);
   }
 
-  if (Error e = zlib::uncompress(toStringRef(rawData), uncompressedBuf, size))
+  if (Error e = uncompressRawData(uncompressedBuf, size))
     fatal(toString(this) +
           ": uncompress failed: " + llvm::toString(std::move(e)));
   rawData = makeArrayRef((uint8_t *)uncompressedBuf, size);
   uncompressedSize = -1;
 }
 
+void InputSectionBase::releaseMemory() {
+  SmallVector<Relocation, 0>().swap(relocations);
+  SmallVector<JumpInstrMod, 0>().swap(jumpInstrMods);
+
+  // The contents are either in the mmapped input file, in which case the
+  // pages are simply dropped from memory, or in a buffer we allocated to
+  // decompress them. Only pages within the section are affected, so the
+  // symbol and string tables of the file are left alone.
+  if (!rawData.empty())
+    sys::Memory::discardPages(rawData.data(), rawData.size());
+}
+
 uint64_t InputSectionBase::getOffsetInFile() const {
   const uint8_t *fileStart = (const uint8_t *)file->mb.getBufferStart();
   const uint8_t *secStart = data().begin();
@@ -208,7 +230,7 @@ OutputSection *SectionBase::getOutputSection() {
 }
 
 // When a section is compressed, `rawData` consists with a header followed
-// by zlib-compressed data. This function parses a header to initialize
+// by zlib- or zstd-compressed data. This function parses a header to initialize
 // `uncompressedSize` member and remove the header from `rawData`.
 void InputSectionBase::parseCompressedHeader() {
   using Chdr64 = typename ELF64LE::Chdr;
@@ -247,11 +269,13 @@ void InputSectionBase::parseCompressedHeader() {
     }
 
     auto *hdr = reinterpret_cast<const Chdr64 *>(rawData.data());
-    if (hdr->ch_type != ELFCOMPRESS_ZLIB) {
+    if (hdr->ch_type != ELFCOMPRESS_ZLIB && hdr->ch_type != ELFCOMPRESS_ZSTD) {
       error(toString(this) + ": unsupported compression type");
       return;
     }
 
+    zstdCompressed = hdr->ch_type == ELFCOMPRESS_ZSTD;
+
     uncompressedSize = hdr->ch_size;
     alignment = std::max<uint32_t>(hdr->ch_addralign, 1);
     rawData = rawData.slice(sizeof(*hdr));
@@ -265,11 +289,13 @@ void InputSectionBase::parseCompressedHeader() {
   }
 
   auto *hdr = reinterpret_cast<const Chdr32 *>(rawData.data());
-  if (hdr->ch_type != ELFCOMPRESS_ZLIB) {
+  if (hdr->ch_type != ELFCOMPRESS_ZLIB && hdr->ch_type != ELFCOMPRESS_ZSTD) {
     error(toString(this) + ": unsupported compression type");
     return;
   }
 
+  zstdCompressed = hdr->ch_type == ELFCOMPRESS_ZSTD;
+
   uncompressedSize = hdr->ch_size;
   alignment = std::max<uint32_t>(hdr->ch_addralign, 1);
   rawData = rawData.slice(sizeof(*hdr));
@@ -1248,8 +1274,7 @@ template <class ELFT> void InputSection::writeTo(uint8_t *buf) {
   // to the buffer.
   if (uncompressedSize >= 0) {
     size_t size = uncompressedSize;
-    if (Error e = zlib::uncompress(toStringRef(rawData),
-                                   (char *)(buf + outSecOff), size))
+    if (Error e = uncompressRawData((char *)(buf + outSecOff), size))
       fatal(toString(this) +
             ": uncompress failed: " + llvm::toString(std::move(e)));
     uint8_t *bufEnd = buf + outSecOff + size;
@@ -1356,16 +1381,40 @@ void MergeInputSection::splitStrings(ArrayRef<uint8_t> data, size_t entSize) {
   bool isAlloc = flags & SHF_ALLOC;
   StringRef s = toStringRef(data);
 
+  // Hashing is much slower than finding the string boundaries. For large
+  // sections, which are typically .debug_str of LTO or of big objects and
+  // may take most of the time of splitSections(), find the boundaries first
+  // and hash the pieces in parallel.
+  bool hashInParallel = data.size() >= (1 << 20);
+
   while (!s.empty()) {
     size_t end = findNull(s, entSize);
     if (end == StringRef::npos)
       fatal(toString(this) + ": string is not null terminated");
     size_t size = end + entSize;
 
-    pieces.emplace_back(off, xxHash64(s.substr(0, size)), !isAlloc);
+    pieces.emplace_back(
+        off, hashInParallel ? 0 : xxHash64(s.substr(0, size)), !isAlloc);
     s = s.substr(size);
     off += size;
   }
+
+  if (hashInParallel) {
+    const size_t numPieces = pieces.size();
+    const size_t chunkSize = 4096;
+    parallelForEachN(0, (numPieces + chunkSize - 1) / chunkSize, [&](size_t c) {
+      size_t begin = c * chunkSize;
+      size_t end = std::min(begin + chunkSize, numPieces);
+      for (size_t i = begin; i != end; ++i) {
+        size_t pieceBegin = pieces[i].inputOff;
+        size_t pieceEnd =
+            i + 1 == numPieces ? data.size() : pieces[i + 1].inputOff;
+        // Same as SectionPiece's constructor.
+        uint32_t hash = xxHash64(data.slice(pieceBegin, pieceEnd - pieceBegin));
+        pieces[i].hash = hash >> 1;
+      }
+    });
+  }
 }
 
 // Split non-SHF_STRINGS section. Such section is a sequence of
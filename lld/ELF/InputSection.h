@@ -54,7 +54,7 @@ public:
 
   uint8_t sectionKind : 3;
 
-  // The next two bit fields are only used by InputSectionBase, but we
+  // The next three bit fields are only used by InputSectionBase, but we
   // put them here so the struct packs better.
 
   uint8_t bss : 1;
@@ -62,6 +62,10 @@ public:
   // Set for sections that should not be folded by ICF.
   uint8_t keepUnique : 1;
 
+  // Set for compressed sections whose contents are zstd frames rather than a
+  // zlib stream.
+  uint8_t zstdCompressed : 1;
+
   // The 1-indexed partition that this section is assigned to by the garbage
   // collector, or 0 if this section is dead. Normally there is only one
   // partition, so this will either be 0 or 1.
@@ -96,8 +100,9 @@ protected:
               uint64_t entsize, uint64_t alignment, uint32_t type,
               uint32_t info, uint32_t link)
       : name(name), repl(this), sectionKind(sectionKind), bss(false),
-        keepUnique(false), partition(0), alignment(alignment), flags(flags),
-        entsize(entsize), type(type), link(link), info(info) {}
+        keepUnique(false), zstdCompressed(false), partition(0),
+        alignment(alignment), flags(flags), entsize(entsize), type(type),
+        link(link), info(info) {}
 };
 
 // This corresponds to a section of an input file.
@@ -231,6 +236,11 @@ public:
   void adjustSplitStackFunctionPrologues(uint8_t *buf, uint8_t *end);
 
 
+  // Gives the memory holding the contents and relocations of this section
+  // back to the system. Used by --no-keep-memory once the output file has
+  // been written; the section must not be read afterwards.
+  void releaseMemory();
+
   template <typename T> llvm::ArrayRef<T> getDataAs() const {
     size_t s = data().size();
     assert(s % sizeof(T) == 0);
@@ -239,6 +249,7 @@ public:
 
 protected:
   void parseCompressedHeader();
+  llvm::Error uncompressRawData(char *buf, size_t &size) const;
   void uncompress() const;
 
   mutable ArrayRef<uint8_t> rawData;
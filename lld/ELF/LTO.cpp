@@ -194,6 +194,13 @@ BitcodeCompiler::BitcodeCompiler() {
         std::string(config->thinLTOPrefixReplace.first),
         std::string(config->thinLTOPrefixReplace.second),
         config->thinLTOEmitImportsFiles, indexFile.get(), onIndexWrite);
+  } else if (!config->thinLTODistributor.empty()) {
+    backend = lto::createOutOfProcessThinBackend(
+        llvm::heavyweight_hardware_concurrency(config->thinLTOJobs),
+        std::string(config->thinLTODistributor),
+        std::vector<std::string>(config->thinLTODistributorArgs.begin(),
+                                 config->thinLTODistributorArgs.end()),
+        /*JobDir=*/"");
   } else {
     backend = lto::createInProcessThinBackend(
         llvm::heavyweight_hardware_concurrency(config->thinLTOJobs));
@@ -298,13 +305,19 @@ std::vector<InputFile *> BitcodeCompiler::compile() {
   // The --thinlto-cache-dir option specifies the path to a directory in which
   // to cache native object files for ThinLTO incremental builds. If a path was
   // specified, configure LTO to use it as the cache directory.
+  // --thinlto-remote-cache-dir adds a second tier shared between machines.
   lto::NativeObjectCache cache;
-  if (!config->thinLTOCacheDir.empty())
+  if (!config->thinLTOCacheDir.empty()) {
+    std::shared_ptr<lto::RemoteCache> remote;
+    if (!config->thinLTORemoteCacheDir.empty())
+      remote = check(lto::directoryRemoteCache(config->thinLTORemoteCacheDir));
     cache = check(
         lto::localCache(config->thinLTOCacheDir,
                         [&](size_t task, std::unique_ptr<MemoryBuffer> mb) {
                           files[task] = std::move(mb);
-                        }));
+                        },
+                        remote));
+  }
 
   if (!bitcodeFiles.empty())
     checkError(ltoObj->run(
@@ -277,6 +277,83 @@ static void fill(uint8_t *buf, size_t size,
   memcpy(buf + i, filler.data(), size - i);
 }
 
+// Deflate data that ends with a sync flush is byte aligned and may be
+// followed by more deflate data. We split the section into fixed-size shards,
+// compress them in parallel, and concatenate the results between a zlib
+// header and a trailer holding the Adler-32 checksum combined from the
+// per-shard checksums. The result is a single valid zlib stream. Like in
+// compressZstd(), the shard size doesn't depend on the number of threads, so
+// the output is deterministic.
+void OutputSection::compressZlib(ArrayRef<uint8_t> buf) {
+  // Each shard restarts the deflate dictionary, which costs a little
+  // compression ratio; 1 MiB keeps the loss well under 1%.
+  const size_t shardSize = 1 << 20;
+  size_t numShards = std::max<size_t>(1, divideCeil(buf.size(), shardSize));
+  // We chose 1 as the default compression level because it is the fastest. If
+  // -O2 is given, we use level 6 to compress debug info more by ~15%. We found
+  // that level 7 to 9 doesn't make much difference (~1% more compression) while
+  // they take significant amount of time (~2x), so level 6 seems enough.
+  int level = config->optimize >= 2 ? 6 : 1;
+
+  std::vector<SmallVector<char, 0>> shards(numShards);
+  std::vector<uint32_t> checksums(numShards);
+  parallelForEachN(0, numShards, [&](size_t i) {
+    StringRef in = toStringRef(buf.slice(i * shardSize).take_front(shardSize));
+    if (Error e = zlib::compressRaw(in, shards[i], level, i == numShards - 1))
+      fatal("compress failed: " + llvm::toString(std::move(e)));
+    checksums[i] = zlib::adler32(in);
+  });
+
+  size_t totalSize = 2 + 4;
+  for (const SmallVector<char, 0> &shard : shards)
+    totalSize += shard.size();
+  compressedData.reserve(totalSize);
+
+  // CMF (deflate, 32 KiB window) and FLG (no preset dictionary, FLEVEL 0)
+  // such that CMF*256+FLG is a multiple of 31.
+  compressedData.push_back(0x78);
+  compressedData.push_back(0x01);
+
+  uint32_t checksum = 1;
+  for (size_t i = 0; i != numShards; ++i) {
+    compressedData.append(shards[i].begin(), shards[i].end());
+    size_t len = std::min(shardSize, buf.size() - i * shardSize);
+    checksum = zlib::adler32Combine(checksum, checksums[i], len);
+  }
+  compressedData.resize(compressedData.size() + 4);
+  write32be(compressedData.end() - 4, checksum);
+}
+
+// A sequence of zstd frames is a valid zstd stream, so we can split the
+// section into fixed-size shards, compress them independently in parallel and
+// concatenate the results. Each frame records its own size, so decompressors
+// don't need to know about the shards. Because the shard size doesn't depend
+// on the number of threads, the output is deterministic.
+void OutputSection::compressZstd(ArrayRef<uint8_t> buf) {
+  // Smaller shards make the compression ratio worse. 1 MiB loses less than 1%
+  // on typical DWARF while giving enough parallelism for large sections.
+  const size_t shardSize = 1 << 20;
+  size_t numShards = std::max<size_t>(1, divideCeil(buf.size(), shardSize));
+  // zstd level 1 is already faster than zlib level 1 with a better ratio;
+  // use the library default for -O2.
+  int level = config->optimize >= 2 ? zstd::DefaultCompression
+                                    : zstd::BestSpeedCompression;
+
+  std::vector<SmallVector<char, 0>> shards(numShards);
+  parallelForEachN(0, numShards, [&](size_t i) {
+    ArrayRef<uint8_t> in = buf.slice(i * shardSize).take_front(shardSize);
+    if (Error e = zstd::compress(toStringRef(in), shards[i], level))
+      fatal("compress failed: " + llvm::toString(std::move(e)));
+  });
+
+  size_t totalSize = 0;
+  for (const SmallVector<char, 0> &shard : shards)
+    totalSize += shard.size();
+  compressedData.reserve(totalSize);
+  for (const SmallVector<char, 0> &shard : shards)
+    compressedData.append(shard.begin(), shard.end());
+}
+
 // Compress section contents if this section contains debug info.
 template <class ELFT> void OutputSection::maybeCompress() {
   using Elf_Chdr = typename ELFT::Chdr;
@@ -289,22 +366,21 @@ template <class ELFT> void OutputSection::maybeCompress() {
   llvm::TimeTraceScope timeScope("Compress debug sections");
 
   // Create a section header.
+  bool isZstd = *config->compressDebugSections == compression::Format::Zstd;
   zDebugHeader.resize(sizeof(Elf_Chdr));
   auto *hdr = reinterpret_cast<Elf_Chdr *>(zDebugHeader.data());
-  hdr->ch_type = ELFCOMPRESS_ZLIB;
+  hdr->ch_type = isZstd ? ELFCOMPRESS_ZSTD : ELFCOMPRESS_ZLIB;
   hdr->ch_size = size;
   hdr->ch_addralign = alignment;
 
   // Write section contents to a temporary buffer and compress it.
   std::vector<uint8_t> buf(size);
   writeTo<ELFT>(buf.data());
-  // We chose 1 as the default compression level because it is the fastest. If
-  // -O2 is given, we use level 6 to compress debug info more by ~15%. We found
-  // that level 7 to 9 doesn't make much difference (~1% more compression) while
-  // they take significant amount of time (~2x), so level 6 seems enough.
-  if (Error e = zlib::compress(toStringRef(buf), compressedData,
-                               config->optimize >= 2 ? 6 : 1))
-    fatal("compress failed: " + llvm::toString(std::move(e)));
+
+  if (isZstd)
+    compressZstd(buf);
+  else
+    compressZlib(buf);
 
   // Update section headers.
   size = sizeof(Elf_Chdr) + compressedData.size();
@@ -347,7 +423,13 @@ template <class ELFT> void OutputSection::writeTo(uint8_t *buf) {
 
   parallelForEachN(0, sections.size(), [&](size_t i) {
     InputSection *isec = sections[i];
-    isec->writeTo<ELFT>(buf);
+    if (!isec->file || !isec->file->incrementalUnchanged) {
+      // When patching an existing output, synthetic sections that only write
+      // some of their bytes would otherwise keep stale contents.
+      if (config->incremental && isa<SyntheticSection>(isec))
+        memset(buf + isec->outSecOff, 0, isec->getSize());
+      isec->writeTo<ELFT>(buf);
+    }
 
     // Fill gaps between sections.
     if (nonZeroFiller) {
@@ -113,6 +113,8 @@ private:
   std::vector<uint8_t> zDebugHeader;
   llvm::SmallVector<char, 0> compressedData;
 
+  void compressZlib(ArrayRef<uint8_t> buf);
+  void compressZstd(ArrayRef<uint8_t> buf);
   std::array<uint8_t, 4> getFiller();
 };
 
@@ -55,6 +55,7 @@
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/Demangle/Demangle.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 
@@ -1554,6 +1555,176 @@ template <class ELFT> void elf::scanRelocations(InputSectionBase &s) {
     scanRelocs<ELFT>(s, s.rels<ELFT>());
 }
 
+// The parallel relocation scan splits the work of scanRelocs() into two
+// phases. The first phase runs concurrently on many sections and only does
+// work that depends on the section and its relocations: decoding, offset
+// translation, computing RelExpr and the addend. Most relocations in a
+// typical link are resolved statically against non-preemptible symbols, and
+// the first phase handles them completely.
+//
+// Everything else may create GOT/PLT entries, copy relocations, dynamic
+// relocations or diagnostics, which mutate global state whose order is
+// observable in the output. Such relocations are handed back to scanReloc()
+// in the second phase, which runs on a single thread and visits sections and
+// relocations in the same order as the serial scan. That way the output is
+// identical regardless of the number of threads.
+namespace {
+enum class ScanKind : uint8_t { Skip, Static, Full };
+
+struct ScanRecord {
+  Relocation rel;
+  ScanKind kind;
+};
+} // namespace
+
+// Returns true if the targets' getRelExpr() and the processing of their
+// relocations are free of side effects that depend on the order in which
+// relocations are visited. MIPS, PPC, Hexagon and RISC-V keep per-file or
+// global state or may diagnose the same relocation twice, so they always use
+// the serial scan.
+static bool supportsParallelScan() {
+  switch (config->emachine) {
+  case EM_386:
+  case EM_AARCH64:
+  case EM_ARM:
+  case EM_X86_64:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Returns true if a relocation can be resolved at link-time without creating
+// any synthetic entries or diagnostics, i.e. if scanReloc() would just append
+// it to the section's relocation vector.
+static bool isSimpleStaticReloc(RelExpr expr, const Symbol &sym) {
+  if (!sym.isDefined() || sym.isPreemptible || sym.isGnuIFunc() ||
+      sym.isTls())
+    return false;
+  if (needsPlt(expr) || needsGot(expr) ||
+      oneof<R_GOTPLTONLY_PC, R_GOTPLTREL, R_GOTPLT, R_TLSGD_GOTPLT,
+            R_GOTONLY_PC, R_GOTREL, R_TLSDESC, R_TLSDESC_CALL, R_TLSDESC_PC,
+            R_AARCH64_TLSDESC_PAGE>(expr))
+    return false;
+  if (!config->isPic || expr == R_SIZE)
+    return true;
+  return isAbsoluteValue(sym) != isRelExpr(expr);
+}
+
+template <class ELFT, class RelTy>
+static void preScanRelocs(InputSectionBase &sec, ArrayRef<RelTy> rels,
+                          std::vector<ScanRecord> &records) {
+  OffsetGetter getOffset(sec);
+  records.resize(rels.size());
+
+  for (size_t i = 0, e = rels.size(); i != e; ++i) {
+    const RelTy &rel = rels[i];
+    ScanRecord &rec = records[i];
+    rec.kind = ScanKind::Full;
+
+    uint32_t symIndex = rel.getSymbol(config->isMips64EL);
+    Symbol &sym = sec.getFile<ELFT>()->getSymbol(symIndex);
+    RelType type = rel.getType(config->isMips64EL);
+    uint64_t offset = getOffset.get(rel.r_offset);
+    if (offset == uint64_t(-1)) {
+      rec.kind = ScanKind::Skip;
+      continue;
+    }
+
+    // Undefined symbols may need to be reported, so leave them to the
+    // serial phase.
+    if (sym.isUndefined())
+      continue;
+
+    const uint8_t *relocatedAddr = sec.data().begin() + rel.r_offset;
+    RelExpr expr = target->getRelExpr(type, sym, relocatedAddr);
+    if (expr == R_NONE) {
+      rec.kind = ScanKind::Skip;
+      continue;
+    }
+    if (!isSimpleStaticReloc(expr, sym))
+      continue;
+
+    int64_t addend = computeAddend<ELFT>(rel, rels.end(), sec, expr,
+                                         sym.isLocal());
+    rec.rel = {expr, type, offset, addend, &sym};
+    rec.kind = ScanKind::Static;
+  }
+}
+
+// Records are computed before earlier sections are committed. That is safe
+// because committing a relocation only ever turns a symbol that needs a Full
+// scan into one that doesn't (e.g. a shared symbol receiving a copy relocation
+// or an ifunc getting a canonical PLT entry), never the other way around.
+template <class ELFT, class RelTy>
+static void commitRelocs(InputSectionBase &sec, ArrayRef<RelTy> rels,
+                         ArrayRef<ScanRecord> records) {
+  OffsetGetter getOffset(sec);
+  sec.relocations.reserve(rels.size());
+
+  const RelTy *begin = rels.begin();
+  for (const RelTy *i = begin, *end = rels.end(); i != end;) {
+    const ScanRecord &rec = records[i - begin];
+    switch (rec.kind) {
+    case ScanKind::Skip:
+      ++i;
+      break;
+    case ScanKind::Static:
+      sec.relocations.push_back(rec.rel);
+      ++i;
+      break;
+    case ScanKind::Full:
+      // scanReloc() may consume more than one relocation (e.g. for TLS
+      // relaxation). Records of the consumed relocations are ignored.
+      scanReloc<ELFT>(sec, getOffset, i, begin, end);
+      break;
+    }
+  }
+}
+
+template <class ELFT>
+void elf::scanRelocations(ArrayRef<InputSectionBase *> sections) {
+  if (parallel::strategy.ThreadsRequested == 1 || config->mipsN32Abi ||
+      !supportsParallelScan()) {
+    for (InputSectionBase *sec : sections)
+      scanRelocations<ELFT>(*sec);
+    return;
+  }
+
+  // Pre-scanned records take more memory than the resulting Relocation
+  // vectors, so process the sections in batches to bound peak memory usage.
+  // Batches are formed in section order, which keeps the output independent
+  // of the batch size.
+  const size_t maxRelocsPerBatch = 1 << 20;
+  std::vector<std::vector<ScanRecord>> records;
+  for (size_t begin = 0, e = sections.size(); begin != e;) {
+    size_t end = begin;
+    size_t numRelocs = 0;
+    while (end != e && (end == begin || numRelocs < maxRelocsPerBatch))
+      numRelocs += sections[end++]->numRelocations;
+    ArrayRef<InputSectionBase *> batch = sections.slice(begin, end - begin);
+    records.resize(batch.size());
+
+    parallelForEachN(0, batch.size(), [&](size_t i) {
+      InputSectionBase &sec = *batch[i];
+      if (sec.areRelocsRela)
+        preScanRelocs<ELFT>(sec, sec.relas<ELFT>(), records[i]);
+      else
+        preScanRelocs<ELFT>(sec, sec.rels<ELFT>(), records[i]);
+    });
+
+    for (size_t i = 0, n = batch.size(); i != n; ++i) {
+      InputSectionBase &sec = *batch[i];
+      if (sec.areRelocsRela)
+        commitRelocs<ELFT>(sec, sec.relas<ELFT>(), records[i]);
+      else
+        commitRelocs<ELFT>(sec, sec.rels<ELFT>(), records[i]);
+      records[i].clear();
+    }
+    begin = end;
+  }
+}
+
 static bool mergeCmp(const InputSection *a, const InputSection *b) {
   // std::merge requires a strict weak ordering.
   if (a->outSecOff < b->outSecOff)
@@ -2070,6 +2241,10 @@ template void elf::scanRelocations<ELF32LE>(InputSectionBase &);
 template void elf::scanRelocations<ELF32BE>(InputSectionBase &);
 template void elf::scanRelocations<ELF64LE>(InputSectionBase &);
 template void elf::scanRelocations<ELF64BE>(InputSectionBase &);
+template void elf::scanRelocations<ELF32LE>(ArrayRef<InputSectionBase *>);
+template void elf::scanRelocations<ELF32BE>(ArrayRef<InputSectionBase *>);
+template void elf::scanRelocations<ELF64LE>(ArrayRef<InputSectionBase *>);
+template void elf::scanRelocations<ELF64BE>(ArrayRef<InputSectionBase *>);
 template void elf::reportUndefinedSymbols<ELF32LE>();
 template void elf::reportUndefinedSymbols<ELF32BE>();
 template void elf::reportUndefinedSymbols<ELF64LE>();
@@ -124,6 +124,12 @@ struct JumpInstrMod {
 // the diagnostics.
 template <class ELFT> void scanRelocations(InputSectionBase &);
 
+// Scans relocations of all given sections. This is equivalent to calling
+// scanRelocations() for each section in order, but it does most of the work
+// in parallel if multi-threading is enabled. The result doesn't depend on the
+// number of threads.
+template <class ELFT> void scanRelocations(ArrayRef<InputSectionBase *>);
+
 template <class ELFT> void reportUndefinedSymbols();
 
 void hexagonTLSSymbolUpdate(ArrayRef<OutputSection *> outputSections);
@@ -30,9 +30,11 @@
 #include "llvm/ADT/SetOperations.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/BinaryFormat/Dwarf.h"
+#include "llvm/DebugInfo/DWARF/DWARFAcceleratorTable.h"
 #include "llvm/DebugInfo/DWARF/DWARFDebugPubTable.h"
 #include "llvm/Object/ELFObjectFile.h"
 #include "llvm/Support/Compression.h"
+#include "llvm/Support/DJB.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/MD5.h"
@@ -54,6 +56,7 @@ using llvm::support::endian::write32le;
 using llvm::support::endian::write64le;
 
 constexpr size_t MergeNoTailSection::numShards;
+constexpr size_t MergeTailSection::numShards;
 
 static uint64_t readUint(uint8_t *buf) {
   return config->is64 ? read64(buf) : read32(buf);
@@ -2771,9 +2774,9 @@ readPubNamesAndTypes(const LLDDwarfObj<ELFT> &obj,
 
 // Create a list of symbols from a given list of symbol names and types
 // by uniquifying them by name.
-static std::vector<GdbIndexSection::GdbSymbol>
-createSymbols(ArrayRef<std::vector<GdbIndexSection::NameAttrEntry>> nameAttrs,
-              const std::vector<GdbIndexSection::GdbChunk> &chunks) {
+static std::vector<GdbIndexSection::GdbSymbol> createSymbols(
+    MutableArrayRef<std::vector<GdbIndexSection::NameAttrEntry>> nameAttrs,
+    const std::vector<GdbIndexSection::GdbChunk> &chunks) {
   using GdbSymbol = GdbIndexSection::GdbSymbol;
   using NameAttrEntry = GdbIndexSection::NameAttrEntry;
 
@@ -2787,38 +2790,40 @@ createSymbols(ArrayRef<std::vector<GdbIndexSection::NameAttrEntry>> nameAttrs,
 
   // The number of symbols we will handle in this function is of the order
   // of millions for very large executables, so we use multi-threading to
-  // speed it up.
+  // speed it up. Symbols are sharded by the upper bits of their hash values
+  // so that each shard can be uniquified independently.
   constexpr size_t numShards = 32;
-  size_t concurrency = PowerOf2Floor(
-      std::min<size_t>(hardware_concurrency(parallel::strategy.ThreadsRequested)
-                           .compute_thread_count(),
-                       numShards));
-
-  // A sharded map to uniquify symbols by name.
-  std::vector<DenseMap<CachedHashStringRef, size_t>> map(numShards);
   size_t shift = 32 - countTrailingZeros(numShards);
 
-  // Instantiate GdbSymbols while uniqufying them by name.
-  std::vector<std::vector<GdbSymbol>> symbols(numShards);
-  parallelForEachN(0, concurrency, [&](size_t threadId) {
-    uint32_t i = 0;
-    for (ArrayRef<NameAttrEntry> entries : nameAttrs) {
-      for (const NameAttrEntry &ent : entries) {
-        size_t shardId = ent.name.hash() >> shift;
-        if ((shardId & (concurrency - 1)) != threadId)
-          continue;
+  // Distribute the entries of each file to the shards, so that a shard only
+  // visits its own entries. The input vectors are freed as we go to keep
+  // the memory usage flat.
+  using ShardedEntries = std::array<std::vector<NameAttrEntry>, numShards>;
+  std::vector<ShardedEntries> shardedAttrs(nameAttrs.size());
+  parallelForEachN(0, nameAttrs.size(), [&](size_t i) {
+    for (const NameAttrEntry &ent : nameAttrs[i])
+      shardedAttrs[i][ent.name.hash() >> shift].push_back(
+          {ent.name, ent.cuIndexAndAttrs + cuIdxs[i]});
+    std::vector<NameAttrEntry>().swap(nameAttrs[i]);
+  });
 
-        uint32_t v = ent.cuIndexAndAttrs + cuIdxs[i];
-        size_t &idx = map[shardId][ent.name];
+  // Instantiate GdbSymbols while uniqufying them by name. Files are visited
+  // in order, so the output doesn't depend on the number of threads.
+  std::vector<std::vector<GdbSymbol>> symbols(numShards);
+  parallelForEachN(0, numShards, [&](size_t shardId) {
+    DenseMap<CachedHashStringRef, size_t> map;
+    for (ShardedEntries &entries : shardedAttrs) {
+      for (const NameAttrEntry &ent : entries[shardId]) {
+        size_t &idx = map[ent.name];
         if (idx) {
-          symbols[shardId][idx - 1].cuVector.push_back(v);
+          symbols[shardId][idx - 1].cuVector.push_back(ent.cuIndexAndAttrs);
           continue;
         }
 
         idx = symbols[shardId].size() + 1;
-        symbols[shardId].push_back({ent.name, {v}, 0, 0});
+        symbols[shardId].push_back({ent.name, {ent.cuIndexAndAttrs}, 0, 0});
       }
-      ++i;
+      std::vector<NameAttrEntry>().swap(entries[shardId]);
     }
   });
 
@@ -2901,33 +2906,49 @@ void GdbIndexSection::writeTo(uint8_t *buf) {
   hdr->version = 7;
   buf += sizeof(*hdr);
 
+  // Compute where the entries of each chunk go in the CU list and in the
+  // address area, so that chunks can be written in parallel.
+  std::vector<size_t> cuOffs(chunks.size());
+  std::vector<size_t> areaOffs(chunks.size());
+  size_t numCus = 0, numAreas = 0;
+  for (size_t i = 0, e = chunks.size(); i != e; ++i) {
+    cuOffs[i] = numCus;
+    areaOffs[i] = numAreas;
+    numCus += chunks[i].compilationUnits.size();
+    numAreas += chunks[i].addressAreas.size();
+  }
+
   // Write the CU list.
   hdr->cuListOff = buf - start;
-  for (GdbChunk &chunk : chunks) {
-    for (CuEntry &cu : chunk.compilationUnits) {
-      write64le(buf, chunk.sec->outSecOff + cu.cuOffset);
-      write64le(buf + 8, cu.cuLength);
-      buf += 16;
+  parallelForEachN(0, chunks.size(), [&](size_t i) {
+    uint8_t *p = buf + cuOffs[i] * 16;
+    for (CuEntry &cu : chunks[i].compilationUnits) {
+      write64le(p, chunks[i].sec->outSecOff + cu.cuOffset);
+      write64le(p + 8, cu.cuLength);
+      p += 16;
     }
-  }
+  });
+  buf += numCus * 16;
 
   // Write the address area.
   hdr->cuTypesOff = buf - start;
   hdr->addressAreaOff = buf - start;
-  uint32_t cuOff = 0;
-  for (GdbChunk &chunk : chunks) {
-    for (AddressEntry &e : chunk.addressAreas) {
+  parallelForEachN(0, chunks.size(), [&](size_t i) {
+    uint8_t *p = buf + areaOffs[i] * 20;
+    for (AddressEntry &e : chunks[i].addressAreas) {
       // In the case of ICF there may be duplicate address range entries.
       const uint64_t baseAddr = e.section->repl->getVA(0);
-      write64le(buf, baseAddr + e.lowAddress);
-      write64le(buf + 8, baseAddr + e.highAddress);
-      write32le(buf + 16, e.cuIndex + cuOff);
-      buf += 20;
+      write64le(p, baseAddr + e.lowAddress);
+      write64le(p + 8, baseAddr + e.highAddress);
+      write32le(p + 16, e.cuIndex + cuOffs[i]);
+      p += 20;
     }
-    cuOff += chunk.compilationUnits.size();
-  }
+  });
+  buf += numAreas * 20;
 
-  // Write the on-disk open-addressing hash table containing symbols.
+  // Write the on-disk open-addressing hash table containing symbols. This is
+  // done sequentially because the slot of a symbol depends on the symbols
+  // inserted before it.
   hdr->symtabOff = buf - start;
   size_t symtabSize = computeSymtabSize();
   uint32_t mask = symtabSize - 1;
@@ -2953,18 +2974,317 @@ void GdbIndexSection::writeTo(uint8_t *buf) {
   });
 
   // Write the CU vectors.
-  for (GdbSymbol &sym : symbols) {
-    write32le(buf, sym.cuVector.size());
-    buf += 4;
+  parallelForEach(symbols, [&](GdbSymbol &sym) {
+    uint8_t *p = buf + sym.cuVectorOff;
+    write32le(p, sym.cuVector.size());
     for (uint32_t val : sym.cuVector) {
-      write32le(buf, val);
-      buf += 4;
+      p += 4;
+      write32le(p, val);
     }
-  }
+  });
 }
 
 bool GdbIndexSection::isNeeded() const { return !chunks.empty(); }
 
+DebugNamesSection::DebugNamesSection()
+    : SyntheticSection(0, SHT_PROGBITS, 4, ".debug_names") {}
+
+// Reads the name indexes of a file. Entries of type units are dropped
+// because type units may be deduplicated across files; a debugger finds them
+// through the entries of the compile units referring to them.
+template <class ELFT>
+static void readNameIndexes(const LLDDwarfObj<ELFT> &obj,
+                            DebugNamesSection::Chunk &chunk) {
+  const LLDDWARFSection &namesSec = obj.getNamesSection();
+  DWARFDataExtractor data(obj, namesSec, config->isLE, config->wordsize);
+  DataExtractor strData(obj.getStrSection(), config->isLE, config->wordsize);
+  DWARFDebugNames names(data, strData);
+  if (Error e = names.extract()) {
+    warn(toString(namesSec.sec) + ": " + toString(std::move(e)));
+    return;
+  }
+
+  for (const DWARFDebugNames::NameIndex &ni : names) {
+    uint32_t cuBase = chunk.cuOffsets.size();
+    for (uint32_t i = 0, e = ni.getCUCount(); i != e; ++i)
+      chunk.cuOffsets.push_back(ni.getCUOffset(i));
+
+    for (const DWARFDebugNames::NameTableEntry &nte : ni) {
+      const char *name = nte.getString();
+      if (!name)
+        continue;
+      DebugNamesSection::NameData nd{
+          CachedHashStringRef(name, caseFoldingDjbHash(name)),
+          nte.getStringOffset(), uint32_t(chunk.entries.size()), 0};
+
+      uint64_t off = nte.getEntryOffset();
+      while (true) {
+        Expected<DWARFDebugNames::Entry> ent = ni.getEntry(&off);
+        if (!ent) {
+          // The list of entries of a name ends with a sentinel.
+          consumeError(ent.takeError());
+          break;
+        }
+        if (ent->lookup(dwarf::DW_IDX_type_unit))
+          continue;
+        Optional<uint64_t> cuIndex = ent->getCUIndex();
+        Optional<uint64_t> dieOffset = ent->getDIEUnitOffset();
+        if (!cuIndex || *cuIndex >= ni.getCUCount() || !dieOffset)
+          continue;
+
+        DebugNamesSection::IndexEntry ie;
+        ie.cuIndex = cuBase + *cuIndex;
+        ie.dieOffset = *dieOffset;
+        ie.tag = ent->tag();
+        ie.typeHash = 0;
+        ie.hasTypeHash = false;
+        if (Optional<DWARFFormValue> hash =
+                ent->lookup(dwarf::DW_IDX_type_hash)) {
+          if (Optional<uint64_t> v = hash->getAsUnsignedConstant()) {
+            ie.typeHash = *v;
+            ie.hasTypeHash = true;
+          }
+        }
+        chunk.entries.push_back(ie);
+      }
+
+      nd.entriesEnd = chunk.entries.size();
+      if (nd.entriesBegin != nd.entriesEnd)
+        chunk.names.push_back(nd);
+    }
+  }
+}
+
+// Returns a newly-created .debug_names section.
+template <class ELFT> DebugNamesSection *DebugNamesSection::create() {
+  llvm::TimeTraceScope timeScope("Create .debug_names");
+
+  // Collect InputFiles with .debug_names. The input name indexes are
+  // replaced by the merged one.
+  SetVector<InputFile *> files;
+  for (InputSectionBase *s : inputSections) {
+    if (s->name != ".debug_names")
+      continue;
+    s->markDead();
+    if (isa<InputSection>(s))
+      files.insert(s->file);
+  }
+
+  auto *ret = make<DebugNamesSection>();
+  std::vector<Chunk> chunks(files.size());
+  parallelForEachN(0, files.size(), [&](size_t i) {
+    ObjFile<ELFT> *file = cast<ObjFile<ELFT>>(files[i]);
+    LLDDwarfObj<ELFT> obj(file);
+    Chunk &chunk = chunks[i];
+    chunk.infoSec = cast_or_null<InputSection>(obj.getInfoSection());
+    for (InputSectionBase *sec : file->getSections())
+      if (sec && sec->name == ".debug_str")
+        chunk.strSec = sec;
+    if (!chunk.infoSec || !chunk.strSec) {
+      warn(toString(file) + ": .debug_names requires .debug_info and "
+                            ".debug_str; ignoring the name index");
+      return;
+    }
+    readNameIndexes(obj, chunk);
+  });
+
+  // Drop files without any usable name.
+  llvm::erase_if(chunks, [](const Chunk &c) { return c.names.empty(); });
+  for (const Chunk &chunk : chunks) {
+    ret->cuBases.push_back(ret->numCus);
+    ret->numCus += chunk.cuOffsets.size();
+  }
+
+  // Uniquify names. As in createSymbols() for .gdb_index, names are sharded
+  // by the upper bits of their hash values and each shard is uniquified in
+  // parallel. Files are visited in order so that the output doesn't depend
+  // on the number of threads.
+  constexpr size_t numShards = 32;
+  size_t shift = 32 - countTrailingZeros(numShards);
+  using ShardedNames = std::array<std::vector<uint32_t>, numShards>;
+  std::vector<ShardedNames> shardedNames(chunks.size());
+  parallelForEachN(0, chunks.size(), [&](size_t i) {
+    Chunk &chunk = chunks[i];
+    for (IndexEntry &ie : chunk.entries)
+      ie.cuIndex += ret->cuBases[i];
+    for (uint32_t j = 0, e = chunk.names.size(); j != e; ++j)
+      shardedNames[i][chunk.names[j].name.hash() >> shift].push_back(j);
+  });
+
+  std::vector<std::vector<OutputName>> shards(numShards);
+  parallelForEachN(0, numShards, [&](size_t shardId) {
+    DenseMap<CachedHashStringRef, size_t> map;
+    std::vector<OutputName> &out = shards[shardId];
+    for (size_t i = 0, e = chunks.size(); i != e; ++i) {
+      for (uint32_t j : shardedNames[i][shardId]) {
+        const NameData &nd = chunks[i].names[j];
+        size_t &idx = map[nd.name];
+        if (!idx) {
+          out.push_back({nd.name, chunks[i].strSec, nd.strOffset, {}, 0});
+          idx = out.size();
+        }
+        for (uint32_t k = nd.entriesBegin; k != nd.entriesEnd; ++k)
+          out[idx - 1].entries.push_back(&chunks[i].entries[k]);
+      }
+    }
+  });
+
+  size_t numNames = 0;
+  for (const std::vector<OutputName> &v : shards)
+    numNames += v.size();
+  ret->names.reserve(numNames);
+  for (std::vector<OutputName> &v : shards)
+    for (OutputName &name : v)
+      ret->names.push_back(std::move(name));
+  ret->chunks = std::move(chunks);
+
+  // Compute the number of buckets the same way as LLVM's AccelTable.
+  std::vector<uint32_t> hashes;
+  hashes.reserve(numNames);
+  for (const OutputName &name : ret->names)
+    hashes.push_back(name.name.hash());
+  parallelSort(hashes.begin(), hashes.end());
+  size_t numHashes = std::unique(hashes.begin(), hashes.end()) - hashes.begin();
+  if (numHashes > 1024)
+    ret->bucketCount = numHashes / 4;
+  else if (numHashes > 16)
+    ret->bucketCount = numHashes / 2;
+  else
+    ret->bucketCount = std::max<uint32_t>(numHashes, 1);
+
+  // Names in a bucket have to be contiguous.
+  uint32_t bucketCount = ret->bucketCount;
+  parallelSort(ret->names, [=](const OutputName &a, const OutputName &b) {
+    uint32_t ha = a.name.hash(), hb = b.name.hash();
+    if (ha % bucketCount != hb % bucketCount)
+      return ha % bucketCount < hb % bucketCount;
+    if (ha != hb)
+      return ha < hb;
+    return a.name.val() < b.name.val();
+  });
+
+  ret->initOutputSize();
+  return ret;
+}
+
+size_t DebugNamesSection::getEntrySize(const IndexEntry &e) const {
+  uint32_t code = abbrevCodes.lookup(e.tag << 1 | e.hasTypeHash);
+  return getULEB128Size(code) + 8 + (e.hasTypeHash ? 8 : 0);
+}
+
+// Each abbreviation is a tag with a fixed set of attributes: the compile unit
+// index, the DIE offset and optionally the type hash.
+void DebugNamesSection::initOutputSize() {
+  std::vector<uint32_t> keys;
+  for (const Chunk &chunk : chunks)
+    for (const IndexEntry &e : chunk.entries)
+      keys.push_back(e.tag << 1 | e.hasTypeHash);
+  llvm::sort(keys);
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+  raw_string_ostream os(abbrevTable);
+  for (size_t i = 0, e = keys.size(); i != e; ++i) {
+    abbrevCodes[keys[i]] = i + 1;
+    encodeULEB128(i + 1, os);
+    encodeULEB128(keys[i] >> 1, os);
+    encodeULEB128(dwarf::DW_IDX_compile_unit, os);
+    encodeULEB128(dwarf::DW_FORM_data4, os);
+    encodeULEB128(dwarf::DW_IDX_die_offset, os);
+    encodeULEB128(dwarf::DW_FORM_ref4, os);
+    if (keys[i] & 1) {
+      encodeULEB128(dwarf::DW_IDX_type_hash, os);
+      encodeULEB128(dwarf::DW_FORM_data8, os);
+    }
+    encodeULEB128(0, os);
+    encodeULEB128(0, os);
+  }
+  encodeULEB128(0, os);
+  os.flush();
+
+  // Compute the offset of the entries of each name in the entry pool. Each
+  // list is terminated by a zero abbreviation code.
+  parallelForEach(names, [&](OutputName &name) {
+    size_t n = 1;
+    for (const IndexEntry *e : name.entries)
+      n += getEntrySize(*e);
+    name.entryOffset = n;
+  });
+  for (OutputName &name : names) {
+    size_t n = name.entryOffset;
+    name.entryOffset = entryPoolSize;
+    entryPoolSize += n;
+  }
+
+  // Header with the augmentation string, CU list, buckets, hashes, string
+  // offsets and entry offsets.
+  size = 40 + numCus * 4 + bucketCount * 4 + names.size() * 12 +
+         abbrevTable.size() + entryPoolSize;
+  if (size > UINT32_MAX)
+    error(".debug_names is larger than 4 GiB");
+}
+
+void DebugNamesSection::writeTo(uint8_t *buf) {
+  // Write the header.
+  write32(buf, size - 4);
+  write16(buf + 4, 5);
+  write16(buf + 6, 0);
+  write32(buf + 8, numCus);
+  write32(buf + 12, 0);
+  write32(buf + 16, 0);
+  write32(buf + 20, bucketCount);
+  write32(buf + 24, names.size());
+  write32(buf + 28, abbrevTable.size());
+  write32(buf + 32, 4);
+  memcpy(buf + 36, "LLD", 4);
+  buf += 40;
+
+  // Write the CU list.
+  parallelForEachN(0, chunks.size(), [&](size_t i) {
+    uint8_t *p = buf + cuBases[i] * 4;
+    for (uint64_t off : chunks[i].cuOffsets) {
+      write32(p, chunks[i].infoSec->outSecOff + off);
+      p += 4;
+    }
+  });
+  buf += numCus * 4;
+
+  // Write the buckets. A bucket refers to the first of its names, 1-based,
+  // or is zero if empty.
+  memset(buf, 0, bucketCount * 4);
+  for (size_t i = names.size(); i != 0; --i)
+    write32(buf + (names[i - 1].name.hash() % bucketCount) * 4, i);
+  buf += bucketCount * 4;
+
+  // Write the hashes, the string offsets and the entry offsets.
+  uint8_t *hashes = buf;
+  uint8_t *strOffsets = hashes + names.size() * 4;
+  uint8_t *entryOffsets = strOffsets + names.size() * 4;
+  uint8_t *pool = entryOffsets + names.size() * 4 + abbrevTable.size();
+  memcpy(entryOffsets + names.size() * 4, abbrevTable.data(),
+         abbrevTable.size());
+
+  parallelForEachN(0, names.size(), [&](size_t i) {
+    const OutputName &name = names[i];
+    write32(hashes + i * 4, name.name.hash());
+    write32(strOffsets + i * 4, name.strSec->getVA(name.strOffset));
+    write32(entryOffsets + i * 4, name.entryOffset);
+
+    // Write the entries of this name.
+    uint8_t *p = pool + name.entryOffset;
+    for (const IndexEntry *e : name.entries) {
+      p += encodeULEB128(abbrevCodes.lookup(e->tag << 1 | e->hasTypeHash), p);
+      write32(p, e->cuIndex);
+      write32(p + 4, e->dieOffset);
+      p += 8;
+      if (e->hasTypeHash) {
+        write64(p, e->typeHash);
+        p += 8;
+      }
+    }
+    *p = 0;
+  });
+}
+
 EhFrameHeader::EhFrameHeader()
     : SyntheticSection(SHF_ALLOC, SHT_PROGBITS, 4, ".eh_frame_hdr") {}
 
@@ -3197,33 +3517,89 @@ void MergeSyntheticSection::addSection(MergeInputSection *ms) {
   alignment = std::max(alignment, ms->alignment);
 }
 
-MergeTailSection::MergeTailSection(StringRef name, uint32_t type,
-                                   uint64_t flags, uint32_t alignment)
-    : MergeSyntheticSection(name, type, flags, alignment),
-      builder(StringTableBuilder::RAW, alignment) {}
-
-size_t MergeTailSection::getSize() const { return builder.getSize(); }
+// Each piece ends with an entSize-byte null terminator. The shard is chosen
+// by the two characters before it, or, for a one-character string, by that
+// character repeated. A one-character string is therefore only merged with
+// strings ending with the same two characters, which costs little because
+// such strings are rare. The empty string goes to the first shard.
+size_t MergeTailSection::getShardId(StringRef s, size_t entSize) {
+  size_t numChars = s.size() / entSize - 1;
+  if (numChars == 0)
+    return 0;
+  StringRef last = s.drop_back(entSize).take_back(entSize);
+  StringRef prev = last;
+  if (numChars > 1)
+    prev = s.drop_back(entSize * 2).take_back(entSize);
+  uint64_t hash = hash_combine(hash_value(prev), hash_value(last));
+  return hash % numShards;
+}
 
-void MergeTailSection::writeTo(uint8_t *buf) { builder.write(buf); }
+void MergeTailSection::writeTo(uint8_t *buf) {
+  parallelForEachN(0, numShards,
+                   [&](size_t i) { shards[i].write(buf + shardOffsets[i]); });
+}
 
+// Tail merging sorts all strings by their reversed contents, which makes it
+// one of the slowest parts of linking programs with lots of debug info
+// (.debug_str is usually the largest SHF_STRINGS section). We split the
+// strings into shards whose tails can't be shared and merge each shard in
+// parallel. The output only depends on the number of shards, not on the
+// number of threads.
 void MergeTailSection::finalizeContents() {
-  // Add all string pieces to the string table builder to create section
-  // contents.
-  for (MergeInputSection *sec : sections)
+  // Initializes string table builders.
+  for (size_t i = 0; i < numShards; ++i)
+    shards.emplace_back(StringTableBuilder::RAW, alignment);
+
+  // Compute the shard of each piece. We reuse the outputOff field which is
+  // overwritten below.
+  parallelForEach(sections, [&](MergeInputSection *sec) {
     for (size_t i = 0, e = sec->pieces.size(); i != e; ++i)
       if (sec->pieces[i].live)
-        builder.add(sec->getData(i));
+        sec->pieces[i].outputOff = getShardId(sec->getData(i).val(),
+                                              sec->entsize);
+  });
+
+  // Add section pieces to the builders. As in MergeNoTailSection, each
+  // thread owns a fixed subset of the shards.
+  size_t concurrency = PowerOf2Floor(
+      std::min<size_t>(hardware_concurrency(parallel::strategy.ThreadsRequested)
+                           .compute_thread_count(),
+                       numShards));
+  parallelForEachN(0, concurrency, [&](size_t threadId) {
+    for (MergeInputSection *sec : sections) {
+      for (size_t i = 0, e = sec->pieces.size(); i != e; ++i) {
+        size_t shardId = sec->pieces[i].outputOff;
+        if (sec->pieces[i].live && (shardId & (concurrency - 1)) == threadId)
+          shards[shardId].add(sec->getData(i));
+      }
+    }
+  });
 
-  // Fix the string table content. After this, the contents will never change.
-  builder.finalize();
+  // Fix the string table contents. After this, the contents will never
+  // change.
+  parallelForEachN(0, numShards, [&](size_t i) { shards[i].finalize(); });
+
+  // Compute an in-section offset for each shard.
+  size_t off = 0;
+  for (size_t i = 0; i < numShards; ++i) {
+    if (shards[i].getSize() > 0)
+      off = alignTo(off, alignment);
+    shardOffsets[i] = off;
+    off += shards[i].getSize();
+  }
+  size = off;
 
   // finalize() fixed tail-optimized strings, so we can now get
   // offsets of strings. Get an offset for each string and save it
   // to a corresponding SectionPiece for easy access.
-  for (MergeInputSection *sec : sections)
-    for (size_t i = 0, e = sec->pieces.size(); i != e; ++i)
-      if (sec->pieces[i].live)
-        sec->pieces[i].outputOff = builder.getOffset(sec->getData(i));
+  parallelForEach(sections, [&](MergeInputSection *sec) {
+    for (size_t i = 0, e = sec->pieces.size(); i != e; ++i) {
+      SectionPiece &piece = sec->pieces[i];
+      if (piece.live)
+        piece.outputOff = shardOffsets[piece.outputOff] +
+                          shards[piece.outputOff].getOffset(sec->getData(i));
+    }
+  });
 }
 
 void MergeNoTailSection::writeTo(uint8_t *buf) {
@@ -3791,6 +4167,11 @@ template GdbIndexSection *GdbIndexSection::create<ELF32BE>();
 template GdbIndexSection *GdbIndexSection::create<ELF64LE>();
 template GdbIndexSection *GdbIndexSection::create<ELF64BE>();
 
+template DebugNamesSection *DebugNamesSection::create<ELF32LE>();
+template DebugNamesSection *DebugNamesSection::create<ELF32BE>();
+template DebugNamesSection *DebugNamesSection::create<ELF64LE>();
+template DebugNamesSection *DebugNamesSection::create<ELF64BE>();
+
 template void elf::splitSections<ELF32LE>();
 template void elf::splitSections<ELF32BE>();
 template void elf::splitSections<ELF64LE>();
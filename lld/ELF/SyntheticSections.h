@@ -789,6 +789,73 @@ private:
   size_t size;
 };
 
+// --debug-names option tells linker to merge the DWARF v5 .debug_names name
+// indexes of the input files into a single name index covering all compile
+// units, so that debuggers need to look up a name in only one hash table.
+class DebugNamesSection final : public SyntheticSection {
+public:
+  // A DIE with a given name.
+  struct IndexEntry {
+    uint64_t typeHash;
+    uint32_t cuIndex;
+    uint32_t dieOffset;
+    uint16_t tag;
+    bool hasTypeHash;
+  };
+
+  // A name of an input name index and the range of its entries.
+  struct NameData {
+    llvm::CachedHashStringRef name;
+    uint64_t strOffset;
+    uint32_t entriesBegin;
+    uint32_t entriesEnd;
+  };
+
+  // Each chunk contains the name indexes of a single object file.
+  struct Chunk {
+    InputSection *infoSec = nullptr;
+    InputSectionBase *strSec = nullptr;
+    std::vector<uint64_t> cuOffsets;
+    std::vector<NameData> names;
+    std::vector<IndexEntry> entries;
+  };
+
+  // A name of the output name index with the entries of all input files.
+  struct OutputName {
+    llvm::CachedHashStringRef name;
+    InputSectionBase *strSec;
+    uint64_t strOffset;
+    std::vector<const IndexEntry *> entries;
+    uint32_t entryOffset;
+  };
+
+  DebugNamesSection();
+  template <typename ELFT> static DebugNamesSection *create();
+  void writeTo(uint8_t *buf) override;
+  size_t getSize() const override { return size; }
+  bool isNeeded() const override { return !chunks.empty(); }
+
+private:
+  void initOutputSize();
+  size_t getEntrySize(const IndexEntry &e) const;
+
+  std::vector<Chunk> chunks;
+
+  // The number of compile units preceding each chunk.
+  std::vector<uint32_t> cuBases;
+  uint32_t numCus = 0;
+
+  std::vector<OutputName> names;
+  uint32_t bucketCount = 0;
+
+  // Abbreviation codes keyed by (tag << 1 | hasTypeHash).
+  llvm::DenseMap<uint32_t, uint32_t> abbrevCodes;
+  std::string abbrevTable;
+
+  size_t entryPoolSize = 0;
+  size_t size;
+};
+
 // --eh-frame-hdr option tells linker to construct a header for all the
 // .eh_frame sections. This header is placed to a section named .eh_frame_hdr
 // and also to a PT_GNU_EH_FRAME segment.
@@ -895,14 +962,26 @@ protected:
 class MergeTailSection final : public MergeSyntheticSection {
 public:
   MergeTailSection(StringRef name, uint32_t type, uint64_t flags,
-                   uint32_t alignment);
+                   uint32_t alignment)
+      : MergeSyntheticSection(name, type, flags, alignment) {}
 
-  size_t getSize() const override;
+  size_t getSize() const override { return size; }
   void writeTo(uint8_t *buf) override;
   void finalizeContents() override;
 
 private:
-  llvm::StringTableBuilder builder;
+  // A string can only be a suffix of another string if they end with the
+  // same characters, so we shard strings by their last two characters. Each
+  // shard can then be tail-merged independently of the others.
+  static size_t getShardId(StringRef s, size_t entSize);
+
+  // Section size
+  size_t size;
+
+  // String table contents
+  constexpr static size_t numShards = 32;
+  std::vector<llvm::StringTableBuilder> shards;
+  size_t shardOffsets[numShards];
 };
 
 class MergeNoTailSection final : public MergeSyntheticSection {
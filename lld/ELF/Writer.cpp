@@ -11,6 +11,7 @@
 #include "ARMErrataFix.h"
 #include "CallGraphSort.h"
 #include "Config.h"
+#include "Incremental.h"
 #include "LinkerScript.h"
 #include "MapFile.h"
 #include "OutputSections.h"
@@ -529,6 +530,8 @@ template <class ELFT> void elf::createSyntheticSections() {
 
   if (config->gdbIndex)
     add(GdbIndexSection::create<ELFT>());
+  if (config->debugNames)
+    add(DebugNamesSection::create<ELFT>());
 
   // We always need to add rel[a].plt to output if it has entries.
   // Even for static linking it can contain R_[*]_IRELATIVE relocations.
@@ -579,6 +582,19 @@ template <class ELFT> void elf::createSyntheticSections() {
     add(in.strTab);
 }
 
+// With --no-keep-memory, the contents and relocations of input sections are
+// dropped as soon as all output sections have been written, before the output
+// is hashed and committed. We can't drop them while writing because some
+// targets read other sections' contents or relocations when relaxing, e.g.
+// PPC64 TOC indirection and RISC-V PC-relative pairs.
+static void releaseInputMemory() {
+  llvm::TimeTraceScope timeScope("Release input memory");
+  parallelForEach(inputSections, [](InputSectionBase *s) {
+    if (s->file && s->file->kind() == InputFile::ObjKind)
+      s->releaseMemory();
+  });
+}
+
 // The main function of the writer.
 template <class ELFT> void Writer<ELFT>::run() {
   copyLocalSymbols();
@@ -653,6 +669,9 @@ template <class ELFT> void Writer<ELFT>::run() {
       writeSectionsBinary();
     }
 
+    if (config->noKeepMemory)
+      releaseInputMemory();
+
     // Backfill .note.gnu.build-id section content. This is done at last
     // because the content is usually a hash value of the entire output file.
     writeBuildId();
@@ -662,6 +681,9 @@ template <class ELFT> void Writer<ELFT>::run() {
     if (auto e = buffer->commit())
       error("failed to write to the output file: " + toString(std::move(e)));
   }
+
+  if (config->incremental && !errorCount())
+    writeIncrementalState();
 }
 
 template <class ELFT, class RelTy>
@@ -1312,15 +1334,11 @@ static void maybeShuffle(DenseMap<const InputSectionBase *, int> &order) {
 }
 
 // Builds section order for handling --symbol-ordering-file.
-static DenseMap<const InputSectionBase *, int> buildSectionOrder() {
+// Builds a map from sections to priorities, such that sections defining the
+// given symbols have negative priorities in the order of the symbols.
+static DenseMap<const InputSectionBase *, int>
+getOrderOfSymbols(ArrayRef<StringRef> symbols, StringRef fileKind) {
   DenseMap<const InputSectionBase *, int> sectionOrder;
-  // Use the rarely used option -call-graph-ordering-file to sort sections.
-  if (!config->callGraphProfile.empty())
-    return computeCallGraphProfileOrder();
-
-  if (config->symbolOrderingFile.empty())
-    return sectionOrder;
-
   struct SymbolOrderEntry {
     int priority;
     bool present;
@@ -1330,8 +1348,8 @@ static DenseMap<const InputSectionBase *, int> buildSectionOrder() {
   // appear in the symbol ordering file have the lowest priority 0.
   // All explicitly mentioned symbols have negative (higher) priorities.
   DenseMap<StringRef, SymbolOrderEntry> symbolOrder;
-  int priority = -config->symbolOrderingFile.size();
-  for (StringRef s : config->symbolOrderingFile)
+  int priority = -symbols.size();
+  for (StringRef s : symbols)
     symbolOrder.insert({s, {priority++, false}});
 
   // Build a map from sections to their priorities.
@@ -1368,11 +1386,54 @@ static DenseMap<const InputSectionBase *, int> buildSectionOrder() {
   if (config->warnSymbolOrdering)
     for (auto orderEntry : symbolOrder)
       if (!orderEntry.second.present)
-        warn("symbol ordering file: no such symbol: " + orderEntry.first);
+        warn(fileKind + ": no such symbol: " + orderEntry.first);
 
   return sectionOrder;
 }
 
+static DenseMap<const InputSectionBase *, int> buildSectionOrder() {
+  // Use the rarely used option -call-graph-ordering-file to sort sections.
+  if (!config->callGraphProfile.empty())
+    return computeCallGraphProfileOrder();
+
+  if (config->symbolOrderingFile.empty())
+    return {};
+  return getOrderOfSymbols(config->symbolOrderingFile, "symbol ordering file");
+}
+
+// Moves the sections touched at process startup, as given by
+// --startup-ordering-file, to the front of their input section descriptions
+// in the order they were first touched, so that starting the program faults
+// in as few pages as possible. The first of them is aligned to a page
+// boundary; packing the rest back to back then touches the fewest pages for
+// their total size.
+static void
+moveStartupSections(OutputSection *sec,
+                    const DenseMap<const InputSectionBase *, int> &startup) {
+  bool aligned = false;
+  for (BaseCommand *b : sec->sectionCommands) {
+    auto *isd = dyn_cast<InputSectionDescription>(b);
+    if (!isd)
+      continue;
+    auto mid = std::stable_partition(
+        isd->sections.begin(), isd->sections.end(),
+        [&](InputSection *isec) { return startup.count(isec); });
+    if (mid == isd->sections.begin())
+      continue;
+    std::stable_sort(isd->sections.begin(), mid,
+                     [&](InputSection *a, InputSection *b) {
+                       return startup.lookup(a) < startup.lookup(b);
+                     });
+    if (!aligned) {
+      InputSection *first = isd->sections.front();
+      first->alignment = std::max<uint32_t>(first->alignment,
+                                            config->commonPageSize);
+      sec->alignment = std::max(sec->alignment, first->alignment);
+      aligned = true;
+    }
+  }
+}
+
 // Sorts the sections in ISD according to the provided section order.
 static void
 sortISDBySectionOrder(InputSectionDescription *isd,
@@ -1438,8 +1499,10 @@ sortISDBySectionOrder(InputSectionDescription *isd,
     isd->sections.push_back(isec);
 }
 
-static void sortSection(OutputSection *sec,
-                        const DenseMap<const InputSectionBase *, int> &order) {
+static void
+sortSection(OutputSection *sec,
+            const DenseMap<const InputSectionBase *, int> &order,
+            const DenseMap<const InputSectionBase *, int> &startup) {
   StringRef name = sec->name;
 
   // Never sort these.
@@ -1463,6 +1526,12 @@ static void sortSection(OutputSection *sec,
       if (auto *isd = dyn_cast<InputSectionDescription>(b))
         sortISDBySectionOrder(isd, order);
 
+  // The order of these sections is significant, or constrained by the
+  // relocations referring to them.
+  if (!startup.empty() && name != ".init_array" && name != ".fini_array" &&
+      name != ".ctors" && name != ".dtors" && name != ".toc")
+    moveStartupSections(sec, startup);
+
   // Sort input sections by section name suffixes for
   // __attribute__((init_priority(N))).
   if (name == ".init_array" || name == ".fini_array") {
@@ -1503,9 +1572,13 @@ template <class ELFT> void Writer<ELFT>::sortInputSections() {
   // Build the order once since it is expensive.
   DenseMap<const InputSectionBase *, int> order = buildSectionOrder();
   maybeShuffle(order);
+  DenseMap<const InputSectionBase *, int> startup;
+  if (!config->startupOrderingFile.empty())
+    startup = getOrderOfSymbols(config->startupOrderingFile,
+                                "startup ordering file");
   for (BaseCommand *base : script->sectionCommands)
     if (auto *sec = dyn_cast<OutputSection>(base))
-      sortSection(sec, order);
+      sortSection(sec, order, startup);
 }
 
 template <class ELFT> void Writer<ELFT>::sortSections() {
@@ -1978,7 +2051,9 @@ template <class ELFT> void Writer<ELFT>::finalizeSections() {
     // a linker-script-defined symbol is absolute.
     ppc64noTocRelax.clear();
     if (!config->relocatable) {
-      forEachRelSec(scanRelocations<ELFT>);
+      std::vector<InputSectionBase *> relSecs;
+      forEachRelSec([&](InputSectionBase &sec) { relSecs.push_back(&sec); });
+      scanRelocations<ELFT>(relSecs);
       reportUndefinedSymbols<ELFT>();
     }
   }
@@ -2877,12 +2952,17 @@ template <class ELFT> void Writer<ELFT>::openFile() {
     return;
   }
 
-  unlinkAsync(config->outputFile);
   unsigned flags = 0;
+  if (config->incremental && canPatchOutput(fileSize))
+    flags |= FileOutputBuffer::F_modify;
+  else
+    unlinkAsync(config->outputFile);
   if (!config->relocatable)
     flags |= FileOutputBuffer::F_executable;
   if (!config->mmapOutputFile)
     flags |= FileOutputBuffer::F_no_mmap;
+  if (config->directOutput)
+    flags |= FileOutputBuffer::F_direct;
   Expected<std::unique_ptr<FileOutputBuffer>> bufferOrErr =
       FileOutputBuffer::create(config->outputFile, fileSize, flags);
 
@@ -2945,9 +3025,28 @@ template <class ELFT> void Writer<ELFT>::writeSections() {
     if (sec->type == SHT_REL || sec->type == SHT_RELA)
       sec->writeTo<ELFT>(Out::bufferStart + sec->offset);
 
+  // Sections are final once written, except those holding a build ID, which
+  // is only filled in at the end. Let the buffer write the others to the file
+  // while the next ones are being written.
+  auto isFinal = [](OutputSection *sec) {
+    if (sec->type == SHT_NOBITS)
+      return false;
+    for (Partition &part : partitions)
+      if (part.buildId && part.buildId->getParent() == sec)
+        return false;
+    return true;
+  };
   for (OutputSection *sec : outputSections)
-    if (sec->type != SHT_REL && sec->type != SHT_RELA)
-      sec->writeTo<ELFT>(Out::bufferStart + sec->offset);
+    if ((sec->type == SHT_REL || sec->type == SHT_RELA) && isFinal(sec))
+      buffer->writeback(sec->offset, sec->size);
+
+  for (OutputSection *sec : outputSections) {
+    if (sec->type == SHT_REL || sec->type == SHT_RELA)
+      continue;
+    sec->writeTo<ELFT>(Out::bufferStart + sec->offset);
+    if (isFinal(sec))
+      buffer->writeback(sec->offset, sec->size);
+  }
 }
 
 // Split one uint8 array into small pieces of uint8 arrays.
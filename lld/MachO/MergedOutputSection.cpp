@@ -10,6 +10,7 @@
 #include "lld/Common/ErrorHandler.h"
 #include "lld/Common/Memory.h"
 #include "llvm/BinaryFormat/MachO.h"
+#include "llvm/Support/Parallel.h"
 
 using namespace llvm;
 using namespace llvm::MachO;
@@ -45,9 +46,9 @@ void MergedOutputSection::finalize() {
 }
 
 void MergedOutputSection::writeTo(uint8_t *buf) const {
-  for (InputSection *isec : inputs) {
+  parallelForEach(inputs, [&](InputSection *isec) {
     isec->writeTo(buf + isec->outSecFileOff);
-  }
+  });
 }
 
 // TODO: this is most likely wrong; reconsider how section flags
@@ -23,6 +23,7 @@
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/LEB128.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 
 using namespace llvm;
@@ -710,6 +711,15 @@ void SymtabSection::finalizeContents() {
     }
   }
 
+  // Like ld64, emit external and undefined symbols sorted by name. Names are
+  // unique among these symbols, so the order doesn't depend on the order in
+  // which symbols were inserted into the symbol table.
+  auto cmp = [](const SymtabEntry &a, const SymtabEntry &b) {
+    return a.sym->getName() < b.sym->getName();
+  };
+  parallelSort(externalSymbols, cmp);
+  parallelSort(undefinedSymbols, cmp);
+
   emitStabs();
   uint32_t symtabIndex = stabs.size();
   for (const SymtabEntry &entry :
@@ -25,6 +25,7 @@
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/xxhash.h"
 
@@ -679,14 +680,30 @@ void Writer::openFile() {
 
 void Writer::writeSections() {
   uint8_t *buf = buffer->getBufferStart();
+  std::vector<OutputSection *> osecs;
   for (OutputSegment *seg : outputSegments)
-    for (OutputSection *osec : seg->getSections())
-      osec->writeTo(buf + osec->fileOff);
+    append_range(osecs, seg->getSections());
+
+  parallelForEach(osecs, [&](OutputSection *osec) {
+    osec->writeTo(buf + osec->fileOff);
+  });
 }
 
+// Computes the UUID digest of the output. To utilize multiple cores, we split
+// the file into 1 MiB chunks, hash each chunk in parallel and then hash the
+// concatenation of those hashes, as ELF does for --build-id=fast.
 void Writer::writeUuid() {
-  uint64_t digest =
-      xxHash64({buffer->getBufferStart(), buffer->getBufferEnd()});
+  ArrayRef<uint8_t> data{buffer->getBufferStart(), buffer->getBufferEnd()};
+  const size_t chunkSize = 1024 * 1024;
+  size_t numChunks = divideCeil(data.size(), chunkSize);
+  std::vector<uint64_t> hashes(numChunks);
+
+  parallelForEachN(0, numChunks, [&](size_t i) {
+    hashes[i] = xxHash64(data.slice(i * chunkSize).take_front(chunkSize));
+  });
+
+  uint64_t digest = xxHash64({reinterpret_cast<const uint8_t *>(hashes.data()),
+                              hashes.size() * sizeof(uint64_t)});
   uuidCommand->writeUuid(digest);
 }
 
@@ -59,6 +59,7 @@ public:
   bool SetClangModulesCachePath(const FileSpec &path);
   bool GetEnableExternalLookup() const;
   bool SetEnableExternalLookup(bool new_value);
+  bool GetLoadSymbolOnDemand() const;
 
   PathMappingList GetSymlinkMappings() const;
 };
@@ -108,6 +108,14 @@ public:
 
   virtual uint32_t CalculateAbilities() = 0;
 
+  /// Return the symbol file doing the actual work of this symbol file. This
+  /// is the object itself, except for wrappers like SymbolFileOnDemand.
+  virtual SymbolFile *GetBackingSymbolFile() { return this; }
+
+  /// Request the debug info of the module to be loaded. This is a no-op for
+  /// symbol files that don't load their debug info on demand.
+  virtual void SetLoadDebugInfoEnabled() {}
+
   /// Symbols file subclasses should override this to return the Module that
   /// owns the TypeSystem that this symbol file modifies type information in.
   virtual std::recursive_mutex &GetModuleMutex() const;
@@ -0,0 +1,212 @@
+//===-- SymbolFileOnDemand.h ------------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLDB_SYMBOL_SYMBOLFILEONDEMAND_H
+#define LLDB_SYMBOL_SYMBOLFILEONDEMAND_H
+
+#include <mutex>
+
+#include "lldb/Symbol/SymbolFile.h"
+#include "lldb/lldb-private.h"
+
+namespace lldb_private {
+
+/// SymbolFileOnDemand wraps an actual SymbolFile and only forwards the
+/// module wide debug info queries (name lookups, address and file/line
+/// resolution, type enumeration) to it once the debug info of the module has
+/// been enabled. This allows lldb to only pay for indexing the debug info of
+/// the modules that end up mattering to a debug session.
+///
+/// The debug info is enabled by calling SetLoadDebugInfoEnabled(), which is
+/// done when a stack frame resolves to the module, and by the wrapper itself
+/// when a file/line lookup matches one of the module's compile units or a
+/// function or global variable lookup matches the module's symbol table.
+///
+/// Queries made through objects that can only be obtained from the backing
+/// symbol file (compile units, functions, types, ...) are always forwarded.
+class SymbolFileOnDemand : public lldb_private::SymbolFile {
+  /// LLVM RTTI support.
+  static char ID;
+
+public:
+  /// LLVM RTTI support.
+  /// \{
+  bool isA(const void *ClassID) const override {
+    return ClassID == &ID || SymbolFile::isA(ClassID);
+  }
+  static bool classof(const SymbolFile *obj) { return obj->isA(&ID); }
+  /// \}
+
+  SymbolFileOnDemand(std::unique_ptr<SymbolFile> &&symbol_file);
+  ~SymbolFileOnDemand() override;
+
+  // PluginInterface protocol
+  ConstString GetPluginName() override;
+
+  uint32_t GetPluginVersion() override;
+
+  // SymbolFile protocol
+  SymbolFile *GetBackingSymbolFile() override { return m_sym_file_impl.get(); }
+
+  void SetLoadDebugInfoEnabled() override;
+
+  bool IsDebugInfoEnabled() const { return m_debug_info_enabled; }
+
+  uint32_t CalculateAbilities() override;
+
+  std::recursive_mutex &GetModuleMutex() const override;
+
+  void InitializeObject() override;
+
+  lldb::LanguageType ParseLanguage(CompileUnit &comp_unit) override;
+
+  XcodeSDK ParseXcodeSDK(CompileUnit &comp_unit) override;
+
+  size_t ParseFunctions(CompileUnit &comp_unit) override;
+
+  bool ParseLineTable(CompileUnit &comp_unit) override;
+
+  bool ParseDebugMacros(CompileUnit &comp_unit) override;
+
+  bool ForEachExternalModule(
+      CompileUnit &comp_unit,
+      llvm::DenseSet<lldb_private::SymbolFile *> &visited_symbol_files,
+      llvm::function_ref<bool(Module &)> lambda) override;
+
+  bool ParseSupportFiles(CompileUnit &comp_unit,
+                         FileSpecList &support_files) override;
+
+  bool ParseIsOptimized(CompileUnit &comp_unit) override;
+
+  size_t ParseTypes(CompileUnit &comp_unit) override;
+
+  bool ParseImportedModules(
+      const SymbolContext &sc,
+      std::vector<SourceModule> &imported_modules) override;
+
+  size_t ParseBlocksRecursive(Function &func) override;
+
+  size_t ParseVariablesForContext(const SymbolContext &sc) override;
+
+  Type *ResolveTypeUID(lldb::user_id_t type_uid) override;
+
+  llvm::Optional<ArrayInfo>
+  GetDynamicArrayInfoForUID(lldb::user_id_t type_uid,
+                            const ExecutionContext *exe_ctx) override;
+
+  bool CompleteType(CompilerType &compiler_type) override;
+
+  CompilerDecl GetDeclForUID(lldb::user_id_t uid) override;
+
+  CompilerDeclContext GetDeclContextForUID(lldb::user_id_t uid) override;
+
+  CompilerDeclContext GetDeclContextContainingUID(lldb::user_id_t uid) override;
+
+  void ParseDeclsForContext(CompilerDeclContext decl_ctx) override;
+
+  uint32_t ResolveSymbolContext(const Address &so_addr,
+                                lldb::SymbolContextItem resolve_scope,
+                                SymbolContext &sc) override;
+
+  uint32_t ResolveSymbolContext(const FileSpec &file_spec, uint32_t line,
+                                bool check_inlines,
+                                lldb::SymbolContextItem resolve_scope,
+                                SymbolContextList &sc_list) override;
+
+  void DumpClangAST(Stream &s) override;
+
+  void FindGlobalVariables(ConstString name,
+                           const CompilerDeclContext &parent_decl_ctx,
+                           uint32_t max_matches,
+                           VariableList &variables) override;
+
+  void FindGlobalVariables(const RegularExpression &regex,
+                           uint32_t max_matches,
+                           VariableList &variables) override;
+
+  void FindFunctions(ConstString name,
+                     const CompilerDeclContext &parent_decl_ctx,
+                     lldb::FunctionNameType name_type_mask,
+                     bool include_inlines, SymbolContextList &sc_list) override;
+
+  void FindFunctions(const RegularExpression &regex, bool include_inlines,
+                     SymbolContextList &sc_list) override;
+
+  void FindTypes(
+      ConstString name, const CompilerDeclContext &parent_decl_ctx,
+      uint32_t max_matches,
+      llvm::DenseSet<lldb_private::SymbolFile *> &searched_symbol_files,
+      TypeMap &types) override;
+
+  void FindTypes(llvm::ArrayRef<CompilerContext> pattern,
+                 LanguageSet languages,
+                 llvm::DenseSet<SymbolFile *> &searched_symbol_files,
+                 TypeMap &types) override;
+
+  void GetMangledNamesForFunction(
+      const std::string &scope_qualified_name,
+      std::vector<ConstString> &mangled_names) override;
+
+  void GetTypes(lldb_private::SymbolContextScope *sc_scope,
+                lldb::TypeClass type_mask,
+                lldb_private::TypeList &type_list) override;
+
+  void PreloadSymbols() override;
+
+  llvm::Expected<lldb_private::TypeSystem &>
+  GetTypeSystemForLanguage(lldb::LanguageType language) override;
+
+  CompilerDeclContext
+  FindNamespace(ConstString name,
+                const CompilerDeclContext &parent_decl_ctx) override;
+
+  std::vector<std::unique_ptr<CallEdge>>
+  ParseCallEdgesInFunction(UserID func_id) override;
+
+  void AddSymbols(Symtab &symtab) override;
+
+  void SectionFileAddressesChanged() override;
+
+  lldb::UnwindPlanSP
+  GetUnwindPlan(const Address &address,
+                const RegisterInfoResolver &resolver) override;
+
+  llvm::Expected<lldb::addr_t> GetParameterStackSize(Symbol &symbol) override;
+
+  void Dump(Stream &s) override;
+
+protected:
+  uint32_t CalculateNumCompileUnits() override;
+
+  lldb::CompUnitSP ParseCompileUnitAtIndex(uint32_t idx) override;
+
+private:
+  /// Returns true if a query for \p name_for_log should be forwarded to the
+  /// backing symbol file, logging that the query was skipped otherwise.
+  bool ShouldForward(llvm::StringRef name_for_log);
+
+  /// Returns true if one of the compile units of the module was built from
+  /// \p file_spec or includes it.
+  bool HasCompileUnitForFile(const FileSpec &file_spec);
+
+  /// The name of the module's file, used in log messages.
+  ConstString GetSymbolFileName();
+
+  std::unique_ptr<SymbolFile> m_sym_file_impl;
+  bool m_debug_info_enabled = false;
+  /// Set when PreloadSymbols() was requested before the debug info was
+  /// enabled.
+  bool m_preload_symbols = false;
+
+  SymbolFileOnDemand(const SymbolFileOnDemand &) = delete;
+  const SymbolFileOnDemand &operator=(const SymbolFileOnDemand &) = delete;
+};
+
+} // namespace lldb_private
+
+#endif // LLDB_SYMBOL_SYMBOLFILEONDEMAND_H
@@ -57,8 +57,19 @@ protected:
   InvalidRanges m_invalid_ranges;
   Process &m_process;
   uint32_t m_L2_cache_line_byte_size;
+  /// Number of lines read ahead of the last line a read needs.
+  uint32_t m_L2_read_ahead_lines;
 
 private:
+  /// Read the missing L2 cache line at \p addr into the cache, along with
+  /// the lines covering the rest of the \p byte_size bytes at \p addr and
+  /// the read-ahead lines that aren't cached yet.
+  ///
+  /// \return
+  ///     The number of bytes read for the line at \p addr, zero if it
+  ///     couldn't be read in which case \p error is set.
+  size_t FetchL2CacheLines(lldb::addr_t addr, size_t byte_size, Status &error);
+
   MemoryCache(const MemoryCache &) = delete;
   const MemoryCache &operator=(const MemoryCache &) = delete;
 };
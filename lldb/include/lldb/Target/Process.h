@@ -75,6 +75,7 @@ public:
 
   bool GetDisableMemoryCache() const;
   uint64_t GetMemoryCacheLineSize() const;
+  uint64_t GetMemoryCacheReadAhead() const;
   Args GetExtraStartupCommands() const;
   void SetExtraStartupCommands(const Args &args);
   FileSpec GetPythonOSPluginPath() const;
@@ -1443,6 +1444,32 @@ public:
   virtual size_t DoReadMemory(lldb::addr_t vm_addr, void *buf, size_t size,
                               Status &error) = 0;
 
+  /// A range of memory to read with ReadMemoryRangesFromInferior().
+  struct MemoryRangeRead {
+    MemoryRangeRead(lldb::addr_t addr, void *buf, size_t size)
+        : addr(addr), buf(buf), size(size) {}
+
+    lldb::addr_t addr;
+    /// A byte buffer that is at least \a size bytes long.
+    void *buf;
+    size_t size;
+    /// The number of bytes that were actually read into \a buf.
+    size_t bytes_read = 0;
+    Status error;
+  };
+
+  /// Actually do the reading of several ranges of memory from a process.
+  ///
+  /// Subclasses that can read several ranges with a single request to the
+  /// process should override this function. The default implementation
+  /// reads the ranges one after the other with DoReadMemory().
+  ///
+  /// \param[in,out] ranges
+  ///     The ranges to read. The bytes_read and error fields of each range
+  ///     are filled in.
+  virtual void
+  DoReadMemoryRanges(llvm::MutableArrayRef<MemoryRangeRead> ranges);
+
   /// Read of memory from a process.
   ///
   /// This function will read memory from the current process's address space
@@ -1509,6 +1536,17 @@ public:
   size_t ReadMemoryFromInferior(lldb::addr_t vm_addr, void *buf, size_t size,
                                 Status &error);
 
+  /// Read several ranges of memory from a process, bypassing caching.
+  ///
+  /// This has the semantics of ReadMemoryFromInferior() for each of the
+  /// ranges, but lets the process plug-in fetch them all at once.
+  ///
+  /// \param[in,out] ranges
+  ///     The ranges to read. The bytes_read and error fields of each range
+  ///     are filled in.
+  void ReadMemoryRangesFromInferior(
+      llvm::MutableArrayRef<MemoryRangeRead> ranges);
+
   /// Read a NULL terminated string from memory
   ///
   /// This function will read a cache page at a time until a NULL string
@@ -128,6 +128,7 @@ public:
 
     eServerPacketType_jSignalsInfo,
     eServerPacketType_jModulesInfo,
+    eServerPacketType_jMultiMemRead,
 
     eServerPacketType_vAttach,
     eServerPacketType_vAttachWait,
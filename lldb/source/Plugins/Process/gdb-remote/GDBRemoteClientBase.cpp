@@ -169,6 +169,51 @@ GDBRemoteClientBase::SendPacketAndWaitForResponse(
   return SendPacketAndWaitForResponseNoLock(payload, response);
 }
 
+GDBRemoteCommunication::PacketResult
+GDBRemoteClientBase::SendPacketsAndWaitForResponses(
+    llvm::ArrayRef<std::string> payloads,
+    llvm::MutableArrayRef<StringExtractorGDBRemote> responses,
+    bool send_async) {
+  assert(payloads.size() == responses.size());
+  Lock lock(*this, send_async);
+  if (!lock) {
+    if (Log *log =
+            ProcessGDBRemoteLog::GetLogIfAllCategoriesSet(GDBR_LOG_PROCESS))
+      LLDB_LOGF(log,
+                "GDBRemoteClientBase::%s failed to get mutex, not sending "
+                "%zu packets (send_async=%d)",
+                __FUNCTION__, payloads.size(), send_async);
+    return PacketResult::ErrorSendFailed;
+  }
+
+  // Each packet has to be acknowledged before the next one can be sent.
+  if (GetSendAcks()) {
+    for (size_t i = 0; i < payloads.size(); ++i) {
+      PacketResult packet_result =
+          SendPacketAndWaitForResponseNoLock(payloads[i], responses[i]);
+      if (packet_result != PacketResult::Success)
+        return packet_result;
+    }
+    return PacketResult::Success;
+  }
+
+  for (const std::string &payload : payloads) {
+    PacketResult packet_result = SendPacketNoLock(payload);
+    if (packet_result != PacketResult::Success)
+      return packet_result;
+  }
+  // The responses come back in order. Unlike a single packet, a response
+  // that fails validation can't be skipped without losing track of which
+  // packet the following responses belong to.
+  for (StringExtractorGDBRemote &response : responses) {
+    PacketResult packet_result =
+        ReadPacket(response, GetPacketTimeout(), true);
+    if (packet_result != PacketResult::Success)
+      return packet_result;
+  }
+  return PacketResult::Success;
+}
+
 GDBRemoteCommunication::PacketResult
 GDBRemoteClientBase::SendPacketAndReceiveResponseWithOutputSupport(
     llvm::StringRef payload, StringExtractorGDBRemote &response,
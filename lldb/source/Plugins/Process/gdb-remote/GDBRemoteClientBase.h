@@ -45,6 +45,16 @@ public:
                                             StringExtractorGDBRemote &response,
                                             bool send_async);
 
+  /// Send all of \p payloads and receive their responses into \p responses,
+  /// which must have the same size. Once acknowledgments are disabled, the
+  /// packets are all written before the first response is read, so the whole
+  /// batch costs a single round trip.
+  PacketResult
+  SendPacketsAndWaitForResponses(llvm::ArrayRef<std::string> payloads,
+                                 llvm::MutableArrayRef<StringExtractorGDBRemote>
+                                     responses,
+                                 bool send_async);
+
   PacketResult SendPacketAndReceiveResponseWithOutputSupport(
       llvm::StringRef payload, StringExtractorGDBRemote &response,
       bool send_async,
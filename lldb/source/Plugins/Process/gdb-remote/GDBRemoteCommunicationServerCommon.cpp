@@ -838,20 +838,25 @@ GDBRemoteCommunicationServerCommon::Handle_qSupported(
                                          // size--debugger can always use less
   response.Printf("PacketSize=%x", max_packet_size);
 
-  response.PutCString(";QStartNoAckMode+");
-  response.PutCString(";QThreadSuffixSupported+");
-  response.PutCString(";QListThreadsInStopReply+");
-  response.PutCString(";qEcho+");
-  response.PutCString(";qXfer:features:read+");
-#if defined(__linux__) || defined(__NetBSD__) || defined(__FreeBSD__)
-  response.PutCString(";QPassSignals+");
-  response.PutCString(";qXfer:auxv:read+");
-  response.PutCString(";qXfer:libraries-svr4:read+");
-#endif
+  for (const std::string &feature : GetSupportedFeatures())
+    response.Printf(";%s", feature.c_str());
 
   return SendPacketNoLock(response.GetString());
 }
 
+std::vector<std::string>
+GDBRemoteCommunicationServerCommon::GetSupportedFeatures() {
+  std::vector<std::string> features = {
+      "QStartNoAckMode+", "QThreadSuffixSupported+",
+      "QListThreadsInStopReply+", "qEcho+", "qXfer:features:read+"};
+#if defined(__linux__) || defined(__NetBSD__) || defined(__FreeBSD__)
+  features.push_back("QPassSignals+");
+  features.push_back("qXfer:auxv:read+");
+  features.push_back("qXfer:libraries-svr4:read+");
+#endif
+  return features;
+}
+
 GDBRemoteCommunication::PacketResult
 GDBRemoteCommunicationServerCommon::Handle_QThreadSuffixSupported(
     StringExtractorGDBRemote &packet) {
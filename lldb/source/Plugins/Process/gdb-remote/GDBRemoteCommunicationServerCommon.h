@@ -145,6 +145,10 @@ protected:
   virtual FileSpec FindModuleFile(const std::string &module_path,
                                   const ArchSpec &arch);
 
+  /// Return the features to advertise in the qSupported response, after the
+  /// PacketSize.
+  virtual std::vector<std::string> GetSupportedFeatures();
+
 private:
   ModuleSpec GetModuleInfo(llvm::StringRef module_path, llvm::StringRef triple);
 };
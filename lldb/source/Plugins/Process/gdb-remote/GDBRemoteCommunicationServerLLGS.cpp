@@ -145,6 +145,9 @@ void GDBRemoteCommunicationServerLLGS::RegisterPacketHandlers() {
   RegisterMemberFunctionHandler(
       StringExtractorGDBRemote::eServerPacketType_jThreadsInfo,
       &GDBRemoteCommunicationServerLLGS::Handle_jThreadsInfo);
+  RegisterMemberFunctionHandler(
+      StringExtractorGDBRemote::eServerPacketType_jMultiMemRead,
+      &GDBRemoteCommunicationServerLLGS::Handle_jMultiMemRead);
   RegisterMemberFunctionHandler(
       StringExtractorGDBRemote::eServerPacketType_qWatchpointSupportInfo,
       &GDBRemoteCommunicationServerLLGS::Handle_qWatchpointSupportInfo);
@@ -2321,6 +2324,73 @@ GDBRemoteCommunicationServerLLGS::Handle_memory_read(
   return SendPacketNoLock(response.GetString());
 }
 
+GDBRemoteCommunication::PacketResult
+GDBRemoteCommunicationServerLLGS::Handle_jMultiMemRead(
+    StringExtractorGDBRemote &packet) {
+  Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS));
+
+  if (!m_debugged_process_up ||
+      (m_debugged_process_up->GetID() == LLDB_INVALID_PROCESS_ID)) {
+    LLDB_LOGF(
+        log,
+        "GDBRemoteCommunicationServerLLGS::%s failed, no process available",
+        __FUNCTION__);
+    return SendErrorResponse(0x15);
+  }
+
+  // The packet is "jMultiMemRead:<addr>,<length>[;<addr>,<length>]*" and
+  // gets a "<bytes read>[,<bytes read>]*;<binary data>" reply holding the
+  // data of all the ranges back to back. A range that can't be read at all
+  // reports zero bytes instead of failing the whole packet.
+  packet.SetFilePos(strlen("jMultiMemRead:"));
+  std::vector<std::pair<lldb::addr_t, uint64_t>> ranges;
+  uint64_t total_size = 0;
+  while (packet.GetBytesLeft() > 0) {
+    const lldb::addr_t addr = packet.GetHexMaxU64(false, LLDB_INVALID_ADDRESS);
+    if (addr == LLDB_INVALID_ADDRESS || packet.GetChar() != ',')
+      return SendIllFormedResponse(packet, "Malformed jMultiMemRead range");
+    const uint64_t length = packet.GetHexMaxU64(false, UINT64_MAX);
+    if (length == UINT64_MAX)
+      return SendIllFormedResponse(packet, "Malformed jMultiMemRead length");
+    total_size += length;
+    ranges.emplace_back(addr, length);
+    if (packet.GetBytesLeft() > 0 && packet.GetChar() != ';')
+      return SendIllFormedResponse(packet, "Semicolon sep missing");
+  }
+  if (ranges.empty())
+    return SendIllFormedResponse(packet, "No range in jMultiMemRead packet");
+  // Stay within the PacketSize we advertise in qSupported.
+  if (total_size > 128 * 1024)
+    return SendErrorResponse(0x78);
+
+  std::string buf(total_size, '\0');
+  std::vector<size_t> bytes_read(ranges.size(), 0);
+  size_t buf_offset = 0;
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    const uint64_t length = ranges[i].second;
+    if (length == 0)
+      continue;
+    Status error = m_debugged_process_up->ReadMemoryWithoutTrap(
+        ranges[i].first, &buf[buf_offset], length, bytes_read[i]);
+    if (error.Fail()) {
+      LLDB_LOGF(log,
+                "GDBRemoteCommunicationServerLLGS::%s pid %" PRIu64
+                " mem 0x%" PRIx64 ": failed to read. Error: %s",
+                __FUNCTION__, m_debugged_process_up->GetID(), ranges[i].first,
+                error.AsCString());
+      bytes_read[i] = 0;
+    }
+    buf_offset += bytes_read[i];
+  }
+
+  StreamGDBRemote response;
+  for (size_t i = 0; i < bytes_read.size(); ++i)
+    response.Printf("%s%" PRIx64, i ? "," : "", (uint64_t)bytes_read[i]);
+  response.PutChar(';');
+  response.PutEscapedBytes(buf.data(), buf_offset);
+  return SendPacketNoLock(response.GetString());
+}
+
 GDBRemoteCommunication::PacketResult
 GDBRemoteCommunicationServerLLGS::Handle__M(StringExtractorGDBRemote &packet) {
   Log *log(GetLogIfAnyCategoriesSet(LIBLLDB_LOG_PROCESS));
@@ -3469,6 +3539,14 @@ void GDBRemoteCommunicationServerLLGS::ClearProcessSpecificData() {
   m_xfer_buffer_map.clear();
 }
 
+std::vector<std::string>
+GDBRemoteCommunicationServerLLGS::GetSupportedFeatures() {
+  std::vector<std::string> features =
+      GDBRemoteCommunicationServerCommon::GetSupportedFeatures();
+  features.push_back("jMultiMemRead+");
+  return features;
+}
+
 FileSpec
 GDBRemoteCommunicationServerLLGS::FindModuleFile(const std::string &module_path,
                                                  const ArchSpec &arch) {
@@ -2686,6 +2686,42 @@ void ProcessGDBRemote::WillPublicStop() {
 }
 
 // Process Memory
+// Extract the memory read for an "x" or "m" packet from its response.
+static size_t ExtractMemoryReadResponse(StringExtractorGDBRemote &response,
+                                        bool binary_memory_read, addr_t addr,
+                                        void *buf, size_t size,
+                                        llvm::StringRef packet, Status &error) {
+  if (response.IsNormalResponse()) {
+    error.Clear();
+    if (binary_memory_read) {
+      // The lower level GDBRemoteCommunication packet receive layer has
+      // already de-quoted any 0x7d character escaping that was present in
+      // the packet
+
+      size_t data_received_size = response.GetBytesLeft();
+      if (data_received_size > size) {
+        // Don't write past the end of BUF if the remote debug server gave us
+        // too much data for some reason.
+        data_received_size = size;
+      }
+      memcpy(buf, response.GetStringRef().data(), data_received_size);
+      return data_received_size;
+    } else {
+      return response.GetHexBytes(
+          llvm::MutableArrayRef<uint8_t>((uint8_t *)buf, size), '\xdd');
+    }
+  } else if (response.IsErrorResponse())
+    error.SetErrorStringWithFormat("memory read failed for 0x%" PRIx64, addr);
+  else if (response.IsUnsupportedResponse())
+    error.SetErrorStringWithFormat(
+        "GDB server does not support reading memory");
+  else
+    error.SetErrorStringWithFormat(
+        "unexpected response to GDB server memory read packet '%s': '%s'",
+        packet.str().c_str(), response.GetStringRef().data());
+  return 0;
+}
+
 size_t ProcessGDBRemote::DoReadMemory(addr_t addr, void *buf, size_t size,
                                       Status &error) {
   GetMaxMemorySize();
@@ -2709,39 +2745,112 @@ size_t ProcessGDBRemote::DoReadMemory(addr_t addr, void *buf, size_t size,
   UNUSED_IF_ASSERT_DISABLED(packet_len);
   StringExtractorGDBRemote response;
   if (m_gdb_comm.SendPacketAndWaitForResponse(packet, response, true) ==
+      GDBRemoteCommunication::PacketResult::Success)
+    return ExtractMemoryReadResponse(response, binary_memory_read, addr, buf,
+                                     size, packet, error);
+  error.SetErrorStringWithFormat("failed to send packet: '%s'", packet);
+  return 0;
+}
+
+void ProcessGDBRemote::DoReadMemoryRanges(
+    llvm::MutableArrayRef<MemoryRangeRead> ranges) {
+  GetMaxMemorySize();
+  const bool multi_mem_read = m_gdb_comm.GetMultiMemReadSupported();
+  const bool binary_memory_read = m_gdb_comm.GetxPacketSupported();
+  const size_t max_memory_size =
+      binary_memory_read ? m_max_memory_size : m_max_memory_size / 2;
+
+  // Ranges too large for a single packet take the regular path, which breaks
+  // them up.
+  std::vector<MemoryRangeRead *> batched_ranges;
+  for (MemoryRangeRead &range : ranges) {
+    if (range.size > max_memory_size || range.size == 0)
+      Process::DoReadMemoryRanges(range);
+    else
+      batched_ranges.push_back(&range);
+  }
+  if (batched_ranges.empty())
+    return;
+
+  // With jMultiMemRead, each packet carries as many ranges as fit in the
+  // maximum memory read size. Otherwise each range gets its own memory read
+  // packet. Either way, all the packets are pipelined.
+  std::vector<std::string> packets;
+  std::vector<std::pair<size_t, size_t>> packet_ranges;
+  size_t packet_size = 0;
+  for (size_t i = 0; i < batched_ranges.size(); ++i) {
+    const MemoryRangeRead &range = *batched_ranges[i];
+    if (multi_mem_read && !packets.empty() &&
+        packet_size + range.size <= m_max_memory_size) {
+      packets.back() += llvm::formatv(";{0:x-},{1:x-}", range.addr, range.size);
+      packet_ranges.back().second = i + 1;
+      packet_size += range.size;
+      continue;
+    }
+    if (multi_mem_read)
+      packets.push_back(llvm::formatv("jMultiMemRead:{0:x-},{1:x-}",
+                                      range.addr, range.size));
+    else
+      packets.push_back(llvm::formatv("{0}{1:x-},{2:x-}",
+                                      binary_memory_read ? 'x' : 'm',
+                                      range.addr, range.size));
+    packet_ranges.emplace_back(i, i + 1);
+    packet_size = range.size;
+  }
+
+  std::vector<StringExtractorGDBRemote> responses(packets.size());
+  if (m_gdb_comm.SendPacketsAndWaitForResponses(packets, responses, true) !=
       GDBRemoteCommunication::PacketResult::Success) {
-    if (response.IsNormalResponse()) {
-      error.Clear();
-      if (binary_memory_read) {
-        // The lower level GDBRemoteCommunication packet receive layer has
-        // already de-quoted any 0x7d character escaping that was present in
-        // the packet
-
-        size_t data_received_size = response.GetBytesLeft();
-        if (data_received_size > size) {
-          // Don't write past the end of BUF if the remote debug server gave us
-          // too much data for some reason.
-          data_received_size = size;
-        }
-        memcpy(buf, response.GetStringRef().data(), data_received_size);
-        return data_received_size;
-      } else {
-        return response.GetHexBytes(
-            llvm::MutableArrayRef<uint8_t>((uint8_t *)buf, size), '\xdd');
+    for (MemoryRangeRead *range : batched_ranges)
+      range->error.SetErrorStringWithFormat(
+          "failed to send memory read packets for 0x%" PRIx64, range->addr);
+    return;
+  }
+
+  for (size_t p = 0; p < packets.size(); ++p) {
+    StringExtractorGDBRemote &response = responses[p];
+    const size_t begin = packet_ranges[p].first;
+    const size_t end = packet_ranges[p].second;
+    if (!multi_mem_read) {
+      MemoryRangeRead &range = *batched_ranges[begin];
+      range.bytes_read =
+          ExtractMemoryReadResponse(response, binary_memory_read, range.addr,
+                                    range.buf, range.size, packets[p],
+                                    range.error);
+      continue;
+    }
+
+    // The reply is "<bytes read>[,<bytes read>]*;<binary data>" with the data
+    // of all the ranges back to back.
+    llvm::StringRef reply = response.GetStringRef();
+    llvm::StringRef lengths, data;
+    std::tie(lengths, data) = reply.split(';');
+    bool valid = response.GetResponseType() ==
+                     StringExtractorGDBRemote::eResponse &&
+                 reply.size() != lengths.size();
+    for (size_t i = begin; i < end; ++i) {
+      MemoryRangeRead &range = *batched_ranges[i];
+      llvm::StringRef length_str;
+      std::tie(length_str, lengths) = lengths.split(',');
+      size_t length = 0;
+      if (!valid || length_str.getAsInteger(16, length) ||
+          length > range.size || length > data.size()) {
+        valid = false;
+        range.error.SetErrorStringWithFormat(
+            "unexpected response to GDB server packet '%s': '%s'",
+            packets[p].c_str(), response.GetStringRef().data());
+        continue;
       }
-    } else if (response.IsErrorResponse())
-      error.SetErrorStringWithFormat("memory read failed for 0x%" PRIx64, addr);
-    else if (response.IsUnsupportedResponse())
-      error.SetErrorStringWithFormat(
-          "GDB server does not support reading memory");
-    else
-      error.SetErrorStringWithFormat(
-          "unexpected response to GDB server memory read packet '%s': '%s'",
-          packet, response.GetStringRef().data());
-  } else {
-    error.SetErrorStringWithFormat("failed to send packet: '%s'", packet);
+      memcpy(range.buf, data.data(), length);
+      data = data.drop_front(length);
+      range.bytes_read = length;
+      if (length == 0)
+        range.error.SetErrorStringWithFormat(
+            "memory read failed for 0x%" PRIx64, range.addr);
+      else
+        range.error.Clear();
+    }
   }
-  return 0;
 }
 
 Status ProcessGDBRemote::WriteObjectFile(
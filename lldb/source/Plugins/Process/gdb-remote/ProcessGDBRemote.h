@@ -134,6 +134,9 @@ public:
   size_t DoReadMemory(lldb::addr_t addr, void *buf, size_t size,
                       Status &error) override;
 
+  void
+  DoReadMemoryRanges(llvm::MutableArrayRef<MemoryRangeRead> ranges) override;
+
   Status
   WriteObjectFile(std::vector<ObjectFile::LoadableData> entries) override;
 
@@ -13,9 +13,16 @@
 #include "Plugins/SymbolFile/DWARF/LogChannelDWARF.h"
 #include "Plugins/SymbolFile/DWARF/SymbolFileDWARFDwo.h"
 #include "lldb/Core/Module.h"
+#include "lldb/Host/FileSystem.h"
 #include "lldb/Symbol/ObjectFile.h"
 #include "lldb/Utility/Stream.h"
 #include "lldb/Utility/Timer.h"
+#include "llvm/Support/Chrono.h"
+#include "llvm/Support/DataExtractor.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/ThreadPool.h"
 
 using namespace lldb_private;
@@ -35,6 +42,18 @@ void ManualDWARFIndex::Index() {
   SymbolFileDWARFDwo *dwp_dwarf = main_dwarf.GetDwpSymbolFile().get();
   DWARFDebugInfo *dwp_info = dwp_dwarf ? &dwp_dwarf->DebugInfo() : nullptr;
 
+  // Reuse the index built by a previous session if the object file didn't
+  // change since.
+  std::string cache_path = GetCacheFilePath(main_dwarf);
+  uint64_t cache_signature = 0;
+  if (!cache_path.empty()) {
+    cache_signature =
+        llvm::sys::toTimeT(FileSystem::Instance().GetModificationTime(
+            main_dwarf.GetObjectFile()->GetFileSpec()));
+    if (LoadFromCache(cache_path, cache_signature))
+      return;
+  }
+
   std::vector<DWARFUnit *> units_to_index;
   units_to_index.reserve(main_info.GetNumUnits() +
                          (dwp_info ? dwp_info->GetNumUnits() : 0));
@@ -109,6 +128,137 @@ void ManualDWARFIndex::Index() {
   pool.async(finalize_fn, &IndexSet::types);
   pool.async(finalize_fn, &IndexSet::namespaces);
   pool.wait();
+
+  // The index of units with split DWARF depends on the dwo files, which the
+  // cache signature doesn't cover.
+  if (!cache_path.empty() &&
+      llvm::none_of(units_to_index, [](DWARFUnit *unit) {
+        return unit->GetDwoSymbolFile() != nullptr;
+      }))
+    SaveToCache(cache_path, cache_signature);
+}
+
+// Identifies cache files, and their format. Bump the version whenever the
+// format or the content of the index changes.
+static constexpr uint32_t g_cache_magic = 0x4c4d4449; // 'LMDI'
+static constexpr uint32_t g_cache_version = 1;
+
+std::string ManualDWARFIndex::GetCacheFilePath(SymbolFileDWARF &dwarf) {
+  // Partial indexes and the indexes of dwo files aren't cached.
+  if (!m_cache_directory || !m_units_to_avoid.empty() || dwarf.GetDwoNum() ||
+      dwarf.GetDwpSymbolFile())
+    return "";
+  UUID uuid = dwarf.GetObjectFile()->GetUUID();
+  if (!uuid.IsValid())
+    return "";
+  llvm::SmallString<128> path(m_cache_directory.GetPath());
+  llvm::sys::path::append(path, uuid.GetAsString() + ".lldbindex");
+  return std::string(path.str());
+}
+
+bool ManualDWARFIndex::LoadFromCache(llvm::StringRef path,
+                                     uint64_t signature) {
+  // The file is mapped, the names are interned straight from it.
+  auto buffer_or_err = llvm::MemoryBuffer::getFile(
+      path, /*FileSize=*/-1, /*RequiresNullTerminator=*/false);
+  if (!buffer_or_err)
+    return false;
+  llvm::DataExtractor data((*buffer_or_err)->getBuffer(),
+                           /*IsLittleEndian=*/true, /*AddressSize=*/0);
+  llvm::DataExtractor::Cursor cursor(0);
+  if (data.getU32(cursor) != g_cache_magic ||
+      data.getU32(cursor) != g_cache_version ||
+      data.getU64(cursor) != signature) {
+    llvm::consumeError(cursor.takeError());
+    return false;
+  }
+
+  const uint32_t num_strings = data.getU32(cursor);
+  if (!cursor || num_strings > data.size()) {
+    llvm::consumeError(cursor.takeError());
+    return false;
+  }
+  std::vector<ConstString> strings(num_strings);
+  for (ConstString &str : strings) {
+    const uint32_t length = data.getU32(cursor);
+    str = ConstString(data.getBytes(cursor, length));
+  }
+
+  bool valid = true;
+  m_set.ForEach([&](NameToDIE &index) {
+    const uint32_t num_entries = data.getU32(cursor);
+    for (uint32_t i = 0; valid && i < num_entries; ++i) {
+      const uint32_t name = data.getU32(cursor);
+      const uint32_t dwo_num = data.getU32(cursor);
+      const uint8_t section = data.getU8(cursor);
+      const uint32_t die_offset = data.getU32(cursor);
+      valid = cursor && name < num_strings && section <= DIERef::DebugTypes;
+      if (valid)
+        index.Insert(strings[name],
+                     DIERef(dwo_num ? llvm::Optional<uint32_t>(dwo_num - 1)
+                                    : llvm::None,
+                            static_cast<DIERef::Section>(section),
+                            die_offset));
+    }
+    index.Finalize();
+  });
+  if (!cursor || !valid) {
+    llvm::consumeError(cursor.takeError());
+    m_set = IndexSet();
+    return false;
+  }
+  return true;
+}
+
+void ManualDWARFIndex::SaveToCache(llvm::StringRef path, uint64_t signature) {
+  // Most names appear in several indexes, store them once.
+  llvm::DenseMap<const char *, uint32_t> string_indexes;
+  std::vector<llvm::StringRef> strings;
+  m_set.ForEach([&](NameToDIE &index) {
+    index.ForEach([&](ConstString name, const DIERef &) {
+      if (string_indexes.try_emplace(name.GetCString(), strings.size()).second)
+        strings.push_back(name.GetStringRef());
+      return true;
+    });
+  });
+
+  // Write to a temporary file renamed once complete, so that other debugger
+  // instances never read a partial index.
+  if (llvm::sys::fs::create_directories(m_cache_directory.GetPath()))
+    return;
+  int fd;
+  llvm::SmallString<128> tmp_path;
+  if (llvm::sys::fs::createUniqueFile(path + "-%%%%%%%%.tmp", fd, tmp_path))
+    return;
+  llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+  llvm::support::endian::Writer writer(os, llvm::support::little);
+  writer.write<uint32_t>(g_cache_magic);
+  writer.write<uint32_t>(g_cache_version);
+  writer.write<uint64_t>(signature);
+  writer.write<uint32_t>(strings.size());
+  for (llvm::StringRef str : strings) {
+    writer.write<uint32_t>(str.size());
+    os << str;
+  }
+  m_set.ForEach([&](NameToDIE &index) {
+    writer.write<uint32_t>(index.GetSize());
+    index.ForEach([&](ConstString name, const DIERef &die_ref) {
+      llvm::Optional<uint32_t> dwo_num = die_ref.dwo_num();
+      writer.write<uint32_t>(string_indexes.lookup(name.GetCString()));
+      writer.write<uint32_t>(dwo_num ? *dwo_num + 1 : 0);
+      writer.write<uint8_t>(die_ref.section());
+      writer.write<uint32_t>(die_ref.die_offset());
+      return true;
+    });
+  });
+  os.close();
+  if (os.has_error()) {
+    os.clear_error();
+    llvm::sys::fs::remove(tmp_path);
+    return;
+  }
+  if (llvm::sys::fs::rename(tmp_path, path))
+    llvm::sys::fs::remove(tmp_path);
 }
 
 void ManualDWARFIndex::IndexUnit(DWARFUnit &unit, SymbolFileDWARFDwo *dwp,
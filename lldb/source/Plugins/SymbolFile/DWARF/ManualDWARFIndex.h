@@ -11,6 +11,7 @@
 
 #include "Plugins/SymbolFile/DWARF/DWARFIndex.h"
 #include "Plugins/SymbolFile/DWARF/NameToDIE.h"
+#include "lldb/Utility/FileSpec.h"
 #include "llvm/ADT/DenseSet.h"
 
 class DWARFDebugInfo;
@@ -20,9 +21,11 @@ namespace lldb_private {
 class ManualDWARFIndex : public DWARFIndex {
 public:
   ManualDWARFIndex(Module &module, SymbolFileDWARF &dwarf,
-                   llvm::DenseSet<dw_offset_t> units_to_avoid = {})
+                   llvm::DenseSet<dw_offset_t> units_to_avoid = {},
+                   FileSpec cache_directory = {})
       : DWARFIndex(module), m_dwarf(&dwarf),
-        m_units_to_avoid(std::move(units_to_avoid)) {}
+        m_units_to_avoid(std::move(units_to_avoid)),
+        m_cache_directory(std::move(cache_directory)) {}
 
   void Preload() override { Index(); }
 
@@ -65,6 +68,15 @@ private:
     NameToDIE globals;
     NameToDIE types;
     NameToDIE namespaces;
+
+    /// Call \p fn on each of the indexes, in the order they are cached in.
+    template <typename Fn> void ForEach(Fn fn) {
+      for (NameToDIE *index :
+           {&function_basenames, &function_fullnames, &function_methods,
+            &function_selectors, &objc_class_selectors, &globals, &types,
+            &namespaces})
+        fn(*index);
+    }
   };
   void Index();
   void IndexUnit(DWARFUnit &unit, SymbolFileDWARFDwo *dwp, IndexSet &set);
@@ -73,11 +85,27 @@ private:
                             const lldb::LanguageType cu_language,
                             IndexSet &set);
 
+  /// Returns the path of the file caching the index of \p dwarf, or an empty
+  /// string if it can't be cached. The file is named after the UUID of the
+  /// object file.
+  std::string GetCacheFilePath(SymbolFileDWARF &dwarf);
+
+  /// Read the index from the cache file \p path. Returns false, leaving
+  /// m_set empty, if the file doesn't exist, is invalid or was written for
+  /// an object file with a different \p signature.
+  bool LoadFromCache(llvm::StringRef path, uint64_t signature);
+
+  /// Write the index to the cache file \p path.
+  void SaveToCache(llvm::StringRef path, uint64_t signature);
+
   /// The DWARF file which we are indexing. Set to nullptr after the index is
   /// built.
   SymbolFileDWARF *m_dwarf;
   /// Which dwarf units should we skip while building the index.
   llvm::DenseSet<dw_offset_t> m_units_to_avoid;
+  /// Directory where finished indexes are cached across debug sessions, or
+  /// empty if they aren't.
+  FileSpec m_cache_directory;
 
   IndexSet m_set;
 };
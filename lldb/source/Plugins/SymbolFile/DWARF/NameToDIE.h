@@ -32,6 +32,8 @@ public:
 
   void Finalize();
 
+  size_t GetSize() const { return m_map.GetSize(); }
+
   bool Find(lldb_private::ConstString name,
             llvm::function_ref<bool(DIERef ref)> callback) const;
 
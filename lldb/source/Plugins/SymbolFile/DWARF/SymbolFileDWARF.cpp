@@ -140,6 +140,13 @@ public:
     return m_collection_sp->GetPropertyAtIndexAsBoolean(
         nullptr, ePropertyIgnoreIndexes, false);
   }
+
+  FileSpec GetIndexCachePath() const {
+    return m_collection_sp
+        ->GetPropertyAtIndexAsOptionValueFileSpec(nullptr, false,
+                                                  ePropertyIndexCachePath)
+        ->GetCurrentValue();
+  }
 };
 
 typedef std::shared_ptr<PluginProperties> SymbolFileDWARFPropertiesSP;
@@ -495,8 +502,9 @@ void SymbolFileDWARF::InitializeObject() {
     }
   }
 
-  m_index =
-      std::make_unique<ManualDWARFIndex>(*GetObjectFile()->GetModule(), *this);
+  m_index = std::make_unique<ManualDWARFIndex>(
+      *GetObjectFile()->GetModule(), *this, llvm::DenseSet<dw_offset_t>(),
+      GetGlobalPluginProperties()->GetIndexCachePath());
 }
 
 bool SymbolFileDWARF::SupportedVersion(uint16_t version) {
@@ -1745,8 +1753,9 @@ void SymbolFileDWARF::UpdateExternalModuleListIfNeeded() {
     if (!dwo_id)
       continue;
 
-    auto *dwo_symfile =
-        llvm::dyn_cast_or_null<SymbolFileDWARF>(module_sp->GetSymbolFile());
+    SymbolFile *sym_file = module_sp->GetSymbolFile();
+    auto *dwo_symfile = llvm::dyn_cast_or_null<SymbolFileDWARF>(
+        sym_file ? sym_file->GetBackingSymbolFile() : nullptr);
     if (!dwo_symfile)
       continue;
     llvm::Optional<uint64_t> dwo_dwo_id = dwo_symfile->GetDWOId();
@@ -3847,8 +3856,8 @@ SymbolFileDWARFDebugMap *SymbolFileDWARF::GetDebugMapSymfile() {
   if (m_debug_map_symfile == nullptr && !m_debug_map_module_wp.expired()) {
     lldb::ModuleSP module_sp(m_debug_map_module_wp.lock());
     if (module_sp) {
-      m_debug_map_symfile =
-          static_cast<SymbolFileDWARFDebugMap *>(module_sp->GetSymbolFile());
+      m_debug_map_symfile = static_cast<SymbolFileDWARFDebugMap *>(
+          module_sp->GetSymbolFile()->GetBackingSymbolFile());
     }
   }
   return m_debug_map_symfile;
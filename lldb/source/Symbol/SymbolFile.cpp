@@ -9,9 +9,11 @@
 #include "lldb/Symbol/SymbolFile.h"
 
 #include "lldb/Core/Module.h"
+#include "lldb/Core/ModuleList.h"
 #include "lldb/Core/PluginManager.h"
 #include "lldb/Symbol/CompileUnit.h"
 #include "lldb/Symbol/ObjectFile.h"
+#include "lldb/Symbol/SymbolFileOnDemand.h"
 #include "lldb/Symbol/TypeMap.h"
 #include "lldb/Symbol/TypeSystem.h"
 #include "lldb/Symbol/VariableList.h"
@@ -79,6 +81,20 @@ SymbolFile *SymbolFile::FindPlugin(ObjectFileSP objfile_sp) {
       }
     }
     if (best_symfile_up) {
+      // When symbols are loaded on demand, the debug info of executables and
+      // shared libraries (and of their separate debug info files) is only
+      // read once something needs it. Symbol files without any debug info
+      // abilities have nothing to defer.
+      ObjectFile::Type obj_file_type = objfile_sp->CalculateType();
+      if (ModuleList::GetGlobalModuleListProperties()
+              .GetLoadSymbolOnDemand() &&
+          best_symfile_abilities > 0 &&
+          (obj_file_type == ObjectFile::eTypeExecutable ||
+           obj_file_type == ObjectFile::eTypeSharedLibrary ||
+           obj_file_type == ObjectFile::eTypeDebugInfo)) {
+        best_symfile_up =
+            std::make_unique<SymbolFileOnDemand>(std::move(best_symfile_up));
+      }
       // Let the winning symbol file parser initialize itself more completely
       // now that it has been chosen
       best_symfile_up->InitializeObject();
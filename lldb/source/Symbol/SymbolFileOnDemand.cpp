@@ -0,0 +1,379 @@
+//===-- SymbolFileOnDemand.cpp --------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "lldb/Symbol/SymbolFileOnDemand.h"
+
+#include "lldb/Core/Module.h"
+#include "lldb/Symbol/CompileUnit.h"
+#include "lldb/Symbol/ObjectFile.h"
+#include "lldb/Symbol/SymbolContext.h"
+#include "lldb/Symbol/Symtab.h"
+#include "lldb/Utility/Log.h"
+#include "lldb/Utility/Logging.h"
+
+using namespace lldb;
+using namespace lldb_private;
+
+char SymbolFileOnDemand::ID;
+
+SymbolFileOnDemand::SymbolFileOnDemand(
+    std::unique_ptr<SymbolFile> &&symbol_file)
+    : SymbolFile(symbol_file->GetObjectFile()->shared_from_this()),
+      m_sym_file_impl(std::move(symbol_file)) {}
+
+SymbolFileOnDemand::~SymbolFileOnDemand() = default;
+
+ConstString SymbolFileOnDemand::GetPluginName() {
+  return m_sym_file_impl->GetPluginName();
+}
+
+uint32_t SymbolFileOnDemand::GetPluginVersion() {
+  return m_sym_file_impl->GetPluginVersion();
+}
+
+ConstString SymbolFileOnDemand::GetSymbolFileName() {
+  return GetObjectFile()->GetFileSpec().GetFilename();
+}
+
+bool SymbolFileOnDemand::ShouldForward(llvm::StringRef name_for_log) {
+  if (m_debug_info_enabled)
+    return true;
+  Log *log = GetLogIfAllCategoriesSet(LIBLLDB_LOG_SYMBOLS);
+  LLDB_LOG(log, "[{0}] {1} is skipped", GetSymbolFileName(), name_for_log);
+  return false;
+}
+
+void SymbolFileOnDemand::SetLoadDebugInfoEnabled() {
+  std::lock_guard<std::recursive_mutex> guard(GetModuleMutex());
+  if (m_debug_info_enabled)
+    return;
+  Log *log = GetLogIfAllCategoriesSet(LIBLLDB_LOG_SYMBOLS);
+  LLDB_LOG(log, "[{0}] Hydrate debug info", GetSymbolFileName());
+  m_debug_info_enabled = true;
+  // The backing symbol file may have skipped the index construction while
+  // nothing needed it; catch up now if preloading was requested.
+  if (m_preload_symbols)
+    m_sym_file_impl->PreloadSymbols();
+}
+
+bool SymbolFileOnDemand::HasCompileUnitForFile(const FileSpec &file_spec) {
+  const uint32_t num_cus = m_sym_file_impl->GetNumCompileUnits();
+  for (uint32_t i = 0; i < num_cus; ++i) {
+    CompUnitSP cu_sp = m_sym_file_impl->GetCompileUnitAtIndex(i);
+    if (!cu_sp)
+      continue;
+    if (FileSpec::Match(file_spec, cu_sp->GetPrimaryFile()))
+      return true;
+    // Inlined code from headers is attributed to the support files.
+    for (const FileSpec &support_file : cu_sp->GetSupportFiles())
+      if (FileSpec::Match(file_spec, support_file))
+        return true;
+  }
+  return false;
+}
+
+uint32_t SymbolFileOnDemand::CalculateAbilities() {
+  return m_sym_file_impl->GetAbilities();
+}
+
+std::recursive_mutex &SymbolFileOnDemand::GetModuleMutex() const {
+  return m_sym_file_impl->GetModuleMutex();
+}
+
+void SymbolFileOnDemand::InitializeObject() {
+  m_sym_file_impl->InitializeObject();
+}
+
+uint32_t SymbolFileOnDemand::CalculateNumCompileUnits() {
+  return m_sym_file_impl->GetNumCompileUnits();
+}
+
+CompUnitSP SymbolFileOnDemand::ParseCompileUnitAtIndex(uint32_t idx) {
+  return m_sym_file_impl->GetCompileUnitAtIndex(idx);
+}
+
+lldb::LanguageType SymbolFileOnDemand::ParseLanguage(CompileUnit &comp_unit) {
+  return m_sym_file_impl->ParseLanguage(comp_unit);
+}
+
+XcodeSDK SymbolFileOnDemand::ParseXcodeSDK(CompileUnit &comp_unit) {
+  return m_sym_file_impl->ParseXcodeSDK(comp_unit);
+}
+
+size_t SymbolFileOnDemand::ParseFunctions(CompileUnit &comp_unit) {
+  return m_sym_file_impl->ParseFunctions(comp_unit);
+}
+
+bool SymbolFileOnDemand::ParseLineTable(CompileUnit &comp_unit) {
+  return m_sym_file_impl->ParseLineTable(comp_unit);
+}
+
+bool SymbolFileOnDemand::ParseDebugMacros(CompileUnit &comp_unit) {
+  return m_sym_file_impl->ParseDebugMacros(comp_unit);
+}
+
+bool SymbolFileOnDemand::ForEachExternalModule(
+    CompileUnit &comp_unit,
+    llvm::DenseSet<lldb_private::SymbolFile *> &visited_symbol_files,
+    llvm::function_ref<bool(Module &)> lambda) {
+  return m_sym_file_impl->ForEachExternalModule(comp_unit,
+                                                visited_symbol_files, lambda);
+}
+
+bool SymbolFileOnDemand::ParseSupportFiles(CompileUnit &comp_unit,
+                                           FileSpecList &support_files) {
+  return m_sym_file_impl->ParseSupportFiles(comp_unit, support_files);
+}
+
+bool SymbolFileOnDemand::ParseIsOptimized(CompileUnit &comp_unit) {
+  return m_sym_file_impl->ParseIsOptimized(comp_unit);
+}
+
+size_t SymbolFileOnDemand::ParseTypes(CompileUnit &comp_unit) {
+  return m_sym_file_impl->ParseTypes(comp_unit);
+}
+
+bool SymbolFileOnDemand::ParseImportedModules(
+    const SymbolContext &sc, std::vector<SourceModule> &imported_modules) {
+  return m_sym_file_impl->ParseImportedModules(sc, imported_modules);
+}
+
+size_t SymbolFileOnDemand::ParseBlocksRecursive(Function &func) {
+  return m_sym_file_impl->ParseBlocksRecursive(func);
+}
+
+size_t SymbolFileOnDemand::ParseVariablesForContext(const SymbolContext &sc) {
+  return m_sym_file_impl->ParseVariablesForContext(sc);
+}
+
+Type *SymbolFileOnDemand::ResolveTypeUID(lldb::user_id_t type_uid) {
+  return m_sym_file_impl->ResolveTypeUID(type_uid);
+}
+
+llvm::Optional<SymbolFile::ArrayInfo>
+SymbolFileOnDemand::GetDynamicArrayInfoForUID(
+    lldb::user_id_t type_uid, const ExecutionContext *exe_ctx) {
+  return m_sym_file_impl->GetDynamicArrayInfoForUID(type_uid, exe_ctx);
+}
+
+bool SymbolFileOnDemand::CompleteType(CompilerType &compiler_type) {
+  return m_sym_file_impl->CompleteType(compiler_type);
+}
+
+CompilerDecl SymbolFileOnDemand::GetDeclForUID(lldb::user_id_t uid) {
+  return m_sym_file_impl->GetDeclForUID(uid);
+}
+
+CompilerDeclContext
+SymbolFileOnDemand::GetDeclContextForUID(lldb::user_id_t uid) {
+  return m_sym_file_impl->GetDeclContextForUID(uid);
+}
+
+CompilerDeclContext
+SymbolFileOnDemand::GetDeclContextContainingUID(lldb::user_id_t uid) {
+  return m_sym_file_impl->GetDeclContextContainingUID(uid);
+}
+
+void SymbolFileOnDemand::ParseDeclsForContext(CompilerDeclContext decl_ctx) {
+  m_sym_file_impl->ParseDeclsForContext(decl_ctx);
+}
+
+uint32_t
+SymbolFileOnDemand::ResolveSymbolContext(const Address &so_addr,
+                                         SymbolContextItem resolve_scope,
+                                         SymbolContext &sc) {
+  // Symbols are resolved by the module from the symbol table; everything
+  // else comes from the debug info.
+  if (!ShouldForward(__FUNCTION__))
+    return 0;
+  return m_sym_file_impl->ResolveSymbolContext(so_addr, resolve_scope, sc);
+}
+
+uint32_t SymbolFileOnDemand::ResolveSymbolContext(
+    const FileSpec &file_spec, uint32_t line, bool check_inlines,
+    SymbolContextItem resolve_scope, SymbolContextList &sc_list) {
+  if (!m_debug_info_enabled) {
+    if (!HasCompileUnitForFile(file_spec)) {
+      ShouldForward(__FUNCTION__);
+      return 0;
+    }
+    SetLoadDebugInfoEnabled();
+  }
+  return m_sym_file_impl->ResolveSymbolContext(file_spec, line, check_inlines,
+                                               resolve_scope, sc_list);
+}
+
+void SymbolFileOnDemand::DumpClangAST(Stream &s) {
+  if (!ShouldForward(__FUNCTION__))
+    return;
+  m_sym_file_impl->DumpClangAST(s);
+}
+
+void SymbolFileOnDemand::FindGlobalVariables(
+    ConstString name, const CompilerDeclContext &parent_decl_ctx,
+    uint32_t max_matches, VariableList &variables) {
+  if (!m_debug_info_enabled) {
+    Symtab *symtab = GetSymtab();
+    if (!symtab || !symtab->FindFirstSymbolWithNameAndType(
+                       name, eSymbolTypeData, Symtab::eDebugAny,
+                       Symtab::eVisibilityAny)) {
+      ShouldForward(__FUNCTION__);
+      return;
+    }
+    SetLoadDebugInfoEnabled();
+  }
+  m_sym_file_impl->FindGlobalVariables(name, parent_decl_ctx, max_matches,
+                                       variables);
+}
+
+void SymbolFileOnDemand::FindGlobalVariables(const RegularExpression &regex,
+                                             uint32_t max_matches,
+                                             VariableList &variables) {
+  if (!m_debug_info_enabled) {
+    Symtab *symtab = GetSymtab();
+    std::vector<uint32_t> symbol_indexes;
+    if (symtab)
+      symtab->AppendSymbolIndexesMatchingRegExAndType(regex, eSymbolTypeData,
+                                                      symbol_indexes);
+    if (symbol_indexes.empty()) {
+      ShouldForward(__FUNCTION__);
+      return;
+    }
+    SetLoadDebugInfoEnabled();
+  }
+  m_sym_file_impl->FindGlobalVariables(regex, max_matches, variables);
+}
+
+void SymbolFileOnDemand::FindFunctions(
+    ConstString name, const CompilerDeclContext &parent_decl_ctx,
+    FunctionNameType name_type_mask, bool include_inlines,
+    SymbolContextList &sc_list) {
+  if (!m_debug_info_enabled) {
+    Symtab *symtab = GetSymtab();
+    SymbolContextList symbol_sc_list;
+    if (symtab)
+      symtab->FindFunctionSymbols(name, name_type_mask, symbol_sc_list);
+    if (symbol_sc_list.GetSize() == 0) {
+      ShouldForward(__FUNCTION__);
+      return;
+    }
+    SetLoadDebugInfoEnabled();
+  }
+  m_sym_file_impl->FindFunctions(name, parent_decl_ctx, name_type_mask,
+                                 include_inlines, sc_list);
+}
+
+void SymbolFileOnDemand::FindFunctions(const RegularExpression &regex,
+                                       bool include_inlines,
+                                       SymbolContextList &sc_list) {
+  if (!m_debug_info_enabled) {
+    Symtab *symtab = GetSymtab();
+    std::vector<uint32_t> symbol_indexes;
+    if (symtab)
+      symtab->AppendSymbolIndexesMatchingRegExAndType(regex, eSymbolTypeCode,
+                                                      symbol_indexes);
+    if (symbol_indexes.empty()) {
+      ShouldForward(__FUNCTION__);
+      return;
+    }
+    SetLoadDebugInfoEnabled();
+  }
+  m_sym_file_impl->FindFunctions(regex, include_inlines, sc_list);
+}
+
+void SymbolFileOnDemand::FindTypes(
+    ConstString name, const CompilerDeclContext &parent_decl_ctx,
+    uint32_t max_matches,
+    llvm::DenseSet<lldb_private::SymbolFile *> &searched_symbol_files,
+    TypeMap &types) {
+  // Types are not in the symbol table, so a type lookup alone never enables
+  // the debug info.
+  if (!ShouldForward(__FUNCTION__))
+    return;
+  m_sym_file_impl->FindTypes(name, parent_decl_ctx, max_matches,
+                             searched_symbol_files, types);
+}
+
+void SymbolFileOnDemand::FindTypes(
+    llvm::ArrayRef<CompilerContext> pattern, LanguageSet languages,
+    llvm::DenseSet<SymbolFile *> &searched_symbol_files, TypeMap &types) {
+  if (!ShouldForward(__FUNCTION__))
+    return;
+  m_sym_file_impl->FindTypes(pattern, languages, searched_symbol_files, types);
+}
+
+void SymbolFileOnDemand::GetMangledNamesForFunction(
+    const std::string &scope_qualified_name,
+    std::vector<ConstString> &mangled_names) {
+  if (!ShouldForward(__FUNCTION__))
+    return;
+  m_sym_file_impl->GetMangledNamesForFunction(scope_qualified_name,
+                                              mangled_names);
+}
+
+void SymbolFileOnDemand::GetTypes(SymbolContextScope *sc_scope,
+                                  TypeClass type_mask, TypeList &type_list) {
+  if (!ShouldForward(__FUNCTION__))
+    return;
+  m_sym_file_impl->GetTypes(sc_scope, type_mask, type_list);
+}
+
+void SymbolFileOnDemand::PreloadSymbols() {
+  // Preloading would build the very indexes this class defers; remember the
+  // request and honor it once the debug info is enabled.
+  m_preload_symbols = true;
+  if (!ShouldForward(__FUNCTION__))
+    return;
+  m_sym_file_impl->PreloadSymbols();
+}
+
+llvm::Expected<TypeSystem &>
+SymbolFileOnDemand::GetTypeSystemForLanguage(LanguageType language) {
+  return m_sym_file_impl->GetTypeSystemForLanguage(language);
+}
+
+CompilerDeclContext
+SymbolFileOnDemand::FindNamespace(ConstString name,
+                                  const CompilerDeclContext &parent_decl_ctx) {
+  if (!ShouldForward(__FUNCTION__))
+    return CompilerDeclContext();
+  return m_sym_file_impl->FindNamespace(name, parent_decl_ctx);
+}
+
+std::vector<std::unique_ptr<CallEdge>>
+SymbolFileOnDemand::ParseCallEdgesInFunction(UserID func_id) {
+  return m_sym_file_impl->ParseCallEdgesInFunction(func_id);
+}
+
+void SymbolFileOnDemand::AddSymbols(Symtab &symtab) {
+  // The backing symbol file adds its symbols to the same symbol table of the
+  // main object file, and only does so once.
+  m_sym_file_impl->GetSymtab();
+}
+
+void SymbolFileOnDemand::SectionFileAddressesChanged() {
+  m_sym_file_impl->SectionFileAddressesChanged();
+}
+
+UnwindPlanSP
+SymbolFileOnDemand::GetUnwindPlan(const Address &address,
+                                  const RegisterInfoResolver &resolver) {
+  // Unwinding must work for every module, so this is never deferred.
+  return m_sym_file_impl->GetUnwindPlan(address, resolver);
+}
+
+llvm::Expected<lldb::addr_t>
+SymbolFileOnDemand::GetParameterStackSize(Symbol &symbol) {
+  return m_sym_file_impl->GetParameterStackSize(symbol);
+}
+
+void SymbolFileOnDemand::Dump(Stream &s) {
+  s.Format("SymbolFileOnDemand (debug info {0})\n",
+           m_debug_info_enabled ? "enabled" : "not loaded yet");
+  m_sym_file_impl->Dump(s);
+}
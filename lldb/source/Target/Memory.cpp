@@ -23,7 +23,8 @@ using namespace lldb_private;
 MemoryCache::MemoryCache(Process &process)
     : m_mutex(), m_L1_cache(), m_L2_cache(), m_invalid_ranges(),
       m_process(process),
-      m_L2_cache_line_byte_size(process.GetMemoryCacheLineSize()) {}
+      m_L2_cache_line_byte_size(process.GetMemoryCacheLineSize()),
+      m_L2_read_ahead_lines(process.GetMemoryCacheReadAhead()) {}
 
 // Destructor
 MemoryCache::~MemoryCache() {}
@@ -35,6 +36,7 @@ void MemoryCache::Clear(bool clear_invalid_ranges) {
   if (clear_invalid_ranges)
     m_invalid_ranges.Clear();
   m_L2_cache_line_byte_size = m_process.GetMemoryCacheLineSize();
+  m_L2_read_ahead_lines = m_process.GetMemoryCacheReadAhead();
 }
 
 void MemoryCache::AddL1CacheData(lldb::addr_t addr, const void *src,
@@ -224,22 +226,15 @@ size_t MemoryCache::Read(addr_t addr, void *dst, size_t dst_len,
 
       if (bytes_left > 0) {
         assert((curr_addr % cache_line_byte_size) == 0);
-        std::unique_ptr<DataBufferHeap> data_buffer_heap_up(
-            new DataBufferHeap(cache_line_byte_size, 0));
-        size_t process_bytes_read = m_process.ReadMemoryFromInferior(
-            curr_addr, data_buffer_heap_up->GetBytes(),
-            data_buffer_heap_up->GetByteSize(), error);
+        size_t process_bytes_read =
+            FetchL2CacheLines(curr_addr, cache_offset + bytes_left, error);
         if (process_bytes_read == 0)
           return dst_len - bytes_left;
 
-        if (process_bytes_read != cache_line_byte_size) {
-          if (process_bytes_read < data_buffer_heap_up->GetByteSize()) {
-            dst_len -= data_buffer_heap_up->GetByteSize() - process_bytes_read;
-            bytes_left = process_bytes_read;
-          }
-          data_buffer_heap_up->SetByteSize(process_bytes_read);
+        if (process_bytes_read < cache_line_byte_size) {
+          dst_len -= cache_line_byte_size - process_bytes_read;
+          bytes_left = process_bytes_read;
         }
-        m_L2_cache[curr_addr] = DataBufferSP(data_buffer_heap_up.release());
         // We have read data and put it into the cache, continue through the
         // loop again to get the data out of the cache...
       }
@@ -249,6 +244,74 @@ size_t MemoryCache::Read(addr_t addr, void *dst, size_t dst_len,
   return dst_len - bytes_left;
 }
 
+size_t MemoryCache::FetchL2CacheLines(addr_t addr, size_t byte_size,
+                                      Status &error) {
+  const uint32_t cache_line_byte_size = m_L2_cache_line_byte_size;
+  const uint64_t num_lines =
+      (byte_size + cache_line_byte_size - 1) / cache_line_byte_size +
+      m_L2_read_ahead_lines;
+
+  // Collect the runs of consecutive lines that aren't cached yet, starting
+  // with the line at "addr" which is known to be missing. Each run is read
+  // as a single range, and all of the ranges with a single request when the
+  // process supports it.
+  struct LineRun {
+    addr_t addr;
+    uint64_t num_lines;
+  };
+  std::vector<LineRun> runs;
+  bool extends_last_run = false;
+  for (uint64_t i = 0; i < num_lines; ++i) {
+    const addr_t line_addr = addr + i * cache_line_byte_size;
+    if (line_addr < addr)
+      break;
+    if (i > 0 && (m_L2_cache.count(line_addr) ||
+                  m_invalid_ranges.FindEntryThatContains(line_addr))) {
+      extends_last_run = false;
+      continue;
+    }
+    if (extends_last_run)
+      ++runs.back().num_lines;
+    else
+      runs.push_back({line_addr, 1});
+    extends_last_run = true;
+  }
+
+  std::vector<DataBufferHeap> buffers;
+  std::vector<Process::MemoryRangeRead> ranges;
+  buffers.reserve(runs.size());
+  ranges.reserve(runs.size());
+  for (const LineRun &run : runs) {
+    buffers.emplace_back(run.num_lines * cache_line_byte_size, 0);
+    ranges.emplace_back(run.addr, buffers.back().GetBytes(),
+                        buffers.back().GetByteSize());
+  }
+  m_process.ReadMemoryRangesFromInferior(ranges);
+
+  // The line we actually need must not be lost because the lines read along
+  // with it aren't readable and the process failed the whole range.
+  Process::MemoryRangeRead &first = ranges.front();
+  if (first.bytes_read == 0 && first.size > cache_line_byte_size)
+    first.bytes_read = m_process.ReadMemoryFromInferior(
+        first.addr, first.buf, cache_line_byte_size, first.error);
+  if (first.bytes_read == 0) {
+    error = first.error;
+    return 0;
+  }
+
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    const Process::MemoryRangeRead &range = ranges[i];
+    for (size_t offset = 0; offset < range.bytes_read;
+         offset += cache_line_byte_size) {
+      const size_t line_size = std::min<size_t>(cache_line_byte_size,
+                                                range.bytes_read - offset);
+      m_L2_cache[range.addr + offset] = std::make_shared<DataBufferHeap>(
+          buffers[i].GetBytes() + offset, line_size);
+    }
+  }
+  return std::min<size_t>(first.bytes_read, cache_line_byte_size);
+}
+
 AllocatedBlock::AllocatedBlock(lldb::addr_t addr, uint32_t byte_size,
                                uint32_t permissions, uint32_t chunk_size)
     : m_range(addr, byte_size), m_permissions(permissions),
@@ -187,6 +187,12 @@ uint64_t ProcessProperties::GetMemoryCacheLineSize() const {
       nullptr, idx, g_process_properties[idx].default_uint_value);
 }
 
+uint64_t ProcessProperties::GetMemoryCacheReadAhead() const {
+  const uint32_t idx = ePropertyMemCacheReadAhead;
+  return m_collection_sp->GetPropertyAtIndexAsUInt64(
+      nullptr, idx, g_process_properties[idx].default_uint_value);
+}
+
 Args ProcessProperties::GetExtraStartupCommands() const {
   Args args;
   const uint32_t idx = ePropertyExtraStartCommand;
@@ -2211,6 +2217,38 @@ size_t Process::ReadMemoryFromInferior(addr_t addr, void *buf, size_t size,
   return bytes_read;
 }
 
+void Process::DoReadMemoryRanges(
+    llvm::MutableArrayRef<MemoryRangeRead> ranges) {
+  for (MemoryRangeRead &range : ranges) {
+    uint8_t *bytes = (uint8_t *)range.buf;
+    range.bytes_read = 0;
+    while (range.bytes_read < range.size) {
+      const size_t curr_size = range.size - range.bytes_read;
+      const size_t curr_bytes_read =
+          DoReadMemory(range.addr + range.bytes_read,
+                       bytes + range.bytes_read, curr_size, range.error);
+      range.bytes_read += curr_bytes_read;
+      if (curr_bytes_read == curr_size || curr_bytes_read == 0)
+        break;
+    }
+  }
+}
+
+void Process::ReadMemoryRangesFromInferior(
+    llvm::MutableArrayRef<MemoryRangeRead> ranges) {
+  if (ranges.empty())
+    return;
+  DoReadMemoryRanges(ranges);
+
+  // Replace any software breakpoint opcodes that fall into these ranges back
+  // into their buffers before we return
+  for (MemoryRangeRead &range : ranges) {
+    if (range.bytes_read > 0)
+      RemoveBreakpointOpcodesFromBuffer(range.addr, range.bytes_read,
+                                        (uint8_t *)range.buf);
+  }
+}
+
 uint64_t Process::ReadUnsignedIntegerFromMemory(lldb::addr_t vm_addr,
                                                 size_t integer_byte_size,
                                                 uint64_t fail_value,
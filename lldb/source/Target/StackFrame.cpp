@@ -20,6 +20,7 @@
 #include "lldb/Symbol/Function.h"
 #include "lldb/Symbol/Symbol.h"
 #include "lldb/Symbol/SymbolContextScope.h"
+#include "lldb/Symbol/SymbolFile.h"
 #include "lldb/Symbol/Type.h"
 #include "lldb/Symbol/VariableList.h"
 #include "lldb/Target/ABI.h"
@@ -318,6 +319,16 @@ StackFrame::GetSymbolContext(SymbolContextItem resolve_scope) {
       // haven't already tried to lookup one of those things. If we haven't
       // then we will do the query.
 
+      // A frame that needs more than the symbol table is what triggers
+      // loading the debug info of its module when symbols are loaded on
+      // demand.
+      if (resolve_scope & (eSymbolContextCompUnit | eSymbolContextFunction |
+                           eSymbolContextBlock | eSymbolContextLineEntry |
+                           eSymbolContextVariable)) {
+        if (SymbolFile *symfile = m_sc.module_sp->GetSymbolFile())
+          symfile->SetLoadDebugInfoEnabled();
+      }
+
       SymbolContextItem actual_resolve_scope = SymbolContextItem(0);
 
       if (resolve_scope & eSymbolContextCompUnit) {
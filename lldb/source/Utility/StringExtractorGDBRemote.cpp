@@ -296,6 +296,8 @@ StringExtractorGDBRemote::GetServerPacketType() const {
   case 'j':
     if (PACKET_STARTS_WITH("jModulesInfo:"))
       return eServerPacketType_jModulesInfo;
+    if (PACKET_STARTS_WITH("jMultiMemRead:"))
+      return eServerPacketType_jMultiMemRead;
     if (PACKET_MATCHES("jSignalsInfo"))
       return eServerPacketType_jSignalsInfo;
     if (PACKET_MATCHES("jThreadsInfo"))
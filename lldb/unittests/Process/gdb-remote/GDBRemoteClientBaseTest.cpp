@@ -359,3 +359,26 @@ TEST_F(GDBRemoteClientBaseTest, SendPacketAndReceiveResponseWithOutputSupport) {
   ASSERT_EQ("OK", response.GetStringRef());
   ASSERT_EQ("Hello, world", command_output.GetString().str());
 }
+
+TEST_F(GDBRemoteClientBaseTest, SendPacketsAndWaitForResponses) {
+  const std::vector<std::string> packets = {"qTest1", "qTest2", "qTest3"};
+  StringExtractorGDBRemote responses[3], response;
+
+  std::future<PacketResult> result = std::async(std::launch::async, [&] {
+    return client.SendPacketsAndWaitForResponses(packets, responses, true);
+  });
+
+  // Without acks, all the packets are sent before the first response is read.
+  for (const std::string &packet : packets) {
+    ASSERT_EQ(PacketResult::Success, server.GetPacket(response));
+    ASSERT_EQ(packet, response.GetStringRef());
+  }
+  ASSERT_EQ(PacketResult::Success, server.SendPacket("QTest1"));
+  ASSERT_EQ(PacketResult::Success, server.SendPacket("E01"));
+  ASSERT_EQ(PacketResult::Success, server.SendPacket("QTest3"));
+
+  ASSERT_EQ(PacketResult::Success, result.get());
+  EXPECT_EQ("QTest1", responses[0].GetStringRef());
+  EXPECT_TRUE(responses[1].IsErrorResponse());
+  EXPECT_EQ("QTest3", responses[2].GetStringRef());
+}
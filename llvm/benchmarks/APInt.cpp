@@ -0,0 +1,76 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/ArrayRef.h"
+#include <random>
+#include <vector>
+
+using namespace llvm;
+
+// Constant folding and known bits analysis operate almost entirely on values
+// of 64 bits or less, which APInt stores inline. The wider widths exercise the
+// heap allocated representation used for i128 and vector constants.
+static std::vector<APInt> makeValues(unsigned BitWidth, unsigned Seed) {
+  std::mt19937_64 Rng(Seed);
+  std::vector<APInt> Values;
+  unsigned NumWords = (BitWidth + 63) / 64;
+  for (unsigned I = 0; I != 1024; ++I) {
+    std::vector<uint64_t> Words;
+    for (unsigned W = 0; W != NumWords; ++W)
+      Words.push_back(Rng());
+    APInt V(BitWidth, Words);
+    // Divisors must not be zero.
+    if (V.isNullValue())
+      V = 1;
+    Values.push_back(V);
+  }
+  return Values;
+}
+
+#define APINT_BINOP_BENCHMARK(Name, Expr)                                      \
+  static void BM_##Name(benchmark::State &State) {                             \
+    auto LHS = makeValues(State.range(0), 1);                                  \
+    auto RHS = makeValues(State.range(0), 2);                                  \
+    for (auto _ : State)                                                       \
+      for (size_t I = 0; I != LHS.size(); ++I) {                               \
+        const APInt &A = LHS[I], &B = RHS[I];                                  \
+        benchmark::DoNotOptimize(Expr);                                        \
+      }                                                                        \
+    State.SetItemsProcessed(State.iterations() * LHS.size());                  \
+  }                                                                            \
+  BENCHMARK(BM_##Name)->Arg(32)->Arg(64)->Arg(128)->Arg(256)->Arg(1024);
+
+APINT_BINOP_BENCHMARK(Add, A + B)
+APINT_BINOP_BENCHMARK(Mul, A * B)
+APINT_BINOP_BENCHMARK(UDiv, A.udiv(B))
+APINT_BINOP_BENCHMARK(And, A & B)
+APINT_BINOP_BENCHMARK(ICmpULT, A.ult(B))
+APINT_BINOP_BENCHMARK(Shl, A.shl(B.getLoBits(5).getZExtValue()))
+APINT_BINOP_BENCHMARK(BitCount, A.countLeadingZeros() + B.countPopulation())
+
+// In place updates avoid the temporaries of the binary operators; known bits
+// propagation leans on these.
+static void BM_InPlaceOps(benchmark::State &State) {
+  auto Values = makeValues(State.range(0), 1);
+  APInt Acc(State.range(0), 0);
+  for (auto _ : State)
+    for (const APInt &V : Values) {
+      Acc += V;
+      Acc &= V;
+      Acc |= V.lshr(3);
+      Acc.setBit(V.getLoBits(6).getZExtValue() % Acc.getBitWidth());
+    }
+  benchmark::DoNotOptimize(Acc);
+  State.SetItemsProcessed(State.iterations() * Values.size());
+}
+BENCHMARK(BM_InPlaceOps)->Arg(32)->Arg(64)->Arg(128)->Arg(256)->Arg(1024);
+
+static void BM_ToString(benchmark::State &State) {
+  auto Values = makeValues(State.range(0), 1);
+  for (auto _ : State)
+    for (const APInt &V : Values)
+      benchmark::DoNotOptimize(V.toString(10, false));
+  State.SetItemsProcessed(State.iterations() * Values.size());
+}
+BENCHMARK(BM_ToString)->Arg(64)->Arg(128)->Arg(256);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,86 @@
+#include "benchmark/benchmark.h"
+#include "llvm/Support/Allocator.h"
+#include <random>
+#include <vector>
+
+using namespace llvm;
+
+// Allocation sizes drawn from what a frontend and the IR put into their
+// arenas: mostly small nodes, some operand arrays and the odd large buffer
+// that ends up in its own custom sized slab.
+static std::vector<size_t> makeSizes(size_t N, unsigned Seed) {
+  std::mt19937 Rng(Seed);
+  std::vector<size_t> Sizes;
+  Sizes.reserve(N);
+  for (size_t I = 0; I != N; ++I) {
+    unsigned R = Rng() % 1000;
+    if (R < 700)
+      Sizes.push_back(16 + 8 * (Rng() % 10));
+    else if (R < 990)
+      Sizes.push_back(64 + Rng() % 512);
+    else
+      Sizes.push_back(4096 + Rng() % 16384);
+  }
+  return Sizes;
+}
+
+static void BM_Allocate(benchmark::State &State) {
+  auto Sizes = makeSizes(State.range(0), 1);
+  for (auto _ : State) {
+    BumpPtrAllocator Alloc;
+    for (size_t Size : Sizes)
+      benchmark::DoNotOptimize(Alloc.Allocate(Size, Align(8)));
+  }
+  State.SetItemsProcessed(State.iterations() * Sizes.size());
+}
+BENCHMARK(BM_Allocate)->Range(64, 1 << 18);
+
+// A long lived allocator that is reset between functions keeps its first
+// slab, so this is the steady state cost of the fast path.
+static void BM_AllocateReset(benchmark::State &State) {
+  auto Sizes = makeSizes(State.range(0), 1);
+  BumpPtrAllocator Alloc;
+  for (auto _ : State) {
+    for (size_t Size : Sizes)
+      benchmark::DoNotOptimize(Alloc.Allocate(Size, Align(8)));
+    Alloc.Reset();
+  }
+  State.SetItemsProcessed(State.iterations() * Sizes.size());
+}
+BENCHMARK(BM_AllocateReset)->Range(64, 1 << 14);
+
+static void BM_AllocateAligned(benchmark::State &State) {
+  auto Sizes = makeSizes(1 << 12, 1);
+  Align A(State.range(0));
+  for (auto _ : State) {
+    BumpPtrAllocator Alloc;
+    for (size_t Size : Sizes)
+      benchmark::DoNotOptimize(Alloc.Allocate(Size, A));
+  }
+  State.SetItemsProcessed(State.iterations() * Sizes.size());
+}
+BENCHMARK(BM_AllocateAligned)->RangeMultiplier(2)->Range(1, 64);
+
+namespace {
+struct Node {
+  Node *Next;
+  std::vector<unsigned> Payload;
+  explicit Node(Node *Next) : Next(Next) {}
+};
+} // end anonymous namespace
+
+// SpecificBumpPtrAllocator runs destructors over every slab on destruction.
+static void BM_SpecificAllocate(benchmark::State &State) {
+  size_t N = State.range(0);
+  for (auto _ : State) {
+    SpecificBumpPtrAllocator<Node> Alloc;
+    Node *Head = nullptr;
+    for (size_t I = 0; I != N; ++I)
+      Head = new (Alloc.Allocate()) Node(Head);
+    benchmark::DoNotOptimize(Head);
+  }
+  State.SetItemsProcessed(State.iterations() * N);
+}
+BENCHMARK(BM_SpecificAllocate)->Range(64, 1 << 16);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,167 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Support/Allocator.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace llvm;
+
+// Sizes in bytes of the objects a module pass keys its maps on, weighted by
+// how often they show up in the heap of an LTO link: mostly instructions and
+// their operand lists, with constants, arguments, blocks and functions mixed
+// in.
+static const std::pair<unsigned, unsigned> ObjectSizes[] = {
+    {64, 38}, {72, 20}, {88, 12}, {24, 10}, {48, 8},
+    {40, 5},  {80, 4},  {120, 2}, {136, 1},
+};
+
+namespace {
+// Pointer keys laid out the way a BumpPtrAllocator backed context lays out IR
+// objects: densely packed within slabs, in allocation order, with the sizes
+// above. Keeping the allocator alive keeps the addresses stable, so hashing
+// sees the same bit patterns the compiler does.
+class IRPointerKeys {
+  BumpPtrAllocator Alloc;
+
+public:
+  std::vector<void *> Keys;
+
+  IRPointerKeys(size_t N, unsigned Seed) {
+    std::mt19937 Rng(Seed);
+    std::vector<unsigned> Weights;
+    for (const auto &S : ObjectSizes)
+      Weights.push_back(S.second);
+    std::discrete_distribution<unsigned> Pick(Weights.begin(), Weights.end());
+    Keys.reserve(N);
+    for (size_t I = 0; I != N; ++I)
+      Keys.push_back(Alloc.Allocate(ObjectSizes[Pick(Rng)].first, Align(8)));
+  }
+};
+} // end anonymous namespace
+
+// Lookups in a pass are heavily skewed towards a few hot values (the function,
+// its entry block, common constants), so draw the probe sequence from a Zipf
+// distribution over the inserted keys.
+static std::vector<void *> makeZipfProbes(const std::vector<void *> &Keys,
+                                          size_t NumProbes, unsigned Seed) {
+  std::vector<double> Weights;
+  Weights.reserve(Keys.size());
+  for (size_t I = 0; I != Keys.size(); ++I)
+    Weights.push_back(1.0 / std::pow(I + 1, 1.1));
+  std::mt19937 Rng(Seed);
+  std::discrete_distribution<size_t> Pick(Weights.begin(), Weights.end());
+  // Hot values are spread over the module rather than first in it.
+  std::vector<void *> Shuffled(Keys);
+  std::shuffle(Shuffled.begin(), Shuffled.end(), Rng);
+  std::vector<void *> Probes;
+  Probes.reserve(NumProbes);
+  for (size_t I = 0; I != NumProbes; ++I)
+    Probes.push_back(Shuffled[Pick(Rng)]);
+  return Probes;
+}
+
+static void BM_DenseMapInsert(benchmark::State &State) {
+  IRPointerKeys K(State.range(0), 1);
+  for (auto _ : State) {
+    DenseMap<void *, unsigned> Map;
+    for (void *Key : K.Keys)
+      Map[Key] = 1;
+    benchmark::DoNotOptimize(Map.size());
+  }
+  State.SetItemsProcessed(State.iterations() * K.Keys.size());
+}
+BENCHMARK(BM_DenseMapInsert)->Range(16, 1 << 18);
+
+static void BM_DenseMapInsertReserved(benchmark::State &State) {
+  IRPointerKeys K(State.range(0), 1);
+  for (auto _ : State) {
+    DenseMap<void *, unsigned> Map(K.Keys.size());
+    for (void *Key : K.Keys)
+      Map[Key] = 1;
+    benchmark::DoNotOptimize(Map.size());
+  }
+  State.SetItemsProcessed(State.iterations() * K.Keys.size());
+}
+BENCHMARK(BM_DenseMapInsertReserved)->Range(16, 1 << 18);
+
+static void BM_DenseMapLookupZipf(benchmark::State &State) {
+  IRPointerKeys K(State.range(0), 1);
+  auto Probes = makeZipfProbes(K.Keys, 1 << 14, 2);
+  DenseMap<void *, unsigned> Map;
+  for (void *Key : K.Keys)
+    Map[Key] = 1;
+  for (auto _ : State)
+    for (void *Key : Probes)
+      benchmark::DoNotOptimize(Map.find(Key));
+  State.SetItemsProcessed(State.iterations() * Probes.size());
+}
+BENCHMARK(BM_DenseMapLookupZipf)->Range(16, 1 << 18);
+
+static void BM_DenseMapLookupMiss(benchmark::State &State) {
+  IRPointerKeys K(State.range(0), 1);
+  IRPointerKeys Misses(State.range(0), 2);
+  DenseMap<void *, unsigned> Map;
+  for (void *Key : K.Keys)
+    Map[Key] = 1;
+  for (auto _ : State)
+    for (void *Key : Misses.Keys)
+      benchmark::DoNotOptimize(Map.find(Key));
+  State.SetItemsProcessed(State.iterations() * Misses.Keys.size());
+}
+BENCHMARK(BM_DenseMapLookupMiss)->Range(16, 1 << 18);
+
+// Worklist style churn: erase values as they are processed and insert newly
+// discovered ones, leaving the table full of tombstones.
+static void BM_DenseMapEraseInsert(benchmark::State &State) {
+  IRPointerKeys K(State.range(0) * 2, 1);
+  size_t Half = K.Keys.size() / 2;
+  for (auto _ : State) {
+    DenseMap<void *, unsigned> Map;
+    for (size_t I = 0; I != Half; ++I)
+      Map[K.Keys[I]] = I;
+    for (size_t I = 0; I != Half; ++I) {
+      Map.erase(K.Keys[I]);
+      Map[K.Keys[Half + I]] = I;
+    }
+    benchmark::DoNotOptimize(Map.size());
+  }
+  State.SetItemsProcessed(State.iterations() * K.Keys.size());
+}
+BENCHMARK(BM_DenseMapEraseInsert)->Range(16, 1 << 16);
+
+static void BM_DenseMapIterate(benchmark::State &State) {
+  IRPointerKeys K(State.range(0), 1);
+  DenseMap<void *, unsigned> Map;
+  for (void *Key : K.Keys)
+    Map[Key] = 1;
+  for (auto _ : State) {
+    unsigned Sum = 0;
+    for (auto &KV : Map)
+      Sum += KV.second;
+    benchmark::DoNotOptimize(Sum);
+  }
+  State.SetItemsProcessed(State.iterations() * Map.size());
+}
+BENCHMARK(BM_DenseMapIterate)->Range(16, 1 << 18);
+
+// Visited sets are usually small and short lived.
+template <typename SetT> static void BM_VisitedSet(benchmark::State &State) {
+  IRPointerKeys K(State.range(0), 1);
+  for (auto _ : State) {
+    SetT Visited;
+    for (void *Key : K.Keys)
+      benchmark::DoNotOptimize(Visited.insert(Key).second);
+    for (void *Key : K.Keys)
+      benchmark::DoNotOptimize(Visited.count(Key));
+  }
+  State.SetItemsProcessed(State.iterations() * K.Keys.size() * 2);
+}
+BENCHMARK_TEMPLATE(BM_VisitedSet, DenseSet<void *>)->Range(4, 1 << 12);
+BENCHMARK_TEMPLATE(BM_VisitedSet, SmallPtrSet<void *, 8>)->Range(4, 1 << 12);
+BENCHMARK_TEMPLATE(BM_VisitedSet, SmallPtrSet<void *, 32>)->Range(4, 1 << 12);
+
+BENCHMARK_MAIN();
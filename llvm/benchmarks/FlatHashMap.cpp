@@ -0,0 +1,86 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/FlatHashMap.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace llvm;
+
+template <typename KeyT> static std::vector<KeyT> makeKeys(size_t, unsigned);
+
+// Pointers spread like those of heap allocated IR objects.
+template <> std::vector<void *> makeKeys(size_t N, unsigned Seed) {
+  std::mt19937_64 Rng(Seed);
+  std::vector<void *> Keys;
+  Keys.reserve(N);
+  for (size_t I = 0; I != N; ++I)
+    Keys.push_back(reinterpret_cast<void *>((Rng() & 0xFFFFFFFFFFF0) | 0x10));
+  return Keys;
+}
+
+// Keep clear of the empty and tombstone keys of DenseMapInfo<unsigned>.
+template <> std::vector<unsigned> makeKeys(size_t N, unsigned Seed) {
+  std::mt19937 Rng(Seed);
+  std::vector<unsigned> Keys;
+  Keys.reserve(N);
+  for (size_t I = 0; I != N; ++I)
+    Keys.push_back(Rng() >> 2);
+  return Keys;
+}
+
+template <typename MapT> static void BM_Insert(benchmark::State &State) {
+  using KeyT = typename MapT::key_type;
+  auto Keys = makeKeys<KeyT>(State.range(0), 1);
+  for (auto _ : State) {
+    MapT Map;
+    for (KeyT Key : Keys)
+      Map[Key] = 1;
+    benchmark::DoNotOptimize(Map.size());
+  }
+  State.SetItemsProcessed(State.iterations() * Keys.size());
+}
+
+template <typename MapT> static void BM_LookupHit(benchmark::State &State) {
+  using KeyT = typename MapT::key_type;
+  auto Keys = makeKeys<KeyT>(State.range(0), 1);
+  MapT Map;
+  for (KeyT Key : Keys)
+    Map[Key] = 1;
+  for (auto _ : State)
+    for (KeyT Key : Keys)
+      benchmark::DoNotOptimize(Map.find(Key));
+  State.SetItemsProcessed(State.iterations() * Keys.size());
+}
+
+template <typename MapT> static void BM_LookupMiss(benchmark::State &State) {
+  using KeyT = typename MapT::key_type;
+  auto Keys = makeKeys<KeyT>(State.range(0), 1);
+  auto Misses = makeKeys<KeyT>(State.range(0), 2);
+  MapT Map;
+  for (KeyT Key : Keys)
+    Map[Key] = 1;
+  for (auto _ : State)
+    for (KeyT Key : Misses)
+      benchmark::DoNotOptimize(Map.find(Key));
+  State.SetItemsProcessed(State.iterations() * Misses.size());
+}
+
+#define MAP_BENCHMARKS(KeyT)                                                   \
+  BENCHMARK_TEMPLATE(BM_Insert, DenseMap<KeyT, unsigned>)                      \
+      ->Range(16, 1 << 20);                                                    \
+  BENCHMARK_TEMPLATE(BM_Insert, FlatHashMap<KeyT, unsigned>)                   \
+      ->Range(16, 1 << 20);                                                    \
+  BENCHMARK_TEMPLATE(BM_LookupHit, DenseMap<KeyT, unsigned>)                   \
+      ->Range(16, 1 << 20);                                                    \
+  BENCHMARK_TEMPLATE(BM_LookupHit, FlatHashMap<KeyT, unsigned>)                \
+      ->Range(16, 1 << 20);                                                    \
+  BENCHMARK_TEMPLATE(BM_LookupMiss, DenseMap<KeyT, unsigned>)                  \
+      ->Range(16, 1 << 20);                                                    \
+  BENCHMARK_TEMPLATE(BM_LookupMiss, FlatHashMap<KeyT, unsigned>)               \
+      ->Range(16, 1 << 20);
+
+MAP_BENCHMARKS(void *)
+MAP_BENCHMARKS(unsigned)
+
+BENCHMARK_MAIN();
@@ -0,0 +1,128 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/FoldingSet.h"
+#include "llvm/Support/Allocator.h"
+#include <random>
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+// A uniqued expression node in the shape of a SCEV or SDNode: an opcode, a
+// type and a short operand list of other nodes.
+struct ExprNode : public FoldingSetNode {
+  unsigned Opcode;
+  unsigned TypeID;
+  SmallVector<const ExprNode *, 4> Ops;
+
+  void Profile(FoldingSetNodeID &ID) const {
+    ID.AddInteger(Opcode);
+    ID.AddInteger(TypeID);
+    for (const ExprNode *Op : Ops)
+      ID.AddPointer(Op);
+  }
+};
+
+// A request for a node. Operands are positions of earlier requests in the
+// stream.
+struct ExprDesc {
+  unsigned Opcode;
+  unsigned TypeID;
+  SmallVector<unsigned, 4> Ops;
+};
+
+// Unique nodes the way the analyses do: profile the would-be node, look it up
+// and only allocate one on a miss.
+class Uniquer {
+  FoldingSet<ExprNode> Set;
+  BumpPtrAllocator Alloc;
+
+  const ExprNode *get(const ExprDesc &D,
+                      const std::vector<const ExprNode *> &Results) {
+    FoldingSetNodeID ID;
+    ID.AddInteger(D.Opcode);
+    ID.AddInteger(D.TypeID);
+    for (unsigned Op : D.Ops)
+      ID.AddPointer(Results[Op]);
+    void *IP = nullptr;
+    if (ExprNode *N = Set.FindNodeOrInsertPos(ID, IP))
+      return N;
+    ExprNode *N = new (Alloc) ExprNode();
+    N->Opcode = D.Opcode;
+    N->TypeID = D.TypeID;
+    for (unsigned Op : D.Ops)
+      N->Ops.push_back(Results[Op]);
+    Set.InsertNode(N, IP);
+    return N;
+  }
+
+public:
+  void replay(const std::vector<ExprDesc> &Stream,
+              std::vector<const ExprNode *> &Results) {
+    Results.resize(Stream.size());
+    for (size_t I = 0; I != Stream.size(); ++I)
+      Results[I] = get(Stream[I], Results);
+  }
+};
+} // end anonymous namespace
+
+// A stream of N node requests where roughly DupPercent of them repeat an
+// expression that was already requested, as happens when the same address
+// computation or value is analysed from several users. Operands always refer
+// to earlier requests so the stream replays in order.
+static std::vector<ExprDesc> makeStream(size_t N, unsigned DupPercent) {
+  std::mt19937 Rng(1);
+  std::vector<ExprDesc> Stream;
+  std::vector<size_t> Unique;
+  for (size_t I = 0; I != N; ++I) {
+    if (!Unique.empty() && Rng() % 100 < DupPercent) {
+      Stream.push_back(Stream[Unique[Rng() % Unique.size()]]);
+      continue;
+    }
+    ExprDesc D;
+    if (I < 8) {
+      // Leaves, distinguished by their type alone.
+      D.Opcode = 0;
+      D.TypeID = I;
+    } else {
+      D.Opcode = 1 + Rng() % 24;
+      D.TypeID = Rng() % 6;
+      for (unsigned Op = 0, E = 1 + Rng() % 3; Op != E; ++Op)
+        D.Ops.push_back(Rng() % I);
+    }
+    Unique.push_back(Stream.size());
+    Stream.push_back(D);
+  }
+  return Stream;
+}
+
+static void BM_GetOrInsert(benchmark::State &State) {
+  auto Stream = makeStream(State.range(0), State.range(1));
+  std::vector<const ExprNode *> Results;
+  for (auto _ : State) {
+    Uniquer U;
+    U.replay(Stream, Results);
+    benchmark::DoNotOptimize(Results.data());
+  }
+  State.SetItemsProcessed(State.iterations() * Stream.size());
+}
+static void streamArgs(benchmark::internal::Benchmark *B) {
+  for (int N = 256; N <= 1 << 18; N *= 8)
+    for (int DupPercent : {0, 50, 90})
+      B->Args({N, DupPercent});
+}
+BENCHMARK(BM_GetOrInsert)->Apply(streamArgs);
+
+static void BM_LookupHit(benchmark::State &State) {
+  auto Stream = makeStream(State.range(0), 0);
+  std::vector<const ExprNode *> Results;
+  Uniquer U;
+  U.replay(Stream, Results);
+  for (auto _ : State) {
+    U.replay(Stream, Results);
+    benchmark::DoNotOptimize(Results.data());
+  }
+  State.SetItemsProcessed(State.iterations() * Stream.size());
+}
+BENCHMARK(BM_LookupHit)->Range(256, 1 << 18);
+
+BENCHMARK_MAIN();
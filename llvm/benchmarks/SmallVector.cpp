@@ -0,0 +1,84 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/SmallVector.h"
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+// Push N elements into a vector with inline capacity for 8. The small sizes
+// stay inline; the large ones measure growth.
+template <typename T> static void BM_PushBack(benchmark::State &State) {
+  size_t N = State.range(0);
+  for (auto _ : State) {
+    SmallVector<T, 8> V;
+    for (size_t I = 0; I != N; ++I)
+      V.push_back(T());
+    benchmark::DoNotOptimize(V.data());
+  }
+  State.SetItemsProcessed(State.iterations() * N);
+}
+BENCHMARK_TEMPLATE(BM_PushBack, void *)->RangeMultiplier(2)->Range(4, 1 << 12);
+BENCHMARK_TEMPLATE(BM_PushBack, std::string)
+    ->RangeMultiplier(2)
+    ->Range(4, 1 << 10);
+
+// Operand and use lists are built, copied and thrown away constantly; most of
+// them have fewer than four elements.
+static void BM_CopySmall(benchmark::State &State) {
+  std::mt19937 Rng(1);
+  std::vector<SmallVector<void *, 4>> Lists(1024);
+  for (auto &L : Lists)
+    L.resize(Rng() % 2 ? Rng() % 4 : Rng() % 16);
+  for (auto _ : State)
+    for (const auto &L : Lists) {
+      SmallVector<void *, 4> Copy(L);
+      benchmark::DoNotOptimize(Copy.data());
+    }
+  State.SetItemsProcessed(State.iterations() * Lists.size());
+}
+BENCHMARK(BM_CopySmall);
+
+static void BM_MoveSmall(benchmark::State &State) {
+  std::mt19937 Rng(1);
+  std::vector<SmallVector<void *, 4>> Lists(1024);
+  for (auto &L : Lists)
+    L.resize(Rng() % 2 ? Rng() % 4 : Rng() % 16);
+  for (auto _ : State)
+    for (auto &L : Lists) {
+      SmallVector<void *, 4> Moved(std::move(L));
+      L = std::move(Moved);
+      benchmark::DoNotOptimize(L.data());
+    }
+  State.SetItemsProcessed(State.iterations() * Lists.size() * 2);
+}
+BENCHMARK(BM_MoveSmall);
+
+// Inserting into and erasing from the middle, as instruction lists and
+// scheduling queues do.
+static void BM_InsertEraseMiddle(benchmark::State &State) {
+  size_t N = State.range(0);
+  SmallVector<unsigned, 16> V(N, 0);
+  for (auto _ : State) {
+    V.insert(V.begin() + N / 2, 1u);
+    V.erase(V.begin() + N / 3);
+    benchmark::DoNotOptimize(V.data());
+  }
+  State.SetItemsProcessed(State.iterations() * 2);
+}
+BENCHMARK(BM_InsertEraseMiddle)->Range(16, 1 << 14);
+
+static void BM_Append(benchmark::State &State) {
+  size_t N = State.range(0);
+  std::vector<unsigned> Src(N, 7);
+  for (auto _ : State) {
+    SmallVector<unsigned, 32> V;
+    V.append(Src.begin(), Src.end());
+    V.append(Src.begin(), Src.end());
+    benchmark::DoNotOptimize(V.data());
+  }
+  State.SetItemsProcessed(State.iterations() * N * 2);
+}
+BENCHMARK(BM_Append)->Range(4, 1 << 14);
+
+BENCHMARK_MAIN();
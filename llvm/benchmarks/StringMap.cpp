@@ -0,0 +1,103 @@
+#include "benchmark/benchmark.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/StringSaver.h"
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+// Itanium mangled names, the bulk of the keys in symbol tables during an LTO
+// link. They share long prefixes (namespaces, common classes) and are between
+// a dozen and a few hundred bytes long.
+static std::vector<std::string> makeSymbols(size_t N, unsigned Seed) {
+  static const char *const Namespaces[] = {"4llvm", "3std", "5clang", "3lld",
+                                           "6detail", "4mlir", "5boost"};
+  static const char *const Classes[] = {"11SmallVector", "8DenseMap",
+                                        "9StringRef", "6Module", "8Function",
+                                        "10BasicBlock", "11Instruction",
+                                        "6vector", "12basic_string"};
+  std::mt19937 Rng(Seed);
+  std::vector<std::string> Syms;
+  Syms.reserve(N);
+  for (size_t I = 0; I != N; ++I) {
+    std::string S = "_ZN";
+    for (unsigned D = 1 + Rng() % 3; D; --D)
+      S += Namespaces[Rng() % 7];
+    S += Classes[Rng() % 9];
+    // A unique member name of typical length.
+    std::string Member = "m" + std::to_string(Rng()) + std::to_string(I);
+    S += std::to_string(Member.size()) + Member + "E";
+    for (unsigned P = Rng() % 4; P; --P)
+      S += Rng() % 2 ? "RKS_" : "PNS_11Instruction";
+    if (S.back() == 'E')
+      S += 'v';
+    Syms.push_back(std::move(S));
+  }
+  return Syms;
+}
+
+static void BM_StringMapInsert(benchmark::State &State) {
+  auto Syms = makeSymbols(State.range(0), 1);
+  for (auto _ : State) {
+    StringMap<unsigned> Map;
+    for (const std::string &S : Syms)
+      Map[S] = 1;
+    benchmark::DoNotOptimize(Map.size());
+  }
+  State.SetItemsProcessed(State.iterations() * Syms.size());
+}
+BENCHMARK(BM_StringMapInsert)->Range(16, 1 << 18);
+
+static void BM_StringMapLookupHit(benchmark::State &State) {
+  auto Syms = makeSymbols(State.range(0), 1);
+  StringMap<unsigned> Map;
+  for (const std::string &S : Syms)
+    Map[S] = 1;
+  // Look up through separate storage so that no pointer comparison can
+  // short circuit the string compare.
+  BumpPtrAllocator Alloc;
+  StringSaver Saver(Alloc);
+  std::vector<StringRef> Probes;
+  for (const std::string &S : Syms)
+    Probes.push_back(Saver.save(S));
+  for (auto _ : State)
+    for (StringRef S : Probes)
+      benchmark::DoNotOptimize(Map.find(S));
+  State.SetItemsProcessed(State.iterations() * Probes.size());
+}
+BENCHMARK(BM_StringMapLookupHit)->Range(16, 1 << 18);
+
+static void BM_StringMapLookupMiss(benchmark::State &State) {
+  auto Syms = makeSymbols(State.range(0), 1);
+  auto Misses = makeSymbols(State.range(0), 2);
+  StringMap<unsigned> Map;
+  for (const std::string &S : Syms)
+    Map[S] = 1;
+  for (auto _ : State)
+    for (const std::string &S : Misses)
+      benchmark::DoNotOptimize(Map.find(S));
+  State.SetItemsProcessed(State.iterations() * Misses.size());
+}
+BENCHMARK(BM_StringMapLookupMiss)->Range(16, 1 << 18);
+
+// Symbol resolution inserts every name and most of them are duplicates of
+// names already seen in other object files.
+static void BM_StringSetDedup(benchmark::State &State) {
+  auto Syms = makeSymbols(State.range(0), 1);
+  std::mt19937 Rng(3);
+  std::vector<StringRef> Stream;
+  for (size_t I = 0; I != Syms.size() * 4; ++I)
+    Stream.push_back(Syms[Rng() % Syms.size()]);
+  for (auto _ : State) {
+    StringSet<> Set;
+    for (StringRef S : Stream)
+      Set.insert(S);
+    benchmark::DoNotOptimize(Set.size());
+  }
+  State.SetItemsProcessed(State.iterations() * Stream.size());
+}
+BENCHMARK(BM_StringSetDedup)->Range(16, 1 << 16);
+
+BENCHMARK_MAIN();
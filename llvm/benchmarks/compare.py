@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+#===- compare.py - Compare two sets of benchmark results -----*- python -*--===#
+#
+# Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+#
+#===------------------------------------------------------------------------===#
+'''Compare the JSON output of two runs of the LLVM benchmarks.
+
+Run each benchmark binary against the baseline and the modified tree with
+JSON output, preferably with repetitions so that noise can be told apart
+from real changes:
+
+    ./benchmarks/DenseMap --benchmark_repetitions=10 \\
+            --benchmark_out=base.json --benchmark_out_format=json
+
+then compare the two files:
+
+    ./benchmarks/compare.py base.json new.json
+
+Each benchmark is summarised by the median of its repetitions. A benchmark
+whose time grew by more than --threshold percent is reported as a regression
+and makes the script exit with status 1, so it can gate a change in CI.
+Either side may also be a directory, in which case all the .json files in
+it are read, so the results of every benchmark binary can be compared at once:
+
+    ./benchmarks/compare.py base-results/ new-results/
+'''
+
+from __future__ import print_function
+
+import argparse
+import glob
+import json
+import os
+import re
+import statistics
+import sys
+
+AGGREGATE_SUFFIX = re.compile(r'_(mean|median|stddev|cv)$')
+TIME_UNITS = {'ns': 1.0, 'us': 1e3, 'ms': 1e6, 's': 1e9}
+
+
+def load(path, metric, name_filter):
+    '''Return a map from benchmark name to the list of times, in nanoseconds,
+    of its runs in the given file or directory.'''
+    if os.path.isdir(path):
+        paths = sorted(glob.glob(os.path.join(path, '*.json')))
+    else:
+        paths = [path]
+    times = {}
+    for path in paths:
+        with open(path) as f:
+            data = json.load(f)
+        for run in data.get('benchmarks', []):
+            # Aggregates (mean, median, stddev) are recomputed from the
+            # individual repetitions. Older versions of the library only mark
+            # them with a suffix.
+            if (run.get('run_type') == 'aggregate' or
+                    AGGREGATE_SUFFIX.search(run['name'])):
+                continue
+            name = run.get('run_name', run['name'])
+            if name_filter and not name_filter.search(name):
+                continue
+            scale = TIME_UNITS[run.get('time_unit', 'ns')]
+            times.setdefault(name, []).append(run[metric] * scale)
+    return times
+
+
+def format_time(ns):
+    for unit in ('s', 'ms', 'us'):
+        if ns >= TIME_UNITS[unit]:
+            return '%.3g %s' % (ns / TIME_UNITS[unit], unit)
+    return '%.3g ns' % ns
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__, formatter_class=argparse.RawTextHelpFormatter)
+    parser.add_argument('baseline', help='JSON file or directory')
+    parser.add_argument('contender', help='JSON file or directory')
+    parser.add_argument('--metric', choices=('cpu_time', 'real_time'),
+                        default='cpu_time', help='time to compare')
+    parser.add_argument('--threshold', type=float, default=5.0,
+                        help='slowdown, in percent, reported as a regression')
+    parser.add_argument('--filter', type=re.compile,
+                        help='only compare benchmarks matching this regex')
+    parser.add_argument('--all', action='store_true',
+                        help='also list benchmarks that did not change')
+    args = parser.parse_args()
+
+    base = load(args.baseline, args.metric, args.filter)
+    new = load(args.contender, args.metric, args.filter)
+
+    rows = []
+    regressions = 0
+    for name in [n for n in base if n in new]:
+        old_time = statistics.median(base[name])
+        new_time = statistics.median(new[name])
+        change = (new_time - old_time) / old_time * 100 if old_time else 0.0
+        # With repetitions, only trust a change that moves the whole
+        # distribution: the fastest new run must be slower than the slowest
+        # old one (or the other way around for improvements).
+        if len(base[name]) > 1 and len(new[name]) > 1:
+            noisy = not (min(new[name]) > max(base[name]) or
+                         max(new[name]) < min(base[name]))
+        else:
+            noisy = False
+        if change > args.threshold and not noisy:
+            status = 'REGRESSION'
+            regressions += 1
+        elif change < -args.threshold and not noisy:
+            status = 'improvement'
+        elif abs(change) > args.threshold:
+            status = 'noise'
+        else:
+            status = ''
+        if status or args.all:
+            rows.append((name, format_time(old_time), format_time(new_time),
+                         '%+.1f%%' % change, status))
+
+    for name in sorted(set(base) ^ set(new)):
+        rows.append((name, '-' if name not in base else 'ran',
+                     '-' if name not in new else 'ran', '', 'missing'))
+
+    if rows:
+        header = ('Benchmark', 'Baseline', 'New', 'Change', '')
+        widths = [max(len(r[i]) for r in rows + [header]) for i in range(4)]
+        for row in [header] + rows:
+            print('%-*s  %*s  %*s  %*s  %s' % (
+                widths[0], row[0], widths[1], row[1], widths[2], row[2],
+                widths[3], row[3], row[4]))
+    print('%d benchmarks compared, %d regressions above %.1f%%' %
+          (len(set(base) & set(new)), regressions, args.threshold))
+    return 1 if regressions else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -87,6 +87,10 @@ public:
 
   static constexpr WordType WORDTYPE_MAX = ~WordType(0);
 
+  /// Values of up to this many words are stored inside the APInt itself, so
+  /// that i128 arithmetic does not hit the heap.
+  static constexpr unsigned NumInlineWords = 2;
+
 private:
   /// This union is used to store the integer value. When the
   /// integer bit-width <= 64, it uses VAL, otherwise it uses pVal.
@@ -97,6 +101,11 @@ private:
 
   unsigned BitWidth; ///< The number of bits in this APInt.
 
+  /// The words of a multi-word value that fits in NumInlineWords words. pVal
+  /// points here for such values, so code handling multi-word values need
+  /// not care where they live.
+  uint64_t InlineWords[NumInlineWords];
+
   friend struct DenseMapInfo<APInt>;
 
   friend class APSInt;
@@ -109,11 +118,40 @@ private:
     U.pVal = val;
   }
 
+  struct UninitializedTag {};
+
+  /// Fast internal constructor for temporaries whose words are filled in by
+  /// the caller.
+  APInt(unsigned bits, UninitializedTag) : BitWidth(bits) {
+    if (!isSingleWord())
+      allocateWords();
+  }
+
   /// Determine if this APInt just has one word to store value.
   ///
   /// \returns true if the number of bits <= 64, false otherwise.
   bool isSingleWord() const { return BitWidth <= APINT_BITS_PER_WORD; }
 
+  /// Point pVal at storage for getNumWords() words, inline if they fit. The
+  /// contents are left uninitialized.
+  void allocateWords() {
+    U.pVal = needsCleanup() ? new uint64_t[getNumWords()] : InlineWords;
+  }
+
+  /// Take over the value of \p that, which is left with zero width.
+  void stealValue(APInt &that) {
+    BitWidth = that.BitWidth;
+    if (isSingleWord() || needsCleanup()) {
+      // Use memcpy so that type based alias analysis sees both VAL and pVal
+      // as modified.
+      memcpy(&U, &that.U, sizeof(U));
+    } else {
+      memcpy(InlineWords, that.InlineWords, sizeof(InlineWords));
+      U.pVal = InlineWords;
+    }
+    that.BitWidth = 0;
+  }
+
   /// Determine which word a bit is in.
   ///
   /// \returns the word position for the specified bit position.
@@ -327,10 +365,7 @@ public:
   }
 
   /// Move Constructor.
-  APInt(APInt &&that) : BitWidth(that.BitWidth) {
-    memcpy(&U, &that.U, sizeof(U));
-    that.BitWidth = 0;
-  }
+  APInt(APInt &&that) { stealValue(that); }
 
   /// Destructor.
   ~APInt() {
@@ -346,7 +381,7 @@ public:
   explicit APInt() : BitWidth(1) { U.VAL = 0; }
 
   /// Returns whether this instance allocated memory.
-  bool needsCleanup() const { return !isSingleWord(); }
+  bool needsCleanup() const { return getNumWords() > NumInlineWords; }
 
   /// Used to insert APInt objects, or objects that contain APInt objects, into
   ///  FoldingSets.
@@ -771,16 +806,10 @@ public:
       return *this;
 #endif
     assert(this != &that && "Self-move not supported");
-    if (!isSingleWord())
+    if (needsCleanup())
       delete[] U.pVal;
 
-    // Use memcpy so that type based alias analysis sees both VAL and pVal
-    // as modified.
-    memcpy(&U, &that.U, sizeof(U));
-
-    BitWidth = that.BitWidth;
-    that.BitWidth = 0;
-
+    stealValue(that);
     return *this;
   }
 
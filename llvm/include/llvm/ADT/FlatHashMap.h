@@ -0,0 +1,587 @@
+//===- llvm/ADT/FlatHashMap.h - Group probed hash table ---------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the FlatHashMap class, an open addressing hash map that
+// keeps one control byte per bucket, in the style of "Swiss tables".
+//
+// A control byte is either empty, deleted, or holds 7 bits of the hash of the
+// key in the bucket. Lookups compare a group of control bytes at once, with
+// SSE2 when available, and only compare the keys of the buckets whose control
+// byte matches. Unlike DenseMap, keys need no empty or tombstone values, and
+// failed lookups stop at the first group with an empty bucket.
+//
+// FlatHashMap uses DenseMapInfo for hashing and comparing keys, and has the
+// same interface as DenseMap for the common operations, so that performance
+// sensitive users can switch between the two.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ADT_FLATHASHMAP_H
+#define LLVM_ADT_FLATHASHMAP_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/ADT/EpochTracker.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemAlloc.h"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LLVM_FLATHASHMAP_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace llvm {
+
+namespace detail {
+
+/// Control bytes of the buckets that are not full. Full buckets have 7 bits of
+/// the hash of their key, so only empty and deleted buckets have the high bit
+/// set.
+enum : int8_t { FlatHashEmpty = -128, FlatHashDeleted = -2 };
+
+#if LLVM_FLATHASHMAP_USE_SSE2
+/// A group of control bytes compared with SSE2. Bit I of the masks stands for
+/// bucket I of the group.
+struct FlatHashGroup {
+  static constexpr unsigned Width = 16;
+  static constexpr unsigned Stride = 1;
+  using MaskT = uint32_t;
+
+  __m128i Ctrl;
+
+  explicit FlatHashGroup(const int8_t *Pos)
+      : Ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(Pos))) {}
+
+  MaskT match(int8_t H2) const {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(H2), Ctrl));
+  }
+  MaskT matchEmpty() const { return match(FlatHashEmpty); }
+  MaskT matchEmptyOrDeleted() const { return _mm_movemask_epi8(Ctrl); }
+};
+#else
+/// A group of control bytes compared as a 64 bit word. Bit 8 * I + 7 of the
+/// masks stands for bucket I of the group.
+struct FlatHashGroup {
+  static constexpr unsigned Width = 8;
+  static constexpr unsigned Stride = 8;
+  using MaskT = uint64_t;
+
+  static constexpr uint64_t LSBs = 0x0101010101010101ULL;
+  static constexpr uint64_t MSBs = 0x8080808080808080ULL;
+
+  uint64_t Ctrl;
+
+  explicit FlatHashGroup(const int8_t *Pos)
+      : Ctrl(support::endian::read64le(Pos)) {}
+
+  /// This may report full buckets next to a match, whose keys are compared
+  /// anyway.
+  MaskT match(int8_t H2) const {
+    uint64_t X = Ctrl ^ (LSBs * uint8_t(H2));
+    return (X - LSBs) & ~X & MSBs;
+  }
+  MaskT matchEmpty() const { return Ctrl & (~Ctrl << 6) & MSBs; }
+  MaskT matchEmptyOrDeleted() const { return Ctrl & MSBs; }
+};
+#endif
+
+/// The index in its group of the first bucket of a non-zero mask.
+inline unsigned flatHashLowest(FlatHashGroup::MaskT M) {
+  return countTrailingZeros(M) / FlatHashGroup::Stride;
+}
+
+/// The number of buckets at the end of the group after the last one of \p M.
+inline unsigned flatHashLeading(FlatHashGroup::MaskT M) {
+  constexpr unsigned Unused = sizeof(FlatHashGroup::MaskT) * CHAR_BIT -
+                              FlatHashGroup::Width * FlatHashGroup::Stride;
+  FlatHashGroup::MaskT Shifted = M << Unused;
+  return countLeadingZeros(Shifted) / FlatHashGroup::Stride;
+}
+
+} // end namespace detail
+
+template <typename KeyT, typename ValueT,
+          typename KeyInfoT = DenseMapInfo<KeyT>>
+class FlatHashMap : public DebugEpochBase {
+  using BucketT = detail::DenseMapPair<KeyT, ValueT>;
+  using Group = detail::FlatHashGroup;
+
+  template <typename T>
+  using const_arg_type_t = typename const_pointer_or_const_ref<T>::type;
+
+  template <bool IsConst> class Iterator;
+
+  /// NumBuckets is 0 or a power of two of at least MinBuckets. The control
+  /// bytes follow the buckets in the same allocation, and the first group of
+  /// them is repeated after the last one, so that a group can be loaded from
+  /// any bucket.
+  BucketT *Buckets = nullptr;
+  int8_t *Ctrl = nullptr;
+  size_t NumBuckets = 0;
+  size_t NumEntries = 0;
+  /// The number of entries that can be inserted in empty buckets before the
+  /// table is rehashed. Deleted buckets are reused without counting.
+  size_t GrowthLeft = 0;
+
+  static constexpr size_t MinBuckets = 16;
+  static_assert(MinBuckets >= Group::Width, "groups would wrap around");
+
+public:
+  using size_type = unsigned;
+  using key_type = KeyT;
+  using mapped_type = ValueT;
+  using value_type = BucketT;
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  explicit FlatHashMap(unsigned InitialReserve = 0) { reserve(InitialReserve); }
+
+  FlatHashMap(std::initializer_list<std::pair<KeyT, ValueT>> Vals) {
+    reserve(Vals.size());
+    for (const auto &Val : Vals)
+      insert(Val);
+  }
+
+  template <typename InputIt> FlatHashMap(const InputIt &I, const InputIt &E) {
+    insert(I, E);
+  }
+
+  FlatHashMap(const FlatHashMap &Other) : DebugEpochBase() {
+    if (!Other.NumBuckets)
+      return;
+    allocate(Other.NumBuckets);
+    std::memcpy(Ctrl, Other.Ctrl, NumBuckets + Group::Width);
+    for (size_t I = 0; I != NumBuckets; ++I)
+      if (Ctrl[I] >= 0)
+        ::new (&Buckets[I]) BucketT(Other.Buckets[I]);
+    NumEntries = Other.NumEntries;
+    GrowthLeft = Other.GrowthLeft;
+  }
+
+  FlatHashMap(FlatHashMap &&Other) : DebugEpochBase() { swap(Other); }
+
+  ~FlatHashMap() {
+    destroyAll();
+    deallocate();
+  }
+
+  FlatHashMap &operator=(const FlatHashMap &Other) {
+    if (&Other != this) {
+      FlatHashMap Copy(Other);
+      swap(Copy);
+    }
+    return *this;
+  }
+
+  FlatHashMap &operator=(FlatHashMap &&Other) {
+    FlatHashMap Moved(std::move(Other));
+    swap(Moved);
+    return *this;
+  }
+
+  void swap(FlatHashMap &Other) {
+    incrementEpoch();
+    Other.incrementEpoch();
+    std::swap(Buckets, Other.Buckets);
+    std::swap(Ctrl, Other.Ctrl);
+    std::swap(NumBuckets, Other.NumBuckets);
+    std::swap(NumEntries, Other.NumEntries);
+    std::swap(GrowthLeft, Other.GrowthLeft);
+  }
+
+  iterator begin() { return iterator(Ctrl, Ctrl + NumBuckets, Buckets, *this); }
+  iterator end() { return makeIterator(NumBuckets); }
+  const_iterator begin() const {
+    return const_iterator(Ctrl, Ctrl + NumBuckets, Buckets, *this);
+  }
+  const_iterator end() const { return makeIterator(NumBuckets); }
+
+  LLVM_NODISCARD bool empty() const { return NumEntries == 0; }
+  unsigned size() const { return NumEntries; }
+
+  /// Grow the map so that it can contain at least \p Size items before
+  /// resizing again.
+  void reserve(size_type Size) {
+    incrementEpoch();
+    if (!Size)
+      return;
+    size_t NewNumBuckets = MinBuckets;
+    while (capacityToGrowth(NewNumBuckets) < Size)
+      NewNumBuckets *= 2;
+    if (NewNumBuckets > NumBuckets)
+      rehash(NewNumBuckets);
+  }
+
+  void clear() {
+    incrementEpoch();
+    if (NumEntries == 0 && GrowthLeft == capacityToGrowth(NumBuckets))
+      return;
+    destroyAll();
+    std::memset(Ctrl, detail::FlatHashEmpty, NumBuckets + Group::Width);
+    NumEntries = 0;
+    GrowthLeft = capacityToGrowth(NumBuckets);
+  }
+
+  /// Return 1 if the specified key is in the map, 0 otherwise.
+  size_type count(const_arg_type_t<KeyT> Val) const {
+    return findIndex(Val, hashOf(Val)) != NumBuckets;
+  }
+
+  iterator find(const_arg_type_t<KeyT> Val) {
+    return makeIterator(findIndex(Val, hashOf(Val)));
+  }
+  const_iterator find(const_arg_type_t<KeyT> Val) const {
+    return makeIterator(findIndex(Val, hashOf(Val)));
+  }
+
+  /// Alternate version of find() which allows a different, and possibly less
+  /// expensive, key type. The DenseMapInfo is responsible for supplying
+  /// methods getHashValue(LookupKeyT) and isEqual(LookupKeyT, KeyT) for each
+  /// key type used.
+  template <class LookupKeyT> iterator find_as(const LookupKeyT &Val) {
+    return makeIterator(findIndex(Val, hashOf(Val)));
+  }
+  template <class LookupKeyT>
+  const_iterator find_as(const LookupKeyT &Val) const {
+    return makeIterator(findIndex(Val, hashOf(Val)));
+  }
+
+  /// Return the entry for the specified key, or a default constructed value
+  /// if no such entry exists.
+  ValueT lookup(const_arg_type_t<KeyT> Val) const {
+    size_t I = findIndex(Val, hashOf(Val));
+    if (I != NumBuckets)
+      return Buckets[I].getSecond();
+    return ValueT();
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // If the key is already in the map, it returns false and doesn't update the
+  // value.
+  std::pair<iterator, bool> insert(const std::pair<KeyT, ValueT> &KV) {
+    return try_emplace(KV.first, KV.second);
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // If the key is already in the map, it returns false and doesn't update the
+  // value.
+  std::pair<iterator, bool> insert(std::pair<KeyT, ValueT> &&KV) {
+    return try_emplace(std::move(KV.first), std::move(KV.second));
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // The value is constructed in-place if the key is not in the map, otherwise
+  // it is not moved.
+  template <typename... Ts>
+  std::pair<iterator, bool> try_emplace(KeyT &&Key, Ts &&... Args) {
+    return tryEmplaceImpl(std::move(Key), std::forward<Ts>(Args)...);
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // The value is constructed in-place if the key is not in the map, otherwise
+  // it is not moved.
+  template <typename... Ts>
+  std::pair<iterator, bool> try_emplace(const KeyT &Key, Ts &&... Args) {
+    return tryEmplaceImpl(Key, std::forward<Ts>(Args)...);
+  }
+
+  /// Insert a range of pairs.
+  template <typename InputIt> void insert(InputIt I, InputIt E) {
+    for (; I != E; ++I)
+      insert(*I);
+  }
+
+  bool erase(const KeyT &Val) {
+    size_t I = findIndex(Val, hashOf(Val));
+    if (I == NumBuckets)
+      return false;
+    eraseIndex(I);
+    return true;
+  }
+  void erase(iterator I) {
+    assert(I.isHandleInSync() && "invalid iterator access!");
+    eraseIndex(I.Ptr - Buckets);
+  }
+
+  ValueT &operator[](const KeyT &Key) {
+    return tryEmplaceImpl(Key).first->getSecond();
+  }
+  ValueT &operator[](KeyT &&Key) {
+    return tryEmplaceImpl(std::move(Key)).first->getSecond();
+  }
+
+  /// Return the approximate size (in bytes) of the actual map.
+  size_t getMemorySize() const {
+    return NumBuckets ? allocationSize(NumBuckets) : 0;
+  }
+
+private:
+  static size_t capacityToGrowth(size_t N) { return N - N / 8; }
+
+  static size_t allocationSize(size_t N) {
+    return N * sizeof(BucketT) + N + Group::Width;
+  }
+
+  /// Mix the hash so that the bits used for the position and for the control
+  /// byte are well distributed, as DenseMapInfo hashes are often weak.
+  template <typename LookupKeyT> static uint64_t hashOf(const LookupKeyT &Val) {
+    uint64_t H = uint64_t(KeyInfoT::getHashValue(Val)) * 0x9E3779B97F4A7C15ULL;
+    return H ^ (H >> 32);
+  }
+  static int8_t h2(uint64_t H) { return H & 0x7F; }
+
+  iterator makeIterator(size_t I) {
+    return iterator(Ctrl + I, Ctrl + NumBuckets, Buckets + I, *this, true);
+  }
+  const_iterator makeIterator(size_t I) const {
+    return const_iterator(Ctrl + I, Ctrl + NumBuckets, Buckets + I, *this,
+                          true);
+  }
+
+  /// Return the index of the bucket of \p Val, or NumBuckets if it is not in
+  /// the map. Groups are probed with triangular steps, which visit all of them.
+  template <typename LookupKeyT>
+  size_t findIndex(const LookupKeyT &Val, uint64_t H) const {
+    if (NumBuckets == 0)
+      return 0;
+    size_t Mask = NumBuckets - 1;
+    size_t Pos = (H >> 7) & Mask;
+    for (size_t Step = Group::Width;; Step += Group::Width) {
+      Group G(Ctrl + Pos);
+      for (Group::MaskT M = G.match(h2(H)); M; M &= M - 1) {
+        size_t I = (Pos + detail::flatHashLowest(M)) & Mask;
+        if (LLVM_LIKELY(KeyInfoT::isEqual(Val, Buckets[I].getFirst())))
+          return I;
+      }
+      if (LLVM_LIKELY(G.matchEmpty()))
+        return NumBuckets;
+      Pos = (Pos + Step) & Mask;
+    }
+  }
+
+  /// Return the first empty or deleted bucket in the probe sequence of \p H.
+  size_t findInsertIndex(uint64_t H) const {
+    size_t Mask = NumBuckets - 1;
+    size_t Pos = (H >> 7) & Mask;
+    for (size_t Step = Group::Width;; Step += Group::Width) {
+      if (Group::MaskT M = Group(Ctrl + Pos).matchEmptyOrDeleted())
+        return (Pos + detail::flatHashLowest(M)) & Mask;
+      Pos = (Pos + Step) & Mask;
+    }
+  }
+
+  /// Set the control byte of bucket \p I, and its copy after the last group.
+  void setCtrl(size_t I, int8_t C) {
+    Ctrl[I] = C;
+    Ctrl[((I - Group::Width) & (NumBuckets - 1)) + Group::Width] = C;
+  }
+
+  template <typename KeyArg, typename... Ts>
+  std::pair<iterator, bool> tryEmplaceImpl(KeyArg &&Key, Ts &&... Args) {
+    uint64_t H = hashOf(Key);
+    size_t I = findIndex(Key, H);
+    if (I != NumBuckets)
+      return std::make_pair(makeIterator(I), false); // Already in map.
+
+    I = prepareInsert(H);
+    BucketT *B = &Buckets[I];
+    ::new (&B->getFirst()) KeyT(std::forward<KeyArg>(Key));
+    ::new (&B->getSecond()) ValueT(std::forward<Ts>(Args)...);
+    return std::make_pair(makeIterator(I), true);
+  }
+
+  /// Claim a bucket for a new entry with hash \p H, rehashing if needed.
+  size_t prepareInsert(uint64_t H) {
+    incrementEpoch();
+    size_t I = NumBuckets ? findInsertIndex(H) : 0;
+    if (LLVM_UNLIKELY(NumBuckets == 0 ||
+                      (GrowthLeft == 0 && Ctrl[I] == detail::FlatHashEmpty))) {
+      // Reclaim the deleted buckets if they are most of the used ones, as the
+      // table is as large as its entries need.
+      if (NumBuckets == 0)
+        rehash(MinBuckets);
+      else if (NumEntries * 2 <= capacityToGrowth(NumBuckets))
+        rehash(NumBuckets);
+      else
+        rehash(NumBuckets * 2);
+      I = findInsertIndex(H);
+    }
+    if (Ctrl[I] == detail::FlatHashEmpty)
+      --GrowthLeft;
+    ++NumEntries;
+    setCtrl(I, h2(H));
+    return I;
+  }
+
+  void eraseIndex(size_t I) {
+    incrementEpoch();
+    Buckets[I].~BucketT();
+    --NumEntries;
+
+    // If the bucket is not in a run of Width full or deleted buckets, no
+    // probe sequence went past it, so it can be marked empty again.
+    size_t Before = (I - Group::Width) & (NumBuckets - 1);
+    Group::MaskT EmptyAfter = Group(Ctrl + I).matchEmpty();
+    Group::MaskT EmptyBefore = Group(Ctrl + Before).matchEmpty();
+    if (EmptyBefore && EmptyAfter &&
+        detail::flatHashLowest(EmptyAfter) +
+                detail::flatHashLeading(EmptyBefore) <
+            Group::Width) {
+      setCtrl(I, detail::FlatHashEmpty);
+      ++GrowthLeft;
+      return;
+    }
+    setCtrl(I, detail::FlatHashDeleted);
+  }
+
+  void allocate(size_t N) {
+    NumBuckets = N;
+    Buckets = static_cast<BucketT *>(
+        allocate_buffer(allocationSize(N), alignof(BucketT)));
+    Ctrl = reinterpret_cast<int8_t *>(Buckets + N);
+  }
+
+  void deallocate() {
+    if (NumBuckets)
+      deallocate_buffer(Buckets, allocationSize(NumBuckets), alignof(BucketT));
+  }
+
+  void destroyAll() {
+    if (std::is_trivially_destructible<BucketT>::value)
+      return;
+    for (size_t I = 0; I != NumBuckets; ++I)
+      if (Ctrl[I] >= 0)
+        Buckets[I].~BucketT();
+  }
+
+  void rehash(size_t NewNumBuckets) {
+    BucketT *OldBuckets = Buckets;
+    int8_t *OldCtrl = Ctrl;
+    size_t OldNumBuckets = NumBuckets;
+
+    allocate(NewNumBuckets);
+    std::memset(Ctrl, detail::FlatHashEmpty, NumBuckets + Group::Width);
+    GrowthLeft = capacityToGrowth(NumBuckets) - NumEntries;
+    for (size_t I = 0; I != OldNumBuckets; ++I) {
+      if (OldCtrl[I] < 0)
+        continue;
+      BucketT &B = OldBuckets[I];
+      uint64_t H = hashOf(B.getFirst());
+      size_t J = findInsertIndex(H);
+      setCtrl(J, h2(H));
+      ::new (&Buckets[J].getFirst()) KeyT(std::move(B.getFirst()));
+      ::new (&Buckets[J].getSecond()) ValueT(std::move(B.getSecond()));
+      B.~BucketT();
+    }
+    if (OldNumBuckets)
+      deallocate_buffer(OldBuckets, allocationSize(OldNumBuckets),
+                        alignof(BucketT));
+  }
+};
+
+template <typename KeyT, typename ValueT, typename KeyInfoT>
+template <bool IsConst>
+class FlatHashMap<KeyT, ValueT, KeyInfoT>::Iterator
+    : DebugEpochBase::HandleBase {
+  friend class FlatHashMap;
+  friend class Iterator<!IsConst>;
+
+public:
+  using difference_type = ptrdiff_t;
+  using value_type =
+      typename std::conditional<IsConst, const BucketT, BucketT>::type;
+  using pointer = value_type *;
+  using reference = value_type &;
+  using iterator_category = std::forward_iterator_tag;
+
+private:
+  const int8_t *Ctrl = nullptr;
+  const int8_t *CtrlEnd = nullptr;
+  pointer Ptr = nullptr;
+
+  Iterator(const int8_t *Ctrl, const int8_t *CtrlEnd, pointer Ptr,
+           const DebugEpochBase &Epoch, bool NoAdvance = false)
+      : DebugEpochBase::HandleBase(&Epoch), Ctrl(Ctrl), CtrlEnd(CtrlEnd),
+        Ptr(Ptr) {
+    if (!NoAdvance)
+      advancePastNonFull();
+  }
+
+  void advancePastNonFull() {
+    while (Ctrl != CtrlEnd && *Ctrl < 0) {
+      ++Ctrl;
+      ++Ptr;
+    }
+  }
+
+public:
+  Iterator() = default;
+
+  // Converting ctor from non-const iterators to const iterators. SFINAE'd out
+  // for const iterator destinations so it doesn't end up as a user defined
+  // copy constructor.
+  template <bool IsConstSrc,
+            typename = std::enable_if_t<!IsConstSrc && IsConst>>
+  Iterator(const Iterator<IsConstSrc> &I)
+      : DebugEpochBase::HandleBase(I), Ctrl(I.Ctrl), CtrlEnd(I.CtrlEnd),
+        Ptr(I.Ptr) {}
+
+  reference operator*() const {
+    assert(isHandleInSync() && "invalid iterator access!");
+    assert(Ctrl != CtrlEnd && "dereferencing end() iterator");
+    return *Ptr;
+  }
+  pointer operator->() const {
+    assert(isHandleInSync() && "invalid iterator access!");
+    assert(Ctrl != CtrlEnd && "dereferencing end() iterator");
+    return Ptr;
+  }
+
+  friend bool operator==(const Iterator &LHS, const Iterator &RHS) {
+    assert((!LHS.Ptr || LHS.isHandleInSync()) && "handle not in sync!");
+    assert((!RHS.Ptr || RHS.isHandleInSync()) && "handle not in sync!");
+    assert(LHS.getEpochAddress() == RHS.getEpochAddress() &&
+           "comparing incomparable iterators!");
+    return LHS.Ptr == RHS.Ptr;
+  }
+  friend bool operator!=(const Iterator &LHS, const Iterator &RHS) {
+    return !(LHS == RHS);
+  }
+
+  Iterator &operator++() { // Preincrement
+    assert(isHandleInSync() && "invalid iterator access!");
+    assert(Ctrl != CtrlEnd && "incrementing end() iterator");
+    ++Ctrl;
+    ++Ptr;
+    advancePastNonFull();
+    return *this;
+  }
+  Iterator operator++(int) { // Postincrement
+    assert(isHandleInSync() && "invalid iterator access!");
+    Iterator Tmp = *this;
+    ++*this;
+    return Tmp;
+  }
+};
+
+} // end namespace llvm
+
+#endif // LLVM_ADT_FLATHASHMAP_H
@@ -28,7 +28,9 @@
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Support/Compiler.h"
 #include <atomic>
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 
 // Determine whether statistics should be enabled. We must do it here rather
@@ -158,8 +160,96 @@ public:
   void updateMax(unsigned V) {}
 };
 
+namespace detail {
+/// Whether ShardedStatistics count. Set by -stats and EnableStatistics().
+extern std::atomic<bool> CollectShardedStatistics;
+} // end namespace detail
+
+/// A statistic that is cheap enough to update from hot code in multithreaded
+/// tools and that is available in release builds.
+///
+/// Every thread counts into its own shard, which no other thread writes, so an
+/// update is a plain load and store to a thread-local slot rather than an
+/// atomic read-modify-write on a cache line shared by all threads. Until
+/// statistics are enabled with -stats or EnableStatistics(), updates are
+/// dropped at the cost of a single relaxed load.
+///
+/// Reading the value sums the shards of all threads under a lock, so it is
+/// meant for reporting rather than for making decisions. Assignment and
+/// updateMax() also take the lock and are only approximate while other threads
+/// are updating the statistic. The postfix operators return the previous value
+/// as seen by the calling thread, which is exact as long as one thread updates
+/// the statistic.
+class ShardedStatistic : public StatisticBase {
+public:
+  /// One plus the slot of this statistic in the per-thread shards, or zero
+  /// until it is first updated.
+  std::atomic<unsigned> Index;
+  std::atomic<bool> Initialized;
+  /// The part of the value not held by the shards: what was last assigned,
+  /// and every update once there are more statistics than shard slots.
+  std::atomic<uint64_t> Base;
+
+  ShardedStatistic(const char *DebugType, const char *Name, const char *Desc)
+      : StatisticBase(DebugType, Name, Desc), Index(0), Initialized(false),
+        Base(0) {}
+
+  unsigned getValue() const;
+
+  // Allow use of this class as the value itself.
+  operator unsigned() const { return getValue(); }
+
+  const ShardedStatistic &operator=(unsigned Val);
+
+  const ShardedStatistic &operator++() {
+    add(1);
+    return *this;
+  }
+
+  unsigned operator++(int) { return unsigned(add(1)); }
+
+  const ShardedStatistic &operator--() {
+    add(-uint64_t(1));
+    return *this;
+  }
+
+  unsigned operator--(int) { return unsigned(add(-uint64_t(1))); }
+
+  const ShardedStatistic &operator+=(unsigned V) {
+    if (V != 0)
+      add(V);
+    return *this;
+  }
+
+  const ShardedStatistic &operator-=(unsigned V) {
+    if (V != 0)
+      add(-uint64_t(V));
+    return *this;
+  }
+
+  void updateMax(unsigned V);
+
+protected:
+  /// Add \p V, modulo 2^64, to this thread's shard and return the previous
+  /// value as seen by this thread.
+  uint64_t add(uint64_t V) {
+    if (!detail::CollectShardedStatistics.load(std::memory_order_relaxed))
+      return 0;
+    return addToShard(V);
+  }
+
+  uint64_t addToShard(uint64_t V);
+  void RegisterStatistic();
+};
+
+// Statistics are compiled out of release builds unless LLVM_FORCE_ENABLE_STATS
+// is set. Alternatively, defining LLVM_ENABLE_SHARDED_STATS makes every
+// STATISTIC a ShardedStatistic so that release builds can collect them with
+// little overhead.
 #if LLVM_ENABLE_STATS
 using Statistic = TrackingStatistic;
+#elif defined(LLVM_ENABLE_SHARDED_STATS)
+using Statistic = ShardedStatistic;
 #else
 using Statistic = NoopStatistic;
 #endif
@@ -174,6 +264,11 @@ using Statistic = NoopStatistic;
 #define ALWAYS_ENABLED_STATISTIC(VARNAME, DESC)                                \
   static llvm::TrackingStatistic VARNAME = {DEBUG_TYPE, #VARNAME, DESC}
 
+// SHARDED_STATISTIC - A macro to define a statistic like STATISTIC but backed
+// by per-thread counters, for hot code. It is available in release builds.
+#define SHARDED_STATISTIC(VARNAME, DESC)                                       \
+  static llvm::ShardedStatistic VARNAME = {DEBUG_TYPE, #VARNAME, DESC}
+
 /// Enable the collection and printing of statistics.
 void EnableStatistics(bool DoPrintOnExit = true);
 
@@ -204,6 +299,10 @@ void PrintStatisticsJSON(raw_ostream &OS);
 /// completes.
 const std::vector<std::pair<StringRef, unsigned>> GetStatistics();
 
+/// Get the statistics keyed by "<debug type>.<name>", the names used by
+/// PrintStatisticsJSON(). This is how the time trace profiler exports them.
+std::vector<std::pair<std::string, unsigned>> GetQualifiedStatistics();
+
 /// Reset the statistics. This can be used to zero and de-register the
 /// statistics in order to measure a compilation.
 ///
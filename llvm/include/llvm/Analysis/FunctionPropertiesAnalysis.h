@@ -57,6 +57,10 @@ public:
 
   // Number of Top Level Loops in the Function
   int64_t TopLevelLoopCount = 0;
+
+  /// Number of times the function was entered according to the profile, or 0
+  /// if the function has no profile.
+  int64_t EntryCount = 0;
 };
 
 // Analysis pass
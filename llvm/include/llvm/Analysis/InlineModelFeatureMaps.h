@@ -23,6 +23,10 @@ namespace llvm {
 // - a documentation description. Currently, that is not used anywhere
 // programmatically, and serves as workaround to inability of inserting comments
 // in macros.
+//
+// Models need not use every feature. The release mode runner ignores features
+// its compiled model has no input for, so features may be added without
+// retraining the embedded model.
 #define INLINE_FEATURE_ITERATOR(M)                                             \
   M(CalleeBasicBlockCount, "callee_basic_block_count",                         \
     "number of basic blocks of the callee")                                    \
@@ -46,7 +50,11 @@ namespace llvm {
   M(CalleeConditionallyExecutedBlocks, "callee_conditionally_executed_blocks", \
     "number of blocks reached from a conditional instruction, in the callee")  \
   M(CalleeUsers, "callee_users",                                               \
-    "number of blocks reached from a conditional instruction, in the callee")
+    "number of blocks reached from a conditional instruction, in the callee")  \
+  M(CalleeEntryCount, "callee_entry_count",                                    \
+    "profile entry count of the callee, 0 without a profile")                  \
+  M(CallSiteCount, "callsite_count",                                           \
+    "profile count of the call site, 0 without a profile")
 
 enum class FeatureIndex : size_t {
 #define POPULATE_INDICES(INDEX_NAME, NAME, COMMENT) INDEX_NAME,
@@ -834,10 +834,8 @@ public:
   void forgetValue(Value *V);
 
   /// Called when the client has changed the disposition of values in
-  /// this loop.
-  ///
-  /// We don't have a way to invalidate per-loop dispositions. Clear and
-  /// recompute is simpler.
+  /// this loop, e.g. by moving instructions into or out of it. Dispositions
+  /// with respect to L and the loops nested in it are recomputed on demand.
   void forgetLoopDispositions(const Loop *L);
 
   /// Determine the minimum number of zero bits that S is guaranteed to end in
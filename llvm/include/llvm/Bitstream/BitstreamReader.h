@@ -148,6 +148,15 @@ public:
     return Error::success();
   }
 
+protected:
+  /// Read \p Bytes from their first bit on.
+  void resetBitcodeBytes(ArrayRef<uint8_t> Bytes) {
+    BitcodeBytes = Bytes;
+    NextChar = 0;
+    BitsInCurWord = 0;
+  }
+
+public:
   /// Get a pointer into the bitstream at the specified byte offset.
   const uint8_t *getPointerToByte(uint64_t ByteNo, uint64_t NumBytes) {
     return BitcodeBytes.data() + ByteNo;
@@ -349,6 +358,12 @@ class BitstreamCursor : SimpleBitstreamCursor {
     unsigned PrevCodeSize;
     std::vector<std::shared_ptr<BitCodeAbbrev>> PrevAbbrevs;
 
+    /// For compressed blocks, the decompressed body that is read instead of
+    /// the enclosing bytes, and where to resume reading those after the block.
+    std::shared_ptr<std::vector<uint8_t>> Contents;
+    ArrayRef<uint8_t> PrevBytes;
+    uint64_t PrevEndBitNo = 0;
+
     explicit Block(unsigned PCS) : PrevCodeSize(PCS) {}
   };
 
@@ -495,6 +510,11 @@ public:
   }
 
   /// Having read the ENTER_SUBBLOCK abbrevid, and enter the block.
+  ///
+  /// If the block was compressed by BitstreamWriter, its body is decompressed
+  /// and read until the end of the block. Bit numbers and blobs inside the
+  /// block then refer to the decompressed body, which is only kept while the
+  /// block is entered.
   Error EnterSubBlock(unsigned BlockID, unsigned *NumWordsP = nullptr);
 
   bool ReadBlockEnd() {
@@ -504,16 +524,27 @@ public:
     //    [END_BLOCK, <align4bytes>]
     SkipToFourByteBoundary();
 
-    popBlockScope();
-    return false;
+    return popBlockScope();
   }
 
 private:
-  void popBlockScope() {
-    CurCodeSize = BlockScope.back().PrevCodeSize;
-
-    CurAbbrevs = std::move(BlockScope.back().PrevAbbrevs);
+  /// Having read the header of a compressed block, decompress its body and
+  /// start reading it.
+  Error enterCompressedBlock(word_t NumWords);
+
+  /// Returns true on error.
+  bool popBlockScope() {
+    Block &B = BlockScope.back();
+    CurCodeSize = B.PrevCodeSize;
+    CurAbbrevs = std::move(B.PrevAbbrevs);
+    if (B.Contents) {
+      resetBitcodeBytes(B.PrevBytes);
+      uint64_t EndBitNo = B.PrevEndBitNo;
+      BlockScope.pop_back();
+      return errorToBool(JumpToBit(EndBitNo));
+    }
     BlockScope.pop_back();
+    return false;
   }
 
   //===--------------------------------------------------------------------===//
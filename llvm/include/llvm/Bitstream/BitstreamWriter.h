@@ -19,7 +19,9 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Bitstream/BitCodes.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/Error.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <vector>
@@ -59,6 +61,12 @@ class BitstreamWriter {
     unsigned PrevCodeSize;
     size_t StartSizeWord;
     std::vector<std::shared_ptr<BitCodeAbbrev>> PrevAbbrevs;
+    /// For blocks to compress, the format, and the writer state before the
+    /// code length of the header, to rewrite the block from there.
+    Optional<compression::Format> Compression;
+    size_t HeaderOffset = 0;
+    unsigned HeaderCurBit = 0;
+    uint32_t HeaderCurValue = 0;
     Block(unsigned PCS, size_t SSW) : PrevCodeSize(PCS), StartSizeWord(SSW) {}
   };
 
@@ -279,11 +287,18 @@ public:
     return nullptr;
   }
 
-  void EnterSubblock(unsigned BlockID, unsigned CodeLen) {
+  /// Enter a block. If \p Compression is set, the body of the block is
+  /// compressed with that format when the block is exited, if that makes it
+  /// smaller. Readers then decompress it when they enter the block.
+  void EnterSubblock(unsigned BlockID, unsigned CodeLen,
+                     Optional<compression::Format> Compression = None) {
     // Block header:
     //    [ENTER_SUBBLOCK, blockid, newcodelen, <align4bytes>, blocklen]
     EmitCode(bitc::ENTER_SUBBLOCK);
     EmitVBR(BlockID, bitc::BlockIDWidth);
+    size_t HeaderOffset = GetBufferOffset();
+    unsigned HeaderCurBit = CurBit;
+    uint32_t HeaderCurValue = CurValue;
     EmitVBR(CodeLen, bitc::CodeLenWidth);
     FlushToWord();
 
@@ -299,6 +314,13 @@ public:
     // empty abbrev set.
     BlockScope.emplace_back(OldCodeSize, BlockSizeWordIndex);
     BlockScope.back().PrevAbbrevs.swap(CurAbbrevs);
+    if (Compression) {
+      Block &B = BlockScope.back();
+      B.Compression = Compression;
+      B.HeaderOffset = HeaderOffset;
+      B.HeaderCurBit = HeaderCurBit;
+      B.HeaderCurValue = HeaderCurValue;
+    }
 
     // If there is a blockinfo for this BlockID, add all the predefined abbrevs
     // to the abbrev list.
@@ -324,12 +346,57 @@ public:
     // Update the block size field in the header of this sub-block.
     BackpatchWord(BitNo, SizeInWords);
 
+    if (B.Compression)
+      compressBlock(B);
+
     // Restore the inner block's code size and abbrev table.
     CurCodeSize = B.PrevCodeSize;
     CurAbbrevs = std::move(B.PrevAbbrevs);
     BlockScope.pop_back();
   }
 
+private:
+  /// Replace the block \p B that was just written with its compressed form,
+  /// if it is smaller:
+  ///    [ENTER_SUBBLOCK, blockid, 0, <align4bytes>, blocklen,
+  ///     codelen, format, uncompressedsize, compressedsize, compressed data,
+  ///     <align4bytes>]
+  /// The uncompressed data is the body of the block, from its first abbrev to
+  /// the alignment after END_BLOCK.
+  void compressBlock(const Block &B) {
+    // The block header must not have been flushed to the file yet.
+    uint64_t Flushed = GetNumOfFlushedBytes();
+    if (B.HeaderOffset < Flushed)
+      return;
+    size_t BodyBegin = (B.StartSizeWord + 1) * 4 - Flushed;
+    StringRef Body(Out.data() + BodyBegin, Out.size() - BodyBegin);
+    SmallVector<char, 0> Compressed;
+    if (errorToBool(compression::compress(
+            *B.Compression, Body, Compressed,
+            compression::getDefaultLevel(*B.Compression))))
+      return;
+    size_t CompressedWords = alignTo(Compressed.size(), 4) / 4 + 4;
+    if (CompressedWords * 4 >= Body.size())
+      return;
+    uint32_t UncompressedSize = Body.size();
+
+    Out.resize(B.HeaderOffset - Flushed);
+    CurBit = B.HeaderCurBit;
+    CurValue = B.HeaderCurValue;
+    EmitVBR(0, bitc::CodeLenWidth);
+    FlushToWord();
+    Emit(CompressedWords, bitc::BlockSizeWidth);
+    Emit(CurCodeSize, 32);
+    Emit(static_cast<uint32_t>(*B.Compression), 32);
+    Emit(UncompressedSize, 32);
+    Emit(Compressed.size(), 32);
+    for (char C : Compressed)
+      WriteByte(C);
+    while (GetBufferOffset() & 3)
+      WriteByte(0);
+  }
+
+public:
   //===--------------------------------------------------------------------===//
   // Record Emission
   //===--------------------------------------------------------------------===//
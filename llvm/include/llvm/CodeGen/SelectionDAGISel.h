@@ -337,6 +337,13 @@ private:
   void SelectBasicBlock(BasicBlock::const_iterator Begin,
                         BasicBlock::const_iterator End,
                         bool &HadTailCall);
+
+  /// Return where to end the DAG of the instructions between \p Begin and
+  /// \p End early, so that the instructions after it go in another DAG, or
+  /// \p End if they all go in one. The values which the instructions after
+  /// the split point use are exported to virtual registers.
+  BasicBlock::const_iterator findDAGSplitPoint(BasicBlock::const_iterator Begin,
+                                               BasicBlock::const_iterator End);
   void FinishBasicBlock();
 
   void CodeGenAndEmitDAG();
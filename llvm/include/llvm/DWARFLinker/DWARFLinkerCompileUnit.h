@@ -9,6 +9,7 @@
 #ifndef LLVM_DWARFLINKER_DWARFLINKERCOMPILEUNIT_H
 #define LLVM_DWARFLINKER_DWARFLINKERCOMPILEUNIT_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/IntervalMap.h"
 #include "llvm/CodeGen/DIE.h"
 #include "llvm/DebugInfo/DWARF/DWARFUnit.h"
@@ -252,6 +253,12 @@ public:
     ResolvedPaths[FileNum] = Path;
   }
 
+  /// Record that the DIE at index \p Idx belongs to \p Ctxt. \returns the
+  /// index of the first DIE of this unit recorded for \p Ctxt.
+  uint32_t noteDeclContext(const DeclContext *Ctxt, uint32_t Idx) {
+    return SeenDeclContexts.try_emplace(Ctxt, Idx).first->second;
+  }
+
   MCSymbol *getLabelBegin() { return LabelBegin; }
   void setLabelBegin(MCSymbol *S) { LabelBegin = S; }
 
@@ -316,6 +323,10 @@ private:
   /// for the purposes of getting a unique address for each string.
   std::vector<StringRef> ResolvedPaths;
 
+  /// The index of the first DIE seen for each non-namespace DeclContext of
+  /// this unit, used to detect ambiguous contexts.
+  DenseMap<const DeclContext *, uint32_t> SeenDeclContexts;
+
   /// Is this unit subject to the ODR rule?
   bool HasODR;
 
@@ -18,6 +18,8 @@
 #include "llvm/DebugInfo/DWARF/DWARFDie.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
+#include <array>
+#include <mutex>
 
 namespace llvm {
 
@@ -78,11 +80,9 @@ public:
   DeclContext() : DefinedInClangModule(0), Parent(*this) {}
 
   DeclContext(unsigned Hash, uint32_t Line, uint32_t ByteSize, uint16_t Tag,
-              StringRef Name, StringRef File, const DeclContext &Parent,
-              DWARFDie LastSeenDIE = DWARFDie(), unsigned CUId = 0)
+              StringRef Name, StringRef File, const DeclContext &Parent)
       : QualifiedNameHash(Hash), Line(Line), ByteSize(ByteSize), Tag(Tag),
-        DefinedInClangModule(0), Name(Name), File(File), Parent(Parent),
-        LastSeenDIE(LastSeenDIE), LastSeenCompileUnitID(CUId) {}
+        DefinedInClangModule(0), Name(Name), File(File), Parent(Parent) {}
 
   uint32_t getQualifiedNameHash() const { return QualifiedNameHash; }
 
@@ -108,14 +108,17 @@ private:
   StringRef Name;
   StringRef File;
   const DeclContext &Parent;
-  DWARFDie LastSeenDIE;
-  uint32_t LastSeenCompileUnitID = 0;
   uint32_t CanonicalDIEOffset = 0;
 };
 
 /// This class gives a tree-like API to the DenseMap that stores the
 /// DeclContext objects. It holds the BumpPtrAllocator where these objects will
 /// be allocated.
+///
+/// getChildDeclContext() may be called concurrently for different compile
+/// units. The map is split into shards keyed on the qualified name hash, each
+/// with its own lock and allocator, so that threads analyzing different units
+/// rarely contend.
 class DeclContextTree {
 public:
   /// Get the child of \a Context described by \a DIE in \a Unit. The
@@ -137,9 +140,24 @@ public:
   DeclContext &getRoot() { return Root; }
 
 private:
-  BumpPtrAllocator Allocator;
+  /// A part of the context map along with the lock that guards it.
+  struct Shard {
+    std::mutex Mutex;
+    BumpPtrAllocator Allocator;
+    DeclContext::Map Contexts;
+  };
+
+  static constexpr unsigned ShardBits = 6;
+
+  /// Returns the shard holding contexts with qualified name hash \p Hash. Use
+  /// the high bits so that the shards' own hash tables still see the low ones.
+  Shard &getShard(uint32_t Hash) { return Shards[Hash >> (32 - ShardBits)]; }
+
   DeclContext Root;
-  DeclContext::Map Contexts;
+  std::array<Shard, 1 << ShardBits> Shards;
+
+  /// Guards the uniquing string pool and PathResolver.
+  std::mutex StringPoolMutex;
 
   /// Cache resolved paths from the line table.
   CachedPathResolver PathResolver;
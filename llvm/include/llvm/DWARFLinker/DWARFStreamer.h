@@ -55,6 +55,13 @@ public:
 
   AsmPrinter &getAsmPrinter() const { return *Asm; }
 
+  /// Write the contents of the debug_info section to \p OS as each unit is
+  /// emitted instead of handing them to the MC layer, so that they don't stay
+  /// in memory until the end of the link. The debug_info section then only
+  /// reserves space for the units, and the caller is responsible for copying
+  /// the contents of \p OS into that space in the output file.
+  void setDebugInfoStream(raw_ostream *OS) { DebugInfoStream = OS; }
+
   /// Set the current output section to debug_info and change
   /// the MC Dwarf version to \p DwarfVersion.
   void switchToDebugInfoSection(unsigned DwarfVersion);
@@ -197,6 +204,9 @@ private:
   uint64_t FrameSectionSize = 0;
   uint64_t DebugInfoSectionSize = 0;
 
+  /// If set, the stream the debug_info contents are written to.
+  raw_ostream *DebugInfoStream = nullptr;
+
   /// Keep track of emitted CUs and their Unique ID.
   struct EmittedUnit {
     unsigned ID;
@@ -204,6 +214,19 @@ private:
   };
   std::vector<EmittedUnit> EmittedUnits;
 
+  /// Emit a unit header for a unit of \p UnitSize bytes, length field
+  /// included, and DWARF \p Version with \p AddressSize bytes addresses.
+  void emitUnitHeader(uint64_t UnitSize, unsigned Version,
+                      unsigned AddressSize);
+
+  /// Write the integer \p Value of \p Size bytes to DebugInfoStream.
+  void writeInt(uint64_t Value, unsigned Size);
+
+  /// Write the DIE tree rooted at \p Die to DebugInfoStream, the same way
+  /// AsmPrinter::emitDwarfDIE() would emit it.
+  void writeDIE(const DIE &Die);
+  void writeDIEValue(const DIEValue &Value);
+
   /// Emit the pubnames or pubtypes section contribution for \p
   /// Unit into \p Sec. The data is provided in \p Names.
   void emitPubSectionForUnit(MCSection *Sec, StringRef Name,
@@ -197,6 +197,9 @@ struct DIDumpOptions {
   bool SummarizeTypes = false;
   bool Verbose = false;
   bool DisplayRawContents = false;
+  /// Number of threads DWARFVerifier may use, 0 meaning all the hardware
+  /// threads.
+  unsigned VerifyNumThreads = 1;
 
   /// Return default option set for printing a single DIE without children.
   static DIDumpOptions getForSingleDIE() {
@@ -142,6 +142,18 @@ public:
   // DWARF parsing to be faster as many DWARF DIEs have a fixed byte size.
   Optional<size_t> getFixedAttributesByteSize(const DWARFUnit &U) const;
 
+  /// Skip the attribute data of a DIE that uses this abbreviation. Only the
+  /// values whose size isn't implied by the abbreviation and the unit are
+  /// decoded, the runs of fixed size values between them are skipped at once.
+  ///
+  /// \param Data the .debug_info data of \p U.
+  /// \param OffsetPtr the offset of the first attribute value, updated to the
+  /// offset past the last one.
+  /// \param U the DWARFUnit that contains the DIE.
+  /// \returns false if an attribute value could not be skipped.
+  bool skipAttributeValues(DataExtractor Data, uint64_t *OffsetPtr,
+                           const DWARFUnit &U) const;
+
 private:
   void clear();
 
@@ -168,6 +180,13 @@ private:
     size_t getByteSize(const DWARFUnit &U) const;
   };
 
+  /// An attribute whose value has a variable byte size, along with the
+  /// fixed size of the attribute values preceding it.
+  struct VariableSizeAttribute {
+    FixedSizeInfo PrecedingSize;
+    dwarf::Form Form;
+  };
+
   uint32_t Code;
   dwarf::Tag Tag;
   uint8_t CodeByteSize;
@@ -176,6 +195,11 @@ private:
   /// If this abbreviation has a fixed byte size then FixedAttributeSize member
   /// variable below will have a value.
   Optional<FixedSizeInfo> FixedAttributeSize;
+  /// If this abbreviation doesn't have a fixed byte size, the attributes with
+  /// a variable byte size and the fixed size of the attributes following the
+  /// last of them. This is what skipAttributeValues() walks.
+  SmallVector<VariableSizeAttribute, 2> VariableSizeAttributes;
+  FixedSizeInfo TrailingFixedSize;
 };
 
 } // end namespace llvm
@@ -236,6 +236,9 @@ class DWARFUnit {
   /// IntervalMap does not support range removal, as a result, we use the
   /// std::map::upper_bound for address range lookup.
   std::map<uint64_t, std::pair<uint64_t, DWARFDie>> AddrDieMap;
+  /// Number of getSubroutineForAddress() queries answered without building
+  /// AddrDieMap.
+  unsigned NumLazyAddressLookups = 0;
 
   using die_iterator_range =
       iterator_range<std::vector<DWARFDebugInfoEntry>::iterator>;
@@ -310,6 +313,11 @@ public:
   /// Recursively update address to Die map.
   void updateAddressDieMap(DWARFDie Die);
 
+  /// Find the innermost subroutine DIE below \p Die whose address ranges
+  /// contain \p Address, without evaluating the ranges of the DIEs nested in
+  /// subroutines that don't contain it.
+  DWARFDie findSubroutineForAddress(DWARFDie Die, uint64_t Address);
+
   void setRangesSection(const DWARFSection *RS, uint64_t Base) {
     RangeSection = RS;
     RangeSectionBase = Base;
@@ -10,6 +10,7 @@
 #define LLVM_DEBUGINFO_DWARF_DWARFVERIFIER_H
 
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/DebugInfo/DIContext.h"
 #include "llvm/DebugInfo/DWARF/DWARFAcceleratorTable.h"
 #include "llvm/DebugInfo/DWARF/DWARFDie.h"
@@ -105,6 +106,27 @@ private:
   raw_ostream &note() const;
   raw_ostream &dump(const DWARFDie &Die, unsigned indent = 0) const;
 
+  /// Runs \p Task for each index in [0, NumTasks) and returns the sum of the
+  /// errors it reported.
+  ///
+  /// When more than one thread is allowed by DumpOpts and \p AllowThreads is
+  /// true, the tasks run on a thread pool. Each task is then given a verifier
+  /// of its own, whose output is buffered and printed in index order once all
+  /// tasks are done, so that the output doesn't depend on the number of
+  /// threads. Otherwise, the tasks run in order with this verifier.
+  unsigned
+  verifyInParallel(size_t NumTasks,
+                   function_ref<unsigned(DWARFVerifier &, size_t)> Task,
+                   bool AllowThreads = true);
+
+  /// Extracts the DIEs of all the units in the context, so that
+  /// DWARFContext::getDIEForOffset() can then be called by several threads.
+  ///
+  /// \returns false if lookups by offset must be done by a single thread,
+  /// because the verification is single threaded or because the context has
+  /// no units.
+  bool extractDIEsForParallelLookups();
+
   /// Verifies the abbreviations section.
   ///
   /// This function currently checks that:
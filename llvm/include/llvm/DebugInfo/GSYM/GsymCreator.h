@@ -197,6 +197,15 @@ public:
   /// \param   FI The function info object to emplace into our functions list.
   void addFunctionInfo(FunctionInfo &&FI);
 
+  /// Add function infos to this GSYM creator.
+  ///
+  /// Equivalent to calling addFunctionInfo() for each of \p FIs, but only
+  /// takes the lock once. This lets threads that produce many function infos
+  /// buffer them and hand them over at once.
+  ///
+  /// \param   FIs The function info objects to move into our functions list.
+  void addFunctionInfos(std::vector<FunctionInfo> &&FIs);
+
   /// Finalize the data in the GSYM creator prior to saving the data out.
   ///
   /// Finalize must be called after all FunctionInfo objects have been added
@@ -13,11 +13,13 @@
 #ifndef LLVM_DEBUGINFO_SYMBOLIZE_SYMBOLIZE_H
 #define LLVM_DEBUGINFO_SYMBOLIZE_SYMBOLIZE_H
 
+#include "llvm/ADT/StringSet.h"
 #include "llvm/DebugInfo/Symbolize/SymbolizableModule.h"
 #include "llvm/Object/Binary.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Object/ELFObjectFile.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/ThreadPool.h"
 #include <algorithm>
 #include <cstdint>
 #include <map>
@@ -49,6 +51,7 @@ public:
     std::string FallbackDebugPath;
     std::string DWPName;
     std::vector<std::string> DebugFileDirectory;
+    std::string GsymCacheDirectory;
   };
 
   LLVMSymbolizer() = default;
@@ -97,6 +100,14 @@ private:
                    std::unique_ptr<DIContext> Context,
                    StringRef ModuleName);
 
+  /// Returns \p SymMod extended to symbolize code from the GSYM file of
+  /// \p DbgObj in the GSYM cache directory. If there is no such file yet, the
+  /// debug info of \p DbgObj is converted to one in the background, and
+  /// \p SymMod is returned as is.
+  std::unique_ptr<SymbolizableModule>
+  useGsymCache(const ObjectFile &DbgObj, const std::string &ArchName,
+               std::unique_ptr<SymbolizableModule> SymMod);
+
   ObjectFile *lookUpDsymFile(const std::string &Path,
                              const MachOObjectFile *ExeObj,
                              const std::string &ArchName);
@@ -133,6 +144,13 @@ private:
       ObjectForUBPathAndArch;
 
   Options Opts;
+
+  /// GSYM files being generated, or already generated, by this symbolizer.
+  StringSet<> ScheduledGsymConversions;
+
+  /// Runs the GSYM conversions. It is destroyed first, which waits for the
+  /// pending conversions to complete.
+  std::unique_ptr<ThreadPool> GsymConversionPool;
 };
 
 } // end namespace symbolize
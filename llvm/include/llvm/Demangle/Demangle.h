@@ -31,6 +31,31 @@ enum : int {
 char *itaniumDemangle(const char *mangled_name, char *buf, size_t *n,
                       int *status);
 
+/// Demangler for many Itanium names in a row. itaniumDemangle sets up a fresh
+/// parser and output buffer for every name; this keeps both, so that once the
+/// context has grown to fit the names being demangled no further memory is
+/// allocated. A context must not be used by more than one thread at a time.
+struct ItaniumDemangleContext {
+  ItaniumDemangleContext();
+
+  ItaniumDemangleContext(ItaniumDemangleContext &&Other);
+  ItaniumDemangleContext &operator=(ItaniumDemangleContext &&Other);
+
+  /// Demangle \p MangledName. On success the result is returned as a
+  /// null-terminated string owned by the context, which stays valid until the
+  /// next call, and its length is stored to \p N if non-null. On failure this
+  /// returns nullptr. \p Status receives one of the demangle_ enum entries if
+  /// it is non-null.
+  const char *demangle(const char *MangledName, size_t *N = nullptr,
+                       int *Status = nullptr);
+
+  ~ItaniumDemangleContext();
+private:
+  void *Context;
+  char *Buf;
+  size_t BufSize;
+};
+
 
 enum MSDemangleFlags {
   MSDF_None = 0,
@@ -62,6 +87,8 @@ char *microsoftDemangle(const char *mangled_name, size_t *n_read,
 /// \param MangledName - reference to string to demangle.
 /// \returns - the demangled string, or a copy of the input string if no
 /// demangling occurred.
+/// Itanium names are demangled with a per-thread ItaniumDemangleContext, so
+/// this is cheap to call for every symbol of a binary.
 std::string demangle(const std::string &MangledName);
 
 /// "Partial" demangler. This supports demangling a string into an AST
@@ -22,6 +22,8 @@
 
 #include <cstdint>
 #include <future>
+#include <map>
+#include <mutex>
 
 namespace llvm {
 namespace jitlink {
@@ -115,6 +117,42 @@ public:
   allocate(const JITLinkDylib *JD, const SegmentsRequestMap &Request) override;
 };
 
+/// A JITLinkMemoryManager that carves in-process allocations out of a single
+/// slab of memory reserved up front.
+///
+/// Reserving the slab once avoids an mmap/munmap pair per allocation, and
+/// keeps all JIT'd code and data in one contiguous region that can be backed
+/// by large pages. Segments are still page aligned so that the segments of
+/// different allocations can have different protections. The slab is mapped
+/// read/write, so only segments that need other protections are re-protected
+/// when they are finalized, and reset when they are deallocated.
+class InProcessSlabMemoryManager : public JITLinkMemoryManager {
+public:
+  /// Reserve a slab of at least SlabSize bytes. If UseLargePages is true the
+  /// slab is requested with sys::Memory::MF_HUGE_HINT.
+  static Expected<std::unique_ptr<InProcessSlabMemoryManager>>
+  Create(uint64_t SlabSize, bool UseLargePages = false);
+
+  ~InProcessSlabMemoryManager();
+
+  Expected<std::unique_ptr<Allocation>>
+  allocate(const JITLinkDylib *JD, const SegmentsRequestMap &Request) override;
+
+private:
+  class SlabAllocation;
+
+  InProcessSlabMemoryManager(sys::MemoryBlock Slab, uint64_t PageSize);
+
+  Expected<char *> reserve(uint64_t Size);
+  void release(char *Addr, uint64_t Size);
+
+  sys::MemoryBlock Slab;
+  uint64_t PageSize;
+
+  std::mutex FreeRangesMutex;
+  std::map<char *, uint64_t> FreeRanges;
+};
+
 } // end namespace jitlink
 } // end namespace llvm
 
@@ -92,6 +92,11 @@ public:
   /// Sets the ImplSymbolMap
   void setImplMap(ImplSymbolMap *Imp);
 
+  /// Point the lazy call-through stubs for the given symbols at new
+  /// addresses. ImplD is the implementation dylib that the symbols' partitions
+  /// were emitted into. Symbols without a stub are ignored.
+  Error redirectStubs(JITDylib &ImplD, const SymbolMap &NewAddrs);
+
   /// Emits the given module. This should not be called by clients: it will be
   /// called by the JIT when a definition added via the add method is requested.
   void emit(std::unique_ptr<MaterializationResponsibility> R,
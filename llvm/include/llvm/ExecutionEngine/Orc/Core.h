@@ -20,11 +20,13 @@
 #include "llvm/ExecutionEngine/JITLink/JITLinkDylib.h"
 #include "llvm/ExecutionEngine/JITSymbol.h"
 #include "llvm/ExecutionEngine/Orc/SymbolStringPool.h"
+#include "llvm/ExecutionEngine/Orc/TaskDispatch.h"
 #include "llvm/ExecutionEngine/OrcV1Deprecation.h"
 #include "llvm/Support/Debug.h"
 
 #include <atomic>
 #include <memory>
+#include <tuple>
 #include <vector>
 
 namespace llvm {
@@ -1227,7 +1229,8 @@ public:
   /// For reporting errors.
   using ErrorReporter = std::function<void(Error)>;
 
-  /// For dispatching MaterializationUnit::materialize calls.
+  /// For dispatching MaterializationUnit::materialize calls without going
+  /// through the session's TaskDispatcher.
   using DispatchMaterializationFunction =
       std::function<void(std::unique_ptr<MaterializationUnit> MU,
                          std::unique_ptr<MaterializationResponsibility> MR)>;
@@ -1237,7 +1240,8 @@ public:
   /// SymbolStringPools may be shared between ExecutionSessions.
   ExecutionSession(std::shared_ptr<SymbolStringPool> SSP = nullptr);
 
-  /// End the session. Closes all JITDylibs.
+  /// End the session. Waits for the TaskDispatcher to finish any outstanding
+  /// work, then closes all JITDylibs.
   Error endSession();
 
   /// Add a symbol name to the SymbolStringPool and return a pointer to it.
@@ -1303,7 +1307,19 @@ public:
   /// Unhandled errors can be sent here to log them.
   void reportError(Error Err) { ReportError(std::move(Err)); }
 
-  /// Set the materialization dispatch function.
+  /// Set the TaskDispatcher that runs materializations. Defaults to an
+  /// InPlaceTaskDispatcher.
+  ExecutionSession &setTaskDispatcher(std::unique_ptr<TaskDispatcher> D) {
+    assert(D && "D must be non-null");
+    this->D = std::move(D);
+    return *this;
+  }
+
+  /// Get the TaskDispatcher for this session.
+  TaskDispatcher &getTaskDispatcher() { return *D; }
+
+  /// Set the materialization dispatch function. If set, it is used instead of
+  /// the TaskDispatcher, and materialization priorities are ignored.
   ExecutionSession &setDispatchMaterialization(
       DispatchMaterializationFunction DispatchMaterialization) {
     this->DispatchMaterialization = std::move(DispatchMaterialization);
@@ -1340,10 +1356,15 @@ public:
   /// dependenant symbols for this query (e.g. it is being made by a top level
   /// client to get an address to call) then the value NoDependenciesToRegister
   /// can be used.
+  ///
+  /// Materializations started by this lookup are dispatched with the given
+  /// Priority. Speculative lookups should use TaskPriority::Speculative so
+  /// that they do not delay work that clients are waiting on.
   void lookup(LookupKind K, const JITDylibSearchOrder &SearchOrder,
               SymbolLookupSet Symbols, SymbolState RequiredState,
               SymbolsResolvedCallback NotifyComplete,
-              RegisterDependenciesFunction RegisterDependencies);
+              RegisterDependenciesFunction RegisterDependencies,
+              TaskPriority Priority = TaskPriority::Normal);
 
   /// Blocking version of lookup above. Returns the resolved symbol map.
   /// If WaitUntilReady is true (the default), will not return until all
@@ -1383,11 +1404,8 @@ public:
   /// Materialize the given unit.
   void
   dispatchMaterialization(std::unique_ptr<MaterializationUnit> MU,
-                          std::unique_ptr<MaterializationResponsibility> MR) {
-    assert(MU && "MU must be non-null");
-    DEBUG_WITH_TYPE("orc", dumpDispatchInfo(MR->getTargetJITDylib(), *MU));
-    DispatchMaterialization(std::move(MU), std::move(MR));
-  }
+                          std::unique_ptr<MaterializationResponsibility> MR,
+                          TaskPriority Priority = TaskPriority::Normal);
 
   /// Dump the state of all the JITDylibs in this session.
   void dump(raw_ostream &OS);
@@ -1397,12 +1415,6 @@ private:
     logAllUnhandledErrors(std::move(Err), errs(), "JIT session error: ");
   }
 
-  static void materializeOnCurrentThread(
-      std::unique_ptr<MaterializationUnit> MU,
-      std::unique_ptr<MaterializationResponsibility> MR) {
-    MU->materialize(std::move(MR));
-  }
-
   void dispatchOutstandingMUs();
 
   static std::unique_ptr<MaterializationResponsibility>
@@ -1479,8 +1491,8 @@ private:
   std::shared_ptr<SymbolStringPool> SSP;
   std::unique_ptr<Platform> P;
   ErrorReporter ReportError = logErrorsToStdErr;
-  DispatchMaterializationFunction DispatchMaterialization =
-      materializeOnCurrentThread;
+  std::unique_ptr<TaskDispatcher> D = std::make_unique<InPlaceTaskDispatcher>();
+  DispatchMaterializationFunction DispatchMaterialization;
 
   std::vector<ResourceManager *> ResourceManagers;
 
@@ -1489,8 +1501,9 @@ private:
   // FIXME: Remove this (and runOutstandingMUs) once the linking layer works
   //        with callbacks from asynchronous queries.
   mutable std::recursive_mutex OutstandingMUsMutex;
-  std::vector<std::pair<std::unique_ptr<MaterializationUnit>,
-                        std::unique_ptr<MaterializationResponsibility>>>
+  std::vector<std::tuple<std::unique_ptr<MaterializationUnit>,
+                         std::unique_ptr<MaterializationResponsibility>,
+                         TaskPriority>>
       OutstandingMUs;
 };
 
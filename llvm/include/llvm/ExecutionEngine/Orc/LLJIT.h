@@ -21,6 +21,7 @@
 #include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
 #include "llvm/ExecutionEngine/Orc/ObjectTransformLayer.h"
 #include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
+#include "llvm/ExecutionEngine/Orc/TieredCompilation.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ThreadPool.h"
 
@@ -206,7 +207,6 @@ protected:
 
   DataLayout DL;
   Triple TT;
-  std::unique_ptr<ThreadPool> CompileThreads;
 
   std::unique_ptr<ObjectLayer> ObjLinkingLayer;
   ObjectTransformLayer ObjTransformLayer;
@@ -245,6 +245,7 @@ private:
   LLLazyJIT(LLLazyJITBuilderState &S, Error &Err);
 
   std::unique_ptr<LazyCallThroughManager> LCTMgr;
+  std::unique_ptr<IRTieringLayer> TieringLayer;
   std::unique_ptr<CompileOnDemandLayer> CODLayer;
 };
 
@@ -266,6 +267,7 @@ public:
   CompileFunctionCreator CreateCompileFunction;
   PlatformSetupFunction SetUpPlatform;
   unsigned NumCompileThreads = 0;
+  ObjectCache *ObjCache = nullptr;
   TargetProcessControl *TPC = nullptr;
 
   /// Called prior to JIT class construcion to fix up defaults.
@@ -349,6 +351,16 @@ public:
     return impl();
   }
 
+  /// Set an ObjectCache for the default compile function to use, e.g. a
+  /// PersistentObjectCache. The cache must outlive the JIT instance and be
+  /// thread safe if more than one compile thread is used.
+  ///
+  /// This setting is ignored if a CompileFunctionCreator is set.
+  SetterImpl &setObjectCache(ObjectCache *ObjCache) {
+    impl().ObjCache = ObjCache;
+    return impl();
+  }
+
   /// Set a TargetProcessControl object.
   ///
   /// If the platform uses ObjectLinkingLayer by default and no
@@ -392,6 +404,7 @@ public:
   JITTargetAddress LazyCompileFailureAddr = 0;
   std::unique_ptr<LazyCallThroughManager> LCTMgr;
   IndirectStubsManagerBuilderFunction ISMBuilder;
+  uint64_t TierUpThreshold = 0;
 
   Error prepareForConstruction();
 };
@@ -427,6 +440,21 @@ public:
     this->impl().ISMBuilder = std::move(ISMBuilder);
     return this->impl();
   }
+
+  /// Enable tiered compilation.
+  ///
+  /// If set to a non-zero number N, lazily compiled functions are first
+  /// compiled without optimization, and recompiled with optimization once
+  /// they have been called N times (see IRTieringLayer). Unless a
+  /// CompileFunctionCreator is set, a TieredIRCompiler is used to compile
+  /// both tiers. Tiering requires in-process execution.
+  ///
+  /// If this method is not called, behavior will be as if it were called with
+  /// a zero argument.
+  SetterImpl &setTierUpThreshold(uint64_t TierUpThreshold) {
+    this->impl().TierUpThreshold = TierUpThreshold;
+    return this->impl();
+  }
 };
 
 /// Constructs LLLazyJIT instances.
@@ -13,11 +13,18 @@
 #ifndef LLVM_EXECUTIONENGINE_ORC_ORCRPCTARGETPROCESSCONTROL_H
 #define LLVM_EXECUTIONENGINE_ORC_ORCRPCTARGETPROCESSCONTROL_H
 
+#include "llvm/ADT/ScopeExit.h"
 #include "llvm/ExecutionEngine/Orc/RPC/RPCUtils.h"
 #include "llvm/ExecutionEngine/Orc/RPC/RawByteChannel.h"
 #include "llvm/ExecutionEngine/Orc/TargetProcess/OrcRPCTPCServer.h"
 #include "llvm/ExecutionEngine/Orc/TargetProcessControl.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MSVCErrorWorkarounds.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+
+#include <map>
+#include <mutex>
 
 namespace llvm {
 namespace orc {
@@ -223,6 +230,257 @@ private:
   OrcRPCTPCImplT &Parent;
 };
 
+/// JITLinkMemoryManager implementation for a process on the same host,
+/// connected via an ORC RPC endpoint, that shares a slab of memory with the
+/// JIT process.
+///
+/// The slab is a file that both processes map. Allocations are carved out of
+/// the slab, and the JIT links directly into its own mapping of it, so
+/// finalizing an allocation is a single FinalizeMem call to apply protections
+/// in the target process: unlike OrcRPCTPCJITLinkMemoryManager, no segment
+/// content is sent over the RPC channel. The file is removed as soon as both
+/// processes have mapped it. It is created in the system temporary directory
+/// unless another directory is given, which must permit executable mappings.
+template <typename OrcRPCTPCImplT>
+class OrcRPCTPCSharedMemoryManager : public jitlink::JITLinkMemoryManager {
+private:
+  struct Segment {
+    uint64_t Offset = 0;
+    uint64_t Size = 0;
+  };
+
+  using SegmentMap = DenseMap<int, Segment>;
+
+public:
+  class SharedMemAllocation : public Allocation {
+  public:
+    SharedMemAllocation(OrcRPCTPCSharedMemoryManager<OrcRPCTPCImplT> &Parent,
+                        uint64_t Offset, uint64_t Size, SegmentMap Segments)
+        : Parent(Parent), Offset(Offset), Size(Size),
+          Segments(std::move(Segments)) {}
+
+    ~SharedMemAllocation() override {
+      assert(Segments.empty() && "failed to deallocate");
+    }
+
+    MutableArrayRef<char> getWorkingMemory(ProtectionFlags Seg) override {
+      auto I = Segments.find(Seg);
+      assert(I != Segments.end() && "No allocation for segment");
+      return {Parent.LocalSlab->data() + I->second.Offset,
+              static_cast<size_t>(I->second.Size)};
+    }
+
+    JITTargetAddress getTargetMemory(ProtectionFlags Seg) override {
+      auto I = Segments.find(Seg);
+      assert(I != Segments.end() && "No allocation for segment");
+      return Parent.TargetSlab + I->second.Offset;
+    }
+
+    void finalizeAsync(FinalizeContinuation OnFinalize) override {
+      // The content is already in place: only protections need applying.
+      orcrpctpc::ReleaseOrFinalizeMemRequest FMR;
+      for (auto &KV : Segments)
+        FMR.push_back({orcrpctpc::toWireProtectionFlags(
+                           static_cast<sys::Memory::ProtectionFlags>(KV.first)),
+                       Parent.TargetSlab + KV.second.Offset, KV.second.Size});
+
+      DEBUG_WITH_TYPE("orc", {
+        dbgs() << "finalizeAsync " << (void *)this << " (shared memory):\n";
+        for (auto &E : FMR)
+          dbgs() << "  " << ((E.Prot & orcrpctpc::WPF_Read) ? 'R' : '-')
+                 << ((E.Prot & orcrpctpc::WPF_Write) ? 'W' : '-')
+                 << ((E.Prot & orcrpctpc::WPF_Exec) ? 'X' : '-')
+                 << " segment: target " << formatv("{0:x16}", E.Address)
+                 << ", size " << formatv("{0:x16}", E.Size) << "\n";
+      });
+
+      if (auto Err =
+              Parent.Parent.getEndpoint()
+                  .template callAsync<orcrpctpc::FinalizeMem>(
+                      [OF = std::move(OnFinalize)](Error Err2) {
+                        // FIXME: Dispatch to work queue.
+                        std::thread([OF = std::move(OF),
+                                     Err3 = std::move(Err2)]() mutable {
+                          OF(std::move(Err3));
+                        }).detach();
+                        return Error::success();
+                      },
+                      FMR)) {
+        Parent.Parent.getEndpoint().abandonPendingResponses();
+        Parent.Parent.reportError(std::move(Err));
+      }
+    }
+
+    Error deallocate() override {
+      if (Segments.empty())
+        return Error::success();
+
+      // Hand the memory back read/write, which is how allocate returns it.
+      auto ReadWrite = orcrpctpc::WPF_Read | orcrpctpc::WPF_Write;
+      orcrpctpc::ReleaseOrFinalizeMemRequest RMR;
+      for (auto &KV : Segments)
+        RMR.push_back(
+            {ReadWrite, Parent.TargetSlab + KV.second.Offset, KV.second.Size});
+      Segments.clear();
+
+      auto Err =
+          Parent.Parent.getEndpoint().template callB<orcrpctpc::FinalizeMem>(
+              RMR);
+      if (!Err)
+        Parent.release(Offset, Size);
+      return Err;
+    }
+
+  private:
+    OrcRPCTPCSharedMemoryManager<OrcRPCTPCImplT> &Parent;
+    uint64_t Offset;
+    uint64_t Size;
+    SegmentMap Segments;
+  };
+
+  /// Create a shared slab of at least SlabSize bytes in Dir (or in the system
+  /// temporary directory if Dir is empty) and map it into both processes.
+  static Expected<std::unique_ptr<OrcRPCTPCSharedMemoryManager>>
+  Create(OrcRPCTPCImplT &Parent, uint64_t SlabSize, StringRef Dir = "") {
+    SlabSize = alignTo(SlabSize, Parent.getPageSize());
+
+    SmallString<128> Model(Dir);
+    if (Model.empty())
+      sys::path::system_temp_directory(/*ErasedOnReboot=*/true, Model);
+    sys::path::append(Model, "orc-shared-mem-%%%%%%");
+
+    int FD;
+    SmallString<128> Path;
+    if (auto EC = sys::fs::createUniqueFile(Model, FD, Path,
+                                            sys::fs::owner_read |
+                                                sys::fs::owner_write))
+      return errorCodeToError(EC);
+
+    // Both mappings outlive the file.
+    auto RemoveFile = make_scope_exit([&]() {
+      sys::Process::SafelyCloseFileDescriptor(FD);
+      sys::fs::remove(Path);
+    });
+
+    if (auto EC = sys::fs::resize_file(FD, SlabSize))
+      return errorCodeToError(EC);
+
+    std::error_code EC;
+    auto LocalSlab = std::make_unique<sys::fs::mapped_file_region>(
+        sys::fs::convertFDToNativeFile(FD),
+        sys::fs::mapped_file_region::readwrite, SlabSize, 0, EC);
+    if (EC)
+      return errorCodeToError(EC);
+
+    auto TargetSlab =
+        Parent.getEndpoint().template callB<orcrpctpc::MapSharedMem>(
+            Path.str().str(), SlabSize);
+    if (!TargetSlab)
+      return TargetSlab.takeError();
+
+    DEBUG_WITH_TYPE("orc", {
+      dbgs() << "Orc shared memmgr mapped " << formatv("{0:x16}", SlabSize)
+             << " bytes: local " << (void *)LocalSlab->data() << ", target "
+             << formatv("{0:x16}", *TargetSlab) << "\n";
+    });
+
+    return std::unique_ptr<OrcRPCTPCSharedMemoryManager>(
+        new OrcRPCTPCSharedMemoryManager(Parent, std::move(LocalSlab),
+                                         *TargetSlab));
+  }
+
+  Expected<std::unique_ptr<Allocation>>
+  allocate(const jitlink::JITLinkDylib *JD,
+           const SegmentsRequestMap &Request) override {
+    uint64_t PageSize = Parent.getPageSize();
+
+    // Give each segment its own pages so that it can be protected
+    // independently.
+    uint64_t TotalSize = 0;
+    for (auto &KV : Request) {
+      if (KV.second.getAlignment() > PageSize)
+        return make_error<StringError>("Cannot request higher than page "
+                                       "alignment",
+                                       inconvertibleErrorCode());
+      TotalSize += alignTo(
+          KV.second.getContentSize() + KV.second.getZeroFillSize(), PageSize);
+    }
+
+    auto Offset = reserve(TotalSize);
+    if (!Offset)
+      return Offset.takeError();
+
+    SegmentMap Segments;
+    uint64_t NextOffset = *Offset;
+    for (auto &KV : Request) {
+      uint64_t SegSize = alignTo(
+          KV.second.getContentSize() + KV.second.getZeroFillSize(), PageSize);
+
+      // Reused memory may hold stale content.
+      memset(LocalSlab->data() + NextOffset + KV.second.getContentSize(), 0,
+             KV.second.getZeroFillSize());
+
+      Segments[KV.first] = {NextOffset, SegSize};
+      NextOffset += SegSize;
+    }
+
+    return std::make_unique<SharedMemAllocation>(*this, *Offset, TotalSize,
+                                                 std::move(Segments));
+  }
+
+private:
+  OrcRPCTPCSharedMemoryManager(
+      OrcRPCTPCImplT &Parent,
+      std::unique_ptr<sys::fs::mapped_file_region> LocalSlab,
+      JITTargetAddress TargetSlab)
+      : Parent(Parent), LocalSlab(std::move(LocalSlab)),
+        TargetSlab(TargetSlab) {
+    FreeRanges[0] = this->LocalSlab->size();
+  }
+
+  Expected<uint64_t> reserve(uint64_t Size) {
+    std::lock_guard<std::mutex> Lock(FreeRangesMutex);
+    for (auto I = FreeRanges.begin(), E = FreeRanges.end(); I != E; ++I) {
+      if (I->second < Size)
+        continue;
+      uint64_t Offset = I->first;
+      uint64_t Remaining = I->second - Size;
+      FreeRanges.erase(I);
+      if (Remaining)
+        FreeRanges[Offset + Size] = Remaining;
+      return Offset;
+    }
+    return make_error<StringError>("Shared memory slab exhausted: could not "
+                                   "allocate " +
+                                       Twine(Size) + " bytes",
+                                   inconvertibleErrorCode());
+  }
+
+  void release(uint64_t Offset, uint64_t Size) {
+    std::lock_guard<std::mutex> Lock(FreeRangesMutex);
+    auto Next = FreeRanges.lower_bound(Offset);
+    if (Next != FreeRanges.end() && Offset + Size == Next->first) {
+      Size += Next->second;
+      Next = FreeRanges.erase(Next);
+    }
+    if (Next != FreeRanges.begin()) {
+      auto Prev = std::prev(Next);
+      if (Prev->first + Prev->second == Offset) {
+        Prev->second += Size;
+        return;
+      }
+    }
+    FreeRanges[Offset] = Size;
+  }
+
+  OrcRPCTPCImplT &Parent;
+  std::unique_ptr<sys::fs::mapped_file_region> LocalSlab;
+  JITTargetAddress TargetSlab;
+
+  std::mutex FreeRangesMutex;
+  std::map<uint64_t, uint64_t> FreeRanges;
+};
+
 /// TargetProcessControl::MemoryAccess implementation for a process connected
 /// via an ORC RPC endpoint.
 template <typename OrcRPCTPCImplT>
@@ -0,0 +1,86 @@
+//===- PersistentObjectCache.h - On-disk cache of JIT'd objects -*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// An ObjectCache that keeps compiled objects in a directory so that they can
+// be reused by later runs of the JIT.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
+#define LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/Support/CachePruning.h"
+#include "llvm/Support/Error.h"
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace llvm {
+
+class Module;
+
+namespace orc {
+
+class JITTargetMachineBuilder;
+
+/// An ObjectCache that stores objects in a directory on disk.
+///
+/// Entries are keyed by a hash of the module's bitcode together with the
+/// target triple, CPU, features, optimization level, relocation model and code
+/// model of the JITTargetMachineBuilder the cache was created for. Other
+/// TargetOptions are not part of the key, so clients that vary them should
+/// use a separate directory for each configuration.
+///
+/// Entries are written to a temporary file and renamed into place, so several
+/// processes can share a directory. The directory is pruned according to the
+/// given CachePruningPolicy, least recently used entries first, when the cache
+/// is created and whenever prune is called.
+///
+/// The cache is thread safe and can be shared by the compilers of all
+/// compile threads.
+class PersistentObjectCache : public ObjectCache {
+public:
+  /// Create a cache in Directory, creating the directory if needed.
+  static Expected<std::unique_ptr<PersistentObjectCache>>
+  Create(StringRef Directory, const JITTargetMachineBuilder &JTMB,
+         CachePruningPolicy Policy = CachePruningPolicy());
+
+  /// Look up the object for M. The key computed here is remembered so that
+  /// notifyObjectCompiled stores the object under the key of the module as it
+  /// was before code generation.
+  std::unique_ptr<MemoryBuffer> getObject(const Module *M) override;
+
+  /// Store the object compiled for M. Ignored unless getObject was called for
+  /// M first.
+  void notifyObjectCompiled(const Module *M, MemoryBufferRef Obj) override;
+
+  /// Prune the cache directory according to the policy.
+  void prune();
+
+private:
+  PersistentObjectCache(std::string Directory, std::string TargetKey,
+                        CachePruningPolicy Policy)
+      : Directory(std::move(Directory)), TargetKey(std::move(TargetKey)),
+        Policy(std::move(Policy)) {}
+
+  std::string getEntryPath(const Module &M);
+
+  std::string Directory;
+  std::string TargetKey;
+  CachePruningPolicy Policy;
+
+  std::mutex PendingEntriesMutex;
+  DenseMap<const Module *, std::string> PendingEntries;
+};
+
+} // end namespace orc
+} // end namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
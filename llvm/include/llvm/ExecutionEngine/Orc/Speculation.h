@@ -116,7 +116,7 @@ private:
             if (auto Err = Result.takeError())
               ES.reportError(std::move(Err));
           },
-          NoDependenciesToRegister);
+          NoDependenciesToRegister, TaskPriority::Speculative);
   }
 
 public:
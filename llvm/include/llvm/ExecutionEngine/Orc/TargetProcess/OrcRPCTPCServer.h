@@ -20,6 +20,7 @@
 #include "llvm/ExecutionEngine/Orc/TargetProcess/TargetExecutionUtils.h"
 #include "llvm/ExecutionEngine/Orc/TargetProcessControl.h"
 #include "llvm/Support/DynamicLibrary.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/MathExtras.h"
@@ -307,6 +308,13 @@ public:
   static const char *getName() { return "ReleaseMem"; }
 };
 
+class MapSharedMem
+    : public rpc::Function<MapSharedMem, Expected<JITTargetAddress>(
+                                             std::string Path, uint64_t Size)> {
+public:
+  static const char *getName() { return "MapSharedMem"; }
+};
+
 class WriteUInt8s
     : public rpc::Function<WriteUInt8s,
                            Error(std::vector<tpctypes::UInt8Write>)> {
@@ -397,6 +405,8 @@ public:
     EP.template addHandler<orcrpctpc::FinalizeMem>(*this,
                                                    &ThisT::finalizeMemory);
     EP.template addHandler<orcrpctpc::ReleaseMem>(*this, &ThisT::releaseMemory);
+    EP.template addHandler<orcrpctpc::MapSharedMem>(*this,
+                                                    &ThisT::mapSharedMemory);
 
     EP.template addHandler<orcrpctpc::WriteUInt8s>(
         handleWriteUInt<tpctypes::UInt8Write>);
@@ -516,6 +526,9 @@ private:
         return make_error<StringError>("error protecting memory: " +
                                            EC.message(),
                                        inconvertibleErrorCode());
+      if (PF & sys::Memory::MF_EXEC)
+        sys::Memory::InvalidateInstructionCache(MB.base(),
+                                                MB.allocatedSize());
     }
     return Error::success();
   }
@@ -531,6 +544,31 @@ private:
     return Error::success();
   }
 
+  Expected<JITTargetAddress> mapSharedMemory(const std::string &Path,
+                                             uint64_t Size) {
+    int FD;
+    if (auto EC = sys::fs::openFileForReadWrite(
+            Path, FD, sys::fs::CD_OpenExisting, sys::fs::OF_None))
+      return make_error<StringError>("Unable to open shared memory " + Path +
+                                         ": " + EC.message(),
+                                     inconvertibleErrorCode());
+
+    // The mapping stays valid once the file has been closed (and removed).
+    std::error_code EC;
+    auto Mapping = std::make_unique<sys::fs::mapped_file_region>(
+        sys::fs::convertFDToNativeFile(FD),
+        sys::fs::mapped_file_region::readwrite, Size, 0, EC);
+    sys::Process::SafelyCloseFileDescriptor(FD);
+    if (EC)
+      return make_error<StringError>("Unable to map shared memory " + Path +
+                                         ": " + EC.message(),
+                                     inconvertibleErrorCode());
+
+    JITTargetAddress Addr = pointerToJITTargetAddress(Mapping->data());
+    SharedMemMappings.push_back(std::move(Mapping));
+    return Addr;
+  }
+
   Expected<tpctypes::DylibHandle> loadDylib(const std::string &Path) {
     std::string ErrMsg;
     const char *DLPath = !Path.empty() ? Path.c_str() : nullptr;
@@ -606,6 +644,7 @@ private:
   RPCEndpointT &EP;
   std::atomic<bool> Finished{false};
   DenseMap<tpctypes::DylibHandle, sys::DynamicLibrary> Dylibs;
+  std::vector<std::unique_ptr<sys::fs::mapped_file_region>> SharedMemMappings;
 };
 
 } // end namespace orc
@@ -0,0 +1,77 @@
+//===--------- TaskDispatch.h - ORC task dispatch utils ---------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Task and TaskDispatcher classes used by ExecutionSession to run
+// materializations.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_TASKDISPATCH_H
+#define LLVM_EXECUTIONENGINE_ORC_TASKDISPATCH_H
+
+#include "llvm/ADT/FunctionExtras.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+
+namespace llvm {
+namespace orc {
+
+/// Relative urgency of a dispatched task.
+enum class TaskPriority {
+  /// Work that a client is, or will shortly be, waiting on.
+  Normal,
+  /// Work done ahead of need, e.g. speculative compilation. Only started when
+  /// no Normal priority work is waiting.
+  Speculative
+};
+
+/// Abstract base for the object that runs the tasks (currently
+/// materializations) produced by an ExecutionSession.
+class TaskDispatcher {
+public:
+  using Task = unique_function<void()>;
+
+  virtual ~TaskDispatcher();
+
+  /// Run the given task, either on the current thread or asynchronously.
+  /// Tasks may dispatch further tasks.
+  virtual void dispatch(Task T, TaskPriority Priority) = 0;
+
+  /// Block until all dispatched tasks, including any that they dispatch, have
+  /// completed. Called by ExecutionSession::endSession.
+  virtual void shutdown() = 0;
+};
+
+/// Runs each task on the current thread as soon as it is dispatched.
+class InPlaceTaskDispatcher : public TaskDispatcher {
+public:
+  void dispatch(Task T, TaskPriority Priority) override;
+  void shutdown() override;
+};
+
+/// Runs tasks on a ThreadPool. All threads share one queue, so an idle thread
+/// picks up the next task regardless of which thread dispatched it. Queued
+/// Normal priority tasks are always started before Speculative ones.
+class ThreadPoolTaskDispatcher : public TaskDispatcher {
+public:
+  ThreadPoolTaskDispatcher(ThreadPoolStrategy S = hardware_concurrency())
+      : Pool(S) {}
+
+  void dispatch(Task T, TaskPriority Priority) override;
+  void shutdown() override;
+
+  unsigned getThreadCount() const { return Pool.getThreadCount(); }
+
+private:
+  ThreadPool Pool;
+};
+
+} // End namespace orc
+} // End namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_ORC_TASKDISPATCH_H
@@ -0,0 +1,114 @@
+//===--- TieredCompilation.h - Recompile hot functions ----------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Utilities for compiling lazily compiled functions cheaply first, and
+// recompiling the ones that turn out to be hot with full optimization.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_TIEREDCOMPILATION_H
+#define LLVM_EXECUTIONENGINE_ORC_TIEREDCOMPILATION_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/FunctionExtras.h"
+#include "llvm/ExecutionEngine/Orc/Core.h"
+#include "llvm/ExecutionEngine/Orc/IRCompileLayer.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/ExecutionEngine/Orc/Layer.h"
+#include "llvm/ExecutionEngine/Orc/Mangling.h"
+#include <mutex>
+#include <vector>
+
+namespace llvm {
+
+class ObjectCache;
+
+namespace orc {
+
+/// Counts the calls to the functions of each module it emits, and recompiles
+/// a module once one of its functions has been called HotThreshold times.
+///
+/// The layer is meant to sit between a CompileOnDemandLayer and the layer
+/// that compiles its partitions. Every external function defined by an
+/// emitted module is instrumented to count its calls, and an uninstrumented
+/// copy of the module is kept. When a function becomes hot, the copy is marked
+/// as second tier (see isSecondTier) and added to the base layer in a
+/// "<dylib>.tier2" JITDylib. This happens in a task dispatched with
+/// TaskPriority::Speculative. Once the new definitions are ready, the redirect
+/// function is called to point callers at them, e.g. by updating the stubs of
+/// a CompileOnDemandLayer.
+///
+/// The instrumentation calls back into the layer through the __orc_tier_up
+/// and __orc_tiering_layer symbols, which the layer defines in each JITDylib
+/// it emits modules into. Tiering therefore requires in-process execution.
+///
+/// Modules that define mutable global variables are not tiered, as the second
+/// tier would get its own copy of the variables.
+class IRTieringLayer : public IRLayer {
+public:
+  /// Points the callers of the symbols in NewAddrs, whose first tier
+  /// definitions were emitted into FirstTierJD, at their new addresses.
+  using RedirectFunction =
+      unique_function<Error(JITDylib &FirstTierJD, const SymbolMap &NewAddrs)>;
+
+  IRTieringLayer(ExecutionSession &ES, IRLayer &BaseLayer,
+                 RedirectFunction Redirect, uint64_t HotThreshold);
+
+  void emit(std::unique_ptr<MaterializationResponsibility> R,
+            ThreadSafeModule TSM) override;
+
+  /// Returns true if M was added to the base layer as second tier.
+  static bool isSecondTier(const Module &M);
+
+private:
+  struct TierUpCandidate {
+    JITDylib *FirstTierJD = nullptr;
+    ThreadSafeModule TSM;
+    SymbolNameVector Callables;
+  };
+
+  static void tierUpEntryPoint(IRTieringLayer *Layer, uint64_t CandidateId);
+
+  Error addTieringRuntime(JITDylib &JD, const DataLayout &DL);
+  void instrument(Module &M, uint64_t CandidateId);
+  void tierUp(uint64_t CandidateId);
+  void emitSecondTier(TierUpCandidate C);
+  JITDylib &getSecondTierDylib(JITDylib &FirstTierJD);
+
+  IRLayer &BaseLayer;
+  RedirectFunction Redirect;
+  uint64_t HotThreshold;
+
+  std::mutex TieringMutex;
+  std::vector<TierUpCandidate> Candidates;
+  DenseSet<JITDylib *> DylibsWithRuntime;
+  DenseMap<JITDylib *, JITDylib *> SecondTierDylibs;
+};
+
+/// A thread-safe compiler for use under an IRTieringLayer.
+///
+/// First tier modules are compiled at CodeGenOpt::None, which selects FastISel
+/// where the target supports it. Second tier modules are run through the O2
+/// pipeline and compiled at the JITTargetMachineBuilder's optimization level.
+class TieredIRCompiler : public IRCompileLayer::IRCompiler {
+public:
+  TieredIRCompiler(JITTargetMachineBuilder JTMB,
+                   ObjectCache *ObjCache = nullptr);
+
+  Expected<std::unique_ptr<MemoryBuffer>> operator()(Module &M) override;
+
+private:
+  JITTargetMachineBuilder JTMB;
+  ObjectCache *ObjCache = nullptr;
+};
+
+} // end namespace orc
+} // end namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_ORC_TIEREDCOMPILATION_H
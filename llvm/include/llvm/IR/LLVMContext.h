@@ -27,6 +27,7 @@ class DiagnosticInfo;
 enum DiagnosticSeverity : char;
 class Function;
 class Instruction;
+class IRArena;
 class LLVMContextImpl;
 class Module;
 class OptPassGate;
@@ -146,6 +147,23 @@ public:
   /// especially in release mode.
   void setDiscardValueNames(bool Discard);
 
+  /// Return true if types, constants, attributes and metadata can be uniqued
+  /// by several threads at once.
+  bool hasConcurrentUniquing() const;
+
+  /// Guard the uniquing tables of types, constants, attributes and metadata
+  /// with locks, so that several threads can get (or create) these at once,
+  /// e.g. to build functions of one module in parallel. Single-threaded users
+  /// don't pay for the locks unless this is enabled.
+  ///
+  /// This also guards the use lists of the values that several functions may
+  /// use (constants, globals...), as well as the context's tables of value
+  /// names, value handles and metadata attachments. Walking the users of such
+  /// values while other threads change them still isn't safe, and neither is
+  /// changing the module. This must be set while no other thread uses the
+  /// context.
+  void setConcurrentUniquing(bool Enable);
+
   /// Whether there is a string map for uniquing debug info
   /// identifiers across the context.  Off by default.
   bool isODRUniquingDebugTypes() const;
@@ -324,6 +342,26 @@ public:
   /// LLVMContext is used by compilation.
   void setOptPassGate(OptPassGate&);
 
+  /// While an ArenaScope is alive, the Users (instructions, constants...),
+  /// their operands and the MDNodes created on the current thread are
+  /// allocated from an arena owned by the context, rather than the heap.
+  /// Deleting one of them puts its memory on a free list for reuse, and the
+  /// arena is freed as a whole with the context, which avoids the cost of the
+  /// heap in clients that create and delete a lot of IR, e.g. JITs.
+  ///
+  /// The IR created in the scope must belong to the context. Scopes nest, the
+  /// innermost one applies.
+  class ArenaScope {
+  public:
+    ArenaScope(LLVMContext &C);
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope &operator=(const ArenaScope &) = delete;
+    ~ArenaScope();
+
+  private:
+    IRArena *Previous;
+  };
+
 private:
   // Module needs access to the add/removeModule methods.
   friend class Module;
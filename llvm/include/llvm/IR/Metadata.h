@@ -66,11 +66,15 @@ protected:
   enum StorageType { Uniqued, Distinct, Temporary };
 
   /// Storage flag for non-uniqued, otherwise unowned, metadata.
-  unsigned char Storage : 7;
+  unsigned char Storage : 6;
   // TODO: expose remaining bits to subclasses.
 
   unsigned char ImplicitCode : 1;
 
+  /// Whether an MDNode was allocated in an LLVMContext::ArenaScope. Set by
+  /// MDNode::operator new, hence not initialized by the constructor.
+  unsigned char IsArenaAllocated : 1;
+
   unsigned short SubclassData16 = 0;
   unsigned SubclassData32 = 0;
 
@@ -48,14 +48,17 @@
 #include "llvm/IR/PassManagerInternal.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/TypeName.h"
 #include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <functional>
 #include <iterator>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <tuple>
 #include <type_traits>
 #include <utility>
@@ -774,10 +777,23 @@ public:
   /// IR units itself has potentially changed, and thus we can't even look up a
   /// a result and invalidate/clear it directly.
   void clear() {
+    auto Lock = lockIfThreadSafe();
     AnalysisResults.clear();
     AnalysisResultLists.clear();
   }
 
+  /// Return true if several threads may use the manager at once.
+  bool isThreadSafe() const { return Mutex != nullptr; }
+
+  /// Guard the results cache with a lock, so that several threads can get and
+  /// invalidate the results of different IR units at once. The analyses run
+  /// without the lock. This must be set while no other thread uses the
+  /// manager.
+  void setThreadSafe(bool ThreadSafe) {
+    if (ThreadSafe != isThreadSafe())
+      Mutex.reset(ThreadSafe ? new std::recursive_mutex() : nullptr);
+  }
+
   /// Get the result of an analysis pass for a given IR unit.
   ///
   /// Runs the analysis if a cached result is not available.
@@ -819,6 +835,7 @@ public:
   /// Verify that the given Result cannot be invalidated, assert otherwise.
   template <typename PassT>
   void verifyNotInvalidated(IRUnitT &IR, typename PassT::Result *Result) const {
+    auto Lock = lockIfThreadSafe();
     PreservedAnalyses PA = PreservedAnalyses::none();
     SmallDenseMap<AnalysisKey *, bool, 8> IsResultInvalidated;
     Invalidator Inv(IsResultInvalidated, AnalysisResults);
@@ -899,6 +916,7 @@ private:
 
   /// Get a cached analysis result or return null.
   ResultConceptT *getCachedResultImpl(AnalysisKey *ID, IRUnitT &IR) const {
+    auto Lock = lockIfThreadSafe();
     typename AnalysisResultMapT::const_iterator RI =
         AnalysisResults.find({ID, &IR});
     return RI == AnalysisResults.end() ? nullptr : &*RI->second->second;
@@ -906,6 +924,7 @@ private:
 
   /// Invalidate a pass result for a IR unit.
   void invalidateImpl(AnalysisKey *ID, IRUnitT &IR) {
+    auto Lock = lockIfThreadSafe();
     typename AnalysisResultMapT::iterator RI =
         AnalysisResults.find({ID, &IR});
     if (RI == AnalysisResults.end())
@@ -918,6 +937,13 @@ private:
     AnalysisResults.erase(RI);
   }
 
+  /// Lock the results cache if the manager is thread safe.
+  std::unique_lock<std::recursive_mutex> lockIfThreadSafe() const {
+    if (!Mutex)
+      return std::unique_lock<std::recursive_mutex>();
+    return std::unique_lock<std::recursive_mutex>(*Mutex);
+  }
+
   /// Map type from analysis pass ID to pass concept pointer.
   using AnalysisPassMapT =
       DenseMap<AnalysisKey *, std::unique_ptr<PassConceptT>>;
@@ -937,6 +963,10 @@ private:
 
   /// Indicates whether we log to \c llvm::dbgs().
   bool DebugLogging;
+
+  /// Guards the results cache, if the manager is thread safe. Recursive, as
+  /// analyses get the results of others.
+  std::unique_ptr<std::recursive_mutex> Mutex;
 };
 
 extern template class AnalysisManager<Module>;
@@ -1258,6 +1288,60 @@ createModuleToFunctionPassAdaptor(FunctionPassT Pass) {
       std::make_unique<PassModelT>(std::move(Pass)));
 }
 
+/// Like ModuleToFunctionPassAdaptor, but runs the function passes over
+/// several functions of the module at once, on a pool of threads.
+///
+/// Each thread runs its own instance of the function passes, built on the
+/// calling thread, so that passes keeping state across functions need not be
+/// thread safe. The threads share the function analysis manager, which is
+/// made thread safe for the run, and the context, which is set up for
+/// concurrent uniquing (\see LLVMContext::setConcurrentUniquing).
+///
+/// The rules of ModuleToFunctionPassAdaptor are strict here: the passes must
+/// not look at other functions, walk the users of constants and globals, or
+/// change the module. The instrumentation callbacks of the passes are called
+/// one at a time, but those that expect passes to nest, like the pass timers,
+/// don't work. The order of the use lists of constants and globals depends on
+/// how the threads are scheduled.
+class ParallelModuleToFunctionPassAdaptor
+    : public PassInfoMixin<ParallelModuleToFunctionPassAdaptor> {
+public:
+  using PassConceptT = detail::PassConcept<Function, FunctionAnalysisManager>;
+  using PassBuilderT = std::function<std::unique_ptr<PassConceptT>()>;
+
+  ParallelModuleToFunctionPassAdaptor(PassBuilderT PassBuilder,
+                                      ThreadPoolStrategy Strategy)
+      : PassBuilder(std::move(PassBuilder)), Strategy(Strategy) {}
+
+  /// Runs the function passes across every function in the module.
+  PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM);
+
+  static bool isRequired() { return true; }
+
+private:
+  PassBuilderT PassBuilder;
+  ThreadPoolStrategy Strategy;
+};
+
+/// A function to deduce the type of the function passes that \p PassBuilder
+/// returns, and wrap it in the parallel adaptor.
+template <typename FunctionPassBuilderT>
+ParallelModuleToFunctionPassAdaptor createParallelModuleToFunctionPassAdaptor(
+    FunctionPassBuilderT PassBuilder,
+    ThreadPoolStrategy Strategy = hardware_concurrency()) {
+  using FunctionPassT = decltype(PassBuilder());
+  using PassConceptT = ParallelModuleToFunctionPassAdaptor::PassConceptT;
+  using PassModelT =
+      detail::PassModel<Function, FunctionPassT, PreservedAnalyses,
+                        FunctionAnalysisManager>;
+
+  return ParallelModuleToFunctionPassAdaptor(
+      [PassBuilder]() -> std::unique_ptr<PassConceptT> {
+        return std::make_unique<PassModelT>(PassBuilder());
+      },
+      Strategy);
+}
+
 /// A utility pass template to force an analysis result to be available.
 ///
 /// If there are extra arguments at the pass's run level there may also be
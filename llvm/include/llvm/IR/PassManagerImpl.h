@@ -37,6 +37,7 @@ template <typename IRUnitT, typename... ExtraArgTs>
 inline void
 AnalysisManager<IRUnitT, ExtraArgTs...>::clear(IRUnitT &IR,
                                                llvm::StringRef Name) {
+  auto Lock = lockIfThreadSafe();
   if (DebugLogging)
     dbgs() << "Clearing all analysis results for: " << Name << "\n";
 
@@ -55,6 +56,7 @@ template <typename IRUnitT, typename... ExtraArgTs>
 inline typename AnalysisManager<IRUnitT, ExtraArgTs...>::ResultConceptT &
 AnalysisManager<IRUnitT, ExtraArgTs...>::getResultImpl(
     AnalysisKey *ID, IRUnitT &IR, ExtraArgTs... ExtraArgs) {
+  auto Lock = lockIfThreadSafe();
   typename AnalysisResultMapT::iterator RI;
   bool Inserted;
   std::tie(RI, Inserted) = AnalysisResults.insert(std::make_pair(
@@ -71,8 +73,15 @@ AnalysisManager<IRUnitT, ExtraArgTs...>::getResultImpl(
       PI.runBeforeAnalysis(P, IR);
     }
 
+    // Other threads may get the results of other IR units meanwhile.
+    if (Lock)
+      Lock.unlock();
+    auto Result = P.run(IR, *this, ExtraArgs...);
+    if (Lock.mutex())
+      Lock.lock();
+
     AnalysisResultListT &ResultList = AnalysisResultLists[&IR];
-    ResultList.emplace_back(ID, P.run(IR, *this, ExtraArgs...));
+    ResultList.emplace_back(ID, std::move(Result));
 
     PI.runAfterAnalysis(P, IR);
 
@@ -94,6 +103,8 @@ inline void AnalysisManager<IRUnitT, ExtraArgTs...>::invalidate(
   if (PA.allAnalysesInSetPreserved<AllAnalysesOn<IRUnitT>>())
     return;
 
+  auto Lock = lockIfThreadSafe();
+
   // Track whether each analysis's result is invalidated in
   // IsResultInvalidated.
   SmallDenseMap<AnalysisKey *, bool, 8> IsResultInvalidated;
@@ -20,8 +20,12 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/PerfCounters.h"
 #include "llvm/Support/Timer.h"
+#include <chrono>
+#include <map>
 #include <memory>
+#include <string>
 #include <utility>
 
 namespace llvm {
@@ -101,6 +105,83 @@ private:
   void runAfterPass(StringRef PassID);
 };
 
+/// This class implements -time-passes-counters for the new pass manager. It
+/// tallies the wall time, the hardware events (see PerfCounters) and the
+/// memory of each pass on each function, and at the end of its life-time
+/// writes them out as JSON, one object per line:
+///
+///   {"pass":"InstCombinePass","function":"foo","runs":2,"wall-ns":81234,
+///    "instructions":190342,"cycles":120544,"cache-misses":312,
+///    "malloc-bytes":4096,"peak-memory-growth-bytes":0}
+///
+/// The function is empty for passes over modules and other IR units. The
+/// counts of a pass exclude those of the passes and analyses it runs in turn.
+/// "malloc-bytes" is the net change of the memory allocated with malloc,
+/// "peak-memory-growth-bytes" how much the pass raised the peak resident set
+/// size of the process. The counters that the system doesn't provide are left
+/// out. As all values are sums, the reports of several compilations merge by
+/// adding up the records of the same pass and function.
+///
+/// The hardware events are those of the thread that creates the handler,
+/// which is expected to run the passes.
+class PassCountersHandler {
+  struct Counts {
+    unsigned Runs = 0;
+    std::chrono::nanoseconds Wall{0};
+    PerfCounters::Values Events;
+    int64_t MallocBytes = 0;
+    int64_t PeakMemoryGrowth = 0;
+  };
+
+  /// The counts of each pass, by pass and function name.
+  std::map<std::pair<std::string, std::string>, Counts> Data;
+
+  /// Stack of the passes running, the innermost last.
+  SmallVector<Counts *, 8> Running;
+
+  /// The readings at the last pass boundary.
+  std::chrono::steady_clock::time_point LastWall;
+  PerfCounters::Values LastEvents;
+  size_t LastMalloc = 0;
+  size_t LastPeakMemory = 0;
+
+  std::unique_ptr<PerfCounters> Counters;
+
+  /// Custom output stream to print the counts into. By default (== nullptr)
+  /// they go to the -time-passes-counters-output file, appended, or to the
+  /// stream created by CreateInfoOutputFile().
+  raw_ostream *OutStream = nullptr;
+
+  bool Enabled;
+
+public:
+  PassCountersHandler();
+  PassCountersHandler(bool Enabled);
+
+  /// Destructor handles the print action if it has not been handled before.
+  ~PassCountersHandler() { print(); }
+
+  /// Prints out the counts and then resets them.
+  void print();
+
+  PassCountersHandler(const PassCountersHandler &) = delete;
+  void operator=(const PassCountersHandler &) = delete;
+
+  void registerCallbacks(PassInstrumentationCallbacks &PIC);
+
+  /// Set a custom output stream for subsequent reporting.
+  void setOutStream(raw_ostream &OutStream);
+
+private:
+  /// Charge what happened since the last pass boundary to the innermost
+  /// running pass.
+  void update();
+
+  // Implementation of pass instrumentation callbacks.
+  void runBeforePass(StringRef PassID, Any IR);
+  void runAfterPass(StringRef PassID);
+};
+
 } // namespace llvm
 
 #endif
@@ -28,6 +28,7 @@
 #include "llvm/ADT/PointerIntPair.h"
 #include "llvm/Support/CBindingWrapping.h"
 #include "llvm/Support/Compiler.h"
+#include <atomic>
 
 namespace llvm {
 
@@ -49,11 +50,21 @@ public:
   /// that also works with less standard-compliant compilers
   void swap(Use &RHS);
 
+  /// The number of contexts set up for concurrent uniquing. While there are
+  /// any, the use lists of the values that several functions may use, like
+  /// constants and globals, are changed under a lock of their context.
+  /// \see LLVMContext::setConcurrentUniquing
+  static std::atomic<unsigned> NumConcurrentContexts;
+
 private:
   /// Destructor - Only for zap()
   ~Use() {
-    if (Val)
-      removeFromList();
+    if (Val) {
+      if (LLVM_UNLIKELY(NumConcurrentContexts.load(std::memory_order_relaxed)))
+        setLocked(nullptr);
+      else
+        removeFromList();
+    }
   }
 
   /// Constructor
@@ -109,6 +120,10 @@ private:
     if (Next)
       Next->Prev = Prev;
   }
+
+  /// Like set, but with the lock of the use list of a value several
+  /// functions may use.
+  void setLocked(Value *V);
 };
 
 /// Allow clients to treat uses just like values when using
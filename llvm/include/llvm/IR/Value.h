@@ -111,7 +111,7 @@ protected:
   ///
   /// Note, this should *NOT* be used directly by any class other than User.
   /// User uses this value to find the Use list.
-  enum : unsigned { NumUserOperandsBits = 27 };
+  enum : unsigned { NumUserOperandsBits = 26 };
   unsigned NumUserOperands : NumUserOperandsBits;
 
   // Use the same type as the bitfield above so that MSVC will pack them.
@@ -120,6 +120,7 @@ protected:
   unsigned HasMetadata : 1; // Has metadata attached to this?
   unsigned HasHungOffUses : 1;
   unsigned HasDescriptor : 1;
+  unsigned IsArenaAllocated : 1; // Allocated in an LLVMContext::ArenaScope?
 
 private:
   template <typename UseT> // UseT == 'Use' or 'const Use'
@@ -842,6 +843,8 @@ inline raw_ostream &operator<<(raw_ostream &OS, const Value &V) {
 }
 
 void Use::set(Value *V) {
+  if (LLVM_UNLIKELY(NumConcurrentContexts.load(std::memory_order_relaxed)))
+    return setLocked(V);
   if (Val) removeFromList();
   Val = V;
   if (V) V->addUse(*this);
@@ -27,11 +27,37 @@ namespace lto {
 using AddBufferFn =
     std::function<void(unsigned Task, std::unique_ptr<MemoryBuffer> MB)>;
 
+/// A cache tier shared between machines, e.g. served over HTTP. It is looked
+/// up when an entry is missing from the local cache, and receives the entries
+/// created locally.
+///
+/// Methods may be called concurrently from several threads.
+class RemoteCache {
+public:
+  virtual ~RemoteCache();
+
+  /// Returns the object file cached for \p Key, or nullptr if there is none.
+  virtual std::unique_ptr<MemoryBuffer> lookup(StringRef Key) = 0;
+
+  /// Publish \p Object as the object file for \p Key. Errors are not
+  /// reported: the entry is then only available locally.
+  virtual void store(StringRef Key, MemoryBufferRef Object) = 0;
+};
+
+/// Create a remote cache tier which stores its entries in the given directory,
+/// typically on a file system shared by the machines using the cache. This
+/// function also creates the directory if it does not already exist.
+Expected<std::shared_ptr<RemoteCache>>
+directoryRemoteCache(StringRef RemoteDirectoryPath);
+
 /// Create a local file system cache which uses the given cache directory and
 /// file callback. This function also creates the cache directory if it does not
-/// already exist.
-Expected<NativeObjectCache> localCache(StringRef CacheDirectoryPath,
-                                       AddBufferFn AddBuffer);
+/// already exist. If \p Remote is set, entries missing from the cache directory
+/// are looked up in it before being recomputed, and new entries are published
+/// to it.
+Expected<NativeObjectCache>
+localCache(StringRef CacheDirectoryPath, AddBufferFn AddBuffer,
+           std::shared_ptr<RemoteCache> Remote = nullptr);
 
 } // namespace lto
 } // namespace llvm
@@ -149,10 +149,13 @@ struct Config {
   /// Specific thinLTO modules to compile.
   std::vector<std::string> ThinLTOModulesToCompile;
 
-  /// Time trace enabled.
+  /// Time trace enabled. The backend threads record into the trace of the
+  /// thread running LTO whenever it is being profiled, so this is only kept
+  /// for clients that set it.
   bool TimeTraceEnabled = false;
 
-  /// Time trace granularity.
+  /// Time trace granularity. The backend threads use the granularity of the
+  /// profiler of the thread running LTO.
   unsigned TimeTraceGranularity = 500;
 
   bool ShouldDiscardValueNames = true;
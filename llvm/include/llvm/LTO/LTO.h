@@ -95,6 +95,21 @@ setupStatsFile(StringRef StatsFilename);
 /// ordered indices to elements in the input array.
 std::vector<int> generateModulesOrdering(ArrayRef<BitcodeModule *> R);
 
+/// Produces a container ordering for optimal multi-threaded processing, with
+/// the elements of highest \p Costs first and ties broken by bitcode size.
+/// Returns ordered indices to elements in the input array.
+std::vector<int> generateModulesOrdering(ArrayRef<BitcodeModule *> R,
+                                         ArrayRef<uint64_t> Costs);
+
+/// Estimates the cost of running the ThinLTO backend on a module from the
+/// combined summary \p Index: the instruction count of the functions in
+/// \p DefinedGlobals plus the instruction count of the functions imported
+/// according to \p ImportList.
+uint64_t
+estimateThinBackendCost(const ModuleSummaryIndex &Index,
+                        const GVSummaryMapTy &DefinedGlobals,
+                        const FunctionImporter::ImportMapTy &ImportList);
+
 class LTO;
 struct SymbolResolution;
 class ThinBackendProc;
@@ -250,6 +265,22 @@ ThinBackend createWriteIndexesThinBackend(std::string OldPrefix,
                                           raw_fd_ostream *LinkedObjectsFile,
                                           IndexWriteCallback OnWrite);
 
+/// This ThinBackend hands the individual backend jobs to an external
+/// distributor program, which may run them on remote machines, and adds the
+/// object files it produces to the link.
+///
+/// For each job the backend writes the module's individual index, the bitcode
+/// of the module and of every module it imports from, and a job file listing
+/// them into JobDir (a fresh temporary directory if empty). It then runs
+/// "Distributor DistributorArgs... -o <object> <job file>" and waits for it to
+/// write <object>. At most Parallelism distributor processes run at a time.
+/// "llvm-lto2 run-backend" implements a local distributor.
+ThinBackend
+createOutOfProcessThinBackend(ThreadPoolStrategy Parallelism,
+                              std::string Distributor,
+                              std::vector<std::string> DistributorArgs,
+                              std::string JobDir);
+
 /// This class implements a resolution-based interface to LLVM's LTO
 /// functionality. It supports regular LTO, parallel LTO code generation and
 /// ThinLTO. You can use it from a linker in the following way:
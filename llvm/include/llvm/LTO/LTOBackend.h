@@ -65,6 +65,13 @@ bool loadReferencedModules(
     MapVector<llvm::StringRef, llvm::BitcodeModule> &ModuleMap,
     std::vector<std::unique_ptr<llvm::MemoryBuffer>>
         &OwnedImportsLifetimeManager);
+
+/// Distributed ThinLTO: run the backend job described by the job file at
+/// \p JobPath, as written by the backend created by
+/// createOutOfProcessThinBackend(), and write the object file to
+/// \p OutputPath.
+Error runThinBackendJob(const Config &C, StringRef JobPath,
+                        StringRef OutputPath);
 }
 }
 
@@ -182,9 +182,11 @@ private:
   bool fragmentNeedsRelaxation(const MCRelaxableFragment *IF,
                                const MCAsmLayout &Layout) const;
 
-  /// Perform one layout iteration and return true if any offsets
-  /// were adjusted.
-  bool layoutOnce(MCAsmLayout &Layout);
+  /// Perform one layout iteration of the sections before \p FirstStable and
+  /// return the index of the last section whose offsets were adjusted, or 0
+  /// if none were. Only the sections before that one can still need
+  /// relaxation, as the later ones were relaxed after every adjustment.
+  unsigned layoutOnce(MCAsmLayout &Layout, unsigned FirstStable);
 
   /// Perform one layout iteration of the given section and return true
   /// if any offsets were adjusted.
@@ -102,6 +102,14 @@ protected:
   /// offset \p FOffset as a symbol offset within the fragment.
   void flushPendingLabels(MCFragment *F, uint64_t FOffset = 0);
 
+  /// Encode \p Inst at the end of \p DF and add its fixups to \p DF. The
+  /// instruction is encoded straight into the fragment contents, without a
+  /// temporary buffer.
+  /// \returns the index in DF.getFixups() of the first fixup of \p Inst.
+  size_t appendInstToDataFragment(const MCInst &Inst,
+                                  const MCSubtargetInfo &STI,
+                                  MCDataFragment &DF);
+
 public:
   void visitUsedSymbol(const MCSymbol &Sym) override;
 
@@ -20,6 +20,7 @@
 #include "llvm/MC/MCRegisterInfo.h"
 #include "llvm/MC/MCSubtargetInfo.h"
 #include "llvm/MCA/HardwareUnits/HardwareUnit.h"
+#include "llvm/MCA/HardwareUnits/LSUnit.h"
 #include "llvm/MCA/Pipeline.h"
 #include "llvm/MCA/SourceMgr.h"
 #include <memory>
@@ -45,6 +46,8 @@ struct PipelineOptions {
   unsigned StoreQueueSize;
   bool AssumeNoAlias;
   bool EnableBottleneckAnalysis;
+  // Data cache levels that loads can miss. Empty if every load hits the L1D.
+  SmallVector<CacheLevel, 3> CacheLevels;
 };
 
 class Context {
@@ -184,6 +184,19 @@ public:
   }
 };
 
+/// A level of a simple data cache hierarchy model.
+///
+/// llvm-mca doesn't know which addresses are accessed, so a cache level is
+/// only described by the share of the loads reaching it that miss it. Misses
+/// are spread evenly over those loads, which keeps the simulation
+/// deterministic.
+struct CacheLevel {
+  /// Percentage of the loads reaching this level that miss it.
+  unsigned MissRate;
+  /// Number of cycles that a miss in this level adds to the load latency.
+  unsigned MissLatency;
+};
+
 /// Abstract base interface for LS (load/store) units in llvm-mca.
 class LSUnitBase : public HardwareUnit {
   /// Load queue size.
@@ -212,6 +225,16 @@ class LSUnitBase : public HardwareUnit {
   /// alias with stores.
   const bool NoAlias;
 
+  /// Data cache levels, from the closest to the farthest one.
+  ///
+  /// By default there are none, and every load hits in the L1D with the
+  /// latency given by the scheduling model.
+  SmallVector<CacheLevel, 3> CacheLevels;
+
+  /// For each cache level, the misses (in hundredths) owed by the loads that
+  /// have reached it so far.
+  SmallVector<unsigned, 3> CacheMissCredits;
+
   /// Used to map group identifiers to MemoryGroups.
   DenseMap<unsigned, std::unique_ptr<MemoryGroup>> Groups;
   unsigned NextGroupID;
@@ -237,6 +260,15 @@ public:
 
   bool assumeNoAlias() const { return NoAlias; }
 
+  void setCacheLevels(ArrayRef<CacheLevel> Levels) {
+    CacheLevels.assign(Levels.begin(), Levels.end());
+    CacheMissCredits.assign(Levels.size(), 0);
+  }
+
+  /// Returns the number of cycles that cache misses add to the latency of
+  /// a load that is being issued.
+  unsigned getCacheMissLatency();
+
   enum Status {
     LSU_AVAILABLE = 0,
     LSU_LQUEUE_FULL, // Load Queue unavailable
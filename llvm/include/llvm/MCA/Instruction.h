@@ -213,7 +213,7 @@ public:
 
   // On every cycle, update CyclesLeft and notify dependent users.
   void cycleEvent();
-  void onInstructionIssued(unsigned IID);
+  void onInstructionIssued(unsigned IID, unsigned ExtraLatency = 0);
 
 #ifndef NDEBUG
   void dump() const;
@@ -512,7 +512,7 @@ public:
 
   // Instruction issued. Transition to the IS_EXECUTING state, and update
   // all the register definitions.
-  void execute(unsigned IID);
+  void execute(unsigned IID, unsigned ExtraLatency = 0);
 
   // Force a transition from the IS_DISPATCHED state to the IS_READY or
   // IS_PENDING state. State transitions normally occur either at the beginning
@@ -13,6 +13,7 @@
 #ifndef LLVM_OBJECT_ARCHIVEWRITER_H
 #define LLVM_OBJECT_ARCHIVEWRITER_H
 
+#include "llvm/ADT/Optional.h"
 #include "llvm/Object/Archive.h"
 
 namespace llvm {
@@ -22,6 +23,11 @@ struct NewArchiveMember {
   StringRef MemberName;
   sys::TimePoint<std::chrono::seconds> ModTime;
   unsigned UID = 0, GID = 0, Perms = 0644;
+  // The symbols that the member defines for the archive symbol table, if they
+  // are already known, e.g. from the symbol table of the archive that the
+  // member is copied from. The writer then uses them instead of parsing the
+  // member, and treats the member as an object file.
+  Optional<std::vector<StringRef>> Symbols;
 
   NewArchiveMember() = default;
   NewArchiveMember(MemoryBufferRef BufRef);
@@ -346,8 +346,10 @@ public:
   /// @param ObjectPath The path to the object file. ObjectPath.isObject must
   ///        return true.
   /// Create ObjectFile from path.
+  /// \param Hints A combination of MemoryBuffer::AccessHint values.
   static Expected<OwningBinary<ObjectFile>>
-  createObjectFile(StringRef ObjectPath);
+  createObjectFile(StringRef ObjectPath,
+                   unsigned Hints = MemoryBuffer::AH_None);
 
   static Expected<std::unique_ptr<ObjectFile>>
   createObjectFile(MemoryBufferRef Object, llvm::file_magic Type,
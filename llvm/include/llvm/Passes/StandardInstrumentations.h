@@ -15,14 +15,17 @@
 #ifndef LLVM_PASSES_STANDARDINSTRUMENTATIONS_H
 #define LLVM_PASSES_STANDARDINSTRUMENTATIONS_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/OptBisect.h"
 #include "llvm/IR/PassTimingInfo.h"
 #include "llvm/IR/ValueHandle.h"
 #include "llvm/Support/CommandLine.h"
 
+#include <chrono>
 #include <string>
 #include <utility>
 
@@ -78,6 +81,46 @@ public:
   void registerCallbacks(PassInstrumentationCallbacks &PIC);
 };
 
+/// Keeps the compile time of outlier functions in check. Once a function has
+/// spent -function-time-budget milliseconds in function and loop passes, or
+/// if it has more than -function-size-budget instructions, the expensive
+/// passes (-function-budget-expensive-passes) are skipped on it for the rest
+/// of the pipeline, which leaves it the cheaper ones. An analysis remark of
+/// "compile-time-budget" tells which functions went over their budget, and
+/// why.
+class CompileTimeBudgetInstrumentation {
+public:
+  CompileTimeBudgetInstrumentation(bool DebugLogging);
+  void registerCallbacks(PassInstrumentationCallbacks &PIC);
+
+  /// Return true if \p F went over its budget.
+  bool isOverBudget(const Function &F) const {
+    auto I = Budgets.find(&F);
+    return I != Budgets.end() && I->second.OverBudget;
+  }
+
+private:
+  struct FunctionBudget {
+    /// The time spent in the passes that are done.
+    std::chrono::steady_clock::duration Spent{0};
+    /// When the outermost of the running passes started.
+    std::chrono::steady_clock::time_point Start;
+    /// The number of passes running on the function.
+    unsigned Depth = 0;
+    bool OverBudget = false;
+  };
+
+  DenseMap<const Function *, FunctionBudget> Budgets;
+  /// The function of each running pass, if it has one.
+  SmallVector<const Function *, 8> Running;
+  StringSet<> ExpensivePasses;
+  bool DebugLogging;
+
+  bool shouldRun(StringRef PassID, Any IR);
+  void runBeforePass(Any IR);
+  void runAfterPass();
+};
+
 // Debug logging for transformation and analysis passes.
 class PrintPassInstrumentation {
 public:
@@ -265,8 +308,10 @@ class StandardInstrumentations {
   PrintIRInstrumentation PrintIR;
   PrintPassInstrumentation PrintPass;
   TimePassesHandler TimePasses;
+  PassCountersHandler PassCounters;
   OptNoneInstrumentation OptNone;
   OptBisectInstrumentation OptBisect;
+  CompileTimeBudgetInstrumentation CompileTimeBudget;
   PreservedCFGCheckerInstrumentation PreservedCFGChecker;
   IRChangedPrinter PrintChangedIR;
   VerifyInstrumentation Verify;
@@ -275,12 +320,14 @@ class StandardInstrumentations {
 
 public:
   StandardInstrumentations(bool DebugLogging, bool VerifyEach = false)
-      : PrintPass(DebugLogging), OptNone(DebugLogging), Verify(DebugLogging),
+      : PrintPass(DebugLogging), OptNone(DebugLogging),
+        CompileTimeBudget(DebugLogging), Verify(DebugLogging),
         VerifyEach(VerifyEach) {}
 
   void registerCallbacks(PassInstrumentationCallbacks &PIC);
 
   TimePassesHandler &getTimePasses() { return TimePasses; }
+  PassCountersHandler &getPassCounters() { return PassCounters; }
 };
 
 extern template class ChangeReporter<std::string>;
@@ -28,6 +28,7 @@
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cassert>
 #include <cstdint>
@@ -45,6 +46,7 @@ class IndexedInstrProfReader;
 
 namespace coverage {
 
+class BinaryCoverageReader;
 class CoverageMappingReader;
 struct CoverageMappingRecord;
 
@@ -524,6 +526,18 @@ class CoverageMapping {
   Error loadFunctionRecord(const CoverageMappingRecord &Record,
                            IndexedInstrProfReader &ProfileReader);
 
+  /// Add \p Function, unless a function with the same name and files was
+  /// added before.
+  void addFunctionRecord(FunctionRecord &&Function);
+
+  /// Add the function records of \p CoverageReaders, decoding and evaluating
+  /// them in parallel. \p ProfileReader reads \p ProfileFilename, which is
+  /// opened again for the workers that need a reader of their own.
+  Error loadFunctionRecordsInParallel(
+      ArrayRef<std::unique_ptr<BinaryCoverageReader>> CoverageReaders,
+      std::unique_ptr<IndexedInstrProfReader> ProfileReader,
+      StringRef ProfileFilename, ThreadPoolStrategy S);
+
   /// Look up the indices for function records which are at least partially
   /// defined in the specified file. This is guaranteed to return a superset of
   /// such records: extra records not in the file may be included if there is
@@ -543,9 +557,12 @@ public:
   /// Load the coverage mapping from the given object files and profile. If
   /// \p Arches is non-empty, it must specify an architecture for each object.
   /// Ignores non-instrumented object files unless all are not instrumented.
+  /// The objects are read, and their records evaluated, on the threads of
+  /// \p S. The result does not depend on the number of threads.
   static Expected<std::unique_ptr<CoverageMapping>>
   load(ArrayRef<StringRef> ObjectFilenames, StringRef ProfileFilename,
-       ArrayRef<StringRef> Arches = None);
+       ArrayRef<StringRef> Arches = None,
+       ThreadPoolStrategy S = hardware_concurrency(1));
 
   /// The number of functions that couldn't have their profiles mapped.
   ///
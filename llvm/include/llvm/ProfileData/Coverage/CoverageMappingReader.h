@@ -176,14 +176,19 @@ public:
 
   using DecompressedData = std::vector<std::unique_ptr<SmallVector<char, 0>>>;
 
+  /// Storage for the filenames, expressions and regions of a decoded record.
+  struct RecordStorage {
+    std::vector<StringRef> Filenames;
+    std::vector<CounterExpression> Expressions;
+    std::vector<CounterMappingRegion> MappingRegions;
+  };
+
 private:
   std::vector<StringRef> Filenames;
   std::vector<ProfileMappingRecord> MappingRecords;
   InstrProfSymtab ProfileNames;
   size_t CurrentRecord = 0;
-  std::vector<StringRef> FunctionsFilenames;
-  std::vector<CounterExpression> Expressions;
-  std::vector<CounterMappingRegion> MappingRegions;
+  RecordStorage CurrentStorage;
 
   // Used to tie the lifetimes of coverage function records to the lifetime of
   // this BinaryCoverageReader instance. Needed to support the format change in
@@ -212,6 +217,15 @@ public:
                                  support::endianness Endian);
 
   Error readNextRecord(CoverageMappingRecord &Record) override;
+
+  /// The number of function records in the coverage mapping.
+  size_t getNumRecords() const { return MappingRecords.size(); }
+
+  /// Decode the function record at \p Index into \p Record, whose arrays are
+  /// kept in \p Storage. This does not change the state of the reader, so
+  /// different records may be decoded concurrently.
+  Error readRecord(size_t Index, CoverageMappingRecord &Record,
+                   RecordStorage &Storage) const;
 };
 
 /// Reader for the raw coverage filenames.
@@ -0,0 +1,112 @@
+//===- MemProf.h - Read memory profiles -------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file contains the definitions needed for reading the memory profiles
+// written by the memprof runtime.
+//
+// Text format
+// -----------
+//
+// The runtime writes a profile when run with print_terse=1,
+// print_alloc_stacks=1 and demangle=0. Each allocation context is described
+// by a MIB line:
+//
+//    MIB:StackID/AllocCount/AveSize/MinSize/MaxSize/AveAccessCount/
+//        MinAccessCount/MaxAccessCount/AveLifetime/MinLifetime/MaxLifetime/
+//        NumMigratedCpu/NumLifetimeOverlaps/NumSameAllocCpu/NumSameDeallocCpu
+//
+// followed by one line for each frame of its allocation call stack, innermost
+// frame first:
+//
+//    STK:StackID/Function/Line/Column
+//
+// Lifetimes are in milliseconds. A context may be described more than once,
+// in which case the descriptions are merged. Other lines are ignored.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_PROFILEDATA_MEMPROF_H
+#define LLVM_PROFILEDATA_MEMPROF_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace llvm {
+namespace memprof {
+
+/// A frame of an allocation call stack.
+struct Frame {
+  /// The linkage name of the function, or its name if it has none.
+  std::string Function;
+  uint32_t Line = 0;
+  uint32_t Column = 0;
+
+  bool operator==(const Frame &Other) const {
+    return Function == Other.Function && Line == Other.Line &&
+           Column == Other.Column;
+  }
+};
+
+/// The behavior of the allocations made from one allocation call stack.
+struct AllocationInfo {
+  uint64_t StackId = 0;
+  uint64_t AllocCount = 0;
+  double AveSize = 0;
+  uint64_t MinSize = 0;
+  uint64_t MaxSize = 0;
+  double AveAccessCount = 0;
+  uint64_t MinAccessCount = 0;
+  uint64_t MaxAccessCount = 0;
+  double AveLifetime = 0;
+  uint64_t MinLifetime = 0;
+  uint64_t MaxLifetime = 0;
+  uint64_t NumMigratedCpu = 0;
+  uint64_t NumLifetimeOverlaps = 0;
+  uint64_t NumSameAllocCpu = 0;
+  uint64_t NumSameDeallocCpu = 0;
+
+  /// The allocation call stack, innermost frame first.
+  std::vector<Frame> CallStack;
+
+  /// Merge another description of the same allocation context.
+  void merge(const AllocationInfo &Other);
+};
+
+/// Reader for the text memory profile written by the memprof runtime.
+class MemProfReader {
+public:
+  /// Read the profile in \p Path.
+  static Expected<std::unique_ptr<MemProfReader>> create(const Twine &Path);
+
+  /// Read the profile in \p Buffer.
+  static Expected<std::unique_ptr<MemProfReader>>
+  create(std::unique_ptr<MemoryBuffer> Buffer);
+
+  /// The allocation contexts of the profile, in the order they were first
+  /// described.
+  ArrayRef<AllocationInfo> getAllocations() const { return Allocations; }
+
+private:
+  MemProfReader() = default;
+
+  Error read(const MemoryBuffer &Buffer);
+
+  std::vector<AllocationInfo> Allocations;
+};
+
+} // end namespace memprof
+} // end namespace llvm
+
+#endif // LLVM_PROFILEDATA_MEMPROF_H
@@ -175,7 +175,10 @@ enum class SecProfSummaryFlags : uint32_t {
   /// SecFlagPartial means the profile is for common/shared code.
   /// The common profile is usually merged from profiles collected
   /// from running other targets.
-  SecFlagPartial = (1 << 0)
+  SecFlagPartial = (1 << 0),
+  /// SecFlagFullContext means the top-level profiles are named by their
+  /// full calling context, as in a context-sensitive profile.
+  SecFlagFullContext = (1 << 1)
 };
 
 // Verify section specific flag is used for the correct section.
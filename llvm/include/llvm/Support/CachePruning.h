@@ -73,8 +73,18 @@ Expected<CachePruningPolicy> parseCachePruningPolicy(StringRef PolicyStr);
 /// As a safeguard against data loss if the user specifies the wrong directory
 /// as their cache directory, this function will ignore files not matching the
 /// pattern "llvmcache-*".
+///
+/// After walking the directory, the total size and number of files left in
+/// the cache are recorded in it. As long as the files recorded since then
+/// with recordCacheFileAdded() keep the cache within the policy, and no file
+/// can have expired, later prunings don't walk the directory again.
 bool pruneCache(StringRef Path, CachePruningPolicy Policy);
 
+/// Record that a file of \p Size bytes was added to the cache directory
+/// \p Path, to keep the accounting used by pruneCache() up to date. Safe to
+/// call from several processes sharing the cache.
+void recordCacheFileAdded(StringRef Path, uint64_t Size);
+
 } // namespace llvm
 
 #endif
@@ -20,6 +20,7 @@ template <typename T> class SmallVectorImpl;
 class Error;
 class StringRef;
 
+namespace compression {
 namespace zlib {
 
 static constexpr int NoCompression = 0;
@@ -41,8 +42,83 @@ Error uncompress(StringRef InputBuffer,
 
 uint32_t crc32(StringRef Buffer);
 
+/// Compress \p InputBuffer into raw deflate data, without the zlib header and
+/// trailer. Unless \p Final is true, the output ends with a sync flush, which
+/// leaves it byte aligned so that more deflate data can follow. Compressing
+/// consecutive pieces of a buffer independently (the last one with \p Final)
+/// and concatenating the results yields a valid deflate stream for the whole
+/// buffer, which allows compressing large buffers in parallel.
+Error compressRaw(StringRef InputBuffer,
+                  SmallVectorImpl<char> &CompressedBuffer, int Level,
+                  bool Final);
+
+/// Return the Adler-32 checksum of \p Buffer, as stored in the zlib trailer.
+uint32_t adler32(StringRef Buffer);
+
+/// Return the Adler-32 checksum of the concatenation of two buffers given the
+/// checksums of both and the length of the second one.
+uint32_t adler32Combine(uint32_t Adler1, uint32_t Adler2, size_t Length2);
+
 }  // End of namespace zlib
 
+namespace zstd {
+
+static constexpr int BestSpeedCompression = 1;
+static constexpr int DefaultCompression = 5;
+static constexpr int BestSizeCompression = 12;
+
+bool isAvailable();
+
+/// Compress \p InputBuffer into a single zstd frame. The frame records the
+/// uncompressed size. Concatenated frames form a valid zstd stream, which
+/// callers may use to compress independent chunks of a buffer in parallel.
+Error compress(StringRef InputBuffer, SmallVectorImpl<char> &CompressedBuffer,
+               int Level = DefaultCompression);
+
+/// Decompress one or more concatenated zstd frames. \p UncompressedSize is the
+/// capacity of \p UncompressedBuffer on input and the number of bytes written
+/// on output.
+Error uncompress(StringRef InputBuffer, char *UncompressedBuffer,
+                 size_t &UncompressedSize);
+
+Error uncompress(StringRef InputBuffer,
+                 SmallVectorImpl<char> &UncompressedBuffer,
+                 size_t UncompressedSize);
+
+}  // End of namespace zstd
+
+enum class Format {
+  Zlib,
+  Zstd,
+};
+
+/// Return the name of the library implementing \p F, for use in diagnostics.
+const char *getName(Format F);
+
+/// Return true if LLVM was built with support for \p F.
+bool isAvailable(Format F);
+
+/// Return the default compression level of \p F.
+int getDefaultLevel(Format F);
+
+/// Compress \p InputBuffer with the algorithm \p F. \p Level is interpreted
+/// by the algorithm, see the constants in the respective namespaces.
+Error compress(Format F, StringRef InputBuffer,
+               SmallVectorImpl<char> &CompressedBuffer, int Level);
+
+Error uncompress(Format F, StringRef InputBuffer, char *UncompressedBuffer,
+                 size_t &UncompressedSize);
+
+Error uncompress(Format F, StringRef InputBuffer,
+                 SmallVectorImpl<char> &UncompressedBuffer,
+                 size_t UncompressedSize);
+
+} // End of namespace compression
+
+// Most users only need one algorithm and predate the compression namespace.
+namespace zlib = compression::zlib;
+namespace zstd = compression::zstd;
+
 } // End of namespace llvm
 
 #endif
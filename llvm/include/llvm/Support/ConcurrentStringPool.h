@@ -0,0 +1,75 @@
+//===- llvm/Support/ConcurrentStringPool.h ----------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares ConcurrentStringPool, a string interning table that many
+// threads can use at once.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_CONCURRENTSTRINGPOOL_H
+#define LLVM_SUPPORT_CONCURRENTSTRINGPOOL_H
+
+#include "llvm/ADT/CachedHashString.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/Allocator.h"
+#include <memory>
+#include <mutex>
+
+namespace llvm {
+
+/// Saves strings in stable storage owned by the pool, and returns a StringRef
+/// with a stable character pointer. Saving the same string yields the same
+/// StringRef, whichever thread saves it.
+///
+/// This is UniqueStringSaver for multithreaded tools. The strings are spread
+/// over shards by their hash, and each shard has its own lock, table and
+/// allocator, so that threads saving different strings rarely wait for each
+/// other. The hash is computed once, outside of any lock.
+class ConcurrentStringPool {
+public:
+  /// Create a pool of \p NumShards shards, rounded up to a power of two. By
+  /// default, there are a few shards per hardware thread.
+  explicit ConcurrentStringPool(unsigned NumShards = 0);
+  ~ConcurrentStringPool();
+
+  ConcurrentStringPool(const ConcurrentStringPool &) = delete;
+  ConcurrentStringPool &operator=(const ConcurrentStringPool &) = delete;
+
+  // All returned strings are null-terminated: *save(S).end() == 0.
+  StringRef save(const char *S) { return save(StringRef(S)); }
+  StringRef save(StringRef S);
+  StringRef save(const Twine &S) { return save(StringRef(S.str())); }
+  StringRef save(const std::string &S) { return save(StringRef(S)); }
+
+  /// Return the number of distinct strings saved.
+  size_t size() const;
+
+  /// Return the number of bytes allocated to hold the strings.
+  size_t getBytesAllocated() const;
+
+  unsigned getNumShards() const { return NumShards; }
+
+private:
+  struct Shard {
+    mutable std::mutex Mutex;
+    DenseSet<CachedHashStringRef> Strings;
+    BumpPtrAllocator Alloc;
+  };
+
+  std::unique_ptr<Shard[]> Shards;
+  unsigned NumShards;
+  /// The shard of a string is given by the top bits of its hash, as the
+  /// tables of the shards index their buckets with the bottom ones.
+  unsigned ShardShift;
+};
+
+} // end namespace llvm
+
+#endif // LLVM_SUPPORT_CONCURRENTSTRINGPOOL_H
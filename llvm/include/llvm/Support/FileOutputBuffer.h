@@ -34,6 +34,17 @@ public:
     /// Don't use mmap and instead write an in-memory buffer to a file when this
     /// buffer is closed.
     F_no_mmap = 2,
+
+    /// Modify the existing file in place instead of replacing it. Writes are
+    /// visible as soon as they are made and cannot be discarded, but the
+    /// parts of the file that aren't written keep their previous contents.
+    F_modify = 4,
+
+    /// Keep the buffer in memory and write it to the file with direct I/O,
+    /// bypassing the page cache, so that the kernel has no dirty pages left to
+    /// flush once the file is committed. Ranges passed to writeback() are
+    /// written right away. Ignored where direct I/O is not available.
+    F_direct = 8,
   };
 
   /// Factory method to create an OutputBuffer object which manages a read/write
@@ -60,6 +71,20 @@ public:
   /// Returns path where file will show up if buffer is committed.
   StringRef getPath() const { return FinalPath; }
 
+  /// Copies \p Size bytes at offset \p InOffset of the file \p InFD to
+  /// \p Offset in the buffer, without reading them into memory, see
+  /// sys::fs::copy_file_range(). Returns false if the buffer can't do that, in
+  /// which case the caller should copy the bytes through getBufferStart().
+  virtual bool copyFromFile(int InFD, uint64_t InOffset, size_t Offset,
+                            size_t Size) {
+    return false;
+  }
+
+  /// Tells the buffer that \p Size bytes at \p Offset are final and will not
+  /// be written again, so that they can be written to the file now instead
+  /// of all at once on commit(). May be called from several threads.
+  virtual void writeback(size_t Offset, size_t Size) {}
+
   /// Flushes the content of the buffer to its file and deallocates the
   /// buffer.  If commit() is not called before this object's destructor
   /// is called, the file is deleted in the destructor. The optional parameter
@@ -403,6 +403,19 @@ std::error_code copy_file(const Twine &From, const Twine &To);
 /// @param ToFD The open file descriptor of the destination file.
 std::error_code copy_file(const Twine &From, int ToFD);
 
+/// Copy \a Size bytes at offset \a InOffset of the file \a InFD to offset
+/// \a OutOffset of the file \a OutFD, without passing the data through this
+/// process. File systems that support it may share the data between the files
+/// instead of copying it.
+///
+/// @param InFD The open file descriptor of the file to copy from.
+/// @param OutFD The open file descriptor of the file to copy to.
+/// @returns errc::function_not_supported if the platform or file system can't
+///          copy the data this way. On error, part of the range may have been
+///          copied already, and the caller should copy all of it itself.
+std::error_code copy_file_range(int InFD, uint64_t InOffset, int OutFD,
+                                uint64_t OutOffset, uint64_t Size);
+
 /// Resize path to size. File is resized as if by POSIX truncate().
 ///
 /// @param FD Input file descriptor.
@@ -1211,6 +1224,16 @@ public:
     priv ///< May modify via data, but changes are lost on destruction.
   };
 
+  /// Hints about how the mapping will be accessed, which may be combined.
+  /// They only affect performance, and may be ignored.
+  enum maphint : unsigned {
+    hint_none = 0,
+    hint_sequential = 1 << 0, ///< Read front to back: read ahead aggressively.
+    hint_random = 1 << 1,     ///< Read in no particular order: no read ahead.
+    hint_populate = 1 << 2,   ///< Read in full: fault all pages in up front.
+    hint_hugepages = 1 << 3,  ///< Large: align the mapping for huge pages.
+  };
+
 private:
   /// Platform-specific mapping state.
   size_t Size;
@@ -1220,7 +1243,8 @@ private:
 #endif
   mapmode Mode;
 
-  std::error_code init(sys::fs::file_t FD, uint64_t Offset, mapmode Mode);
+  std::error_code init(sys::fs::file_t FD, uint64_t Offset, mapmode Mode,
+                       unsigned Hints);
 
 public:
   mapped_file_region() = delete;
@@ -1228,8 +1252,9 @@ public:
   mapped_file_region &operator =(mapped_file_region&) = delete;
 
   /// \param fd An open file descriptor to map. Does not take ownership of fd.
+  /// \param hints A combination of maphint values.
   mapped_file_region(sys::fs::file_t fd, mapmode mode, size_t length, uint64_t offset,
-                     std::error_code &ec);
+                     std::error_code &ec, unsigned hints = hint_none);
 
   ~mapped_file_region();
 
@@ -141,7 +141,7 @@ public:
     unsigned OldBitWidth = getBitWidth();
     APInt NewZero = Zero.zext(BitWidth);
     NewZero.setBitsFrom(OldBitWidth);
-    return KnownBits(NewZero, One.zext(BitWidth));
+    return KnownBits(std::move(NewZero), One.zext(BitWidth));
   }
 
   /// Return known bits for a sign extension of the value we're tracking.
@@ -264,6 +264,14 @@ public:
     return KnownBits(LHS.Zero & RHS.Zero, LHS.One & RHS.One);
   }
 
+  /// Compute known bits common to LHS and RHS, reusing the storage of LHS.
+  /// This is the common `Known = commonBits(std::move(Known), Known2)` case.
+  static KnownBits commonBits(KnownBits &&LHS, const KnownBits &RHS) {
+    LHS.Zero &= RHS.Zero;
+    LHS.One &= RHS.One;
+    return std::move(LHS);
+  }
+
   /// Compute known bits resulting from adding LHS, RHS and a 1-bit Carry.
   static KnownBits computeForAddCarry(
       const KnownBits &LHS, const KnownBits &RHS, const KnownBits &Carry);
@@ -129,6 +129,21 @@ namespace sys {
     static std::error_code protectMappedMemory(const MemoryBlock &Block,
                                                unsigned Flags);
 
+    /// This method tells the operating system that the pages lying entirely
+    /// within [\p Addr, \p Addr + \p Len) are not needed anymore, so that
+    /// their physical memory can be reclaimed. Pages that are only partially
+    /// covered are left alone. The range stays mapped: pages of a file
+    /// mapping are read back from the file if accessed again, whereas
+    /// anonymous pages may read as zero. This is a no-op on systems that
+    /// don't support it.
+    /// \p Addr and \p Len describe the memory to be discarded.
+    ///
+    /// \r error_success if the function was successful, or an error_code
+    /// describing the failure if an error occurred.
+    ///
+    /// Discard pages.
+    static std::error_code discardPages(const void *Addr, size_t Len);
+
     /// InvalidateInstructionCache - Before the JIT can run a block of code
     /// that has been emitted it must invalidate the instruction cache on some
     /// platforms.
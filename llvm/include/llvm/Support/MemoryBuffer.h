@@ -74,6 +74,23 @@ public:
   /// from.
   virtual StringRef getBufferIdentifier() const { return "Unknown buffer"; }
 
+  /// Hints about how a buffer read from a file will be accessed, which may be
+  /// combined. They let the operating system read the file ahead of the
+  /// accesses when it is mapped into memory, and are ignored otherwise.
+  enum AccessHint : unsigned {
+    AH_None = 0,
+    /// The buffer is read front to back: read ahead aggressively.
+    AH_Sequential = 1 << 0,
+    /// The buffer is read in no particular order: do not read ahead.
+    AH_Random = 1 << 1,
+    /// The whole buffer will be read: read it all in when opening the file
+    /// rather than on first access.
+    AH_Populate = 1 << 2,
+    /// The buffer is large and lives long: map it so that it can be backed by
+    /// huge pages.
+    AH_HugePages = 1 << 3,
+  };
+
   /// Open the specified file as a MemoryBuffer, returning a new MemoryBuffer
   /// if successful, otherwise returning null. If FileSize is specified, this
   /// means that the client knows that the file exists and that it has the
@@ -82,9 +99,12 @@ public:
   /// \param IsVolatile Set to true to indicate that the contents of the file
   /// can change outside the user's control, e.g. when libclang tries to parse
   /// while the user is editing/updating the file or if the file is on an NFS.
+  ///
+  /// \param Hints A combination of AccessHint values.
   static ErrorOr<std::unique_ptr<MemoryBuffer>>
   getFile(const Twine &Filename, int64_t FileSize = -1,
-          bool RequiresNullTerminator = true, bool IsVolatile = false);
+          bool RequiresNullTerminator = true, bool IsVolatile = false,
+          unsigned Hints = AH_None);
 
   /// Read all of the specified file into a MemoryBuffer as a stream
   /// (i.e. until EOF reached). This is useful for special files that
@@ -97,7 +117,8 @@ public:
   /// Since this is in the middle of a file, the buffer is not null terminated.
   static ErrorOr<std::unique_ptr<MemoryBuffer>>
   getOpenFileSlice(sys::fs::file_t FD, const Twine &Filename, uint64_t MapSize,
-                   int64_t Offset, bool IsVolatile = false);
+                   int64_t Offset, bool IsVolatile = false,
+                   unsigned Hints = AH_None);
 
   /// Given an already-open file descriptor, read the file and return a
   /// MemoryBuffer.
@@ -107,7 +128,8 @@ public:
   /// while the user is editing/updating the file or if the file is on an NFS.
   static ErrorOr<std::unique_ptr<MemoryBuffer>>
   getOpenFile(sys::fs::file_t FD, const Twine &Filename, uint64_t FileSize,
-              bool RequiresNullTerminator = true, bool IsVolatile = false);
+              bool RequiresNullTerminator = true, bool IsVolatile = false,
+              unsigned Hints = AH_None);
 
   /// Open the specified memory range as a MemoryBuffer. Note that InputData
   /// must be null terminated if RequiresNullTerminator is true.
@@ -130,12 +152,12 @@ public:
   /// is "-".
   static ErrorOr<std::unique_ptr<MemoryBuffer>>
   getFileOrSTDIN(const Twine &Filename, int64_t FileSize = -1,
-                 bool RequiresNullTerminator = true);
+                 bool RequiresNullTerminator = true, unsigned Hints = AH_None);
 
   /// Map a subrange of the specified file as a MemoryBuffer.
   static ErrorOr<std::unique_ptr<MemoryBuffer>>
   getFileSlice(const Twine &Filename, uint64_t MapSize, uint64_t Offset,
-               bool IsVolatile = false);
+               bool IsVolatile = false, unsigned Hints = AH_None);
 
   //===--------------------------------------------------------------------===//
   // Provided for performance analysis.
@@ -16,6 +16,7 @@
 #include "llvm/Support/Threading.h"
 
 #include <algorithm>
+#include <chrono>
 #include <condition_variable>
 #include <functional>
 #include <mutex>
@@ -57,19 +58,33 @@ public:
     std::unique_lock<std::mutex> lock(Mutex);
     Cond.wait(lock, [&] { return Count == 0; });
   }
+
+  /// Wait until the count drops to zero or \p Timeout expires. Returns true
+  /// if the count is zero.
+  template <class Rep, class Period>
+  bool syncFor(const std::chrono::duration<Rep, Period> &Timeout) const {
+    std::unique_lock<std::mutex> lock(Mutex);
+    return Cond.wait_for(lock, Timeout, [&] { return Count == 0; });
+  }
+
+  bool isDone() const {
+    std::lock_guard<std::mutex> lock(Mutex);
+    return Count == 0;
+  }
 };
 
+/// A group of tasks running on the default executor. Task groups may be
+/// nested: tasks may spawn tasks into other groups and wait for them. A worker
+/// thread waiting for a group runs queued tasks instead of blocking.
 class TaskGroup {
   Latch L;
-  bool Parallel;
 
 public:
-  TaskGroup();
   ~TaskGroup();
 
   void spawn(std::function<void()> f);
 
-  void sync() const { L.sync(); }
+  void sync() const;
 };
 
 const ptrdiff_t MinParallelSize = 1024;
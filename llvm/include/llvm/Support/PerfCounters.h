@@ -0,0 +1,79 @@
+//===- llvm/Support/PerfCounters.h - Performance counters -------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares PerfCounters, which reads the hardware performance
+// counters of the calling thread.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_PERFCOUNTERS_H
+#define LLVM_SUPPORT_PERFCOUNTERS_H
+
+#include "llvm/ADT/StringRef.h"
+#include <cstdint>
+
+namespace llvm {
+
+/// Counts the instructions, cycles and last level cache misses of the thread
+/// that creates it, with Linux perf_event. The counters are not available on
+/// other systems, or if the kernel denies access to them (see
+/// perf_event_paranoid), in which case they read as zero.
+class PerfCounters {
+public:
+  enum Counter { Instructions, Cycles, CacheMisses, NumCounters };
+
+  /// A reading of the counters. Readings subtract to give the counts of the
+  /// events in between.
+  struct Values {
+    uint64_t Counts[NumCounters] = {};
+
+    uint64_t operator[](Counter C) const { return Counts[C]; }
+
+    Values &operator+=(const Values &RHS) {
+      for (unsigned I = 0; I != NumCounters; ++I)
+        Counts[I] += RHS.Counts[I];
+      return *this;
+    }
+    Values &operator-=(const Values &RHS) {
+      for (unsigned I = 0; I != NumCounters; ++I)
+        Counts[I] -= RHS.Counts[I];
+      return *this;
+    }
+  };
+
+  /// Open and start the counters of the calling thread.
+  PerfCounters();
+  ~PerfCounters();
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  /// Return true if \p C is counted.
+  bool isAvailable(Counter C) const { return Index[C] >= 0; }
+
+  /// Return true if any counter is counted.
+  bool isAvailable() const { return GroupFD >= 0; }
+
+  /// Read all the counters at once.
+  Values read() const;
+
+  /// Return the name of \p C, as perf names it.
+  static StringRef getName(Counter C);
+
+private:
+  /// The leader of the group of counters, or -1.
+  int GroupFD = -1;
+  /// The other counters of the group.
+  int FDs[NumCounters - 1] = {-1, -1};
+  /// The position of each counter within the reading of the group, or -1.
+  int Index[NumCounters] = {-1, -1, -1};
+};
+
+} // end namespace llvm
+
+#endif // LLVM_SUPPORT_PERFCOUNTERS_H
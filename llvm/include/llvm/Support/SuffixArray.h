@@ -0,0 +1,68 @@
+//===- llvm/Support/SuffixArray.h - Array for substrings --------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the Suffix Array class.
+//
+//===----------------------------------------------------------------------===//
+#ifndef LLVM_SUPPORT_SUFFIXARRAY_H
+#define LLVM_SUPPORT_SUFFIXARRAY_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/SuffixTree.h"
+#include <vector>
+
+namespace llvm {
+
+/// The suffixes of a string in lexicographical order, along with the length
+/// of the longest common prefix of each pair of neighbouring suffixes.
+///
+/// This finds the same repeated substrings as \p SuffixTree, in a fraction of
+/// its memory: two unsigned integers per element of the string, where the
+/// tree allocates up to two nodes, each with its own map of children. The
+/// internal nodes of the tree are the intervals of the array whose suffixes
+/// share a prefix, which are visited bottom-up with a stack.
+///
+/// As for the tree, a "string" is a vector of unsigned integers, and the last
+/// element of the string should be unique, so that no suffix is a prefix of
+/// another.
+///
+/// The array is sorted by prefix doubling, in O(N log N) time. The common
+/// prefixes are computed in linear time from the array, with the algorithm of
+/// Kasai et al. "Linear-Time Longest-Common-Prefix Computation in Suffix
+/// Arrays and Its Applications".
+class SuffixArray {
+public:
+  using RepeatedSubstring = SuffixTree::RepeatedSubstring;
+
+  /// Construct the suffix array of \p Str, which must outlive it.
+  explicit SuffixArray(ArrayRef<unsigned> Str);
+
+  /// Return the start indices of the suffixes, in lexicographical order.
+  ArrayRef<unsigned> getSuffixes() const { return Suffixes; }
+
+  /// Return the lengths of the common prefixes of the suffixes: element I is
+  /// the common prefix of suffixes I - 1 and I, and element 0 is 0.
+  ArrayRef<unsigned> getCommonPrefixes() const { return CommonPrefixes; }
+
+  /// Call \p Callback on each substring of at least \p MinLength elements
+  /// that \p SuffixTree would find, with the start indices of the leaves of
+  /// its node, in increasing order.
+  void forEachRepeatedSubstring(
+      function_ref<void(const RepeatedSubstring &)> Callback,
+      unsigned MinLength = 2) const;
+
+private:
+  ArrayRef<unsigned> Str;
+  std::vector<unsigned> Suffixes;
+  std::vector<unsigned> CommonPrefixes;
+};
+
+} // namespace llvm
+
+#endif // LLVM_SUPPORT_SUFFIXARRAY_H
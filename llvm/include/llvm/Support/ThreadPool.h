@@ -13,6 +13,8 @@
 #ifndef LLVM_SUPPORT_THREAD_POOL_H
 #define LLVM_SUPPORT_THREAD_POOL_H
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Support/Threading.h"
 #include "llvm/Support/thread.h"
@@ -26,19 +28,62 @@
 #include <mutex>
 #include <queue>
 #include <utility>
+#include <vector>
 
 namespace llvm {
 
+class ThreadPoolTaskGroup;
+
 /// A ThreadPool for asynchronous parallel execution on a defined number of
 /// threads.
 ///
 /// The pool keeps a vector of threads alive, waiting on a condition variable
 /// for some work to become available.
+///
+/// Tasks submitted with schedule() may carry a priority, depend on previously
+/// scheduled tasks and belong to a ThreadPoolTaskGroup. A task is only queued
+/// once all of its dependencies have completed; queued tasks are started in
+/// decreasing priority order, and in submission order for equal priorities.
 class ThreadPool {
+  struct TaskNode;
+
 public:
   using TaskTy = std::function<void()>;
   using PackagedTaskTy = std::packaged_task<void()>;
 
+  /// A reference to a task submitted with schedule(). It can be used as a
+  /// dependency of tasks scheduled later, which makes them continuations of
+  /// this task.
+  class TaskHandle {
+  public:
+    TaskHandle() = default;
+
+    /// Returns a future that becomes ready when the task has completed.
+    std::shared_future<void> getFuture() const { return Future; }
+
+    /// Blocking wait for the task to complete.
+    void wait() const { Future.wait(); }
+
+    explicit operator bool() const { return Node != nullptr; }
+
+  private:
+    friend class ThreadPool;
+    std::shared_ptr<TaskNode> Node;
+    std::shared_future<void> Future;
+  };
+
+  /// Scheduling parameters for schedule().
+  struct TaskOptions {
+    /// Queued tasks with a higher priority are started first.
+    int Priority = 0;
+
+    /// Group the task is accounted to, if any.
+    ThreadPoolTaskGroup *Group = nullptr;
+
+    /// Tasks that must have completed before this task is started.
+    ArrayRef<TaskHandle> Dependencies;
+  };
+
   /// Construct a pool using the hardware strategy \p S for mapping hardware
   /// execution resources (threads, cores, CPUs)
   /// Defaults to using the maximum execution resources in the system, but
@@ -64,24 +109,66 @@ public:
     return asyncImpl(std::forward<Function>(F));
   }
 
+  /// Submission of a task to the pool with the priority, group and
+  /// dependencies given in \p Opts. The returned handle can be used to wait
+  /// for the task or as a dependency of other tasks.
+  TaskHandle schedule(TaskTy F, const TaskOptions &Opts);
+  TaskHandle schedule(TaskTy F) { return schedule(std::move(F), {}); }
+
   /// Blocking wait for all the threads to complete and the queue to be empty.
   /// It is an error to try to add new tasks while blocking on this call.
   void wait();
 
+  /// Blocking wait for all the tasks in \p Group to complete. Tasks outside
+  /// the group may still be running when this returns. When called from one
+  /// of the pool's own threads, queued tasks are run while waiting so that
+  /// waiting on a group from within a task doesn't deadlock.
+  void wait(ThreadPoolTaskGroup &Group);
+
   unsigned getThreadCount() const { return ThreadCount; }
 
 private:
-  bool workCompletedUnlocked() { return !ActiveThreads && Tasks.empty(); }
+  /// Orders the ready queue by priority, then by submission order.
+  struct TaskOrder {
+    bool operator()(const std::shared_ptr<TaskNode> &LHS,
+                    const std::shared_ptr<TaskNode> &RHS) const;
+  };
+
+  bool workCompletedUnlocked() { return !ActiveThreads && !PendingTasks; }
+
+  bool groupCompletedUnlocked(ThreadPoolTaskGroup *Group) {
+    return !GroupTasks.count(Group);
+  }
 
   /// Asynchronous submission of a task to the pool. The returned future can be
   /// used to wait for the task to finish and is *non-blocking* on destruction.
   std::shared_future<void> asyncImpl(TaskTy F);
 
+  /// Pop the next task to run from the ready queue.
+  std::shared_ptr<TaskNode> popTaskUnlocked();
+
+  /// Run \p Node outside of QueueLock and update the bookkeeping once it has
+  /// completed, queueing any task that was only waiting on it.
+  void runTask(std::shared_ptr<TaskNode> Node);
+
   /// Threads in flight
   std::vector<llvm::thread> Threads;
 
-  /// Tasks waiting for execution in the pool.
-  std::queue<PackagedTaskTy> Tasks;
+  /// Tasks whose dependencies have completed, waiting for execution in the
+  /// pool.
+  std::priority_queue<std::shared_ptr<TaskNode>,
+                      std::vector<std::shared_ptr<TaskNode>>, TaskOrder>
+      Tasks;
+
+  /// Number of tasks not started yet, either queued or waiting on
+  /// dependencies.
+  unsigned PendingTasks = 0;
+
+  /// Number of unfinished tasks in each group with unfinished tasks.
+  DenseMap<ThreadPoolTaskGroup *, unsigned> GroupTasks;
+
+  /// Submission counter, used to keep FIFO order among equal priorities.
+  uint64_t NextSequence = 0;
 
   /// Locking and signaling for accessing the Tasks queue.
   std::mutex QueueLock;
@@ -100,6 +187,53 @@ private:
 
   unsigned ThreadCount;
 };
+
+/// A group of tasks submitted to a ThreadPool that can be waited on
+/// independently of the other tasks in the pool.
+class ThreadPoolTaskGroup {
+public:
+  explicit ThreadPoolTaskGroup(ThreadPool &Pool) : Pool(Pool) {}
+
+  /// Blocking destructor: waits for all the tasks in the group to complete.
+  ~ThreadPoolTaskGroup() { wait(); }
+
+  /// Asynchronous submission of a task to the group's pool, see
+  /// ThreadPool::async().
+  template <typename Function, typename... Args>
+  inline std::shared_future<void> async(Function &&F, Args &&... ArgList) {
+    return asyncImpl(
+        std::bind(std::forward<Function>(F), std::forward<Args>(ArgList)...));
+  }
+
+  template <typename Function>
+  inline std::shared_future<void> async(Function &&F) {
+    return asyncImpl(std::forward<Function>(F));
+  }
+
+  /// Submission of a task in this group with priority \p Priority, started
+  /// only once all of \p Dependencies have completed.
+  ThreadPool::TaskHandle
+  schedule(ThreadPool::TaskTy F, int Priority = 0,
+           ArrayRef<ThreadPool::TaskHandle> Dependencies = None) {
+    ThreadPool::TaskOptions Opts;
+    Opts.Priority = Priority;
+    Opts.Group = this;
+    Opts.Dependencies = Dependencies;
+    return Pool.schedule(std::move(F), Opts);
+  }
+
+  /// Blocking wait for all the tasks in this group to complete.
+  void wait() { Pool.wait(*this); }
+
+  ThreadPool &getPool() const { return Pool; }
+
+private:
+  std::shared_future<void> asyncImpl(ThreadPool::TaskTy F) {
+    return schedule(std::move(F)).getFuture();
+  }
+
+  ThreadPool &Pool;
+};
 }
 
 #endif // LLVM_SUPPORT_THREAD_POOL_H
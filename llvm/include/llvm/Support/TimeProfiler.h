@@ -20,8 +20,12 @@ TimeTraceProfiler *getTimeTraceProfilerInstance();
 /// Initialize the time trace profiler.
 /// This sets up the global \p TimeTraceProfilerInstance
 /// variable to be the profiler instance.
+/// If \p RecordMemory is set, each section also records how much the memory
+/// allocated by the process grew while it was open, and the highest level it
+/// reached, as sampled when the nested sections begin and end.
 void timeTraceProfilerInitialize(unsigned TimeTraceGranularity,
-                                 StringRef ProcName);
+                                 StringRef ProcName,
+                                 bool RecordMemory = false);
 
 /// Cleanup the time trace profiler, if it was initialized.
 void timeTraceProfilerCleanup();
@@ -58,6 +62,29 @@ void timeTraceProfilerBegin(StringRef Name,
 /// Manually end the last time section.
 void timeTraceProfilerEnd();
 
+/// Where a task that runs on another thread was created: the time trace
+/// profiler of the creating thread, and the innermost section open there.
+/// ThreadPool and the llvm::parallel executor capture it when a task is queued
+/// and hand it to a TimeTraceTaskScope on the thread that runs the task.
+struct TimeTraceTaskOrigin {
+  TimeTraceProfiler *Profiler = nullptr;
+  std::string Section;
+};
+
+/// Capture the origin of a task created on the current thread. If the profiler
+/// is not initialized, the origin is empty.
+TimeTraceTaskOrigin timeTraceProfilerTaskOrigin();
+
+/// Make the current thread record its sections into the trace of \p Parent,
+/// the profiler of another thread, until timeTraceProfilerDetachThread() is
+/// called. Each thread gets a track of its own in the trace, which it keeps
+/// for all the tasks it runs until the profiler is cleaned up. Returns false,
+/// and does nothing, if the current thread is profiling already.
+bool timeTraceProfilerAttachThread(TimeTraceProfiler *Parent);
+
+/// Stop recording into the trace the current thread was attached to.
+void timeTraceProfilerDetachThread();
+
 /// The TimeTraceScope is a helper class to call the begin and end functions
 /// of the time trace profiler.  When the object is constructed, it begins
 /// the section; and when it is destroyed, it stops it. If the time profiler
@@ -88,6 +115,41 @@ struct TimeTraceScope {
   }
 };
 
+/// The TimeTraceTaskScope records a task run by the current thread into the
+/// trace of the thread that created it, as a section named after the section
+/// the task was created in. Sections begun by the task nest inside it. Worker
+/// threads show up as tracks of their own, which makes idle threads and
+/// straggling tasks visible. If the creating thread was not profiling, the
+/// overhead is a single branch.
+struct TimeTraceTaskScope {
+  TimeTraceTaskScope() = delete;
+  TimeTraceTaskScope(const TimeTraceTaskScope &) = delete;
+  TimeTraceTaskScope &operator=(const TimeTraceTaskScope &) = delete;
+  TimeTraceTaskScope(TimeTraceTaskScope &&) = delete;
+  TimeTraceTaskScope &operator=(TimeTraceTaskScope &&) = delete;
+
+  explicit TimeTraceTaskScope(const TimeTraceTaskOrigin &Origin) {
+    if (Origin.Profiler == nullptr)
+      return;
+    // A thread that is profiling already, e.g. because it runs a task it
+    // created itself, records the task into its own track.
+    Attached = timeTraceProfilerAttachThread(Origin.Profiler);
+    Active = true;
+    timeTraceProfilerBegin(Origin.Section, StringRef(""));
+  }
+  ~TimeTraceTaskScope() {
+    if (!Active)
+      return;
+    timeTraceProfilerEnd();
+    if (Attached)
+      timeTraceProfilerDetachThread();
+  }
+
+private:
+  bool Active = false;
+  bool Attached = false;
+};
+
 } // end namespace llvm
 
 #endif
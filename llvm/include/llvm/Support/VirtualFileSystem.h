@@ -18,6 +18,7 @@
 #include "llvm/ADT/None.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Chrono.h"
 #include "llvm/Support/ErrorOr.h"
@@ -28,6 +29,7 @@
 #include <cstdint>
 #include <ctime>
 #include <memory>
+#include <mutex>
 #include <stack>
 #include <string>
 #include <system_error>
@@ -405,6 +407,65 @@ private:
   virtual void anchor();
 };
 
+/// A file system that remembers the results of \p status() calls on another
+/// file system, including failed lookups, so that each path costs at most one
+/// round trip to the underlying file system. This is meant for tools that
+/// probe the same paths many times, such as header search, on file systems
+/// where each lookup is expensive, such as network file systems.
+///
+/// When \p ListDirectories is set, the first lookup in a directory lists the
+/// whole directory instead, and lookups of names that are not in it fail
+/// without any further round trip. Iterating over a listed directory does not
+/// list it again either.
+///
+/// The underlying file system is assumed not to change while the cache is in
+/// use. Clients that watch for changes, e.g. with a DirectoryWatcher, call
+/// \p invalidate() to forget about the paths that changed.
+///
+/// The cache is thread safe, so long as the underlying file system is.
+class CachingFileSystem : public ProxyFileSystem {
+public:
+  explicit CachingFileSystem(IntrusiveRefCntPtr<FileSystem> FS,
+                             bool ListDirectories = true)
+      : ProxyFileSystem(std::move(FS)), ListDirectories(ListDirectories) {}
+
+  llvm::ErrorOr<Status> status(const Twine &Path) override;
+  llvm::ErrorOr<std::unique_ptr<File>>
+  openFileForRead(const Twine &Path) override;
+  directory_iterator dir_begin(const Twine &Dir, std::error_code &EC) override;
+
+  /// Forget what is known about \p Path, its contents if it is a directory,
+  /// and the listing of its parent directory.
+  void invalidate(const Twine &Path);
+
+  /// Forget everything.
+  void invalidateAll();
+
+  /// The cached entries of a directory.
+  struct DirectoryListing;
+
+private:
+
+  /// Return the key for \p Path in the caches, or an error if it cannot be
+  /// made absolute.
+  std::error_code getKey(const Twine &Path, SmallVectorImpl<char> &Key) const;
+
+  /// Return the listing of the directory \p Dir, listing it if it has not
+  /// been yet, or null if it cannot be listed.
+  std::shared_ptr<const DirectoryListing> getListing(StringRef Dir);
+
+  /// Could the underlying file system have an entry \p Key, given the
+  /// listing of its parent directory?
+  bool mayExist(StringRef Key);
+
+  bool ListDirectories;
+
+  std::mutex Mutex;
+  StringMap<llvm::ErrorOr<Status>> Statuses;
+  /// Null for directories that cannot be listed.
+  StringMap<std::shared_ptr<const DirectoryListing>> Listings;
+};
+
 namespace detail {
 
 class InMemoryDirectory;
@@ -13,6 +13,8 @@
 #ifndef LLVM_TABLEGEN_MAIN_H
 #define LLVM_TABLEGEN_MAIN_H
 
+#include "llvm/ADT/STLExtras.h"
+
 namespace llvm {
 
 class raw_ostream;
@@ -24,6 +26,18 @@ using TableGenMainFn = bool (raw_ostream &OS, RecordKeeper &Records);
 
 int TableGenMain(const char *argv0, TableGenMainFn *MainFn);
 
+/// Perform the action with index Action using Records, and write output to
+/// OS. Returns true on error, false otherwise.
+using TableGenMultiMainFn =
+    function_ref<bool(unsigned Action, raw_ostream &OS, RecordKeeper &Records)>;
+
+/// Parse the input once and perform NumActions actions on the records, each
+/// one writing to the output file given by the matching -o option. On Unix,
+/// the actions run at the same time in processes that share the records
+/// (see -backend-jobs).
+int TableGenMain(const char *argv0, unsigned NumActions,
+                 TableGenMultiMainFn MainFn);
+
 } // end namespace llvm
 
 #endif // LLVM_TABLEGEN_MAIN_H
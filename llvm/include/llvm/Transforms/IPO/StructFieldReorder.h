@@ -0,0 +1,34 @@
+//===- StructFieldReorder.h - Profile-guided struct field reordering ------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass uses profile data to reorder the fields of struct types whose
+// layout is not visible outside of the module, so that the fields accessed
+// most often are packed together at the start of the struct. It is meant to
+// run on the whole program, in the LTO pipeline, once the symbols that are
+// not exported have been internalized.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TRANSFORMS_IPO_STRUCTFIELDREORDER_H
+#define LLVM_TRANSFORMS_IPO_STRUCTFIELDREORDER_H
+
+#include "llvm/IR/PassManager.h"
+
+namespace llvm {
+
+class Module;
+
+/// Pass to reorder the fields of struct types by their access counts.
+class StructFieldReorderPass : public PassInfoMixin<StructFieldReorderPass> {
+public:
+  PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM);
+};
+
+} // end namespace llvm
+
+#endif // LLVM_TRANSFORMS_IPO_STRUCTFIELDREORDER_H
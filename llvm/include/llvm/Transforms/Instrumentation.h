@@ -170,6 +170,9 @@ struct SanitizerCoverageOptions {
   bool PCTable = false;
   bool NoPrune = false;
   bool StackDepth = false;
+  // If greater than 1, a thread only records the edge coverage of one in this
+  // many of its function entries.
+  unsigned SamplePeriod = 0;
 
   SanitizerCoverageOptions() = default;
 };
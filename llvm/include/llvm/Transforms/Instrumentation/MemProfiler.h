@@ -16,6 +16,7 @@
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/PassManager.h"
+#include <string>
 
 namespace llvm {
 
@@ -42,6 +43,20 @@ public:
   static bool isRequired() { return true; }
 };
 
+/// Uses a memory profile to annotate allocation calls with the behavior of
+/// their allocations, as a "memprof" attribute of "cold", "hot" or
+/// "short-lived". Calls are matched to the profiled allocation call stacks by
+/// their inlined debug locations. Cold and hot calls to operator new can also
+/// be redirected to the variants taking a __hot_cold_t hint.
+class MemProfUsePass : public PassInfoMixin<MemProfUsePass> {
+public:
+  explicit MemProfUsePass(std::string MemoryProfileFile = "");
+  PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM);
+
+private:
+  std::string MemoryProfileFile;
+};
+
 // Insert MemProfiler instrumentation
 FunctionPass *createMemProfilerFunctionPass();
 ModulePass *createModuleMemProfilerLegacyPassPass();
@@ -219,7 +219,7 @@ public:
       LoopInfo *LI, OptimizationRemarkEmitter *ORE,
       LoopVectorizationRequirements *R, LoopVectorizeHints *H, DemandedBits *DB,
       AssumptionCache *AC, BlockFrequencyInfo *BFI, ProfileSummaryInfo *PSI)
-      : TheLoop(L), LI(LI), PSE(PSE), TTI(TTI), TLI(TLI), DT(DT),
+      : TheLoop(L), LI(LI), PSE(PSE), TTI(TTI), TLI(TLI), DT(DT), AA(AA),
         GetLAA(GetLAA), ORE(ORE), Requirements(R), Hints(H), DB(DB), AC(AC),
         BFI(BFI), PSI(PSI) {}
 
@@ -298,6 +298,9 @@ public:
   /// 0 - Stride is unknown or non-consecutive.
   /// 1 - Address is consecutive.
   /// -1 - Address is consecutive, and decreasing.
+  /// For an outer loop, the address must advance by one element per iteration
+  /// of the outer loop, by the same amount at every iteration of its inner
+  /// loops.
   /// NOTE: This method must only be used before modifying the original scalar
   /// loop. Do not use after invoking 'createVectorizedLoopSkeleton' (PR34965).
   int isConsecutivePtr(Value *Ptr);
@@ -391,6 +394,14 @@ private:
   /// specific checks for outer loop vectorization.
   bool canVectorizeOuterLoop();
 
+  /// Return true if the iterations of this outer loop access memory
+  /// independently of each other, so that running several of them in lockstep
+  /// through the inner loops keeps the semantics. Only simple cases are
+  /// recognized: each store writes to an address which does not change in the
+  /// inner loops and advances by at least its size with the outer loop, and
+  /// the other accesses which may alias it use the same address.
+  bool canVectorizeOuterLoopMemory() const;
+
   /// Return true if all of the instructions in the block can be speculatively
   /// executed, and record the loads/stores that require masking. If's that
   /// guard loads can be ignored under "assume safety" unless \p PreserveGuards
@@ -447,6 +458,9 @@ private:
   /// Dominator Tree.
   DominatorTree *DT;
 
+  /// Alias Analysis.
+  AAResults *AA;
+
   // LoopAccess analysis.
   std::function<const LoopAccessInfo &(Loop &)> *GetLAA;
 
@@ -145,6 +145,18 @@ private:
 
   bool vectorizeStores(ArrayRef<StoreInst *> Stores, slpvectorizer::BoUpSLP &R);
 
+  /// Vectorize the prefix scans stored by the store instructions collected in
+  /// Stores: runs of stores to consecutive locations where each stored value
+  /// is the one stored before it combined with a new operand,
+  /// s[i] = s[i - 1] op x[i]. The vectorized stores are removed from Stores.
+  bool vectorizeScans(slpvectorizer::BoUpSLP &R);
+
+  /// Vectorize the scan stored by \p Chain, which stores VF consecutive
+  /// elements. \p Carry is the element of the scan stored before the chain, or
+  /// null if the chain starts the scan.
+  bool vectorizeScanChain(ArrayRef<StoreInst *> Chain, unsigned Opcode,
+                          Value *Carry, slpvectorizer::BoUpSLP &R);
+
   /// The store instructions in a basic block organized by base pointer.
   StoreListMap Stores;
 
@@ -24,6 +24,9 @@ FunctionPropertiesInfo::getFunctionPropertiesInfo(const Function &F,
 
   FPI.Uses = ((!F.hasLocalLinkage()) ? 1 : 0) + F.getNumUses();
 
+  if (auto EntryCount = F.getEntryCount())
+    FPI.EntryCount = EntryCount.getCount();
+
   for (const auto &BB : F) {
     ++FPI.BasicBlockCount;
 
@@ -67,7 +70,8 @@ void FunctionPropertiesInfo::print(raw_ostream &OS) const {
      << "LoadInstCount: " << LoadInstCount << "\n"
      << "StoreInstCount: " << StoreInstCount << "\n"
      << "MaxLoopDepth: " << MaxLoopDepth << "\n"
-     << "TopLevelLoopCount: " << TopLevelLoopCount << "\n\n";
+     << "TopLevelLoopCount: " << TopLevelLoopCount << "\n"
+     << "EntryCount: " << EntryCount << "\n\n";
 }
 
 AnalysisKey FunctionPropertiesAnalysis::Key;
@@ -19,6 +19,7 @@
 #include <unordered_set>
 
 #include "llvm/ADT/SCCIterator.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
 #include "llvm/Analysis/CallGraph.h"
 #include "llvm/Analysis/FunctionPropertiesAnalysis.h"
 #include "llvm/Analysis/InlineCost.h"
@@ -224,6 +225,14 @@ std::unique_ptr<InlineAdvice> MLInlineAdvisor::getAdvice(CallBase &CB) {
   auto &CallerBefore = FAM.getResult<FunctionPropertiesAnalysis>(Caller);
   auto &CalleeBefore = FAM.getResult<FunctionPropertiesAnalysis>(Callee);
 
+  // The count of the call site needs the block frequencies of the caller,
+  // which are only worth computing if the caller has a profile.
+  int64_t CallSiteCount = 0;
+  if (CallerBefore.EntryCount)
+    if (auto Count = FAM.getResult<BlockFrequencyAnalysis>(Caller)
+                         .getBlockProfileCount(CB.getParent()))
+      CallSiteCount = *Count;
+
   ModelRunner->setFeature(FeatureIndex::CalleeBasicBlockCount,
                           CalleeBefore.BasicBlockCount);
   ModelRunner->setFeature(FeatureIndex::CallSiteHeight,
@@ -240,6 +249,9 @@ std::unique_ptr<InlineAdvice> MLInlineAdvisor::getAdvice(CallBase &CB) {
   ModelRunner->setFeature(FeatureIndex::CalleeConditionallyExecutedBlocks,
                           CalleeBefore.BlocksReachedFromConditionalInstruction);
   ModelRunner->setFeature(FeatureIndex::CalleeUsers, CalleeBefore.Uses);
+  ModelRunner->setFeature(FeatureIndex::CalleeEntryCount,
+                          CalleeBefore.EntryCount);
+  ModelRunner->setFeature(FeatureIndex::CallSiteCount, CallSiteCount);
   return getAdviceFromModel(CB, ORE);
 }
 
@@ -52,14 +52,12 @@ ReleaseModeModelRunner::ReleaseModeModelRunner(LLVMContext &Ctx)
       CompiledModel(std::make_unique<llvm::InlinerSizeModel>()) {
   assert(CompiledModel && "The CompiledModel should be valid");
 
-  FeatureIndices.reserve(NumberOfFeatures);
-
-  for (size_t I = 0; I < NumberOfFeatures; ++I) {
-    const int Index =
+  // A model may not use every feature, e.g. because it was trained before the
+  // feature was added. Such features are not fed to it.
+  FeatureIndices.resize(NumberOfFeatures);
+  for (size_t I = 0; I < NumberOfFeatures; ++I)
+    FeatureIndices[I] =
         CompiledModel->LookupArgIndex(FeedPrefix + FeatureNameMap[I]);
-    assert(Index >= 0 && "Cannot find Feature in inlining model");
-    FeatureIndices[I] = Index;
-  }
 
   ResultIndex =
       CompiledModel->LookupResultIndex(std::string(FetchPrefix) + DecisionName);
@@ -67,13 +65,17 @@ ReleaseModeModelRunner::ReleaseModeModelRunner(LLVMContext &Ctx)
 }
 
 int64_t ReleaseModeModelRunner::getFeature(int Index) const {
+  if (FeatureIndices[Index] < 0)
+    return 0;
   return *static_cast<int64_t *>(
       CompiledModel->arg_data(FeatureIndices[Index]));
 }
 
 void ReleaseModeModelRunner::setFeature(FeatureIndex Index, int64_t Value) {
-  *static_cast<int64_t *>(CompiledModel->arg_data(
-      FeatureIndices[static_cast<size_t>(Index)])) = Value;
+  int32_t ArgIndex = FeatureIndices[static_cast<size_t>(Index)];
+  if (ArgIndex < 0)
+    return;
+  *static_cast<int64_t *>(CompiledModel->arg_data(ArgIndex)) = Value;
 }
 
 bool ReleaseModeModelRunner::run() {
@@ -146,6 +146,12 @@ STATISTIC(NumTripCountsNotComputed,
           "Number of loops without predictable loop counts");
 STATISTIC(NumBruteForceTripCountsComputed,
           "Number of loops with trip counts computed by force");
+STATISTIC(NumSCEVsCreated, "Number of values analyzed by SCEV");
+STATISTIC(NumSCEVNodeBudgetExceeded,
+          "Number of values left unknown because the SCEV node budget was "
+          "exceeded");
+STATISTIC(NumLoopDispositionsForgotten,
+          "Number of cached loop dispositions forgotten");
 
 static cl::opt<unsigned>
 MaxBruteForceIterations("scalar-evolution-max-iterations", cl::ReallyHidden,
@@ -221,6 +227,13 @@ static cl::opt<unsigned>
                   cl::desc("Size of the expression which is considered huge"),
                   cl::init(4096));
 
+static cl::opt<unsigned> MaxSCEVNodes(
+    "scalar-evolution-max-scev-nodes", cl::Hidden,
+    cl::desc("Maximum number of SCEV expressions created for a function "
+             "before further instructions are treated as unknown values "
+             "(0 = unlimited)"),
+    cl::init(1000000));
+
 static cl::opt<bool>
 ClassifyExpressions("scalar-evolution-classify-expressions",
     cl::Hidden, cl::init(true),
@@ -6352,6 +6365,13 @@ const SCEV *ScalarEvolution::createSCEV(Value *V) {
     // analysis depends on.
     if (!DT.isReachableFromEntry(I->getParent()))
       return getUnknown(UndefValue::get(V->getType()));
+    // Once the function has used up its budget of expressions, stop modeling
+    // instructions. An unknown value is always a correct description.
+    if (MaxSCEVNodes && UniqueSCEVs.size() >= MaxSCEVNodes) {
+      ++NumSCEVNodeBudgetExceeded;
+      return getUnknown(V);
+    }
+    ++NumSCEVsCreated;
   } else if (ConstantInt *CI = dyn_cast<ConstantInt>(V))
     return getConstant(CI);
   else if (isa<ConstantPointerNull>(V))
@@ -7175,7 +7195,19 @@ void ScalarEvolution::forgetValue(Value *V) {
 }
 
 void ScalarEvolution::forgetLoopDispositions(const Loop *L) {
-  LoopDispositions.clear();
+  // Values moved into or out of L only change their disposition with respect
+  // to L and the loops nested in it.
+  SmallPtrSet<const Loop *, 8> Loops;
+  for (const Loop *Nested : L->getLoopsInPreorder())
+    Loops.insert(Nested);
+  for (auto &Entry : LoopDispositions) {
+    auto &Values = Entry.second;
+    unsigned NumValues = Values.size();
+    erase_if(Values, [&](PointerIntPair<const Loop *, 2, LoopDisposition> V) {
+      return Loops.count(V.getPointer());
+    });
+    NumLoopDispositionsForgotten += NumValues - Values.size();
+  }
 }
 
 /// Get the exact loop backedge taken count considering all loop exits. A
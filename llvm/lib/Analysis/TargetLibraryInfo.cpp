@@ -26,6 +26,11 @@ static cl::opt<TargetLibraryInfoImpl::VectorLibrary> ClVectorLibrary(
                           "Accelerate framework"),
                clEnumValN(TargetLibraryInfoImpl::LIBMVEC_X86, "LIBMVEC-X86",
                           "GLIBC Vector Math library"),
+               clEnumValN(TargetLibraryInfoImpl::LLVMLIBC_X86, "LLVMLIBC-X86",
+                          "LLVM libc vector math functions for x86-64"),
+               clEnumValN(TargetLibraryInfoImpl::LLVMLIBC_AARCH64,
+                          "LLVMLIBC-AARCH64",
+                          "LLVM libc vector math functions for AArch64"),
                clEnumValN(TargetLibraryInfoImpl::MASSV, "MASSV",
                           "IBM MASS vector library"),
                clEnumValN(TargetLibraryInfoImpl::SVML, "SVML",
@@ -1569,6 +1574,22 @@ void TargetLibraryInfoImpl::addVectorizableFunctionsFromVecLib(
     addVectorizableFunctions(VecFuncs);
     break;
   }
+  case LLVMLIBC_X86: {
+    const VecDesc VecFuncs[] = {
+    #define TLI_DEFINE_LLVMLIBC_X86_VECFUNCS
+    #include "llvm/Analysis/VecFuncs.def"
+    };
+    addVectorizableFunctions(VecFuncs);
+    break;
+  }
+  case LLVMLIBC_AARCH64: {
+    const VecDesc VecFuncs[] = {
+    #define TLI_DEFINE_LLVMLIBC_AARCH64_VECFUNCS
+    #include "llvm/Analysis/VecFuncs.def"
+    };
+    addVectorizableFunctions(VecFuncs);
+    break;
+  }
   case MASSV: {
     const VecDesc VecFuncs[] = {
     #define TLI_DEFINE_MASSV_VECFUNCS
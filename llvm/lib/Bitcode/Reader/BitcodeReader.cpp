@@ -70,6 +70,8 @@
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
@@ -92,6 +94,11 @@ static cl::opt<bool> PrintSummaryGUIDs(
     cl::desc(
         "Print the global id for each value when reading the module summary"));
 
+static cl::opt<bool> PrefetchFunctionBodies(
+    "bitcode-prefetch-function-bodies", cl::init(false), cl::Hidden,
+    cl::desc("Decode the records of the next function body on another thread "
+             "while materializing the current one"));
+
 namespace {
 
 enum {
@@ -479,6 +486,22 @@ BitcodeReaderBase::readNameFromStrtab(ArrayRef<uint64_t> Record) {
 
 namespace {
 
+/// The top-level records of a function block, decoded ahead of parsing.
+/// Sub-blocks are not decoded: they are parsed from the reader's own stream.
+struct PrefetchedFunctionBody {
+  struct Item {
+    /// The ID of records is their code rather than their abbreviation.
+    BitstreamEntry Entry;
+    /// The bit to resume parsing at for sub-blocks and the end of the block.
+    uint64_t BitNo;
+    /// The operands of records, in Ops.
+    size_t OpsBegin;
+    size_t NumOps;
+  };
+  std::vector<Item> Items;
+  std::vector<uint64_t> Ops;
+};
+
 class BitcodeReader : public BitcodeReaderBase, public GVMaterializer {
   LLVMContext &Context;
   Module *TheModule = nullptr;
@@ -565,6 +588,18 @@ class BitcodeReader : public BitcodeReaderBase, public GVMaterializer {
   std::vector<std::string> BundleTags;
   SmallVector<SyncScope::ID, 8> SSIDs;
 
+  /// With -bitcode-prefetch-function-bodies, the function whose body is being
+  /// decoded into Prefetched by PrefetchThread, if any. The buffers are swapped
+  /// with CurrentBody when that function is materialized, so that the next one
+  /// can be decoded while it is parsed.
+  Function *PrefetchedFunction = nullptr;
+  PrefetchedFunctionBody Prefetched;
+  bool PrefetchSucceeded = false;
+  std::shared_future<void> PrefetchDone;
+  PrefetchedFunctionBody CurrentBody;
+  /// Declared last so that it waits for the decoding before the buffers go.
+  std::unique_ptr<ThreadPool> PrefetchThread;
+
 public:
   BitcodeReader(BitstreamCursor Stream, StringRef Strtab,
                 StringRef ProducerIdentification, LLVMContext &Context);
@@ -753,7 +788,10 @@ private:
   /// Save the positions of the Metadata blocks and skip parsing the blocks.
   Error rememberAndSkipMetadata();
   Error typeCheckLoadStoreInst(Type *ValType, Type *PtrType);
-  Error parseFunctionBody(Function *F);
+  Error parseFunctionBody(Function *F,
+                          const PrefetchedFunctionBody *Body = nullptr);
+  void prefetchFunctionBodyAfter(Function *F);
+  bool takePrefetchedFunctionBody(Function *F);
   Error globalCleanup();
   Error resolveGlobalAndIndirectSymbolInits();
   Error parseUseLists();
@@ -3794,8 +3832,97 @@ void BitcodeReader::propagateByValSRetTypes(CallBase *CB,
   }
 }
 
-/// Lazily parse the specified function body block.
-Error BitcodeReader::parseFunctionBody(Function *F) {
+/// Decodes the top-level records of the function block at \p BitNo into
+/// \p Body. \p Cursor is a copy of the reader's stream, so that this can run
+/// on another thread. Returns false if the block is malformed, leaving the
+/// error to be reported when the body is parsed from the stream.
+static bool decodeFunctionBlock(BitstreamCursor Cursor, uint64_t BitNo,
+                                PrefetchedFunctionBody &Body) {
+  Body.Items.clear();
+  Body.Ops.clear();
+  if (errorToBool(Cursor.JumpToBit(BitNo)) ||
+      errorToBool(Cursor.EnterSubBlock(bitc::FUNCTION_BLOCK_ID)))
+    return false;
+
+  SmallVector<uint64_t, 64> Record;
+  while (true) {
+    uint64_t EntryBitNo = Cursor.GetCurrentBitNo();
+    Expected<BitstreamEntry> MaybeEntry = Cursor.advance();
+    if (!MaybeEntry) {
+      consumeError(MaybeEntry.takeError());
+      return false;
+    }
+    BitstreamEntry Entry = MaybeEntry.get();
+
+    switch (Entry.Kind) {
+    case BitstreamEntry::Error:
+      return false;
+    case BitstreamEntry::EndBlock:
+      Body.Items.push_back({Entry, EntryBitNo, 0, 0});
+      return true;
+    case BitstreamEntry::SubBlock:
+      Body.Items.push_back({Entry, Cursor.GetCurrentBitNo(), 0, 0});
+      if (errorToBool(Cursor.SkipBlock()))
+        return false;
+      break;
+    case BitstreamEntry::Record: {
+      Record.clear();
+      Expected<unsigned> MaybeBitCode = Cursor.readRecord(Entry.ID, Record);
+      if (!MaybeBitCode) {
+        consumeError(MaybeBitCode.takeError());
+        return false;
+      }
+      Body.Items.push_back({BitstreamEntry::getRecord(MaybeBitCode.get()), 0,
+                            Body.Ops.size(), Record.size()});
+      Body.Ops.insert(Body.Ops.end(), Record.begin(), Record.end());
+      break;
+    }
+    }
+  }
+}
+
+/// Starts decoding the body of the function expected to be materialized after
+/// \p F on PrefetchThread.
+void BitcodeReader::prefetchFunctionBodyAfter(Function *F) {
+  if (!PrefetchFunctionBodies || !llvm_is_multithreaded())
+    return;
+  // Functions are usually materialized in module order. Skip declarations.
+  Module::iterator Next = std::next(F->getIterator());
+  Module::iterator End = F->getParent()->end();
+  while (Next != End && !DeferredFunctionInfo.count(&*Next))
+    ++Next;
+  if (Next == End || !Next->isMaterializable())
+    return;
+  uint64_t BitNo = DeferredFunctionInfo.lookup(&*Next);
+  if (BitNo == 0)
+    return;
+
+  if (!PrefetchThread)
+    PrefetchThread = std::make_unique<ThreadPool>(hardware_concurrency(1));
+  PrefetchedFunction = &*Next;
+  PrefetchDone = PrefetchThread->async([this, Cursor = Stream, BitNo] {
+    PrefetchSucceeded = decodeFunctionBlock(Cursor, BitNo, Prefetched);
+  });
+}
+
+/// Waits for the decoding started by prefetchFunctionBodyAfter, if any, and
+/// returns true if it was for \p F and succeeded. CurrentBody then holds the
+/// records.
+bool BitcodeReader::takePrefetchedFunctionBody(Function *F) {
+  if (!PrefetchedFunction)
+    return false;
+  PrefetchDone.wait();
+  bool Taken = PrefetchedFunction == F && PrefetchSucceeded;
+  PrefetchedFunction = nullptr;
+  if (Taken)
+    std::swap(Prefetched, CurrentBody);
+  return Taken;
+}
+
+/// Lazily parse the specified function body block. If \p Body is set, it holds
+/// the records of the block, and the stream is only used for sub-blocks.
+Error BitcodeReader::parseFunctionBody(Function *F,
+                                       const PrefetchedFunctionBody *Body) {
   if (Error Err = Stream.EnterSubBlock(bitc::FUNCTION_BLOCK_ID))
     return Err;
 
@@ -3831,11 +3958,34 @@ Error BitcodeReader::parseFunctionBody(Function *F) {
 
   std::vector<OperandBundleDef> OperandBundles;
 
-  // Read all the records.
+  // Read all the records, from Body if it was decoded ahead of time.
   SmallVector<uint64_t, 64> Record;
+  const PrefetchedFunctionBody::Item *NextItem =
+      Body ? Body->Items.data() : nullptr;
+  auto advance = [&]() -> Expected<BitstreamEntry> {
+    if (!Body)
+      return Stream.advance();
+    const PrefetchedFunctionBody::Item &I = *NextItem++;
+    if (I.Entry.Kind == BitstreamEntry::Record)
+      return I.Entry;
+    if (Error Err = Stream.JumpToBit(I.BitNo))
+      return std::move(Err);
+    if (I.Entry.Kind == BitstreamEntry::SubBlock)
+      return I.Entry;
+    // Let the stream read the end of the block to leave it.
+    return Stream.advance();
+  };
+  auto readRecord = [&](unsigned AbbrevID) -> Expected<unsigned> {
+    if (!Body)
+      return Stream.readRecord(AbbrevID, Record);
+    const PrefetchedFunctionBody::Item &I = NextItem[-1];
+    Record.append(Body->Ops.begin() + I.OpsBegin,
+                  Body->Ops.begin() + I.OpsBegin + I.NumOps);
+    return I.Entry.ID;
+  };
 
   while (true) {
-    Expected<llvm::BitstreamEntry> MaybeEntry = Stream.advance();
+    Expected<llvm::BitstreamEntry> MaybeEntry = advance();
     if (!MaybeEntry)
       return MaybeEntry.takeError();
     llvm::BitstreamEntry Entry = MaybeEntry.get();
@@ -3887,7 +4037,7 @@ Error BitcodeReader::parseFunctionBody(Function *F) {
     Record.clear();
     Instruction *I = nullptr;
     Type *FullTy = nullptr;
-    Expected<unsigned> MaybeBitCode = Stream.readRecord(Entry.ID, Record);
+    Expected<unsigned> MaybeBitCode = readRecord(Entry.ID);
     if (!MaybeBitCode)
       return MaybeBitCode.takeError();
     switch (unsigned BitCode = MaybeBitCode.get()) {
@@ -5415,6 +5565,8 @@ Error BitcodeReader::materialize(GlobalValue *GV) {
 
   DenseMap<Function*, uint64_t>::iterator DFII = DeferredFunctionInfo.find(F);
   assert(DFII != DeferredFunctionInfo.end() && "Deferred function not found!");
+  // Wait for any prefetching before the stream is read further.
+  bool Prefetched = takePrefetchedFunctionBody(F);
   // If its position is recorded as 0, its body is somewhere in the stream
   // but we haven't seen it yet.
   if (DFII->second == 0)
@@ -5428,7 +5580,8 @@ Error BitcodeReader::materialize(GlobalValue *GV) {
   // Move the bit stream to the saved position of the deferred function body.
   if (Error JumpFailed = Stream.JumpToBit(DFII->second))
     return JumpFailed;
-  if (Error Err = parseFunctionBody(F))
+  prefetchFunctionBodyAfter(F);
+  if (Error Err = parseFunctionBody(F, Prefetched ? &CurrentBody : nullptr))
     return Err;
   F->setIsMaterializable(false);
 
@@ -5860,8 +6013,17 @@ std::vector<FunctionSummary::EdgeTy>
 ModuleSummaryIndexBitcodeReader::makeCallList(ArrayRef<uint64_t> Record,
                                               bool IsOldProfileFormat,
                                               bool HasProfile, bool HasRelBF) {
+  // Each edge is the callee value id, followed by either the hotness or the
+  // relative block frequency if present, or by the callsite count and the
+  // optional profile count in the old profile format. Reserve exactly the
+  // number of edges: these lists make up a large part of the combined index.
+  unsigned EdgeSize = 1;
+  if (IsOldProfileFormat)
+    EdgeSize += HasProfile ? 2 : 1;
+  else if (HasProfile || HasRelBF)
+    EdgeSize += 1;
   std::vector<FunctionSummary::EdgeTy> Ret;
-  Ret.reserve(Record.size());
+  Ret.reserve(Record.size() / EdgeSize);
   for (unsigned I = 0, E = Record.size(); I != E; ++I) {
     CalleeInfo::HotnessType Hotness = CalleeInfo::HotnessType::Unknown;
     uint64_t RelBF = 0;
@@ -86,6 +86,8 @@ using namespace llvm;
 STATISTIC(NumMDStringLoaded, "Number of MDStrings loaded");
 STATISTIC(NumMDNodeTemporary, "Number of MDNode::Temporary created");
 STATISTIC(NumMDRecordLoaded, "Number of Metadata records loaded");
+STATISTIC(NumTypeDeclarationsImported,
+          "Number of composite types imported as declarations");
 
 /// Flag whether we need to import full type definitions for ThinLTO.
 /// Currently needed for Darwin and LLDB.
@@ -93,6 +95,14 @@ static cl::opt<bool> ImportFullTypeDefinitions(
     "import-full-type-definitions", cl::init(false), cl::Hidden,
     cl::desc("Import full type definitions for ThinLTO."));
 
+/// Flag whether named composite types without an ODR identifier (C types, and
+/// C++ types with internal linkage) are also imported as declarations. The
+/// debugger then finds their definition by name in the exporting module.
+static cl::opt<bool> ImportLocalTypeDeclarations(
+    "import-local-type-declarations", cl::init(false), cl::Hidden,
+    cl::desc("Import named composite types without an ODR identifier as "
+             "declarations for ThinLTO."));
+
 static cl::opt<bool> DisableLazyLoading(
     "disable-ondemand-mds-loading", cl::init(false), cl::Hidden,
     cl::desc("Force disable the lazy-loading on-demand of metadata when "
@@ -1498,11 +1508,16 @@ Error MetadataLoader::MetadataLoaderImpl::parseOneMetadata(
     // handles the case where this is type ODRed with a definition needed
     // by the importing module, in which case the existing definition is
     // used.
-    if (IsImporting && !ImportFullTypeDefinitions && Identifier &&
+    // Optionally do the same for named types without identifier: they cannot
+    // be ODRed, but this avoids loading the graph of their members.
+    if (IsImporting && !ImportFullTypeDefinitions &&
+        (Identifier || (ImportLocalTypeDeclarations && Name)) &&
         (Tag == dwarf::DW_TAG_enumeration_type ||
          Tag == dwarf::DW_TAG_class_type ||
          Tag == dwarf::DW_TAG_structure_type ||
          Tag == dwarf::DW_TAG_union_type)) {
+      if (!(Flags & DINode::FlagFwdDecl))
+        ++NumTypeDeclarationsImported;
       Flags = Flags | DINode::FlagFwdDecl;
     } else {
       BaseType = getDITypeRefOrNull(Record[6]);
@@ -62,6 +62,7 @@
 #include "llvm/Support/AtomicOrdering.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorHandling.h"
@@ -90,6 +91,11 @@ static cl::opt<uint32_t> FlushThreshold(
     "bitcode-flush-threshold", cl::Hidden, cl::init(512),
     cl::desc("The threshold (unit M) for flushing LLVM bitcode."));
 
+static cl::opt<bool> CompressFunctionBlocks(
+    "bitcode-compress-function-blocks", cl::Hidden, cl::init(false),
+    cl::desc("Compress function blocks, with zstd if available and zlib "
+             "otherwise. Readers decompress them when they are materialized."));
+
 static cl::opt<bool> WriteRelBFToSummary(
     "write-relbf-to-summary", cl::Hidden, cl::init(false),
     cl::desc("Write relative block frequency to function summary "));
@@ -3256,7 +3262,14 @@ void ModuleBitcodeWriter::writeFunction(
   // in the VST.
   FunctionToBitcodeIndex[&F] = Stream.GetCurrentBitNo();
 
-  Stream.EnterSubblock(bitc::FUNCTION_BLOCK_ID, 4);
+  Optional<compression::Format> Compression;
+  if (CompressFunctionBlocks) {
+    if (compression::isAvailable(compression::Format::Zstd))
+      Compression = compression::Format::Zstd;
+    else if (compression::isAvailable(compression::Format::Zlib))
+      Compression = compression::Format::Zlib;
+  }
+  Stream.EnterSubblock(bitc::FUNCTION_BLOCK_ID, 4, Compression);
   VE.incorporateFunction(F);
 
   SmallVector<unsigned, 64> Vals;
@@ -8,6 +8,7 @@
 
 #include "llvm/Bitstream/BitstreamReader.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Compression.h"
 #include <cassert>
 #include <string>
 
@@ -52,10 +53,9 @@ Error BitstreamCursor::EnterSubBlock(unsigned BlockID, unsigned *NumWordsP) {
   if (NumWordsP)
     *NumWordsP = NumWords;
 
+  // A code size of 0 marks the blocks compressed by BitstreamWriter.
   if (CurCodeSize == 0)
-    return llvm::createStringError(
-        std::errc::illegal_byte_sequence,
-        "can't enter sub-block: current code size is 0");
+    return enterCompressedBlock(NumWords);
   if (AtEndOfStream())
     return llvm::createStringError(
         std::errc::illegal_byte_sequence,
@@ -64,6 +64,68 @@ Error BitstreamCursor::EnterSubBlock(unsigned BlockID, unsigned *NumWordsP) {
   return Error::success();
 }
 
+Error BitstreamCursor::enterCompressedBlock(word_t NumWords) {
+  // Compressed block body:
+  //    [codelen, format, uncompressedsize, compressedsize, compressed data,
+  //     <align4bytes>]
+  uint64_t EndBitNo = GetCurrentBitNo() + uint64_t(NumWords) * 32;
+  if (NumWords < 4 || !canSkipToPos(EndBitNo / 8))
+    return llvm::createStringError(
+        std::errc::illegal_byte_sequence,
+        "can't enter compressed sub-block: invalid size");
+
+  uint32_t Header[4];
+  for (uint32_t &Word : Header) {
+    Expected<word_t> MaybeWord = Read(32);
+    if (!MaybeWord)
+      return MaybeWord.takeError();
+    Word = MaybeWord.get();
+  }
+  CurCodeSize = Header[0];
+  uint32_t UncompressedSize = Header[2];
+  uint32_t CompressedSize = Header[3];
+  if (CurCodeSize == 0 || CurCodeSize > MaxChunkSize)
+    return llvm::createStringError(
+        std::errc::illegal_byte_sequence,
+        "can't enter compressed sub-block: invalid code size %u", CurCodeSize);
+  if (Header[1] > static_cast<uint32_t>(compression::Format::Zstd))
+    return llvm::createStringError(
+        std::errc::illegal_byte_sequence,
+        "can't enter compressed sub-block: unknown format %u", Header[1]);
+  auto Format = static_cast<compression::Format>(Header[1]);
+  if (!compression::isAvailable(Format))
+    return llvm::createStringError(
+        std::errc::not_supported,
+        "can't enter compressed sub-block: LLVM was built without %s",
+        compression::getName(Format));
+  if (UncompressedSize == 0 || UncompressedSize % 4 != 0 ||
+      CompressedSize > (NumWords - 4) * 4)
+    return llvm::createStringError(
+        std::errc::illegal_byte_sequence,
+        "can't enter compressed sub-block: invalid size");
+
+  StringRef Compressed(
+      reinterpret_cast<const char *>(
+          getPointerToBit(GetCurrentBitNo(), CompressedSize)),
+      CompressedSize);
+  auto Contents = std::make_shared<std::vector<uint8_t>>(UncompressedSize);
+  size_t Size = UncompressedSize;
+  if (Error Err = compression::uncompress(
+          Format, Compressed, reinterpret_cast<char *>(Contents->data()), Size))
+    return Err;
+  if (Size != UncompressedSize)
+    return llvm::createStringError(
+        std::errc::illegal_byte_sequence,
+        "can't enter compressed sub-block: size mismatch");
+
+  Block &B = BlockScope.back();
+  B.PrevBytes = getBitcodeBytes();
+  B.PrevEndBitNo = EndBitNo;
+  B.Contents = std::move(Contents);
+  resetBitcodeBytes(*B.Contents);
+  return Error::success();
+}
+
 static Expected<uint64_t> readAbbreviatedField(BitstreamCursor &Cursor,
                                                const BitCodeAbbrevOp &Op) {
   assert(!Op.isLiteral() && "Not to be used with literals!");
@@ -19,6 +19,12 @@
 // the overall changes to the binary size are negligible; only a small number of
 // additional jump instructions may be introduced.
 //
+// With -mfs-cluster-file, the clusters of the split functions are also written
+// out in the format of -basic-block-sections=<file>, so that builds without
+// the profile can reproduce the same split. Either way, the hot part keeps the
+// function symbol, which the linker orders with the call graph profile, and
+// the cold parts are grouped by their section prefix.
+//
 // For the original RFC of this pass please see
 // https://groups.google.com/d/msg/llvm-dev/RUegaMg-iqc/wFAVxa6fCgAJ
 //===----------------------------------------------------------------------===//
@@ -36,9 +42,18 @@
 #include "llvm/IR/Module.h"
 #include "llvm/InitializePasses.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include <mutex>
 
 using namespace llvm;
 
+#define DEBUG_TYPE "mfs"
+
+STATISTIC(NumFunctionsSplit, "Number of functions split");
+STATISTIC(NumColdBlocks, "Number of blocks moved to the cold section");
+
 // FIXME: This cutoff value is CPU dependent and should be moved to
 // TargetTransformInfo once we consider enabling this on other platforms.
 // The value is expressed as a ProfileSummaryInfo integer percentile cutoff.
@@ -58,6 +73,12 @@ static cl::opt<unsigned> ColdCountThreshold(
         "Minimum number of times a block must be executed to be retained."),
     cl::init(1), cl::Hidden);
 
+static cl::opt<std::string> ClusterFile(
+    "mfs-cluster-file",
+    cl::desc("Append the basic block clusters of the split functions to this "
+             "file, in the format of -basic-block-sections=<file>"),
+    cl::init(""), cl::Hidden);
+
 namespace {
 
 class MachineFunctionSplitter : public MachineFunctionPass {
@@ -74,6 +95,10 @@ public:
   void getAnalysisUsage(AnalysisUsage &AU) const override;
 
   bool runOnMachineFunction(MachineFunction &F) override;
+
+private:
+  /// Append the basic block clusters of \p MF to ClusterFile.
+  void writeClusters(const MachineFunction &MF);
 };
 } // end anonymous namespace
 
@@ -117,10 +142,10 @@ bool MachineFunctionSplitter::runOnMachineFunction(MachineFunction &MF) {
   // blocks. Preserving the order of blocks is essential to retaining decisions
   // made by prior passes such as MachineBlockPlacement.
   MF.RenumberBlocks();
-  MF.setBBSectionsType(BasicBlockSection::Preset);
   auto *MBFI = &getAnalysis<MachineBlockFrequencyInfo>();
   auto *PSI = &getAnalysis<ProfileSummaryInfoWrapperPass>().getPSI();
 
+  SmallVector<MachineBasicBlock *, 16> ColdBlocks;
   for (auto &MBB : MF) {
     // FIXME: We retain the entry block and conservatively keep all landing pad
     // blocks as part of the original function. Once D73739 is submitted, we can
@@ -128,9 +153,23 @@ bool MachineFunctionSplitter::runOnMachineFunction(MachineFunction &MF) {
     if ((MBB.pred_empty() || MBB.isEHPad()))
       continue;
     if (isColdBlock(MBB, MBFI, PSI))
-      MBB.setSectionID(MBBSectionID::ColdSectionID);
+      ColdBlocks.push_back(&MBB);
   }
 
+  // Sections cost extra branches, CFI and debug info ranges, so functions
+  // without cold blocks are left alone.
+  if (ColdBlocks.empty())
+    return false;
+
+  MF.setBBSectionsType(BasicBlockSection::Preset);
+  for (MachineBasicBlock *MBB : ColdBlocks)
+    MBB->setSectionID(MBBSectionID::ColdSectionID);
+  ++NumFunctionsSplit;
+  NumColdBlocks += ColdBlocks.size();
+
+  if (!ClusterFile.empty())
+    writeClusters(MF);
+
   auto Comparator = [](const MachineBasicBlock &X, const MachineBasicBlock &Y) {
     return X.getSectionID().Type < Y.getSectionID().Type;
   };
@@ -139,6 +178,32 @@ bool MachineFunctionSplitter::runOnMachineFunction(MachineFunction &MF) {
   return true;
 }
 
+// The hot blocks form the single cluster of the function, in their current
+// order. The others go to the cold section when the file is read back.
+void MachineFunctionSplitter::writeClusters(const MachineFunction &MF) {
+  std::string Clusters;
+  raw_string_ostream ClustersOS(Clusters);
+  ClustersOS << "!" << MF.getName() << "\n!!";
+  bool First = true;
+  for (const auto &MBB : MF) {
+    if (MBB.getSectionID() == MBBSectionID::ColdSectionID)
+      continue;
+    ClustersOS << (First ? "" : " ") << MBB.getNumber();
+    First = false;
+  }
+  ClustersOS << "\n";
+
+  // Several functions, and perhaps several compilations, write to the file.
+  static std::mutex ClusterFileMutex;
+  std::lock_guard<std::mutex> Lock(ClusterFileMutex);
+  std::error_code EC;
+  raw_fd_ostream OS(ClusterFile, EC, sys::fs::OF_Append | sys::fs::OF_Text);
+  if (EC)
+    report_fatal_error(Twine("Failed to open ") + ClusterFile +
+                       " to write the basic block clusters: " + EC.message());
+  OS << ClustersOS.str();
+}
+
 void MachineFunctionSplitter::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.addRequired<MachineModuleInfoWrapperPass>();
   AU.addRequired<MachineBlockFrequencyInfo>();
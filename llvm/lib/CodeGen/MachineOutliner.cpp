@@ -70,7 +70,9 @@
 #include "llvm/InitializePasses.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/SuffixArray.h"
 #include "llvm/Support/SuffixTree.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <functional>
 #include <tuple>
@@ -103,6 +105,21 @@ static cl::opt<unsigned> OutlinerReruns(
     cl::desc(
         "Number of times to rerun the outliner after the initial outline"));
 
+/// The suffix array finds the same repeated sequences as the suffix tree in
+/// much less memory, but gives them in a different order, which may break
+/// ties between equally beneficial sequences differently.
+static cl::opt<bool> UseSuffixArray(
+    "machine-outliner-suffix-array", cl::init(false), cl::Hidden,
+    cl::desc("Find repeated sequences with a suffix array rather than a "
+             "suffix tree, which uses much less memory on large modules"));
+
+/// The target's cost model must be safe to run on different candidates at
+/// once for this to be set above 1.
+static cl::opt<unsigned> OutlinerThreads(
+    "machine-outliner-threads", cl::init(1), cl::Hidden,
+    cl::desc("Number of threads to compute the benefit of the repeated "
+             "sequences on (0 = all hardware threads)"));
+
 namespace {
 
 /// Maps \p MachineInstrs to unsigned integers and stores the mappings.
@@ -328,8 +345,9 @@ struct InstructionMapper {
 /// instructions and replaces them with calls to functions.
 ///
 /// Each instruction is mapped to an unsigned integer and placed in a string.
-/// The resulting mapping is then placed in a \p SuffixTree. The \p SuffixTree
-/// is then repeatedly queried for repeated sequences of instructions. Each
+/// The resulting mapping is then placed in a \p SuffixTree, or a \p SuffixArray
+/// with -machine-outliner-suffix-array, which is then repeatedly queried for
+/// repeated sequences of instructions. Each
 /// non-overlapping repeated sequence is then placed in its own
 /// \p MachineFunction and each instance is then replaced with a call to that
 /// function.
@@ -512,87 +530,147 @@ void MachineOutliner::emitOutlinedFunctionRemark(OutlinedFunction &OF) {
   MORE.emit(R);
 }
 
+/// Add the occurrences of \p RS that don't overlap each other to \p
+/// Candidates.
+static void findCandidatesForRepeat(InstructionMapper &Mapper,
+                                    const SuffixTree::RepeatedSubstring &RS,
+                                    std::vector<Candidate> &Candidates) {
+  unsigned StringLen = RS.Length;
+  // If the occurrences are in order, then so are the candidates which were
+  // kept, and only the last one can overlap the next occurrence.
+  bool Sorted = llvm::is_sorted(RS.StartIndices);
+  for (const unsigned &StartIdx : RS.StartIndices) {
+    unsigned EndIdx = StartIdx + StringLen - 1;
+    // Trick: Discard some candidates that would be incompatible with the
+    // ones we've already found for this sequence. This will save us some
+    // work in candidate selection.
+    //
+    // If two candidates overlap, then we can't outline them both. This
+    // happens when we have candidates that look like, say
+    //
+    // AA (where each "A" is an instruction).
+    //
+    // We might have some portion of the module that looks like this:
+    // AAAAAA (6 A's)
+    //
+    // In this case, there are 5 different copies of "AA" in this range, but
+    // at most 3 can be outlined. If only outlining 3 of these is going to
+    // be unbeneficial, then we ought to not bother.
+    //
+    // Note that two things DON'T overlap when they look like this:
+    // start1...end1 .... start2...end2
+    // That is, one must either
+    // * End before the other starts
+    // * Start after the other ends
+    auto DoesntOverlap = [&StartIdx, &EndIdx](const Candidate &C) {
+      return (EndIdx < C.getStartIdx() || StartIdx > C.getEndIdx());
+    };
+    if (Sorted ? Candidates.empty() || DoesntOverlap(Candidates.back())
+               : llvm::all_of(Candidates, DoesntOverlap)) {
+      // It doesn't overlap with anything, so we can outline it.
+      // Each sequence is over [StartIt, EndIt].
+      // Save the candidate and its location.
+
+      MachineBasicBlock::iterator StartIt = Mapper.InstrList[StartIdx];
+      MachineBasicBlock::iterator EndIt = Mapper.InstrList[EndIdx];
+      MachineBasicBlock *MBB = StartIt->getParent();
+
+      // The index of the function is only known once it has been kept.
+      Candidates.emplace_back(StartIdx, StringLen, StartIt, EndIt, MBB, 0,
+                              Mapper.MBBFlagsMap[MBB]);
+    }
+  }
+}
+
 void MachineOutliner::findCandidates(
     InstructionMapper &Mapper, std::vector<OutlinedFunction> &FunctionList) {
   FunctionList.clear();
-  SuffixTree ST(Mapper.UnsignedVec);
-
-  // First, find all of the repeated substrings in the tree of minimum length
-  // 2.
-  std::vector<Candidate> CandidatesForRepeatedSeq;
-  for (auto It = ST.begin(), Et = ST.end(); It != Et; ++It) {
-    CandidatesForRepeatedSeq.clear();
-    SuffixTree::RepeatedSubstring RS = *It;
-    unsigned StringLen = RS.Length;
-    for (const unsigned &StartIdx : RS.StartIndices) {
-      unsigned EndIdx = StartIdx + StringLen - 1;
-      // Trick: Discard some candidates that would be incompatible with the
-      // ones we've already found for this sequence. This will save us some
-      // work in candidate selection.
-      //
-      // If two candidates overlap, then we can't outline them both. This
-      // happens when we have candidates that look like, say
-      //
-      // AA (where each "A" is an instruction).
-      //
-      // We might have some portion of the module that looks like this:
-      // AAAAAA (6 A's)
-      //
-      // In this case, there are 5 different copies of "AA" in this range, but
-      // at most 3 can be outlined. If only outlining 3 of these is going to
-      // be unbeneficial, then we ought to not bother.
-      //
-      // Note that two things DON'T overlap when they look like this:
-      // start1...end1 .... start2...end2
-      // That is, one must either
-      // * End before the other starts
-      // * Start after the other ends
-      if (std::all_of(
-              CandidatesForRepeatedSeq.begin(), CandidatesForRepeatedSeq.end(),
-              [&StartIdx, &EndIdx](const Candidate &C) {
-                return (EndIdx < C.getStartIdx() || StartIdx > C.getEndIdx());
-              })) {
-        // It doesn't overlap with anything, so we can outline it.
-        // Each sequence is over [StartIt, EndIt].
-        // Save the candidate and its location.
-
-        MachineBasicBlock::iterator StartIt = Mapper.InstrList[StartIdx];
-        MachineBasicBlock::iterator EndIt = Mapper.InstrList[EndIdx];
-        MachineBasicBlock *MBB = StartIt->getParent();
-
-        CandidatesForRepeatedSeq.emplace_back(StartIdx, StringLen, StartIt,
-                                              EndIt, MBB, FunctionList.size(),
-                                              Mapper.MBBFlagsMap[MBB]);
-      }
-    }
+
+  // The repeated substrings are gathered in batches, whose candidates are
+  // found and costed on the thread pool, if there is one. The results are
+  // then kept or dropped in order, so that the same functions are found
+  // whatever the number of threads.
+  const unsigned BatchSize = 4096, ChunkSize = 64;
+  std::unique_ptr<ThreadPool> Pool;
+  if (OutlinerThreads != 1)
+    Pool = std::make_unique<ThreadPool>(hardware_concurrency(OutlinerThreads));
+  std::vector<SuffixTree::RepeatedSubstring> Repeats;
+  std::vector<std::vector<Candidate>> CandidateLists;
+  std::vector<OutlinedFunction> Functions;
+
+  auto CostRepeat = [&](unsigned I) {
+    std::vector<Candidate> &CandidatesForRepeatedSeq = CandidateLists[I];
+    findCandidatesForRepeat(Mapper, Repeats[I], CandidatesForRepeatedSeq);
 
     // We've found something we might want to outline.
     // Create an OutlinedFunction to store it and check if it'd be beneficial
     // to outline.
     if (CandidatesForRepeatedSeq.size() < 2)
-      continue;
+      return;
 
     // Arbitrarily choose a TII from the first candidate.
     // FIXME: Should getOutliningCandidateInfo move to TargetMachine?
     const TargetInstrInfo *TII =
         CandidatesForRepeatedSeq[0].getMF()->getSubtarget().getInstrInfo();
 
-    OutlinedFunction OF =
-        TII->getOutliningCandidateInfo(CandidatesForRepeatedSeq);
+    Functions[I] = TII->getOutliningCandidateInfo(CandidatesForRepeatedSeq);
+  };
+
+  auto ProcessRepeats = [&]() {
+    CandidateLists.assign(Repeats.size(), std::vector<Candidate>());
+    Functions.assign(Repeats.size(), OutlinedFunction());
+    if (Pool) {
+      for (unsigned B = 0, E = Repeats.size(); B < E; B += ChunkSize)
+        Pool->async([&, B, E] {
+          for (unsigned I = B, CE = std::min(B + ChunkSize, E); I != CE; ++I)
+            CostRepeat(I);
+        });
+      Pool->wait();
+    } else {
+      for (unsigned I = 0, E = Repeats.size(); I != E; ++I)
+        CostRepeat(I);
+    }
 
-    // If we deleted too many candidates, then there's nothing worth outlining.
-    // FIXME: This should take target-specified instruction sizes into account.
-    if (OF.Candidates.size() < 2)
-      continue;
+    for (unsigned I = 0, E = Repeats.size(); I != E; ++I) {
+      OutlinedFunction &OF = Functions[I];
 
-    // Is it better to outline this candidate than not?
-    if (OF.getBenefit() < 1) {
-      emitNotOutliningCheaperRemark(StringLen, CandidatesForRepeatedSeq, OF);
-      continue;
-    }
+      // If we deleted too many candidates, then there's nothing worth
+      // outlining.
+      // FIXME: This should take target-specified instruction sizes into
+      // account.
+      if (OF.Candidates.size() < 2)
+        continue;
 
-    FunctionList.push_back(OF);
+      // Is it better to outline this candidate than not?
+      if (OF.getBenefit() < 1) {
+        emitNotOutliningCheaperRemark(Repeats[I].Length, CandidateLists[I],
+                                      OF);
+        continue;
+      }
+
+      for (Candidate &C : OF.Candidates)
+        C.FunctionIdx = FunctionList.size();
+      FunctionList.push_back(std::move(OF));
+    }
+    Repeats.clear();
+  };
+
+  auto AddRepeat = [&](const SuffixTree::RepeatedSubstring &RS) {
+    Repeats.push_back(RS);
+    if (Repeats.size() == BatchSize)
+      ProcessRepeats();
+  };
+
+  // First, find all of the repeated substrings of minimum length 2.
+  if (UseSuffixArray) {
+    SuffixArray SA(Mapper.UnsignedVec);
+    SA.forEachRepeatedSubstring(AddRepeat);
+  } else {
+    SuffixTree ST(Mapper.UnsignedVec);
+    for (auto It = ST.begin(), Et = ST.end(); It != Et; ++It)
+      AddRepeat(*It);
   }
+  ProcessRepeats();
 }
 
 MachineFunction *MachineOutliner::createOutlinedFunction(
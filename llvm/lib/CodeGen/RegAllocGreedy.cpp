@@ -84,6 +84,11 @@ using namespace llvm;
 STATISTIC(NumGlobalSplits, "Number of split global live ranges");
 STATISTIC(NumLocalSplits,  "Number of split local live ranges");
 STATISTIC(NumEvicted,      "Number of interferences evicted");
+STATISTIC(NumEvictionsDenied,
+          "Number of evictions denied by the eviction depth limit");
+STATISTIC(NumRegionSplitsCut,
+          "Number of region splits cut short by the register limit");
+STATISTIC(NumLastChanceRecolorings, "Number of last chance recolorings");
 
 static cl::opt<SplitEditor::ComplementSpillMode> SplitSpillMode(
     "split-spill-mode", cl::Hidden,
@@ -130,6 +135,20 @@ CSRFirstTimeCost("regalloc-csr-first-time-cost",
               cl::desc("Cost for first time use of callee-saved register."),
               cl::init(0), cl::Hidden);
 
+// Evicting a live range may make it evict another, and so on. Bounding the
+// length of such chains bounds the time spent on huge functions.
+static cl::opt<unsigned> MaxEvictionDepth(
+    "regalloc-greedy-max-eviction-depth", cl::Hidden,
+    cl::desc("Maximum length of a chain of evictions, after which only "
+             "urgent evictions are done (0 = unlimited)"),
+    cl::init(0));
+
+static cl::opt<unsigned> MaxRegionSplitRegs(
+    "regalloc-greedy-max-region-split-regs", cl::Hidden,
+    cl::desc("Maximum number of registers to compute the cost of splitting "
+             "a live range around (0 = unlimited)"),
+    cl::init(0));
+
 static cl::opt<bool> ConsiderLocalIntervalCost(
     "consider-local-interval-cost", cl::Hidden,
     cl::desc("Consider the cost of local intervals created by a split "
@@ -242,6 +261,10 @@ class RAGreedy : public MachineFunctionPass,
     // Cascade - Eviction loop prevention. See canEvictInterference().
     unsigned Cascade = 0;
 
+    // EvictionDepth - The length of the chain of evictions which ended with
+    // this live range being evicted. See canEvictInterference().
+    unsigned EvictionDepth = 0;
+
     RegInfo() = default;
   };
 
@@ -897,6 +920,11 @@ bool RAGreedy::canEvictInterference(LiveInterval &VirtReg, MCRegister PhysReg,
   if (!Cascade)
     Cascade = NextCascade;
 
+  // Past the end of a long eviction chain, only evict for urgent live ranges.
+  bool DepthExceeded =
+      MaxEvictionDepth &&
+      ExtraRegInfo[VirtReg.reg()].EvictionDepth >= MaxEvictionDepth;
+
   EvictionCost Cost;
   for (MCRegUnitIterator Units(PhysReg, TRI); Units.isValid(); ++Units) {
     LiveIntervalUnion::Query &Q = Matrix->query(VirtReg, *Units);
@@ -930,6 +958,10 @@ bool RAGreedy::canEvictInterference(LiveInterval &VirtReg, MCRegister PhysReg,
            RegClassInfo.getNumAllocatableRegs(MRI->getRegClass(VirtReg.reg())) <
                RegClassInfo.getNumAllocatableRegs(
                    MRI->getRegClass(Intf->reg())));
+      if (DepthExceeded && !Urgent) {
+        ++NumEvictionsDenied;
+        return false;
+      }
       // Only evict older cascades or live ranges without a cascade.
       unsigned IntfCascade = ExtraRegInfo[Intf->reg()].Cascade;
       if (Cascade <= IntfCascade) {
@@ -1090,6 +1122,8 @@ void RAGreedy::evictInterference(LiveInterval &VirtReg, MCRegister PhysReg,
             VirtReg.isSpillable() < Intf->isSpillable()) &&
            "Cannot decrease cascade number, illegal eviction");
     ExtraRegInfo[Intf->reg()].Cascade = Cascade;
+    ExtraRegInfo[Intf->reg()].EvictionDepth =
+        ExtraRegInfo[VirtReg.reg()].EvictionDepth + 1;
     ++NumEvicted;
     NewVRegs.push_back(Intf->reg());
   }
@@ -1865,11 +1899,19 @@ unsigned RAGreedy::calculateRegionSplitCost(LiveInterval &VirtReg,
                                             unsigned &NumCands, bool IgnoreCSR,
                                             bool *CanCauseEvictionChain) {
   unsigned BestCand = NoCand;
+  unsigned NumRegs = 0;
   for (MCPhysReg PhysReg : Order) {
     assert(PhysReg);
     if (IgnoreCSR && isUnusedCalleeSavedReg(PhysReg))
       continue;
 
+    // The allocation order puts the most likely registers first, so on huge
+    // functions the cost of the rest may not be worth computing.
+    if (MaxRegionSplitRegs && NumRegs++ == MaxRegionSplitRegs) {
+      ++NumRegionSplitsCut;
+      break;
+    }
+
     // Discard bad candidates before we run out of interference cache cursors.
     // This will only affect register classes with a lot of registers (>32).
     if (NumCands == IntfCache.getMaxCursors()) {
@@ -2596,6 +2638,8 @@ unsigned RAGreedy::tryLastChanceRecoloring(LiveInterval &VirtReg,
   if (!TRI->shouldUseLastChanceRecoloringForVirtReg(*MF, VirtReg))
     return ~0u;
 
+  ++NumLastChanceRecolorings;
+
   LLVM_DEBUG(dbgs() << "Try last chance recoloring for " << VirtReg << '\n');
   // Ranges must be Done.
   assert((getStage(VirtReg) >= RS_Done || !VirtReg.isSpillable()) &&
@@ -3097,9 +3141,15 @@ MCRegister RAGreedy::selectOrSplitImpl(LiveInterval &VirtReg,
 
   // If we couldn't allocate a register from spilling, there is probably some
   // invalid inline assembly. The base class will report it.
-  if (Stage >= RS_Done || !VirtReg.isSpillable())
+  if (Stage >= RS_Done || !VirtReg.isSpillable()) {
+    // Recoloring recurses into selectOrSplitImpl, so only the outermost one
+    // is timed.
+    NamedRegionTimer T("last_chance_recoloring", "Last Chance Recoloring",
+                       TimerGroupName, TimerGroupDescription,
+                       TimePassesIsEnabled && Depth == 0);
     return tryLastChanceRecoloring(VirtReg, Order, NewVRegs, FixedRegisters,
                                    Depth);
+  }
 
   // Finally spill VirtReg itself.
   if ((EnableDeferredSpilling ||
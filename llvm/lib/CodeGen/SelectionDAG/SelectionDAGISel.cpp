@@ -118,6 +118,9 @@ STATISTIC(NumFastIselBlocks, "Number of blocks selected entirely by fast isel");
 STATISTIC(NumDAGBlocks, "Number of blocks selected using DAG");
 STATISTIC(NumDAGIselRetries,"Number of times dag isel has to try another path");
 STATISTIC(NumEntryBlocks, "Number of entry blocks encountered");
+STATISTIC(NumDAGBlockSplits, "Number of times a block was split into DAGs");
+STATISTIC(NumDAGNodes, "Number of nodes in the initial DAGs");
+STATISTIC(MaxDAGNodes, "Largest number of nodes in an initial DAG");
 STATISTIC(NumFastIselFailLowerArguments,
           "Number of entry blocks where fast isel failed to lower arguments");
 
@@ -134,6 +137,15 @@ static cl::opt<bool> EnableFastISelFallbackReport(
     cl::desc("Emit a diagnostic when \"fast\" instruction selection "
              "falls back to SelectionDAG."));
 
+// The time DAGCombiner and the schedulers take grows faster than the size of
+// the DAG, so huge blocks are much faster to select a part at a time. Values
+// that live across the split points go through virtual registers, and some
+// folding across them is lost.
+static cl::opt<unsigned> MaxDAGBlockSize(
+    "isel-max-dag-block-size", cl::Hidden, cl::init(0),
+    cl::desc("Split basic blocks of more than this many instructions into "
+             "several selection DAGs (0 = no limit)"));
+
 static cl::opt<bool>
 UseMBPI("use-mbpi",
         cl::desc("use Machine Branch Probability Info"),
@@ -710,6 +722,73 @@ void SelectionDAGISel::SelectBasicBlock(BasicBlock::const_iterator Begin,
   CodeGenAndEmitDAG();
 }
 
+BasicBlock::const_iterator
+SelectionDAGISel::findDAGSplitPoint(BasicBlock::const_iterator Begin,
+                                    BasicBlock::const_iterator End) {
+  // Skip the first MaxDAGBlockSize instructions, keeping the tokens: they
+  // must be used in the DAG that defines them.
+  SmallVector<const Instruction *, 4> Tokens;
+  BasicBlock::const_iterator Split = Begin;
+  for (unsigned N = 0; Split != End && N != MaxDAGBlockSize; ++Split) {
+    if (Split->getType()->isTokenTy())
+      Tokens.push_back(&*Split);
+    if (!isa<DbgInfoIntrinsic>(Split))
+      ++N;
+  }
+
+  // A call is lowered as a tail call only if the return follows it in the
+  // same DAG, so the split must come before some instruction that keeps the
+  // calls before it out of tail position.
+  const BasicBlock *BB = Begin->getParent();
+  BasicBlock::const_iterator LastBarrier = End;
+  if (isa<ReturnInst>(BB->getTerminator())) {
+    for (auto I = End; I != Split;)
+      if ((--I)->mayHaveSideEffects() || I->mayReadFromMemory()) {
+        LastBarrier = I;
+        break;
+      }
+    if (LastBarrier == End)
+      return End;
+  }
+
+  // Find the first point after which none of the tokens is used.
+  for (; Split != End && !Split->isTerminator(); ++Split) {
+    const Instruction *SplitI = &*Split;
+    if (llvm::none_of(Tokens, [&](const Instruction *Token) {
+          return llvm::any_of(Token->users(), [&](const User *U) {
+            auto *UI = cast<Instruction>(U);
+            return UI->getParent() == BB && !UI->comesBefore(SplitI);
+          });
+        }))
+      break;
+    if (Split == LastBarrier)
+      return End;
+    if (Split->getType()->isTokenTy())
+      Tokens.push_back(SplitI);
+  }
+  if (Split == End || Split->isTerminator())
+    return End;
+
+  // Export the values which the rest of the block uses. The DAG builder
+  // copies the values which have a virtual register into it, and reads the
+  // values from other DAGs out of it.
+  for (const Instruction &I : make_range(Begin, Split)) {
+    if (I.use_empty() || I.getType()->isEmptyTy() ||
+        FuncInfo->isExportedInst(&I))
+      continue;
+    if (auto *AI = dyn_cast<AllocaInst>(&I))
+      if (FuncInfo->StaticAllocaMap.count(AI))
+        continue;
+    if (llvm::any_of(I.users(), [&](const User *U) {
+          auto *UI = cast<Instruction>(U);
+          return UI->getParent() == BB && !isa<PHINode>(UI) &&
+                 !UI->comesBefore(&*Split);
+        }))
+      FuncInfo->InitializeRegForValue(&I);
+  }
+  return Split;
+}
+
 void SelectionDAGISel::ComputeLiveOutVRegInfo() {
   SmallPtrSet<SDNode *, 16> Added;
   SmallVector<SDNode*, 128> Worklist;
@@ -774,6 +853,9 @@ void SelectionDAGISel::CodeGenAndEmitDAG() {
     BlockName =
         (MF->getName() + ":" + FuncInfo->MBB->getBasicBlock()->getName()).str();
   }
+  NumDAGNodes += CurDAG->allnodes_size();
+  MaxDAGNodes.updateMax(CurDAG->allnodes_size());
+
   LLVM_DEBUG(dbgs() << "Initial selection DAG: "
                     << printMBBReference(*FuncInfo->MBB) << " '" << BlockName
                     << "'\n";
@@ -1360,6 +1442,9 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
     LLVM_DEBUG(dbgs() << "Enabling fast-isel\n");
     FastIS = TLI->createFastISel(*FuncInfo, LibInfo);
   }
+  // FastISel selects bottom-up, and already splits blocks where it falls
+  // back to the DAG.
+  bool SplitDAGs = !FastIS && MaxDAGBlockSize;
 
   ReversePostOrderTraversal<const Function*> RPOT(&Fn);
 
@@ -1603,7 +1688,15 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
       // not handled by FastISel. If FastISel is not run, this is the entire
       // block.
       bool HadTailCall;
-      SelectBasicBlock(Begin, BI, HadTailCall);
+      BasicBlock::const_iterator PartBegin = Begin;
+      if (SplitDAGs)
+        for (BasicBlock::const_iterator Split;
+             (Split = findDAGSplitPoint(PartBegin, BI)) != BI;
+             PartBegin = Split) {
+          SelectBasicBlock(PartBegin, Split, HadTailCall);
+          ++NumDAGBlockSplits;
+        }
+      SelectBasicBlock(PartBegin, BI, HadTailCall);
 
       // But if FastISel was run, we already selected some of the block.
       // If we emitted a tail-call, we need to delete any previously emitted
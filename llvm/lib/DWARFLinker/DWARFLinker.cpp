@@ -8,7 +8,6 @@
 
 #include "llvm/DWARFLinker/DWARFLinker.h"
 #include "llvm/ADT/ArrayRef.h"
-#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/CodeGen/NonRelocatableStringpool.h"
@@ -226,6 +225,9 @@ static void analyzeImportedModule(
     return;
   if (Optional<DWARFFormValue> Val = DIE.find(dwarf::DW_AT_name))
     if (Optional<const char *> Name = Val->getAsCString()) {
+      // Compile units of several objects may be analyzed concurrently.
+      static std::mutex InterfacesMutex;
+      std::lock_guard<std::mutex> Lock(InterfacesMutex);
       auto &Entry = (*ParseableSwiftInterfaces)[*Name];
       // The prepend path is applied later when copying.
       DWARFDie CUDie = CU.getOrigUnit().getUnitDIE();
@@ -2400,15 +2402,9 @@ bool DWARFLinker::link() {
   const uint64_t ModulesEndOffset =
       Options.NoOutput ? 0 : TheDwarfEmitter->getDebugInfoSectionSize();
 
-  // These variables manage the list of processed object files.
-  // The mutex and condition variable are to ensure that this is thread safe.
-  std::mutex ProcessedFilesMutex;
-  std::condition_variable ProcessedFilesConditionVariable;
-  BitVector ProcessedFiles(NumObjects, false);
-
-  //  Analyzing the context info is particularly expensive so it is executed in
-  //  parallel with emitting the previous compile unit.
-  auto AnalyzeLambda = [&](size_t I) {
+  // Create the compile units of an object file. This assigns unit IDs, so it
+  // must run for the object files in order.
+  auto CreateUnitsLambda = [&](size_t I) {
     auto &Context = ObjectContexts[I];
 
     if (Context.Skip || !Context.File.Dwarf)
@@ -2431,6 +2427,13 @@ bool DWARFLinker::link() {
             *CU, UnitID++, !Options.NoODR && !Options.Update, ""));
       }
     }
+  };
+
+  //  Analyzing the context info is particularly expensive so it is executed in
+  //  parallel with emitting the previous compile units. The DeclContextTree is
+  //  thread-safe, so several object files can be analyzed at once.
+  auto AnalyzeLambda = [&](size_t I) {
+    auto &Context = ObjectContexts[I];
 
     // Now build the DIE parent links that we will use during the next phase.
     for (auto &CurrentUnit : Context.CompileUnits) {
@@ -2453,7 +2456,9 @@ bool DWARFLinker::link() {
   // And then the remaining work in serial again.
   // Note, although this loop runs in serial, it can run in parallel with
   // the analyzeContextInfo loop so long as we process files with indices >=
-  // than those processed by analyzeContextInfo.
+  // than those processed by analyzeContextInfo. Cloning stays in object order
+  // because the output offsets, and thus the canonical DIE of each ODR type,
+  // depend on it.
   auto CloneLambda = [&](size_t I) {
     auto &OptContext = ObjectContexts[I];
     if (OptContext.Skip || !OptContext.File.Dwarf)
@@ -2524,46 +2529,37 @@ bool DWARFLinker::link() {
     }
   };
 
-  auto AnalyzeAll = [&]() {
-    for (unsigned I = 0, E = NumObjects; I != E; ++I) {
-      AnalyzeLambda(I);
-
-      std::unique_lock<std::mutex> LockGuard(ProcessedFilesMutex);
-      ProcessedFiles.set(I);
-      ProcessedFilesConditionVariable.notify_one();
-    }
-  };
-
-  auto CloneAll = [&]() {
-    for (unsigned I = 0, E = NumObjects; I != E; ++I) {
-      {
-        std::unique_lock<std::mutex> LockGuard(ProcessedFilesMutex);
-        if (!ProcessedFiles[I]) {
-          ProcessedFilesConditionVariable.wait(
-              LockGuard, [&]() { return ProcessedFiles[I]; });
-        }
-      }
-
-      CloneLambda(I);
-    }
-    EmitLambda();
-  };
-
   // To limit memory usage in the single threaded case, analyze and clone are
   // run sequentially so the OptContext is freed after processing each object
   // in endDebugObject.
   if (Options.Threads == 1) {
     for (unsigned I = 0, E = NumObjects; I != E; ++I) {
+      CreateUnitsLambda(I);
       AnalyzeLambda(I);
       CloneLambda(I);
     }
-    EmitLambda();
   } else {
-    ThreadPool Pool(hardware_concurrency(2));
-    Pool.async(AnalyzeAll);
-    Pool.async(CloneAll);
-    Pool.wait();
+    // One thread clones while the others analyze the object files that
+    // follow. The analysis may only run a few objects ahead, as every
+    // analyzed object keeps its debug info in memory until it is cloned.
+    ThreadPool Pool(Options.Threads == 0
+                        ? hardware_concurrency()
+                        : hardware_concurrency(Options.Threads - 1));
+    const unsigned MaxAhead = 2 * Pool.getThreadCount();
+    std::vector<std::shared_future<void>> Analyzed(NumObjects);
+    unsigned NextToAnalyze = 0;
+
+    for (unsigned I = 0, E = NumObjects; I != E; ++I) {
+      for (; NextToAnalyze != E && NextToAnalyze < I + MaxAhead;
+           ++NextToAnalyze) {
+        CreateUnitsLambda(NextToAnalyze);
+        Analyzed[NextToAnalyze] = Pool.async(AnalyzeLambda, NextToAnalyze);
+      }
+      Analyzed[I].wait();
+      CloneLambda(I);
+    }
   }
+  EmitLambda();
 
   if (Options.Statistics) {
     // Create a vector sorted in descending order by output size.
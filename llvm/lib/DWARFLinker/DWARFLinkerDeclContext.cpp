@@ -27,17 +27,18 @@ namespace llvm {
 ///
 /// If a context that is not a namespace appears twice in the same CU, we know
 /// it is ambiguous. Make it invalid.
+///
+/// The contexts seen so far are tracked by the unit rather than by the
+/// context, so that the outcome doesn't depend on how the analysis of
+/// different units is interleaved.
 bool DeclContext::setLastSeenDIE(CompileUnit &U, const DWARFDie &Die) {
-  if (LastSeenCompileUnitID == U.getUniqueID()) {
-    DWARFUnit &OrigUnit = U.getOrigUnit();
-    uint32_t FirstIdx = OrigUnit.getDIEIndex(LastSeenDIE);
-    U.getInfo(FirstIdx).Ctxt = nullptr;
-    return false;
-  }
+  uint32_t Idx = U.getOrigUnit().getDIEIndex(Die);
+  uint32_t FirstIdx = U.noteDeclContext(this, Idx);
+  if (FirstIdx == Idx)
+    return true;
 
-  LastSeenCompileUnitID = U.getUniqueID();
-  LastSeenDIE = Die;
-  return true;
+  U.getInfo(FirstIdx).Ctxt = nullptr;
+  return false;
 }
 
 PointerIntPair<DeclContext *, 1> DeclContextTree::getChildDeclContext(
@@ -90,17 +91,20 @@ PointerIntPair<DeclContext *, 1> DeclContextTree::getChildDeclContext(
   StringRef ShortNameRef;
   StringRef FileRef;
 
-  if (Name)
-    NameRef = StringPool.internString(Name);
-  else if (Tag == dwarf::DW_TAG_namespace)
-    // FIXME: For dsymutil-classic compatibility. I think uniquing within
-    // anonymous namespaces is wrong. There is no ODR guarantee there.
-    NameRef = StringPool.internString("(anonymous namespace)");
-
-  if (ShortName && ShortName != Name)
-    ShortNameRef = StringPool.internString(ShortName);
-  else
-    ShortNameRef = NameRef;
+  {
+    std::lock_guard<std::mutex> Lock(StringPoolMutex);
+    if (Name)
+      NameRef = StringPool.internString(Name);
+    else if (Tag == dwarf::DW_TAG_namespace)
+      // FIXME: For dsymutil-classic compatibility. I think uniquing within
+      // anonymous namespaces is wrong. There is no ODR guarantee there.
+      NameRef = StringPool.internString("(anonymous namespace)");
+
+    if (ShortName && ShortName != Name)
+      ShortNameRef = StringPool.internString(ShortName);
+    else
+      ShortNameRef = NameRef;
+  }
 
   if (Tag != dwarf::DW_TAG_class_type && Tag != dwarf::DW_TAG_structure_type &&
       Tag != dwarf::DW_TAG_union_type &&
@@ -149,6 +153,7 @@ PointerIntPair<DeclContext *, 1> DeclContextTree::getChildDeclContext(
               assert(FoundFileName && "Must get file name from line table");
               // Second level of caching, this time based on the file's parent
               // path.
+              std::lock_guard<std::mutex> Lock(StringPoolMutex);
               FileRef = PathResolver.resolve(File, StringPool);
               U.setResolvedPath(FileNum, FileRef);
             }
@@ -180,34 +185,36 @@ PointerIntPair<DeclContext *, 1> DeclContextTree::getChildDeclContext(
 
   // Now look if this context already exists.
   DeclContext Key(Hash, Line, ByteSize, Tag, NameRef, FileRef, Context);
-  auto ContextIter = Contexts.find(&Key);
-
-  if (ContextIter == Contexts.end()) {
-    // The context wasn't found.
-    bool Inserted;
-    DeclContext *NewContext =
-        new (Allocator) DeclContext(Hash, Line, ByteSize, Tag, NameRef, FileRef,
-                                    Context, DIE, U.getUniqueID());
-    std::tie(ContextIter, Inserted) = Contexts.insert(NewContext);
-    assert(Inserted && "Failed to insert DeclContext");
-    (void)Inserted;
-  } else if (Tag != dwarf::DW_TAG_namespace &&
-             !(*ContextIter)->setLastSeenDIE(U, DIE)) {
+  Shard &S = getShard(Hash);
+  DeclContext *Ctxt;
+  {
+    std::lock_guard<std::mutex> Lock(S.Mutex);
+    auto ContextIter = S.Contexts.find(&Key);
+    if (ContextIter == S.Contexts.end()) {
+      // The context wasn't found.
+      Ctxt = new (S.Allocator)
+          DeclContext(Hash, Line, ByteSize, Tag, NameRef, FileRef, Context);
+      S.Contexts.insert(Ctxt);
+    } else {
+      Ctxt = *ContextIter;
+    }
+  }
+
+  if (Tag != dwarf::DW_TAG_namespace && !Ctxt->setLastSeenDIE(U, DIE)) {
     // The context was found, but it is ambiguous with another context
     // in the same file. Mark it invalid.
-    return PointerIntPair<DeclContext *, 1>(*ContextIter, /* Invalid= */ 1);
+    return PointerIntPair<DeclContext *, 1>(Ctxt, /* Invalid= */ 1);
   }
 
-  assert(ContextIter != Contexts.end());
   // FIXME: dsymutil-classic compatibility. Union types aren't
   // uniques, but their children might be.
   if ((Tag == dwarf::DW_TAG_subprogram &&
        Context.getTag() != dwarf::DW_TAG_structure_type &&
        Context.getTag() != dwarf::DW_TAG_class_type) ||
       (Tag == dwarf::DW_TAG_union_type))
-    return PointerIntPair<DeclContext *, 1>(*ContextIter, /* Invalid= */ 1);
+    return PointerIntPair<DeclContext *, 1>(Ctxt, /* Invalid= */ 1);
 
-  return PointerIntPair<DeclContext *, 1>(*ContextIter);
+  return PointerIntPair<DeclContext *, 1>(Ctxt);
 }
 
 } // namespace llvm
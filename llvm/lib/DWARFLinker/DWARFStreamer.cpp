@@ -136,20 +136,127 @@ void DwarfStreamer::emitCompileUnitHeader(CompileUnit &Unit) {
   Unit.setLabelBegin(Asm->createTempSymbol("cu_begin"));
   Asm->OutStreamer->emitLabel(Unit.getLabelBegin());
 
-  // Emit size of content not including length itself. The size has already
-  // been computed in CompileUnit::computeOffsets(). Subtract 4 to that size to
-  // account for the length field.
-  Asm->emitInt32(Unit.getNextUnitOffset() - Unit.getStartOffset() - 4);
-  Asm->emitInt16(Version);
+  // The size has already been computed in CompileUnit::computeOffsets().
+  emitUnitHeader(Unit.getNextUnitOffset() - Unit.getStartOffset(), Version,
+                 Unit.getOrigUnit().getAddressByteSize());
+
+  // Remember this CU.
+  EmittedUnits.push_back({Unit.getUniqueID(), Unit.getLabelBegin()});
+}
 
+void DwarfStreamer::emitUnitHeader(uint64_t UnitSize, unsigned Version,
+                                   unsigned AddressSize) {
+  // Emit size of content not including length itself. Subtract 4 to that size
+  // to account for the length field.
   // We share one abbreviations table across all units so it's always at the
   // start of the section.
-  Asm->emitInt32(0);
-  Asm->emitInt8(Unit.getOrigUnit().getAddressByteSize());
+  if (DebugInfoStream) {
+    writeInt(UnitSize - 4, 4);
+    writeInt(Version, 2);
+    writeInt(0, 4);
+    writeInt(AddressSize, 1);
+    MS->emitZeros(11);
+  } else {
+    Asm->emitInt32(UnitSize - 4);
+    Asm->emitInt16(Version);
+    Asm->emitInt32(0);
+    Asm->emitInt8(AddressSize);
+  }
   DebugInfoSectionSize += 11;
+}
 
-  // Remember this CU.
-  EmittedUnits.push_back({Unit.getUniqueID(), Unit.getLabelBegin()});
+void DwarfStreamer::writeInt(uint64_t Value, unsigned Size) {
+  bool IsLittleEndian = MAI->isLittleEndian();
+  for (unsigned I = 0; I != Size; ++I) {
+    unsigned Shift = 8 * (IsLittleEndian ? I : Size - 1 - I);
+    *DebugInfoStream << char(Value >> Shift);
+  }
+}
+
+void DwarfStreamer::writeDIE(const DIE &Die) {
+  encodeULEB128(Die.getAbbrevNumber(), *DebugInfoStream);
+
+  for (const DIEValue &Value : Die.values())
+    writeDIEValue(Value);
+
+  if (Die.hasChildren()) {
+    for (const DIE &Child : Die.children())
+      writeDIE(Child);
+    writeInt(0, 1);
+  }
+}
+
+void DwarfStreamer::writeDIEValue(const DIEValue &Value) {
+  dwarf::Form Form = Value.getForm();
+
+  switch (Value.getType()) {
+  case DIEValue::isInteger:
+    switch (Form) {
+    case dwarf::DW_FORM_implicit_const:
+    case dwarf::DW_FORM_flag_present:
+      return;
+    case dwarf::DW_FORM_GNU_str_index:
+    case dwarf::DW_FORM_GNU_addr_index:
+    case dwarf::DW_FORM_ref_udata:
+    case dwarf::DW_FORM_strx:
+    case dwarf::DW_FORM_addrx:
+    case dwarf::DW_FORM_rnglistx:
+    case dwarf::DW_FORM_udata:
+      encodeULEB128(Value.getDIEInteger().getValue(), *DebugInfoStream);
+      return;
+    case dwarf::DW_FORM_sdata:
+      encodeSLEB128(Value.getDIEInteger().getValue(), *DebugInfoStream);
+      return;
+    default:
+      writeInt(Value.getDIEInteger().getValue(), Value.SizeOf(Asm.get()));
+      return;
+    }
+  case DIEValue::isEntry: {
+    uint64_t Offset = Value.getDIEEntry().getEntry().getOffset();
+    if (Form == dwarf::DW_FORM_ref_udata)
+      encodeULEB128(Offset, *DebugInfoStream);
+    else if (Form != dwarf::DW_FORM_ref_addr)
+      writeInt(Offset, Value.SizeOf(Asm.get()));
+    else
+      llvm_unreachable("DW_FORM_ref_addr references are emitted as integers");
+    return;
+  }
+  case DIEValue::isBlock:
+  case DIEValue::isLoc: {
+    // Write the block contents first to know the size to put in front.
+    SmallString<64> Contents;
+    raw_svector_ostream ContentsOS(Contents);
+    raw_ostream *OS = DebugInfoStream;
+    DebugInfoStream = &ContentsOS;
+    for (const DIEValue &Elt : Value.getType() == DIEValue::isBlock
+                                   ? Value.getDIEBlock().values()
+                                   : Value.getDIELoc().values())
+      writeDIEValue(Elt);
+    DebugInfoStream = OS;
+
+    switch (Form) {
+    case dwarf::DW_FORM_block1:
+      writeInt(Contents.size(), 1);
+      break;
+    case dwarf::DW_FORM_block2:
+      writeInt(Contents.size(), 2);
+      break;
+    case dwarf::DW_FORM_block4:
+      writeInt(Contents.size(), 4);
+      break;
+    case dwarf::DW_FORM_block:
+    case dwarf::DW_FORM_exprloc:
+      encodeULEB128(Contents.size(), *DebugInfoStream);
+      break;
+    default:
+      break;
+    }
+    *DebugInfoStream << Contents;
+    return;
+  }
+  default:
+    llvm_unreachable("Unexpected DIE value in linked debug info");
+  }
 }
 
 /// Emit the \p Abbrevs array as the shared abbreviation table
@@ -165,7 +272,12 @@ void DwarfStreamer::emitAbbrevs(
 /// Recursively emit the DIE tree rooted at \p Die.
 void DwarfStreamer::emitDIE(DIE &Die) {
   MS->SwitchSection(MOFI->getDwarfInfoSection());
-  Asm->emitDwarfDIE(Die);
+  if (DebugInfoStream) {
+    writeDIE(Die);
+    MS->emitZeros(Die.getSize());
+  } else {
+    Asm->emitDwarfDIE(Die);
+  }
   DebugInfoSectionSize += Die.getSize();
 }
 
@@ -192,12 +304,8 @@ void DwarfStreamer::emitSectionContents(StringRef SecData, StringRef SecName) {
 /// Emit DIE containing warnings.
 void DwarfStreamer::emitPaperTrailWarningsDie(DIE &Die) {
   switchToDebugInfoSection(/* Version */ 2);
-  auto &Asm = getAsmPrinter();
-  Asm.emitInt32(11 + Die.getSize() - 4);
-  Asm.emitInt16(2);
-  Asm.emitInt32(0);
-  Asm.emitInt8(MOFI->getTargetTriple().isArch64Bit() ? 8 : 4);
-  DebugInfoSectionSize += 11;
+  emitUnitHeader(11 + Die.getSize(), 2,
+                 MOFI->getTargetTriple().isArch64Bit() ? 8 : 4);
   emitDIE(Die);
 }
 
@@ -30,6 +30,8 @@ void DWARFAbbreviationDeclaration::clear() {
   HasChildren = false;
   AttributeSpecs.clear();
   FixedAttributeSize.reset();
+  VariableSizeAttributes.clear();
+  TrailingFixedSize = FixedSizeInfo();
 }
 
 DWARFAbbreviationDeclaration::DWARFAbbreviationDeclaration() {
@@ -57,6 +59,9 @@ DWARFAbbreviationDeclaration::extract(DataExtractor Data,
   // this member variable still has a value after the while loop below, then
   // all attribute data in this abbreviation declaration has a fixed byte size.
   FixedAttributeSize = FixedSizeInfo();
+  // The size of the fixed size attributes since the last one with a variable
+  // size.
+  FixedSizeInfo PendingSize;
 
   // Read all of the abbreviation attributes and forms.
   while (true) {
@@ -76,11 +81,13 @@ DWARFAbbreviationDeclaration::extract(DataExtractor Data,
       case DW_FORM_addr:
         if (FixedAttributeSize)
           ++FixedAttributeSize->NumAddrs;
+        ++PendingSize.NumAddrs;
         break;
 
       case DW_FORM_ref_addr:
         if (FixedAttributeSize)
           ++FixedAttributeSize->NumRefAddrs;
+        ++PendingSize.NumRefAddrs;
         break;
 
       case DW_FORM_strp:
@@ -91,6 +98,7 @@ DWARFAbbreviationDeclaration::extract(DataExtractor Data,
       case DW_FORM_strp_sup:
         if (FixedAttributeSize)
           ++FixedAttributeSize->NumDwarfOffsets;
+        ++PendingSize.NumDwarfOffsets;
         break;
 
       default:
@@ -99,12 +107,15 @@ DWARFAbbreviationDeclaration::extract(DataExtractor Data,
         if ((ByteSize = dwarf::getFixedFormByteSize(F, dwarf::FormParams()))) {
           if (FixedAttributeSize)
             FixedAttributeSize->NumBytes += *ByteSize;
+          PendingSize.NumBytes += *ByteSize;
           break;
         }
         // Indicate we no longer have a fixed byte size for this
         // abbreviation by clearing the FixedAttributeSize optional value
         // so it doesn't have a value.
         FixedAttributeSize.reset();
+        VariableSizeAttributes.push_back({PendingSize, F});
+        PendingSize = FixedSizeInfo();
         break;
       }
       // Record this attribute and its fixed size if it has one.
@@ -112,6 +123,7 @@ DWARFAbbreviationDeclaration::extract(DataExtractor Data,
     } else if (A == 0 && F == 0) {
       // We successfully reached the end of this abbreviation declaration
       // since both attribute and form are zero.
+      TrailingFixedSize = PendingSize;
       break;
     } else {
       // Attribute and form pairs must either both be non-zero, in which case
@@ -213,3 +225,19 @@ Optional<size_t> DWARFAbbreviationDeclaration::getFixedAttributesByteSize(
     return FixedAttributeSize->getByteSize(U);
   return None;
 }
+
+bool DWARFAbbreviationDeclaration::skipAttributeValues(
+    DataExtractor Data, uint64_t *OffsetPtr, const DWARFUnit &U) const {
+  if (FixedAttributeSize) {
+    *OffsetPtr += FixedAttributeSize->getByteSize(U);
+    return true;
+  }
+  const dwarf::FormParams Params = U.getFormParams();
+  for (const VariableSizeAttribute &Attr : VariableSizeAttributes) {
+    *OffsetPtr += Attr.PrecedingSize.getByteSize(U);
+    if (!DWARFFormValue::skipValue(Attr.Form, Data, OffsetPtr, Params))
+      return false;
+  }
+  *OffsetPtr += TrailingFixedSize.getByteSize(U);
+  return true;
+}
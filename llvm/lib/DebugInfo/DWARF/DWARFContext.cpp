@@ -1373,13 +1373,17 @@ DWARFContext::getDWOContext(StringRef AbsolutePath) {
     return std::shared_ptr<DWARFContext>(std::move(S), Ctxt);
   }
 
+  // Only the units that are looked up get read, from split DWARF files that
+  // can be very large, so do not let the operating system read ahead.
+  const unsigned Hints = MemoryBuffer::AH_Random;
   Expected<OwningBinary<ObjectFile>> Obj = [&] {
     if (!CheckedForDWP) {
       SmallString<128> DWPName;
       auto Obj = object::ObjectFile::createObjectFile(
           this->DWPName.empty()
               ? (DObj->getFileName() + ".dwp").toStringRef(DWPName)
-              : StringRef(this->DWPName));
+              : StringRef(this->DWPName),
+          Hints);
       if (Obj) {
         Entry = &DWP;
         return Obj;
@@ -1391,7 +1395,7 @@ DWARFContext::getDWOContext(StringRef AbsolutePath) {
       }
     }
 
-    return object::ObjectFile::createObjectFile(AbsolutePath);
+    return object::ObjectFile::createObjectFile(AbsolutePath, Hints);
   }();
 
   if (!Obj) {
@@ -45,26 +45,14 @@ bool DWARFDebugInfoEntry::extractFast(const DWARFUnit &U, uint64_t *OffsetPtr,
     *OffsetPtr = Offset;
     return false;
   }
-  // See if all attributes in this DIE have fixed byte sizes. If so, we can
-  // just add this size to the offset to skip to the next DIE.
-  if (Optional<size_t> FixedSize = AbbrevDecl->getFixedAttributesByteSize(U)) {
-    *OffsetPtr += *FixedSize;
-    return true;
-  }
-
-  // Skip all data in the .debug_info for the attributes
-  for (const auto &AttrSpec : AbbrevDecl->attributes()) {
-    // Check if this attribute has a fixed byte size.
-    if (auto FixedSize = AttrSpec.getByteSize(U)) {
-      // Attribute byte size if fixed, just add the size to the offset.
-      *OffsetPtr += *FixedSize;
-    } else if (!DWARFFormValue::skipValue(AttrSpec.Form, DebugInfoData,
-                                          OffsetPtr, U.getFormParams())) {
-      // We failed to skip this attribute's value, restore the original offset
-      // and return the failure status.
-      *OffsetPtr = Offset;
-      return false;
-    }
+  // Skip all data in the .debug_info for the attributes. The abbreviation
+  // knows which values have a fixed byte size, so that only the others need
+  // to be decoded.
+  if (!AbbrevDecl->skipAttributeValues(DebugInfoData, OffsetPtr, U)) {
+    // We failed to skip an attribute's value, restore the original offset
+    // and return the failure status.
+    *OffsetPtr = Offset;
+    return false;
   }
   return true;
 }
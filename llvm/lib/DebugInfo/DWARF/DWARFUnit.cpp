@@ -664,10 +664,48 @@ void DWARFUnit::updateAddressDieMap(DWARFDie Die) {
     updateAddressDieMap(Child);
 }
 
+DWARFDie DWARFUnit::findSubroutineForAddress(DWARFDie Die,
+                                             uint64_t Address) {
+  // Visit the DIEs in the order updateAddressDieMap() adds them, so that the
+  // last match is the DIE the map would have returned.
+  DWARFDie Result;
+  for (DWARFDie Child : Die.children()) {
+    if (Child.isSubroutineDIE()) {
+      auto RangesOrError = Child.getAddressRanges();
+      if (RangesOrError) {
+        // The ranges of the nested DIEs are within the ones of their parent,
+        // no need to look at them if the address isn't.
+        if (llvm::none_of(*RangesOrError, [&](const DWARFAddressRange &R) {
+              return R.LowPC <= Address && Address < R.HighPC;
+            }))
+          continue;
+        Result = Child;
+      } else
+        llvm::consumeError(RangesOrError.takeError());
+    }
+    if (DWARFDie Nested = findSubroutineForAddress(Child, Address))
+      Result = Nested;
+  }
+  return Result;
+}
+
+/// Number of lookups in a unit that are answered by walking its DIE tree
+/// before building the address map.
+static constexpr unsigned MaxLazyAddressLookups = 4;
+
 DWARFDie DWARFUnit::getSubroutineForAddress(uint64_t Address) {
   extractDIEsIfNeeded(false);
-  if (AddrDieMap.empty())
+  if (AddrDieMap.empty()) {
+    // Building the map evaluates the ranges of every subroutine of the unit,
+    // including all the inlined ones, which only pays off when the unit is
+    // queried repeatedly. Tools that look up a handful of addresses are
+    // better served by walking the tree down to the address.
+    if (NumLazyAddressLookups < MaxLazyAddressLookups) {
+      ++NumLazyAddressLookups;
+      return findSubroutineForAddress(getUnitDIE(), Address);
+    }
     updateAddressDieMap(getUnitDIE());
+  }
   auto R = AddrDieMap.upper_bound(Address);
   if (R == AddrDieMap.begin())
     return DWARFDie();
@@ -16,6 +16,7 @@
 #include "llvm/DebugInfo/DWARF/DWARFSection.h"
 #include "llvm/Support/DJB.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
 #include <map>
@@ -26,6 +27,22 @@ using namespace llvm;
 using namespace dwarf;
 using namespace object;
 
+namespace {
+/// Buffers the output of a verification task. The output is colored if the
+/// stream it will eventually be printed to supports colors.
+class BufferedOutput : public raw_string_ostream {
+  bool HasColors;
+
+public:
+  BufferedOutput(std::string &Str, const raw_ostream &Parent)
+      : raw_string_ostream(Str), HasColors(Parent.has_colors()) {
+    enable_colors(true);
+  }
+
+  bool has_colors() const override { return HasColors; }
+};
+} // namespace
+
 Optional<DWARFAddressRange>
 DWARFVerifier::DieRangeInfo::insert(const DWARFAddressRange &R) {
   auto Begin = Ranges.begin();
@@ -299,10 +316,30 @@ unsigned DWARFVerifier::verifyUnitSection(const DWARFSection &S,
   bool hasDIE = DebugInfoData.isValidOffset(Offset);
   DWARFUnitVector TypeUnitVector;
   DWARFUnitVector CompileUnitVector;
+
+  // The unit headers are verified first, one after the other, and the unit
+  // contents afterwards, possibly in parallel. The errors found in a header
+  // are kept so that they are printed before the contents of the following
+  // units, as if each unit had been verified right after its header.
+  struct UnitToVerify {
+    DWARFUnit *Unit = nullptr;
+    std::string HeaderErrors;
+  };
+  std::vector<UnitToVerify> Units;
+  std::string HeaderErrors;
+  BufferedOutput HeaderOS(HeaderErrors, OS);
+  DWARFVerifier HeaderVerifier(HeaderOS, DCtx, DumpOpts);
   while (hasDIE) {
     OffsetStart = Offset;
-    if (!verifyUnitHeader(DebugInfoData, &Offset, UnitIdx, UnitType,
-                          isUnitDWARF64)) {
+    bool IsValidHeader = HeaderVerifier.verifyUnitHeader(
+        DebugInfoData, &Offset, UnitIdx, UnitType, isUnitDWARF64);
+    HeaderOS.flush();
+    if (!HeaderErrors.empty()) {
+      Units.emplace_back();
+      Units.back().HeaderErrors = std::move(HeaderErrors);
+      HeaderErrors.clear();
+    }
+    if (!IsValidHeader) {
       isHeaderChainValid = false;
       if (isUnitDWARF64)
         break;
@@ -337,11 +374,30 @@ unsigned DWARFVerifier::verifyUnitSection(const DWARFSection &S,
       }
       default: { llvm_unreachable("Invalid UnitType."); }
       }
-      NumDebugInfoErrors += verifyUnitContents(*Unit);
+      Units.emplace_back();
+      Units.back().Unit = Unit;
     }
     hasDIE = DebugInfoData.isValidOffset(Offset);
     ++UnitIdx;
   }
+
+  if (DumpOpts.VerifyNumThreads != 1) {
+    // Neither extracting the DIEs of a unit nor parsing its line table can be
+    // done by several threads at once, do both before verifying the contents
+    // of the units in parallel.
+    for (const UnitToVerify &U : Units) {
+      if (!U.Unit)
+        continue;
+      U.Unit->getUnitDIE(/*ExtractUnitDIEOnly=*/false);
+      DCtx.getLineTableForUnit(U.Unit);
+    }
+  }
+  NumDebugInfoErrors +=
+      verifyInParallel(Units.size(), [&](DWARFVerifier &V, size_t I) {
+        V.OS << Units[I].HeaderErrors;
+        return Units[I].Unit ? V.verifyUnitContents(*Units[I].Unit) : 0;
+      });
+
   if (UnitIdx == 0 && !hasDIE) {
     warn() << "Section is empty.\n";
     isHeaderChainValid = true;
@@ -912,60 +968,70 @@ unsigned DWARFVerifier::verifyAppleAccelTable(const DWARFSection *AccelSection,
     return 1;
   }
 
-  for (uint32_t HashIdx = 0; HashIdx < NumHashes; ++HashIdx) {
-    uint64_t HashOffset = HashesBase + 4 * HashIdx;
-    uint64_t DataOffset = OffsetsBase + 4 * HashIdx;
-    uint32_t Hash = AccelSectionData.getU32(&HashOffset);
-    uint64_t HashDataOffset = AccelSectionData.getU32(&DataOffset);
-    if (!AccelSectionData.isValidOffsetForDataOfSize(HashDataOffset,
-                                                     sizeof(uint64_t))) {
-      error() << format("Hash[%d] has invalid HashData offset: "
-                        "0x%08" PRIx64 ".\n",
-                        HashIdx, HashDataOffset);
-      ++NumErrors;
-    }
-
-    uint64_t StrpOffset;
-    uint64_t StringOffset;
-    uint32_t StringCount = 0;
-    uint64_t Offset;
-    unsigned Tag;
-    while ((StrpOffset = AccelSectionData.getU32(&HashDataOffset)) != 0) {
-      const uint32_t NumHashDataObjects =
-          AccelSectionData.getU32(&HashDataOffset);
-      for (uint32_t HashDataIdx = 0; HashDataIdx < NumHashDataObjects;
-           ++HashDataIdx) {
-        std::tie(Offset, Tag) = AccelTable.readAtoms(&HashDataOffset);
-        auto Die = DCtx.getDIEForOffset(Offset);
-        if (!Die) {
-          const uint32_t BucketIdx =
-              NumBuckets ? (Hash % NumBuckets) : UINT32_MAX;
-          StringOffset = StrpOffset;
-          const char *Name = StrData->getCStr(&StringOffset);
-          if (!Name)
-            Name = "<NULL>";
-
-          error() << format(
-              "%s Bucket[%d] Hash[%d] = 0x%08x "
-              "Str[%u] = 0x%08" PRIx64 " DIE[%d] = 0x%08" PRIx64 " "
-              "is not a valid DIE offset for \"%s\".\n",
-              SectionName, BucketIdx, HashIdx, Hash, StringCount, StrpOffset,
-              HashDataIdx, Offset, Name);
+  // Verify the hashes in parallel, in batches of HashesPerTask.
+  const uint32_t HashesPerTask = 1024;
+  auto VerifyHashes = [&](DWARFVerifier &V, size_t Task) {
+    unsigned NumTaskErrors = 0;
+    uint32_t FirstHashIdx = Task * HashesPerTask;
+    uint32_t EndHashIdx = std::min(NumHashes, FirstHashIdx + HashesPerTask);
+    for (uint32_t HashIdx = FirstHashIdx; HashIdx < EndHashIdx; ++HashIdx) {
+      uint64_t HashOffset = HashesBase + 4 * HashIdx;
+      uint64_t DataOffset = OffsetsBase + 4 * HashIdx;
+      uint32_t Hash = AccelSectionData.getU32(&HashOffset);
+      uint64_t HashDataOffset = AccelSectionData.getU32(&DataOffset);
+      if (!AccelSectionData.isValidOffsetForDataOfSize(HashDataOffset,
+                                                       sizeof(uint64_t))) {
+        V.error() << format("Hash[%d] has invalid HashData offset: "
+                            "0x%08" PRIx64 ".\n",
+                            HashIdx, HashDataOffset);
+        ++NumTaskErrors;
+      }
 
-          ++NumErrors;
-          continue;
-        }
-        if ((Tag != dwarf::DW_TAG_null) && (Die.getTag() != Tag)) {
-          error() << "Tag " << dwarf::TagString(Tag)
-                  << " in accelerator table does not match Tag "
-                  << dwarf::TagString(Die.getTag()) << " of DIE[" << HashDataIdx
-                  << "].\n";
-          ++NumErrors;
+      uint64_t StrpOffset;
+      uint64_t StringOffset;
+      uint32_t StringCount = 0;
+      uint64_t Offset;
+      unsigned Tag;
+      while ((StrpOffset = AccelSectionData.getU32(&HashDataOffset)) != 0) {
+        const uint32_t NumHashDataObjects =
+            AccelSectionData.getU32(&HashDataOffset);
+        for (uint32_t HashDataIdx = 0; HashDataIdx < NumHashDataObjects;
+             ++HashDataIdx) {
+          std::tie(Offset, Tag) = AccelTable.readAtoms(&HashDataOffset);
+          auto Die = DCtx.getDIEForOffset(Offset);
+          if (!Die) {
+            const uint32_t BucketIdx =
+                NumBuckets ? (Hash % NumBuckets) : UINT32_MAX;
+            StringOffset = StrpOffset;
+            const char *Name = StrData->getCStr(&StringOffset);
+            if (!Name)
+              Name = "<NULL>";
+
+            V.error() << format(
+                "%s Bucket[%d] Hash[%d] = 0x%08x "
+                "Str[%u] = 0x%08" PRIx64 " DIE[%d] = 0x%08" PRIx64 " "
+                "is not a valid DIE offset for \"%s\".\n",
+                SectionName, BucketIdx, HashIdx, Hash, StringCount, StrpOffset,
+                HashDataIdx, Offset, Name);
+
+            ++NumTaskErrors;
+            continue;
+          }
+          if ((Tag != dwarf::DW_TAG_null) && (Die.getTag() != Tag)) {
+            V.error() << "Tag " << dwarf::TagString(Tag)
+                      << " in accelerator table does not match Tag "
+                      << dwarf::TagString(Die.getTag()) << " of DIE["
+                      << HashDataIdx << "].\n";
+            ++NumTaskErrors;
+          }
         }
+        ++StringCount;
       }
-      ++StringCount;
     }
-  }
+    return NumTaskErrors;
+  };
+  NumErrors += verifyInParallel(divideCeil(NumHashes, HashesPerTask),
+                                VerifyHashes, extractDIEsForParallelLookups());
   return NumErrors;
 }
 
@@ -1487,21 +1553,56 @@ unsigned DWARFVerifier::verifyDebugNames(const DWARFSection &AccelSection,
   // Don't attempt Entry validation if any of the previous checks found errors
   if (NumErrors > 0)
     return NumErrors;
+  bool AllowThreads = extractDIEsForParallelLookups();
+
+  // Verify the entries of the names in parallel, in batches of NamesPerTask
+  // names of a given Name Index.
+  const uint32_t NamesPerTask = 1024;
+  struct NamesToVerify {
+    const DWARFDebugNames::NameIndex *NI;
+    uint32_t FirstName;
+    uint32_t EndName;
+  };
+  std::vector<NamesToVerify> Names;
   for (const auto &NI : AccelTable)
-    for (DWARFDebugNames::NameTableEntry NTE : NI)
-      NumErrors += verifyNameIndexEntries(NI, NTE);
+    for (uint32_t Name = 1; Name <= NI.getNameCount(); Name += NamesPerTask)
+      Names.push_back(
+          {&NI, Name, std::min(NI.getNameCount() + 1, Name + NamesPerTask)});
+  NumErrors += verifyInParallel(
+      Names.size(),
+      [&](DWARFVerifier &V, size_t I) {
+        unsigned NumTaskErrors = 0;
+        const NamesToVerify &Task = Names[I];
+        for (uint32_t Name = Task.FirstName; Name < Task.EndName; ++Name)
+          NumTaskErrors += V.verifyNameIndexEntries(
+              *Task.NI, Task.NI->getNameTableEntry(Name));
+        return NumTaskErrors;
+      },
+      AllowThreads);
 
   if (NumErrors > 0)
     return NumErrors;
 
+  // Verify that the DIEs of each compile unit are indexed, in parallel.
+  std::vector<std::pair<DWARFCompileUnit *, const DWARFDebugNames::NameIndex *>>
+      CUsToVerify;
   for (const std::unique_ptr<DWARFUnit> &U : DCtx.compile_units()) {
     if (const DWARFDebugNames::NameIndex *NI =
-            AccelTable.getCUNameIndex(U->getOffset())) {
-      auto *CU = cast<DWARFCompileUnit>(U.get());
-      for (const DWARFDebugInfoEntry &Die : CU->dies())
-        NumErrors += verifyNameIndexCompleteness(DWARFDie(CU, &Die), *NI);
-    }
+            AccelTable.getCUNameIndex(U->getOffset()))
+      CUsToVerify.emplace_back(cast<DWARFCompileUnit>(U.get()), NI);
   }
+  NumErrors += verifyInParallel(
+      CUsToVerify.size(),
+      [&](DWARFVerifier &V, size_t I) {
+        unsigned NumTaskErrors = 0;
+        DWARFCompileUnit *CU = CUsToVerify[I].first;
+        const DWARFDebugNames::NameIndex *NI = CUsToVerify[I].second;
+        for (const DWARFDebugInfoEntry &Die : CU->dies())
+          NumTaskErrors +=
+              V.verifyNameIndexCompleteness(DWARFDie(CU, &Die), *NI);
+        return NumTaskErrors;
+      },
+      AllowThreads);
   return NumErrors;
 }
 
@@ -1537,3 +1638,54 @@ raw_ostream &DWARFVerifier::dump(const DWARFDie &Die, unsigned indent) const {
   Die.dump(OS, indent, DumpOpts);
   return OS;
 }
+
+unsigned DWARFVerifier::verifyInParallel(
+    size_t NumTasks, function_ref<unsigned(DWARFVerifier &, size_t)> Task,
+    bool AllowThreads) {
+  ThreadPoolStrategy Strategy = hardware_concurrency(DumpOpts.VerifyNumThreads);
+  unsigned NumErrors = 0;
+  if (!AllowThreads || NumTasks < 2 || Strategy.compute_thread_count() < 2) {
+    for (size_t I = 0; I < NumTasks; ++I)
+      NumErrors += Task(*this, I);
+    return NumErrors;
+  }
+
+  DIDumpOptions TaskDumpOpts = DumpOpts;
+  TaskDumpOpts.VerifyNumThreads = 1;
+  std::vector<std::string> Outputs(NumTasks);
+  std::vector<unsigned> TaskErrors(NumTasks);
+  std::vector<std::map<uint64_t, std::set<uint64_t>>> TaskReferences(NumTasks);
+  {
+    ThreadPool Pool(Strategy);
+    for (size_t I = 0; I < NumTasks; ++I) {
+      Pool.async([&, I] {
+        BufferedOutput TaskOS(Outputs[I], OS);
+        DWARFVerifier V(TaskOS, DCtx, TaskDumpOpts);
+        TaskErrors[I] = Task(V, I);
+        TaskReferences[I] = std::move(V.ReferenceToDIEOffsets);
+      });
+    }
+    Pool.wait();
+  }
+
+  for (size_t I = 0; I < NumTasks; ++I) {
+    OS << Outputs[I];
+    NumErrors += TaskErrors[I];
+    for (const auto &Ref : TaskReferences[I])
+      ReferenceToDIEOffsets[Ref.first].insert(Ref.second.begin(),
+                                              Ref.second.end());
+  }
+  return NumErrors;
+}
+
+bool DWARFVerifier::extractDIEsForParallelLookups() {
+  if (DumpOpts.VerifyNumThreads == 1)
+    return false;
+  // Without any unit, every lookup would try to parse the units again.
+  bool HasUnits = false;
+  for (const std::unique_ptr<DWARFUnit> &U : DCtx.normal_units()) {
+    U->getUnitDIE(/*ExtractUnitDIEOnly=*/false);
+    HasUnits = true;
+  }
+  return HasUnits;
+}
@@ -10,6 +10,7 @@
 #include "llvm/DebugInfo/GSYM/Header.h"
 #include "llvm/DebugInfo/GSYM/LineTable.h"
 #include "llvm/MC/StringTableBuilder.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include <algorithm>
@@ -169,7 +170,7 @@ llvm::Error GsymCreator::finalize(llvm::raw_ostream &OS) {
   Finalized = true;
 
   // Sort function infos so we can emit sorted functions.
-  llvm::sort(Funcs.begin(), Funcs.end());
+  parallelSort(Funcs.begin(), Funcs.end());
 
   // Don't let the string table indexes change by finalizing in order.
   StrTab.finalizeInOrder();
@@ -194,56 +195,63 @@ llvm::Error GsymCreator::finalize(llvm::raw_ostream &OS) {
   // Note that in case of (b), we cannot include Y in the result because then
   // we wouldn't find any function for range (end of Y, end of X)
   // with binary search
+  //
+  // The entries that are kept are compacted at the front of Funcs as we go,
+  // erasing them one at a time would be quadratic when many are removed, as
+  // happens when most functions have both a symbol and debug info.
   auto NumBefore = Funcs.size();
-  auto Curr = Funcs.begin();
-  auto Prev = Funcs.end();
-  while (Curr != Funcs.end()) {
+  size_t NumKept = 0;
+  for (size_t I = 0, E = Funcs.size(); I != E; ++I) {
+    FunctionInfo &Curr = Funcs[I];
+    // Set to true to replace the previous entry by the current one.
+    bool RemovePrev = false;
     // Can't check for overlaps or same address ranges if we don't have a
     // previous entry
-    if (Prev != Funcs.end()) {
-      if (Prev->Range.intersects(Curr->Range)) {
+    if (NumKept != 0) {
+      FunctionInfo &Prev = Funcs[NumKept - 1];
+      if (Prev.Range.intersects(Curr.Range)) {
         // Overlapping address ranges.
-        if (Prev->Range == Curr->Range) {
+        if (Prev.Range == Curr.Range) {
           // Same address range. Check if one is from debug info and the other
           // is from a symbol table. If so, then keep the one with debug info.
           // Our sorting guarantees that entries with matching address ranges
           // that have debug info are last in the sort.
-          if (*Prev == *Curr) {
+          if (Prev == Curr) {
             // FunctionInfo entries match exactly (range, lines, inlines)
             OS << "warning: duplicate function info entries for range: "
-               << Curr->Range << '\n';
-            Curr = Funcs.erase(Prev);
-          } else {
-            if (!Prev->hasRichInfo() && Curr->hasRichInfo()) {
-              // Same address range, one with no debug info (symbol) and the
-              // next with debug info. Keep the latter.
-              Curr = Funcs.erase(Prev);
-            } else {
-              OS << "warning: same address range contains different debug "
-                 << "info. Removing:\n"
-                 << *Prev << "\nIn favor of this one:\n"
-                 << *Curr << "\n";
-              Curr = Funcs.erase(Prev);
-            }
+               << Curr.Range << '\n';
+          } else if (Prev.hasRichInfo() || !Curr.hasRichInfo()) {
+            OS << "warning: same address range contains different debug "
+               << "info. Removing:\n"
+               << Prev << "\nIn favor of this one:\n"
+               << Curr << "\n";
           }
+          // Otherwise it is the same address range, one with no debug info
+          // (symbol) and the next with debug info. Keep the latter.
+          RemovePrev = true;
         } else {
           // print warnings about overlaps
           OS << "warning: function ranges overlap:\n"
-             << *Prev << "\n"
-             << *Curr << "\n";
+             << Prev << "\n"
+             << Curr << "\n";
         }
-      } else if (Prev->Range.size() == 0 &&
-                 Curr->Range.contains(Prev->Range.Start)) {
+      } else if (Prev.Range.size() == 0 &&
+                 Curr.Range.contains(Prev.Range.Start)) {
         OS << "warning: removing symbol:\n"
-           << *Prev << "\nKeeping:\n"
-           << *Curr << "\n";
-        Curr = Funcs.erase(Prev);
+           << Prev << "\nKeeping:\n"
+           << Curr << "\n";
+        RemovePrev = true;
       }
     }
-    if (Curr == Funcs.end())
-      break;
-    Prev = Curr++;
+    if (RemovePrev) {
+      Funcs[NumKept - 1] = std::move(Curr);
+      continue;
+    }
+    if (NumKept != I)
+      Funcs[NumKept] = std::move(Curr);
+    ++NumKept;
   }
+  Funcs.erase(Funcs.begin() + NumKept, Funcs.end());
 
   // If our last function info entry doesn't have a size and if we have valid
   // text ranges, we should set the size of the last entry since any search for
@@ -282,7 +290,19 @@ uint32_t GsymCreator::insertString(StringRef S, bool Copy) {
 void GsymCreator::addFunctionInfo(FunctionInfo &&FI) {
   std::lock_guard<std::recursive_mutex> Guard(Mutex);
   Ranges.insert(FI.Range);
-  Funcs.emplace_back(FI);
+  Funcs.emplace_back(std::move(FI));
+}
+
+void GsymCreator::addFunctionInfos(std::vector<FunctionInfo> &&FIs) {
+  std::lock_guard<std::recursive_mutex> Guard(Mutex);
+  for (const FunctionInfo &FI : FIs)
+    Ranges.insert(FI.Range);
+  if (Funcs.empty())
+    Funcs = std::move(FIs);
+  else
+    Funcs.insert(Funcs.end(), std::make_move_iterator(FIs.begin()),
+                 std::make_move_iterator(FIs.end()));
+  FIs.clear();
 }
 
 void GsymCreator::forEachFunctionInfo(
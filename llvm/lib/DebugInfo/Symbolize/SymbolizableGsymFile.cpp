@@ -0,0 +1,98 @@
+//===- SymbolizableGsymFile.cpp -------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// Implementation of SymbolizableGsymFile class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "SymbolizableGsymFile.h"
+#include "llvm/DebugInfo/GSYM/LookupResult.h"
+
+using namespace llvm;
+using namespace symbolize;
+
+bool SymbolizableGsymFile::lookup(uint64_t Address,
+                                  DILineInfoSpecifier LineInfoSpecifier,
+                                  DIInliningInfo &InlinedContext) const {
+  Expected<gsym::LookupResult> Result = Reader.lookup(Address);
+  if (!Result) {
+    consumeError(Result.takeError());
+    return false;
+  }
+
+  // GSYM only records one name per function, it is used for both the short
+  // and the linkage names.
+  bool PrintFunctions = LineInfoSpecifier.FNKind != FunctionNameKind::None;
+  if (Result->Locations.empty()) {
+    // The function has no line table, only its name is known.
+    DILineInfo Frame;
+    if (PrintFunctions)
+      Frame.FunctionName = Result->FuncName.str();
+    InlinedContext.addFrame(Frame);
+    return true;
+  }
+
+  for (uint32_t I = 0, E = Result->Locations.size(); I != E; ++I) {
+    const gsym::SourceLocation &Loc = Result->Locations[I];
+    DILineInfo Frame;
+    if (PrintFunctions)
+      Frame.FunctionName = Loc.Name.str();
+    Frame.Line = Loc.Line;
+    switch (LineInfoSpecifier.FLIKind) {
+    case DILineInfoSpecifier::FileLineInfoKind::None:
+      break;
+    case DILineInfoSpecifier::FileLineInfoKind::BaseNameOnly:
+      Frame.FileName = Loc.Base.str();
+      break;
+    default:
+      Frame.FileName = Result->getSourceFile(I);
+      break;
+    }
+    InlinedContext.addFrame(Frame);
+  }
+  return true;
+}
+
+DILineInfo
+SymbolizableGsymFile::symbolizeCode(object::SectionedAddress ModuleOffset,
+                                    DILineInfoSpecifier LineInfoSpecifier,
+                                    bool UseSymbolTable) const {
+  DIInliningInfo InlinedContext;
+  if (!lookup(ModuleOffset.Address, LineInfoSpecifier, InlinedContext))
+    return ObjectModule->symbolizeCode(ModuleOffset, LineInfoSpecifier,
+                                       UseSymbolTable);
+  return InlinedContext.getFrame(0);
+}
+
+DIInliningInfo SymbolizableGsymFile::symbolizeInlinedCode(
+    object::SectionedAddress ModuleOffset,
+    DILineInfoSpecifier LineInfoSpecifier, bool UseSymbolTable) const {
+  DIInliningInfo InlinedContext;
+  if (!lookup(ModuleOffset.Address, LineInfoSpecifier, InlinedContext))
+    return ObjectModule->symbolizeInlinedCode(ModuleOffset, LineInfoSpecifier,
+                                              UseSymbolTable);
+  return InlinedContext;
+}
+
+DIGlobal SymbolizableGsymFile::symbolizeData(
+    object::SectionedAddress ModuleOffset) const {
+  return ObjectModule->symbolizeData(ModuleOffset);
+}
+
+std::vector<DILocal> SymbolizableGsymFile::symbolizeFrame(
+    object::SectionedAddress ModuleOffset) const {
+  return ObjectModule->symbolizeFrame(ModuleOffset);
+}
+
+bool SymbolizableGsymFile::isWin32Module() const {
+  return ObjectModule->isWin32Module();
+}
+
+uint64_t SymbolizableGsymFile::getModulePreferredBase() const {
+  return ObjectModule->getModulePreferredBase();
+}
@@ -0,0 +1,65 @@
+//===- SymbolizableGsymFile.h -----------------------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the SymbolizableGsymFile class.
+//
+//===----------------------------------------------------------------------===//
+#ifndef LLVM_LIB_DEBUGINFO_SYMBOLIZE_SYMBOLIZABLEGSYMFILE_H
+#define LLVM_LIB_DEBUGINFO_SYMBOLIZE_SYMBOLIZABLEGSYMFILE_H
+
+#include "llvm/DebugInfo/DIContext.h"
+#include "llvm/DebugInfo/GSYM/GsymReader.h"
+#include "llvm/DebugInfo/Symbolize/SymbolizableModule.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace llvm {
+namespace symbolize {
+
+/// A module whose code addresses are symbolized from a GSYM file generated
+/// from its debug info. Addresses the GSYM file doesn't cover, as well as data
+/// and frame queries, are answered by the module of the object file itself.
+class SymbolizableGsymFile : public SymbolizableModule {
+public:
+  SymbolizableGsymFile(gsym::GsymReader Reader,
+                       std::unique_ptr<SymbolizableModule> ObjectModule)
+      : Reader(std::move(Reader)), ObjectModule(std::move(ObjectModule)) {}
+
+  DILineInfo symbolizeCode(object::SectionedAddress ModuleOffset,
+                           DILineInfoSpecifier LineInfoSpecifier,
+                           bool UseSymbolTable) const override;
+  DIInliningInfo symbolizeInlinedCode(object::SectionedAddress ModuleOffset,
+                                      DILineInfoSpecifier LineInfoSpecifier,
+                                      bool UseSymbolTable) const override;
+  DIGlobal symbolizeData(object::SectionedAddress ModuleOffset) const override;
+  std::vector<DILocal>
+  symbolizeFrame(object::SectionedAddress ModuleOffset) const override;
+
+  // Return true if this is a 32-bit x86 PE COFF module.
+  bool isWin32Module() const override;
+
+  // Returns the preferred base of the module, i.e. where the loader would place
+  // it in memory assuming there were no conflicts.
+  uint64_t getModulePreferredBase() const override;
+
+private:
+  /// Look up \p Address in the GSYM file and fill \p InlinedContext with its
+  /// frames, innermost first. Returns false if the GSYM file doesn't contain
+  /// the address.
+  bool lookup(uint64_t Address, DILineInfoSpecifier LineInfoSpecifier,
+              DIInliningInfo &InlinedContext) const;
+
+  gsym::GsymReader Reader;
+  std::unique_ptr<SymbolizableModule> ObjectModule;
+};
+
+} // end namespace symbolize
+} // end namespace llvm
+
+#endif // LLVM_LIB_DEBUGINFO_SYMBOLIZE_SYMBOLIZABLEGSYMFILE_H
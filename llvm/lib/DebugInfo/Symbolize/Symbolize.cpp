@@ -12,12 +12,16 @@
 
 #include "llvm/DebugInfo/Symbolize/Symbolize.h"
 
+#include "SymbolizableGsymFile.h"
 #include "SymbolizableObjectFile.h"
 
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/BinaryFormat/COFF.h"
 #include "llvm/Config/config.h"
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
+#include "llvm/DebugInfo/GSYM/DwarfTransformer.h"
+#include "llvm/DebugInfo/GSYM/GsymCreator.h"
+#include "llvm/DebugInfo/GSYM/ObjectFileTransformer.h"
 #include "llvm/DebugInfo/PDB/PDB.h"
 #include "llvm/DebugInfo/PDB/PDBContext.h"
 #include "llvm/Demangle/Demangle.h"
@@ -566,9 +570,137 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName) {
       Context.reset(new PDBContext(*CoffObject, std::move(Session)));
     }
   }
+  bool UseGsym = !Context && !Opts.GsymCacheDirectory.empty();
   if (!Context)
     Context = DWARFContext::create(*Objects.second, nullptr, Opts.DWPName);
-  return createModuleInfo(Objects.first, std::move(Context), ModuleName);
+  Expected<SymbolizableModule *> InfoOrErr =
+      createModuleInfo(Objects.first, std::move(Context), ModuleName);
+  if (!InfoOrErr || !UseGsym)
+    return InfoOrErr;
+  std::unique_ptr<SymbolizableModule> &SymMod = Modules[ModuleName];
+  SymMod = useGsymCache(*Objects.second, ArchName, std::move(SymMod));
+  return SymMod.get();
+}
+
+namespace {
+
+/// Returns the path of the GSYM file for \p Obj in \p CacheDirectory. The
+/// files are named after the UUID or build ID of the object file, which
+/// identifies its debug info, and can be shared by symbolizers running
+/// concurrently.
+Optional<std::string> getGsymCachePath(StringRef CacheDirectory,
+                                       const ObjectFile &Obj) {
+  ArrayRef<uint8_t> ID;
+  if (auto *MachObj = dyn_cast<MachOObjectFile>(&Obj))
+    ID = MachObj->getUuid();
+  else if (auto *ELFObj = dyn_cast<ELFObjectFileBase>(&Obj))
+    ID = getBuildID(ELFObj).getValueOr(ArrayRef<uint8_t>());
+  if (ID.empty())
+    return None;
+  SmallString<128> Path(CacheDirectory);
+  sys::path::append(Path, toHex(ID, /*LowerCase=*/true) + ".gsym");
+  return std::string(Path.str());
+}
+
+/// Converts the debug info and symbol table of the object file at \p Path to
+/// the GSYM file \p GsymPath. The file is written under a unique name and
+/// renamed once complete, so that other symbolizers never see a partial file.
+Error convertToGsym(StringRef Path, StringRef ArchName, StringRef GsymPath) {
+  Expected<OwningBinary<Binary>> BinOrErr = createBinary(Path);
+  if (!BinOrErr)
+    return BinOrErr.takeError();
+  Binary *Bin = BinOrErr->getBinary();
+  auto *Obj = dyn_cast<ObjectFile>(Bin);
+  std::unique_ptr<MachOObjectFile> ObjForArch;
+  if (auto *UB = dyn_cast<MachOUniversalBinary>(Bin)) {
+    Expected<std::unique_ptr<MachOObjectFile>> ObjOrErr =
+        UB->getMachOObjectForArch(ArchName);
+    if (!ObjOrErr)
+      return ObjOrErr.takeError();
+    ObjForArch = std::move(*ObjOrErr);
+    Obj = ObjForArch.get();
+  }
+  if (!Obj)
+    return errorCodeToError(object_error::invalid_file_type);
+
+  gsym::GsymCreator Gsym;
+  gsym::AddressRanges TextRanges;
+  for (const SectionRef &Sect : Obj->sections()) {
+    if (!Sect.isText() || Sect.getSize() == 0)
+      continue;
+    TextRanges.insert(gsym::AddressRange(Sect.getAddress(),
+                                         Sect.getAddress() + Sect.getSize()));
+  }
+  if (!TextRanges.empty())
+    Gsym.SetValidTextRanges(TextRanges);
+
+  // Use a single thread, the conversion runs next to the symbolization
+  // requests and shouldn't compete with them.
+  std::unique_ptr<DWARFContext> DICtx = DWARFContext::create(*Obj);
+  gsym::DwarfTransformer DT(*DICtx, nulls(), Gsym);
+  if (Error Err = DT.convert(/*NumThreads=*/1))
+    return Err;
+  if (Error Err = gsym::ObjectFileTransformer::convert(*Obj, nulls(), Gsym))
+    return Err;
+  if (Error Err = Gsym.finalize(nulls()))
+    return Err;
+
+  if (std::error_code EC =
+          sys::fs::create_directories(sys::path::parent_path(GsymPath)))
+    return errorCodeToError(EC);
+  SmallString<128> TmpPath;
+  sys::fs::createUniquePath(GsymPath + "-%%%%%%%%.tmp", TmpPath,
+                            /*MakeAbsolute=*/false);
+  if (Error Err = Gsym.save(TmpPath, Obj->isLittleEndian() ? support::little
+                                                           : support::big)) {
+    sys::fs::remove(TmpPath);
+    return Err;
+  }
+  if (std::error_code EC = sys::fs::rename(TmpPath, GsymPath)) {
+    sys::fs::remove(TmpPath);
+    return errorCodeToError(EC);
+  }
+  return Error::success();
+}
+
+} // end anonymous namespace
+
+std::unique_ptr<SymbolizableModule>
+LLVMSymbolizer::useGsymCache(const ObjectFile &DbgObj,
+                             const std::string &ArchName,
+                             std::unique_ptr<SymbolizableModule> SymMod) {
+  if (!SymMod)
+    return SymMod;
+  Optional<std::string> GsymPath =
+      getGsymCachePath(Opts.GsymCacheDirectory, DbgObj);
+  if (!GsymPath)
+    return SymMod;
+
+  if (sys::fs::exists(*GsymPath)) {
+    // The reader maps the file, only the parts queried are paged in.
+    Expected<gsym::GsymReader> ReaderOrErr =
+        gsym::GsymReader::openFile(*GsymPath);
+    if (!ReaderOrErr) {
+      // Keep using the debug info of the object file.
+      consumeError(ReaderOrErr.takeError());
+      return SymMod;
+    }
+    return std::make_unique<SymbolizableGsymFile>(std::move(*ReaderOrErr),
+                                                  std::move(SymMod));
+  }
+
+  // Serve this symbolizer from the debug info of the object file and convert
+  // it for the next ones. A failed conversion simply leaves no GSYM file.
+  if (!ScheduledGsymConversions.insert(*GsymPath).second)
+    return SymMod;
+  if (!GsymConversionPool)
+    GsymConversionPool =
+        std::make_unique<ThreadPool>(hardware_concurrency(1));
+  std::string Path = std::string(DbgObj.getFileName());
+  GsymConversionPool->async([Path, ArchName, GsymPath] {
+    consumeError(convertToGsym(Path, ArchName, *GsymPath));
+  });
+  return SymMod;
 }
 
 namespace {
@@ -610,13 +742,13 @@ LLVMSymbolizer::DemangleName(const std::string &Name,
   // We can spoil names of symbols with C linkage, so use an heuristic
   // approach to check if the name should be demangled.
   if (Name.substr(0, 2) == "_Z") {
-    int status = 0;
-    char *DemangledName = itaniumDemangle(Name.c_str(), nullptr, nullptr, &status);
-    if (status != 0)
-      return Name;
-    std::string Result = DemangledName;
-    free(DemangledName);
-    return Result;
+    // Symbolizing a trace demangles a name per frame; keep the demangler's
+    // memory around between them.
+    static thread_local ItaniumDemangleContext Demangler;
+    size_t Length;
+    if (const char *DemangledName = Demangler.demangle(Name.c_str(), &Length))
+      return std::string(DemangledName, Length);
+    return Name;
   }
 
   if (!Name.empty() && Name.front() == '?') {
@@ -20,12 +20,16 @@ static bool isItaniumEncoding(const std::string &MangledName) {
 }
 
 std::string llvm::demangle(const std::string &MangledName) {
-  char *Demangled;
-  if (isItaniumEncoding(MangledName))
-    Demangled = itaniumDemangle(MangledName.c_str(), nullptr, nullptr, nullptr);
-  else
-    Demangled = microsoftDemangle(MangledName.c_str(), nullptr, nullptr,
-                                  nullptr, nullptr);
+  if (isItaniumEncoding(MangledName)) {
+    static thread_local ItaniumDemangleContext Context;
+    size_t N;
+    if (const char *Demangled = Context.demangle(MangledName.c_str(), &N))
+      return std::string(Demangled, N);
+    return MangledName;
+  }
+
+  char *Demangled = microsoftDemangle(MangledName.c_str(), nullptr, nullptr,
+                                      nullptr, nullptr);
 
   if (!Demangled)
     return MangledName;
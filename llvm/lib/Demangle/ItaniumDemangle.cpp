@@ -13,6 +13,7 @@
 #include "llvm/Demangle/Demangle.h"
 #include "llvm/Demangle/ItaniumDemangle.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cctype>
 #include <cstdio>
@@ -323,6 +324,79 @@ public:
 
 using Demangler = itanium_demangle::ManglingParser<DefaultAllocator>;
 
+namespace {
+/// Node arena for a parser that demangles many names. Unlike DefaultAllocator
+/// it keeps its slabs when reset, so a long lived parser stops allocating once
+/// it has seen its largest name.
+class ReusableAllocator {
+  static constexpr size_t SlabSize = 4096;
+
+  std::vector<char *> Slabs;
+  std::vector<void *> LargeAllocs;
+  size_t NextSlab = 0;
+  char *Ptr = nullptr;
+  char *End = nullptr;
+
+  void *allocateSlow(size_t N) {
+    // Rare oversized requests get their own allocation, freed on reset.
+    if (N > SlabSize / 4) {
+      void *Mem = std::malloc(N);
+      if (Mem == nullptr)
+        std::terminate();
+      LargeAllocs.push_back(Mem);
+      return Mem;
+    }
+    if (NextSlab == Slabs.size()) {
+      char *Slab = static_cast<char *>(std::malloc(SlabSize));
+      if (Slab == nullptr)
+        std::terminate();
+      Slabs.push_back(Slab);
+    }
+    Ptr = Slabs[NextSlab++];
+    End = Ptr + SlabSize;
+    Ptr += N;
+    return Ptr - N;
+  }
+
+public:
+  ReusableAllocator() = default;
+  ReusableAllocator(const ReusableAllocator &) = delete;
+  ReusableAllocator &operator=(const ReusableAllocator &) = delete;
+
+  ~ReusableAllocator() {
+    reset();
+    for (char *Slab : Slabs)
+      std::free(Slab);
+  }
+
+  void reset() {
+    for (void *Mem : LargeAllocs)
+      std::free(Mem);
+    LargeAllocs.clear();
+    NextSlab = 0;
+    Ptr = End = nullptr;
+  }
+
+  void *allocate(size_t N) {
+    N = (N + 15u) & ~size_t(15u);
+    if (static_cast<size_t>(End - Ptr) < N)
+      return allocateSlow(N);
+    Ptr += N;
+    return Ptr - N;
+  }
+
+  template<typename T, typename ...Args> T *makeNode(Args &&...args) {
+    return new (allocate(sizeof(T))) T(std::forward<Args>(args)...);
+  }
+
+  void *allocateNodeArray(size_t sz) {
+    return allocate(sizeof(Node *) * sz);
+  }
+};
+} // unnamed namespace
+
+using ReusableDemangler = itanium_demangle::ManglingParser<ReusableAllocator>;
+
 char *llvm::itaniumDemangle(const char *MangledName, char *Buf,
                             size_t *N, int *Status) {
   if (MangledName == nullptr || (Buf != nullptr && N == nullptr)) {
@@ -355,11 +429,79 @@ char *llvm::itaniumDemangle(const char *MangledName, char *Buf,
   return InternalStatus == demangle_success ? Buf : nullptr;
 }
 
+ItaniumDemangleContext::ItaniumDemangleContext()
+    : Context(new ReusableDemangler{nullptr, nullptr}), Buf(nullptr),
+      BufSize(0) {}
+
+ItaniumDemangleContext::~ItaniumDemangleContext() {
+  delete static_cast<ReusableDemangler *>(Context);
+  std::free(Buf);
+}
+
+ItaniumDemangleContext::ItaniumDemangleContext(ItaniumDemangleContext &&Other)
+    : Context(Other.Context), Buf(Other.Buf), BufSize(Other.BufSize) {
+  Other.Context = nullptr;
+  Other.Buf = nullptr;
+  Other.BufSize = 0;
+}
+
+ItaniumDemangleContext &ItaniumDemangleContext::
+operator=(ItaniumDemangleContext &&Other) {
+  std::swap(Context, Other.Context);
+  std::swap(Buf, Other.Buf);
+  std::swap(BufSize, Other.BufSize);
+  return *this;
+}
+
+const char *ItaniumDemangleContext::demangle(const char *MangledName,
+                                             size_t *N, int *Status) {
+  if (MangledName == nullptr || Context == nullptr) {
+    if (Status)
+      *Status = demangle_invalid_args;
+    return nullptr;
+  }
+
+  ReusableDemangler *Parser = static_cast<ReusableDemangler *>(Context);
+  Parser->reset(MangledName, MangledName + std::strlen(MangledName));
+  // reset() leaves behind the forward references of a name that failed to
+  // parse.
+  Parser->ForwardTemplateRefs.clear();
+
+  Node *AST = Parser->parse();
+  if (AST == nullptr) {
+    if (Status)
+      *Status = demangle_invalid_mangled_name;
+    return nullptr;
+  }
+
+  if (Buf == nullptr) {
+    BufSize = 1024;
+    Buf = static_cast<char *>(std::malloc(BufSize));
+    if (Buf == nullptr) {
+      if (Status)
+        *Status = demangle_memory_alloc_failure;
+      return nullptr;
+    }
+  }
+  assert(Parser->ForwardTemplateRefs.empty());
+  OutputStream S(Buf, BufSize);
+  AST->print(S);
+  S += '\0';
+  // Printing may have grown the buffer; keep it for the next name.
+  Buf = S.getBuffer();
+  BufSize = std::max(BufSize, S.getBufferCapacity());
+  if (N != nullptr)
+    *N = S.getCurrentPosition() - 1;
+  if (Status)
+    *Status = demangle_success;
+  return Buf;
+}
+
 ItaniumPartialDemangler::ItaniumPartialDemangler()
-    : RootNode(nullptr), Context(new Demangler{nullptr, nullptr}) {}
+    : RootNode(nullptr), Context(new ReusableDemangler{nullptr, nullptr}) {}
 
 ItaniumPartialDemangler::~ItaniumPartialDemangler() {
-  delete static_cast<Demangler *>(Context);
+  delete static_cast<ReusableDemangler *>(Context);
 }
 
 ItaniumPartialDemangler::ItaniumPartialDemangler(
@@ -377,9 +519,10 @@ operator=(ItaniumPartialDemangler &&Other) {
 
 // Demangle MangledName into an AST, storing it into this->RootNode.
 bool ItaniumPartialDemangler::partialDemangle(const char *MangledName) {
-  Demangler *Parser = static_cast<Demangler *>(Context);
+  ReusableDemangler *Parser = static_cast<ReusableDemangler *>(Context);
   size_t Len = std::strlen(MangledName);
   Parser->reset(MangledName, MangledName + Len);
+  Parser->ForwardTemplateRefs.clear();
   RootNode = Parser->parse();
   return RootNode == nullptr;
 }
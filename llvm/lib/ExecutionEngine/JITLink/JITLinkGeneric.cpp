@@ -14,12 +14,18 @@
 
 #include "llvm/Support/BinaryStreamReader.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Parallel.h"
 
 #define DEBUG_TYPE "jitlink"
 
 namespace llvm {
 namespace jitlink {
 
+// Graphs with less block content than this are copied and fixed up on the
+// linking thread: below this size the cost of farming out the work exceeds
+// the cost of doing it.
+static const uint64_t ParallelLinkThreshold = 1024 * 1024;
+
 JITLinkerBase::~JITLinkerBase() {}
 
 void JITLinkerBase::linkPhase1(std::unique_ptr<JITLinkerBase> Self) {
@@ -218,6 +224,7 @@ Error JITLinkerBase::allocateSegments(const SegmentLayoutMap &Layout) {
   // Compute segment sizes and allocate memory.
   LLVM_DEBUG(dbgs() << "JIT linker requesting: { ");
   JITLinkMemoryManager::SegmentsRequestMap Segments;
+  uint64_t TotalContentSize = 0;
   for (auto &KV : Layout) {
     auto &Prot = KV.first;
     auto &SegLists = KV.second;
@@ -243,6 +250,7 @@ Error JITLinkerBase::allocateSegments(const SegmentLayoutMap &Layout) {
 
     Segments[Prot] = {SegAlign, SegContentSize,
                       SegZeroFillEnd - SegZeroFillStart};
+    TotalContentSize += SegContentSize;
 
     LLVM_DEBUG({
       dbgs() << (&KV == &*Layout.begin() ? "" : "; ")
@@ -254,6 +262,11 @@ Error JITLinkerBase::allocateSegments(const SegmentLayoutMap &Layout) {
   }
   LLVM_DEBUG(dbgs() << " }\n");
 
+  // Keep to a single thread while debugging so that the output stays ordered.
+  LinkInParallel = TotalContentSize >= ParallelLinkThreshold &&
+                   parallel::strategy.ThreadsRequested != 1;
+  LLVM_DEBUG(LinkInParallel = false);
+
   if (auto AllocOrErr =
           Ctx->getMemoryManager().allocate(Ctx->getJITLinkDylib(), Segments))
     Alloc = std::move(*AllocOrErr);
@@ -331,71 +344,71 @@ void JITLinkerBase::applyLookupResult(AsyncLookupResult Result) {
 void JITLinkerBase::copyBlockContentToWorkingMemory(
     const SegmentLayoutMap &Layout, JITLinkMemoryManager::Allocation &Alloc) {
 
+  // Each copy zero-pads from the end of its block up to the start of the next
+  // block (or the end of the segment), so that copies touch disjoint memory
+  // and can run in any order.
+  struct BlockCopy {
+    Block *B;
+    char *Dest;
+    char *PadEnd;
+  };
+  std::vector<BlockCopy> Copies;
+
   LLVM_DEBUG(dbgs() << "Copying block content:\n");
   for (auto &KV : Layout) {
-    auto &Prot = KV.first;
+    auto Prot = static_cast<sys::Memory::ProtectionFlags>(KV.first);
     auto &SegLayout = KV.second;
 
-    auto SegMem =
-        Alloc.getWorkingMemory(static_cast<sys::Memory::ProtectionFlags>(Prot));
-    char *LastBlockEnd = SegMem.data();
-    char *BlockDataPtr = LastBlockEnd;
+    auto SegMem = Alloc.getWorkingMemory(Prot);
+    JITTargetAddress SegAddr = Alloc.getTargetMemory(Prot);
+    char *SegEnd = SegMem.data() + SegMem.size();
 
     LLVM_DEBUG({
-      dbgs() << "  Processing segment "
-             << static_cast<sys::Memory::ProtectionFlags>(Prot) << " [ "
-             << (const void *)SegMem.data() << " .. "
-             << (const void *)((char *)SegMem.data() + SegMem.size())
-             << " ]\n    Processing content sections:\n";
+      dbgs() << "  Segment " << Prot << " [ " << (const void *)SegMem.data()
+             << " .. " << (const void *)SegEnd << " ]: "
+             << SegLayout.ContentBlocks.size() << " content blocks\n";
     });
 
-    for (auto *B : SegLayout.ContentBlocks) {
-      LLVM_DEBUG(dbgs() << "    " << *B << ":\n");
-
-      // Pad to alignment/alignment-offset.
-      BlockDataPtr = alignToBlock(BlockDataPtr, *B);
-
-      LLVM_DEBUG({
-        dbgs() << "      Bumped block pointer to " << (const void *)BlockDataPtr
-               << " to meet block alignment " << B->getAlignment()
-               << " and alignment offset " << B->getAlignmentOffset() << "\n";
-      });
-
-      // Zero pad up to alignment.
-      LLVM_DEBUG({
-        if (LastBlockEnd != BlockDataPtr)
-          dbgs() << "      Zero padding from " << (const void *)LastBlockEnd
-                 << " to " << (const void *)BlockDataPtr << "\n";
-      });
-
-      while (LastBlockEnd != BlockDataPtr)
-        *LastBlockEnd++ = 0;
-
-      // Copy initial block content.
-      LLVM_DEBUG({
-        dbgs() << "      Copying block " << *B << " content, "
-               << B->getContent().size() << " bytes, from "
-               << (const void *)B->getContent().data() << " to "
-               << (const void *)BlockDataPtr << "\n";
-      });
-      memcpy(BlockDataPtr, B->getContent().data(), B->getContent().size());
-
-      // Point the block's content to the fixed up buffer.
-      B->setContent(StringRef(BlockDataPtr, B->getContent().size()));
-
-      // Update block end pointer.
-      LastBlockEnd = BlockDataPtr + B->getContent().size();
-      BlockDataPtr = LastBlockEnd;
-    }
+    // Block addresses were assigned in allocateSegments, so each block's
+    // offset in working memory is its offset from the segment's target
+    // address.
+    auto getWorkingMem = [&](Block &B) {
+      return SegMem.data() + (B.getAddress() - SegAddr);
+    };
+
+    auto &Blocks = SegLayout.ContentBlocks;
+    char *FirstBlockStart = Blocks.empty() ? SegEnd : getWorkingMem(*Blocks[0]);
+    memset(SegMem.data(), 0, FirstBlockStart - SegMem.data());
+
+    for (size_t I = 0, E = Blocks.size(); I != E; ++I)
+      Copies.push_back({Blocks[I], getWorkingMem(*Blocks[I]),
+                        I + 1 != E ? getWorkingMem(*Blocks[I + 1]) : SegEnd});
+  }
+
+  auto CopyBlock = [](const BlockCopy &C) {
+    size_t Size = C.B->getContent().size();
+    assert(C.Dest + Size <= C.PadEnd && "Block overlaps next block");
+    memcpy(C.Dest, C.B->getContent().data(), Size);
+    memset(C.Dest + Size, 0, C.PadEnd - (C.Dest + Size));
+
+    // Point the block's content to the fixed up buffer.
+    C.B->setContent(StringRef(C.Dest, Size));
+  };
+
+  if (LinkInParallel) {
+    parallelForEach(Copies, CopyBlock);
+    return;
+  }
 
-    // Zero pad the rest of the segment.
+  for (auto &C : Copies) {
     LLVM_DEBUG({
-      dbgs() << "    Zero padding end of segment from "
-             << (const void *)LastBlockEnd << " to "
-             << (const void *)((char *)SegMem.data() + SegMem.size()) << "\n";
+      dbgs() << "    Copying block " << *C.B << " content, "
+             << C.B->getContent().size() << " bytes, from "
+             << (const void *)C.B->getContent().data() << " to "
+             << (const void *)C.Dest << ", zero padding to "
+             << (const void *)C.PadEnd << "\n";
     });
-    while (LastBlockEnd != SegMem.data() + SegMem.size())
-      *LastBlockEnd++ = 0;
+    CopyBlock(C);
   }
 }
 
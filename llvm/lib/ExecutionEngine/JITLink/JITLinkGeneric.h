@@ -15,6 +15,7 @@
 
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ExecutionEngine/JITLink/JITLink.h"
+#include "llvm/Support/Parallel.h"
 
 #define DEBUG_TYPE "jitlink"
 
@@ -89,6 +90,10 @@ protected:
     return P + Delta;
   }
 
+  // True if block content should be copied and fixed up in parallel. Set once
+  // segments have been allocated.
+  bool linkInParallel() const { return LinkInParallel; }
+
 private:
   // Run all passes in the given pass list, bailing out immediately if any pass
   // returns an error.
@@ -112,6 +117,7 @@ private:
   std::unique_ptr<LinkGraph> G;
   PassConfiguration Passes;
   std::unique_ptr<JITLinkMemoryManager::Allocation> Alloc;
+  bool LinkInParallel = false;
 };
 
 template <typename LinkerImpl> class JITLinker : public JITLinkerBase {
@@ -143,11 +149,10 @@ private:
   Error fixUpBlocks(LinkGraph &G) const override {
     LLVM_DEBUG(dbgs() << "Fixing up blocks:\n");
 
-    for (auto *B : G.blocks()) {
-      LLVM_DEBUG(dbgs() << "  " << *B << ":\n");
-
-      // Copy Block data and apply fixups.
-      LLVM_DEBUG(dbgs() << "    Applying fixups.\n");
+    // Fixups only write to the content of the block being fixed up, so blocks
+    // can be fixed up independently of each other.
+    auto FixUpBlock = [this](Block *B) -> Error {
+      auto *BlockData = const_cast<char *>(B->getContent().data());
       for (auto &E : B->edges()) {
 
         // Skip non-relocation edges.
@@ -155,10 +160,21 @@ private:
           continue;
 
         // Dispatch to LinkerImpl for fixup.
-        auto *BlockData = const_cast<char *>(B->getContent().data());
         if (auto Err = impl().applyFixup(*B, E, BlockData))
           return Err;
       }
+      return Error::success();
+    };
+
+    if (linkInParallel()) {
+      std::vector<Block *> Blocks(G.blocks().begin(), G.blocks().end());
+      return parallelForEachError(Blocks, FixUpBlock);
+    }
+
+    for (auto *B : G.blocks()) {
+      LLVM_DEBUG(dbgs() << "  " << *B << ":\n");
+      if (auto Err = FixUpBlock(B))
+        return Err;
     }
 
     return Error::success();
@@ -129,5 +129,180 @@ InProcessMemoryManager::allocate(const JITLinkDylib *JD,
       new IPMMAlloc(std::move(Blocks)));
 }
 
+// Protection of memory that has not been finalized.
+static const sys::Memory::ProtectionFlags ReadWrite =
+    static_cast<sys::Memory::ProtectionFlags>(sys::Memory::MF_READ |
+                                              sys::Memory::MF_WRITE);
+
+class InProcessSlabMemoryManager::SlabAllocation : public Allocation {
+public:
+  using AllocationMap = DenseMap<unsigned, sys::MemoryBlock>;
+
+  SlabAllocation(InProcessSlabMemoryManager &MemMgr, char *Base, uint64_t Size,
+                 AllocationMap SegBlocks)
+      : MemMgr(MemMgr), Base(Base), Size(Size),
+        SegBlocks(std::move(SegBlocks)) {}
+
+  MutableArrayRef<char> getWorkingMemory(ProtectionFlags Seg) override {
+    assert(SegBlocks.count(Seg) && "No allocation for segment");
+    return {static_cast<char *>(SegBlocks[Seg].base()),
+            SegBlocks[Seg].allocatedSize()};
+  }
+
+  JITTargetAddress getTargetMemory(ProtectionFlags Seg) override {
+    assert(SegBlocks.count(Seg) && "No allocation for segment");
+    return pointerToJITTargetAddress(SegBlocks[Seg].base());
+  }
+
+  void finalizeAsync(FinalizeContinuation OnFinalize) override {
+    for (auto &KV : SegBlocks) {
+      auto Prot = static_cast<ProtectionFlags>(KV.first);
+      auto &Block = KV.second;
+      if (Prot != ReadWrite)
+        if (auto EC = sys::Memory::protectMappedMemory(Block, Prot))
+          return OnFinalize(errorCodeToError(EC));
+      if (Prot & sys::Memory::MF_EXEC)
+        sys::Memory::InvalidateInstructionCache(Block.base(),
+                                                Block.allocatedSize());
+    }
+    OnFinalize(Error::success());
+  }
+
+  Error deallocate() override {
+    if (!Base)
+      return Error::success();
+
+    // Return the memory to the slab read/write, as it was handed out.
+    for (auto &KV : SegBlocks)
+      if (KV.first != ReadWrite)
+        if (auto EC = sys::Memory::protectMappedMemory(KV.second, ReadWrite))
+          return errorCodeToError(EC);
+
+    MemMgr.release(Base, Size);
+    Base = nullptr;
+    SegBlocks.clear();
+    return Error::success();
+  }
+
+private:
+  InProcessSlabMemoryManager &MemMgr;
+  char *Base;
+  uint64_t Size;
+  AllocationMap SegBlocks;
+};
+
+Expected<std::unique_ptr<InProcessSlabMemoryManager>>
+InProcessSlabMemoryManager::Create(uint64_t SlabSize, bool UseLargePages) {
+  uint64_t PageSize = sys::Process::getPageSizeEstimate();
+  if (!isPowerOf2_64(PageSize))
+    return make_error<StringError>("Page size is not a power of 2",
+                                   inconvertibleErrorCode());
+
+  unsigned Flags = ReadWrite;
+  if (UseLargePages)
+    Flags |= sys::Memory::MF_HUGE_HINT;
+
+  std::error_code EC;
+  auto Slab = sys::Memory::allocateMappedMemory(alignTo(SlabSize, PageSize),
+                                                nullptr, Flags, EC);
+  if (EC)
+    return errorCodeToError(EC);
+
+  return std::unique_ptr<InProcessSlabMemoryManager>(
+      new InProcessSlabMemoryManager(std::move(Slab), PageSize));
+}
+
+InProcessSlabMemoryManager::InProcessSlabMemoryManager(sys::MemoryBlock Slab,
+                                                       uint64_t PageSize)
+    : Slab(std::move(Slab)), PageSize(PageSize) {
+  FreeRanges[static_cast<char *>(this->Slab.base())] =
+      this->Slab.allocatedSize();
+}
+
+InProcessSlabMemoryManager::~InProcessSlabMemoryManager() {
+  sys::Memory::releaseMappedMemory(Slab);
+}
+
+Expected<std::unique_ptr<JITLinkMemoryManager::Allocation>>
+InProcessSlabMemoryManager::allocate(const JITLinkDylib *JD,
+                                     const SegmentsRequestMap &Request) {
+  // Compute the total size of the page aligned segments.
+  uint64_t TotalSize = 0;
+  for (auto &KV : Request) {
+    const auto &Seg = KV.second;
+    if (Seg.getAlignment() > PageSize)
+      return make_error<StringError>("Cannot request higher than page "
+                                     "alignment",
+                                     inconvertibleErrorCode());
+    TotalSize +=
+        alignTo(Seg.getContentSize() + Seg.getZeroFillSize(), PageSize);
+  }
+
+  char *Base = nullptr;
+  if (TotalSize) {
+    if (auto BaseOrErr = reserve(TotalSize))
+      Base = *BaseOrErr;
+    else
+      return BaseOrErr.takeError();
+  }
+
+  // Allocate segment memory from the reserved range.
+  SlabAllocation::AllocationMap Blocks;
+  char *NextSeg = Base;
+  for (auto &KV : Request) {
+    const auto &Seg = KV.second;
+    uint64_t SegmentSize =
+        alignTo(Seg.getContentSize() + Seg.getZeroFillSize(), PageSize);
+
+    // Zero out the zero-fill memory. The range may have been used before.
+    memset(NextSeg + Seg.getContentSize(), 0, Seg.getZeroFillSize());
+
+    Blocks[KV.first] = sys::MemoryBlock(NextSeg, SegmentSize);
+    NextSeg += SegmentSize;
+  }
+
+  return std::unique_ptr<Allocation>(
+      new SlabAllocation(*this, Base, TotalSize, std::move(Blocks)));
+}
+
+Expected<char *> InProcessSlabMemoryManager::reserve(uint64_t Size) {
+  std::lock_guard<std::mutex> Lock(FreeRangesMutex);
+
+  // First fit keeps the allocations packed towards the start of the slab.
+  for (auto I = FreeRanges.begin(), E = FreeRanges.end(); I != E; ++I) {
+    if (I->second < Size)
+      continue;
+    char *Addr = I->first;
+    uint64_t Remaining = I->second - Size;
+    FreeRanges.erase(I);
+    if (Remaining)
+      FreeRanges[Addr + Size] = Remaining;
+    return Addr;
+  }
+
+  return make_error<StringError>("Slab exhausted: could not allocate " +
+                                     Twine(Size) + " bytes",
+                                 inconvertibleErrorCode());
+}
+
+void InProcessSlabMemoryManager::release(char *Addr, uint64_t Size) {
+  std::lock_guard<std::mutex> Lock(FreeRangesMutex);
+
+  // Coalesce with the free ranges on either side.
+  auto Next = FreeRanges.lower_bound(Addr);
+  if (Next != FreeRanges.end() && Addr + Size == Next->first) {
+    Size += Next->second;
+    Next = FreeRanges.erase(Next);
+  }
+  if (Next != FreeRanges.begin()) {
+    auto Prev = std::prev(Next);
+    if (Prev->first + Prev->second == Addr) {
+      Prev->second += Size;
+      return;
+    }
+  }
+  FreeRanges[Addr] = Size;
+}
+
 } // end namespace jitlink
 } // end namespace llvm
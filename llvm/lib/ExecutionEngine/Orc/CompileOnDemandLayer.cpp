@@ -182,8 +182,31 @@ void CompileOnDemandLayer::emit(
   }
 }
 
+Error CompileOnDemandLayer::redirectStubs(JITDylib &ImplD,
+                                          const SymbolMap &NewAddrs) {
+  std::lock_guard<std::mutex> Lock(CODLayerMutex);
+  auto I = llvm::find_if(DylibResources,
+                         [&](PerDylibResourcesMap::value_type &KV) {
+                           return &KV.second.getImplDylib() == &ImplD;
+                         });
+  if (I == DylibResources.end())
+    return make_error<StringError>("No stubs for implementation dylib " +
+                                       ImplD.getName(),
+                                   inconvertibleErrorCode());
+
+  auto &ISMgr = I->second.getISManager();
+  for (auto &KV : NewAddrs) {
+    if (!ISMgr.findStub(*KV.first, false))
+      continue;
+    if (auto Err = ISMgr.updatePointer(*KV.first, KV.second.getAddress()))
+      return Err;
+  }
+  return Error::success();
+}
+
 CompileOnDemandLayer::PerDylibResources &
 CompileOnDemandLayer::getPerDylibResources(JITDylib &TargetD) {
+  std::lock_guard<std::mutex> Lock(CODLayerMutex);
   auto I = DylibResources.find(&TargetD);
   if (I == DylibResources.end()) {
     auto &ImplD =
@@ -478,6 +478,7 @@ public:
   JITDylibSearchOrder SearchOrder;
   SymbolLookupSet LookupSet;
   SymbolState RequiredState;
+  TaskPriority Priority = TaskPriority::Normal;
 
   std::unique_lock<std::mutex> GeneratorLock;
   size_t CurSearchOrderIndex = 0;
@@ -1725,6 +1726,10 @@ ExecutionSession::ExecutionSession(std::shared_ptr<SymbolStringPool> SSP)
 Error ExecutionSession::endSession() {
   LLVM_DEBUG(dbgs() << "Ending ExecutionSession " << this << "\n");
 
+  // Let in-flight materializations finish before tearing down the JITDylibs
+  // that they are defining symbols in.
+  D->shutdown();
+
   std::vector<JITDylibSP> JITDylibsToClose = runSessionLocked([&] {
     SessionOpen = false;
     return std::move(JDs);
@@ -1860,7 +1865,7 @@ void ExecutionSession::lookup(
     LookupKind K, const JITDylibSearchOrder &SearchOrder,
     SymbolLookupSet Symbols, SymbolState RequiredState,
     SymbolsResolvedCallback NotifyComplete,
-    RegisterDependenciesFunction RegisterDependencies) {
+    RegisterDependenciesFunction RegisterDependencies, TaskPriority Priority) {
 
   LLVM_DEBUG({
     runSessionLocked([&]() {
@@ -1881,6 +1886,7 @@ void ExecutionSession::lookup(
   auto IPLS = std::make_unique<InProgressFullLookupState>(
       K, SearchOrder, std::move(Unresolved), RequiredState, std::move(Q),
       std::move(RegisterDependencies));
+  IPLS->Priority = Priority;
 
   OL_applyQueryPhase1(std::move(IPLS), Error::success());
 }
@@ -1972,11 +1978,30 @@ void ExecutionSession::dump(raw_ostream &OS) {
   });
 }
 
+void ExecutionSession::dispatchMaterialization(
+    std::unique_ptr<MaterializationUnit> MU,
+    std::unique_ptr<MaterializationResponsibility> MR, TaskPriority Priority) {
+  assert(MU && "MU must be non-null");
+  DEBUG_WITH_TYPE("orc", dumpDispatchInfo(MR->getTargetJITDylib(), *MU));
+
+  if (DispatchMaterialization) {
+    DispatchMaterialization(std::move(MU), std::move(MR));
+    return;
+  }
+
+  D->dispatch(
+      [MU = std::move(MU), MR = std::move(MR)]() mutable {
+        MU->materialize(std::move(MR));
+      },
+      Priority);
+}
+
 void ExecutionSession::dispatchOutstandingMUs() {
   LLVM_DEBUG(dbgs() << "Dispatching MaterializationUnits...\n");
   while (1) {
-    Optional<std::pair<std::unique_ptr<MaterializationUnit>,
-                       std::unique_ptr<MaterializationResponsibility>>>
+    Optional<std::tuple<std::unique_ptr<MaterializationUnit>,
+                        std::unique_ptr<MaterializationResponsibility>,
+                        TaskPriority>>
         JMU;
 
     {
@@ -1990,9 +2015,11 @@ void ExecutionSession::dispatchOutstandingMUs() {
     if (!JMU)
       break;
 
-    assert(JMU->first && "No MU?");
-    LLVM_DEBUG(dbgs() << "  Dispatching \"" << JMU->first->getName() << "\"\n");
-    dispatchMaterialization(std::move(JMU->first), std::move(JMU->second));
+    auto &MU = std::get<0>(*JMU);
+    assert(MU && "No MU?");
+    LLVM_DEBUG(dbgs() << "  Dispatching \"" << MU->getName() << "\"\n");
+    dispatchMaterialization(std::move(MU), std::move(std::get<1>(*JMU)),
+                            std::get<2>(*JMU));
   }
   LLVM_DEBUG(dbgs() << "Done dispatching MaterializationUnits.\n");
 }
@@ -2492,8 +2519,8 @@ void ExecutionSession::OL_completeLookup(
                   &JD, std::move(UMI->MU->SymbolFlags),
                   std::move(UMI->MU->InitSymbol)));
           JD.MRTrackers[MR.get()] = UMI->RT;
-          OutstandingMUs.push_back(
-              std::make_pair(std::move(UMI->MU), std::move(MR)));
+          OutstandingMUs.push_back(std::make_tuple(
+              std::move(UMI->MU), std::move(MR), IPLS->Priority));
         }
       }
     } else
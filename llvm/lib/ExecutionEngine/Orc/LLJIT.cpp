@@ -973,8 +973,6 @@ Error LLJITBuilderState::prepareForConstruction() {
 }
 
 LLJIT::~LLJIT() {
-  if (CompileThreads)
-    CompileThreads->wait();
   if (auto Err = ES->endSession())
     ES->reportError(std::move(Err));
 }
@@ -1045,13 +1043,13 @@ LLJIT::createCompileFunction(LLJITBuilderState &S,
   // Otherwise default to creating a SimpleCompiler, or ConcurrentIRCompiler,
   // depending on the number of threads requested.
   if (S.NumCompileThreads > 0)
-    return std::make_unique<ConcurrentIRCompiler>(std::move(JTMB));
+    return std::make_unique<ConcurrentIRCompiler>(std::move(JTMB), S.ObjCache);
 
   auto TM = JTMB.createTargetMachine();
   if (!TM)
     return TM.takeError();
 
-  return std::make_unique<TMOwningSimpleCompiler>(std::move(*TM));
+  return std::make_unique<TMOwningSimpleCompiler>(std::move(*TM), S.ObjCache);
 }
 
 LLJIT::LLJIT(LLJITBuilderState &S, Error &Err)
@@ -1093,22 +1091,8 @@ LLJIT::LLJIT(LLJITBuilderState &S, Error &Err)
 
   if (S.NumCompileThreads > 0) {
     InitHelperTransformLayer->setCloneToNewContextOnEmit(true);
-    CompileThreads =
-        std::make_unique<ThreadPool>(hardware_concurrency(S.NumCompileThreads));
-    ES->setDispatchMaterialization(
-        [this](std::unique_ptr<MaterializationUnit> MU,
-               std::unique_ptr<MaterializationResponsibility> MR) {
-          // FIXME: We should be able to use move-capture here, but ThreadPool's
-          // AsyncTaskTys are std::functions rather than unique_functions
-          // (because MSVC's std::packaged_tasks don't support move-only types).
-          // Fix this when all the above gets sorted out.
-          CompileThreads->async(
-              [UnownedMU = MU.release(), UnownedMR = MR.release()]() mutable {
-                std::unique_ptr<MaterializationUnit> MU(UnownedMU);
-                std::unique_ptr<MaterializationResponsibility> MR(UnownedMR);
-                MU->materialize(std::move(MR));
-              });
-        });
+    ES->setTaskDispatcher(std::make_unique<ThreadPoolTaskDispatcher>(
+        hardware_concurrency(S.NumCompileThreads)));
   }
 
   if (S.SetUpPlatform)
@@ -1159,6 +1143,14 @@ Error LLLazyJITBuilderState::prepareForConstruction() {
   if (auto Err = LLJITBuilderState::prepareForConstruction())
     return Err;
   TT = JTMB->getTargetTriple();
+  if (TierUpThreshold > 0 && !CreateCompileFunction) {
+    ObjectCache *TieredObjCache = ObjCache;
+    CreateCompileFunction = [TieredObjCache](JITTargetMachineBuilder JTMB)
+        -> Expected<std::unique_ptr<IRCompileLayer::IRCompiler>> {
+      return std::make_unique<TieredIRCompiler>(std::move(JTMB),
+                                                TieredObjCache);
+    };
+  }
   return Error::success();
 }
 
@@ -1209,9 +1201,22 @@ LLLazyJIT::LLLazyJIT(LLLazyJITBuilderState &S, Error &Err) : LLJIT(S, Err) {
     return;
   }
 
+  // If tiering is enabled, put the tiering layer under the COD layer so that
+  // it sees each partition, and let it tier up through the COD layer's stubs.
+  IRLayer *CODBaseLayer = InitHelperTransformLayer.get();
+  if (S.TierUpThreshold > 0) {
+    TieringLayer = std::make_unique<IRTieringLayer>(
+        *ES, *InitHelperTransformLayer,
+        [this](JITDylib &ImplJD, const SymbolMap &NewAddrs) {
+          return CODLayer->redirectStubs(ImplJD, NewAddrs);
+        },
+        S.TierUpThreshold);
+    CODBaseLayer = TieringLayer.get();
+  }
+
   // Create the COD layer.
   CODLayer = std::make_unique<CompileOnDemandLayer>(
-      *ES, *InitHelperTransformLayer, *LCTMgr, std::move(ISMBuilder));
+      *ES, *CODBaseLayer, *LCTMgr, std::move(ISMBuilder));
 
   if (S.NumCompileThreads > 0)
     CODLayer->setCloneToNewContextOnEmit(true);
@@ -0,0 +1,133 @@
+//===--- PersistentObjectCache.cpp - On-disk cache of JIT'd objects -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/PersistentObjectCache.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace llvm {
+namespace orc {
+
+Expected<std::unique_ptr<PersistentObjectCache>>
+PersistentObjectCache::Create(StringRef Directory,
+                              const JITTargetMachineBuilder &JTMB,
+                              CachePruningPolicy Policy) {
+  if (std::error_code EC = sys::fs::create_directories(Directory))
+    return errorCodeToError(EC);
+
+  std::string TargetKey;
+  {
+    raw_string_ostream OS(TargetKey);
+    OS << JTMB.getTargetTriple().str() << '\0' << JTMB.getCPU() << '\0'
+       << JTMB.getFeatures().getString() << '\0'
+       << static_cast<int>(JTMB.getCodeGenOptLevel()) << '\0';
+    if (auto &RM = JTMB.getRelocationModel())
+      OS << static_cast<int>(*RM);
+    OS << '\0';
+    if (auto &CM = JTMB.getCodeModel())
+      OS << static_cast<int>(*CM);
+    OS << '\0';
+  }
+
+  pruneCache(Directory, Policy);
+
+  return std::unique_ptr<PersistentObjectCache>(new PersistentObjectCache(
+      Directory.str(), std::move(TargetKey), std::move(Policy)));
+}
+
+std::string PersistentObjectCache::getEntryPath(const Module &M) {
+  SmallVector<char, 0> Bitcode;
+  {
+    raw_svector_ostream OS(Bitcode);
+    WriteBitcodeToFile(M, OS);
+  }
+
+  SHA1 Hasher;
+  Hasher.update(TargetKey);
+  Hasher.update(ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t *>(Bitcode.data()), Bitcode.size()));
+
+  // This choice of file name allows the cache to be pruned (see pruneCache()
+  // in include/llvm/Support/CachePruning.h).
+  SmallString<128> EntryPath;
+  sys::path::append(EntryPath, Directory,
+                    "llvmcache-" + toHex(Hasher.result()));
+  return std::string(EntryPath.str());
+}
+
+std::unique_ptr<MemoryBuffer>
+PersistentObjectCache::getObject(const Module *M) {
+  std::string EntryPath = getEntryPath(*M);
+
+  // Open with OF_UpdateAtime so that pruning evicts the least recently used
+  // entries first.
+  Expected<sys::fs::file_t> FDOrErr = sys::fs::openNativeFileForRead(
+      Twine(EntryPath), sys::fs::OF_UpdateAtime);
+  if (FDOrErr) {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> MBOrErr =
+        MemoryBuffer::getOpenFile(*FDOrErr, EntryPath, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+    sys::fs::closeFile(*FDOrErr);
+    if (MBOrErr)
+      return std::move(*MBOrErr);
+  } else
+    consumeError(FDOrErr.takeError());
+
+  // A missing or unreadable entry is a miss; remember where the object for M
+  // should go once it has been compiled.
+  std::lock_guard<std::mutex> Lock(PendingEntriesMutex);
+  PendingEntries[M] = std::move(EntryPath);
+  return nullptr;
+}
+
+void PersistentObjectCache::notifyObjectCompiled(const Module *M,
+                                                 MemoryBufferRef Obj) {
+  std::string EntryPath;
+  {
+    std::lock_guard<std::mutex> Lock(PendingEntriesMutex);
+    auto I = PendingEntries.find(M);
+    if (I == PendingEntries.end())
+      return;
+    EntryPath = std::move(I->second);
+    PendingEntries.erase(I);
+  }
+
+  // Write the object to a temporary file and rename it into place, so that
+  // other processes never see a partially written entry. Failing to store an
+  // entry only costs a later recompile.
+  SmallString<128> TempFilenameModel;
+  sys::path::append(TempFilenameModel, Directory, "orc-%%%%%%.tmp.o");
+  Expected<sys::fs::TempFile> Temp = sys::fs::TempFile::create(
+      TempFilenameModel, sys::fs::owner_read | sys::fs::owner_write);
+  if (!Temp) {
+    consumeError(Temp.takeError());
+    return;
+  }
+  {
+    raw_fd_ostream OS(Temp->FD, /*shouldClose=*/false);
+    OS << Obj.getBuffer();
+  }
+  if (Error Err = Temp->keep(EntryPath)) {
+    consumeError(std::move(Err));
+    consumeError(Temp->discard());
+    return;
+  }
+  recordCacheFileAdded(Directory, Obj.getBufferSize());
+}
+
+void PersistentObjectCache::prune() { pruneCache(Directory, Policy); }
+
+} // end namespace orc
+} // end namespace llvm
@@ -0,0 +1,32 @@
+//===------------ TaskDispatch.cpp - ORC task dispatch utils --------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/TaskDispatch.h"
+
+namespace llvm {
+namespace orc {
+
+TaskDispatcher::~TaskDispatcher() {}
+
+void InPlaceTaskDispatcher::dispatch(Task T, TaskPriority Priority) { T(); }
+
+void InPlaceTaskDispatcher::shutdown() {}
+
+void ThreadPoolTaskDispatcher::dispatch(Task T, TaskPriority Priority) {
+  // ThreadPool tasks are std::functions, which must be copyable, so hand the
+  // task over through a shared_ptr.
+  auto SharedT = std::make_shared<Task>(std::move(T));
+  ThreadPool::TaskOptions Opts;
+  Opts.Priority = Priority == TaskPriority::Normal ? 1 : 0;
+  Pool.schedule([SharedT]() { (*SharedT)(); }, Opts);
+}
+
+void ThreadPoolTaskDispatcher::shutdown() { Pool.wait(); }
+
+} // End namespace orc
+} // End namespace llvm
@@ -0,0 +1,252 @@
+//===--- TieredCompilation.cpp - Recompile hot functions ------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/TieredCompilation.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ExecutionEngine/Orc/CompileUtils.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+
+#define DEBUG_TYPE "orc"
+
+namespace llvm {
+namespace orc {
+
+static const char *SecondTierFlag = "orc-second-tier";
+
+IRTieringLayer::IRTieringLayer(ExecutionSession &ES, IRLayer &BaseLayer,
+                               RedirectFunction Redirect,
+                               uint64_t HotThreshold)
+    : IRLayer(ES, BaseLayer.getManglingOptions()), BaseLayer(BaseLayer),
+      Redirect(std::move(Redirect)), HotThreshold(HotThreshold) {
+  assert(HotThreshold > 0 && "HotThreshold must be at least one");
+}
+
+Error IRTieringLayer::addTieringRuntime(JITDylib &JD, const DataLayout &DL) {
+  {
+    std::lock_guard<std::mutex> Lock(TieringMutex);
+    if (!DylibsWithRuntime.insert(&JD).second)
+      return Error::success();
+  }
+
+  MangleAndInterner Mangle(getExecutionSession(), DL);
+  JITEvaluatedSymbol ThisPtr(pointerToJITTargetAddress(this),
+                             JITSymbolFlags::Exported);
+  JITEvaluatedSymbol TierUpEntryPtr(
+      pointerToJITTargetAddress(&tierUpEntryPoint), JITSymbolFlags::Exported);
+  return JD.define(absoluteSymbols({
+      {Mangle("__orc_tiering_layer"), ThisPtr}, // Data Symbol
+      {Mangle("__orc_tier_up"), TierUpEntryPtr} // Callable Symbol
+  }));
+}
+
+bool IRTieringLayer::isSecondTier(const Module &M) {
+  return M.getModuleFlag(SecondTierFlag) != nullptr;
+}
+
+void IRTieringLayer::emit(std::unique_ptr<MaterializationResponsibility> R,
+                          ThreadSafeModule TSM) {
+  assert(TSM && "Tiering layer received null module");
+
+  SymbolNameVector Callables;
+  for (auto &KV : R->getSymbols())
+    if (KV.second.isCallable())
+      Callables.push_back(KV.first);
+
+  bool CanTierUp =
+      !Callables.empty() && TSM.withModuleDo([](Module &M) {
+        return none_of(M.globals(), [](const GlobalVariable &GV) {
+          return !GV.isDeclaration() && !GV.isConstant();
+        });
+      });
+
+  if (CanTierUp) {
+    auto DL = TSM.withModuleDo([](Module &M) { return M.getDataLayout(); });
+    if (auto Err = addTieringRuntime(R->getTargetJITDylib(), DL)) {
+      getExecutionSession().reportError(std::move(Err));
+      R->failMaterialization();
+      return;
+    }
+
+    TierUpCandidate C;
+    C.FirstTierJD = &R->getTargetJITDylib();
+    C.TSM = cloneToNewContext(TSM);
+    C.Callables = std::move(Callables);
+
+    uint64_t CandidateId;
+    {
+      std::lock_guard<std::mutex> Lock(TieringMutex);
+      CandidateId = Candidates.size();
+      Candidates.push_back(std::move(C));
+    }
+
+    TSM.withModuleDo([&](Module &M) { instrument(M, CandidateId); });
+    assert(!TSM.withModuleDo([](const Module &M) { return verifyModule(M); }) &&
+           "Tiering instrumentation breaks IR?");
+  }
+
+  BaseLayer.emit(std::move(R), std::move(TSM));
+}
+
+void IRTieringLayer::tierUpEntryPoint(IRTieringLayer *Layer,
+                                      uint64_t CandidateId) {
+  assert(Layer && "Null address received in __orc_tier_up");
+  Layer->tierUp(CandidateId);
+}
+
+void IRTieringLayer::instrument(Module &M, uint64_t CandidateId) {
+  auto &Ctx = M.getContext();
+  auto *Int64Ty = Type::getInt64Ty(Ctx);
+  auto *LayerTy = StructType::create(Ctx, "Class.IRTieringLayer");
+  auto *TierUpTy = FunctionType::get(Type::getVoidTy(Ctx),
+                                     {LayerTy->getPointerTo(), Int64Ty}, false);
+  auto *TierUp = Function::Create(TierUpTy, GlobalValue::ExternalLinkage,
+                                  "__orc_tier_up", &M);
+  auto *LayerAddr =
+      new GlobalVariable(M, LayerTy, false, GlobalValue::ExternalLinkage,
+                         nullptr, "__orc_tiering_layer");
+
+  for (auto &F : M.functions()) {
+    if (F.isDeclaration() || F.hasLocalLinkage())
+      continue;
+
+    auto *Counter = new GlobalVariable(
+        M, Int64Ty, false, GlobalValue::InternalLinkage,
+        ConstantInt::get(Int64Ty, 0), "__orc_tier.count." + F.getName());
+
+    // Count the call after the entry block's static allocas, so that they stay
+    // in the entry block. Exactly one caller sees the count reach the
+    // threshold.
+    BasicBlock::iterator InsertPt = F.getEntryBlock().getFirstInsertionPt();
+    while (isa<AllocaInst>(*InsertPt))
+      ++InsertPt;
+    IRBuilder<> B(&*InsertPt);
+    auto *OldCount = B.CreateAtomicRMW(AtomicRMWInst::Add, Counter,
+                                       ConstantInt::get(Int64Ty, 1),
+                                       AtomicOrdering::Monotonic);
+    auto *IsHot =
+        B.CreateICmpEQ(OldCount, ConstantInt::get(Int64Ty, HotThreshold - 1));
+    IRBuilder<> HotB(SplitBlockAndInsertIfThen(IsHot, &*InsertPt, false));
+    HotB.CreateCall(TierUpTy, TierUp,
+                    {LayerAddr, ConstantInt::get(Int64Ty, CandidateId)});
+  }
+}
+
+void IRTieringLayer::tierUp(uint64_t CandidateId) {
+  TierUpCandidate C;
+  {
+    std::lock_guard<std::mutex> Lock(TieringMutex);
+    assert(CandidateId < Candidates.size() && "Unknown tier-up candidate");
+    // Every function of a module counts its own calls, so the module may be
+    // reported hot more than once.
+    if (!Candidates[CandidateId].TSM)
+      return;
+    C = std::move(Candidates[CandidateId]);
+    Candidates[CandidateId] = TierUpCandidate();
+  }
+
+  LLVM_DEBUG({
+    dbgs() << "Tiering up " << C.Callables.size() << " function(s) in "
+           << C.FirstTierJD->getName() << "\n";
+  });
+
+  getExecutionSession().getTaskDispatcher().dispatch(
+      [this, C = std::move(C)]() mutable { emitSecondTier(std::move(C)); },
+      TaskPriority::Speculative);
+}
+
+void IRTieringLayer::emitSecondTier(TierUpCandidate C) {
+  auto &ES = getExecutionSession();
+  JITDylib &SecondTierJD = getSecondTierDylib(*C.FirstTierJD);
+
+  C.TSM.withModuleDo([](Module &M) {
+    M.addModuleFlag(Module::Warning, SecondTierFlag, 1);
+  });
+  if (auto Err = BaseLayer.add(SecondTierJD, std::move(C.TSM))) {
+    ES.reportError(std::move(Err));
+    return;
+  }
+
+  SymbolLookupSet Symbols(C.Callables);
+  JITDylib *FirstTierJD = C.FirstTierJD;
+  ES.lookup(
+      LookupKind::Static,
+      makeJITDylibSearchOrder(&SecondTierJD,
+                              JITDylibLookupFlags::MatchAllSymbols),
+      std::move(Symbols), SymbolState::Ready,
+      [this, FirstTierJD](Expected<SymbolMap> Result) {
+        auto &ES = getExecutionSession();
+        if (!Result) {
+          ES.reportError(Result.takeError());
+          return;
+        }
+        if (auto Err = Redirect(*FirstTierJD, *Result))
+          ES.reportError(std::move(Err));
+      },
+      NoDependenciesToRegister, TaskPriority::Speculative);
+}
+
+JITDylib &IRTieringLayer::getSecondTierDylib(JITDylib &FirstTierJD) {
+  std::lock_guard<std::mutex> Lock(TieringMutex);
+  auto I = SecondTierDylibs.find(&FirstTierJD);
+  if (I != SecondTierDylibs.end())
+    return *I->second;
+
+  // Search the second tier dylib first, so that hot functions call each other
+  // directly, then everything the first tier dylib links against.
+  auto &SecondTierJD = getExecutionSession().createBareJITDylib(
+      FirstTierJD.getName() + ".tier2");
+  FirstTierJD.withLinkOrderDo([&](const JITDylibSearchOrder &LinkOrder) {
+    SecondTierJD.setLinkOrder(LinkOrder);
+  });
+  SecondTierDylibs[&FirstTierJD] = &SecondTierJD;
+  return SecondTierJD;
+}
+
+TieredIRCompiler::TieredIRCompiler(JITTargetMachineBuilder JTMB,
+                                   ObjectCache *ObjCache)
+    : IRCompiler(irManglingOptionsFromTargetOptions(JTMB.getOptions())),
+      JTMB(std::move(JTMB)), ObjCache(ObjCache) {}
+
+Expected<std::unique_ptr<MemoryBuffer>>
+TieredIRCompiler::operator()(Module &M) {
+  bool SecondTier = IRTieringLayer::isSecondTier(M);
+
+  JITTargetMachineBuilder TierJTMB = JTMB;
+  if (!SecondTier)
+    TierJTMB.setCodeGenOptLevel(CodeGenOpt::None);
+  auto TM = TierJTMB.createTargetMachine();
+  if (!TM)
+    return TM.takeError();
+
+  if (SecondTier) {
+    PassBuilder PB(/*DebugLogging=*/false, TM->get());
+    LoopAnalysisManager LAM;
+    FunctionAnalysisManager FAM;
+    CGSCCAnalysisManager CGAM;
+    ModuleAnalysisManager MAM;
+    PB.registerModuleAnalyses(MAM);
+    PB.registerCGSCCAnalyses(CGAM);
+    PB.registerFunctionAnalyses(FAM);
+    PB.registerLoopAnalyses(LAM);
+    PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+    PB.buildPerModuleDefaultPipeline(PassBuilder::OptimizationLevel::O2)
+        .run(M, MAM);
+  }
+
+  SimpleCompiler C(**TM, ObjCache);
+  return C(M);
+}
+
+} // end namespace orc
+} // end namespace llvm
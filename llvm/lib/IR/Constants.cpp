@@ -803,6 +803,7 @@ ConstantInt::ConstantInt(IntegerType *Ty, const APInt &V)
 
 ConstantInt *ConstantInt::getTrue(LLVMContext &Context) {
   LLVMContextImpl *pImpl = Context.pImpl;
+  UniquingLock Lock(pImpl->ConstantsMutex);
   if (!pImpl->TheTrueVal)
     pImpl->TheTrueVal = ConstantInt::get(Type::getInt1Ty(Context), 1);
   return pImpl->TheTrueVal;
@@ -810,6 +811,7 @@ ConstantInt *ConstantInt::getTrue(LLVMContext &Context) {
 
 ConstantInt *ConstantInt::getFalse(LLVMContext &Context) {
   LLVMContextImpl *pImpl = Context.pImpl;
+  UniquingLock Lock(pImpl->ConstantsMutex);
   if (!pImpl->TheFalseVal)
     pImpl->TheFalseVal = ConstantInt::get(Type::getInt1Ty(Context), 0);
   return pImpl->TheFalseVal;
@@ -835,6 +837,7 @@ Constant *ConstantInt::getFalse(Type *Ty) {
 ConstantInt *ConstantInt::get(LLVMContext &Context, const APInt &V) {
   // get an existing value or the insertion position
   LLVMContextImpl *pImpl = Context.pImpl;
+  UniquingLock Lock(pImpl->ConstantsMutex);
   std::unique_ptr<ConstantInt> &Slot = pImpl->IntConstants[V];
   if (!Slot) {
     // Get the corresponding integer type for the bit width of the value.
@@ -990,6 +993,7 @@ Constant *ConstantFP::getZeroValueForNegation(Type *Ty) {
 ConstantFP* ConstantFP::get(LLVMContext &Context, const APFloat& V) {
   LLVMContextImpl* pImpl = Context.pImpl;
 
+  UniquingLock Lock(pImpl->ConstantsMutex);
   std::unique_ptr<ConstantFP> &Slot = pImpl->FPConstants[V];
 
   if (!Slot) {
@@ -1376,6 +1380,7 @@ Constant *ConstantVector::getSplat(ElementCount EC, Constant *V) {
 
 ConstantTokenNone *ConstantTokenNone::get(LLVMContext &Context) {
   LLVMContextImpl *pImpl = Context.pImpl;
+  UniquingLock Lock(pImpl->ConstantsMutex);
   if (!pImpl->TheNoneToken)
     pImpl->TheNoneToken.reset(new ConstantTokenNone(Context));
   return pImpl->TheNoneToken.get();
@@ -1600,6 +1605,7 @@ ConstantAggregateZero *ConstantAggregateZero::get(Type *Ty) {
   assert((Ty->isStructTy() || Ty->isArrayTy() || Ty->isVectorTy()) &&
          "Cannot create an aggregate zero of non-aggregate type!");
 
+  UniquingLock Lock(Ty->getContext().pImpl->ConstantsMutex);
   std::unique_ptr<ConstantAggregateZero> &Entry =
       Ty->getContext().pImpl->CAZConstants[Ty];
   if (!Entry)
@@ -1610,6 +1616,7 @@ ConstantAggregateZero *ConstantAggregateZero::get(Type *Ty) {
 
 /// Remove the constant from the constant table.
 void ConstantAggregateZero::destroyConstantImpl() {
+  UniquingLock Lock(getContext().pImpl->ConstantsMutex);
   getContext().pImpl->CAZConstants.erase(getType());
 }
 
@@ -1704,6 +1711,7 @@ const APInt &Constant::getUniqueInteger() const {
 //
 
 ConstantPointerNull *ConstantPointerNull::get(PointerType *Ty) {
+  UniquingLock Lock(Ty->getContext().pImpl->ConstantsMutex);
   std::unique_ptr<ConstantPointerNull> &Entry =
       Ty->getContext().pImpl->CPNConstants[Ty];
   if (!Entry)
@@ -1714,10 +1722,12 @@ ConstantPointerNull *ConstantPointerNull::get(PointerType *Ty) {
 
 /// Remove the constant from the constant table.
 void ConstantPointerNull::destroyConstantImpl() {
+  UniquingLock Lock(getContext().pImpl->ConstantsMutex);
   getContext().pImpl->CPNConstants.erase(getType());
 }
 
 UndefValue *UndefValue::get(Type *Ty) {
+  UniquingLock Lock(Ty->getContext().pImpl->ConstantsMutex);
   std::unique_ptr<UndefValue> &Entry = Ty->getContext().pImpl->UVConstants[Ty];
   if (!Entry)
     Entry.reset(new UndefValue(Ty));
@@ -1728,6 +1738,7 @@ UndefValue *UndefValue::get(Type *Ty) {
 /// Remove the constant from the constant table.
 void UndefValue::destroyConstantImpl() {
   // Free the constant and any dangling references to it.
+  UniquingLock Lock(getContext().pImpl->ConstantsMutex);
   if (getValueID() == UndefValueVal) {
     getContext().pImpl->UVConstants.erase(getType());
   } else if (getValueID() == PoisonValueVal) {
@@ -1737,6 +1748,7 @@ void UndefValue::destroyConstantImpl() {
 }
 
 PoisonValue *PoisonValue::get(Type *Ty) {
+  UniquingLock Lock(Ty->getContext().pImpl->ConstantsMutex);
   std::unique_ptr<PoisonValue> &Entry = Ty->getContext().pImpl->PVConstants[Ty];
   if (!Entry)
     Entry.reset(new PoisonValue(Ty));
@@ -1747,6 +1759,7 @@ PoisonValue *PoisonValue::get(Type *Ty) {
 /// Remove the constant from the constant table.
 void PoisonValue::destroyConstantImpl() {
   // Free the constant and any dangling references to it.
+  UniquingLock Lock(getContext().pImpl->ConstantsMutex);
   getContext().pImpl->PVConstants.erase(getType());
 }
 
@@ -1756,6 +1769,7 @@ BlockAddress *BlockAddress::get(BasicBlock *BB) {
 }
 
 BlockAddress *BlockAddress::get(Function *F, BasicBlock *BB) {
+  UniquingLock Lock(F->getContext().pImpl->ConstantsMutex);
   BlockAddress *&BA =
     F->getContext().pImpl->BlockAddresses[std::make_pair(F, BB)];
   if (!BA)
@@ -1779,6 +1793,7 @@ BlockAddress *BlockAddress::lookup(const BasicBlock *BB) {
 
   const Function *F = BB->getParent();
   assert(F && "Block must have a parent");
+  UniquingLock Lock(F->getContext().pImpl->ConstantsMutex);
   BlockAddress *BA =
       F->getContext().pImpl->BlockAddresses.lookup(std::make_pair(F, BB));
   assert(BA && "Refcount and block address map disagree!");
@@ -1787,6 +1802,7 @@ BlockAddress *BlockAddress::lookup(const BasicBlock *BB) {
 
 /// Remove the constant from the constant table.
 void BlockAddress::destroyConstantImpl() {
+  UniquingLock Lock(getContext().pImpl->ConstantsMutex);
   getFunction()->getType()->getContext().pImpl
     ->BlockAddresses.erase(std::make_pair(getFunction(), getBasicBlock()));
   getBasicBlock()->AdjustBlockAddressRefCount(-1);
@@ -1807,6 +1823,7 @@ Value *BlockAddress::handleOperandChangeImpl(Value *From, Value *To) {
 
   // See if the 'new' entry already exists, if not, just update this in place
   // and return early.
+  UniquingLock Lock(getContext().pImpl->ConstantsMutex);
   BlockAddress *&NewBA =
     getContext().pImpl->BlockAddresses[std::make_pair(NewF, NewBB)];
   if (NewBA)
@@ -1829,6 +1846,7 @@ Value *BlockAddress::handleOperandChangeImpl(Value *From, Value *To) {
 }
 
 DSOLocalEquivalent *DSOLocalEquivalent::get(GlobalValue *GV) {
+  UniquingLock Lock(GV->getContext().pImpl->ConstantsMutex);
   DSOLocalEquivalent *&Equiv = GV->getContext().pImpl->DSOLocalEquivalents[GV];
   if (!Equiv)
     Equiv = new DSOLocalEquivalent(GV);
@@ -1846,12 +1864,14 @@ DSOLocalEquivalent::DSOLocalEquivalent(GlobalValue *GV)
 /// Remove the constant from the constant table.
 void DSOLocalEquivalent::destroyConstantImpl() {
   const GlobalValue *GV = getGlobalValue();
+  UniquingLock Lock(GV->getContext().pImpl->ConstantsMutex);
   GV->getContext().pImpl->DSOLocalEquivalents.erase(GV);
 }
 
 Value *DSOLocalEquivalent::handleOperandChangeImpl(Value *From, Value *To) {
   assert(From == getGlobalValue() && "Changing value does not match operand.");
   assert(isa<Constant>(To) && "Can only replace the operands with a constant");
+  UniquingLock Lock(getContext().pImpl->ConstantsMutex);
 
   // The replacement is with another global value.
   if (const auto *ToObj = dyn_cast<GlobalValue>(To)) {
@@ -2891,6 +2911,7 @@ Constant *ConstantDataSequential::getImpl(StringRef Elements, Type *Ty) {
     return ConstantAggregateZero::get(Ty);
 
   // Do a lookup to see if we have already formed one of these.
+  UniquingLock Lock(Ty->getContext().pImpl->ConstantsMutex);
   auto &Slot =
       *Ty->getContext()
            .pImpl->CDSConstants.insert(std::make_pair(Elements, nullptr))
@@ -2921,6 +2942,7 @@ Constant *ConstantDataSequential::getImpl(StringRef Elements, Type *Ty) {
 
 void ConstantDataSequential::destroyConstantImpl() {
   // Remove the constant from the StringMap.
+  UniquingLock Lock(getContext().pImpl->ConstantsMutex);
   StringMap<std::unique_ptr<ConstantDataSequential>> &CDSConstants =
       getType()->getContext().pImpl->CDSConstants;
 
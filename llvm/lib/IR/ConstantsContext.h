@@ -35,6 +35,7 @@
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <mutex>
 #include <utility>
 
 #define DEBUG_TYPE "ir"
@@ -644,6 +645,30 @@ public:
 // removed from all relevant maps.
 void deleteConstant(Constant *C);
 
+/// Guards uniquing tables of the context. It only locks once the context is
+/// set up for concurrent uniquing, so that users that keep to one thread don't
+/// pay for it. Recursive, as some getters call other getters on the same
+/// tables.
+class UniquingMutex {
+  std::recursive_mutex Mutex;
+  bool Enabled = false;
+
+public:
+  /// Only to be changed while no other thread uses the context.
+  void setEnabled(bool Enable) { Enabled = Enable; }
+
+  void lock() {
+    if (Enabled)
+      Mutex.lock();
+  }
+  void unlock() {
+    if (Enabled)
+      Mutex.unlock();
+  }
+};
+
+using UniquingLock = std::lock_guard<UniquingMutex>;
+
 template <class ConstantClass> class ConstantUniqueMap {
 public:
   using ValType = typename ConstantInfo<ConstantClass>::ValType;
@@ -700,8 +725,11 @@ public:
 
 private:
   MapTy Map;
+  UniquingMutex Mutex;
 
 public:
+  void setConcurrent(bool Enable) { Mutex.setEnabled(Enable); }
+
   typename MapTy::iterator begin() { return Map.begin(); }
   typename MapTy::iterator end() { return Map.end(); }
 
@@ -729,6 +757,7 @@ public:
 
     ConstantClass *Result = nullptr;
 
+    UniquingLock Lock(Mutex);
     auto I = Map.find_as(Lookup);
     if (I == Map.end())
       Result = create(Ty, V, Lookup);
@@ -741,6 +770,7 @@ public:
 
   /// Remove this constant from the map
   void remove(ConstantClass *CP) {
+    UniquingLock Lock(Mutex);
     typename MapTy::iterator I = Map.find(CP);
     assert(I != Map.end() && "Constant not found in constant table!");
     assert(*I == CP && "Didn't find correct element?");
@@ -755,6 +785,7 @@ public:
     /// Hash once, and reuse it for the lookup and the insertion if needed.
     LookupKeyHashed Lookup(MapInfo::getHashValue(Key), Key);
 
+    UniquingLock Lock(Mutex);
     auto ItMap = Map.find_as(Lookup);
     if (ItMap != Map.end())
       return *ItMap;
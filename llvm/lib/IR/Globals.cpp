@@ -195,8 +195,11 @@ void GlobalValue::setPartition(StringRef S) {
 
   // Get or create a stable partition name string and put it in the table in the
   // context.
-  if (!S.empty())
+  if (!S.empty()) {
+    // The strings are allocated along with the types.
+    UniquingLock Lock(getContext().pImpl->TypesMutex);
     S = getContext().pImpl->Saver.save(S);
+  }
   getContext().pImpl->GlobalValuePartitions[this] = S;
 
   // Update the HasPartition field. Setting the partition to the empty string
@@ -216,8 +219,11 @@ void GlobalObject::setSection(StringRef S) {
 
   // Get or create a stable section name string and put it in the table in the
   // context.
-  if (!S.empty())
+  if (!S.empty()) {
+    // The strings are allocated along with the types.
+    UniquingLock Lock(getContext().pImpl->TypesMutex);
     S = getContext().pImpl->Saver.save(S);
+  }
   getContext().pImpl->GlobalObjectSections[this] = S;
 
   // Update the HasSectionHashEntryBit. Setting the section to the empty string
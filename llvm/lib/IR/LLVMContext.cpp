@@ -272,6 +272,7 @@ void LLVMContext::emitError(unsigned LocCookie, const Twine &ErrorStr) {
 
 /// Return a unique non-zero ID for the specified metadata kind.
 unsigned LLVMContext::getMDKindID(StringRef Name) const {
+  UniquingLock Lock(pImpl->ValuesMutex);
   // If this is new, assign it its ID.
   return pImpl->CustomMDKindNames.insert(
                                      std::make_pair(
@@ -346,10 +347,25 @@ void LLVMContext::setDiscardValueNames(bool Discard) {
   pImpl->DiscardValueNames = Discard;
 }
 
+bool LLVMContext::hasConcurrentUniquing() const {
+  return pImpl->ConcurrentUniquing;
+}
+
+void LLVMContext::setConcurrentUniquing(bool Enable) {
+  pImpl->setConcurrentUniquing(Enable);
+}
+
 OptPassGate &LLVMContext::getOptPassGate() const {
   return pImpl->getOptPassGate();
 }
 
+LLVMContext::ArenaScope::ArenaScope(LLVMContext &C)
+    : Previous(IRArena::getActive()) {
+  IRArena::setActive(&C.pImpl->Arena);
+}
+
+LLVMContext::ArenaScope::~ArenaScope() { IRArena::setActive(Previous); }
+
 void LLVMContext::setOptPassGate(OptPassGate& OPG) {
   pImpl->setOptPassGate(OPG);
 }
@@ -21,6 +21,41 @@
 
 using namespace llvm;
 
+static LLVM_THREAD_LOCAL IRArena *ActiveArena = nullptr;
+
+IRArena *IRArena::getActive() { return ActiveArena; }
+
+void IRArena::setActive(IRArena *Arena) { ActiveArena = Arena; }
+
+void *IRArena::allocate(IRArena *Arena, size_t Size) {
+  if (!Arena)
+    return ::operator new(Size);
+  size_t SizeClass = divideCeil(Size, Granule);
+  Header *H;
+  if (SizeClass >= NumSizeClasses) {
+    H = static_cast<Header *>(::operator new(sizeof(Header) + Size));
+  } else if (void *Free = Arena->FreeLists[SizeClass]) {
+    H = static_cast<Header *>(Free) - 1;
+    Arena->FreeLists[SizeClass] = *static_cast<void **>(Free);
+  } else {
+    H = static_cast<Header *>(Arena->Alloc.Allocate(
+        sizeof(Header) + SizeClass * Granule, Align(Granule)));
+  }
+  H->Arena = Arena;
+  H->SizeClass = SizeClass;
+  return H + 1;
+}
+
+void IRArena::deallocate(void *Ptr, bool InArena) {
+  if (!InArena)
+    return ::operator delete(Ptr);
+  Header *H = static_cast<Header *>(Ptr) - 1;
+  if (H->SizeClass >= NumSizeClasses)
+    return ::operator delete(H);
+  *static_cast<void **>(Ptr) = H->Arena->FreeLists[H->SizeClass];
+  H->Arena->FreeLists[H->SizeClass] = Ptr;
+}
+
 LLVMContextImpl::LLVMContextImpl(LLVMContext &C)
   : DiagHandler(std::make_unique<DiagnosticHandler>()),
     VoidTy(C, Type::VoidTyID),
@@ -43,6 +78,9 @@ LLVMContextImpl::LLVMContextImpl(LLVMContext &C)
     Int128Ty(C, 128) {}
 
 LLVMContextImpl::~LLVMContextImpl() {
+  // Keep the count of concurrent contexts right.
+  setConcurrentUniquing(false);
+
   // NOTE: We need to delete the contents of OwnedModules, but Module's dtor
   // will call LLVMContextImpl::removeModule, thus invalidating iterators into
   // the container. Avoid iterators during this operation:
@@ -189,6 +227,7 @@ unsigned MDNodeOpsKey::calculateHash(ArrayRef<Metadata *> Ops) {
 }
 
 StringMapEntry<uint32_t> *LLVMContextImpl::getOrInsertBundleTag(StringRef Tag) {
+  UniquingLock Lock(ValuesMutex);
   uint32_t NewIdx = BundleTagCache.size();
   return &*(BundleTagCache.insert(std::make_pair(Tag, NewIdx)).first);
 }
@@ -200,12 +239,14 @@ void LLVMContextImpl::getOperandBundleTags(SmallVectorImpl<StringRef> &Tags) con
 }
 
 uint32_t LLVMContextImpl::getOperandBundleTagID(StringRef Tag) const {
+  UniquingLock Lock(ValuesMutex);
   auto I = BundleTagCache.find(Tag);
   assert(I != BundleTagCache.end() && "Unknown tag!");
   return I->second;
 }
 
 SyncScope::ID LLVMContextImpl::getOrInsertSyncScopeID(StringRef SSN) {
+  UniquingLock Lock(ValuesMutex);
   auto NewSSID = SSC.size();
   assert(NewSSID < std::numeric_limits<SyncScope::ID>::max() &&
          "Hit the maximum number of synchronization scopes allowed!");
@@ -241,3 +282,22 @@ OptPassGate &LLVMContextImpl::getOptPassGate() const {
 void LLVMContextImpl::setOptPassGate(OptPassGate& OPG) {
   this->OPG = &OPG;
 }
+
+void LLVMContextImpl::setConcurrentUniquing(bool Enable) {
+  if (Enable == ConcurrentUniquing)
+    return;
+  ConcurrentUniquing = Enable;
+  if (Enable)
+    ++Use::NumConcurrentContexts;
+  else
+    --Use::NumConcurrentContexts;
+  ValuesMutex.setEnabled(Enable);
+  ConstantsMutex.setEnabled(Enable);
+  TypesMutex.setEnabled(Enable);
+  MetadataMutex.setEnabled(Enable);
+  ArrayConstants.setConcurrent(Enable);
+  StructConstants.setConcurrent(Enable);
+  VectorConstants.setConcurrent(Enable);
+  ExprConstants.setConcurrent(Enable);
+  InlineAsms.setConcurrent(Enable);
+}
@@ -1306,8 +1306,41 @@ public:
   }
 };
 
+/// The allocator of the IR created in an LLVMContext::ArenaScope.
+///
+/// Each block is prefixed with its arena and size class, so that it can be
+/// freed knowing only that it comes from an arena. Freed blocks are put on a
+/// free list per size class, the largest blocks come from the heap.
+class IRArena {
+public:
+  /// Returns the arena of the innermost ArenaScope of this thread, if any.
+  static IRArena *getActive();
+  static void setActive(IRArena *Arena);
+
+  /// Allocates \p Size bytes from \p Arena if non-null, or the heap otherwise.
+  static void *allocate(IRArena *Arena, size_t Size);
+  /// Frees the memory returned by allocate(), \p InArena tells whether it was
+  /// given an arena.
+  static void deallocate(void *Ptr, bool InArena);
+
+private:
+  struct alignas(16) Header {
+    IRArena *Arena;
+    size_t SizeClass;
+  };
+  static constexpr size_t Granule = alignof(Header);
+  static constexpr size_t NumSizeClasses = 64;
+
+  BumpPtrAllocator Alloc;
+  void *FreeLists[NumSizeClasses] = {};
+};
+
 class LLVMContextImpl {
 public:
+  /// The arena of the ArenaScopes. It comes first to be destroyed last, after
+  /// the IR it may hold.
+  IRArena Arena;
+
   /// OwnedModules - The set of modules instantiated in this context, and which
   /// will be automatically deleted if this context is deleted.
   SmallPtrSet<Module*, 4> OwnedModules;
@@ -1349,6 +1382,10 @@ public:
   LLVMContext::YieldCallbackTy YieldCallback = nullptr;
   void *YieldOpaqueHandle = nullptr;
 
+  /// Guards the tables of constants, other than the ConstantUniqueMaps which
+  /// have their own.
+  UniquingMutex ConstantsMutex;
+
   using IntMapTy =
       DenseMap<APInt, std::unique_ptr<ConstantInt>, DenseMapAPIntKeyInfo>;
   IntMapTy IntConstants;
@@ -1357,14 +1394,23 @@ public:
       DenseMap<APFloat, std::unique_ptr<ConstantFP>, DenseMapAPFloatKeyInfo>;
   FPMapTy FPConstants;
 
+  // Attributes are allocated from Alloc, so TypesMutex guards these as well.
   FoldingSet<AttributeImpl> AttrsSet;
   FoldingSet<AttributeListImpl> AttrsLists;
   FoldingSet<AttributeSetNode> AttrsSetNodes;
 
+  /// Guards the tables of metadata below.
+  UniquingMutex MetadataMutex;
+
   StringMap<MDString, BumpPtrAllocator> MDStringCache;
   DenseMap<Value *, ValueAsMetadata *> ValuesAsMetadata;
   DenseMap<Metadata *, MetadataAsValue *> MetadataAsValues;
 
+  /// Guards ValueNames, ValueHandles, ValueMetadata, the use lists of the
+  /// values that several functions may use, and the maps of metadata kinds,
+  /// bundle tags and sync scopes, which instructions are built with.
+  mutable UniquingMutex ValuesMutex;
+
   DenseMap<const Value*, ValueName*> ValueNames;
 
 #define HANDLE_MDNODE_LEAF_UNIQUABLE(CLASS)                                    \
@@ -1419,6 +1465,9 @@ public:
   Type X86_FP80Ty, FP128Ty, PPC_FP128Ty, X86_MMXTy;
   IntegerType Int1Ty, Int8Ty, Int16Ty, Int32Ty, Int64Ty, Int128Ty;
 
+  /// Guards the tables of types and attributes, and Alloc.
+  UniquingMutex TypesMutex;
+
   BumpPtrAllocator Alloc;
   UniqueStringSaver Saver{Alloc};
 
@@ -1494,6 +1543,11 @@ public:
   /// not.
   bool DiscardValueNames = false;
 
+  /// Whether the uniquing tables are guarded by their locks.
+  /// \see LLVMContext::setConcurrentUniquing
+  bool ConcurrentUniquing = false;
+  void setConcurrentUniquing(bool Enable);
+
   LLVMContextImpl(LLVMContext &C);
   ~LLVMContextImpl();
 
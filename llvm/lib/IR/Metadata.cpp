@@ -66,6 +66,7 @@ MetadataAsValue::MetadataAsValue(Type *Ty, Metadata *MD)
 }
 
 MetadataAsValue::~MetadataAsValue() {
+  UniquingLock Lock(getType()->getContext().pImpl->MetadataMutex);
   getType()->getContext().pImpl->MetadataAsValues.erase(MD);
   untrack();
 }
@@ -105,6 +106,7 @@ static Metadata *canonicalizeMetadataForValue(LLVMContext &Context,
 
 MetadataAsValue *MetadataAsValue::get(LLVMContext &Context, Metadata *MD) {
   MD = canonicalizeMetadataForValue(Context, MD);
+  UniquingLock Lock(Context.pImpl->MetadataMutex);
   auto *&Entry = Context.pImpl->MetadataAsValues[MD];
   if (!Entry)
     Entry = new MetadataAsValue(Type::getMetadataTy(Context), MD);
@@ -114,6 +116,7 @@ MetadataAsValue *MetadataAsValue::get(LLVMContext &Context, Metadata *MD) {
 MetadataAsValue *MetadataAsValue::getIfExists(LLVMContext &Context,
                                               Metadata *MD) {
   MD = canonicalizeMetadataForValue(Context, MD);
+  UniquingLock Lock(Context.pImpl->MetadataMutex);
   auto &Store = Context.pImpl->MetadataAsValues;
   return Store.lookup(MD);
 }
@@ -121,6 +124,7 @@ MetadataAsValue *MetadataAsValue::getIfExists(LLVMContext &Context,
 void MetadataAsValue::handleChangedMetadata(Metadata *MD) {
   LLVMContext &Context = getContext();
   MD = canonicalizeMetadataForValue(Context, MD);
+  UniquingLock Lock(Context.pImpl->MetadataMutex);
   auto &Store = Context.pImpl->MetadataAsValues;
 
   // Stop tracking the old metadata.
@@ -350,6 +354,7 @@ ValueAsMetadata *ValueAsMetadata::get(Value *V) {
   assert(V && "Unexpected null Value");
 
   auto &Context = V->getContext();
+  UniquingLock Lock(Context.pImpl->MetadataMutex);
   auto *&Entry = Context.pImpl->ValuesAsMetadata[V];
   if (!Entry) {
     assert((isa<Constant>(V) || isa<Argument>(V) || isa<Instruction>(V)) &&
@@ -367,12 +372,14 @@ ValueAsMetadata *ValueAsMetadata::get(Value *V) {
 
 ValueAsMetadata *ValueAsMetadata::getIfExists(Value *V) {
   assert(V && "Unexpected null Value");
+  UniquingLock Lock(V->getContext().pImpl->MetadataMutex);
   return V->getContext().pImpl->ValuesAsMetadata.lookup(V);
 }
 
 void ValueAsMetadata::handleDeletion(Value *V) {
   assert(V && "Expected valid value");
 
+  UniquingLock Lock(V->getType()->getContext().pImpl->MetadataMutex);
   auto &Store = V->getType()->getContext().pImpl->ValuesAsMetadata;
   auto I = Store.find(V);
   if (I == Store.end())
@@ -396,6 +403,7 @@ void ValueAsMetadata::handleRAUW(Value *From, Value *To) {
   assert(From->getType() == To->getType() && "Unexpected type change");
 
   LLVMContext &Context = From->getType()->getContext();
+  UniquingLock Lock(Context.pImpl->MetadataMutex);
   auto &Store = Context.pImpl->ValuesAsMetadata;
   auto I = Store.find(From);
   if (I == Store.end()) {
@@ -452,6 +460,7 @@ void ValueAsMetadata::handleRAUW(Value *From, Value *To) {
 //
 
 MDString *MDString::get(LLVMContext &Context, StringRef Str) {
+  UniquingLock Lock(Context.pImpl->MetadataMutex);
   auto &Store = Context.pImpl->MDStringCache;
   auto I = Store.try_emplace(Str);
   auto &MapEntry = I.first->getValue();
@@ -483,10 +492,13 @@ void *MDNode::operator new(size_t Size, unsigned NumOps) {
   // uint64_t is the most aligned type we need support (ensured by static_assert
   // above)
   OpSize = alignTo(OpSize, alignof(uint64_t));
-  void *Ptr = reinterpret_cast<char *>(::operator new(OpSize + Size)) + OpSize;
+  IRArena *Arena = IRArena::getActive();
+  void *Ptr = static_cast<char *>(IRArena::allocate(Arena, OpSize + Size)) +
+              OpSize;
   MDOperand *O = static_cast<MDOperand *>(Ptr);
   for (MDOperand *E = O - NumOps; O != E; --O)
     (void)new (O - 1) MDOperand;
+  static_cast<MDNode *>(Ptr)->IsArenaAllocated = Arena != nullptr;
   return Ptr;
 }
 
@@ -500,7 +512,8 @@ LLVM_NO_SANITIZE_MEMORY_ATTRIBUTE void MDNode::operator delete(void *Mem) {
   MDOperand *O = static_cast<MDOperand *>(Mem);
   for (MDOperand *E = O - N->NumOperands; O != E; --O)
     (O - 1)->~MDOperand();
-  ::operator delete(reinterpret_cast<char *>(Mem) - OpSize);
+  IRArena::deallocate(reinterpret_cast<char *>(Mem) - OpSize,
+                      N->IsArenaAllocated);
 }
 
 MDNode::MDNode(LLVMContext &Context, unsigned ID, StorageType Storage,
@@ -782,6 +795,7 @@ MDNode *MDNode::uniquify() {
   assert(!hasSelfReference(this) && "Cannot uniquify a self-referencing node");
 
   // Try to insert into uniquing store.
+  UniquingLock Lock(getContext().pImpl->MetadataMutex);
   switch (getMetadataID()) {
   default:
     llvm_unreachable("Invalid or non-uniquable subclass of MDNode");
@@ -798,6 +812,7 @@ MDNode *MDNode::uniquify() {
 }
 
 void MDNode::eraseFromStore() {
+  UniquingLock Lock(getContext().pImpl->MetadataMutex);
   switch (getMetadataID()) {
   default:
     llvm_unreachable("Invalid or non-uniquable subclass of MDNode");
@@ -811,6 +826,7 @@ void MDNode::eraseFromStore() {
 
 MDTuple *MDTuple::getImpl(LLVMContext &Context, ArrayRef<Metadata *> MDs,
                           StorageType Storage, bool ShouldCreate) {
+  UniquingLock Lock(Context.pImpl->MetadataMutex);
   unsigned Hash = 0;
   if (Storage == Uniqued) {
     MDTupleInfo::KeyTy Key(MDs);
@@ -852,6 +868,7 @@ void MDNode::storeDistinctInContext() {
 #include "llvm/IR/Metadata.def"
   }
 
+  UniquingLock Lock(getContext().pImpl->MetadataMutex);
   getContext().pImpl->DistinctMDNodes.push_back(this);
 }
 
@@ -1179,6 +1196,7 @@ bool MDAttachments::erase(unsigned ID) {
 MDNode *Value::getMetadata(unsigned KindID) const {
   if (!hasMetadata())
     return nullptr;
+  UniquingLock Lock(getContext().pImpl->ValuesMutex);
   const auto &Info = getContext().pImpl->ValueMetadata[this];
   assert(!Info.empty() && "bit out of sync with hash table");
   return Info.lookup(KindID);
@@ -1187,14 +1205,14 @@ MDNode *Value::getMetadata(unsigned KindID) const {
 MDNode *Value::getMetadata(StringRef Kind) const {
   if (!hasMetadata())
     return nullptr;
-  const auto &Info = getContext().pImpl->ValueMetadata[this];
-  assert(!Info.empty() && "bit out of sync with hash table");
-  return Info.lookup(getContext().getMDKindID(Kind));
+  return getMetadata(getContext().getMDKindID(Kind));
 }
 
 void Value::getMetadata(unsigned KindID, SmallVectorImpl<MDNode *> &MDs) const {
-  if (hasMetadata())
-    getContext().pImpl->ValueMetadata[this].get(KindID, MDs);
+  if (!hasMetadata())
+    return;
+  UniquingLock Lock(getContext().pImpl->ValuesMutex);
+  getContext().pImpl->ValueMetadata[this].get(KindID, MDs);
 }
 
 void Value::getMetadata(StringRef Kind, SmallVectorImpl<MDNode *> &MDs) const {
@@ -1205,6 +1223,7 @@ void Value::getMetadata(StringRef Kind, SmallVectorImpl<MDNode *> &MDs) const {
 void Value::getAllMetadata(
     SmallVectorImpl<std::pair<unsigned, MDNode *>> &MDs) const {
   if (hasMetadata()) {
+    UniquingLock Lock(getContext().pImpl->ValuesMutex);
     assert(getContext().pImpl->ValueMetadata.count(this) &&
            "bit out of sync with hash table");
     const auto &Info = getContext().pImpl->ValueMetadata.find(this)->second;
@@ -1215,6 +1234,7 @@ void Value::getAllMetadata(
 
 void Value::setMetadata(unsigned KindID, MDNode *Node) {
   assert(isa<Instruction>(this) || isa<GlobalObject>(this));
+  UniquingLock Lock(getContext().pImpl->ValuesMutex);
 
   // Handle the case when we're adding/updating metadata on a value.
   if (Node) {
@@ -1249,6 +1269,7 @@ void Value::setMetadata(StringRef Kind, MDNode *Node) {
 
 void Value::addMetadata(unsigned KindID, MDNode &MD) {
   assert(isa<Instruction>(this) || isa<GlobalObject>(this));
+  UniquingLock Lock(getContext().pImpl->ValuesMutex);
   if (!HasMetadata)
     HasMetadata = true;
   getContext().pImpl->ValueMetadata[this].insert(KindID, MD);
@@ -1263,6 +1284,7 @@ bool Value::eraseMetadata(unsigned KindID) {
   if (!HasMetadata)
     return false;
 
+  UniquingLock Lock(getContext().pImpl->ValuesMutex);
   auto &Store = getContext().pImpl->ValueMetadata[this];
   bool Changed = Store.erase(KindID);
   if (Store.empty())
@@ -1273,6 +1295,7 @@ bool Value::eraseMetadata(unsigned KindID) {
 void Value::clearMetadata() {
   if (!HasMetadata)
     return;
+  UniquingLock Lock(getContext().pImpl->ValuesMutex);
   assert(getContext().pImpl->ValueMetadata.count(this) &&
          "bit out of sync with hash table");
   getContext().pImpl->ValueMetadata.erase(this);
@@ -1302,6 +1325,7 @@ void Instruction::dropUnknownNonDebugMetadata(ArrayRef<unsigned> KnownIDs) {
   SmallSet<unsigned, 4> KnownSet;
   KnownSet.insert(KnownIDs.begin(), KnownIDs.end());
 
+  UniquingLock Lock(getContext().pImpl->ValuesMutex);
   auto &MetadataStore = getContext().pImpl->ValueMetadata;
   auto &Info = MetadataStore[this];
   assert(!Info.empty() && "bit out of sync with hash table");
@@ -10,6 +10,8 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/PassManagerImpl.h"
+#include "llvm/Support/ThreadPool.h"
+#include <atomic>
 
 using namespace llvm;
 
@@ -139,6 +141,80 @@ PreservedAnalyses ModuleToFunctionPassAdaptor::run(Module &M,
   return PA;
 }
 
+PreservedAnalyses
+ParallelModuleToFunctionPassAdaptor::run(Module &M,
+                                         ModuleAnalysisManager &AM) {
+  FunctionAnalysisManager &FAM =
+      AM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+  PassInstrumentation PI = AM.getResult<PassInstrumentationAnalysis>(M);
+
+  std::vector<Function *> Functions;
+  for (Function &F : M)
+    if (!F.isDeclaration())
+      Functions.push_back(&F);
+
+  // One instance of the passes per thread.
+  ThreadPoolStrategy S = Strategy;
+  S.ThreadsRequested =
+      std::min<size_t>(Strategy.compute_thread_count(), Functions.size());
+  std::vector<std::unique_ptr<PassConceptT>> Passes;
+  for (unsigned I = 0; I != S.ThreadsRequested; ++I)
+    Passes.push_back(PassBuilder());
+
+  LLVMContext &Ctx = M.getContext();
+  bool WasConcurrentUniquing = Ctx.hasConcurrentUniquing();
+  bool WasThreadSafe = FAM.isThreadSafe();
+  Ctx.setConcurrentUniquing(true);
+  FAM.setThreadSafe(true);
+
+  PreservedAnalyses PA = PreservedAnalyses::all();
+  // Guards PA and the instrumentation callbacks.
+  std::mutex Mutex;
+  std::atomic<size_t> NextFunction(0);
+  if (!Passes.empty()) {
+    ThreadPool Pool(S);
+    for (std::unique_ptr<PassConceptT> &P : Passes)
+      Pool.async([&, Pass = P.get()] {
+        for (size_t I = NextFunction++; I < Functions.size();
+             I = NextFunction++) {
+          Function &F = *Functions[I];
+          {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            if (!PI.runBeforePass<Function>(*Pass, F))
+              continue;
+          }
+
+          PreservedAnalyses PassPA;
+          {
+            TimeTraceScope TimeScope(Pass->name(), F.getName());
+            PassPA = Pass->run(F, FAM);
+          }
+
+          {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            PI.runAfterPass(*Pass, F, PassPA);
+          }
+
+          // As in ModuleToFunctionPassAdaptor, only this function's analyses
+          // may have been invalidated.
+          FAM.invalidate(F, PassPA);
+
+          std::lock_guard<std::mutex> Lock(Mutex);
+          PA.intersect(std::move(PassPA));
+        }
+      });
+    Pool.wait();
+  }
+
+  FAM.setThreadSafe(WasThreadSafe);
+  Ctx.setConcurrentUniquing(WasConcurrentUniquing);
+
+  // Preserve the same as ModuleToFunctionPassAdaptor, for the same reasons.
+  PA.preserveSet<AllAnalysesOn<Function>>();
+  PA.preserve<FunctionAnalysisManagerModuleProxy>();
+  return PA;
+}
+
 AnalysisSetKey CFGAnalyses::SetKey;
 
 AnalysisSetKey PreservedAnalyses::AllAnalysesKey;
@@ -17,13 +17,17 @@
 
 #include "llvm/IR/PassTimingInfo.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/IR/Function.h"
 #include "llvm/IR/PassInstrumentation.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Mutex.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/TypeName.h"
 #include "llvm/Support/raw_ostream.h"
 #include <string>
@@ -46,6 +50,15 @@ static cl::opt<bool, true> EnableTimingPerRun(
     cl::desc("Time each pass run, printing elapsed time for each run on exit"),
     cl::callback([](const bool &) { TimePassesIsEnabled = true; }));
 
+static cl::opt<bool> EnablePassCounters(
+    "time-passes-counters", cl::Hidden,
+    cl::desc("Count the time, hardware events and memory of each pass on each "
+             "function, reporting them as JSON on exit"));
+
+static cl::opt<std::string> PassCountersOutput(
+    "time-passes-counters-output", cl::Hidden, cl::value_desc("filename"),
+    cl::desc("Append the -time-passes-counters report to this file"));
+
 namespace {
 namespace legacy {
 
@@ -290,4 +303,127 @@ void TimePassesHandler::registerCallbacks(PassInstrumentationCallbacks &PIC) {
       [this](StringRef P, Any) { this->runAfterPass(P); });
 }
 
+//===----------------------------------------------------------------------===//
+// Pass counters for the New Pass Manager
+//===----------------------------------------------------------------------===//
+
+PassCountersHandler::PassCountersHandler(bool Enabled) : Enabled(Enabled) {}
+
+PassCountersHandler::PassCountersHandler()
+    : PassCountersHandler(EnablePassCounters) {}
+
+void PassCountersHandler::setOutStream(raw_ostream &Out) { OutStream = &Out; }
+
+void PassCountersHandler::update() {
+  auto Wall = std::chrono::steady_clock::now();
+  PerfCounters::Values Events = Counters->read();
+  size_t Malloc = sys::Process::GetMallocUsage();
+  size_t PeakMemory = sys::Process::GetPeakMemoryUsage();
+  if (!Running.empty()) {
+    Counts &C = *Running.back();
+    C.Wall += Wall - LastWall;
+    PerfCounters::Values Delta = Events;
+    Delta -= LastEvents;
+    C.Events += Delta;
+    C.MallocBytes += int64_t(Malloc) - int64_t(LastMalloc);
+    C.PeakMemoryGrowth += int64_t(PeakMemory) - int64_t(LastPeakMemory);
+  }
+  LastWall = Wall;
+  LastEvents = Events;
+  LastMalloc = Malloc;
+  LastPeakMemory = PeakMemory;
+}
+
+void PassCountersHandler::runBeforePass(StringRef PassID, Any IR) {
+  if (isSpecialPass(PassID,
+                    {"PassManager", "PassAdaptor", "AnalysisManagerProxy"}))
+    return;
+
+  update();
+  StringRef FunctionName;
+  if (any_isa<const Function *>(IR))
+    FunctionName = any_cast<const Function *>(IR)->getName();
+  Counts &C = Data[{PassID.str(), FunctionName.str()}];
+  ++C.Runs;
+  Running.push_back(&C);
+}
+
+void PassCountersHandler::runAfterPass(StringRef PassID) {
+  if (isSpecialPass(PassID,
+                    {"PassManager", "PassAdaptor", "AnalysisManagerProxy"}))
+    return;
+
+  assert(!Running.empty() && "unbalanced pass callbacks");
+  update();
+  Running.pop_back();
+}
+
+void PassCountersHandler::print() {
+  if (!Enabled || Data.empty())
+    return;
+
+  std::string Report;
+  raw_string_ostream ReportOS(Report);
+  for (const auto &PassAndCounts : Data) {
+    const Counts &C = PassAndCounts.second;
+    json::OStream J(ReportOS);
+    J.object([&] {
+      J.attribute("pass", PassAndCounts.first.first);
+      J.attribute("function", PassAndCounts.first.second);
+      J.attribute("runs", C.Runs);
+      J.attribute("wall-ns", int64_t(C.Wall.count()));
+      for (unsigned I = 0; I != PerfCounters::NumCounters; ++I) {
+        auto Counter = static_cast<PerfCounters::Counter>(I);
+        if (Counters->isAvailable(Counter))
+          J.attribute(PerfCounters::getName(Counter),
+                      int64_t(C.Events[Counter]));
+      }
+      J.attribute("malloc-bytes", C.MallocBytes);
+      J.attribute("peak-memory-growth-bytes", C.PeakMemoryGrowth);
+    });
+    ReportOS << '\n';
+  }
+  ReportOS.flush();
+  Data.clear();
+
+  if (OutStream) {
+    *OutStream << Report;
+  } else if (!PassCountersOutput.empty()) {
+    // Write the report at once, so that the reports of compilations that run
+    // at the same time don't interleave.
+    std::error_code EC;
+    raw_fd_ostream OS(PassCountersOutput, EC, sys::fs::OF_Append);
+    if (EC)
+      report_fatal_error("Could not open " + PassCountersOutput + ": " +
+                         EC.message());
+    OS.SetUnbuffered();
+    OS << Report;
+  } else {
+    *CreateInfoOutputFile() << Report;
+  }
+}
+
+void PassCountersHandler::registerCallbacks(PassInstrumentationCallbacks &PIC) {
+  if (!Enabled)
+    return;
+
+  Counters = std::make_unique<PerfCounters>();
+  update();
+
+  PIC.registerBeforeNonSkippedPassCallback(
+      [this](StringRef P, Any IR) { this->runBeforePass(P, IR); });
+  PIC.registerAfterPassCallback(
+      [this](StringRef P, Any, const PreservedAnalyses &) {
+        this->runAfterPass(P);
+      });
+  PIC.registerAfterPassInvalidatedCallback(
+      [this](StringRef P, const PreservedAnalyses &) {
+        this->runAfterPass(P);
+      });
+  PIC.registerBeforeAnalysisCallback(
+      [this](StringRef P, Any IR) { this->runBeforePass(P, IR); });
+  PIC.registerAfterAnalysisCallback(
+      [this](StringRef P, Any) { this->runAfterPass(P); });
+}
+
 } // namespace llvm
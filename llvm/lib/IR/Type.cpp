@@ -267,6 +267,7 @@ IntegerType *IntegerType::get(LLVMContext &C, unsigned NumBits) {
     break;
   }
 
+  UniquingLock Lock(C.pImpl->TypesMutex);
   IntegerType *&Entry = C.pImpl->IntegerTypes[NumBits];
 
   if (!Entry)
@@ -313,6 +314,7 @@ FunctionType *FunctionType::get(Type *ReturnType,
   // one for inserting the newly allocated one), here we instead lookup based on
   // Key and update the reference to the function type in-place to a newly
   // allocated one if not found.
+  UniquingLock Lock(pImpl->TypesMutex);
   auto Insertion = pImpl->FunctionTypes.insert_as(nullptr, Key);
   if (Insertion.second) {
     // The function type was not found. Allocate one and update FunctionTypes
@@ -359,6 +361,7 @@ StructType *StructType::get(LLVMContext &Context, ArrayRef<Type*> ETypes,
   // one for inserting the newly allocated one), here we instead lookup based on
   // Key and update the reference to the struct type in-place to a newly
   // allocated one if not found.
+  UniquingLock Lock(pImpl->TypesMutex);
   auto Insertion = pImpl->AnonStructTypes.insert_as(nullptr, Key);
   if (Insertion.second) {
     // The struct type was not found. Allocate one and update AnonStructTypes
@@ -389,12 +392,14 @@ void StructType::setBody(ArrayRef<Type*> Elements, bool isPacked) {
     return;
   }
 
+  UniquingLock Lock(getContext().pImpl->TypesMutex);
   ContainedTys = Elements.copy(getContext().pImpl->Alloc).data();
 }
 
 void StructType::setName(StringRef Name) {
   if (Name == getName()) return;
 
+  UniquingLock Lock(getContext().pImpl->TypesMutex);
   StringMap<StructType *> &SymbolTable = getContext().pImpl->NamedStructTypes;
 
   using EntryTy = StringMap<StructType *>::MapEntryTy;
@@ -444,6 +449,7 @@ void StructType::setName(StringRef Name) {
 // StructType Helper functions.
 
 StructType *StructType::create(LLVMContext &Context, StringRef Name) {
+  UniquingLock Lock(Context.pImpl->TypesMutex);
   StructType *ST = new (Context.pImpl->Alloc) StructType(Context);
   if (!Name.empty())
     ST->setName(Name);
@@ -549,6 +555,7 @@ bool StructType::indexValid(const Value *V) const {
 }
 
 StructType *StructType::getTypeByName(LLVMContext &C, StringRef Name) {
+  UniquingLock Lock(C.pImpl->TypesMutex);
   return C.pImpl->NamedStructTypes.lookup(Name);
 }
 
@@ -567,6 +574,7 @@ ArrayType *ArrayType::get(Type *ElementType, uint64_t NumElements) {
   assert(isValidElementType(ElementType) && "Invalid type for array element!");
 
   LLVMContextImpl *pImpl = ElementType->getContext().pImpl;
+  UniquingLock Lock(pImpl->TypesMutex);
   ArrayType *&Entry =
     pImpl->ArrayTypes[std::make_pair(ElementType, NumElements)];
 
@@ -617,6 +625,7 @@ FixedVectorType *FixedVectorType::get(Type *ElementType, unsigned NumElts) {
   auto EC = ElementCount::getFixed(NumElts);
 
   LLVMContextImpl *pImpl = ElementType->getContext().pImpl;
+  UniquingLock Lock(pImpl->TypesMutex);
   VectorType *&Entry = ElementType->getContext()
                            .pImpl->VectorTypes[std::make_pair(ElementType, EC)];
 
@@ -639,6 +648,7 @@ ScalableVectorType *ScalableVectorType::get(Type *ElementType,
   auto EC = ElementCount::getScalable(MinNumElts);
 
   LLVMContextImpl *pImpl = ElementType->getContext().pImpl;
+  UniquingLock Lock(pImpl->TypesMutex);
   VectorType *&Entry = ElementType->getContext()
                            .pImpl->VectorTypes[std::make_pair(ElementType, EC)];
 
@@ -658,6 +668,7 @@ PointerType *PointerType::get(Type *EltTy, unsigned AddressSpace) {
   LLVMContextImpl *CImpl = EltTy->getContext().pImpl;
 
   // Since AddressSpace #0 is the common case, we special case it.
+  UniquingLock Lock(CImpl->TypesMutex);
   PointerType *&Entry = AddressSpace == 0 ? CImpl->PointerTypes[EltTy]
      : CImpl->ASPointerTypes[std::make_pair(EltTy, AddressSpace)];
 
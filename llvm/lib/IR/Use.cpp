@@ -7,16 +7,55 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/IR/Use.h"
+#include "LLVMContextImpl.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/IR/Argument.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Instruction.h"
 #include "llvm/IR/User.h"
 #include "llvm/IR/Value.h"
 #include <new>
 
 namespace llvm {
 
+std::atomic<unsigned> Use::NumConcurrentContexts(0);
+
+/// Return the lock to take to change the use list of \p V, if other threads
+/// may do so too: the values local to a function are only handled by the
+/// thread working on that function.
+static UniquingMutex *getUseListMutex(const Value *V) {
+  if (!V || isa<Instruction>(V) || isa<Argument>(V) || isa<BasicBlock>(V))
+    return nullptr;
+  return &V->getContext().pImpl->ValuesMutex;
+}
+
+void Use::setLocked(Value *V) {
+  // Both values belong to the same context.
+  UniquingMutex *Mutex = getUseListMutex(Val);
+  if (!Mutex)
+    Mutex = getUseListMutex(V);
+  Optional<UniquingLock> Lock;
+  if (Mutex)
+    Lock.emplace(*Mutex);
+
+  if (Val) removeFromList();
+  Val = V;
+  if (V) V->addUse(*this);
+}
+
 void Use::swap(Use &RHS) {
   if (Val == RHS.Val)
     return;
 
+  Optional<UniquingLock> Lock;
+  if (LLVM_UNLIKELY(NumConcurrentContexts.load(std::memory_order_relaxed))) {
+    UniquingMutex *Mutex = getUseListMutex(Val);
+    if (!Mutex)
+      Mutex = getUseListMutex(RHS.Val);
+    if (Mutex)
+      Lock.emplace(*Mutex);
+  }
+
   std::swap(Val, RHS.Val);
   std::swap(Next, RHS.Next);
   std::swap(Prev, RHS.Prev);
@@ -35,6 +35,7 @@
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <mutex>
 
 using namespace llvm;
 
@@ -200,7 +201,6 @@ void Value::dropDroppableUsesIn(User &Usr) {
 }
 
 void Value::dropDroppableUse(Use &U) {
-  U.removeFromList();
   if (auto *Assume = dyn_cast<IntrinsicInst>(U.getUser())) {
     assert(Assume->getIntrinsicID() == Intrinsic::assume);
     unsigned OpNo = U.getOperandNo();
@@ -268,6 +268,7 @@ ValueName *Value::getValueName() const {
   if (!HasName) return nullptr;
 
   LLVMContext &Ctx = getContext();
+  UniquingLock Lock(Ctx.pImpl->ValuesMutex);
   auto I = Ctx.pImpl->ValueNames.find(this);
   assert(I != Ctx.pImpl->ValueNames.end() &&
          "No name entry found!");
@@ -277,6 +278,7 @@ ValueName *Value::getValueName() const {
 
 void Value::setValueName(ValueName *VN) {
   LLVMContext &Ctx = getContext();
+  UniquingLock Lock(Ctx.pImpl->ValuesMutex);
 
   assert(HasName == Ctx.pImpl->ValueNames.count(this) &&
          "HasName bit out of sync!");
@@ -915,6 +917,7 @@ void ValueHandleBase::AddToUseList() {
   assert(getValPtr() && "Null pointer doesn't have a use list!");
 
   LLVMContextImpl *pImpl = getValPtr()->getContext().pImpl;
+  UniquingLock Lock(pImpl->ValuesMutex);
 
   if (getValPtr()->HasValueHandle) {
     // If this value already has a ValueHandle, then it must be in the
@@ -957,6 +960,8 @@ void ValueHandleBase::AddToUseList() {
 void ValueHandleBase::RemoveFromUseList() {
   assert(getValPtr() && getValPtr()->HasValueHandle &&
          "Pointer doesn't have a use list!");
+  LLVMContextImpl *pImpl = getValPtr()->getContext().pImpl;
+  UniquingLock Lock(pImpl->ValuesMutex);
 
   // Unlink this from its use list.
   ValueHandleBase **PrevPtr = getPrevPtr();
@@ -972,7 +977,6 @@ void ValueHandleBase::RemoveFromUseList() {
   // If the Next pointer was null, then it is possible that this was the last
   // ValueHandle watching VP.  If so, delete its entry from the ValueHandles
   // map.
-  LLVMContextImpl *pImpl = getValPtr()->getContext().pImpl;
   DenseMap<Value*, ValueHandleBase*> &Handles = pImpl->ValueHandles;
   if (Handles.isPointerIntoBucketsArray(PrevPtr)) {
     Handles.erase(getValPtr());
@@ -986,6 +990,7 @@ void ValueHandleBase::ValueIsDeleted(Value *V) {
   // Get the linked list base, which is guaranteed to exist since the
   // HasValueHandle flag is set.
   LLVMContextImpl *pImpl = V->getContext().pImpl;
+  std::unique_lock<UniquingMutex> Lock(pImpl->ValuesMutex);
   ValueHandleBase *Entry = pImpl->ValueHandles[V];
   assert(Entry && "Value bit set but no entries exist");
 
@@ -1013,8 +1018,11 @@ void ValueHandleBase::ValueIsDeleted(Value *V) {
       Entry->operator=(nullptr);
       break;
     case Callback:
-      // Forward to the subclass's implementation.
+      // Forward to the subclass's implementation. It may do anything, so it
+      // mustn't hold the lock.
+      Lock.unlock();
       static_cast<CallbackVH*>(Entry)->deleted();
+      Lock.lock();
       break;
     }
   }
@@ -1042,6 +1050,7 @@ void ValueHandleBase::ValueIsRAUWd(Value *Old, Value *New) {
   // Get the linked list base, which is guaranteed to exist since the
   // HasValueHandle flag is set.
   LLVMContextImpl *pImpl = Old->getContext().pImpl;
+  std::unique_lock<UniquingMutex> Lock(pImpl->ValuesMutex);
   ValueHandleBase *Entry = pImpl->ValueHandles[Old];
 
   assert(Entry && "Value bit set but no entries exist");
@@ -1065,8 +1074,10 @@ void ValueHandleBase::ValueIsRAUWd(Value *Old, Value *New) {
       Entry->operator=(New);
       break;
     case Callback:
-      // Forward to the subclass's implementation.
+      // Forward to the subclass's implementation, without the lock.
+      Lock.unlock();
       static_cast<CallbackVH*>(Entry)->allUsesReplacedWith(New);
+      Lock.lock();
       break;
     }
   }
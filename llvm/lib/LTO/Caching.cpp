@@ -12,6 +12,7 @@
 
 #include "llvm/LTO/Caching.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/CachePruning.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
@@ -27,8 +28,68 @@
 using namespace llvm;
 using namespace llvm::lto;
 
-Expected<NativeObjectCache> lto::localCache(StringRef CacheDirectoryPath,
-                                            AddBufferFn AddBuffer) {
+RemoteCache::~RemoteCache() = default;
+
+/// Atomically add a cache entry with the given contents to Directory, writing
+/// it to a temporary file first so that readers never see a partial entry.
+static Error writeCacheEntry(StringRef Directory, StringRef EntryPath,
+                             StringRef Contents) {
+  SmallString<64> TempFilenameModel;
+  sys::path::append(TempFilenameModel, Directory, "Thin-%%%%%%.tmp.o");
+  Expected<sys::fs::TempFile> Temp = sys::fs::TempFile::create(
+      TempFilenameModel, sys::fs::owner_read | sys::fs::owner_write);
+  if (!Temp)
+    return Temp.takeError();
+  {
+    raw_fd_ostream OS(Temp->FD, /*shouldClose=*/false);
+    OS << Contents;
+  }
+  if (Error E = Temp->keep(EntryPath)) {
+    consumeError(Temp->discard());
+    return E;
+  }
+  return Error::success();
+}
+
+namespace {
+class DirectoryRemoteCache : public RemoteCache {
+  std::string Directory;
+
+  std::string getEntryPath(StringRef Key) {
+    SmallString<64> EntryPath;
+    sys::path::append(EntryPath, Directory, "llvmcache-" + Key);
+    return std::string(EntryPath.str());
+  }
+
+public:
+  DirectoryRemoteCache(StringRef Directory) : Directory(Directory) {}
+
+  std::unique_ptr<MemoryBuffer> lookup(StringRef Key) override {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> MBOrErr =
+        MemoryBuffer::getFile(getEntryPath(Key), /*FileSize=*/-1,
+                              /*RequiresNullTerminator=*/false);
+    if (!MBOrErr)
+      return nullptr;
+    return std::move(*MBOrErr);
+  }
+
+  void store(StringRef Key, MemoryBufferRef Object) override {
+    consumeError(
+        writeCacheEntry(Directory, getEntryPath(Key), Object.getBuffer()));
+  }
+};
+} // end anonymous namespace
+
+Expected<std::shared_ptr<RemoteCache>>
+lto::directoryRemoteCache(StringRef RemoteDirectoryPath) {
+  if (std::error_code EC = sys::fs::create_directories(RemoteDirectoryPath))
+    return errorCodeToError(EC);
+  return std::make_shared<DirectoryRemoteCache>(RemoteDirectoryPath);
+}
+
+Expected<NativeObjectCache>
+lto::localCache(StringRef CacheDirectoryPath, AddBufferFn AddBuffer,
+                std::shared_ptr<RemoteCache> Remote) {
   if (std::error_code EC = sys::fs::create_directories(CacheDirectoryPath))
     return errorCodeToError(EC);
 
@@ -67,20 +128,39 @@ Expected<NativeObjectCache> lto::localCache(StringRef CacheDirectoryPath,
       report_fatal_error(Twine("Failed to open cache file ") + EntryPath +
                          ": " + EC.message() + "\n");
 
+    // Next, try the remote tier. A hit is copied to the local cache so that
+    // later links on this machine don't go to the remote tier again; failing
+    // to do so only loses that.
+    if (Remote) {
+      if (std::unique_ptr<MemoryBuffer> MB = Remote->lookup(Key)) {
+        if (!errorToBool(writeCacheEntry(CacheDirectoryPath, EntryPath,
+                                         MB->getBuffer())))
+          recordCacheFileAdded(CacheDirectoryPath, MB->getBufferSize());
+        AddBuffer(Task, std::move(MB));
+        return AddStreamFn();
+      }
+    }
+
     // This native object stream is responsible for commiting the resulting
     // file to the cache and calling AddBuffer to add it to the link.
     struct CacheStream : NativeObjectStream {
       AddBufferFn AddBuffer;
       sys::fs::TempFile TempFile;
+      std::string CacheDirectoryPath;
       std::string EntryPath;
+      std::string Key;
+      std::shared_ptr<RemoteCache> Remote;
       unsigned Task;
 
       CacheStream(std::unique_ptr<raw_pwrite_stream> OS, AddBufferFn AddBuffer,
-                  sys::fs::TempFile TempFile, std::string EntryPath,
-                  unsigned Task)
+                  sys::fs::TempFile TempFile, std::string CacheDirectoryPath,
+                  std::string EntryPath, std::string Key,
+                  std::shared_ptr<RemoteCache> Remote, unsigned Task)
           : NativeObjectStream(std::move(OS)), AddBuffer(std::move(AddBuffer)),
-            TempFile(std::move(TempFile)), EntryPath(std::move(EntryPath)),
-            Task(Task) {}
+            TempFile(std::move(TempFile)),
+            CacheDirectoryPath(std::move(CacheDirectoryPath)),
+            EntryPath(std::move(EntryPath)), Key(std::move(Key)),
+            Remote(std::move(Remote)), Task(Task) {}
 
       ~CacheStream() {
         // Make sure the stream is closed before committing it.
@@ -126,6 +206,9 @@ Expected<NativeObjectCache> lto::localCache(StringRef CacheDirectoryPath,
                              TempFile.TmpName + " to " + EntryPath + ": " +
                              toString(std::move(E)) + "\n");
 
+        recordCacheFileAdded(CacheDirectoryPath, (*MBOrErr)->getBufferSize());
+        if (Remote)
+          Remote->store(Key, **MBOrErr);
         AddBuffer(Task, std::move(*MBOrErr));
       }
     };
@@ -144,7 +227,8 @@ Expected<NativeObjectCache> lto::localCache(StringRef CacheDirectoryPath,
       // This CacheStream will move the temporary file into the cache when done.
       return std::make_unique<CacheStream>(
           std::make_unique<raw_fd_ostream>(Temp->FD, /* ShouldClose */ false),
-          AddBuffer, std::move(*Temp), std::string(EntryPath.str()), Task);
+          AddBuffer, std::move(*Temp), std::string(CacheDirectoryPath),
+          std::string(EntryPath.str()), std::string(Key), Remote, Task);
     };
   };
 }
@@ -36,6 +36,7 @@
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
 #include "llvm/Support/SHA1.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
@@ -1195,9 +1196,10 @@ public:
                 &ResolvedODR,
             const GVSummaryMapTy &DefinedGlobals,
             MapVector<StringRef, BitcodeModule> &ModuleMap) {
-          if (LLVM_ENABLE_THREADS && Conf.TimeTraceEnabled)
-            timeTraceProfilerInitialize(Conf.TimeTraceGranularity,
-                                        "thin backend");
+          // The thread pool records the backends into the trace of the
+          // thread running LTO, if it is being profiled.
+          TimeTraceScope TimeScope("Thin backend",
+                                   BM.getModuleIdentifier());
           Error E = runThinLTOBackendThread(
               AddStream, Cache, Task, BM, CombinedIndex, ImportList, ExportList,
               ResolvedODR, DefinedGlobals, ModuleMap);
@@ -1208,8 +1210,6 @@ public:
             else
               Err = std::move(E);
           }
-          if (LLVM_ENABLE_THREADS && Conf.TimeTraceEnabled)
-            timeTraceProfilerFinishThread();
         },
         BM, std::ref(CombinedIndex), std::ref(ImportList), std::ref(ExportList),
         std::ref(ResolvedODR), std::ref(DefinedGlobals), std::ref(ModuleMap));
@@ -1334,6 +1334,228 @@ ThinBackend lto::createWriteIndexesThinBackend(
   };
 }
 
+namespace {
+class OutOfProcessThinBackend : public ThinBackendProc {
+  ThreadPool BackendThreadPool;
+  AddStreamFn AddStream;
+  NativeObjectCache Cache;
+  std::string Distributor;
+  std::vector<std::string> DistributorArgs;
+  std::string JobDir;
+  /// Whether JobDir is a temporary directory created by this backend, in
+  /// which case job files are removed once the job has completed.
+  bool RemoveJobFiles = false;
+  std::set<GlobalValue::GUID> CfiFunctionDefs;
+  std::set<GlobalValue::GUID> CfiFunctionDecls;
+
+  Optional<Error> Err;
+  std::mutex ErrMu;
+
+public:
+  OutOfProcessThinBackend(
+      const Config &Conf, ModuleSummaryIndex &CombinedIndex,
+      ThreadPoolStrategy ThinLTOParallelism,
+      const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
+      AddStreamFn AddStream, NativeObjectCache Cache, std::string Distributor,
+      std::vector<std::string> DistributorArgs, std::string JobDir)
+      : ThinBackendProc(Conf, CombinedIndex, ModuleToDefinedGVSummaries),
+        BackendThreadPool(ThinLTOParallelism), AddStream(std::move(AddStream)),
+        Cache(std::move(Cache)), Distributor(std::move(Distributor)),
+        DistributorArgs(std::move(DistributorArgs)), JobDir(std::move(JobDir)) {
+    for (auto &Name : CombinedIndex.cfiFunctionDefs())
+      CfiFunctionDefs.insert(
+          GlobalValue::getGUID(GlobalValue::dropLLVMManglingEscape(Name)));
+    for (auto &Name : CombinedIndex.cfiFunctionDecls())
+      CfiFunctionDecls.insert(
+          GlobalValue::getGUID(GlobalValue::dropLLVMManglingEscape(Name)));
+  }
+
+  // Write the blocks of BM, followed by its string table, as a standalone
+  // bitcode file.
+  static Error writeBitcodeModule(const BitcodeModule &BM, StringRef Path) {
+    SmallVector<char, 0> Buffer;
+    BitcodeWriter Writer(Buffer);
+    Buffer.append(BM.getBuffer().begin(), BM.getBuffer().end());
+    Writer.copyStrtab(BM.getStrtab());
+
+    std::error_code EC;
+    raw_fd_ostream OS(Path, EC, sys::fs::OpenFlags::OF_None);
+    if (EC)
+      return createFileError(Path, EC);
+    OS << Buffer;
+    return Error::success();
+  }
+
+  Error runJob(unsigned Task, BitcodeModule BM,
+               const FunctionImporter::ImportMapTy &ImportList,
+               MapVector<StringRef, BitcodeModule> &ModuleMap,
+               AddStreamFn AddStream) {
+    StringRef ModulePath = BM.getModuleIdentifier();
+    SmallString<128> PrefixPath(JobDir);
+    sys::path::append(PrefixPath, Twine(Task));
+    std::string Prefix = std::string(PrefixPath.str());
+    std::vector<std::string> Files;
+
+    // The job file lists the module's individual index, the module itself and
+    // every module it imports from. Module identifiers are kept so that they
+    // match the module paths in the index.
+    std::string Job;
+    raw_string_ostream JobOS(Job);
+    JobOS << "thinlto-job 1\n";
+
+    std::map<std::string, GVSummaryMapTy> ModuleToSummariesForIndex;
+    gatherImportedSummariesForModule(ModulePath, ModuleToDefinedGVSummaries,
+                                     ImportList, ModuleToSummariesForIndex);
+    Files.push_back(Prefix + ".thinlto.bc");
+    {
+      std::error_code EC;
+      raw_fd_ostream OS(Files.back(), EC, sys::fs::OpenFlags::OF_None);
+      if (EC)
+        return createFileError(Files.back(), EC);
+      WriteIndexToFile(CombinedIndex, OS, &ModuleToSummariesForIndex);
+    }
+    JobOS << "index\t" << Files.back() << '\n';
+
+    Files.push_back(Prefix + ".bc");
+    if (Error E = writeBitcodeModule(BM, Files.back()))
+      return E;
+    JobOS << "module\t" << Files.back() << '\t' << ModulePath << '\n';
+
+    unsigned ImportIndex = 0;
+    for (auto &ModuleAndGUIDs : ImportList) {
+      StringRef ImportPath = ModuleAndGUIDs.first();
+      auto It = ModuleMap.find(ImportPath);
+      if (It == ModuleMap.end())
+        return make_error<StringError>("missing bitcode for imported module " +
+                                           ImportPath,
+                                       inconvertibleErrorCode());
+      Files.push_back(Prefix + ".import." + utostr(ImportIndex++) + ".bc");
+      if (Error E = writeBitcodeModule(It->second, Files.back()))
+        return E;
+      JobOS << "import\t" << Files.back() << '\t' << ImportPath << '\n';
+    }
+
+    Files.push_back(Prefix + ".job");
+    {
+      std::error_code EC;
+      raw_fd_ostream OS(Files.back(), EC, sys::fs::OpenFlags::OF_None);
+      if (EC)
+        return createFileError(Files.back(), EC);
+      OS << JobOS.str();
+    }
+    std::string JobPath = Files.back();
+    Files.push_back(Prefix + ".o");
+    std::string ObjectPath = Files.back();
+
+    SmallVector<StringRef, 8> Args;
+    Args.push_back(Distributor);
+    for (const std::string &Arg : DistributorArgs)
+      Args.push_back(Arg);
+    Args.push_back("-o");
+    Args.push_back(ObjectPath);
+    Args.push_back(JobPath);
+
+    std::string ErrMsg;
+    int RC = sys::ExecuteAndWait(Distributor, Args, /*Env=*/None,
+                                 /*Redirects=*/{}, /*SecondsToWait=*/0,
+                                 /*MemoryLimit=*/0, &ErrMsg);
+    if (RC != 0) {
+      if (ErrMsg.empty())
+        ErrMsg = "exited with code " + itostr(RC);
+      return make_error<StringError>("ThinLTO distributor failed for " +
+                                         ModulePath + ": " + ErrMsg,
+                                     inconvertibleErrorCode());
+    }
+
+    ErrorOr<std::unique_ptr<MemoryBuffer>> ObjOrErr =
+        MemoryBuffer::getFile(ObjectPath);
+    if (!ObjOrErr)
+      return createFileError(ObjectPath, ObjOrErr.getError());
+    *AddStream(Task)->OS << (*ObjOrErr)->getBuffer();
+
+    if (RemoveJobFiles)
+      for (const std::string &File : Files)
+        sys::fs::remove(File);
+    return Error::success();
+  }
+
+  Error start(
+      unsigned Task, BitcodeModule BM,
+      const FunctionImporter::ImportMapTy &ImportList,
+      const FunctionImporter::ExportSetTy &ExportList,
+      const std::map<GlobalValue::GUID, GlobalValue::LinkageTypes> &ResolvedODR,
+      MapVector<StringRef, BitcodeModule> &ModuleMap) override {
+    if (JobDir.empty()) {
+      SmallString<128> Dir;
+      if (std::error_code EC = sys::fs::createUniqueDirectory("thinlto", Dir))
+        return errorCodeToError(EC);
+      JobDir = std::string(Dir.str());
+      RemoveJobFiles = true;
+    }
+
+    StringRef ModulePath = BM.getModuleIdentifier();
+    assert(ModuleToDefinedGVSummaries.count(ModulePath));
+    const GVSummaryMapTy &DefinedGlobals =
+        ModuleToDefinedGVSummaries.find(ModulePath)->second;
+    BackendThreadPool.async([=, &ImportList, &ExportList, &ResolvedODR,
+                             &DefinedGlobals, &ModuleMap] {
+      Error E = Error::success();
+      AddStreamFn JobAddStream = AddStream;
+      bool Run = true;
+      // As for the in-process backend, the module may be cached.
+      if (Cache && CombinedIndex.modulePaths().count(ModulePath) &&
+          !all_of(CombinedIndex.getModuleHash(ModulePath),
+                  [](uint32_t V) { return V == 0; })) {
+        SmallString<40> Key;
+        computeLTOCacheKey(Key, Conf, CombinedIndex, ModulePath, ImportList,
+                           ExportList, ResolvedODR, DefinedGlobals,
+                           CfiFunctionDefs, CfiFunctionDecls);
+        JobAddStream = Cache(Task, Key);
+        Run = bool(JobAddStream);
+      }
+      if (Run)
+        E = runJob(Task, BM, ImportList, ModuleMap, JobAddStream);
+      if (E) {
+        std::unique_lock<std::mutex> L(ErrMu);
+        if (Err)
+          Err = joinErrors(std::move(*Err), std::move(E));
+        else
+          Err = std::move(E);
+      }
+    });
+    return Error::success();
+  }
+
+  Error wait() override {
+    BackendThreadPool.wait();
+    if (RemoveJobFiles)
+      sys::fs::remove(JobDir);
+    if (Err)
+      return std::move(*Err);
+    else
+      return Error::success();
+  }
+
+  unsigned getThreadCount() override {
+    return BackendThreadPool.getThreadCount();
+  }
+};
+} // end anonymous namespace
+
+ThinBackend
+lto::createOutOfProcessThinBackend(ThreadPoolStrategy Parallelism,
+                                   std::string Distributor,
+                                   std::vector<std::string> DistributorArgs,
+                                   std::string JobDir) {
+  return [=](const Config &Conf, ModuleSummaryIndex &CombinedIndex,
+             const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
+             AddStreamFn AddStream, NativeObjectCache Cache) {
+    return std::make_unique<OutOfProcessThinBackend>(
+        Conf, CombinedIndex, Parallelism, ModuleToDefinedGVSummaries, AddStream,
+        Cache, Distributor, DistributorArgs, JobDir);
+  };
+}
+
 Error LTO::runThinLTO(AddStreamFn AddStream, NativeObjectCache Cache,
                       const DenseSet<GlobalValue::GUID> &GUIDPreservedSymbols) {
   if (ThinLTO.ModuleMap.empty())
@@ -1472,15 +1694,21 @@ Error LTO::runThinLTO(AddStreamFn AddStream, NativeObjectCache Cache,
       if (Error E = ProcessOneModule(I))
         return E;
   } else {
-    // When executing in parallel, process largest bitsize modules first to
+    // When executing in parallel, process the most expensive modules first to
     // improve parallelism, and avoid starving the thread pool near the end.
-    // This saves about 15 sec on a 36-core machine while link `clang.exe` (out
-    // of 100 sec).
+    // The cost is estimated from the summary, which accounts for the functions
+    // a module imports, and falls back to the bitcode size.
     std::vector<BitcodeModule *> ModulesVec;
+    std::vector<uint64_t> Costs;
     ModulesVec.reserve(ModuleMap.size());
-    for (auto &Mod : ModuleMap)
+    Costs.reserve(ModuleMap.size());
+    for (auto &Mod : ModuleMap) {
       ModulesVec.push_back(&Mod.second);
-    for (int I : generateModulesOrdering(ModulesVec))
+      Costs.push_back(estimateThinBackendCost(
+          ThinLTO.CombinedIndex, ModuleToDefinedGVSummaries[Mod.first],
+          ImportLists[Mod.first]));
+    }
+    for (int I : generateModulesOrdering(ModulesVec, Costs))
       if (Error E = ProcessOneModule(I))
         return E;
   }
@@ -1542,3 +1770,37 @@ std::vector<int> lto::generateModulesOrdering(ArrayRef<BitcodeModule *> R) {
   });
   return ModulesOrdering;
 }
+
+std::vector<int> lto::generateModulesOrdering(ArrayRef<BitcodeModule *> R,
+                                              ArrayRef<uint64_t> Costs) {
+  assert(R.size() == Costs.size() && "Expected one cost per module");
+  std::vector<int> ModulesOrdering;
+  ModulesOrdering.resize(R.size());
+  std::iota(ModulesOrdering.begin(), ModulesOrdering.end(), 0);
+  llvm::sort(ModulesOrdering, [&](int LeftIndex, int RightIndex) {
+    if (Costs[LeftIndex] != Costs[RightIndex])
+      return Costs[LeftIndex] > Costs[RightIndex];
+    auto LSize = R[LeftIndex]->getBuffer().size();
+    auto RSize = R[RightIndex]->getBuffer().size();
+    if (LSize != RSize)
+      return LSize > RSize;
+    return LeftIndex < RightIndex;
+  });
+  return ModulesOrdering;
+}
+
+uint64_t
+lto::estimateThinBackendCost(const ModuleSummaryIndex &Index,
+                             const GVSummaryMapTy &DefinedGlobals,
+                             const FunctionImporter::ImportMapTy &ImportList) {
+  uint64_t Cost = 0;
+  for (auto &GlobalAndSummary : DefinedGlobals)
+    if (auto *FS = dyn_cast<FunctionSummary>(GlobalAndSummary.second))
+      Cost += FS->instCount();
+  for (auto &ModuleAndGUIDs : ImportList)
+    for (GlobalValue::GUID GUID : ModuleAndGUIDs.second)
+      if (auto *FS = dyn_cast_or_null<FunctionSummary>(
+              Index.findSummaryInModule(GUID, ModuleAndGUIDs.first())))
+        Cost += FS->instCount();
+  return Cost;
+}
@@ -728,3 +728,106 @@ bool lto::loadReferencedModules(
   }
   return true;
 }
+
+Error lto::runThinBackendJob(const Config &Conf, StringRef JobPath,
+                             StringRef OutputPath) {
+  auto MalformedJob = [&](const Twine &Msg) {
+    return createStringError(inconvertibleErrorCode(),
+                             "malformed ThinLTO job file '" + JobPath +
+                                 "': " + Msg);
+  };
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> JobOrErr =
+      MemoryBuffer::getFile(JobPath);
+  if (!JobOrErr)
+    return createFileError(JobPath, JobOrErr.getError());
+
+  SmallVector<StringRef, 8> Lines;
+  (*JobOrErr)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                                 /*KeepEmpty=*/false);
+  if (Lines.empty() || Lines[0] != "thinlto-job 1")
+    return MalformedJob("unsupported version");
+
+  // Module identifiers refer into the job file buffer, which outlives the
+  // backend.
+  StringRef IndexPath;
+  std::pair<StringRef, StringRef> Main;
+  std::vector<std::pair<StringRef, StringRef>> Imports;
+  for (StringRef Line : makeArrayRef(Lines).drop_front()) {
+    StringRef Kind, Rest;
+    std::tie(Kind, Rest) = Line.split('\t');
+    if (Kind == "index") {
+      IndexPath = Rest;
+    } else if (Kind == "module" || Kind == "import") {
+      std::pair<StringRef, StringRef> PathAndID = Rest.split('\t');
+      if (PathAndID.first.empty() || PathAndID.second.empty())
+        return MalformedJob("expected a path and a module identifier");
+      if (Kind == "module")
+        Main = PathAndID;
+      else
+        Imports.push_back(PathAndID);
+    } else {
+      return MalformedJob("unknown entry '" + Kind + "'");
+    }
+  }
+  if (IndexPath.empty() || Main.first.empty())
+    return MalformedJob("missing index or module");
+
+  Expected<std::unique_ptr<ModuleSummaryIndex>> IndexOrErr =
+      getModuleSummaryIndexForFile(IndexPath);
+  if (!IndexOrErr)
+    return IndexOrErr.takeError();
+  ModuleSummaryIndex &CombinedIndex = **IndexOrErr;
+
+  std::vector<std::unique_ptr<MemoryBuffer>> OwnedBuffers;
+  auto LoadModule = [&](StringRef Path,
+                        StringRef ID) -> Expected<BitcodeModule> {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> MBOrErr =
+        MemoryBuffer::getFile(Path);
+    if (!MBOrErr)
+      return createFileError(Path, MBOrErr.getError());
+    MemoryBufferRef MBRef((*MBOrErr)->getBuffer(), ID);
+    OwnedBuffers.push_back(std::move(*MBOrErr));
+    return findThinLTOModule(MBRef);
+  };
+
+  Expected<BitcodeModule> BMOrErr = LoadModule(Main.first, Main.second);
+  if (!BMOrErr)
+    return BMOrErr.takeError();
+  MapVector<StringRef, BitcodeModule> ModuleMap;
+  for (auto &PathAndID : Imports) {
+    Expected<BitcodeModule> ImportOrErr =
+        LoadModule(PathAndID.first, PathAndID.second);
+    if (!ImportOrErr)
+      return ImportOrErr.takeError();
+    ModuleMap.insert({PathAndID.second, *ImportOrErr});
+  }
+
+  // As for clang's distributed backend, we can simply import the values
+  // mentioned in the individual index.
+  FunctionImporter::ImportMapTy ImportList;
+  for (const auto &GlobalList : CombinedIndex)
+    for (const auto &Summary : GlobalList.second.SummaryList)
+      if (Summary->modulePath() != Main.second)
+        ImportList[Summary->modulePath()].insert(GlobalList.first);
+
+  StringMap<GVSummaryMapTy> ModuleToDefinedGVSummaries;
+  CombinedIndex.collectDefinedGVSummariesPerModule(ModuleToDefinedGVSummaries);
+
+  LTOLLVMContext BackendContext(Conf);
+  Expected<std::unique_ptr<Module>> MOrErr =
+      BMOrErr->parseModule(BackendContext);
+  if (!MOrErr)
+    return MOrErr.takeError();
+
+  std::error_code EC;
+  auto OS = std::make_unique<raw_fd_ostream>(OutputPath, EC, sys::fs::OF_None);
+  if (EC)
+    return createFileError(OutputPath, EC);
+  auto AddStream = [&](size_t Task) {
+    return std::make_unique<NativeObjectStream>(std::move(OS));
+  };
+  return thinBackend(Conf, /*Task=*/0, AddStream, **MOrErr, CombinedIndex,
+                     ImportList, ModuleToDefinedGVSummaries[Main.second],
+                     ModuleMap);
+}
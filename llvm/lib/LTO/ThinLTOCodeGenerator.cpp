@@ -1060,11 +1060,20 @@ void ThinLTOCodeGenerator::run() {
     ModuleToDefinedGVSummaries[ModuleIdentifier];
   }
 
+  // Start the most expensive modules first, as estimated from the summary.
   std::vector<BitcodeModule *> ModulesVec;
+  std::vector<uint64_t> Costs;
   ModulesVec.reserve(Modules.size());
-  for (auto &Mod : Modules)
+  Costs.reserve(Modules.size());
+  for (auto &Mod : Modules) {
+    auto ModuleIdentifier = Mod->getName();
     ModulesVec.push_back(&Mod->getSingleBitcodeModule());
-  std::vector<int> ModulesOrdering = lto::generateModulesOrdering(ModulesVec);
+    Costs.push_back(lto::estimateThinBackendCost(
+        *Index, ModuleToDefinedGVSummaries[ModuleIdentifier],
+        ImportLists[ModuleIdentifier]));
+  }
+  std::vector<int> ModulesOrdering =
+      lto::generateModulesOrdering(ModulesVec, Costs);
 
   // Parallel optimizer + codegen
   {
@@ -68,6 +68,8 @@ STATISTIC(evaluateFixup, "Number of evaluated fixups");
 STATISTIC(FragmentLayouts, "Number of fragment layouts");
 STATISTIC(ObjectBytes, "Number of emitted object file bytes");
 STATISTIC(RelaxationSteps, "Number of assembler layout and relaxation steps");
+STATISTIC(SectionRelaxationSteps,
+          "Number of assembler layout and relaxation steps of a section");
 STATISTIC(RelaxedInstructions, "Number of relaxed instructions");
 
 } // end namespace stats
@@ -844,14 +846,16 @@ void MCAssembler::layout(MCAsmLayout &Layout) {
   }
 
   // Layout until everything fits.
-  while (layoutOnce(Layout)) {
+  unsigned FirstStable = Sections.size();
+  while ((FirstStable = layoutOnce(Layout, FirstStable)) > 0) {
     if (getContext().hadError())
       return;
     // Size of fragments in one section can depend on the size of fragments in
-    // another. If any fragment has changed size, we have to re-layout (and
-    // as a result possibly further relax) all.
-    for (MCSection &Sec : *this)
-      Layout.invalidateFragmentsFrom(&*Sec.begin());
+    // another. The sections before the last one that changed size were
+    // relaxed against stale sizes, so we have to re-layout (and as a result
+    // possibly further relax) them. The sections from it on are stable.
+    for (unsigned I = 0; I != FirstStable; ++I)
+      Layout.invalidateFragmentsFrom(&*Sections[I]->begin());
   }
 
   DEBUG_WITH_TYPE("mc-dump", {
@@ -1231,6 +1235,8 @@ bool MCAssembler::relaxFragment(MCAsmLayout &Layout, MCFragment &F) {
 }
 
 bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
+  ++stats::SectionRelaxationSteps;
+
   // Holds the first fragment which needed relaxing during this layout. It will
   // remain NULL if none were relaxed.
   // When a fragment is relaxed, all the fragments following it should get
@@ -1251,16 +1257,16 @@ bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
   return false;
 }
 
-bool MCAssembler::layoutOnce(MCAsmLayout &Layout) {
+unsigned MCAssembler::layoutOnce(MCAsmLayout &Layout, unsigned FirstStable) {
   ++stats::RelaxationSteps;
 
-  bool WasRelaxed = false;
-  for (MCSection &Sec : *this) {
-    while (layoutSectionOnce(Layout, Sec))
-      WasRelaxed = true;
+  unsigned LastRelaxed = 0;
+  for (unsigned I = 0; I != FirstStable; ++I) {
+    while (layoutSectionOnce(Layout, *Sections[I]))
+      LastRelaxed = I;
   }
 
-  return WasRelaxed;
+  return LastRelaxed;
 }
 
 void MCAssembler::finishLayout(MCAsmLayout &Layout) {
@@ -532,6 +532,18 @@ static void CheckBundleSubtargets(const MCSubtargetInfo *OldSTI,
 void MCELFStreamer::emitInstToData(const MCInst &Inst,
                                    const MCSubtargetInfo &STI) {
   MCAssembler &Assembler = getAssembler();
+
+  // If bundling is disabled, append the encoded instruction to the current data
+  // fragment (or create a new such fragment if the current fragment is not a
+  // data fragment, or the Subtarget has changed).
+  if (!Assembler.isBundlingEnabled()) {
+    MCDataFragment *DF = getOrCreateDataFragment(&STI);
+    size_t FirstFixup = appendInstToDataFragment(Inst, STI, *DF);
+    for (const MCFixup &Fixup : makeArrayRef(DF->getFixups()).slice(FirstFixup))
+      fixSymbolsInTLSFixups(Fixup.getValue());
+    return;
+  }
+
   SmallVector<MCFixup, 4> Fixups;
   SmallString<256> Code;
   raw_svector_ostream VecOS(Code);
@@ -540,13 +552,7 @@ void MCELFStreamer::emitInstToData(const MCInst &Inst,
   for (unsigned i = 0, e = Fixups.size(); i != e; ++i)
     fixSymbolsInTLSFixups(Fixups[i].getValue());
 
-  // There are several possibilities here:
-  //
-  // If bundling is disabled, append the encoded instruction to the current data
-  // fragment (or create a new such fragment if the current fragment is not a
-  // data fragment, or the Subtarget has changed).
-  //
-  // If bundling is enabled:
+  // There are several possibilities here, as bundling is enabled:
   // - If we're not in a bundle-locked group, emit the instruction into a
   //   fragment of its own. If there are no fixups registered for the
   //   instruction, emit a MCCompactEncodedInstFragment. Otherwise, emit a
@@ -556,53 +562,48 @@ void MCELFStreamer::emitInstToData(const MCInst &Inst,
   //   the same fragment. Be careful not to do that for the first instruction in
   //   the group, though.
   MCDataFragment *DF;
-
-  if (Assembler.isBundlingEnabled()) {
-    MCSection &Sec = *getCurrentSectionOnly();
-    if (Assembler.getRelaxAll() && isBundleLocked()) {
-      // If the -mc-relax-all flag is used and we are bundle-locked, we re-use
-      // the current bundle group.
-      DF = BundleGroups.back();
-      CheckBundleSubtargets(DF->getSubtargetInfo(), &STI);
-    }
-    else if (Assembler.getRelaxAll() && !isBundleLocked())
-      // When not in a bundle-locked group and the -mc-relax-all flag is used,
-      // we create a new temporary fragment which will be later merged into
-      // the current fragment.
-      DF = new MCDataFragment();
-    else if (isBundleLocked() && !Sec.isBundleGroupBeforeFirstInst()) {
-      // If we are bundle-locked, we re-use the current fragment.
-      // The bundle-locking directive ensures this is a new data fragment.
-      DF = cast<MCDataFragment>(getCurrentFragment());
-      CheckBundleSubtargets(DF->getSubtargetInfo(), &STI);
-    }
-    else if (!isBundleLocked() && Fixups.size() == 0) {
-      // Optimize memory usage by emitting the instruction to a
-      // MCCompactEncodedInstFragment when not in a bundle-locked group and
-      // there are no fixups registered.
-      MCCompactEncodedInstFragment *CEIF = new MCCompactEncodedInstFragment();
-      insert(CEIF);
-      CEIF->getContents().append(Code.begin(), Code.end());
-      CEIF->setHasInstructions(STI);
-      return;
-    } else {
-      DF = new MCDataFragment();
-      insert(DF);
-    }
-    if (Sec.getBundleLockState() == MCSection::BundleLockedAlignToEnd) {
-      // If this fragment is for a group marked "align_to_end", set a flag
-      // in the fragment. This can happen after the fragment has already been
-      // created if there are nested bundle_align groups and an inner one
-      // is the one marked align_to_end.
-      DF->setAlignToBundleEnd(true);
-    }
-
-    // We're now emitting an instruction in a bundle group, so this flag has
-    // to be turned off.
-    Sec.setBundleGroupBeforeFirstInst(false);
+  MCSection &Sec = *getCurrentSectionOnly();
+  if (Assembler.getRelaxAll() && isBundleLocked()) {
+    // If the -mc-relax-all flag is used and we are bundle-locked, we re-use
+    // the current bundle group.
+    DF = BundleGroups.back();
+    CheckBundleSubtargets(DF->getSubtargetInfo(), &STI);
+  }
+  else if (Assembler.getRelaxAll() && !isBundleLocked())
+    // When not in a bundle-locked group and the -mc-relax-all flag is used,
+    // we create a new temporary fragment which will be later merged into
+    // the current fragment.
+    DF = new MCDataFragment();
+  else if (isBundleLocked() && !Sec.isBundleGroupBeforeFirstInst()) {
+    // If we are bundle-locked, we re-use the current fragment.
+    // The bundle-locking directive ensures this is a new data fragment.
+    DF = cast<MCDataFragment>(getCurrentFragment());
+    CheckBundleSubtargets(DF->getSubtargetInfo(), &STI);
+  }
+  else if (!isBundleLocked() && Fixups.size() == 0) {
+    // Optimize memory usage by emitting the instruction to a
+    // MCCompactEncodedInstFragment when not in a bundle-locked group and
+    // there are no fixups registered.
+    MCCompactEncodedInstFragment *CEIF = new MCCompactEncodedInstFragment();
+    insert(CEIF);
+    CEIF->getContents().append(Code.begin(), Code.end());
+    CEIF->setHasInstructions(STI);
+    return;
   } else {
-    DF = getOrCreateDataFragment(&STI);
+    DF = new MCDataFragment();
+    insert(DF);
   }
+  if (Sec.getBundleLockState() == MCSection::BundleLockedAlignToEnd) {
+    // If this fragment is for a group marked "align_to_end", set a flag
+    // in the fragment. This can happen after the fragment has already been
+    // created if there are nested bundle_align groups and an inner one
+    // is the one marked align_to_end.
+    DF->setAlignToBundleEnd(true);
+  }
+
+  // We're now emitting an instruction in a bundle group, so this flag has
+  // to be turned off.
+  Sec.setBundleGroupBeforeFirstInst(false);
 
   // Add the fixups and data.
   for (unsigned i = 0, e = Fixups.size(); i != e; ++i) {
@@ -612,7 +613,7 @@ void MCELFStreamer::emitInstToData(const MCInst &Inst,
   DF->setHasInstructions(STI);
   DF->getContents().append(Code.begin(), Code.end());
 
-  if (Assembler.isBundlingEnabled() && Assembler.getRelaxAll()) {
+  if (Assembler.getRelaxAll()) {
     if (!isBundleLocked()) {
       mergeFragment(getOrCreateDataFragment(&STI), DF);
       delete DF;
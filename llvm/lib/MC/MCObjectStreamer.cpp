@@ -424,11 +424,28 @@ void MCObjectStreamer::emitInstToFragment(const MCInst &Inst,
   MCRelaxableFragment *IF = new MCRelaxableFragment(Inst, STI);
   insert(IF);
 
-  SmallString<128> Code;
-  raw_svector_ostream VecOS(Code);
+  raw_svector_ostream VecOS(IF->getContents());
   getAssembler().getEmitter().encodeInstruction(Inst, VecOS, IF->getFixups(),
                                                 STI);
-  IF->getContents().append(Code.begin(), Code.end());
+}
+
+size_t MCObjectStreamer::appendInstToDataFragment(const MCInst &Inst,
+                                                  const MCSubtargetInfo &STI,
+                                                  MCDataFragment &DF) {
+  SmallVectorImpl<char> &Contents = DF.getContents();
+  SmallVectorImpl<MCFixup> &Fixups = DF.getFixups();
+  const uint32_t Offset = Contents.size();
+  const size_t FirstFixup = Fixups.size();
+
+  // Code emitters append to the stream and give the fixup offsets relative to
+  // the start of the instruction, so they can write into the fragment.
+  raw_svector_ostream VecOS(Contents);
+  getAssembler().getEmitter().encodeInstruction(Inst, VecOS, Fixups, STI);
+  for (size_t I = FirstFixup, E = Fixups.size(); I != E; ++I)
+    Fixups[I].setOffset(Fixups[I].getOffset() + Offset);
+
+  DF.setHasInstructions(STI);
+  return FirstFixup;
 }
 
 #ifndef NDEBUG
@@ -160,23 +160,9 @@ void MCWasmStreamer::emitInstToFragment(const MCInst &Inst,
 
 void MCWasmStreamer::emitInstToData(const MCInst &Inst,
                                     const MCSubtargetInfo &STI) {
-  MCAssembler &Assembler = getAssembler();
-  SmallVector<MCFixup, 4> Fixups;
-  SmallString<256> Code;
-  raw_svector_ostream VecOS(Code);
-  Assembler.getEmitter().encodeInstruction(Inst, VecOS, Fixups, STI);
-
   // Append the encoded instruction to the current data fragment (or create a
   // new such fragment if the current fragment is not a data fragment).
-  MCDataFragment *DF = getOrCreateDataFragment();
-
-  // Add the fixups and data.
-  for (unsigned I = 0, E = Fixups.size(); I != E; ++I) {
-    Fixups[I].setOffset(Fixups[I].getOffset() + DF->getContents().size());
-    DF->getFixups().push_back(Fixups[I]);
-  }
-  DF->setHasInstructions(STI);
-  DF->getContents().append(Code.begin(), Code.end());
+  appendInstToDataFragment(Inst, STI, *getOrCreateDataFragment());
 }
 
 void MCWasmStreamer::finishImpl() {
@@ -50,20 +50,7 @@ MCWinCOFFStreamer::MCWinCOFFStreamer(MCContext &Context,
 
 void MCWinCOFFStreamer::emitInstToData(const MCInst &Inst,
                                        const MCSubtargetInfo &STI) {
-  MCDataFragment *DF = getOrCreateDataFragment();
-
-  SmallVector<MCFixup, 4> Fixups;
-  SmallString<256> Code;
-  raw_svector_ostream VecOS(Code);
-  getAssembler().getEmitter().encodeInstruction(Inst, VecOS, Fixups, STI);
-
-  // Add the fixups and data.
-  for (unsigned i = 0, e = Fixups.size(); i != e; ++i) {
-    Fixups[i].setOffset(Fixups[i].getOffset() + DF->getContents().size());
-    DF->getFixups().push_back(Fixups[i]);
-  }
-  DF->setHasInstructions(STI);
-  DF->getContents().append(Code.begin(), Code.end());
+  appendInstToDataFragment(Inst, STI, *getOrCreateDataFragment());
 }
 
 void MCWinCOFFStreamer::InitSections(bool NoExecStack) {
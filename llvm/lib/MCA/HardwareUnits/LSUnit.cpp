@@ -41,6 +41,19 @@ LSUnitBase::LSUnitBase(const MCSchedModel &SM, unsigned LQ, unsigned SQ,
 
 LSUnitBase::~LSUnitBase() {}
 
+unsigned LSUnitBase::getCacheMissLatency() {
+  unsigned Latency = 0;
+  for (unsigned I = 0, E = CacheLevels.size(); I < E; ++I) {
+    CacheMissCredits[I] += CacheLevels[I].MissRate;
+    if (CacheMissCredits[I] < 100)
+      break;
+    // This load misses the level, and goes on to the next one.
+    CacheMissCredits[I] -= 100;
+    Latency += CacheLevels[I].MissLatency;
+  }
+  return Latency;
+}
+
 void LSUnitBase::cycleEvent() {
   for (const std::pair<unsigned, std::unique_ptr<MemoryGroup>> &G : Groups)
     G.second->cycleEvent();
@@ -78,8 +78,12 @@ void Scheduler::issueInstructionImpl(
   Resources->issueInstruction(D, UsedResources);
 
   // Notify the instruction that it started executing.
-  // This updates the internal state of each write.
-  IS->execute(IR.getSourceIndex());
+  // This updates the internal state of each write. Loads also pay for the
+  // data cache misses modeled by the LSUnit.
+  unsigned ExtraLatency = 0;
+  if (IS->isMemOp() && D.MayLoad)
+    ExtraLatency = LSU.getCacheMissLatency();
+  IS->execute(IR.getSourceIndex(), ExtraLatency);
 
   IS->computeCriticalRegDep();
 
@@ -50,10 +50,10 @@ void ReadState::writeStartEvent(unsigned IID, MCPhysReg RegID, unsigned Cycles)
   }
 }
 
-void WriteState::onInstructionIssued(unsigned IID) {
+void WriteState::onInstructionIssued(unsigned IID, unsigned ExtraLatency) {
   assert(CyclesLeft == UNKNOWN_CYCLES);
   // Update the number of cycles left based on the WriteDescriptor info.
-  CyclesLeft = getLatency();
+  CyclesLeft = getLatency() + ExtraLatency;
 
   // Now that the time left before write-back is known, notify
   // all the users.
@@ -165,15 +165,15 @@ void Instruction::dispatch(unsigned RCUToken) {
     updatePending();
 }
 
-void Instruction::execute(unsigned IID) {
+void Instruction::execute(unsigned IID, unsigned ExtraLatency) {
   assert(Stage == IS_READY);
   Stage = IS_EXECUTING;
 
   // Set the cycles left before the write-back stage.
-  CyclesLeft = getLatency();
+  CyclesLeft = getLatency() + ExtraLatency;
 
   for (WriteState &WS : getDefs())
-    WS.onInstructionIssued(IID);
+    WS.onInstructionIssued(IID, ExtraLatency);
 
   // Transition to the "executed" stage if this is a zero-latency instruction.
   if (!CyclesLeft)
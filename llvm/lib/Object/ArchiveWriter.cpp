@@ -25,6 +25,7 @@
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SmallVectorMemoryBuffer.h"
 #include "llvm/Support/ToolOutputFile.h"
@@ -402,6 +403,35 @@ getSymbols(MemoryBufferRef Buf, raw_ostream &SymNames, bool &HasObject) {
   return Ret;
 }
 
+namespace {
+// The symbols of one member, with the offsets of their names in Names. They
+// are computed independently of the other members, so that the members can be
+// parsed in parallel.
+struct MemberSymbols {
+  SmallString<0> Names;
+  Optional<Expected<std::vector<unsigned>>> Offsets;
+  bool HasObject = false;
+};
+} // namespace
+
+static void computeMemberSymbols(const NewArchiveMember &M,
+                                 MemberSymbols &Ret) {
+  raw_svector_ostream Names(Ret.Names);
+  if (!M.Symbols) {
+    Ret.Offsets.emplace(
+        getSymbols(M.Buf->getMemBufferRef(), Names, Ret.HasObject));
+    return;
+  }
+
+  std::vector<unsigned> Offsets;
+  for (StringRef Name : *M.Symbols) {
+    Offsets.push_back(Names.tell());
+    Names << Name << '\0';
+  }
+  Ret.HasObject = true;
+  Ret.Offsets.emplace(std::move(Offsets));
+}
+
 static Expected<std::vector<MemberData>>
 computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
                   object::Archive::Kind Kind, bool Thin, bool Deterministic,
@@ -506,18 +536,40 @@ computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
                       ModTime, Size);
     Out.flush();
 
-    std::vector<unsigned> Symbols;
-    if (NeedSymbols) {
-      Expected<std::vector<unsigned>> SymbolsOrErr =
-          getSymbols(Buf, SymNames, HasObject);
-      if (auto E = SymbolsOrErr.takeError())
-        return std::move(E);
-      Symbols = std::move(*SymbolsOrErr);
-    }
-
     Pos += Header.size() + Data.size() + Padding.size();
-    Ret.push_back({std::move(Symbols), std::move(Header), Data, Padding});
+    Ret.push_back({{}, std::move(Header), Data, Padding});
   }
+
+  if (NeedSymbols) {
+    // Parsing the members dominates the time it takes to write a large
+    // archive, so do it in parallel and then concatenate the symbol names in
+    // member order, which keeps the output deterministic.
+    std::vector<MemberSymbols> Symbols(NewMembers.size());
+    parallelForEachN(0, NewMembers.size(), [&](size_t I) {
+      computeMemberSymbols(NewMembers[I], Symbols[I]);
+    });
+
+    Error Err = Error::success();
+    for (size_t I = 0, E = Symbols.size(); I != E; ++I) {
+      Expected<std::vector<unsigned>> &OffsetsOrErr = *Symbols[I].Offsets;
+      if (!OffsetsOrErr) {
+        // Report the error of the first member that failed.
+        if (Err)
+          consumeError(OffsetsOrErr.takeError());
+        else
+          Err = OffsetsOrErr.takeError();
+        continue;
+      }
+      uint64_t Base = SymNames.tell();
+      for (unsigned Offset : *OffsetsOrErr)
+        Ret[I].Symbols.push_back(Base + Offset);
+      SymNames << Symbols[I].Names;
+      HasObject |= Symbols[I].HasObject;
+    }
+    if (Err)
+      return std::move(Err);
+  }
+
   // If there are no symbols, emit an empty symbol table, to satisfy Solaris
   // tools, older versions of which expect a symbol table in a non-empty
   // archive, regardless of whether there are any symbols in it.
@@ -19,14 +19,14 @@ using namespace object;
 
 Expected<Decompressor> Decompressor::create(StringRef Name, StringRef Data,
                                             bool IsLE, bool Is64Bit) {
-  if (!zlib::isAvailable())
-    return createError("zlib is not available");
-
   Decompressor D(Data);
   Error Err = isGnuStyle(Name) ? D.consumeCompressedGnuHeader()
                                : D.consumeCompressedZLibHeader(Is64Bit, IsLE);
   if (Err)
     return std::move(Err);
+  if (!compression::isAvailable(D.CompressionType))
+    return createError(Twine(compression::getName(D.CompressionType)) +
+                       " is not available");
   return D;
 }
 
@@ -57,10 +57,17 @@ Error Decompressor::consumeCompressedZLibHeader(bool Is64Bit,
 
   DataExtractor Extractor(SectionData, IsLittleEndian, 0);
   uint64_t Offset = 0;
-  if (Extractor.getUnsigned(&Offset, Is64Bit ? sizeof(Elf64_Word)
-                                             : sizeof(Elf32_Word)) !=
-      ELFCOMPRESS_ZLIB)
+  switch (Extractor.getUnsigned(&Offset, Is64Bit ? sizeof(Elf64_Word)
+                                                 : sizeof(Elf32_Word))) {
+  case ELFCOMPRESS_ZLIB:
+    CompressionType = compression::Format::Zlib;
+    break;
+  case ELFCOMPRESS_ZSTD:
+    CompressionType = compression::Format::Zstd;
+    break;
+  default:
     return createError("unsupported compression type");
+  }
 
   // Skip Elf64_Chdr::ch_reserved field.
   if (Is64Bit)
@@ -94,5 +101,6 @@ bool Decompressor::isCompressedELFSection(uint64_t Flags, StringRef Name) {
 
 Error Decompressor::decompress(MutableArrayRef<char> Buffer) {
   size_t Size = Buffer.size();
-  return zlib::uncompress(SectionData, Buffer.data(), Size);
+  return compression::uncompress(CompressionType, SectionData, Buffer.data(),
+                                 Size);
 }
@@ -183,9 +183,11 @@ ObjectFile::createObjectFile(MemoryBufferRef Object, file_magic Type,
 }
 
 Expected<OwningBinary<ObjectFile>>
-ObjectFile::createObjectFile(StringRef ObjectPath) {
+ObjectFile::createObjectFile(StringRef ObjectPath, unsigned Hints) {
   ErrorOr<std::unique_ptr<MemoryBuffer>> FileOrErr =
-      MemoryBuffer::getFile(ObjectPath);
+      MemoryBuffer::getFile(ObjectPath, /*FileSize=*/-1,
+                            /*RequiresNullTerminator=*/true,
+                            /*IsVolatile=*/false, Hints);
   if (std::error_code EC = FileOrErr.getError())
     return errorCodeToError(EC);
   std::unique_ptr<MemoryBuffer> Buffer = std::move(FileOrErr.get());
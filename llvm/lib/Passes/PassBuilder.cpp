@@ -115,6 +115,7 @@
 #include "llvm/Transforms/IPO/SampleProfileProbe.h"
 #include "llvm/Transforms/IPO/StripDeadPrototypes.h"
 #include "llvm/Transforms/IPO/StripSymbols.h"
+#include "llvm/Transforms/IPO/StructFieldReorder.h"
 #include "llvm/Transforms/IPO/SyntheticCountsPropagation.h"
 #include "llvm/Transforms/IPO/WholeProgramDevirt.h"
 #include "llvm/Transforms/InstCombine/InstCombine.h"
@@ -267,6 +268,11 @@ static cl::opt<bool> EnableMemProfiler("enable-mem-prof", cl::init(false),
                                        cl::Hidden, cl::ZeroOrMore,
                                        cl::desc("Enable memory profiler"));
 
+static cl::opt<bool> EnableStructFieldReorder(
+    "enable-struct-field-reorder", cl::init(false), cl::Hidden,
+    cl::desc("Reorder struct fields by their profile counts in the LTO "
+             "pipeline"));
+
 static cl::opt<bool> PerformMandatoryInliningsFirst(
     "mandatory-inlining-first", cl::init(true), cl::Hidden, cl::ZeroOrMore,
     cl::desc("Perform mandatory inlinings module-wide, before performing "
@@ -289,6 +295,7 @@ extern cl::opt<bool> EnableConstraintElimination;
 extern cl::opt<bool> EnableGVNHoist;
 extern cl::opt<bool> EnableGVNSink;
 extern cl::opt<bool> EnableHotColdSplit;
+extern cl::opt<std::string> MemProfProfileFile;
 extern cl::opt<bool> EnableOrderFileInstrumentation;
 extern cl::opt<bool> EnableCHR;
 extern cl::opt<bool> EnableUnrollAndJam;
@@ -1349,6 +1356,12 @@ PassBuilder::buildModuleOptimizationPipeline(OptimizationLevel Level,
   for (auto &C : OptimizerLastEPCallbacks)
     C(MPM, Level);
 
+  // Allocation calls are matched by their inlined call stacks, so use the
+  // memory profile once inlining is done. In the ThinLTO and LTO pre-link
+  // pipelines this is left to the backends.
+  if (!MemProfProfileFile.empty() && !LTOPreLink)
+    MPM.addPass(MemProfUsePass(MemProfProfileFile));
+
   if (PTO.CallGraphProfile)
     MPM.addPass(CGProfilePass());
 
@@ -1640,6 +1653,11 @@ PassBuilder::buildLTODefaultPipeline(OptimizationLevel Level,
   // Optimize globals again after we ran the inliner.
   MPM.addPass(GlobalOptPass());
 
+  // Inlining has merged the accesses to struct fields into fewer functions,
+  // and every non-exported symbol is internal by now.
+  if (EnableStructFieldReorder)
+    MPM.addPass(StructFieldReorderPass());
+
   // Garbage collect dead functions.
   // FIXME: Add ArgumentPromotion pass after once it's ported.
   MPM.addPass(GlobalDCEPass());
@@ -1737,6 +1755,9 @@ PassBuilder::buildLTODefaultPipeline(OptimizationLevel Level,
   if (EnableHotColdSplit)
     MPM.addPass(HotColdSplittingPass());
 
+  if (!MemProfProfileFile.empty())
+    MPM.addPass(MemProfUsePass(MemProfProfileFile));
+
   // Add late LTO optimization passes.
   // Delete basic blocks, which optimization passes may have killed.
   MPM.addPass(createModuleToFunctionPassAdaptor(SimplifyCFGPass()));
@@ -19,6 +19,8 @@
 #include "llvm/Analysis/CallGraphSCCPass.h"
 #include "llvm/Analysis/LazyCallGraph.h"
 #include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/OptimizationRemarkEmitter.h"
+#include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/PassInstrumentation.h"
@@ -596,6 +598,141 @@ bool OptNoneInstrumentation::shouldRun(StringRef PassID, Any IR) {
   return ShouldRun;
 }
 
+static cl::opt<unsigned> FunctionTimeBudget(
+    "function-time-budget", cl::Hidden, cl::init(0),
+    cl::value_desc("milliseconds"),
+    cl::desc("Skip the expensive passes on the functions that have spent "
+             "this long in function and loop passes (0 = no limit)"));
+
+static cl::opt<unsigned> FunctionSizeBudget(
+    "function-size-budget", cl::Hidden, cl::init(0),
+    cl::value_desc("instructions"),
+    cl::desc("Skip the expensive passes on the functions that have more "
+             "instructions than this (0 = no limit)"));
+
+static cl::list<std::string> FunctionBudgetExpensivePasses(
+    "function-budget-expensive-passes", cl::Hidden, cl::CommaSeparated,
+    cl::value_desc("pass names"),
+    cl::desc("The passes that -function-time-budget and -function-size-budget "
+             "skip, instead of the default ones"));
+
+// Those that are known to blow up on large or pathological functions.
+static const char *const DefaultExpensivePasses[] = {
+    "AggressiveInstCombinePass",
+    "CorrelatedValuePropagationPass",
+    "DSEPass",
+    "GVN",
+    "IndVarSimplifyPass",
+    "InstCombinePass",
+    "JumpThreadingPass",
+    "LoopFullUnrollPass",
+    "LoopIdiomRecognizePass",
+    "LoopUnrollPass",
+    "LoopVectorizePass",
+    "MemCpyOptPass",
+    "NewGVNPass",
+    "SLPVectorizerPass",
+};
+
+static const Function *getFunction(Any IR) {
+  if (any_isa<const Function *>(IR))
+    return any_cast<const Function *>(IR);
+  if (any_isa<const Loop *>(IR))
+    return any_cast<const Loop *>(IR)->getHeader()->getParent();
+  return nullptr;
+}
+
+CompileTimeBudgetInstrumentation::CompileTimeBudgetInstrumentation(
+    bool DebugLogging)
+    : DebugLogging(DebugLogging) {
+  if (FunctionBudgetExpensivePasses.empty())
+    ExpensivePasses.insert(std::begin(DefaultExpensivePasses),
+                           std::end(DefaultExpensivePasses));
+  else
+    ExpensivePasses.insert(FunctionBudgetExpensivePasses.begin(),
+                           FunctionBudgetExpensivePasses.end());
+}
+
+void CompileTimeBudgetInstrumentation::registerCallbacks(
+    PassInstrumentationCallbacks &PIC) {
+  if (!FunctionTimeBudget && !FunctionSizeBudget)
+    return;
+
+  PIC.registerShouldRunOptionalPassCallback(
+      [this](StringRef P, Any IR) { return this->shouldRun(P, IR); });
+  PIC.registerBeforeNonSkippedPassCallback(
+      [this](StringRef, Any IR) { this->runBeforePass(IR); });
+  PIC.registerAfterPassCallback(
+      [this](StringRef, Any, const PreservedAnalyses &) {
+        this->runAfterPass();
+      });
+  PIC.registerAfterPassInvalidatedCallback(
+      [this](StringRef, const PreservedAnalyses &) { this->runAfterPass(); });
+}
+
+bool CompileTimeBudgetInstrumentation::shouldRun(StringRef PassID, Any IR) {
+  if (!ExpensivePasses.count(PassID))
+    return true;
+  const Function *F = getFunction(IR);
+  if (!F)
+    return true;
+
+  FunctionBudget &Budget = Budgets[F];
+  if (!Budget.OverBudget) {
+    using namespace std::chrono;
+    auto Spent = Budget.Spent;
+    if (Budget.Depth)
+      Spent += steady_clock::now() - Budget.Start;
+    uint64_t SpentMs = duration_cast<milliseconds>(Spent).count();
+    unsigned TimeBudget = FunctionTimeBudget, SizeBudget = FunctionSizeBudget;
+    bool OverTime = TimeBudget && SpentMs >= TimeBudget;
+    unsigned Size = 0;
+    if (!OverTime && SizeBudget)
+      Size = F->getInstructionCount();
+    if (!OverTime && Size <= SizeBudget)
+      return true;
+
+    OptimizationRemarkAnalysis R("compile-time-budget", "OverBudget",
+                                 F->getSubprogram(), &F->getEntryBlock());
+    if (OverTime)
+      R << "spent " << ore::NV("TimeMs", SpentMs) << " ms in " << F->getName()
+        << ", over the budget of " << ore::NV("BudgetMs", TimeBudget)
+        << " ms";
+    else
+      R << ore::NV("Instructions", Size) << " instructions in "
+        << F->getName() << ", over the budget of "
+        << ore::NV("Budget", SizeBudget);
+    R << "; skipping the expensive passes on it";
+    F->getContext().diagnose(R);
+    Budget.OverBudget = true;
+  }
+
+  if (DebugLogging)
+    errs() << "Skipping pass " << PassID << " on " << F->getName()
+           << " due to its compile-time budget\n";
+  return false;
+}
+
+void CompileTimeBudgetInstrumentation::runBeforePass(Any IR) {
+  const Function *F = getFunction(IR);
+  Running.push_back(F);
+  if (!F)
+    return;
+  FunctionBudget &Budget = Budgets[F];
+  if (Budget.Depth++ == 0)
+    Budget.Start = std::chrono::steady_clock::now();
+}
+
+void CompileTimeBudgetInstrumentation::runAfterPass() {
+  assert(!Running.empty() && "unbalanced pass callbacks");
+  const Function *F = Running.pop_back_val();
+  if (!F)
+    return;
+  FunctionBudget &Budget = Budgets[F];
+  if (--Budget.Depth == 0)
+    Budget.Spent += std::chrono::steady_clock::now() - Budget.Start;
+}
+
 static std::string getBisectDescription(Any IR) {
   if (any_isa<const Module *>(IR)) {
     const Module *M = any_cast<const Module *>(IR);
@@ -861,8 +998,10 @@ void StandardInstrumentations::registerCallbacks(
   PrintIR.registerCallbacks(PIC);
   PrintPass.registerCallbacks(PIC);
   TimePasses.registerCallbacks(PIC);
+  PassCounters.registerCallbacks(PIC);
   OptNone.registerCallbacks(PIC);
   OptBisect.registerCallbacks(PIC);
+  CompileTimeBudget.registerCallbacks(PIC);
   PreservedCFGChecker.registerCallbacks(PIC);
   PrintChangedIR.registerCallbacks(PIC);
   if (VerifyEach)
@@ -27,6 +27,7 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
@@ -34,6 +35,7 @@
 #include <iterator>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <system_error>
 #include <utility>
@@ -203,9 +205,13 @@ ArrayRef<unsigned> CoverageMapping::getImpreciseRecordIndicesForFilename(
   return RecordIt->second;
 }
 
-Error CoverageMapping::loadFunctionRecord(
-    const CoverageMappingRecord &Record,
-    IndexedInstrProfReader &ProfileReader) {
+/// Evaluate the regions of \p Record with the counts in \p ProfileReader.
+/// Returns None if the record does not add a function. If that is because the
+/// profile has another hash for the function, the mismatch is appended to
+/// \p HashMismatches.
+static Expected<Optional<FunctionRecord>> evaluateFunctionRecord(
+    const CoverageMappingRecord &Record, IndexedInstrProfReader &ProfileReader,
+    std::vector<std::pair<std::string, uint64_t>> &HashMismatches) {
   StringRef OrigFuncName = Record.FunctionName;
   if (OrigFuncName.empty())
     return make_error<CoverageMapError>(coveragemap_error::malformed);
@@ -222,9 +228,9 @@ Error CoverageMapping::loadFunctionRecord(
                                                 Record.FunctionHash, Counts)) {
     instrprof_error IPE = InstrProfError::take(std::move(E));
     if (IPE == instrprof_error::hash_mismatch) {
-      FuncHashMismatches.emplace_back(std::string(Record.FunctionName),
-                                      Record.FunctionHash);
-      return Error::success();
+      HashMismatches.emplace_back(std::string(Record.FunctionName),
+                                  Record.FunctionHash);
+      return None;
     } else if (IPE != instrprof_error::unknown_function)
       return make_error<InstrProfError>(IPE);
     Counts.assign(Record.MappingRegions.size(), 0);
@@ -240,23 +246,26 @@ Error CoverageMapping::loadFunctionRecord(
   // when they have non-zero counts in the profile).
   if (Record.MappingRegions.size() == 1 &&
       Record.MappingRegions[0].Count.isZero() && Counts[0] > 0)
-    return Error::success();
+    return None;
 
   FunctionRecord Function(OrigFuncName, Record.Filenames);
   for (const auto &Region : Record.MappingRegions) {
     Expected<int64_t> ExecutionCount = Ctx.evaluate(Region.Count);
     if (auto E = ExecutionCount.takeError()) {
       consumeError(std::move(E));
-      return Error::success();
+      return None;
     }
     Function.pushRegion(Region, *ExecutionCount);
   }
+  return std::move(Function);
+}
 
+void CoverageMapping::addFunctionRecord(FunctionRecord &&Function) {
   // Don't create records for (filenames, function) pairs we've already seen.
-  auto FilenamesHash = hash_combine_range(Record.Filenames.begin(),
-                                          Record.Filenames.end());
-  if (!RecordProvenance[FilenamesHash].insert(hash_value(OrigFuncName)).second)
-    return Error::success();
+  auto FilenamesHash = hash_combine_range(Function.Filenames.begin(),
+                                          Function.Filenames.end());
+  if (!RecordProvenance[FilenamesHash].insert(hash_value(Function.Name)).second)
+    return;
 
   Functions.push_back(std::move(Function));
 
@@ -264,7 +273,7 @@ Error CoverageMapping::loadFunctionRecord(
   // which correspond to each filename. This can be used to substantially speed
   // up queries for coverage info in a file.
   unsigned RecordIndex = Functions.size() - 1;
-  for (StringRef Filename : Record.Filenames) {
+  for (StringRef Filename : Functions.back().Filenames) {
     auto &RecordIndices = FilenameHash2RecordIndices[hash_value(Filename)];
     // Note that there may be duplicates in the filename set for a function
     // record, because of e.g. macro expansions in the function in which both
@@ -272,7 +281,17 @@ Error CoverageMapping::loadFunctionRecord(
     if (RecordIndices.empty() || RecordIndices.back() != RecordIndex)
       RecordIndices.push_back(RecordIndex);
   }
+}
 
+Error CoverageMapping::loadFunctionRecord(
+    const CoverageMappingRecord &Record,
+    IndexedInstrProfReader &ProfileReader) {
+  auto FunctionOrErr =
+      evaluateFunctionRecord(Record, ProfileReader, FuncHashMismatches);
+  if (Error E = FunctionOrErr.takeError())
+    return E;
+  if (*FunctionOrErr)
+    addFunctionRecord(std::move(**FunctionOrErr));
   return Error::success();
 }
 
@@ -304,41 +323,225 @@ static Error handleMaybeNoDataFoundError(Error E) {
       });
 }
 
+/// Create the coverage readers for \p ObjectFilename and append them to
+/// \p Readers. The buffers the readers refer to are appended to \p Buffers.
+/// An object without coverage data adds no readers.
+static Error
+loadCoverageReaders(StringRef ObjectFilename, StringRef Arch,
+                    std::vector<std::unique_ptr<BinaryCoverageReader>> &Readers,
+                    SmallVectorImpl<std::unique_ptr<MemoryBuffer>> &Buffers) {
+  auto CovMappingBufOrErr = MemoryBuffer::getFileOrSTDIN(ObjectFilename);
+  if (std::error_code EC = CovMappingBufOrErr.getError())
+    return errorCodeToError(EC);
+  MemoryBufferRef CovMappingBufRef =
+      CovMappingBufOrErr.get()->getMemBufferRef();
+  auto CoverageReadersOrErr =
+      BinaryCoverageReader::create(CovMappingBufRef, Arch, Buffers);
+  if (Error E = CoverageReadersOrErr.takeError())
+    return handleMaybeNoDataFoundError(std::move(E));
+  for (auto &Reader : CoverageReadersOrErr.get())
+    Readers.push_back(std::move(Reader));
+  Buffers.push_back(std::move(CovMappingBufOrErr.get()));
+  return Error::success();
+}
+
+/// Keep \p E in \p FirstErr unless it already holds an error, in which case
+/// \p E is consumed. This makes parallel loading report the error that
+/// sequential loading would have stopped at.
+static void keepFirstError(Error &FirstErr, Error E) {
+  if (!E)
+    return;
+  if (FirstErr)
+    consumeError(std::move(E));
+  else
+    FirstErr = std::move(E);
+}
+
+namespace {
+
+/// Indexed profile readers for the workers evaluating coverage records.
+/// Lookups reuse buffers of their reader, so workers cannot share one.
+class ProfileReaderPool {
+  StringRef Filename;
+  std::mutex Lock;
+  std::vector<std::unique_ptr<IndexedInstrProfReader>> Readers;
+
+public:
+  ProfileReaderPool(StringRef Filename,
+                    std::unique_ptr<IndexedInstrProfReader> Reader)
+      : Filename(Filename) {
+    Readers.push_back(std::move(Reader));
+  }
+
+  /// Take a reader out of the pool, opening the profile again if all readers
+  /// are in use.
+  Expected<std::unique_ptr<IndexedInstrProfReader>> take() {
+    {
+      std::lock_guard<std::mutex> Guard(Lock);
+      if (!Readers.empty()) {
+        auto Reader = std::move(Readers.back());
+        Readers.pop_back();
+        return std::move(Reader);
+      }
+    }
+    return IndexedInstrProfReader::create(Filename);
+  }
+
+  void giveBack(std::unique_ptr<IndexedInstrProfReader> Reader) {
+    std::lock_guard<std::mutex> Guard(Lock);
+    Readers.push_back(std::move(Reader));
+  }
+};
+
+/// A range of the records of a coverage reader, and the functions evaluated
+/// from them.
+struct FunctionRecordChunk {
+  const BinaryCoverageReader *Reader;
+  size_t Begin;
+  size_t End;
+  std::vector<FunctionRecord> Functions;
+  std::vector<std::pair<std::string, uint64_t>> HashMismatches;
+  Error Err = Error::success();
+
+  FunctionRecordChunk(const BinaryCoverageReader *Reader, size_t Begin,
+                      size_t End)
+      : Reader(Reader), Begin(Begin), End(End) {}
+
+  Error evaluate(IndexedInstrProfReader &ProfileReader) {
+    BinaryCoverageReader::RecordStorage Storage;
+    for (size_t I = Begin; I != End; ++I) {
+      CoverageMappingRecord Record;
+      if (Error E = Reader->readRecord(I, Record, Storage))
+        return E;
+      auto FunctionOrErr =
+          evaluateFunctionRecord(Record, ProfileReader, HashMismatches);
+      if (Error E = FunctionOrErr.takeError())
+        return E;
+      if (*FunctionOrErr)
+        Functions.push_back(std::move(**FunctionOrErr));
+    }
+    return Error::success();
+  }
+};
+
+} // end anonymous namespace
+
+/// The number of coverage records a task decodes and evaluates when coverage
+/// is loaded in parallel.
+static const size_t RecordChunkSize = 512;
+
+Error CoverageMapping::loadFunctionRecordsInParallel(
+    ArrayRef<std::unique_ptr<BinaryCoverageReader>> CoverageReaders,
+    std::unique_ptr<IndexedInstrProfReader> ProfileReader,
+    StringRef ProfileFilename, ThreadPoolStrategy S) {
+  std::vector<FunctionRecordChunk> Chunks;
+  for (const auto &Reader : CoverageReaders)
+    for (size_t I = 0, E = Reader->getNumRecords(); I < E; I += RecordChunkSize)
+      Chunks.emplace_back(Reader.get(), I, std::min(I + RecordChunkSize, E));
+
+  ProfileReaderPool Pool(ProfileFilename, std::move(ProfileReader));
+  ThreadPool Workers(S);
+  for (auto &Chunk : Chunks)
+    Workers.async([&Pool, &Chunk]() {
+      ErrorAsOutParameter EAO(&Chunk.Err);
+      auto ReaderOrErr = Pool.take();
+      if (!ReaderOrErr) {
+        Chunk.Err = ReaderOrErr.takeError();
+        return;
+      }
+      Chunk.Err = Chunk.evaluate(**ReaderOrErr);
+      Pool.giveBack(std::move(*ReaderOrErr));
+    });
+  Workers.wait();
+
+  // Add the functions in the order of the records, so that the result does
+  // not depend on how the chunks were scheduled.
+  Error FirstErr = Error::success();
+  for (auto &Chunk : Chunks)
+    keepFirstError(FirstErr, std::move(Chunk.Err));
+  if (FirstErr)
+    return FirstErr;
+  for (auto &Chunk : Chunks) {
+    for (auto &Function : Chunk.Functions)
+      addFunctionRecord(std::move(Function));
+    FuncHashMismatches.insert(
+        FuncHashMismatches.end(),
+        std::make_move_iterator(Chunk.HashMismatches.begin()),
+        std::make_move_iterator(Chunk.HashMismatches.end()));
+  }
+  return Error::success();
+}
+
 Expected<std::unique_ptr<CoverageMapping>>
 CoverageMapping::load(ArrayRef<StringRef> ObjectFilenames,
-                      StringRef ProfileFilename, ArrayRef<StringRef> Arches) {
+                      StringRef ProfileFilename, ArrayRef<StringRef> Arches,
+                      ThreadPoolStrategy S) {
   auto ProfileReaderOrErr = IndexedInstrProfReader::create(ProfileFilename);
   if (Error E = ProfileReaderOrErr.takeError())
     return std::move(E);
   auto ProfileReader = std::move(ProfileReaderOrErr.get());
 
-  SmallVector<std::unique_ptr<CoverageMappingReader>, 4> Readers;
+  // A profile read from stdin can't be opened again by the workers.
+  bool Parallel = S.compute_thread_count() > 1 && ProfileFilename != "-";
+
+  std::vector<std::unique_ptr<BinaryCoverageReader>> Readers;
   SmallVector<std::unique_ptr<MemoryBuffer>, 4> Buffers;
-  for (const auto &File : llvm::enumerate(ObjectFilenames)) {
-    auto CovMappingBufOrErr = MemoryBuffer::getFileOrSTDIN(File.value());
-    if (std::error_code EC = CovMappingBufOrErr.getError())
-      return errorCodeToError(EC);
-    StringRef Arch = Arches.empty() ? StringRef() : Arches[File.index()];
-    MemoryBufferRef CovMappingBufRef =
-        CovMappingBufOrErr.get()->getMemBufferRef();
-    auto CoverageReadersOrErr =
-        BinaryCoverageReader::create(CovMappingBufRef, Arch, Buffers);
-    if (Error E = CoverageReadersOrErr.takeError()) {
-      E = handleMaybeNoDataFoundError(std::move(E));
-      if (E)
+  if (!Parallel || ObjectFilenames.size() < 2) {
+    for (const auto &File : llvm::enumerate(ObjectFilenames)) {
+      StringRef Arch = Arches.empty() ? StringRef() : Arches[File.index()];
+      if (Error E = loadCoverageReaders(File.value(), Arch, Readers, Buffers))
         return std::move(E);
-      // E == success (originally a no_data_found error).
-      continue;
     }
-    for (auto &Reader : CoverageReadersOrErr.get())
-      Readers.push_back(std::move(Reader));
-    Buffers.push_back(std::move(CovMappingBufOrErr.get()));
+  } else {
+    // Objects are independent, so read their coverage mappings in parallel.
+    // Their readers are still added in the order of the objects.
+    size_t NumObjects = ObjectFilenames.size();
+    std::vector<std::vector<std::unique_ptr<BinaryCoverageReader>>>
+        ObjectReaders(NumObjects);
+    std::vector<SmallVector<std::unique_ptr<MemoryBuffer>, 4>> ObjectBuffers(
+        NumObjects);
+    std::vector<Error> ObjectErrors;
+    for (size_t I = 0; I != NumObjects; ++I)
+      ObjectErrors.push_back(Error::success());
+    ThreadPool Workers(S);
+    for (size_t I = 0; I != NumObjects; ++I)
+      Workers.async([&, I]() {
+        StringRef Arch = Arches.empty() ? StringRef() : Arches[I];
+        ErrorAsOutParameter EAO(&ObjectErrors[I]);
+        ObjectErrors[I] = loadCoverageReaders(
+            ObjectFilenames[I], Arch, ObjectReaders[I], ObjectBuffers[I]);
+      });
+    Workers.wait();
+
+    Error FirstErr = Error::success();
+    for (auto &E : ObjectErrors)
+      keepFirstError(FirstErr, std::move(E));
+    if (FirstErr)
+      return std::move(FirstErr);
+    for (size_t I = 0; I != NumObjects; ++I) {
+      for (auto &Reader : ObjectReaders[I])
+        Readers.push_back(std::move(Reader));
+      for (auto &Buffer : ObjectBuffers[I])
+        Buffers.push_back(std::move(Buffer));
+    }
   }
   // If no readers were created, either no objects were provided or none of them
   // had coverage data. Return an error in the latter case.
   if (Readers.empty() && !ObjectFilenames.empty())
     return make_error<CoverageMapError>(coveragemap_error::no_data_found);
-  return load(Readers, *ProfileReader);
+
+  if (!Parallel) {
+    SmallVector<std::unique_ptr<CoverageMappingReader>, 4> CoverageReaders;
+    for (auto &Reader : Readers)
+      CoverageReaders.push_back(std::move(Reader));
+    return load(CoverageReaders, *ProfileReader);
+  }
+
+  auto Coverage = std::unique_ptr<CoverageMapping>(new CoverageMapping());
+  if (Error E = Coverage->loadFunctionRecordsInParallel(
+          Readers, std::move(ProfileReader), ProfileFilename, S))
+    return std::move(E);
+  return std::move(Coverage);
 }
 
 namespace {
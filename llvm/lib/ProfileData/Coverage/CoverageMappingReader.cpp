@@ -1043,26 +1043,34 @@ BinaryCoverageReader::create(
   return std::move(Readers);
 }
 
-Error BinaryCoverageReader::readNextRecord(CoverageMappingRecord &Record) {
-  if (CurrentRecord >= MappingRecords.size())
-    return make_error<CoverageMapError>(coveragemap_error::eof);
-
-  FunctionsFilenames.clear();
-  Expressions.clear();
-  MappingRegions.clear();
-  auto &R = MappingRecords[CurrentRecord];
+Error BinaryCoverageReader::readRecord(size_t Index,
+                                       CoverageMappingRecord &Record,
+                                       RecordStorage &Storage) const {
+  Storage.Filenames.clear();
+  Storage.Expressions.clear();
+  Storage.MappingRegions.clear();
+  auto &R = MappingRecords[Index];
   RawCoverageMappingReader Reader(
       R.CoverageMapping,
       makeArrayRef(Filenames).slice(R.FilenamesBegin, R.FilenamesSize),
-      FunctionsFilenames, Expressions, MappingRegions);
+      Storage.Filenames, Storage.Expressions, Storage.MappingRegions);
   if (auto Err = Reader.read())
     return Err;
 
   Record.FunctionName = R.FunctionName;
   Record.FunctionHash = R.FunctionHash;
-  Record.Filenames = FunctionsFilenames;
-  Record.Expressions = Expressions;
-  Record.MappingRegions = MappingRegions;
+  Record.Filenames = Storage.Filenames;
+  Record.Expressions = Storage.Expressions;
+  Record.MappingRegions = Storage.MappingRegions;
+  return Error::success();
+}
+
+Error BinaryCoverageReader::readNextRecord(CoverageMappingRecord &Record) {
+  if (CurrentRecord >= MappingRecords.size())
+    return make_error<CoverageMapError>(coveragemap_error::eof);
+
+  if (auto Err = readRecord(CurrentRecord, Record, CurrentStorage))
+    return Err;
 
   ++CurrentRecord;
   return Error::success();
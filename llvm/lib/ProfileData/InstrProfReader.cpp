@@ -39,9 +39,10 @@
 using namespace llvm;
 
 static Expected<std::unique_ptr<MemoryBuffer>>
-setupMemoryBuffer(const Twine &Path) {
+setupMemoryBuffer(const Twine &Path, bool RequiresNullTerminator = true) {
   ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
-      MemoryBuffer::getFileOrSTDIN(Path);
+      MemoryBuffer::getFileOrSTDIN(Path, /*FileSize=*/-1,
+                                   RequiresNullTerminator);
   if (std::error_code EC = BufferOrErr.getError())
     return errorCodeToError(EC);
   return std::move(BufferOrErr.get());
@@ -91,8 +92,11 @@ InstrProfReader::create(std::unique_ptr<MemoryBuffer> Buffer) {
 
 Expected<std::unique_ptr<IndexedInstrProfReader>>
 IndexedInstrProfReader::create(const Twine &Path, const Twine &RemappingPath) {
-  // Set up the buffer to read.
-  auto BufferOrError = setupMemoryBuffer(Path);
+  // Set up the buffer to read. The indexed format does not need a null
+  // terminator, so the file is always mapped rather than read, and a lookup
+  // only touches the pages of the hash table it probes.
+  auto BufferOrError =
+      setupMemoryBuffer(Path, /*RequiresNullTerminator=*/false);
   if (Error E = BufferOrError.takeError())
     return std::move(E);
 
@@ -676,8 +680,49 @@ public:
   }
 
   Error populateRemappings() override {
-    if (Error E = Remappings.read(*RemapBuffer))
+    return Remappings.read(*RemapBuffer);
+  }
+
+  Error getRecords(StringRef FuncName,
+                   ArrayRef<NamedInstrProfRecord> &Data) override {
+    // Most functions are found under their own name, so only look through
+    // the remappings for the ones that are not.
+    Error E = Underlying.getRecords(FuncName, Data);
+    if (!E)
       return E;
+    if (Error Unhandled = handleErrors(
+            std::move(E), [](std::unique_ptr<InstrProfError> Err) {
+              return Err->get() == instrprof_error::unknown_function
+                         ? Error::success()
+                         : Error(std::move(Err));
+            }))
+      return Unhandled;
+
+    populateMappedNames();
+    StringRef RealName = extractName(FuncName);
+    StringRef Remapped;
+    if (auto Key = Remappings.lookup(RealName))
+      Remapped = MappedNames.lookup(Key);
+    if (Remapped.empty())
+      return make_error<InstrProfError>(instrprof_error::unknown_function);
+    if (RealName.begin() == FuncName.begin() &&
+        RealName.end() == FuncName.end())
+      return Underlying.getRecords(Remapped, Data);
+
+    // Rebuild the name from the given remapping.
+    SmallString<256> Reconstituted;
+    reconstituteName(FuncName, RealName, Remapped, Reconstituted);
+    return Underlying.getRecords(Reconstituted, Data);
+  }
+
+private:
+  /// Map the names in the profile to their equivalence classes. This walks
+  /// every key of the on-disk hash table, so it is only done once a function
+  /// cannot be found under its own name.
+  void populateMappedNames() {
+    if (MappedNamesPopulated)
+      return;
+    MappedNamesPopulated = true;
     for (StringRef Name : Underlying.HashTable->keys()) {
       StringRef RealName = extractName(Name);
       if (auto Key = Remappings.insert(RealName)) {
@@ -687,42 +732,8 @@ public:
         MappedNames.insert({Key, RealName});
       }
     }
-    return Error::success();
   }
 
-  Error getRecords(StringRef FuncName,
-                   ArrayRef<NamedInstrProfRecord> &Data) override {
-    StringRef RealName = extractName(FuncName);
-    if (auto Key = Remappings.lookup(RealName)) {
-      StringRef Remapped = MappedNames.lookup(Key);
-      if (!Remapped.empty()) {
-        if (RealName.begin() == FuncName.begin() &&
-            RealName.end() == FuncName.end())
-          FuncName = Remapped;
-        else {
-          // Try rebuilding the name from the given remapping.
-          SmallString<256> Reconstituted;
-          reconstituteName(FuncName, RealName, Remapped, Reconstituted);
-          Error E = Underlying.getRecords(Reconstituted, Data);
-          if (!E)
-            return E;
-
-          // If we failed because the name doesn't exist, fall back to asking
-          // about the original name.
-          if (Error Unhandled = handleErrors(
-                  std::move(E), [](std::unique_ptr<InstrProfError> Err) {
-                    return Err->get() == instrprof_error::unknown_function
-                               ? Error::success()
-                               : Error(std::move(Err));
-                  }))
-            return Unhandled;
-        }
-      }
-    }
-    return Underlying.getRecords(FuncName, Data);
-  }
-
-private:
   /// The memory buffer containing the remapping configuration. Remappings
   /// holds pointers into this buffer.
   std::unique_ptr<MemoryBuffer> RemapBuffer;
@@ -736,6 +747,9 @@ private:
   /// redoing lookup?
   DenseMap<SymbolRemappingReader::Key, StringRef> MappedNames;
 
+  /// Whether MappedNames has been built.
+  bool MappedNamesPopulated = false;
+
   /// The real profile data reader.
   InstrProfReaderIndex<HashTableImpl> &Underlying;
 };
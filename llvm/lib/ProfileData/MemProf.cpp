@@ -0,0 +1,147 @@
+//===- MemProf.cpp - Read memory profiles ---------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the reader for the text memory profiles written by the
+// memprof runtime.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ProfileData/MemProf.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Errc.h"
+#include "llvm/Support/LineIterator.h"
+#include <algorithm>
+#include <tuple>
+
+using namespace llvm;
+using namespace llvm::memprof;
+
+static double mergeAverage(double A, uint64_t CountA, double B,
+                           uint64_t CountB) {
+  if (!CountA && !CountB)
+    return 0;
+  return (A * CountA + B * CountB) / (CountA + CountB);
+}
+
+void AllocationInfo::merge(const AllocationInfo &Other) {
+  AveSize = mergeAverage(AveSize, AllocCount, Other.AveSize, Other.AllocCount);
+  AveAccessCount = mergeAverage(AveAccessCount, AllocCount,
+                                Other.AveAccessCount, Other.AllocCount);
+  AveLifetime = mergeAverage(AveLifetime, AllocCount, Other.AveLifetime,
+                             Other.AllocCount);
+  AllocCount += Other.AllocCount;
+  MinSize = std::min(MinSize, Other.MinSize);
+  MaxSize = std::max(MaxSize, Other.MaxSize);
+  MinAccessCount = std::min(MinAccessCount, Other.MinAccessCount);
+  MaxAccessCount = std::max(MaxAccessCount, Other.MaxAccessCount);
+  MinLifetime = std::min(MinLifetime, Other.MinLifetime);
+  MaxLifetime = std::max(MaxLifetime, Other.MaxLifetime);
+  NumMigratedCpu += Other.NumMigratedCpu;
+  NumLifetimeOverlaps += Other.NumLifetimeOverlaps;
+  NumSameAllocCpu += Other.NumSameAllocCpu;
+  NumSameDeallocCpu += Other.NumSameDeallocCpu;
+}
+
+static Error malformed(const line_iterator &Line, const Twine &Message) {
+  return make_error<StringError>("memory profile line " +
+                                     Twine(Line.line_number()) + ": " +
+                                     Message,
+                                 make_error_code(errc::illegal_byte_sequence));
+}
+
+/// Parse a MIB line, without its "MIB:" prefix.
+static bool parseMIB(StringRef Text, AllocationInfo &Info) {
+  SmallVector<StringRef, 15> Fields;
+  Text.split(Fields, '/');
+  if (Fields.size() != 15)
+    return false;
+  std::pair<unsigned, uint64_t *> Integers[] = {
+      {0, &Info.StackId},          {1, &Info.AllocCount},
+      {3, &Info.MinSize},          {4, &Info.MaxSize},
+      {6, &Info.MinAccessCount},   {7, &Info.MaxAccessCount},
+      {9, &Info.MinLifetime},      {10, &Info.MaxLifetime},
+      {11, &Info.NumMigratedCpu},  {12, &Info.NumLifetimeOverlaps},
+      {13, &Info.NumSameAllocCpu}, {14, &Info.NumSameDeallocCpu}};
+  for (auto &Integer : Integers)
+    if (Fields[Integer.first].getAsInteger(10, *Integer.second))
+      return false;
+  return to_float(Fields[2], Info.AveSize) &&
+         to_float(Fields[5], Info.AveAccessCount) &&
+         to_float(Fields[8], Info.AveLifetime);
+}
+
+/// Parse a STK line, without its "STK:" prefix. Function names may contain
+/// slashes, so the line and column are taken from the end.
+static bool parseFrame(StringRef Text, uint64_t &StackId, Frame &F) {
+  StringRef Id, Rest, LineStr, ColumnStr;
+  std::tie(Id, Rest) = Text.split('/');
+  std::tie(Rest, ColumnStr) = Rest.rsplit('/');
+  std::tie(Rest, LineStr) = Rest.rsplit('/');
+  if (Id.getAsInteger(10, StackId) || LineStr.getAsInteger(10, F.Line) ||
+      ColumnStr.getAsInteger(10, F.Column) || Rest.empty())
+    return false;
+  F.Function = Rest.str();
+  return true;
+}
+
+Error MemProfReader::read(const MemoryBuffer &Buffer) {
+  DenseMap<uint64_t, size_t> AllocationIndex;
+  // The context whose call stack follows, if it was described for the first
+  // time. Later descriptions repeat the same stack.
+  Optional<size_t> StackOwner;
+  for (line_iterator Line(Buffer, /*SkipBlanks=*/true); !Line.is_at_eof();
+       ++Line) {
+    StringRef Text = Line->trim();
+    if (Text.consume_front("MIB:")) {
+      if (Text.startswith("StackID/"))
+        continue;
+      AllocationInfo Info;
+      if (!parseMIB(Text, Info))
+        return malformed(Line, "invalid MIB");
+      auto Inserted =
+          AllocationIndex.insert({Info.StackId, Allocations.size()});
+      if (!Inserted.second) {
+        Allocations[Inserted.first->second].merge(Info);
+        StackOwner = None;
+        continue;
+      }
+      StackOwner = Allocations.size();
+      Allocations.push_back(std::move(Info));
+    } else if (Text.consume_front("STK:")) {
+      uint64_t StackId;
+      Frame F;
+      if (!parseFrame(Text, StackId, F))
+        return malformed(Line, "invalid stack frame");
+      if (!AllocationIndex.count(StackId))
+        return malformed(Line, "stack frame of unknown context " +
+                                   Twine(StackId));
+      if (StackOwner && Allocations[*StackOwner].StackId == StackId)
+        Allocations[*StackOwner].CallStack.push_back(std::move(F));
+    }
+  }
+  return Error::success();
+}
+
+Expected<std::unique_ptr<MemProfReader>>
+MemProfReader::create(const Twine &Path) {
+  auto BufferOrErr = MemoryBuffer::getFileOrSTDIN(Path);
+  if (std::error_code EC = BufferOrErr.getError())
+    return errorCodeToError(EC);
+  return create(std::move(BufferOrErr.get()));
+}
+
+Expected<std::unique_ptr<MemProfReader>>
+MemProfReader::create(std::unique_ptr<MemoryBuffer> Buffer) {
+  std::unique_ptr<MemProfReader> Reader(new MemProfReader());
+  if (Error E = Reader->read(*Buffer))
+    return std::move(E);
+  return std::move(Reader);
+}
@@ -39,6 +39,7 @@
 #include <limits>
 #include <memory>
 #include <system_error>
+#include <tuple>
 #include <vector>
 
 using namespace llvm;
@@ -491,9 +492,11 @@ SampleProfileReaderBinary::readFuncProfile(const uint8_t *Start) {
   if (std::error_code EC = FName.getError())
     return EC;
 
-  Profiles[*FName] = FunctionSamples();
-  FunctionSamples &FProfile = Profiles[*FName];
-  FProfile.setName(*FName);
+  SampleContext FContext(*FName, ProfileIsCS ? RawContext : UnknownContext);
+  Profiles[FContext] = FunctionSamples();
+  FunctionSamples &FProfile = Profiles[FContext];
+  FProfile.setName(FContext.getName());
+  FProfile.setContext(FContext);
 
   FProfile.addHeadSamples(*NumHeadSamples);
 
@@ -521,6 +524,8 @@ std::error_code SampleProfileReaderExtBinaryBase::readOneSection(
       return EC;
     if (hasSecFlag(Entry, SecProfSummaryFlags::SecFlagPartial))
       Summary->setPartialProfile(true);
+    if (hasSecFlag(Entry, SecProfSummaryFlags::SecFlagFullContext))
+      ProfileIsCS = true;
     break;
   case SecNameTable: {
     FixedLengthMD5 =
@@ -552,11 +557,19 @@ std::error_code SampleProfileReaderExtBinaryBase::readOneSection(
   return sampleprof_error::success;
 }
 
-void SampleProfileReaderExtBinaryBase::collectFuncsFrom(const Module &M) {
-  UseAllFuncs = false;
+/// Only the profiles of functions with a body, defined in the module or
+/// imported into it, are ever applied, so declarations are not collected.
+static void collectDefinedFuncs(const Module &M,
+                                DenseSet<StringRef> &FuncsToUse) {
   FuncsToUse.clear();
   for (auto &F : M)
-    FuncsToUse.insert(FunctionSamples::getCanonicalFnName(F));
+    if (!F.isDeclaration())
+      FuncsToUse.insert(FunctionSamples::getCanonicalFnName(F));
+}
+
+void SampleProfileReaderExtBinaryBase::collectFuncsFrom(const Module &M) {
+  UseAllFuncs = false;
+  collectDefinedFuncs(M, FuncsToUse);
 }
 
 std::error_code SampleProfileReaderExtBinaryBase::readFuncOffsetTable() {
@@ -579,9 +592,26 @@ std::error_code SampleProfileReaderExtBinaryBase::readFuncOffsetTable() {
   return sampleprof_error::success;
 }
 
+/// Return true if any function on the calling context \p Context, such as
+/// `main:3 @ _Z5funcAi:1 @ _Z8funcLeafi`, satisfies \p IsUsed.
+static bool isAnyFuncOnContext(StringRef Context,
+                               function_ref<bool(StringRef)> IsUsed) {
+  while (!Context.empty()) {
+    StringRef Frame, FName;
+    std::tie(Frame, Context) = SampleContext::splitContextString(Context);
+    LineLocation Loc(0, 0);
+    SampleContext::decodeContextString(Frame, FName, Loc);
+    if (IsUsed(FName))
+      return true;
+  }
+  return false;
+}
+
 std::error_code SampleProfileReaderExtBinaryBase::readFuncProfiles() {
   const uint8_t *Start = Data;
-  if (UseAllFuncs) {
+  // Names in a context-sensitive profile using MD5 cannot be decoded into
+  // their frames, so all of its profiles are loaded.
+  if (UseAllFuncs || (ProfileIsCS && useMD5())) {
     while (Data < End) {
       if (std::error_code EC = readFuncProfile(Data))
         return EC;
@@ -596,26 +626,50 @@ std::error_code SampleProfileReaderExtBinaryBase::readFuncProfiles() {
     }
   }
 
-  if (useMD5()) {
+  auto readFuncProfileAt = [&](uint64_t Offset) {
+    const uint8_t *FuncProfileAddr = Start + Offset;
+    assert(FuncProfileAddr < End && "out of LBRProfile section");
+    return readFuncProfile(FuncProfileAddr);
+  };
+  auto IsUsed = [&](StringRef FuncName) {
+    return FuncsToUse.count(FuncName) ||
+           (Remapper && Remapper->exist(FuncName));
+  };
+
+  if (ProfileIsCS) {
+    // A context profile is needed when any function on its context is used
+    // in the module: the profile of the leaf may be promoted into its base
+    // profile, and the callers may inline along the context.
+    for (auto NameOffset : FuncOffsetTable) {
+      if (!isAnyFuncOnContext(NameOffset.first, IsUsed))
+        continue;
+      if (std::error_code EC = readFuncProfileAt(NameOffset.second))
+        return EC;
+    }
+  } else if (useMD5()) {
     for (auto Name : FuncsToUse) {
       auto GUID = std::to_string(MD5Hash(Name));
       auto iter = FuncOffsetTable.find(StringRef(GUID));
       if (iter == FuncOffsetTable.end())
         continue;
-      const uint8_t *FuncProfileAddr = Start + iter->second;
-      assert(FuncProfileAddr < End && "out of LBRProfile section");
-      if (std::error_code EC = readFuncProfile(FuncProfileAddr))
+      if (std::error_code EC = readFuncProfileAt(iter->second))
         return EC;
     }
-  } else {
+  } else if (Remapper) {
     for (auto NameOffset : FuncOffsetTable) {
-      auto FuncName = NameOffset.first;
-      if (!FuncsToUse.count(FuncName) &&
-          (!Remapper || !Remapper->exist(FuncName)))
+      if (!IsUsed(NameOffset.first))
         continue;
-      const uint8_t *FuncProfileAddr = Start + NameOffset.second;
-      assert(FuncProfileAddr < End && "out of LBRProfile section");
-      if (std::error_code EC = readFuncProfile(FuncProfileAddr))
+      if (std::error_code EC = readFuncProfileAt(NameOffset.second))
+        return EC;
+    }
+  } else {
+    // Probe the offset table for the functions in the module, rather than
+    // walking the table, which holds every function in the profile.
+    for (auto Name : FuncsToUse) {
+      auto iter = FuncOffsetTable.find(Name);
+      if (iter == FuncOffsetTable.end())
+        continue;
+      if (std::error_code EC = readFuncProfileAt(iter->second))
         return EC;
     }
   }
@@ -1014,9 +1068,7 @@ std::error_code SampleProfileReaderCompactBinary::readFuncOffsetTable() {
 
 void SampleProfileReaderCompactBinary::collectFuncsFrom(const Module &M) {
   UseAllFuncs = false;
-  FuncsToUse.clear();
-  for (auto &F : M)
-    FuncsToUse.insert(FunctionSamples::getCanonicalFnName(F));
+  collectDefinedFuncs(M, FuncsToUse);
 }
 
 std::error_code SampleProfileReaderBinary::readSummaryEntry(
@@ -129,6 +129,8 @@ SampleProfileWriterExtBinaryBase::addNewSection(SecType Type,
 
 std::error_code SampleProfileWriterExtBinaryBase::write(
     const StringMap<FunctionSamples> &ProfileMap) {
+  if (FunctionSamples::ProfileIsCS)
+    addSectionFlag(SecProfSummary, SecProfSummaryFlags::SecFlagFullContext);
   if (std::error_code EC = writeHeader(ProfileMap))
     return EC;
 
@@ -146,7 +148,7 @@ std::error_code SampleProfileWriterExtBinaryBase::write(
 std::error_code
 SampleProfileWriterExtBinaryBase::writeSample(const FunctionSamples &S) {
   uint64_t Offset = OutputStream->tell();
-  StringRef Name = S.getName();
+  StringRef Name = S.getNameWithContext();
   FuncOffsetTable[Name] = Offset - SecLBRProfileStart;
   encodeULEB128(S.getHeadSamples(), *OutputStream);
   return writeBody(S);
@@ -539,7 +541,11 @@ std::error_code SampleProfileWriterBinary::writeSummary() {
 std::error_code SampleProfileWriterBinary::writeBody(const FunctionSamples &S) {
   auto &OS = *OutputStream;
 
-  if (std::error_code EC = writeNameIdx(S.getName()))
+  // The top-level profiles of a context-sensitive profile are named by their
+  // full context.
+  StringRef Name =
+      S.getContext().hasContext() ? S.getNameWithContext() : S.getName();
+  if (std::error_code EC = writeNameIdx(Name))
     return EC;
 
   encodeULEB128(S.getTotalSamples(), OS);
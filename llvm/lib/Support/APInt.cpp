@@ -32,20 +32,6 @@ using namespace llvm;
 
 #define DEBUG_TYPE "apint"
 
-/// A utility function for allocating memory, checking for allocation failures,
-/// and ensuring the contents are zeroed.
-inline static uint64_t* getClearedMemory(unsigned numWords) {
-  uint64_t *result = new uint64_t[numWords];
-  memset(result, 0, numWords * sizeof(uint64_t));
-  return result;
-}
-
-/// A utility function for allocating memory and checking for allocation
-/// failure.  The content is not zeroed.
-inline static uint64_t* getMemory(unsigned numWords) {
-  return new uint64_t[numWords];
-}
-
 /// A utility function that converts a character to a digit.
 inline static unsigned getDigit(char cdigit, uint8_t radix) {
   unsigned r;
@@ -75,7 +61,8 @@ inline static unsigned getDigit(char cdigit, uint8_t radix) {
 
 
 void APInt::initSlowCase(uint64_t val, bool isSigned) {
-  U.pVal = getClearedMemory(getNumWords());
+  allocateWords();
+  memset(U.pVal, 0, getNumWords() * APINT_WORD_SIZE);
   U.pVal[0] = val;
   if (isSigned && int64_t(val) < 0)
     for (unsigned i = 1; i < getNumWords(); ++i)
@@ -84,7 +71,7 @@ void APInt::initSlowCase(uint64_t val, bool isSigned) {
 }
 
 void APInt::initSlowCase(const APInt& that) {
-  U.pVal = getMemory(getNumWords());
+  allocateWords();
   memcpy(U.pVal, that.U.pVal, getNumWords() * APINT_WORD_SIZE);
 }
 
@@ -95,7 +82,8 @@ void APInt::initFromArray(ArrayRef<uint64_t> bigVal) {
     U.VAL = bigVal[0];
   else {
     // Get memory, cleared to 0
-    U.pVal = getClearedMemory(getNumWords());
+    allocateWords();
+    memset(U.pVal, 0, getNumWords() * APINT_WORD_SIZE);
     // Calculate the number of words to copy
     unsigned words = std::min<unsigned>(bigVal.size(), getNumWords());
     // Copy the words from bigVal to pVal
@@ -129,7 +117,7 @@ void APInt::reallocate(unsigned NewBitWidth) {
   }
 
   // If we have an allocation, delete it.
-  if (!isSingleWord())
+  if (needsCleanup())
     delete [] U.pVal;
 
   // Update BitWidth.
@@ -137,7 +125,7 @@ void APInt::reallocate(unsigned NewBitWidth) {
 
   // If we are supposed to have an allocation, create it.
   if (!isSingleWord())
-    U.pVal = getMemory(getNumWords());
+    allocateWords();
 }
 
 void APInt::AssignSlowCase(const APInt& RHS) {
@@ -232,7 +220,7 @@ APInt APInt::operator*(const APInt& RHS) const {
   if (isSingleWord())
     return APInt(BitWidth, U.VAL * RHS.U.VAL);
 
-  APInt Result(getMemory(getNumWords()), getBitWidth());
+  APInt Result(getBitWidth(), UninitializedTag());
 
   tcMultiply(Result.U.pVal, U.pVal, RHS.U.pVal, getNumWords());
 
@@ -862,7 +850,7 @@ APInt APInt::trunc(unsigned width) const {
   if (width <= APINT_BITS_PER_WORD)
     return APInt(width, getRawData()[0]);
 
-  APInt Result(getMemory(getNumWords(width)), width);
+  APInt Result(width, UninitializedTag());
 
   // Copy full words.
   unsigned i;
@@ -909,7 +897,7 @@ APInt APInt::sext(unsigned Width) const {
   if (Width <= APINT_BITS_PER_WORD)
     return APInt(Width, SignExtend64(U.VAL, BitWidth));
 
-  APInt Result(getMemory(getNumWords(Width)), Width);
+  APInt Result(Width, UninitializedTag());
 
   // Copy words.
   std::memcpy(Result.U.pVal, getRawData(), getNumWords() * APINT_WORD_SIZE);
@@ -933,7 +921,7 @@ APInt APInt::zext(unsigned width) const {
   if (width <= APINT_BITS_PER_WORD)
     return APInt(width, U.VAL);
 
-  APInt Result(getMemory(getNumWords(width)), width);
+  APInt Result(width, UninitializedTag());
 
   // Copy words.
   std::memcpy(Result.U.pVal, getRawData(), getNumWords() * APINT_WORD_SIZE);
@@ -2137,8 +2125,10 @@ void APInt::fromString(unsigned numbits, StringRef str, uint8_t radix) {
   // Allocate memory if needed
   if (isSingleWord())
     U.VAL = 0;
-  else
-    U.pVal = getClearedMemory(getNumWords());
+  else {
+    allocateWords();
+    memset(U.pVal, 0, getNumWords() * APINT_WORD_SIZE);
+  }
 
   // Figure out if we can shift instead of multiply
   unsigned shift = (radix == 16 ? 4 : radix == 8 ? 3 : radix == 2 ? 1 : 0);
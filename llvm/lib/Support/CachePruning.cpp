@@ -16,11 +16,13 @@
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 
 #define DEBUG_TYPE "cache-pruning"
 
+#include <limits>
 #include <set>
 #include <system_error>
 
@@ -48,6 +50,79 @@ static void writeTimestampFile(StringRef TimestampFile) {
   raw_fd_ostream Out(TimestampFile.str(), EC, sys::fs::OF_None);
 }
 
+/// The state of a cache directory as of its last complete walk: the total size
+/// and number of the files left, and the last access time of the least
+/// recently used one. Files added since are appended to the journal.
+namespace {
+struct CacheIndex {
+  uint64_t TotalSize = 0;
+  uint64_t NumFiles = 0;
+  /// Seconds since the epoch.
+  uint64_t OldestAccessTime = 0;
+};
+} // anonymous namespace
+
+static const char CacheIndexName[] = "llvmcache.index";
+static const char CacheJournalName[] = "llvmcache.journal";
+
+static bool readCacheIndex(StringRef Path, CacheIndex &Index) {
+  SmallString<128> IndexFile(Path);
+  sys::path::append(IndexFile, CacheIndexName);
+  ErrorOr<std::unique_ptr<MemoryBuffer>> MBOrErr =
+      MemoryBuffer::getFile(IndexFile);
+  if (!MBOrErr)
+    return false;
+  SmallVector<StringRef, 3> Fields;
+  (*MBOrErr)->getBuffer().trim().split(Fields, ' ');
+  return Fields.size() == 3 && !Fields[0].getAsInteger(10, Index.TotalSize) &&
+         !Fields[1].getAsInteger(10, Index.NumFiles) &&
+         !Fields[2].getAsInteger(10, Index.OldestAccessTime);
+}
+
+static void writeCacheIndex(StringRef Path, const CacheIndex &Index) {
+  SmallString<128> IndexFile(Path);
+  sys::path::append(IndexFile, CacheIndexName);
+  std::error_code EC;
+  raw_fd_ostream Out(IndexFile, EC, sys::fs::OF_None);
+  if (!EC)
+    Out << Index.TotalSize << ' ' << Index.NumFiles << ' '
+        << Index.OldestAccessTime << '\n';
+}
+
+/// Add the files recorded in the journal to \p Index. Returns false if the
+/// journal can't be read.
+static bool readCacheJournal(StringRef Path, CacheIndex &Index) {
+  SmallString<128> JournalFile(Path);
+  sys::path::append(JournalFile, CacheJournalName);
+  ErrorOr<std::unique_ptr<MemoryBuffer>> MBOrErr =
+      MemoryBuffer::getFile(JournalFile);
+  if (!MBOrErr)
+    return MBOrErr.getError() == errc::no_such_file_or_directory;
+  SmallVector<StringRef, 0> Lines;
+  (*MBOrErr)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                                /*KeepEmpty=*/false);
+  for (StringRef Line : Lines) {
+    uint64_t Size;
+    if (Line.getAsInteger(10, Size))
+      return false;
+    Index.TotalSize += Size;
+    ++Index.NumFiles;
+  }
+  return true;
+}
+
+void llvm::recordCacheFileAdded(StringRef Path, uint64_t Size) {
+  SmallString<128> JournalFile(Path);
+  sys::path::append(JournalFile, CacheJournalName);
+  std::error_code EC;
+  raw_fd_ostream Out(JournalFile, EC, sys::fs::OF_Append);
+  if (EC)
+    return;
+  // Writes this short to a file opened for appending are atomic, so entries
+  // from concurrent processes don't interleave.
+  Out << Size << '\n';
+}
+
 static Expected<std::chrono::seconds> parseDuration(StringRef Duration) {
   if (Duration.empty())
     return make_error<StringError>("Duration must not be empty",
@@ -199,6 +274,55 @@ bool llvm::pruneCache(StringRef Path, CachePruningPolicy Policy) {
     writeTimestampFile(TimestampFile);
   }
 
+  // Compute the size the cache must be pruned to, given that it currently
+  // occupies TotalSize bytes.
+  auto GetTotalSizeTarget = [&](uint64_t TotalSize) -> uint64_t {
+    if (Policy.MaxSizePercentageOfAvailableSpace == 0 &&
+        Policy.MaxSizeBytes == 0)
+      return std::numeric_limits<uint64_t>::max();
+    auto ErrOrSpaceInfo = sys::fs::disk_space(Path);
+    if (!ErrOrSpaceInfo) {
+      report_fatal_error("Can't get available size");
+    }
+    sys::fs::space_info SpaceInfo = ErrOrSpaceInfo.get();
+    auto AvailableSpace = TotalSize + SpaceInfo.free;
+
+    unsigned MaxSizePercentage = Policy.MaxSizePercentageOfAvailableSpace;
+    if (MaxSizePercentage == 0)
+      MaxSizePercentage = 100;
+    uint64_t MaxSizeBytes = Policy.MaxSizeBytes;
+    if (MaxSizeBytes == 0)
+      MaxSizeBytes = AvailableSpace;
+    LLVM_DEBUG(dbgs() << "Occupancy: " << ((100 * TotalSize) / AvailableSpace)
+                      << "% target is: " << MaxSizePercentage << "%, "
+                      << MaxSizeBytes << " bytes\n");
+    return std::min<uint64_t>(AvailableSpace * MaxSizePercentage / 100ull,
+                              MaxSizeBytes);
+  };
+
+  // If the files added since the last walk keep the cache within the limits,
+  // and none of the files can have expired yet, there is nothing to prune.
+  const uint64_t CurrentSeconds =
+      duration_cast<seconds>(CurrentTime.time_since_epoch()).count();
+  CacheIndex Index;
+  if (readCacheIndex(Path, Index) && readCacheJournal(Path, Index) &&
+      (Policy.Expiration == seconds(0) ||
+       CurrentSeconds <= Index.OldestAccessTime + Policy.Expiration.count()) &&
+      (!Policy.MaxSizeFiles || Index.NumFiles <= Policy.MaxSizeFiles) &&
+      Index.TotalSize <= GetTotalSizeTarget(Index.TotalSize)) {
+    LLVM_DEBUG(dbgs() << "Cache index within limits (" << Index.NumFiles
+                      << " files, " << Index.TotalSize
+                      << " bytes), do not walk.\n");
+    return true;
+  }
+
+  // Files added from now on are seen by the walk below, or recorded in a new
+  // journal. Either way they are accounted for next time, possibly twice,
+  // which only causes an early walk.
+  SmallString<128> JournalFile(Path);
+  sys::path::append(JournalFile, CacheJournalName);
+  sys::fs::remove(JournalFile);
+
   // Keep track of files to delete to get below the size limit.
   // Order by time of last use so that recently used files are preserved.
   std::set<FileInfo> FileInfos;
@@ -264,29 +388,23 @@ bool llvm::pruneCache(StringRef Path, CachePruningPolicy Policy) {
 
   // Prune for size now if needed
   if (Policy.MaxSizePercentageOfAvailableSpace > 0 || Policy.MaxSizeBytes > 0) {
-    auto ErrOrSpaceInfo = sys::fs::disk_space(Path);
-    if (!ErrOrSpaceInfo) {
-      report_fatal_error("Can't get available size");
-    }
-    sys::fs::space_info SpaceInfo = ErrOrSpaceInfo.get();
-    auto AvailableSpace = TotalSize + SpaceInfo.free;
-
-    if (Policy.MaxSizePercentageOfAvailableSpace == 0)
-      Policy.MaxSizePercentageOfAvailableSpace = 100;
-    if (Policy.MaxSizeBytes == 0)
-      Policy.MaxSizeBytes = AvailableSpace;
-    auto TotalSizeTarget = std::min<uint64_t>(
-        AvailableSpace * Policy.MaxSizePercentageOfAvailableSpace / 100ull,
-        Policy.MaxSizeBytes);
-
-    LLVM_DEBUG(dbgs() << "Occupancy: " << ((100 * TotalSize) / AvailableSpace)
-                      << "% target is: "
-                      << Policy.MaxSizePercentageOfAvailableSpace << "%, "
-                      << Policy.MaxSizeBytes << " bytes\n");
+    auto TotalSizeTarget = GetTotalSizeTarget(TotalSize);
 
     // Remove the oldest accessed files first, till we get below the threshold.
     while (TotalSize > TotalSizeTarget && FileInfo != FileInfos.end())
       RemoveCacheFile();
   }
+
+  // Record what is left, along with the access time of the least recently used
+  // file, so that the next pruning may not need to walk the directory. Files
+  // added later are used more recently than that.
+  CacheIndex NewIndex;
+  NewIndex.TotalSize = TotalSize;
+  NewIndex.NumFiles = NumFiles;
+  NewIndex.OldestAccessTime =
+      FileInfo != FileInfos.end()
+          ? duration_cast<seconds>(FileInfo->Time.time_since_epoch()).count()
+          : CurrentSeconds;
+  writeCacheIndex(Path, NewIndex);
   return true;
 }
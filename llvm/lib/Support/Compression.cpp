@@ -20,14 +20,19 @@
 #if LLVM_ENABLE_ZLIB
 #include <zlib.h>
 #endif
+#if LLVM_ENABLE_ZSTD
+#include <zstd.h>
+#endif
 
 using namespace llvm;
+using namespace llvm::compression;
 
-#if LLVM_ENABLE_ZLIB
-static Error createError(StringRef Err) {
+LLVM_ATTRIBUTE_UNUSED static Error createError(StringRef Err) {
   return make_error<StringError>(Err, inconvertibleErrorCode());
 }
 
+#if LLVM_ENABLE_ZLIB
+
 static StringRef convertZlibCodeToString(int Code) {
   switch (Code) {
   case Z_MEM_ERROR:
@@ -85,6 +90,45 @@ uint32_t zlib::crc32(StringRef Buffer) {
   return ::crc32(0, (const Bytef *)Buffer.data(), Buffer.size());
 }
 
+Error zlib::compressRaw(StringRef InputBuffer,
+                        SmallVectorImpl<char> &CompressedBuffer, int Level,
+                        bool Final) {
+  z_stream Stream = {};
+  // A negative window size selects raw deflate data. 15 and 8 are the
+  // defaults used by compress2().
+  int Res = ::deflateInit2(&Stream, Level, Z_DEFLATED, -15, 8,
+                           Z_DEFAULT_STRATEGY);
+  if (Res != Z_OK)
+    return createError(convertZlibCodeToString(Res));
+
+  Stream.next_in = (Bytef *)InputBuffer.data();
+  Stream.avail_in = InputBuffer.size();
+  // A sync flush appends up to 5 bytes and the final block a few more.
+  CompressedBuffer.resize(::deflateBound(&Stream, InputBuffer.size()) + 16);
+  Stream.next_out = (Bytef *)CompressedBuffer.data();
+  Stream.avail_out = CompressedBuffer.size();
+  Res = ::deflate(&Stream, Final ? Z_FINISH : Z_SYNC_FLUSH);
+  size_t CompressedSize = CompressedBuffer.size() - Stream.avail_out;
+  ::deflateEnd(&Stream);
+  if (Res != (Final ? Z_STREAM_END : Z_OK) || Stream.avail_in != 0)
+    return createError(convertZlibCodeToString(Z_BUF_ERROR));
+
+  // Tell MemorySanitizer that zlib output buffer is fully initialized.
+  // This avoids a false report when running LLVM with uninstrumented ZLib.
+  __msan_unpoison(CompressedBuffer.data(), CompressedSize);
+  CompressedBuffer.resize(CompressedSize);
+  return Error::success();
+}
+
+uint32_t zlib::adler32(StringRef Buffer) {
+  return ::adler32(1, (const Bytef *)Buffer.data(), Buffer.size());
+}
+
+uint32_t zlib::adler32Combine(uint32_t Adler1, uint32_t Adler2,
+                              size_t Length2) {
+  return ::adler32_combine(Adler1, Adler2, Length2);
+}
+
 #else
 bool zlib::isAvailable() { return false; }
 Error zlib::compress(StringRef InputBuffer,
@@ -103,4 +147,142 @@ Error zlib::uncompress(StringRef InputBuffer,
 uint32_t zlib::crc32(StringRef Buffer) {
   llvm_unreachable("zlib::crc32 is unavailable");
 }
+Error zlib::compressRaw(StringRef InputBuffer,
+                        SmallVectorImpl<char> &CompressedBuffer, int Level,
+                        bool Final) {
+  llvm_unreachable("zlib::compressRaw is unavailable");
+}
+uint32_t zlib::adler32(StringRef Buffer) {
+  llvm_unreachable("zlib::adler32 is unavailable");
+}
+uint32_t zlib::adler32Combine(uint32_t Adler1, uint32_t Adler2,
+                              size_t Length2) {
+  llvm_unreachable("zlib::adler32Combine is unavailable");
+}
 #endif
+
+#if LLVM_ENABLE_ZSTD
+bool zstd::isAvailable() { return true; }
+
+Error zstd::compress(StringRef InputBuffer,
+                     SmallVectorImpl<char> &CompressedBuffer, int Level) {
+  size_t CompressedBufferSize = ::ZSTD_compressBound(InputBuffer.size());
+  CompressedBuffer.reserve(CompressedBufferSize);
+  size_t CompressedSize =
+      ::ZSTD_compress(CompressedBuffer.data(), CompressedBufferSize,
+                      InputBuffer.data(), InputBuffer.size(), Level);
+  if (::ZSTD_isError(CompressedSize))
+    return createError(::ZSTD_getErrorName(CompressedSize));
+  // Tell MemorySanitizer that zstd output buffer is fully initialized.
+  // This avoids a false report when running LLVM with uninstrumented zstd.
+  __msan_unpoison(CompressedBuffer.data(), CompressedSize);
+  CompressedBuffer.set_size(CompressedSize);
+  return Error::success();
+}
+
+Error zstd::uncompress(StringRef InputBuffer, char *UncompressedBuffer,
+                       size_t &UncompressedSize) {
+  // ZSTD_decompress handles a sequence of concatenated frames.
+  size_t Res = ::ZSTD_decompress(UncompressedBuffer, UncompressedSize,
+                                 InputBuffer.data(), InputBuffer.size());
+  if (::ZSTD_isError(Res))
+    return createError(::ZSTD_getErrorName(Res));
+  UncompressedSize = Res;
+  // Tell MemorySanitizer that zstd output buffer is fully initialized.
+  // This avoids a false report when running LLVM with uninstrumented zstd.
+  __msan_unpoison(UncompressedBuffer, UncompressedSize);
+  return Error::success();
+}
+
+Error zstd::uncompress(StringRef InputBuffer,
+                       SmallVectorImpl<char> &UncompressedBuffer,
+                       size_t UncompressedSize) {
+  UncompressedBuffer.reserve(UncompressedSize);
+  Error E =
+      uncompress(InputBuffer, UncompressedBuffer.data(), UncompressedSize);
+  UncompressedBuffer.set_size(UncompressedSize);
+  return E;
+}
+
+#else
+bool zstd::isAvailable() { return false; }
+Error zstd::compress(StringRef InputBuffer,
+                     SmallVectorImpl<char> &CompressedBuffer, int Level) {
+  llvm_unreachable("zstd::compress is unavailable");
+}
+Error zstd::uncompress(StringRef InputBuffer, char *UncompressedBuffer,
+                       size_t &UncompressedSize) {
+  llvm_unreachable("zstd::uncompress is unavailable");
+}
+Error zstd::uncompress(StringRef InputBuffer,
+                       SmallVectorImpl<char> &UncompressedBuffer,
+                       size_t UncompressedSize) {
+  llvm_unreachable("zstd::uncompress is unavailable");
+}
+#endif
+
+const char *compression::getName(Format F) {
+  switch (F) {
+  case Format::Zlib:
+    return "zlib";
+  case Format::Zstd:
+    return "zstd";
+  }
+  llvm_unreachable("unknown compression format");
+}
+
+bool compression::isAvailable(Format F) {
+  switch (F) {
+  case Format::Zlib:
+    return zlib::isAvailable();
+  case Format::Zstd:
+    return zstd::isAvailable();
+  }
+  llvm_unreachable("unknown compression format");
+}
+
+int compression::getDefaultLevel(Format F) {
+  switch (F) {
+  case Format::Zlib:
+    return zlib::DefaultCompression;
+  case Format::Zstd:
+    return zstd::DefaultCompression;
+  }
+  llvm_unreachable("unknown compression format");
+}
+
+Error compression::compress(Format F, StringRef InputBuffer,
+                            SmallVectorImpl<char> &CompressedBuffer,
+                            int Level) {
+  switch (F) {
+  case Format::Zlib:
+    return zlib::compress(InputBuffer, CompressedBuffer, Level);
+  case Format::Zstd:
+    return zstd::compress(InputBuffer, CompressedBuffer, Level);
+  }
+  llvm_unreachable("unknown compression format");
+}
+
+Error compression::uncompress(Format F, StringRef InputBuffer,
+                              char *UncompressedBuffer,
+                              size_t &UncompressedSize) {
+  switch (F) {
+  case Format::Zlib:
+    return zlib::uncompress(InputBuffer, UncompressedBuffer, UncompressedSize);
+  case Format::Zstd:
+    return zstd::uncompress(InputBuffer, UncompressedBuffer, UncompressedSize);
+  }
+  llvm_unreachable("unknown compression format");
+}
+
+Error compression::uncompress(Format F, StringRef InputBuffer,
+                              SmallVectorImpl<char> &UncompressedBuffer,
+                              size_t UncompressedSize) {
+  switch (F) {
+  case Format::Zlib:
+    return zlib::uncompress(InputBuffer, UncompressedBuffer, UncompressedSize);
+  case Format::Zstd:
+    return zstd::uncompress(InputBuffer, UncompressedBuffer, UncompressedSize);
+  }
+  llvm_unreachable("unknown compression format");
+}
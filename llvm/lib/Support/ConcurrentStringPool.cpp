@@ -0,0 +1,60 @@
+//===-- ConcurrentStringPool.cpp ------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/ConcurrentStringPool.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Threading.h"
+#include <algorithm>
+
+using namespace llvm;
+
+ConcurrentStringPool::ConcurrentStringPool(unsigned NumShards) {
+  if (NumShards == 0)
+    NumShards = 4 * hardware_concurrency().compute_thread_count();
+  // Any more shards would only waste memory.
+  this->NumShards = std::min<uint64_t>(PowerOf2Ceil(NumShards), 1024);
+  ShardShift = 32 - Log2_32(this->NumShards);
+  Shards.reset(new Shard[this->NumShards]);
+}
+
+ConcurrentStringPool::~ConcurrentStringPool() = default;
+
+StringRef ConcurrentStringPool::save(StringRef S) {
+  CachedHashStringRef Key(S);
+  // Shifting a 32-bit value by 32 is undefined, so there is one more step.
+  Shard &Sh = Shards[(Key.hash() >> 1) >> (ShardShift - 1)];
+  std::lock_guard<std::mutex> Lock(Sh.Mutex);
+  auto R = Sh.Strings.insert(Key);
+  if (R.second) { // cache miss, need to actually save the string
+    char *P = Sh.Alloc.Allocate<char>(S.size() + 1);
+    if (!S.empty())
+      memcpy(P, S.data(), S.size());
+    P[S.size()] = '\0';
+    // Safe replacement with an equal value.
+    *R.first = CachedHashStringRef(StringRef(P, S.size()), Key.hash());
+  }
+  return R.first->val();
+}
+
+size_t ConcurrentStringPool::size() const {
+  size_t Size = 0;
+  for (unsigned I = 0; I != NumShards; ++I) {
+    std::lock_guard<std::mutex> Lock(Shards[I].Mutex);
+    Size += Shards[I].Strings.size();
+  }
+  return Size;
+}
+
+size_t ConcurrentStringPool::getBytesAllocated() const {
+  size_t Bytes = 0;
+  for (unsigned I = 0; I != NumShards; ++I) {
+    std::lock_guard<std::mutex> Lock(Shards[I].Mutex);
+    Bytes += Shards[I].Alloc.getBytesAllocated();
+  }
+  return Bytes;
+}
@@ -11,14 +11,19 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/FileOutputBuffer.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/ScopeExit.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Memory.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include <mutex>
 #include <system_error>
 
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
+#include <fcntl.h>
 #include <unistd.h>
 #else
 #include <io.h>
@@ -45,6 +50,23 @@ public:
 
   size_t getBufferSize() const override { return Buffer->size(); }
 
+  // The file is mapped shared, so data copied into it by the kernel is visible
+  // through the mapping as well.
+  bool copyFromFile(int InFD, uint64_t InOffset, size_t Offset,
+                    size_t Size) override {
+    assert(Offset + Size <= getBufferSize() && "copy out of bounds");
+    return !fs::copy_file_range(InFD, InOffset, Temp.FD, Offset, Size);
+  }
+
+  // Start writing the dirty pages of the range to disk without waiting for
+  // them, so that they are not all left for the kernel to flush at the end.
+  void writeback(size_t Offset, size_t Size) override {
+    assert(Offset + Size <= getBufferSize() && "writeback out of bounds");
+#if defined(__linux__)
+    ::sync_file_range(Temp.FD, Offset, Size, SYNC_FILE_RANGE_WRITE);
+#endif
+  }
+
   Error commit() override {
     // Unmap buffer, letting OS flush dirty pages to file on disk.
     Buffer.reset();
@@ -112,6 +134,127 @@ private:
   size_t BufferSize;
   unsigned Mode;
 };
+
+#if defined(O_DIRECT)
+// A FileOutputBuffer which keeps data in memory and writes it with direct I/O
+// to a temporary file, which atomically replaces the final output file on
+// commit(). Direct I/O needs the offsets, sizes and addresses of writes to be
+// aligned, so only whole blocks are written: writeback() leaves out the
+// partial blocks at either end of its range, and commit() writes the blocks
+// that are left, with the last one padded with zeros.
+class DirectBuffer : public FileOutputBuffer {
+public:
+  DirectBuffer(StringRef Path, fs::TempFile Temp, int DirectFD,
+               MemoryBlock Buf, size_t BufSize, size_t BlockSize)
+      : FileOutputBuffer(Path), Buffer(Buf), BufferSize(BufSize),
+        BlockSize(BlockSize), Temp(std::move(Temp)), DirectFD(DirectFD),
+        Written(alignTo(BufSize, BlockSize) / BlockSize) {}
+
+  uint8_t *getBufferStart() const override { return (uint8_t *)Buffer.base(); }
+
+  uint8_t *getBufferEnd() const override {
+    return (uint8_t *)Buffer.base() + BufferSize;
+  }
+
+  size_t getBufferSize() const override { return BufferSize; }
+
+  void writeback(size_t Offset, size_t Size) override {
+    assert(Offset + Size <= getBufferSize() && "writeback out of bounds");
+    size_t Begin = alignTo(Offset, BlockSize) / BlockSize;
+    size_t End = (Offset + Size) / BlockSize;
+    if (Begin < End)
+      writeBlocks(Begin, End);
+  }
+
+  Error commit() override {
+    int Begin = Written.find_first_unset();
+    while (Begin != -1) {
+      int End = Written.find_next(Begin);
+      if (End == -1)
+        End = Written.size();
+      writeBlocks(Begin, End);
+      Begin = End == int(Written.size()) ? -1 : Written.find_next_unset(End);
+    }
+    if (WriteError)
+      return errorCodeToError(WriteError);
+
+    // Cut the padding of the last block off.
+    if (std::error_code EC = fs::resize_file(Temp.FD, BufferSize))
+      return errorCodeToError(EC);
+    ::close(DirectFD);
+    DirectFD = -1;
+
+    // Atomically replace the existing file with the new one.
+    return Temp.keep(FinalPath);
+  }
+
+  ~DirectBuffer() override {
+    if (DirectFD != -1)
+      ::close(DirectFD);
+    consumeError(Temp.discard());
+  }
+
+  void discard() override { consumeError(Temp.discard()); }
+
+private:
+  void writeBlocks(size_t Begin, size_t End) {
+    const uint8_t *Data = getBufferStart();
+    for (size_t Offset = Begin * BlockSize, EndOffset = End * BlockSize;
+         Offset < EndOffset;) {
+      ssize_t N = ::pwrite(DirectFD, Data + Offset, EndOffset - Offset, Offset);
+      if (N < 0) {
+        if (errno == EINTR)
+          continue;
+        std::lock_guard<std::mutex> Lock(Mutex);
+        if (!WriteError)
+          WriteError = std::error_code(errno, std::generic_category());
+        return;
+      }
+      Offset += N;
+    }
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Written.set(Begin, End);
+  }
+
+  OwningMemoryBlock Buffer;
+  size_t BufferSize;
+  size_t BlockSize;
+  fs::TempFile Temp;
+  int DirectFD;
+
+  std::mutex Mutex;
+  // The blocks that have been written to the file.
+  BitVector Written;
+  // The first error a write failed with.
+  std::error_code WriteError;
+};
+#endif
+
+// A FileOutputBuffer which maps an existing file and modifies it in place.
+// There is no temporary file, so commit() only has to unmap the buffer and
+// discard() cannot undo the changes made so far.
+class InPlaceBuffer : public FileOutputBuffer {
+public:
+  InPlaceBuffer(StringRef Path, std::unique_ptr<fs::mapped_file_region> Buf)
+      : FileOutputBuffer(Path), Buffer(std::move(Buf)) {}
+
+  uint8_t *getBufferStart() const override { return (uint8_t *)Buffer->data(); }
+
+  uint8_t *getBufferEnd() const override {
+    return (uint8_t *)Buffer->data() + Buffer->size();
+  }
+
+  size_t getBufferSize() const override { return Buffer->size(); }
+
+  Error commit() override {
+    // Unmap buffer, letting OS flush dirty pages to file on disk.
+    Buffer.reset();
+    return Error::success();
+  }
+
+private:
+  std::unique_ptr<fs::mapped_file_region> Buffer;
+};
 } // namespace
 
 static Expected<std::unique_ptr<InMemoryBuffer>>
@@ -161,6 +304,66 @@ createOnDiskBuffer(StringRef Path, size_t Size, unsigned Mode) {
                                          std::move(MappedFile));
 }
 
+#if defined(O_DIRECT)
+static Expected<std::unique_ptr<FileOutputBuffer>>
+createDirectBuffer(StringRef Path, size_t Size, unsigned Mode) {
+  Expected<fs::TempFile> FileOrErr =
+      fs::TempFile::create(Path + ".tmp%%%%%%%", Mode);
+  if (!FileOrErr)
+    return FileOrErr.takeError();
+  fs::TempFile File = std::move(*FileOrErr);
+
+  // Not every file system supports direct I/O. If the temporary file cannot
+  // be opened for it, fall back to mapping it.
+  int DirectFD = ::open(File.TmpName.c_str(), O_WRONLY | O_DIRECT | O_CLOEXEC);
+  if (DirectFD == -1) {
+    consumeError(File.discard());
+    return createOnDiskBuffer(Path, Size, Mode);
+  }
+
+  // Allocate whole blocks, so that the last one can be written as is. The
+  // memory is zeroed, so the padding is too.
+  size_t BlockSize = Process::getPageSizeEstimate();
+  std::error_code EC;
+  MemoryBlock MB = Memory::allocateMappedMemory(
+      alignTo(Size, BlockSize), nullptr,
+      sys::Memory::MF_READ | sys::Memory::MF_WRITE, EC);
+  if (EC) {
+    ::close(DirectFD);
+    consumeError(File.discard());
+    return errorCodeToError(EC);
+  }
+  return std::make_unique<DirectBuffer>(Path, std::move(File), DirectFD, MB,
+                                        Size, BlockSize);
+}
+#endif
+
+static Expected<std::unique_ptr<FileOutputBuffer>>
+createInPlaceBuffer(StringRef Path, size_t Size) {
+  int FD;
+  if (std::error_code EC = fs::openFileForReadWrite(
+          Path, FD, fs::CD_OpenExisting, fs::OF_None))
+    return errorCodeToError(EC);
+  fs::file_t File = fs::convertFDToNativeFile(FD);
+  auto CloseFile = make_scope_exit([&] { fs::closeFile(File); });
+
+  if (Size == size_t(-1)) {
+    fs::file_status Stat;
+    if (std::error_code EC = fs::status(FD, Stat))
+      return errorCodeToError(EC);
+    Size = Stat.getSize();
+  } else if (std::error_code EC = fs::resize_file(FD, Size)) {
+    return errorCodeToError(EC);
+  }
+
+  std::error_code EC;
+  auto MappedFile = std::make_unique<fs::mapped_file_region>(
+      File, fs::mapped_file_region::readwrite, Size, 0, EC);
+  if (EC)
+    return errorCodeToError(EC);
+  return std::make_unique<InPlaceBuffer>(Path, std::move(MappedFile));
+}
+
 // Create an instance of FileOutputBuffer.
 Expected<std::unique_ptr<FileOutputBuffer>>
 FileOutputBuffer::create(StringRef Path, size_t Size, unsigned Flags) {
@@ -172,13 +375,22 @@ FileOutputBuffer::create(StringRef Path, size_t Size, unsigned Flags) {
   if (Flags & F_executable)
     Mode |= fs::all_exe;
 
+  fs::file_status Stat;
+  fs::status(Path, Stat);
+
+  if (Flags & F_modify) {
+    if (Stat.type() == fs::file_type::regular_file && Size != 0)
+      return createInPlaceBuffer(Path, Size);
+    if (Size == size_t(-1))
+      return errorCodeToError(Stat.type() == fs::file_type::file_not_found
+                                  ? errc::no_such_file_or_directory
+                                  : errc::invalid_argument);
+  }
+
   // If Size is zero, don't use mmap which will fail with EINVAL.
   if (Size == 0)
     return createInMemoryBuffer(Path, Size, Mode);
 
-  fs::file_status Stat;
-  fs::status(Path, Stat);
-
   // Usually, we want to create OnDiskBuffer to create a temporary file in
   // the same directory as the destination file and atomically replaces it
   // by rename(2).
@@ -193,6 +405,10 @@ FileOutputBuffer::create(StringRef Path, size_t Size, unsigned Flags) {
   case fs::file_type::regular_file:
   case fs::file_type::file_not_found:
   case fs::file_type::status_error:
+#if defined(O_DIRECT)
+    if (Flags & F_direct)
+      return createDirectBuffer(Path, Size, Mode);
+#endif
     if (Flags & F_no_mmap)
       return createInMemoryBuffer(Path, Size, Mode);
     else
@@ -127,7 +127,7 @@ KnownBits KnownBits::makeGE(const APInt &Val) const {
   // underlying value must also have a 1.
   APInt MaskedVal(Val);
   MaskedVal.clearLowBits(getBitWidth() - N);
-  return KnownBits(Zero, One | MaskedVal);
+  return KnownBits(Zero, One | std::move(MaskedVal));
 }
 
 KnownBits KnownBits::umax(const KnownBits &LHS, const KnownBits &RHS) {
@@ -162,7 +162,7 @@ KnownBits KnownBits::smax(const KnownBits &LHS, const KnownBits &RHS) {
     APInt One = Val.One;
     Zero.setBitVal(SignBitPosition, Val.One[SignBitPosition]);
     One.setBitVal(SignBitPosition, Val.Zero[SignBitPosition]);
-    return KnownBits(Zero, One);
+    return KnownBits(std::move(Zero), std::move(One));
   };
   return Flip(umax(Flip(LHS), Flip(RHS)));
 }
@@ -175,7 +175,7 @@ KnownBits KnownBits::smin(const KnownBits &LHS, const KnownBits &RHS) {
     APInt One = Val.Zero;
     Zero.setBitVal(SignBitPosition, Val.Zero[SignBitPosition]);
     One.setBitVal(SignBitPosition, Val.One[SignBitPosition]);
-    return KnownBits(Zero, One);
+    return KnownBits(std::move(Zero), std::move(One));
   };
   return Flip(umax(Flip(LHS), Flip(RHS)));
 }
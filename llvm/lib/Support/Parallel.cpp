@@ -10,10 +10,11 @@
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Threading.h"
+#include "llvm/Support/TimeProfiler.h"
 
 #include <atomic>
+#include <deque>
 #include <future>
-#include <stack>
 #include <thread>
 #include <vector>
 
@@ -33,15 +34,97 @@ public:
   virtual ~Executor() = default;
   virtual void add(std::function<void()> func) = 0;
 
+  /// Run queued closures on the calling thread until \p L reaches zero, if
+  /// the calling thread is one of the executor's workers. Otherwise, or if
+  /// there is nothing to run, block until \p L reaches zero.
+  virtual void helpUntilDone(const Latch &L) = 0;
+
   static Executor *getDefaultExecutor();
 };
 
-/// An implementation of an Executor that runs closures on a thread pool
-///   in filo order.
+using Task = std::function<void()>;
+
+/// A fixed-size work-stealing deque (Chase and Lev, "Dynamic Circular
+/// Work-Stealing Deque", SPAA 2005, with the memory orderings of Le et al.,
+/// "Correct and Efficient Work-Stealing for Weak Memory Models", PPoPP 2013).
+/// The owning thread pushes and pops at the bottom in LIFO order; any other
+/// thread may steal from the top. push() fails rather than growing when the
+/// deque is full, which avoids having to reclaim old buffers.
+class WorkStealingDeque {
+public:
+  /// Owner only. Returns false if the deque is full.
+  bool push(Task *T) {
+    int64_t B = Bottom.load(std::memory_order_relaxed);
+    int64_t Tp = Top.load(std::memory_order_acquire);
+    if (B - Tp >= int64_t(Capacity))
+      return false;
+    // Release stores rather than a release fence, so that ThreadSanitizer,
+    // which doesn't model fences, sees the task being published.
+    Buffer[B & Mask].store(T, std::memory_order_release);
+    Bottom.store(B + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Owner only. Returns nullptr if the deque is empty.
+  Task *pop() {
+    int64_t B = Bottom.load(std::memory_order_relaxed) - 1;
+    Bottom.store(B, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t Tp = Top.load(std::memory_order_relaxed);
+    if (Tp > B) {
+      Bottom.store(B + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    Task *T = Buffer[B & Mask].load(std::memory_order_relaxed);
+    if (Tp == B) {
+      // This is the last element. Race against thieves for it.
+      if (!Top.compare_exchange_strong(Tp, Tp + 1, std::memory_order_seq_cst,
+                                       std::memory_order_relaxed))
+        T = nullptr;
+      Bottom.store(B + 1, std::memory_order_relaxed);
+    }
+    return T;
+  }
+
+  /// Any thread. Returns nullptr if the deque is empty or if another thread
+  /// won the race for the top element.
+  Task *steal() {
+    int64_t Tp = Top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t B = Bottom.load(std::memory_order_acquire);
+    if (Tp >= B)
+      return nullptr;
+    Task *T = Buffer[Tp & Mask].load(std::memory_order_acquire);
+    if (!Top.compare_exchange_strong(Tp, Tp + 1, std::memory_order_seq_cst,
+                                     std::memory_order_relaxed))
+      return nullptr;
+    return T;
+  }
+
+  bool empty() const {
+    return Top.load(std::memory_order_relaxed) >=
+           Bottom.load(std::memory_order_relaxed);
+  }
+
+private:
+  static constexpr size_t Capacity = 4096;
+  static constexpr size_t Mask = Capacity - 1;
+
+  std::atomic<int64_t> Top{0};
+  std::atomic<int64_t> Bottom{0};
+  std::atomic<Task *> Buffer[Capacity] = {};
+};
+
+/// An implementation of an Executor that runs closures on a thread pool.
+/// Each worker has its own work-stealing deque. Closures added by a worker go
+/// to its deque and are run in filo order. Closures added by other threads,
+/// or by a worker whose deque is full, go to a shared queue. Idle workers
+/// steal from the shared queue and from each other.
 class ThreadPoolExecutor : public Executor {
 public:
   explicit ThreadPoolExecutor(ThreadPoolStrategy S = hardware_concurrency()) {
     unsigned ThreadCount = S.compute_thread_count();
+    Queues = std::vector<WorkStealingDeque>(ThreadCount);
     // Spawn all but one of the threads in another thread as spawning threads
     // can take a while.
     Threads.reserve(ThreadCount);
@@ -77,6 +160,11 @@ public:
         T.detach();
       else
         T.join();
+    for (WorkStealingDeque &Q : Queues)
+      while (Task *T = Q.pop())
+        delete T;
+    for (Task *T : SharedQueue)
+      delete T;
   }
 
   struct Creator {
@@ -87,36 +175,119 @@ public:
   };
 
   void add(std::function<void()> F) override {
-    {
-      std::lock_guard<std::mutex> Lock(Mutex);
-      WorkStack.push(F);
+    Task *T = new Task(std::move(F));
+    if (CurrentExecutor != this || !Queues[CurrentWorker].push(T)) {
+      std::lock_guard<std::mutex> Lock(SharedMutex);
+      SharedQueue.push_back(T);
+    }
+    // Pairs with the fence in sleep(): either we see the sleeping worker, or
+    // it sees the new task.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (NumSleeping.load(std::memory_order_relaxed) != 0) {
+      { std::lock_guard<std::mutex> Lock(Mutex); }
+      Cond.notify_one();
+    }
+  }
+
+  void helpUntilDone(const Latch &L) override {
+    // A thread that isn't one of our workers doesn't count against the
+    // thread limit, so it must not run tasks; just wait.
+    if (CurrentExecutor != this) {
+      L.sync();
+      return;
+    }
+    // A worker must not block while tasks it waits for may be sitting in
+    // queues, since that could deadlock once all workers wait. Run tasks in
+    // the meantime; tasks from our own deque come first, and those are the
+    // ones most likely spawned by the task group we are waiting on.
+    while (!L.isDone()) {
+      if (Task *T = getTask(CurrentWorker)) {
+        run(T);
+        continue;
+      }
+      // Everything we wait for is running on other threads. Wait a little
+      // and look again, since those tasks may spawn more work.
+      L.syncFor(std::chrono::microseconds(100));
     }
-    Cond.notify_one();
   }
 
 private:
   void work(ThreadPoolStrategy S, unsigned ThreadID) {
     S.apply_thread_strategy(ThreadID);
-    while (true) {
-      std::unique_lock<std::mutex> Lock(Mutex);
-      Cond.wait(Lock, [&] { return Stop || !WorkStack.empty(); });
-      if (Stop)
-        break;
-      auto Task = WorkStack.top();
-      WorkStack.pop();
-      Lock.unlock();
-      Task();
+    CurrentExecutor = this;
+    CurrentWorker = ThreadID;
+    while (!Stop) {
+      if (Task *T = getTask(ThreadID))
+        run(T);
+      else
+        sleep();
+    }
+  }
+
+  static void run(Task *T) {
+    (*T)();
+    delete T;
+  }
+
+  Task *getTask(unsigned ThreadID) {
+    if (Task *T = Queues[ThreadID].pop())
+      return T;
+    {
+      std::lock_guard<std::mutex> Lock(SharedMutex);
+      if (!SharedQueue.empty()) {
+        Task *T = SharedQueue.front();
+        SharedQueue.pop_front();
+        return T;
+      }
+    }
+    // Start stealing at a different victim each time to spread contention.
+    size_t N = Queues.size();
+    size_t Start = NextVictim.fetch_add(1, std::memory_order_relaxed);
+    for (size_t I = 0; I != N; ++I) {
+      size_t Victim = (Start + I) % N;
+      if (Victim == ThreadID)
+        continue;
+      if (Task *T = Queues[Victim].steal())
+        return T;
     }
+    return nullptr;
   }
 
+  bool hasWork() {
+    for (const WorkStealingDeque &Q : Queues)
+      if (!Q.empty())
+        return true;
+    std::lock_guard<std::mutex> Lock(SharedMutex);
+    return !SharedQueue.empty();
+  }
+
+  void sleep() {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    NumSleeping.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!Stop && !hasWork())
+      Cond.wait(Lock);
+    NumSleeping.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  static LLVM_THREAD_LOCAL ThreadPoolExecutor *CurrentExecutor;
+  static LLVM_THREAD_LOCAL unsigned CurrentWorker;
+
   std::atomic<bool> Stop{false};
-  std::stack<std::function<void()>> WorkStack;
+  std::vector<WorkStealingDeque> Queues;
+  std::deque<Task *> SharedQueue;
+  std::mutex SharedMutex;
+  std::atomic<size_t> NextVictim{0};
+  std::atomic<unsigned> NumSleeping{0};
   std::mutex Mutex;
   std::condition_variable Cond;
   std::promise<void> ThreadsCreated;
   std::vector<std::thread> Threads;
 };
 
+LLVM_THREAD_LOCAL ThreadPoolExecutor *ThreadPoolExecutor::CurrentExecutor;
+LLVM_THREAD_LOCAL unsigned ThreadPoolExecutor::CurrentWorker;
+
 Executor *Executor::getDefaultExecutor() {
   // The ManagedStatic enables the ThreadPoolExecutor to be stopped via
   // llvm_shutdown() which allows a "clean" fast exit, e.g. via _exit(). This
@@ -144,25 +315,24 @@ Executor *Executor::getDefaultExecutor() {
 }
 } // namespace
 
-static std::atomic<int> TaskGroupInstances;
-
-// Latch::sync() called by the dtor may cause one thread to block. If is a dead
-// lock if all threads in the default executor are blocked. To prevent the dead
-// lock, only allow the first TaskGroup to run tasks parallelly. In the scenario
-// of nested parallel_for_each(), only the outermost one runs parallelly.
-TaskGroup::TaskGroup() : Parallel(TaskGroupInstances++ == 0) {}
-TaskGroup::~TaskGroup() { --TaskGroupInstances; }
+// Nested task groups are safe because a worker waiting for a task group runs
+// other tasks instead of blocking, see helpUntilDone().
+TaskGroup::~TaskGroup() { sync(); }
 
 void TaskGroup::spawn(std::function<void()> F) {
-  if (Parallel) {
-    L.inc();
-    Executor::getDefaultExecutor()->add([&, F] {
-      F();
-      L.dec();
-    });
-  } else {
-    F();
-  }
+  L.inc();
+  Executor::getDefaultExecutor()->add(
+      [&, F, Origin = timeTraceProfilerTaskOrigin()] {
+        {
+          TimeTraceTaskScope TimeScope(Origin);
+          F();
+        }
+        L.dec();
+      });
+}
+
+void TaskGroup::sync() const {
+  Executor::getDefaultExecutor()->helpUntilDone(L);
 }
 
 } // namespace detail
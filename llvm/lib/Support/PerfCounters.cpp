@@ -0,0 +1,94 @@
+//===-- PerfCounters.cpp - Hardware performance counters ------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/PerfCounters.h"
+#include "llvm/Support/ErrorHandling.h"
+
+#if defined(__linux__)
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace llvm;
+
+#if defined(__linux__)
+static int openCounter(uint64_t Config, int GroupFD) {
+  perf_event_attr Attr;
+  memset(&Attr, 0, sizeof(Attr));
+  Attr.size = sizeof(Attr);
+  Attr.type = PERF_TYPE_HARDWARE;
+  Attr.config = Config;
+  Attr.read_format = PERF_FORMAT_GROUP;
+  Attr.exclude_kernel = 1;
+  Attr.exclude_hv = 1;
+  // This thread, on any CPU.
+  return syscall(__NR_perf_event_open, &Attr, 0, -1, GroupFD, 0);
+}
+#endif
+
+PerfCounters::PerfCounters() {
+#if defined(__linux__)
+  static const uint64_t Configs[NumCounters] = {PERF_COUNT_HW_INSTRUCTIONS,
+                                                PERF_COUNT_HW_CPU_CYCLES,
+                                                PERF_COUNT_HW_CACHE_MISSES};
+  // The counters that the hardware lacks are left out of the group.
+  int NumOpen = 0;
+  for (unsigned C = 0; C != NumCounters; ++C) {
+    int FD = openCounter(Configs[C], GroupFD);
+    if (FD < 0)
+      continue;
+    if (GroupFD < 0)
+      GroupFD = FD;
+    else
+      FDs[NumOpen - 1] = FD;
+    Index[C] = NumOpen++;
+  }
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#if defined(__linux__)
+  for (int FD : FDs)
+    if (FD >= 0)
+      ::close(FD);
+  if (GroupFD >= 0)
+    ::close(GroupFD);
+#endif
+}
+
+PerfCounters::Values PerfCounters::read() const {
+  Values V;
+#if defined(__linux__)
+  if (GroupFD < 0)
+    return V;
+  // The number of counters, then their values.
+  uint64_t Buffer[1 + NumCounters];
+  if (::read(GroupFD, Buffer, sizeof(Buffer)) < (ssize_t)sizeof(uint64_t))
+    return V;
+  for (unsigned C = 0; C != NumCounters; ++C)
+    if (Index[C] >= 0 && (uint64_t)Index[C] < Buffer[0])
+      V.Counts[C] = Buffer[1 + Index[C]];
+#endif
+  return V;
+}
+
+StringRef PerfCounters::getName(Counter C) {
+  switch (C) {
+  case Instructions:
+    return "instructions";
+  case Cycles:
+    return "cycles";
+  case CacheMisses:
+    return "cache-misses";
+  case NumCounters:
+    break;
+  }
+  llvm_unreachable("Unknown counter");
+}
@@ -35,13 +35,18 @@
 #include <cstring>
 using namespace llvm;
 
+std::atomic<bool> llvm::detail::CollectShardedStatistics(false);
+
 /// -stats - Command line option to cause transformations to emit stats about
 /// what they did.
 ///
 static cl::opt<bool> EnableStats(
     "stats",
     cl::desc("Enable statistics output from program (available with Asserts)"),
-    cl::Hidden);
+    cl::Hidden, cl::callback([](const bool &Val) {
+      if (Val)
+        detail::CollectShardedStatistics = true;
+    }));
 
 static cl::opt<bool> StatsAsJSON("stats-json",
                                  cl::desc("Display statistics as json data"),
@@ -58,34 +63,82 @@ namespace {
 /// use LLVM.
 class StatisticInfo {
   std::vector<TrackingStatistic *> Stats;
+  std::vector<ShardedStatistic *> ShardedStats;
 
-  friend void llvm::PrintStatistics();
-  friend void llvm::PrintStatistics(raw_ostream &OS);
-  friend void llvm::PrintStatisticsJSON(raw_ostream &OS);
-
-  /// Sort statistics by debugtype,name,description.
-  void sort();
 public:
-  using const_iterator = std::vector<TrackingStatistic *>::const_iterator;
-
   StatisticInfo();
   ~StatisticInfo();
 
   void addStatistic(TrackingStatistic *S) { Stats.push_back(S); }
+  void addStatistic(ShardedStatistic *S) { ShardedStats.push_back(S); }
 
-  const_iterator begin() const { return Stats.begin(); }
-  const_iterator end() const { return Stats.end(); }
-  iterator_range<const_iterator> statistics() const {
-    return {begin(), end()};
-  }
+  bool empty() const { return Stats.empty() && ShardedStats.empty(); }
+
+  /// Return the registered statistics of both kinds and their values, sorted
+  /// by debugtype,name,description.
+  std::vector<std::pair<const StatisticBase *, unsigned>> collect() const;
 
   void reset();
 };
+
+/// The counters of one thread for every ShardedStatistic. The pages are
+/// allocated by the owning thread when it first updates a statistic in them,
+/// and only that thread writes the counters. Other threads read them under
+/// StatLock.
+struct StatisticShards {
+  static constexpr unsigned PageSize = 256;
+  static constexpr unsigned NumPages = 64;
+  static constexpr unsigned NumSlots = PageSize * NumPages;
+
+  std::atomic<std::atomic<uint64_t> *> Pages[NumPages] = {};
+
+  ~StatisticShards() {
+    for (auto &Page : Pages)
+      delete[] Page.load(std::memory_order_relaxed);
+  }
+
+  std::atomic<uint64_t> &getSlot(unsigned Slot) {
+    std::atomic<uint64_t> *Page =
+        Pages[Slot / PageSize].load(std::memory_order_relaxed);
+    if (!Page) {
+      Page = new std::atomic<uint64_t>[PageSize]();
+      Pages[Slot / PageSize].store(Page, std::memory_order_release);
+    }
+    return Page[Slot % PageSize];
+  }
+
+  uint64_t read(unsigned Slot) const {
+    std::atomic<uint64_t> *Page =
+        Pages[Slot / PageSize].load(std::memory_order_acquire);
+    return Page ? Page[Slot % PageSize].load(std::memory_order_relaxed) : 0;
+  }
+
+  void clear(unsigned Slot) {
+    if (std::atomic<uint64_t> *Page =
+            Pages[Slot / PageSize].load(std::memory_order_acquire))
+      Page[Slot % PageSize].store(0, std::memory_order_relaxed);
+  }
+};
 } // end anonymous namespace
 
 static ManagedStatic<StatisticInfo> StatInfo;
 static ManagedStatic<sys::SmartMutex<true> > StatLock;
 
+/// The shards of every thread that has updated a ShardedStatistic, guarded by
+/// StatLock. They are kept when their thread exits, as they still hold its
+/// counts, and are never freed since threads may update statistics during
+/// shutdown.
+static std::vector<std::unique_ptr<StatisticShards>> &getAllShards() {
+  static auto *AllShards = new std::vector<std::unique_ptr<StatisticShards>>();
+  return *AllShards;
+}
+
+static LLVM_THREAD_LOCAL StatisticShards *ThreadShards = nullptr;
+
+/// The number of shard slots handed out to ShardedStatistics, guarded by
+/// StatLock. Slots are never reused.
+static unsigned NumShardedSlots;
+
 /// RegisterStatistic - The first time a statistic is bumped, this method is
 /// called.
 void TrackingStatistic::RegisterStatistic() {
@@ -112,6 +165,82 @@ void TrackingStatistic::RegisterStatistic() {
   }
 }
 
+void ShardedStatistic::RegisterStatistic() {
+  // See TrackingStatistic::RegisterStatistic for the locking order.
+  sys::SmartMutex<true> &Lock = *StatLock;
+  StatisticInfo &SI = *StatInfo;
+  sys::SmartScopedLock<true> Writer(Lock);
+  if (Initialized.load(std::memory_order_relaxed))
+    return;
+  // A statistic keeps its slot when it is reset.
+  if (!Index.load(std::memory_order_relaxed))
+    Index.store(++NumShardedSlots, std::memory_order_relaxed);
+  SI.addStatistic(this);
+  Initialized.store(true, std::memory_order_release);
+}
+
+uint64_t ShardedStatistic::addToShard(uint64_t V) {
+  if (!Initialized.load(std::memory_order_acquire))
+    RegisterStatistic();
+
+  unsigned Slot = Index.load(std::memory_order_relaxed) - 1;
+  if (Slot >= StatisticShards::NumSlots)
+    return Base.fetch_add(V, std::memory_order_relaxed);
+
+  StatisticShards *Shards = ThreadShards;
+  if (!Shards) {
+    Shards = new StatisticShards();
+    sys::SmartMutex<true> &Lock = *StatLock;
+    sys::SmartScopedLock<true> Writer(Lock);
+    getAllShards().emplace_back(Shards);
+    ThreadShards = Shards;
+  }
+
+  // Nobody else writes this counter, so it needs no read-modify-write.
+  std::atomic<uint64_t> &Counter = Shards->getSlot(Slot);
+  uint64_t Prev = Counter.load(std::memory_order_relaxed);
+  Counter.store(Prev + V, std::memory_order_relaxed);
+  return Base.load(std::memory_order_relaxed) + Prev;
+}
+
+unsigned ShardedStatistic::getValue() const {
+  sys::SmartMutex<true> &Lock = *StatLock;
+  sys::SmartScopedLock<true> Reader(Lock);
+  uint64_t Value = Base.load(std::memory_order_relaxed);
+  unsigned Slot = Index.load(std::memory_order_relaxed) - 1;
+  if (Slot < StatisticShards::NumSlots)
+    for (const auto &Shards : getAllShards())
+      Value += Shards->read(Slot);
+  return unsigned(Value);
+}
+
+const ShardedStatistic &ShardedStatistic::operator=(unsigned Val) {
+  if (!detail::CollectShardedStatistics.load(std::memory_order_relaxed))
+    return *this;
+  if (!Initialized.load(std::memory_order_acquire))
+    RegisterStatistic();
+
+  sys::SmartMutex<true> &Lock = *StatLock;
+  sys::SmartScopedLock<true> Writer(Lock);
+  unsigned Slot = Index.load(std::memory_order_relaxed) - 1;
+  if (Slot < StatisticShards::NumSlots)
+    for (const auto &Shards : getAllShards())
+      Shards->clear(Slot);
+  Base.store(Val, std::memory_order_relaxed);
+  return *this;
+}
+
+void ShardedStatistic::updateMax(unsigned V) {
+  if (!detail::CollectShardedStatistics.load(std::memory_order_relaxed))
+    return;
+  if (!Initialized.load(std::memory_order_acquire))
+    RegisterStatistic();
+  sys::SmartMutex<true> &Lock = *StatLock;
+  sys::SmartScopedLock<true> Writer(Lock);
+  if (V > getValue())
+    *this = V;
+}
+
 StatisticInfo::StatisticInfo() {
   // Ensure timergroup lists are created first so they are destructed after us.
   TimerGroup::ConstructTimerLists();
@@ -125,6 +254,7 @@ StatisticInfo::~StatisticInfo() {
 
 void llvm::EnableStatistics(bool DoPrintOnExit) {
   Enabled = true;
+  detail::CollectShardedStatistics = true;
   PrintOnExit = DoPrintOnExit;
 }
 
@@ -132,17 +262,26 @@ bool llvm::AreStatisticsEnabled() {
   return Enabled || EnableStats;
 }
 
-void StatisticInfo::sort() {
-  llvm::stable_sort(
-      Stats, [](const TrackingStatistic *LHS, const TrackingStatistic *RHS) {
-        if (int Cmp = std::strcmp(LHS->getDebugType(), RHS->getDebugType()))
-          return Cmp < 0;
-
-        if (int Cmp = std::strcmp(LHS->getName(), RHS->getName()))
-          return Cmp < 0;
-
-        return std::strcmp(LHS->getDesc(), RHS->getDesc()) < 0;
-      });
+std::vector<std::pair<const StatisticBase *, unsigned>>
+StatisticInfo::collect() const {
+  sys::SmartScopedLock<true> Reader(*StatLock);
+  std::vector<std::pair<const StatisticBase *, unsigned>> Result;
+  for (const TrackingStatistic *Stat : Stats)
+    Result.emplace_back(Stat, Stat->getValue());
+  for (const ShardedStatistic *Stat : ShardedStats)
+    Result.emplace_back(Stat, Stat->getValue());
+
+  llvm::stable_sort(Result, [](const auto &L, const auto &R) {
+    const StatisticBase *LHS = L.first, *RHS = R.first;
+    if (int Cmp = std::strcmp(LHS->getDebugType(), RHS->getDebugType()))
+      return Cmp < 0;
+
+    if (int Cmp = std::strcmp(LHS->getName(), RHS->getName()))
+      return Cmp < 0;
+
+    return std::strcmp(LHS->getDesc(), RHS->getDesc()) < 0;
+  });
+  return Result;
 }
 
 void StatisticInfo::reset() {
@@ -158,6 +297,14 @@ void StatisticInfo::reset() {
     Stat->Initialized = false;
     Stat->Value = 0;
   }
+  for (auto *Stat : ShardedStats) {
+    Stat->Initialized = false;
+    unsigned Slot = Stat->Index - 1;
+    if (Slot < StatisticShards::NumSlots)
+      for (const auto &Shards : getAllShards())
+        Shards->clear(Slot);
+    Stat->Base = 0;
+  }
 
   // Clear the registration list and release the lock once we're done. Any
   // pending updates from other threads will safely take effect after we return.
@@ -165,33 +312,29 @@ void StatisticInfo::reset() {
   // but it's their responsibility to prevent concurrent compilations to make
   // a single compilation measurable.
   Stats.clear();
+  ShardedStats.clear();
 }
 
 void llvm::PrintStatistics(raw_ostream &OS) {
-  StatisticInfo &Stats = *StatInfo;
+  auto Stats = StatInfo->collect();
 
   // Figure out how long the biggest Value and Name fields are.
   unsigned MaxDebugTypeLen = 0, MaxValLen = 0;
-  for (size_t i = 0, e = Stats.Stats.size(); i != e; ++i) {
-    MaxValLen = std::max(MaxValLen,
-                         (unsigned)utostr(Stats.Stats[i]->getValue()).size());
-    MaxDebugTypeLen = std::max(MaxDebugTypeLen,
-                         (unsigned)std::strlen(Stats.Stats[i]->getDebugType()));
+  for (const auto &Stat : Stats) {
+    MaxValLen = std::max(MaxValLen, (unsigned)utostr(Stat.second).size());
+    MaxDebugTypeLen = std::max(
+        MaxDebugTypeLen, (unsigned)std::strlen(Stat.first->getDebugType()));
   }
 
-  Stats.sort();
-
   // Print out the statistics header...
   OS << "===" << std::string(73, '-') << "===\n"
      << "                          ... Statistics Collected ...\n"
      << "===" << std::string(73, '-') << "===\n\n";
 
   // Print all of the statistics.
-  for (size_t i = 0, e = Stats.Stats.size(); i != e; ++i)
-    OS << format("%*u %-*s - %s\n",
-                 MaxValLen, Stats.Stats[i]->getValue(),
-                 MaxDebugTypeLen, Stats.Stats[i]->getDebugType(),
-                 Stats.Stats[i]->getDesc());
+  for (const auto &Stat : Stats)
+    OS << format("%*u %-*s - %s\n", MaxValLen, Stat.second, MaxDebugTypeLen,
+                 Stat.first->getDebugType(), Stat.first->getDesc());
 
   OS << '\n';  // Flush the output stream.
   OS.flush();
@@ -199,21 +342,20 @@ void llvm::PrintStatistics(raw_ostream &OS) {
 
 void llvm::PrintStatisticsJSON(raw_ostream &OS) {
   sys::SmartScopedLock<true> Reader(*StatLock);
-  StatisticInfo &Stats = *StatInfo;
-
-  Stats.sort();
 
   // Print all of the statistics.
   OS << "{\n";
   const char *delim = "";
-  for (const TrackingStatistic *Stat : Stats.Stats) {
+  for (const auto &Stat : StatInfo->collect()) {
     OS << delim;
-    assert(yaml::needsQuotes(Stat->getDebugType()) == yaml::QuotingType::None &&
+    assert(yaml::needsQuotes(Stat.first->getDebugType()) ==
+               yaml::QuotingType::None &&
            "Statistic group/type name is simple.");
-    assert(yaml::needsQuotes(Stat->getName()) == yaml::QuotingType::None &&
+    assert(yaml::needsQuotes(Stat.first->getName()) ==
+               yaml::QuotingType::None &&
            "Statistic name is simple");
-    OS << "\t\"" << Stat->getDebugType() << '.' << Stat->getName() << "\": "
-       << Stat->getValue();
+    OS << "\t\"" << Stat.first->getDebugType() << '.' << Stat.first->getName()
+       << "\": " << Stat.second;
     delim = ",\n";
   }
   // Print timers.
@@ -224,12 +366,22 @@ void llvm::PrintStatisticsJSON(raw_ostream &OS) {
 }
 
 void llvm::PrintStatistics() {
-#if LLVM_ENABLE_STATS
   sys::SmartScopedLock<true> Reader(*StatLock);
   StatisticInfo &Stats = *StatInfo;
 
-  // Statistics not enabled?
-  if (Stats.Stats.empty()) return;
+  // Statistics not enabled? In release builds, Statistics operators do
+  // nothing, so only ShardedStatistics are ever registered.
+  if (Stats.empty()) {
+#if !LLVM_ENABLE_STATS
+    if (EnableStats) {
+      // Get the stream to write to.
+      std::unique_ptr<raw_ostream> OutStream = CreateInfoOutputFile();
+      (*OutStream) << "Statistics are disabled.  "
+                   << "Build with asserts or with -DLLVM_FORCE_ENABLE_STATS\n";
+    }
+#endif
+    return;
+  }
 
   // Get the stream to write to.
   std::unique_ptr<raw_ostream> OutStream = CreateInfoOutputFile();
@@ -237,26 +389,21 @@ void llvm::PrintStatistics() {
     PrintStatisticsJSON(*OutStream);
   else
     PrintStatistics(*OutStream);
-
-#else
-  // Check if the -stats option is set instead of checking
-  // !Stats.Stats.empty().  In release builds, Statistics operators
-  // do nothing, so stats are never Registered.
-  if (EnableStats) {
-    // Get the stream to write to.
-    std::unique_ptr<raw_ostream> OutStream = CreateInfoOutputFile();
-    (*OutStream) << "Statistics are disabled.  "
-                 << "Build with asserts or with -DLLVM_FORCE_ENABLE_STATS\n";
-  }
-#endif
 }
 
 const std::vector<std::pair<StringRef, unsigned>> llvm::GetStatistics() {
-  sys::SmartScopedLock<true> Reader(*StatLock);
   std::vector<std::pair<StringRef, unsigned>> ReturnStats;
+  for (const auto &Stat : StatInfo->collect())
+    ReturnStats.emplace_back(Stat.first->getName(), Stat.second);
+  return ReturnStats;
+}
 
-  for (const auto &Stat : StatInfo->statistics())
-    ReturnStats.emplace_back(Stat->getName(), Stat->getValue());
+std::vector<std::pair<std::string, unsigned>> llvm::GetQualifiedStatistics() {
+  std::vector<std::pair<std::string, unsigned>> ReturnStats;
+  for (const auto &Stat : StatInfo->collect())
+    ReturnStats.emplace_back(
+        (Twine(Stat.first->getDebugType()) + "." + Stat.first->getName()).str(),
+        Stat.second);
   return ReturnStats;
 }
 
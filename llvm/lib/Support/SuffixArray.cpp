@@ -0,0 +1,132 @@
+//===- llvm/Support/SuffixArray.cpp - Implement Suffix Array ----*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the Suffix Array class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/SuffixArray.h"
+#include "llvm/ADT/SmallVector.h"
+#include <numeric>
+
+using namespace llvm;
+
+SuffixArray::SuffixArray(ArrayRef<unsigned> Str) : Str(Str) {
+  unsigned N = Str.size();
+  Suffixes.resize(N);
+  CommonPrefixes.assign(N, 0);
+  if (N == 0)
+    return;
+
+  // Sort the suffixes by their first element, and rank them by it.
+  std::iota(Suffixes.begin(), Suffixes.end(), 0);
+  llvm::sort(Suffixes,
+             [&](unsigned LHS, unsigned RHS) { return Str[LHS] < Str[RHS]; });
+  std::vector<unsigned> Rank(N), Tmp(N), Count;
+  Rank[Suffixes[0]] = 0;
+  for (unsigned I = 1; I != N; ++I)
+    Rank[Suffixes[I]] = Rank[Suffixes[I - 1]] +
+                        (Str[Suffixes[I]] != Str[Suffixes[I - 1]]);
+
+  // Once the suffixes are sorted by their first K elements, sort them by
+  // their first 2K with the ranks of the two halves, until all the ranks are
+  // distinct. The rank of an empty second half is the smallest.
+  for (unsigned K = 1; Rank[Suffixes[N - 1]] != N - 1; K *= 2) {
+    auto SecondRank = [&](unsigned I) {
+      return I + K < N ? Rank[I + K] + 1 : 0;
+    };
+
+    // Order by the second half, which is the order of the suffixes K
+    // elements further along.
+    unsigned P = 0;
+    for (unsigned I = N - K; I != N; ++I)
+      Tmp[P++] = I;
+    for (unsigned I : Suffixes)
+      if (I >= K)
+        Tmp[P++] = I - K;
+
+    // Then stably by the first half.
+    Count.assign(Rank[Suffixes[N - 1]] + 1, 0);
+    for (unsigned R : Rank)
+      ++Count[R];
+    for (unsigned R = 0, Sum = 0; R != Count.size(); ++R) {
+      unsigned C = Count[R];
+      Count[R] = Sum;
+      Sum += C;
+    }
+    for (unsigned I : Tmp)
+      Suffixes[Count[Rank[I]]++] = I;
+
+    Tmp[Suffixes[0]] = 0;
+    for (unsigned I = 1; I != N; ++I) {
+      unsigned Prev = Suffixes[I - 1], Cur = Suffixes[I];
+      bool Same =
+          Rank[Prev] == Rank[Cur] && SecondRank(Prev) == SecondRank(Cur);
+      Tmp[Cur] = Tmp[Prev] + !Same;
+    }
+    std::swap(Rank, Tmp);
+  }
+
+  // Rank is now the inverse of Suffixes. If suffix I shares Len elements
+  // with its predecessor, suffix I + 1 shares at least Len - 1 with its own,
+  // so the comparisons take linear time in total.
+  for (unsigned I = 0, Len = 0; I != N; ++I) {
+    if (Rank[I] == 0) {
+      Len = 0;
+      continue;
+    }
+    unsigned J = Suffixes[Rank[I] - 1];
+    while (I + Len < N && J + Len < N && Str[I + Len] == Str[J + Len])
+      ++Len;
+    CommonPrefixes[Rank[I]] = Len;
+    if (Len)
+      --Len;
+  }
+}
+
+void SuffixArray::forEachRepeatedSubstring(
+    function_ref<void(const RepeatedSubstring &)> Callback,
+    unsigned MinLength) const {
+  // An interval of suffixes which share a prefix of Length elements, and the
+  // position of its first leaf in Leaves. The leaves of an interval are the
+  // suffixes which share no longer prefix with their neighbours, and so are
+  // in no nested interval.
+  struct Interval {
+    unsigned Length;
+    unsigned LeavesBegin;
+  };
+  SmallVector<Interval, 32> Stack;
+  Stack.push_back({0, 0});
+  std::vector<unsigned> Leaves;
+  RepeatedSubstring RS;
+
+  for (unsigned I = 0, N = Suffixes.size(); I != N; ++I) {
+    // The stack holds the intervals that contain suffix I, innermost last.
+    // Suffix I is a leaf of the innermost one, unless it shares a longer
+    // prefix with suffix I + 1, in which case it starts a new interval.
+    unsigned Next = I + 1 != N ? CommonPrefixes[I + 1] : 0;
+    if (Next > Stack.back().Length)
+      Stack.push_back({Next, static_cast<unsigned>(Leaves.size())});
+    if (Stack.back().Length >= MinLength)
+      Leaves.push_back(Suffixes[I]);
+
+    // Close the intervals which suffix I + 1 is not in.
+    while (Stack.back().Length > Next) {
+      Interval Top = Stack.pop_back_val();
+      if (Top.Length >= MinLength && Leaves.size() - Top.LeavesBegin >= 2) {
+        RS.Length = Top.Length;
+        RS.StartIndices.assign(Leaves.begin() + Top.LeavesBegin, Leaves.end());
+        llvm::sort(RS.StartIndices);
+        Callback(RS);
+      }
+      Leaves.resize(Top.LeavesBegin);
+      if (Stack.back().Length < Next)
+        Stack.push_back({Next, static_cast<unsigned>(Leaves.size())});
+    }
+  }
+}
@@ -14,11 +14,154 @@
 
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Support/Threading.h"
+#include "llvm/Support/TimeProfiler.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace llvm;
 
+struct ThreadPool::TaskNode {
+  PackagedTaskTy Task;
+  int Priority = 0;
+  uint64_t Sequence = 0;
+  ThreadPoolTaskGroup *Group = nullptr;
+  /// Number of dependencies that haven't completed yet.
+  unsigned PendingDependencies = 0;
+  bool Completed = false;
+  /// Tasks depending on this one.
+  std::vector<std::shared_ptr<TaskNode>> Successors;
+};
+
+bool ThreadPool::TaskOrder::operator()(
+    const std::shared_ptr<TaskNode> &LHS,
+    const std::shared_ptr<TaskNode> &RHS) const {
+  // std::priority_queue pops the greatest element first.
+  if (LHS->Priority != RHS->Priority)
+    return LHS->Priority < RHS->Priority;
+  return LHS->Sequence > RHS->Sequence;
+}
+
+std::shared_ptr<ThreadPool::TaskNode> ThreadPool::popTaskUnlocked() {
+  std::shared_ptr<TaskNode> Node = Tasks.top();
+  Tasks.pop();
+  --PendingTasks;
+  return Node;
+}
+
+void ThreadPool::runTask(std::shared_ptr<TaskNode> Node) {
+  Node->Task();
+  // Release whatever the task captured; the future's shared state outlives it.
+  Node->Task = PackagedTaskTy();
+
+  unsigned NumReady = 0;
+  bool NotifyCompletion;
+  {
+    std::lock_guard<std::mutex> LockGuard(QueueLock);
+    Node->Completed = true;
+    for (std::shared_ptr<TaskNode> &Successor : Node->Successors) {
+      if (--Successor->PendingDependencies == 0) {
+        Tasks.push(std::move(Successor));
+        ++NumReady;
+      }
+    }
+    Node->Successors.clear();
+
+    bool GroupCompleted = false;
+    if (Node->Group) {
+      auto It = GroupTasks.find(Node->Group);
+      if (--It->second == 0) {
+        GroupTasks.erase(It);
+        GroupCompleted = true;
+      }
+    }
+
+    // Adjust `ActiveThreads`, in case someone waits on ThreadPool::wait()
+    --ActiveThreads;
+    NotifyCompletion = GroupCompleted || workCompletedUnlocked();
+  }
+  if (NumReady == 1)
+    QueueCondition.notify_one();
+  else if (NumReady > 1)
+    QueueCondition.notify_all();
+  // Notify task completion if this is the last active thread, in case
+  // someone waits on ThreadPool::wait(), or if a group has completed. Threads
+  // of the pool waiting on a group wait on QueueCondition.
+  if (NotifyCompletion) {
+    CompletionCondition.notify_all();
+    QueueCondition.notify_all();
+  }
+}
+
+ThreadPool::TaskHandle ThreadPool::schedule(TaskTy F,
+                                            const TaskOptions &Opts) {
+  auto Node = std::make_shared<TaskNode>();
+  Node->Priority = Opts.Priority;
+  Node->Group = Opts.Group;
+
+  // Record the task into the trace of the scheduling thread if it is being
+  // profiled. The section has to end before the future becomes ready, as the
+  // trace may be written as soon as the task has been waited for.
+  TimeTraceTaskOrigin Origin = timeTraceProfilerTaskOrigin();
+  if (Origin.Profiler != nullptr)
+    F = [Task = std::move(F), Origin = std::move(Origin)] {
+      TimeTraceTaskScope TimeScope(Origin);
+      Task();
+    };
+
+  TaskHandle Handle;
+  Handle.Node = Node;
+#if LLVM_ENABLE_THREADS
+  /// Wrap the Task in a packaged_task to return a future object.
+  Node->Task = PackagedTaskTy(std::move(F));
+  Handle.Future = Node->Task.get_future().share();
+#else
+  // Get a Future with launch::deferred execution using std::async
+  auto Future = std::async(std::launch::deferred, std::move(F)).share();
+  // Wrap the future so that both ThreadPool::wait() can operate and the
+  // returned future can be sync'ed on.
+  Node->Task = PackagedTaskTy([Future]() { Future.get(); });
+  Handle.Future = Future;
+#endif
+
+  bool Ready;
+  {
+    // Lock the queue and push the new task
+    std::unique_lock<std::mutex> LockGuard(QueueLock);
+
 #if LLVM_ENABLE_THREADS
+    // Don't allow enqueueing after disabling the pool
+    assert(EnableFlag && "Queuing a thread during ThreadPool destruction");
+#endif
+
+    Node->Sequence = NextSequence++;
+    ++PendingTasks;
+    if (Node->Group)
+      ++GroupTasks[Node->Group];
+    for (const TaskHandle &Dependency : Opts.Dependencies) {
+      assert(Dependency && "Depending on an empty task handle");
+      if (!Dependency.Node->Completed) {
+        Dependency.Node->Successors.push_back(Node);
+        ++Node->PendingDependencies;
+      }
+    }
+    Ready = !Node->PendingDependencies;
+    if (Ready)
+      Tasks.push(std::move(Node));
+  }
+#if LLVM_ENABLE_THREADS
+  if (Ready)
+    QueueCondition.notify_one();
+#endif
+  return Handle;
+}
+
+std::shared_future<void> ThreadPool::asyncImpl(TaskTy Task) {
+  return schedule(std::move(Task)).getFuture();
+}
+
+#if LLVM_ENABLE_THREADS
+
+/// The pool whose thread is the current thread, if any.
+static thread_local ThreadPool *CurrentThreadPool = nullptr;
 
 ThreadPool::ThreadPool(ThreadPoolStrategy S)
     : ThreadCount(S.compute_thread_count()) {
@@ -28,8 +171,9 @@ ThreadPool::ThreadPool(ThreadPoolStrategy S)
   for (unsigned ThreadID = 0; ThreadID < ThreadCount; ++ThreadID) {
     Threads.emplace_back([S, ThreadID, this] {
       S.apply_thread_strategy(ThreadID);
+      CurrentThreadPool = this;
       while (true) {
-        PackagedTaskTy Task;
+        std::shared_ptr<TaskNode> Task;
         {
           std::unique_lock<std::mutex> LockGuard(QueueLock);
           // Wait for tasks to be pushed in the queue
@@ -44,49 +188,46 @@ ThreadPool::ThreadPool(ThreadPoolStrategy S)
           // in order for wait() to properly detect that even if the queue is
           // empty, there is still a task in flight.
           ++ActiveThreads;
-          Task = std::move(Tasks.front());
-          Tasks.pop();
+          Task = popTaskUnlocked();
         }
         // Run the task we just grabbed
-        Task();
-
-        bool Notify;
-        {
-          // Adjust `ActiveThreads`, in case someone waits on ThreadPool::wait()
-          std::lock_guard<std::mutex> LockGuard(QueueLock);
-          --ActiveThreads;
-          Notify = workCompletedUnlocked();
-        }
-        // Notify task completion if this is the last active thread, in case
-        // someone waits on ThreadPool::wait().
-        if (Notify)
-          CompletionCondition.notify_all();
+        runTask(std::move(Task));
       }
     });
   }
 }
 
 void ThreadPool::wait() {
+  assert(CurrentThreadPool != this &&
+         "Waiting on the whole pool from one of its threads would deadlock");
   // Wait for all threads to complete and the queue to be empty
   std::unique_lock<std::mutex> LockGuard(QueueLock);
   CompletionCondition.wait(LockGuard, [&] { return workCompletedUnlocked(); });
 }
 
-std::shared_future<void> ThreadPool::asyncImpl(TaskTy Task) {
-  /// Wrap the Task in a packaged_task to return a future object.
-  PackagedTaskTy PackagedTask(std::move(Task));
-  auto Future = PackagedTask.get_future();
-  {
-    // Lock the queue and push the new task
-    std::unique_lock<std::mutex> LockGuard(QueueLock);
-
-    // Don't allow enqueueing after disabling the pool
-    assert(EnableFlag && "Queuing a thread during ThreadPool destruction");
+void ThreadPool::wait(ThreadPoolTaskGroup &Group) {
+  std::unique_lock<std::mutex> LockGuard(QueueLock);
+  if (CurrentThreadPool != this) {
+    CompletionCondition.wait(LockGuard,
+                             [&] { return groupCompletedUnlocked(&Group); });
+    return;
+  }
 
-    Tasks.push(std::move(PackagedTask));
+  // We are running a task of this pool: help with queued tasks rather than
+  // blocking a thread the group may need to make progress.
+  while (!groupCompletedUnlocked(&Group)) {
+    if (Tasks.empty()) {
+      QueueCondition.wait(LockGuard, [&] {
+        return groupCompletedUnlocked(&Group) || !Tasks.empty();
+      });
+      continue;
+    }
+    ++ActiveThreads;
+    std::shared_ptr<TaskNode> Task = popTaskUnlocked();
+    LockGuard.unlock();
+    runTask(std::move(Task));
+    LockGuard.lock();
   }
-  QueueCondition.notify_one();
-  return Future.share();
 }
 
 // The destructor joins all threads, waiting for completion.
@@ -113,21 +254,28 @@ ThreadPool::ThreadPool(ThreadPoolStrategy S)
 
 void ThreadPool::wait() {
   // Sequential implementation running the tasks
+  std::unique_lock<std::mutex> LockGuard(QueueLock);
   while (!Tasks.empty()) {
-    auto Task = std::move(Tasks.front());
-    Tasks.pop();
-    Task();
+    ++ActiveThreads;
+    std::shared_ptr<TaskNode> Task = popTaskUnlocked();
+    LockGuard.unlock();
+    runTask(std::move(Task));
+    LockGuard.lock();
   }
+  assert(workCompletedUnlocked() && "Cyclic task dependencies");
 }
 
-std::shared_future<void> ThreadPool::asyncImpl(TaskTy Task) {
-  // Get a Future with launch::deferred execution using std::async
-  auto Future = std::async(std::launch::deferred, std::move(Task)).share();
-  // Wrap the future so that both ThreadPool::wait() can operate and the
-  // returned future can be sync'ed on.
-  PackagedTaskTy PackagedTask([Future]() { Future.get(); });
-  Tasks.push(std::move(PackagedTask));
-  return Future;
+void ThreadPool::wait(ThreadPoolTaskGroup &Group) {
+  // Sequential implementation running tasks until the group is complete.
+  std::unique_lock<std::mutex> LockGuard(QueueLock);
+  while (!groupCompletedUnlocked(&Group)) {
+    assert(!Tasks.empty() && "Cyclic task dependencies");
+    ++ActiveThreads;
+    std::shared_ptr<TaskNode> Task = popTaskUnlocked();
+    LockGuard.unlock();
+    runTask(std::move(Task));
+    LockGuard.lock();
+  }
 }
 
 ThreadPool::~ThreadPool() { wait(); }
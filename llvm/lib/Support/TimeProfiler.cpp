@@ -12,6 +12,7 @@
 
 #include "llvm/Support/TimeProfiler.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/JSON.h"
@@ -34,6 +35,12 @@ static std::vector<TimeTraceProfiler *>
     ThreadTimeTraceProfilerInstances; // GUARDED_BY(Mu)
 // Per Thread instance
 static LLVM_THREAD_LOCAL TimeTraceProfiler *TimeTraceProfilerInstance = nullptr;
+// The profiler a thread records the tasks it runs for other threads into. It
+// is registered in ThreadTimeTraceProfilerInstances when it is created and
+// reused until timeTraceProfilerCleanup deletes it, which bumps Generation.
+static LLVM_THREAD_LOCAL TimeTraceProfiler *TaskProfilerInstance = nullptr;
+static LLVM_THREAD_LOCAL unsigned TaskProfilerGeneration = 0;
+static unsigned Generation = 0; // GUARDED_BY(Mu)
 
 TimeTraceProfiler *llvm::getTimeTraceProfilerInstance() {
   return TimeTraceProfilerInstance;
@@ -51,6 +58,11 @@ struct Entry {
   TimePointType End;
   const std::string Name;
   const std::string Detail;
+  // The memory allocated by the process when the section began and ended,
+  // and the most it reached in between, if memory is recorded.
+  size_t StartMemory = 0;
+  size_t EndMemory = 0;
+  size_t PeakMemory = 0;
 
   Entry(TimePointType &&S, TimePointType &&E, std::string &&N, std::string &&Dt)
       : Start(std::move(S)), End(std::move(E)), Name(std::move(N)),
@@ -74,22 +86,44 @@ struct Entry {
 } // namespace
 
 struct llvm::TimeTraceProfiler {
-  TimeTraceProfiler(unsigned TimeTraceGranularity = 0, StringRef ProcName = "")
+  TimeTraceProfiler(unsigned TimeTraceGranularity = 0, StringRef ProcName = "",
+                    bool RecordMemory = false, bool RunsTasks = false)
       : BeginningOfTime(system_clock::now()), StartTime(steady_clock::now()),
         ProcName(ProcName), Pid(sys::Process::getProcessId()),
-        Tid(llvm::get_threadid()), TimeTraceGranularity(TimeTraceGranularity) {
+        Tid(llvm::get_threadid()), TimeTraceGranularity(TimeTraceGranularity),
+        RecordMemory(RecordMemory), RunsTasks(RunsTasks) {
     llvm::get_thread_name(ThreadName);
   }
 
+  // Samples the memory allocated by the process into the open sections. The
+  // allocators of LLVM, BumpPtrAllocator included, get their memory from
+  // malloc, so its usage accounts for them.
+  size_t sampleMemory() {
+    size_t Memory = sys::Process::GetMallocUsage();
+    if (!Stack.empty())
+      Stack.back().PeakMemory = std::max(Stack.back().PeakMemory, Memory);
+    return Memory;
+  }
+
   void begin(std::string Name, llvm::function_ref<std::string()> Detail) {
+    size_t Memory = RecordMemory ? sampleMemory() : 0;
     Stack.emplace_back(steady_clock::now(), TimePointType(), std::move(Name),
                        Detail());
+    Stack.back().StartMemory = Stack.back().PeakMemory = Memory;
   }
 
   void end() {
     assert(!Stack.empty() && "Must call begin() first");
     Entry &E = Stack.back();
     E.End = steady_clock::now();
+    if (RecordMemory) {
+      E.EndMemory = sampleMemory();
+      // The enclosing section reached at least the peak of this one.
+      if (Stack.size() > 1) {
+        Entry &Parent = Stack[Stack.size() - 2];
+        Parent.PeakMemory = std::max(Parent.PeakMemory, E.PeakMemory);
+      }
+    }
 
     // Check that end times monotonically increase.
     assert((Entries.empty() ||
@@ -109,13 +143,18 @@ struct llvm::TimeTraceProfiler {
     // them; e.g. if there's a template instantiation that instantiates other
     // templates from within, we only want to add the topmost one. "topmost"
     // happens to be the ones that don't have any currently open entries above
-    // itself.
-    if (std::find_if(++Stack.rbegin(), Stack.rend(), [&](const Entry &Val) {
+    // itself. The outermost section of a thread running tasks for other
+    // threads is the task, which is accounted for by the thread that created
+    // it, so it is left out.
+    if (!(RunsTasks && Stack.size() == 1) &&
+        std::find_if(++Stack.rbegin(), Stack.rend(), [&](const Entry &Val) {
           return Val.Name == E.Name;
         }) == Stack.rend()) {
       auto &CountAndTotal = CountAndTotalPerName[E.Name];
       CountAndTotal.first++;
       CountAndTotal.second += Duration;
+      if (RecordMemory)
+        MemoryPerName[E.Name] += int64_t(E.EndMemory) - int64_t(E.StartMemory);
     }
 
     Stack.pop_back();
@@ -149,8 +188,17 @@ struct llvm::TimeTraceProfiler {
         J.attribute("ts", StartUs);
         J.attribute("dur", DurUs);
         J.attribute("name", E.Name);
-        if (!E.Detail.empty()) {
-          J.attributeObject("args", [&] { J.attribute("detail", E.Detail); });
+        if (!E.Detail.empty() || RecordMemory) {
+          J.attributeObject("args", [&] {
+            if (!E.Detail.empty())
+              J.attribute("detail", E.Detail);
+            if (RecordMemory) {
+              J.attribute("memory delta",
+                          int64_t(E.EndMemory) - int64_t(E.StartMemory));
+              J.attribute("memory peak",
+                          int64_t(E.PeakMemory) - int64_t(E.StartMemory));
+            }
+          });
         }
       });
     };
@@ -182,6 +230,13 @@ struct llvm::TimeTraceProfiler {
       for (const auto &Stat : TTP->CountAndTotalPerName)
         combineStat(Stat);
 
+    StringMap<int64_t> AllMemoryPerName;
+    for (const auto &Stat : MemoryPerName)
+      AllMemoryPerName[Stat.getKey()] += Stat.getValue();
+    for (const TimeTraceProfiler *TTP : ThreadTimeTraceProfilerInstances)
+      for (const auto &Stat : TTP->MemoryPerName)
+        AllMemoryPerName[Stat.getKey()] += Stat.getValue();
+
     std::vector<NameAndCountAndDurationType> SortedTotals;
     SortedTotals.reserve(AllCountAndTotalPerName.size());
     for (const auto &Total : AllCountAndTotalPerName)
@@ -208,6 +263,8 @@ struct llvm::TimeTraceProfiler {
         J.attributeObject("args", [&] {
           J.attribute("count", int64_t(Count));
           J.attribute("avg ms", int64_t(DurUs / Count / 1000));
+          if (RecordMemory)
+            J.attribute("memory delta", AllMemoryPerName[Total.first]);
         });
       });
 
@@ -235,6 +292,14 @@ struct llvm::TimeTraceProfiler {
     J.arrayEnd();
     J.attributeEnd();
 
+    // Emit the statistics collected during the run, keyed like the output of
+    // -stats-json, so that they can be read along with the profile.
+    if (AreStatisticsEnabled())
+      J.attributeObject("statistics", [&] {
+        for (const auto &Stat : GetQualifiedStatistics())
+          J.attribute(Stat.first, Stat.second);
+      });
+
     // Emit the absolute time when this TimeProfiler started.
     // This can be used to combine the profiling data from
     // multiple processes and preserve actual time intervals.
@@ -249,6 +314,8 @@ struct llvm::TimeTraceProfiler {
   SmallVector<Entry, 16> Stack;
   SmallVector<Entry, 128> Entries;
   StringMap<CountAndDurationType> CountAndTotalPerName;
+  // The memory allocated by the topmost sections of each name.
+  StringMap<int64_t> MemoryPerName;
   const time_point<system_clock> BeginningOfTime;
   const TimePointType StartTime;
   const std::string ProcName;
@@ -258,24 +325,34 @@ struct llvm::TimeTraceProfiler {
 
   // Minimum time granularity (in microseconds)
   const unsigned TimeTraceGranularity;
+
+  // Whether to record the memory allocated by each section.
+  const bool RecordMemory;
+
+  // Whether this profiler records tasks run for other threads, see
+  // timeTraceProfilerAttachThread.
+  const bool RunsTasks;
 };
 
 void llvm::timeTraceProfilerInitialize(unsigned TimeTraceGranularity,
-                                       StringRef ProcName) {
+                                       StringRef ProcName, bool RecordMemory) {
   assert(TimeTraceProfilerInstance == nullptr &&
          "Profiler should not be initialized");
   TimeTraceProfilerInstance = new TimeTraceProfiler(
-      TimeTraceGranularity, llvm::sys::path::filename(ProcName));
+      TimeTraceGranularity, llvm::sys::path::filename(ProcName), RecordMemory);
 }
 
 // Removes all TimeTraceProfilerInstances.
 // Called from main thread.
 void llvm::timeTraceProfilerCleanup() {
   delete TimeTraceProfilerInstance;
+  TimeTraceProfilerInstance = nullptr;
   std::lock_guard<std::mutex> Lock(Mu);
   for (auto TTP : ThreadTimeTraceProfilerInstances)
     delete TTP;
   ThreadTimeTraceProfilerInstances.clear();
+  // The task profilers of the worker threads are gone.
+  ++Generation;
 }
 
 // Finish TimeTraceProfilerInstance on a worker thread.
@@ -286,6 +363,42 @@ void llvm::timeTraceProfilerFinishThread() {
   TimeTraceProfilerInstance = nullptr;
 }
 
+TimeTraceTaskOrigin llvm::timeTraceProfilerTaskOrigin() {
+  TimeTraceTaskOrigin Origin;
+  if (TimeTraceProfilerInstance != nullptr) {
+    Origin.Profiler = TimeTraceProfilerInstance;
+    Origin.Section = TimeTraceProfilerInstance->Stack.empty()
+                         ? "Task"
+                         : TimeTraceProfilerInstance->Stack.back().Name;
+  }
+  return Origin;
+}
+
+bool llvm::timeTraceProfilerAttachThread(TimeTraceProfiler *Parent) {
+  assert(Parent != nullptr && "Profiler object can't be null");
+  if (TimeTraceProfilerInstance != nullptr)
+    return false;
+  std::lock_guard<std::mutex> Lock(Mu);
+  if (TaskProfilerInstance == nullptr || TaskProfilerGeneration != Generation) {
+    TaskProfilerInstance = new TimeTraceProfiler(
+        Parent->TimeTraceGranularity, Parent->ProcName, Parent->RecordMemory,
+        /*RunsTasks=*/true);
+    TaskProfilerGeneration = Generation;
+    ThreadTimeTraceProfilerInstances.push_back(TaskProfilerInstance);
+  }
+  TimeTraceProfilerInstance = TaskProfilerInstance;
+  return true;
+}
+
+void llvm::timeTraceProfilerDetachThread() {
+  assert(TimeTraceProfilerInstance != nullptr &&
+         TimeTraceProfilerInstance == TaskProfilerInstance &&
+         "Thread is not attached");
+  assert(TimeTraceProfilerInstance->Stack.empty() &&
+         "All sections of a task should be ended when it finishes");
+  TimeTraceProfilerInstance = nullptr;
+}
+
 void llvm::timeTraceProfilerWrite(raw_pwrite_stream &OS) {
   assert(TimeTraceProfilerInstance != nullptr &&
          "Profiler object can't be null");
@@ -520,6 +520,195 @@ directory_iterator OverlayFileSystem::dir_begin(const Twine &Dir,
 
 void ProxyFileSystem::anchor() {}
 
+//===-----------------------------------------------------------------------===/
+// CachingFileSystem implementation
+//===-----------------------------------------------------------------------===/
+
+/// The entries of a directory, in the order the underlying file system
+/// listed them.
+struct CachingFileSystem::DirectoryListing {
+  std::vector<std::pair<std::string, sys::fs::file_type>> Entries;
+  StringSet<> Names;
+  /// The names in lower case, as some file systems ignore case in lookups.
+  StringSet<> FoldedNames;
+};
+
+namespace {
+
+class CachedDirIterImpl : public llvm::vfs::detail::DirIterImpl {
+  std::string Dir;
+  std::shared_ptr<const CachingFileSystem::DirectoryListing> Listing;
+  size_t Index = 0;
+
+  void setCurrentEntry();
+
+public:
+  CachedDirIterImpl(
+      StringRef Dir,
+      std::shared_ptr<const CachingFileSystem::DirectoryListing> Listing)
+      : Dir(Dir), Listing(std::move(Listing)) {
+    setCurrentEntry();
+  }
+
+  std::error_code increment() override {
+    ++Index;
+    setCurrentEntry();
+    return {};
+  }
+};
+
+} // namespace
+
+void CachedDirIterImpl::setCurrentEntry() {
+  if (Index == Listing->Entries.size()) {
+    CurrentEntry = directory_entry();
+    return;
+  }
+  const auto &Entry = Listing->Entries[Index];
+  SmallString<256> Path(Dir);
+  sys::path::append(Path, Entry.first);
+  CurrentEntry = directory_entry(std::string(Path.str()), Entry.second);
+}
+
+std::error_code CachingFileSystem::getKey(const Twine &Path,
+                                          SmallVectorImpl<char> &Key) const {
+  Key.clear();
+  Path.toVector(Key);
+  if (std::error_code EC = makeAbsolute(Key))
+    return EC;
+  sys::path::remove_dots(Key, /*remove_dot_dot=*/false);
+  return {};
+}
+
+std::shared_ptr<const CachingFileSystem::DirectoryListing>
+CachingFileSystem::getListing(StringRef Dir) {
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto I = Listings.find(Dir);
+    if (I != Listings.end())
+      return I->second;
+  }
+
+  // List the directory without holding the lock, so that other threads can
+  // keep using the cache meanwhile. If two threads list the same directory,
+  // the first listing wins.
+  auto Listing = std::make_shared<DirectoryListing>();
+  std::error_code EC;
+  for (directory_iterator I = getUnderlyingFS().dir_begin(Dir, EC), E;
+       !EC && I != E; I.increment(EC)) {
+    StringRef Name = sys::path::filename(I->path());
+    Listing->Entries.emplace_back(std::string(Name), I->type());
+    Listing->Names.insert(Name);
+    Listing->FoldedNames.insert(Name.lower());
+  }
+  std::shared_ptr<const DirectoryListing> Result;
+  if (!EC)
+    Result = std::move(Listing);
+
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return Listings.try_emplace(Dir, std::move(Result)).first->second;
+}
+
+bool CachingFileSystem::mayExist(StringRef Key) {
+  if (!ListDirectories)
+    return true;
+  StringRef Parent = sys::path::parent_path(Key);
+  if (Parent.empty())
+    return true;
+  std::shared_ptr<const DirectoryListing> Listing = getListing(Parent);
+  if (!Listing)
+    return true;
+  StringRef Name = sys::path::filename(Key);
+  return Listing->Names.count(Name) || Listing->FoldedNames.count(Name.lower());
+}
+
+ErrorOr<Status> CachingFileSystem::status(const Twine &Path) {
+  SmallString<256> Key;
+  if (getKey(Path, Key))
+    return getUnderlyingFS().status(Path);
+  SmallString<256> PathStorage;
+  StringRef PathStr = Path.toStringRef(PathStorage);
+
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto I = Statuses.find(Key);
+    if (I != Statuses.end()) {
+      const ErrorOr<Status> &Cached = I->second;
+      // Statuses are named after the path they were looked up with, unless
+      // the underlying file system names them otherwise.
+      if (Cached && Cached->getName() == Key)
+        return Status::copyWithNewName(*Cached, PathStr);
+      return Cached;
+    }
+  }
+
+  ErrorOr<Status> Result =
+      mayExist(Key) ? getUnderlyingFS().status(PathStr)
+                    : ErrorOr<Status>(
+                          make_error_code(errc::no_such_file_or_directory));
+  // Other errors, such as permission problems, may be transient.
+  if (!Result && Result.getError() != errc::no_such_file_or_directory &&
+      Result.getError() != errc::not_a_directory)
+    return Result;
+
+  std::lock_guard<std::mutex> Lock(Mutex);
+  if (Result && Result->getName() == PathStr)
+    Statuses.try_emplace(Key, Status::copyWithNewName(*Result, Key));
+  else
+    Statuses.try_emplace(Key, Result);
+  return Result;
+}
+
+ErrorOr<std::unique_ptr<File>>
+CachingFileSystem::openFileForRead(const Twine &Path) {
+  SmallString<256> Key;
+  if (!getKey(Path, Key)) {
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      auto I = Statuses.find(Key);
+      if (I != Statuses.end() && !I->second)
+        return I->second.getError();
+    }
+    if (!mayExist(Key)) {
+      std::error_code EC = make_error_code(errc::no_such_file_or_directory);
+      std::lock_guard<std::mutex> Lock(Mutex);
+      Statuses.try_emplace(Key, EC);
+      return EC;
+    }
+  }
+  return getUnderlyingFS().openFileForRead(Path);
+}
+
+directory_iterator CachingFileSystem::dir_begin(const Twine &Dir,
+                                                std::error_code &EC) {
+  SmallString<256> Key;
+  if (!ListDirectories || getKey(Dir, Key))
+    return getUnderlyingFS().dir_begin(Dir, EC);
+  std::shared_ptr<const DirectoryListing> Listing = getListing(Key);
+  if (!Listing)
+    return getUnderlyingFS().dir_begin(Dir, EC);
+  EC = std::error_code();
+  SmallString<256> DirStorage;
+  return directory_iterator(std::make_shared<CachedDirIterImpl>(
+      Dir.toStringRef(DirStorage), std::move(Listing)));
+}
+
+void CachingFileSystem::invalidate(const Twine &Path) {
+  SmallString<256> Key;
+  if (getKey(Path, Key))
+    return;
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Statuses.erase(Key);
+  Listings.erase(Key);
+  Listings.erase(sys::path::parent_path(Key));
+}
+
+void CachingFileSystem::invalidateAll() {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Statuses.clear();
+  Listings.clear();
+}
+
 namespace llvm {
 namespace vfs {
 
@@ -17,20 +17,26 @@
 #include "llvm/TableGen/Main.h"
 #include "TGParser.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/Config/llvm-config.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/TableGen/Error.h"
 #include "llvm/TableGen/Record.h"
 #include <algorithm>
 #include <cstdio>
 #include <system_error>
+#ifdef LLVM_ON_UNIX
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 using namespace llvm;
 
-static cl::opt<std::string>
-OutputFilename("o", cl::desc("Output filename"), cl::value_desc("filename"),
-               cl::init("-"));
+static cl::list<std::string>
+OutputFilenames("o", cl::desc("Output filename, once per action"),
+                cl::value_desc("filename"));
 
 static cl::opt<std::string>
 DependFilename("d",
@@ -55,6 +61,12 @@ WriteIfChanged("write-if-changed", cl::desc("Only write output if it changed"));
 static cl::opt<bool>
 TimePhases("time-phases", cl::desc("Time phases of parser and backend"));
 
+static cl::opt<unsigned>
+BackendJobs("backend-jobs",
+            cl::desc("Number of actions to perform at once, 0 for one per "
+                     "core"),
+            cl::init(0));
+
 static int reportError(const char *ProgName, Twine Msg) {
   errs() << ProgName << ": " << Msg;
   errs().flush();
@@ -66,7 +78,7 @@ static int reportError(const char *ProgName, Twine Msg) {
 /// This functionality is really only for the benefit of the build system.
 /// It is similar to GCC's `-M*` family of options.
 static int createDependencyFile(const TGParser &Parser, const char *argv0) {
-  if (OutputFilename == "-")
+  if (OutputFilenames.empty())
     return reportError(argv0, "the option -d must be used together with -o\n");
 
   std::error_code EC;
@@ -74,7 +86,7 @@ static int createDependencyFile(const TGParser &Parser, const char *argv0) {
   if (EC)
     return reportError(argv0, "error opening " + DependFilename + ":" +
                                   EC.message() + "\n");
-  DepOut.os() << OutputFilename << ":";
+  DepOut.os() << join(OutputFilenames, " ") << ":";
   for (const auto &Dep : Parser.getDependencies()) {
     DepOut.os() << ' ' << Dep;
   }
@@ -83,7 +95,110 @@ static int createDependencyFile(const TGParser &Parser, const char *argv0) {
   return 0;
 }
 
+static StringRef getOutputFilename(unsigned Action) {
+  return OutputFilenames.empty() ? "-" : OutputFilenames[Action];
+}
+
+/// Perform the action with index Action and write its output file.
+static int runAction(const char *argv0, unsigned Action,
+                     TableGenMultiMainFn MainFn, RecordKeeper &Records) {
+  unsigned ErrorsBefore = ErrorsPrinted;
+
+  // Write output to memory.
+  Records.startBackendTimer("Backend overall");
+  std::string OutString;
+  raw_string_ostream Out(OutString);
+  unsigned status = MainFn(Action, Out, Records);
+  Records.stopBackendTimer();
+  if (status)
+    return 1;
+
+  Records.startTimer("Write output");
+  StringRef OutputFilename = getOutputFilename(Action);
+  bool WriteFile = true;
+  if (WriteIfChanged) {
+    // Only updates the real output file if there are any differences.
+    // This prevents recompilation of all the files depending on it if there
+    // aren't any.
+    if (auto ExistingOrErr = MemoryBuffer::getFile(OutputFilename))
+      if (std::move(ExistingOrErr.get())->getBuffer() == Out.str())
+        WriteFile = false;
+  }
+  if (WriteFile) {
+    std::error_code EC;
+    ToolOutputFile OutFile(OutputFilename, EC, sys::fs::OF_None);
+    if (EC)
+      return reportError(argv0, "error opening " + OutputFilename + ": " +
+                                    EC.message() + "\n");
+    OutFile.os() << Out.str();
+    if (ErrorsPrinted == ErrorsBefore)
+      OutFile.keep();
+  }
+  Records.stopTimer();
+
+  if (ErrorsPrinted > ErrorsBefore)
+    return reportError(argv0, Twine(ErrorsPrinted - ErrorsBefore) +
+                                  " errors.\n");
+  return 0;
+}
+
+#ifdef LLVM_ON_UNIX
+/// Perform the actions in child processes, at most Jobs at a time. The
+/// children get the parsed records for free from fork, and each one writes
+/// its own output file, so the backends do not need to be thread-safe.
+static int runActionsInProcesses(const char *argv0, unsigned NumActions,
+                                 unsigned Jobs, TableGenMultiMainFn MainFn,
+                                 RecordKeeper &Records) {
+  outs().flush();
+  errs().flush();
+
+  int Result = 0;
+  unsigned Running = 0;
+  auto waitForChild = [&]() {
+    int Status;
+    if (::waitpid(-1, &Status, 0) < 0 || !WIFEXITED(Status) ||
+        WEXITSTATUS(Status) != 0)
+      Result = 1;
+    --Running;
+  };
+  for (unsigned Action = 0; Action != NumActions; ++Action) {
+    if (Running == Jobs)
+      waitForChild();
+    pid_t Pid = ::fork();
+    if (Pid == 0) {
+      int Ret = runAction(argv0, Action, MainFn, Records);
+      outs().flush();
+      errs().flush();
+      // Skip the destructors, the parent owns the records.
+      ::_exit(Ret);
+    }
+    if (Pid < 0) {
+      if (runAction(argv0, Action, MainFn, Records))
+        Result = 1;
+      continue;
+    }
+    ++Running;
+  }
+  while (Running)
+    waitForChild();
+  return Result;
+}
+#endif
+
 int llvm::TableGenMain(const char *argv0, TableGenMainFn *MainFn) {
+  return TableGenMain(argv0, 1,
+                      [MainFn](unsigned, raw_ostream &OS,
+                               RecordKeeper &Records) {
+                        return MainFn(OS, Records);
+                      });
+}
+
+int llvm::TableGenMain(const char *argv0, unsigned NumActions,
+                       TableGenMultiMainFn MainFn) {
+  if ((NumActions > 1 || OutputFilenames.size() > 1) &&
+      OutputFilenames.size() != NumActions)
+    return reportError(argv0, "the option -o must be given once per action\n");
+
   RecordKeeper Records;
 
   if (TimePhases)
@@ -113,49 +228,29 @@ int llvm::TableGenMain(const char *argv0, TableGenMainFn *MainFn) {
     return 1;
   Records.stopTimer();
 
-  // Write output to memory.
-  Records.startBackendTimer("Backend overall");
-  std::string OutString;
-  raw_string_ostream Out(OutString);
-  unsigned status = MainFn(Out, Records);
-  Records.stopBackendTimer();
-  if (status)
-    return 1;
+  unsigned Jobs = BackendJobs;
+  if (Jobs == 0)
+    Jobs = heavyweight_hardware_concurrency().compute_thread_count();
+  int Result = 0;
+#ifdef LLVM_ON_UNIX
+  // The timers of the children would be lost, so time the actions in turn.
+  if (NumActions > 1 && Jobs > 1 && !TimePhases)
+    Result = runActionsInProcesses(argv0, NumActions, Jobs, MainFn, Records);
+  else
+#endif
+    for (unsigned Action = 0; Action != NumActions; ++Action)
+      if (runAction(argv0, Action, MainFn, Records))
+        Result = 1;
 
-  // Always write the depfile, even if the main output hasn't changed.
-  // If it's missing, Ninja considers the output dirty.  If this was below
-  // the early exit below and someone deleted the .inc.d file but not the .inc
-  // file, tablegen would never write the depfile.
+  // Always write the depfile, even if the outputs haven't changed.
+  // If it's missing, Ninja considers the outputs dirty.  If it was only
+  // written along with the outputs and someone deleted the .inc.d file but
+  // not the .inc file, tablegen would never write the depfile.
   if (!DependFilename.empty()) {
     if (int Ret = createDependencyFile(Parser, argv0))
       return Ret;
   }
 
-  Records.startTimer("Write output");
-  bool WriteFile = true;
-  if (WriteIfChanged) {
-    // Only updates the real output file if there are any differences.
-    // This prevents recompilation of all the files depending on it if there
-    // aren't any.
-    if (auto ExistingOrErr = MemoryBuffer::getFile(OutputFilename))
-      if (std::move(ExistingOrErr.get())->getBuffer() == Out.str())
-        WriteFile = false;
-  }
-  if (WriteFile) {
-    std::error_code EC;
-    ToolOutputFile OutFile(OutputFilename, EC, sys::fs::OF_None);
-    if (EC)
-      return reportError(argv0, "error opening " + OutputFilename + ": " +
-                                    EC.message() + "\n");
-    OutFile.os() << Out.str();
-    if (ErrorsPrinted == 0)
-      OutFile.keep();
-  }
-  
-  Records.stopTimer();
   Records.stopPhaseTiming();
-
-  if (ErrorsPrinted > 0)
-    return reportError(argv0, Twine(ErrorsPrinted) + " errors.\n");
-  return 0;
+  return Result;
 }
@@ -160,6 +160,12 @@ void X86LegalizerInfo::setLegalizerInfo32bit() {
     getActionDefinitionsBuilder(G_ICMP)
         .legalForCartesianProduct({s8}, {s8, s16, s32, p0})
         .clampScalar(0, s8, s8);
+
+    // Selects, with CMOV. There is no 8-bit CMOV.
+    getActionDefinitionsBuilder(G_SELECT)
+        .legalFor({{s16, s1}, {s32, s1}, {p0, s1}})
+        .widenScalarToNextPow2(0, /*Min*/ 16)
+        .clampScalar(0, s16, s32);
   }
 
   // Control-flow
@@ -250,6 +256,12 @@ void X86LegalizerInfo::setLegalizerInfo64bit() {
       .legalForCartesianProduct({s8}, {s8, s16, s32, s64, p0})
       .clampScalar(0, s8, s8);
 
+  // Selects, with CMOV. There is no 8-bit CMOV.
+  getActionDefinitionsBuilder(G_SELECT)
+      .legalFor({{s16, s1}, {s32, s1}, {s64, s1}, {p0, s1}})
+      .widenScalarToNextPow2(0, /*Min*/ 16)
+      .clampScalar(0, s16, s64);
+
   getActionDefinitionsBuilder(G_FCMP)
       .legalForCartesianProduct({s8}, {s32, s64})
       .clampScalar(0, s8, s8)
@@ -56,6 +56,12 @@ static cl::opt<bool> EnableMachineCombinerPass("x86-machine-combiner",
                                cl::desc("Enable the machine combiner pass"),
                                cl::init(true), cl::Hidden);
 
+static cl::opt<int> EnableGlobalISelAtO(
+    "x86-enable-global-isel-at-O", cl::Hidden,
+    cl::desc("Enable GlobalISel on x86-64 at or below an opt level, falling "
+             "back to SelectionDAG where it fails (-1 to disable)"),
+    cl::init(-1));
+
 extern "C" LLVM_EXTERNAL_VISIBILITY void LLVMInitializeX86Target() {
   // Register the target.
   RegisterTargetMachine<X86TargetMachine> X(getTheX86_32Target());
@@ -228,6 +234,13 @@ X86TargetMachine::X86TargetMachine(const Target &T, const Triple &TT,
   // x86 supports the debug entry values.
   setSupportsDebugEntryValues(true);
 
+  // GlobalISel is incomplete on x86, so functions it cannot select go through
+  // SelectionDAG instead.
+  if (TT.getArch() == Triple::x86_64 && getOptLevel() <= EnableGlobalISelAtO) {
+    setGlobalISel(true);
+    setGlobalISelAbort(GlobalISelAbortMode::Disable);
+  }
+
   initAsmInfo();
 }
 
@@ -78,6 +78,12 @@ static cl::opt<unsigned>
                           cl::desc("Maximal number of fixpoint iterations."),
                           cl::init(32));
 
+static cl::opt<unsigned> MaxUpdates(
+    "attributor-max-updates", cl::Hidden,
+    cl::desc("Maximal number of abstract attribute updates in a fixpoint "
+             "iteration, 0 for no limit."),
+    cl::init(0));
+
 static cl::opt<unsigned, true> MaxInitializationChainLengthX(
     "attributor-max-initialization-chain-length", cl::Hidden,
     cl::desc(
@@ -979,6 +985,8 @@ void Attributor::runTillFixpoint() {
   // the abstract analysis.
 
   unsigned IterationCounter = 1;
+  unsigned NumUpdates = 0;
+  bool OutOfUpdates = false;
 
   SmallVector<AbstractAttribute *, 32> ChangedAAs;
   SetVector<AbstractAttribute *> Worklist, InvalidAAs;
@@ -1035,12 +1043,22 @@ void Attributor::runTillFixpoint() {
     InvalidAAs.clear();
 
     // Update all abstract attribute in the work list and record the ones that
-    // changed.
+    // changed. Once the update budget is spent, the remaining ones may depend
+    // on changed attributes without having seen the change, so they are
+    // treated as changed and reset below.
     for (AbstractAttribute *AA : Worklist) {
       const auto &AAState = AA->getState();
-      if (!AAState.isAtFixpoint())
+      if (!AAState.isAtFixpoint()) {
+        if (MaxUpdates && NumUpdates == MaxUpdates)
+          OutOfUpdates = true;
+        if (OutOfUpdates) {
+          ChangedAAs.push_back(AA);
+          continue;
+        }
+        ++NumUpdates;
         if (updateAA(*AA) == ChangeStatus::CHANGED)
           ChangedAAs.push_back(AA);
+      }
 
       // Use the InvalidAAs vector to propagate invalid states fast transitively
       // without requiring updates.
@@ -1058,12 +1076,15 @@ void Attributor::runTillFixpoint() {
     Worklist.clear();
     Worklist.insert(ChangedAAs.begin(), ChangedAAs.end());
 
-  } while (!Worklist.empty() && (IterationCounter++ < MaxFixpointIterations ||
-                                 VerifyMaxFixpointIterations));
+  } while (!Worklist.empty() && !OutOfUpdates &&
+           (IterationCounter++ < MaxFixpointIterations ||
+            VerifyMaxFixpointIterations));
 
   LLVM_DEBUG(dbgs() << "\n[Attributor] Fixpoint iteration done after: "
                     << IterationCounter << "/" << MaxFixpointIterations
-                    << " iterations\n");
+                    << " iterations and " << NumUpdates << " updates"
+                    << (OutOfUpdates ? " (update limit reached)" : "")
+                    << "\n");
 
   // Reset abstract arguments not settled in a sound fixpoint by now. This
   // happens when we stopped the fixpoint iteration early. Note that only the
@@ -0,0 +1,751 @@
+//===- StructFieldReorder.cpp - Profile-guided struct field reordering ----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass reorders the fields of identified struct types so that the fields
+// accessed most often, according to the block counts of the profile, are
+// packed together at the start of the struct.
+//
+// A struct type is only reordered if every access to its layout can be
+// rewritten: fields must be addressed by GEP instructions, the type must not
+// appear in the signature of a function or the type of a global that is
+// visible outside of the module, and pointers to it may only be cast to bytes
+// for allocation, deallocation and whole-object memory intrinsics. The new
+// layout always has the size and alignment of the original one, so sizes
+// computed by the frontend remain valid.
+//
+// Types that mention a reordered type, such as pointers to it and functions
+// taking such pointers, are replaced throughout the module. Struct-path TBAA
+// metadata describes the original field offsets, so it is dropped from the
+// functions that address a reordered field, and !tbaa.struct is dropped from
+// all memory copies.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/IPO/StructFieldReorder.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/Analysis/MemoryBuiltins.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/GetElementPtrTypeIterator.h"
+#include "llvm/IR/GlobalAlias.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Operator.h"
+#include "llvm/IR/TypeFinder.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
+#include <numeric>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "struct-field-reorder"
+
+STATISTIC(NumStructsReordered, "Number of struct types reordered");
+STATISTIC(NumStructsEscaping,
+          "Number of struct types whose layout escapes the module");
+
+static cl::opt<unsigned> HotFieldPercent(
+    "struct-reorder-hot-field-percent", cl::init(10), cl::Hidden,
+    cl::desc("A field is hot if its access count is at least this percentage "
+             "of the count of the most accessed field of its struct"));
+
+namespace {
+
+/// A GEP index that selects a field of a struct type that may be reordered.
+struct FieldAccess {
+  GetElementPtrInst *GEP;
+  unsigned OperandNo;
+  StructType *STy;
+};
+
+/// The new order of the fields of a reordered struct type.
+struct FieldOrder {
+  /// The original index of the field at each position of the new layout.
+  SmallVector<unsigned, 8> NewToOld;
+  /// The position in the new layout of each original field.
+  SmallVector<unsigned, 8> OldToNew;
+};
+
+/// Maps every type that mentions a reordered struct type to a new type built
+/// from the reordered layouts.
+class ReorderedTypeMapper : public ValueMapTypeRemapper {
+public:
+  ReorderedTypeMapper(const MapVector<StructType *, FieldOrder> &Orders)
+      : Orders(Orders) {}
+
+  Type *remapType(Type *Ty) override;
+
+  /// The identified struct types that have been replaced, with their
+  /// replacements.
+  ArrayRef<std::pair<StructType *, StructType *>> replacedStructs() const {
+    return ReplacedStructs;
+  }
+
+private:
+  bool isAffected(Type *Ty);
+
+  const MapVector<StructType *, FieldOrder> &Orders;
+  DenseMap<Type *, Type *> MappedTypes;
+  DenseMap<Type *, bool> AffectedTypes;
+  SmallVector<std::pair<StructType *, StructType *>, 8> ReplacedStructs;
+};
+
+class StructFieldReorder {
+public:
+  StructFieldReorder(Module &M,
+                     function_ref<BlockFrequencyInfo &(Function &)> GetBFI,
+                     function_ref<const TargetLibraryInfo &(Function &)> GetTLI)
+      : M(M), DL(M.getDataLayout()), GetBFI(GetBFI), GetTLI(GetTLI) {}
+
+  bool run();
+
+private:
+  bool mentionsCandidate(Type *Ty);
+  bool containsCandidateByValue(Type *Ty);
+  void markEscaping(Type *Ty);
+
+  void visitFunction(Function &F);
+  void visitGEP(GetElementPtrInst &GEP, bool HasProfile);
+  void visitCast(Operator &Cast, const TargetLibraryInfo *TLI);
+  void visitConstant(Constant *C);
+  bool isWholeObjectSize(Value *Len, Type *Pointee);
+  bool isSafeByteUse(User *U, Operator &Cast, const TargetLibraryInfo *TLI);
+
+  Optional<FieldOrder> chooseOrder(StructType *STy, ArrayRef<uint64_t> Counts);
+  uint64_t getHotSpan(StructType *STy, ArrayRef<Type *> Elements,
+                      ArrayRef<unsigned> NewToOld,
+                      ArrayRef<uint64_t> Counts, uint64_t HotCount);
+  void rewriteModule(const MapVector<StructType *, FieldOrder> &Orders);
+
+  Module &M;
+  const DataLayout &DL;
+  function_ref<BlockFrequencyInfo &(Function &)> GetBFI;
+  function_ref<const TargetLibraryInfo &(Function &)> GetTLI;
+
+  /// The access count of each field of the struct types that may be
+  /// reordered.
+  MapVector<StructType *, SmallVector<uint64_t, 8>> Candidates;
+  /// Candidates whose layout may be observed by code that cannot be rewritten.
+  SmallPtrSet<StructType *, 16> Escaping;
+  /// Every GEP index that selects a field of a candidate.
+  SmallVector<FieldAccess, 64> FieldAccesses;
+
+  DenseMap<Type *, bool> MentionsCandidate;
+  SmallPtrSet<Type *, 32> MarkedTypes;
+  SmallPtrSet<Constant *, 32> VisitedConstants;
+};
+
+} // end anonymous namespace
+
+/// Collect the identified struct types that \p Ty contains or points to,
+/// directly or through other types.
+static void collectStructs(Type *Ty, SmallPtrSetImpl<StructType *> &Structs) {
+  if (auto *STy = dyn_cast<StructType>(Ty))
+    if (!STy->isLiteral() && !Structs.insert(STy).second)
+      return;
+  for (Type *SubTy : Ty->subtypes())
+    collectStructs(SubTy, Structs);
+}
+
+/// Collect the memory accesses whose address is derived from \p Ptr, together
+/// with the derived address they use.
+static void collectMemoryAccesses(
+    Value *Ptr, SmallVectorImpl<std::pair<Instruction *, Value *>> &Accesses) {
+  SmallVector<Value *, 8> Worklist{Ptr};
+  SmallPtrSet<Value *, 8> Visited{Ptr};
+  while (!Worklist.empty()) {
+    Value *V = Worklist.pop_back_val();
+    for (User *U : V->users()) {
+      auto *I = dyn_cast<Instruction>(U);
+      if (!I)
+        continue;
+      if (isa<LoadInst>(I) || isa<AtomicRMWInst>(I) ||
+          isa<AtomicCmpXchgInst>(I) || isa<MemIntrinsic>(I) ||
+          (isa<StoreInst>(I) &&
+           cast<StoreInst>(I)->getPointerOperand() == V)) {
+        Accesses.push_back({I, V});
+        continue;
+      }
+      if ((isa<GetElementPtrInst>(I) && I->getOperand(0) == V) ||
+          isa<BitCastInst>(I) || isa<PHINode>(I) || isa<SelectInst>(I))
+        if (Visited.insert(I).second)
+          Worklist.push_back(I);
+    }
+  }
+}
+
+/// Lower the alignment claimed by \p I for its access through \p Ptr to at
+/// most \p A.
+static void clampAlignment(Instruction *I, Value *Ptr, Align A) {
+  if (auto *LI = dyn_cast<LoadInst>(I))
+    LI->setAlignment(std::min(LI->getAlign(), A));
+  else if (auto *SI = dyn_cast<StoreInst>(I))
+    SI->setAlignment(std::min(SI->getAlign(), A));
+  else if (auto *RMW = dyn_cast<AtomicRMWInst>(I))
+    RMW->setAlignment(std::min(RMW->getAlign(), A));
+  else if (auto *CmpXchg = dyn_cast<AtomicCmpXchgInst>(I))
+    CmpXchg->setAlignment(std::min(CmpXchg->getAlign(), A));
+  else if (auto *MI = dyn_cast<MemIntrinsic>(I)) {
+    if (MI->getRawDest() == Ptr)
+      MI->setDestAlignment(std::min(MI->getDestAlign().valueOrOne(), A));
+    if (auto *MTI = dyn_cast<MemTransferInst>(MI))
+      if (MTI->getRawSource() == Ptr)
+        MTI->setSourceAlignment(
+            std::min(MTI->getSourceAlign().valueOrOne(), A));
+  }
+}
+
+bool ReorderedTypeMapper::isAffected(Type *Ty) {
+  auto It = AffectedTypes.find(Ty);
+  if (It != AffectedTypes.end())
+    return It->second;
+  SmallPtrSet<StructType *, 8> Structs;
+  collectStructs(Ty, Structs);
+  bool Affected = any_of(Structs, [&](StructType *STy) {
+    return Orders.count(STy);
+  });
+  return AffectedTypes[Ty] = Affected;
+}
+
+Type *ReorderedTypeMapper::remapType(Type *Ty) {
+  auto It = MappedTypes.find(Ty);
+  if (It != MappedTypes.end())
+    return It->second;
+  if (!isAffected(Ty))
+    return MappedTypes[Ty] = Ty;
+
+  LLVMContext &Ctx = Ty->getContext();
+  if (auto *STy = dyn_cast<StructType>(Ty)) {
+    if (!STy->isLiteral()) {
+      // Map the struct before its elements, which may point back to it. It
+      // takes the name of the original type once the module is rewritten.
+      StructType *NewSTy = StructType::create(Ctx);
+      MappedTypes[Ty] = NewSTy;
+      ReplacedStructs.push_back({STy, NewSTy});
+
+      SmallVector<Type *, 8> Elements;
+      for (Type *ElTy : STy->elements())
+        Elements.push_back(remapType(ElTy));
+      auto OrderIt = Orders.find(STy);
+      if (OrderIt != Orders.end()) {
+        SmallVector<Type *, 8> Reordered;
+        for (unsigned OldIdx : OrderIt->second.NewToOld)
+          Reordered.push_back(Elements[OldIdx]);
+        Elements = std::move(Reordered);
+      }
+      NewSTy->setBody(Elements, STy->isPacked());
+      return NewSTy;
+    }
+  }
+
+  SmallVector<Type *, 8> SubTypes;
+  for (Type *SubTy : Ty->subtypes())
+    SubTypes.push_back(remapType(SubTy));
+
+  Type *NewTy = nullptr;
+  switch (Ty->getTypeID()) {
+  case Type::PointerTyID:
+    NewTy = PointerType::get(SubTypes[0], Ty->getPointerAddressSpace());
+    break;
+  case Type::ArrayTyID:
+    NewTy = ArrayType::get(SubTypes[0], Ty->getArrayNumElements());
+    break;
+  case Type::FixedVectorTyID:
+  case Type::ScalableVectorTyID:
+    NewTy = VectorType::get(SubTypes[0],
+                            cast<VectorType>(Ty)->getElementCount());
+    break;
+  case Type::FunctionTyID:
+    NewTy = FunctionType::get(SubTypes[0], makeArrayRef(SubTypes).drop_front(),
+                              cast<FunctionType>(Ty)->isVarArg());
+    break;
+  case Type::StructTyID:
+    NewTy = StructType::get(Ctx, SubTypes, cast<StructType>(Ty)->isPacked());
+    break;
+  default:
+    llvm_unreachable("Type without subtypes cannot mention a struct");
+  }
+  return MappedTypes[Ty] = NewTy;
+}
+
+bool StructFieldReorder::mentionsCandidate(Type *Ty) {
+  auto It = MentionsCandidate.find(Ty);
+  if (It != MentionsCandidate.end())
+    return It->second;
+  SmallPtrSet<StructType *, 8> Structs;
+  collectStructs(Ty, Structs);
+  bool Mentions = any_of(Structs, [&](StructType *STy) {
+    return Candidates.count(STy);
+  });
+  return MentionsCandidate[Ty] = Mentions;
+}
+
+bool StructFieldReorder::containsCandidateByValue(Type *Ty) {
+  if (auto *STy = dyn_cast<StructType>(Ty)) {
+    if (Candidates.count(STy))
+      return true;
+    return any_of(STy->elements(),
+                  [&](Type *ElTy) { return containsCandidateByValue(ElTy); });
+  }
+  if (auto *ATy = dyn_cast<ArrayType>(Ty))
+    return containsCandidateByValue(ATy->getElementType());
+  if (auto *VTy = dyn_cast<VectorType>(Ty))
+    return containsCandidateByValue(VTy->getElementType());
+  return false;
+}
+
+void StructFieldReorder::markEscaping(Type *Ty) {
+  if (!MarkedTypes.insert(Ty).second || !mentionsCandidate(Ty))
+    return;
+  SmallPtrSet<StructType *, 8> Structs;
+  collectStructs(Ty, Structs);
+  for (StructType *STy : Structs)
+    if (Candidates.count(STy) && Escaping.insert(STy).second)
+      LLVM_DEBUG(dbgs() << "SFR: layout of " << STy->getName()
+                        << " escapes through " << *Ty << "\n");
+}
+
+void StructFieldReorder::visitGEP(GetElementPtrInst &GEP, bool HasProfile) {
+  SmallVector<std::pair<Instruction *, Value *>, 8> Accesses;
+  bool AccessesCollected = false;
+  unsigned OperandNo = 1;
+  for (auto GTI = gep_type_begin(GEP), GTE = gep_type_end(GEP); GTI != GTE;
+       ++GTI, ++OperandNo) {
+    StructType *STy = GTI.getStructTypeOrNull();
+    if (!STy)
+      continue;
+    auto It = Candidates.find(STy);
+    if (It == Candidates.end())
+      continue;
+    auto *Idx = dyn_cast<ConstantInt>(GTI.getOperand());
+    if (!Idx) {
+      // Vector GEPs select fields with splat vectors; leave them alone.
+      Escaping.insert(STy);
+      continue;
+    }
+    FieldAccesses.push_back({&GEP, OperandNo, STy});
+    if (!HasProfile)
+      continue;
+    if (!AccessesCollected) {
+      collectMemoryAccesses(&GEP, Accesses);
+      AccessesCollected = true;
+    }
+    BlockFrequencyInfo &BFI = GetBFI(*GEP.getFunction());
+    uint64_t &FieldCount = It->second[Idx->getZExtValue()];
+    for (auto &Access : Accesses)
+      FieldCount = SaturatingAdd(
+          FieldCount,
+          BFI.getBlockProfileCount(Access.first->getParent()).getValueOr(0));
+  }
+}
+
+bool StructFieldReorder::isWholeObjectSize(Value *Len, Type *Pointee) {
+  if (!containsCandidateByValue(Pointee))
+    return true;
+  // A partial copy would observe the layout of the object.
+  uint64_t Size = DL.getTypeAllocSize(Pointee).getFixedSize();
+  if (auto *C = dyn_cast<ConstantInt>(Len))
+    return Size && C->getZExtValue() % Size == 0;
+  if (auto *Mul = dyn_cast<BinaryOperator>(Len))
+    if (Mul->getOpcode() == Instruction::Mul)
+      for (Value *Op : Mul->operands())
+        if (auto *C = dyn_cast<ConstantInt>(Op))
+          if (Size && C->getZExtValue() % Size == 0)
+            return true;
+  return false;
+}
+
+bool StructFieldReorder::isSafeByteUse(User *U, Operator &Cast,
+                                       const TargetLibraryInfo *TLI) {
+  Type *SrcTy = Cast.getOperand(0)->getType();
+  Type *Pointee = SrcTy->getPointerElementType();
+  if (auto *II = dyn_cast<IntrinsicInst>(U))
+    if (II->isLifetimeStartOrEnd())
+      return true;
+  if (auto *MSI = dyn_cast<MemSetInst>(U))
+    return MSI->getRawDest() == &Cast &&
+           isWholeObjectSize(MSI->getLength(), Pointee);
+  if (auto *MTI = dyn_cast<MemTransferInst>(U)) {
+    // Both sides of the copy must have the layout of the same type.
+    Value *Dest = MTI->getRawDest()->stripPointerCasts();
+    Value *Src = MTI->getRawSource()->stripPointerCasts();
+    return Dest->getType() == SrcTy && Src->getType() == SrcTy &&
+           isWholeObjectSize(MTI->getLength(), Pointee);
+  }
+  return TLI && isFreeCall(U, TLI);
+}
+
+void StructFieldReorder::visitCast(Operator &Cast,
+                                   const TargetLibraryInfo *TLI) {
+  Value *Src = Cast.getOperand(0);
+  if (!mentionsCandidate(Src->getType()) && !mentionsCandidate(Cast.getType()))
+    return;
+
+  if (Cast.getOpcode() == Instruction::BitCast &&
+      Src->getType()->isPointerTy()) {
+    // Pointers may be viewed as bytes to copy, clear, or free whole objects.
+    Type *Int8PtrTy = Type::getInt8PtrTy(
+        Cast.getContext(), Src->getType()->getPointerAddressSpace());
+    if (Cast.getType() == Int8PtrTy &&
+        all_of(Cast.users(), [&](User *U) {
+          return isSafeByteUse(U, Cast, TLI);
+        }))
+      return;
+    // Memory returned by an allocation function has no layout yet.
+    if (Src->getType() == Int8PtrTy && TLI && isAllocationFn(Src, TLI))
+      return;
+  }
+
+  markEscaping(Src->getType());
+  markEscaping(Cast.getType());
+}
+
+void StructFieldReorder::visitConstant(Constant *C) {
+  if (isa<GlobalValue>(C) || !VisitedConstants.insert(C).second)
+    return;
+
+  if (auto *CS = dyn_cast<ConstantStruct>(C)) {
+    // Initializers are laid out in the original order of the fields.
+    if (Candidates.count(CS->getType()))
+      Escaping.insert(CS->getType());
+  } else if (auto *GEP = dyn_cast<GEPOperator>(C)) {
+    for (auto GTI = gep_type_begin(GEP), GTE = gep_type_end(GEP); GTI != GTE;
+         ++GTI)
+      if (StructType *STy = GTI.getStructTypeOrNull())
+        if (Candidates.count(STy))
+          Escaping.insert(STy);
+  } else if (auto *CE = dyn_cast<ConstantExpr>(C)) {
+    if (CE->isCast())
+      visitCast(*cast<Operator>(CE), nullptr);
+  }
+
+  for (Value *Op : C->operands())
+    visitConstant(cast<Constant>(Op));
+}
+
+void StructFieldReorder::visitFunction(Function &F) {
+  if (!F.hasLocalLinkage() || F.isDeclaration() ||
+      any_of(F, [](BasicBlock &BB) { return BB.hasAddressTaken(); }))
+    markEscaping(F.getFunctionType());
+  if (F.isDeclaration())
+    return;
+
+  const TargetLibraryInfo &TLI = GetTLI(F);
+  bool HasProfile = F.getEntryCount().hasValue();
+  for (Instruction &I : instructions(F)) {
+    if (auto *GEP = dyn_cast<GetElementPtrInst>(&I))
+      visitGEP(*GEP, HasProfile);
+    else if (isa<CastInst>(&I))
+      visitCast(*cast<Operator>(&I), &TLI);
+    else if (isa<ExtractValueInst>(&I) || isa<InsertValueInst>(&I))
+      markEscaping(I.getOperand(0)->getType());
+    else if (auto *CB = dyn_cast<CallBase>(&I))
+      if (CB->isInlineAsm())
+        markEscaping(CB->getFunctionType());
+
+    for (Value *Op : I.operands())
+      if (auto *C = dyn_cast<Constant>(Op))
+        visitConstant(C);
+  }
+}
+
+uint64_t StructFieldReorder::getHotSpan(StructType *STy,
+                                        ArrayRef<Type *> Elements,
+                                        ArrayRef<unsigned> NewToOld,
+                                        ArrayRef<uint64_t> Counts,
+                                        uint64_t HotCount) {
+  const StructLayout *SL =
+      DL.getStructLayout(StructType::get(STy->getContext(), Elements));
+  uint64_t Begin = UINT64_MAX, End = 0;
+  for (unsigned NewIdx = 0, E = NewToOld.size(); NewIdx != E; ++NewIdx) {
+    if (Counts[NewToOld[NewIdx]] < HotCount)
+      continue;
+    uint64_t Offset = SL->getElementOffset(NewIdx);
+    Begin = std::min(Begin, Offset);
+    End = std::max(
+        End, Offset + DL.getTypeAllocSize(Elements[NewIdx]).getFixedSize());
+  }
+  return End - Begin;
+}
+
+Optional<FieldOrder>
+StructFieldReorder::chooseOrder(StructType *STy, ArrayRef<uint64_t> Counts) {
+  uint64_t MaxCount = *std::max_element(Counts.begin(), Counts.end());
+  if (!MaxCount)
+    return None;
+  uint64_t HotCount = std::max<uint64_t>(
+      SaturatingMultiply<uint64_t>(MaxCount, HotFieldPercent) / 100, 1);
+  auto IsHot = [&](unsigned Idx) { return Counts[Idx] >= HotCount; };
+  auto Layout = [&](ArrayRef<unsigned> NewToOld) {
+    SmallVector<Type *, 8> Elements;
+    for (unsigned OldIdx : NewToOld)
+      Elements.push_back(STy->getElementType(OldIdx));
+    return Elements;
+  };
+
+  SmallVector<unsigned, 8> Identity(Counts.size());
+  std::iota(Identity.begin(), Identity.end(), 0);
+  uint64_t Size = DL.getTypeAllocSize(STy).getFixedSize();
+  uint64_t Span =
+      getHotSpan(STy, Layout(Identity), Identity, Counts, HotCount);
+
+  // Try the fields by decreasing access count first. If that needs more
+  // padding, keep the hot fields first but sort each group by alignment,
+  // which packs naturally aligned fields without padding.
+  SmallVector<unsigned, 8> ByCount = Identity;
+  llvm::stable_sort(ByCount, [&](unsigned A, unsigned B) {
+    return Counts[A] > Counts[B];
+  });
+  SmallVector<unsigned, 8> ByAlign = Identity;
+  llvm::stable_sort(ByAlign, [&](unsigned A, unsigned B) {
+    if (IsHot(A) != IsHot(B))
+      return IsHot(A);
+    return DL.getABITypeAlign(STy->getElementType(A)) >
+           DL.getABITypeAlign(STy->getElementType(B));
+  });
+
+  for (ArrayRef<unsigned> NewToOld : {ByCount, ByAlign}) {
+    if (NewToOld == makeArrayRef(Identity))
+      continue;
+    SmallVector<Type *, 8> Elements = Layout(NewToOld);
+    if (DL.getTypeAllocSize(StructType::get(STy->getContext(), Elements))
+            .getFixedSize() != Size)
+      continue;
+    if (getHotSpan(STy, Elements, NewToOld, Counts, HotCount) >= Span)
+      continue;
+    FieldOrder Order;
+    Order.NewToOld.assign(NewToOld.begin(), NewToOld.end());
+    Order.OldToNew.resize(NewToOld.size());
+    for (unsigned NewIdx = 0, E = NewToOld.size(); NewIdx != E; ++NewIdx)
+      Order.OldToNew[NewToOld[NewIdx]] = NewIdx;
+    return Order;
+  }
+  return None;
+}
+
+void StructFieldReorder::rewriteModule(
+    const MapVector<StructType *, FieldOrder> &Orders) {
+  // Renumber the field indices while the GEPs still have the original types,
+  // and make sure accesses do not claim the alignment of the old offsets.
+  SmallPtrSet<Function *, 16> FunctionsWithFieldAccesses;
+  for (const FieldAccess &Access : FieldAccesses) {
+    auto It = Orders.find(Access.STy);
+    if (It == Orders.end())
+      continue;
+    auto *Idx = cast<ConstantInt>(Access.GEP->getOperand(Access.OperandNo));
+    unsigned OldIdx = Idx->getZExtValue();
+    Access.GEP->setOperand(
+        Access.OperandNo,
+        ConstantInt::get(Idx->getType(), It->second.OldToNew[OldIdx]));
+
+    Align FieldAlign = DL.getABITypeAlign(Access.STy->getElementType(OldIdx));
+    SmallVector<std::pair<Instruction *, Value *>, 8> Accesses;
+    collectMemoryAccesses(Access.GEP, Accesses);
+    for (auto &MemAccess : Accesses)
+      clampAlignment(MemAccess.first, MemAccess.second, FieldAlign);
+    FunctionsWithFieldAccesses.insert(Access.GEP->getFunction());
+  }
+  for (Function *F : FunctionsWithFieldAccesses)
+    for (Instruction &I : instructions(F))
+      I.setMetadata(LLVMContext::MD_tbaa, nullptr);
+  // Whole-object copies may be anywhere.
+  for (Function &F : M)
+    for (Instruction &I : instructions(F))
+      if (isa<MemTransferInst>(&I))
+        I.setMetadata(LLVMContext::MD_tbaa_struct, nullptr);
+
+  ReorderedTypeMapper TypeMapper(Orders);
+  ValueToValueMapTy VM;
+
+  // Functions and globals cannot change their value types, so the ones that
+  // mention a reordered type are replaced by new ones.
+  SmallVector<std::pair<Function *, Function *>, 16> ReplacedFunctions;
+  for (Function &F : M) {
+    auto *NewFTy =
+        cast<FunctionType>(TypeMapper.remapType(F.getFunctionType()));
+    if (NewFTy == F.getFunctionType())
+      continue;
+    assert(F.hasLocalLinkage() && !F.isDeclaration() &&
+           "Rewriting the signature of a visible function");
+    Function *NF =
+        Function::Create(NewFTy, F.getLinkage(), F.getAddressSpace());
+    NF->copyAttributesFrom(&F);
+    NF->setComdat(F.getComdat());
+    NF->copyMetadata(&F, 0);
+
+    // Typed parameter attributes refer to the old types.
+    LLVMContext &Ctx = F.getContext();
+    AttributeList Attrs = NF->getAttributes();
+    for (unsigned I = 0; I < Attrs.getNumAttrSets(); ++I)
+      for (Attribute::AttrKind TypedAttr :
+           {Attribute::ByVal, Attribute::StructRet, Attribute::ByRef,
+            Attribute::Preallocated})
+        if (Type *Ty = Attrs.getAttribute(I, TypedAttr).getValueAsType())
+          Attrs = Attrs.replaceAttributeType(Ctx, I, TypedAttr,
+                                             TypeMapper.remapType(Ty));
+    NF->setAttributes(Attrs);
+
+    M.getFunctionList().insert(F.getIterator(), NF);
+    NF->takeName(&F);
+    NF->getBasicBlockList().splice(NF->begin(), F.getBasicBlockList());
+    for (auto ArgPair : zip(F.args(), NF->args())) {
+      std::get<1>(ArgPair).takeName(&std::get<0>(ArgPair));
+      VM[&std::get<0>(ArgPair)] = &std::get<1>(ArgPair);
+    }
+    VM[&F] = NF;
+    ReplacedFunctions.push_back({&F, NF});
+  }
+
+  SmallVector<std::pair<GlobalVariable *, GlobalVariable *>, 16>
+      ReplacedGlobals;
+  for (GlobalVariable &GV : M.globals()) {
+    Type *NewTy = TypeMapper.remapType(GV.getValueType());
+    if (NewTy == GV.getValueType())
+      continue;
+    assert(GV.hasLocalLinkage() && "Rewriting the type of a visible global");
+    auto *NGV = new GlobalVariable(
+        M, NewTy, GV.isConstant(), GV.getLinkage(), nullptr, "", &GV,
+        GV.getThreadLocalMode(), GV.getAddressSpace(),
+        GV.isExternallyInitialized());
+    NGV->copyAttributesFrom(&GV);
+    NGV->setComdat(GV.getComdat());
+    NGV->copyMetadata(&GV, 0);
+    NGV->takeName(&GV);
+    VM[&GV] = NGV;
+    ReplacedGlobals.push_back({&GV, NGV});
+  }
+
+  ValueMapper Mapper(VM, RF_IgnoreMissingLocals | RF_NoModuleLevelChanges,
+                     &TypeMapper);
+  for (GlobalVariable &GV : M.globals()) {
+    if (!GV.hasInitializer() || VM.count(&GV))
+      continue;
+    Constant *Init = GV.getInitializer();
+    Constant *NewInit = Mapper.mapConstant(*Init);
+    if (NewInit != Init)
+      GV.setInitializer(NewInit);
+  }
+  for (auto &GVPair : ReplacedGlobals)
+    if (GVPair.first->hasInitializer())
+      GVPair.second->setInitializer(
+          Mapper.mapConstant(*GVPair.first->getInitializer()));
+  for (GlobalAlias &GA : M.aliases())
+    GA.setAliasee(Mapper.mapConstant(*GA.getAliasee()));
+  for (Function &F : M)
+    if (!F.isDeclaration())
+      Mapper.remapFunction(F);
+
+  // Remove the replaced functions and globals. Metadata may still refer to
+  // them.
+  for (auto &GVPair : ReplacedGlobals)
+    GVPair.first->setInitializer(nullptr);
+  for (auto &GVPair : ReplacedGlobals) {
+    GVPair.first->replaceAllUsesWith(
+        ConstantExpr::getBitCast(GVPair.second, GVPair.first->getType()));
+    GVPair.first->eraseFromParent();
+  }
+  for (auto &FPair : ReplacedFunctions) {
+    FPair.first->replaceAllUsesWith(
+        ConstantExpr::getBitCast(FPair.second, FPair.first->getType()));
+    FPair.first->eraseFromParent();
+  }
+
+  // The new types take over the names of the old ones.
+  for (auto &STyPair : TypeMapper.replacedStructs()) {
+    std::string Name = STyPair.first->getName().str();
+    STyPair.first->setName("");
+    STyPair.second->setName(Name);
+  }
+}
+
+bool StructFieldReorder::run() {
+  TypeFinder StructTypes;
+  StructTypes.run(M, /*onlySerialized=*/false);
+  for (StructType *STy : StructTypes)
+    if (!STy->isLiteral() && !STy->isOpaque() && !STy->isPacked() &&
+        STy->getNumElements() > 1)
+      Candidates[STy].resize(STy->getNumElements());
+  if (Candidates.empty())
+    return false;
+
+  for (Function &F : M)
+    visitFunction(F);
+  for (GlobalVariable &GV : M.globals()) {
+    if (!GV.hasLocalLinkage())
+      markEscaping(GV.getValueType());
+    // The intrinsic globals only collect references to other globals.
+    if (GV.hasInitializer() && GV.getName() != "llvm.used" &&
+        GV.getName() != "llvm.compiler.used")
+      visitConstant(GV.getInitializer());
+  }
+  for (GlobalAlias &GA : M.aliases()) {
+    markEscaping(GA.getValueType());
+    visitConstant(GA.getAliasee());
+  }
+  for (GlobalIFunc &GI : M.ifuncs())
+    markEscaping(GI.getValueType());
+  NumStructsEscaping += Escaping.size();
+
+  MapVector<StructType *, FieldOrder> Orders;
+  for (auto &Candidate : Candidates) {
+    StructType *STy = Candidate.first;
+    if (Escaping.count(STy))
+      continue;
+    if (Optional<FieldOrder> Order = chooseOrder(STy, Candidate.second)) {
+      LLVM_DEBUG({
+        dbgs() << "SFR: reordering " << STy->getName() << ":";
+        for (unsigned OldIdx : Order->NewToOld)
+          dbgs() << " " << OldIdx << "(" << Candidate.second[OldIdx] << ")";
+        dbgs() << "\n";
+      });
+      Orders.insert({STy, std::move(*Order)});
+    }
+  }
+  if (Orders.empty())
+    return false;
+
+  rewriteModule(Orders);
+  NumStructsReordered += Orders.size();
+  return true;
+}
+
+PreservedAnalyses StructFieldReorderPass::run(Module &M,
+                                              ModuleAnalysisManager &AM) {
+  // Without a profile there is nothing to order the fields by.
+  auto &PSI = AM.getResult<ProfileSummaryAnalysis>(M);
+  if (!PSI.hasProfileSummary())
+    return PreservedAnalyses::all();
+
+  auto &FAM = AM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+  auto GetBFI = [&FAM](Function &F) -> BlockFrequencyInfo & {
+    return FAM.getResult<BlockFrequencyAnalysis>(F);
+  };
+  auto GetTLI = [&FAM](Function &F) -> const TargetLibraryInfo & {
+    return FAM.getResult<TargetLibraryAnalysis>(F);
+  };
+  if (!StructFieldReorder(M, GetBFI, GetTLI).run())
+    return PreservedAnalyses::all();
+  return PreservedAnalyses::none();
+}
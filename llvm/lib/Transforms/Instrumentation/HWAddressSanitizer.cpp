@@ -17,6 +17,7 @@
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/Analysis/ValueTracking.h"
 #include "llvm/BinaryFormat/ELF.h"
 #include "llvm/IR/Attributes.h"
 #include "llvm/IR/BasicBlock.h"
@@ -185,6 +186,13 @@ static cl::opt<bool> ClInlineAllChecks("hwasan-inline-all-checks",
                                        cl::desc("inline all checks"),
                                        cl::Hidden, cl::init(false));
 
+static cl::opt<bool> ClMergeChecks(
+    "hwasan-merge-checks",
+    cl::desc("skip the checks of accesses covered by an earlier check in the "
+             "same basic block, and widen a check to cover later accesses "
+             "to the same granule"),
+    cl::Hidden, cl::init(true));
+
 namespace {
 
 /// An instrumentation pass implementing detection of addressability bugs
@@ -218,6 +226,8 @@ public:
                                  Instruction *InsertBefore);
   void instrumentMemIntrinsic(MemIntrinsic *MI);
   bool instrumentMemAccess(InterestingMemoryOperand &O);
+  void mergeChecks(SmallVectorImpl<InterestingMemoryOperand> &Operands,
+                   SmallPtrSetImpl<Use *> &Unchecked);
   bool ignoreAccess(Value *Ptr);
   void getInterestingMemoryOperands(
       Instruction *I, SmallVectorImpl<InterestingMemoryOperand> &Interesting);
@@ -863,6 +873,76 @@ bool HWAddressSanitizer::instrumentMemAccess(InterestingMemoryOperand &O) {
   return true;
 }
 
+// Returns true if an instruction in [From, To) may change memory tags.
+static bool mayRetagBetween(Instruction *From, Instruction *To) {
+  for (auto It = From->getIterator(); &*It != To; ++It)
+    if (isa<CallBase>(*It) && !isa<DbgInfoIntrinsic>(*It))
+      return true;
+  return false;
+}
+
+// Memory tags only change in calls (to the allocator, or to the runtime) and
+// in the stack instrumentation, so within a basic block and between two calls
+// the check of an access also proves that any access to the same bytes
+// through the same tagged base pointer is valid. The checks of those accesses
+// are recorded in Unchecked, and a check is widened to also cover a later
+// access in the same granule, if it was inline and stays so.
+void HWAddressSanitizer::mergeChecks(
+    SmallVectorImpl<InterestingMemoryOperand> &Operands,
+    SmallPtrSetImpl<Use *> &Unchecked) {
+  struct Check {
+    Value *Base;
+    int64_t Offset;
+    uint64_t Size;
+    size_t OperandNo;
+  };
+  // Bounds the quadratic search in very large basic blocks.
+  const size_t kMaxLiveChecks = 32;
+  const uint64_t kMaxInlineSize = 1ULL << (kNumberOfAccessSizes - 1);
+  SmallVector<Check, 8> Live;
+  const DataLayout &DL = M.getDataLayout();
+  Instruction *Prev = nullptr;
+  for (size_t i = 0; i < Operands.size(); i++) {
+    InterestingMemoryOperand &O = Operands[i];
+    Instruction *I = O.getInsn();
+    if (!Prev || Prev->getParent() != I->getParent() ||
+        (Prev != I && mayRetagBetween(Prev, I)))
+      Live.clear();
+    Prev = I;
+    if (O.MaybeMask)
+      continue;
+    int64_t Offset;
+    Value *Base = GetPointerBaseWithConstantOffset(O.getPtr(), Offset, DL);
+    uint64_t Size = O.TypeSize / 8;
+    bool Merged = false;
+    for (Check &C : Live) {
+      if (C.Base != Base || Offset < C.Offset)
+        continue;
+      uint64_t End = Offset - C.Offset + Size;
+      if (End <= C.Size) {
+        Merged = true;
+        break;
+      }
+      InterestingMemoryOperand &CO = Operands[C.OperandNo];
+      if (CO.IsWrite != O.IsWrite || !isPowerOf2_64(End) ||
+          End > kMaxInlineSize || !isPowerOf2_64(C.Size) ||
+          !CO.Alignment || CO.Alignment->value() < End)
+        continue;
+      CO.TypeSize = End * 8;
+      C.Size = End;
+      Merged = true;
+      break;
+    }
+    if (Merged) {
+      Unchecked.insert(O.PtrUse);
+      continue;
+    }
+    if (Live.size() == kMaxLiveChecks)
+      Live.erase(Live.begin());
+    Live.push_back({Base, Offset, Size, i});
+  }
+}
+
 static uint64_t getAllocaSizeInBytes(const AllocaInst &AI) {
   uint64_t ArraySize = 1;
   if (AI.isArrayAllocation()) {
@@ -1321,8 +1401,15 @@ bool HWAddressSanitizer::sanitizeFunction(Function &F) {
     }
   }
 
-  for (auto &Operand : OperandsToInstrument)
-    instrumentMemAccess(Operand);
+  SmallPtrSet<Use *, 16> Unchecked;
+  if (ClMergeChecks)
+    mergeChecks(OperandsToInstrument, Unchecked);
+  for (auto &Operand : OperandsToInstrument) {
+    if (Unchecked.count(Operand.PtrUse))
+      untagPointerOperand(Operand.getInsn(), Operand.getPtr());
+    else
+      instrumentMemAccess(Operand);
+  }
 
   if (ClInstrumentMemIntrinsics && !IntrinToInstrument.empty()) {
     for (auto Inst : IntrinToInstrument)
@@ -15,12 +15,18 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Transforms/Instrumentation/MemProfiler.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/Analysis/MemoryBuiltins.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/IR/Constant.h"
 #include "llvm/IR/DataLayout.h"
+#include "llvm/IR/DebugInfoMetadata.h"
+#include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/GlobalValue.h"
 #include "llvm/IR/IRBuilder.h"
@@ -31,6 +37,7 @@
 #include "llvm/IR/Value.h"
 #include "llvm/InitializePasses.h"
 #include "llvm/Pass.h"
+#include "llvm/ProfileData/MemProf.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Transforms/Instrumentation.h"
@@ -121,8 +128,51 @@ static cl::opt<int> ClDebugMin("memprof-debug-min", cl::desc("Debug min inst"),
 static cl::opt<int> ClDebugMax("memprof-debug-max", cl::desc("Debug max inst"),
                                cl::Hidden, cl::init(-1));
 
+// Memory profile use flags.
+
+cl::opt<std::string>
+    MemProfProfileFile("memprof-profile-file", cl::Hidden,
+                       cl::desc("Memory profile used to annotate allocation "
+                                "calls in the optimization pipelines"));
+
+static cl::opt<unsigned> ClColdMinLifetime(
+    "memprof-cold-min-lifetime", cl::Hidden, cl::init(10000),
+    cl::desc("Minimum average lifetime in ms of cold allocations"));
+
+static cl::opt<double> ClColdMaxAccessDensity(
+    "memprof-cold-max-access-density", cl::Hidden, cl::init(0.1),
+    cl::desc("Maximum number of accesses per allocated byte of cold "
+             "allocations"));
+
+static cl::opt<double> ClHotMinAccessDensity(
+    "memprof-hot-min-access-density", cl::Hidden, cl::init(10.0),
+    cl::desc("Minimum number of accesses per allocated byte of hot "
+             "allocations"));
+
+static cl::opt<unsigned> ClShortLivedMaxLifetime(
+    "memprof-short-lived-max-lifetime", cl::Hidden, cl::init(1),
+    cl::desc("Maximum lifetime in ms of short-lived allocations"));
+
+static cl::opt<bool> ClHotColdNew(
+    "memprof-hot-cold-new", cl::Hidden, cl::init(false),
+    cl::desc("Redirect cold and hot calls to operator new to the variants "
+             "taking a __hot_cold_t hint"));
+
+static cl::opt<unsigned> ClColdNewHint(
+    "memprof-cold-new-hint", cl::Hidden, cl::init(0),
+    cl::desc("The __hot_cold_t hint passed to cold operator new calls"));
+
+static cl::opt<unsigned> ClHotNewHint(
+    "memprof-hot-new-hint", cl::Hidden, cl::init(255),
+    cl::desc("The __hot_cold_t hint passed to hot operator new calls"));
+
 STATISTIC(NumInstrumentedReads, "Number of instrumented reads");
 STATISTIC(NumInstrumentedWrites, "Number of instrumented writes");
+STATISTIC(NumColdAllocations, "Number of allocation calls annotated as cold");
+STATISTIC(NumHotAllocations, "Number of allocation calls annotated as hot");
+STATISTIC(NumShortLivedAllocations,
+          "Number of allocation calls annotated as short-lived");
+STATISTIC(NumHotColdNew, "Number of operator new calls given a hot/cold hint");
 
 namespace {
 
@@ -636,3 +686,217 @@ bool MemProfiler::instrumentFunction(Function &F) {
 
   return FunctionModified;
 }
+
+namespace {
+
+enum class AllocationType { None, Cold, Hot, ShortLived };
+
+/// A frame of the inlined call stack of an allocation call.
+struct CallFrame {
+  StringRef Function;
+  unsigned Line;
+  unsigned Column;
+
+  bool operator==(const memprof::Frame &F) const {
+    return Function == F.Function && Line == F.Line && Column == F.Column;
+  }
+};
+
+} // end anonymous namespace
+
+static size_t hashFrame(StringRef Function, unsigned Line, unsigned Column) {
+  return hash_combine(Function, Line, Column);
+}
+
+static AllocationType classifyAllocation(const memprof::AllocationInfo &Info) {
+  double AccessDensity = Info.AveAccessCount / std::max(Info.AveSize, 1.0);
+  if (Info.AveLifetime >= ClColdMinLifetime &&
+      AccessDensity < ClColdMaxAccessDensity)
+    return AllocationType::Cold;
+  if (Info.MaxLifetime <= ClShortLivedMaxLifetime)
+    return AllocationType::ShortLived;
+  if (AccessDensity >= ClHotMinAccessDensity)
+    return AllocationType::Hot;
+  return AllocationType::None;
+}
+
+/// Returns the inlined call stack of \p CB, innermost frame first, in terms of
+/// the function names the runtime symbolizes.
+static SmallVector<CallFrame, 4> getCallStack(const CallBase &CB) {
+  SmallVector<CallFrame, 4> CallStack;
+  for (const DILocation *Loc = CB.getDebugLoc(); Loc;
+       Loc = Loc->getInlinedAt()) {
+    const DISubprogram *SP = Loc->getScope()->getSubprogram();
+    StringRef Name = SP->getLinkageName();
+    if (Name.empty())
+      Name = SP->getName();
+    CallStack.push_back({Name, Loc->getLine(), Loc->getColumn()});
+  }
+  return CallStack;
+}
+
+/// Redirects a call to operator new to the variant that takes a __hot_cold_t
+/// hint as its last argument. Returns false if \p CB does not call operator
+/// new.
+static bool redirectToHotColdNew(CallBase *CB, const TargetLibraryInfo &TLI,
+                                 uint8_t Hint) {
+  Function *Callee = CB->getCalledFunction();
+  LibFunc Func;
+  if (!Callee || isa<CallBrInst>(CB) || !TLI.getLibFunc(*Callee, Func))
+    return false;
+  switch (Func) {
+  case LibFunc_Znwj:
+  case LibFunc_ZnwjRKSt9nothrow_t:
+  case LibFunc_ZnwjSt11align_val_t:
+  case LibFunc_ZnwjSt11align_val_tRKSt9nothrow_t:
+  case LibFunc_Znwm:
+  case LibFunc_ZnwmRKSt9nothrow_t:
+  case LibFunc_ZnwmSt11align_val_t:
+  case LibFunc_ZnwmSt11align_val_tRKSt9nothrow_t:
+  case LibFunc_Znaj:
+  case LibFunc_ZnajRKSt9nothrow_t:
+  case LibFunc_ZnajSt11align_val_t:
+  case LibFunc_ZnajSt11align_val_tRKSt9nothrow_t:
+  case LibFunc_Znam:
+  case LibFunc_ZnamRKSt9nothrow_t:
+  case LibFunc_ZnamSt11align_val_t:
+  case LibFunc_ZnamSt11align_val_tRKSt9nothrow_t:
+    break;
+  default:
+    return false;
+  }
+
+  // The hint is appended to the mangled parameter list.
+  Type *Int8Ty = Type::getInt8Ty(CB->getContext());
+  FunctionType *FTy = Callee->getFunctionType();
+  SmallVector<Type *, 4> Params(FTy->param_begin(), FTy->param_end());
+  Params.push_back(Int8Ty);
+  FunctionCallee HotColdNew = CB->getModule()->getOrInsertFunction(
+      (Callee->getName() + "12__hot_cold_t").str(),
+      FunctionType::get(FTy->getReturnType(), Params, /*isVarArg=*/false));
+
+  SmallVector<Value *, 4> Args(CB->args());
+  Args.push_back(ConstantInt::get(Int8Ty, Hint));
+  SmallVector<OperandBundleDef, 1> Bundles;
+  CB->getOperandBundlesAsDefs(Bundles);
+  CallBase *NewCB;
+  if (auto *II = dyn_cast<InvokeInst>(CB)) {
+    NewCB = InvokeInst::Create(HotColdNew, II->getNormalDest(),
+                               II->getUnwindDest(), Args, Bundles, "", CB);
+  } else {
+    auto *CI = CallInst::Create(HotColdNew, Args, Bundles, "", CB);
+    CI->setTailCallKind(cast<CallInst>(CB)->getTailCallKind());
+    NewCB = CI;
+  }
+  NewCB->setCallingConv(CB->getCallingConv());
+  NewCB->setAttributes(CB->getAttributes());
+  NewCB->copyMetadata(*CB);
+  NewCB->takeName(CB);
+  CB->replaceAllUsesWith(NewCB);
+  CB->eraseFromParent();
+  return true;
+}
+
+MemProfUsePass::MemProfUsePass(std::string MemoryProfileFile)
+    : MemoryProfileFile(MemoryProfileFile.empty()
+                            ? std::string(MemProfProfileFile)
+                            : std::move(MemoryProfileFile)) {}
+
+PreservedAnalyses MemProfUsePass::run(Module &M, ModuleAnalysisManager &AM) {
+  LLVMContext &Ctx = M.getContext();
+  auto ReaderOrErr = memprof::MemProfReader::create(MemoryProfileFile);
+  if (Error E = ReaderOrErr.takeError()) {
+    handleAllErrors(std::move(E), [&](const ErrorInfoBase &EI) {
+      Ctx.diagnose(
+          DiagnosticInfoPGOProfile(MemoryProfileFile.data(), EI.message()));
+    });
+    return PreservedAnalyses::all();
+  }
+
+  // Index the allocation contexts by each of their frames, so that a call can
+  // be matched to the contexts in which it is inlined.
+  ArrayRef<memprof::AllocationInfo> Allocations =
+      (*ReaderOrErr)->getAllocations();
+  DenseMap<size_t, SmallVector<std::pair<unsigned, unsigned>, 1>> FrameIndex;
+  for (unsigned I = 0, E = Allocations.size(); I != E; ++I) {
+    ArrayRef<memprof::Frame> Stack = Allocations[I].CallStack;
+    for (unsigned J = 0, FE = Stack.size(); J != FE; ++J)
+      FrameIndex[hashFrame(Stack[J].Function, Stack[J].Line, Stack[J].Column)]
+          .push_back({I, J});
+  }
+
+  auto &FAM = AM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+  bool Changed = false;
+  for (Function &F : M) {
+    if (F.isDeclaration() || !F.getSubprogram())
+      continue;
+    const TargetLibraryInfo &TLI = FAM.getResult<TargetLibraryAnalysis>(F);
+    SmallVector<CallBase *, 8> AllocationCalls;
+    for (BasicBlock &BB : F)
+      for (Instruction &I : BB)
+        if (auto *CB = dyn_cast<CallBase>(&I))
+          if (CB->getDebugLoc() && isAllocationFn(CB, &TLI))
+            AllocationCalls.push_back(CB);
+
+    for (CallBase *CB : AllocationCalls) {
+      SmallVector<CallFrame, 4> CallStack = getCallStack(*CB);
+      const CallFrame &Leaf = CallStack.front();
+      auto It =
+          FrameIndex.find(hashFrame(Leaf.Function, Leaf.Line, Leaf.Column));
+      if (It == FrameIndex.end())
+        continue;
+
+      // Contexts that reach the call through different callers may disagree;
+      // the call is only annotated if they all behave the same.
+      Optional<AllocationType> AllocType;
+      for (auto &Match : It->second) {
+        ArrayRef<memprof::Frame> Stack = Allocations[Match.first].CallStack;
+        ArrayRef<memprof::Frame> Frames = Stack.drop_front(Match.second);
+        if (Frames.size() < CallStack.size() ||
+            !std::equal(CallStack.begin(), CallStack.end(), Frames.begin()))
+          continue;
+        AllocationType MatchType =
+            classifyAllocation(Allocations[Match.first]);
+        if (AllocType && *AllocType != MatchType) {
+          AllocType = AllocationType::None;
+          break;
+        }
+        AllocType = MatchType;
+      }
+      if (!AllocType || *AllocType == AllocationType::None)
+        continue;
+
+      StringRef Kind;
+      switch (*AllocType) {
+      case AllocationType::Cold:
+        Kind = "cold";
+        ++NumColdAllocations;
+        break;
+      case AllocationType::Hot:
+        Kind = "hot";
+        ++NumHotAllocations;
+        break;
+      case AllocationType::ShortLived:
+        Kind = "short-lived";
+        ++NumShortLivedAllocations;
+        break;
+      case AllocationType::None:
+        llvm_unreachable("Unannotated allocation");
+      }
+      LLVM_DEBUG(dbgs() << "MEMPROF: " << Kind << " allocation " << *CB
+                        << "\n");
+      CB->addAttribute(AttributeList::FunctionIndex,
+                       Attribute::get(Ctx, "memprof", Kind));
+      Changed = true;
+
+      if (ClHotColdNew && *AllocType != AllocationType::ShortLived &&
+          redirectToHotColdNew(CB, TLI,
+                               *AllocType == AllocationType::Cold
+                                   ? ClColdNewHint
+                                   : ClHotNewHint))
+        ++NumHotColdNew;
+    }
+  }
+
+  return Changed ? PreservedAnalyses::none() : PreservedAnalyses::all();
+}
@@ -78,6 +78,7 @@ const char SanCovBoolFlagSectionName[] = "sancov_bools";
 const char SanCovPCsSectionName[] = "sancov_pcs";
 
 const char SanCovLowestStackName[] = "__sancov_lowest_stack";
+const char SanCovSampleCountdownName[] = "__sancov_sample_countdown";
 
 static cl::opt<int> ClCoverageLevel(
     "sanitizer-coverage-level",
@@ -135,6 +136,16 @@ static cl::opt<bool> ClStackDepth("sanitizer-coverage-stack-depth",
                                   cl::desc("max stack depth tracing"),
                                   cl::Hidden, cl::init(false));
 
+// Each thread counts down its function entries, and the edges of a function
+// are only recorded when the count hits zero. This makes the coverage of
+// long-running processes cheap enough to collect in production, at the cost
+// of missing rarely executed code.
+static cl::opt<unsigned> ClSamplePeriod(
+    "sanitizer-coverage-sample-period",
+    cl::desc("only record edge coverage for one in this many function entries "
+             "on each thread"),
+    cl::Hidden, cl::init(0));
+
 namespace {
 
 SanitizerCoverageOptions getOptions(int LegacyCoverageLevel) {
@@ -175,6 +186,8 @@ SanitizerCoverageOptions OverrideFromCL(SanitizerCoverageOptions Options) {
   Options.PCTable |= ClCreatePCTable;
   Options.NoPrune |= !ClPruneBlocks;
   Options.StackDepth |= ClStackDepth;
+  if (ClSamplePeriod)
+    Options.SamplePeriod = ClSamplePeriod;
   if (!Options.TracePCGuard && !Options.TracePC &&
       !Options.Inline8bitCounters && !Options.StackDepth &&
       !Options.InlineBoolFlag)
@@ -218,6 +231,7 @@ private:
   void CreateFunctionLocalArrays(Function &F, ArrayRef<BasicBlock *> AllBlocks);
   void InjectCoverageAtBlock(Function &F, BasicBlock &BB, size_t Idx,
                              bool IsLeafFunc = true);
+  Value *CreateSampleCountdown(IRBuilder<> &IRB);
   Function *CreateInitCallsForSections(Module &M, const char *CtorName,
                                        const char *InitFunctionName, Type *Ty,
                                        const char *Section);
@@ -240,6 +254,7 @@ private:
   FunctionCallee SanCovTraceGepFunction;
   FunctionCallee SanCovTraceSwitchFunction;
   GlobalVariable *SanCovLowestStack;
+  GlobalVariable *SanCovSampleCountdown;
   Type *IntptrTy, *IntptrPtrTy, *Int64Ty, *Int64PtrTy, *Int32Ty, *Int32PtrTy,
       *Int16Ty, *Int8Ty, *Int8PtrTy, *Int1Ty, *Int1PtrTy;
   Module *CurModule;
@@ -252,6 +267,7 @@ private:
   GlobalVariable *Function8bitCounterArray;  // for inline-8bit-counters.
   GlobalVariable *FunctionBoolArray;         // for inline-bool-flag.
   GlobalVariable *FunctionPCsArray;  // for pc-table.
+  Value *FunctionSampled;  // for sample-period.
   SmallVector<GlobalValue *, 20> GlobalsToAppendToUsed;
   SmallVector<GlobalValue *, 20> GlobalsToAppendToCompilerUsed;
 
@@ -470,6 +486,21 @@ bool ModuleSanitizerCoverage::instrumentModule(
   if (Options.StackDepth && !SanCovLowestStack->isDeclaration())
     SanCovLowestStack->setInitializer(Constant::getAllOnesValue(IntptrTy));
 
+  SanCovSampleCountdown = nullptr;
+  if (Options.SamplePeriod > 1 &&
+      (Options.TracePC || Options.TracePCGuard || Options.Inline8bitCounters ||
+       Options.InlineBoolFlag)) {
+    SanCovSampleCountdown = dyn_cast<GlobalVariable>(
+        M.getOrInsertGlobal(SanCovSampleCountdownName, Int32Ty));
+    if (!SanCovSampleCountdown) {
+      C->emitError(StringRef("'") + SanCovSampleCountdownName +
+                   "' should not be declared by the user");
+      return true;
+    }
+    SanCovSampleCountdown->setThreadLocalMode(
+        GlobalValue::ThreadLocalMode::InitialExecTLSModel);
+  }
+
   SanCovTracePC = M.getOrInsertFunction(SanCovTracePCName, VoidTy);
   SanCovTracePCGuard =
       M.getOrInsertFunction(SanCovTracePCGuardName, VoidTy, Int32PtrTy);
@@ -740,6 +771,7 @@ bool ModuleSanitizerCoverage::InjectCoverage(Function &F,
                                              bool IsLeafFunc) {
   if (AllBlocks.empty()) return false;
   CreateFunctionLocalArrays(F, AllBlocks);
+  FunctionSampled = nullptr;
   for (size_t i = 0, N = AllBlocks.size(); i < N; i++)
     InjectCoverageAtBlock(F, *AllBlocks[i], i, IsLeafFunc);
   return true;
@@ -894,6 +926,17 @@ void ModuleSanitizerCoverage::InjectCoverageAtBlock(Function &F, BasicBlock &BB,
 
   IRBuilder<> IRB(&*IP);
   IRB.SetCurrentDebugLocation(EntryLoc);
+  // With sampling, the edge coverage below is only recorded if the function
+  // entry was sampled.
+  Instruction *CoverageIP = &*IP;
+  if (SanCovSampleCountdown) {
+    if (IsEntryBB)
+      FunctionSampled = CreateSampleCountdown(IRB);
+    assert(FunctionSampled && "the entry block is instrumented first");
+    CoverageIP = SplitBlockAndInsertIfThen(FunctionSampled, &*IP, false);
+    IRB.SetInsertPoint(CoverageIP);
+    IRB.SetCurrentDebugLocation(EntryLoc);
+  }
   if (Options.TracePC) {
     IRB.CreateCall(SanCovTracePC)
         ->setCannotMerge(); // gets the PC using GET_CALLER_PC.
@@ -921,13 +964,15 @@ void ModuleSanitizerCoverage::InjectCoverageAtBlock(Function &F, BasicBlock &BB,
         {ConstantInt::get(IntptrTy, 0), ConstantInt::get(IntptrTy, Idx)});
     auto Load = IRB.CreateLoad(Int1Ty, FlagPtr);
     auto ThenTerm =
-        SplitBlockAndInsertIfThen(IRB.CreateIsNull(Load), &*IP, false);
+        SplitBlockAndInsertIfThen(IRB.CreateIsNull(Load), CoverageIP, false);
     IRBuilder<> ThenIRB(ThenTerm);
     auto Store = ThenIRB.CreateStore(ConstantInt::getTrue(Int1Ty), FlagPtr);
     SetNoSanitizeMetadata(Load);
     SetNoSanitizeMetadata(Store);
   }
   if (Options.StackDepth && IsEntryBB && !IsLeafFunc) {
+    IRB.SetInsertPoint(&*IP);
+    IRB.SetCurrentDebugLocation(EntryLoc);
     // Check stack depth.  If it's the deepest so far, record it.
     Module *M = F.getParent();
     Function *GetFrameAddr = Intrinsic::getDeclaration(
@@ -946,6 +991,23 @@ void ModuleSanitizerCoverage::InjectCoverageAtBlock(Function &F, BasicBlock &BB,
   }
 }
 
+// Counts down the function entries of the thread, and returns whether this one
+// is sampled:
+//   Sampled = Countdown == 0;
+//   Countdown = Sampled ? SamplePeriod - 1 : Countdown - 1;
+// A new thread starts at zero, so its first function entry is sampled.
+Value *ModuleSanitizerCoverage::CreateSampleCountdown(IRBuilder<> &IRB) {
+  auto Countdown = IRB.CreateLoad(Int32Ty, SanCovSampleCountdown);
+  auto Sampled = IRB.CreateIsNull(Countdown);
+  auto Next = IRB.CreateSelect(
+      Sampled, ConstantInt::get(Int32Ty, Options.SamplePeriod - 1),
+      IRB.CreateSub(Countdown, ConstantInt::get(Int32Ty, 1)));
+  auto Store = IRB.CreateStore(Next, SanCovSampleCountdown);
+  SetNoSanitizeMetadata(Countdown);
+  SetNoSanitizeMetadata(Store);
+  return Sampled;
+}
+
 std::string
 ModuleSanitizerCoverage::getSectionName(const std::string &Section) const {
   if (TargetTriple.isOSBinFormatCOFF()) {
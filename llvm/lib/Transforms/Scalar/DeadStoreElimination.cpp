@@ -118,6 +118,12 @@ static cl::opt<unsigned> MemorySSAUpwardsStepLimit(
     cl::desc("The maximum number of steps while walking upwards to find "
              "MemoryDefs that may be killed (default = 90)"));
 
+static cl::opt<unsigned> MemorySSAMaxUpwardsStepLimit(
+    "dse-memoryssa-max-walklimit", cl::init(360), cl::Hidden,
+    cl::desc("The maximum number of steps while walking upwards from a single "
+             "MemoryDef, when earlier MemoryDefs left steps of their walk "
+             "limit unused (default = 360)"));
+
 static cl::opt<unsigned> MemorySSAPartialStoreLimit(
     "dse-memoryssa-partial-store-limit", cl::init(5), cl::Hidden,
     cl::desc("The maximum number candidates that only partially overwrite the "
@@ -1636,6 +1642,12 @@ struct DSEState {
   /// basic block.
   DenseMap<BasicBlock *, InstOverlapIntervalsTy> IOLs;
 
+  /// Walker steps left unused by the killing MemoryDefs processed so far.
+  /// Later MemoryDefs may use them to walk further, so the limit adapts to
+  /// the function while the total number of steps stays bounded by
+  /// MemorySSAUpwardsStepLimit per MemoryDef.
+  unsigned UnusedWalkerSteps = 0;
+
   struct CheckCache {
     SmallPtrSet<MemoryAccess *, 16> KnownNoReads;
     SmallPtrSet<MemoryAccess *, 16> KnownReads;
@@ -2541,6 +2553,13 @@ bool eliminateDeadStoresMemorySSA(Function &F, AliasAnalysis &AA,
 
     unsigned ScanLimit = MemorySSAScanLimit;
     unsigned WalkerStepLimit = MemorySSAUpwardsStepLimit;
+    if (MemorySSAMaxUpwardsStepLimit > WalkerStepLimit) {
+      unsigned ExtraSteps =
+          std::min(State.UnusedWalkerSteps,
+                   MemorySSAMaxUpwardsStepLimit - WalkerStepLimit);
+      WalkerStepLimit += ExtraSteps;
+      State.UnusedWalkerSteps -= ExtraSteps;
+    }
     unsigned PartialLimit = MemorySSAPartialStoreLimit;
     // Worklist of MemoryAccesses that may be killed by KillingDef.
     SetVector<MemoryAccess *> ToCheck;
@@ -2657,6 +2676,8 @@ bool eliminateDeadStoresMemorySSA(Function &F, AliasAnalysis &AA,
       }
     }
 
+    State.UnusedWalkerSteps += WalkerStepLimit;
+
     // Check if the store is a no-op.
     if (!Shortend && isRemovable(SI) &&
         State.storeIsNoop(KillingDef, SILoc, SILocUnd)) {
@@ -15,8 +15,10 @@
 //
 
 #include "llvm/Transforms/Vectorize/LoopVectorizationLegality.h"
+#include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/Analysis/Loads.h"
 #include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/Analysis/VectorUtils.h"
@@ -415,7 +417,40 @@ static bool hasOutsideLoopUser(const Loop *TheLoop, Instruction *Inst,
   return false;
 }
 
+/// Return 1 or -1 if the address \p Ptr, in the outer loop \p OuterLp,
+/// advances by one element per iteration of \p OuterLp, and by the same amount
+/// at every iteration of the inner loops, and 0 otherwise.
+static int getOuterLoopPtrStride(Value *Ptr, Loop *OuterLp,
+                                 ScalarEvolution &SE) {
+  const SCEV *S = SE.getSCEV(Ptr);
+  // The recurrences of the inner loops must be the same in every lane.
+  while (auto *AR = dyn_cast<SCEVAddRecExpr>(S)) {
+    if (AR->getLoop() == OuterLp)
+      break;
+    if (!OuterLp->contains(AR->getLoop()) || !AR->isAffine() ||
+        !SE.isLoopInvariant(AR->getStepRecurrence(SE), OuterLp))
+      return 0;
+    S = AR->getStart();
+  }
+  auto *AR = dyn_cast<SCEVAddRecExpr>(S);
+  if (!AR || AR->getLoop() != OuterLp || !AR->isAffine())
+    return 0;
+  auto *Step = dyn_cast<SCEVConstant>(AR->getStepRecurrence(SE));
+  if (!Step)
+    return 0;
+  const DataLayout &DL = OuterLp->getHeader()->getModule()->getDataLayout();
+  int64_t Size = DL.getTypeAllocSize(
+      cast<PointerType>(Ptr->getType())->getElementType());
+  int64_t Stride = Step->getAPInt().getSExtValue();
+  if (Stride == Size || Stride == -Size)
+    return Stride > 0 ? 1 : -1;
+  return 0;
+}
+
 int LoopVectorizationLegality::isConsecutivePtr(Value *Ptr) {
+  if (!TheLoop->isInnermost())
+    return getOuterLoopPtrStride(Ptr, TheLoop, *PSE.getSE());
+
   const ValueToValueMap &Strides =
       getSymbolicStrides() ? *getSymbolicStrides() : ValueToValueMap();
 
@@ -499,9 +534,76 @@ bool LoopVectorizationLegality::canVectorizeOuterLoop() {
       return false;
   }
 
+  // An explicit vectorization hint is taken as the promise that the outer loop
+  // iterations are independent. Without one, we have to prove it.
+  if (Hints->getForce() == LoopVectorizeHints::FK_Undefined &&
+      !canVectorizeOuterLoopMemory()) {
+    reportVectorizationFailure("Outer loop iterations may be dependent",
+        "cannot prove that the iterations of the outer loop are independent",
+        "OuterLoopMemoryDependence", ORE, TheLoop);
+    if (DoExtraAnalysis)
+      Result = false;
+    else
+      return false;
+  }
+
   return Result;
 }
 
+bool LoopVectorizationLegality::canVectorizeOuterLoopMemory() const {
+  if (TheLoop->isAnnotatedParallel())
+    return true;
+
+  ScalarEvolution &SE = *PSE.getSE();
+  const DataLayout &DL = TheLoop->getHeader()->getModule()->getDataLayout();
+  SmallVector<Instruction *, 16> Accesses;
+  SmallVector<StoreInst *, 8> Stores;
+  for (BasicBlock *BB : TheLoop->blocks())
+    for (Instruction &I : *BB) {
+      if (!I.mayReadOrWriteMemory())
+        continue;
+      auto *LI = dyn_cast<LoadInst>(&I);
+      auto *SI = dyn_cast<StoreInst>(&I);
+      if (!(LI && LI->isSimple()) && !(SI && SI->isSimple())) {
+        LLVM_DEBUG(dbgs() << "LV: Unsupported outer loop memory access: " << I
+                          << "\n");
+        return false;
+      }
+      Accesses.push_back(&I);
+      if (SI)
+        Stores.push_back(SI);
+    }
+
+  for (StoreInst *SI : Stores) {
+    Value *Ptr = SI->getPointerOperand();
+    Type *Ty = SI->getValueOperand()->getType();
+    const SCEV *S = SE.getSCEV(Ptr);
+    auto *AR = dyn_cast<SCEVAddRecExpr>(S);
+    auto *Step = AR ? dyn_cast<SCEVConstant>(AR->getStepRecurrence(SE))
+                    : nullptr;
+    if (!Step || AR->getLoop() != TheLoop || !AR->isAffine() ||
+        Step->getAPInt().abs().ult(DL.getTypeStoreSize(Ty))) {
+      LLVM_DEBUG(dbgs() << "LV: Outer loop store to a non-disjoint address: "
+                        << *SI << "\n");
+      return false;
+    }
+    for (Instruction *I : Accesses) {
+      Value *OtherPtr = getLoadStorePointerOperand(I);
+      Type *OtherTy = isa<LoadInst>(I)
+                          ? I->getType()
+                          : cast<StoreInst>(I)->getValueOperand()->getType();
+      if ((SE.getSCEV(OtherPtr) == S && OtherTy == Ty) ||
+          AA->isNoAlias(MemoryLocation::getBeforeOrAfter(Ptr),
+                        MemoryLocation::getBeforeOrAfter(OtherPtr)))
+        continue;
+      LLVM_DEBUG(dbgs() << "LV: Outer loop store " << *SI
+                        << " may depend on " << *I << "\n");
+      return false;
+    }
+  }
+  return true;
+}
+
 void LoopVectorizationLegality::addInductionPhi(
     PHINode *Phi, const InductionDescriptor &ID,
     SmallPtrSetImpl<Value *> &AllowedExit) {
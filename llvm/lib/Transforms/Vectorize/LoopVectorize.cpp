@@ -283,6 +283,12 @@ static cl::opt<bool> LoopVectorizeWithBlockFrequency(
              "heuristics minimizing code growth in cold regions and being more "
              "aggressive in hot regions."));
 
+static cl::opt<bool> VectorizeWithTripCount(
+    "vectorize-with-trip-count", cl::init(false), cl::Hidden,
+    cl::desc("Take the known, profiled or estimated trip count of a loop into "
+             "account when selecting its vectorization factor, counting the "
+             "iterations left to the scalar epilogue."));
+
 // Runtime interleave loops for load/store throughput.
 static cl::opt<bool> EnableLoadStoreRuntimeInterleave(
     "enable-loadstore-runtime-interleave", cl::init(true), cl::Hidden,
@@ -336,6 +342,17 @@ cl::opt<bool> EnableVPlanPredication(
     cl::desc("Enable VPlan-native vectorization path predicator with "
              "support for outer loop vectorization."));
 
+static cl::opt<bool> VPlanNativeOuterLoopsWithoutHints(
+    "vplan-native-outer-loops-without-hints", cl::init(false), cl::Hidden,
+    cl::desc("In the VPlan-native path, also consider the outer loops without "
+             "a vectorization hint, and vectorize them when the cost model "
+             "finds it profitable."));
+
+static cl::opt<unsigned> VPlanNativeMaxInnerTripCount(
+    "vplan-native-max-inner-trip-count", cl::init(16), cl::Hidden,
+    cl::desc("The largest constant trip count of the inner loops of the outer "
+             "loops considered without a vectorization hint."));
+
 // This flag enables the stress testing of the VPlan H-CFG construction in the
 // VPlan-native vectorization path. It must be used in conjuction with
 // -enable-vplan-native-path. -vplan-verify-hcfg can also be used to enable the
@@ -1242,6 +1259,24 @@ public:
   /// then this vectorization factor will be selected if vectorization is
   /// possible.
   VectorizationFactor selectVectorizationFactor(ElementCount MaxVF);
+
+  /// \return The most profitable vectorization factor of the outer loop
+  /// TheLoop in the VPlan-native path, and the cost of that VF. This method
+  /// checks every power of two up to MaxVF with getOuterLoopCost.
+  VectorizationFactor selectOuterLoopVectorizationFactor(ElementCount MaxVF);
+
+  /// \return The expected cost of VF iterations of the outer loop TheLoop,
+  /// vectorized in the VPlan-native path with the vectorization factor \p VF,
+  /// and set the widening decisions of its memory accesses for \p VF. The
+  /// instructions of the inner loops count once per iteration of the inner
+  /// loops, whose control flow is uniform, so that it does not scale with VF.
+  unsigned getOuterLoopCost(ElementCount VF);
+
+  /// Returns true if TheLoop is an outer loop, vectorized in the VPlan-native
+  /// path, for which the cost model is not run.
+  bool isVPlanNativeOuterLoop() const {
+    return EnableVPlanNativePath && !TheLoop->isInnermost();
+  }
   VectorizationFactor
   selectEpilogueVectorizationFactor(const ElementCount MaxVF,
                                     const LoopVectorizationPlanner &LVP);
@@ -1310,7 +1345,7 @@ public:
 
     // Cost model is not run in the VPlan-native path - return conservative
     // result until this changes.
-    if (EnableVPlanNativePath)
+    if (isVPlanNativeOuterLoop())
       return false;
 
     auto Scalars = InstsToScalarize.find(VF);
@@ -1326,7 +1361,7 @@ public:
 
     // Cost model is not run in the VPlan-native path - return conservative
     // result until this changes.
-    if (EnableVPlanNativePath)
+    if (isVPlanNativeOuterLoop())
       return false;
 
     auto UniformsPerVF = Uniforms.find(VF);
@@ -1342,7 +1377,7 @@ public:
 
     // Cost model is not run in the VPlan-native path - return conservative
     // result until this changes.
-    if (EnableVPlanNativePath)
+    if (isVPlanNativeOuterLoop())
       return false;
 
     auto ScalarsPerVF = Scalars.find(VF);
@@ -1399,16 +1434,15 @@ public:
   /// through the cost modeling.
   InstWidening getWideningDecision(Instruction *I, ElementCount VF) {
     assert(VF.isVector() && "Expected VF to be a vector VF");
-    // Cost model is not run in the VPlan-native path - return conservative
-    // result until this changes.
-    if (EnableVPlanNativePath)
-      return CM_GatherScatter;
-
     std::pair<Instruction *, ElementCount> InstOnVF = std::make_pair(I, VF);
     auto Itr = WideningDecisions.find(InstOnVF);
-    if (Itr == WideningDecisions.end())
-      return CM_Unknown;
-    return Itr->second.first;
+    if (Itr != WideningDecisions.end())
+      return Itr->second.first;
+    // In the VPlan-native path, only getOuterLoopCost decides how to widen
+    // memory accesses. Return the conservative result for the others.
+    if (isVPlanNativeOuterLoop())
+      return CM_GatherScatter;
+    return CM_Unknown;
   }
 
   /// Return the vectorization cost for the given instruction \p I and vector
@@ -1877,15 +1911,44 @@ static bool isExplicitVecOuterLoop(Loop *OuterLp,
   return true;
 }
 
-static void collectSupportedLoops(Loop &L, LoopInfo *LI,
+// Return true if the outer loop \p OuterLp has no vectorization hint, but is a
+// candidate for vectorization in the VPlan-native path, which vectorizes it
+// only if the cost model finds it profitable. Those are the loops whose inner
+// loops all have short constant trip counts, so that vectorizing the inner
+// loops does not pay off.
+static bool isCandidateOuterLoop(Loop *OuterLp, ScalarEvolution &SE,
+                                 OptimizationRemarkEmitter *ORE) {
+  assert(!OuterLp->isInnermost() && "This is not an outer loop");
+  if (!VPlanNativeOuterLoopsWithoutHints)
+    return false;
+
+  LoopVectorizeHints Hints(OuterLp, true /*DisableInterleaving*/, *ORE);
+  Function *Fn = OuterLp->getHeader()->getParent();
+  if (Hints.getForce() != LoopVectorizeHints::FK_Undefined ||
+      !Hints.allowVectorization(Fn, OuterLp,
+                                false /*VectorizeOnlyWhenForced*/))
+    return false;
+
+  for (Loop *InnerLp : OuterLp->getLoopsInPreorder()) {
+    if (InnerLp == OuterLp)
+      continue;
+    unsigned TC = SE.getSmallConstantTripCount(InnerLp);
+    if (TC == 0 || TC > VPlanNativeMaxInnerTripCount)
+      return false;
+  }
+  return true;
+}
+
+static void collectSupportedLoops(Loop &L, LoopInfo *LI, ScalarEvolution &SE,
                                   OptimizationRemarkEmitter *ORE,
                                   SmallVectorImpl<Loop *> &V) {
   // Collect inner loops and outer loops without irreducible control flow. For
-  // now, only collect outer loops that have explicit vectorization hints. If we
-  // are stress testing the VPlan H-CFG construction, we collect the outermost
-  // loop of every loop nest.
+  // now, only collect outer loops that have explicit vectorization hints, or
+  // whose inner loops are short. If we are stress testing the VPlan H-CFG
+  // construction, we collect the outermost loop of every loop nest.
   if (L.isInnermost() || VPlanBuildStressTest ||
-      (EnableVPlanNativePath && isExplicitVecOuterLoop(&L, ORE))) {
+      (EnableVPlanNativePath && (isExplicitVecOuterLoop(&L, ORE) ||
+                                 isCandidateOuterLoop(&L, SE, ORE)))) {
     LoopBlocksRPO RPOT(&L);
     RPOT.perform(LI);
     if (!containsIrreducibleCFG<const BasicBlock *>(RPOT, *LI)) {
@@ -1899,7 +1962,7 @@ static void collectSupportedLoops(Loop &L, LoopInfo *LI,
     }
   }
   for (Loop *InnerL : L)
-    collectSupportedLoops(*InnerL, LI, ORE, V);
+    collectSupportedLoops(*InnerL, LI, SE, ORE, V);
 }
 
 namespace {
@@ -2346,7 +2409,7 @@ Value *InnerLoopVectorizer::getOrCreateVectorValue(Value *V, unsigned Part) {
 
   // If we have a stride that is replaced by one, do it here. Defer this for
   // the VPlan-native path until we start running Legal checks in that path.
-  if (!EnableVPlanNativePath && Legal->hasStride(V))
+  if (OrigLoop->isInnermost() && Legal->hasStride(V))
     V = ConstantInt::get(V->getType(), 1);
 
   // If we have a vector mapped to this value, return it.
@@ -3129,7 +3192,7 @@ void InnerLoopVectorizer::emitSCEVChecks(Loop *L, BasicBlock *Bypass) {
 
 void InnerLoopVectorizer::emitMemRuntimeChecks(Loop *L, BasicBlock *Bypass) {
   // VPlan-native path does not do any analysis for runtime checks currently.
-  if (EnableVPlanNativePath)
+  if (!OrigLoop->isInnermost())
     return;
 
   // Reuse existing vector loop preheader for runtime memory checks.
@@ -3882,7 +3945,7 @@ void InnerLoopVectorizer::fixVectorizedLoop() {
 
   // Fix widened non-induction PHIs by setting up the PHI operands.
   if (OrigPHIsToFix.size()) {
-    assert(EnableVPlanNativePath &&
+    assert(!OrigLoop->isInnermost() &&
            "Unexpected non-induction PHIs for fixup in non VPlan-native path");
     fixNonInductionPHIs();
   }
@@ -4580,7 +4643,7 @@ void InnerLoopVectorizer::widenPHIInstruction(Instruction *PN, unsigned UF,
                                               ElementCount VF) {
   assert(!VF.isScalable() && "scalable vectors not yet supported.");
   PHINode *P = cast<PHINode>(PN);
-  if (EnableVPlanNativePath) {
+  if (!OrigLoop->isInnermost()) {
     // Currently we enter here in the VPlan-native path for non-induction
     // PHIs where all control flow is uniform. We simply widen these PHIs.
     // Create a vector phi with no operands - the vector phi operands will be
@@ -5674,12 +5737,35 @@ LoopVectorizationCostModel::selectVectorizationFactor(ElementCount MaxVF) {
     Cost = std::numeric_limits<float>::max();
   }
 
+  Optional<unsigned> ExpectedTC;
+  if (VectorizeWithTripCount)
+    ExpectedTC = getSmallBestKnownTC(*PSE.getSE(), TheLoop);
+
   for (unsigned i = 2; i <= MaxVF.getFixedValue(); i *= 2) {
     // Notice that the vector loop needs to be executed less times, so
     // we need to divide the cost of the vector loops by the width of
     // the vector elements.
     VectorizationCostTy C = expectedCost(ElementCount::getFixed(i));
     float VectorCost = C.first / (float)i;
+    // With a trip count, the iterations which don't fill a vector are
+    // counted at the scalar cost, so a width that leaves most of them to the
+    // scalar epilogue is not worth it.
+    if (ExpectedTC && *ExpectedTC) {
+      unsigned TC = *ExpectedTC;
+      float TotalCost;
+      if (foldTailByMasking()) {
+        TotalCost = divideCeil(TC, i) * C.first;
+      } else {
+        unsigned Remainder = TC % i;
+        if (!Remainder && requiresScalarEpilogue())
+          Remainder = std::min(i, TC);
+        TotalCost = (TC - Remainder) / i * C.first + Remainder * ScalarCost;
+      }
+      VectorCost = TotalCost / TC;
+      LLVM_DEBUG(dbgs() << "LV: Vector loop of width " << i << " costs "
+                        << (int)VectorCost << " over a trip count of " << TC
+                        << ".\n");
+    }
     LLVM_DEBUG(dbgs() << "LV: Vector loop of width " << i
                       << " costs: " << (int)VectorCost << ".\n");
     if (!C.second && !ForceVectorization) {
@@ -5718,6 +5804,126 @@ LoopVectorizationCostModel::selectVectorizationFactor(ElementCount MaxVF) {
   return Factor;
 }
 
+VectorizationFactor
+LoopVectorizationCostModel::selectOuterLoopVectorizationFactor(
+    ElementCount MaxVF) {
+  assert(isVPlanNativeOuterLoop() && "Expected an outer loop");
+  assert(!MaxVF.isScalable() && "scalable vectors not yet supported");
+
+  float Cost = getOuterLoopCost(ElementCount::getFixed(1));
+  const float ScalarCost = Cost;
+  unsigned Width = 1;
+  LLVM_DEBUG(dbgs() << "LV: Scalar outer loop costs: " << (int)ScalarCost
+                    << ".\n");
+
+  bool ForceVectorization = Hints->getForce() == LoopVectorizeHints::FK_Enabled;
+  if (ForceVectorization && MaxVF.isVector())
+    Cost = std::numeric_limits<float>::max();
+
+  for (unsigned i = 2; i <= MaxVF.getFixedValue(); i *= 2) {
+    float VectorCost = getOuterLoopCost(ElementCount::getFixed(i)) / (float)i;
+    LLVM_DEBUG(dbgs() << "LV: Vector outer loop of width " << i
+                      << " costs: " << (int)VectorCost << ".\n");
+    if (VectorCost < Cost) {
+      Cost = VectorCost;
+      Width = i;
+    }
+  }
+
+  LLVM_DEBUG(if (ForceVectorization && Width > 1 && Cost >= ScalarCost) dbgs()
+             << "LV: Vectorization seems to be not beneficial, "
+             << "but was forced by a user.\n");
+  LLVM_DEBUG(dbgs() << "LV: Selecting outer loop VF: " << Width << ".\n");
+  return {ElementCount::getFixed(Width), (unsigned)(Width * Cost)};
+}
+
+unsigned LoopVectorizationCostModel::getOuterLoopCost(ElementCount VF) {
+  assert(isVPlanNativeOuterLoop() && "Expected an outer loop");
+  const TTI::TargetCostKind CostKind = TTI::TCK_RecipThroughput;
+  const unsigned Width = VF.getFixedValue();
+
+  // The cost of an instruction of the scalar loop, with unknown costs taken
+  // as expensive.
+  auto GetScalarCost = [&](Instruction &I) -> unsigned {
+    InstructionCost C = TTI.getInstructionCost(&I, CostKind);
+    return C.isValid() ? *C.getValue() : 16;
+  };
+  // The cost of widening an instruction other than a memory access, which is
+  // scalarized if we don't know better.
+  auto GetWidenedCost = [&](Instruction &I) -> unsigned {
+    Type *VectorTy = ToVectorTy(I.getType(), VF);
+    if (auto *BO = dyn_cast<BinaryOperator>(&I))
+      return TTI.getArithmeticInstrCost(BO->getOpcode(), VectorTy, CostKind);
+    if (auto *Cast = dyn_cast<CastInst>(&I))
+      return TTI.getCastInstrCost(
+          Cast->getOpcode(), VectorTy,
+          ToVectorTy(Cast->getSrcTy(), VF),
+          TTI::CastContextHint::None, CostKind);
+    if (auto *Cmp = dyn_cast<CmpInst>(&I))
+      return TTI.getCmpSelInstrCost(
+          Cmp->getOpcode(), ToVectorTy(Cmp->getOperand(0)->getType(), VF),
+          VectorTy, Cmp->getPredicate(), CostKind);
+    if (isa<SelectInst>(I))
+      return TTI.getCmpSelInstrCost(Instruction::Select, VectorTy,
+                                    ToVectorTy(I.getOperand(0)->getType(), VF),
+                                    CmpInst::BAD_ICMP_PREDICATE, CostKind);
+    // The control flow of the inner loops is uniform, and the addresses of
+    // consecutive accesses are only needed for the first lane.
+    if (isa<BranchInst>(I) || isa<GetElementPtrInst>(I))
+      return GetScalarCost(I);
+    return Width * GetScalarCost(I);
+  };
+  // The cost of widening a memory access, which is consecutive or a gather or
+  // scatter.
+  auto GetMemoryCost = [&](Instruction &I) -> unsigned {
+    Value *Ptr = getLoadStorePointerOperand(&I);
+    auto *VectorTy = cast<VectorType>(ToVectorTy(getMemInstValueType(&I), VF));
+    const Align Alignment = getLoadStoreAlignment(&I);
+    unsigned AS = getLoadStoreAddressSpace(&I);
+    int Stride = Legal->isConsecutivePtr(Ptr);
+    unsigned Cost;
+    InstWidening Decision;
+    if (Stride) {
+      Decision = Stride == 1 ? CM_Widen : CM_Widen_Reverse;
+      Cost = TTI.getMemoryOpCost(I.getOpcode(), VectorTy, Alignment, AS,
+                                 CostKind, &I);
+      if (Stride == -1)
+        Cost += TTI.getShuffleCost(TargetTransformInfo::SK_Reverse, VectorTy);
+    } else {
+      Decision = CM_GatherScatter;
+      Cost = TTI.getGatherScatterOpCost(I.getOpcode(), VectorTy, Ptr,
+                                        false /*VariableMask*/, Alignment,
+                                        CostKind, &I);
+    }
+    setWideningDecision(&I, VF, Decision, Cost);
+    return Cost;
+  };
+
+  unsigned Cost = 0;
+  for (BasicBlock *BB : TheLoop->blocks()) {
+    // The blocks of the inner loops run once per iteration of each of them.
+    unsigned NumRuns = 1;
+    for (Loop *L = LI->getLoopFor(BB); L != TheLoop; L = L->getParentLoop())
+      NumRuns *= std::max(1u, PSE.getSE()->getSmallConstantTripCount(L));
+
+    unsigned BlockCost = 0;
+    for (Instruction &I : *BB) {
+      if (isa<PHINode>(I) || isa<DbgInfoIntrinsic>(I))
+        continue;
+      if (VF.isScalar())
+        BlockCost += GetScalarCost(I);
+      else if (isa<LoadInst>(I) || isa<StoreInst>(I))
+        BlockCost += GetMemoryCost(I);
+      else
+        BlockCost += GetWidenedCost(I);
+    }
+    Cost += NumRuns * BlockCost;
+  }
+  LLVM_DEBUG(dbgs() << "LV: Outer loop cost for VF " << VF << ": " << Cost
+                    << ".\n");
+  return Cost;
+}
+
 bool LoopVectorizationCostModel::isCandidateForEpilogueVectorization(
     const Loop &L, ElementCount VF) const {
   // Cross iteration phis such as reductions need special handling and are
@@ -7333,6 +7539,23 @@ LoopVectorizationPlanner::planInVPlanNativePath(ElementCount UserVF) {
       }
     }
     assert(EnableVPlanNativePath && "VPlan-native path is not enabled.");
+
+    // Choose the most profitable VF up to the computed one, which may be to
+    // not vectorize at all.
+    unsigned Cost = 0;
+    if (!VPlanBuildStressTest) {
+      VectorizationFactor Selected =
+          UserVF.isZero() ? CM.selectOuterLoopVectorizationFactor(VF)
+                          : VectorizationFactor{VF, CM.getOuterLoopCost(VF)};
+      if (Selected.Width.isScalar()) {
+        LLVM_DEBUG(dbgs() << "LV: Not vectorizing: The outer loop is not "
+                             "profitable to vectorize.\n");
+        return VectorizationFactor::Disabled();
+      }
+      VF = Selected.Width;
+      Cost = Selected.Cost;
+    }
+
     assert(isPowerOf2_32(VF.getKnownMinValue()) &&
            "VF needs to be a power of two");
     LLVM_DEBUG(dbgs() << "LV: Using " << (!UserVF.isZero() ? "user " : "")
@@ -7343,7 +7566,7 @@ LoopVectorizationPlanner::planInVPlanNativePath(ElementCount UserVF) {
     if (VPlanBuildStressTest)
       return VectorizationFactor::Disabled();
 
-    return {VF, 0 /*Cost*/};
+    return {VF, Cost};
   }
 
   LLVM_DEBUG(
@@ -9337,7 +9560,7 @@ LoopVectorizeResult LoopVectorizePass::runImpl(
   SmallVector<Loop *, 8> Worklist;
 
   for (Loop *L : *LI)
-    collectSupportedLoops(*L, LI, ORE, Worklist);
+    collectSupportedLoops(*L, LI, *SE, ORE, Worklist);
 
   LoopsAnalyzed += Worklist.size();
 
@@ -104,6 +104,7 @@ using namespace slpvectorizer;
 #define DEBUG_TYPE "SLP"
 
 STATISTIC(NumVectorInstructions, "Number of vector instructions generated");
+STATISTIC(NumVectorScans, "Number of scans vectorized");
 
 cl::opt<bool> RunSLPVectorization("vectorize-slp", cl::init(true), cl::Hidden,
                                   cl::desc("Run the SLP vectorization passes"));
@@ -122,6 +123,11 @@ static cl::opt<bool> ShouldStartVectorizeHorAtStore(
     cl::desc(
         "Attempt to vectorize horizontal reductions feeding into a store"));
 
+static cl::opt<bool>
+ShouldVectorizeScans("slp-vectorize-scans", cl::init(false), cl::Hidden,
+                     cl::desc("Attempt to vectorize prefix scans stored to "
+                              "consecutive locations"));
+
 static cl::opt<int>
 MaxVectorRegSizeOption("slp-max-reg-size", cl::init(128), cl::Hidden,
     cl::desc("Attempt to vectorize for this register size in bits"));
@@ -5951,6 +5957,11 @@ bool SLPVectorizerPass::runImpl(Function &F, ScalarEvolution *SE_,
   for (auto BB : post_order(&F.getEntryBlock())) {
     collectSeedInstructions(BB);
 
+    // Vectorize the scans among the stores, before their elements are taken
+    // for independent trees.
+    if (ShouldVectorizeScans && !Stores.empty())
+      Changed |= vectorizeScans(R);
+
     // Vectorize trees that end at stores.
     if (!Stores.empty()) {
       LLVM_DEBUG(dbgs() << "SLP: Found stores for " << Stores.size()
@@ -7900,6 +7911,281 @@ bool SLPVectorizerPass::vectorizeStoreChains(BoUpSLP &R) {
   return Changed;
 }
 
+/// Return the store of the element of a scan that follows the one stored by
+/// \p Prev: a store of Prev's value combined, with \p Opcode if it is set, with
+/// another operand, to the next location. \p Opcode is set to the operation of
+/// the scan.
+static StoreInst *findNextScanStore(StoreInst *Prev, unsigned &Opcode,
+                                    const SmallPtrSetImpl<StoreInst *> &Used,
+                                    const DataLayout &DL, ScalarEvolution &SE,
+                                    BoUpSLP &R) {
+  Value *V = Prev->getValueOperand();
+  // Don't walk the users of constants, which are all over the module.
+  if (!isa<Instruction>(V) && !isa<Argument>(V))
+    return nullptr;
+  for (User *U : V->users()) {
+    auto *BO = dyn_cast<BinaryOperator>(U);
+    if (!BO || BO->getParent() != Prev->getParent() || R.isDeleted(BO) ||
+        !BO->isAssociative() || !BO->isCommutative() ||
+        BO->getOperand(0) == BO->getOperand(1) ||
+        (Opcode && BO->getOpcode() != Opcode))
+      continue;
+    for (User *BU : BO->users()) {
+      auto *SI = dyn_cast<StoreInst>(BU);
+      if (!SI || !SI->isSimple() || SI->getValueOperand() != BO ||
+          SI->getParent() != Prev->getParent() || Used.count(SI) ||
+          R.isDeleted(SI) || !isConsecutiveAccess(Prev, SI, DL, SE))
+        continue;
+      Opcode = BO->getOpcode();
+      return SI;
+    }
+  }
+  return nullptr;
+}
+
+bool SLPVectorizerPass::vectorizeScanChain(ArrayRef<StoreInst *> Chain,
+                                           unsigned Opcode, Value *Carry,
+                                           BoUpSLP &R) {
+  const unsigned VF = Chain.size();
+  BasicBlock *BB = Chain[0]->getParent();
+  Type *ScalarTy = Chain[0]->getValueOperand()->getType();
+  auto *VecTy = FixedVectorType::get(ScalarTy, VF);
+  LLVM_DEBUG(dbgs() << "SLP: Analyzing a scan of " << VF << " elements.\n");
+
+  // The elements of the scan, and the operands combined into them. Without a
+  // carry, the first element is its own operand.
+  SmallVector<Value *, 8> Scans, Ops;
+  for (unsigned I = 0; I != VF; ++I) {
+    Value *V = Chain[I]->getValueOperand();
+    Value *Prev = I ? Scans[I - 1] : Carry;
+    Scans.push_back(V);
+    if (!Prev) {
+      Ops.push_back(V);
+      continue;
+    }
+    auto *BO = cast<BinaryOperator>(V);
+    Ops.push_back(BO->getOperand(BO->getOperand(0) == Prev ? 1 : 0));
+  }
+  // The elements computed by the scan operations, which go away.
+  ArrayRef<Value *> Replaced = makeArrayRef(Scans).drop_front(Carry ? 0 : 1);
+  if (any_of(Ops, [&](Value *Op) { return is_contained(Replaced, Op); }))
+    return false;
+
+  // The vector code goes after the last of its operands, and the vector store
+  // at the last of the scalar stores.
+  Instruction *LastOp = nullptr;
+  StoreInst *FirstStore = Chain[0], *LastStore = Chain[0];
+  auto UpdateLastOp = [&](Value *V) {
+    auto *I = dyn_cast_or_null<Instruction>(V);
+    if (I && I->getParent() == BB && (!LastOp || LastOp->comesBefore(I)))
+      LastOp = I;
+  };
+  for (Value *Op : Ops)
+    UpdateLastOp(Op);
+  UpdateLastOp(Carry);
+  for (StoreInst *SI : Chain) {
+    if (SI->comesBefore(FirstStore))
+      FirstStore = SI;
+    if (LastStore->comesBefore(SI))
+      LastStore = SI;
+  }
+  BasicBlock::iterator InsertPt = BB->getFirstInsertionPt();
+  if (LastOp && !isa<PHINode>(LastOp))
+    InsertPt = std::next(LastOp->getIterator());
+
+  // The users of the elements, other than the scan and its stores, get
+  // extracts from the vector. Within the block, they must follow it.
+  SmallVector<bool, 8> NeedsExtract(VF, false);
+  for (unsigned I = Carry ? 0 : 1; I != VF; ++I) {
+    for (User *U : Scans[I]->users()) {
+      if (U == Chain[I] || (I + 1 != VF && U == Scans[I + 1]))
+        continue;
+      NeedsExtract[I] = true;
+      auto *UI = cast<Instruction>(U);
+      if (UI->getParent() != BB || isa<PHINode>(UI))
+        continue;
+      if (LastOp && !LastOp->comesBefore(UI))
+        return false;
+    }
+  }
+
+  // The scalar stores sink to the last one, so nothing in between may access
+  // their locations.
+  auto IsRemoved = [&](Instruction *I) {
+    return R.isDeleted(I) || is_contained(Chain, I);
+  };
+  for (BasicBlock::iterator It = FirstStore->getIterator(),
+                            E = LastStore->getIterator();
+       It != E; ++It) {
+    if (IsRemoved(&*It) || !It->mayReadOrWriteMemory())
+      continue;
+    for (StoreInst *SI : Chain)
+      if (SI->comesBefore(&*It) &&
+          isModOrRefSet(AA->getModRefInfo(&*It, MemoryLocation::get(SI))))
+        return false;
+  }
+
+  // Load the operands with a vector load if they are consecutive loads that
+  // can sink to the vector code, and insert them into a vector otherwise.
+  bool LoadOps = all_of(Ops, [&](Value *Op) {
+    auto *LI = dyn_cast<LoadInst>(Op);
+    return LI && LI->isSimple() && LI->getParent() == BB;
+  });
+  for (unsigned I = 1; LoadOps && I != VF; ++I)
+    LoadOps = isConsecutiveAccess(Ops[I - 1], Ops[I], *DL, *SE);
+  for (unsigned I = 0; LoadOps && I != VF; ++I) {
+    auto *LI = cast<LoadInst>(Ops[I]);
+    MemoryLocation Loc = MemoryLocation::get(LI);
+    for (BasicBlock::iterator It = std::next(LI->getIterator());
+         LoadOps && It != InsertPt; ++It)
+      LoadOps = IsRemoved(&*It) || !It->mayWriteToMemory() ||
+                !isModSet(AA->getModRefInfo(&*It, Loc));
+  }
+
+  TTI::TargetCostKind CostKind = TTI::TCK_RecipThroughput;
+  auto *Store = Chain[0];
+  unsigned AS = Store->getPointerAddressSpace();
+  int ScalarCost =
+      (int)Replaced.size() *
+          TTI->getArithmeticInstrCost(Opcode, ScalarTy, CostKind) +
+      VF * TTI->getMemoryOpCost(Instruction::Store, ScalarTy, Store->getAlign(),
+                                AS, CostKind);
+  int VecCost =
+      Log2_32(VF) * (TTI->getArithmeticInstrCost(Opcode, VecTy, CostKind) +
+                     TTI->getShuffleCost(TTI::SK_PermuteTwoSrc, VecTy)) +
+      TTI->getMemoryOpCost(Instruction::Store, VecTy, Store->getAlign(), AS,
+                           CostKind);
+  if (Carry)
+    VecCost += TTI->getVectorInstrCost(Instruction::InsertElement, VecTy, 0) +
+               TTI->getShuffleCost(TTI::SK_Broadcast, VecTy) +
+               TTI->getArithmeticInstrCost(Opcode, VecTy, CostKind);
+  if (LoadOps) {
+    auto *Load = cast<LoadInst>(Ops[0]);
+    for (Value *Op : Ops)
+      if (Op->hasOneUse())
+        ScalarCost += TTI->getMemoryOpCost(Instruction::Load, ScalarTy,
+                                           Load->getAlign(),
+                                           Load->getPointerAddressSpace(),
+                                           CostKind);
+    VecCost += TTI->getMemoryOpCost(Instruction::Load, VecTy, Load->getAlign(),
+                                    Load->getPointerAddressSpace(), CostKind);
+  } else {
+    for (unsigned I = 0; I != VF; ++I)
+      VecCost += TTI->getVectorInstrCost(Instruction::InsertElement, VecTy, I);
+  }
+  for (unsigned I = 0; I != VF; ++I)
+    if (NeedsExtract[I])
+      VecCost += TTI->getVectorInstrCost(Instruction::ExtractElement, VecTy, I);
+
+  int Cost = VecCost - ScalarCost;
+  LLVM_DEBUG(dbgs() << "SLP: Found cost = " << Cost << " for a scan.\n");
+  if (Cost >= -SLPCostThreshold)
+    return false;
+
+  using namespace ore;
+
+  R.getORE()->emit(OptimizationRemark(SV_NAME, "ScanVectorized", Store)
+                   << "Scan SLP vectorized with cost " << NV("Cost", Cost)
+                   << " and with " << NV("VF", VF) << " elements");
+
+  IRBuilder<> Builder(BB, InsertPt);
+  Builder.SetCurrentDebugLocation(
+      cast<Instruction>(Scans.back())->getDebugLoc());
+  Value *Vec = UndefValue::get(VecTy);
+  if (LoadOps) {
+    auto *Load = cast<LoadInst>(Ops[0]);
+    Value *Ptr = Builder.CreateBitCast(
+        Load->getPointerOperand(),
+        VecTy->getPointerTo(Load->getPointerAddressSpace()));
+    Vec = Builder.CreateAlignedLoad(VecTy, Ptr, Load->getAlign());
+  } else {
+    for (unsigned I = 0; I != VF; ++I)
+      Vec = Builder.CreateInsertElement(Vec, Ops[I], Builder.getInt32(I));
+  }
+
+  // In log2(VF) steps, each lane combines with the lane Step lanes before it,
+  // and with the identity if there is none: the lanes end up holding the
+  // scan of the operands. The wrap flags don't hold for the partial results.
+  Constant *Identity = ConstantExpr::getBinOpIdentity(Opcode, VecTy);
+  assert(Identity && "Associative operation without an identity");
+  auto CreateScanOp = [&](Value *LHS, Value *RHS) {
+    Value *Op = Builder.CreateBinOp(Instruction::BinaryOps(Opcode), LHS, RHS);
+    if (isa<FPMathOperator>(Op))
+      propagateIRFlags(Op, Replaced);
+    return Op;
+  };
+  SmallVector<int, 8> Mask(VF);
+  for (unsigned Step = 1; Step < VF; Step *= 2) {
+    for (unsigned I = 0; I != VF; ++I)
+      Mask[I] = I >= Step ? I - Step : VF + I;
+    Value *Shifted = Builder.CreateShuffleVector(Vec, Identity, Mask);
+    Vec = CreateScanOp(Shifted, Vec);
+  }
+  if (Carry)
+    Vec = CreateScanOp(Builder.CreateVectorSplat(VF, Carry), Vec);
+
+  for (unsigned I = 0; I != VF; ++I)
+    if (NeedsExtract[I])
+      Scans[I]->replaceAllUsesWith(
+          Builder.CreateExtractElement(Vec, Builder.getInt32(I)));
+
+  Builder.SetInsertPoint(LastStore);
+  Value *Ptr = Builder.CreateBitCast(Store->getPointerOperand(),
+                                     VecTy->getPointerTo(AS));
+  Builder.CreateAlignedStore(Vec, Ptr, Store->getAlign());
+
+  SmallVector<Value *, 16> Dead(Chain.begin(), Chain.end());
+  Dead.append(Replaced.begin(), Replaced.end());
+  if (LoadOps)
+    for (Value *Op : Ops)
+      if (all_of(Op->users(), [&](User *U) { return is_contained(Dead, U); }))
+        Dead.push_back(Op);
+  R.eraseInstructions(Dead);
+  ++NumVectorScans;
+  return true;
+}
+
+bool SLPVectorizerPass::vectorizeScans(BoUpSLP &R) {
+  bool Changed = false;
+  for (auto &Pair : Stores) {
+    StoreList &List = Pair.second;
+    if (List.size() < 2)
+      continue;
+    SmallPtrSet<StoreInst *, 16> Used;
+    // Follow the scans from their first stores, in the order of the block.
+    for (StoreInst *Head : List) {
+      if (Used.count(Head) || R.isDeleted(Head))
+        continue;
+      SmallVector<StoreInst *, 16> Scan(1, Head);
+      unsigned Opcode = 0;
+      while (StoreInst *Next =
+                 findNextScanStore(Scan.back(), Opcode, Used, *DL, *SE, R))
+        Scan.push_back(Next);
+      if (Scan.size() < 2)
+        continue;
+      Used.insert(Scan.begin(), Scan.end());
+
+      unsigned MaxVF = R.getMaxVecRegSize() / R.getVectorElementSize(Head);
+      if (MaxVFOption != 0)
+        MaxVF = std::min<unsigned>(MaxVF, MaxVFOption);
+      // Each group of VF elements is a vector scan, which carries the last
+      // element of the group before it.
+      for (unsigned Begin = 0; Scan.size() - Begin >= 2;) {
+        unsigned VF =
+            PowerOf2Floor(std::min<size_t>(Scan.size() - Begin, MaxVF));
+        if (VF < 2)
+          break;
+        Value *Carry = Begin ? Scan[Begin - 1]->getValueOperand() : nullptr;
+        Changed |= vectorizeScanChain(makeArrayRef(Scan).slice(Begin, VF),
+                                      Opcode, Carry, R);
+        Begin += VF;
+      }
+    }
+    llvm::erase_if(List, [&R](StoreInst *SI) { return R.isDeleted(SI); });
+  }
+  return Changed;
+}
+
 char SLPVectorizer::ID = 0;
 
 static const char lv_name[] = "SLP Vectorizer";
@@ -14,6 +14,7 @@
 #include "llvm/Support/DataExtractor.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/XRay/BlockIndexer.h"
 #include "llvm/XRay/BlockVerifier.h"
 #include "llvm/XRay/FDRRecordConsumer.h"
@@ -23,6 +24,7 @@
 #include "llvm/XRay/FileHeaderReader.h"
 #include "llvm/XRay/YAMLXRayRecord.h"
 #include <memory>
+#include <mutex>
 #include <vector>
 
 using namespace llvm;
@@ -210,6 +212,40 @@ Error loadNaiveFormatLog(StringRef Data, bool IsLittleEndian,
   return Error::success();
 }
 
+/// Verifies the blocks recorded for a single process+thread pair, then
+/// reconstitutes their `Trace` records into \p Records.
+Error expandBlocks(std::vector<BlockIndexer::Block> &Blocks, uint16_t Version,
+                   std::vector<XRayRecord> &Records) {
+  // First we verify the consistency of the blocks.
+  for (auto &B : Blocks) {
+    BlockVerifier Verifier;
+    for (auto *R : B.Records)
+      if (auto E = R->apply(Verifier))
+        return E;
+    if (auto E = Verifier.verify())
+      return E;
+  }
+
+  // This is now the meat of the algorithm. Here we sort the blocks according to
+  // the Walltime record in each of the blocks for the same thread. This allows
+  // us to more consistently recreate the execution trace in temporal order.
+  // After the sort, we then reconstitute `Trace` records using a stateful
+  // visitor associated with a single process+thread pair.
+  llvm::sort(Blocks, [](const BlockIndexer::Block &L,
+                        const BlockIndexer::Block &R) {
+    return (L.WallclockTime->seconds() < R.WallclockTime->seconds() &&
+            L.WallclockTime->nanos() < R.WallclockTime->nanos());
+  });
+  auto Adder = [&](const XRayRecord &R) { Records.push_back(R); };
+  TraceExpander Expander(Adder, Version);
+  for (auto &B : Blocks) {
+    for (auto *R : B.Records)
+      if (auto E = R->apply(Expander))
+        return E;
+  }
+  return Expander.flush();
+}
+
 /// Reads a log in FDR mode for version 1 of this binary format. FDR mode is
 /// defined as part of the compiler-rt project in xray_fdr_logging.h, and such
 /// a log consists of the familiar 32 bit XRayHeader, followed by sequences of
@@ -304,46 +340,32 @@ Error loadFDRLog(StringRef Data, bool IsLittleEndian,
       return E;
   }
 
-  // Then we verify the consistency of the blocks.
-  {
-    for (auto &PTB : Index) {
-      auto &Blocks = PTB.second;
-      for (auto &B : Blocks) {
-        BlockVerifier Verifier;
-        for (auto *R : B.Records)
-          if (auto E = R->apply(Verifier))
-            return E;
-        if (auto E = Verifier.verify())
-          return E;
-      }
-    }
-  }
-
-  // This is now the meat of the algorithm. Here we sort the blocks according to
-  // the Walltime record in each of the blocks for the same thread. This allows
-  // us to more consistently recreate the execution trace in temporal order.
-  // After the sort, we then reconstitute `Trace` records using a stateful
-  // visitor associated with a single process+thread pair.
-  {
-    for (auto &PTB : Index) {
-      auto &Blocks = PTB.second;
-      llvm::sort(Blocks, [](const BlockIndexer::Block &L,
-                            const BlockIndexer::Block &R) {
-        return (L.WallclockTime->seconds() < R.WallclockTime->seconds() &&
-                L.WallclockTime->nanos() < R.WallclockTime->nanos());
-      });
-      auto Adder = [&](const XRayRecord &R) { Records.push_back(R); };
-      TraceExpander Expander(Adder, FileHeader.Version);
-      for (auto &B : Blocks) {
-        for (auto *R : B.Records)
-          if (auto E = R->apply(Expander))
-            return E;
-      }
-      if (auto E = Expander.flush())
-        return E;
+  // The blocks of each process+thread pair are independent of every other
+  // pair's, so we verify and expand them in parallel, one task per pair, and
+  // concatenate the results in index order afterwards. This keeps the output
+  // the same no matter how many threads do the work.
+  std::vector<std::vector<BlockIndexer::Block> *> Threads;
+  for (auto &PTB : Index)
+    Threads.push_back(&PTB.second);
+  std::vector<std::vector<XRayRecord>> ThreadRecords(Threads.size());
+  std::mutex ErrMutex;
+  Error Err = Error::success();
+  parallelForEachN(0, Threads.size(), [&](size_t I) {
+    if (auto E = expandBlocks(*Threads[I], FileHeader.Version,
+                              ThreadRecords[I])) {
+      std::lock_guard<std::mutex> Lock(ErrMutex);
+      Err = joinErrors(std::move(Err), std::move(E));
     }
-  }
-
+  });
+  if (Err)
+    return Err;
+
+  size_t Total = Records.size();
+  for (auto &R : ThreadRecords)
+    Total += R.size();
+  Records.reserve(Total);
+  for (auto &R : ThreadRecords)
+    Records.insert(Records.end(), R.begin(), R.end());
   return Error::success();
 }
 
@@ -23,6 +23,7 @@
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/PointerIntPair.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/ScopeExit.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
@@ -296,6 +297,31 @@ bool DwarfLinkerForBinary::link(const DebugMap &Map) {
   if (!createStreamer(Map.getTriple(), OutFile))
     return false;
 
+  bool EmitDsymCompanion = Map.getTriple().isOSDarwin() &&
+                           !Map.getBinaryPath().empty() &&
+                           Options.FileType == OutputFileType::Object;
+
+  // The dSYM companion file is written section by section at the end, so
+  // the linked debug_info can be kept in a temporary file until then.
+  Optional<sys::fs::TempFile> DebugInfoFile;
+  std::unique_ptr<raw_fd_ostream> DebugInfoStream;
+  if (Options.StreamDebugInfo && EmitDsymCompanion && !Options.NoOutput) {
+    SmallString<128> Model;
+    sys::path::system_temp_directory(/*ErasedOnReboot=*/true, Model);
+    sys::path::append(Model, "dsymutil-%%%%%%.debug_info");
+    Expected<sys::fs::TempFile> TempFile = sys::fs::TempFile::create(Model);
+    if (!TempFile)
+      return error(toString(TempFile.takeError()), "streaming debug_info");
+    DebugInfoFile = std::move(*TempFile);
+    DebugInfoStream = std::make_unique<raw_fd_ostream>(
+        DebugInfoFile->FD, /*shouldClose=*/false);
+    Streamer->setDebugInfoStream(DebugInfoStream.get());
+  }
+  auto DiscardDebugInfoFile = make_scope_exit([&] {
+    if (DebugInfoFile)
+      consumeError(DebugInfoFile->discard());
+  });
+
   ObjectsForLinking.clear();
   ContextForLinking.clear();
   AddressMapForLinking.clear();
@@ -453,11 +479,23 @@ bool DwarfLinkerForBinary::link(const DebugMap &Map) {
       return error(toString(std::move(E)));
   }
 
-  if (Map.getTriple().isOSDarwin() && !Map.getBinaryPath().empty() &&
-      Options.FileType == OutputFileType::Object)
+  if (EmitDsymCompanion) {
+    std::unique_ptr<MemoryBuffer> DebugInfo;
+    if (DebugInfoStream) {
+      DebugInfoStream->flush();
+      if (DebugInfoStream->has_error())
+        return error(DebugInfoStream->error().message(),
+                     "streaming debug_info");
+      auto BufOrErr = MemoryBuffer::getFile(DebugInfoFile->TmpName, -1,
+                                            /*RequiresNullTerminator=*/false);
+      if (!BufOrErr)
+        return error(BufOrErr.getError().message(), "streaming debug_info");
+      DebugInfo = std::move(*BufOrErr);
+    }
     return MachOUtils::generateDsymCompanion(
         Options.VFS, Map, Options.Translator,
-        *Streamer->getAsmPrinter().OutStreamer, OutFile);
+        *Streamer->getAsmPrinter().OutStreamer, OutFile, DebugInfo.get());
+  }
 
   Streamer->finish();
   return true;
@@ -33,6 +33,9 @@ struct LinkOptions {
   /// Skip emitting output
   bool NoOutput = false;
 
+  /// Write debug_info to a temporary file as it is emitted
+  bool StreamDebugInfo = false;
+
   /// Do not unique types according to ODR
   bool NoODR = false;
 
@@ -12,7 +12,9 @@
 #include "LinkUtils.h"
 #include "llvm/CodeGen/NonRelocatableStringpool.h"
 #include "llvm/MC/MCAsmLayout.h"
+#include "llvm/MC/MCContext.h"
 #include "llvm/MC/MCMachObjectWriter.h"
+#include "llvm/MC/MCObjectFileInfo.h"
 #include "llvm/MC/MCObjectStreamer.h"
 #include "llvm/MC/MCSectionMachO.h"
 #include "llvm/MC/MCStreamer.h"
@@ -339,10 +341,13 @@ static unsigned segmentLoadCommandSize(bool Is64Bit, unsigned NumSections) {
 
 // Stream a dSYM companion binary file corresponding to the binary referenced
 // by \a DM to \a OutFile. The passed \a MS MCStreamer is setup to write to
-// \a OutFile and it must be using a MachObjectWriter object to do so.
+// \a OutFile and it must be using a MachObjectWriter object to do so. If
+// \a DebugInfo is set, it holds the debug_info contents, for which \a MS only
+// reserved space.
 bool generateDsymCompanion(llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> VFS,
                            const DebugMap &DM, SymbolMapTranslator &Translator,
-                           MCStreamer &MS, raw_fd_ostream &OutFile) {
+                           MCStreamer &MS, raw_fd_ostream &OutFile,
+                           const MemoryBuffer *DebugInfo) {
   auto &ObjectStreamer = static_cast<MCObjectStreamer &>(MS);
   MCAssembler &MCAsm = ObjectStreamer.getAssembler();
   auto &Writer = static_cast<MachObjectWriter &>(MCAsm.getWriter());
@@ -562,12 +567,20 @@ bool generateDsymCompanion(llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> VFS,
   assert(OutFile.tell() == DwarfSegmentStart);
 
   // Emit the Dwarf sections contents.
+  const MCSection *DebugInfoSec =
+      MS.getContext().getObjectFileInfo()->getDwarfInfoSection();
   for (const MCSection &Sec : MCAsm) {
     if (Sec.begin() == Sec.end())
       continue;
 
     uint64_t Pos = OutFile.tell();
     OutFile.write_zeros(alignTo(Pos, Sec.getAlignment()) - Pos);
+    if (DebugInfo && &Sec == DebugInfoSec) {
+      assert(DebugInfo->getBufferSize() == Layout.getSectionFileSize(&Sec) &&
+             "streamed debug_info doesn't match the reserved space");
+      OutFile << DebugInfo->getBuffer();
+      continue;
+    }
     MCAsm.writeSectionData(OutFile, &Sec, Layout);
   }
 
@@ -18,6 +18,7 @@
 
 namespace llvm {
 class MCStreamer;
+class MemoryBuffer;
 class raw_fd_ostream;
 namespace dsymutil {
 class DebugMap;
@@ -43,7 +44,8 @@ bool generateUniversalBinary(SmallVectorImpl<ArchAndFile> &ArchFiles,
 
 bool generateDsymCompanion(llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> VFS,
                            const DebugMap &DM, SymbolMapTranslator &Translator,
-                           MCStreamer &MS, raw_fd_ostream &OutFile);
+                           MCStreamer &MS, raw_fd_ostream &OutFile,
+                           const MemoryBuffer *DebugInfo = nullptr);
 
 std::string getArchName(StringRef Arch);
 } // namespace MachOUtils
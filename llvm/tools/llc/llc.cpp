@@ -13,6 +13,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/CodeGen/CommandFlags.h"
@@ -21,6 +22,7 @@
 #include "llvm/CodeGen/MIRParser/MIRParser.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/CodeGen/MachineModuleInfo.h"
+#include "llvm/CodeGen/ParallelCG.h"
 #include "llvm/CodeGen/TargetPassConfig.h"
 #include "llvm/CodeGen/TargetSubtargetInfo.h"
 #include "llvm/IR/AutoUpgrade.h"
@@ -108,6 +110,14 @@ static cl::opt<std::string> SplitDwarfFile(
     cl::desc(
         "Specify the name of the .dwo file to encode in the DWARF output"));
 
+static cl::opt<unsigned> CodeGenPartitions(
+    "codegen-partitions", cl::init(1), cl::value_desc("N"),
+    cl::desc("Split the module into N partitions, and generate code for them "
+             "in parallel. Partition 0 is written to the output file, and "
+             "partition I to the output file suffixed with '.I'. Linked "
+             "together, they are equivalent to the output of a single "
+             "partition"));
+
 static cl::opt<bool> NoVerify("disable-verify", cl::Hidden,
                               cl::desc("Do not verify input module"));
 
@@ -577,6 +587,51 @@ static int compileModule(char **argv, LLVMContext &Context) {
     WithColor::warning(errs(), argv[0])
         << ": warning: ignoring -mc-relax-all because filetype != obj";
 
+  if (CodeGenPartitions > 1) {
+    if (MIR || !RunPassNames->empty() || DwoOut || CompileTwice ||
+        DisableSimplifyLibCalls || OutputFilename == "-") {
+      WithColor::error(errs(), argv[0])
+          << "-codegen-partitions needs an output file, and does not support "
+             "MIR input, -run-pass, -split-dwarf-output, -compile-twice or "
+             "-disable-simplify-libcalls\n";
+      return 1;
+    }
+
+    std::vector<std::unique_ptr<ToolOutputFile>> PartitionOuts;
+    SmallVector<raw_pwrite_stream *, 8> OSs{&Out->os()};
+    for (unsigned I = 1; I != CodeGenPartitions; ++I) {
+      std::error_code EC;
+      PartitionOuts.push_back(std::make_unique<ToolOutputFile>(
+          OutputFilename + "." + utostr(I), EC,
+          codegen::getFileType() == CGFT_AssemblyFile ? sys::fs::OF_Text
+                                                      : sys::fs::OF_None));
+      if (EC) {
+        WithColor::error(errs(), argv[0]) << EC.message() << '\n';
+        return 1;
+      }
+      OSs.push_back(&PartitionOuts.back()->os());
+    }
+
+    // Before executing passes, print the final values of the LLVM options.
+    cl::PrintOptionValues();
+
+    // Each partition is generated in its own LLVMContext, on its own thread,
+    // with its own TargetMachine.
+    splitCodeGen(
+        std::move(M), OSs, /*BCOSs=*/{},
+        [&]() {
+          return std::unique_ptr<TargetMachine>(TheTarget->createTargetMachine(
+              TheTriple.getTriple(), CPUStr, FeaturesStr, Options, RM,
+              codegen::getExplicitCodeModel(), OLvl));
+        },
+        codegen::getFileType());
+
+    Out->keep();
+    for (auto &PartitionOut : PartitionOuts)
+      PartitionOut->keep();
+    return 0;
+  }
+
   {
     raw_pwrite_stream *OS = &Out->os();
 
@@ -101,6 +101,13 @@ namespace {
                                  "(jit-kind=orc-lazy only)"),
                         cl::init(0));
 
+  cl::opt<unsigned> TierUpThreshold(
+      "tier-up-threshold",
+      cl::desc("Compile functions without optimization first, and recompile "
+               "them with optimization after this many calls. Zero disables "
+               "tiering (jit-kind=orc-lazy only)"),
+      cl::init(0));
+
   cl::list<std::string>
   ThreadEntryPoints("thread-entry",
                     cl::desc("calls the given entry-point on a new thread "
@@ -832,6 +839,7 @@ int runOrcLazyJIT(const char *ProgName) {
   Builder.setLazyCompileFailureAddr(
       pointerToJITTargetAddress(exitOnLazyCallThroughFailure));
   Builder.setNumCompileThreads(LazyJITCompileThreads);
+  Builder.setTierUpThreshold(TierUpThreshold);
 
   // If the object cache is enabled then set a custom compile function
   // creator to use the cache.
@@ -11,6 +11,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/Triple.h"
@@ -784,6 +785,38 @@ static InsertAction computeInsertAction(ArchiveOperation Operation,
   llvm_unreachable("No such operation");
 }
 
+// Maps the offsets of the members of an archive to the symbols that its symbol
+// table lists for them.
+using MemberSymbolsMap = DenseMap<uint64_t, std::vector<StringRef>>;
+
+// Reads the symbol table of the old archive, so that the members that are kept
+// don't need to be parsed again to write the new one. The members of a thin
+// archive may have changed on disk since the symbol table was written, so
+// their symbols are always recomputed.
+static MemberSymbolsMap readMemberSymbols(const object::Archive &OldArchive) {
+  MemberSymbolsMap Ret;
+  if (OldArchive.isThin() || !OldArchive.hasSymbolTable())
+    return Ret;
+  for (const object::Archive::Symbol &Sym : OldArchive.symbols()) {
+    Expected<object::Archive::Child> ChildOrErr = Sym.getMember();
+    if (!ChildOrErr) {
+      // Don't trust a broken symbol table; parse all members instead.
+      consumeError(ChildOrErr.takeError());
+      return MemberSymbolsMap();
+    }
+    Ret[ChildOrErr->getChildOffset()].push_back(Sym.getName());
+  }
+  return Ret;
+}
+
+static void addOldMemberSymbols(NewArchiveMember &Member,
+                                const object::Archive::Child &Child,
+                                const MemberSymbolsMap &OldSymbols) {
+  auto It = OldSymbols.find(Child.getChildOffset());
+  if (It != OldSymbols.end())
+    Member.Symbols = It->second;
+}
+
 // We have to walk this twice and computing it is not trivial, so creating an
 // explicit std::vector is actually fairly efficient.
 static std::vector<NewArchiveMember>
@@ -795,6 +828,9 @@ computeNewArchiveMembers(ArchiveOperation Operation,
   if (OldArchive) {
     Error Err = Error::success();
     StringMap<int> MemberCount;
+    MemberSymbolsMap OldSymbols;
+    if (Symtab)
+      OldSymbols = readMemberSymbols(*OldArchive);
     for (auto &Child : OldArchive->children(Err)) {
       int Pos = Ret.size();
       Expected<StringRef> NameOrErr = Child.getName();
@@ -814,6 +850,8 @@ computeNewArchiveMembers(ArchiveOperation Operation,
       switch (Action) {
       case IA_AddOldMember:
         addChildMember(Ret, Child, /*FlattenArchive=*/Thin);
+        if (!OldSymbols.empty())
+          addOldMemberSymbols(Ret.back(), Child, OldSymbols);
         break;
       case IA_AddNewMember:
         addMember(Ret, *MemberI);
@@ -822,6 +860,8 @@ computeNewArchiveMembers(ArchiveOperation Operation,
         break;
       case IA_MoveOldMember:
         addChildMember(Moved, Child, /*FlattenArchive=*/Thin);
+        if (!OldSymbols.empty())
+          addOldMemberSymbols(Moved.back(), Child, OldSymbols);
         break;
       case IA_MoveNewMember:
         addMember(Moved, *MemberI);
@@ -12,6 +12,8 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/Parallel.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdlib>
 #include <iostream>
@@ -58,6 +60,12 @@ static cl::opt<bool>
 static cl::alias TypesShort("t", cl::desc("alias for --types"),
                             cl::aliasopt(Types));
 
+static cl::opt<unsigned>
+    Threads("threads",
+            cl::desc("demangle in batches on this many threads, 0 for all "
+                     "hardware threads; output keeps the input order"),
+            cl::init(1));
+
 static cl::list<std::string>
 Decorated(cl::Positional, cl::desc("<mangled>"), cl::ZeroOrMore);
 
@@ -74,8 +82,8 @@ static bool shouldStripUnderscore() {
   return Triple(sys::getProcessTriple()).isOSBinFormatMachO();
 }
 
-static std::string demangle(const std::string &Mangled) {
-  int Status;
+static std::string demangle(ItaniumDemangleContext &Demangler,
+                            const std::string &Mangled) {
   std::string Prefix;
 
   const char *DecoratedStr = Mangled.c_str();
@@ -84,22 +92,20 @@ static std::string demangle(const std::string &Mangled) {
       ++DecoratedStr;
   size_t DecoratedLength = strlen(DecoratedStr);
 
-  char *Undecorated = nullptr;
+  const char *Undecorated = nullptr;
 
   if (Types ||
       ((DecoratedLength >= 2 && strncmp(DecoratedStr, "_Z", 2) == 0) ||
        (DecoratedLength >= 4 && strncmp(DecoratedStr, "___Z", 4) == 0)))
-    Undecorated = itaniumDemangle(DecoratedStr, nullptr, nullptr, &Status);
+    Undecorated = Demangler.demangle(DecoratedStr);
 
   if (!Undecorated &&
       (DecoratedLength > 6 && strncmp(DecoratedStr, "__imp_", 6) == 0)) {
     Prefix = "import thunk for ";
-    Undecorated = itaniumDemangle(DecoratedStr + 6, nullptr, nullptr, &Status);
+    Undecorated = Demangler.demangle(DecoratedStr + 6);
   }
 
-  std::string Result(Undecorated ? Prefix + Undecorated : Mangled);
-  free(Undecorated);
-  return Result;
+  return Undecorated ? Prefix + Undecorated : Mangled;
 }
 
 // Split 'Source' on any character that fails to pass 'IsLegalChar'.  The
@@ -138,17 +144,37 @@ static bool IsLegalItaniumChar(char C) {
 
 // If 'Split' is true, then 'Mangled' is broken into individual words and each
 // word is demangled.  Otherwise, the entire string is treated as a single
-// mangled item.  The result is output to 'OS'.
-static void demangleLine(llvm::raw_ostream &OS, StringRef Mangled, bool Split) {
+// mangled item.
+static std::string demangleLine(ItaniumDemangleContext &Demangler,
+                                StringRef Mangled, bool Split) {
   std::string Result;
   if (Split) {
     SmallVector<std::pair<StringRef, StringRef>, 16> Words;
     SplitStringDelims(Mangled, Words, IsLegalItaniumChar);
     for (const auto &Word : Words)
-      Result += ::demangle(std::string(Word.first)) + Word.second.str();
+      Result += ::demangle(Demangler, std::string(Word.first)) +
+                Word.second.str();
   } else
-    Result = ::demangle(std::string(Mangled));
-  OS << Result << '\n';
+    Result = ::demangle(Demangler, std::string(Mangled));
+  return Result;
+}
+
+// Demangle 'Lines' in parallel and output the results in order. Each task
+// takes a contiguous chunk of lines and a demangler of its own.
+static void demangleBatch(llvm::raw_ostream &OS,
+                          const std::vector<std::string> &Lines, bool Split) {
+  std::vector<std::string> Results(Lines.size());
+  size_t NumChunks = std::min<size_t>(
+      Lines.size(), parallel::strategy.compute_thread_count() * 4);
+  parallelForEachN(0, NumChunks, [&](size_t Chunk) {
+    ItaniumDemangleContext Demangler;
+    size_t Begin = Lines.size() * Chunk / NumChunks;
+    size_t End = Lines.size() * (Chunk + 1) / NumChunks;
+    for (size_t I = Begin; I != End; ++I)
+      Results[I] = demangleLine(Demangler, Lines[I], Split);
+  });
+  for (const std::string &Result : Results)
+    OS << Result << '\n';
   OS.flush();
 }
 
@@ -157,12 +183,40 @@ int main(int argc, char **argv) {
 
   cl::ParseCommandLineOptions(argc, argv, "llvm symbol undecoration tool\n");
 
+  if (Threads != 1) {
+    parallel::strategy = hardware_concurrency(Threads);
+    if (!Decorated.empty()) {
+      demangleBatch(llvm::outs(), Decorated, false);
+      return EXIT_SUCCESS;
+    }
+    // Read standard input in batches, so that results still stream out when
+    // the input is long.
+    const size_t BatchSize = 1 << 16;
+    std::vector<std::string> Lines;
+    for (std::string Mangled; std::getline(std::cin, Mangled);) {
+      Lines.push_back(std::move(Mangled));
+      if (Lines.size() == BatchSize) {
+        demangleBatch(llvm::outs(), Lines, true);
+        Lines.clear();
+      }
+    }
+    demangleBatch(llvm::outs(), Lines, true);
+    return EXIT_SUCCESS;
+  }
+
+  // Demangle line by line, flushing after each, so that interactive use and
+  // pipes see every result as soon as its line is read.
+  ItaniumDemangleContext Demangler;
+  auto Output = [](const std::string &Result) {
+    llvm::outs() << Result << '\n';
+    llvm::outs().flush();
+  };
   if (Decorated.empty())
     for (std::string Mangled; std::getline(std::cin, Mangled);)
-      demangleLine(llvm::outs(), Mangled, true);
+      Output(demangleLine(Demangler, Mangled, true));
   else
     for (const auto &Symbol : Decorated)
-      demangleLine(llvm::outs(), Symbol, false);
+      Output(demangleLine(Demangler, Symbol, false));
 
   return EXIT_SUCCESS;
 }
@@ -1,51 +1,32 @@
 #ifndef TOOLS_LLVM_DWP_DWPSTRINGPOOL
 #define TOOLS_LLVM_DWP_DWPSTRINGPOOL
 
+#include "DWPWriter.h"
+#include "llvm/ADT/CachedHashString.h"
 #include "llvm/ADT/DenseMap.h"
-#include "llvm/MC/MCSection.h"
-#include "llvm/MC/MCStreamer.h"
 #include <cassert>
 
 namespace llvm {
 class DWPStringPool {
-
-  struct CStrDenseMapInfo {
-    static inline const char *getEmptyKey() {
-      return reinterpret_cast<const char *>(~static_cast<uintptr_t>(0));
-    }
-    static inline const char *getTombstoneKey() {
-      return reinterpret_cast<const char *>(~static_cast<uintptr_t>(1));
-    }
-    static unsigned getHashValue(const char *Val) {
-      assert(Val != getEmptyKey() && "Cannot hash the empty key!");
-      assert(Val != getTombstoneKey() && "Cannot hash the tombstone key!");
-      return (unsigned)hash_value(StringRef(Val));
-    }
-    static bool isEqual(const char *LHS, const char *RHS) {
-      if (RHS == getEmptyKey())
-        return LHS == getEmptyKey();
-      if (RHS == getTombstoneKey())
-        return LHS == getTombstoneKey();
-      return strcmp(LHS, RHS) == 0;
-    }
-  };
-
-  MCStreamer &Out;
-  MCSection *Sec;
-  DenseMap<const char *, uint32_t, CStrDenseMapInfo> Pool;
+  DWPSection &Out;
+  DenseMap<CachedHashStringRef, uint32_t> Pool;
   uint32_t Offset = 0;
 
 public:
-  DWPStringPool(MCStreamer &Out, MCSection *Sec) : Out(Out), Sec(Sec) {}
+  DWPStringPool(DWPSection &Out) : Out(Out) {}
 
-  uint32_t getOffset(const char *Str, unsigned Length) {
-    assert(strlen(Str) + 1 == Length && "Ensure length hint is correct");
+  /// Returns the offset of \p Str in the output string section, appending it
+  /// to the section if needed. \p Str doesn't include the null terminator that
+  /// follows it, and must stay valid until the output is written. Its hash is
+  /// usually computed ahead of time, while the input files are read.
+  uint32_t getOffset(CachedHashStringRef Str) {
+    assert(Str.val().data()[Str.size()] == '\0' &&
+           "Ensure the string is null terminated");
 
     auto Pair = Pool.insert(std::make_pair(Str, Offset));
     if (Pair.second) {
-      Out.SwitchSection(Sec);
-      Out.emitBytes(StringRef(Str, Length));
-      Offset += Length;
+      Out.append(StringRef(Str.val().data(), Str.size() + 1));
+      Offset += Str.size() + 1;
     }
 
     return Pair.first->second;
@@ -0,0 +1,73 @@
+#include "DWPWriter.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/BinaryFormat/ELF.h"
+#include "llvm/Object/ELFTypes.h"
+#include "llvm/Support/MathExtras.h"
+#include <cstring>
+
+using namespace llvm;
+
+void llvm::writeDWP(raw_ostream &OS, ArrayRef<const DWPSection *> Sections) {
+  using Elf_Ehdr = object::ELF64LE::Ehdr;
+  using Elf_Shdr = object::ELF64LE::Shdr;
+
+  SmallVector<const DWPSection *, 16> OutputSections;
+  for (const DWPSection *Section : Sections)
+    if (Section->getSize())
+      OutputSections.push_back(Section);
+
+  // The section headers are the null header, one header per output section,
+  // and the header of the section name string table, which comes last.
+  std::vector<Elf_Shdr> Headers(OutputSections.size() + 2);
+  memset(Headers.data(), 0, Headers.size() * sizeof(Elf_Shdr));
+  std::string SectionNames(1, '\0');
+  uint64_t Offset = sizeof(Elf_Ehdr);
+  for (size_t I = 0; I != OutputSections.size(); ++I) {
+    const DWPSection &Section = *OutputSections[I];
+    Elf_Shdr &Header = Headers[I + 1];
+    Header.sh_name = SectionNames.size();
+    Header.sh_type = ELF::SHT_PROGBITS;
+    Header.sh_flags = Section.getFlags();
+    Header.sh_offset = Offset;
+    Header.sh_size = Section.getSize();
+    Header.sh_addralign = 1;
+    Header.sh_entsize = Section.getEntrySize();
+    SectionNames += Section.getName();
+    SectionNames += '\0';
+    Offset += Section.getSize();
+  }
+  Elf_Shdr &NamesHeader = Headers.back();
+  NamesHeader.sh_name = SectionNames.size();
+  SectionNames += ".shstrtab";
+  SectionNames += '\0';
+  NamesHeader.sh_type = ELF::SHT_STRTAB;
+  NamesHeader.sh_offset = Offset;
+  NamesHeader.sh_size = SectionNames.size();
+  NamesHeader.sh_addralign = 1;
+  Offset += SectionNames.size();
+  uint64_t HeadersOffset = alignTo(Offset, 8);
+
+  Elf_Ehdr FileHeader;
+  memset(&FileHeader, 0, sizeof(FileHeader));
+  memcpy(FileHeader.e_ident, ELF::ElfMagic, strlen(ELF::ElfMagic));
+  FileHeader.e_ident[ELF::EI_CLASS] = ELF::ELFCLASS64;
+  FileHeader.e_ident[ELF::EI_DATA] = ELF::ELFDATA2LSB;
+  FileHeader.e_ident[ELF::EI_VERSION] = ELF::EV_CURRENT;
+  FileHeader.e_ident[ELF::EI_OSABI] = ELF::ELFOSABI_NONE;
+  FileHeader.e_type = ELF::ET_REL;
+  FileHeader.e_machine = ELF::EM_X86_64;
+  FileHeader.e_version = ELF::EV_CURRENT;
+  FileHeader.e_shoff = HeadersOffset;
+  FileHeader.e_ehsize = sizeof(Elf_Ehdr);
+  FileHeader.e_shentsize = sizeof(Elf_Shdr);
+  FileHeader.e_shnum = Headers.size();
+  FileHeader.e_shstrndx = Headers.size() - 1;
+
+  OS.write(reinterpret_cast<const char *>(&FileHeader), sizeof(FileHeader));
+  for (const DWPSection *Section : OutputSections)
+    Section->write(OS);
+  OS << SectionNames;
+  OS.write_zeros(HeadersOffset - Offset);
+  OS.write(reinterpret_cast<const char *>(Headers.data()),
+           Headers.size() * sizeof(Elf_Shdr));
+}
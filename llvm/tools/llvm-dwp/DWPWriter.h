@@ -0,0 +1,63 @@
+#ifndef TOOLS_LLVM_DWP_DWPWRITER
+#define TOOLS_LLVM_DWP_DWPWRITER
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace llvm {
+/// A section of the output package. Its contents are a list of chunks that
+/// either point into the input files or into buffers owned by the section.
+/// Nothing is copied until the package is written, so that the package never
+/// needs to be built up in memory.
+class DWPSection {
+public:
+  DWPSection(StringRef Name, uint64_t Flags, uint64_t EntrySize = 0)
+      : Name(Name), Flags(Flags), EntrySize(EntrySize) {}
+
+  StringRef getName() const { return Name; }
+  uint64_t getFlags() const { return Flags; }
+  uint64_t getEntrySize() const { return EntrySize; }
+  uint64_t getSize() const { return Size; }
+
+  /// Appends \p Data, which must stay valid until the package is written.
+  void append(StringRef Data) {
+    if (Data.empty())
+      return;
+    Chunks.push_back(Data);
+    Size += Data.size();
+  }
+
+  /// Appends a zeroed buffer of \p BufferSize bytes owned by the section. The
+  /// buffer may be filled in until the package is written.
+  MutableArrayRef<char> appendBuffer(size_t BufferSize) {
+    Buffers.emplace_back(new char[BufferSize]());
+    MutableArrayRef<char> Buffer(Buffers.back().get(), BufferSize);
+    append(StringRef(Buffer.data(), Buffer.size()));
+    return Buffer;
+  }
+
+  void write(raw_ostream &OS) const {
+    for (StringRef Chunk : Chunks)
+      OS << Chunk;
+  }
+
+private:
+  std::string Name;
+  uint64_t Flags;
+  uint64_t EntrySize;
+  uint64_t Size = 0;
+  std::vector<StringRef> Chunks;
+  std::vector<std::unique_ptr<char[]>> Buffers;
+};
+
+/// Writes the non-empty sections among \p Sections to \p OS as an x86-64 ELF
+/// relocatable object, streaming their contents.
+void writeDWP(raw_ostream &OS, ArrayRef<const DWPSection *> Sections);
+}
+
+#endif
@@ -12,43 +12,37 @@
 //===----------------------------------------------------------------------===//
 #include "DWPError.h"
 #include "DWPStringPool.h"
+#include "DWPWriter.h"
+#include "llvm/ADT/CachedHashString.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/ScopeExit.h"
+#include "llvm/BinaryFormat/ELF.h"
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
 #include "llvm/DebugInfo/DWARF/DWARFFormValue.h"
 #include "llvm/DebugInfo/DWARF/DWARFUnitIndex.h"
-#include "llvm/MC/MCAsmBackend.h"
-#include "llvm/MC/MCAsmInfo.h"
-#include "llvm/MC/MCCodeEmitter.h"
-#include "llvm/MC/MCContext.h"
-#include "llvm/MC/MCInstrInfo.h"
-#include "llvm/MC/MCObjectFileInfo.h"
-#include "llvm/MC/MCObjectWriter.h"
-#include "llvm/MC/MCRegisterInfo.h"
-#include "llvm/MC/MCStreamer.h"
-#include "llvm/MC/MCTargetOptionsCommandFlags.h"
 #include "llvm/Object/Decompressor.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/DataExtractor.h"
+#include "llvm/Support/EndianStream.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/InitLLVM.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
-#include "llvm/Support/TargetRegistry.h"
-#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
+#include <deque>
 
 using namespace llvm;
 using namespace llvm::object;
 
-static mc::RegisterMCTargetOptionsFlags MCTargetOptionsFlags;
-
 cl::OptionCategory DwpCategory("Specific Options");
 static cl::list<std::string> InputFiles(cl::Positional, cl::ZeroOrMore,
                                         cl::desc("<input files>"),
@@ -64,36 +58,87 @@ static cl::opt<std::string> OutputFilename(cl::Required, "o",
                                            cl::value_desc("filename"),
                                            cl::cat(DwpCategory));
 
-static void writeStringsAndOffsets(MCStreamer &Out, DWPStringPool &Strings,
-                                   MCSection *StrOffsetSection,
+static cl::opt<unsigned>
+    NumThreads("num-threads",
+               cl::desc("Specify the maximum number of threads used to read "
+                        "the input files and rewrite their string offsets. "
+                        "0 uses all the hardware threads."),
+               cl::init(0), cl::cat(DwpCategory));
+static cl::alias NumThreadsAlias("j", cl::desc("Alias for --num-threads"),
+                                 cl::aliasopt(NumThreads));
+
+/// An output section and the kind of its contributions in the unit indexes.
+using OutputSection = std::pair<DWPSection *, DWARFSectionKind>;
+
+/// The strings of a string section, with their offsets in the section.
+using StringList = std::vector<std::pair<uint64_t, CachedHashStringRef>>;
+
+namespace {
+/// An input file. The files are opened, their sections decompressed and their
+/// strings hashed on a thread pool, before their contents are merged into the
+/// package in input order.
+struct DWOInput {
+  OwningBinary<ObjectFile> Obj;
+  std::deque<SmallString<32>> UncompressedSections;
+  /// The sections of the file that go into the package, in file order.
+  std::vector<std::pair<OutputSection, StringRef>> Sections;
+  /// The strings of the string section of the file, in section order.
+  StringList Strings;
+  /// The result of reading the file.
+  Optional<Error> Err;
+};
+
+/// The rewriting of the string offsets of an input file into its contribution
+/// to the output string offsets section. It only needs the offsets of the
+/// strings of the file in the output string section, so the rewriting of all
+/// the files can be done in parallel once the string pool is complete.
+struct StrOffsetsRewrite {
+  StringRef StrOffsets;
+  const StringList *Strings;
+  /// The offsets of Strings in the output string section.
+  std::vector<uint32_t> NewOffsets;
+  MutableArrayRef<char> Out;
+};
+} // namespace
+
+static void writeStringsAndOffsets(DWPStringPool &Strings,
+                                   DWPSection &StrOffsetSection,
                                    StringRef CurStrSection,
-                                   StringRef CurStrOffsetSection) {
+                                   StringRef CurStrOffsetSection,
+                                   const StringList &CurStrings,
+                                   std::vector<StrOffsetsRewrite> &Rewrites) {
   // Could possibly produce an error or warning if one of these was non-null but
   // the other was null.
   if (CurStrSection.empty() || CurStrOffsetSection.empty())
     return;
 
-  DenseMap<uint64_t, uint32_t> OffsetRemapping;
-
-  DataExtractor Data(CurStrSection, true, 0);
-  uint64_t LocalOffset = 0;
-  uint64_t PrevOffset = 0;
-  while (const char *s = Data.getCStr(&LocalOffset)) {
-    OffsetRemapping[PrevOffset] =
-        Strings.getOffset(s, LocalOffset - PrevOffset);
-    PrevOffset = LocalOffset;
-  }
-
-  Data = DataExtractor(CurStrOffsetSection, true, 0);
+  StrOffsetsRewrite Rewrite;
+  Rewrite.StrOffsets = CurStrOffsetSection;
+  Rewrite.Strings = &CurStrings;
+  Rewrite.NewOffsets.reserve(CurStrings.size());
+  for (const auto &Str : CurStrings)
+    Rewrite.NewOffsets.push_back(Strings.getOffset(Str.second));
+  Rewrite.Out = StrOffsetSection.appendBuffer(CurStrOffsetSection.size());
+  Rewrites.push_back(std::move(Rewrite));
+}
 
-  Out.SwitchSection(StrOffsetSection);
+static void rewriteStrOffsets(const StrOffsetsRewrite &Rewrite) {
+  DataExtractor Data(Rewrite.StrOffsets, true, 0);
+  const StringList &Strings = *Rewrite.Strings;
+  char *Out = Rewrite.Out.data();
 
   uint64_t Offset = 0;
-  uint64_t Size = CurStrOffsetSection.size();
-  while (Offset < Size) {
-    auto OldOffset = Data.getU32(&Offset);
-    auto NewOffset = OffsetRemapping[OldOffset];
-    Out.emitIntValue(NewOffset, 4);
+  uint64_t Size = Rewrite.StrOffsets.size();
+  while (Offset + 4 <= Size) {
+    uint64_t OldOffset = Data.getU32(&Offset);
+    auto It = partition_point(Strings, [&](const auto &Str) {
+      return Str.first < OldOffset;
+    });
+    uint32_t NewOffset = 0;
+    if (It != Strings.end() && It->first == OldOffset)
+      NewOffset = Rewrite.NewOffsets[It - Strings.begin()];
+    support::endian::write32le(Out, NewOffset);
+    Out += 4;
   }
 }
 
@@ -245,10 +290,9 @@ static StringRef getSubsection(StringRef Section,
 }
 
 static void addAllTypesFromDWP(
-    MCStreamer &Out, MapVector<uint64_t, UnitIndexEntry> &TypeIndexEntries,
-    const DWARFUnitIndex &TUIndex, MCSection *OutputTypes, StringRef Types,
+    MapVector<uint64_t, UnitIndexEntry> &TypeIndexEntries,
+    const DWARFUnitIndex &TUIndex, DWPSection &OutputTypes, StringRef Types,
     const UnitIndexEntry &TUEntry, uint32_t &TypesOffset) {
-  Out.SwitchSection(OutputTypes);
   for (const DWARFUnitIndex::Entry &E : TUIndex.getRows()) {
     auto *I = E.getContributions();
     if (!I)
@@ -269,20 +313,18 @@ static void addAllTypesFromDWP(
     }
     unsigned TypesIndex = getContributionIndex(DW_SECT_EXT_TYPES);
     auto &C = Entry.Contributions[TypesIndex];
-    Out.emitBytes(Types.substr(
+    OutputTypes.append(Types.substr(
         C.Offset - TUEntry.Contributions[TypesIndex].Offset, C.Length));
     C.Offset = TypesOffset;
     TypesOffset += C.Length;
   }
 }
 
-static void addAllTypes(MCStreamer &Out,
-                        MapVector<uint64_t, UnitIndexEntry> &TypeIndexEntries,
-                        MCSection *OutputTypes,
+static void addAllTypes(MapVector<uint64_t, UnitIndexEntry> &TypeIndexEntries,
+                        DWPSection &OutputTypes,
                         const std::vector<StringRef> &TypesSections,
                         const UnitIndexEntry &CUEntry, uint32_t &TypesOffset) {
   for (StringRef Types : TypesSections) {
-    Out.SwitchSection(OutputTypes);
     uint64_t Offset = 0;
     DataExtractor Data(Types, true, 0);
     while (Data.isValidOffset(Offset)) {
@@ -305,25 +347,25 @@ static void addAllTypes(MCStreamer &Out,
       if (!P.second)
         continue;
 
-      Out.emitBytes(Types.substr(PrevOffset, C.Length));
+      OutputTypes.append(Types.substr(PrevOffset, C.Length));
       TypesOffset += C.Length;
     }
   }
 }
 
 static void
-writeIndexTable(MCStreamer &Out, ArrayRef<unsigned> ContributionOffsets,
+writeIndexTable(support::endian::Writer &Out,
+                ArrayRef<unsigned> ContributionOffsets,
                 const MapVector<uint64_t, UnitIndexEntry> &IndexEntries,
                 uint32_t DWARFUnitIndex::Entry::SectionContribution::*Field) {
   for (const auto &E : IndexEntries)
     for (size_t i = 0; i != array_lengthof(E.second.Contributions); ++i)
       if (ContributionOffsets[i])
-        Out.emitIntValue(E.second.Contributions[i].*Field, 4);
+        Out.write<uint32_t>(E.second.Contributions[i].*Field);
 }
 
 static void
-writeIndex(MCStreamer &Out, MCSection *Section,
-           ArrayRef<unsigned> ContributionOffsets,
+writeIndex(DWPSection &Section, ArrayRef<unsigned> ContributionOffsets,
            const MapVector<uint64_t, UnitIndexEntry> &IndexEntries) {
   if (IndexEntries.empty())
     return;
@@ -349,24 +391,26 @@ writeIndex(MCStreamer &Out, MCSection *Section,
     ++i;
   }
 
-  Out.SwitchSection(Section);
-  Out.emitIntValue(2, 4);                   // Version
-  Out.emitIntValue(Columns, 4);             // Columns
-  Out.emitIntValue(IndexEntries.size(), 4); // Num Units
-  Out.emitIntValue(Buckets.size(), 4);      // Num Buckets
+  std::string Index;
+  raw_string_ostream OS(Index);
+  support::endian::Writer Out(OS, support::little);
+  Out.write<uint32_t>(2);                   // Version
+  Out.write<uint32_t>(Columns);             // Columns
+  Out.write<uint32_t>(IndexEntries.size()); // Num Units
+  Out.write<uint32_t>(Buckets.size());      // Num Buckets
 
   // Write the signatures.
   for (const auto &I : Buckets)
-    Out.emitIntValue(I ? IndexEntries.begin()[I - 1].first : 0, 8);
+    Out.write<uint64_t>(I ? IndexEntries.begin()[I - 1].first : 0);
 
   // Write the indexes.
   for (const auto &I : Buckets)
-    Out.emitIntValue(I, 4);
+    Out.write<uint32_t>(I);
 
   // Write the column headers (which sections will appear in the table)
   for (size_t i = 0; i != ContributionOffsets.size(); ++i)
     if (ContributionOffsets[i])
-      Out.emitIntValue(getOnDiskSectionId(i), 4);
+      Out.write<uint32_t>(getOnDiskSectionId(i));
 
   // Write the offsets.
   writeIndexTable(Out, ContributionOffsets, IndexEntries,
@@ -375,6 +419,10 @@ writeIndex(MCStreamer &Out, MCSection *Section,
   // Write the lengths.
   writeIndexTable(Out, ContributionOffsets, IndexEntries,
                   &DWARFUnitIndex::Entry::SectionContribution::Length);
+
+  OS.flush();
+  MutableArrayRef<char> Buffer = Section.appendBuffer(Index.size());
+  std::copy(Index.begin(), Index.end(), Buffer.begin());
 }
 
 static std::string buildDWODescription(StringRef Name, StringRef DWPName,
@@ -423,17 +471,9 @@ handleCompressedSection(std::deque<SmallString<32>> &UncompressedSections,
   return Error::success();
 }
 
-static Error handleSection(
-    const StringMap<std::pair<MCSection *, DWARFSectionKind>> &KnownSections,
-    const MCSection *StrSection, const MCSection *StrOffsetSection,
-    const MCSection *TypesSection, const MCSection *CUIndexSection,
-    const MCSection *TUIndexSection, const SectionRef &Section, MCStreamer &Out,
-    std::deque<SmallString<32>> &UncompressedSections,
-    uint32_t (&ContributionOffsets)[8], UnitIndexEntry &CurEntry,
-    StringRef &CurStrSection, StringRef &CurStrOffsetSection,
-    std::vector<StringRef> &CurTypesSection, StringRef &InfoSection,
-    StringRef &AbbrevSection, StringRef &CurCUIndexSection,
-    StringRef &CurTUIndexSection) {
+static Error
+readSection(const StringMap<OutputSection> &KnownSections,
+            const SectionRef &Section, DWOInput &DWO) {
   if (Section.isBSS())
     return Error::success();
 
@@ -450,7 +490,8 @@ static Error handleSection(
     return ContentsOrErr.takeError();
   StringRef Contents = *ContentsOrErr;
 
-  if (auto Err = handleCompressedSection(UncompressedSections, Name, Contents))
+  if (auto Err =
+          handleCompressedSection(DWO.UncompressedSections, Name, Contents))
     return Err;
 
   Name = Name.substr(Name.find_first_not_of("._"));
@@ -459,7 +500,51 @@ static Error handleSection(
   if (SectionPair == KnownSections.end())
     return Error::success();
 
-  if (DWARFSectionKind Kind = SectionPair->second.second) {
+  DWO.Sections.emplace_back(SectionPair->second, Contents);
+  return Error::success();
+}
+
+/// Opens \p Input, reads the sections that go into the package and hashes the
+/// strings of its string section. This only looks at the input itself, so the
+/// inputs can be read in parallel.
+static Error readInput(const std::string &Input,
+                       const StringMap<OutputSection> &KnownSections,
+                       const DWPSection *StrSection, DWOInput &DWO) {
+  auto ErrOrObj = object::ObjectFile::createObjectFile(Input);
+  if (!ErrOrObj)
+    return ErrOrObj.takeError();
+  DWO.Obj = std::move(*ErrOrObj);
+
+  for (const auto &Section : DWO.Obj.getBinary()->sections())
+    if (auto Err = readSection(KnownSections, Section, DWO))
+      return Err;
+
+  for (const auto &Section : DWO.Sections) {
+    if (Section.first.first != StrSection)
+      continue;
+    DataExtractor Data(Section.second, true, 0);
+    uint64_t Offset = 0;
+    uint64_t PrevOffset = 0;
+    while (const char *S = Data.getCStr(&Offset)) {
+      DWO.Strings.emplace_back(
+          PrevOffset,
+          CachedHashStringRef(StringRef(S, Offset - PrevOffset - 1)));
+      PrevOffset = Offset;
+    }
+  }
+  return Error::success();
+}
+
+static void handleSection(
+    const DWPSection *StrSection, const DWPSection *StrOffsetSection,
+    const DWPSection *TypesSection, const DWPSection *CUIndexSection,
+    const DWPSection *TUIndexSection, const OutputSection &SectionPair,
+    StringRef Contents, uint32_t (&ContributionOffsets)[8],
+    UnitIndexEntry &CurEntry, StringRef &CurStrSection,
+    StringRef &CurStrOffsetSection, std::vector<StringRef> &CurTypesSection,
+    StringRef &InfoSection, StringRef &AbbrevSection,
+    StringRef &CurCUIndexSection, StringRef &CurTUIndexSection) {
+  if (DWARFSectionKind Kind = SectionPair.second) {
     auto Index = getContributionIndex(Kind);
     if (Kind != DW_SECT_EXT_TYPES) {
       CurEntry.Contributions[Index].Offset = ContributionOffsets[Index];
@@ -479,7 +564,7 @@ static Error handleSection(
     }
   }
 
-  MCSection *OutSection = SectionPair->second.first;
+  DWPSection *OutSection = SectionPair.first;
   if (OutSection == StrOffsetSection)
     CurStrOffsetSection = Contents;
   else if (OutSection == StrSection)
@@ -490,11 +575,8 @@ static Error handleSection(
     CurCUIndexSection = Contents;
   else if (OutSection == TUIndexSection)
     CurTUIndexSection = Contents;
-  else {
-    Out.SwitchSection(OutSection);
-    Out.emitBytes(Contents);
-  }
-  return Error::success();
+  else
+    OutSection->append(Contents);
 }
 
 static Error
@@ -536,21 +618,31 @@ getDWOFilenames(StringRef ExecFilename) {
   return std::move(DWOPaths);
 }
 
-static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
-  const auto &MCOFI = *Out.getContext().getObjectFileInfo();
-  MCSection *const StrSection = MCOFI.getDwarfStrDWOSection();
-  MCSection *const StrOffsetSection = MCOFI.getDwarfStrOffDWOSection();
-  MCSection *const TypesSection = MCOFI.getDwarfTypesDWOSection();
-  MCSection *const CUIndexSection = MCOFI.getDwarfCUIndexSection();
-  MCSection *const TUIndexSection = MCOFI.getDwarfTUIndexSection();
-  const StringMap<std::pair<MCSection *, DWARFSectionKind>> KnownSections = {
-      {"debug_info.dwo", {MCOFI.getDwarfInfoDWOSection(), DW_SECT_INFO}},
-      {"debug_types.dwo", {MCOFI.getDwarfTypesDWOSection(), DW_SECT_EXT_TYPES}},
+static Error write(raw_ostream &OS, ArrayRef<std::string> Inputs) {
+  DWPSection InfoDWO(".debug_info.dwo", ELF::SHF_EXCLUDE);
+  DWPSection TypesDWO(".debug_types.dwo", ELF::SHF_EXCLUDE);
+  DWPSection StrOffsetsDWO(".debug_str_offsets.dwo", ELF::SHF_EXCLUDE);
+  DWPSection StrDWO(".debug_str.dwo",
+                    ELF::SHF_MERGE | ELF::SHF_STRINGS | ELF::SHF_EXCLUDE, 1);
+  DWPSection LocDWO(".debug_loc.dwo", ELF::SHF_EXCLUDE);
+  DWPSection LineDWO(".debug_line.dwo", ELF::SHF_EXCLUDE);
+  DWPSection AbbrevDWO(".debug_abbrev.dwo", ELF::SHF_EXCLUDE);
+  DWPSection CUIndex(".debug_cu_index", 0);
+  DWPSection TUIndex(".debug_tu_index", 0);
+
+  DWPSection *const StrSection = &StrDWO;
+  DWPSection *const StrOffsetSection = &StrOffsetsDWO;
+  DWPSection *const TypesSection = &TypesDWO;
+  DWPSection *const CUIndexSection = &CUIndex;
+  DWPSection *const TUIndexSection = &TUIndex;
+  const StringMap<OutputSection> KnownSections = {
+      {"debug_info.dwo", {&InfoDWO, DW_SECT_INFO}},
+      {"debug_types.dwo", {TypesSection, DW_SECT_EXT_TYPES}},
       {"debug_str_offsets.dwo", {StrOffsetSection, DW_SECT_STR_OFFSETS}},
       {"debug_str.dwo", {StrSection, static_cast<DWARFSectionKind>(0)}},
-      {"debug_loc.dwo", {MCOFI.getDwarfLocDWOSection(), DW_SECT_EXT_LOC}},
-      {"debug_line.dwo", {MCOFI.getDwarfLineDWOSection(), DW_SECT_LINE}},
-      {"debug_abbrev.dwo", {MCOFI.getDwarfAbbrevDWOSection(), DW_SECT_ABBREV}},
+      {"debug_loc.dwo", {&LocDWO, DW_SECT_EXT_LOC}},
+      {"debug_line.dwo", {&LineDWO, DW_SECT_LINE}},
+      {"debug_abbrev.dwo", {&AbbrevDWO, DW_SECT_ABBREV}},
       {"debug_cu_index", {CUIndexSection, static_cast<DWARFSectionKind>(0)}},
       {"debug_tu_index", {TUIndexSection, static_cast<DWARFSectionKind>(0)}}};
 
@@ -559,20 +651,34 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
 
   uint32_t ContributionOffsets[8] = {};
 
-  DWPStringPool Strings(Out, StrSection);
+  DWPStringPool Strings(*StrSection);
 
-  SmallVector<OwningBinary<object::ObjectFile>, 128> Objects;
-  Objects.reserve(Inputs.size());
+  ThreadPool Pool(hardware_concurrency(NumThreads));
 
-  std::deque<SmallString<32>> UncompressedSections;
+  // Open and scan the inputs in parallel. Their contributions are then merged
+  // in input order, so that the package doesn't depend on the thread count.
+  std::vector<DWOInput> DWOs(Inputs.size());
+  auto ConsumeErrors = make_scope_exit([&] {
+    for (DWOInput &DWO : DWOs)
+      if (DWO.Err)
+        consumeError(std::move(*DWO.Err));
+  });
+  for (size_t I = 0; I != Inputs.size(); ++I)
+    Pool.async([&, I] {
+      DWOs[I].Err.emplace(
+          readInput(Inputs[I], KnownSections, StrSection, DWOs[I]));
+    });
+  Pool.wait();
+
+  std::vector<StrOffsetsRewrite> StrOffsetsRewrites;
 
-  for (const auto &Input : Inputs) {
-    auto ErrOrObj = object::ObjectFile::createObjectFile(Input);
-    if (!ErrOrObj)
-      return ErrOrObj.takeError();
+  for (size_t InputIndex = 0; InputIndex != Inputs.size(); ++InputIndex) {
+    const std::string &Input = Inputs[InputIndex];
+    DWOInput &DWO = DWOs[InputIndex];
+    if (Error Err = std::move(*DWO.Err))
+      return Err;
 
-    auto &Obj = *ErrOrObj->getBinary();
-    Objects.push_back(std::move(*ErrOrObj));
+    auto &Obj = *DWO.Obj.getBinary();
 
     UnitIndexEntry CurEntry = {};
 
@@ -584,20 +690,19 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
     StringRef CurCUIndexSection;
     StringRef CurTUIndexSection;
 
-    for (const auto &Section : Obj.sections())
-      if (auto Err = handleSection(
-              KnownSections, StrSection, StrOffsetSection, TypesSection,
-              CUIndexSection, TUIndexSection, Section, Out,
-              UncompressedSections, ContributionOffsets, CurEntry,
-              CurStrSection, CurStrOffsetSection, CurTypesSection, InfoSection,
-              AbbrevSection, CurCUIndexSection, CurTUIndexSection))
-        return Err;
+    for (const auto &Section : DWO.Sections)
+      handleSection(StrSection, StrOffsetSection, TypesSection, CUIndexSection,
+                    TUIndexSection, Section.first, Section.second,
+                    ContributionOffsets, CurEntry, CurStrSection,
+                    CurStrOffsetSection, CurTypesSection, InfoSection,
+                    AbbrevSection, CurCUIndexSection, CurTUIndexSection);
 
     if (InfoSection.empty())
       continue;
 
-    writeStringsAndOffsets(Out, Strings, StrOffsetSection, CurStrSection,
-                           CurStrOffsetSection);
+    writeStringsAndOffsets(Strings, *StrOffsetSection, CurStrSection,
+                           CurStrOffsetSection, DWO.Strings,
+                           StrOffsetsRewrites);
 
     if (CurCUIndexSection.empty()) {
       Expected<CompileUnitIdentifiers> EID = getCUIdentifiers(
@@ -610,8 +715,7 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
         return buildDuplicateError(*P.first, ID, "");
       P.first->second.Name = ID.Name;
       P.first->second.DWOName = ID.DWOName;
-      addAllTypes(Out, TypeIndexEntries, TypesSection, CurTypesSection,
-                  CurEntry,
+      addAllTypes(TypeIndexEntries, *TypesSection, CurTypesSection, CurEntry,
                   ContributionOffsets[getContributionIndex(DW_SECT_EXT_TYPES)]);
       continue;
     }
@@ -667,26 +771,32 @@ static Error write(MCStreamer &Out, ArrayRef<std::string> Inputs) {
             " (only version 2 is supported)");
 
       addAllTypesFromDWP(
-          Out, TypeIndexEntries, TUIndex, TypesSection, CurTypesSection.front(),
+          TypeIndexEntries, TUIndex, *TypesSection, CurTypesSection.front(),
           CurEntry,
           ContributionOffsets[getContributionIndex(DW_SECT_EXT_TYPES)]);
     }
   }
 
+  // The string pool is complete, so the string offsets of all the inputs can
+  // be rewritten independently.
+  for (const StrOffsetsRewrite &Rewrite : StrOffsetsRewrites)
+    Pool.async([&Rewrite] { rewriteStrOffsets(Rewrite); });
+  Pool.wait();
+
   // Lie about there being no info contributions so the TU index only includes
   // the type unit contribution
   ContributionOffsets[0] = 0;
-  writeIndex(Out, MCOFI.getDwarfTUIndexSection(), ContributionOffsets,
-             TypeIndexEntries);
+  writeIndex(*TUIndexSection, ContributionOffsets, TypeIndexEntries);
 
   // Lie about the type contribution
   ContributionOffsets[getContributionIndex(DW_SECT_EXT_TYPES)] = 0;
   // Unlie about the info contribution
   ContributionOffsets[0] = 1;
 
-  writeIndex(Out, MCOFI.getDwarfCUIndexSection(), ContributionOffsets,
-             IndexEntries);
+  writeIndex(*CUIndexSection, ContributionOffsets, IndexEntries);
 
+  writeDWP(OS, {&InfoDWO, &TypesDWO, &StrOffsetsDWO, &StrDWO, &LocDWO,
+                &LineDWO, &AbbrevDWO, &CUIndex, &TUIndex});
   return Error::success();
 }
 
@@ -701,77 +811,12 @@ int main(int argc, char **argv) {
 
   cl::ParseCommandLineOptions(argc, argv, "merge split dwarf (.dwo) files\n");
 
-  llvm::InitializeAllTargetInfos();
-  llvm::InitializeAllTargetMCs();
-  llvm::InitializeAllTargets();
-  llvm::InitializeAllAsmPrinters();
-
-  std::string ErrorStr;
-  StringRef Context = "dwarf streamer init";
-
-  Triple TheTriple("x86_64-linux-gnu");
-
-  // Get the target.
-  const Target *TheTarget =
-      TargetRegistry::lookupTarget("", TheTriple, ErrorStr);
-  if (!TheTarget)
-    return error(ErrorStr, Context);
-  std::string TripleName = TheTriple.getTriple();
-
-  // Create all the MC Objects.
-  std::unique_ptr<MCRegisterInfo> MRI(TheTarget->createMCRegInfo(TripleName));
-  if (!MRI)
-    return error(Twine("no register info for target ") + TripleName, Context);
-
-  MCTargetOptions MCOptions = llvm::mc::InitMCTargetOptionsFromFlags();
-  std::unique_ptr<MCAsmInfo> MAI(
-      TheTarget->createMCAsmInfo(*MRI, TripleName, MCOptions));
-  if (!MAI)
-    return error("no asm info for target " + TripleName, Context);
-
-  MCObjectFileInfo MOFI;
-  MCContext MC(MAI.get(), MRI.get(), &MOFI);
-  MOFI.InitMCObjectFileInfo(TheTriple, /*PIC*/ false, MC);
-
-  std::unique_ptr<MCSubtargetInfo> MSTI(
-      TheTarget->createMCSubtargetInfo(TripleName, "", ""));
-  if (!MSTI)
-    return error("no subtarget info for target " + TripleName, Context);
-
-  MCTargetOptions Options;
-  auto MAB = TheTarget->createMCAsmBackend(*MSTI, *MRI, Options);
-  if (!MAB)
-    return error("no asm backend for target " + TripleName, Context);
-
-  std::unique_ptr<MCInstrInfo> MII(TheTarget->createMCInstrInfo());
-  if (!MII)
-    return error("no instr info info for target " + TripleName, Context);
-
-  MCCodeEmitter *MCE = TheTarget->createMCCodeEmitter(*MII, *MRI, MC);
-  if (!MCE)
-    return error("no code emitter for target " + TripleName, Context);
-
   // Create the output file.
   std::error_code EC;
   ToolOutputFile OutFile(OutputFilename, EC, sys::fs::OF_None);
-  Optional<buffer_ostream> BOS;
-  raw_pwrite_stream *OS;
   if (EC)
-    return error(Twine(OutputFilename) + ": " + EC.message(), Context);
-  if (OutFile.os().supportsSeeking()) {
-    OS = &OutFile.os();
-  } else {
-    BOS.emplace(OutFile.os());
-    OS = BOS.getPointer();
-  }
-
-  std::unique_ptr<MCStreamer> MS(TheTarget->createMCObjectStreamer(
-      TheTriple, MC, std::unique_ptr<MCAsmBackend>(MAB),
-      MAB->createObjectWriter(*OS), std::unique_ptr<MCCodeEmitter>(MCE), *MSTI,
-      MCOptions.MCRelaxAll, MCOptions.MCIncrementalLinkerCompatible,
-      /*DWARFMustBeAtTheEnd*/ false));
-  if (!MS)
-    return error("no object streamer for target " + TripleName, Context);
+    return error(Twine(OutputFilename) + ": " + EC.message(),
+                 "output file init");
 
   std::vector<std::string> DWOFilenames = InputFiles;
   for (const auto &ExecFilename : ExecFilenames) {
@@ -785,12 +830,11 @@ int main(int argc, char **argv) {
                         std::make_move_iterator(DWOs->end()));
   }
 
-  if (auto Err = write(*MS, DWOFilenames)) {
+  if (auto Err = write(OutFile.os(), DWOFilenames)) {
     logAllUnhandledErrors(std::move(Err), WithColor::error());
     return 1;
   }
 
-  MS->Finish();
   OutFile.keep();
   return 0;
 }
@@ -12,6 +12,7 @@
 #include "llvm/MC/MCAsmInfo.h"
 #include "llvm/MC/MCTargetOptions.h"
 #include "llvm/Support/FormatVariadic.h"
+#include <cmath>
 #include <limits>
 #include <unordered_set>
 #include <vector>
@@ -547,34 +548,12 @@ Error Analysis::run<Analysis::PrintSchedClassInconsistencies>(
   for (const auto &RSCAndPoints : makePointsPerSchedClass()) {
     if (!RSCAndPoints.RSC.SCDesc)
       continue;
-    // Bucket sched class points into sched class clusters.
-    std::vector<SchedClassCluster> SchedClassClusters;
-    for (const size_t PointId : RSCAndPoints.PointIds) {
-      const auto &ClusterId = Clustering_.getClusterIdForPoint(PointId);
-      if (!ClusterId.isValid())
-        continue; // Ignore noise and errors. FIXME: take noise into account ?
-      if (ClusterId.isUnstable() ^ AnalysisDisplayUnstableOpcodes_)
-        continue; // Either display stable or unstable clusters only.
-      auto SchedClassClusterIt =
-          std::find_if(SchedClassClusters.begin(), SchedClassClusters.end(),
-                       [ClusterId](const SchedClassCluster &C) {
-                         return C.id() == ClusterId;
-                       });
-      if (SchedClassClusterIt == SchedClassClusters.end()) {
-        SchedClassClusters.emplace_back();
-        SchedClassClusterIt = std::prev(SchedClassClusters.end());
-      }
-      SchedClassClusterIt->addPoint(PointId, Clustering_);
-    }
+    const std::vector<SchedClassCluster> SchedClassClusters =
+        makeSchedClassClusters(RSCAndPoints);
 
     // Print any scheduling class that has at least one cluster that does not
     // match the checked-in data.
-    if (all_of(SchedClassClusters, [this,
-                                    &RSCAndPoints](const SchedClassCluster &C) {
-          return C.measurementsMatch(*SubtargetInfo_, RSCAndPoints.RSC,
-                                     Clustering_,
-                                     AnalysisInconsistencyEpsilonSquared_);
-        }))
+    if (allClustersMatch(SchedClassClusters, RSCAndPoints.RSC))
       continue; // Nothing weird.
 
     OS << "<div class=\"inconsistency\"><p>Sched Class <span "
@@ -599,5 +578,139 @@ Error Analysis::run<Analysis::PrintSchedClassInconsistencies>(
   return Error::success();
 }
 
+std::vector<Analysis::SchedClassCluster> Analysis::makeSchedClassClusters(
+    const ResolvedSchedClassAndPoints &RSCAndPoints) const {
+  std::vector<SchedClassCluster> SchedClassClusters;
+  for (const size_t PointId : RSCAndPoints.PointIds) {
+    const auto &ClusterId = Clustering_.getClusterIdForPoint(PointId);
+    if (!ClusterId.isValid())
+      continue; // Ignore noise and errors. FIXME: take noise into account ?
+    if (ClusterId.isUnstable() ^ AnalysisDisplayUnstableOpcodes_)
+      continue; // Either display stable or unstable clusters only.
+    auto SchedClassClusterIt =
+        std::find_if(SchedClassClusters.begin(), SchedClassClusters.end(),
+                     [ClusterId](const SchedClassCluster &C) {
+                       return C.id() == ClusterId;
+                     });
+    if (SchedClassClusterIt == SchedClassClusters.end()) {
+      SchedClassClusters.emplace_back();
+      SchedClassClusterIt = std::prev(SchedClassClusters.end());
+    }
+    SchedClassClusterIt->addPoint(PointId, Clustering_);
+  }
+  return SchedClassClusters;
+}
+
+bool Analysis::allClustersMatch(const std::vector<SchedClassCluster> &Clusters,
+                                const ResolvedSchedClass &RSC) const {
+  return all_of(Clusters, [this, &RSC](const SchedClassCluster &C) {
+    return C.measurementsMatch(*SubtargetInfo_, RSC, Clustering_,
+                               AnalysisInconsistencyEpsilonSquared_);
+  });
+}
+
+// Prints a SchedWriteRes that keeps the resources of the sched class but
+// takes the measured latency or number of uops, and an InstRW that maps the
+// opcodes of the cluster to it.
+void Analysis::printSchedClassCorrection(const SchedClassCluster &Cluster,
+                                         const ResolvedSchedClass &RSC,
+                                         unsigned CorrectionId,
+                                         raw_ostream &OS) const {
+  const auto &Points = Clustering_.getPoints();
+  const auto &SM = SubtargetInfo_->getSchedModel();
+  const InstructionBenchmark::ModeE Mode = Points[0].Mode;
+  const std::vector<BenchmarkMeasure> SchedClassPoint =
+      RSC.getAsPoint(Mode, *SubtargetInfo_, Cluster.getCentroid().getStats());
+
+  OS << "// Sched class ";
+#if !defined(NDEBUG) || defined(LLVM_ENABLE_DUMP)
+  OS << RSC.SCDesc->Name;
+#else
+  OS << RSC.SchedClassId;
+#endif
+  OS << ", cluster ";
+  writeClusterId<kEscapeCsv>(OS, Cluster.id());
+  OS << ":\n";
+  Optional<unsigned> Latency;
+  Optional<unsigned> NumMicroOps;
+  for (size_t I = 0, E = Cluster.getCentroid().getStats().size(); I < E; ++I) {
+    const PerInstructionStats &Stats = Cluster.getCentroid().getStats()[I];
+    OS << "//   " << Stats.key() << ": measured ";
+    writeMeasurementValue<kEscapeCsv>(OS, Stats.avg());
+    OS << " [";
+    writeMeasurementValue<kEscapeCsv>(OS, Stats.min());
+    OS << ";";
+    writeMeasurementValue<kEscapeCsv>(OS, Stats.max());
+    OS << "]";
+    if (I < SchedClassPoint.size()) {
+      OS << ", model ";
+      writeMeasurementValue<kEscapeCsv>(OS,
+                                        SchedClassPoint[I].PerInstructionValue);
+    }
+    OS << "\n";
+    if (Mode == InstructionBenchmark::Latency)
+      Latency = static_cast<unsigned>(std::lround(Stats.avg()));
+    else if (Mode == InstructionBenchmark::Uops && Stats.key() == "NumMicroOps")
+      NumMicroOps = static_cast<unsigned>(std::lround(Stats.avg()));
+  }
+  if (!Latency && !NumMicroOps) {
+    OS << "// Resource cycles have to be adjusted by hand.\n\n";
+    return;
+  }
+
+  OS << "def ExegesisWrite" << CorrectionId << " : SchedWriteRes<[";
+  std::vector<StringRef> ProcResNames;
+  std::vector<std::string> ProcResCycles;
+  for (const MCWriteProcResEntry &WPR : RSC.NonRedundantWriteProcRes) {
+    ProcResNames.push_back(SM.getProcResource(WPR.ProcResourceIdx)->Name);
+    ProcResCycles.push_back(std::to_string(WPR.Cycles));
+  }
+  OS << join(ProcResNames, ", ") << "]> {\n";
+  unsigned ModelLatency = 0;
+  for (unsigned I = 0; I < RSC.SCDesc->NumWriteLatencyEntries; ++I)
+    ModelLatency = std::max<unsigned>(
+        ModelLatency,
+        SubtargetInfo_->getWriteLatencyEntry(RSC.SCDesc, I)->Cycles);
+  OS << "  let Latency = " << Latency.getValueOr(ModelLatency) << ";\n";
+  OS << "  let NumMicroOps = "
+     << NumMicroOps.getValueOr(RSC.SCDesc->NumMicroOps) << ";\n";
+  OS << "  let ResourceCycles = [" << join(ProcResCycles, ", ") << "];\n}\n";
+
+  // Several configurations of an opcode may be in the cluster.
+  std::vector<StringRef> Opcodes;
+  for (const size_t PointId : Cluster.getPointIds())
+    Opcodes.push_back(
+        InstrInfo_->getName(Points[PointId].keyInstruction().getOpcode()));
+  llvm::sort(Opcodes);
+  Opcodes.erase(std::unique(Opcodes.begin(), Opcodes.end()), Opcodes.end());
+  OS << "def : InstRW<[ExegesisWrite" << CorrectionId << "], (instrs "
+     << join(Opcodes, ", ") << ")>;\n\n";
+}
+
+template <>
+Error Analysis::run<Analysis::PrintSchedClassCorrections>(
+    raw_ostream &OS) const {
+  const auto &FirstPoint = Clustering_.getPoints()[0];
+  OS << "// llvm-exegesis proposed scheduling model corrections.\n";
+  OS << "// Triple: " << FirstPoint.LLVMTriple << "\n";
+  OS << "// Cpu: " << FirstPoint.CpuName << "\n\n";
+
+  unsigned NumCorrections = 0;
+  for (const auto &RSCAndPoints : makePointsPerSchedClass()) {
+    if (!RSCAndPoints.RSC.SCDesc)
+      continue;
+    for (const SchedClassCluster &Cluster :
+         makeSchedClassClusters(RSCAndPoints)) {
+      if (Cluster.measurementsMatch(*SubtargetInfo_, RSCAndPoints.RSC,
+                                    Clustering_,
+                                    AnalysisInconsistencyEpsilonSquared_))
+        continue;
+      printSchedClassCorrection(Cluster, RSCAndPoints.RSC, NumCorrections++,
+                                OS);
+    }
+  }
+  return Error::success();
+}
+
 } // namespace exegesis
 } // namespace llvm
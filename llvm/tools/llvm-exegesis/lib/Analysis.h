@@ -45,6 +45,9 @@ public:
   struct PrintClusters {};
   // Find potential errors in the scheduling information given measurements.
   struct PrintSchedClassInconsistencies {};
+  // Proposes TableGen overrides for the sched classes whose measurements do
+  // not match the scheduling information.
+  struct PrintSchedClassCorrections {};
 
   template <typename Pass> Error run(raw_ostream &OS) const;
 
@@ -106,6 +109,19 @@ private:
   // Builds a list of ResolvedSchedClassAndPoints.
   std::vector<ResolvedSchedClassAndPoints> makePointsPerSchedClass() const;
 
+  // Buckets the points of a sched class into sched class clusters, ignoring
+  // noise and errors, and either stable or unstable clusters.
+  std::vector<SchedClassCluster>
+  makeSchedClassClusters(const ResolvedSchedClassAndPoints &RSCAndPoints) const;
+
+  // Returns true if all the clusters match the sched class.
+  bool allClustersMatch(const std::vector<SchedClassCluster> &Clusters,
+                        const ResolvedSchedClass &RSC) const;
+
+  void printSchedClassCorrection(const SchedClassCluster &Cluster,
+                                 const ResolvedSchedClass &RSC,
+                                 unsigned CorrectionId, raw_ostream &OS) const;
+
   template <typename EscapeTag, EscapeTag Tag>
   void writeSnippet(raw_ostream &OS, ArrayRef<uint8_t> Bytes,
                     const char *Separator) const;
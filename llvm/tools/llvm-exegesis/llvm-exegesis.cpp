@@ -34,11 +34,15 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
 #include <algorithm>
 #include <string>
+#if defined(__linux__)
+#include <sched.h>
+#endif
 
 namespace llvm {
 namespace exegesis {
@@ -126,6 +130,23 @@ static cl::opt<bool> IgnoreInvalidSchedClass(
     cl::desc("ignore instructions that do not define a sched class"),
     cl::cat(BenchmarkOptions), cl::init(false));
 
+static cl::opt<unsigned> SweepJobs(
+    "sweep-jobs",
+    cl::desc("measure the opcodes in that many processes at once, each one "
+             "pinned to a core of its own"),
+    cl::cat(BenchmarkOptions), cl::init(1));
+
+static cl::list<unsigned>
+    SweepCpus("sweep-cpus",
+              cl::desc("comma-separated list of the cores to pin the "
+                       "-sweep-jobs processes to, 0 to N-1 by default"),
+              cl::CommaSeparated, cl::cat(BenchmarkOptions));
+
+// Set by a -sweep-jobs process for the processes that it starts.
+static cl::opt<int> SweepShard("sweep-shard", cl::Hidden, cl::init(-1));
+static cl::opt<std::string> SweepShardOutput("sweep-shard-output", cl::Hidden,
+                                             cl::init(""));
+
 static cl::opt<exegesis::InstructionBenchmarkClustering::ModeE>
     AnalysisClusteringAlgorithm(
         "analysis-clustering", cl::desc("the clustering algorithm to use"),
@@ -159,6 +180,11 @@ static cl::opt<std::string>
     AnalysisInconsistenciesOutputFile("analysis-inconsistencies-output-file",
                                       cl::desc(""), cl::cat(AnalysisOptions),
                                       cl::init(""));
+static cl::opt<std::string> AnalysisSchedCorrectionsOutputFile(
+    "analysis-sched-corrections-output-file",
+    cl::desc("write TableGen overrides for the sched classes whose "
+             "measurements do not match the scheduling model"),
+    cl::cat(AnalysisOptions), cl::init(""));
 
 static cl::opt<bool> AnalysisDisplayUnstableOpcodes(
     "analysis-display-unstable-clusters",
@@ -182,6 +208,9 @@ static cl::opt<bool>
 
 static ExitOnError ExitOnErr("llvm-exegesis error: ");
 
+// The command line, to start the -sweep-jobs processes with.
+static std::vector<StringRef> CommandLineArgs;
+
 // Helper function that logs the error(s) and exits.
 template <typename... ArgTs> static void ExitWithError(ArgTs &&... Args) {
   ExitOnErr(make_error<Failure>(std::forward<ArgTs>(Args)...));
@@ -244,6 +273,70 @@ static std::vector<unsigned> getOpcodesOrDie(const MCInstrInfo &MCInstrInfo) {
   return Result;
 }
 
+static void pinToCpu(unsigned Cpu) {
+#if defined(__linux__)
+  cpu_set_t CpuSet;
+  CPU_ZERO(&CpuSet);
+  CPU_SET(Cpu, &CpuSet);
+  if (sched_setaffinity(0, sizeof(CpuSet), &CpuSet))
+    ExitWithError(Twine("cannot pin to cpu ").concat(Twine(Cpu)));
+#else
+  ExitWithError("-sweep-jobs is only supported on Linux");
+#endif
+}
+
+// Returns the cpu that the process measuring shard `Shard` is pinned to.
+static unsigned getSweepCpu(unsigned Shard) {
+  if (SweepCpus.empty())
+    return Shard;
+  if (SweepCpus.size() < SweepJobs)
+    ExitWithError("-sweep-cpus must list at least -sweep-jobs cores");
+  return SweepCpus[Shard];
+}
+
+// Measures the opcodes in SweepJobs processes, each one pinned to a core and
+// measuring a contiguous shard of the opcodes, then writes their results in
+// shard order, as a single process would.
+static void runSweep() {
+  const std::string Executable = sys::fs::getMainExecutable(
+      CommandLineArgs[0].data(), reinterpret_cast<void *>(&runSweep));
+  std::vector<std::string> ShardFiles(SweepJobs);
+  std::vector<sys::ProcessInfo> Processes;
+  for (unsigned I = 0; I < SweepJobs; ++I) {
+    SmallString<128> ShardFile;
+    ExitOnErr(errorCodeToError(
+        sys::fs::createTemporaryFile("exegesis-shard", "yaml", ShardFile)));
+    ShardFiles[I] = std::string(ShardFile);
+    std::string ShardArg = "-sweep-shard=" + std::to_string(I);
+    std::string OutputArg = "-sweep-shard-output=" + ShardFiles[I];
+    std::vector<StringRef> Args(CommandLineArgs);
+    Args.push_back(ShardArg);
+    Args.push_back(OutputArg);
+    std::string ErrMsg;
+    Processes.push_back(sys::ExecuteNoWait(Executable, Args, None, {}, 0,
+                                           &ErrMsg));
+    if (!Processes.back().Pid)
+      ExitWithError(Twine("cannot start sweep process: ").concat(ErrMsg));
+  }
+
+  bool Failed = false;
+  for (sys::ProcessInfo &PI : Processes)
+    Failed |= sys::Wait(PI, 0, /*WaitUntilTerminates=*/true).ReturnCode != 0;
+
+  std::error_code EC;
+  raw_fd_ostream OS(BenchmarkFile, EC, sys::fs::OF_None);
+  if (EC)
+    ExitOnFileError(BenchmarkFile, errorCodeToError(EC));
+  for (const std::string &ShardFile : ShardFiles) {
+    auto BufferOrErr = MemoryBuffer::getFile(ShardFile);
+    if (BufferOrErr)
+      OS << (*BufferOrErr)->getBuffer();
+    sys::fs::remove(ShardFile);
+  }
+  if (Failed)
+    ExitWithError("a sweep process failed");
+}
+
 // Generates code snippets for opcode `Opcode`.
 static Expected<std::vector<BenchmarkCode>>
 generateSnippets(const LLVMState &State, unsigned Opcode,
@@ -307,7 +400,30 @@ void benchmarkMain() {
     ExitWithError("cannot create benchmark runner");
   }
 
-  const auto Opcodes = getOpcodesOrDie(State.getInstrInfo());
+  auto Opcodes = getOpcodesOrDie(State.getInstrInfo());
+
+  // Write to standard output if file is not set.
+  if (BenchmarkFile.empty())
+    BenchmarkFile = "-";
+
+  if (SweepJobs > 1) {
+    if (Opcodes.empty())
+      ExitWithError("-sweep-jobs needs 'opcode-index' or 'opcode-name'");
+    if (SweepShard < 0) {
+      runSweep();
+      return;
+    }
+    // Measure this process' shard of the opcodes.
+    const size_t ShardSize = divideCeil(Opcodes.size(), SweepJobs);
+    const size_t Begin = std::min(Opcodes.size(), SweepShard * ShardSize);
+    const size_t End = std::min(Opcodes.size(), Begin + ShardSize);
+    Opcodes = std::vector<unsigned>(Opcodes.begin() + Begin,
+                                    Opcodes.begin() + End);
+    BenchmarkFile = SweepShardOutput.getValue();
+    pinToCpu(getSweepCpu(SweepShard));
+    if (Opcodes.empty())
+      return;
+  }
 
   SmallVector<std::unique_ptr<const SnippetRepetitor>, 2> Repetitors;
   if (RepetitionMode != InstructionBenchmark::RepetitionModeE::AggregateMin)
@@ -357,10 +473,6 @@ void benchmarkMain() {
     ExitWithError("--num-repetitions must be greater than zero");
   }
 
-  // Write to standard output if file is not set.
-  if (BenchmarkFile.empty())
-    BenchmarkFile = "-";
-
   for (const BenchmarkCode &Conf : Configurations) {
     InstructionBenchmark Result = ExitOnErr(Runner->runConfiguration(
         Conf, NumRepetitions, Repetitors, DumpObjectToDisk));
@@ -395,10 +507,12 @@ static void analysisMain() {
     ExitWithError("--benchmarks-file must be set");
 
   if (AnalysisClustersOutputFile.empty() &&
-      AnalysisInconsistenciesOutputFile.empty()) {
+      AnalysisInconsistenciesOutputFile.empty() &&
+      AnalysisSchedCorrectionsOutputFile.empty()) {
     ExitWithError(
-        "for --mode=analysis: At least one of --analysis-clusters-output-file "
-        "and --analysis-inconsistencies-output-file must be specified");
+        "for --mode=analysis: At least one of --analysis-clusters-output-file, "
+        "--analysis-inconsistencies-output-file and "
+        "--analysis-sched-corrections-output-file must be specified");
   }
 
   InitializeNativeTarget();
@@ -442,6 +556,9 @@ static void analysisMain() {
   maybeRunAnalysis<Analysis::PrintSchedClassInconsistencies>(
       Analyzer, "sched class consistency analysis",
       AnalysisInconsistenciesOutputFile);
+  maybeRunAnalysis<Analysis::PrintSchedClassCorrections>(
+      Analyzer, "sched class corrections",
+      AnalysisSchedCorrectionsOutputFile);
 }
 
 } // namespace exegesis
@@ -450,6 +567,7 @@ static void analysisMain() {
 int main(int Argc, char **Argv) {
   using namespace llvm;
   cl::ParseCommandLineOptions(Argc, Argv, "");
+  exegesis::CommandLineArgs.assign(Argv, Argv + Argc);
 
   exegesis::ExitOnErr.setExitCodeMapper([](const Error &Err) {
     if (Err.isA<exegesis::ClusteringError>())
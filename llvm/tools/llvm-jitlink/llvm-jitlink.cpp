@@ -153,6 +153,13 @@ static cl::opt<std::string> OutOfProcessExecutorConnect(
     "oop-executor-connect",
     cl::desc("Connect to an out-of-process executor via TCP"));
 
+static cl::opt<std::string> OutOfProcessSharedMemorySizeString(
+    "oop-shared-memory",
+    cl::desc("Share a slab of the given size with the out-of-process executor "
+             "instead of copying code and data to it (executor must run on "
+             "the same host. allowable suffixes: Kb, Mb, Gb. default = Kb)"),
+    cl::init(""));
+
 ExitOnError ExitOnErr;
 
 namespace llvm {
@@ -723,6 +730,24 @@ LLVMJITLinkRemoteTargetProcessControl::ConnectToExecutor() {
 #endif
 }
 
+Error LLVMJITLinkRemoteTargetProcessControl::createMemoryManager() {
+  if (OutOfProcessSharedMemorySizeString.empty()) {
+    OwnedMemMgr = std::make_unique<LLVMJITLinkRemoteMemoryManager>(*this);
+    MemMgr = OwnedMemMgr.get();
+    return Error::success();
+  }
+
+  auto SlabSize = getSlabAllocSize(OutOfProcessSharedMemorySizeString);
+  if (!SlabSize)
+    return SlabSize.takeError();
+  auto SharedMemMgr = LLVMJITLinkSharedMemoryManager::Create(*this, *SlabSize);
+  if (!SharedMemMgr)
+    return SharedMemMgr.takeError();
+  OwnedMemMgr = std::move(*SharedMemMgr);
+  MemMgr = OwnedMemMgr.get();
+  return Error::success();
+}
+
 Error LLVMJITLinkRemoteTargetProcessControl::disconnect() {
   std::promise<MSVCPError> P;
   auto F = P.get_future();
@@ -1015,6 +1040,16 @@ static Error sanitizeArguments(const Triple &TT, const char *ArgV0) {
             OutOfProcessExecutorConnect.ArgStr + " can be specified",
         inconvertibleErrorCode());
 
+  // -oop-shared-memory requires an out-of-process executor.
+  if (!OutOfProcessSharedMemorySizeString.empty() &&
+      !OutOfProcessExecutor.getNumOccurrences() &&
+      !OutOfProcessExecutorConnect.getNumOccurrences())
+    return make_error<StringError>(
+        "-" + OutOfProcessSharedMemorySizeString.ArgStr + " requires -" +
+            OutOfProcessExecutor.ArgStr + " or -" +
+            OutOfProcessExecutorConnect.ArgStr,
+        inconvertibleErrorCode());
+
   // If -oop-executor was used but no value was specified then use a sensible
   // default.
   if (!!OutOfProcessExecutor.getNumOccurrences() &&
@@ -73,6 +73,9 @@ private:
   using LLVMJITLinkRemoteMemoryManager =
       orc::OrcRPCTPCJITLinkMemoryManager<LLVMJITLinkRemoteTargetProcessControl>;
 
+  using LLVMJITLinkSharedMemoryManager =
+      orc::OrcRPCTPCSharedMemoryManager<LLVMJITLinkRemoteTargetProcessControl>;
+
   LLVMJITLinkRemoteTargetProcessControl(
       std::shared_ptr<orc::SymbolStringPool> SSP,
       std::unique_ptr<LLVMJITLinkChannel> Channel,
@@ -98,10 +101,14 @@ private:
 
     OwnedMemAccess = std::make_unique<LLVMJITLinkRemoteMemoryAccess>(*this);
     MemAccess = OwnedMemAccess.get();
-    OwnedMemMgr = std::make_unique<LLVMJITLinkRemoteMemoryManager>(*this);
-    MemMgr = OwnedMemMgr.get();
+    if (auto Err2 = createMemoryManager()) {
+      Err = joinErrors(std::move(Err2), disconnect());
+      return;
+    }
   }
 
+  Error createMemoryManager();
+
   std::unique_ptr<LLVMJITLinkChannel> Channel;
   std::unique_ptr<LLVMJITLinkRPCEndpoint> Endpoint;
   std::unique_ptr<TargetProcessControl::MemoryAccess> OwnedMemAccess;
@@ -21,6 +21,7 @@
 #include "llvm/IR/DiagnosticPrinter.h"
 #include "llvm/LTO/Caching.h"
 #include "llvm/LTO/LTO.h"
+#include "llvm/LTO/LTOBackend.h"
 #include "llvm/Passes/PassPlugin.h"
 #include "llvm/Remarks/HotnessThresholdParser.h"
 #include "llvm/Support/CommandLine.h"
@@ -55,6 +56,12 @@ static cl::opt<std::string> OutputFilename("o", cl::Required,
 static cl::opt<std::string> CacheDir("cache-dir", cl::desc("Cache Directory"),
                                      cl::value_desc("directory"));
 
+static cl::opt<std::string>
+    RemoteCacheDir("remote-cache-dir",
+                   cl::desc("Shared cache directory used along with "
+                            "-cache-dir"),
+                   cl::value_desc("directory"));
+
 static cl::opt<std::string> OptPipeline("opt-pipeline",
                                         cl::desc("Optimizer Pipeline"),
                                         cl::value_desc("pipeline"));
@@ -71,6 +78,23 @@ static cl::opt<bool>
                                        "import files for the "
                                        "distributed backend case"));
 
+static cl::opt<std::string> ThinLTODistributor(
+    "thinlto-distributor",
+    cl::desc("Run ThinLTO backend jobs by invoking this program, e.g. "
+             "'llvm-lto2' with -thinlto-distributor-arg=run-backend"),
+    cl::value_desc("program"));
+
+static cl::list<std::string> ThinLTODistributorArgs(
+    "thinlto-distributor-arg",
+    cl::desc("Argument passed to the ThinLTO distributor ahead of the job"),
+    cl::ZeroOrMore);
+
+static cl::opt<std::string>
+    ThinLTOJobDir("thinlto-job-dir",
+                  cl::desc("Directory for ThinLTO distributor job files "
+                           "(default: a temporary directory)"),
+                  cl::value_desc("directory"));
+
 // Default to using all available threads in the system, but using only one
 // thread per core (no SMT).
 // Use -thinlto-threads=all to use hardware_concurrency() instead, which means
@@ -186,50 +210,11 @@ template <typename T> static T check(ErrorOr<T> E, std::string Msg) {
 }
 
 static int usage() {
-  errs() << "Available subcommands: dump-symtab run\n";
+  errs() << "Available subcommands: dump-symtab run run-backend\n";
   return 1;
 }
 
-static int run(int argc, char **argv) {
-  cl::ParseCommandLineOptions(argc, argv, "Resolution-based LTO test harness");
-
-  // FIXME: Workaround PR30396 which means that a symbol can appear
-  // more than once if it is defined in module-level assembly and
-  // has a GV declaration. We allow (file, symbol) pairs to have multiple
-  // resolutions and apply them in the order observed.
-  std::map<std::pair<std::string, std::string>, std::list<SymbolResolution>>
-      CommandLineResolutions;
-  for (std::string R : SymbolResolutions) {
-    StringRef Rest = R;
-    StringRef FileName, SymbolName;
-    std::tie(FileName, Rest) = Rest.split(',');
-    if (Rest.empty()) {
-      llvm::errs() << "invalid resolution: " << R << '\n';
-      return 1;
-    }
-    std::tie(SymbolName, Rest) = Rest.split(',');
-    SymbolResolution Res;
-    for (char C : Rest) {
-      if (C == 'p')
-        Res.Prevailing = true;
-      else if (C == 'l')
-        Res.FinalDefinitionInLinkageUnit = true;
-      else if (C == 'x')
-        Res.VisibleToRegularObj = true;
-      else if (C == 'r')
-        Res.LinkerRedefined = true;
-      else {
-        llvm::errs() << "invalid character " << C << " in resolution: " << R
-                     << '\n';
-        return 1;
-      }
-    }
-    CommandLineResolutions[{std::string(FileName), std::string(SymbolName)}]
-        .push_back(Res);
-  }
-
-  std::vector<std::unique_ptr<MemoryBuffer>> MBs;
-
+static Config createConfig() {
   Config Conf;
   Conf.DiagHandler = [](const DiagnosticInfo &DI) {
     DiagnosticPrinterRawOStream DP(errs());
@@ -286,7 +271,7 @@ static int run(int argc, char **argv) {
     break;
   default:
     llvm::errs() << "invalid cg optimization level: " << CGOptLevel << '\n';
-    return 1;
+    exit(1);
   }
 
   if (auto FT = codegen::getExplicitFileType())
@@ -297,6 +282,50 @@ static int run(int argc, char **argv) {
   Conf.StatsFile = StatsFile;
   Conf.PTO.LoopVectorization = Conf.OptLevel > 1;
   Conf.PTO.SLPVectorization = Conf.OptLevel > 1;
+  return Conf;
+}
+
+static int run(int argc, char **argv) {
+  cl::ParseCommandLineOptions(argc, argv, "Resolution-based LTO test harness");
+
+  // FIXME: Workaround PR30396 which means that a symbol can appear
+  // more than once if it is defined in module-level assembly and
+  // has a GV declaration. We allow (file, symbol) pairs to have multiple
+  // resolutions and apply them in the order observed.
+  std::map<std::pair<std::string, std::string>, std::list<SymbolResolution>>
+      CommandLineResolutions;
+  for (std::string R : SymbolResolutions) {
+    StringRef Rest = R;
+    StringRef FileName, SymbolName;
+    std::tie(FileName, Rest) = Rest.split(',');
+    if (Rest.empty()) {
+      llvm::errs() << "invalid resolution: " << R << '\n';
+      return 1;
+    }
+    std::tie(SymbolName, Rest) = Rest.split(',');
+    SymbolResolution Res;
+    for (char C : Rest) {
+      if (C == 'p')
+        Res.Prevailing = true;
+      else if (C == 'l')
+        Res.FinalDefinitionInLinkageUnit = true;
+      else if (C == 'x')
+        Res.VisibleToRegularObj = true;
+      else if (C == 'r')
+        Res.LinkerRedefined = true;
+      else {
+        llvm::errs() << "invalid character " << C << " in resolution: " << R
+                     << '\n';
+        return 1;
+      }
+    }
+    CommandLineResolutions[{std::string(FileName), std::string(SymbolName)}]
+        .push_back(Res);
+  }
+
+  std::vector<std::unique_ptr<MemoryBuffer>> MBs;
+
+  Config Conf = createConfig();
 
   ThinBackend Backend;
   if (ThinLTODistributedIndexes)
@@ -305,6 +334,10 @@ static int run(int argc, char **argv) {
                                             /* ShouldEmitImportsFiles */ true,
                                             /* LinkedObjectsFile */ nullptr,
                                             /* OnWrite */ {});
+  else if (!ThinLTODistributor.empty())
+    Backend = createOutOfProcessThinBackend(
+        llvm::heavyweight_hardware_concurrency(Threads), ThinLTODistributor,
+        ThinLTODistributorArgs, ThinLTOJobDir);
   else
     Backend = createInProcessThinBackend(
         llvm::heavyweight_hardware_concurrency(Threads));
@@ -371,13 +404,34 @@ static int run(int argc, char **argv) {
   };
 
   NativeObjectCache Cache;
-  if (!CacheDir.empty())
-    Cache = check(localCache(CacheDir, AddBuffer), "failed to create cache");
+  if (!CacheDir.empty()) {
+    std::shared_ptr<RemoteCache> Remote;
+    if (!RemoteCacheDir.empty())
+      Remote = check(directoryRemoteCache(RemoteCacheDir),
+                     "failed to create remote cache");
+    Cache = check(localCache(CacheDir, AddBuffer, std::move(Remote)),
+                  "failed to create cache");
+  }
 
   check(Lto.run(AddStream, Cache), "LTO::run failed");
   return 0;
 }
 
+// Runs a single backend job written by the out-of-process ThinLTO backend, so
+// that llvm-lto2 can act as its own -thinlto-distributor.
+static int runBackend(int argc, char **argv) {
+  cl::ParseCommandLineOptions(argc, argv, "ThinLTO backend job runner");
+  if (InputFilenames.size() != 1) {
+    llvm::errs() << argv[0] << ": run-backend expects a single job file\n";
+    return 1;
+  }
+
+  Config Conf = createConfig();
+  check(runThinBackendJob(Conf, InputFilenames[0], OutputFilename),
+        "failed to run backend job " + InputFilenames[0]);
+  return 0;
+}
+
 static int dumpSymtab(int argc, char **argv) {
   for (StringRef F : make_range(argv + 1, argv + argc)) {
     std::unique_ptr<MemoryBuffer> MB =
@@ -477,5 +531,7 @@ int main(int argc, char **argv) {
     return dumpSymtab(argc - 1, argv + 1);
   if (Subcommand == "run")
     return run(argc - 1, argv + 1);
+  if (Subcommand == "run-backend")
+    return runBackend(argc - 1, argv + 1);
   return usage();
 }
@@ -186,6 +186,13 @@ static cl::opt<unsigned> StoreQueueSize("squeue",
                                         cl::desc("Size of the store queue"),
                                         cl::cat(ToolOptions), cl::init(0));
 
+static cl::list<std::string> CacheLevels(
+    "cache-level",
+    cl::desc("Model a data cache level that <rate> percent of the loads "
+             "reaching it miss, with every miss adding <latency> cycles to "
+             "the load. Repeat from the L1D outwards to model a hierarchy"),
+    cl::value_desc("rate:latency"), cl::ZeroOrMore, cl::cat(ToolOptions));
+
 static cl::opt<bool>
     PrintInstructionTables("instruction-tables",
                            cl::desc("Print instruction tables"),
@@ -439,6 +446,18 @@ int main(int argc, char **argv) {
   mca::PipelineOptions PO(MicroOpQueue, DecoderThroughput, DispatchWidth,
                           RegisterFileSize, LoadQueueSize, StoreQueueSize,
                           AssumeNoAlias, EnableBottleneckAnalysis);
+  for (StringRef Level : CacheLevels) {
+    StringRef Rate, Latency;
+    std::tie(Rate, Latency) = Level.split(':');
+    mca::CacheLevel CL;
+    if (Rate.getAsInteger(10, CL.MissRate) || CL.MissRate > 100 ||
+        Latency.getAsInteger(10, CL.MissLatency)) {
+      WithColor::error() << "invalid cache level '" << Level
+                         << "', expected <rate>:<latency>\n";
+      return 1;
+    }
+    PO.CacheLevels.push_back(CL);
+  }
 
   // Number each region in the sequence.
   unsigned RegionIdx = 0;
@@ -35,19 +35,22 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
+#include <atomic>
 #include <vector>
 
 using namespace llvm;
 using namespace object;
 
 namespace {
-enum OutputFormatTy { bsd, sysv, posix, darwin };
+enum OutputFormatTy { bsd, sysv, posix, darwin, jsonl };
 
 cl::OptionCategory NMCat("llvm-nm Options");
 
@@ -55,7 +58,9 @@ cl::opt<OutputFormatTy> OutputFormat(
     "format", cl::desc("Specify output format"),
     cl::values(clEnumVal(bsd, "BSD format"), clEnumVal(sysv, "System V format"),
                clEnumVal(posix, "POSIX.2 format"),
-               clEnumVal(darwin, "Darwin -m format")),
+               clEnumVal(darwin, "Darwin -m format"),
+               clEnumValN(jsonl, "json",
+                          "JSON, one object per line and object file")),
     cl::init(bsd), cl::cat(NMCat));
 cl::alias OutputFormat2("f", cl::desc("Alias for --format"),
                         cl::aliasopt(OutputFormat));
@@ -63,6 +68,20 @@ cl::alias OutputFormat2("f", cl::desc("Alias for --format"),
 cl::list<std::string> InputFilenames(cl::Positional, cl::desc("<input files>"),
                                      cl::ZeroOrMore);
 
+cl::opt<std::string>
+    FilesFrom("files-from",
+              cl::desc("Also read input file names from <file>, one per "
+                       "line, or from stdin if <file> is '-', and dump the "
+                       "inputs in parallel"),
+              cl::value_desc("file"), cl::cat(NMCat));
+
+cl::opt<unsigned>
+    Threads("threads",
+            cl::desc("Number of threads to dump the inputs with; 0 uses all "
+                     "the hardware threads. Implied by --files-from"),
+            cl::init(1), cl::cat(NMCat));
+cl::alias Threads2("j", cl::desc("Alias for --threads"), cl::aliasopt(Threads));
+
 cl::opt<bool> UndefinedOnly("undefined-only",
                             cl::desc("Show only undefined symbols"),
                             cl::cat(NMCat));
@@ -153,7 +172,7 @@ cl::opt<bool> PrintSize("print-size",
                         cl::cat(NMCat));
 cl::alias PrintSizeS("S", cl::desc("Alias for --print-size"),
                      cl::aliasopt(PrintSize), cl::Grouping);
-bool MachOPrintSizeWarning = false;
+std::atomic<bool> MachOPrintSizeWarning(false);
 
 cl::opt<bool> SizeSort("size-sort", cl::desc("Sort symbols by size"),
                        cl::cat(NMCat));
@@ -225,14 +244,28 @@ bool PrintAddress = true;
 
 bool MultipleFiles = false;
 
-bool HadError = false;
+std::atomic<bool> HadError(false);
 
 std::string ToolName;
 } // anonymous namespace
 
+// The streams that the output of the input being dumped goes to. When the
+// inputs are dumped in parallel, each one is written to buffers of its own,
+// which are then printed in input order.
+static LLVM_THREAD_LOCAL raw_ostream *CurrentOutStream = nullptr;
+static LLVM_THREAD_LOCAL raw_ostream *CurrentErrStream = nullptr;
+
+static raw_ostream &outStream() {
+  return CurrentOutStream ? *CurrentOutStream : outs();
+}
+
+static raw_ostream &errStream() {
+  return CurrentErrStream ? *CurrentErrStream : errs();
+}
+
 static void error(Twine Message, Twine Path = Twine()) {
   HadError = true;
-  WithColor::error(errs(), ToolName) << Path << ": " << Message << ".\n";
+  WithColor::error(errStream(), ToolName) << Path << ": " << Message << ".\n";
 }
 
 static bool error(std::error_code EC, Twine Path = Twine()) {
@@ -249,7 +282,7 @@ static bool error(std::error_code EC, Twine Path = Twine()) {
 static void error(llvm::Error E, StringRef FileName, const Archive::Child &C,
                   StringRef ArchitectureName = StringRef()) {
   HadError = true;
-  WithColor::error(errs(), ToolName) << FileName;
+  WithColor::error(errStream(), ToolName) << FileName;
 
   Expected<StringRef> NameOrErr = C.getName();
   // TODO: if we have a error getting the name then it would be nice to print
@@ -257,18 +290,18 @@ static void error(llvm::Error E, StringRef FileName, const Archive::Child &C,
   // archive instead of "???" as the name.
   if (!NameOrErr) {
     consumeError(NameOrErr.takeError());
-    errs() << "(" << "???" << ")";
+    errStream() << "(" << "???" << ")";
   } else
-    errs() << "(" << NameOrErr.get() << ")";
+    errStream() << "(" << NameOrErr.get() << ")";
 
   if (!ArchitectureName.empty())
-    errs() << " (for architecture " << ArchitectureName << ") ";
+    errStream() << " (for architecture " << ArchitectureName << ") ";
 
   std::string Buf;
   raw_string_ostream OS(Buf);
   logAllUnhandledErrors(std::move(E), OS);
   OS.flush();
-  errs() << " " << Buf << "\n";
+  errStream() << " " << Buf << "\n";
 }
 
 // This version of error() prints the file name and which architecture slice it
@@ -278,16 +311,16 @@ static void error(llvm::Error E, StringRef FileName, const Archive::Child &C,
 static void error(llvm::Error E, StringRef FileName,
                   StringRef ArchitectureName = StringRef()) {
   HadError = true;
-  WithColor::error(errs(), ToolName) << FileName;
+  WithColor::error(errStream(), ToolName) << FileName;
 
   if (!ArchitectureName.empty())
-    errs() << " (for architecture " << ArchitectureName << ") ";
+    errStream() << " (for architecture " << ArchitectureName << ") ";
 
   std::string Buf;
   raw_string_ostream OS(Buf);
   logAllUnhandledErrors(std::move(E), OS);
   OS.flush();
-  errs() << " " << Buf << "\n";
+  errStream() << " " << Buf << "\n";
 }
 
 namespace {
@@ -358,8 +391,8 @@ static char isSymbolList64Bit(SymbolicFile &Obj) {
   return cast<ELFObjectFileBase>(Obj).getBytesInAddress() == 8;
 }
 
-static StringRef CurrentFilename;
-static std::vector<NMSymbol> SymbolList;
+static thread_local StringRef CurrentFilename;
+static thread_local std::vector<NMSymbol> SymbolList;
 
 static char getSymbolNMTypeChar(IRObjectFile &Obj, basic_symbol_iterator I);
 
@@ -447,22 +480,22 @@ static void darwinPrintSymbol(SymbolicFile &Obj, const NMSymbol &S,
 
   // If we are printing Mach-O symbols in hex do that and return.
   if (FormatMachOasHex) {
-    outs() << format(printFormat, NValue) << ' '
+    outStream() << format(printFormat, NValue) << ' '
            << format("%02x %02x %04x %08x", NType, NSect, NDesc, NStrx) << ' '
            << S.Name;
     if ((NType & MachO::N_TYPE) == MachO::N_INDR) {
-      outs() << " (indirect for ";
-      outs() << format(printFormat, NValue) << ' ';
+      outStream() << " (indirect for ";
+      outStream() << format(printFormat, NValue) << ' ';
       StringRef IndirectName;
       if (S.Sym.getRawDataRefImpl().p) {
         if (MachO->getIndirectName(S.Sym.getRawDataRefImpl(), IndirectName))
-          outs() << "?)";
+          outStream() << "?)";
         else
-          outs() << IndirectName << ")";
+          outStream() << IndirectName << ")";
       } else
-        outs() << S.IndirectName << ")";
+        outStream() << S.IndirectName << ")";
     }
-    outs() << "\n";
+    outStream() << "\n";
     return;
   }
 
@@ -471,51 +504,51 @@ static void darwinPrintSymbol(SymbolicFile &Obj, const NMSymbol &S,
       strcpy(SymbolAddrStr, printBlanks);
     if (Obj.isIR() && (NType & MachO::N_TYPE) == MachO::N_TYPE)
       strcpy(SymbolAddrStr, printDashes);
-    outs() << SymbolAddrStr << ' ';
+    outStream() << SymbolAddrStr << ' ';
   }
 
   switch (NType & MachO::N_TYPE) {
   case MachO::N_UNDF:
     if (NValue != 0) {
-      outs() << "(common) ";
+      outStream() << "(common) ";
       if (MachO::GET_COMM_ALIGN(NDesc) != 0)
-        outs() << "(alignment 2^" << (int)MachO::GET_COMM_ALIGN(NDesc) << ") ";
+        outStream() << "(alignment 2^" << (int)MachO::GET_COMM_ALIGN(NDesc) << ") ";
     } else {
       if ((NType & MachO::N_TYPE) == MachO::N_PBUD)
-        outs() << "(prebound ";
+        outStream() << "(prebound ";
       else
-        outs() << "(";
+        outStream() << "(";
       if ((NDesc & MachO::REFERENCE_TYPE) ==
           MachO::REFERENCE_FLAG_UNDEFINED_LAZY)
-        outs() << "undefined [lazy bound]) ";
+        outStream() << "undefined [lazy bound]) ";
       else if ((NDesc & MachO::REFERENCE_TYPE) ==
                MachO::REFERENCE_FLAG_PRIVATE_UNDEFINED_LAZY)
-        outs() << "undefined [private lazy bound]) ";
+        outStream() << "undefined [private lazy bound]) ";
       else if ((NDesc & MachO::REFERENCE_TYPE) ==
                MachO::REFERENCE_FLAG_PRIVATE_UNDEFINED_NON_LAZY)
-        outs() << "undefined [private]) ";
+        outStream() << "undefined [private]) ";
       else
-        outs() << "undefined) ";
+        outStream() << "undefined) ";
     }
     break;
   case MachO::N_ABS:
-    outs() << "(absolute) ";
+    outStream() << "(absolute) ";
     break;
   case MachO::N_INDR:
-    outs() << "(indirect) ";
+    outStream() << "(indirect) ";
     break;
   case MachO::N_SECT: {
     if (Obj.isIR()) {
       // For llvm bitcode files print out a fake section name using the values
       // use 1, 2 and 3 for section numbers as set above.
       if (NSect == 1)
-        outs() << "(LTO,CODE) ";
+        outStream() << "(LTO,CODE) ";
       else if (NSect == 2)
-        outs() << "(LTO,DATA) ";
+        outStream() << "(LTO,DATA) ";
       else if (NSect == 3)
-        outs() << "(LTO,RODATA) ";
+        outStream() << "(LTO,RODATA) ";
       else
-        outs() << "(?,?) ";
+        outStream() << "(?,?) ";
       break;
     }
     section_iterator Sec = SectionRef();
@@ -524,12 +557,12 @@ static void darwinPrintSymbol(SymbolicFile &Obj, const NMSymbol &S,
           MachO->getSymbolSection(S.Sym.getRawDataRefImpl());
       if (!SecOrErr) {
         consumeError(SecOrErr.takeError());
-        outs() << "(?,?) ";
+        outStream() << "(?,?) ";
         break;
       }
       Sec = *SecOrErr;
       if (Sec == MachO->section_end()) {
-        outs() << "(?,?) ";
+        outStream() << "(?,?) ";
         break;
       }
     } else {
@@ -540,70 +573,70 @@ static void darwinPrintSymbol(SymbolicFile &Obj, const NMSymbol &S,
     if (Expected<StringRef> NameOrErr = MachO->getSectionName(Ref))
       SectionName = *NameOrErr;
     StringRef SegmentName = MachO->getSectionFinalSegmentName(Ref);
-    outs() << "(" << SegmentName << "," << SectionName << ") ";
+    outStream() << "(" << SegmentName << "," << SectionName << ") ";
     break;
   }
   default:
-    outs() << "(?) ";
+    outStream() << "(?) ";
     break;
   }
 
   if (NType & MachO::N_EXT) {
     if (NDesc & MachO::REFERENCED_DYNAMICALLY)
-      outs() << "[referenced dynamically] ";
+      outStream() << "[referenced dynamically] ";
     if (NType & MachO::N_PEXT) {
       if ((NDesc & MachO::N_WEAK_DEF) == MachO::N_WEAK_DEF)
-        outs() << "weak private external ";
+        outStream() << "weak private external ";
       else
-        outs() << "private external ";
+        outStream() << "private external ";
     } else {
       if ((NDesc & MachO::N_WEAK_REF) == MachO::N_WEAK_REF ||
           (NDesc & MachO::N_WEAK_DEF) == MachO::N_WEAK_DEF) {
         if ((NDesc & (MachO::N_WEAK_REF | MachO::N_WEAK_DEF)) ==
             (MachO::N_WEAK_REF | MachO::N_WEAK_DEF))
-          outs() << "weak external automatically hidden ";
+          outStream() << "weak external automatically hidden ";
         else
-          outs() << "weak external ";
+          outStream() << "weak external ";
       } else
-        outs() << "external ";
+        outStream() << "external ";
     }
   } else {
     if (NType & MachO::N_PEXT)
-      outs() << "non-external (was a private external) ";
+      outStream() << "non-external (was a private external) ";
     else
-      outs() << "non-external ";
+      outStream() << "non-external ";
   }
 
   if (Filetype == MachO::MH_OBJECT) {
     if (NDesc & MachO::N_NO_DEAD_STRIP)
-      outs() << "[no dead strip] ";
+      outStream() << "[no dead strip] ";
     if ((NType & MachO::N_TYPE) != MachO::N_UNDF &&
         NDesc & MachO::N_SYMBOL_RESOLVER)
-      outs() << "[symbol resolver] ";
+      outStream() << "[symbol resolver] ";
     if ((NType & MachO::N_TYPE) != MachO::N_UNDF && NDesc & MachO::N_ALT_ENTRY)
-      outs() << "[alt entry] ";
+      outStream() << "[alt entry] ";
     if ((NType & MachO::N_TYPE) != MachO::N_UNDF && NDesc & MachO::N_COLD_FUNC)
-      outs() << "[cold func] ";
+      outStream() << "[cold func] ";
   }
 
   if ((NDesc & MachO::N_ARM_THUMB_DEF) == MachO::N_ARM_THUMB_DEF)
-    outs() << "[Thumb] ";
+    outStream() << "[Thumb] ";
 
   if ((NType & MachO::N_TYPE) == MachO::N_INDR) {
-    outs() << S.Name << " (for ";
+    outStream() << S.Name << " (for ";
     StringRef IndirectName;
     if (MachO) {
       if (S.Sym.getRawDataRefImpl().p) {
         if (MachO->getIndirectName(S.Sym.getRawDataRefImpl(), IndirectName))
-          outs() << "?)";
+          outStream() << "?)";
         else
-          outs() << IndirectName << ")";
+          outStream() << IndirectName << ")";
       } else
-        outs() << S.IndirectName << ")";
+        outStream() << S.IndirectName << ")";
     } else
-      outs() << "?)";
+      outStream() << "?)";
   } else
-    outs() << S.Name;
+    outStream() << S.Name;
 
   if ((Flags & MachO::MH_TWOLEVEL) == MachO::MH_TWOLEVEL &&
       (((NType & MachO::N_TYPE) == MachO::N_UNDF && NValue == 0) ||
@@ -611,21 +644,21 @@ static void darwinPrintSymbol(SymbolicFile &Obj, const NMSymbol &S,
     uint32_t LibraryOrdinal = MachO::GET_LIBRARY_ORDINAL(NDesc);
     if (LibraryOrdinal != 0) {
       if (LibraryOrdinal == MachO::EXECUTABLE_ORDINAL)
-        outs() << " (from executable)";
+        outStream() << " (from executable)";
       else if (LibraryOrdinal == MachO::DYNAMIC_LOOKUP_ORDINAL)
-        outs() << " (dynamically looked up)";
+        outStream() << " (dynamically looked up)";
       else {
         StringRef LibraryName;
         if (!MachO ||
             MachO->getLibraryShortNameByIndex(LibraryOrdinal - 1, LibraryName))
-          outs() << " (from bad library ordinal " << LibraryOrdinal << ")";
+          outStream() << " (from bad library ordinal " << LibraryOrdinal << ")";
         else
-          outs() << " (from " << LibraryName << ")";
+          outStream() << " (from " << LibraryName << ")";
       }
     }
   }
 
-  outs() << "\n";
+  outStream() << "\n";
 }
 
 // Table that maps Darwin's Mach-O stab constants to strings to allow printing.
@@ -695,11 +728,11 @@ static void darwinPrintStab(MachOObjectFile *MachO, const NMSymbol &S) {
     NDesc = STE.n_desc;
   }
 
-  outs() << format(" %02x %04x ", NSect, NDesc);
+  outStream() << format(" %02x %04x ", NSect, NDesc);
   if (const char *stabString = getDarwinStabString(NType))
-    outs() << format("%5.5s", stabString);
+    outStream() << format("%5.5s", stabString);
   else
-    outs() << format("   %02x", NType);
+    outStream() << format("   %02x", NType);
 }
 
 static Optional<std::string> demangle(StringRef Name, bool StripUnderscore) {
@@ -709,15 +742,12 @@ static Optional<std::string> demangle(StringRef Name, bool StripUnderscore) {
   if (!Name.startswith("_Z"))
     return None;
 
-  int Status;
-  char *Undecorated =
-      itaniumDemangle(Name.str().c_str(), nullptr, nullptr, &Status);
-  if (Status != 0)
+  static ItaniumDemangleContext Demangler;
+  size_t Length;
+  const char *Undecorated = Demangler.demangle(Name.str().c_str(), &Length);
+  if (!Undecorated)
     return None;
-
-  std::string S(Undecorated);
-  free(Undecorated);
-  return S;
+  return std::string(Undecorated, Length);
 }
 
 static bool symbolIsDefined(const NMSymbol &Sym) {
@@ -747,6 +777,48 @@ static bool isSpecialSym(SymbolicFile &Obj, StringRef Name) {
   return !Name.empty() && Name[0] == '$';
 }
 
+static json::Value toJSONString(StringRef S) {
+  if (json::isUTF8(S))
+    return S;
+  return json::fixUTF8(S);
+}
+
+// Starts the JSON object for the symbols of an object file. PrintFileName is
+// always set for the JSON format, so ArchiveName and ArchitectureName are
+// filled in wherever they apply.
+static void beginJSONSymbolList(json::OStream &J, StringRef ArchiveName,
+                                StringRef ArchitectureName) {
+  J.objectBegin();
+  if (!ArchiveName.empty())
+    J.attribute("archive", toJSONString(ArchiveName));
+  J.attribute("file", toJSONString(CurrentFilename));
+  if (!ArchitectureName.empty())
+    J.attribute("arch", toJSONString(ArchitectureName));
+  J.attributeBegin("symbols");
+  J.arrayBegin();
+}
+
+static void endJSONSymbolList(json::OStream &J) {
+  J.arrayEnd();
+  J.attributeEnd();
+  J.objectEnd();
+  outStream() << '\n';
+}
+
+static void printJSONSymbol(json::OStream &J, SymbolicFile &Obj,
+                            const NMSymbol &S, StringRef Name) {
+  J.object([&] {
+    J.attribute("name", toJSONString(Name));
+    J.attribute("type", std::string(1, S.TypeChar));
+    if (symbolIsDefined(S) && !Obj.isIR()) {
+      // Addresses may not fit in the signed integers that JSON readers
+      // commonly use.
+      J.attribute("value", "0x" + utohexstr(S.Address));
+      J.attribute("size", int64_t(S.Size));
+    }
+  });
+}
+
 static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
                                    StringRef ArchiveName,
                                    StringRef ArchitectureName) {
@@ -770,16 +842,16 @@ static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
 
   if (!PrintFileName) {
     if (OutputFormat == posix && MultipleFiles && printName) {
-      outs() << '\n' << CurrentFilename << ":\n";
+      outStream() << '\n' << CurrentFilename << ":\n";
     } else if (OutputFormat == bsd && MultipleFiles && printName) {
-      outs() << "\n" << CurrentFilename << ":\n";
+      outStream() << "\n" << CurrentFilename << ":\n";
     } else if (OutputFormat == sysv) {
-      outs() << "\n\nSymbols from " << CurrentFilename << ":\n\n";
+      outStream() << "\n\nSymbols from " << CurrentFilename << ":\n\n";
       if (isSymbolList64Bit(Obj))
-        outs() << "Name                  Value           Class        Type"
+        outStream() << "Name                  Value           Class        Type"
                << "         Size             Line  Section\n";
       else
-        outs() << "Name                  Value   Class        Type"
+        outStream() << "Name                  Value   Class        Type"
                << "         Size     Line  Section\n";
     }
   }
@@ -813,6 +885,12 @@ static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
     }
   }
 
+  std::unique_ptr<json::OStream> J;
+  if (OutputFormat == jsonl) {
+    J = std::make_unique<json::OStream>(outStream());
+    beginJSONSymbolList(*J, ArchiveName, ArchitectureName);
+  }
+
   for (const NMSymbol &S : SymbolList) {
     uint32_t SymFlags;
     std::string Name = S.Name.str();
@@ -826,7 +904,7 @@ static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
       if (!SymFlagsOrErr) {
         // TODO: Test this error.
         error(SymFlagsOrErr.takeError(), Obj.getFileName());
-        return;
+        break;
       }
       SymFlags = *SymFlagsOrErr;
     } else
@@ -839,12 +917,16 @@ static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
         (!Global && ExternalOnly) || (Weak && NoWeakSymbols) ||
         (!SpecialSyms && isSpecialSym(Obj, Name)))
       continue;
+    if (J) {
+      printJSONSymbol(*J, Obj, S, Name);
+      continue;
+    }
     if (PrintFileName)
-      writeFileName(outs(), ArchiveName, ArchitectureName);
+      writeFileName(outStream(), ArchiveName, ArchitectureName);
     if ((JustSymbolName ||
          (UndefinedOnly && MachO && OutputFormat != darwin)) &&
         OutputFormat != posix) {
-      outs() << Name << "\n";
+      outStream() << Name << "\n";
       continue;
     }
 
@@ -883,36 +965,38 @@ static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
       darwinPrintSymbol(Obj, S, SymbolAddrStr, printBlanks, printDashes,
                         printFormat);
     } else if (OutputFormat == posix) {
-      outs() << Name << " " << S.TypeChar << " " << SymbolAddrStr << " "
+      outStream() << Name << " " << S.TypeChar << " " << SymbolAddrStr << " "
              << (MachO ? "0" : SymbolSizeStr) << "\n";
     } else if (OutputFormat == bsd || (OutputFormat == darwin && !MachO)) {
       if (PrintAddress)
-        outs() << SymbolAddrStr << ' ';
+        outStream() << SymbolAddrStr << ' ';
       if (PrintSize)
-        outs() << SymbolSizeStr << ' ';
-      outs() << S.TypeChar;
+        outStream() << SymbolSizeStr << ' ';
+      outStream() << S.TypeChar;
       if (S.TypeChar == '-' && MachO)
         darwinPrintStab(MachO, S);
-      outs() << " " << Name;
+      outStream() << " " << Name;
       if (S.TypeChar == 'I' && MachO) {
-        outs() << " (indirect for ";
+        outStream() << " (indirect for ";
         if (S.Sym.getRawDataRefImpl().p) {
           StringRef IndirectName;
           if (MachO->getIndirectName(S.Sym.getRawDataRefImpl(), IndirectName))
-            outs() << "?)";
+            outStream() << "?)";
           else
-            outs() << IndirectName << ")";
+            outStream() << IndirectName << ")";
         } else
-          outs() << S.IndirectName << ")";
+          outStream() << S.IndirectName << ")";
       }
-      outs() << "\n";
+      outStream() << "\n";
     } else if (OutputFormat == sysv) {
-      outs() << left_justify(Name, 20) << "|" << SymbolAddrStr << "|   "
+      outStream() << left_justify(Name, 20) << "|" << SymbolAddrStr << "|   "
              << S.TypeChar << "  |" << right_justify(S.TypeName, 18) << "|"
              << SymbolSizeStr << "|     |" << S.SectionName << "\n";
     }
   }
 
+  if (J)
+    endJSONSymbolList(*J);
   SymbolList.clear();
 }
 
@@ -1779,8 +1863,8 @@ static void dumpSymbolNamesFromObject(SymbolicFile &Obj, bool printName,
   CurrentFilename = Obj.getFileName();
 
   if (Symbols.empty() && SymbolList.empty()) {
-    writeFileName(errs(), ArchiveName, ArchitectureName);
-    errs() << "no symbols\n";
+    writeFileName(errStream(), ArchiveName, ArchitectureName);
+    errStream() << "no symbols\n";
   }
 
   sortAndPrintSymbolList(Obj, printName, ArchiveName, ArchitectureName);
@@ -1837,11 +1921,11 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
   Binary &Bin = *BinaryOrErr.get();
 
   if (Archive *A = dyn_cast<Archive>(&Bin)) {
-    if (ArchiveMap) {
+    if (ArchiveMap && OutputFormat != jsonl) {
       Archive::symbol_iterator I = A->symbol_begin();
       Archive::symbol_iterator E = A->symbol_end();
       if (I != E) {
-        outs() << "Archive map\n";
+        outStream() << "Archive map\n";
         for (; I != E; ++I) {
           Expected<Archive::Child> C = I->getMember();
           if (!C) {
@@ -1854,9 +1938,9 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
             break;
           }
           StringRef SymName = I->getName();
-          outs() << SymName << " in " << FileNameOrErr.get() << "\n";
+          outStream() << SymName << " in " << FileNameOrErr.get() << "\n";
         }
-        outs() << "\n";
+        outStream() << "\n";
       }
     }
 
@@ -1871,20 +1955,19 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
           continue;
         }
         if (SymbolicFile *O = dyn_cast<SymbolicFile>(&*ChildOrErr.get())) {
-          if (!MachOPrintSizeWarning && PrintSize &&  isa<MachOObjectFile>(O)) {
-            WithColor::warning(errs(), ToolName)
+          if (PrintSize && isa<MachOObjectFile>(O) &&
+              !MachOPrintSizeWarning.exchange(true))
+            WithColor::warning(errStream(), ToolName)
                 << "sizes with -print-size for Mach-O files are always zero.\n";
-            MachOPrintSizeWarning = true;
-          }
           if (!checkMachOAndArchFlags(O, Filename))
             return;
           if (!PrintFileName) {
-            outs() << "\n";
+            outStream() << "\n";
             if (isa<MachOObjectFile>(O)) {
-              outs() << Filename << "(" << O->getFileName() << ")";
+              outStream() << Filename << "(" << O->getFileName() << ")";
             } else
-              outs() << O->getFileName();
-            outs() << ":\n";
+              outStream() << O->getFileName();
+            outStream() << ":\n";
           }
           dumpSymbolNamesFromObject(*O, false, Filename);
         }
@@ -1918,7 +2001,7 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
                 if (PrintFileName)
                   ArchitectureName = I->getArchFlagName();
                 else
-                  outs() << "\n" << Obj.getFileName() << " (for architecture "
+                  outStream() << "\n" << Obj.getFileName() << " (for architecture "
                          << I->getArchFlagName() << ")"
                          << ":\n";
               }
@@ -1951,13 +2034,13 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
                     if (ArchFlags.size() > 1)
                       ArchitectureName = I->getArchFlagName();
                   } else {
-                    outs() << "\n" << A->getFileName();
-                    outs() << "(" << O->getFileName() << ")";
+                    outStream() << "\n" << A->getFileName();
+                    outStream() << "(" << O->getFileName() << ")";
                     if (ArchFlags.size() > 1) {
-                      outs() << " (for architecture " << I->getArchFlagName()
+                      outStream() << " (for architecture " << I->getArchFlagName()
                              << ")";
                     }
-                    outs() << ":\n";
+                    outStream() << ":\n";
                   }
                   dumpSymbolNamesFromObject(*O, false, ArchiveName,
                                             ArchitectureName);
@@ -2018,7 +2101,7 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
                 if (PrintFileName)
                   ArchiveName = std::string(A->getFileName());
                 else
-                  outs() << "\n" << A->getFileName() << "(" << O->getFileName()
+                  outStream() << "\n" << A->getFileName() << "(" << O->getFileName()
                          << ")"
                          << ":\n";
                 dumpSymbolNamesFromObject(*O, false, ArchiveName);
@@ -2053,11 +2136,11 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
             ArchitectureName = O.getArchFlagName();
         } else {
           if (moreThanOneArch)
-            outs() << "\n";
-          outs() << Obj.getFileName();
+            outStream() << "\n";
+          outStream() << Obj.getFileName();
           if (isa<MachOObjectFile>(Obj) && moreThanOneArch)
-            outs() << " (for architecture " << O.getArchFlagName() << ")";
-          outs() << ":\n";
+            outStream() << " (for architecture " << O.getArchFlagName() << ")";
+          outStream() << ":\n";
         }
         dumpSymbolNamesFromObject(Obj, false, ArchiveName, ArchitectureName);
       } else if (auto E = isNotObjectErrorInvalidFileType(
@@ -2085,15 +2168,15 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
               if (isa<MachOObjectFile>(F) && moreThanOneArch)
                 ArchitectureName = O.getArchFlagName();
             } else {
-              outs() << "\n" << A->getFileName();
+              outStream() << "\n" << A->getFileName();
               if (isa<MachOObjectFile>(F)) {
-                outs() << "(" << F->getFileName() << ")";
+                outStream() << "(" << F->getFileName() << ")";
                 if (moreThanOneArch)
-                  outs() << " (for architecture " << O.getArchFlagName()
+                  outStream() << " (for architecture " << O.getArchFlagName()
                          << ")";
               } else
-                outs() << ":" << F->getFileName();
-              outs() << ":\n";
+                outStream() << ":" << F->getFileName();
+              outStream() << ":\n";
             }
             dumpSymbolNamesFromObject(*F, false, ArchiveName, ArchitectureName);
           }
@@ -2122,9 +2205,10 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
       if (!AddInlinedInfo && !I.isTopLevelLib())
         continue;
       if (auto ObjOrErr = I.getAsObjectFile()) {
-        outs() << "\n"
-               << I.getInstallName() << " (for architecture " << ArchName << ")"
-               << ":\n";
+        if (OutputFormat != jsonl)
+          outStream() << "\n" << I.getInstallName() << " (for architecture "
+                      << ArchName << ")"
+                      << ":\n";
         dumpSymbolNamesFromObject(*ObjOrErr.get(), false, {}, ArchName);
       } else if (Error E =
                      isNotObjectErrorInvalidFileType(ObjOrErr.takeError())) {
@@ -2136,17 +2220,67 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
   }
 
   if (SymbolicFile *O = dyn_cast<SymbolicFile>(&Bin)) {
-    if (!MachOPrintSizeWarning && PrintSize &&  isa<MachOObjectFile>(O)) {
-      WithColor::warning(errs(), ToolName)
+    if (PrintSize && isa<MachOObjectFile>(O) &&
+        !MachOPrintSizeWarning.exchange(true))
+      WithColor::warning(errStream(), ToolName)
           << "sizes with --print-size for Mach-O files are always zero.\n";
-      MachOPrintSizeWarning = true;
-    }
     if (!checkMachOAndArchFlags(O, Filename))
       return;
     dumpSymbolNamesFromObject(*O, true);
   }
 }
 
+// Reads the input file names listed in FilesFrom, one per line.
+static void readFilesFrom() {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
+      MemoryBuffer::getFileOrSTDIN(FilesFrom);
+  if (error(BufferOrErr.getError(), FilesFrom))
+    return;
+  SmallVector<StringRef, 0> Lines;
+  (*BufferOrErr)->getBuffer().split(Lines, '\n', -1, false);
+  for (StringRef Line : Lines) {
+    Line = Line.rtrim("\r");
+    if (!Line.empty())
+      InputFilenames.push_back(Line.str());
+  }
+}
+
+// Dumps the inputs on several threads. The output of each input is buffered,
+// and the buffers are printed in input order, so the output is the same as
+// when dumping the inputs one by one. The inputs are dumped in batches to
+// bound the memory the buffers take.
+static void dumpSymbolNamesFromFilesInParallel() {
+  struct InputOutput {
+    std::string Out;
+    std::string Err;
+  };
+  parallel::strategy = hardware_concurrency(Threads);
+  const size_t BatchSize = 64 * parallel::strategy.compute_thread_count();
+  std::vector<InputOutput> Outputs;
+  for (size_t Begin = 0, E = InputFilenames.size(); Begin < E;
+       Begin += BatchSize) {
+    size_t End = std::min(Begin + BatchSize, E);
+    Outputs.assign(End - Begin, InputOutput());
+    parallelForEachN(Begin, End, [&](size_t I) {
+      InputOutput &IO = Outputs[I - Begin];
+      raw_string_ostream Out(IO.Out);
+      raw_string_ostream Err(IO.Err);
+      CurrentOutStream = &Out;
+      CurrentErrStream = &Err;
+      dumpSymbolNamesFromFile(InputFilenames[I]);
+      CurrentOutStream = nullptr;
+      CurrentErrStream = nullptr;
+    });
+    for (const InputOutput &IO : Outputs) {
+      outs() << IO.Out;
+      if (!IO.Err.empty()) {
+        outs().flush();
+        errs() << IO.Err;
+      }
+    }
+  }
+}
+
 int main(int argc, char **argv) {
   InitLLVM X(argc, argv);
   cl::HideUnrelatedOptions(NMCat);
@@ -2168,6 +2302,10 @@ int main(int argc, char **argv) {
     OutputFormat = posix;
   if (DarwinFormat)
     OutputFormat = darwin;
+  // Every JSON object names the file that its symbols come from instead of
+  // a header line.
+  if (OutputFormat == jsonl)
+    PrintFileName = true;
 
   // The relative order of these is important. If you pass --size-sort it should
   // only print out the size. However, if you pass -S --size-sort, it should
@@ -2176,7 +2314,12 @@ int main(int argc, char **argv) {
     PrintAddress = false;
   if (OutputFormat == sysv || SizeSort)
     PrintSize = true;
-  if (InputFilenames.empty())
+  if (!FilesFrom.empty()) {
+    readFilesFrom();
+    if (!Threads.getNumOccurrences())
+      Threads = 0;
+  }
+  if (InputFilenames.empty() && FilesFrom.empty())
     InputFilenames.push_back("a.out");
   if (InputFilenames.size() > 1)
     MultipleFiles = true;
@@ -2202,7 +2345,10 @@ int main(int argc, char **argv) {
   if (NoDyldInfo && (AddDyldInfo || DyldInfoOnly))
     error("--no-dyldinfo can't be used with --add-dyldinfo or --dyldinfo-only");
 
-  llvm::for_each(InputFilenames, dumpSymbolNamesFromFile);
+  if (Threads != 1 && InputFilenames.size() > 1)
+    dumpSymbolNamesFromFilesInParallel();
+  else
+    llvm::for_each(InputFilenames, dumpSymbolNamesFromFile);
 
   if (HadError)
     return 1;
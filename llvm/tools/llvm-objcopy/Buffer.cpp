@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "Buffer.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/FileOutputBuffer.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -18,6 +19,10 @@ namespace objcopy {
 
 Buffer::~Buffer() {}
 
+void Buffer::write(ArrayRef<uint8_t> Data, uint64_t Offset) {
+  llvm::copy(Data, getBufferStart() + Offset);
+}
+
 static Error createEmptyFile(StringRef FileName) {
   // Create an empty tempfile and atomically swap it in place with the desired
   // output file.
@@ -60,6 +65,18 @@ uint8_t *FileBuffer::getBufferStart() {
   return reinterpret_cast<uint8_t *>(Buf->getBufferStart());
 }
 
+void FileBuffer::write(ArrayRef<uint8_t> Data, uint64_t Offset) {
+  // Copying a range takes a system call, so only do it for large ranges.
+  const size_t MinFileCopySize = 64 * 1024;
+  if (InputFD != -1 && Data.size() >= MinFileCopySize &&
+      Data.begin() >= InputContents.begin() &&
+      Data.end() <= InputContents.end() &&
+      Buf->copyFromFile(InputFD, Data.begin() - InputContents.begin(), Offset,
+                        Data.size()))
+    return;
+  Buffer::write(Data, Offset);
+}
+
 Error MemBuffer::allocate(size_t Size) {
   Buf = WritableMemoryBuffer::getNewMemBuffer(Size, getName());
   return Error::success();
@@ -9,6 +9,7 @@
 #ifndef LLVM_TOOLS_OBJCOPY_BUFFER_H
 #define LLVM_TOOLS_OBJCOPY_BUFFER_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/FileOutputBuffer.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -30,6 +31,8 @@ public:
   virtual Error allocate(size_t Size) = 0;
   virtual uint8_t *getBufferStart() = 0;
   virtual Error commit() = 0;
+  // Copies Data to Offset in the buffer. Data must not overlap the buffer.
+  virtual void write(ArrayRef<uint8_t> Data, uint64_t Offset);
 
   explicit Buffer(StringRef Name) : Name(Name) {}
   StringRef getName() const { return Name; }
@@ -40,11 +43,24 @@ class FileBuffer : public Buffer {
   // Indicates that allocate(0) was called, and commit() should create or
   // truncate a file instead of using a FileOutputBuffer.
   bool EmptyFile = false;
+  // See setInputFile().
+  int InputFD = -1;
+  ArrayRef<uint8_t> InputContents;
 
 public:
   Error allocate(size_t Size) override;
   uint8_t *getBufferStart() override;
   Error commit() override;
+  void write(ArrayRef<uint8_t> Data, uint64_t Offset) override;
+
+  // Tells the buffer that Contents holds the contents of the open file FD.
+  // write() then has the kernel copy large pieces of Contents from the input
+  // file to the output file, rather than reading them through memory, which
+  // keeps the memory use of e.g. stripping a large binary low.
+  void setInputFile(int FD, ArrayRef<uint8_t> Contents) {
+    InputFD = FD;
+    InputContents = Contents;
+  }
 
   explicit FileBuffer(StringRef FileName) : Buffer(FileName) {}
 };
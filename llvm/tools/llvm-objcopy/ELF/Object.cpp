@@ -170,7 +170,7 @@ Error BinarySectionWriter::visit(const GroupSection &Sec) {
 
 Error SectionWriter::visit(const Section &Sec) {
   if (Sec.Type != SHT_NOBITS)
-    llvm::copy(Sec.Contents, Out.getBufferStart() + Sec.Offset);
+    Out.write(Sec.Contents, Sec.Offset);
 
   return Error::success();
 }
@@ -2076,8 +2076,7 @@ template <class ELFT> Error ELFWriter<ELFT>::writeSectionData() {
 template <class ELFT> void ELFWriter<ELFT>::writeSegmentData() {
   for (Segment &Seg : Obj.segments()) {
     size_t Size = std::min<size_t>(Seg.FileSize, Seg.getContents().size());
-    std::memcpy(Buf.getBufferStart() + Seg.Offset, Seg.getContents().data(),
-                Size);
+    Buf.write(Seg.getContents().take_front(Size), Seg.Offset);
   }
 
   // Iterate over removed sections and overwrite their old data with zeroes.
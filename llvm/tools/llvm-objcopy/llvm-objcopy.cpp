@@ -15,6 +15,7 @@
 
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Object/Archive.h"
@@ -310,9 +311,20 @@ static Error executeObjcopy(CopyConfig &Config) {
       if (Error E = executeObjcopyOnArchive(Config, *Ar))
         return E;
     } else {
+      Binary &In = *BinaryOrErr.get().getBinary();
       FileBuffer FB(Config.OutputFilename);
-      if (Error E = executeObjcopyOnBinary(Config,
-                                           *BinaryOrErr.get().getBinary(), FB))
+      // Let the writer copy unchanged data straight from the input file.
+      int InputFD = -1;
+      if (Config.InputFilename != "-") {
+        if (!sys::fs::openFileForRead(Config.InputFilename, InputFD))
+          FB.setInputFile(InputFD, arrayRefFromStringRef(In.getData()));
+        else
+          InputFD = -1;
+      }
+      Error E = executeObjcopyOnBinary(Config, In, FB);
+      if (InputFD != -1)
+        sys::Process::SafelyCloseFileDescriptor(InputFD);
+      if (E)
         return E;
     }
   }
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
@@ -308,11 +309,174 @@ static void writeInstrProfile(StringRef OutputFilename,
   }
 }
 
+/// Shared state of a merge that splits the functions into hash partitions.
+/// Every function is owned by exactly one partition, so the merged counters
+/// are kept in memory once however many inputs and threads there are.
+struct PartitionedMerge {
+  struct Partition {
+    std::mutex Lock;
+    InstrProfWriter Writer;
+
+    Partition(bool IsSparse) : Lock(), Writer(IsSparse) {}
+  };
+
+  std::vector<std::unique_ptr<Partition>> Partitions;
+
+  /// The kind of the profiles merged so far.
+  std::mutex KindLock;
+  Optional<bool> IsIRLevel;
+  bool HasCSIRLevel = false;
+  bool InstrEntryBBEnabled = false;
+
+  std::mutex ErrLock;
+  std::vector<std::pair<Error, std::string>> Errors;
+  SmallSet<instrprof_error, 4> WriterErrorCodes;
+
+  PartitionedMerge(unsigned NumPartitions, bool IsSparse) {
+    for (unsigned I = 0; I < NumPartitions; ++I)
+      Partitions.emplace_back(std::make_unique<Partition>(IsSparse));
+  }
+};
+
+/// Records read from an input are handed to their partition in batches of
+/// this many, so that a partition lock is not taken for every record.
+static const unsigned PartitionBatchSize = 256;
+
+static void addRecordsToPartition(PartitionedMerge &PM,
+                                  PartitionedMerge::Partition &P,
+                                  SmallVectorImpl<NamedInstrProfRecord> &Batch,
+                                  const WeightedFile &Input) {
+  std::unique_lock<std::mutex> PartitionGuard{P.Lock};
+  for (auto &Record : Batch) {
+    const StringRef FuncName = Record.Name;
+    bool Reported = false;
+    P.Writer.addRecord(std::move(Record), Input.Weight, [&](Error E) {
+      if (Reported) {
+        consumeError(std::move(E));
+        return;
+      }
+      Reported = true;
+      // Only show hint the first time an error occurs.
+      instrprof_error IPE = InstrProfError::take(std::move(E));
+      std::unique_lock<std::mutex> ErrGuard{PM.ErrLock};
+      bool firstTime = PM.WriterErrorCodes.insert(IPE).second;
+      handleMergeWriterError(make_error<InstrProfError>(IPE), Input.Filename,
+                             FuncName, firstTime);
+    });
+  }
+  Batch.clear();
+}
+
+/// Stream the records of an input into the partitions owning them. Only one
+/// batch of records per partition is held besides the reader itself.
+static void loadInputIntoPartitions(const WeightedFile &Input,
+                                    SymbolRemapper *Remapper,
+                                    PartitionedMerge *PM) {
+  // Copy the input, see loadInput.
+  WeightedFile LocalInput = Input;
+  auto addError = [&](Error E) {
+    std::unique_lock<std::mutex> ErrGuard{PM->ErrLock};
+    PM->Errors.emplace_back(std::move(E), LocalInput.Filename);
+  };
+
+  auto ReaderOrErr = InstrProfReader::create(LocalInput.Filename);
+  if (Error E = ReaderOrErr.takeError()) {
+    // Skip the empty profiles by returning sliently.
+    instrprof_error IPE = InstrProfError::take(std::move(E));
+    if (IPE != instrprof_error::empty_raw_profile)
+      addError(make_error<InstrProfError>(IPE));
+    return;
+  }
+
+  auto Reader = std::move(ReaderOrErr.get());
+  {
+    std::unique_lock<std::mutex> KindGuard{PM->KindLock};
+    bool IsIRProfile = Reader->isIRLevelProfile();
+    if (PM->IsIRLevel && *PM->IsIRLevel != IsIRProfile) {
+      KindGuard.unlock();
+      addError(make_error<StringError>(
+          "Merge IR generated profile with Clang generated profile.",
+          std::error_code()));
+      return;
+    }
+    PM->IsIRLevel = IsIRProfile;
+    PM->HasCSIRLevel |= Reader->hasCSIRLevelProfile();
+    PM->InstrEntryBBEnabled |= Reader->instrEntryBBEnabled();
+  }
+
+  std::vector<SmallVector<NamedInstrProfRecord, 0>> Batches(
+      PM->Partitions.size());
+  for (auto &I : *Reader) {
+    if (Remapper)
+      I.Name = (*Remapper)(I.Name);
+    unsigned Index = MD5Hash(I.Name) % PM->Partitions.size();
+    auto &Batch = Batches[Index];
+    Batch.push_back(std::move(I));
+    if (Batch.size() == PartitionBatchSize)
+      addRecordsToPartition(*PM, *PM->Partitions[Index], Batch, LocalInput);
+  }
+  // The record names point into the reader, so flush before it goes away.
+  for (unsigned Index = 0; Index < Batches.size(); ++Index)
+    if (!Batches[Index].empty())
+      addRecordsToPartition(*PM, *PM->Partitions[Index], Batches[Index],
+                            LocalInput);
+
+  if (Reader->hasError())
+    if (Error E = Reader->getError())
+      addError(std::move(E));
+}
+
+/// Merge \p Inputs into \p NumPartitions hash partitions of the function
+/// names, then move the partitions one at a time into the output writer. As
+/// the partitions are disjoint, nothing is merged twice and no partition is
+/// copied while another still holds its records.
+static void mergeInstrProfileInPartitions(
+    const WeightedFileVector &Inputs, SymbolRemapper *Remapper,
+    StringRef OutputFilename, ProfileFormat OutputFormat, bool OutputSparse,
+    unsigned NumThreads, unsigned NumPartitions, FailureMode FailMode) {
+  if (NumThreads == 0)
+    NumThreads = std::min(hardware_concurrency().compute_thread_count(),
+                          unsigned(Inputs.size()));
+
+  PartitionedMerge PM(NumPartitions, OutputSparse);
+  if (NumThreads == 1) {
+    for (const auto &Input : Inputs)
+      loadInputIntoPartitions(Input, Remapper, &PM);
+  } else {
+    ThreadPool Pool(hardware_concurrency(NumThreads));
+    for (const auto &Input : Inputs)
+      Pool.async(loadInputIntoPartitions, Input, Remapper, &PM);
+    Pool.wait();
+  }
+
+  unsigned NumErrors = 0;
+  for (auto &ErrorPair : PM.Errors) {
+    ++NumErrors;
+    warn(toString(std::move(ErrorPair.first)), ErrorPair.second);
+  }
+  if (NumErrors == Inputs.size() ||
+      (NumErrors > 0 && FailMode == failIfAnyAreInvalid))
+    exitWithError("No profiles could be merged.");
+
+  InstrProfWriter Writer(OutputSparse);
+  if (PM.IsIRLevel)
+    cantFail(Writer.setIsIRLevelProfile(*PM.IsIRLevel, PM.HasCSIRLevel));
+  Writer.setInstrEntryBBEnabled(PM.InstrEntryBBEnabled);
+  for (auto &P : PM.Partitions) {
+    Writer.mergeRecordsFromWriter(std::move(P->Writer), [&](Error E) {
+      warn(toString(std::move(E)));
+    });
+    P.reset();
+  }
+  writeInstrProfile(OutputFilename, OutputFormat, Writer);
+}
+
 static void mergeInstrProfile(const WeightedFileVector &Inputs,
                               SymbolRemapper *Remapper,
                               StringRef OutputFilename,
                               ProfileFormat OutputFormat, bool OutputSparse,
-                              unsigned NumThreads, FailureMode FailMode) {
+                              unsigned NumThreads, unsigned NumPartitions,
+                              FailureMode FailMode) {
   if (OutputFilename.compare("-") == 0)
     exitWithError("Cannot write indexed profdata format to stdout.");
 
@@ -320,6 +484,13 @@ static void mergeInstrProfile(const WeightedFileVector &Inputs,
       OutputFormat != PF_Ext_Binary && OutputFormat != PF_Text)
     exitWithError("Unknown format is specified.");
 
+  if (NumPartitions > 0) {
+    mergeInstrProfileInPartitions(Inputs, Remapper, OutputFilename,
+                                  OutputFormat, OutputSparse, NumThreads,
+                                  NumPartitions, FailMode);
+    return;
+  }
+
   std::mutex ErrorLock;
   SmallSet<instrprof_error, 4> WriterErrorCodes;
 
@@ -639,6 +810,9 @@ static void handleExtBinaryWriter(sampleprof::SampleProfileWriter &Writer,
   if (UseMD5) {
     if (OutputFormat != PF_Ext_Binary)
       warn("-use-md5 is ignored. Specify -extbinary to enable it");
+    else if (sampleprof::FunctionSamples::ProfileIsCS)
+      warn("-use-md5 is ignored for context-sensitive profiles, whose "
+           "contexts must stay readable to be loaded on demand");
     else
       Writer.setUseMD5();
   }
@@ -679,6 +853,14 @@ mergeSampleProfile(const WeightedFileVector &Inputs, SymbolRemapper *Remapper,
       continue;
     }
 
+    // Context-sensitive profiles are merged and written per context.
+    if (Reader->profileIsCS()) {
+      if (Remapper)
+        exitWithError("Remapping is not supported for context-sensitive "
+                      "profiles.", Input.Filename);
+      FunctionSamples::ProfileIsCS = true;
+    }
+
     StringMap<FunctionSamples> &Profiles = Reader->getProfiles();
     for (StringMap<FunctionSamples>::iterator I = Profiles.begin(),
                                               E = Profiles.end();
@@ -688,8 +870,10 @@ mergeSampleProfile(const WeightedFileVector &Inputs, SymbolRemapper *Remapper,
           Remapper ? remapSamples(I->second, *Remapper, Result)
                    : FunctionSamples();
       FunctionSamples &Samples = Remapper ? Remapped : I->second;
-      StringRef FName = Samples.getName();
-      MergeResult(Result, ProfileMap[FName].merge(Samples, Input.Weight));
+      StringRef FName = Samples.getNameWithContext();
+      FunctionSamples &MergedSamples = ProfileMap[FName];
+      MergeResult(Result, MergedSamples.merge(Samples, Input.Weight));
+      MergedSamples.setContext(Samples.getContext());
       if (Result != sampleprof_error::success) {
         std::error_code EC = make_error_code(Result);
         handleMergeWriterError(errorCodeToError(EC), Input.Filename, FName);
@@ -831,6 +1015,11 @@ static int merge_main(int argc, const char *argv[]) {
       cl::desc("Number of merge threads to use (default: autodetect)"));
   cl::alias NumThreadsA("j", cl::desc("Alias for --num-threads"),
                         cl::aliasopt(NumThreads));
+  cl::opt<unsigned> NumPartitions(
+      "num-partitions", cl::init(0),
+      cl::desc("Merge instrumentation profiles by splitting the functions "
+               "into this many hash partitions, so that the merged counters "
+               "are held in memory only once (default: off)"));
   cl::opt<std::string> ProfileSymbolListFile(
       "prof-sym-list", cl::init(""),
       cl::desc("Path to file containing the list of function symbols "
@@ -909,7 +1098,8 @@ static int merge_main(int argc, const char *argv[]) {
 
   if (ProfileKind == instr)
     mergeInstrProfile(WeightedInputs, Remapper.get(), OutputFilename,
-                      OutputFormat, OutputSparse, NumThreads, FailureMode);
+                      OutputFormat, OutputSparse, NumThreads, NumPartitions,
+                      FailureMode);
   else
     mergeSampleProfile(WeightedInputs, Remapper.get(), OutputFilename,
                        OutputFormat, ProfileSymbolListFile, CompressAllSections,
@@ -6,6 +6,8 @@
 //
 //===----------------------------------------------------------------------===//
 #include "PerfReader.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 
 static cl::opt<bool> ShowMmapEvents("show-mmap-events", cl::ReallyHidden,
                                     cl::init(false), cl::ZeroOrMore,
@@ -16,6 +18,11 @@ static cl::opt<bool> ShowUnwinderOutput("show-unwinder-output",
                                         cl::ZeroOrMore,
                                         cl::desc("Print unwinder output"));
 
+static cl::opt<unsigned>
+    NumThreads("num-threads", cl::init(0), cl::ZeroOrMore,
+               cl::desc("Number of threads to unwind hybrid samples with "
+                        "(default: autodetect)"));
+
 namespace llvm {
 namespace sampleprof {
 
@@ -221,11 +228,60 @@ void PerfReader::printUnwinderOutput() {
   }
 }
 
+// Add the counts of \p Src into \p Dst, moving the samples of contexts that
+// \p Dst does not have yet.
+template <typename ContextCounter>
+static void mergeContextCounter(ContextCounter &Dst, ContextCounter &Src) {
+  for (auto &I : Src) {
+    auto Iter = Dst.find(I.first);
+    if (Iter == Dst.end()) {
+      Dst.emplace(I.first, std::move(I.second));
+      continue;
+    }
+    for (const auto &Count : I.second)
+      Iter->second[Count.first] += Count.second;
+  }
+  Src.clear();
+}
+
 void PerfReader::unwindSamples() {
-  for (const auto &Item : AggregatedSamples) {
-    const HybridSample &Sample = Item.first;
-    VirtualUnwinder Unwinder(&BinarySampleCounters[Sample.Binary]);
-    Unwinder.unwind(Sample, Item.second);
+  std::vector<std::pair<const HybridSample *, uint64_t>> Samples;
+  Samples.reserve(AggregatedSamples.size());
+  for (const auto &Item : AggregatedSamples)
+    Samples.emplace_back(&Item.first, Item.second);
+
+  ThreadPoolStrategy Strategy = hardware_concurrency(NumThreads);
+  unsigned NumShards = std::max<size_t>(
+      1, std::min<size_t>(Strategy.compute_thread_count(), Samples.size()));
+
+  // Each shard unwinds every NumShards-th sample into counters of its own, so
+  // that the unwinders never share a counter. The shards are merged after all
+  // of them are done.
+  std::vector<BinarySampleCounterMap> ShardCounters(NumShards);
+  auto UnwindShard = [&](unsigned Shard) {
+    for (size_t I = Shard; I < Samples.size(); I += NumShards) {
+      const HybridSample &Sample = *Samples[I].first;
+      VirtualUnwinder Unwinder(&ShardCounters[Shard][Sample.Binary]);
+      Unwinder.unwind(Sample, Samples[I].second);
+    }
+  };
+  if (NumShards == 1) {
+    UnwindShard(0);
+  } else {
+    ThreadPool Pool(Strategy);
+    for (unsigned Shard = 0; Shard < NumShards; ++Shard)
+      Pool.async(UnwindShard, Shard);
+    Pool.wait();
+  }
+
+  BinarySampleCounters = std::move(ShardCounters[0]);
+  for (unsigned Shard = 1; Shard < NumShards; ++Shard) {
+    for (auto &I : ShardCounters[Shard]) {
+      ContextSampleCounters &Counters = BinarySampleCounters[I.first];
+      mergeContextCounter(Counters.RangeCounter, I.second.RangeCounter);
+      mergeContextCounter(Counters.BranchCounter, I.second.BranchCounter);
+    }
+    ShardCounters[Shard].clear();
   }
 
   if (ShowUnwinderOutput)
@@ -137,9 +137,8 @@ ProfiledBinary::getExpandedContextStr(const std::list<uint64_t> &Stack) const {
 
   std::ostringstream OContextStr;
   for (uint32_t I = 0; I < (uint32_t)ContextVec.size(); I++) {
-    if (OContextStr.str().size()) {
+    if (I != 0)
       OContextStr << " @ ";
-    }
 
     if (I == ContextVec.size() - 1) {
       // Only keep the function name for the leaf frame
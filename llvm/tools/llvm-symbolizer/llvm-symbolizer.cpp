@@ -284,6 +284,7 @@ int main(int argc, char **argv) {
   Opts.DWPName = Args.getLastArgValue(OPT_dwp_EQ).str();
   Opts.FallbackDebugPath =
       Args.getLastArgValue(OPT_fallback_debug_path_EQ).str();
+  Opts.GsymCacheDirectory = Args.getLastArgValue(OPT_gsym_cache_dir_EQ).str();
   Opts.PrintFunctions = decideHowToPrintFunctions(Args, IsAddr2Line);
   parseIntArg(Args, OPT_print_source_context_lines_EQ, SourceContextLines);
   Opts.RelativeAddresses = Args.hasArg(OPT_relative_address);
@@ -0,0 +1,294 @@
+//===- llvm-time-trace-merge.cpp ------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// llvm-time-trace-merge aggregates the -ftime-trace profiles of the
+// translation units of a build, and reports the headers, templates and passes
+// that cost the most across the whole build.
+//
+// For each kind of section (e.g. "Source", "InstantiateFunction" or
+// "RunPass") and each detail (e.g. the header or the template), it sums:
+//  - the inclusive time: the duration of the sections, not counting the
+//    sections nested in a section with the same kind and detail twice;
+//  - the exclusive time: the duration of the sections minus the duration of
+//    the sections nested directly in them;
+//  - the memory allocated by the sections, if the profiles were recorded with
+//    -ftime-trace-memory.
+// It also reports the profiles that span the most time, under the
+// "Translation unit" kind.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/WithColor.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace llvm;
+
+static cl::list<std::string> InputFiles(cl::Positional, cl::OneOrMore,
+                                        cl::desc("<trace files>"));
+static cl::opt<std::string> OutputFilename("o", cl::value_desc("filename"),
+                                           cl::init("-"),
+                                           cl::desc("Output file"));
+static cl::opt<unsigned> Top("top", cl::init(20),
+                             cl::desc("Number of entries to report for each "
+                                      "kind of section"));
+static cl::opt<std::string>
+    Kinds("kinds", cl::init(""),
+          cl::desc("Comma-separated kinds of sections to report (default: "
+                   "all)"));
+static cl::opt<std::string>
+    Threads("j", cl::init(""),
+            cl::desc("Number of trace files to read in parallel"));
+
+namespace {
+
+/// The aggregated cost of the sections with a given kind and detail.
+struct Cost {
+  uint64_t Count = 0;
+  uint64_t InclusiveUs = 0;
+  uint64_t ExclusiveUs = 0;
+  int64_t Memory = 0;
+
+  void add(const Cost &Other) {
+    Count += Other.Count;
+    InclusiveUs += Other.InclusiveUs;
+    ExclusiveUs += Other.ExclusiveUs;
+    Memory += Other.Memory;
+  }
+};
+
+/// The costs of the sections of one or more profiles, by kind and detail.
+struct Profile {
+  StringMap<StringMap<Cost>> Costs;
+  bool HasMemory = false;
+
+  void add(const Profile &Other) {
+    for (const auto &Kind : Other.Costs)
+      for (const auto &Detail : Kind.getValue())
+        Costs[Kind.getKey()][Detail.getKey()].add(Detail.getValue());
+    HasMemory |= Other.HasMemory;
+  }
+};
+
+struct Event {
+  StringRef Name;
+  StringRef Detail;
+  uint64_t Tid;
+  uint64_t StartUs;
+  uint64_t DurUs;
+  Optional<int64_t> Memory;
+};
+
+} // namespace
+
+static void warn(const Twine &Message, StringRef File) {
+  WithColor::warning() << File << ": " << Message << "\n";
+}
+
+/// Collects the complete events of the profile, without the totals that the
+/// profiler adds at the end.
+static std::vector<Event> collectEvents(const json::Value &Root) {
+  std::vector<Event> Events;
+  const json::Object *Obj = Root.getAsObject();
+  const json::Array *TraceEvents = Obj ? Obj->getArray("traceEvents") : nullptr;
+  if (!TraceEvents)
+    return Events;
+
+  for (const json::Value &V : *TraceEvents) {
+    const json::Object *E = V.getAsObject();
+    if (!E || E->getString("ph") != StringRef("X"))
+      continue;
+    Optional<StringRef> Name = E->getString("name");
+    Optional<int64_t> Tid = E->getInteger("tid");
+    Optional<int64_t> Ts = E->getInteger("ts");
+    Optional<int64_t> Dur = E->getInteger("dur");
+    if (!Name || !Tid || !Ts || !Dur || Name->startswith("Total "))
+      continue;
+
+    Event Ev{*Name, "", uint64_t(*Tid), uint64_t(*Ts), uint64_t(*Dur), None};
+    if (const json::Object *Args = E->getObject("args")) {
+      if (Optional<StringRef> Detail = Args->getString("detail"))
+        Ev.Detail = *Detail;
+      Ev.Memory = Args->getInteger("memory delta");
+    }
+    Events.push_back(Ev);
+  }
+  return Events;
+}
+
+/// Computes the costs of the sections of one profile.
+static Profile analyzeProfile(std::vector<Event> &Events) {
+  Profile P;
+
+  // Nested sections start after, and within, the sections that contain them.
+  llvm::sort(Events, [](const Event &LHS, const Event &RHS) {
+    return std::make_tuple(LHS.Tid, LHS.StartUs, RHS.DurUs) <
+           std::make_tuple(RHS.Tid, RHS.StartUs, LHS.DurUs);
+  });
+
+  struct Open {
+    const Event *E;
+    uint64_t ChildrenUs;
+  };
+  SmallVector<Open, 32> Stack;
+  auto Close = [&]() {
+    Open O = Stack.pop_back_val();
+    Cost &C = P.Costs[O.E->Name][O.E->Detail];
+    ++C.Count;
+    C.ExclusiveUs += O.E->DurUs - std::min(O.ChildrenUs, O.E->DurUs);
+    // Only count the outermost of nested sections with the same kind and
+    // detail, e.g. a recursive template instantiation, towards the inclusive
+    // cost.
+    if (llvm::none_of(Stack, [&](const Open &Outer) {
+          return Outer.E->Name == O.E->Name && Outer.E->Detail == O.E->Detail;
+        })) {
+      C.InclusiveUs += O.E->DurUs;
+      if (O.E->Memory) {
+        C.Memory += *O.E->Memory;
+        P.HasMemory = true;
+      }
+    }
+  };
+
+  for (const Event &E : Events) {
+    while (!Stack.empty() &&
+           (Stack.back().E->Tid != E.Tid ||
+            Stack.back().E->StartUs + Stack.back().E->DurUs <= E.StartUs))
+      Close();
+    if (!Stack.empty())
+      Stack.back().ChildrenUs += E.DurUs;
+    Stack.push_back({&E, 0});
+  }
+  while (!Stack.empty())
+    Close();
+
+  return P;
+}
+
+static void printReport(const Profile &Build, size_t NumProfiles,
+                        raw_ostream &OS) {
+  SmallVector<StringRef, 4> SelectedKinds;
+  StringRef(Kinds).split(SelectedKinds, ',', -1, /*KeepEmpty=*/false);
+
+  // Report the kinds of sections that take the most time first.
+  std::vector<std::pair<StringRef, uint64_t>> SortedKinds;
+  for (const auto &Kind : Build.Costs) {
+    if (!SelectedKinds.empty() && !is_contained(SelectedKinds, Kind.getKey()))
+      continue;
+    uint64_t ExclusiveUs = 0;
+    for (const auto &Detail : Kind.getValue())
+      ExclusiveUs += Detail.getValue().ExclusiveUs;
+    SortedKinds.emplace_back(Kind.getKey(), ExclusiveUs);
+  }
+  llvm::sort(SortedKinds, [](const auto &LHS, const auto &RHS) {
+    return std::make_pair(LHS.second, RHS.first) >
+           std::make_pair(RHS.second, LHS.first);
+  });
+
+  OS << "Merged " << NumProfiles << " time trace profiles.\n";
+  for (const auto &Kind : SortedKinds) {
+    const StringMap<Cost> &Details = Build.Costs.find(Kind.first)->getValue();
+    std::vector<std::pair<StringRef, const Cost *>> Sorted;
+    for (const auto &Detail : Details)
+      Sorted.emplace_back(Detail.getKey(), &Detail.getValue());
+    llvm::sort(Sorted, [](const auto &LHS, const auto &RHS) {
+      return std::make_pair(LHS.second->InclusiveUs, RHS.first) >
+             std::make_pair(RHS.second->InclusiveUs, LHS.first);
+    });
+    if (Sorted.size() > Top)
+      Sorted.resize(Top);
+
+    OS << "\n*** " << Kind.first << " (" << format("%.1f", Kind.second / 1e6)
+       << " s exclusive)\n";
+    OS << "  inclusive s  exclusive s      count";
+    if (Build.HasMemory)
+      OS << "    memory MB";
+    OS << "  detail\n";
+    for (const auto &Detail : Sorted) {
+      const Cost &C = *Detail.second;
+      OS << format("  %11.2f  %11.2f  %9llu", C.InclusiveUs / 1e6,
+                   C.ExclusiveUs / 1e6, (unsigned long long)C.Count);
+      if (Build.HasMemory)
+        OS << format("  %11.1f", C.Memory / (1024.0 * 1024.0));
+      OS << "  " << (Detail.first.empty() ? "<none>" : Detail.first) << "\n";
+    }
+  }
+}
+
+int main(int argc, char **argv) {
+  InitLLVM X(argc, argv);
+  cl::ParseCommandLineOptions(argc, argv, "Merge -ftime-trace profiles\n");
+
+  Profile Build;
+  size_t NumProfiles = 0;
+  std::mutex Mutex;
+  {
+    ThreadPool Pool(heavyweight_hardware_concurrency(Threads));
+    for (const std::string &File : InputFiles)
+      Pool.async([&, File]() {
+        ErrorOr<std::unique_ptr<MemoryBuffer>> Buffer =
+            MemoryBuffer::getFile(File);
+        if (!Buffer) {
+          std::lock_guard<std::mutex> Lock(Mutex);
+          warn(Buffer.getError().message(), File);
+          return;
+        }
+        Expected<json::Value> Root = json::parse((*Buffer)->getBuffer());
+        if (!Root) {
+          std::lock_guard<std::mutex> Lock(Mutex);
+          warn(toString(Root.takeError()), File);
+          return;
+        }
+        std::vector<Event> Events = collectEvents(*Root);
+        Profile P = analyzeProfile(Events);
+
+        // Report the wall time of each profile, which tells the slowest
+        // translation units of the build.
+        if (!Events.empty()) {
+          uint64_t StartUs = UINT64_MAX, EndUs = 0;
+          for (const Event &E : Events) {
+            StartUs = std::min(StartUs, E.StartUs);
+            EndUs = std::max(EndUs, E.StartUs + E.DurUs);
+          }
+          Cost &C = P.Costs["Translation unit"][File];
+          C.Count = 1;
+          C.InclusiveUs = C.ExclusiveUs = EndUs - StartUs;
+        }
+
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Build.add(P);
+        ++NumProfiles;
+      });
+    Pool.wait();
+  }
+
+  std::error_code EC;
+  raw_fd_ostream OS(OutputFilename, EC, sys::fs::OF_Text);
+  if (EC) {
+    WithColor::error() << OutputFilename << ": " << EC.message() << "\n";
+    return 1;
+  }
+  printReport(Build, NumProfiles, OS);
+  return 0;
+}
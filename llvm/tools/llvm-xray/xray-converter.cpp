@@ -17,6 +17,7 @@
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/ScopedPrinter.h"
 #include "llvm/Support/YAMLTraits.h"
 #include "llvm/Support/raw_ostream.h"
@@ -72,6 +73,13 @@ static cl::opt<bool> ConvertSortInput(
     cl::sub(Convert), cl::init(true));
 static cl::alias ConvertSortInput2("s", cl::aliasopt(ConvertSortInput),
                                    cl::desc("Alias for -sort"));
+static cl::opt<unsigned> ConvertThreads(
+    "threads",
+    cl::desc("number of threads to load the input log with; 0 uses all the "
+             "hardware threads"),
+    cl::sub(Convert), cl::init(0));
+static cl::alias ConvertThreads2("j", cl::aliasopt(ConvertThreads),
+                                 cl::desc("Alias for -threads"));
 
 using llvm::yaml::Output;
 
@@ -388,6 +396,7 @@ static CommandRegistration Unused(&Convert, []() -> Error {
     return make_error<StringError>(
         Twine("Cannot open file '") + ConvertOutput + "' for writing.", EC);
 
+  parallel::strategy = hardware_concurrency(ConvertThreads);
   auto TraceOrErr = loadTraceFile(ConvertInput, ConvertSortInput);
   if (!TraceOrErr)
     return joinErrors(
@@ -1816,6 +1816,50 @@ TEST(APIntTest, SelfMoveAssignment) {
 #endif
 #endif // EXPENSIVE_CHECKS
 
+TEST(APIntTest, InlineStorage) {
+  // Values of up to NumInlineWords words live inside the object.
+  uint64_t Bits[] = {0x0123456789abcdefULL, 0xfedcba9876543210ULL};
+  APInt X(128, Bits);
+  const char *Begin = reinterpret_cast<const char *>(&X);
+  const char *Raw = reinterpret_cast<const char *>(X.getRawData());
+  EXPECT_TRUE(Raw >= Begin && Raw < Begin + sizeof(APInt));
+  EXPECT_FALSE(X.needsCleanup());
+  EXPECT_TRUE(APInt(256, 0).needsCleanup());
+
+  // Copies and moves must not keep pointing into their source.
+  APInt Copy(X);
+  EXPECT_NE(X.getRawData(), Copy.getRawData());
+  APInt Moved(std::move(Copy));
+  EXPECT_EQ(X, Moved);
+  Raw = reinterpret_cast<const char *>(Moved.getRawData());
+  Begin = reinterpret_cast<const char *>(&Moved);
+  EXPECT_TRUE(Raw >= Begin && Raw < Begin + sizeof(APInt));
+
+  APInt Y(96, 7);
+  std::swap(Moved, Y);
+  EXPECT_EQ(APInt(96, 7), Moved);
+  EXPECT_EQ(X, Y);
+
+  // Assignment switches between inline and heap storage as the width
+  // changes.
+  APInt Z(128, 5);
+  Z = APInt::getAllOnesValue(512);
+  EXPECT_TRUE(Z.isAllOnesValue());
+  Z = X;
+  EXPECT_EQ(X, Z);
+  Z = APInt(64, 3);
+  EXPECT_EQ(3u, Z.getZExtValue());
+  Z = APInt::getSignedMinValue(1024);
+  Z = std::move(Y);
+  EXPECT_EQ(X, Z);
+
+  // Results computed into fresh storage.
+  EXPECT_EQ(APInt(128, 6), APInt(128, 2) * APInt(128, 3));
+  EXPECT_EQ(APInt(128, -1, true), APInt(64, -1, true).sext(128));
+  EXPECT_EQ(APInt(128, Bits[0]), X.trunc(64).zext(128));
+  EXPECT_EQ(APInt(100, Bits).zext(128).trunc(100), APInt(100, Bits));
+}
+
 TEST(APIntTest, byteSwap) {
   EXPECT_EQ(0x00000000, APInt(16, 0x0000).byteSwap());
   EXPECT_EQ(0x0000010f, APInt(16, 0x0f01).byteSwap());
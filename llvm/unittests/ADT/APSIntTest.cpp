@@ -33,7 +33,7 @@ TEST(APSIntTest, MoveTest) {
   A = APSInt(64, true);
   EXPECT_TRUE(A.isUnsigned());
 
-  Wide = APInt(128, 1);
+  Wide = APInt(256, 1);
   Bits = Wide.getRawData();
   A = std::move(Wide);
   EXPECT_TRUE(A.isUnsigned());
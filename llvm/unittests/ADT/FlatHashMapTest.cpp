@@ -0,0 +1,183 @@
+//===- llvm/unittest/ADT/FlatHashMapTest.cpp - FlatHashMap unit tests -----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/FlatHashMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "gtest/gtest.h"
+#include <map>
+#include <random>
+#include <string>
+
+using namespace llvm;
+
+namespace {
+
+TEST(FlatHashMapTest, EmptyMap) {
+  FlatHashMap<int, int> Map;
+  EXPECT_TRUE(Map.empty());
+  EXPECT_EQ(0u, Map.size());
+  EXPECT_TRUE(Map.begin() == Map.end());
+  EXPECT_EQ(0u, Map.count(1));
+  EXPECT_TRUE(Map.find(1) == Map.end());
+  EXPECT_EQ(0, Map.lookup(1));
+  EXPECT_FALSE(Map.erase(1));
+  EXPECT_EQ(0u, Map.getMemorySize());
+}
+
+TEST(FlatHashMapTest, InsertFindErase) {
+  FlatHashMap<int, int> Map;
+  EXPECT_TRUE(Map.insert({1, 10}).second);
+  EXPECT_FALSE(Map.insert({1, 11}).second);
+  EXPECT_TRUE(Map.try_emplace(2, 20).second);
+  Map[3] = 30;
+  EXPECT_EQ(3u, Map.size());
+  EXPECT_EQ(10, Map.lookup(1));
+  EXPECT_EQ(20, Map.find(2)->second);
+  EXPECT_EQ(30, Map[3]);
+  EXPECT_EQ(1u, Map.count(3));
+
+  EXPECT_TRUE(Map.erase(1));
+  EXPECT_FALSE(Map.erase(1));
+  Map.erase(Map.find(2));
+  EXPECT_EQ(1u, Map.size());
+  EXPECT_EQ(0u, Map.count(1));
+  EXPECT_EQ(0u, Map.count(2));
+  EXPECT_EQ(30, Map.lookup(3));
+
+  Map.clear();
+  EXPECT_TRUE(Map.empty());
+  EXPECT_EQ(0u, Map.count(3));
+}
+
+TEST(FlatHashMapTest, Iteration) {
+  FlatHashMap<unsigned, unsigned> Map;
+  for (unsigned I = 0; I != 100; ++I)
+    Map[I] = I * 2;
+  std::vector<bool> Seen(100);
+  for (auto &KV : Map) {
+    EXPECT_EQ(KV.getFirst() * 2, KV.getSecond());
+    EXPECT_FALSE(Seen[KV.first]);
+    Seen[KV.first] = true;
+  }
+  EXPECT_EQ(100u, std::count(Seen.begin(), Seen.end(), true));
+
+  const FlatHashMap<unsigned, unsigned> &ConstMap = Map;
+  FlatHashMap<unsigned, unsigned>::const_iterator I = Map.find(5);
+  EXPECT_TRUE(I == ConstMap.find(5));
+  EXPECT_EQ(100, std::distance(ConstMap.begin(), ConstMap.end()));
+}
+
+TEST(FlatHashMapTest, CopyAndMove) {
+  FlatHashMap<StringRef, std::string> Map = {{"a", "x"}, {"b", "y"}};
+  FlatHashMap<StringRef, std::string> Copy(Map);
+  EXPECT_EQ(2u, Copy.size());
+  EXPECT_EQ("x", Copy.lookup("a"));
+  Copy["c"] = "z";
+  EXPECT_EQ(0u, Map.count("c"));
+
+  FlatHashMap<StringRef, std::string> Moved(std::move(Copy));
+  EXPECT_EQ(3u, Moved.size());
+  EXPECT_EQ("z", Moved.lookup("c"));
+
+  Map = Moved;
+  EXPECT_EQ(3u, Map.size());
+  Moved = FlatHashMap<StringRef, std::string>();
+  EXPECT_TRUE(Moved.empty());
+  EXPECT_EQ("y", Map.lookup("b"));
+}
+
+// Counts the live objects to check that the map destroys all it constructs.
+struct Counted {
+  static int Live;
+  int Value;
+  Counted(int Value = 0) : Value(Value) { ++Live; }
+  Counted(const Counted &Other) : Value(Other.Value) { ++Live; }
+  ~Counted() { --Live; }
+};
+int Counted::Live = 0;
+
+TEST(FlatHashMapTest, ConstructsAndDestroys) {
+  {
+    FlatHashMap<int, Counted> Map;
+    for (int I = 0; I != 1000; ++I)
+      Map.try_emplace(I, I);
+    for (int I = 0; I != 1000; I += 2)
+      Map.erase(I);
+    EXPECT_EQ(500, Counted::Live);
+    FlatHashMap<int, Counted> Copy(Map);
+    EXPECT_EQ(1000, Counted::Live);
+    Copy.clear();
+    EXPECT_EQ(500, Counted::Live);
+  }
+  EXPECT_EQ(0, Counted::Live);
+}
+
+// Inserting and erasing without growing the map reuses its buckets.
+TEST(FlatHashMapTest, ReusesErasedBuckets) {
+  FlatHashMap<unsigned, unsigned> Map;
+  Map.reserve(100);
+  size_t MemorySize = Map.getMemorySize();
+  for (unsigned I = 0; I != 100000; ++I) {
+    Map[I] = I;
+    if (I >= 50) {
+      EXPECT_TRUE(Map.erase(I - 50));
+    }
+  }
+  EXPECT_EQ(50u, Map.size());
+  EXPECT_EQ(MemorySize, Map.getMemorySize());
+}
+
+struct ConstantHashInfo {
+  static unsigned getHashValue(unsigned) { return 42; }
+  static unsigned getHashValue(StringRef) { return 42; }
+  static bool isEqual(unsigned LHS, unsigned RHS) { return LHS == RHS; }
+  static bool isEqual(StringRef LHS, unsigned RHS) {
+    return LHS == std::to_string(RHS);
+  }
+};
+
+// All keys collide, so lookups probe every group.
+TEST(FlatHashMapTest, Collisions) {
+  FlatHashMap<unsigned, unsigned, ConstantHashInfo> Map;
+  for (unsigned I = 0; I != 200; ++I)
+    Map[I] = I;
+  for (unsigned I = 0; I < 200; I += 3)
+    Map.erase(I);
+  for (unsigned I = 0; I != 200; ++I)
+    EXPECT_EQ(I % 3 != 0, Map.count(I) == 1);
+  EXPECT_EQ(7u, Map.find_as(StringRef("7"))->second);
+  EXPECT_TRUE(Map.find_as(StringRef("9")) == Map.end());
+}
+
+TEST(FlatHashMapTest, RandomOperations) {
+  std::mt19937 Rng(0);
+  FlatHashMap<uint64_t, uint64_t> Map;
+  std::map<uint64_t, uint64_t> Reference;
+  for (unsigned Step = 0; Step != 100000; ++Step) {
+    uint64_t Key = Rng() % 5000;
+    switch (Rng() % 3) {
+    case 0:
+      Map[Key] = Step;
+      Reference[Key] = Step;
+      break;
+    case 1:
+      EXPECT_EQ(Reference.erase(Key) == 1, Map.erase(Key));
+      break;
+    case 2: {
+      auto It = Reference.find(Key);
+      EXPECT_EQ(It == Reference.end() ? 0 : It->second, Map.lookup(Key));
+      break;
+    }
+    }
+  }
+  EXPECT_EQ(Reference.size(), Map.size());
+  for (auto &KV : Map)
+    EXPECT_EQ(Reference[KV.first], KV.second);
+}
+
+} // end anonymous namespace
@@ -7,8 +7,10 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
+#include <thread>
 using namespace llvm;
 
 using OptionalStatistic = Optional<std::pair<StringRef, unsigned>>;
@@ -18,6 +20,7 @@ namespace {
 STATISTIC(Counter, "Counts things");
 STATISTIC(Counter2, "Counts other things");
 ALWAYS_ENABLED_STATISTIC(AlwaysCounter, "Counts things always");
+SHARDED_STATISTIC(ShardedCounter, "Counts things from many threads");
 
 #if LLVM_ENABLE_STATS
 static void
@@ -168,4 +171,70 @@ TEST(StatisticTest, API) {
 #endif
 }
 
+TEST(StatisticTest, Sharded) {
+  EnableStatistics();
+  ResetStatistics();
+
+  EXPECT_EQ(ShardedCounter, 0u);
+  EXPECT_EQ(ShardedCounter++, 0u);
+  ++ShardedCounter;
+  ShardedCounter += 5;
+  EXPECT_EQ(ShardedCounter--, 7u);
+  ShardedCounter -= 2;
+  EXPECT_EQ(ShardedCounter, 4u);
+
+  ShardedCounter.updateMax(3);
+  EXPECT_EQ(ShardedCounter, 4u);
+  ShardedCounter.updateMax(9);
+  EXPECT_EQ(ShardedCounter, 9u);
+  ShardedCounter = 2;
+  ++ShardedCounter;
+  EXPECT_EQ(ShardedCounter, 3u);
+
+  // Sharded statistics are reported along with the others, and are available
+  // in release builds.
+  {
+    auto Range = GetStatistics();
+    auto It = llvm::find_if(Range, [](const std::pair<StringRef, unsigned> &S) {
+      return S.first == "ShardedCounter";
+    });
+    ASSERT_NE(It, Range.end());
+    EXPECT_EQ(It->second, 3u);
+
+    auto Qualified = GetQualifiedStatistics();
+    EXPECT_TRUE(llvm::is_contained(
+        Qualified, std::make_pair(std::string("unittest.ShardedCounter"), 3u)));
+  }
+
+  ResetStatistics();
+  EXPECT_EQ(ShardedCounter, 0u);
+  EXPECT_TRUE(GetQualifiedStatistics().empty());
+  ++ShardedCounter;
+  EXPECT_EQ(ShardedCounter, 1u);
+  EXPECT_EQ(GetStatistics().size(), 1u);
+  ResetStatistics();
+}
+
+TEST(StatisticTest, ShardedThreads) {
+  EnableStatistics();
+  ResetStatistics();
+
+  // The counts of every thread are kept after it exits.
+  std::vector<std::thread> Threads;
+  for (unsigned I = 0; I != 4; ++I)
+    Threads.emplace_back([] {
+      for (unsigned J = 0; J != 10000; ++J)
+        ++ShardedCounter;
+    });
+  for (std::thread &T : Threads)
+    T.join();
+  EXPECT_EQ(ShardedCounter, 40000u);
+
+  // Assignment and reset clear the shards of all threads.
+  ShardedCounter = 5;
+  EXPECT_EQ(ShardedCounter, 5u);
+  ResetStatistics();
+  EXPECT_EQ(ShardedCounter, 0u);
+}
+
 } // end anonymous namespace
@@ -89,5 +89,20 @@ define internal i32 @top() {
   EXPECT_EQ(BranchesFeatures.StoreInstCount, 0);
   EXPECT_EQ(BranchesFeatures.MaxLoopDepth, 0);
   EXPECT_EQ(BranchesFeatures.TopLevelLoopCount, 0);
+  EXPECT_EQ(BranchesFeatures.EntryCount, 0);
+}
+
+TEST_F(FunctionPropertiesAnalysisTest, EntryCount) {
+  LLVMContext C;
+  std::unique_ptr<Module> M = makeLLVMModule(C,
+                                             R"IR(
+define void @hot() !prof !0 {
+  ret void
+}
+!0 = !{!"function_entry_count", i64 1000}
+)IR");
+
+  FunctionPropertiesInfo HotFeatures = buildFPI(*M->getFunction("hot"));
+  EXPECT_EQ(HotFeatures.EntryCount, 1000);
 }
 } // end anonymous namespace
\ No newline at end of file
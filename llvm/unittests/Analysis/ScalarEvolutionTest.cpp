@@ -1421,4 +1421,51 @@ TEST_F(ScalarEvolutionsTest, MatchURem) {
   });
 }
 
+TEST_F(ScalarEvolutionsTest, ForgetNestedLoopDispositions) {
+  LLVMContext C;
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(
+      "define void @foo(i32* %p, i32 %n) { "
+      "entry: "
+      "  br label %outer "
+      "outer: "
+      "  %i = phi i32 [ 0, %entry ], [ %i.next, %outer.latch ] "
+      "  br label %inner "
+      "inner: "
+      "  %j = phi i32 [ 0, %outer ], [ %j.next, %inner ] "
+      "  %x = load i32, i32* %p "
+      "  %j.next = add i32 %j, 1 "
+      "  %c = icmp slt i32 %j.next, %x "
+      "  br i1 %c, label %inner, label %outer.latch "
+      "outer.latch: "
+      "  %i.next = add i32 %i, 1 "
+      "  %c2 = icmp slt i32 %i.next, %n "
+      "  br i1 %c2, label %outer, label %exit "
+      "exit: "
+      "  ret void "
+      "} ",
+      Err, C);
+
+  ASSERT_TRUE(M && "Could not parse module?");
+  ASSERT_TRUE(!verifyModule(*M) && "Must have been well formed!");
+
+  runWithSE(*M, "foo", [](Function &F, LoopInfo &LI, ScalarEvolution &SE) {
+    auto *X = getInstructionByName(F, "x");
+    const Loop *Inner = LI.getLoopFor(X->getParent());
+    const Loop *Outer = Inner->getParentLoop();
+    ASSERT_NE(Outer, nullptr);
+
+    const SCEV *S = SE.getSCEV(X);
+    EXPECT_FALSE(SE.isLoopInvariant(S, Inner));
+    EXPECT_FALSE(SE.isLoopInvariant(S, Outer));
+
+    // Hoist the load into the preheader of the inner loop, which is still
+    // part of the outer loop.
+    X->moveBefore(Inner->getLoopPreheader()->getTerminator());
+    SE.forgetLoopDispositions(Inner);
+    EXPECT_TRUE(SE.isLoopInvariant(S, Inner));
+    EXPECT_FALSE(SE.isLoopInvariant(S, Outer));
+  });
+}
+
 }  // end namespace llvm
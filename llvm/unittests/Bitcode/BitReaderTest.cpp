@@ -11,10 +11,12 @@
 #include "llvm/AsmParser/Parser.h"
 #include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/DebugInfoMetadata.h"
 #include "llvm/IR/InstrTypes.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -122,6 +124,120 @@ TEST(BitReaderTest, MaterializeFunctionsOutOfOrder) {
   EXPECT_FALSE(verifyModule(*M, &dbgs()));
 }
 
+// Tests that bodies decoded ahead of time on another thread are parsed like
+// those read from the stream.
+TEST(BitReaderTest, MaterializeFunctionsPrefetched) {
+  const char *Assembly = "define i32 @f(i32 %x) {\n"
+                         "entry:\n"
+                         "  %a = add i32 %x, 42, !md !0\n"
+                         "  br label %loop\n"
+                         "loop:\n"
+                         "  %i = phi i32 [ %a, %entry ], [ %j, %loop ]\n"
+                         "  %j = call i32 @g(i32 %i)\n"
+                         "  %c = icmp eq i32 %j, 7\n"
+                         "  br i1 %c, label %exit, label %loop\n"
+                         "exit:\n"
+                         "  ret i32 %j\n"
+                         "}\n"
+                         "declare void @d()\n"
+                         "define i32 @g(i32 %y) {\n"
+                         "  %b = mul i32 %y, 3\n"
+                         "  call void @d()\n"
+                         "  ret i32 %b\n"
+                         "}\n"
+                         "define i32 @h() {\n"
+                         "  %r = call i32 @f(i32 1)\n"
+                         "  ret i32 %r\n"
+                         "}\n"
+                         "!0 = !{!\"md\"}\n";
+  auto print = [](Module &M) {
+    std::string S;
+    raw_string_ostream OS(S);
+    M.print(OS, nullptr);
+    return OS.str();
+  };
+
+  LLVMContext Context;
+  SmallString<1024> Mem;
+  std::unique_ptr<Module> Expected =
+      getLazyModuleFromAssembly(Context, Mem, Assembly);
+  ASSERT_FALSE(Expected->materializeAll());
+
+  auto &Prefetch = *static_cast<cl::opt<bool> *>(
+      cl::getRegisteredOptions()["bitcode-prefetch-function-bodies"]);
+  Prefetch = true;
+  SmallString<1024> PrefetchMem;
+  LLVMContext PrefetchContext;
+  std::unique_ptr<Module> M =
+      getLazyModuleFromAssembly(PrefetchContext, PrefetchMem, Assembly);
+  // Materializing f prefetches g, and g prefetches h for materializeAll.
+  ASSERT_FALSE(M->getFunction("f")->materialize());
+  ASSERT_FALSE(M->getFunction("g")->materialize());
+  ASSERT_FALSE(M->materializeAll());
+  Prefetch = false;
+  EXPECT_FALSE(verifyModule(*M, &dbgs()));
+  EXPECT_EQ(print(*Expected), print(*M));
+}
+
+// Tests that named types without an ODR identifier can be imported as
+// declarations.
+TEST(BitReaderTest, ImportLocalTypeDeclarations) {
+  const char *Assembly =
+      "define void @f(i8* %s) !dbg !4 {\n"
+      "  ret void\n"
+      "}\n"
+      "!llvm.dbg.cu = !{!0}\n"
+      "!llvm.module.flags = !{!3}\n"
+      "!0 = distinct !DICompileUnit(language: DW_LANG_C99, file: !1, "
+      "emissionKind: FullDebug)\n"
+      "!1 = !DIFile(filename: \"t.c\", directory: \"/\")\n"
+      "!3 = !{i32 2, !\"Debug Info Version\", i32 3}\n"
+      "!4 = distinct !DISubprogram(name: \"f\", scope: !1, file: !1, "
+      "type: !5, unit: !0, spFlags: DISPFlagDefinition)\n"
+      "!5 = !DISubroutineType(types: !6)\n"
+      "!6 = !{null, !7}\n"
+      "!7 = !DIDerivedType(tag: DW_TAG_pointer_type, baseType: !8, "
+      "size: 64)\n"
+      "!8 = !DICompositeType(tag: DW_TAG_structure_type, name: \"S\", "
+      "file: !1, size: 32, elements: !9)\n"
+      "!9 = !{!10}\n"
+      "!10 = !DIDerivedType(tag: DW_TAG_member, name: \"x\", scope: !8, "
+      "file: !1, baseType: !11, size: 32)\n"
+      "!11 = !DIBasicType(name: \"int\", size: 32, encoding: "
+      "DW_ATE_signed)\n";
+  LLVMContext Context;
+  SmallString<1024> Mem;
+  writeModuleToBuffer(parseAssembly(Context, Assembly), Mem);
+  auto importStruct = [&](LLVMContext &Context) {
+    Expected<std::unique_ptr<Module>> M = getLazyBitcodeModule(
+        MemoryBufferRef(Mem.str(), "test"), Context,
+        /*ShouldLazyLoadMetadata=*/true, /*IsImporting=*/true);
+    if (!M)
+      report_fatal_error("Could not parse bitcode module");
+    Function *F = (*M)->getFunction("f");
+    if (F->materialize())
+      report_fatal_error("Could not materialize f");
+    auto *Ptr = cast<DIDerivedType>(
+        F->getSubprogram()->getType()->getTypeArray()[1]);
+    return cast<DICompositeType>(Ptr->getBaseType());
+  };
+
+  LLVMContext FullContext;
+  DICompositeType *Full = importStruct(FullContext);
+  EXPECT_FALSE(Full->isForwardDecl());
+  EXPECT_EQ(1u, Full->getElements().size());
+
+  auto &ImportDeclarations = *static_cast<cl::opt<bool> *>(
+      cl::getRegisteredOptions()["import-local-type-declarations"]);
+  ImportDeclarations = true;
+  LLVMContext DeclContext;
+  DICompositeType *Decl = importStruct(DeclContext);
+  ImportDeclarations = false;
+  EXPECT_TRUE(Decl->isForwardDecl());
+  EXPECT_EQ("S", Decl->getName());
+  EXPECT_EQ(0u, Decl->getElements().size());
+}
+
 TEST(BitReaderTest, MaterializeFunctionsStrictFP) {
   SmallString<1024> Mem;
 
@@ -9,6 +9,7 @@
 #include "llvm/Bitstream/BitstreamReader.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Bitstream/BitstreamWriter.h"
+#include "llvm/Support/Compression.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -151,6 +152,81 @@ TEST(BitstreamReaderTest, readRecordWithBlobWhileStreaming) {
   }
 }
 
+static void writeCompressibleBlocks(SmallVectorImpl<char> &Buffer,
+                                    Optional<compression::Format> Compression) {
+  BitstreamWriter Stream(Buffer);
+  Stream.EnterSubblock(bitc::FIRST_APPLICATION_BLOCKID, 3);
+  Stream.EmitRecord(1, makeArrayRef<unsigned>({7}));
+  Stream.EnterSubblock(bitc::FIRST_APPLICATION_BLOCKID + 1, 4, Compression);
+  for (unsigned I = 0; I != 100; ++I)
+    Stream.EmitRecord(2, makeArrayRef<unsigned>({1, 2, 3}));
+  Stream.EnterSubblock(bitc::FIRST_APPLICATION_BLOCKID + 2, 3);
+  Stream.EmitRecord(3, makeArrayRef<unsigned>({9}));
+  Stream.ExitBlock();
+  Stream.ExitBlock();
+  Stream.EmitRecord(4, makeArrayRef<unsigned>({8}));
+  Stream.ExitBlock();
+}
+
+static void expectRecord(BitstreamCursor &Stream, unsigned Code,
+                         uint64_t Value) {
+  Expected<BitstreamEntry> MaybeEntry = Stream.advance();
+  ASSERT_TRUE((bool)MaybeEntry);
+  ASSERT_EQ(BitstreamEntry::Record, MaybeEntry->Kind);
+  SmallVector<uint64_t, 4> Record;
+  Expected<unsigned> MaybeCode = Stream.readRecord(MaybeEntry->ID, Record);
+  ASSERT_TRUE((bool)MaybeCode);
+  EXPECT_EQ(Code, MaybeCode.get());
+  ASSERT_FALSE(Record.empty());
+  EXPECT_EQ(Value, Record[0]);
+}
+
+static void expectEntry(BitstreamCursor &Stream, unsigned Kind,
+                        unsigned ID = 0) {
+  Expected<BitstreamEntry> MaybeEntry = Stream.advance();
+  ASSERT_TRUE((bool)MaybeEntry);
+  EXPECT_EQ(Kind, unsigned(MaybeEntry->Kind));
+  if (Kind == BitstreamEntry::SubBlock)
+    EXPECT_EQ(ID, MaybeEntry->ID);
+}
+
+TEST(BitstreamReaderTest, compressedBlock) {
+  if (!compression::zlib::isAvailable())
+    return;
+  SmallVector<char, 0> Plain, Compressed;
+  writeCompressibleBlocks(Plain, None);
+  writeCompressibleBlocks(Compressed, compression::Format::Zlib);
+  EXPECT_LT(Compressed.size(), Plain.size());
+
+  for (bool Skip : {false, true}) {
+    BitstreamCursor Stream(ArrayRef<uint8_t>(
+        (const uint8_t *)Compressed.begin(), Compressed.size()));
+    expectEntry(Stream, BitstreamEntry::SubBlock,
+                bitc::FIRST_APPLICATION_BLOCKID);
+    ASSERT_FALSE(Stream.EnterSubBlock(bitc::FIRST_APPLICATION_BLOCKID));
+    expectRecord(Stream, 1, 7);
+    expectEntry(Stream, BitstreamEntry::SubBlock,
+                bitc::FIRST_APPLICATION_BLOCKID + 1);
+    if (Skip) {
+      ASSERT_FALSE(Stream.SkipBlock());
+    } else {
+      ASSERT_FALSE(Stream.EnterSubBlock(bitc::FIRST_APPLICATION_BLOCKID + 1));
+      for (unsigned I = 0; I != 100; ++I)
+        expectRecord(Stream, 2, 1);
+      expectEntry(Stream, BitstreamEntry::SubBlock,
+                  bitc::FIRST_APPLICATION_BLOCKID + 2);
+      ASSERT_FALSE(Stream.EnterSubBlock(bitc::FIRST_APPLICATION_BLOCKID + 2));
+      expectRecord(Stream, 3, 9);
+      expectEntry(Stream, BitstreamEntry::EndBlock);
+      expectEntry(Stream, BitstreamEntry::EndBlock);
+    }
+    // Reading resumes after the compressed block.
+    expectRecord(Stream, 4, 8);
+    expectEntry(Stream, BitstreamEntry::EndBlock);
+    EXPECT_TRUE(Stream.AtEndOfStream());
+  }
+}
+
 TEST(BitstreamReaderTest, shortRead) {
   uint8_t Bytes[] = {8, 7, 6, 5, 4, 3, 2, 1};
   for (unsigned I = 1; I != 8; ++I) {
@@ -1277,6 +1277,80 @@ TEST(DWARFDebugInfo, TestRelations) {
   }
 }
 
+TEST(DWARFDebugInfo, TestSubroutineForAddress) {
+  Triple Triple = getNormalizedDefaultTargetTriple();
+  if (!isConfigurationSupported(Triple))
+    return;
+
+  uint16_t Version = 4;
+  auto ExpectedDG = dwarfgen::Generator::create(Triple, Version);
+  ASSERT_THAT_EXPECTED(ExpectedDG, Succeeded());
+  dwarfgen::Generator *DG = ExpectedDG.get().get();
+  dwarfgen::CompileUnit &CU = DG->addCompileUnit();
+
+  // Create DWARF tree that looks like:
+  //
+  // CU
+  //   namespace
+  //     main        [0x1000, 0x2000)
+  //       inlined   [0x1100, 0x1200)
+  //   other         [0x3000, 0x3100)
+  //     inlined     [0x3000, 0x3010)
+  //     inlined     [0x3008, 0x3020)
+  {
+    dwarfgen::DIE CUDie = CU.getUnitDIE();
+    CUDie.addAttribute(DW_AT_name, DW_FORM_string, "/tmp/main.cpp");
+    dwarfgen::DIE NamespaceDie = CUDie.addChild(DW_TAG_namespace);
+    NamespaceDie.addAttribute(DW_AT_name, DW_FORM_string, "ns");
+    dwarfgen::DIE MainDie = NamespaceDie.addChild(DW_TAG_subprogram);
+    MainDie.addAttribute(DW_AT_name, DW_FORM_string, "main");
+    MainDie.addAttribute(DW_AT_low_pc, DW_FORM_addr, 0x1000U);
+    MainDie.addAttribute(DW_AT_high_pc, DW_FORM_data4, 0x1000U);
+    dwarfgen::DIE InlinedDie = MainDie.addChild(DW_TAG_inlined_subroutine);
+    InlinedDie.addAttribute(DW_AT_low_pc, DW_FORM_addr, 0x1100U);
+    InlinedDie.addAttribute(DW_AT_high_pc, DW_FORM_data4, 0x100U);
+    InlinedDie.addAttribute(DW_AT_call_line, DW_FORM_udata, 1000U);
+    dwarfgen::DIE OtherDie = CUDie.addChild(DW_TAG_subprogram);
+    OtherDie.addAttribute(DW_AT_name, DW_FORM_string, "other");
+    OtherDie.addAttribute(DW_AT_low_pc, DW_FORM_addr, 0x3000U);
+    OtherDie.addAttribute(DW_AT_high_pc, DW_FORM_data4, 0x100U);
+    dwarfgen::DIE First = OtherDie.addChild(DW_TAG_inlined_subroutine);
+    First.addAttribute(DW_AT_low_pc, DW_FORM_addr, 0x3000U);
+    First.addAttribute(DW_AT_high_pc, DW_FORM_data4, 0x10U);
+    dwarfgen::DIE Second = OtherDie.addChild(DW_TAG_inlined_subroutine);
+    Second.addAttribute(DW_AT_low_pc, DW_FORM_addr, 0x3008U);
+    Second.addAttribute(DW_AT_high_pc, DW_FORM_data4, 0x18U);
+  }
+
+  MemoryBufferRef FileBuffer(DG->generate(), "dwarf");
+  auto Obj = object::ObjectFile::createObjectFile(FileBuffer);
+  EXPECT_TRUE((bool)Obj);
+  std::unique_ptr<DWARFContext> DwarfContext = DWARFContext::create(**Obj);
+  DWARFCompileUnit *U = DwarfContext->getCompileUnitForOffset(0);
+  ASSERT_NE(U, nullptr);
+
+  auto CUDie = U->getUnitDIE(false);
+  auto MainDie = CUDie.getFirstChild().getFirstChild();
+  auto InlinedDie = MainDie.getFirstChild();
+  auto OtherDie = CUDie.getFirstChild().getSibling();
+  auto First = OtherDie.getFirstChild();
+  auto Second = First.getSibling();
+
+  // The first lookups in the unit walk the DIE tree and the following ones use
+  // the address map, both must agree.
+  for (unsigned I = 0; I != 8; ++I) {
+    EXPECT_FALSE(U->getSubroutineForAddress(0x800).isValid());
+    EXPECT_EQ(U->getSubroutineForAddress(0x1000), MainDie);
+    EXPECT_EQ(U->getSubroutineForAddress(0x1180), InlinedDie);
+    EXPECT_EQ(U->getSubroutineForAddress(0x1200), MainDie);
+    EXPECT_FALSE(U->getSubroutineForAddress(0x2000).isValid());
+    EXPECT_EQ(U->getSubroutineForAddress(0x3004), First);
+    // Overlapping siblings resolve to the last one.
+    EXPECT_EQ(U->getSubroutineForAddress(0x300c), Second);
+    EXPECT_EQ(U->getSubroutineForAddress(0x3080), OtherDie);
+  }
+}
+
 TEST(DWARFDebugInfo, TestDWARFDie) {
   // Make sure a default constructed DWARFDie doesn't have any parent, sibling
   // or child;
@@ -1919,6 +1993,93 @@ TEST(DWARFDebugInfo, TestDwarfVerifyInvalidCURef) {
                              "0x0000001a):");
 }
 
+TEST(DWARFDebugInfo, TestDwarfVerifyInParallel) {
+  // Create three compile units, each with a function that has an invalid CU
+  // relative DW_AT_type. Verifying the units in parallel must report the
+  // errors in the same order as verifying them one at a time.
+  const char *yamldata = R"(
+    debug_str:
+      - ''
+      - /tmp/main.c
+      - main
+    debug_abbrev:
+      - Table:
+          - Code:            0x00000001
+            Tag:             DW_TAG_compile_unit
+            Children:        DW_CHILDREN_yes
+            Attributes:
+              - Attribute:       DW_AT_name
+                Form:            DW_FORM_strp
+          - Code:            0x00000002
+            Tag:             DW_TAG_subprogram
+            Children:        DW_CHILDREN_no
+            Attributes:
+              - Attribute:       DW_AT_name
+                Form:            DW_FORM_strp
+              - Attribute:       DW_AT_type
+                Form:            DW_FORM_ref4
+    debug_info:
+      - Version:         4
+        AddrSize:        8
+        Entries:
+          - AbbrCode:        0x00000001
+            Values:
+              - Value:           0x0000000000000001
+          - AbbrCode:        0x00000002
+            Values:
+              - Value:           0x000000000000000D
+              - Value:           0x0000000000001234
+          - AbbrCode:        0x00000000
+      - Version:         4
+        AddrSize:        8
+        Entries:
+          - AbbrCode:        0x00000001
+            Values:
+              - Value:           0x0000000000000001
+          - AbbrCode:        0x00000002
+            Values:
+              - Value:           0x000000000000000D
+              - Value:           0x0000000000002345
+          - AbbrCode:        0x00000000
+      - Version:         4
+        AddrSize:        8
+        Entries:
+          - AbbrCode:        0x00000001
+            Values:
+              - Value:           0x0000000000000001
+          - AbbrCode:        0x00000002
+            Values:
+              - Value:           0x000000000000000D
+              - Value:           0x0000000000003456
+          - AbbrCode:        0x00000000
+  )";
+  auto ErrOrSections = DWARFYAML::emitDebugSections(StringRef(yamldata));
+  ASSERT_TRUE((bool)ErrOrSections);
+
+  auto Verify = [&](unsigned NumThreads) {
+    std::unique_ptr<DWARFContext> DwarfContext =
+        DWARFContext::create(*ErrOrSections, 8);
+    DIDumpOptions DumpOpts;
+    DumpOpts.VerifyNumThreads = NumThreads;
+    std::string Str;
+    raw_string_ostream Strm(Str);
+    EXPECT_FALSE(DwarfContext->verify(Strm, DumpOpts));
+    return Strm.str();
+  };
+  std::string Sequential = Verify(1);
+  std::string Parallel = Verify(4);
+  EXPECT_EQ(Sequential, Parallel);
+
+  size_t First = Parallel.find("CU offset 0x00001234 is invalid");
+  size_t Second = Parallel.find("CU offset 0x00002345 is invalid");
+  size_t Third = Parallel.find("CU offset 0x00003456 is invalid");
+  ASSERT_NE(First, std::string::npos);
+  ASSERT_NE(Second, std::string::npos);
+  ASSERT_NE(Third, std::string::npos);
+  EXPECT_LT(First, Second);
+  EXPECT_LT(Second, Third);
+}
+
 TEST(DWARFDebugInfo, TestDwarfVerifyInvalidRefAddr) {
   // Create a single compile unit with a single function that has an invalid
   // DW_AT_type with an invalid .debug_info offset in its DW_FORM_ref_addr.
@@ -1148,6 +1148,48 @@ static void TestEncodeDecode(const GsymCreator &GC,
   Compare(GC, GR.get());
 }
 
+TEST(GSYMTest, TestGsymCreatorFinalizePrunes) {
+  GsymCreator GC;
+  const uint32_t FooName = GC.insertString("foo");
+  const uint32_t BarName = GC.insertString("bar");
+  const uint32_t BazName = GC.insertString("baz");
+  const uint32_t FileIdx = GC.insertFile("/tmp/main.c");
+  auto makeFunctionInfo = [&](uint64_t Addr, uint64_t Size, uint32_t Name) {
+    FunctionInfo FI(Addr, Size, Name);
+    FI.OptLineTable = LineTable();
+    FI.OptLineTable->push(LineEntry(Addr, FileIdx, 10));
+    return FI;
+  };
+  // Functions from debug info, added in bulk in no particular order, and
+  // from the symbol table. Symbols covered by debug info and exact duplicates
+  // are removed, as are symbols without a size at the start of another
+  // function.
+  std::vector<FunctionInfo> FIs;
+  FIs.push_back(makeFunctionInfo(0x1020, 0x10, BazName));
+  FIs.push_back(makeFunctionInfo(0x1000, 0x10, FooName));
+  FIs.push_back(makeFunctionInfo(0x1010, 0x10, BarName));
+  FIs.push_back(makeFunctionInfo(0x1000, 0x10, FooName));
+  GC.addFunctionInfos(std::move(FIs));
+  EXPECT_TRUE(FIs.empty());
+  GC.addFunctionInfo(FunctionInfo(0x1000, 0x10, FooName));
+  GC.addFunctionInfo(FunctionInfo(0x1010, 0x10, BarName));
+  GC.addFunctionInfo(FunctionInfo(0x1020, 0, BazName));
+  GC.addFunctionInfo(FunctionInfo(0x1040, 0x10, FooName));
+  EXPECT_EQ(GC.getNumFunctionInfos(), 8u);
+  Error Err = GC.finalize(llvm::nulls());
+  ASSERT_FALSE(Err);
+  EXPECT_EQ(GC.getNumFunctionInfos(), 4u);
+
+  std::vector<uint64_t> StartAddrs;
+  GC.forEachFunctionInfo([&](const FunctionInfo &FI) {
+    StartAddrs.push_back(FI.startAddress());
+    EXPECT_EQ(FI.hasRichInfo(), FI.startAddress() != 0x1040);
+    return true;
+  });
+  EXPECT_EQ(StartAddrs,
+            std::vector<uint64_t>({0x1000, 0x1010, 0x1020, 0x1040}));
+}
+
 TEST(GSYMTest, TestGsymCreator1ByteAddrOffsets) {
   uint8_t UUID[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
   GsymCreator GC;
@@ -8,6 +8,7 @@
 
 #include "llvm/Demangle/Demangle.h"
 #include "gmock/gmock.h"
+#include <cstdlib>
 
 using namespace llvm;
 
@@ -22,3 +23,40 @@ TEST(Demangle, demangleTest) {
   EXPECT_EQ(demangle("?foo@@YAXH@Z"), "void __cdecl foo(int)");
   EXPECT_EQ(demangle("foo"), "foo");
 }
+
+TEST(Demangle, itaniumDemangleContextTest) {
+  // Interleave valid and invalid names, short and long ones, so that the
+  // context has to recover from failures and grow its buffers.
+  std::string Long = "_Z1f";
+  for (int I = 0; I != 200; ++I)
+    Long += "N1a1bE";
+  const char *Names[] = {"_Z3fooi",
+                         "_ZN1AcvT_Ev",
+                         "_Z3barv",
+                         "not mangled",
+                         Long.c_str(),
+                         "_ZNSt6vectorIiSaIiEE9push_backERKi",
+                         "_Z",
+                         "_Z3fooi"};
+  ItaniumDemangleContext Context;
+  for (int Round = 0; Round != 2; ++Round) {
+    for (const char *Name : Names) {
+      int Status, ExpectedStatus;
+      size_t N;
+      char *Expected = itaniumDemangle(Name, nullptr, nullptr, &ExpectedStatus);
+      const char *Demangled = Context.demangle(Name, &N, &Status);
+      EXPECT_EQ(ExpectedStatus, Status);
+      if (Expected) {
+        ASSERT_NE(nullptr, Demangled);
+        EXPECT_EQ(std::string(Expected), std::string(Demangled, N));
+      } else {
+        EXPECT_EQ(nullptr, Demangled);
+      }
+      std::free(Expected);
+    }
+  }
+
+  ItaniumDemangleContext Moved(std::move(Context));
+  EXPECT_STREQ("foo(int)", Moved.demangle("_Z3fooi"));
+  EXPECT_EQ(nullptr, Context.demangle("_Z3fooi"));
+}
@@ -0,0 +1,81 @@
+//===-- JITLinkMemoryManagerTest.cpp - Unit tests for JIT memory managers -===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/JITLink/JITLinkMemoryManager.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Testing/Support/Error.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::jitlink;
+
+static auto RWFlags =
+    sys::Memory::ProtectionFlags(sys::Memory::MF_READ | sys::Memory::MF_WRITE);
+static auto RFlags = sys::Memory::ProtectionFlags(sys::Memory::MF_READ);
+
+TEST(InProcessSlabMemoryManagerTest, AllocateFinalizeAndReuse) {
+  uint64_t PageSize = sys::Process::getPageSizeEstimate();
+  auto MemMgr = InProcessSlabMemoryManager::Create(4 * PageSize);
+  ASSERT_THAT_EXPECTED(MemMgr, Succeeded());
+
+  JITLinkMemoryManager::SegmentsRequestMap Request;
+  Request[RWFlags] = {8, 16, 32};
+  Request[RFlags] = {8, 100, 0};
+
+  auto Alloc = (*MemMgr)->allocate(nullptr, Request);
+  ASSERT_THAT_EXPECTED(Alloc, Succeeded());
+
+  // Each segment gets its own page aligned range, zero-fill included.
+  auto RWMem = (*Alloc)->getWorkingMemory(RWFlags);
+  auto RMem = (*Alloc)->getWorkingMemory(RFlags);
+  EXPECT_EQ(RWMem.size(), PageSize);
+  EXPECT_EQ(RMem.size(), PageSize);
+  EXPECT_EQ((*Alloc)->getTargetMemory(RWFlags) % PageSize, 0U);
+  EXPECT_EQ((*Alloc)->getTargetMemory(RFlags) % PageSize, 0U);
+  for (unsigned I = 16; I != 48; ++I)
+    EXPECT_EQ(RWMem[I], 0) << "Zero-fill memory not zeroed";
+
+  memset(RMem.data(), 0x2a, 100);
+  EXPECT_THAT_ERROR((*Alloc)->finalize(), Succeeded());
+  EXPECT_EQ(RMem[0], 0x2a);
+  JITTargetAddress FirstBase = std::min((*Alloc)->getTargetMemory(RWFlags),
+                                        (*Alloc)->getTargetMemory(RFlags));
+  EXPECT_THAT_ERROR((*Alloc)->deallocate(), Succeeded());
+
+  // Freed memory is handed out again, writable.
+  auto Reused = (*MemMgr)->allocate(nullptr, Request);
+  ASSERT_THAT_EXPECTED(Reused, Succeeded());
+  EXPECT_EQ(std::min((*Reused)->getTargetMemory(RWFlags),
+                     (*Reused)->getTargetMemory(RFlags)),
+            FirstBase);
+  memset((*Reused)->getWorkingMemory(RFlags).data(), 0, 100);
+  EXPECT_THAT_ERROR((*Reused)->deallocate(), Succeeded());
+}
+
+TEST(InProcessSlabMemoryManagerTest, Exhaustion) {
+  uint64_t PageSize = sys::Process::getPageSizeEstimate();
+  auto MemMgr = InProcessSlabMemoryManager::Create(2 * PageSize);
+  ASSERT_THAT_EXPECTED(MemMgr, Succeeded());
+
+  JITLinkMemoryManager::SegmentsRequestMap Request;
+  Request[RWFlags] = {8, PageSize, 0};
+
+  auto A1 = (*MemMgr)->allocate(nullptr, Request);
+  ASSERT_THAT_EXPECTED(A1, Succeeded());
+  auto A2 = (*MemMgr)->allocate(nullptr, Request);
+  ASSERT_THAT_EXPECTED(A2, Succeeded());
+  EXPECT_THAT_EXPECTED((*MemMgr)->allocate(nullptr, Request), Failed());
+
+  // Releasing both allocations coalesces the slab back into one range.
+  EXPECT_THAT_ERROR((*A2)->deallocate(), Succeeded());
+  EXPECT_THAT_ERROR((*A1)->deallocate(), Succeeded());
+  Request[RWFlags] = {8, 2 * PageSize, 0};
+  auto A3 = (*MemMgr)->allocate(nullptr, Request);
+  ASSERT_THAT_EXPECTED(A3, Succeeded());
+  EXPECT_THAT_ERROR((*A3)->deallocate(), Succeeded());
+}
@@ -12,6 +12,7 @@
 #include "llvm/ExecutionEngine/Orc/OrcError.h"
 #include "llvm/Testing/Support/Error.h"
 
+#include <future>
 #include <set>
 #include <thread>
 
@@ -1226,6 +1227,78 @@ TEST_F(CoreAPIsStandardTest, TestLookupWithThreadedMaterialization) {
 #endif
 }
 
+TEST_F(CoreAPIsStandardTest, TaskDispatcherReceivesLookupPriority) {
+  // Test that materializations are dispatched with the priority of the lookup
+  // that triggered them.
+  class RecordingDispatcher : public TaskDispatcher {
+  public:
+    RecordingDispatcher(std::vector<TaskPriority> &Priorities)
+        : Priorities(Priorities) {}
+    void dispatch(Task T, TaskPriority Priority) override {
+      Priorities.push_back(Priority);
+      T();
+    }
+    void shutdown() override {}
+
+  private:
+    std::vector<TaskPriority> &Priorities;
+  };
+
+  std::vector<TaskPriority> Priorities;
+  ES.setTaskDispatcher(std::make_unique<RecordingDispatcher>(Priorities));
+
+  auto MakeMU = [](SymbolStringPtr Name, JITEvaluatedSymbol Sym) {
+    return std::make_unique<SimpleMaterializationUnit>(
+        SymbolFlagsMap({{Name, Sym.getFlags()}}),
+        [=](std::unique_ptr<MaterializationResponsibility> R) {
+          cantFail(R->notifyResolved(SymbolMap({{Name, Sym}})));
+          cantFail(R->notifyEmitted());
+        });
+  };
+  cantFail(JD.define(MakeMU(Foo, FooSym)));
+  cantFail(JD.define(MakeMU(Bar, BarSym)));
+
+  bool BarReady = false;
+  ES.lookup(
+      LookupKind::Static, makeJITDylibSearchOrder(&JD), SymbolLookupSet(Bar),
+      SymbolState::Ready,
+      [&](Expected<SymbolMap> Result) {
+        cantFail(std::move(Result));
+        BarReady = true;
+      },
+      NoDependenciesToRegister, TaskPriority::Speculative);
+  EXPECT_TRUE(BarReady) << "Speculative lookup did not complete";
+
+  cantFail(ES.lookup(makeJITDylibSearchOrder(&JD), Foo));
+
+  ASSERT_EQ(Priorities.size(), 2U);
+  EXPECT_EQ(Priorities[0], TaskPriority::Speculative);
+  EXPECT_EQ(Priorities[1], TaskPriority::Normal);
+}
+
+TEST(ThreadPoolTaskDispatcherTest, NormalBeforeSpeculative) {
+#if LLVM_ENABLE_THREADS
+  ThreadPoolTaskDispatcher D(hardware_concurrency(1));
+
+  // Keep the only thread busy while the remaining tasks are queued.
+  std::promise<void> Unblock;
+  D.dispatch([F = Unblock.get_future()]() { F.wait(); }, TaskPriority::Normal);
+
+  std::vector<TaskPriority> Order;
+  D.dispatch([&]() { Order.push_back(TaskPriority::Speculative); },
+             TaskPriority::Speculative);
+  D.dispatch([&]() { Order.push_back(TaskPriority::Normal); },
+             TaskPriority::Normal);
+
+  Unblock.set_value();
+  D.shutdown();
+
+  ASSERT_EQ(Order.size(), 2U);
+  EXPECT_EQ(Order[0], TaskPriority::Normal);
+  EXPECT_EQ(Order[1], TaskPriority::Speculative);
+#endif
+}
+
 TEST_F(CoreAPIsStandardTest, TestGetRequestedSymbolsAndReplace) {
   // Test that GetRequestedSymbols returns the set of symbols that currently
   // have pending queries, and test that MaterializationResponsibility's
@@ -0,0 +1,91 @@
+//===- PersistentObjectCacheTest.cpp - Tests for PersistentObjectCache ----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/PersistentObjectCache.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Testing/Support/Error.h"
+#include "llvm/Testing/Support/SupportHelpers.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::orc;
+using llvm::unittest::TempDir;
+
+namespace {
+
+std::unique_ptr<PersistentObjectCache> createCache(StringRef Directory,
+                                                   StringRef CPU = "") {
+  JITTargetMachineBuilder JTMB(Triple("x86_64-unknown-linux-gnu"));
+  JTMB.setCPU(CPU.str());
+  auto Cache = PersistentObjectCache::Create(Directory, JTMB);
+  EXPECT_THAT_EXPECTED(Cache, Succeeded());
+  return Cache ? std::move(*Cache) : nullptr;
+}
+
+TEST(PersistentObjectCacheTest, StoreAndReload) {
+  TempDir Dir("orc-object-cache-test", /*Unique=*/true);
+  LLVMContext Ctx;
+  Module M("M", Ctx);
+  M.setTargetTriple("x86_64-unknown-linux-gnu");
+  MemoryBufferRef Obj("object bytes", "M.o");
+
+  {
+    auto Cache = createCache(Dir.path());
+    ASSERT_TRUE(Cache);
+    EXPECT_FALSE(Cache->getObject(&M)) << "Unexpected hit in empty cache";
+    Cache->notifyObjectCompiled(&M, Obj);
+    auto Hit = Cache->getObject(&M);
+    ASSERT_TRUE(Hit) << "Expected hit after storing an object";
+    EXPECT_EQ(Hit->getBuffer(), Obj.getBuffer());
+  }
+
+  // A new cache on the same directory sees the stored object.
+  auto Cache = createCache(Dir.path());
+  ASSERT_TRUE(Cache);
+  auto Hit = Cache->getObject(&M);
+  ASSERT_TRUE(Hit) << "Expected entry to persist across cache instances";
+  EXPECT_EQ(Hit->getBuffer(), Obj.getBuffer());
+}
+
+TEST(PersistentObjectCacheTest, KeyedByModuleAndTarget) {
+  TempDir Dir("orc-object-cache-test", /*Unique=*/true);
+  LLVMContext Ctx;
+  Module M("M", Ctx);
+  MemoryBufferRef Obj("object bytes", "M.o");
+
+  auto Cache = createCache(Dir.path());
+  ASSERT_TRUE(Cache);
+  EXPECT_FALSE(Cache->getObject(&M));
+  Cache->notifyObjectCompiled(&M, Obj);
+
+  // A module with different contents misses.
+  Module Other("M", Ctx);
+  Other.setDataLayout("e-m:e-i64:64");
+  EXPECT_FALSE(Cache->getObject(&Other)) << "Hit for a different module";
+
+  // So does the same module compiled for a different CPU.
+  auto CPUCache = createCache(Dir.path(), "haswell");
+  ASSERT_TRUE(CPUCache);
+  EXPECT_FALSE(CPUCache->getObject(&M)) << "Hit for a different CPU";
+}
+
+TEST(PersistentObjectCacheTest, NotifyWithoutLookupIsIgnored) {
+  TempDir Dir("orc-object-cache-test", /*Unique=*/true);
+  LLVMContext Ctx;
+  Module M("M", Ctx);
+
+  auto Cache = createCache(Dir.path());
+  ASSERT_TRUE(Cache);
+  Cache->notifyObjectCompiled(&M, MemoryBufferRef("object bytes", "M.o"));
+  EXPECT_FALSE(Cache->getObject(&M));
+}
+
+} // end anonymous namespace
@@ -0,0 +1,115 @@
+//===- TieredCompilationTest.cpp - Unit tests for tiered compilation ------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "OrcTestCommon.h"
+#include "llvm/ExecutionEngine/Orc/TieredCompilation.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Testing/Support/Error.h"
+
+using namespace llvm;
+using namespace llvm::orc;
+
+namespace {
+
+/// An IRLayer that hands each emitted module to a callback, which resolves
+/// the module's symbols.
+class MockIRLayer : public IRLayer {
+public:
+  using EmitFunction = std::function<void(MaterializationResponsibility &R,
+                                          Module &M)>;
+
+  MockIRLayer(ExecutionSession &ES, EmitFunction Emit)
+      : IRLayer(ES, MO), Emit(std::move(Emit)) {}
+
+  void emit(std::unique_ptr<MaterializationResponsibility> R,
+            ThreadSafeModule TSM) override {
+    TSM.withModuleDo([&](Module &M) { Emit(*R, M); });
+  }
+
+private:
+  IRSymbolMapper::ManglingOptions MOValue;
+  const IRSymbolMapper::ManglingOptions *MO = &MOValue;
+  EmitFunction Emit;
+};
+
+class TieredCompilationTest : public CoreAPIsBasedStandardTest {
+protected:
+  ThreadSafeModule createModuleDefiningFoo() {
+    auto Ctx = std::make_unique<LLVMContext>();
+    auto M = std::make_unique<Module>("M", *Ctx);
+    auto *FooF = Function::Create(
+        FunctionType::get(Type::getVoidTy(*Ctx), false),
+        GlobalValue::ExternalLinkage, "foo", M.get());
+    IRBuilder<> B(BasicBlock::Create(*Ctx, "entry", FooF));
+    B.CreateRetVoid();
+    return ThreadSafeModule(std::move(M), std::move(Ctx));
+  }
+};
+
+TEST_F(TieredCompilationTest, InstrumentAndTierUp) {
+  unsigned FirstTierEmits = 0;
+  unsigned SecondTierEmits = 0;
+  MockIRLayer BaseLayer(ES, [&](MaterializationResponsibility &R, Module &M) {
+    JITEvaluatedSymbol Sym = FooSym;
+    if (IRTieringLayer::isSecondTier(M)) {
+      ++SecondTierEmits;
+      EXPECT_FALSE(M.getNamedGlobal("__orc_tier.count.foo"))
+          << "Second tier should not be instrumented";
+      Sym = BarSym;
+    } else {
+      ++FirstTierEmits;
+      EXPECT_TRUE(M.getNamedGlobal("__orc_tier.count.foo"))
+          << "First tier should count calls to foo";
+      EXPECT_TRUE(M.getFunction("__orc_tier_up"));
+    }
+    cantFail(R.notifyResolved(SymbolMap({{Foo, Sym}})));
+    cantFail(R.notifyEmitted());
+  });
+
+  JITDylib *RedirectedJD = nullptr;
+  SymbolMap Redirected;
+  IRTieringLayer TieringLayer(
+      ES, BaseLayer,
+      [&](JITDylib &FirstTierJD, const SymbolMap &NewAddrs) {
+        RedirectedJD = &FirstTierJD;
+        Redirected = NewAddrs;
+        return Error::success();
+      },
+      /*HotThreshold=*/2);
+
+  cantFail(TieringLayer.add(JD, createModuleDefiningFoo()));
+  auto FooLookup = ES.lookup(makeJITDylibSearchOrder(&JD), Foo);
+  ASSERT_THAT_EXPECTED(FooLookup, Succeeded());
+  EXPECT_EQ(FooLookup->getAddress(), FooAddr);
+  EXPECT_EQ(FirstTierEmits, 1U);
+
+  // Call the runtime entry point the way the instrumentation does once foo
+  // has become hot.
+  auto TierUpSym =
+      ES.lookup(makeJITDylibSearchOrder(&JD), ES.intern("__orc_tier_up"));
+  ASSERT_THAT_EXPECTED(TierUpSym, Succeeded());
+  auto LayerSym = ES.lookup(makeJITDylibSearchOrder(&JD),
+                            ES.intern("__orc_tiering_layer"));
+  ASSERT_THAT_EXPECTED(LayerSym, Succeeded());
+  auto *TierUp = jitTargetAddressToFunction<void (*)(void *, uint64_t)>(
+      TierUpSym->getAddress());
+  auto *Layer = jitTargetAddressToPointer<void *>(LayerSym->getAddress());
+
+  TierUp(Layer, 0);
+  EXPECT_EQ(SecondTierEmits, 1U);
+  EXPECT_EQ(RedirectedJD, &JD);
+  ASSERT_EQ(Redirected.size(), 1U);
+  EXPECT_EQ(Redirected[Foo].getAddress(), BarAddr);
+
+  // A module is only tiered up once.
+  TierUp(Layer, 0);
+  EXPECT_EQ(SecondTierEmits, 1U);
+}
+
+} // end anonymous namespace
@@ -13,8 +13,10 @@
 #include "llvm/IR/InstrTypes.h"
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ThreadPool.h"
 #include "gtest/gtest.h"
 
 namespace llvm {
@@ -667,5 +669,49 @@ TEST(ConstantsTest, GetSplatValueRoundTrip) {
   }
 }
 
+// Threads that get the same types, constants, attributes and metadata all get
+// the same objects.
+TEST(ConstantsTest, ConcurrentUniquing) {
+  LLVMContext Context;
+  Context.setConcurrentUniquing(true);
+  EXPECT_TRUE(Context.hasConcurrentUniquing());
+  Module M("m", Context);
+  Type *Int64Ty = Type::getInt64Ty(Context);
+  auto *G = new GlobalVariable(M, Int64Ty, false, GlobalValue::ExternalLinkage,
+                               nullptr, "g");
+
+  const unsigned NumThreads = 8, NumValues = 500;
+  std::vector<std::vector<const void *>> Results(NumThreads);
+  {
+    ThreadPool Threads(hardware_concurrency(NumThreads));
+    for (unsigned T = 0; T != NumThreads; ++T)
+      Threads.async([&, T] {
+        std::vector<const void *> &R = Results[T];
+        for (unsigned I = 0; I != NumValues; ++I) {
+          Type *ArrayTy = ArrayType::get(Type::getInt8Ty(Context), I);
+          R.push_back(StructType::get(Context, {Int64Ty, ArrayTy}));
+          R.push_back(PointerType::get(ArrayTy, 1));
+          R.push_back(FunctionType::get(ArrayTy, {Int64Ty}, false));
+          Constant *C = ConstantInt::get(Int64Ty, I);
+          R.push_back(C);
+          R.push_back(ConstantFP::get(Type::getDoubleTy(Context), I));
+          R.push_back(ConstantExpr::getAdd(
+              ConstantExpr::getPtrToInt(G, Int64Ty), C));
+          R.push_back(ConstantVector::getSplat(ElementCount::getFixed(2), C));
+          R.push_back(UndefValue::get(ArrayTy));
+          R.push_back(AttributeList::get(Context, AttributeList::FunctionIndex,
+                                         Attribute::get(Context, "n",
+                                                        std::to_string(I)))
+                          .getRawPointer());
+          R.push_back(MDTuple::get(Context, {ConstantAsMetadata::get(C),
+                                             MDString::get(Context, "md")}));
+        }
+      });
+  }
+
+  for (unsigned T = 1; T != NumThreads; ++T)
+    EXPECT_EQ(Results[0], Results[T]);
+}
+
 }  // end anonymous namespace
 }  // end namespace llvm
@@ -10,14 +10,20 @@
 #include "llvm/Analysis/AssumptionCache.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/PassManagerImpl.h"
+#include "llvm/IR/Verifier.h"
 #include "llvm/Passes/StandardInstrumentations.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Transforms/Scalar/SimplifyCFG.h"
 #include "gtest/gtest.h"
+#include <atomic>
 
 using namespace llvm;
 
@@ -164,6 +170,77 @@ struct TestInvalidationFunctionPass
   StringRef Name;
 };
 
+// Like TestFunctionAnalysis, but it may run on several threads at once.
+class TestAtomicFunctionAnalysis
+    : public AnalysisInfoMixin<TestAtomicFunctionAnalysis> {
+public:
+  struct Result {
+    unsigned InstructionCount;
+  };
+
+  TestAtomicFunctionAnalysis(std::atomic<int> &Runs) : Runs(Runs) {}
+
+  Result run(Function &F, FunctionAnalysisManager &AM) {
+    ++Runs;
+    return Result{F.getInstructionCount()};
+  }
+
+private:
+  friend AnalysisInfoMixin<TestAtomicFunctionAnalysis>;
+  static AnalysisKey Key;
+
+  std::atomic<int> &Runs;
+};
+
+AnalysisKey TestAtomicFunctionAnalysis::Key;
+
+// Makes the function return its instruction count, and tags the return with
+// it, which creates constants and metadata from any thread.
+struct TestParallelFunctionPass : PassInfoMixin<TestParallelFunctionPass> {
+  TestParallelFunctionPass(std::atomic<int> &RunCount) : RunCount(RunCount) {}
+
+  PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM) {
+    ++RunCount;
+    auto &AR = AM.getResult<TestAtomicFunctionAnalysis>(F);
+    Constant *C = ConstantInt::get(F.getReturnType(), AR.InstructionCount);
+    auto *Ret = cast<ReturnInst>(F.getEntryBlock().getTerminator());
+    Ret->setOperand(0, C);
+    Ret->setMetadata("count",
+                     MDNode::get(F.getContext(), ConstantAsMetadata::get(C)));
+    return PreservedAnalyses::none();
+  }
+
+  std::atomic<int> &RunCount;
+};
+
+// Counts its runs on each function.
+struct TestExpensivePass : PassInfoMixin<TestExpensivePass> {
+  TestExpensivePass(StringMap<int> &Runs) : Runs(Runs) {}
+
+  PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM) {
+    ++Runs[F.getName()];
+    return PreservedAnalyses::all();
+  }
+
+  StringMap<int> &Runs;
+};
+
+struct TestRemarkHandler : DiagnosticHandler {
+  std::vector<std::string> &Remarks;
+
+  TestRemarkHandler(std::vector<std::string> &Remarks) : Remarks(Remarks) {}
+
+  bool isAnalysisRemarkEnabled(StringRef PassName) const override {
+    return true;
+  }
+
+  bool handleDiagnostics(const DiagnosticInfo &DI) override {
+    if (auto *R = dyn_cast<OptimizationRemarkAnalysis>(&DI))
+      Remarks.push_back(R->getMsg());
+    return true;
+  }
+};
+
 std::unique_ptr<Module> parseIR(LLVMContext &Context, const char *IR) {
   SMDiagnostic Err;
   return parseAssemblyString(IR, Err, Context);
@@ -946,4 +1023,95 @@ TEST_F(PassManagerTest, FunctionPassCFGCheckerWrapped) {
   FPM.addPass(TestSimplifyCFGWrapperPass(InnerFPM));
   FPM.run(*F, FAM);
 }
+
+TEST_F(PassManagerTest, CompileTimeBudget) {
+  auto &Options = cl::getRegisteredOptions();
+  auto &SizeBudget =
+      *static_cast<cl::opt<unsigned> *>(Options["function-size-budget"]);
+  auto &ExpensivePasses = *static_cast<cl::list<std::string> *>(
+      Options["function-budget-expensive-passes"]);
+  SizeBudget = 2;
+  ExpensivePasses.push_back(TestExpensivePass::name().str());
+
+  std::vector<std::string> Remarks;
+  Context.setDiagnosticHandler(std::make_unique<TestRemarkHandler>(Remarks));
+
+  PassInstrumentationCallbacks PIC;
+  StandardInstrumentations SI(/*DebugLogging*/ false);
+  SI.registerCallbacks(PIC);
+  FunctionAnalysisManager FAM;
+  ModuleAnalysisManager MAM;
+  MAM.registerPass([&] { return FunctionAnalysisManagerModuleProxy(FAM); });
+  FAM.registerPass([&] { return ModuleAnalysisManagerFunctionProxy(MAM); });
+  MAM.registerPass([&] { return PassInstrumentationAnalysis(&PIC); });
+  FAM.registerPass([&] { return PassInstrumentationAnalysis(&PIC); });
+
+  StringMap<int> Runs;
+  FunctionPassManager FPM;
+  FPM.addPass(TestExpensivePass(Runs));
+  FPM.addPass(TestExpensivePass(Runs));
+  ModulePassManager MPM;
+  MPM.addPass(createModuleToFunctionPassAdaptor(std::move(FPM)));
+  MPM.run(*M, MAM);
+
+  SizeBudget = 0;
+  ExpensivePasses.clear();
+
+  // Only f, with its three instructions, goes over the budget.
+  EXPECT_EQ(0, Runs.lookup("f"));
+  EXPECT_EQ(2, Runs.lookup("g"));
+  EXPECT_EQ(2, Runs.lookup("h"));
+  ASSERT_EQ(1u, Remarks.size());
+  EXPECT_EQ("3 instructions in f, over the budget of 2; skipping the expensive "
+            "passes on it",
+            Remarks[0]);
+}
+
+TEST(ParallelPassManagerTest, Basic) {
+  LLVMContext Context;
+  std::string IR;
+  for (int I = 0; I != 64; ++I)
+    IR += "define i32 @f" + std::to_string(I) + "(i32 %x) {\n" +
+          "  %a = add i32 %x, " + std::to_string(I + 100) + "\n" +
+          "  %b = mul i32 %a, %a\n" +
+          "  ret i32 %b\n" +
+          "}\n";
+  std::unique_ptr<Module> M = parseIR(Context, IR.c_str());
+
+  FunctionAnalysisManager FAM;
+  std::atomic<int> AnalysisRuns(0);
+  FAM.registerPass([&] { return TestAtomicFunctionAnalysis(AnalysisRuns); });
+  ModuleAnalysisManager MAM;
+  MAM.registerPass([&] { return FunctionAnalysisManagerModuleProxy(FAM); });
+  FAM.registerPass([&] { return ModuleAnalysisManagerFunctionProxy(MAM); });
+  MAM.registerPass([&] { return PassInstrumentationAnalysis(); });
+  FAM.registerPass([&] { return PassInstrumentationAnalysis(); });
+
+  std::atomic<int> PassRuns(0);
+  ModulePassManager MPM;
+  MPM.addPass(createParallelModuleToFunctionPassAdaptor(
+      [&] {
+        FunctionPassManager FPM;
+        FPM.addPass(TestParallelFunctionPass(PassRuns));
+        return FPM;
+      },
+      hardware_concurrency(4)));
+  MPM.run(*M, MAM);
+
+  EXPECT_EQ(64, PassRuns);
+  EXPECT_EQ(64, AnalysisRuns);
+  EXPECT_FALSE(FAM.isThreadSafe());
+  EXPECT_FALSE(Context.hasConcurrentUniquing());
+  EXPECT_FALSE(verifyModule(*M, &errs()));
+
+  // All the functions return the same constant, with the same tag.
+  Constant *Three = ConstantInt::get(Type::getInt32Ty(Context), 3);
+  EXPECT_EQ(64u, Three->getNumUses());
+  MDNode *Tag = MDNode::get(Context, ConstantAsMetadata::get(Three));
+  for (Function &F : *M) {
+    auto *Ret = cast<ReturnInst>(F.getEntryBlock().getTerminator());
+    EXPECT_EQ(Three, Ret->getReturnValue());
+    EXPECT_EQ(Tag, Ret->getMetadata("count"));
+  }
+}
 }
@@ -9,11 +9,14 @@
 #include <gtest/gtest.h>
 #include <llvm/ADT/SmallString.h>
 #include "llvm/IR/LegacyPassManager.h"
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/Function.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/PassInstrumentation.h>
 #include <llvm/IR/PassManager.h>
 #include <llvm/IR/PassTimingInfo.h>
+#include <llvm/Support/JSON.h>
 #include <llvm/Support/raw_ostream.h>
 
 using namespace llvm;
@@ -166,4 +169,59 @@ TEST(TimePassesTest, CustomOut) {
   EXPECT_TRUE(TimePassesStr.str().contains("Pass2"));
 }
 
+TEST(TimePassesTest, Counters) {
+  PassInstrumentationCallbacks PIC;
+  PassInstrumentation PI(&PIC);
+
+  LLVMContext Context;
+  Module M("TestModule", Context);
+  Function *F =
+      Function::Create(FunctionType::get(Type::getVoidTy(Context), false),
+                       GlobalValue::ExternalLinkage, "f", M);
+  MyPass1 Pass1;
+  MyPass2 Pass2;
+
+  std::string Report;
+  raw_string_ostream ReportStream(Report);
+  auto PassCounters = std::make_unique<PassCountersHandler>(true);
+  PassCounters->setOutStream(ReportStream);
+  PassCounters->registerCallbacks(PIC);
+
+  PI.runBeforePass(Pass1, M);
+  PI.runBeforePass(Pass2, *F);
+  PI.runAfterPass(Pass2, *F, PreservedAnalyses::all());
+  PI.runBeforePass(Pass2, *F);
+  PI.runAfterPass(Pass2, *F, PreservedAnalyses::all());
+  PI.runAfterPass(Pass1, M, PreservedAnalyses::all());
+
+  PassCounters.reset();
+  ReportStream.flush();
+
+  // One record per line, for each pass and function.
+  SmallVector<StringRef, 4> Lines;
+  StringRef(Report).trim().split(Lines, '\n');
+  ASSERT_EQ(2u, Lines.size());
+  bool HasInstructions = PerfCounters().isAvailable(PerfCounters::Instructions);
+  for (StringRef Line : Lines) {
+    Expected<json::Value> Record = json::parse(Line);
+    ASSERT_TRUE(bool(Record)) << toString(Record.takeError());
+    const json::Object *O = Record->getAsObject();
+    ASSERT_TRUE(O);
+    Optional<StringRef> Pass = O->getString("pass");
+    ASSERT_TRUE(Pass.hasValue());
+    if (Pass->contains("MyPass1")) {
+      EXPECT_EQ("", O->getString("function").getValueOr("-"));
+      EXPECT_EQ(1, O->getInteger("runs").getValueOr(0));
+    } else {
+      EXPECT_TRUE(Pass->contains("MyPass2"));
+      EXPECT_EQ("f", O->getString("function").getValueOr("-"));
+      EXPECT_EQ(2, O->getInteger("runs").getValueOr(0));
+    }
+    EXPECT_GE(O->getInteger("wall-ns").getValueOr(-1), 0);
+    EXPECT_TRUE(O->getInteger("malloc-bytes").hasValue());
+    EXPECT_TRUE(O->getInteger("peak-memory-growth-bytes").hasValue());
+    EXPECT_EQ(HasInstructions, O->getInteger("instructions").hasValue());
+  }
+}
+
 } // end anonymous namespace
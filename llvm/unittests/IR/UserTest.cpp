@@ -9,6 +9,7 @@
 #include "llvm/IR/User.h"
 #include "llvm/AsmParser/Parser.h"
 #include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
@@ -173,4 +174,43 @@ TEST(UserTest, PersonalityUser) {
   EXPECT_TRUE(TestF->user_empty());
 }
 
+TEST(UserTest, ArenaAllocation) {
+  LLVMContext Context;
+  Module M("", Context);
+  Type *I32 = Type::getInt32Ty(Context);
+  LLVMContext::ArenaScope Scope(Context);
+
+  // Deleted instructions and metadata nodes give their memory to the arena.
+  Constant *One = ConstantInt::get(I32, 1);
+  Instruction *Add = BinaryOperator::CreateAdd(One, One);
+  void *AddMem = Add;
+  Add->deleteValue();
+  Add = BinaryOperator::CreateAdd(One, One);
+  EXPECT_EQ(AddMem, Add);
+  Add->deleteValue();
+  void *TempMem = MDTuple::getTemporary(Context, None).get();
+  EXPECT_EQ(TempMem, MDTuple::getTemporary(Context, None).get());
+
+  // Hung-off operands come from the arena as well, and can grow.
+  FunctionType *FTy = FunctionType::get(I32, {I32}, false);
+  Function *F = Function::Create(FTy, GlobalValue::ExternalLinkage, "f", &M);
+  BasicBlock *Entry = BasicBlock::Create(Context, "entry", F);
+  BasicBlock *Exit = BasicBlock::Create(Context, "exit", F);
+  IRBuilder<> Builder(Entry);
+  Value *Sum = Builder.CreateAdd(F->getArg(0), One);
+  Builder.CreateBr(Exit);
+  Builder.SetInsertPoint(Exit);
+  PHINode *Phi = Builder.CreatePHI(I32, 1);
+  for (int I = 0; I < 8; ++I)
+    Phi->addIncoming(Sum, Entry);
+  Builder.CreateRet(Phi);
+  EXPECT_EQ(Phi->getNumIncomingValues(), 8u);
+  for (unsigned I = 0; I < 8; ++I) {
+    EXPECT_EQ(Phi->getIncomingValue(I), Sum);
+    EXPECT_EQ(Phi->getIncomingBlock(I), Entry);
+  }
+  EXPECT_EQ(Sum->getNumUses(), 8u);
+  F->eraseFromParent();
+}
+
 } // end anonymous namespace
@@ -7,6 +7,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Object/Archive.h"
+#include "llvm/Object/ArchiveWriter.h"
 #include "llvm/Testing/Support/Error.h"
 #include "gtest/gtest.h"
 
@@ -91,3 +92,31 @@ TEST_F(ArchiveTestsFixture, ArchiveChildGetBuffer) {
   EXPECT_EQ(MemberSize, Buffer->size());
   EXPECT_EQ(ArchiveWithMember + sizeof(ArchiveWithMember) - 1, Buffer->data());
 }
+
+TEST(ArchiveWriterTest, KnownMemberSymbols) {
+  // The symbols of the first member are taken from NewArchiveMember::Symbols,
+  // as the member itself is not an object file that could be parsed.
+  std::vector<NewArchiveMember> Members;
+  Members.emplace_back(MemoryBufferRef("not an object", "first"));
+  Members.back().Symbols = std::vector<StringRef>{"foo", "bar"};
+  Members.emplace_back(MemoryBufferRef("neither is this", "second"));
+
+  Expected<std::unique_ptr<MemoryBuffer>> BufOrErr =
+      writeArchiveToBuffer(Members, /*WriteSymtab=*/true, Archive::K_GNU,
+                           /*Deterministic=*/true, /*Thin=*/false);
+  ASSERT_THAT_EXPECTED(BufOrErr, Succeeded());
+  Expected<std::unique_ptr<Archive>> AOrErr =
+      Archive::create((*BufOrErr)->getMemBufferRef());
+  ASSERT_THAT_EXPECTED(AOrErr, Succeeded());
+
+  std::vector<std::string> Symbols;
+  for (const Archive::Symbol &Sym : (*AOrErr)->symbols()) {
+    Symbols.push_back(Sym.getName().str());
+    Expected<Archive::Child> ChildOrErr = Sym.getMember();
+    ASSERT_THAT_EXPECTED(ChildOrErr, Succeeded());
+    Expected<StringRef> NameOrErr = ChildOrErr->getName();
+    ASSERT_THAT_EXPECTED(NameOrErr, Succeeded());
+    EXPECT_EQ("first", *NameOrErr);
+  }
+  EXPECT_EQ((std::vector<std::string>{"foo", "bar"}), Symbols);
+}
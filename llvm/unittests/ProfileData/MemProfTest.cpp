@@ -0,0 +1,87 @@
+//===- unittest/ProfileData/MemProfTest.cpp ---------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ProfileData/MemProf.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Testing/Support/Error.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::memprof;
+
+namespace {
+
+Expected<std::unique_ptr<MemProfReader>> read(StringRef Text) {
+  return MemProfReader::create(MemoryBuffer::getMemBufferCopy(Text));
+}
+
+TEST(MemProfTest, ReadAllocationsAndStacks) {
+  auto ReaderOrErr = read(
+      "MIB:StackID/AllocCount/AveSize/MinSize/MaxSize/AveAccessCount/"
+      "MinAccessCount/MaxAccessCount/AveLifetime/MinLifetime/MaxLifetime/"
+      "NumMigratedCpu/NumLifetimeOverlaps/NumSameAllocCpu/NumSameDeallocCpu\n"
+      "MIB:7/2/24.00/16/32/3.50/1/6/1000.00/10/1990/0/1/2/2\n"
+      "STK:7/_Znwm/0/0\n"
+      "STK:7/_ZN3foo3getEv/12/5\n"
+      "STK:7/main/40/3\n"
+      "Overall miss rate: 0 / 2 =     0.00%\n"
+      "MIB:9/1/8.00/8/8/0.00/0/0/0.00/0/0/0/0/1/1\n"
+      "STK:9/operator/(a, b)/3/1\n");
+  ASSERT_THAT_EXPECTED(ReaderOrErr, Succeeded());
+  ArrayRef<AllocationInfo> Allocations = (*ReaderOrErr)->getAllocations();
+  ASSERT_EQ(Allocations.size(), 2u);
+
+  const AllocationInfo &First = Allocations[0];
+  EXPECT_EQ(First.StackId, 7u);
+  EXPECT_EQ(First.AllocCount, 2u);
+  EXPECT_DOUBLE_EQ(First.AveSize, 24.0);
+  EXPECT_EQ(First.MaxSize, 32u);
+  EXPECT_DOUBLE_EQ(First.AveAccessCount, 3.5);
+  EXPECT_DOUBLE_EQ(First.AveLifetime, 1000.0);
+  EXPECT_EQ(First.MaxLifetime, 1990u);
+  EXPECT_EQ(First.NumSameDeallocCpu, 2u);
+  ASSERT_EQ(First.CallStack.size(), 3u);
+  EXPECT_EQ(First.CallStack[1].Function, "_ZN3foo3getEv");
+  EXPECT_EQ(First.CallStack[1].Line, 12u);
+  EXPECT_EQ(First.CallStack[1].Column, 5u);
+
+  ASSERT_EQ(Allocations[1].CallStack.size(), 1u);
+  EXPECT_EQ(Allocations[1].CallStack[0].Function, "operator/(a, b)");
+}
+
+TEST(MemProfTest, MergeRepeatedContexts) {
+  auto ReaderOrErr =
+      read("MIB:7/1/10.00/10/10/4.00/4/4/100.00/100/100/0/0/0/0\n"
+           "STK:7/f/1/2\n"
+           "Evicted:\n"
+           "MIB:7/3/30.00/20/40/0.00/0/0/20.00/5/30/1/2/3/4\n"
+           "STK:7/f/1/2\n");
+  ASSERT_THAT_EXPECTED(ReaderOrErr, Succeeded());
+  ArrayRef<AllocationInfo> Allocations = (*ReaderOrErr)->getAllocations();
+  ASSERT_EQ(Allocations.size(), 1u);
+  const AllocationInfo &Info = Allocations[0];
+  EXPECT_EQ(Info.AllocCount, 4u);
+  EXPECT_DOUBLE_EQ(Info.AveSize, 25.0);
+  EXPECT_DOUBLE_EQ(Info.AveAccessCount, 1.0);
+  EXPECT_DOUBLE_EQ(Info.AveLifetime, 40.0);
+  EXPECT_EQ(Info.MinSize, 10u);
+  EXPECT_EQ(Info.MaxSize, 40u);
+  EXPECT_EQ(Info.MinLifetime, 5u);
+  EXPECT_EQ(Info.NumSameDeallocCpu, 4u);
+  EXPECT_EQ(Info.CallStack.size(), 1u);
+}
+
+TEST(MemProfTest, RejectMalformedLines) {
+  EXPECT_THAT_EXPECTED(read("MIB:7/1/10.00\n"), Failed());
+  EXPECT_THAT_EXPECTED(
+      read("MIB:7/1/10.00/10/10/4.00/4/4/1.00/1/1/0/0/0/0\nSTK:7/f/x/2\n"),
+      Failed());
+  EXPECT_THAT_EXPECTED(read("STK:8/f/1/2\n"), Failed());
+}
+
+} // end anonymous namespace
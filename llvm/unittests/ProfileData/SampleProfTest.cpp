@@ -9,12 +9,16 @@
 #include "llvm/ProfileData/SampleProf.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
 #include "llvm/ProfileData/SampleProfReader.h"
 #include "llvm/ProfileData/SampleProfWriter.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -63,6 +67,17 @@ struct SampleProfTest : ::testing::Test {
     Reader->collectFuncsFrom(M);
   }
 
+  // Give \p Name a body in \p M. The binary readers only load the profiles
+  // of functions that are defined in, or imported into, the module.
+  Function *defineFunction(Module &M, StringRef Name) {
+    FunctionType *FnType =
+        FunctionType::get(Type::getVoidTy(Context), {}, false);
+    auto *F = cast<Function>(M.getOrInsertFunction(Name, FnType).getCallee());
+    if (F->isDeclaration())
+      ReturnInst::Create(Context, BasicBlock::Create(Context, "entry", F));
+    return F;
+  }
+
   TempFile createRemapFile() {
     return TempFile("remapfile", "", R"(
       # Types 'int' and 'long' are equivalent
@@ -198,8 +213,6 @@ struct SampleProfTest : ::testing::Test {
     Profiles[BooName] = std::move(BooSamples);
 
     Module M("my_module", Context);
-    FunctionType *fn_type =
-        FunctionType::get(Type::getVoidTy(Context), {}, false);
 
     TempFile RemapFile(createRemapFile());
     if (Remap) {
@@ -209,9 +222,9 @@ struct SampleProfTest : ::testing::Test {
       HooName = "_Z3hool";
     }
 
-    M.getOrInsertFunction(FooName, fn_type);
-    M.getOrInsertFunction(BarName, fn_type);
-    M.getOrInsertFunction(BooName, fn_type);
+    defineFunction(M, FooName);
+    defineFunction(M, BarName);
+    defineFunction(M, BooName);
 
     ProfileSymbolList List;
     if (Format == SampleProfileFormat::SPF_Ext_Binary) {
@@ -351,10 +364,7 @@ struct SampleProfTest : ::testing::Test {
   void createFunctionWithSampleProfileElisionPolicy(Module *M,
                                                     const char *Fname,
                                                     StringRef Policy) {
-    FunctionType *FnType =
-        FunctionType::get(Type::getVoidTy(Context), {}, false);
-    auto Inserted = M->getOrInsertFunction(Fname, FnType);
-    auto Fcn = cast<Function>(Inserted.getCallee());
+    Function *Fcn = defineFunction(*M, Fname);
     if (Policy != "")
       Fcn->addFnAttr("sample-profile-suffix-elision-policy", Policy);
   }
@@ -427,6 +437,69 @@ TEST_F(SampleProfTest, remap_ext_binary_profile) {
   testRoundTrip(SampleProfileFormat::SPF_Ext_Binary, true, false);
 }
 
+TEST_F(SampleProfTest, ext_binary_skips_declared_functions) {
+  TempFile ProfileFile("profile", "", "", /*Unique*/ true);
+  createWriter(SampleProfileFormat::SPF_Ext_Binary, ProfileFile.path());
+  StringMap<FunctionSamples> Profiles;
+  for (StringRef Name : {"defined", "declared", "absent"}) {
+    FunctionSamples &FS = Profiles[Name];
+    FS.setName(Name);
+    FS.addTotalSamples(10);
+    FS.addHeadSamples(1);
+    FS.addBodySamples(1, 0, 10);
+  }
+  ASSERT_TRUE(NoError(Writer->write(Profiles)));
+  Writer->getOutputStream().flush();
+
+  Module M("my_module", Context);
+  defineFunction(M, "defined");
+  M.getOrInsertFunction(
+      "declared", FunctionType::get(Type::getVoidTy(Context), {}, false));
+  readProfile(M, ProfileFile.path());
+  ASSERT_TRUE(NoError(Reader->read()));
+  EXPECT_NE(Reader->getSamplesFor("defined"), nullptr);
+  EXPECT_EQ(Reader->getSamplesFor("declared"), nullptr);
+  EXPECT_EQ(Reader->getSamplesFor("absent"), nullptr);
+}
+
+TEST_F(SampleProfTest, ext_binary_context_sensitive_profile) {
+  TempFile ProfileFile("profile", "", "", /*Unique*/ true);
+  createWriter(SampleProfileFormat::SPF_Ext_Binary, ProfileFile.path());
+  if (zlib::isAvailable())
+    Writer->setToCompressAllSections();
+
+  StringMap<FunctionSamples> Profiles;
+  for (StringRef ContextStr :
+       {"main:3 @ foo", "foo:1 @ bar", "baz:2 @ qux", "foo"}) {
+    SampleContext FContext(ContextStr, RawContext);
+    FunctionSamples &FS = Profiles[ContextStr];
+    FS.setName(FContext.getName());
+    FS.setContext(FContext);
+    FS.addTotalSamples(10);
+    FS.addHeadSamples(1);
+    FS.addBodySamples(1, 0, 10);
+  }
+  FunctionSamples::ProfileIsCS = true;
+  std::error_code EC = Writer->write(Profiles);
+  FunctionSamples::ProfileIsCS = false;
+  ASSERT_TRUE(NoError(EC));
+  Writer->getOutputStream().flush();
+
+  // Only the contexts going through foo are needed by a module defining foo.
+  Module M("my_module", Context);
+  defineFunction(M, "foo");
+  readProfile(M, ProfileFile.path());
+  ASSERT_TRUE(NoError(Reader->read()));
+  ASSERT_TRUE(Reader->profileIsCS());
+  StringMap<FunctionSamples> &Loaded = Reader->getProfiles();
+  EXPECT_EQ(Loaded.size(), 3u);
+  EXPECT_TRUE(Loaded.count("main:3 @ foo"));
+  EXPECT_TRUE(Loaded.count("foo:1 @ bar"));
+  EXPECT_TRUE(Loaded.count("foo"));
+  EXPECT_EQ(Loaded["foo:1 @ bar"].getName(), "bar");
+  EXPECT_EQ(Loaded["foo:1 @ bar"].getContext().getCallingContext(), "foo:1");
+}
+
 TEST_F(SampleProfTest, sample_overflow_saturation) {
   const uint64_t Max = std::numeric_limits<uint64_t>::max();
   sampleprof_error Result;
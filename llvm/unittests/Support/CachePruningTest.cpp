@@ -8,6 +8,9 @@
 
 #include "llvm/Support/CachePruning.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Testing/Support/SupportHelpers.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -94,3 +97,36 @@ TEST(CachePruningPolicyParser, Errors) {
   EXPECT_EQ("Unknown key: 'foo'",
             toString(parseCachePruningPolicy("foo=bar").takeError()));
 }
+
+static void writeCacheFile(const llvm::unittest::TempDir &Dir, StringRef Name) {
+  std::error_code EC;
+  raw_fd_ostream OS(Dir.path(Name), EC, sys::fs::OF_None);
+  ASSERT_FALSE(EC);
+  OS << std::string(100, 'x');
+}
+
+TEST(CachePruning, Index) {
+  llvm::unittest::TempDir Dir("cache-pruning-test", /*Unique=*/true);
+  CachePruningPolicy Policy;
+  Policy.Interval = std::chrono::seconds(0);
+  Policy.Expiration = std::chrono::seconds(0);
+  Policy.MaxSizePercentageOfAvailableSpace = 0;
+  Policy.MaxSizeFiles = 1;
+
+  // The first pruning walks the directory and records its state.
+  writeCacheFile(Dir, "llvmcache-a");
+  EXPECT_TRUE(pruneCache(Dir.path(), Policy));
+  EXPECT_TRUE(sys::fs::exists(Dir.path("llvmcache-a")));
+
+  // A file added without being recorded isn't seen, as the recorded state is
+  // within the policy.
+  writeCacheFile(Dir, "llvmcache-b");
+  EXPECT_TRUE(pruneCache(Dir.path(), Policy));
+  EXPECT_TRUE(sys::fs::exists(Dir.path("llvmcache-b")));
+
+  // Once recorded, the cache goes over the limit and is walked again.
+  recordCacheFileAdded(Dir.path(), 100);
+  EXPECT_TRUE(pruneCache(Dir.path(), Policy));
+  EXPECT_NE(sys::fs::exists(Dir.path("llvmcache-a")),
+            sys::fs::exists(Dir.path("llvmcache-b")));
+}
@@ -15,6 +15,7 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Config/config.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Testing/Support/Error.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -65,6 +66,38 @@ TEST(CompressionTest, Zlib) {
   TestZlibCompression(BinaryDataStr, zlib::DefaultCompression);
 }
 
+TEST(CompressionTest, ZlibShards) {
+  std::string Input;
+  for (unsigned I = 0; I < 10000; ++I)
+    Input += std::to_string(I * 7919 % 1000);
+  StringRef InputRef(Input);
+
+  // Compress pieces of the input independently and assemble a zlib stream
+  // from them: a header, the raw deflate data and the combined checksum.
+  const size_t ShardSize = 4096;
+  SmallString<32> Compressed;
+  Compressed.push_back(0x78);
+  Compressed.push_back(0x01);
+  uint32_t Checksum = 1;
+  for (size_t Off = 0; Off < Input.size(); Off += ShardSize) {
+    StringRef Shard = InputRef.substr(Off, ShardSize);
+    SmallString<32> Out;
+    EXPECT_THAT_ERROR(zlib::compressRaw(Shard, Out, zlib::DefaultCompression,
+                                        Off + ShardSize >= Input.size()),
+                      Succeeded());
+    Compressed += Out;
+    Checksum = zlib::adler32Combine(Checksum, zlib::adler32(Shard),
+                                    Shard.size());
+  }
+  for (int I = 3; I >= 0; --I)
+    Compressed.push_back((Checksum >> (I * 8)) & 0xff);
+
+  SmallString<32> Uncompressed;
+  EXPECT_THAT_ERROR(zlib::uncompress(Compressed, Uncompressed, Input.size()),
+                    Succeeded());
+  EXPECT_EQ(InputRef, Uncompressed);
+}
+
 TEST(CompressionTest, ZlibCRC32) {
   EXPECT_EQ(
       0x414FA339U,
@@ -73,4 +106,87 @@ TEST(CompressionTest, ZlibCRC32) {
 
 #endif
 
+void TestZstdCompression(StringRef Input, int Level) {
+  SmallString<32> Compressed;
+  SmallString<32> Uncompressed;
+
+  Error E = zstd::compress(Input, Compressed, Level);
+  EXPECT_FALSE(E);
+  consumeError(std::move(E));
+
+  // Check that uncompressed buffer is the same as original.
+  E = zstd::uncompress(Compressed, Uncompressed, Input.size());
+  EXPECT_FALSE(E);
+  consumeError(std::move(E));
+
+  EXPECT_EQ(Input, Uncompressed);
+  if (Input.size() > 0) {
+    // Uncompression fails if expected length is too short.
+    EXPECT_THAT_ERROR(
+        zstd::uncompress(Compressed, Uncompressed, Input.size() - 1),
+        Failed());
+  }
+}
+
+TEST(CompressionTest, Zstd) {
+  if (!zstd::isAvailable())
+    return;
+
+  TestZstdCompression("", zstd::DefaultCompression);
+
+  TestZstdCompression("hello, world!", zstd::BestSizeCompression);
+  TestZstdCompression("hello, world!", zstd::BestSpeedCompression);
+  TestZstdCompression("hello, world!", zstd::DefaultCompression);
+
+  const size_t kSize = 1024;
+  char BinaryData[kSize];
+  for (size_t i = 0; i < kSize; ++i)
+    BinaryData[i] = i & 255;
+  StringRef BinaryDataStr(BinaryData, kSize);
+
+  TestZstdCompression(BinaryDataStr, zstd::BestSizeCompression);
+  TestZstdCompression(BinaryDataStr, zstd::BestSpeedCompression);
+  TestZstdCompression(BinaryDataStr, zstd::DefaultCompression);
+}
+
+TEST(CompressionTest, ZstdConcatenatedFrames) {
+  if (!zstd::isAvailable())
+    return;
+
+  // Frames compressed independently decompress as a single stream.
+  SmallString<32> Compressed;
+  SmallString<32> Frame;
+  EXPECT_THAT_ERROR(zstd::compress("hello, ", Frame), Succeeded());
+  Compressed += Frame;
+  Frame.clear();
+  EXPECT_THAT_ERROR(zstd::compress("world!", Frame), Succeeded());
+  Compressed += Frame;
+
+  SmallString<32> Uncompressed;
+  EXPECT_THAT_ERROR(zstd::uncompress(Compressed, Uncompressed, 13),
+                    Succeeded());
+  EXPECT_EQ("hello, world!", Uncompressed);
+}
+
+TEST(CompressionTest, Format) {
+  EXPECT_EQ(zlib::isAvailable(),
+            compression::isAvailable(compression::Format::Zlib));
+  EXPECT_EQ(zstd::isAvailable(),
+            compression::isAvailable(compression::Format::Zstd));
+
+  for (compression::Format F :
+       {compression::Format::Zlib, compression::Format::Zstd}) {
+    if (!compression::isAvailable(F))
+      continue;
+    SmallString<32> Compressed;
+    SmallString<32> Uncompressed;
+    EXPECT_THAT_ERROR(compression::compress(F, "hello, world!", Compressed,
+                                            compression::getDefaultLevel(F)),
+                      Succeeded());
+    EXPECT_THAT_ERROR(compression::uncompress(F, Compressed, Uncompressed, 13),
+                      Succeeded());
+    EXPECT_EQ("hello, world!", Uncompressed);
+  }
+}
+
 }
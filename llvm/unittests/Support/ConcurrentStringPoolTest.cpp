@@ -0,0 +1,82 @@
+//===- llvm/unittest/Support/ConcurrentStringPoolTest.cpp -----------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/ConcurrentStringPool.h"
+#include "llvm/Support/ThreadPool.h"
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+
+TEST(ConcurrentStringPoolTest, Save) {
+  ConcurrentStringPool Pool(4);
+  EXPECT_EQ(4u, Pool.getNumShards());
+  std::string Str = "hello";
+  StringRef S1 = Pool.save(Str);
+  EXPECT_EQ("hello", S1);
+  EXPECT_NE(Str.data(), S1.data());
+  EXPECT_EQ('\0', *S1.end());
+  EXPECT_EQ(S1.data(), Pool.save("hello").data());
+  EXPECT_EQ(S1.data(), Pool.save(Twine("hel") + "lo").data());
+
+  StringRef Empty = Pool.save("");
+  EXPECT_TRUE(Empty.empty());
+  EXPECT_EQ('\0', *Empty.end());
+  EXPECT_EQ(Empty.data(), Pool.save(StringRef()).data());
+  EXPECT_EQ(2u, Pool.size());
+}
+
+TEST(ConcurrentStringPoolTest, ShardCount) {
+  EXPECT_EQ(1u, ConcurrentStringPool(1).getNumShards());
+  EXPECT_EQ(8u, ConcurrentStringPool(5).getNumShards());
+  EXPECT_GE(ConcurrentStringPool().getNumShards(), 1u);
+
+  // A single shard holds everything.
+  ConcurrentStringPool Pool(1);
+  for (unsigned I = 0; I != 100; ++I)
+    Pool.save(std::to_string(I));
+  EXPECT_EQ(100u, Pool.size());
+  EXPECT_GE(Pool.getBytesAllocated(), 190u);
+}
+
+// Threads saving overlapping strings all get the same copies.
+TEST(ConcurrentStringPoolTest, ManyThreads) {
+  const unsigned NumThreads = 8, NumStrings = 10000;
+  ConcurrentStringPool Pool;
+  std::vector<std::vector<StringRef>> Saved(NumThreads);
+  {
+    ThreadPool Threads(hardware_concurrency(NumThreads));
+    for (unsigned T = 0; T != NumThreads; ++T)
+      Threads.async([&, T] {
+        // Each thread saves the strings in a different order.
+        for (unsigned I = 0; I != NumStrings; ++I) {
+          unsigned N = (I * 7919 + T * 613) % NumStrings;
+          Saved[T].push_back(Pool.save("str" + std::to_string(N)));
+        }
+      });
+  }
+  EXPECT_EQ(NumStrings, Pool.size());
+
+  std::vector<const char *> ByNumber(NumStrings);
+  for (unsigned T = 0; T != NumThreads; ++T) {
+    for (unsigned I = 0; I != NumStrings; ++I) {
+      unsigned N = (I * 7919 + T * 613) % NumStrings;
+      StringRef S = Saved[T][I];
+      EXPECT_EQ("str" + std::to_string(N), S);
+      if (T == 0)
+        ByNumber[N] = S.data();
+      else
+        EXPECT_EQ(ByNumber[N], S.data());
+    }
+  }
+}
+
+} // end anonymous namespace
@@ -12,6 +12,7 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
@@ -155,6 +156,122 @@ TEST(FileOutputBuffer, Test) {
   ASSERT_EQ(File6Size, 0ULL);
   ASSERT_NO_ERROR(fs::remove(File6.str()));
 
+  // TEST 7: Modify an existing file in place.
+  SmallString<128> File7(TestDirectory);
+  File7.append("/file7");
+  {
+    Expected<std::unique_ptr<FileOutputBuffer>> BufferOrErr =
+        FileOutputBuffer::create(File7, 8192);
+    ASSERT_NO_ERROR(errorToErrorCode(BufferOrErr.takeError()));
+    std::unique_ptr<FileOutputBuffer> &Buffer = *BufferOrErr;
+    memset(Buffer->getBufferStart(), 'a', 8192);
+    ASSERT_NO_ERROR(errorToErrorCode(Buffer->commit()));
+  }
+  {
+    Expected<std::unique_ptr<FileOutputBuffer>> BufferOrErr =
+        FileOutputBuffer::create(File7, size_t(-1), FileOutputBuffer::F_modify);
+    ASSERT_NO_ERROR(errorToErrorCode(BufferOrErr.takeError()));
+    std::unique_ptr<FileOutputBuffer> &Buffer = *BufferOrErr;
+    ASSERT_EQ(Buffer->getBufferSize(), 8192U);
+    ASSERT_EQ(Buffer->getBufferStart()[4096], 'a');
+    memset(Buffer->getBufferStart() + 4096, 'b', 16);
+    ASSERT_NO_ERROR(errorToErrorCode(Buffer->commit()));
+  }
+  {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr =
+        MemoryBuffer::getFile(File7);
+    ASSERT_NO_ERROR(BufOrErr.getError());
+    StringRef Data = (*BufOrErr)->getBuffer();
+    ASSERT_EQ(Data.size(), 8192U);
+    ASSERT_EQ(Data.count('b'), 16U);
+    ASSERT_EQ(Data[4095], 'a');
+    ASSERT_EQ(Data[4112], 'a');
+  }
+  ASSERT_NO_ERROR(fs::remove(File7.str()));
+
+  // TEST 8: Modifying a file that doesn't exist requires a size.
+  SmallString<128> File8(TestDirectory);
+  File8.append("/file8");
+  {
+    Expected<std::unique_ptr<FileOutputBuffer>> BufferOrErr =
+        FileOutputBuffer::create(File8, size_t(-1), FileOutputBuffer::F_modify);
+    ASSERT_FALSE(bool(BufferOrErr));
+    consumeError(BufferOrErr.takeError());
+  }
+
+  // TEST 9: Copy a range of another file into the buffer. Not every platform
+  // or file system supports this, but the data must be right when it does.
+  SmallString<128> File9(TestDirectory);
+  File9.append("/file9");
+  SmallString<128> File9In(TestDirectory);
+  File9In.append("/file9.in");
+  {
+    std::error_code EC;
+    raw_fd_ostream In(File9In, EC);
+    ASSERT_NO_ERROR(EC);
+    for (int I = 0; I < 8192; ++I)
+      In << char('a' + I % 26);
+  }
+  {
+    int InFD;
+    ASSERT_NO_ERROR(fs::openFileForRead(File9In, InFD));
+    Expected<std::unique_ptr<FileOutputBuffer>> BufferOrErr =
+        FileOutputBuffer::create(File9, 8192);
+    ASSERT_NO_ERROR(errorToErrorCode(BufferOrErr.takeError()));
+    std::unique_ptr<FileOutputBuffer> &Buffer = *BufferOrErr;
+    memset(Buffer->getBufferStart(), 'x', 8192);
+    if (!Buffer->copyFromFile(InFD, 26, 100, 4000))
+      memcpy(Buffer->getBufferStart() + 100, "abcdefghijklmnopqrstuvwxyz", 26);
+    // Data copied by the kernel must be visible through the mapping.
+    ASSERT_EQ(Buffer->getBufferStart()[99], 'x');
+    ASSERT_EQ(Buffer->getBufferStart()[100], 'a');
+    ASSERT_EQ(Buffer->getBufferStart()[125], 'z');
+    ASSERT_NO_ERROR(errorToErrorCode(Buffer->commit()));
+    sys::Process::SafelyCloseFileDescriptor(InFD);
+  }
+  {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr =
+        MemoryBuffer::getFile(File9);
+    ASSERT_NO_ERROR(BufOrErr.getError());
+    StringRef Data = (*BufOrErr)->getBuffer();
+    ASSERT_EQ(Data.size(), 8192U);
+    ASSERT_EQ(Data.substr(100, 26), "abcdefghijklmnopqrstuvwxyz");
+    ASSERT_EQ(Data[99], 'x');
+  }
+  ASSERT_NO_ERROR(fs::remove(File9.str()));
+  ASSERT_NO_ERROR(fs::remove(File9In.str()));
+
+  // TEST 10: Write ranges back early, with and without direct I/O, which not
+  // every platform or file system supports. The size is not a multiple of
+  // any block size.
+  SmallString<128> File10(TestDirectory);
+  File10.append("/file10");
+  for (unsigned Flags : {0u, unsigned(FileOutputBuffer::F_direct)}) {
+    const size_t Size = 3 * 8192 + 100;
+    {
+      Expected<std::unique_ptr<FileOutputBuffer>> BufferOrErr =
+          FileOutputBuffer::create(File10, Size, Flags);
+      ASSERT_NO_ERROR(errorToErrorCode(BufferOrErr.takeError()));
+      std::unique_ptr<FileOutputBuffer> &Buffer = *BufferOrErr;
+      uint8_t *Data = Buffer->getBufferStart();
+      memset(Data + 5000, 'b', 10000);
+      Buffer->writeback(5000, 10000);
+      memset(Data, 'a', 5000);
+      memset(Data + 15000, 'c', Size - 15000);
+      Buffer->writeback(15000, Size - 15000);
+      ASSERT_NO_ERROR(errorToErrorCode(Buffer->commit()));
+    }
+    ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr =
+        MemoryBuffer::getFile(File10);
+    ASSERT_NO_ERROR(BufOrErr.getError());
+    StringRef Data = (*BufOrErr)->getBuffer();
+    ASSERT_EQ(Data.size(), Size);
+    EXPECT_EQ(Data.find_first_not_of('a'), 5000U);
+    EXPECT_EQ(Data.find_first_not_of('b', 5000), 15000U);
+    EXPECT_EQ(Data.find_first_not_of('c', 15000), StringRef::npos);
+    ASSERT_NO_ERROR(fs::remove(File10.str()));
+  }
+
   // Clean up.
   ASSERT_NO_ERROR(fs::remove(TestDirectory.str()));
 }
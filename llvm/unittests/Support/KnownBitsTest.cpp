@@ -324,4 +324,22 @@ TEST(KnownBitsTest, SExtOrTrunc) {
   }
 }
 
+TEST(KnownBitsTest, CommonBits) {
+  unsigned Bits = 4;
+  ForeachKnownBits(Bits, [&](const KnownBits &Known1) {
+    ForeachKnownBits(Bits, [&](const KnownBits &Known2) {
+      KnownBits Common = KnownBits::commonBits(Known1, Known2);
+      ForeachNumInKnownBits(Known1, [&](const APInt &N) {
+        EXPECT_FALSE(N.intersects(Common.Zero));
+        EXPECT_TRUE(Common.One.isSubsetOf(N));
+      });
+      // The overload reusing the storage of its first operand must agree.
+      KnownBits Known = Known1;
+      Known = KnownBits::commonBits(std::move(Known), Known2);
+      EXPECT_EQ(Common.Zero, Known.Zero);
+      EXPECT_EQ(Common.One, Known.One);
+    });
+  });
+}
+
 } // end anonymous namespace
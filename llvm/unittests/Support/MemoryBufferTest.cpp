@@ -312,6 +312,52 @@ TEST_F(MemoryBufferTest, slice) {
   EXPECT_TRUE(BufData2.substr(0x2FF8,8).equals("abcdefgh"));
 }
 
+TEST_F(MemoryBufferTest, accessHints) {
+  // Create a file large enough to be mapped with huge pages, with different
+  // data in each megabyte and a size that is not a multiple of the page size.
+  int FD;
+  SmallString<64> TestPath;
+  sys::fs::createTemporaryFile("MemoryBufferTest_AccessHints", "temp", FD,
+                               TestPath);
+  FileRemover Cleanup(TestPath);
+  raw_fd_ostream OF(FD, true);
+  const char *Data[] = {"12345678", "abcdefgh", "ABCDEFGH", "87654321"};
+  for (const char *D : Data)
+    for (unsigned i = 0; i < 0x100000 / 8; ++i)
+      OF << D;
+  OF << "end";
+  OF.close();
+
+  const unsigned AllHints[] = {
+      MemoryBuffer::AH_Sequential, MemoryBuffer::AH_Random,
+      MemoryBuffer::AH_Populate,
+      MemoryBuffer::AH_HugePages | MemoryBuffer::AH_Populate};
+  for (unsigned Hints : AllHints) {
+    ErrorOr<OwningBuffer> MB =
+        MemoryBuffer::getFile(TestPath, -1, true, false, Hints);
+    ASSERT_FALSE(MB.getError());
+    EXPECT_EQ(MemoryBuffer::MemoryBuffer_MMap, MB.get()->getBufferKind());
+    StringRef BufData = MB.get()->getBuffer();
+    ASSERT_EQ(0x400003UL, BufData.size());
+    for (unsigned i = 0; i < 4; ++i) {
+      EXPECT_EQ(Data[i], BufData.substr(i * 0x100000, 8));
+      EXPECT_EQ(Data[i], BufData.substr(i * 0x100000 + 0xFFFF8, 8));
+    }
+    EXPECT_EQ("end", BufData.substr(0x400000));
+    EXPECT_EQ('\0', *MB.get()->getBufferEnd());
+  }
+
+  // Slices that do not start at a huge page boundary of the file.
+  ErrorOr<OwningBuffer> MB = MemoryBuffer::getFileSlice(
+      TestPath, 0x200000, 0x180800, false, MemoryBuffer::AH_HugePages);
+  ASSERT_FALSE(MB.getError());
+  StringRef BufData = MB.get()->getBuffer();
+  EXPECT_EQ(0x200000UL, BufData.size());
+  EXPECT_EQ("abcdefgh", BufData.substr(0, 8));
+  EXPECT_EQ("ABCDEFGH", BufData.substr(0x7F800, 8));
+  EXPECT_EQ("87654321", BufData.substr(0x1FFFF8, 8));
+}
+
 TEST_F(MemoryBufferTest, writableSlice) {
   // Create a file initialized with some data
   int FD;
@@ -11,6 +11,7 @@
 #include "gtest/gtest.h"
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
 
 #if defined(__NetBSD__)
 // clang-format off
@@ -417,6 +418,35 @@ TEST_P(MappedMemoryTest, UnalignedNear) {
   EXPECT_FALSE(Memory::releaseMappedMemory(M1));
 }
 
+TEST_P(MappedMemoryTest, DiscardPages) {
+  CHECK_UNSUPPORTED();
+  std::error_code EC;
+  MemoryBlock M1 = Memory::allocateMappedMemory(3 * PageSize, nullptr,
+                                                getTestableEquivalent(Flags),
+                                                EC);
+  EXPECT_EQ(std::error_code(), EC);
+  uint8_t *Base = static_cast<uint8_t *>(M1.base());
+  memset(Base, 0xAB, 3 * PageSize);
+
+  // Only the second page is entirely within the range.
+  EXPECT_FALSE(Memory::discardPages(Base + 1, 2 * PageSize));
+  EXPECT_EQ(0xAB, Base[0]);
+  EXPECT_EQ(0xAB, Base[PageSize - 1]);
+  EXPECT_EQ(0xAB, Base[2 * PageSize]);
+  EXPECT_EQ(0xAB, Base[3 * PageSize - 1]);
+#if defined(__linux__)
+  EXPECT_EQ(0, Base[PageSize]);
+  EXPECT_EQ(0, Base[2 * PageSize - 1]);
+#endif
+
+  // Ranges covering no whole page are ignored.
+  EXPECT_FALSE(Memory::discardPages(Base + 1, PageSize - 2));
+  EXPECT_EQ(0xAB, Base[1]);
+  EXPECT_FALSE(Memory::discardPages(Base, 0));
+
+  EXPECT_FALSE(Memory::releaseMappedMemory(M1));
+}
+
 // Note that Memory::MF_WRITE is not supported exclusively across
 // operating systems and architectures and can imply MF_READ|MF_WRITE
 unsigned MemoryFlags[] = {
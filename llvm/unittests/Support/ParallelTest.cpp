@@ -14,6 +14,7 @@
 #include "llvm/Support/Parallel.h"
 #include "gtest/gtest.h"
 #include <array>
+#include <atomic>
 #include <random>
 
 uint32_t array[1024 * 1024];
@@ -92,4 +93,33 @@ TEST(Parallel, ForEachError) {
   EXPECT_EQ(errText, std::string("asdf\nasdf\nasdf"));
 }
 
+TEST(Parallel, NestedParallelFor) {
+  // Inner loops run from tasks of the outer loop. Workers waiting for an inner
+  // loop must keep running tasks, or this would deadlock.
+  std::atomic<uint32_t> sum{0};
+  parallelForEachN(0, 64, [&](size_t I) {
+    parallelForEachN(0, 64, [&](size_t J) {
+      parallelForEachN(0, 16, [&](size_t K) { ++sum; });
+    });
+  });
+  EXPECT_EQ(sum, 64u * 64u * 16u);
+}
+
+TEST(Parallel, NestedSort) {
+  std::vector<std::vector<uint32_t>> vecs(16);
+  std::mt19937 randEngine;
+  std::uniform_int_distribution<uint32_t> dist;
+  for (std::vector<uint32_t> &v : vecs) {
+    v.resize(8192);
+    for (uint32_t &i : v)
+      i = dist(randEngine);
+  }
+
+  parallelForEach(vecs, [](std::vector<uint32_t> &v) {
+    parallelSort(v.begin(), v.end());
+  });
+  for (const std::vector<uint32_t> &v : vecs)
+    EXPECT_TRUE(llvm::is_sorted(v));
+}
+
 #endif
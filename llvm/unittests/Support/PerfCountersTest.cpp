@@ -0,0 +1,40 @@
+//===- llvm/unittest/Support/PerfCountersTest.cpp -------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/PerfCounters.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+TEST(PerfCountersTest, Read) {
+  PerfCounters Counters;
+  PerfCounters::Values Before = Counters.read();
+  volatile unsigned Sum = 0;
+  for (unsigned I = 0; I != 100000; ++I)
+    Sum += I;
+  PerfCounters::Values Delta = Counters.read();
+  Delta -= Before;
+
+  for (unsigned I = 0; I != PerfCounters::NumCounters; ++I) {
+    auto C = static_cast<PerfCounters::Counter>(I);
+    EXPECT_FALSE(PerfCounters::getName(C).empty());
+    // The counters that aren't available read as zero.
+    if (!Counters.isAvailable(C))
+      EXPECT_EQ(0u, Delta[C]);
+  }
+  EXPECT_EQ(Counters.isAvailable(PerfCounters::Instructions) ||
+                Counters.isAvailable(PerfCounters::Cycles) ||
+                Counters.isAvailable(PerfCounters::CacheMisses),
+            Counters.isAvailable());
+  if (Counters.isAvailable(PerfCounters::Instructions))
+    EXPECT_GE(Delta[PerfCounters::Instructions], 100000u);
+}
+
+} // end anonymous namespace
@@ -11,6 +11,7 @@
 #include "llvm/Support/Host.h"
 #include "llvm/Support/Process.h"
 #include "gtest/gtest.h"
+#include <vector>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -31,6 +32,16 @@ TEST(ProcessTest, GetProcessIdTest) {
 #endif
 }
 
+#if defined(__linux__) || defined(__APPLE__) || defined(_WIN32)
+TEST(ProcessTest, GetPeakMemoryUsage) {
+  size_t Peak = Process::GetPeakMemoryUsage();
+  EXPECT_GT(Peak, 0u);
+  // Touching more memory than the peak so far raises it.
+  std::vector<char> Buffer(Peak + (1 << 20), 1);
+  EXPECT_GT(Process::GetPeakMemoryUsage(), Buffer.size());
+}
+#endif
+
 TEST(ProcessTest, GetRandomNumberTest) {
   const unsigned r1 = Process::GetRandomNumber();
   const unsigned r2 = Process::GetRandomNumber();
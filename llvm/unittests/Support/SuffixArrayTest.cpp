@@ -0,0 +1,104 @@
+//===- unittests/Support/SuffixArrayTest.cpp - suffix array tests ---------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/SuffixArray.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace llvm;
+
+namespace {
+
+typedef std::pair<unsigned, std::vector<unsigned>> Repeat;
+
+std::vector<Repeat> getRepeats(const SuffixArray &SA) {
+  std::vector<Repeat> Repeats;
+  SA.forEachRepeatedSubstring([&](const SuffixArray::RepeatedSubstring &RS) {
+    Repeats.emplace_back(RS.Length, RS.StartIndices);
+  });
+  std::sort(Repeats.begin(), Repeats.end());
+  return Repeats;
+}
+
+std::vector<Repeat> getRepeats(SuffixTree &ST) {
+  std::vector<Repeat> Repeats;
+  for (auto It = ST.begin(); It != ST.end(); It++) {
+    Repeats.emplace_back((*It).Length, (*It).StartIndices);
+    std::sort(Repeats.back().second.begin(), Repeats.back().second.end());
+  }
+  std::sort(Repeats.begin(), Repeats.end());
+  return Repeats;
+}
+
+TEST(SuffixArrayTest, Sorted) {
+  std::vector<unsigned> Data = {2, 1, 2, 1, 2, 3};
+  SuffixArray SA(Data);
+  EXPECT_EQ(std::vector<unsigned>({1, 3, 0, 2, 4, 5}),
+            std::vector<unsigned>(SA.getSuffixes().begin(),
+                                  SA.getSuffixes().end()));
+  EXPECT_EQ(std::vector<unsigned>({0, 2, 0, 3, 1, 0}),
+            std::vector<unsigned>(SA.getCommonPrefixes().begin(),
+                                  SA.getCommonPrefixes().end()));
+
+  SuffixArray Empty({});
+  EXPECT_TRUE(Empty.getSuffixes().empty());
+  EXPECT_TRUE(getRepeats(Empty).empty());
+}
+
+TEST(SuffixArrayTest, Repeats) {
+  std::vector<unsigned> Data = {1, 2, 3, 1, 2, 3, 4};
+  SuffixArray SA(Data);
+  std::vector<Repeat> Expected = {{2, {1, 4}}, {3, {0, 3}}};
+  EXPECT_EQ(Expected, getRepeats(SA));
+
+  // Only {1, 2, 3} is long enough.
+  std::vector<Repeat> Repeats;
+  SA.forEachRepeatedSubstring(
+      [&](const SuffixArray::RepeatedSubstring &RS) {
+        Repeats.emplace_back(RS.Length, RS.StartIndices);
+      },
+      3);
+  Expected = {{3, {0, 3}}};
+  EXPECT_EQ(Expected, Repeats);
+}
+
+// The array finds the same substrings as the tree, on strings with many
+// nested and overlapping repeats.
+TEST(SuffixArrayTest, MatchesSuffixTree) {
+  std::mt19937 Rand(0);
+  for (unsigned Alphabet : {1, 2, 3, 8}) {
+    for (unsigned Size : {1, 2, 10, 100, 1000}) {
+      std::vector<unsigned> Data;
+      for (unsigned I = 0; I != Size; ++I)
+        Data.push_back(Rand() % Alphabet);
+      Data.push_back(Alphabet);
+      SuffixArray SA(Data);
+      SuffixTree ST(Data);
+      EXPECT_EQ(getRepeats(ST), getRepeats(SA))
+          << "alphabet " << Alphabet << ", size " << Size;
+
+      for (unsigned I = 1; I < Data.size(); ++I) {
+        ArrayRef<unsigned> Prev = makeArrayRef(Data).drop_front(
+            SA.getSuffixes()[I - 1]);
+        ArrayRef<unsigned> Cur =
+            makeArrayRef(Data).drop_front(SA.getSuffixes()[I]);
+        ASSERT_TRUE(std::lexicographical_compare(Prev.begin(), Prev.end(),
+                                                 Cur.begin(), Cur.end()));
+        unsigned Len = SA.getCommonPrefixes()[I];
+        ASSERT_TRUE(Prev.take_front(Len) == Cur.take_front(Len));
+        ASSERT_TRUE(Len == Prev.size() || Len == Cur.size() ||
+                    Prev[Len] != Cur[Len]);
+      }
+    }
+  }
+}
+
+} // namespace
@@ -167,6 +167,99 @@ TEST_F(ThreadPoolTest, PoolDestruction) {
   ASSERT_EQ(5, checked_in);
 }
 
+TEST_F(ThreadPoolTest, Priorities) {
+  CHECK_UNSUPPORTED();
+  // With a single thread, queued tasks start by decreasing priority, and in
+  // submission order for equal priorities.
+  std::vector<int> Order;
+  std::mutex Lock;
+  ThreadPool Pool(hardware_concurrency(1));
+  ThreadPool::TaskOptions Opts;
+  Opts.Priority = 100;
+  Pool.schedule([this] { waitForMainThread(); }, Opts);
+  const int Priorities[] = {1, 3, 2, 3, 0};
+  for (int I = 0; I < 5; ++I) {
+    Opts.Priority = Priorities[I];
+    Pool.schedule(
+        [&, I] {
+          std::lock_guard<std::mutex> Guard(Lock);
+          Order.push_back(I);
+        },
+        Opts);
+  }
+  setMainThreadReady();
+  Pool.wait();
+  ASSERT_EQ(std::vector<int>({1, 3, 2, 0, 4}), Order);
+}
+
+TEST_F(ThreadPoolTest, Dependencies) {
+  CHECK_UNSUPPORTED();
+  // A diamond: B and C continue A, D waits for both B and C.
+  std::atomic_int A{0}, B{0}, C{0}, D{0};
+  ThreadPool Pool(hardware_concurrency(4));
+  ThreadPool::TaskHandle TA = Pool.schedule([&, this] {
+    waitForMainThread();
+    A = 1;
+  });
+  ThreadPool::TaskOptions Opts;
+  Opts.Dependencies = TA;
+  ThreadPool::TaskHandle TB = Pool.schedule([&] { B = A + 1; }, Opts);
+  ThreadPool::TaskHandle TC = Pool.schedule([&] { C = A + 2; }, Opts);
+  ThreadPool::TaskHandle Deps[] = {TB, TC};
+  Opts.Dependencies = Deps;
+  Pool.schedule([&] { D = B + C; }, Opts);
+  ASSERT_EQ(0, B.load());
+  ASSERT_EQ(0, C.load());
+  setMainThreadReady();
+  Pool.wait();
+  ASSERT_EQ(2, B.load());
+  ASSERT_EQ(3, C.load());
+  ASSERT_EQ(5, D.load());
+
+  // Depending on a completed task doesn't delay the continuation.
+  Opts.Dependencies = TA;
+  Pool.schedule([&] { ++D; }, Opts).wait();
+  ASSERT_EQ(6, D.load());
+}
+
+TEST_F(ThreadPoolTest, GroupWait) {
+  CHECK_UNSUPPORTED();
+  std::atomic_int Blocked{0}, Quick{0};
+  ThreadPool Pool(hardware_concurrency(2));
+  ThreadPoolTaskGroup Group1(Pool);
+  ThreadPoolTaskGroup Group2(Pool);
+  Group1.async([this, &Blocked] {
+    waitForMainThread();
+    ++Blocked;
+  });
+  for (int I = 0; I < 5; ++I)
+    Group2.async([&Quick] { ++Quick; });
+  // Only the second group is waited for; the first is still blocked.
+  Group2.wait();
+  ASSERT_EQ(5, Quick.load());
+  ASSERT_EQ(0, Blocked.load());
+  setMainThreadReady();
+  Group1.wait();
+  ASSERT_EQ(1, Blocked.load());
+}
+
+TEST_F(ThreadPoolTest, NestedGroupWait) {
+  CHECK_UNSUPPORTED();
+  // Waiting on a group from a task of a single thread pool must run the
+  // group's tasks instead of deadlocking.
+  std::atomic_int Count{0};
+  ThreadPool Pool(hardware_concurrency(1));
+  Pool.async([&] {
+    ThreadPoolTaskGroup Group(Pool);
+    for (int I = 0; I < 10; ++I)
+      Group.async([&Count] { ++Count; });
+    Group.wait();
+    ASSERT_EQ(10, Count.load());
+  });
+  Pool.wait();
+  ASSERT_EQ(10, Count.load());
+}
+
 #if LLVM_ENABLE_THREADS == 1
 
 void ThreadPoolTest::RunOnAllSockets(ThreadPoolStrategy S) {
@@ -0,0 +1,155 @@
+//===- unittests/TimeProfilerTest.cpp - Time profiler tests ---------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/TimeProfiler.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Parallel.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+// Returns the trace events of the current profiler named \p Name.
+std::vector<json::Object> getEvents(StringRef Name) {
+  SmallString<1024> Trace;
+  raw_svector_ostream OS(Trace);
+  timeTraceProfilerWrite(OS);
+
+  std::vector<json::Object> Events;
+  Expected<json::Value> Root = json::parse(Trace);
+  EXPECT_TRUE(bool(Root));
+  if (!Root)
+    return Events;
+  for (const json::Value &Event :
+       *Root->getAsObject()->getArray("traceEvents")) {
+    const json::Object *Obj = Event.getAsObject();
+    if (Obj->getString("name") == Name)
+      Events.push_back(*Obj);
+  }
+  return Events;
+}
+
+TEST(TimeProfiler, DoesNotRecordMemoryByDefault) {
+  timeTraceProfilerInitialize(/*TimeTraceGranularity=*/0, "test");
+  { TimeTraceScope Scope("Scope", "detail"); }
+
+  std::vector<json::Object> Events = getEvents("Scope");
+  ASSERT_EQ(1u, Events.size());
+  const json::Object *Args = Events[0].getObject("args");
+  ASSERT_TRUE(Args);
+  EXPECT_EQ(StringRef("detail"), Args->getString("detail"));
+  EXPECT_FALSE(Args->get("memory delta"));
+  timeTraceProfilerCleanup();
+}
+
+TEST(TimeProfiler, RecordsMemory) {
+  timeTraceProfilerInitialize(/*TimeTraceGranularity=*/0, "test",
+                              /*RecordMemory=*/true);
+  std::unique_ptr<char[]> Memory;
+  {
+    TimeTraceScope Outer("Outer");
+    {
+      TimeTraceScope Inner("Inner");
+      Memory.reset(new char[1 << 20]);
+      Memory[0] = 1;
+    }
+  }
+
+  for (StringRef Name : {"Outer", "Inner"}) {
+    std::vector<json::Object> Events = getEvents(Name);
+    ASSERT_EQ(1u, Events.size()) << Name;
+    const json::Object *Args = Events[0].getObject("args");
+    ASSERT_TRUE(Args) << Name;
+    Optional<int64_t> Delta = Args->getInteger("memory delta");
+    Optional<int64_t> Peak = Args->getInteger("memory peak");
+    ASSERT_TRUE(Delta && Peak) << Name;
+    EXPECT_LE(*Delta, *Peak) << Name;
+  }
+  timeTraceProfilerCleanup();
+}
+
+#if LLVM_ENABLE_THREADS
+// Checks that the tasks recorded as "Task" sections ran on other threads than
+// the current one, each with one "Inner" section nested inside, and that they
+// are not counted twice in the totals.
+static void checkTasks(StringRef Task, unsigned NumTasks) {
+  int64_t Tid = get_threadid();
+  std::vector<json::Object> Tasks = getEvents(Task);
+  ASSERT_EQ(NumTasks + 1, Tasks.size());
+  EXPECT_EQ(1, llvm::count_if(Tasks, [&](const json::Object &E) {
+              return E.getInteger("tid") == Tid;
+            }));
+
+  std::vector<json::Object> Inner = getEvents("Inner");
+  ASSERT_EQ(NumTasks, Inner.size());
+  for (const json::Object &E : Inner)
+    EXPECT_NE(Tid, E.getInteger("tid"));
+
+  std::vector<json::Object> Totals = getEvents(("Total " + Task).str());
+  ASSERT_EQ(1u, Totals.size());
+  EXPECT_EQ(Optional<int64_t>(1),
+            Totals[0].getObject("args")->getInteger("count"));
+}
+
+TEST(TimeProfiler, RecordsThreadPoolTasks) {
+  timeTraceProfilerInitialize(/*TimeTraceGranularity=*/0, "test");
+  {
+    TimeTraceScope Scope("Schedule");
+    ThreadPool Pool(hardware_concurrency(2));
+    for (unsigned I = 0; I != 4; ++I)
+      Pool.async([] { TimeTraceScope Scope("Inner"); });
+    Pool.wait();
+  }
+  checkTasks("Schedule", 4);
+  timeTraceProfilerCleanup();
+}
+
+TEST(TimeProfiler, RecordsParallelTasks) {
+  timeTraceProfilerInitialize(/*TimeTraceGranularity=*/0, "test");
+  {
+    TimeTraceScope Scope("Spawn");
+    parallel::detail::TaskGroup TG;
+    for (unsigned I = 0; I != 4; ++I)
+      TG.spawn([] { TimeTraceScope Scope("Inner"); });
+  }
+  checkTasks("Spawn", 4);
+  timeTraceProfilerCleanup();
+}
+#endif
+
+#define DEBUG_TYPE "timeprofiler-test"
+SHARDED_STATISTIC(NumScopes, "Number of scopes entered");
+
+TEST(TimeProfiler, WritesStatistics) {
+  EnableStatistics(/*DoPrintOnExit=*/false);
+  ResetStatistics();
+  timeTraceProfilerInitialize(/*TimeTraceGranularity=*/0, "test");
+  for (unsigned I = 0; I != 3; ++I) {
+    TimeTraceScope Scope("Scope");
+    ++NumScopes;
+  }
+
+  SmallString<1024> Trace;
+  raw_svector_ostream OS(Trace);
+  timeTraceProfilerWrite(OS);
+  Expected<json::Value> Root = json::parse(Trace);
+  ASSERT_TRUE(bool(Root));
+  const json::Object *Stats = Root->getAsObject()->getObject("statistics");
+  ASSERT_TRUE(Stats);
+  EXPECT_EQ(Optional<int64_t>(3),
+            Stats->getInteger("timeprofiler-test.NumScopes"));
+  timeTraceProfilerCleanup();
+  ResetStatistics();
+}
+
+} // namespace
@@ -883,6 +883,98 @@ TEST(ProxyFileSystemTest, Basic) {
   EXPECT_FALSE(Local);
 }
 
+namespace {
+/// Counts the lookups that reach a file system.
+class CountingFileSystem : public vfs::ProxyFileSystem {
+public:
+  explicit CountingFileSystem(IntrusiveRefCntPtr<vfs::FileSystem> FS)
+      : ProxyFileSystem(std::move(FS)) {}
+
+  ErrorOr<vfs::Status> status(const Twine &Path) override {
+    ++StatusCalls;
+    return ProxyFileSystem::status(Path);
+  }
+  vfs::directory_iterator dir_begin(const Twine &Dir,
+                                    std::error_code &EC) override {
+    ++DirBeginCalls;
+    return ProxyFileSystem::dir_begin(Dir, EC);
+  }
+
+  int StatusCalls = 0;
+  int DirBeginCalls = 0;
+};
+} // end anonymous namespace
+
+TEST(CachingFileSystemTest, CachesStatus) {
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> Base(
+      new vfs::InMemoryFileSystem());
+  Base->addFile("/a/b", 0, MemoryBuffer::getMemBuffer("test"));
+  IntrusiveRefCntPtr<CountingFileSystem> Counting(new CountingFileSystem(Base));
+  vfs::CachingFileSystem FS(Counting, /*ListDirectories=*/false);
+
+  ASSERT_FALSE(FS.status("/a/b").getError());
+  ASSERT_FALSE(FS.status("/a/b").getError());
+  EXPECT_EQ(1, Counting->StatusCalls);
+
+  ASSERT_FALSE(FS.setCurrentWorkingDirectory("/a"));
+  auto Stat = FS.status("b");
+  ASSERT_FALSE(Stat.getError());
+  EXPECT_EQ("b", Stat->getName());
+  EXPECT_EQ(1, Counting->StatusCalls);
+
+  EXPECT_EQ(errc::no_such_file_or_directory, FS.status("/a/c").getError());
+  EXPECT_EQ(errc::no_such_file_or_directory, FS.status("/a/c").getError());
+  EXPECT_EQ(2, Counting->StatusCalls);
+  EXPECT_EQ(0, Counting->DirBeginCalls);
+}
+
+TEST(CachingFileSystemTest, NegativeLookupsFromListing) {
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> Base(
+      new vfs::InMemoryFileSystem());
+  Base->addFile("/a/b", 0, MemoryBuffer::getMemBuffer("test"));
+  Base->addFile("/a/c", 0, MemoryBuffer::getMemBuffer("test"));
+  IntrusiveRefCntPtr<CountingFileSystem> Counting(new CountingFileSystem(Base));
+  vfs::CachingFileSystem FS(Counting);
+
+  EXPECT_EQ(errc::no_such_file_or_directory, FS.status("/a/x").getError());
+  EXPECT_EQ(errc::no_such_file_or_directory, FS.status("/a/y").getError());
+  EXPECT_EQ(errc::no_such_file_or_directory,
+            FS.openFileForRead("/a/z").getError());
+  EXPECT_EQ(0, Counting->StatusCalls);
+  EXPECT_EQ(1, Counting->DirBeginCalls);
+
+  ASSERT_FALSE(FS.status("/a/b").getError());
+  ASSERT_FALSE(FS.openFileForRead("/a/c").getError());
+  EXPECT_EQ(1, Counting->StatusCalls);
+
+  std::error_code EC;
+  std::vector<std::string> Contents;
+  for (vfs::directory_iterator I = FS.dir_begin("/a", EC), E; !EC && I != E;
+       I.increment(EC))
+    Contents.push_back(std::string(I->path()));
+  ASSERT_FALSE(EC);
+  EXPECT_THAT(Contents, UnorderedElementsAre("/a/b", "/a/c"));
+  EXPECT_EQ(1, Counting->DirBeginCalls);
+}
+
+TEST(CachingFileSystemTest, Invalidate) {
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> Base(
+      new vfs::InMemoryFileSystem());
+  Base->addFile("/a/b", 0, MemoryBuffer::getMemBuffer("test"));
+  vfs::CachingFileSystem FS(Base);
+
+  EXPECT_EQ(errc::no_such_file_or_directory, FS.status("/a/c").getError());
+  Base->addFile("/a/c", 0, MemoryBuffer::getMemBuffer("test"));
+  EXPECT_EQ(errc::no_such_file_or_directory, FS.status("/a/c").getError());
+
+  FS.invalidate("/a/c");
+  EXPECT_FALSE(FS.status("/a/c").getError());
+
+  Base->addFile("/a/d", 0, MemoryBuffer::getMemBuffer("test"));
+  FS.invalidateAll();
+  EXPECT_FALSE(FS.status("/a/d").getError());
+}
+
 class InMemoryFileSystemTest : public ::testing::Test {
 protected:
   llvm::vfs::InMemoryFileSystem FS;
@@ -69,8 +69,8 @@ cl::opt<bool> EmitLongStrLiterals(
 } // end namespace llvm
 
 namespace {
-cl::opt<ActionType> Action(
-    cl::desc("Action to perform:"),
+cl::list<ActionType> Actions(
+    cl::desc("Actions to perform, each one writing to its own -o file:"),
     cl::values(
         clEnumValN(PrintRecords, "print-records",
                    "Print all records to stdout (default)"),
@@ -145,8 +145,9 @@ cl::opt<std::string> Class("class", cl::desc("Print Enum list for this class"),
                            cl::value_desc("class name"),
                            cl::cat(PrintEnumsCat));
 
-bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
-  switch (Action) {
+bool LLVMTableGenMain(unsigned Action, raw_ostream &OS,
+                      RecordKeeper &Records) {
+  switch (Actions.empty() ? PrintRecords : Actions[Action]) {
   case PrintRecords:
     OS << Records;              // No argument, dump all contents
     break;
@@ -282,7 +283,8 @@ int main(int argc, char **argv) {
   InitLLVM X(argc, argv);
   cl::ParseCommandLineOptions(argc, argv);
 
-  return TableGenMain(argv[0], &LLVMTableGenMain);
+  return TableGenMain(argv[0], std::max<unsigned>(Actions.size(), 1),
+                      LLVMTableGenMain);
 }
 
 #ifndef __has_feature
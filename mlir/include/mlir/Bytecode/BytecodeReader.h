@@ -0,0 +1,88 @@
+//===- BytecodeReader.h - MLIR Bytecode Reader ------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This header defines interfaces to read MLIR bytecode files/streams.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef MLIR_BYTECODE_BYTECODEREADER_H
+#define MLIR_BYTECODE_BYTECODEREADER_H
+
+#include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
+#include <memory>
+
+namespace llvm {
+class MemoryBufferRef;
+} // end namespace llvm
+
+namespace mlir {
+class Block;
+class LocationAttr;
+class MLIRContext;
+class Operation;
+
+/// Returns true if the given buffer starts with the magic number of MLIR
+/// bytecode.
+bool isBytecode(llvm::MemoryBufferRef buffer);
+
+/// Read the operations defined within the given bytecode buffer and append
+/// them to the given block. If successful, the operations are verified and
+/// success is returned. Otherwise, an error is emitted through the error
+/// handler registered in the context, and failure is returned. If
+/// `sourceFileLoc` is non-null, it is populated with a file location
+/// representing the start of the buffer.
+///
+/// Strings and blobs of data, such as the contents of dense elements
+/// attributes, are referenced in place while reading, so reading a buffer that
+/// maps a file does not copy them out of the file first.
+LogicalResult readBytecodeFile(llvm::MemoryBufferRef buffer, Block *block,
+                               MLIRContext *context,
+                               LocationAttr *sourceFileLoc = nullptr);
+
+/// This class allows for reading a bytecode buffer in stages. With lazy
+/// loading enabled, the regions of operations that are isolated from above,
+/// such as functions, are not read along with the operation that holds them.
+/// These operations are left with empty regions until they are materialized,
+/// which allows for only paying for the parts of the IR that are used.
+///
+/// The buffer must outlive the reader. Operations that have not been
+/// materialized must not be erased while the reader is alive, and the IR is
+/// not verified by the reader when lazy loading is enabled.
+class BytecodeReader {
+public:
+  BytecodeReader(llvm::MemoryBufferRef buffer, MLIRContext *context,
+                 bool lazyLoad = false);
+  ~BytecodeReader();
+
+  /// Read the top-level operations of the buffer and append them to the given
+  /// block. If lazy loading is disabled, all of the IR is read and verified.
+  /// `sourceFileLoc` is populated as for `readBytecodeFile`.
+  LogicalResult readTopLevel(Block *block,
+                             LocationAttr *sourceFileLoc = nullptr);
+
+  /// Returns true if the given operation has regions that have not been
+  /// materialized yet.
+  bool isMaterializable(Operation *op);
+
+  /// Materialize the regions of the given operation. The regions of operations
+  /// nested within them that are isolated from above are loaded lazily in
+  /// turn.
+  LogicalResult materialize(Operation *op);
+
+  /// Materialize all of the operations that have not been loaded yet.
+  LogicalResult materializeAll();
+
+private:
+  class Impl;
+  std::unique_ptr<Impl> impl;
+};
+
+} // end namespace mlir
+
+#endif // MLIR_BYTECODE_BYTECODEREADER_H
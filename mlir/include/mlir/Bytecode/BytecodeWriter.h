@@ -0,0 +1,30 @@
+//===- BytecodeWriter.h - MLIR Bytecode Writer ------------------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This header defines interfaces to write MLIR bytecode files/streams.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef MLIR_BYTECODE_BYTECODEWRITER_H
+#define MLIR_BYTECODE_BYTECODEWRITER_H
+
+#include "mlir/Support/LLVM.h"
+
+namespace mlir {
+class Operation;
+
+/// Write the bytecode for the given operation to the provided output stream.
+/// The operation is written as the only top-level operation of the file, and
+/// may be read back with `readBytecodeFile`. Attributes and types are encoded
+/// by the BytecodeDialectInterface of their dialect when it provides an
+/// encoding, and in their textual form otherwise.
+void writeBytecodeToFile(Operation *op, raw_ostream &os);
+
+} // end namespace mlir
+
+#endif // MLIR_BYTECODE_BYTECODEWRITER_H
@@ -0,0 +1,153 @@
+//===- AutoTuning.h - Linalg codegen strategy auto-tuning -------*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This header declares a driver that searches for the tiling, interchange and
+// vectorization configuration of the CodegenStrategy that runs fastest for a
+// given Linalg op. The configurations are measured through a user provided
+// benchmark function, e.g. one that JIT-compiles them with the
+// ExecutionEngine, and the best one is cached by op shape.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef MLIR_DIALECT_LINALG_TRANSFORMS_AUTOTUNING_H_
+#define MLIR_DIALECT_LINALG_TRANSFORMS_AUTOTUNING_H_
+
+#include "mlir/Dialect/Linalg/IR/LinalgOps.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "llvm/ADT/StringMap.h"
+
+#include <functional>
+
+namespace mlir {
+namespace linalg {
+
+/// A point of the search space of the auto-tuner: a level of tiling with the
+/// tiled loops optionally interchanged, optionally followed by the
+/// vectorization of the tiles. A zero tile size leaves the corresponding loop
+/// untiled, and empty tile sizes leave the op untiled.
+struct TuningConfig {
+  SmallVector<int64_t, 4> tileSizes;
+  SmallVector<unsigned, 4> interchange;
+  bool vectorize = false;
+
+  /// Print the configuration in the format accepted by `parse`, e.g.
+  /// `tile=8,16,32 interchange=1,0,2 vectorize=1`.
+  void print(raw_ostream &os) const;
+
+  /// Parse a configuration printed by `print`. Returns None if `str` is
+  /// malformed.
+  static Optional<TuningConfig> parse(StringRef str);
+
+  bool operator==(const TuningConfig &other) const {
+    return tileSizes == other.tileSizes && interchange == other.interchange &&
+           vectorize == other.vectorize;
+  }
+};
+
+/// The configurations explored by the auto-tuner.
+struct TuningSearchSpace {
+  /// The candidate tile sizes of each loop, in addition to 0. Sizes that do not
+  /// evenly divide the range of a loop, or that are not smaller than it, are
+  /// skipped for that loop.
+  SmallVector<int64_t, 4> tileSizes = {4, 8, 16, 32, 64};
+  /// Explore the permutations of the tiled loops of ops that have at most this
+  /// number of loops. Zero disables the exploration of interchanges.
+  unsigned maxInterchangeLoops = 3;
+  /// Explore the vectorization of tiles whose iteration space holds at most
+  /// this number of points. Zero disables the exploration of vectorization.
+  int64_t maxVectorTileVolume = 4096;
+  /// The maximum number of configurations explored for an op, zero for no
+  /// limit. Configurations past the limit in enumeration order are dropped.
+  unsigned maxNumConfigs = 0;
+};
+
+/// Returns the configurations of `space` that apply to `op`, starting with the
+/// configuration that leaves the op untransformed. Returns no configuration if
+/// the loop ranges of `op` are not statically known.
+SmallVector<TuningConfig, 8>
+enumerateTuningConfigs(LinalgOp op, const TuningSearchSpace &space);
+
+/// Returns the key under which the configuration of `op` is cached: the name
+/// of the op, its iterator types, its indexing maps and the types of its
+/// operands.
+std::string getTuningKey(LinalgOp op);
+
+/// Returns a new module holding a clone of `op` within a function named
+/// `kernelName`, which takes the operands of `op` as arguments. Returns null if
+/// `op` does not have buffer semantics with statically shaped operands.
+OwningModuleRef buildTuningKernel(LinalgOp op, StringRef kernelName);
+
+/// Apply `config` to all of the Linalg ops named `opName` in `func` through a
+/// CodegenStrategy. Returns failure if the tiling or the vectorization of the
+/// configuration did not apply.
+LogicalResult applyTuningConfig(FuncOp func, StringRef opName,
+                                const TuningConfig &config);
+
+/// A map from tuning keys to the best configuration found for them. The cache
+/// has a textual form, one `key<tab>config` line per entry, so that it can be
+/// saved and reused across runs.
+class TuningCache {
+public:
+  /// Returns the configuration cached for `key`, or null if there is none.
+  const TuningConfig *lookup(StringRef key) const;
+
+  /// Cache `config` for `key`, replacing any previous entry.
+  void insert(StringRef key, const TuningConfig &config);
+
+  /// Returns the number of cached entries.
+  size_t size() const { return entries.size(); }
+
+  /// Print the textual form of the cache, with entries sorted by key.
+  void print(raw_ostream &os) const;
+
+  /// Add the entries of the given textual form of a cache. Returns failure if
+  /// a line is malformed, in which case the entries of the previous lines have
+  /// been added.
+  LogicalResult parse(StringRef text);
+
+private:
+  llvm::StringMap<TuningConfig> entries;
+};
+
+/// A function that measures a candidate configuration. It is given a module
+/// holding the transformed op within a function named `kernelName`, see
+/// `buildTuningKernel`, and returns the running time of the function in
+/// seconds, or None if it could not be measured. The module may be modified.
+using TuningBenchmarkFn =
+    std::function<Optional<double>(ModuleOp module, StringRef kernelName)>;
+
+/// Drives the search for the fastest configuration of Linalg ops. Each
+/// configuration of the search space is applied to a kernel holding a clone of
+/// the op and measured with the benchmark function, and the fastest one is
+/// recorded in the cache.
+class LinalgAutoTuner {
+public:
+  LinalgAutoTuner(TuningSearchSpace space, TuningBenchmarkFn benchmark,
+                  TuningCache &cache)
+      : space(std::move(space)), benchmark(std::move(benchmark)),
+        cache(cache) {}
+
+  /// Returns the fastest configuration for `op`. Ops whose key is in the cache
+  /// are not measured again. Returns None if `op` cannot be extracted into a
+  /// kernel, see `buildTuningKernel`, or if no configuration could be
+  /// measured.
+  Optional<TuningConfig> tune(LinalgOp op);
+
+  /// Returns the name of the kernel function given to the benchmark function.
+  static StringRef getKernelName() { return "linalg_autotune_kernel"; }
+
+private:
+  TuningSearchSpace space;
+  TuningBenchmarkFn benchmark;
+  TuningCache &cache;
+};
+
+} // namespace linalg
+} // namespace mlir
+
+#endif // MLIR_DIALECT_LINALG_TRANSFORMS_AUTOTUNING_H_
@@ -83,6 +83,45 @@ struct Vectorize : public Transformation {
   }
 };
 
+/// Same as `Tile<LinalgOpType>` for the Linalg op with name `opName`, for use
+/// when the type of the op is only known at runtime.
+struct TileByName : public Transformation {
+  TileByName(StringRef opName, linalg::LinalgTilingOptions options)
+      : opName(opName.str()), options(options) {}
+
+  OwningRewritePatternList
+  buildRewritePatterns(MLIRContext *context, linalg::LinalgMarker m) override {
+    OwningRewritePatternList tilingPatterns;
+    tilingPatterns.insert<linalg::LinalgTilingPatternByName>(opName, context,
+                                                             options, m);
+    return tilingPatterns;
+  }
+
+private:
+  std::string opName;
+  linalg::LinalgTilingOptions options;
+};
+
+/// Same as `Vectorize<LinalgOpType>` for the Linalg op with name `opName`, for
+/// use when the type of the op is only known at runtime.
+struct VectorizeByName : public Transformation {
+  explicit VectorizeByName(StringRef opName) : opName(opName.str()) {}
+
+  OwningRewritePatternList
+  buildRewritePatterns(MLIRContext *context, linalg::LinalgMarker m) override {
+    OwningRewritePatternList vectorizationPatterns;
+    vectorizationPatterns.insert<linalg::LinalgBaseVectorizationPattern>(
+        opName, context, m);
+    vectorizationPatterns.insert<linalg::LinalgCopyVTRForwardingPattern,
+                                 linalg::LinalgCopyVTWForwardingPattern>(
+        context, /*benefit=*/2);
+    return vectorizationPatterns;
+  }
+
+private:
+  std::string opName;
+};
+
 /// Codegen strategy controls how a Linalg op is progressively lowered.
 /// The application uses a 3-level staged patterns strategy which allows
 /// ordering transformations by using the Linalg `applyStagedPatterns` function,
@@ -107,6 +146,13 @@ struct CodegenStrategy {
   CodegenStrategy &tileIf(bool b, linalg::LinalgTilingOptions options) {
     return b ? tile<LinalgOpType>(options) : *this;
   }
+  /// Append a pattern to add a level of tiling for the Linalg op named
+  /// `opName` with tiling `options`.
+  CodegenStrategy &tile(StringRef opName,
+                        linalg::LinalgTilingOptions options) {
+    transformationSequence.emplace_back(new TileByName(opName, options));
+    return *this;
+  }
   /// Append a pattern to add a level of promotion for `LinalgOpType` with
   /// promotion `options`.
   template <typename LinalgOpType>
@@ -134,6 +180,12 @@ struct CodegenStrategy {
     return b ? vectorize<LinalgOpType>() : *this;
     return *this;
   }
+  /// Append a pattern to rewrite the Linalg op named `opName` as a vector
+  /// operation.
+  CodegenStrategy &vectorize(StringRef opName) {
+    transformationSequence.emplace_back(new VectorizeByName(opName));
+    return *this;
+  }
   /// Configure the post staged-patterns late vector transformations.
   CodegenStrategy &
   setVectorTransformsOptions(vector::VectorTransformsOptions options) {
@@ -432,6 +432,28 @@ struct LinalgTilingPattern : public LinalgBaseTilingPattern {
   }
 };
 
+/// Same as `LinalgTilingPattern` for the Linalg op with name `opName`, for use
+/// when the type of the op is only known at runtime.
+struct LinalgTilingPatternByName : public LinalgBaseTilingPattern {
+  LinalgTilingPatternByName(StringRef opName, MLIRContext *context,
+                            LinalgTilingOptions options,
+                            LinalgMarker marker = LinalgMarker(),
+                            PatternBenefit benefit = 1)
+      : LinalgBaseTilingPattern(opName, context, options, marker, benefit) {}
+  LogicalResult matchAndRewrite(Operation *op,
+                                PatternRewriter &rewriter) const override {
+    SmallVector<Value, 4> tensorResults;
+    if (failed(LinalgBaseTilingPattern::matchAndRewriteBase(op, rewriter,
+                                                            tensorResults)))
+      return failure();
+    if (tensorResults.empty())
+      rewriter.eraseOp(op);
+    else
+      rewriter.replaceOp(op, tensorResults);
+    return success();
+  }
+};
+
 struct LinalgFusionOptions {
   /// List of operands indices to use for fusion.
   llvm::SmallSet<unsigned, 1> indicesToFuse = {};
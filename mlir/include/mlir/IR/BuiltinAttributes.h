@@ -14,6 +14,10 @@
 #include "llvm/ADT/Sequence.h"
 #include <complex>
 
+namespace llvm {
+class MemoryBuffer;
+} // end namespace llvm
+
 namespace mlir {
 class AffineMap;
 class FunctionType;
@@ -670,6 +674,21 @@ public:
   static bool isValidRawBuffer(ShapedType type, ArrayRef<char> rawBuffer,
                                bool &detectedSplat);
 
+  /// Construct a dense elements attribute that refers to the contents of
+  /// `buffer` in place, e.g. a memory mapped file, instead of copying them into
+  /// the context. The context takes ownership of the buffer and keeps it alive
+  /// until the context is destroyed. The contents are expected to be in the
+  /// raw buffer format, see `isValidRawBuffer`, and aligned to the storage
+  /// width of the element type. Returns null if the contents are not a valid
+  /// raw buffer for 'type'.
+  ///
+  /// The contents are neither copied nor hashed: the attribute is uniqued by
+  /// the address of the buffer, so attributes created from distinct buffers
+  /// compare unequal even if their contents are the same.
+  static DenseElementsAttr
+  getFromExternalBuffer(ShapedType type,
+                        std::unique_ptr<llvm::MemoryBuffer> buffer);
+
   //===--------------------------------------------------------------------===//
   // Iterators
   //===--------------------------------------------------------------------===//
@@ -953,6 +972,10 @@ public:
   /// form the user might expect.
   ArrayRef<char> getRawData() const;
 
+  /// Returns true if the raw data of this attribute is held outside of the
+  /// context, see `getFromExternalBuffer`.
+  bool isExternal() const;
+
   /// Return the raw StringRef data held by this attribute.
   ArrayRef<StringRef> getRawStringData() const;
 
@@ -1079,6 +1102,12 @@ protected:
   static DenseElementsAttr getRaw(ShapedType type, ArrayRef<char> data,
                                   bool isSplat);
 
+  /// Get or create a new dense elements attribute instance that refers to the
+  /// given raw data buffer in place. The buffer must outlive the context.
+  /// 'type' must be a vector or tensor with static shape.
+  static DenseElementsAttr getRawExternal(ShapedType type, ArrayRef<char> data,
+                                          bool isSplat);
+
   /// Overload of the raw 'get' method that asserts that the given type is of
   /// complex type. This method is used to verify type invariants that the
   /// templatized 'get' method cannot.
@@ -11,6 +11,7 @@
 
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "llvm/Support/TypeName.h"
 
 namespace mlir {
 
@@ -89,6 +90,14 @@ public:
   /// safe to apply this pattern recursively to generated IR.
   bool hasBoundedRewriteRecursion() const { return hasBoundedRecursion; }
 
+  /// Return a readable name for this pattern, used for debugging and for
+  /// statistics. Patterns added to an OwningRewritePatternList by type are
+  /// named after that type.
+  StringRef getDebugName() const { return debugName; }
+
+  /// Set the readable name of this pattern.
+  void setDebugName(StringRef name) { debugName = name; }
+
 protected:
   /// This class acts as a special tag that makes the desire to match "any"
   /// operation type explicit. This helps to avoid unnecessary usages of this
@@ -137,6 +146,9 @@ private:
 
   /// A boolean flag of whether this pattern has bounded recursion or not.
   bool hasBoundedRecursion = false;
+
+  /// A readable name for this pattern.
+  StringRef debugName;
 };
 
 //===----------------------------------------------------------------------===//
@@ -644,6 +656,8 @@ private:
   insertImpl(Args &&...args) {
     nativePatterns.emplace_back(
         std::make_unique<T>(std::forward<Args>(args)...));
+    if (nativePatterns.back()->getDebugName().empty())
+      nativePatterns.back()->setDebugName(llvm::getTypeName<T>());
   }
   template <typename T, typename... Args>
   std::enable_if_t<std::is_base_of<PDLPatternModule, T>::value>
@@ -40,6 +40,13 @@ public:
 
   virtual ~PassInstrumentation() = 0;
 
+  /// Returns true if this instrumentation synchronizes access to its own
+  /// state. The PassInstrumentor serializes the callbacks of instrumentations
+  /// that do not, which costs a lock around every pass and analysis run on
+  /// every thread. Thread-safe instrumentations may have their callbacks
+  /// invoked concurrently from multiple threads.
+  virtual bool isThreadSafe() const { return false; }
+
   /// A callback to run before a pass pipeline is executed. This function takes
   /// the name of the operation type being operated on, and information related
   /// to the parent that spawned this pipeline.
@@ -290,9 +290,12 @@ public:
     /// Initialize the configuration.
     /// * 'displayMode' switch between list or pipeline display (see the
     /// `PassDisplayMode` enum documentation).
+    /// * 'traceFile' if non-empty, the file to write a Chrome trace of the
+    /// pass and analysis executions on each thread to.
     explicit PassTimingConfig(
-        PassDisplayMode displayMode = PassDisplayMode::Pipeline)
-        : displayMode(displayMode) {}
+        PassDisplayMode displayMode = PassDisplayMode::Pipeline,
+        std::string traceFile = "")
+        : displayMode(displayMode), traceFile(std::move(traceFile)) {}
 
     virtual ~PassTimingConfig();
 
@@ -301,11 +304,23 @@ public:
     /// responsible to call it back with a stream for the output.
     virtual void printTiming(PrintCallbackFn printCallback);
 
+    /// A hook that may be overridden by a derived config to control where the
+    /// Chrome trace is printed, if one was requested. The default
+    /// implementation writes it to the trace file.
+    virtual void printTrace(PrintCallbackFn printCallback);
+
     /// Return the `PassDisplayMode` this config was created with.
     PassDisplayMode getDisplayMode() { return displayMode; }
 
+    /// Return true if a Chrome trace of pass execution should be recorded.
+    bool shouldTrace() { return !traceFile.empty(); }
+
+    /// Return the file the Chrome trace is written to by default.
+    StringRef getTraceFile() { return traceFile; }
+
   private:
     PassDisplayMode displayMode;
+    std::string traceFile;
   };
 
   /// Add an instrumentation to time the execution of passes and the computation
@@ -15,6 +15,8 @@
 #define MLIR_REWRITE_PATTERNAPPLICATOR_H
 
 #include "mlir/Rewrite/FrozenRewritePatternList.h"
+#include "llvm/ADT/DenseSet.h"
+#include <chrono>
 
 namespace mlir {
 class PatternRewriter;
@@ -33,6 +35,18 @@ public:
   /// `impossibleToMatch`.
   using CostModel = function_ref<PatternBenefit(const Pattern &)>;
 
+  /// Statistics about the application of a single pattern, collected when
+  /// enabled with `enableStatistics`.
+  struct PatternStatistics {
+    /// The number of times the pattern was tried, and how many of those
+    /// resulted in a rewrite.
+    unsigned numAttempts = 0;
+    unsigned numSuccesses = 0;
+    /// The time spent matching and rewriting with the pattern. For PDL
+    /// patterns, whose matching is shared, this only includes the rewrite.
+    std::chrono::nanoseconds time{0};
+  };
+
   explicit PatternApplicator(const FrozenRewritePatternList &frozenPatternList);
   ~PatternApplicator();
 
@@ -63,7 +77,26 @@ public:
   /// Walk all of the patterns within the applicator.
   void walkAllPatterns(function_ref<void(const Pattern &)> walk);
 
+  /// Enable or disable the collection of per-pattern statistics. Statistics
+  /// are not collected by default, as timing each pattern is not free.
+  void enableStatistics(bool enable = true) { collectStatistics = enable; }
+
+  /// Return the statistics collected for each pattern that was tried.
+  const DenseMap<const Pattern *, PatternStatistics> &getStatistics() const {
+    return statistics;
+  }
+
+  /// Print the collected statistics to the given stream, sorted by the time
+  /// spent in each pattern.
+  void printStatistics(raw_ostream &os) const;
+
 private:
+  /// Returns true if a PDL pattern may match the given operation.
+  bool mayMatchPDLPattern(Operation *op) const {
+    return hasAnyOpPDLPattern || pdlRootKinds.count(op->getName());
+  }
+
+
   /// The list that owns the patterns used within this applicator.
   const FrozenRewritePatternList &frozenPatternList;
   /// The set of patterns to match for each operation, stable sorted by benefit.
@@ -71,8 +104,17 @@ private:
   /// The set of patterns that may match against any operation type, stable
   /// sorted by benefit.
   SmallVector<const RewritePattern *, 1> anyOpPatterns;
+  /// The root operations of the PDL patterns, used to avoid running the PDL
+  /// matcher on operations that none of them may match, and whether any PDL
+  /// pattern may match any operation type.
+  DenseSet<OperationName> pdlRootKinds;
+  bool hasAnyOpPDLPattern = false;
   /// The mutable state used during execution of the PDL bytecode.
   std::unique_ptr<detail::PDLByteCodeMutableState> mutableByteCodeState;
+
+  /// Whether per-pattern statistics are collected, and the statistics.
+  bool collectStatistics = false;
+  DenseMap<const Pattern *, PatternStatistics> statistics;
 };
 
 } // end namespace mlir
@@ -18,6 +18,28 @@
 
 namespace mlir {
 
+/// This class allows control over how the greedy pattern rewrite driver works.
+class GreedyRewriteConfig {
+public:
+  /// The maximum number of times the driver iterates between applying patterns
+  /// and simplifying the regions before giving up on reaching a fixed point.
+  unsigned maxIterations = 10;
+
+  /// If true, all of the operations within the regions are visited again in
+  /// each iteration after one that changed the IR. If false, the regions are
+  /// only scanned once up front, and afterwards only the operations affected
+  /// by a change are revisited: newly created and modified operations, the
+  /// users of replaced results, and the defining operations of operands that
+  /// lost a use. The regions are then only scanned again if the region
+  /// simplification changed them.
+  bool rescanRegionsOnChange = true;
+
+  /// If true, the number of attempts, the number of successful rewrites, and
+  /// the time spent in each pattern are printed to stderr once the driver is
+  /// done.
+  bool printPatternStatistics = false;
+};
+
 //===----------------------------------------------------------------------===//
 // applyPatternsGreedily
 //===----------------------------------------------------------------------===//
@@ -56,6 +78,17 @@ applyPatternsAndFoldGreedily(MutableArrayRef<Region> regions,
                              const FrozenRewritePatternList &patterns,
                              unsigned maxIterations);
 
+/// Rewrite the regions of the specified operation, or the given regions, as
+/// above with the given configuration of the driver.
+LogicalResult
+applyPatternsAndFoldGreedily(Operation *op,
+                             const FrozenRewritePatternList &patterns,
+                             const GreedyRewriteConfig &config);
+LogicalResult
+applyPatternsAndFoldGreedily(MutableArrayRef<Region> regions,
+                             const FrozenRewritePatternList &patterns,
+                             const GreedyRewriteConfig &config);
+
 /// Applies the specified patterns on `op` alone while also trying to fold it,
 /// by selecting the highest benefits patterns in a greedy manner. Returns
 /// success if no more patterns can be matched. `erased` is set to true if `op`
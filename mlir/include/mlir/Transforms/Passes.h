@@ -48,6 +48,11 @@ createPromoteBuffersToStackPass(unsigned maxAllocSizeInBytes = 1024,
                                 unsigned bitwidthOfIndexType = 64,
                                 unsigned maxRankOfAllocatedMemRef = 1);
 
+/// Creates a pass that lets buffers with disjoint live ranges share the
+/// storage of a single arena allocation per block.
+std::unique_ptr<Pass> createBufferReusePass(unsigned alignment = 64,
+                                            unsigned bitwidthOfIndexType = 64);
+
 /// Creates a pass that finalizes a partial bufferization by removing remaining
 /// tensor_load and tensor_to_memref operations.
 std::unique_ptr<FunctionPass> createFinalizingBufferizePass();
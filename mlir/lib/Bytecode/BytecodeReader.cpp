@@ -0,0 +1,904 @@
+//===- BytecodeReader.cpp - MLIR Bytecode Reader --------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Bytecode/BytecodeReader.h"
+#include "Encoding.h"
+#include "mlir/Bytecode/BytecodeImplementation.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/Dialect.h"
+#include "mlir/IR/Location.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Verifier.h"
+#include "mlir/Parser.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Support/LEB128.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+using namespace mlir;
+
+bool mlir::isBytecode(llvm::MemoryBufferRef buffer) {
+  return buffer.getBuffer().startswith(
+      StringRef(bytecode::kMagic, sizeof(bytecode::kMagic)));
+}
+
+//===----------------------------------------------------------------------===//
+// EncodingReader
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// This class provides the primitive operations for decoding the contents of
+/// a bytecode buffer.
+class EncodingReader {
+public:
+  EncodingReader(ArrayRef<uint8_t> contents, Location fileLoc)
+      : dataIt(contents.data()), dataEnd(contents.end()), fileLoc(fileLoc) {}
+
+  /// Returns true if the entire section has been read.
+  bool empty() const { return dataIt == dataEnd; }
+
+  /// Returns the remaining size of the bytecode.
+  size_t size() const { return dataEnd - dataIt; }
+
+  /// Emit an error using the given arguments.
+  InFlightDiagnostic emitError(const Twine &msg = {}) {
+    return ::mlir::emitError(fileLoc, msg);
+  }
+
+  /// Parse a single byte from the stream.
+  LogicalResult parseByte(uint8_t &value) {
+    if (empty())
+      return emitError("attempting to parse a byte at the end of the bytecode");
+    value = *dataIt++;
+    return success();
+  }
+
+  /// Parse a range of bytes of 'length' into the given result.
+  LogicalResult parseBytes(size_t length, ArrayRef<uint8_t> &result) {
+    if (length > size()) {
+      return emitError("attempting to parse ")
+             << length << " bytes when only " << size() << " remain";
+    }
+    result = {dataIt, length};
+    dataIt += length;
+    return success();
+  }
+
+  /// Parse a variable width integer.
+  LogicalResult parseVarInt(uint64_t &result) {
+    unsigned length = 0;
+    const char *error = nullptr;
+    result = llvm::decodeULEB128(dataIt, &length, dataEnd, &error);
+    if (error)
+      return emitError("invalid varint: ") << error;
+    dataIt += length;
+    return success();
+  }
+
+  /// Parse a signed variable width integer.
+  LogicalResult parseSignedVarInt(int64_t &result) {
+    unsigned length = 0;
+    const char *error = nullptr;
+    result = llvm::decodeSLEB128(dataIt, &length, dataEnd, &error);
+    if (error)
+      return emitError("invalid signed varint: ") << error;
+    dataIt += length;
+    return success();
+  }
+
+  /// Parse a section header, placing the identifier of the section in
+  /// `sectionID` and its contents in `sectionData`.
+  LogicalResult parseSection(bytecode::Section::ID &sectionID,
+                             ArrayRef<uint8_t> &sectionData) {
+    uint8_t sectionIDByte;
+    uint64_t length;
+    if (failed(parseByte(sectionIDByte)) || failed(parseVarInt(length)))
+      return failure();
+    if (sectionIDByte >= bytecode::Section::kNumSections)
+      return emitError("invalid section ID: ") << unsigned(sectionIDByte);
+    sectionID = static_cast<bytecode::Section::ID>(sectionIDByte);
+    return parseBytes(static_cast<size_t>(length), sectionData);
+  }
+
+private:
+  /// The current data iterator, and an iterator to the end of the buffer.
+  const uint8_t *dataIt, *dataEnd;
+
+  /// A location for the bytecode used to report errors.
+  Location fileLoc;
+};
+} // end anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// BytecodeReader::Impl
+//===----------------------------------------------------------------------===//
+
+namespace mlir {
+class BytecodeReader::Impl {
+public:
+  Impl(llvm::MemoryBufferRef buffer, MLIRContext *context, bool lazyLoad)
+      : buffer(buffer), context(context), lazyLoad(lazyLoad),
+        fileLoc(FileLineColLoc::get(buffer.getBufferIdentifier(), /*line=*/0,
+                                    /*column=*/0, context)) {}
+  ~Impl();
+
+  /// Read the sections of the bytecode, and the top-level operations into the
+  /// given block.
+  LogicalResult read(Block *block);
+
+  /// Lazy loading.
+  bool isMaterializable(Operation *op) { return lazyOps.count(op); }
+  LogicalResult materialize(Operation *op);
+  LogicalResult materializeAll();
+
+  /// Returns true if isolated regions are read lazily.
+  bool isLazy() const { return lazyLoad; }
+
+  /// Return the location of the buffer.
+  Location getFileLoc() const { return fileLoc; }
+
+  /// Accessors for the tables of the bytecode, used by the dialect reader.
+  MLIRContext *getContext() const { return context; }
+  LogicalResult parseString(EncodingReader &reader, StringRef &result);
+  LogicalResult parseBlob(EncodingReader &reader, ArrayRef<char> &result);
+  LogicalResult parseAttribute(EncodingReader &reader, Attribute &result);
+  LogicalResult parseType(EncodingReader &reader, Type &result);
+  template <typename T>
+  LogicalResult parseAttribute(EncodingReader &reader, T &result) {
+    Attribute baseResult;
+    if (failed(parseAttribute(reader, baseResult)))
+      return failure();
+    if ((result = baseResult.dyn_cast<T>()))
+      return success();
+    return reader.emitError("expected attribute of type: ")
+           << llvm::getTypeName<T>() << ", but got: " << baseResult;
+  }
+
+private:
+  class DialectReader;
+
+  //===--------------------------------------------------------------------===//
+  // Sections
+
+  LogicalResult parseStringSection(ArrayRef<uint8_t> sectionData);
+  LogicalResult parseDialectSection(ArrayRef<uint8_t> sectionData);
+  LogicalResult parseAttrTypeSection(ArrayRef<uint8_t> sectionData);
+  LogicalResult parseDataSection(ArrayRef<uint8_t> sectionData);
+  LogicalResult parseIRSection(ArrayRef<uint8_t> sectionData, Block *block);
+
+  //===--------------------------------------------------------------------===//
+  // Attributes and Types
+
+  /// An attribute or type within the attribute and type table. Entries are
+  /// only decoded when first referenced.
+  struct AttrTypeEntry {
+    uint64_t header = 0;
+    ArrayRef<uint8_t> data;
+    Attribute attr;
+    Type type;
+  };
+
+  /// Decode the attribute or type entry with the given index.
+  LogicalResult resolveEntry(EncodingReader &reader, uint64_t index,
+                             bool isType);
+
+  //===--------------------------------------------------------------------===//
+  // Operations
+
+  LogicalResult parseOp(EncodingReader &reader, Block *block, bool isTopLevel);
+  LogicalResult parseRegions(EncodingReader &reader, Operation *op);
+  LogicalResult parseRegion(EncodingReader &reader, Region &region);
+  LogicalResult parseIsolatedRegions(Operation *op, ArrayRef<uint8_t> data);
+
+  /// Value scopes.
+  LogicalResult pushValueScope(EncodingReader &reader);
+  LogicalResult popValueScope(EncodingReader &reader);
+  LogicalResult parseOperand(EncodingReader &reader, Value &result);
+  LogicalResult defineValue(EncodingReader &reader, Value value);
+
+  /// The buffer being read, and the context to read it into.
+  llvm::MemoryBufferRef buffer;
+  MLIRContext *context;
+
+  /// Whether the regions of operations isolated from above are read lazily.
+  bool lazyLoad;
+
+  /// A location for the buffer, used to report errors.
+  Location fileLoc;
+
+  /// The tables of the bytecode.
+  std::vector<StringRef> strings;
+  std::vector<StringRef> dialectNamespaces;
+  std::vector<Dialect *> dialects;
+  std::vector<OperationName> opNames;
+  std::vector<AttrTypeEntry> attrTypeEntries;
+  ArrayRef<uint8_t> dataSection;
+
+  /// The values defined within an isolated scope. Values that are referenced
+  /// before they are defined are held by forward reference placeholders.
+  struct ValueScope {
+    std::vector<Value> values;
+    uint64_t nextValueID = 0;
+  };
+  std::vector<ValueScope> valueScopes;
+  llvm::SmallPtrSet<Operation *, 8> forwardRefOps;
+
+  /// The blocks of the regions being read, used to resolve successors.
+  std::vector<SmallVector<Block *, 4>> blockScopes;
+
+  /// The operations whose isolated regions have not been read yet, along with
+  /// the encoded regions.
+  DenseMap<Operation *, ArrayRef<uint8_t>> lazyOps;
+};
+} // end namespace mlir
+
+BytecodeReader::Impl::~Impl() {
+  // Drop the placeholders of forward references that were left unresolved by
+  // a failed read.
+  for (Operation *op : forwardRefOps) {
+    op->getResult(0).dropAllUses();
+    op->destroy();
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Dialect Reader
+
+/// This class implements the bytecode reader interface exposed to dialects,
+/// reading from a single attribute or type entry.
+class BytecodeReader::Impl::DialectReader : public DialectBytecodeReader {
+public:
+  DialectReader(BytecodeReader::Impl &state, EncodingReader &reader)
+      : state(state), reader(reader) {}
+
+  InFlightDiagnostic emitError(const Twine &msg) override {
+    return reader.emitError(msg);
+  }
+
+  MLIRContext *getContext() const override { return state.getContext(); }
+
+  //===--------------------------------------------------------------------===//
+  // IR
+
+  LogicalResult readAttribute(Attribute &result) override {
+    return state.parseAttribute(reader, result);
+  }
+  LogicalResult readOptionalAttribute(Attribute &result) override {
+    // Null attributes are encoded as zero, others as their index plus one.
+    uint64_t presentFlag;
+    if (failed(reader.parseVarInt(presentFlag)))
+      return failure();
+    if (!presentFlag) {
+      result = Attribute();
+      return success();
+    }
+    return state.parseAttribute(reader, result);
+  }
+  LogicalResult readType(Type &result) override {
+    return state.parseType(reader, result);
+  }
+
+  //===--------------------------------------------------------------------===//
+  // Primitives
+
+  LogicalResult readVarInt(uint64_t &result) override {
+    return reader.parseVarInt(result);
+  }
+
+  LogicalResult readSignedVarInt(int64_t &result) override {
+    return reader.parseSignedVarInt(result);
+  }
+
+  FailureOr<APInt> readAPIntWithKnownWidth(unsigned bitWidth) override {
+    // Small values are encoded using a single byte.
+    if (bitWidth <= 8) {
+      uint8_t value;
+      if (failed(reader.parseByte(value)))
+        return failure();
+      return APInt(bitWidth, value);
+    }
+
+    // Large values up to 64 bits are encoded using a single signed varint.
+    if (bitWidth <= 64) {
+      int64_t value;
+      if (failed(reader.parseSignedVarInt(value)))
+        return failure();
+      return APInt(bitWidth, static_cast<uint64_t>(value), /*isSigned=*/true);
+    }
+
+    // Otherwise, for really big values we encode the array of active words in
+    // the value.
+    uint64_t numActiveWords;
+    if (failed(reader.parseVarInt(numActiveWords)))
+      return failure();
+    if (numActiveWords > llvm::divideCeil(bitWidth, 64)) {
+      return reader.emitError("invalid APInt with ")
+             << numActiveWords << " words for a width of " << bitWidth;
+    }
+    SmallVector<uint64_t, 4> words(numActiveWords);
+    for (uint64_t &word : words)
+      if (failed(reader.parseVarInt(word)))
+        return failure();
+    return APInt(bitWidth, words);
+  }
+
+  FailureOr<APFloat>
+  readAPFloatWithKnownSemantics(const llvm::fltSemantics &semantics) override {
+    FailureOr<APInt> intVal =
+        readAPIntWithKnownWidth(APFloat::getSizeInBits(semantics));
+    if (failed(intVal))
+      return failure();
+    return APFloat(semantics, *intVal);
+  }
+
+  LogicalResult readString(StringRef &result) override {
+    return state.parseString(reader, result);
+  }
+
+  LogicalResult readBlob(ArrayRef<char> &result) override {
+    return state.parseBlob(reader, result);
+  }
+
+private:
+  BytecodeReader::Impl &state;
+  EncodingReader &reader;
+};
+
+//===----------------------------------------------------------------------===//
+// Sections
+
+LogicalResult BytecodeReader::Impl::read(Block *block) {
+  EncodingReader reader(
+      ArrayRef<uint8_t>(
+          reinterpret_cast<const uint8_t *>(buffer.getBufferStart()),
+          buffer.getBufferSize()),
+      fileLoc);
+
+  // Check the magic number and the version.
+  ArrayRef<uint8_t> magic;
+  if (!isBytecode(buffer) ||
+      failed(reader.parseBytes(sizeof(bytecode::kMagic), magic)))
+    return reader.emitError("input buffer is not an MLIR bytecode file");
+  uint64_t version;
+  if (failed(reader.parseVarInt(version)))
+    return failure();
+  if (version != bytecode::kVersion) {
+    return reader.emitError("bytecode version ")
+           << version << " is not supported, expected version "
+           << bytecode::kVersion;
+  }
+
+  // Collect the sections of the bytecode.
+  Optional<ArrayRef<uint8_t>> sectionDatas[bytecode::Section::kNumSections];
+  while (!reader.empty()) {
+    bytecode::Section::ID sectionID;
+    ArrayRef<uint8_t> sectionData;
+    if (failed(reader.parseSection(sectionID, sectionData)))
+      return failure();
+    if (sectionDatas[sectionID]) {
+      return reader.emitError("duplicate section with ID: ")
+             << unsigned(sectionID);
+    }
+    sectionDatas[sectionID] = sectionData;
+  }
+  for (unsigned i = 0; i < bytecode::Section::kNumSections; ++i) {
+    if (!sectionDatas[i] && i != bytecode::Section::kData)
+      return reader.emitError("missing data for section with ID: ") << i;
+  }
+
+  // Process the sections, the IR section is read last as it references all of
+  // the others.
+  if (failed(parseStringSection(*sectionDatas[bytecode::Section::kString])) ||
+      failed(parseDialectSection(*sectionDatas[bytecode::Section::kDialect])) ||
+      failed(
+          parseAttrTypeSection(*sectionDatas[bytecode::Section::kAttrType])))
+    return failure();
+  if (sectionDatas[bytecode::Section::kData] &&
+      failed(parseDataSection(*sectionDatas[bytecode::Section::kData])))
+    return failure();
+  return parseIRSection(*sectionDatas[bytecode::Section::kIR], block);
+}
+
+LogicalResult
+BytecodeReader::Impl::parseStringSection(ArrayRef<uint8_t> sectionData) {
+  EncodingReader reader(sectionData, fileLoc);
+  uint64_t numStrings;
+  if (failed(reader.parseVarInt(numStrings)))
+    return failure();
+  if (numStrings > reader.size())
+    return reader.emitError("invalid number of strings: ") << numStrings;
+
+  // The lengths of the strings are followed by their concatenated contents.
+  SmallVector<uint64_t, 32> lengths(numStrings);
+  for (uint64_t &length : lengths)
+    if (failed(reader.parseVarInt(length)))
+      return failure();
+  strings.reserve(numStrings);
+  for (uint64_t length : lengths) {
+    ArrayRef<uint8_t> str;
+    if (failed(reader.parseBytes(static_cast<size_t>(length), str)))
+      return failure();
+    strings.emplace_back(reinterpret_cast<const char *>(str.data()),
+                         str.size());
+  }
+  return success();
+}
+
+LogicalResult
+BytecodeReader::Impl::parseDialectSection(ArrayRef<uint8_t> sectionData) {
+  EncodingReader reader(sectionData, fileLoc);
+
+  // Load the referenced dialects, which registers their operations, attributes
+  // and types with the context. Dialects that are not available are only an
+  // error if something in the bytecode requires them.
+  uint64_t numDialects;
+  if (failed(reader.parseVarInt(numDialects)))
+    return failure();
+  for (uint64_t i = 0; i < numDialects; ++i) {
+    StringRef dialectNamespace;
+    if (failed(parseString(reader, dialectNamespace)))
+      return failure();
+    dialectNamespaces.push_back(dialectNamespace);
+    dialects.push_back(context->getOrLoadDialect(dialectNamespace));
+  }
+
+  uint64_t numOpNames;
+  if (failed(reader.parseVarInt(numOpNames)))
+    return failure();
+  for (uint64_t i = 0; i < numOpNames; ++i) {
+    StringRef opName;
+    if (failed(parseString(reader, opName)))
+      return failure();
+    opNames.emplace_back(opName, context);
+  }
+  return success();
+}
+
+LogicalResult
+BytecodeReader::Impl::parseAttrTypeSection(ArrayRef<uint8_t> sectionData) {
+  EncodingReader reader(sectionData, fileLoc);
+  uint64_t numEntries;
+  if (failed(reader.parseVarInt(numEntries)))
+    return failure();
+  if (numEntries > reader.size())
+    return reader.emitError("invalid number of attributes and types");
+
+  // Only record where each entry is, they are decoded when first used.
+  attrTypeEntries.resize(numEntries);
+  for (AttrTypeEntry &entry : attrTypeEntries) {
+    uint64_t size;
+    if (failed(reader.parseVarInt(entry.header)) ||
+        failed(reader.parseVarInt(size)) ||
+        failed(reader.parseBytes(static_cast<size_t>(size), entry.data)))
+      return failure();
+    if ((entry.header >> bytecode::kNumFlagBits) >= dialects.size())
+      return reader.emitError("invalid dialect for attribute or type entry");
+  }
+  return success();
+}
+
+LogicalResult
+BytecodeReader::Impl::parseDataSection(ArrayRef<uint8_t> sectionData) {
+  // Skip the padding that aligns the blobs relative to the start of the
+  // buffer.
+  const uint64_t alignment = DialectBytecodeReader::kBlobAlignment;
+  uint64_t offset = reinterpret_cast<const char *>(sectionData.data()) -
+                    buffer.getBufferStart();
+  uint64_t padding = llvm::alignTo(offset, alignment) - offset;
+  if (padding > sectionData.size())
+    return emitError(fileLoc, "invalid padding of the data section");
+  dataSection = sectionData.drop_front(padding);
+  return success();
+}
+
+//===----------------------------------------------------------------------===//
+// Tables
+
+LogicalResult BytecodeReader::Impl::parseString(EncodingReader &reader,
+                                                StringRef &result) {
+  uint64_t index;
+  if (failed(reader.parseVarInt(index)))
+    return failure();
+  if (index >= strings.size())
+    return reader.emitError("invalid string index: ") << index;
+  result = strings[index];
+  return success();
+}
+
+LogicalResult BytecodeReader::Impl::parseBlob(EncodingReader &reader,
+                                              ArrayRef<char> &result) {
+  uint64_t offset, size;
+  if (failed(reader.parseVarInt(offset)) || failed(reader.parseVarInt(size)))
+    return failure();
+  if (offset > dataSection.size() || size > dataSection.size() - offset)
+    return reader.emitError("invalid blob reference");
+  result = ArrayRef<char>(
+      reinterpret_cast<const char *>(dataSection.data()) + offset, size);
+  return success();
+}
+
+LogicalResult BytecodeReader::Impl::parseAttribute(EncodingReader &reader,
+                                                   Attribute &result) {
+  uint64_t index;
+  if (failed(reader.parseVarInt(index)) ||
+      failed(resolveEntry(reader, index, /*isType=*/false)))
+    return failure();
+  result = attrTypeEntries[index].attr;
+  return success();
+}
+
+LogicalResult BytecodeReader::Impl::parseType(EncodingReader &reader,
+                                              Type &result) {
+  uint64_t index;
+  if (failed(reader.parseVarInt(index)) ||
+      failed(resolveEntry(reader, index, /*isType=*/true)))
+    return failure();
+  result = attrTypeEntries[index].type;
+  return success();
+}
+
+LogicalResult BytecodeReader::Impl::resolveEntry(EncodingReader &reader,
+                                                 uint64_t index, bool isType) {
+  if (index >= attrTypeEntries.size())
+    return reader.emitError("invalid attribute or type index: ") << index;
+  AttrTypeEntry &entry = attrTypeEntries[index];
+  if (bool(entry.header & bytecode::kIsType) != isType) {
+    return reader.emitError("expected ")
+           << (isType ? "type" : "attribute") << " at index " << index;
+  }
+  if (isType ? bool(entry.type) : bool(entry.attr))
+    return success();
+
+  // Entries without a custom encoding hold their textual form.
+  if (!(entry.header & bytecode::kHasCustomEncoding)) {
+    StringRef text(reinterpret_cast<const char *>(entry.data.data()),
+                   entry.data.size());
+    if (isType)
+      entry.type = ::mlir::parseType(text, context);
+    else
+      entry.attr = ::mlir::parseAttribute(text, context);
+    if (isType ? !entry.type : !entry.attr)
+      return reader.emitError("failed to parse entry: ") << text;
+    return success();
+  }
+
+  // Otherwise, defer to the bytecode interface of the dialect.
+  uint64_t dialectIndex = entry.header >> bytecode::kNumFlagBits;
+  Dialect *dialect = dialects[dialectIndex];
+  if (!dialect) {
+    return reader.emitError("dialect '")
+           << dialectNamespaces[dialectIndex] << "' is unknown";
+  }
+  const auto *iface =
+      dialect->getRegisteredInterface<BytecodeDialectInterface>();
+  if (!iface) {
+    return reader.emitError("dialect '")
+           << dialect->getNamespace()
+           << "' does not implement the bytecode interface";
+  }
+
+  EncodingReader entryReader(entry.data, fileLoc);
+  DialectReader dialectReader(*this, entryReader);
+  if (isType)
+    entry.type = iface->readType(dialectReader);
+  else
+    entry.attr = iface->readAttribute(dialectReader);
+  if (isType ? !entry.type : !entry.attr)
+    return failure();
+  if (!entryReader.empty()) {
+    return reader.emitError("unexpected trailing bytes after ")
+           << (isType ? "type" : "attribute") << " at index " << index;
+  }
+  return success();
+}
+
+//===----------------------------------------------------------------------===//
+// Operations
+
+LogicalResult
+BytecodeReader::Impl::parseIRSection(ArrayRef<uint8_t> sectionData,
+                                     Block *block) {
+  EncodingReader reader(sectionData, fileLoc);
+  uint64_t numOps;
+  if (failed(pushValueScope(reader)) || failed(reader.parseVarInt(numOps)))
+    return failure();
+  for (uint64_t i = 0; i < numOps; ++i)
+    if (failed(parseOp(reader, block, /*isTopLevel=*/true)))
+      return failure();
+  if (failed(popValueScope(reader)))
+    return failure();
+  if (!reader.empty())
+    return reader.emitError("unexpected trailing bytes in the IR section");
+  return success();
+}
+
+LogicalResult BytecodeReader::Impl::parseOp(EncodingReader &reader,
+                                            Block *block, bool isTopLevel) {
+  uint64_t nameIndex;
+  if (failed(reader.parseVarInt(nameIndex)))
+    return failure();
+  if (nameIndex >= opNames.size())
+    return reader.emitError("invalid operation name index: ") << nameIndex;
+
+  uint8_t opMask;
+  LocationAttr loc;
+  if (failed(reader.parseByte(opMask)) || failed(parseAttribute(reader, loc)))
+    return failure();
+
+  DictionaryAttr attrs;
+  if ((opMask & bytecode::kHasAttrs) && failed(parseAttribute(reader, attrs)))
+    return failure();
+
+  SmallVector<Type, 4> resultTypes;
+  if (opMask & bytecode::kHasResults) {
+    uint64_t numResults;
+    if (failed(reader.parseVarInt(numResults)))
+      return failure();
+    resultTypes.resize(numResults);
+    for (Type &type : resultTypes)
+      if (failed(parseType(reader, type)))
+        return failure();
+  }
+
+  SmallVector<Value, 4> operands;
+  if (opMask & bytecode::kHasOperands) {
+    uint64_t numOperands;
+    if (failed(reader.parseVarInt(numOperands)))
+      return failure();
+    operands.resize(numOperands);
+    for (Value &operand : operands)
+      if (failed(parseOperand(reader, operand)))
+        return failure();
+  }
+
+  SmallVector<Block *, 2> successors;
+  if (opMask & bytecode::kHasSuccessors) {
+    uint64_t numSuccessors;
+    if (failed(reader.parseVarInt(numSuccessors)))
+      return failure();
+    for (uint64_t i = 0; i < numSuccessors; ++i) {
+      uint64_t blockIndex;
+      if (failed(reader.parseVarInt(blockIndex)))
+        return failure();
+      if (blockScopes.empty() || blockIndex >= blockScopes.back().size())
+        return reader.emitError("invalid successor index: ") << blockIndex;
+      successors.push_back(blockScopes.back()[blockIndex]);
+    }
+  }
+
+  uint64_t regionInfo = 0;
+  if ((opMask & bytecode::kHasRegions) &&
+      failed(reader.parseVarInt(regionInfo)))
+    return failure();
+  unsigned numRegions = regionInfo >> 1;
+
+  Operation *op =
+      Operation::create(loc, opNames[nameIndex], resultTypes, operands,
+                        MutableDictionaryAttr(attrs), successors, numRegions);
+  block->push_back(op);
+  for (Value result : op->getResults())
+    if (failed(defineValue(reader, result)))
+      return failure();
+  if (!numRegions)
+    return success();
+
+  // Regions that aren't isolated from above are part of the current scope.
+  if (!(regionInfo & bytecode::kIsIsolatedFromAbove))
+    return parseRegions(reader, op);
+
+  uint64_t regionSize;
+  ArrayRef<uint8_t> regionData;
+  if (failed(reader.parseVarInt(regionSize)) ||
+      failed(reader.parseBytes(static_cast<size_t>(regionSize), regionData)))
+    return failure();
+
+  // The regions of top-level operations are always read, so that lazy loading
+  // applies to the operations they contain, e.g. the functions of a module.
+  if (lazyLoad && !isTopLevel) {
+    lazyOps.try_emplace(op, regionData);
+    return success();
+  }
+  return parseIsolatedRegions(op, regionData);
+}
+
+LogicalResult BytecodeReader::Impl::parseIsolatedRegions(
+    Operation *op, ArrayRef<uint8_t> data) {
+  EncodingReader reader(data, fileLoc);
+  if (failed(pushValueScope(reader)) || failed(parseRegions(reader, op)) ||
+      failed(popValueScope(reader)))
+    return failure();
+  if (!reader.empty())
+    return reader.emitError("unexpected trailing bytes after regions");
+  return success();
+}
+
+LogicalResult BytecodeReader::Impl::parseRegions(EncodingReader &reader,
+                                                 Operation *op) {
+  for (Region &region : op->getRegions())
+    if (failed(parseRegion(reader, region)))
+      return failure();
+  return success();
+}
+
+LogicalResult BytecodeReader::Impl::parseRegion(EncodingReader &reader,
+                                                Region &region) {
+  uint64_t numBlocks;
+  if (failed(reader.parseVarInt(numBlocks)))
+    return failure();
+  if (numBlocks > reader.size())
+    return reader.emitError("invalid number of blocks: ") << numBlocks;
+  if (!numBlocks)
+    return success();
+
+  // Create all of the blocks upfront, so that successors may refer to blocks
+  // that haven't been read yet.
+  blockScopes.emplace_back();
+  SmallVectorImpl<Block *> &blocks = blockScopes.back();
+  for (uint64_t i = 0; i < numBlocks; ++i) {
+    blocks.push_back(new Block());
+    region.push_back(blocks.back());
+  }
+
+  for (Block *block : blocks) {
+    uint64_t numArgs;
+    if (failed(reader.parseVarInt(numArgs)))
+      return failure();
+    for (uint64_t i = 0; i < numArgs; ++i) {
+      Type argType;
+      if (failed(parseType(reader, argType)) ||
+          failed(defineValue(reader, block->addArgument(argType))))
+        return failure();
+    }
+
+    uint64_t numOps;
+    if (failed(reader.parseVarInt(numOps)))
+      return failure();
+    for (uint64_t i = 0; i < numOps; ++i)
+      if (failed(parseOp(reader, block, /*isTopLevel=*/false)))
+        return failure();
+  }
+  blockScopes.pop_back();
+  return success();
+}
+
+//===----------------------------------------------------------------------===//
+// Value Scopes
+
+LogicalResult BytecodeReader::Impl::pushValueScope(EncodingReader &reader) {
+  uint64_t numValues;
+  if (failed(reader.parseVarInt(numValues)))
+    return failure();
+  if (numValues > reader.size())
+    return reader.emitError("invalid number of values: ") << numValues;
+  valueScopes.emplace_back();
+  valueScopes.back().values.resize(numValues);
+  return success();
+}
+
+LogicalResult BytecodeReader::Impl::popValueScope(EncodingReader &reader) {
+  ValueScope &scope = valueScopes.back();
+  if (scope.nextValueID != scope.values.size()) {
+    return reader.emitError("expected ")
+           << scope.values.size() << " values to be defined, but found "
+           << scope.nextValueID;
+  }
+  valueScopes.pop_back();
+  return success();
+}
+
+LogicalResult BytecodeReader::Impl::parseOperand(EncodingReader &reader,
+                                                 Value &result) {
+  uint64_t valueIndex;
+  if (failed(reader.parseVarInt(valueIndex)))
+    return failure();
+  ValueScope &scope = valueScopes.back();
+  if (valueIndex >= scope.values.size())
+    return reader.emitError("invalid value index: ") << valueIndex;
+
+  Value &value = scope.values[valueIndex];
+  if (!value) {
+    // This is a forward reference, create a placeholder to use until the
+    // value is defined. The type of the placeholder doesn't matter, as it is
+    // replaced before the IR is used.
+    Operation *placeholder = Operation::create(
+        fileLoc, OperationName("placeholder", context),
+        NoneType::get(context), /*operands=*/{}, /*attributes=*/llvm::None,
+        /*successors=*/{}, /*numRegions=*/0);
+    forwardRefOps.insert(placeholder);
+    value = placeholder->getResult(0);
+  }
+  result = value;
+  return success();
+}
+
+LogicalResult BytecodeReader::Impl::defineValue(EncodingReader &reader,
+                                                Value value) {
+  ValueScope &scope = valueScopes.back();
+  if (scope.nextValueID >= scope.values.size())
+    return reader.emitError("more values defined than expected");
+
+  // Replace any forward reference to the value.
+  Value &entry = scope.values[scope.nextValueID++];
+  if (entry) {
+    Operation *placeholder = entry.getDefiningOp();
+    entry.replaceAllUsesWith(value);
+    forwardRefOps.erase(placeholder);
+    placeholder->destroy();
+  }
+  entry = value;
+  return success();
+}
+
+//===----------------------------------------------------------------------===//
+// Lazy Loading
+
+LogicalResult BytecodeReader::Impl::materialize(Operation *op) {
+  auto it = lazyOps.find(op);
+  assert(it != lazyOps.end() && "operation is not materializable");
+  ArrayRef<uint8_t> regionData = it->second;
+  lazyOps.erase(it);
+  return parseIsolatedRegions(op, regionData);
+}
+
+LogicalResult BytecodeReader::Impl::materializeAll() {
+  while (!lazyOps.empty())
+    if (failed(materialize(lazyOps.begin()->first)))
+      return failure();
+  return success();
+}
+
+//===----------------------------------------------------------------------===//
+// BytecodeReader
+//===----------------------------------------------------------------------===//
+
+BytecodeReader::BytecodeReader(llvm::MemoryBufferRef buffer,
+                               MLIRContext *context, bool lazyLoad)
+    : impl(std::make_unique<Impl>(buffer, context, lazyLoad)) {}
+
+BytecodeReader::~BytecodeReader() {}
+
+LogicalResult BytecodeReader::readTopLevel(Block *block,
+                                           LocationAttr *sourceFileLoc) {
+  if (sourceFileLoc)
+    *sourceFileLoc = impl->getFileLoc();
+
+  // Remember where the new operations start, so that only those are verified.
+  Operation *lastOp = block->empty() ? nullptr : &block->back();
+  if (failed(impl->read(block)))
+    return failure();
+  if (impl->isLazy())
+    return success();
+
+  Block::iterator it = lastOp ? std::next(lastOp->getIterator())
+                              : block->begin();
+  for (Operation &op : llvm::make_range(it, block->end()))
+    if (failed(verify(&op)))
+      return failure();
+  return success();
+}
+
+bool BytecodeReader::isMaterializable(Operation *op) {
+  return impl->isMaterializable(op);
+}
+
+LogicalResult BytecodeReader::materialize(Operation *op) {
+  return impl->materialize(op);
+}
+
+LogicalResult BytecodeReader::materializeAll() {
+  return impl->materializeAll();
+}
+
+LogicalResult mlir::readBytecodeFile(llvm::MemoryBufferRef buffer,
+                                     Block *block, MLIRContext *context,
+                                     LocationAttr *sourceFileLoc) {
+  return BytecodeReader(buffer, context).readTopLevel(block, sourceFileLoc);
+}
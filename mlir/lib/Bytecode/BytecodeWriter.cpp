@@ -0,0 +1,487 @@
+//===- BytecodeWriter.cpp - MLIR Bytecode Writer --------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "Encoding.h"
+#include "mlir/Bytecode/BytecodeImplementation.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Dialect.h"
+#include "mlir/IR/Location.h"
+#include "mlir/IR/Operation.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/LEB128.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace mlir;
+
+//===----------------------------------------------------------------------===//
+// EncodingEmitter
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// This class functions as the underlying encoding emitter for the bytecode
+/// writer.
+class EncodingEmitter {
+public:
+  /// Return the current size of the encoded buffer.
+  size_t size() const { return bytes.size(); }
+
+  /// Return the encoded contents of the buffer.
+  ArrayRef<uint8_t> getContents() const { return bytes; }
+
+  /// Emit a single byte.
+  void emitByte(uint8_t byte) { bytes.push_back(byte); }
+
+  /// Emit a range of bytes.
+  void emitBytes(ArrayRef<uint8_t> range) {
+    bytes.append(range.begin(), range.end());
+  }
+  void emitBytes(StringRef str) {
+    bytes.append(str.bytes_begin(), str.bytes_end());
+  }
+
+  /// Emit a variable width integer.
+  void emitVarInt(uint64_t value) {
+    uint8_t buffer[16];
+    unsigned size = llvm::encodeULEB128(value, buffer);
+    bytes.append(buffer, buffer + size);
+  }
+
+  /// Emit a signed variable width integer.
+  void emitSignedVarInt(int64_t value) {
+    uint8_t buffer[16];
+    unsigned size = llvm::encodeSLEB128(value, buffer);
+    bytes.append(buffer, buffer + size);
+  }
+
+  /// Emit a section with the given identifier and contents.
+  void emitSection(bytecode::Section::ID id, const EncodingEmitter &section) {
+    emitByte(id);
+    emitVarInt(section.size());
+    emitBytes(section.getContents());
+  }
+
+private:
+  /// The encoded bytes.
+  SmallVector<uint8_t, 0> bytes;
+};
+} // end anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// BytecodeWriter
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// This class manages the state of the bytecode being written: the tables of
+/// strings, dialects, attributes and types, and the blobs of data referenced
+/// from the IR.
+class BytecodeWriter {
+public:
+  BytecodeWriter(Operation *rootOp) : rootOp(rootOp) {}
+
+  /// Write the bytecode for the root operation to the given stream.
+  void write(raw_ostream &os);
+
+  //===--------------------------------------------------------------------===//
+  // Tables
+
+  /// Return the index of the given string within the string table.
+  uint64_t getStringID(StringRef str) {
+    auto it = stringIDs.try_emplace(str, strings.size());
+    if (it.second)
+      strings.push_back(it.first->getKey());
+    return it.first->second;
+  }
+
+  /// Return the index of the dialect with the given namespace within the
+  /// dialect table.
+  uint64_t getDialectID(StringRef dialectNamespace) {
+    auto it = dialectIDs.try_emplace(dialectNamespace, dialects.size());
+    if (it.second)
+      dialects.push_back(getStringID(dialectNamespace));
+    return it.first->second;
+  }
+
+  /// Return the index of the name of the given operation within the operation
+  /// name table.
+  uint64_t getOpNameID(Operation *op) {
+    StringRef name = op->getName().getStringRef();
+    auto it = opNameIDs.try_emplace(name, opNames.size());
+    if (it.second) {
+      // Record the dialect of the operation, so that it gets loaded before the
+      // operation is read. Unregistered operations use the prefix of their
+      // name.
+      Dialect *dialect = op->getDialect();
+      getDialectID(dialect ? dialect->getNamespace()
+                           : op->getName().getDialect());
+      opNames.push_back(getStringID(name));
+    }
+    return it.first->second;
+  }
+
+  /// Return the index of the given attribute or type within the attribute and
+  /// type table, encoding it if necessary.
+  uint64_t getAttrID(Attribute attr);
+  uint64_t getTypeID(Type type);
+
+  /// Add the given blob to the data section, returning its offset.
+  uint64_t addBlob(ArrayRef<char> blob) {
+    while (data.size() % DialectBytecodeReader::kBlobAlignment)
+      data.emitByte(0);
+    uint64_t offset = data.size();
+    data.emitBytes(ArrayRef<uint8_t>(
+        reinterpret_cast<const uint8_t *>(blob.data()), blob.size()));
+    return offset;
+  }
+
+private:
+  /// Encode an attribute or type, using the bytecode interface of its dialect
+  /// if possible, and its textual form otherwise.
+  template <typename T>
+  uint64_t getEntryID(T value, bool isType);
+
+  /// Write the IR section.
+  void writeOp(EncodingEmitter &emitter, Operation *op);
+  void writeRegion(EncodingEmitter &emitter, Region &region);
+
+  /// Assign numbers to the results of the given operation, starting at
+  /// `nextValueID`, and to the values and blocks defined within its regions.
+  void numberValues(Operation *op, uint64_t &nextValueID);
+
+  /// The root operation being written.
+  Operation *rootOp;
+
+  /// The strings referenced within the bytecode.
+  llvm::StringMap<uint64_t> stringIDs;
+  std::vector<StringRef> strings;
+
+  /// The string indices of the namespaces of the referenced dialects.
+  llvm::StringMap<uint64_t> dialectIDs;
+  std::vector<uint64_t> dialects;
+
+  /// The string indices of the names of the referenced operations.
+  llvm::StringMap<uint64_t> opNameIDs;
+  std::vector<uint64_t> opNames;
+
+  /// The attributes and types referenced within the bytecode, keyed by their
+  /// storage, along with their encoded entries.
+  struct AttrTypeEntry {
+    uint64_t header = 0;
+    EncodingEmitter contents;
+  };
+  DenseMap<const void *, uint64_t> attrTypeIDs;
+  std::vector<AttrTypeEntry> attrTypeEntries;
+
+  /// The numbering of values within their isolated scope, and of blocks
+  /// within their parent region.
+  DenseMap<Value, uint64_t> valueIDs;
+  DenseMap<Block *, uint64_t> blockIDs;
+
+  /// The number of values defined within the regions of each operation that
+  /// is isolated from above.
+  DenseMap<Operation *, uint64_t> isolatedNumValues;
+
+  /// The blobs of data referenced within the bytecode.
+  EncodingEmitter data;
+};
+
+/// This class implements the bytecode writer interface exposed to dialects,
+/// writing into a single attribute or type entry.
+class DialectWriter : public DialectBytecodeWriter {
+public:
+  DialectWriter(BytecodeWriter &state, EncodingEmitter &emitter)
+      : state(state), emitter(emitter) {}
+
+  void writeAttribute(Attribute attr) override {
+    emitter.emitVarInt(state.getAttrID(attr));
+  }
+  void writeOptionalAttribute(Attribute attr) override {
+    // Null attributes are encoded as zero, others as their index plus one.
+    emitter.emitVarInt(attr ? state.getAttrID(attr) + 1 : 0);
+  }
+  void writeType(Type type) override {
+    emitter.emitVarInt(state.getTypeID(type));
+  }
+
+  void writeVarInt(uint64_t value) override { emitter.emitVarInt(value); }
+  void writeSignedVarInt(int64_t value) override {
+    emitter.emitSignedVarInt(value);
+  }
+
+  void writeAPIntWithKnownWidth(const APInt &value) override {
+    unsigned bitWidth = value.getBitWidth();
+
+    // If the value is a single byte, just emit it directly without going
+    // through a varint.
+    if (bitWidth <= 8)
+      return emitter.emitByte(static_cast<uint8_t>(value.getZExtValue()));
+
+    // If the value fits within a single int64_t, emit it as a signed varint,
+    // which keeps small negative values small.
+    if (bitWidth <= 64)
+      return emitter.emitSignedVarInt(value.getSExtValue());
+
+    // Otherwise, emit the number of active words followed by each word.
+    unsigned numActiveWords = value.getActiveWords();
+    emitter.emitVarInt(numActiveWords);
+    const uint64_t *rawValueData = value.getRawData();
+    for (unsigned i = 0; i < numActiveWords; ++i)
+      emitter.emitVarInt(rawValueData[i]);
+  }
+
+  void writeAPFloatWithKnownSemantics(const APFloat &value) override {
+    writeAPIntWithKnownWidth(value.bitcastToAPInt());
+  }
+
+  void writeOwnedString(StringRef str) override {
+    emitter.emitVarInt(state.getStringID(str));
+  }
+
+  void writeOwnedBlob(ArrayRef<char> blob) override {
+    emitter.emitVarInt(state.addBlob(blob));
+    emitter.emitVarInt(blob.size());
+  }
+
+private:
+  BytecodeWriter &state;
+  EncodingEmitter &emitter;
+};
+} // end anonymous namespace
+
+static LogicalResult writeEntry(const BytecodeDialectInterface &iface,
+                                Attribute attr, DialectWriter &writer) {
+  return iface.writeAttribute(attr, writer);
+}
+static LogicalResult writeEntry(const BytecodeDialectInterface &iface,
+                                Type type, DialectWriter &writer) {
+  return iface.writeType(type, writer);
+}
+
+template <typename T>
+uint64_t BytecodeWriter::getEntryID(T value, bool isType) {
+  auto it = attrTypeIDs.find(value.getAsOpaquePointer());
+  if (it != attrTypeIDs.end())
+    return it->second;
+
+  // Encode the entry first, as this assigns indices to the attributes and
+  // types that it references.
+  EncodingEmitter contents;
+  Dialect &dialect = value.getDialect();
+  bool hasCustomEncoding = false;
+  if (const auto *iface =
+          dialect.getRegisteredInterface<BytecodeDialectInterface>()) {
+    DialectWriter dialectWriter(*this, contents);
+    hasCustomEncoding = succeeded(writeEntry(*iface, value, dialectWriter));
+  }
+  if (!hasCustomEncoding) {
+    contents = EncodingEmitter();
+    std::string text;
+    llvm::raw_string_ostream os(text);
+    value.print(os);
+    contents.emitBytes(os.str());
+  }
+
+  uint64_t id = attrTypeEntries.size();
+  attrTypeIDs[value.getAsOpaquePointer()] = id;
+  attrTypeEntries.emplace_back();
+  AttrTypeEntry &entry = attrTypeEntries.back();
+  entry.header = (getDialectID(dialect.getNamespace())
+                  << bytecode::kNumFlagBits) |
+                 (isType ? bytecode::kIsType : 0) |
+                 (hasCustomEncoding ? bytecode::kHasCustomEncoding : 0);
+  entry.contents = std::move(contents);
+  return id;
+}
+
+uint64_t BytecodeWriter::getAttrID(Attribute attr) {
+  // Opaque locations only have meaning within the process that created them,
+  // so they are written as their fallback location.
+  if (auto opaqueLoc = attr.dyn_cast<OpaqueLoc>())
+    attr = LocationAttr(opaqueLoc.getFallbackLocation());
+  return getEntryID(attr, /*isType=*/false);
+}
+
+uint64_t BytecodeWriter::getTypeID(Type type) {
+  return getEntryID(type, /*isType=*/true);
+}
+
+//===----------------------------------------------------------------------===//
+// Operations
+
+void BytecodeWriter::numberValues(Operation *op, uint64_t &nextValueID) {
+  for (Value result : op->getResults())
+    valueIDs[result] = nextValueID++;
+
+  // The regions of an operation that is isolated from above share a numbering
+  // of their own.
+  uint64_t isolatedValueID = 0;
+  uint64_t &regionValueID =
+      op->isKnownIsolatedFromAbove() ? isolatedValueID : nextValueID;
+  for (Region &region : op->getRegions()) {
+    for (auto &it : llvm::enumerate(region)) {
+      Block &block = it.value();
+      blockIDs[&block] = it.index();
+      for (BlockArgument arg : block.getArguments())
+        valueIDs[arg] = regionValueID++;
+      for (Operation &nestedOp : block)
+        numberValues(&nestedOp, regionValueID);
+    }
+  }
+  if (op->isKnownIsolatedFromAbove())
+    isolatedNumValues[op] = isolatedValueID;
+}
+
+void BytecodeWriter::writeOp(EncodingEmitter &emitter, Operation *op) {
+  emitter.emitVarInt(getOpNameID(op));
+
+  uint8_t opEncodingMask = 0;
+  if (!op->getAttrs().empty())
+    opEncodingMask |= bytecode::kHasAttrs;
+  if (op->getNumResults())
+    opEncodingMask |= bytecode::kHasResults;
+  if (op->getNumOperands())
+    opEncodingMask |= bytecode::kHasOperands;
+  if (op->getNumSuccessors())
+    opEncodingMask |= bytecode::kHasSuccessors;
+  if (op->getNumRegions())
+    opEncodingMask |= bytecode::kHasRegions;
+  emitter.emitByte(opEncodingMask);
+
+  emitter.emitVarInt(getAttrID(op->getLoc()));
+  if (opEncodingMask & bytecode::kHasAttrs)
+    emitter.emitVarInt(getAttrID(op->getAttrDictionary()));
+
+  if (opEncodingMask & bytecode::kHasResults) {
+    emitter.emitVarInt(op->getNumResults());
+    for (Type type : op->getResultTypes())
+      emitter.emitVarInt(getTypeID(type));
+  }
+  if (opEncodingMask & bytecode::kHasOperands) {
+    emitter.emitVarInt(op->getNumOperands());
+    for (Value operand : op->getOperands())
+      emitter.emitVarInt(valueIDs.lookup(operand));
+  }
+  if (opEncodingMask & bytecode::kHasSuccessors) {
+    emitter.emitVarInt(op->getNumSuccessors());
+    for (Block *successor : op->getSuccessors())
+      emitter.emitVarInt(blockIDs.lookup(successor));
+  }
+  if (!(opEncodingMask & bytecode::kHasRegions))
+    return;
+
+  bool isIsolatedFromAbove = op->isKnownIsolatedFromAbove();
+  emitter.emitVarInt((op->getNumRegions() << 1) |
+                     (isIsolatedFromAbove ? bytecode::kIsIsolatedFromAbove
+                                          : 0));
+  if (!isIsolatedFromAbove) {
+    for (Region &region : op->getRegions())
+      writeRegion(emitter, region);
+    return;
+  }
+
+  // Prefix isolated regions with their size, so that they may be skipped by
+  // readers that load them lazily.
+  EncodingEmitter regionEmitter;
+  regionEmitter.emitVarInt(isolatedNumValues.lookup(op));
+  for (Region &region : op->getRegions())
+    writeRegion(regionEmitter, region);
+  emitter.emitVarInt(regionEmitter.size());
+  emitter.emitBytes(regionEmitter.getContents());
+}
+
+void BytecodeWriter::writeRegion(EncodingEmitter &emitter, Region &region) {
+  emitter.emitVarInt(region.getBlocks().size());
+  for (Block &block : region) {
+    emitter.emitVarInt(block.getNumArguments());
+    for (BlockArgument arg : block.getArguments())
+      emitter.emitVarInt(getTypeID(arg.getType()));
+    emitter.emitVarInt(block.getOperations().size());
+    for (Operation &op : block)
+      writeOp(emitter, &op);
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Sections
+
+void BytecodeWriter::write(raw_ostream &os) {
+  // Write the IR first, as this populates all of the other tables.
+  EncodingEmitter irEmitter;
+  uint64_t nextValueID = 0;
+  numberValues(rootOp, nextValueID);
+  irEmitter.emitVarInt(nextValueID);
+  irEmitter.emitVarInt(/*numOps=*/1);
+  writeOp(irEmitter, rootOp);
+
+  // The attribute and type table.
+  EncodingEmitter attrTypeEmitter;
+  attrTypeEmitter.emitVarInt(attrTypeEntries.size());
+  for (const AttrTypeEntry &entry : attrTypeEntries) {
+    attrTypeEmitter.emitVarInt(entry.header);
+    attrTypeEmitter.emitVarInt(entry.contents.size());
+    attrTypeEmitter.emitBytes(entry.contents.getContents());
+  }
+
+  // The dialect and operation name table.
+  EncodingEmitter dialectEmitter;
+  dialectEmitter.emitVarInt(dialects.size());
+  for (uint64_t stringID : dialects)
+    dialectEmitter.emitVarInt(stringID);
+  dialectEmitter.emitVarInt(opNames.size());
+  for (uint64_t stringID : opNames)
+    dialectEmitter.emitVarInt(stringID);
+
+  // The string table.
+  EncodingEmitter stringEmitter;
+  stringEmitter.emitVarInt(strings.size());
+  for (StringRef str : strings)
+    stringEmitter.emitVarInt(str.size());
+  for (StringRef str : strings)
+    stringEmitter.emitBytes(str);
+
+  EncodingEmitter emitter;
+  emitter.emitBytes(StringRef(bytecode::kMagic, sizeof(bytecode::kMagic)));
+  emitter.emitVarInt(bytecode::kVersion);
+  emitter.emitSection(bytecode::Section::kString, stringEmitter);
+  emitter.emitSection(bytecode::Section::kDialect, dialectEmitter);
+  emitter.emitSection(bytecode::Section::kAttrType, attrTypeEmitter);
+  emitter.emitSection(bytecode::Section::kIR, irEmitter);
+
+  // The data section is padded so that blobs are aligned relative to the start
+  // of the bytecode. The padding depends on the width of the section length,
+  // which in turn depends on the padding.
+  if (data.size()) {
+    const uint64_t alignment = DialectBytecodeReader::kBlobAlignment;
+    uint64_t sectionStart = emitter.size() + /*id=*/1;
+    uint64_t padding = 0;
+    for (unsigned lengthWidth = 1;; ++lengthWidth) {
+      uint64_t dataStart = sectionStart + lengthWidth;
+      padding = llvm::alignTo(dataStart, alignment) - dataStart;
+      if (llvm::getULEB128Size(padding + data.size()) == lengthWidth)
+        break;
+    }
+    emitter.emitByte(bytecode::Section::kData);
+    emitter.emitVarInt(padding + data.size());
+    for (uint64_t i = 0; i < padding; ++i)
+      emitter.emitByte(0);
+    emitter.emitBytes(data.getContents());
+  }
+
+  ArrayRef<uint8_t> contents = emitter.getContents();
+  os.write(reinterpret_cast<const char *>(contents.data()), contents.size());
+}
+
+//===----------------------------------------------------------------------===//
+// Entry Points
+//===----------------------------------------------------------------------===//
+
+void mlir::writeBytecodeToFile(Operation *op, raw_ostream &os) {
+  BytecodeWriter(op).write(os);
+}
@@ -0,0 +1,134 @@
+//===- Encoding.h - MLIR binary format encoding information -----*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This header defines enum values describing the structure of MLIR bytecode
+// files.
+//
+// A bytecode file starts with the magic number "ML\xEFR" and a version,
+// followed by a sequence of sections:
+//
+//   bytecode ::= magic version:varint section*
+//   section  ::= id:byte length:varint data
+//
+// Integers are encoded as (S)LEB128 variable width integers.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef MLIR_LIB_BYTECODE_ENCODING_H
+#define MLIR_LIB_BYTECODE_ENCODING_H
+
+#include <cstdint>
+
+namespace mlir {
+namespace bytecode {
+//===----------------------------------------------------------------------===//
+// General constants
+//===----------------------------------------------------------------------===//
+
+enum {
+  /// The current bytecode version.
+  kVersion = 0,
+};
+
+/// The magic number that starts every bytecode file.
+static constexpr char kMagic[] = {'M', 'L', '\xEF', 'R'};
+
+//===----------------------------------------------------------------------===//
+// Sections
+//===----------------------------------------------------------------------===//
+
+namespace Section {
+enum ID : uint8_t {
+  /// This section contains the strings referenced within the bytecode:
+  ///
+  ///   strings ::= numStrings:varint length:varint[numStrings] data
+  ///
+  /// where `data` is the concatenation of all of the strings.
+  kString = 0,
+
+  /// This section contains the dialects and operation names referenced within
+  /// the bytecode:
+  ///
+  ///   dialects ::= numDialects:varint namespace:string[numDialects]
+  ///                numOpNames:varint opName:string[numOpNames]
+  kDialect = 1,
+
+  /// This section contains the attributes and types referenced within the
+  /// bytecode, which share a single index space:
+  ///
+  ///   attrTypes ::= numEntries:varint entry[numEntries]
+  ///   entry     ::= header:varint size:varint data
+  ///
+  /// The header packs the index of the dialect of the entry with the flags
+  /// below. Entries without a custom encoding hold their textual form.
+  kAttrType = 2,
+
+  /// This section contains the operations, see `OpEncodingMask`:
+  ///
+  ///   ir       ::= numValues:varint numOps:varint op[numOps]
+  ///   op       ::= name:varint mask:byte location:attr attrDict:attr?
+  ///                (numResults:varint type[numResults])?
+  ///                (numOperands:varint value[numOperands])?
+  ///                (numSuccessors:varint block[numSuccessors])?
+  ///                (regionInfo:varint (region* | isolated))?
+  ///   isolated ::= size:varint numValues:varint region*
+  ///   region   ::= numBlocks:varint block*
+  ///   block    ::= numArgs:varint type[numArgs] numOps:varint op[numOps]
+  ///
+  /// Values are numbered in definition order, and successors by their index
+  /// within the parent region. The regions of operations isolated from above
+  /// use a value numbering of their own, and are prefixed by their size so
+  /// that readers may skip over them and load them lazily. Each numbering
+  /// scope starts with the number of values it defines.
+  kIR = 3,
+
+  /// This section contains blobs of data, e.g. the contents of dense elements
+  /// attributes. The section is padded so that each blob is aligned, relative
+  /// to the start of the bytecode, to `DialectBytecodeReader::kBlobAlignment`.
+  /// Blobs are referenced by their offset from the first aligned byte of the
+  /// section and their size.
+  kData = 4,
+
+  /// The total number of section types.
+  kNumSections = 5,
+};
+} // namespace Section
+
+//===----------------------------------------------------------------------===//
+// Attributes and types
+//===----------------------------------------------------------------------===//
+
+enum AttrTypeEntryMask : uint8_t {
+  /// The entry is encoded by its dialect's BytecodeDialectInterface.
+  kHasCustomEncoding = 0b01,
+  /// The entry is a type rather than an attribute.
+  kIsType = 0b10,
+  /// The number of bits used by the flags, the dialect index is stored above.
+  kNumFlagBits = 2,
+};
+
+//===----------------------------------------------------------------------===//
+// Operations
+//===----------------------------------------------------------------------===//
+
+enum OpEncodingMask : uint8_t {
+  kHasAttrs = 0b00001,
+  kHasResults = 0b00010,
+  kHasOperands = 0b00100,
+  kHasSuccessors = 0b01000,
+  kHasRegions = 0b10000,
+};
+
+/// The low bit of the region info of an operation is set if the regions are
+/// isolated from above, the number of regions is stored above it.
+enum { kIsIsolatedFromAbove = 0b1 };
+
+} // namespace bytecode
+} // namespace mlir
+
+#endif // MLIR_LIB_BYTECODE_ENCODING_H
@@ -0,0 +1,328 @@
+//===- AutoTuning.cpp - Linalg codegen strategy auto-tuning ---------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the search for the fastest tiling, interchange and
+// vectorization configuration of Linalg ops.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Linalg/Transforms/AutoTuning.h"
+
+#include "mlir/Dialect/Linalg/Transforms/CodegenStrategy.h"
+#include "mlir/Dialect/Linalg/Utils/Utils.h"
+#include "mlir/Dialect/SCF/SCF.h"
+#include "mlir/Dialect/StandardOps/IR/Ops.h"
+#include "mlir/IR/BlockAndValueMapping.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Sequence.h"
+#include "llvm/Support/Debug.h"
+
+#include <algorithm>
+
+using namespace mlir;
+using namespace mlir::linalg;
+
+#define DEBUG_TYPE "linalg-autotuning"
+
+//===----------------------------------------------------------------------===//
+// TuningConfig
+//===----------------------------------------------------------------------===//
+
+void TuningConfig::print(raw_ostream &os) const {
+  os << "tile=";
+  llvm::interleave(tileSizes, os, ",");
+  os << " interchange=";
+  llvm::interleave(interchange, os, ",");
+  os << " vectorize=" << (vectorize ? 1 : 0);
+}
+
+/// Parse a comma separated list of integers into `values`.
+template <typename T>
+static LogicalResult parseIntegerList(StringRef str,
+                                      SmallVectorImpl<T> &values) {
+  if (str.empty())
+    return success();
+  SmallVector<StringRef, 4> elements;
+  str.split(elements, ',');
+  for (StringRef element : elements) {
+    T value;
+    if (element.getAsInteger(/*Radix=*/10, value))
+      return failure();
+    values.push_back(value);
+  }
+  return success();
+}
+
+Optional<TuningConfig> TuningConfig::parse(StringRef str) {
+  SmallVector<StringRef, 3> fields;
+  str.trim().split(fields, ' ', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+  if (fields.size() != 3 || !fields[0].consume_front("tile=") ||
+      !fields[1].consume_front("interchange=") ||
+      !fields[2].consume_front("vectorize="))
+    return llvm::None;
+
+  TuningConfig config;
+  if (failed(parseIntegerList(fields[0], config.tileSizes)) ||
+      failed(parseIntegerList(fields[1], config.interchange)))
+    return llvm::None;
+  if (fields[2] != "0" && fields[2] != "1")
+    return llvm::None;
+  config.vectorize = fields[2] == "1";
+  return config;
+}
+
+//===----------------------------------------------------------------------===//
+// Search space
+//===----------------------------------------------------------------------===//
+
+SmallVector<TuningConfig, 8>
+mlir::linalg::enumerateTuningConfigs(LinalgOp op,
+                                     const TuningSearchSpace &space) {
+  SmallVector<TuningConfig, 8> configs;
+  Optional<SmallVector<int64_t, 4>> loopRanges = getStaticLoopRanges(op);
+  if (!loopRanges ||
+      llvm::any_of(*loopRanges, [](int64_t range) { return range < 0; }))
+    return configs;
+  unsigned numLoops = loopRanges->size();
+
+  // Collect the candidate tile sizes of each loop, untiled first.
+  SmallVector<SmallVector<int64_t, 8>, 4> loopTileSizes(numLoops);
+  for (unsigned i = 0; i < numLoops; ++i) {
+    int64_t range = (*loopRanges)[i];
+    loopTileSizes[i].push_back(0);
+    for (int64_t size : space.tileSizes)
+      if (size > 0 && size < range && range % size == 0 &&
+          !llvm::is_contained(loopTileSizes[i], size))
+        loopTileSizes[i].push_back(size);
+  }
+
+  // Collect the candidate interchanges, identity first.
+  SmallVector<unsigned, 4> identity =
+      llvm::to_vector<4>(llvm::seq<unsigned>(0, numLoops));
+  SmallVector<SmallVector<unsigned, 4>, 8> permutations;
+  SmallVector<unsigned, 4> permutation = identity;
+  do {
+    permutations.push_back(permutation);
+  } while (numLoops <= space.maxInterchangeLoops &&
+           std::next_permutation(permutation.begin(), permutation.end()));
+
+  auto isFull = [&] {
+    return space.maxNumConfigs != 0 && configs.size() >= space.maxNumConfigs;
+  };
+
+  // Walk the combinations of tile sizes of the loops.
+  SmallVector<unsigned, 4> positions(numLoops, 0);
+  while (!isFull()) {
+    SmallVector<int64_t, 4> tileSizes;
+    int64_t tileVolume = 1;
+    for (unsigned i = 0; i < numLoops; ++i) {
+      tileSizes.push_back(loopTileSizes[i][positions[i]]);
+      tileVolume *= tileSizes.back() ? tileSizes.back() : (*loopRanges)[i];
+    }
+    bool isTiled =
+        llvm::any_of(tileSizes, [](int64_t size) { return size != 0; });
+    bool canVectorize = tileVolume <= space.maxVectorTileVolume;
+
+    // Interchanges that only differ in the position of untiled loops produce
+    // the same loop nest, only keep the first one of them.
+    SmallVector<SmallVector<unsigned, 4>, 8> tiledPermutations;
+    for (ArrayRef<unsigned> perm : permutations) {
+      if (isFull() || (!isTiled && perm != ArrayRef<unsigned>(identity)))
+        break;
+      SmallVector<unsigned, 4> tiledPermutation;
+      for (unsigned loop : perm)
+        if (tileSizes[loop] != 0)
+          tiledPermutation.push_back(loop);
+      if (llvm::is_contained(tiledPermutations, tiledPermutation))
+        continue;
+      tiledPermutations.push_back(tiledPermutation);
+
+      TuningConfig config;
+      if (isTiled) {
+        config.tileSizes = tileSizes;
+        if (perm != ArrayRef<unsigned>(identity))
+          config.interchange.assign(perm.begin(), perm.end());
+      }
+      configs.push_back(config);
+      if (canVectorize && !isFull()) {
+        config.vectorize = true;
+        configs.push_back(config);
+      }
+    }
+
+    // Advance to the next combination of tile sizes.
+    unsigned loop = 0;
+    for (; loop < numLoops; ++loop) {
+      if (++positions[loop] < loopTileSizes[loop].size())
+        break;
+      positions[loop] = 0;
+    }
+    if (loop == numLoops)
+      break;
+  }
+  return configs;
+}
+
+//===----------------------------------------------------------------------===//
+// Kernels
+//===----------------------------------------------------------------------===//
+
+std::string mlir::linalg::getTuningKey(LinalgOp op) {
+  std::string key;
+  llvm::raw_string_ostream os(key);
+  os << op->getName() << ' ' << op.iterator_types() << ' '
+     << op.indexing_maps() << " (";
+  llvm::interleaveComma(op->getOperandTypes(), os);
+  os << ')';
+  return os.str();
+}
+
+OwningModuleRef mlir::linalg::buildTuningKernel(LinalgOp op,
+                                                StringRef kernelName) {
+  if (!op.hasBufferSemantics())
+    return nullptr;
+  for (Type type : op->getOperandTypes()) {
+    auto memrefType = type.dyn_cast<MemRefType>();
+    if (!memrefType || !memrefType.hasStaticShape())
+      return nullptr;
+  }
+
+  Location loc = op.getLoc();
+  OpBuilder builder(op.getContext());
+  OwningModuleRef module = ModuleOp::create(loc);
+  FuncOp func = FuncOp::create(
+      loc, kernelName, builder.getFunctionType(op->getOperandTypes(), {}));
+  module->push_back(func);
+
+  Block *entryBlock = func.addEntryBlock();
+  builder.setInsertionPointToStart(entryBlock);
+  BlockAndValueMapping mapping;
+  mapping.map(op->getOperands(), entryBlock->getArguments());
+  Operation *kernelOp = builder.clone(*op, mapping);
+  kernelOp->removeAttr(LinalgTransforms::kLinalgTransformMarker);
+  builder.create<ReturnOp>(loc);
+  return module;
+}
+
+LogicalResult mlir::linalg::applyTuningConfig(FuncOp func, StringRef opName,
+                                              const TuningConfig &config) {
+  bool isTiled = llvm::any_of(config.tileSizes,
+                              [](int64_t size) { return size != 0; });
+  if (!isTiled && !config.vectorize)
+    return success();
+
+  CodegenStrategy strategy;
+  if (isTiled)
+    strategy.tile(opName, LinalgTilingOptions()
+                              .setTileSizes(config.tileSizes)
+                              .setInterchange(config.interchange));
+  if (config.vectorize)
+    strategy.vectorize(opName);
+  strategy.transform(func);
+
+  // The strategy leaves the ops it could not transform in place: vectorized
+  // ops are erased, and tiled ops are nested in the generated loops.
+  WalkResult result = func.walk([&](Operation *op) {
+    if (op->getName().getStringRef() != opName)
+      return WalkResult::advance();
+    if (config.vectorize || !op->getParentOfType<scf::ForOp>())
+      return WalkResult::interrupt();
+    return WalkResult::advance();
+  });
+  return failure(result.wasInterrupted());
+}
+
+//===----------------------------------------------------------------------===//
+// TuningCache
+//===----------------------------------------------------------------------===//
+
+const TuningConfig *TuningCache::lookup(StringRef key) const {
+  auto it = entries.find(key);
+  return it == entries.end() ? nullptr : &it->second;
+}
+
+void TuningCache::insert(StringRef key, const TuningConfig &config) {
+  entries[key] = config;
+}
+
+void TuningCache::print(raw_ostream &os) const {
+  SmallVector<StringRef, 8> keys;
+  for (const auto &entry : entries)
+    keys.push_back(entry.getKey());
+  llvm::sort(keys);
+  for (StringRef key : keys) {
+    os << key << '\t';
+    entries.find(key)->second.print(os);
+    os << '\n';
+  }
+}
+
+LogicalResult TuningCache::parse(StringRef text) {
+  SmallVector<StringRef, 8> lines;
+  text.split(lines, '\n', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+  for (StringRef line : lines) {
+    line = line.rtrim();
+    if (line.empty())
+      continue;
+    StringRef key, configStr;
+    std::tie(key, configStr) = line.split('\t');
+    Optional<TuningConfig> config = TuningConfig::parse(configStr);
+    if (key.empty() || !config)
+      return failure();
+    insert(key, *config);
+  }
+  return success();
+}
+
+//===----------------------------------------------------------------------===//
+// LinalgAutoTuner
+//===----------------------------------------------------------------------===//
+
+Optional<TuningConfig> LinalgAutoTuner::tune(LinalgOp op) {
+  std::string key = getTuningKey(op);
+  if (const TuningConfig *config = cache.lookup(key))
+    return *config;
+
+  OwningModuleRef kernel = buildTuningKernel(op, getKernelName());
+  if (!kernel)
+    return llvm::None;
+
+  StringRef opName = op->getName().getStringRef();
+  Optional<TuningConfig> bestConfig;
+  double bestTime = 0;
+  for (const TuningConfig &config : enumerateTuningConfigs(op, space)) {
+    OwningModuleRef candidate = kernel->clone();
+    auto func = candidate->lookupSymbol<FuncOp>(getKernelName());
+    if (failed(applyTuningConfig(func, opName, config))) {
+      LLVM_DEBUG({
+        llvm::dbgs() << "[" DEBUG_TYPE "] failed to apply: ";
+        config.print(llvm::dbgs());
+        llvm::dbgs() << "\n";
+      });
+      continue;
+    }
+
+    Optional<double> time = benchmark(*candidate, getKernelName());
+    LLVM_DEBUG({
+      llvm::dbgs() << "[" DEBUG_TYPE "] ";
+      config.print(llvm::dbgs());
+      if (time)
+        llvm::dbgs() << ": " << *time << "s\n";
+      else
+        llvm::dbgs() << ": failed to measure\n";
+    });
+    if (time && (!bestConfig || *time < bestTime)) {
+      bestConfig = config;
+      bestTime = *time;
+    }
+  }
+
+  if (bestConfig)
+    cache.insert(key, *bestConfig);
+  return bestConfig;
+}
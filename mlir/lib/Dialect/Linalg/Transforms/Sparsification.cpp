@@ -46,6 +46,7 @@
 #include "mlir/Dialect/Linalg/Utils/Utils.h"
 #include "mlir/Dialect/SCF/SCF.h"
 #include "mlir/Dialect/StandardOps/IR/Ops.h"
+#include "mlir/Dialect/Vector/VectorOps.h"
 
 using namespace mlir;
 
@@ -271,6 +272,14 @@ struct CodeGen {
   std::vector<std::vector<Value>> highs;
   std::vector<std::vector<Value>> pidxs;
   std::vector<std::vector<Value>> idxs;
+  // Vectorization information of the current innermost loop. The vector
+  // length is one outside vectorized loops. The mask disables the lanes
+  // past the upper bound of the loop, and the reduction value holds the
+  // vector accumulator of a vectorized reduction loop, if any.
+  unsigned curVecLength = 1;
+  unsigned curVecIdx = 0;
+  Value curVecMask;
+  Value redVal;
 };
 
 } // namespace
@@ -508,6 +517,54 @@ static void genBuffers(Merger &merger, CodeGen &codegen,
   }
 }
 
+/// Generates the vector type of the current vectorized loop for the given
+/// element type.
+static VectorType genVectorType(CodeGen &codegen, Type etp) {
+  return VectorType::get(codegen.curVecLength, etp);
+}
+
+/// Generates a broadcast of a loop invariant value into a vector within a
+/// vectorized loop, and returns the value unchanged otherwise.
+static Value genVectorInvariantValue(CodeGen &codegen,
+                                     PatternRewriter &rewriter, Value val) {
+  if (codegen.curVecLength == 1 || val.getType().isa<VectorType>())
+    return val;
+  VectorType vtp = genVectorType(codegen, val.getType());
+  return rewriter.create<vector::BroadcastOp>(val.getLoc(), vtp, val);
+}
+
+/// Generates a vectorized load on the innermost loop. A vector of indices,
+/// obtained from a sparse storage scheme, results in a masked gather on the
+/// 1-D buffer. Otherwise, the innermost index is the loop induction and the
+/// load is a contiguous read, with lanes out of bounds of the buffer masked.
+static Value genVectorLoad(CodeGen &codegen, PatternRewriter &rewriter,
+                           Value ptr, ArrayRef<Value> args) {
+  Location loc = ptr.getLoc();
+  VectorType vtp = genVectorType(
+      codegen, ptr.getType().cast<MemRefType>().getElementType());
+  if (args.back().getType().isa<VectorType>()) {
+    assert(args.size() == 1 && "gather on a 1-D buffer");
+    Value pass = rewriter.create<ConstantOp>(loc, rewriter.getZeroAttr(vtp));
+    return rewriter.create<vector::GatherOp>(loc, vtp, ptr, args.back(),
+                                             codegen.curVecMask, pass);
+  }
+  return rewriter.create<vector::TransferReadOp>(loc, vtp, ptr, args);
+}
+
+/// Generates a vectorized store on the innermost loop, either as a masked
+/// scatter through a vector of indices or as a contiguous write.
+static void genVectorStore(CodeGen &codegen, PatternRewriter &rewriter,
+                           Value rhs, Value ptr, ArrayRef<Value> args) {
+  Location loc = ptr.getLoc();
+  if (args.back().getType().isa<VectorType>()) {
+    assert(args.size() == 1 && "scatter on a 1-D buffer");
+    rewriter.create<vector::ScatterOp>(loc, ptr, args.back(),
+                                       codegen.curVecMask, rhs);
+    return;
+  }
+  rewriter.create<vector::TransferWriteOp>(loc, rhs, ptr, args);
+}
+
 /// Generates a load on a dense or sparse tensor.
 static Value genTensorLoad(Merger &merger, CodeGen &codegen,
                            PatternRewriter &rewriter, linalg::GenericOp op,
@@ -516,13 +573,14 @@ static Value genTensorLoad(Merger &merger, CodeGen &codegen,
   Value val = merger.exp(exp).val;
   if (val) {
     merger.exp(exp).val = Value(); // reset
-    return val;
+    return genVectorInvariantValue(codegen, rewriter, val);
   }
   // Actual load.
   SmallVector<Value, 4> args;
   unsigned tensor = merger.exp(exp).e0;
   auto map = op.getIndexingMap(tensor);
   bool sparse = false;
+  bool vector = false;
   for (unsigned i = 0, m = map.getNumResults(); i < m; ++i) {
     unsigned idx = map.getDimPosition(i);
     args.push_back(codegen.loops[idx]); // universal dense index
@@ -531,10 +589,14 @@ static Value genTensorLoad(Merger &merger, CodeGen &codegen,
       args.clear();
       args.push_back(codegen.pidxs[tensor][idx]); // position index
     }
+    vector |= codegen.curVecLength > 1 && idx == codegen.curVecIdx;
   }
   Location loc = op.getLoc();
   Value ptr = codegen.buffers[tensor];
-  return rewriter.create<LoadOp>(loc, ptr, args);
+  if (vector)
+    return genVectorLoad(codegen, rewriter, ptr, args);
+  Value load = rewriter.create<LoadOp>(loc, ptr, args);
+  return genVectorInvariantValue(codegen, rewriter, load);
 }
 
 /// Generates a store on a dense tensor.
@@ -549,7 +611,10 @@ static void genTensorStore(Merger &merger, CodeGen &codegen,
   }
   Location loc = op.getLoc();
   Value ptr = codegen.buffers[tensor];
-  rewriter.create<StoreOp>(loc, rhs, ptr, args);
+  if (rhs.getType().isa<VectorType>())
+    genVectorStore(codegen, rewriter, rhs, ptr, args);
+  else
+    rewriter.create<StoreOp>(loc, rhs, ptr, args);
 }
 
 /// Generates a pointer/index load from the sparse storage scheme.
@@ -564,7 +629,7 @@ static Value genLoad(PatternRewriter &rewriter, Location loc, Value ptr,
 /// Generates an invariant value.
 static Value genInvariantValue(Merger &merger, CodeGen &codegen,
                                PatternRewriter &rewriter, unsigned exp) {
-  return merger.exp(exp).val;
+  return genVectorInvariantValue(codegen, rewriter, merger.exp(exp).val);
 }
 
 /// Recursively generates tensor expression.
@@ -659,11 +724,121 @@ static bool genInit(Merger &merger, CodeGen &codegen, PatternRewriter &rewriter,
   return needsUniv;
 }
 
+/// Returns the operand of the tensor expression that is added to the output
+/// tensor in the form `lhs = lhs + rest`, if any.
+static Optional<unsigned> matchReduction(Merger &merger, linalg::GenericOp op,
+                                         unsigned exp) {
+  Kind kind = merger.exp(exp).kind;
+  if (kind != Kind::kAddF && kind != Kind::kAddI)
+    return llvm::None;
+  unsigned lhs = op.getNumInputsAndOutputs() - 1;
+  auto isLhs = [&](unsigned e) {
+    return merger.exp(e).kind == Kind::kTensor && merger.exp(e).e0 == lhs;
+  };
+  if (isLhs(merger.exp(exp).e0))
+    return merger.exp(exp).e1;
+  if (isLhs(merger.exp(exp).e1))
+    return merger.exp(exp).e0;
+  return llvm::None;
+}
+
+/// Returns true if the access of the tensor within the innermost loop on
+/// `idx` can be vectorized: loop invariant accesses are broadcast, sparse
+/// values are read contiguously at the loop position, and dense accesses
+/// are either contiguous in a dense loop or gathered through the sparse
+/// indices of a sparse loop.
+static bool isVectorizableAccess(Merger &merger, linalg::GenericOp op,
+                                 unsigned idx, bool isSparse,
+                                 unsigned tensor) {
+  auto map = op.getIndexingMap(tensor);
+  unsigned rank = map.getNumResults();
+  bool hasSparse = false;
+  Optional<unsigned> pos;
+  for (unsigned d = 0; d < rank; d++) {
+    unsigned i = map.getDimPosition(d);
+    hasSparse |= merger.isSparseAccess(tensor, i);
+    if (i == idx)
+      pos = d;
+  }
+  if (!pos) {
+    // An invariant read of the output tensor would miss the updates of
+    // the vectorized reduction.
+    return tensor != op.getNumInputsAndOutputs() - 1;
+  }
+  if (merger.isSparseAccess(tensor, idx))
+    return isSparse;
+  if (hasSparse)
+    return false;
+  return isSparse ? rank == 1 : *pos == rank - 1;
+}
+
+/// Returns true if all tensor accesses of the expression can be vectorized
+/// within the innermost loop on `idx`.
+static bool isVectorizableExp(Merger &merger, linalg::GenericOp op,
+                              unsigned idx, bool isSparse, unsigned exp) {
+  switch (merger.exp(exp).kind) {
+  case Kind::kTensor:
+    return isVectorizableAccess(merger, op, idx, isSparse, merger.exp(exp).e0);
+  case Kind::kInvariant:
+    return true;
+  default:
+    return isVectorizableExp(merger, op, idx, isSparse, merger.exp(exp).e0) &&
+           isVectorizableExp(merger, op, idx, isSparse, merger.exp(exp).e1);
+  }
+}
+
+/// Returns true if the innermost for-loop on `idx` that evaluates the given
+/// tensor expression can be vectorized. Loops that update the output tensor
+/// at every iteration are vectorized with vector stores, while loops over a
+/// reduction index require the expression to have the form `lhs = lhs +
+/// rest`, and accumulate `rest` into a vector that is reduced after the loop.
+static bool isVectorizable(Merger &merger, CodeGen &codegen,
+                           linalg::GenericOp op, unsigned idx, bool isSparse,
+                           bool needsUniv, unsigned exp) {
+  // Sparse loops gather through a vector of sparse indices, which requires
+  // an integral index type, and must not maintain the universal index.
+  if (isSparse && (needsUniv || codegen.options.indType ==
+                                    linalg::SparseIntType::kNative))
+    return false;
+  unsigned lhs = op.getNumInputsAndOutputs() - 1;
+  Type etp = op.getShapedType(lhs).getElementType();
+  if (!etp.isIntOrFloat())
+    return false;
+  auto map = op.getIndexingMap(lhs);
+  for (unsigned d = 0, rank = map.getNumResults(); d < rank; d++)
+    if (map.getDimPosition(d) == idx)
+      return isVectorizableAccess(merger, op, idx, isSparse, lhs) &&
+             isVectorizableExp(merger, op, idx, isSparse, exp);
+  auto iteratorTypes = op.iterator_types().getValue();
+  Optional<unsigned> rest = matchReduction(merger, op, exp);
+  return linalg::isReductionIteratorType(iteratorTypes[idx]) && rest &&
+         isVectorizableExp(merger, op, idx, isSparse, *rest);
+}
+
+/// Generates the mask of the current iteration of a vectorized loop, which
+/// disables the lanes at or past the upper bound of the loop.
+static Value genVectorMask(CodeGen &codegen, PatternRewriter &rewriter,
+                           Value iv, Value lo, Value hi) {
+  Location loc = iv.getLoc();
+  VectorType mtp = genVectorType(codegen, rewriter.getIntegerType(1));
+  // Special case if the vector length evenly divides the trip count, which
+  // results in an unconditionally all-true mask.
+  auto loOp = lo.getDefiningOp<ConstantIndexOp>();
+  auto hiOp = hi.getDefiningOp<ConstantIndexOp>();
+  if (loOp && hiOp &&
+      (hiOp.getValue() - loOp.getValue()) % codegen.curVecLength == 0)
+    return rewriter.create<ConstantOp>(loc, mtp,
+                                       DenseElementsAttr::get(mtp, true));
+  Value end = rewriter.create<SubIOp>(loc, hi, iv);
+  return rewriter.create<vector::CreateMaskOp>(loc, mtp, end);
+}
+
 /// Generates a for-loop on a single index.
 static Operation *genFor(Merger &merger, CodeGen &codegen,
                          PatternRewriter &rewriter, linalg::GenericOp op,
                          bool isOuter, bool isInner, unsigned idx,
-                         llvm::BitVector &indices) {
+                         bool needsUniv, llvm::BitVector &indices,
+                         unsigned exp) {
   unsigned fb = indices.find_first();
   unsigned tensor = merger.tensor(fb);
   assert(idx == merger.index(fb));
@@ -691,12 +866,30 @@ static Operation *genFor(Merger &merger, CodeGen &codegen,
     break;
   }
 
+  // Vectorization strategy. Only the innermost loop is a candidate, and it
+  // is actually vectorized if all its tensor accesses can be vectorized. A
+  // vectorized loop is never converted into a parallel operation.
+  bool isVector = isInner && codegen.options.vectorLength > 1;
+  switch (codegen.options.vectorizationStrategy) {
+  case linalg::SparseVectorizationStrategy::kNone:
+    isVector = false;
+    break;
+  case linalg::SparseVectorizationStrategy::kDenseInnerLoop:
+    isVector &= !isSparse;
+    break;
+  case linalg::SparseVectorizationStrategy::kAnyStorageInnerLoop:
+    break;
+  }
+  isVector = isVector && isVectorizable(merger, codegen, op, idx, isSparse,
+                                        needsUniv, exp);
+  isParallel &= !isVector;
+
   // Loop bounds and increment.
   Location loc = op.getLoc();
   Value lo;
   Value hi;
-  Value step = rewriter.create<ConstantIndexOp>(loc, 1);
-  Value index;
+  Value step = rewriter.create<ConstantIndexOp>(
+      loc, isVector ? codegen.options.vectorLength : 1);
   if (isSparse) {
     lo = codegen.pidxs[tensor][idx];
     hi = codegen.highs[tensor][idx];
@@ -716,13 +909,32 @@ static Operation *genFor(Merger &merger, CodeGen &codegen,
     return parOp;
   }
 
-  // Emit a sequential loop.
-  scf::ForOp forOp = rewriter.create<scf::ForOp>(loc, lo, hi, step);
+  // Emit a sequential loop, which carries a vector accumulator if it is a
+  // vectorized reduction.
+  scf::ForOp forOp;
+  if (isVector) {
+    codegen.curVecLength = codegen.options.vectorLength;
+    codegen.curVecIdx = idx;
+  }
+  if (isVector && matchReduction(merger, op, exp) &&
+      linalg::isReductionIteratorType(iteratorTypes[idx])) {
+    unsigned lhs = op.getNumInputsAndOutputs() - 1;
+    VectorType vtp =
+        genVectorType(codegen, op.getShapedType(lhs).getElementType());
+    Value init = rewriter.create<ConstantOp>(loc, rewriter.getZeroAttr(vtp));
+    forOp = rewriter.create<scf::ForOp>(loc, lo, hi, step, init);
+    codegen.redVal = forOp.getRegionIterArgs().front();
+  } else {
+    forOp = rewriter.create<scf::ForOp>(loc, lo, hi, step);
+  }
+  Value iv = forOp.getInductionVar();
   if (isSparse)
-    codegen.pidxs[tensor][idx] = forOp.getInductionVar();
+    codegen.pidxs[tensor][idx] = iv;
   else
-    codegen.loops[idx] = forOp.getInductionVar();
+    codegen.loops[idx] = iv;
   rewriter.setInsertionPointToStart(forOp.getBody());
+  if (isVector)
+    codegen.curVecMask = genVectorMask(codegen, rewriter, iv, lo, hi);
   return forOp;
 }
 
@@ -781,13 +993,14 @@ static Operation *genWhile(Merger &merger, CodeGen &codegen,
 static Operation *genLoop(Merger &merger, CodeGen &codegen,
                           PatternRewriter &rewriter, linalg::GenericOp op,
                           std::vector<unsigned> &topSort, unsigned at,
-                          bool needsUniv, llvm::BitVector &indices) {
+                          bool needsUniv, llvm::BitVector &indices,
+                          unsigned exp) {
   unsigned idx = topSort[at];
   if (indices.count() == 1) {
     bool isOuter = at == 0;
     bool isInner = at == topSort.size() - 1;
     return genFor(merger, codegen, rewriter, op, isOuter, isInner, idx,
-                  indices);
+                  needsUniv, indices, exp);
   }
   return genWhile(merger, codegen, rewriter, op, idx, needsUniv, indices);
 }
@@ -809,7 +1022,9 @@ static void genLocals(Merger &merger, CodeGen &codegen,
       assert(idx == merger.index(b));
       Value ptr = codegen.indices[tensor][idx];
       Value s = codegen.pidxs[tensor][idx];
-      Value load = genLoad(rewriter, loc, ptr, s);
+      Value load = codegen.curVecLength > 1
+                       ? genVectorLoad(codegen, rewriter, ptr, s)
+                       : genLoad(rewriter, loc, ptr, s);
       codegen.idxs[tensor][idx] = load;
       if (!needsUniv) {
         if (min) {
@@ -829,7 +1044,10 @@ static void genLocals(Merger &merger, CodeGen &codegen,
     codegen.loops[idx] = min;
   }
 
-  // Initialize dense positions.
+  // Initialize dense positions. These are not needed within a vectorized
+  // loop, which is always innermost.
+  if (codegen.curVecLength > 1)
+    return;
   for (unsigned b = 0, be = locals.size(); b < be; b++) {
     if (locals[b] && !merger.isSparseBit(b)) {
       unsigned tensor = merger.tensor(b);
@@ -922,6 +1140,47 @@ static void optimizeIndices(Merger merger, unsigned lsize,
   }
 }
 
+/// Generates a floating-point or integer addition, depending on the element
+/// type of the operands.
+static Value genAdd(PatternRewriter &rewriter, Location loc, Value v0,
+                    Value v1) {
+  if (getElementTypeOrSelf(v0).isa<FloatType>())
+    return rewriter.create<AddFOp>(loc, v0, v1);
+  return rewriter.create<AddIOp>(loc, v0, v1);
+}
+
+/// Generates the wrap-up of a for-loop and restores the insertion point
+/// after the loop. A vectorized reduction loop yields its vector accumulator,
+/// which is reduced into the output tensor after the loop.
+static void genForEnd(Merger &merger, CodeGen &codegen,
+                      PatternRewriter &rewriter, linalg::GenericOp op,
+                      Operation *loop) {
+  Value red = codegen.redVal;
+  codegen.curVecLength = 1;
+  codegen.curVecMask = Value();
+  codegen.redVal = Value();
+  if (!red) {
+    rewriter.setInsertionPointAfter(loop);
+    return;
+  }
+  Location loc = op.getLoc();
+  scf::ForOp forOp = cast<scf::ForOp>(loop);
+  rewriter.create<scf::YieldOp>(loc, red);
+  rewriter.setInsertionPointAfter(forOp);
+  SmallVector<Value, 4> args;
+  unsigned lhs = op.getNumInputsAndOutputs() - 1;
+  auto map = op.getIndexingMap(lhs);
+  for (unsigned i = 0, m = map.getNumResults(); i < m; ++i)
+    args.push_back(codegen.loops[map.getDimPosition(i)]);
+  Value ptr = codegen.buffers[lhs];
+  Value vec = forOp.getResult(0);
+  Type etp = vec.getType().cast<VectorType>().getElementType();
+  Value sum = rewriter.create<vector::ReductionOp>(
+      loc, etp, rewriter.getStringAttr("add"), vec, ValueRange());
+  Value load = rewriter.create<LoadOp>(loc, ptr, args);
+  rewriter.create<StoreOp>(loc, genAdd(rewriter, loc, load, sum), ptr, args);
+}
+
 /// Recursively generates code while computing iteration lattices in order
 /// to manage the complexity of implementing co-iteration over unions
 /// and intersections of sparse iterations spaces.
@@ -929,7 +1188,20 @@ static void genStmt(Merger &merger, CodeGen &codegen, PatternRewriter &rewriter,
                     linalg::GenericOp op, std::vector<unsigned> &topSort,
                     unsigned exp, unsigned at) {
   // At each leaf, assign remaining tensor (sub)expression to output tensor.
+  // Within a vectorized reduction, accumulate the remaining expression into
+  // the vector accumulator instead, with inactive lanes masked to zero.
   if (at == topSort.size()) {
+    if (codegen.redVal) {
+      Optional<unsigned> rest = matchReduction(merger, op, exp);
+      assert(rest && "vectorized reduction");
+      Location loc = op.getLoc();
+      Value rhs = genExp(merger, codegen, rewriter, op, *rest);
+      Value zero =
+          rewriter.create<ConstantOp>(loc, rewriter.getZeroAttr(rhs.getType()));
+      rhs = rewriter.create<SelectOp>(loc, codegen.curVecMask, rhs, zero);
+      codegen.redVal = genAdd(rewriter, loc, codegen.redVal, rhs);
+      return;
+    }
     unsigned lhs = op.getNumInputsAndOutputs() - 1;
     Value rhs = genExp(merger, codegen, rewriter, op, exp);
     genTensorStore(merger, codegen, rewriter, op, lhs, rhs);
@@ -958,8 +1230,8 @@ static void genStmt(Merger &merger, CodeGen &codegen, PatternRewriter &rewriter,
     // Emit loop.
     llvm::BitVector indices = lati.bits;
     optimizeIndices(merger, lsize, indices);
-    Operation *loop =
-        genLoop(merger, codegen, rewriter, op, topSort, at, needsUniv, indices);
+    Operation *loop = genLoop(merger, codegen, rewriter, op, topSort, at,
+                              needsUniv, indices, lati.exp);
     genLocals(merger, codegen, rewriter, op, topSort, at, needsUniv, lati.bits);
 
     // Visit all lattices points with Li >= Lj to generate the
@@ -986,10 +1258,11 @@ static void genStmt(Merger &merger, CodeGen &codegen, PatternRewriter &rewriter,
       rewriter.setInsertionPointToEnd(&whileOp.after().front());
       genWhileInduction(merger, codegen, rewriter, op, idx, needsUniv,
                         lati.bits, whileOp.results());
+      rewriter.setInsertionPointAfter(loop);
     } else {
       needsUniv = false;
+      genForEnd(merger, codegen, rewriter, op, loop);
     }
-    rewriter.setInsertionPointAfter(loop);
   }
   codegen.loops[idx] = Value();
 }
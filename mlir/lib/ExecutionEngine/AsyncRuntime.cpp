@@ -15,15 +15,26 @@
 
 #ifdef MLIR_ASYNCRUNTIME_DEFINE_FUNCTIONS
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <chrono>
 #include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <functional>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <vector>
 
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 //===----------------------------------------------------------------------===//
 // Async runtime API.
 //===----------------------------------------------------------------------===//
@@ -33,16 +44,98 @@ namespace {
 // Forward declare class defined below.
 class RefCounted;
 
+// -------------------------------------------------------------------------- //
+// A queue of tasks owned by a single worker thread. The owner pushes and pops
+// tasks at the back, so that it keeps working on the most recently spawned
+// tasks whose data is likely still in cache, while other workers steal the
+// oldest tasks from the front.
+// -------------------------------------------------------------------------- //
+
+class WorkQueue {
+public:
+  using Task = std::function<void()>;
+
+  void push(Task task) {
+    std::lock_guard<std::mutex> lock(mu);
+    tasks.push_back(std::move(task));
+  }
+
+  bool pop(Task &task) {
+    std::lock_guard<std::mutex> lock(mu);
+    if (tasks.empty())
+      return false;
+    task = std::move(tasks.back());
+    tasks.pop_back();
+    return true;
+  }
+
+  bool steal(Task &task) {
+    std::lock_guard<std::mutex> lock(mu);
+    if (tasks.empty())
+      return false;
+    task = std::move(tasks.front());
+    tasks.pop_front();
+    return true;
+  }
+
+private:
+  std::mutex mu;
+  std::deque<Task> tasks;
+};
+
 // -------------------------------------------------------------------------- //
 // AsyncRuntime orchestrates all async operations and Async runtime API is built
 // on top of the default runtime instance.
+//
+// Tasks are executed by a pool of worker threads with a work stealing
+// scheduler: each worker has its own queue, and idle workers steal from the
+// queues of the others. Blocking awaits on a worker thread do not block the
+// worker, they run other pending tasks until the awaited value is ready, so
+// that nested async regions can't starve the pool.
+//
+// The pool is configured with environment variables:
+//   MLIR_ASYNC_RUNTIME_NUM_WORKERS: the number of worker threads, defaults to
+//     the number of hardware threads.
+//   MLIR_ASYNC_RUNTIME_AFFINITY: `none` (default) to let the OS schedule the
+//     workers, or `compact` to pin worker `i` to CPU `i` (Linux only).
 // -------------------------------------------------------------------------- //
 
 class AsyncRuntime {
 public:
-  AsyncRuntime() : numRefCountedObjects(0) {}
+  using Task = WorkQueue::Task;
+
+  AsyncRuntime() : numRefCountedObjects(0) {
+    unsigned numWorkers = std::thread::hardware_concurrency();
+    if (const char *env = std::getenv("MLIR_ASYNC_RUNTIME_NUM_WORKERS"))
+      numWorkers = std::strtoul(env, nullptr, 10);
+    numWorkers = std::max(numWorkers, 1u);
+
+    bool pinWorkers = false;
+    if (const char *env = std::getenv("MLIR_ASYNC_RUNTIME_AFFINITY"))
+      pinWorkers = std::strcmp(env, "compact") == 0;
+
+    queues.reserve(numWorkers);
+    for (unsigned i = 0; i < numWorkers; ++i)
+      queues.push_back(std::make_unique<WorkQueue>());
+    workers.reserve(numWorkers);
+    for (unsigned i = 0; i < numWorkers; ++i)
+      workers.emplace_back([this, i, pinWorkers] {
+        if (pinWorkers)
+          pinCurrentThread(i);
+        runWorker(i);
+      });
+  }
 
   ~AsyncRuntime() {
+    // Workers exit once all of the pending tasks have been executed.
+    {
+      std::lock_guard<std::mutex> lock(sleepMu);
+      stopping = true;
+    }
+    sleepCv.notify_all();
+    for (std::thread &worker : workers)
+      worker.join();
+
     assert(getNumRefCountedObjects() == 0 &&
            "all ref counted objects must be destroyed");
   }
@@ -51,9 +144,102 @@ public:
     return numRefCountedObjects.load(std::memory_order_relaxed);
   }
 
+  // Schedules the task for execution on the worker pool. Tasks spawned by a
+  // worker go to the queue of that worker, other tasks are distributed over
+  // the queues in a round robin fashion.
+  void execute(Task task) {
+    unsigned queue = isWorkerThread()
+                         ? currentWorker
+                         : nextQueue.fetch_add(1, std::memory_order_relaxed) %
+                               queues.size();
+    queues[queue]->push(std::move(task));
+    numPendingTasks.fetch_add(1);
+
+    // Wake up a sleeping worker. Taking the lock guarantees that a worker that
+    // is about to go to sleep either sees the new task or gets the
+    // notification.
+    if (numSleepingWorkers.load() > 0) {
+      { std::lock_guard<std::mutex> lock(sleepMu); }
+      sleepCv.notify_one();
+    }
+  }
+
+  // Returns true if the calling thread is a worker of this runtime.
+  bool isWorkerThread() const { return currentRuntime == this; }
+
+  // Runs a single pending task on the calling worker thread, taken from its own
+  // queue if possible and stolen from another worker otherwise. Returns false
+  // if there were no pending tasks.
+  bool runPendingTask() {
+    assert(isWorkerThread() && "expected to be called on a worker thread");
+    Task task;
+    if (!queues[currentWorker]->pop(task)) {
+      bool stolen = false;
+      for (size_t i = 1, e = queues.size(); i < e && !stolen; ++i)
+        stolen = queues[(currentWorker + i) % e]->steal(task);
+      if (!stolen)
+        return false;
+    }
+    numPendingTasks.fetch_sub(1);
+    task();
+    return true;
+  }
+
+  // Waits until `isReady` returns true. On a worker thread, this runs other
+  // pending tasks in the meantime instead of blocking the worker. Otherwise
+  // the thread blocks on the given condition variable, which must be notified
+  // with `mu` held when the awaited value becomes ready.
+  template <typename IsReady>
+  void await(std::mutex &mu, std::condition_variable &cv, IsReady isReady) {
+    std::unique_lock<std::mutex> lock(mu);
+    if (!isWorkerThread()) {
+      cv.wait(lock, isReady);
+      return;
+    }
+
+    while (!isReady()) {
+      lock.unlock();
+      bool ranTask = runPendingTask();
+      lock.lock();
+      // Nothing else to do, wait a little for the value or for new tasks.
+      if (!ranTask && !isReady())
+        cv.wait_for(lock, std::chrono::microseconds(100), isReady);
+    }
+  }
+
 private:
   friend class RefCounted;
 
+  void runWorker(unsigned index) {
+    currentRuntime = this;
+    currentWorker = index;
+    while (true) {
+      if (runPendingTask())
+        continue;
+
+      // Go to sleep until there are new tasks to run.
+      std::unique_lock<std::mutex> lock(sleepMu);
+      numSleepingWorkers.fetch_add(1);
+      sleepCv.wait(lock, [this] {
+        return stopping || numPendingTasks.load() > 0;
+      });
+      numSleepingWorkers.fetch_sub(1);
+      if (stopping && numPendingTasks.load() == 0)
+        return;
+    }
+  }
+
+  static void pinCurrentThread(unsigned cpu) {
+#if defined(__linux__)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpu % CPU_SETSIZE, &cpuSet);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+#else
+    (void)cpu;
+#endif
+  }
+
   // Count the total number of reference counted objects in this instance
   // of an AsyncRuntime. For debugging purposes only.
   void addNumRefCountedObjects() {
@@ -64,8 +250,28 @@ private:
   }
 
   std::atomic<int32_t> numRefCountedObjects;
+
+  // The worker threads and their task queues.
+  std::vector<std::unique_ptr<WorkQueue>> queues;
+  std::vector<std::thread> workers;
+  std::atomic<unsigned> nextQueue{0};
+
+  // The number of tasks in all of the queues, and the state used to put idle
+  // workers to sleep.
+  std::atomic<int64_t> numPendingTasks{0};
+  std::atomic<int32_t> numSleepingWorkers{0};
+  std::mutex sleepMu;
+  std::condition_variable sleepCv;
+  bool stopping = false;
+
+  // The runtime and the index of the worker running on the current thread.
+  static thread_local AsyncRuntime *currentRuntime;
+  static thread_local unsigned currentWorker;
 };
 
+thread_local AsyncRuntime *AsyncRuntime::currentRuntime = nullptr;
+thread_local unsigned AsyncRuntime::currentWorker = 0;
+
 // Returns the default per-process instance of an async runtime.
 AsyncRuntime *getDefaultAsyncRuntimeInstance() {
   static auto runtime = std::make_unique<AsyncRuntime>();
@@ -222,41 +428,47 @@ extern "C" void mlirAsyncRuntimeEmplaceToken(AsyncToken *token) {
 }
 
 extern "C" void mlirAsyncRuntimeAwaitToken(AsyncToken *token) {
-  std::unique_lock<std::mutex> lock(token->mu);
-  if (!token->ready)
-    token->cv.wait(lock, [token] { return token->ready; });
+  getDefaultAsyncRuntimeInstance()->await(token->mu, token->cv,
+                                          [token] { return token->ready; });
 }
 
 extern "C" void mlirAsyncRuntimeAwaitAllInGroup(AsyncGroup *group) {
-  std::unique_lock<std::mutex> lock(group->mu);
-  if (group->pendingTokens != 0)
-    group->cv.wait(lock, [group] { return group->pendingTokens == 0; });
+  getDefaultAsyncRuntimeInstance()->await(
+      group->mu, group->cv, [group] { return group->pendingTokens == 0; });
 }
 
 extern "C" void mlirAsyncRuntimeExecute(CoroHandle handle, CoroResume resume) {
-  (*resume)(handle);
+  getDefaultAsyncRuntimeInstance()->execute(
+      [handle, resume]() { (*resume)(handle); });
 }
 
+// The awaiting coroutine is suspended until the value becomes ready, and is
+// then resumed on the worker pool rather than by the thread that made the
+// value ready, which may still hold locks of the runtime.
 extern "C" void mlirAsyncRuntimeAwaitTokenAndExecute(AsyncToken *token,
                                                      CoroHandle handle,
                                                      CoroResume resume) {
   std::unique_lock<std::mutex> lock(token->mu);
-  auto execute = [handle, resume]() { (*resume)(handle); };
-  if (token->ready)
-    execute();
-  else
-    token->awaiters.push_back([execute]() { execute(); });
+  if (token->ready) {
+    lock.unlock();
+    (*resume)(handle);
+    return;
+  }
+  token->awaiters.push_back(
+      [handle, resume]() { mlirAsyncRuntimeExecute(handle, resume); });
 }
 
 extern "C" void mlirAsyncRuntimeAwaitAllInGroupAndExecute(AsyncGroup *group,
                                                           CoroHandle handle,
                                                           CoroResume resume) {
   std::unique_lock<std::mutex> lock(group->mu);
-  auto execute = [handle, resume]() { (*resume)(handle); };
-  if (group->pendingTokens == 0)
-    execute();
-  else
-    group->awaiters.push_back([execute]() { execute(); });
+  if (group->pendingTokens == 0) {
+    lock.unlock();
+    (*resume)(handle);
+    return;
+  }
+  group->awaiters.push_back(
+      [handle, resume]() { mlirAsyncRuntimeExecute(handle, resume); });
 }
 
 //===----------------------------------------------------------------------===//
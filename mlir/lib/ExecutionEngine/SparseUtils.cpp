@@ -18,19 +18,60 @@
 
 #ifdef MLIR_CRUNNERUTILS_DEFINE_FUNCTIONS
 
+#include <algorithm>
 #include <cctype>
 #include <cinttypes>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MLIR_SPARSEUTILS_USE_MMAP
+#endif
 
 //===----------------------------------------------------------------------===//
 //
-// Internal support for reading matrices in the Matrix Market Exchange Format.
-// See https://math.nist.gov/MatrixMarket for details on this format.
+// Internal support for reading matrices in the Matrix Market Exchange Format
+// and in the FROSTT file format.
+// See https://math.nist.gov/MatrixMarket and http://frostt.io for details on
+// these formats.
+//
+// The contents of a file are mapped into memory and the data items are
+// parsed by several threads at once, each one reading a range of lines. The
+// parsed items are subsequently handed out one at the time.
 //
 //===----------------------------------------------------------------------===//
 
+namespace {
+
+// Contents of a file mapped into memory, or read into a heap buffer where
+// memory mapping is not available.
+struct FileContents {
+  const char *data;
+  size_t size;
+  bool mapped;
+};
+
+// Data items parsed from a range of lines.
+struct MatrixItems {
+  std::vector<uint64_t> i;
+  std::vector<uint64_t> j;
+  std::vector<double> d;
+  const char *error = nullptr; // first malformed line, if any
+};
+
+} // namespace
+
+// Minimum number of bytes parsed by each thread, which avoids spawning
+// threads for small files.
+static const size_t kMinBytesPerThread = 1 << 20;
+
 // Helper to convert string to lower case.
 static char *toLower(char *token) {
   for (char *c = token; *c; c++)
@@ -38,20 +79,202 @@ static char *toLower(char *token) {
   return token;
 }
 
-// Read the header of a general sparse matrix of type real.
+// Helper to test for a file name extension.
+static bool hasSuffix(const char *name, const char *suffix) {
+  size_t n = strlen(name);
+  size_t s = strlen(suffix);
+  return n >= s && strcmp(name + n - s, suffix) == 0;
+}
+
+// Map the contents of the file into memory.
+static FileContents mapFile(char *name) {
+  FileContents contents = {nullptr, 0, false};
+#ifdef MLIR_SPARSEUTILS_USE_MMAP
+  int fd = open(name, O_RDONLY);
+  struct stat st;
+  if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size > 0) {
+    void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr != MAP_FAILED) {
+      contents.data = static_cast<const char *>(addr);
+      contents.size = st.st_size;
+      contents.mapped = true;
+    }
+  }
+  if (fd >= 0)
+    close(fd);
+  if (contents.mapped)
+    return contents;
+#endif
+  // Fall back to reading the whole file.
+  FILE *file = fopen(name, "rb");
+  if (!file) {
+    fprintf(stderr, "Cannot find %s\n", name);
+    exit(1);
+  }
+  std::vector<char> buffer;
+  char chunk[4096];
+  size_t n;
+  while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0)
+    buffer.insert(buffer.end(), chunk, chunk + n);
+  fclose(file);
+  char *data = static_cast<char *>(malloc(buffer.size() + 1));
+  std::copy(buffer.begin(), buffer.end(), data);
+  contents.data = data;
+  contents.size = buffer.size();
+  return contents;
+}
+
+static void unmapFile(FileContents &contents) {
+#ifdef MLIR_SPARSEUTILS_USE_MMAP
+  if (contents.mapped)
+    munmap(const_cast<char *>(contents.data), contents.size);
+  else
+#endif
+    free(const_cast<char *>(contents.data));
+  contents.data = nullptr;
+  contents.size = 0;
+}
+
+// Returns the start of the line after the one at `p`.
+static const char *nextLine(const char *p, const char *end) {
+  const char *eol = static_cast<const char *>(memchr(p, '\n', end - p));
+  return eol ? eol + 1 : end;
+}
+
+// Skip blanks within the current line.
+static const char *skipBlanks(const char *p, const char *end) {
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+    p++;
+  return p;
+}
+
+// Parse an unsigned integer, returns nullptr on failure.
+static const char *parseIndex(const char *p, const char *end, uint64_t *v) {
+  p = skipBlanks(p, end);
+  if (p == end || !isdigit(static_cast<unsigned char>(*p)))
+    return nullptr;
+  uint64_t r = 0;
+  for (; p < end && isdigit(static_cast<unsigned char>(*p)); p++)
+    r = r * 10 + (*p - '0');
+  *v = r;
+  return p;
+}
+
+// Parse a floating-point value, returns nullptr on failure. The token is
+// copied since the contents of the file are not null terminated.
+static const char *parseValue(const char *p, const char *end, double *v) {
+  p = skipBlanks(p, end);
+  char token[64];
+  size_t n = 0;
+  for (; p < end && !isspace(static_cast<unsigned char>(*p)); p++) {
+    if (n == sizeof(token) - 1)
+      return nullptr;
+    token[n++] = *p;
+  }
+  token[n] = 0;
+  char *last;
+  *v = strtod(token, &last);
+  return n != 0 && *last == 0 ? p : nullptr;
+}
+
+// Parse the data items in the lines of [begin, end), skipping empty lines and
+// lines that start with the given comment character.
+static void parseItems(const char *begin, const char *end, char comment,
+                       MatrixItems *items) {
+  for (const char *p = begin; p < end; p = nextLine(p, end)) {
+    const char *q = skipBlanks(p, end);
+    if (q == end || *q == '\n' || *q == comment)
+      continue;
+    uint64_t i, j;
+    double d;
+    q = parseIndex(q, end, &i);
+    if (q)
+      q = parseIndex(q, end, &j);
+    if (q)
+      q = parseValue(q, end, &d);
+    if (q)
+      q = skipBlanks(q, end);
+    // Translate 1-based to 0-based.
+    if (!q || (q != end && *q != '\n') || i == 0 || j == 0) {
+      items->error = p;
+      return;
+    }
+    items->i.push_back(i - 1);
+    items->j.push_back(j - 1);
+    items->d.push_back(d);
+  }
+}
+
+// Parse the data items in [begin, end) with several threads, each parsing a
+// range of whole lines, and concatenate the items in file order.
+static void parseItemsInParallel(char *name, const char *begin,
+                                 const char *end, char comment,
+                                 MatrixItems *items) {
+  size_t size = end - begin;
+  size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+  numThreads = std::min(numThreads, size / kMinBytesPerThread + 1);
+  std::vector<MatrixItems> parts(numThreads);
+  std::vector<std::thread> threads;
+  const char *lo = begin;
+  for (size_t t = 0; t < numThreads; t++) {
+    const char *hi = t + 1 == numThreads
+                         ? end
+                         : std::max(lo, begin + size / numThreads * (t + 1));
+    if (hi != end)
+      hi = nextLine(hi, end);
+    if (t + 1 == numThreads)
+      parseItems(lo, hi, comment, &parts[t]);
+    else
+      threads.emplace_back(parseItems, lo, hi, comment, &parts[t]);
+    lo = hi;
+  }
+  for (std::thread &thread : threads)
+    thread.join();
+  size_t nnz = 0;
+  for (const MatrixItems &part : parts) {
+    if (part.error) {
+      const char *eol = nextLine(part.error, end);
+      fprintf(stderr, "Cannot parse data item \"%.*s\" in %s\n",
+              static_cast<int>(eol - part.error), part.error, name);
+      exit(1);
+    }
+    nnz += part.i.size();
+  }
+  items->i.reserve(nnz);
+  items->j.reserve(nnz);
+  items->d.reserve(nnz);
+  for (const MatrixItems &part : parts) {
+    items->i.insert(items->i.end(), part.i.begin(), part.i.end());
+    items->j.insert(items->j.end(), part.j.begin(), part.j.end());
+    items->d.insert(items->d.end(), part.d.begin(), part.d.end());
+  }
+}
+
+// Read the header of a general sparse matrix of type real, and returns the
+// start of the data items.
 //
 // TODO: support other formats as well?
 //
-static void readHeader(FILE *file, char *name, uint64_t *m, uint64_t *n,
-                       uint64_t *nnz) {
+static const char *readMMEHeader(char *name, const char *begin,
+                                 const char *end, uint64_t *m, uint64_t *n,
+                                 uint64_t *nnz) {
   char line[1025];
   char header[64];
   char object[64];
   char format[64];
   char field[64];
   char symmetry[64];
+  // Copy each line into a null terminated buffer.
+  auto getLine = [&](const char *p) {
+    const char *eol = nextLine(p, end);
+    size_t len = std::min<size_t>(eol - p, sizeof(line) - 1);
+    memcpy(line, p, len);
+    line[len] = 0;
+    return eol;
+  };
   // Read header line.
-  if (fscanf(file, "%63s %63s %63s %63s %63s\n", header, object, format, field,
+  const char *p = getLine(begin);
+  if (sscanf(line, "%63s %63s %63s %63s %63s", header, object, format, field,
              symmetry) != 5) {
     fprintf(stderr, "Corrupt header in %s\n", name);
     exit(1);
@@ -67,10 +290,11 @@ static void readHeader(FILE *file, char *name, uint64_t *m, uint64_t *n,
   }
   // Skip comments.
   while (1) {
-    if (!fgets(line, 1025, file)) {
+    if (p == end) {
       fprintf(stderr, "Cannot find data in %s\n", name);
       exit(1);
     }
+    p = getLine(p);
     if (line[0] != '%')
       break;
   }
@@ -79,26 +303,41 @@ static void readHeader(FILE *file, char *name, uint64_t *m, uint64_t *n,
     fprintf(stderr, "Cannot find size in %s\n", name);
     exit(1);
   }
+  return p;
 }
 
-// Read next data item.
-static void readItem(FILE *file, char *name, uint64_t *i, uint64_t *j,
-                     double *d) {
-  if (fscanf(file, "%" PRIu64 " %" PRIu64 " %lg\n", i, j, d) != 3) {
-    fprintf(stderr, "Cannot find next data item in %s\n", name);
+// Read a matrix in Matrix Market Exchange Format.
+static void readMMEFile(char *name, const FileContents &contents, uint64_t *m,
+                        uint64_t *n, uint64_t *nnz, MatrixItems *items) {
+  const char *end = contents.data + contents.size;
+  const char *begin = readMMEHeader(name, contents.data, end, m, n, nnz);
+  parseItemsInParallel(name, begin, end, '%', items);
+  if (items->i.size() != *nnz) {
+    fprintf(stderr, "Found %zu instead of %" PRIu64 " data items in %s\n",
+            items->i.size(), *nnz, name);
     exit(1);
   }
-  // Translate 1-based to 0-based.
-  *i = *i - 1;
-  *j = *j - 1;
+}
+
+// Read a matrix in FROSTT format, i.e. a 2-dimensional tensor. The file
+// does not have a header, so the sizes are inferred from the data items.
+static void readFROSTTFile(char *name, const FileContents &contents,
+                           uint64_t *m, uint64_t *n, uint64_t *nnz,
+                           MatrixItems *items) {
+  const char *end = contents.data + contents.size;
+  parseItemsInParallel(name, contents.data, end, '#', items);
+  *nnz = items->i.size();
+  *m = *nnz ? *std::max_element(items->i.begin(), items->i.end()) + 1 : 0;
+  *n = *nnz ? *std::max_element(items->j.begin(), items->j.end()) + 1 : 0;
 }
 
 //===----------------------------------------------------------------------===//
 //
 // Public API of the sparse runtime library.
 //
-// Enables MLIR code to read a matrix in Matrix Market Exchange Format
-// as follows:
+// Enables MLIR code to read a matrix in Matrix Market Exchange Format, or a
+// 2-dimensional tensor in FROSTT format (files with the .tns extension), as
+// follows:
 //
 //   call @openMatrix("A.mtx", %m, %n, %nnz) : (!llvm.ptr<i8>,
 //                                              memref<index>,
@@ -113,8 +352,9 @@ static void readItem(FILE *file, char *name, uint64_t *i, uint64_t *j,
 //   }
 //   call @closeMatrix() : () -> ()
 //
-// The implementation is *not* thread-safe. Also, only *one* matrix file can
-// be open at the time. A matrix file must be closed before reading in a next.
+// The whole file is parsed in parallel when opened. The implementation is
+// *not* thread-safe, however. Also, only *one* matrix file can be open at the
+// time. A matrix file must be closed before reading in a next.
 //
 // Note that input parameters in the "MLIRized" version of a function mimic
 // the data layout of a MemRef<T>:
@@ -128,23 +368,26 @@ static void readItem(FILE *file, char *name, uint64_t *i, uint64_t *j,
 //===----------------------------------------------------------------------===//
 
 // Currently open matrix. This is *not* thread-safe or re-entrant.
-static FILE *sparseFile = nullptr;
+static MatrixItems *sparseItems = nullptr;
+static size_t sparseNext = 0;
 static char *sparseFilename = nullptr;
 
 extern "C" void openMatrixC(char *filename, uint64_t *mdata, uint64_t *ndata,
                             uint64_t *nnzdata) {
-  if (sparseFile != nullptr) {
+  if (sparseItems != nullptr) {
     fprintf(stderr, "Other file still open %s vs. %s\n", sparseFilename,
             filename);
     exit(1);
   }
-  sparseFile = fopen(filename, "r");
-  if (!sparseFile) {
-    fprintf(stderr, "Cannot find %s\n", filename);
-    exit(1);
-  }
+  FileContents contents = mapFile(filename);
+  sparseItems = new MatrixItems();
+  sparseNext = 0;
   sparseFilename = filename;
-  readHeader(sparseFile, filename, mdata, ndata, nnzdata);
+  if (hasSuffix(filename, ".tns"))
+    readFROSTTFile(filename, contents, mdata, ndata, nnzdata, sparseItems);
+  else
+    readMMEFile(filename, contents, mdata, ndata, nnzdata, sparseItems);
+  unmapFile(contents);
 }
 
 // "MLIRized" version.
@@ -157,11 +400,18 @@ extern "C" void openMatrix(char *filename, uint64_t *mbase, uint64_t *mdata,
 
 extern "C" void readMatrixItemC(uint64_t *idata, uint64_t *jdata,
                                 double *ddata) {
-  if (sparseFile == nullptr) {
+  if (sparseItems == nullptr) {
     fprintf(stderr, "Cannot read item from unopened matrix\n");
     exit(1);
   }
-  readItem(sparseFile, sparseFilename, idata, jdata, ddata);
+  if (sparseNext == sparseItems->i.size()) {
+    fprintf(stderr, "Cannot find next data item in %s\n", sparseFilename);
+    exit(1);
+  }
+  *idata = sparseItems->i[sparseNext];
+  *jdata = sparseItems->j[sparseNext];
+  *ddata = sparseItems->d[sparseNext];
+  sparseNext++;
 }
 
 // "MLIRized" version.
@@ -172,12 +422,13 @@ extern "C" void readMatrixItem(uint64_t *ibase, uint64_t *idata, int64_t ioff,
 }
 
 extern "C" void closeMatrix() {
-  if (sparseFile == nullptr) {
+  if (sparseItems == nullptr) {
     fprintf(stderr, "Cannot close unopened matrix\n");
     exit(1);
   }
-  fclose(sparseFile);
-  sparseFile = nullptr;
+  delete sparseItems;
+  sparseItems = nullptr;
+  sparseNext = 0;
   sparseFilename = nullptr;
 }
 
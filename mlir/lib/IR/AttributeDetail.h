@@ -358,6 +358,11 @@ inline size_t getDenseElementBitWidth(Type eltType) {
   return eltType.getIntOrFloatBitWidth();
 }
 
+/// Transfer the ownership of a buffer that is referenced in place by
+/// attributes to the given context, which keeps it alive until it is destroyed.
+void registerExternalBuffer(MLIRContext *context,
+                            std::unique_ptr<llvm::MemoryBuffer> buffer);
+
 /// An attribute representing a reference to a dense vector or tensor object.
 struct DenseElementsAttributeStorage : public AttributeStorage {
 public:
@@ -371,13 +376,16 @@ public:
 struct DenseIntOrFPElementsAttributeStorage
     : public DenseElementsAttributeStorage {
   DenseIntOrFPElementsAttributeStorage(ShapedType ty, ArrayRef<char> data,
-                                       bool isSplat = false)
-      : DenseElementsAttributeStorage(ty, isSplat), data(data) {}
+                                       bool isSplat = false,
+                                       bool isExternal = false)
+      : DenseElementsAttributeStorage(ty, isSplat), data(data),
+        isExternal(isExternal) {}
 
   struct KeyTy {
     KeyTy(ShapedType type, ArrayRef<char> data, llvm::hash_code hashCode,
-          bool isSplat = false)
-        : type(type), data(data), hashCode(hashCode), isSplat(isSplat) {}
+          bool isSplat = false, bool isExternal = false)
+        : type(type), data(data), hashCode(hashCode), isSplat(isSplat),
+          isExternal(isExternal) {}
 
     /// The type of the dense elements.
     ShapedType type;
@@ -390,13 +398,21 @@ struct DenseIntOrFPElementsAttributeStorage
 
     /// A boolean that indicates if this data is a splat or not.
     bool isSplat;
+
+    /// A boolean that indicates if this data is held outside of the context,
+    /// in which case it is referenced in place and uniqued by its address.
+    bool isExternal;
   };
 
   /// Compare this storage instance with the provided key.
   bool operator==(const KeyTy &key) const {
-    if (key.type != getType())
+    if (key.type != getType() || key.isExternal != isExternal)
       return false;
 
+    // External data is uniqued by its address, not by its contents.
+    if (isExternal)
+      return key.data.data() == data.data() && key.data.size() == data.size();
+
     // For boolean splats we need to explicitly check that the first bit is the
     // same. Boolean values are packed at the bit level, and even though a splat
     // is detected the rest of the bits in the first byte may differ from the
@@ -456,6 +472,17 @@ struct DenseIntOrFPElementsAttributeStorage
     return KeyTy(ty, firstElt, hashVal, /*isSplat=*/true);
   }
 
+  /// Construct a key for a data buffer held outside of the context. The buffer
+  /// is only referenced by address, so that large buffers are neither scanned
+  /// for splats nor hashed.
+  static KeyTy getKey(ShapedType ty, ArrayRef<char> data, bool isKnownSplat,
+                      bool isExternal) {
+    if (!isExternal)
+      return getKey(ty, data, isKnownSplat);
+    return KeyTy(ty, data, llvm::hash_combine(data.data(), data.size()),
+                 isKnownSplat, /*isExternal=*/true);
+  }
+
   /// Construct a key with a set of boolean data.
   static KeyTy getKeyForBoolData(ShapedType ty, ArrayRef<char> data,
                                  size_t numElements) {
@@ -500,9 +527,11 @@ struct DenseIntOrFPElementsAttributeStorage
   static DenseIntOrFPElementsAttributeStorage *
   construct(AttributeStorageAllocator &allocator, KeyTy key) {
     // If the data buffer is non-empty, we copy it into the allocator with a
-    // 64-bit alignment.
+    // 64-bit alignment. External buffers are referenced in place.
     ArrayRef<char> copy, data = key.data;
-    if (!data.empty()) {
+    if (key.isExternal) {
+      copy = data;
+    } else if (!data.empty()) {
       char *rawData = reinterpret_cast<char *>(
           allocator.allocate(data.size(), alignof(uint64_t)));
       std::memcpy(rawData, data.data(), data.size());
@@ -514,10 +543,12 @@ struct DenseIntOrFPElementsAttributeStorage
     }
 
     return new (allocator.allocate<DenseIntOrFPElementsAttributeStorage>())
-        DenseIntOrFPElementsAttributeStorage(key.type, copy, key.isSplat);
+        DenseIntOrFPElementsAttributeStorage(key.type, copy, key.isSplat,
+                                             key.isExternal);
   }
 
   ArrayRef<char> data;
+  bool isExternal;
 };
 
 /// An attribute representing a reference to a dense vector or tensor object
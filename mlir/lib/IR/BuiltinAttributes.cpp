@@ -17,6 +17,7 @@
 #include "llvm/ADT/Sequence.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/Support/Endian.h"
+#include "llvm/Support/MemoryBuffer.h"
 
 using namespace mlir;
 using namespace mlir::detail;
@@ -892,6 +893,23 @@ DenseElementsAttr DenseElementsAttr::getFromRawBuffer(ShapedType type,
   return DenseIntOrFPElementsAttr::getRaw(type, rawBuffer, isSplatBuffer);
 }
 
+/// Construct a dense elements attribute that refers to the contents of the
+/// given buffer in place, transferring the ownership of the buffer to the
+/// context.
+DenseElementsAttr DenseElementsAttr::getFromExternalBuffer(
+    ShapedType type, std::unique_ptr<llvm::MemoryBuffer> buffer) {
+  ArrayRef<char> rawBuffer(buffer->getBufferStart(), buffer->getBufferSize());
+  Type elementType = type.getElementType();
+  bool detectedSplat = false;
+  if (!(elementType.isIntOrIndexOrFloat() || elementType.isa<ComplexType>()) ||
+      !isValidRawBuffer(type, rawBuffer, detectedSplat))
+    return nullptr;
+
+  detail::registerExternalBuffer(type.getContext(), std::move(buffer));
+  return DenseIntOrFPElementsAttr::getRawExternal(type, rawBuffer,
+                                                  detectedSplat);
+}
+
 /// Returns true if the given buffer is a valid raw buffer for the given type.
 bool DenseElementsAttr::isValidRawBuffer(ShapedType type,
                                          ArrayRef<char> rawBuffer,
@@ -1054,6 +1072,13 @@ ArrayRef<char> DenseElementsAttr::getRawData() const {
   return static_cast<DenseIntOrFPElementsAttributeStorage *>(impl)->data;
 }
 
+/// Returns true if the raw data of this attribute is held outside of the
+/// context.
+bool DenseElementsAttr::isExternal() const {
+  return isa<DenseIntOrFPElementsAttr>() &&
+         static_cast<DenseIntOrFPElementsAttributeStorage *>(impl)->isExternal;
+}
+
 ArrayRef<StringRef> DenseElementsAttr::getRawStringData() const {
   return static_cast<DenseStringElementsAttributeStorage *>(impl)->data;
 }
@@ -1145,6 +1170,16 @@ DenseElementsAttr DenseIntOrFPElementsAttr::getRaw(ShapedType type,
   return Base::get(type.getContext(), type, data, isSplat);
 }
 
+DenseElementsAttr DenseIntOrFPElementsAttr::getRawExternal(ShapedType type,
+                                                           ArrayRef<char> data,
+                                                           bool isSplat) {
+  assert((type.isa<RankedTensorType, VectorType>()) &&
+         "type must be ranked tensor or vector");
+  assert(type.hasStaticShape() && "type must have static shape");
+  return Base::get(type.getContext(), type, data, isSplat,
+                   /*isExternal=*/true);
+}
+
 /// Overload of the raw 'get' method that asserts that the given type is of
 /// complex type. This method is used to verify type invariants that the
 /// templatized 'get' method cannot.
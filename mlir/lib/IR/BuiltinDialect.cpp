@@ -12,6 +12,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "mlir/IR/BuiltinDialect.h"
+#include "BuiltinDialectBytecode.h"
 #include "mlir/IR/BlockAndValueMapping.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinOps.h"
@@ -65,6 +66,7 @@ void BuiltinDialect::initialize() {
 #include "mlir/IR/BuiltinOps.cpp.inc"
       >();
   addInterfaces<BuiltinOpAsmDialectInterface>();
+  addInterface(builtin_dialect_detail::createBytecodeInterface(this));
 }
 
 //===----------------------------------------------------------------------===//
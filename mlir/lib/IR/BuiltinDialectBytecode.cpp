@@ -0,0 +1,635 @@
+//===- BuiltinDialectBytecode.cpp - Builtin Bytecode Implementation -------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "BuiltinDialectBytecode.h"
+#include "mlir/Bytecode/BytecodeImplementation.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/BuiltinDialect.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/Identifier.h"
+#include "mlir/IR/Location.h"
+
+using namespace mlir;
+
+//===----------------------------------------------------------------------===//
+// Encoding
+//===----------------------------------------------------------------------===//
+
+namespace {
+namespace builtin_encoding {
+/// This enum contains marker codes used to indicate which attribute is
+/// currently being decoded, and how it should be decoded. The order of these
+/// codes should generally be unchanged, as any changes will inevitably break
+/// compatibility with older bytecode.
+enum AttributeCode {
+  ///   ArrayAttr {
+  ///     elements: Attribute[]
+  ///   }
+  kArrayAttr = 0,
+
+  ///   DictionaryAttr {
+  ///     attrs: <string, Attribute>[]
+  ///   }
+  kDictionaryAttr = 1,
+
+  ///   StringAttr {
+  ///     value: string
+  ///   }
+  kStringAttr = 2,
+
+  ///   StringAttrWithType {
+  ///     value: string,
+  ///     type: Type
+  ///   }
+  /// A variant of StringAttr with a type other than NoneType.
+  kStringAttrWithType = 3,
+
+  ///   FlatSymbolRefAttr {
+  ///     rootReference: string
+  ///   }
+  kFlatSymbolRefAttr = 4,
+
+  ///   SymbolRefAttr {
+  ///     rootReference: string,
+  ///     leafReferences: FlatSymbolRefAttr[]
+  ///   }
+  kSymbolRefAttr = 5,
+
+  ///   TypeAttr {
+  ///     value: Type
+  ///   }
+  kTypeAttr = 6,
+
+  ///   UnitAttr {
+  ///   }
+  kUnitAttr = 7,
+
+  ///   IntegerAttr {
+  ///     type: Type
+  ///     value: APInt,
+  ///   }
+  kIntegerAttr = 8,
+
+  ///   FloatAttr {
+  ///     type: FloatType
+  ///     value: APFloat
+  ///   }
+  kFloatAttr = 9,
+
+  ///   DenseIntOrFPElementsAttr {
+  ///     type: ShapedType,
+  ///     data: blob
+  ///   }
+  kDenseIntOrFPElementsAttr = 10,
+
+  ///   UnknownLoc {
+  ///   }
+  kUnknownLoc = 11,
+
+  ///   FileLineColLoc {
+  ///     file: string,
+  ///     line: varint,
+  ///     column: varint
+  ///   }
+  kFileLineColLoc = 12,
+
+  ///   NameLoc {
+  ///     name: string,
+  ///     childLoc: LocationAttr
+  ///   }
+  kNameLoc = 13,
+
+  ///   CallSiteLoc {
+  ///    callee: LocationAttr,
+  ///    caller: LocationAttr
+  ///   }
+  kCallSiteLoc = 14,
+
+  ///   FusedLoc {
+  ///     locations: LocationAttr[],
+  ///     metadata: Attribute?
+  ///   }
+  kFusedLoc = 15,
+};
+
+/// This enum contains marker codes used to indicate which type is currently
+/// being decoded, and how it should be decoded. The order of these codes
+/// should generally be unchanged, as any changes will inevitably break
+/// compatibility with older bytecode.
+enum TypeCode {
+  ///   IntegerType {
+  ///     width: varint,
+  ///     signedness: varint
+  ///   }
+  kIntegerType = 0,
+
+  ///   IndexType {
+  ///   }
+  kIndexType = 1,
+
+  ///   BFloat16Type, Float16Type, Float32Type, Float64Type {
+  ///   }
+  kBFloat16Type = 2,
+  kFloat16Type = 3,
+  kFloat32Type = 4,
+  kFloat64Type = 5,
+
+  ///   NoneType {
+  ///   }
+  kNoneType = 6,
+
+  ///   FunctionType {
+  ///     inputs: Type[],
+  ///     results: Type[]
+  ///   }
+  kFunctionType = 7,
+
+  ///   RankedTensorType {
+  ///     shape: svarint[],
+  ///     elementType: Type
+  ///   }
+  kRankedTensorType = 8,
+
+  ///   UnrankedTensorType {
+  ///     elementType: Type
+  ///   }
+  kUnrankedTensorType = 9,
+
+  ///   VectorType {
+  ///     shape: svarint[],
+  ///     elementType: Type
+  ///   }
+  kVectorType = 10,
+
+  ///   ComplexType {
+  ///     elementType: Type
+  ///   }
+  kComplexType = 11,
+
+  ///   TupleType {
+  ///     elementTypes: Type[]
+  ///   }
+  kTupleType = 12,
+};
+} // namespace builtin_encoding
+} // end anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// BuiltinDialectBytecodeInterface
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// This class implements the bytecode interface for the builtin dialect.
+struct BuiltinDialectBytecodeInterface : public BytecodeDialectInterface {
+  using BytecodeDialectInterface::BytecodeDialectInterface;
+
+  //===--------------------------------------------------------------------===//
+  // Attributes
+
+  Attribute readAttribute(DialectBytecodeReader &reader) const override;
+  LogicalResult writeAttribute(Attribute attr,
+                               DialectBytecodeWriter &writer) const override;
+
+  //===--------------------------------------------------------------------===//
+  // Types
+
+  Type readType(DialectBytecodeReader &reader) const override;
+  LogicalResult writeType(Type type,
+                          DialectBytecodeWriter &writer) const override;
+};
+} // end anonymous namespace
+
+std::unique_ptr<DialectInterface>
+builtin_dialect_detail::createBytecodeInterface(BuiltinDialect *dialect) {
+  return std::make_unique<BuiltinDialectBytecodeInterface>(dialect);
+}
+
+/// Return the bitwidth that the value of an IntegerAttr of the given type is
+/// stored with, or zero if the type is not a valid IntegerAttr type.
+static unsigned getIntegerAttrBitWidth(Type type) {
+  if (type.isa<IndexType>())
+    return IndexType::kInternalStorageBitWidth;
+  if (auto intType = type.dyn_cast<IntegerType>())
+    return intType.getWidth();
+  return 0;
+}
+
+//===----------------------------------------------------------------------===//
+// Attributes: Reader
+
+static LogicalResult readLocations(DialectBytecodeReader &reader,
+                                   SmallVectorImpl<Location> &locations) {
+  SmallVector<LocationAttr, 4> locAttrs;
+  if (failed(reader.readAttributes(locAttrs)))
+    return failure();
+  locations.append(locAttrs.begin(), locAttrs.end());
+  return success();
+}
+
+Attribute BuiltinDialectBytecodeInterface::readAttribute(
+    DialectBytecodeReader &reader) const {
+  MLIRContext *context = reader.getContext();
+  uint64_t code;
+  if (failed(reader.readVarInt(code)))
+    return Attribute();
+
+  switch (code) {
+  case builtin_encoding::kArrayAttr: {
+    SmallVector<Attribute, 8> elements;
+    if (failed(reader.readAttributes(elements)))
+      return Attribute();
+    return ArrayAttr::get(elements, context);
+  }
+  case builtin_encoding::kDictionaryAttr: {
+    uint64_t numAttrs;
+    if (failed(reader.readVarInt(numAttrs)))
+      return Attribute();
+    SmallVector<NamedAttribute, 8> attrs;
+    attrs.reserve(numAttrs);
+    for (uint64_t i = 0; i < numAttrs; ++i) {
+      StringRef name;
+      Attribute value;
+      if (failed(reader.readString(name)) ||
+          failed(reader.readAttribute(value)))
+        return Attribute();
+      attrs.emplace_back(Identifier::get(name, context), value);
+    }
+    return DictionaryAttr::get(attrs, context);
+  }
+  case builtin_encoding::kStringAttr: {
+    StringRef value;
+    if (failed(reader.readString(value)))
+      return Attribute();
+    return StringAttr::get(value, context);
+  }
+  case builtin_encoding::kStringAttrWithType: {
+    StringRef value;
+    Type type;
+    if (failed(reader.readString(value)) || failed(reader.readType(type)))
+      return Attribute();
+    return StringAttr::get(value, type);
+  }
+  case builtin_encoding::kFlatSymbolRefAttr: {
+    StringRef rootReference;
+    if (failed(reader.readString(rootReference)))
+      return Attribute();
+    return FlatSymbolRefAttr::get(rootReference, context);
+  }
+  case builtin_encoding::kSymbolRefAttr: {
+    StringRef rootReference;
+    SmallVector<FlatSymbolRefAttr, 4> nestedReferences;
+    if (failed(reader.readString(rootReference)) ||
+        failed(reader.readAttributes(nestedReferences)))
+      return Attribute();
+    return SymbolRefAttr::get(rootReference, nestedReferences, context);
+  }
+  case builtin_encoding::kTypeAttr: {
+    Type type;
+    if (failed(reader.readType(type)))
+      return Attribute();
+    return TypeAttr::get(type);
+  }
+  case builtin_encoding::kUnitAttr:
+    return UnitAttr::get(context);
+  case builtin_encoding::kIntegerAttr: {
+    Type type;
+    if (failed(reader.readType(type)))
+      return Attribute();
+    unsigned bitWidth = getIntegerAttrBitWidth(type);
+    if (!bitWidth) {
+      reader.emitError() << "expected integer or index type for IntegerAttr, "
+                            "but got: "
+                         << type;
+      return Attribute();
+    }
+    FailureOr<APInt> value = reader.readAPIntWithKnownWidth(bitWidth);
+    if (failed(value))
+      return Attribute();
+    return IntegerAttr::get(type, *value);
+  }
+  case builtin_encoding::kFloatAttr: {
+    FloatType type;
+    if (failed(reader.readType(type)))
+      return Attribute();
+    FailureOr<APFloat> value =
+        reader.readAPFloatWithKnownSemantics(type.getFloatSemantics());
+    if (failed(value))
+      return Attribute();
+    return FloatAttr::get(type, *value);
+  }
+  case builtin_encoding::kDenseIntOrFPElementsAttr: {
+    ShapedType type;
+    ArrayRef<char> data;
+    if (failed(reader.readType(type)) || failed(reader.readBlob(data)))
+      return Attribute();
+    bool isSplat;
+    if (!DenseElementsAttr::isValidRawBuffer(type, data, isSplat)) {
+      reader.emitError() << "invalid data for DenseElementsAttr of type "
+                         << type;
+      return Attribute();
+    }
+    return DenseElementsAttr::getFromRawBuffer(type, data, isSplat);
+  }
+  case builtin_encoding::kUnknownLoc:
+    return LocationAttr(UnknownLoc::get(context));
+  case builtin_encoding::kFileLineColLoc: {
+    StringRef filename;
+    uint64_t line, column;
+    if (failed(reader.readString(filename)) ||
+        failed(reader.readVarInt(line)) || failed(reader.readVarInt(column)))
+      return Attribute();
+    return LocationAttr(FileLineColLoc::get(filename, line, column, context));
+  }
+  case builtin_encoding::kNameLoc: {
+    StringRef name;
+    LocationAttr childLoc;
+    if (failed(reader.readString(name)) ||
+        failed(reader.readAttribute(childLoc)))
+      return Attribute();
+    return LocationAttr(NameLoc::get(Identifier::get(name, context), childLoc));
+  }
+  case builtin_encoding::kCallSiteLoc: {
+    LocationAttr callee, caller;
+    if (failed(reader.readAttribute(callee)) ||
+        failed(reader.readAttribute(caller)))
+      return Attribute();
+    return LocationAttr(CallSiteLoc::get(callee, caller));
+  }
+  case builtin_encoding::kFusedLoc: {
+    SmallVector<Location, 4> locations;
+    Attribute metadata;
+    if (failed(readLocations(reader, locations)) ||
+        failed(reader.readOptionalAttribute(metadata)))
+      return Attribute();
+    return LocationAttr(FusedLoc::get(locations, metadata, context));
+  }
+  default:
+    reader.emitError() << "unknown builtin attribute code: " << code;
+    return Attribute();
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Attributes: Writer
+
+LogicalResult BuiltinDialectBytecodeInterface::writeAttribute(
+    Attribute attr, DialectBytecodeWriter &writer) const {
+  if (auto arrayAttr = attr.dyn_cast<ArrayAttr>()) {
+    writer.writeVarInt(builtin_encoding::kArrayAttr);
+    writer.writeAttributes(arrayAttr.getValue());
+    return success();
+  }
+  if (auto dictAttr = attr.dyn_cast<DictionaryAttr>()) {
+    writer.writeVarInt(builtin_encoding::kDictionaryAttr);
+    writer.writeList(dictAttr.getValue(), [&](NamedAttribute attr) {
+      writer.writeOwnedString(attr.first);
+      writer.writeAttribute(attr.second);
+    });
+    return success();
+  }
+  if (auto stringAttr = attr.dyn_cast<StringAttr>()) {
+    // We only encode the type if it isn't NoneType, which is significantly less
+    // common.
+    Type type = stringAttr.getType();
+    if (!type.isa<NoneType>()) {
+      writer.writeVarInt(builtin_encoding::kStringAttrWithType);
+      writer.writeOwnedString(stringAttr.getValue());
+      writer.writeType(type);
+      return success();
+    }
+    writer.writeVarInt(builtin_encoding::kStringAttr);
+    writer.writeOwnedString(stringAttr.getValue());
+    return success();
+  }
+  if (auto symbolRefAttr = attr.dyn_cast<SymbolRefAttr>()) {
+    ArrayRef<FlatSymbolRefAttr> nestedRefs =
+        symbolRefAttr.getNestedReferences();
+    writer.writeVarInt(nestedRefs.empty() ? builtin_encoding::kFlatSymbolRefAttr
+                                          : builtin_encoding::kSymbolRefAttr);
+    writer.writeOwnedString(symbolRefAttr.getRootReference());
+    if (!nestedRefs.empty())
+      writer.writeAttributes(nestedRefs);
+    return success();
+  }
+  if (auto typeAttr = attr.dyn_cast<TypeAttr>()) {
+    writer.writeVarInt(builtin_encoding::kTypeAttr);
+    writer.writeType(typeAttr.getValue());
+    return success();
+  }
+  if (attr.isa<UnitAttr>()) {
+    writer.writeVarInt(builtin_encoding::kUnitAttr);
+    return success();
+  }
+  if (auto intAttr = attr.dyn_cast<IntegerAttr>()) {
+    writer.writeVarInt(builtin_encoding::kIntegerAttr);
+    writer.writeType(intAttr.getType());
+    writer.writeAPIntWithKnownWidth(intAttr.getValue());
+    return success();
+  }
+  if (auto floatAttr = attr.dyn_cast<FloatAttr>()) {
+    writer.writeVarInt(builtin_encoding::kFloatAttr);
+    writer.writeType(floatAttr.getType());
+    writer.writeAPFloatWithKnownSemantics(floatAttr.getValue());
+    return success();
+  }
+  if (auto denseAttr = attr.dyn_cast<DenseIntOrFPElementsAttr>()) {
+    writer.writeVarInt(builtin_encoding::kDenseIntOrFPElementsAttr);
+    writer.writeType(denseAttr.getType());
+    writer.writeOwnedBlob(denseAttr.getRawData());
+    return success();
+  }
+  if (attr.isa<UnknownLoc>()) {
+    writer.writeVarInt(builtin_encoding::kUnknownLoc);
+    return success();
+  }
+  if (auto loc = attr.dyn_cast<FileLineColLoc>()) {
+    writer.writeVarInt(builtin_encoding::kFileLineColLoc);
+    writer.writeOwnedString(loc.getFilename());
+    writer.writeVarInt(loc.getLine());
+    writer.writeVarInt(loc.getColumn());
+    return success();
+  }
+  if (auto loc = attr.dyn_cast<NameLoc>()) {
+    writer.writeVarInt(builtin_encoding::kNameLoc);
+    writer.writeOwnedString(loc.getName());
+    writer.writeAttribute(LocationAttr(loc.getChildLoc()));
+    return success();
+  }
+  if (auto loc = attr.dyn_cast<CallSiteLoc>()) {
+    writer.writeVarInt(builtin_encoding::kCallSiteLoc);
+    writer.writeAttribute(LocationAttr(loc.getCallee()));
+    writer.writeAttribute(LocationAttr(loc.getCaller()));
+    return success();
+  }
+  if (auto loc = attr.dyn_cast<FusedLoc>()) {
+    writer.writeVarInt(builtin_encoding::kFusedLoc);
+    writer.writeList(loc.getLocations(), [&](Location location) {
+      writer.writeAttribute(LocationAttr(location));
+    });
+    writer.writeOptionalAttribute(loc.getMetadata());
+    return success();
+  }
+  return failure();
+}
+
+//===----------------------------------------------------------------------===//
+// Types: Reader
+
+Type BuiltinDialectBytecodeInterface::readType(
+    DialectBytecodeReader &reader) const {
+  MLIRContext *context = reader.getContext();
+  uint64_t code;
+  if (failed(reader.readVarInt(code)))
+    return Type();
+
+  switch (code) {
+  case builtin_encoding::kIntegerType: {
+    uint64_t width, signedness;
+    if (failed(reader.readVarInt(width)) ||
+        failed(reader.readVarInt(signedness)))
+      return Type();
+    if (width > IntegerType::kMaxWidth ||
+        signedness > IntegerType::Unsigned) {
+      reader.emitError() << "invalid integer type, width: " << width
+                         << ", signedness: " << signedness;
+      return Type();
+    }
+    return IntegerType::get(
+        width, static_cast<IntegerType::SignednessSemantics>(signedness),
+        context);
+  }
+  case builtin_encoding::kIndexType:
+    return IndexType::get(context);
+  case builtin_encoding::kBFloat16Type:
+    return FloatType::getBF16(context);
+  case builtin_encoding::kFloat16Type:
+    return FloatType::getF16(context);
+  case builtin_encoding::kFloat32Type:
+    return FloatType::getF32(context);
+  case builtin_encoding::kFloat64Type:
+    return FloatType::getF64(context);
+  case builtin_encoding::kNoneType:
+    return NoneType::get(context);
+  case builtin_encoding::kFunctionType: {
+    SmallVector<Type, 4> inputs, results;
+    if (failed(reader.readTypes(inputs)) || failed(reader.readTypes(results)))
+      return Type();
+    return FunctionType::get(inputs, results, context);
+  }
+  case builtin_encoding::kRankedTensorType: {
+    SmallVector<int64_t, 4> shape;
+    Type elementType;
+    if (failed(reader.readSignedVarInts(shape)) ||
+        failed(reader.readType(elementType)))
+      return Type();
+    return RankedTensorType::get(shape, elementType);
+  }
+  case builtin_encoding::kUnrankedTensorType: {
+    Type elementType;
+    if (failed(reader.readType(elementType)))
+      return Type();
+    return UnrankedTensorType::get(elementType);
+  }
+  case builtin_encoding::kVectorType: {
+    SmallVector<int64_t, 4> shape;
+    Type elementType;
+    if (failed(reader.readSignedVarInts(shape)) ||
+        failed(reader.readType(elementType)))
+      return Type();
+    return VectorType::get(shape, elementType);
+  }
+  case builtin_encoding::kComplexType: {
+    Type elementType;
+    if (failed(reader.readType(elementType)))
+      return Type();
+    return ComplexType::get(elementType);
+  }
+  case builtin_encoding::kTupleType: {
+    SmallVector<Type, 4> elementTypes;
+    if (failed(reader.readTypes(elementTypes)))
+      return Type();
+    return TupleType::get(elementTypes, context);
+  }
+  default:
+    reader.emitError() << "unknown builtin type code: " << code;
+    return Type();
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Types: Writer
+
+LogicalResult BuiltinDialectBytecodeInterface::writeType(
+    Type type, DialectBytecodeWriter &writer) const {
+  if (auto intType = type.dyn_cast<IntegerType>()) {
+    writer.writeVarInt(builtin_encoding::kIntegerType);
+    writer.writeVarInt(intType.getWidth());
+    writer.writeVarInt(intType.getSignedness());
+    return success();
+  }
+  if (type.isa<IndexType>()) {
+    writer.writeVarInt(builtin_encoding::kIndexType);
+    return success();
+  }
+  if (type.isa<BFloat16Type>()) {
+    writer.writeVarInt(builtin_encoding::kBFloat16Type);
+    return success();
+  }
+  if (type.isa<Float16Type>()) {
+    writer.writeVarInt(builtin_encoding::kFloat16Type);
+    return success();
+  }
+  if (type.isa<Float32Type>()) {
+    writer.writeVarInt(builtin_encoding::kFloat32Type);
+    return success();
+  }
+  if (type.isa<Float64Type>()) {
+    writer.writeVarInt(builtin_encoding::kFloat64Type);
+    return success();
+  }
+  if (type.isa<NoneType>()) {
+    writer.writeVarInt(builtin_encoding::kNoneType);
+    return success();
+  }
+  if (auto funcType = type.dyn_cast<FunctionType>()) {
+    writer.writeVarInt(builtin_encoding::kFunctionType);
+    writer.writeTypes(funcType.getInputs());
+    writer.writeTypes(funcType.getResults());
+    return success();
+  }
+  if (auto tensorType = type.dyn_cast<RankedTensorType>()) {
+    writer.writeVarInt(builtin_encoding::kRankedTensorType);
+    writer.writeSignedVarInts(tensorType.getShape());
+    writer.writeType(tensorType.getElementType());
+    return success();
+  }
+  if (auto tensorType = type.dyn_cast<UnrankedTensorType>()) {
+    writer.writeVarInt(builtin_encoding::kUnrankedTensorType);
+    writer.writeType(tensorType.getElementType());
+    return success();
+  }
+  if (auto vectorType = type.dyn_cast<VectorType>()) {
+    writer.writeVarInt(builtin_encoding::kVectorType);
+    writer.writeSignedVarInts(vectorType.getShape());
+    writer.writeType(vectorType.getElementType());
+    return success();
+  }
+  if (auto complexType = type.dyn_cast<ComplexType>()) {
+    writer.writeVarInt(builtin_encoding::kComplexType);
+    writer.writeType(complexType.getElementType());
+    return success();
+  }
+  if (auto tupleType = type.dyn_cast<TupleType>()) {
+    writer.writeVarInt(builtin_encoding::kTupleType);
+    writer.writeTypes(tupleType.getTypes());
+    return success();
+  }
+  // MemRef types, along with their layout maps, and opaque types fall back to
+  // the textual format.
+  return failure();
+}
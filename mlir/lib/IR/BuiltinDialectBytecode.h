@@ -0,0 +1,28 @@
+//===- BuiltinDialectBytecode.h - MLIR Bytecode Implementation --*- C++ -*-===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This holds the hooks into the builtin dialect bytecode implementation.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef BUILTINDIALECTBYTECODE_H_
+#define BUILTINDIALECTBYTECODE_H_
+
+#include <memory>
+
+namespace mlir {
+class BuiltinDialect;
+class DialectInterface;
+
+namespace builtin_dialect_detail {
+/// Create the interface that encodes builtin attributes and types in bytecode.
+std::unique_ptr<DialectInterface> createBytecodeInterface(BuiltinDialect *);
+} // namespace builtin_dialect_detail
+} // namespace mlir
+
+#endif // BUILTINDIALECTBYTECODE_H_
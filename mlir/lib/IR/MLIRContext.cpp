@@ -33,6 +33,8 @@
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Mutex.h"
 #include "llvm/Support/RWMutex.h"
 #include "llvm/Support/raw_ostream.h"
 #include <memory>
@@ -320,6 +322,12 @@ public:
   UnknownLoc unknownLocAttr;
   DictionaryAttr emptyDictionaryAttr;
 
+  /// Buffers that are referenced in place by attributes, e.g. memory mapped
+  /// files holding the data of dense elements attributes, and a mutex for
+  /// thread safety.
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> externalBuffers;
+  llvm::sys::SmartMutex<true> externalBufferMutex;
+
 public:
   MLIRContextImpl() : identifiers(identifierAllocator) {}
   ~MLIRContextImpl() {
@@ -827,6 +835,13 @@ void AttributeUniquer::initializeAttributeStorage(AttributeStorage *storage,
     storage->setType(NoneType::get(ctx));
 }
 
+void mlir::detail::registerExternalBuffer(
+    MLIRContext *context, std::unique_ptr<llvm::MemoryBuffer> buffer) {
+  auto &impl = context->getImpl();
+  llvm::sys::SmartScopedLock<true> lock(impl.externalBufferMutex);
+  impl.externalBuffers.push_back(std::move(buffer));
+}
+
 BoolAttr BoolAttr::get(bool value, MLIRContext *context) {
   return value ? context->getImpl().trueAttr : context->getImpl().falseAttr;
 }
@@ -26,6 +26,7 @@
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
+#include <mutex>
 
 using namespace mlir;
 using namespace mlir::detail;
@@ -925,11 +926,24 @@ PassInstrumentation::~PassInstrumentation() {}
 namespace mlir {
 namespace detail {
 struct PassInstrumentorImpl {
+  using LockT = std::unique_lock<llvm::sys::SmartMutex<true>>;
+
+  /// Acquire the instrumentation lock, unless all of the instrumentations are
+  /// thread-safe.
+  LockT lock() {
+    if (allThreadSafe)
+      return LockT(mutex, std::defer_lock);
+    return LockT(mutex);
+  }
+
   /// Mutex to keep instrumentation access thread-safe.
   llvm::sys::SmartMutex<true> mutex;
 
   /// Set of registered instrumentations.
   std::vector<std::unique_ptr<PassInstrumentation>> instrumentations;
+
+  /// True if every registered instrumentation is thread-safe.
+  bool allThreadSafe = true;
 };
 } // end namespace detail
 } // end namespace mlir
@@ -941,7 +955,7 @@ PassInstrumentor::~PassInstrumentor() {}
 void PassInstrumentor::runBeforePipeline(
     Identifier name,
     const PassInstrumentation::PipelineParentInfo &parentInfo) {
-  llvm::sys::SmartScopedLock<true> instrumentationLock(impl->mutex);
+  auto instrumentationLock = impl->lock();
   for (auto &instr : impl->instrumentations)
     instr->runBeforePipeline(name, parentInfo);
 }
@@ -950,28 +964,28 @@ void PassInstrumentor::runBeforePipeline(
 void PassInstrumentor::runAfterPipeline(
     Identifier name,
     const PassInstrumentation::PipelineParentInfo &parentInfo) {
-  llvm::sys::SmartScopedLock<true> instrumentationLock(impl->mutex);
+  auto instrumentationLock = impl->lock();
   for (auto &instr : llvm::reverse(impl->instrumentations))
     instr->runAfterPipeline(name, parentInfo);
 }
 
 /// See PassInstrumentation::runBeforePass for details.
 void PassInstrumentor::runBeforePass(Pass *pass, Operation *op) {
-  llvm::sys::SmartScopedLock<true> instrumentationLock(impl->mutex);
+  auto instrumentationLock = impl->lock();
   for (auto &instr : impl->instrumentations)
     instr->runBeforePass(pass, op);
 }
 
 /// See PassInstrumentation::runAfterPass for details.
 void PassInstrumentor::runAfterPass(Pass *pass, Operation *op) {
-  llvm::sys::SmartScopedLock<true> instrumentationLock(impl->mutex);
+  auto instrumentationLock = impl->lock();
   for (auto &instr : llvm::reverse(impl->instrumentations))
     instr->runAfterPass(pass, op);
 }
 
 /// See PassInstrumentation::runAfterPassFailed for details.
 void PassInstrumentor::runAfterPassFailed(Pass *pass, Operation *op) {
-  llvm::sys::SmartScopedLock<true> instrumentationLock(impl->mutex);
+  auto instrumentationLock = impl->lock();
   for (auto &instr : llvm::reverse(impl->instrumentations))
     instr->runAfterPassFailed(pass, op);
 }
@@ -979,7 +993,7 @@ void PassInstrumentor::runAfterPassFailed(Pass *pass, Operation *op) {
 /// See PassInstrumentation::runBeforeAnalysis for details.
 void PassInstrumentor::runBeforeAnalysis(StringRef name, TypeID id,
                                          Operation *op) {
-  llvm::sys::SmartScopedLock<true> instrumentationLock(impl->mutex);
+  auto instrumentationLock = impl->lock();
   for (auto &instr : impl->instrumentations)
     instr->runBeforeAnalysis(name, id, op);
 }
@@ -987,7 +1001,7 @@ void PassInstrumentor::runBeforeAnalysis(StringRef name, TypeID id,
 /// See PassInstrumentation::runAfterAnalysis for details.
 void PassInstrumentor::runAfterAnalysis(StringRef name, TypeID id,
                                         Operation *op) {
-  llvm::sys::SmartScopedLock<true> instrumentationLock(impl->mutex);
+  auto instrumentationLock = impl->lock();
   for (auto &instr : llvm::reverse(impl->instrumentations))
     instr->runAfterAnalysis(name, id, op);
 }
@@ -996,5 +1010,6 @@ void PassInstrumentor::runAfterAnalysis(StringRef name, TypeID id,
 void PassInstrumentor::addInstrumentation(
     std::unique_ptr<PassInstrumentation> pi) {
   llvm::sys::SmartScopedLock<true> instrumentationLock(impl->mutex);
+  impl->allThreadSafe &= pi->isThreadSafe();
   impl->instrumentations.emplace_back(std::move(pi));
 }
@@ -71,6 +71,11 @@ struct PassManagerOptions {
                      "display the results in a list sorted by total time"),
           clEnumValN(PassDisplayMode::Pipeline, "pipeline",
                      "display the results with a nested pipeline view"))};
+  llvm::cl::opt<std::string> passTimingTraceFile{
+      "pass-timing-trace",
+      llvm::cl::desc("Write a Chrome trace of the execution of each pass on "
+                     "each thread to the given file (implies -pass-timing)"),
+      llvm::cl::value_desc("filename")};
 
   //===--------------------------------------------------------------------===//
   // Pass Statistics
@@ -137,9 +142,9 @@ void PassManagerOptions::addPrinterInstrumentation(PassManager &pm) {
 
 /// Add a pass timing instrumentation if enabled by 'pass-timing' flags.
 void PassManagerOptions::addTimingInstrumentation(PassManager &pm) {
-  if (passTiming)
-    pm.enableTiming(
-        std::make_unique<PassManager::PassTimingConfig>(passTimingDisplayMode));
+  if (passTiming || !passTimingTraceFile.empty())
+    pm.enableTiming(std::make_unique<PassManager::PassTimingConfig>(
+        passTimingDisplayMode, passTimingTraceFile));
 }
 
 void mlir::registerPassManagerCLOptions() {
@@ -14,8 +14,12 @@
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
 #include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+#include <atomic>
 #include <chrono>
+#include <mutex>
 
 using namespace mlir;
 using namespace mlir::detail;
@@ -66,11 +70,13 @@ struct Timer {
   /// Start the timer.
   void start() { startTime = std::chrono::system_clock::now(); }
 
-  /// Stop the timer.
-  void stop() {
-    auto newTime = std::chrono::system_clock::now() - startTime;
+  /// Stop the timer, returning the time at which it was stopped.
+  std::chrono::time_point<std::chrono::system_clock> stop() {
+    auto stopTime = std::chrono::system_clock::now();
+    auto newTime = stopTime - startTime;
     wallTime += newTime;
     userTime += newTime;
+    return stopTime;
   }
 
   /// Get or create a child timer with the provided name and id.
@@ -159,11 +165,79 @@ struct Timer {
   TimerKind kind;
 };
 
+/// A pass or analysis execution, or a pipeline run on a thread other than its
+/// parent's, recorded for the Chrome trace.
+struct TraceEvent {
+  std::string name;
+  std::chrono::time_point<std::chrono::system_clock> start, end;
+};
+
+/// The timing state of a single thread. Each thread only ever touches its own
+/// state while passes run, so recording needs no synchronization.
+struct ThreadTimingState {
+  explicit ThreadTimingState(unsigned index)
+      : tid(llvm::get_threadid()), index(index) {}
+
+  /// Returns a timer for the provided identifier and name, and makes it the
+  /// active timer.
+  Timer *getTimer(const void *id, TimerKind kind,
+                  std::function<std::string()> &&nameBuilder) {
+    // If there is no active timer then add to the root timer.
+    Timer *parentTimer;
+    if (activeTimers.empty()) {
+      if (!rootTimer)
+        rootTimer = std::make_unique<Timer>("root", TimerKind::Pipeline);
+      parentTimer = rootTimer.get();
+    } else {
+      // Otherwise, add this to the active timer.
+      parentTimer = activeTimers.back();
+    }
+
+    auto timer = parentTimer->getChildTimer(id, kind, std::move(nameBuilder));
+    activeTimers.push_back(timer);
+    return timer;
+  }
+
+  /// Pop the last active timer.
+  Timer *popLastActiveTimer() {
+    assert(!activeTimers.empty() && "expected active timer");
+    return activeTimers.pop_back_val();
+  }
+
+  /// The thread this state belongs to, and its position in the order in which
+  /// threads first reported to the instrumentation.
+  uint64_t tid;
+  unsigned index;
+
+  /// The root top level timer of this thread.
+  std::unique_ptr<Timer> rootTimer;
+
+  /// A stack of the currently active timers.
+  SmallVector<Timer *, 4> activeTimers;
+
+  /// The time spent running, and the number of, pipelines spawned by passes on
+  /// other threads.
+  std::chrono::nanoseconds busyTime = std::chrono::nanoseconds(0);
+  unsigned numPipelines = 0;
+  std::chrono::time_point<std::chrono::system_clock> pipelineStartTime;
+
+  /// The wall time spent in passes that spawned pipelines on other threads.
+  std::chrono::nanoseconds parallelTime = std::chrono::nanoseconds(0);
+
+  /// The events recorded for the Chrome trace.
+  std::vector<TraceEvent> events;
+};
+
 struct PassTiming : public PassInstrumentation {
   PassTiming(std::unique_ptr<PassManager::PassTimingConfig> config)
-      : config(std::move(config)) {}
+      : config(std::move(config)), instanceID(nextInstanceID++),
+        traceStartTime(std::chrono::system_clock::now()) {}
   ~PassTiming() override { print(); }
 
+  /// The timing state is per-thread, so there is no need for the
+  /// PassInstrumentor to serialize the callbacks.
+  bool isThreadSafe() const override { return true; }
+
   /// Setup the instrumentation hooks.
   void runBeforePipeline(Identifier name,
                          const PipelineParentInfo &parentInfo) override;
@@ -188,13 +262,11 @@ struct PassTiming : public PassInstrumentation {
   /// Start a new timer for the given analysis.
   void startAnalysisTimer(StringRef name, TypeID id);
 
-  /// Pop the last active timer for the current thread.
-  Timer *popLastActiveTimer() {
-    auto tid = llvm::get_threadid();
-    auto &activeTimers = activeThreadTimers[tid];
-    assert(!activeTimers.empty() && "expected active timer");
-    return activeTimers.pop_back_val();
-  }
+  /// Stop the given pass or analysis timer.
+  void stopTimer(ThreadTimingState &state, Timer *timer);
+
+  /// Return the timing state of the current thread.
+  ThreadTimingState &getThreadState();
 
   /// Print the timing result in list mode.
   void printResultsAsList(raw_ostream &os, Timer *root, TimeRecord totalTime);
@@ -203,34 +275,15 @@ struct PassTiming : public PassInstrumentation {
   void printResultsAsPipeline(raw_ostream &os, Timer *root,
                               TimeRecord totalTime);
 
-  /// Returns a timer for the provided identifier and name.
-  Timer *getTimer(const void *id, TimerKind kind,
-                  std::function<std::string()> &&nameBuilder) {
-    auto tid = llvm::get_threadid();
-
-    // If there is no active timer then add to the root timer.
-    auto &activeTimers = activeThreadTimers[tid];
-    Timer *parentTimer;
-    if (activeTimers.empty()) {
-      auto &rootTimer = rootTimers[tid];
-      if (!rootTimer)
-        rootTimer = std::make_unique<Timer>("root", TimerKind::Pipeline);
-      parentTimer = rootTimer.get();
-    } else {
-      // Otherwise, add this to the active timer.
-      parentTimer = activeTimers.back();
-    }
-
-    auto timer = parentTimer->getChildTimer(id, kind, std::move(nameBuilder));
-    activeTimers.push_back(timer);
-    return timer;
-  }
+  /// Print how busy the threads that ran pipelines for parallel passes were.
+  void printThreadUtilization(raw_ostream &os);
 
-  /// The root top level timers for each thread.
-  DenseMap<uint64_t, std::unique_ptr<Timer>> rootTimers;
+  /// Print the recorded events in the Chrome trace event format.
+  void printTrace(raw_ostream &os);
 
-  /// A stack of the currently active pass timers per thread.
-  DenseMap<uint64_t, SmallVector<Timer *, 4>> activeThreadTimers;
+  /// The timing state of each thread that has run passes.
+  std::vector<std::unique_ptr<ThreadTimingState>> threadStates;
+  std::mutex threadStatesMutex;
 
   /// The configuration object to use when printing the timing results.
   std::unique_ptr<PassManager::PassTimingConfig> config;
@@ -239,84 +292,136 @@ struct PassTiming : public PassInstrumentation {
   /// collection. The timers are mapped to the parent info to merge into.
   DenseMap<PipelineParentInfo, SmallVector<Timer::ChildrenMap::value_type, 4>>
       pipelinesToMerge;
+  std::mutex pipelinesToMergeMutex;
+
+  /// A unique identifier for this instrumentation, used to key the
+  /// thread-local caches of thread states. Unlike `this`, it is never reused
+  /// by a later instance.
+  uint64_t instanceID;
+  static std::atomic<uint64_t> nextInstanceID;
+
+  /// The time that trace event timestamps are relative to.
+  std::chrono::time_point<std::chrono::system_clock> traceStartTime;
 };
 } // end anonymous namespace
 
+std::atomic<uint64_t> PassTiming::nextInstanceID(0);
+
+ThreadTimingState &PassTiming::getThreadState() {
+  static LLVM_THREAD_LOCAL llvm::SmallDenseMap<uint64_t, ThreadTimingState *, 2>
+      cache;
+  ThreadTimingState *&state = cache[instanceID];
+  if (!state) {
+    std::lock_guard<std::mutex> lock(threadStatesMutex);
+    threadStates.push_back(
+        std::make_unique<ThreadTimingState>(threadStates.size()));
+    state = threadStates.back().get();
+  }
+  return *state;
+}
+
 void PassTiming::runBeforePipeline(Identifier name,
                                    const PipelineParentInfo &parentInfo) {
+  ThreadTimingState &state = getThreadState();
+  if (state.activeTimers.empty())
+    state.pipelineStartTime = std::chrono::system_clock::now();
+
   // We don't actually want to time the pipelines, they gather their total
   // from their held passes.
-  getTimer(name.getAsOpaquePointer(), TimerKind::Pipeline,
-           [&] { return ("'" + name.strref() + "' Pipeline").str(); });
+  state.getTimer(name.getAsOpaquePointer(), TimerKind::Pipeline,
+                 [&] { return ("'" + name.strref() + "' Pipeline").str(); });
 }
 
 void PassTiming::runAfterPipeline(Identifier name,
                                   const PipelineParentInfo &parentInfo) {
   // Pop the timer for the pipeline.
-  auto tid = llvm::get_threadid();
-  auto &activeTimers = activeThreadTimers[tid];
-  assert(!activeTimers.empty() && "expected active timer");
-  activeTimers.pop_back();
+  ThreadTimingState &state = getThreadState();
+  state.popLastActiveTimer();
 
   // If the current thread is the same as the parent, there is nothing left to
   // do.
-  if (tid == parentInfo.parentThreadID)
+  if (state.tid == parentInfo.parentThreadID)
     return;
 
-  // Otherwise, mark the pipeline timer for merging into the correct parent
-  // thread.
-  assert(activeTimers.empty() && "expected parent timer to be root");
-  auto *parentTimer = rootTimers[tid].get();
+  // Otherwise, this thread ran the pipeline on behalf of a parallel pass.
+  assert(state.activeTimers.empty() && "expected parent timer to be root");
+  auto endTime = std::chrono::system_clock::now();
+  state.busyTime += endTime - state.pipelineStartTime;
+  ++state.numPipelines;
+
+  // Mark the pipeline timer for merging into the correct parent thread.
+  Timer *parentTimer = state.rootTimer.get();
   assert(parentTimer->children.size() == 1 &&
          parentTimer->children.count(name.getAsOpaquePointer()) &&
          "expected a single pipeline timer");
-  pipelinesToMerge[parentInfo].push_back(
-      std::move(*parentTimer->children.begin()));
-  rootTimers.erase(tid);
+  if (config->shouldTrace())
+    state.events.push_back({parentTimer->children.begin()->second->name,
+                            state.pipelineStartTime, endTime});
+  {
+    std::lock_guard<std::mutex> lock(pipelinesToMergeMutex);
+    pipelinesToMerge[parentInfo].push_back(
+        std::move(*parentTimer->children.begin()));
+  }
+  state.rootTimer.reset();
 }
 
 /// Start a new timer for the given pass.
 void PassTiming::startPassTimer(Pass *pass) {
   auto kind = isa<OpToOpPassAdaptor>(pass) ? TimerKind::PipelineCollection
                                            : TimerKind::PassOrAnalysis;
-  Timer *timer = getTimer(pass, kind, [pass]() -> std::string {
-    if (auto *adaptor = dyn_cast<OpToOpPassAdaptor>(pass))
-      return adaptor->getAdaptorName();
-    return std::string(pass->getName());
-  });
-
-  // We don't actually want to time the adaptor passes, they gather their total
-  // from their held passes.
-  if (!isa<OpToOpPassAdaptor>(pass))
-    timer->start();
+  Timer *timer =
+      getThreadState().getTimer(pass, kind, [pass]() -> std::string {
+        if (auto *adaptor = dyn_cast<OpToOpPassAdaptor>(pass))
+          return adaptor->getAdaptorName();
+        return std::string(pass->getName());
+      });
+
+  // Adaptor passes gather their total from their held passes; their start
+  // time is only used to measure how long they ran in parallel.
+  timer->start();
 }
 
 /// Start a new timer for the given analysis.
 void PassTiming::startAnalysisTimer(StringRef name, TypeID id) {
-  Timer *timer = getTimer(id.getAsOpaquePointer(), TimerKind::PassOrAnalysis,
-                          [name] { return "(A) " + name.str(); });
+  Timer *timer = getThreadState().getTimer(
+      id.getAsOpaquePointer(), TimerKind::PassOrAnalysis,
+      [name] { return "(A) " + name.str(); });
   timer->start();
 }
 
+void PassTiming::stopTimer(ThreadTimingState &state, Timer *timer) {
+  auto stopTime = timer->stop();
+  if (config->shouldTrace())
+    state.events.push_back({timer->name, timer->startTime, stopTime});
+}
+
 /// Stop a pass timer.
 void PassTiming::runAfterPass(Pass *pass, Operation *) {
-  Timer *timer = popLastActiveTimer();
+  ThreadTimingState &state = getThreadState();
+  Timer *timer = state.popLastActiveTimer();
+  if (timer->kind != TimerKind::PipelineCollection)
+    return stopTimer(state, timer);
 
   // Check to see if we need to merge in the timing data for the pipelines
   // running on other threads.
-  auto toMerge = pipelinesToMerge.find({llvm::get_threadid(), pass});
-  if (toMerge != pipelinesToMerge.end()) {
-    for (auto &it : toMerge->second)
-      timer->mergeChild(std::move(it));
-    pipelinesToMerge.erase(toMerge);
+  SmallVector<Timer::ChildrenMap::value_type, 4> toMerge;
+  {
+    std::lock_guard<std::mutex> lock(pipelinesToMergeMutex);
+    auto it = pipelinesToMerge.find({state.tid, pass});
+    if (it == pipelinesToMerge.end())
+      return;
+    toMerge = std::move(it->second);
+    pipelinesToMerge.erase(it);
   }
-
-  timer->stop();
+  for (auto &it : toMerge)
+    timer->mergeChild(std::move(it));
+  state.parallelTime += std::chrono::system_clock::now() - timer->startTime;
 }
 
 /// Stop a timer.
 void PassTiming::runAfterAnalysis(StringRef, TypeID, Operation *) {
-  popLastActiveTimer()->stop();
+  ThreadTimingState &state = getThreadState();
+  stopTimer(state, state.popLastActiveTimer());
 }
 
 /// Utility to print the timer heading information.
@@ -343,35 +448,118 @@ static void printTimeEntry(raw_ostream &os, unsigned indent, StringRef name,
 
 /// Print out the current timing information.
 void PassTiming::print() {
+  // All threads but one hand their timers over to the thread that spawned
+  // their pipelines.
+  Timer *rootTimer = nullptr;
+  for (auto &state : threadStates) {
+    if (!state->rootTimer)
+      continue;
+    assert(!rootTimer && "expected one remaining root timer");
+    rootTimer = state->rootTimer.get();
+  }
+
   // Don't print anything if there is no timing data.
-  if (rootTimers.empty())
+  if (!rootTimer)
     return;
 
-  assert(rootTimers.size() == 1 && "expected one remaining root timer");
-
   auto printCallback = [&](raw_ostream &os) {
-    auto &rootTimer = rootTimers.begin()->second;
     // Print the timer header.
     TimeRecord totalTime = rootTimer->getTotalTime();
     printTimerHeader(os, totalTime);
     // Defer to a specialized printer for each display mode.
     switch (config->getDisplayMode()) {
     case PassDisplayMode::List:
-      printResultsAsList(os, rootTimer.get(), totalTime);
+      printResultsAsList(os, rootTimer, totalTime);
       break;
     case PassDisplayMode::Pipeline:
-      printResultsAsPipeline(os, rootTimer.get(), totalTime);
+      printResultsAsPipeline(os, rootTimer, totalTime);
       break;
     }
     printTimeEntry(os, 0, "Total", totalTime, totalTime);
+    printThreadUtilization(os);
     os.flush();
-
-    // Reset root timers.
-    rootTimers.clear();
-    activeThreadTimers.clear();
   };
-
   config->printTiming(printCallback);
+
+  if (config->shouldTrace())
+    config->printTrace([&](raw_ostream &os) { printTrace(os); });
+
+  // Reset the timing state.
+  threadStates.clear();
+}
+
+/// Print how busy the threads that ran pipelines for parallel passes were.
+void PassTiming::printThreadUtilization(raw_ostream &os) {
+  using Seconds = std::chrono::duration<double>;
+
+  // Worker threads run the pipelines spawned by parallel passes on other
+  // threads; the parallel time is how long those passes took in total.
+  double parallelTime = 0, totalBusyTime = 0, maxBusyTime = 0;
+  SmallVector<ThreadTimingState *, 8> workers;
+  for (auto &state : threadStates) {
+    parallelTime += Seconds(state->parallelTime).count();
+    if (!state->numPipelines)
+      continue;
+    double busyTime = Seconds(state->busyTime).count();
+    totalBusyTime += busyTime;
+    maxBusyTime = std::max(maxBusyTime, busyTime);
+    workers.push_back(state.get());
+  }
+  if (workers.empty() || parallelTime == 0)
+    return;
+
+  constexpr StringLiteral description = "... Thread utilization report ...";
+  os << "\n===" << std::string(73, '-') << "===\n";
+  os.indent((80 - description.size()) / 2) << description << '\n';
+  os << "===" << std::string(73, '-') << "===\n";
+
+  // The effective parallelism is the speedup over running the pipelines on a
+  // single thread, and the imbalance how much longer the busiest worker ran
+  // than the average worker.
+  double meanBusyTime = totalBusyTime / workers.size();
+  os << llvm::format("  Parallel Wall Time: %5.4f seconds\n", parallelTime);
+  os << "  Worker Threads: " << workers.size() << "\n";
+  os << llvm::format("  Effective Parallelism: %5.2f\n",
+                     totalBusyTime / parallelTime);
+  os << llvm::format("  Load Imbalance (max / mean busy time): %5.2f\n\n",
+                     maxBusyTime / meanBusyTime);
+
+  os << "   ---Busy Time---   ---Idle Time---  Pipelines  --- Thread ---\n";
+  for (ThreadTimingState *state : workers) {
+    double busyTime = Seconds(state->busyTime).count();
+    double idleTime = std::max(parallelTime - busyTime, 0.0);
+    os << llvm::format("  %7.4f (%5.1f%%)  %7.4f (%5.1f%%)  %9u  %u\n",
+                       busyTime, 100.0 * busyTime / parallelTime, idleTime,
+                       100.0 * idleTime / parallelTime, state->numPipelines,
+                       state->index);
+  }
+}
+
+/// Print the recorded events in the Chrome trace event format, which can be
+/// loaded into chrome://tracing.
+void PassTiming::printTrace(raw_ostream &os) {
+  using Microseconds = std::chrono::duration<double, std::micro>;
+
+  llvm::json::OStream json(os);
+  json.object([&] {
+    json.attributeArray("traceEvents", [&] {
+      for (auto &state : threadStates) {
+        for (const TraceEvent &event : state->events) {
+          json.object([&] {
+            json.attribute("name", event.name);
+            json.attribute("ph", "X");
+            json.attribute("pid", 0);
+            json.attribute("tid", int64_t(state->index));
+            json.attribute(
+                "ts", Microseconds(event.start - traceStartTime).count());
+            json.attribute("dur",
+                           Microseconds(event.end - event.start).count());
+          });
+        }
+      }
+    });
+  });
+  os << "\n";
 }
 
 // The default implementation for printTiming uses
@@ -381,6 +569,18 @@ void PassManager::PassTimingConfig::printTiming(PrintCallbackFn printCallback) {
   printCallback(*llvm::CreateInfoOutputFile());
 }
 
+// The default implementation for printTrace writes to the trace file.
+void PassManager::PassTimingConfig::printTrace(PrintCallbackFn printCallback) {
+  std::error_code ec;
+  llvm::raw_fd_ostream os(traceFile, ec, llvm::sys::fs::OF_Text);
+  if (ec) {
+    llvm::errs() << "error: could not open pass timing trace file '"
+                 << traceFile << "': " << ec.message() << "\n";
+    return;
+  }
+  printCallback(os);
+}
+
 /// Print the timing result in list mode.
 void PassTiming::printResultsAsList(raw_ostream &os, Timer *root,
                                     TimeRecord totalTime) {
@@ -14,6 +14,8 @@
 #include "mlir/Rewrite/PatternApplicator.h"
 #include "ByteCode.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
 
 using namespace mlir;
 using namespace mlir::detail;
@@ -32,10 +34,21 @@ PatternApplicator::~PatternApplicator() {}
 
 void PatternApplicator::applyCostModel(CostModel model) {
   // Apply the cost model to the bytecode patterns first, and then the native
-  // patterns.
+  // patterns. Record the roots of the PDL patterns that may still match, so
+  // that the PDL matcher is only run on operations that they may match.
+  pdlRootKinds.clear();
+  hasAnyOpPDLPattern = false;
   if (const PDLByteCode *bytecode = frozenPatternList.getPDLByteCode()) {
-    for (auto it : llvm::enumerate(bytecode->getPatterns()))
-      mutableByteCodeState->updatePatternBenefit(it.index(), model(it.value()));
+    for (auto it : llvm::enumerate(bytecode->getPatterns())) {
+      PatternBenefit benefit = model(it.value());
+      mutableByteCodeState->updatePatternBenefit(it.index(), benefit);
+      if (benefit.isImpossibleToMatch())
+        continue;
+      if (Optional<OperationName> rootKind = it.value().getRootKind())
+        pdlRootKinds.insert(*rootKind);
+      else
+        hasAnyOpPDLPattern = true;
+    }
   }
 
   // Separate patterns by root kind to simplify lookup later on.
@@ -118,7 +131,7 @@ LogicalResult PatternApplicator::matchAndRewrite(
   // conflicts.
   SmallVector<PDLByteCode::MatchResult, 4> pdlMatches;
   const PDLByteCode *bytecode = frozenPatternList.getPDLByteCode();
-  if (bytecode)
+  if (bytecode && mayMatchPDLPattern(op))
     bytecode->match(op, rewriter, pdlMatches, *mutableByteCodeState);
 
   // Check to see if there are patterns matching this specific operation type.
@@ -133,24 +146,36 @@ LogicalResult PatternApplicator::matchAndRewrite(
   auto anyIt = anyOpPatterns.begin(), anyE = anyOpPatterns.end();
   auto pdlIt = pdlMatches.begin(), pdlE = pdlMatches.end();
   while (true) {
-    // Find the next pattern with the highest benefit.
+    // Find the next pattern with the highest benefit. Only the iterator of the
+    // selected pattern is advanced, so that the patterns that lose out are
+    // still tried afterwards.
     const Pattern *bestPattern = nullptr;
     const PDLByteCode::MatchResult *pdlMatch = nullptr;
+    enum { OpPattern, AnyOpPattern, PDLPattern } bestKind = OpPattern;
     /// Operation specific patterns.
     if (opIt != opE)
-      bestPattern = *(opIt++);
+      bestPattern = *opIt;
     /// Operation agnostic patterns.
     if (anyIt != anyE &&
-        (!bestPattern || bestPattern->getBenefit() < (*anyIt)->getBenefit()))
-      bestPattern = *(anyIt++);
+        (!bestPattern || bestPattern->getBenefit() < (*anyIt)->getBenefit())) {
+      bestPattern = *anyIt;
+      bestKind = AnyOpPattern;
+    }
     /// PDL patterns.
     if (pdlIt != pdlE &&
         (!bestPattern || bestPattern->getBenefit() < pdlIt->benefit)) {
       pdlMatch = pdlIt;
-      bestPattern = (pdlIt++)->pattern;
+      bestPattern = pdlIt->pattern;
+      bestKind = PDLPattern;
     }
     if (!bestPattern)
       break;
+    if (bestKind == OpPattern)
+      ++opIt;
+    else if (bestKind == AnyOpPattern)
+      ++anyIt;
+    else
+      ++pdlIt;
 
     // Check that the pattern can be applied.
     if (canApply && !canApply(*bestPattern))
@@ -161,12 +186,21 @@ LogicalResult PatternApplicator::matchAndRewrite(
     // match has already been performed, we just need to rewrite.
     rewriter.setInsertionPoint(op);
     LogicalResult result = success();
+    auto startTime = collectStatistics
+                         ? std::chrono::steady_clock::now()
+                         : std::chrono::steady_clock::time_point();
     if (pdlMatch) {
       bytecode->rewrite(rewriter, *pdlMatch, *mutableByteCodeState);
     } else {
       result = static_cast<const RewritePattern *>(bestPattern)
                    ->matchAndRewrite(op, rewriter);
     }
+    if (collectStatistics) {
+      PatternStatistics &stats = statistics[bestPattern];
+      ++stats.numAttempts;
+      stats.numSuccesses += succeeded(result);
+      stats.time += std::chrono::steady_clock::now() - startTime;
+    }
     if (succeeded(result) && (!onSuccess || succeeded(onSuccess(*bestPattern))))
       return success();
 
@@ -176,3 +210,35 @@ LogicalResult PatternApplicator::matchAndRewrite(
   }
   return failure();
 }
+
+void PatternApplicator::printStatistics(raw_ostream &os) const {
+  // Sort the patterns by the time spent in them, breaking ties by name to
+  // keep the output deterministic.
+  using Entry = std::pair<const Pattern *, PatternStatistics>;
+  std::vector<Entry> entries(statistics.begin(), statistics.end());
+  llvm::sort(entries, [](const Entry &lhs, const Entry &rhs) {
+    if (lhs.second.time != rhs.second.time)
+      return lhs.second.time > rhs.second.time;
+    return lhs.first->getDebugName() < rhs.first->getDebugName();
+  });
+
+  os << "===" << std::string(73, '-') << "===\n"
+     << "  Pattern statistics\n"
+     << "===" << std::string(73, '-') << "===\n"
+     << "  Time (ms)   Attempts  Successes  Pattern\n";
+  for (const Entry &entry : entries) {
+    const Pattern &pattern = *entry.first;
+    const PatternStatistics &stats = entry.second;
+    os << llvm::format("  %9.3f  %9u  %9u  ",
+                       std::chrono::duration<double, std::milli>(stats.time)
+                           .count(),
+                       stats.numAttempts, stats.numSuccesses);
+    if (!pattern.getDebugName().empty())
+      os << pattern.getDebugName();
+    else
+      os << "<unnamed>";
+    if (Optional<OperationName> rootKind = pattern.getRootKind())
+      os << " (" << rootKind->getStringRef() << ")";
+    os << "\n";
+  }
+}
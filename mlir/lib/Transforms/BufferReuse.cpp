@@ -0,0 +1,340 @@
+//===- BufferReuse.cpp - Share storage among non-interfering buffers ------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a pass that lets heap-allocated buffers whose live
+// ranges do not overlap share storage. The buffers of a block are assigned to
+// slots of a single arena allocation, such that the buffers of a slot are
+// never live at the same time, and each buffer is replaced by a view into its
+// slot. The size of a slot is the maximum size of its buffers, which is
+// computed at runtime for buffers with dynamic shapes.
+//
+// The live range of a buffer is the range of operations of its block from
+// its allocation to the last use of any of its aliases. Only buffers that are
+// deallocated in their block, and whose aliases are all used within that
+// block, are considered. Hence, this pass is expected to run after the
+// BufferDeallocation pass.
+//
+//===----------------------------------------------------------------------===//
+
+#include "PassDetail.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Transforms/BufferUtils.h"
+#include "mlir/Transforms/Passes.h"
+#include "llvm/ADT/MapVector.h"
+
+using namespace mlir;
+
+namespace {
+
+/// A buffer whose storage may be shared, with its live range given by the
+/// positions of operations in its block.
+struct BufferCandidate {
+  AllocOp alloc;
+  Operation *dealloc;
+  /// The last operation of the block in the live range.
+  Operation *lastUse;
+  unsigned start;
+  unsigned end;
+  /// The size in bytes of a static buffer, or -1 if the shape is dynamic.
+  int64_t staticSize;
+};
+
+/// A slot of the arena, holding buffers with disjoint live ranges.
+struct ArenaSlot {
+  SmallVector<BufferCandidate *, 4> buffers;
+  /// The end of the live range of the last buffer assigned to the slot.
+  unsigned end;
+  /// The size in bytes of the slot, or -1 if one of its buffers is dynamic.
+  int64_t staticSize;
+};
+
+//===----------------------------------------------------------------------===//
+// BufferReuse
+//===----------------------------------------------------------------------===//
+
+/// Assigns the buffers of each block to the slots of an arena allocation.
+class BufferReuse : BufferPlacementTransformationBase {
+public:
+  BufferReuse(Operation *op, unsigned alignment, unsigned bitwidthOfIndexType)
+      : BufferPlacementTransformationBase(op), alignment(alignment),
+        bitwidthOfIndexType(bitwidthOfIndexType) {}
+
+  /// Shares the storage of the buffers of each block.
+  void reuse() {
+    llvm::MapVector<Block *, SmallVector<BufferCandidate, 8>> candidates;
+    DenseMap<Block *, DenseMap<Operation *, unsigned>> positions;
+    for (BufferPlacementAllocs::AllocEntry &entry : allocs) {
+      Value allocValue = std::get<0>(entry);
+      Operation *dealloc = std::get<1>(entry);
+      Block *block = allocValue.getParentBlock();
+      auto &blockPositions = positions[block];
+      if (blockPositions.empty()) {
+        unsigned position = 0;
+        for (Operation &op : *block)
+          blockPositions[&op] = position++;
+      }
+      BufferCandidate candidate;
+      if (succeeded(analyze(allocValue, dealloc, blockPositions, candidate)))
+        candidates[block].push_back(candidate);
+    }
+    for (auto &it : candidates)
+      reuse(it.first, it.second);
+  }
+
+private:
+  /// Returns the size in bytes of the elements of the given type, or None if
+  /// the elements cannot be placed in the arena.
+  Optional<int64_t> getElementSize(Type elementType) {
+    unsigned bitwidth;
+    if (elementType.isIndex())
+      bitwidth = bitwidthOfIndexType;
+    else if (elementType.isIntOrFloat())
+      bitwidth = elementType.getIntOrFloatBitWidth();
+    else
+      return llvm::None;
+    if (bitwidth % 8 != 0)
+      return llvm::None;
+    return bitwidth / 8;
+  }
+
+  /// Checks whether the given allocation can be placed in the arena of its
+  /// block, and computes its live range.
+  LogicalResult analyze(Value allocValue, Operation *dealloc,
+                        const DenseMap<Operation *, unsigned> &blockPositions,
+                        BufferCandidate &candidate) {
+    auto allocOp = allocValue.getDefiningOp<AllocOp>();
+    Block *block = allocValue.getParentBlock();
+    if (!allocOp || !dealloc || dealloc->getBlock() != block)
+      return failure();
+    MemRefType type = allocOp.getType();
+    Optional<int64_t> elementSize = getElementSize(type.getElementType());
+    if (!elementSize || !type.getAffineMaps().empty() ||
+        type.getMemorySpace() != 0 ||
+        allocOp.alignment().getValueOr(0) > alignment)
+      return failure();
+
+    // The live range spans from the allocation to the last use of an alias
+    // in the block. All uses must be nested in the block, and the buffer
+    // must not be freed through another alias.
+    unsigned start = blockPositions.lookup(allocOp);
+    unsigned end = start;
+    Operation *lastUse = allocOp;
+    for (Value alias : aliases.resolve(allocValue)) {
+      for (Operation *user : alias.getUsers()) {
+        if (user == dealloc)
+          continue;
+        Operation *ancestor = block->findAncestorOpInBlock(*user);
+        if (!ancestor || isa<DeallocOp>(user))
+          return failure();
+        unsigned position = blockPositions.lookup(ancestor);
+        if (position > end) {
+          end = position;
+          lastUse = ancestor;
+        }
+      }
+    }
+
+    candidate.alloc = allocOp;
+    candidate.dealloc = dealloc;
+    candidate.lastUse = lastUse;
+    candidate.start = start;
+    candidate.end = end;
+    candidate.staticSize =
+        type.hasStaticShape() ? type.getNumElements() * *elementSize : -1;
+    return success();
+  }
+
+  /// Generates the size in bytes of the given buffer at the insertion point
+  /// of the builder.
+  Value createSize(OpBuilder &builder, BufferCandidate &candidate) {
+    Location loc = candidate.alloc.getLoc();
+    if (candidate.staticSize >= 0)
+      return builder.create<ConstantIndexOp>(loc, candidate.staticSize);
+    MemRefType type = candidate.alloc.getType();
+    Value size = builder.create<ConstantIndexOp>(
+        loc, *getElementSize(type.getElementType()));
+    auto dynamicSizes = candidate.alloc.getDynamicSizes();
+    unsigned dynamicDim = 0;
+    for (int64_t dim : type.getShape()) {
+      Value dimSize;
+      if (dim == ShapedType::kDynamicSize)
+        dimSize = dynamicSizes[dynamicDim++];
+      else
+        dimSize = builder.create<ConstantIndexOp>(loc, dim);
+      size = builder.createOrFold<MulIOp>(loc, size, dimSize);
+    }
+    return size;
+  }
+
+  /// Assigns the given buffers of the block to arena slots, in order of
+  /// their allocation. A buffer is assigned to a slot whose buffers are no
+  /// longer live, preferring the smallest static slot that is large enough,
+  /// and otherwise the largest one. As the live ranges are intervals, this
+  /// uses the minimal number of slots.
+  SmallVector<ArenaSlot, 8>
+  assignSlots(MutableArrayRef<BufferCandidate> buffers) {
+    SmallVector<ArenaSlot, 8> slots;
+    for (BufferCandidate &buffer : buffers) {
+      ArenaSlot *best = nullptr;
+      auto isBetter = [&](const ArenaSlot &slot) {
+        if (!best)
+          return true;
+        // Treat dynamic sizes as unbounded.
+        uint64_t size = slot.staticSize;
+        uint64_t bestSize = best->staticSize;
+        uint64_t bufferSize = buffer.staticSize;
+        if (bestSize >= bufferSize)
+          return size >= bufferSize && size < bestSize;
+        return size > bestSize;
+      };
+      for (ArenaSlot &slot : slots)
+        if (slot.end < buffer.start && isBetter(slot))
+          best = &slot;
+      if (!best) {
+        slots.push_back({{}, buffer.end, buffer.staticSize});
+        best = &slots.back();
+      } else if (best->staticSize >= 0) {
+        best->staticSize = buffer.staticSize < 0
+                               ? -1
+                               : std::max(best->staticSize, buffer.staticSize);
+      }
+      best->buffers.push_back(&buffer);
+      best->end = buffer.end;
+    }
+    return slots;
+  }
+
+  /// Replaces the given buffers of the block with views into an arena.
+  void reuse(Block *block, SmallVectorImpl<BufferCandidate> &buffers) {
+    // The arena is allocated before the first buffer. Dynamic buffers are
+    // only placed in the arena if their sizes are known at that point.
+    llvm::sort(buffers, [](const BufferCandidate &lhs,
+                           const BufferCandidate &rhs) {
+      return lhs.start < rhs.start;
+    });
+    while (true) {
+      if (buffers.size() < 2)
+        return;
+      Operation *arenaPosition = buffers.front().alloc;
+      auto isAvailable = [&](Value size) {
+        Operation *def = size.getDefiningOp();
+        return !def || def->getBlock() != block ||
+               def->isBeforeInBlock(arenaPosition);
+      };
+      auto it = llvm::remove_if(buffers, [&](const BufferCandidate &buffer) {
+        return !llvm::all_of(buffer.alloc.getDynamicSizes(), isAvailable);
+      });
+      if (it == buffers.end())
+        break;
+      buffers.erase(it, buffers.end());
+    }
+
+    SmallVector<ArenaSlot, 8> slots = assignSlots(buffers);
+    if (slots.size() == buffers.size())
+      return;
+
+    // Compute the offset of each slot, with slots aligned to the alignment of
+    // the arena.
+    Operation *firstAlloc = buffers.front().alloc;
+    Location loc = firstAlloc->getLoc();
+    OpBuilder builder(firstAlloc);
+    Value arenaSize = builder.create<ConstantIndexOp>(loc, 0);
+    Value alignMinusOne = builder.create<ConstantIndexOp>(loc, alignment - 1);
+    Value alignMask = builder.create<ConstantIndexOp>(
+        loc, -static_cast<int64_t>(alignment));
+    DenseMap<Operation *, Value> offsets;
+    for (ArenaSlot &slot : slots) {
+      Value slotSize;
+      for (BufferCandidate *buffer : slot.buffers) {
+        offsets[buffer->alloc] = arenaSize;
+        Value size = createSize(builder, *buffer);
+        if (!slotSize) {
+          slotSize = size;
+          continue;
+        }
+        Value cmp = builder.createOrFold<CmpIOp>(loc, CmpIPredicate::ult,
+                                                 slotSize, size);
+        slotSize = builder.createOrFold<SelectOp>(loc, cmp, size, slotSize);
+      }
+      Value padded = builder.createOrFold<AddIOp>(loc, slotSize, alignMinusOne);
+      Value aligned = builder.createOrFold<AndOp>(loc, padded, alignMask);
+      arenaSize = builder.createOrFold<AddIOp>(loc, arenaSize, aligned);
+    }
+
+    // Allocate the arena, replace the buffers by views and free the arena
+    // after the last use of any buffer.
+    IntegerAttr alignmentAttr = builder.getI64IntegerAttr(alignment);
+    Value arena;
+    if (auto constantSize = arenaSize.getDefiningOp<ConstantIndexOp>()) {
+      auto arenaType =
+          MemRefType::get({constantSize.getValue()}, builder.getIntegerType(8));
+      arena = builder.create<AllocOp>(loc, arenaType, alignmentAttr);
+    } else {
+      auto arenaType = MemRefType::get({ShapedType::kDynamicSize},
+                                       builder.getIntegerType(8));
+      arena = builder.create<AllocOp>(loc, arenaType, arenaSize, alignmentAttr);
+    }
+    Operation *lastUse = firstAlloc;
+    unsigned end = 0;
+    for (BufferCandidate &buffer : buffers) {
+      AllocOp allocOp = buffer.alloc;
+      builder.setInsertionPoint(allocOp);
+      Value view = builder.create<ViewOp>(allocOp.getLoc(), allocOp.getType(),
+                                          arena, offsets.lookup(allocOp),
+                                          allocOp.getDynamicSizes());
+      allocOp.replaceAllUsesWith(view);
+      if (buffer.end >= end) {
+        end = buffer.end;
+        lastUse = buffer.lastUse;
+      }
+    }
+    builder.setInsertionPointAfter(lastUse);
+    builder.create<DeallocOp>(loc, arena);
+    for (BufferCandidate &buffer : buffers) {
+      buffer.dealloc->erase();
+      buffer.alloc.erase();
+    }
+  }
+
+  /// The alignment in bytes of the arena and of its slots.
+  unsigned alignment;
+
+  /// The bitwidth of the index type, used for size computations.
+  unsigned bitwidthOfIndexType;
+};
+
+//===----------------------------------------------------------------------===//
+// BufferReusePass
+//===----------------------------------------------------------------------===//
+
+/// The buffer reuse pass that lets buffers with disjoint live ranges share
+/// storage.
+struct BufferReusePass : BufferReuseBase<BufferReusePass> {
+
+  BufferReusePass(unsigned alignment, unsigned bitwidthOfIndexType) {
+    this->alignment = alignment;
+    this->bitwidthOfIndexType = bitwidthOfIndexType;
+  }
+
+  void runOnFunction() override {
+    if (alignment == 0 || !llvm::isPowerOf2_32(alignment)) {
+      getFunction().emitError("buffer reuse alignment must be a power of 2");
+      return signalPassFailure();
+    }
+    BufferReuse optimizer(getFunction(), alignment, bitwidthOfIndexType);
+    optimizer.reuse();
+  }
+};
+
+} // end anonymous namespace
+
+std::unique_ptr<Pass>
+mlir::createBufferReusePass(unsigned alignment, unsigned bitwidthOfIndexType) {
+  return std::make_unique<BufferReusePass>(alignment, bitwidthOfIndexType);
+}
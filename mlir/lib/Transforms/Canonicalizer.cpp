@@ -31,8 +31,12 @@ struct Canonicalizer : public CanonicalizerBase<Canonicalizer> {
     for (auto *op : context->getRegisteredOperations())
       op->getCanonicalizationPatterns(patterns, context);
 
+    GreedyRewriteConfig config;
+    config.rescanRegionsOnChange = rescanRegions;
+    config.maxIterations = maxIterations;
+    config.printPatternStatistics = printPatternStatistics;
     Operation *op = getOperation();
-    applyPatternsAndFoldGreedily(op->getRegions(), std::move(patterns));
+    applyPatternsAndFoldGreedily(op->getRegions(), std::move(patterns), config);
   }
 };
 } // end anonymous namespace
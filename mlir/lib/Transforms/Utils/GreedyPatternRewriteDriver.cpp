@@ -37,15 +37,29 @@ namespace {
 class GreedyPatternRewriteDriver : public PatternRewriter {
 public:
   explicit GreedyPatternRewriteDriver(MLIRContext *ctx,
-                                      const FrozenRewritePatternList &patterns)
-      : PatternRewriter(ctx), matcher(patterns), folder(ctx) {
+                                      const FrozenRewritePatternList &patterns,
+                                      const GreedyRewriteConfig &config)
+      : PatternRewriter(ctx), matcher(patterns), folder(ctx), config(config) {
     worklist.reserve(64);
 
     // Apply a simple cost model based solely on pattern benefit.
     matcher.applyDefaultCostModel();
+    matcher.enableStatistics(config.printPatternStatistics);
   }
 
-  bool simplify(MutableArrayRef<Region> regions, int maxIterations);
+  bool simplify(MutableArrayRef<Region> regions);
+
+  /// Print the statistics of the patterns applied by this driver, if enabled.
+  void printStatistics() {
+    if (!config.printPatternStatistics)
+      return;
+    // Print into a buffer first, so that the output of drivers running on
+    // different threads isn't interleaved.
+    std::string str;
+    llvm::raw_string_ostream os(str);
+    matcher.printStatistics(os);
+    llvm::errs() << os.str();
+  }
 
   void addToWorklist(Operation *op) {
     // Check to see if the worklist already contains this op.
@@ -83,6 +97,9 @@ protected:
   // inserted ops are added to the worklist for processing.
   void notifyOperationInserted(Operation *op) override { addToWorklist(op); }
 
+  // An operation that was modified in place may now be simplified further.
+  void finalizeRootUpdate(Operation *op) override { addToWorklist(op); }
+
   // If an operation is about to be removed, make sure it is not in our
   // worklist anymore because we'd get dangling references to it.
   void notifyOperationRemoved(Operation *op) override {
@@ -133,22 +150,26 @@ private:
 
   /// Non-pattern based folder for operations.
   OperationFolder folder;
+
+  /// The configuration of the driver.
+  const GreedyRewriteConfig &config;
 };
 } // end anonymous namespace
 
 /// Performs the rewrites while folding and erasing any dead ops. Returns true
 /// if the rewrite converges in `maxIterations`.
-bool GreedyPatternRewriteDriver::simplify(MutableArrayRef<Region> regions,
-                                          int maxIterations) {
+bool GreedyPatternRewriteDriver::simplify(MutableArrayRef<Region> regions) {
   // Add the given operation to the worklist.
   auto collectOps = [this](Operation *op) { addToWorklist(op); };
 
-  bool changed = false;
-  int i = 0;
+  bool changed = false, scanRegions = true;
+  unsigned i = 0;
   do {
     // Add all nested operations to the worklist.
-    for (auto &region : regions)
-      region.walk(collectOps);
+    if (scanRegions) {
+      for (auto &region : regions)
+        region.walk(collectOps);
+    }
 
     // These are scratch vectors used in the folding loop below.
     SmallVector<Value, 8> originalOperands, resultValues;
@@ -202,11 +223,20 @@ bool GreedyPatternRewriteDriver::simplify(MutableArrayRef<Region> regions,
 
     // After applying patterns, make sure that the CFG of each of the regions is
     // kept up to date.
-    if (succeeded(simplifyRegions(regions))) {
+    bool regionsChanged = succeeded(simplifyRegions(regions));
+    if (regionsChanged) {
       folder.clear();
       changed = true;
     }
-  } while (changed && ++i < maxIterations);
+
+    // Without rescanning, the changes made by the patterns were already
+    // processed through the worklist, so only a change to the regions requires
+    // another iteration.
+    if (!config.rescanRegionsOnChange) {
+      changed = regionsChanged;
+      scanRegions = regionsChanged;
+    }
+  } while (changed && ++i < config.maxIterations);
   // Whether the rewrite converges, i.e. wasn't changed in the last iteration.
   return !changed;
 }
@@ -240,6 +270,20 @@ LogicalResult
 mlir::applyPatternsAndFoldGreedily(MutableArrayRef<Region> regions,
                                    const FrozenRewritePatternList &patterns,
                                    unsigned maxIterations) {
+  GreedyRewriteConfig config;
+  config.maxIterations = maxIterations;
+  return applyPatternsAndFoldGreedily(regions, patterns, config);
+}
+LogicalResult
+mlir::applyPatternsAndFoldGreedily(Operation *op,
+                                   const FrozenRewritePatternList &patterns,
+                                   const GreedyRewriteConfig &config) {
+  return applyPatternsAndFoldGreedily(op->getRegions(), patterns, config);
+}
+LogicalResult
+mlir::applyPatternsAndFoldGreedily(MutableArrayRef<Region> regions,
+                                   const FrozenRewritePatternList &patterns,
+                                   const GreedyRewriteConfig &config) {
   if (regions.empty())
     return success();
 
@@ -254,11 +298,12 @@ mlir::applyPatternsAndFoldGreedily(MutableArrayRef<Region> regions,
          "patterns can only be applied to operations IsolatedFromAbove");
 
   // Start the pattern driver.
-  GreedyPatternRewriteDriver driver(regions[0].getContext(), patterns);
-  bool converged = driver.simplify(regions, maxIterations);
+  GreedyPatternRewriteDriver driver(regions[0].getContext(), patterns, config);
+  bool converged = driver.simplify(regions);
+  driver.printStatistics();
   LLVM_DEBUG(if (!converged) {
     llvm::dbgs() << "The pattern rewrite doesn't converge after scanning "
-                 << maxIterations << " times";
+                 << config.maxIterations << " times";
   });
   return success(converged);
 }
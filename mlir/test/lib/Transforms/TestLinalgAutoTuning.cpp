@@ -0,0 +1,254 @@
+//===- TestLinalgAutoTuning.cpp - Test Linalg codegen strategy tuning -----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a pass that tunes the codegen strategy of Linalg ops by
+// JIT-compiling and running each candidate configuration on the host.
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Conversion/AffineToStandard/AffineToStandard.h"
+#include "mlir/Conversion/SCFToStandard/SCFToStandard.h"
+#include "mlir/Conversion/StandardToLLVM/ConvertStandardToLLVMPass.h"
+#include "mlir/Conversion/VectorToLLVM/ConvertVectorToLLVM.h"
+#include "mlir/Conversion/VectorToSCF/VectorToSCF.h"
+#include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "mlir/Dialect/Linalg/IR/LinalgOps.h"
+#include "mlir/Dialect/Linalg/Passes.h"
+#include "mlir/Dialect/Linalg/Transforms/AutoTuning.h"
+#include "mlir/Dialect/SCF/SCF.h"
+#include "mlir/Dialect/StandardOps/IR/Ops.h"
+#include "mlir/Dialect/Vector/VectorOps.h"
+#include "mlir/ExecutionEngine/ExecutionEngine.h"
+#include "mlir/ExecutionEngine/OptUtils.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Pass/PassManager.h"
+#include "mlir/Support/FileUtilities.h"
+
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ToolOutputFile.h"
+
+#include <chrono>
+
+using namespace mlir;
+using namespace mlir::linalg;
+
+/// Append to `module` a function named `mainName` that allocates and
+/// initializes buffers for the arguments of `kernel`, and calls it
+/// `numRepetitions` times. Returns failure if the arguments of `kernel` cannot
+/// be initialized.
+static LogicalResult buildBenchmarkMain(ModuleOp module, FuncOp kernel,
+                                        StringRef mainName,
+                                        unsigned numRepetitions) {
+  Location loc = kernel.getLoc();
+  OpBuilder b(module.getBodyRegion());
+  b.setInsertionPoint(module.getBody()->getTerminator());
+  auto mainFunc = b.create<FuncOp>(loc, mainName, b.getFunctionType({}, {}));
+  b.setInsertionPointToStart(mainFunc.addEntryBlock());
+
+  SmallVector<Value, 4> buffers;
+  for (Type type : kernel.getType().getInputs()) {
+    auto memrefType = type.cast<MemRefType>();
+    Type elementType = memrefType.getElementType();
+    Attribute one;
+    if (elementType.isa<FloatType>())
+      one = b.getFloatAttr(elementType, 1.0);
+    else if (elementType.isSignlessIntOrIndex())
+      one = b.getIntegerAttr(elementType, 1);
+    else
+      return failure();
+    Value buffer = b.create<AllocOp>(loc, memrefType);
+    b.create<FillOp>(loc, buffer, b.create<ConstantOp>(loc, one));
+    buffers.push_back(buffer);
+  }
+
+  Value lowerBound = b.create<ConstantIndexOp>(loc, 0);
+  Value upperBound = b.create<ConstantIndexOp>(loc, numRepetitions);
+  Value step = b.create<ConstantIndexOp>(loc, 1);
+  auto loop = b.create<scf::ForOp>(loc, lowerBound, upperBound, step);
+  b.setInsertionPointToStart(loop.getBody());
+  b.create<CallOp>(loc, kernel, buffers);
+  b.setInsertionPointAfter(loop);
+  for (Value buffer : buffers)
+    b.create<DeallocOp>(loc, buffer);
+  b.create<ReturnOp>(loc);
+  return success();
+}
+
+/// Lower `module` to the LLVM dialect, JIT-compile it and return the fastest
+/// time per call of `kernelName` among `numMeasurements` runs.
+static Optional<double> benchmarkKernel(ModuleOp module, StringRef kernelName,
+                                        unsigned numRepetitions,
+                                        unsigned numMeasurements) {
+  const char *mainName = "linalg_autotune_main";
+  auto kernel = module.lookupSymbol<FuncOp>(kernelName);
+  if (!kernel || failed(buildBenchmarkMain(module, kernel, mainName,
+                                           numRepetitions)))
+    return llvm::None;
+
+  PassManager pm(module.getContext());
+  pm.addNestedPass<FuncOp>(createConvertLinalgToLoopsPass());
+  pm.addNestedPass<FuncOp>(createConvertVectorToSCFPass());
+  pm.addPass(createLowerAffinePass());
+  pm.addPass(createLowerToCFGPass());
+  pm.addPass(createConvertVectorToLLVMPass());
+  pm.addPass(createLowerToLLVMPass());
+  if (failed(pm.run(module)))
+    return llvm::None;
+
+  auto optPipeline = makeOptimizingTransformer(
+      /*optLevel=*/3, /*sizeLevel=*/0, /*targetMachine=*/nullptr);
+  auto expectedEngine = ExecutionEngine::create(
+      module, /*llvmModuleBuilder=*/nullptr, optPipeline,
+      /*jitCodeGenOptLevel=*/llvm::None, /*sharedLibPaths=*/{},
+      /*enableObjectCache=*/false);
+  if (!expectedEngine) {
+    llvm::consumeError(expectedEngine.takeError());
+    return llvm::None;
+  }
+  auto expectedMain = (*expectedEngine)->lookup(mainName);
+  if (!expectedMain) {
+    llvm::consumeError(expectedMain.takeError());
+    return llvm::None;
+  }
+
+  // Run once to warm up the caches before measuring.
+  void (*mainFn)(void **) = *expectedMain;
+  mainFn(nullptr);
+  Optional<double> bestTime;
+  for (unsigned i = 0; i < numMeasurements; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    mainFn(nullptr);
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    double time = elapsed.count() / numRepetitions;
+    if (!bestTime || time < *bestTime)
+      bestTime = time;
+  }
+  return bestTime;
+}
+
+namespace {
+struct TestLinalgAutoTuning
+    : public PassWrapper<TestLinalgAutoTuning, OperationPass<ModuleOp>> {
+  TestLinalgAutoTuning() = default;
+  TestLinalgAutoTuning(const TestLinalgAutoTuning &pass) {}
+
+  void getDependentDialects(DialectRegistry &registry) const override {
+    // clang-format off
+    registry.insert<AffineDialect,
+                    linalg::LinalgDialect,
+                    LLVM::LLVMDialect,
+                    scf::SCFDialect,
+                    StandardOpsDialect,
+                    vector::VectorDialect>();
+    // clang-format on
+  }
+
+  void runOnOperation() override;
+
+  ListOption<int64_t> tileSizes{
+      *this, "tile-sizes", llvm::cl::MiscFlags::CommaSeparated,
+      llvm::cl::desc("Specifies the candidate tile sizes of each loop.")};
+  Option<unsigned> maxInterchangeLoops{
+      *this, "max-interchange-loops",
+      llvm::cl::desc("Explore the loop interchanges of ops with at most this "
+                     "number of loops."),
+      llvm::cl::init(3)};
+  Option<int64_t> maxVectorTileVolume{
+      *this, "max-vector-tile-volume",
+      llvm::cl::desc("Explore the vectorization of tiles with at most this "
+                     "number of points."),
+      llvm::cl::init(4096)};
+  Option<unsigned> maxNumConfigs{
+      *this, "max-configs",
+      llvm::cl::desc("The maximum number of configurations tried per op, 0 "
+                     "for no limit."),
+      llvm::cl::init(0)};
+  Option<unsigned> numRepetitions{
+      *this, "repetitions",
+      llvm::cl::desc("The number of calls of a kernel per measurement."),
+      llvm::cl::init(10)};
+  Option<unsigned> numMeasurements{
+      *this, "measurements",
+      llvm::cl::desc("The number of measurements of each configuration, the "
+                     "fastest one is kept."),
+      llvm::cl::init(3)};
+  Option<std::string> cacheFile{
+      *this, "cache-file",
+      llvm::cl::desc("A file holding the configurations already tuned, which "
+                     "is updated with the newly tuned ones."),
+      llvm::cl::init("")};
+};
+} // end anonymous namespace
+
+void TestLinalgAutoTuning::runOnOperation() {
+  llvm::InitializeNativeTarget();
+  llvm::InitializeNativeTargetAsmPrinter();
+
+  TuningCache cache;
+  std::string errorMessage;
+  if (!cacheFile.empty()) {
+    if (auto file = openInputFile(cacheFile.getValue(), &errorMessage)) {
+      if (failed(cache.parse(file->getBuffer()))) {
+        getOperation().emitError("malformed tuning cache: ")
+            << cacheFile.getValue();
+        return signalPassFailure();
+      }
+    }
+  }
+
+  TuningSearchSpace space;
+  if (!tileSizes.empty())
+    space.tileSizes.assign(tileSizes.begin(), tileSizes.end());
+  space.maxInterchangeLoops = maxInterchangeLoops;
+  space.maxVectorTileVolume = maxVectorTileVolume;
+  space.maxNumConfigs = maxNumConfigs;
+  unsigned repetitions = std::max(1u, numRepetitions.getValue());
+  unsigned measurements = std::max(1u, numMeasurements.getValue());
+  LinalgAutoTuner tuner(
+      space,
+      [&](ModuleOp module, StringRef kernelName) {
+        return benchmarkKernel(module, kernelName, repetitions, measurements);
+      },
+      cache);
+
+  getOperation().walk([&](LinalgOp op) {
+    Optional<TuningConfig> config = tuner.tune(op);
+    if (!config) {
+      op.emitRemark("could not be tuned");
+      return;
+    }
+    std::string str;
+    llvm::raw_string_ostream os(str);
+    config->print(os);
+    op.emitRemark("tuned configuration: ") << os.str();
+  });
+
+  if (cacheFile.empty())
+    return;
+  auto output = openOutputFile(cacheFile.getValue(), &errorMessage);
+  if (!output) {
+    getOperation().emitError(errorMessage);
+    return signalPassFailure();
+  }
+  cache.print(output->os());
+  output->keep();
+}
+
+namespace mlir {
+namespace test {
+void registerTestLinalgAutoTuning() {
+  PassRegistration<TestLinalgAutoTuning> testLinalgAutoTuningPass(
+      "test-linalg-autotuning",
+      "Test tuning the Linalg codegen strategy by benchmarking candidate "
+      "configurations with the ExecutionEngine.");
+}
+} // namespace test
+} // namespace mlir
@@ -0,0 +1,88 @@
+//===- BytecodeTest.cpp - MLIR Bytecode unit tests ------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Bytecode/BytecodeReader.h"
+#include "mlir/Bytecode/BytecodeWriter.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Parser.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "gtest/gtest.h"
+
+using namespace mlir;
+
+namespace {
+const char *const kIR = R"mlir(
+module {
+  func @foo(%arg0: i32) -> i32 {
+    %0 = "test.op"(%arg0) {attr = dense<[1, 2]> : tensor<2xi32>} : (i32) -> i32
+    "test.br"(%0)[^bb1] : (i32) -> ()
+  ^bb1(%1: i32):  // pred: ^bb0
+    "test.return"(%1) : (i32) -> ()
+  }
+  func private @bar() attributes {attr = [1.500000e+00 : f32, "str", unit]}
+}
+)mlir";
+
+std::string print(Operation *op) {
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  op->print(os);
+  return os.str();
+}
+
+TEST(Bytecode, RoundTrip) {
+  MLIRContext context;
+  context.allowUnregisteredDialects();
+  OwningModuleRef module = parseSourceString(kIR, &context);
+  ASSERT_TRUE(module);
+
+  std::string bytecode;
+  llvm::raw_string_ostream os(bytecode);
+  writeBytecodeToFile(*module, os);
+  os.flush();
+
+  llvm::MemoryBufferRef buffer(bytecode, "test");
+  ASSERT_TRUE(isBytecode(buffer));
+  Block block;
+  ASSERT_TRUE(succeeded(readBytecodeFile(buffer, &block, &context)));
+  ASSERT_EQ(block.getOperations().size(), 1u);
+  EXPECT_EQ(print(&block.front()), print(*module));
+}
+
+TEST(Bytecode, LazyLoading) {
+  MLIRContext context;
+  context.allowUnregisteredDialects();
+  OwningModuleRef module = parseSourceString(kIR, &context);
+  ASSERT_TRUE(module);
+
+  std::string bytecode;
+  llvm::raw_string_ostream os(bytecode);
+  writeBytecodeToFile(*module, os);
+  os.flush();
+
+  // The functions are left empty until they are materialized.
+  BytecodeReader reader(llvm::MemoryBufferRef(bytecode, "test"), &context,
+                        /*lazyLoad=*/true);
+  Block block;
+  ASSERT_TRUE(succeeded(reader.readTopLevel(&block)));
+  auto readModule = cast<ModuleOp>(&block.front());
+  for (FuncOp func : readModule.getOps<FuncOp>()) {
+    EXPECT_TRUE(reader.isMaterializable(func));
+    EXPECT_TRUE(func.getBody().empty());
+  }
+
+  FuncOp foo = readModule.lookupSymbol<FuncOp>("foo");
+  ASSERT_TRUE(succeeded(reader.materialize(foo)));
+  EXPECT_FALSE(reader.isMaterializable(foo));
+  EXPECT_EQ(foo.getBody().front().getOperations().size(), 2u);
+
+  ASSERT_TRUE(succeeded(reader.materializeAll()));
+  EXPECT_EQ(print(readModule), print(*module));
+}
+} // end namespace
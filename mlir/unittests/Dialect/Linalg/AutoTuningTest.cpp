@@ -0,0 +1,136 @@
+//===- AutoTuningTest.cpp - Linalg codegen strategy auto-tuning tests -----===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+#include "mlir/Dialect/Linalg/Transforms/AutoTuning.h"
+#include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/Linalg/IR/LinalgOps.h"
+#include "mlir/Dialect/SCF/SCF.h"
+#include "mlir/Dialect/StandardOps/IR/Ops.h"
+#include "mlir/Dialect/Vector/VectorOps.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Parser.h"
+#include "gtest/gtest.h"
+
+using namespace mlir;
+using namespace mlir::linalg;
+
+namespace {
+const char *const kMatmul = R"mlir(
+func @matmul(%a: memref<16x16xf32>, %b: memref<16x16xf32>,
+             %c: memref<16x16xf32>) {
+  linalg.matmul ins(%a, %b : memref<16x16xf32>, memref<16x16xf32>)
+               outs(%c : memref<16x16xf32>)
+  return
+}
+)mlir";
+
+struct AutoTuningTest : public ::testing::Test {
+  AutoTuningTest() {
+    context.loadDialect<AffineDialect, LinalgDialect, scf::SCFDialect,
+                        StandardOpsDialect, vector::VectorDialect>();
+    module = parseSourceString(kMatmul, &context);
+    module->walk([&](MatmulOp op) { matmul = op; });
+  }
+
+  MLIRContext context;
+  OwningModuleRef module;
+  LinalgOp matmul;
+};
+
+TuningSearchSpace getSearchSpace(unsigned maxInterchangeLoops,
+                                 int64_t maxVectorTileVolume) {
+  TuningSearchSpace space;
+  space.tileSizes = {4, 8, 16, 32};
+  space.maxInterchangeLoops = maxInterchangeLoops;
+  space.maxVectorTileVolume = maxVectorTileVolume;
+  return space;
+}
+
+TEST_F(AutoTuningTest, EnumerateTileSizes) {
+  // Each loop is either untiled, or tiled by 4 or 8.
+  auto configs = enumerateTuningConfigs(matmul, getSearchSpace(0, 0));
+  ASSERT_EQ(configs.size(), 27u);
+  EXPECT_EQ(configs.front(), TuningConfig());
+  for (const TuningConfig &config : configs) {
+    EXPECT_TRUE(config.interchange.empty());
+    EXPECT_FALSE(config.vectorize);
+  }
+}
+
+TEST_F(AutoTuningTest, EnumerateInterchanges) {
+  // A configuration with `n` tiled loops has `n!` distinct interchanges.
+  auto configs = enumerateTuningConfigs(matmul, getSearchSpace(3, 0));
+  EXPECT_EQ(configs.size(), 1u + 6u + 12u * 2u + 8u * 6u);
+}
+
+TEST_F(AutoTuningTest, EnumerateVectorization) {
+  // Only the tiles of 4x4x4 hold at most 64 points.
+  auto configs = enumerateTuningConfigs(matmul, getSearchSpace(0, 64));
+  ASSERT_EQ(configs.size(), 28u);
+  TuningConfig vectorized;
+  vectorized.tileSizes = {4, 4, 4};
+  vectorized.vectorize = true;
+  EXPECT_EQ(llvm::count(configs, vectorized), 1);
+
+  TuningSearchSpace space = getSearchSpace(0, 64);
+  space.maxNumConfigs = 5;
+  EXPECT_EQ(enumerateTuningConfigs(matmul, space).size(), 5u);
+}
+
+TEST_F(AutoTuningTest, CacheRoundTrip) {
+  TuningConfig config;
+  config.tileSizes = {8, 0, 4};
+  config.interchange = {2, 0, 1};
+  config.vectorize = true;
+
+  TuningCache cache;
+  cache.insert(getTuningKey(matmul), config);
+  cache.insert("other", TuningConfig());
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  cache.print(os);
+
+  TuningCache parsedCache;
+  ASSERT_TRUE(succeeded(parsedCache.parse(os.str())));
+  EXPECT_EQ(parsedCache.size(), 2u);
+  const TuningConfig *parsedConfig = parsedCache.lookup(getTuningKey(matmul));
+  ASSERT_NE(parsedConfig, nullptr);
+  EXPECT_EQ(*parsedConfig, config);
+  EXPECT_TRUE(failed(parsedCache.parse("key\ttile=1,x interchange= "
+                                       "vectorize=0")));
+}
+
+TEST_F(AutoTuningTest, TuneWithCache) {
+  // Report every candidate as faster than the previous ones, so that the last
+  // configuration that applies is the best.
+  unsigned numBenchmarks = 0;
+  bool lastWasTiled = false;
+  auto benchmark = [&](ModuleOp module, StringRef kernelName) {
+    EXPECT_TRUE(module.lookupSymbol<FuncOp>(kernelName));
+    lastWasTiled = module
+                       .walk([](scf::ForOp) { return WalkResult::interrupt(); })
+                       .wasInterrupted();
+    return Optional<double>(1.0 / ++numBenchmarks);
+  };
+
+  TuningSearchSpace space = getSearchSpace(0, 0);
+  space.tileSizes = {8};
+  TuningCache cache;
+  LinalgAutoTuner tuner(space, benchmark, cache);
+  Optional<TuningConfig> config = tuner.tune(matmul);
+  ASSERT_TRUE(config.hasValue());
+  EXPECT_EQ(numBenchmarks, 8u);
+  EXPECT_TRUE(lastWasTiled);
+  EXPECT_EQ(config->tileSizes, SmallVector<int64_t, 4>({8, 8, 8}));
+  EXPECT_EQ(cache.size(), 1u);
+
+  // The configuration of the op is now cached.
+  EXPECT_EQ(tuner.tune(matmul), config);
+  EXPECT_EQ(numBenchmarks, 8u);
+}
+} // end anonymous namespace
@@ -9,6 +9,7 @@
 #include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/Identifier.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "gtest/gtest.h"
 
 using namespace mlir;
@@ -192,4 +193,43 @@ TEST(DenseComplexTest, ComplexAPIntSplat) {
   testSplat(complexType, value);
 }
 
+TEST(DenseExternalTest, ExternalBuffer) {
+  MLIRContext context;
+  RankedTensorType shape =
+      RankedTensorType::get({4}, IntegerType::get(32, &context));
+  int32_t values[] = {1, 2, 3, 4};
+  ArrayRef<char> rawData(reinterpret_cast<const char *>(values),
+                         sizeof(values));
+  auto getBuffer = [&] {
+    return llvm::MemoryBuffer::getMemBufferCopy(
+        StringRef(rawData.data(), rawData.size()));
+  };
+
+  // The data of the attribute is referenced in place.
+  std::unique_ptr<llvm::MemoryBuffer> buffer = getBuffer();
+  const char *bufferStart = buffer->getBufferStart();
+  DenseElementsAttr external =
+      DenseElementsAttr::getFromExternalBuffer(shape, std::move(buffer));
+  ASSERT_TRUE(external);
+  EXPECT_TRUE(external.isExternal());
+  EXPECT_EQ(external.getRawData().data(), bufferStart);
+  auto externalValues = external.getValues<int32_t>();
+  EXPECT_EQ(std::vector<int32_t>(externalValues.begin(), externalValues.end()),
+            std::vector<int32_t>(std::begin(values), std::end(values)));
+
+  // External attributes are uniqued by their buffer, not by their contents.
+  DenseElementsAttr copy = DenseElementsAttr::getFromRawBuffer(
+      shape, rawData, /*isSplatBuffer=*/false);
+  EXPECT_FALSE(copy.isExternal());
+  EXPECT_NE(copy, external);
+  EXPECT_NE(DenseElementsAttr::getFromExternalBuffer(shape, getBuffer()),
+            external);
+
+  // Buffers that don't match the type are rejected.
+  RankedTensorType largerShape =
+      RankedTensorType::get({8}, IntegerType::get(32, &context));
+  EXPECT_FALSE(
+      DenseElementsAttr::getFromExternalBuffer(largerShape, getBuffer()));
+}
+
 } // end namespace
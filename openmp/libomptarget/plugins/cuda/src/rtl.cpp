@@ -14,9 +14,11 @@
 #include <cstddef>
 #include <cuda.h>
 #include <list>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "Debug.h"
@@ -262,6 +264,118 @@ public:
   }
 };
 
+// Caches the device allocations released by the offloading runtime so that
+// they can be reused by later allocations of a similar size. cuMemAlloc and
+// cuMemFree are expensive, and cuMemFree implicitly synchronizes the device,
+// which would serialize the transfers and kernels in flight on the streams.
+class MemoryPoolTy {
+  // Largest number of bytes a cached block may hold per requested byte
+  static constexpr const size_t MaxWasteFactor = 2;
+
+  int NumberOfDevices;
+  // The largest number of bytes cached per device, 0 disables the pool
+  size_t EnvPoolSize;
+  // Per-device pool mutex
+  std::vector<std::unique_ptr<std::mutex>> PoolMtx;
+  // Per-device cached blocks, sorted by size
+  std::vector<std::multimap<size_t, CUdeviceptr>> FreeBlocks;
+  // Per-device size of the blocks allocated through the pool
+  std::vector<std::unordered_map<CUdeviceptr, size_t>> BlockSizes;
+  // Per-device number of bytes held by the cached blocks
+  std::vector<size_t> CachedBytes;
+  // Reference to per-device data
+  std::vector<DeviceDataTy> &DeviceData;
+
+  // Free all of the cached blocks of a device. This function should be called
+  // with the device mutex and the context of the device set.
+  void releaseCachedBlocks(const int DeviceId) {
+    for (auto &Block : FreeBlocks[DeviceId]) {
+      checkResult(cuMemFree(Block.second), "Error returned from cuMemFree\n");
+      BlockSizes[DeviceId].erase(Block.second);
+    }
+    FreeBlocks[DeviceId].clear();
+    CachedBytes[DeviceId] = 0;
+  }
+
+public:
+  MemoryPoolTy(const int NumberOfDevices, std::vector<DeviceDataTy> &DeviceData)
+      : NumberOfDevices(NumberOfDevices), EnvPoolSize(1UL << 30),
+        DeviceData(DeviceData) {
+    PoolMtx.resize(NumberOfDevices);
+    FreeBlocks.resize(NumberOfDevices);
+    BlockSizes.resize(NumberOfDevices);
+    CachedBytes.resize(NumberOfDevices, 0);
+
+    if (const char *EnvStr = getenv("LIBOMPTARGET_CUDA_MEMORY_POOL_SIZE")) {
+      EnvPoolSize = std::stoul(EnvStr);
+      DP("Parsed LIBOMPTARGET_CUDA_MEMORY_POOL_SIZE=%zu\n", EnvPoolSize);
+    }
+
+    for (std::unique_ptr<std::mutex> &Ptr : PoolMtx)
+      Ptr = std::make_unique<std::mutex>();
+  }
+
+  ~MemoryPoolTy() {
+    for (int I = 0; I < NumberOfDevices; ++I) {
+      if (FreeBlocks[I].empty())
+        continue;
+      checkResult(cuCtxSetCurrent(DeviceData[I].Context),
+                  "Error returned from cuCtxSetCurrent\n");
+      releaseCachedBlocks(I);
+    }
+  }
+
+  // Allocate Size bytes on a device, preferably by reusing the smallest cached
+  // block that is large enough without wasting too much memory. If the device
+  // is out of memory, the cached blocks are freed and the allocation retried.
+  // This function should be called with the context of the device set.
+  CUdeviceptr allocate(const int DeviceId, const size_t Size) {
+    const std::lock_guard<std::mutex> Lock(*PoolMtx[DeviceId]);
+    std::multimap<size_t, CUdeviceptr> &Free = FreeBlocks[DeviceId];
+    auto Itr = Free.lower_bound(Size);
+    if (Itr != Free.end() && Itr->first <= Size * MaxWasteFactor) {
+      CUdeviceptr DevicePtr = Itr->second;
+      CachedBytes[DeviceId] -= Itr->first;
+      Free.erase(Itr);
+      return DevicePtr;
+    }
+
+    CUdeviceptr DevicePtr = 0;
+    CUresult Err = cuMemAlloc(&DevicePtr, Size);
+    if (Err == CUDA_ERROR_OUT_OF_MEMORY && !Free.empty()) {
+      DP("Out of device memory, releasing %zu cached bytes\n",
+         CachedBytes[DeviceId]);
+      releaseCachedBlocks(DeviceId);
+      Err = cuMemAlloc(&DevicePtr, Size);
+    }
+    if (!checkResult(Err, "Error returned from cuMemAlloc\n"))
+      return 0;
+
+    BlockSizes[DeviceId][DevicePtr] = Size;
+    return DevicePtr;
+  }
+
+  // Release a block allocated by allocate. The block is cached unless the pool
+  // is full, in which case it is freed. This function should be called with
+  // the context of the device set, and only once the device does not access
+  // the block anymore.
+  bool release(const int DeviceId, CUdeviceptr DevicePtr) {
+    const std::lock_guard<std::mutex> Lock(*PoolMtx[DeviceId]);
+    auto Itr = BlockSizes[DeviceId].find(DevicePtr);
+    assert(Itr != BlockSizes[DeviceId].end() && "block not allocated by pool");
+    const size_t Size = Itr->second;
+    if (CachedBytes[DeviceId] + Size <= EnvPoolSize) {
+      FreeBlocks[DeviceId].emplace(Size, DevicePtr);
+      CachedBytes[DeviceId] += Size;
+      return true;
+    }
+
+    BlockSizes[DeviceId].erase(Itr);
+    CUresult Err = cuMemFree(DevicePtr);
+    return checkResult(Err, "Error returned from cuMemFree\n");
+  }
+};
+
 class DeviceRTLTy {
   int NumberOfDevices;
   // OpenMP environment properties
@@ -276,6 +390,7 @@ class DeviceRTLTy {
   static constexpr const int DefaultNumThreads = 128;
 
   std::unique_ptr<StreamManagerTy> StreamManager;
+  std::unique_ptr<MemoryPoolTy> MemoryPool;
   std::vector<DeviceDataTy> DeviceData;
   std::vector<CUmodule> Modules;
 
@@ -368,11 +483,14 @@ public:
 
     StreamManager =
         std::make_unique<StreamManagerTy>(NumberOfDevices, DeviceData);
+    MemoryPool = std::make_unique<MemoryPoolTy>(NumberOfDevices, DeviceData);
   }
 
   ~DeviceRTLTy() {
-    // First destruct stream manager in case of Contexts is destructed before it
+    // First destruct stream manager and memory pool in case of Contexts is
+    // destructed before them
     StreamManager = nullptr;
+    MemoryPool = nullptr;
 
     for (CUmodule &M : Modules)
       // Close module
@@ -727,12 +845,7 @@ public:
     if (!checkResult(Err, "Error returned from cuCtxSetCurrent\n"))
       return nullptr;
 
-    CUdeviceptr DevicePtr;
-    Err = cuMemAlloc(&DevicePtr, Size);
-    if (!checkResult(Err, "Error returned from cuMemAlloc\n"))
-      return nullptr;
-
-    return (void *)DevicePtr;
+    return (void *)MemoryPool->allocate(DeviceId, Size);
   }
 
   int dataSubmit(const int DeviceId, const void *TgtPtr, const void *HstPtr,
@@ -835,8 +948,7 @@ public:
     if (!checkResult(Err, "Error returned from cuCtxSetCurrent\n"))
       return OFFLOAD_FAIL;
 
-    Err = cuMemFree((CUdeviceptr)TgtPtr);
-    if (!checkResult(Err, "Error returned from cuMemFree\n"))
+    if (!MemoryPool->release(DeviceId, (CUdeviceptr)TgtPtr))
       return OFFLOAD_FAIL;
 
     return OFFLOAD_SUCCESS;
@@ -10,11 +10,14 @@
 // It is very expensive to call alloc/free functions of target devices. The
 // MemoryManagerTy in this file is to reduce the number of invocations of those
 // functions by buffering allocated device memory. In this way, when a memory is
-// not used, it will not be freed on the device directly. The buffer is
-// organized in a number of buckets for efficient look up. A memory will go to
-// corresponding bucket based on its size. When a new memory request comes in,
-// it will first check whether there is free memory of same size. If yes,
-// returns it directly. Otherwise, allocate one on device.
+// not used, it will not be freed on the device directly. Requested sizes are
+// rounded up to a size class, so that memory freed by a request can be reused
+// by any later request of a close size. The size classes split each power of
+// two into four steps, which bounds the wasted memory to a quarter of the
+// request. Each size class has a free list of the unused memory of that size.
+// When a new memory request comes in, it will first check whether there is free
+// memory in the list of its size class. If yes, returns it directly. Otherwise,
+// allocate one of the size of the class on device.
 //
 // It also provides a way to opt out the memory manager. Memory
 // allocation/deallocation will only be managed if the requested size is less
@@ -29,17 +32,17 @@
 #include "rtl.h"
 
 namespace {
-constexpr const size_t BucketSize[] = {
-    0,       1U << 2, 1U << 3,  1U << 4,  1U << 5,  1U << 6, 1U << 7,
-    1U << 8, 1U << 9, 1U << 10, 1U << 11, 1U << 12, 1U << 13};
+/// The smallest size class. All of the requests up to this size share a class.
+constexpr const size_t MinSizeClass = 1U << 4;
 
-constexpr const int NumBuckets = sizeof(BucketSize) / sizeof(BucketSize[0]);
+/// The number of size classes between two consecutive powers of two.
+constexpr const size_t NumSubClasses = 4;
 
-/// The threshold to manage memory using memory manager. If the request size is
-/// larger than \p SizeThreshold, the allocation will not be managed by the
-/// memory manager. This variable can be configured via an env \p
+/// The default threshold to manage memory using memory manager. If the request
+/// size is larger than the threshold, the allocation will not be managed by the
+/// memory manager. The threshold can be configured via an env \p
 /// LIBOMPTARGET_MEMORY_MANAGER_THRESHOLD. By default, the value is 8KB.
-size_t SizeThreshold = 1U << 13;
+constexpr const size_t DefaultSizeThreshold = 1U << 13;
 
 /// Find the previous number that is power of 2 given a number that is not power
 /// of 2.
@@ -60,44 +63,46 @@ size_t floorToPowerOfTwo(size_t Num) {
   return Num >> 1;
 }
 
-/// Find a suitable bucket
-int findBucket(size_t Size) {
-  const size_t F = floorToPowerOfTwo(Size);
-
-  DP("findBucket: Size %zu is floored to %zu.\n", Size, F);
-
-  int L = 0, H = NumBuckets - 1;
-  while (H - L > 1) {
-    int M = (L + H) >> 1;
-    if (BucketSize[M] == F)
-      return M;
-    if (BucketSize[M] > F)
-      H = M - 1;
-    else
-      L = M;
-  }
+/// Round \p Size up to its size class. Above \p MinSizeClass, the classes
+/// between a power of two P and 2P are P + P/4, P + P/2, P + 3P/4 and 2P.
+size_t roundUpToSizeClass(size_t Size) {
+  if (Size <= MinSizeClass)
+    return MinSizeClass;
+  const size_t Step = floorToPowerOfTwo(Size - 1) / NumSubClasses;
+  return (Size + Step - 1) / Step * Step;
+}
 
-  assert(L >= 0 && L < NumBuckets && "L is out of range");
+/// Find the bucket of a size class, i.e. the index of the class among all of
+/// the size classes.
+int findBucket(size_t SizeClass) {
+  assert(roundUpToSizeClass(SizeClass) == SizeClass && "not a size class");
+  if (SizeClass == MinSizeClass)
+    return 0;
 
-  DP("findBucket: Size %zu goes to bucket %d\n", Size, L);
+  const size_t P = floorToPowerOfTwo(SizeClass - 1);
+  int Log = 0;
+  for (size_t V = P / MinSizeClass; V > 1; V >>= 1)
+    ++Log;
+  const int B = Log * NumSubClasses + (SizeClass - P) / (P / NumSubClasses);
 
-  return L;
+  DP("findBucket: Size class %zu goes to bucket %d\n", SizeClass, B);
+
+  return B;
 }
 } // namespace
 
 MemoryManagerTy::MemoryManagerTy(DeviceTy &Dev, size_t Threshold)
-    : FreeLists(NumBuckets), FreeListLocks(NumBuckets), Device(Dev) {
-  if (Threshold)
-    SizeThreshold = Threshold;
-}
+    : SizeThreshold(Threshold ? Threshold : DefaultSizeThreshold),
+      FreeLists(findBucket(roundUpToSizeClass(SizeThreshold)) + 1),
+      FreeListLocks(FreeLists.size()), Device(Dev) {}
 
 MemoryManagerTy::~MemoryManagerTy() {
   // TODO: There is a little issue that target plugin is destroyed before this
   // object, therefore the memory free will not succeed.
   // Deallocate all memory in map
-  for (auto Itr = PtrToNodeTable.begin(); Itr != PtrToNodeTable.end(); ++Itr) {
-    assert(Itr->second.Ptr && "nullptr in map table");
-    deleteOnDevice(Itr->second.Ptr);
+  for (auto Itr = PtrToSizeTable.begin(); Itr != PtrToSizeTable.end(); ++Itr) {
+    assert(Itr->first && "nullptr in map table");
+    deleteOnDevice(Itr->first);
   }
 }
 
@@ -113,23 +118,23 @@ void *MemoryManagerTy::freeAndAllocate(size_t Size, void *HstPtr) {
   std::vector<void *> RemoveList;
 
   // Deallocate all memory in FreeList
-  for (int I = 0; I < NumBuckets; ++I) {
+  for (size_t I = 0; I < FreeLists.size(); ++I) {
     FreeListTy &List = FreeLists[I];
     std::lock_guard<std::mutex> Lock(FreeListLocks[I]);
     if (List.empty())
       continue;
-    for (const NodeTy &N : List) {
-      deleteOnDevice(N.Ptr);
-      RemoveList.push_back(N.Ptr);
+    for (void *Ptr : List) {
+      deleteOnDevice(Ptr);
+      RemoveList.push_back(Ptr);
     }
-    FreeLists[I].clear();
+    List.clear();
   }
 
-  // Remove all nodes in the map table which have been released
+  // Remove all pointers in the map table which have been released
   if (!RemoveList.empty()) {
     std::lock_guard<std::mutex> LG(MapTableLock);
     for (void *P : RemoveList)
-      PtrToNodeTable.erase(P);
+      PtrToSizeTable.erase(P);
   }
 
   // Try allocate memory again
@@ -178,84 +183,76 @@ void *MemoryManagerTy::allocate(size_t Size, void *HstPtr) {
     return TgtPtr;
   }
 
-  NodeTy *NodePtr = nullptr;
+  const size_t SizeClass = roundUpToSizeClass(Size);
+  void *TgtPtr = nullptr;
 
-  // Try to get a node from FreeList
+  // Try to get a pointer from the FreeList of the size class
   {
-    const int B = findBucket(Size);
+    const int B = findBucket(SizeClass);
     FreeListTy &List = FreeLists[B];
 
-    NodeTy TempNode(Size, nullptr);
     std::lock_guard<std::mutex> LG(FreeListLocks[B]);
-    FreeListTy::const_iterator Itr = List.find(TempNode);
-
-    if (Itr != List.end()) {
-      NodePtr = &Itr->get();
-      List.erase(Itr);
+    if (!List.empty()) {
+      TgtPtr = List.back();
+      List.pop_back();
     }
   }
 
-#ifdef OMPTARGET_DEBUG
-  if (NodePtr != nullptr)
-    DP("Find one node " DPxMOD " in the bucket.\n", DPxPTR(NodePtr));
-#endif
-
-  // We cannot find a valid node in FreeLists. Let's allocate on device and
-  // create a node for it.
-  if (NodePtr == nullptr) {
-    DP("Cannot find a node in the FreeLists. Allocate on device.\n");
-    // Allocate one on device
-    void *TgtPtr = allocateOrFreeAndAllocateOnDevice(Size, HstPtr);
+  if (TgtPtr != nullptr) {
+    DP("Find target pointer " DPxMOD " in the bucket.\n", DPxPTR(TgtPtr));
+    return TgtPtr;
+  }
 
-    if (TgtPtr == nullptr)
-      return nullptr;
+  // We cannot find a free pointer in FreeLists. Let's allocate on device and
+  // add it to the map table.
+  DP("Cannot find a free pointer in the FreeLists. Allocate %zu bytes on "
+     "device.\n",
+     SizeClass);
+  TgtPtr = allocateOrFreeAndAllocateOnDevice(SizeClass, HstPtr);
 
-    // Create a new node and add it into the map table
-    {
-      std::lock_guard<std::mutex> Guard(MapTableLock);
-      auto Itr = PtrToNodeTable.emplace(TgtPtr, NodeTy(Size, TgtPtr));
-      NodePtr = &Itr.first->second;
-    }
+  if (TgtPtr == nullptr)
+    return nullptr;
 
-    DP("Node address " DPxMOD ", target pointer " DPxMOD ", size %zu\n",
-       DPxPTR(NodePtr), DPxPTR(TgtPtr), Size);
+  {
+    std::lock_guard<std::mutex> Guard(MapTableLock);
+    PtrToSizeTable.emplace(TgtPtr, SizeClass);
   }
 
-  assert(NodePtr && "NodePtr should not be nullptr at this point");
+  DP("Target pointer " DPxMOD ", size class %zu\n", DPxPTR(TgtPtr), SizeClass);
 
-  return NodePtr->Ptr;
+  return TgtPtr;
 }
 
 int MemoryManagerTy::free(void *TgtPtr) {
   DP("MemoryManagerTy::free: target memory " DPxMOD ".\n", DPxPTR(TgtPtr));
 
-  NodeTy *P = nullptr;
+  size_t SizeClass = 0;
 
   // Look it up into the table
   {
     std::lock_guard<std::mutex> G(MapTableLock);
-    auto Itr = PtrToNodeTable.find(TgtPtr);
+    auto Itr = PtrToSizeTable.find(TgtPtr);
 
-    // We don't remove the node from the map table because the map does not
-    // change.
-    if (Itr != PtrToNodeTable.end())
-      P = &Itr->second;
+    // We don't remove the pointer from the map table because the memory stays
+    // allocated on the device.
+    if (Itr != PtrToSizeTable.end())
+      SizeClass = Itr->second;
   }
 
   // The memory is not managed by the manager
-  if (P == nullptr) {
-    DP("Cannot find its node. Delete it on device directly.\n");
+  if (SizeClass == 0) {
+    DP("Cannot find its size class. Delete it on device directly.\n");
     return deleteOnDevice(TgtPtr);
   }
 
-  // Insert the node to the free list
-  const int B = findBucket(P->Size);
+  // Insert the pointer to the free list of its size class
+  const int B = findBucket(SizeClass);
 
-  DP("Found its node " DPxMOD ". Insert it to bucket %d.\n", DPxPTR(P), B);
+  DP("Found its size class %zu. Insert it to bucket %d.\n", SizeClass, B);
 
   {
     std::lock_guard<std::mutex> G(FreeListLocks[B]);
-    FreeLists[B].insert(*P);
+    FreeLists[B].push_back(TgtPtr);
   }
 
   return OFFLOAD_SUCCESS;
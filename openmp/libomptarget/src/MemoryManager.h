@@ -14,10 +14,7 @@
 #define LLVM_OPENMP_LIBOMPTARGET_SRC_MEMORYMANAGER_H
 
 #include <cassert>
-#include <functional>
-#include <list>
 #include <mutex>
-#include <set>
 #include <unordered_map>
 #include <vector>
 
@@ -25,36 +22,21 @@
 struct DeviceTy;
 
 class MemoryManagerTy {
-  /// A structure stores the meta data of a target pointer
-  struct NodeTy {
-    /// Memory size
-    const size_t Size;
-    /// Target pointer
-    void *Ptr;
-
-    /// Constructor
-    NodeTy(size_t Size, void *Ptr) : Size(Size), Ptr(Ptr) {}
-  };
-
-  /// To make \p NodePtrTy ordered when they're put into \p std::multiset.
-  struct NodeCmpTy {
-    bool operator()(const NodeTy &LHS, const NodeTy &RHS) const {
-      return LHS.Size < RHS.Size;
-    }
-  };
-
-  /// A \p FreeList is a set of Nodes. We're using \p std::multiset here to make
-  /// the look up procedure more efficient.
-  using FreeListTy = std::multiset<std::reference_wrapper<NodeTy>, NodeCmpTy>;
-
-  /// A list of \p FreeListTy entries, each of which is a \p std::multiset of
-  /// Nodes whose size is less or equal to a specific bucket size.
+  /// A \p FreeList holds the unused target pointers of a size class. It is
+  /// used as a stack so that the most recently freed memory, which is the most
+  /// likely to still be in the caches of the device, is reused first.
+  using FreeListTy = std::vector<void *>;
+
+  /// The largest size managed by the memory manager
+  const size_t SizeThreshold;
+  /// A list of \p FreeListTy entries, one per size class
   std::vector<FreeListTy> FreeLists;
   /// A list of mutex for each \p FreeListTy entry
   std::vector<std::mutex> FreeListLocks;
-  /// A table to map from a target pointer to its node
-  std::unordered_map<void *, NodeTy> PtrToNodeTable;
-  /// The mutex for the table \p PtrToNodeTable
+  /// A table to map from a target pointer to the size class it was allocated
+  /// with
+  std::unordered_map<void *, size_t> PtrToSizeTable;
+  /// The mutex for the table \p PtrToSizeTable
   std::mutex MapTableLock;
   /// A reference to its corresponding \p DeviceTy object
   DeviceTy &Device;
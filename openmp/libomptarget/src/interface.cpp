@@ -156,8 +156,13 @@ EXTERN void __tgt_target_data_begin_mapper(ident_t *loc, int64_t device_id,
   }
 #endif
 
+  // Enqueue all of the transfers on one queue so that they overlap with each
+  // other, and wait for them only once before returning to the host.
+  __tgt_async_info AsyncInfo;
   int rc = targetDataBegin(Device, arg_num, args_base, args, arg_sizes,
-                           arg_types, arg_names, arg_mappers, nullptr);
+                           arg_types, arg_names, arg_mappers, &AsyncInfo);
+  if (rc == OFFLOAD_SUCCESS && AsyncInfo.Queue)
+    rc = Device.synchronize(&AsyncInfo);
   HandleTargetOutcome(rc == OFFLOAD_SUCCESS, loc);
 }
 
@@ -236,8 +241,11 @@ EXTERN void __tgt_target_data_end_mapper(ident_t *loc, int64_t device_id,
   }
 #endif
 
+  __tgt_async_info AsyncInfo;
   int rc = targetDataEnd(Device, arg_num, args_base, args, arg_sizes, arg_types,
-                         arg_names, arg_mappers, nullptr);
+                         arg_names, arg_mappers, &AsyncInfo);
+  if (rc == OFFLOAD_SUCCESS && AsyncInfo.Queue)
+    rc = Device.synchronize(&AsyncInfo);
   HandleTargetOutcome(rc == OFFLOAD_SUCCESS, loc);
 }
 
@@ -295,8 +303,11 @@ EXTERN void __tgt_target_data_update_mapper(ident_t *loc, int64_t device_id,
   }
 
   DeviceTy &Device = PM->Devices[device_id];
+  __tgt_async_info AsyncInfo;
   int rc = targetDataUpdate(Device, arg_num, args_base, args, arg_sizes,
-                            arg_types, arg_names, arg_mappers);
+                            arg_types, arg_names, arg_mappers, &AsyncInfo);
+  if (rc == OFFLOAD_SUCCESS && AsyncInfo.Queue)
+    rc = Device.synchronize(&AsyncInfo);
   HandleTargetOutcome(rc == OFFLOAD_SUCCESS, loc);
 }
 
@@ -210,7 +210,8 @@ static int32_t getParentIndex(int64_t type) {
 // target_data_* function (target_data_{begin,end,update}).
 int targetDataMapper(DeviceTy &Device, void *arg_base, void *arg,
                      int64_t arg_size, int64_t arg_type, void *arg_mapper,
-                     TargetDataFuncPtrTy target_data_function) {
+                     TargetDataFuncPtrTy target_data_function,
+                     __tgt_async_info *async_info_ptr) {
   DP("Calling the mapper function " DPxMOD "\n", DPxPTR(arg_mapper));
 
   // The mapper function fills up Components.
@@ -241,7 +242,7 @@ int targetDataMapper(DeviceTy &Device, void *arg_base, void *arg,
                                 MapperArgsBase.data(), MapperArgs.data(),
                                 MapperArgSizes.data(), MapperArgTypes.data(),
                                 /*arg_names*/ nullptr, /*arg_mappers*/ nullptr,
-                                /*__tgt_async_info*/ nullptr);
+                                async_info_ptr);
 
   return rc;
 }
@@ -265,7 +266,8 @@ int targetDataBegin(DeviceTy &Device, int32_t arg_num, void **args_base,
       DP("Calling targetDataMapper for the %dth argument\n", i);
 
       int rc = targetDataMapper(Device, args_base[i], args[i], arg_sizes[i],
-                                arg_types[i], arg_mappers[i], targetDataBegin);
+                                arg_types[i], arg_mappers[i], targetDataBegin,
+                                async_info_ptr);
 
       if (rc != OFFLOAD_SUCCESS) {
         REPORT("Call to targetDataBegin via targetDataMapper for custom mapper"
@@ -443,6 +445,27 @@ struct DeallocTgtPtrInfo {
 };
 } // namespace
 
+/// Wait for the pending transfers of \p AsyncInfo if shadow pointers lie in
+/// the host range [\p LB, \p UB). Their original values must be restored only
+/// once the data retrieved from the device has landed in that range, otherwise
+/// the transfer would overwrite them again.
+static int synchronizeBeforeShadowRestore(DeviceTy &Device, uintptr_t LB,
+                                          uintptr_t UB,
+                                          __tgt_async_info *AsyncInfo) {
+  if (!AsyncInfo || !AsyncInfo->Queue)
+    return OFFLOAD_SUCCESS;
+
+  Device.ShadowMtx.lock();
+  ShadowPtrListTy::iterator Itr = Device.ShadowPtrMap.lower_bound((void *)LB);
+  bool HasShadowPtrs =
+      Itr != Device.ShadowPtrMap.end() && (uintptr_t)Itr->first < UB;
+  Device.ShadowMtx.unlock();
+  if (!HasShadowPtrs)
+    return OFFLOAD_SUCCESS;
+
+  return Device.synchronize(AsyncInfo);
+}
+
 /// Internal function to undo the mapping and retrieve the data from the device.
 int targetDataEnd(DeviceTy &Device, int32_t ArgNum, void **ArgBases,
                   void **Args, int64_t *ArgSizes, int64_t *ArgTypes,
@@ -465,7 +488,8 @@ int targetDataEnd(DeviceTy &Device, int32_t ArgNum, void **ArgBases,
       DP("Calling targetDataMapper for the %dth argument\n", I);
 
       Ret = targetDataMapper(Device, ArgBases[I], Args[I], ArgSizes[I],
-                             ArgTypes[I], ArgMappers[I], targetDataEnd);
+                             ArgTypes[I], ArgMappers[I], targetDataEnd,
+                             AsyncInfo);
 
       if (Ret != OFFLOAD_SUCCESS) {
         REPORT("Call to targetDataEnd via targetDataMapper for custom mapper"
@@ -574,6 +598,12 @@ int targetDataEnd(DeviceTy &Device, int32_t ArgNum, void **ArgBases,
       // shadow pointer entries for this struct.
       uintptr_t LB = (uintptr_t)HstPtrBegin;
       uintptr_t UB = (uintptr_t)HstPtrBegin + DataSize;
+      if ((ArgTypes[I] & OMP_TGT_MAPTYPE_FROM) &&
+          synchronizeBeforeShadowRestore(Device, LB, UB, AsyncInfo) !=
+              OFFLOAD_SUCCESS) {
+        REPORT("Failed to synchronize device.\n");
+        return OFFLOAD_FAIL;
+      }
       Device.ShadowMtx.lock();
       for (ShadowPtrListTy::iterator Itr = Device.ShadowPtrMap.begin();
            Itr != Device.ShadowPtrMap.end();) {
@@ -641,7 +671,7 @@ int targetDataEnd(DeviceTy &Device, int32_t ArgNum, void **ArgBases,
 
 static int targetDataContiguous(DeviceTy &Device, void *ArgsBase,
                                 void *HstPtrBegin, int64_t ArgSize,
-                                int64_t ArgType) {
+                                int64_t ArgType, __tgt_async_info *AsyncInfo) {
   bool IsLast, IsHostPtr;
   void *TgtPtrBegin = Device.getTgtPtrBegin(HstPtrBegin, ArgSize, IsLast, false,
                                             IsHostPtr, /*MustContain=*/true);
@@ -666,7 +696,8 @@ static int targetDataContiguous(DeviceTy &Device, void *ArgsBase,
   if (ArgType & OMP_TGT_MAPTYPE_FROM) {
     DP("Moving %" PRId64 " bytes (tgt:" DPxMOD ") -> (hst:" DPxMOD ")\n",
        ArgSize, DPxPTR(TgtPtrBegin), DPxPTR(HstPtrBegin));
-    int Ret = Device.retrieveData(HstPtrBegin, TgtPtrBegin, ArgSize, nullptr);
+    int Ret =
+        Device.retrieveData(HstPtrBegin, TgtPtrBegin, ArgSize, AsyncInfo);
     if (Ret != OFFLOAD_SUCCESS) {
       REPORT("Copying data from device failed.\n");
       return OFFLOAD_FAIL;
@@ -674,6 +705,11 @@ static int targetDataContiguous(DeviceTy &Device, void *ArgsBase,
 
     uintptr_t LB = (uintptr_t)HstPtrBegin;
     uintptr_t UB = (uintptr_t)HstPtrBegin + ArgSize;
+    Ret = synchronizeBeforeShadowRestore(Device, LB, UB, AsyncInfo);
+    if (Ret != OFFLOAD_SUCCESS) {
+      REPORT("Failed to synchronize device.\n");
+      return OFFLOAD_FAIL;
+    }
     Device.ShadowMtx.lock();
     for (ShadowPtrListTy::iterator IT = Device.ShadowPtrMap.begin();
          IT != Device.ShadowPtrMap.end(); ++IT) {
@@ -693,7 +729,7 @@ static int targetDataContiguous(DeviceTy &Device, void *ArgsBase,
   if (ArgType & OMP_TGT_MAPTYPE_TO) {
     DP("Moving %" PRId64 " bytes (hst:" DPxMOD ") -> (tgt:" DPxMOD ")\n",
        ArgSize, DPxPTR(HstPtrBegin), DPxPTR(TgtPtrBegin));
-    int Ret = Device.submitData(TgtPtrBegin, HstPtrBegin, ArgSize, nullptr);
+    int Ret = Device.submitData(TgtPtrBegin, HstPtrBegin, ArgSize, AsyncInfo);
     if (Ret != OFFLOAD_SUCCESS) {
       REPORT("Copying data to device failed.\n");
       return OFFLOAD_FAIL;
@@ -713,7 +749,7 @@ static int targetDataContiguous(DeviceTy &Device, void *ArgsBase,
          "pointer " DPxMOD "\n",
          DPxPTR(IT->second.TgtPtrVal), DPxPTR(IT->second.TgtPtrAddr));
       Ret = Device.submitData(IT->second.TgtPtrAddr, &IT->second.TgtPtrVal,
-                              sizeof(void *), nullptr);
+                              sizeof(void *), AsyncInfo);
       if (Ret != OFFLOAD_SUCCESS) {
         REPORT("Copying data to device failed.\n");
         Device.ShadowMtx.unlock();
@@ -729,7 +765,8 @@ static int targetDataNonContiguous(DeviceTy &Device, void *ArgsBase,
                                    __tgt_target_non_contig *NonContig,
                                    uint64_t Size, int64_t ArgType,
                                    int CurrentDim, int DimSize,
-                                   uint64_t Offset) {
+                                   uint64_t Offset,
+                                   __tgt_async_info *AsyncInfo) {
   int Ret = OFFLOAD_SUCCESS;
   if (CurrentDim < DimSize) {
     for (unsigned int I = 0; I < NonContig[CurrentDim].Count; ++I) {
@@ -740,7 +777,7 @@ static int targetDataNonContiguous(DeviceTy &Device, void *ArgsBase,
       if (CurrentDim != DimSize - 1 || I == 0) {
         Ret = targetDataNonContiguous(Device, ArgsBase, NonContig, Size,
                                       ArgType, CurrentDim + 1, DimSize,
-                                      Offset + CurOffset);
+                                      Offset + CurOffset, AsyncInfo);
         // Stop the whole process if any contiguous piece returns anything
         // other than OFFLOAD_SUCCESS.
         if (Ret != OFFLOAD_SUCCESS)
@@ -751,7 +788,8 @@ static int targetDataNonContiguous(DeviceTy &Device, void *ArgsBase,
     char *Ptr = (char *)ArgsBase + Offset;
     DP("Transfer of non-contiguous : host ptr %lx offset %ld len %ld\n",
        (uint64_t)Ptr, Offset, Size);
-    Ret = targetDataContiguous(Device, ArgsBase, Ptr, Size, ArgType);
+    Ret =
+        targetDataContiguous(Device, ArgsBase, Ptr, Size, ArgType, AsyncInfo);
   }
   return Ret;
 }
@@ -767,8 +805,8 @@ static int getNonContigMergedDimension(__tgt_target_non_contig *NonContig,
 }
 
 /// Internal function to pass data to/from the target.
-// async_info_ptr is currently unused, added here so targetDataUpdate has the
-// same signature as targetDataBegin and targetDataEnd.
+// The transfers are enqueued on AsyncInfoPtr if it is not nullptr, in which
+// case the caller must synchronize it before the host data may be accessed.
 int targetDataUpdate(DeviceTy &Device, int32_t ArgNum, void **ArgsBase,
                      void **Args, int64_t *ArgSizes, int64_t *ArgTypes,
                      map_var_info_t *ArgNames, void **ArgMappers,
@@ -786,7 +824,8 @@ int targetDataUpdate(DeviceTy &Device, int32_t ArgNum, void **ArgsBase,
       DP("Calling targetDataMapper for the %dth argument\n", I);
 
       int Ret = targetDataMapper(Device, ArgsBase[I], Args[I], ArgSizes[I],
-                                 ArgTypes[I], ArgMappers[I], targetDataUpdate);
+                                 ArgTypes[I], ArgMappers[I], targetDataUpdate,
+                                 AsyncInfoPtr);
 
       if (Ret != OFFLOAD_SUCCESS) {
         REPORT("Call to targetDataUpdate via targetDataMapper for custom mapper"
@@ -808,10 +847,10 @@ int targetDataUpdate(DeviceTy &Device, int32_t ArgNum, void **ArgsBase,
       int32_t MergedDim = getNonContigMergedDimension(NonContig, DimSize);
       Ret = targetDataNonContiguous(
           Device, ArgsBase[I], NonContig, Size, ArgTypes[I],
-          /*current_dim=*/0, DimSize - MergedDim, /*offset=*/0);
+          /*current_dim=*/0, DimSize - MergedDim, /*offset=*/0, AsyncInfoPtr);
     } else {
       Ret = targetDataContiguous(Device, ArgsBase[I], Args[I], ArgSizes[I],
-                                 ArgTypes[I]);
+                                 ArgTypes[I], AsyncInfoPtr);
     }
     if (Ret == OFFLOAD_FAIL)
       return OFFLOAD_FAIL;
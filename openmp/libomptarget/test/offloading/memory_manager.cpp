@@ -18,6 +18,17 @@ int main(int argc, char *argv[]) {
     }
   }
 
+  // Sizes that are not powers of two share their size class with others.
+#pragma omp parallel for
+  for (int i = 0; i < 16; ++i) {
+    for (int n = 3; n < (1 << 13); n = n * 5 / 3) {
+      void *p = omp_target_alloc(n, 0);
+      void *q = omp_target_alloc(n + 1, 0);
+      omp_target_free(p, 0);
+      omp_target_free(q, 0);
+    }
+  }
+
 #pragma omp parallel for
   for (int i = 0; i < 16; ++i) {
     for (int n = 1; n < (1 << 13); n <<= 1) {
@@ -2154,6 +2154,7 @@ extern kmp_tasking_mode_t
     __kmp_tasking_mode; /* determines how/when to execute tasks */
 extern int __kmp_task_stealing_constraint;
 extern int __kmp_enable_task_throttling;
+extern int __kmp_task_steal_locality;
 extern kmp_int32 __kmp_default_device; // Set via OMP_DEFAULT_DEVICE if
 // specified, defaults to 0 otherwise
 // Set via OMP_MAX_TASK_PRIORITY if specified, defaults to 0 otherwise
@@ -2412,6 +2413,11 @@ typedef struct kmp_base_thread_data {
   kmp_int32 td_deque_ntasks; // Number of tasks in deque
   // GEH: shouldn't this be volatile since used in while-spin?
   kmp_int32 td_deque_last_stolen; // Thread number of last successful steal
+  kmp_int32 td_pkg; // Package td_thr is bound to, -1 if unknown
+  kmp_int32 td_pkg_nthreads; // Number of threads of the team in td_pkg
+  // Random steals within td_pkg since the last one outside of it, or since the
+  // last successful steal
+  kmp_int32 td_pkg_steals;
 #ifdef BUILD_TIED_TASK_STACK
   kmp_task_stack_t td_susp_tied_tasks; // Stack of suspended tied tasks for task
 // scheduling constraint
@@ -2505,6 +2511,16 @@ typedef struct kmp_cg_root {
   struct kmp_cg_root *up; // pointer to higher level CG root in list
 } kmp_cg_root_t;
 
+// Measurements of a thread in the current parallel region, collected when
+// KMP_REGION_STATS is set. Times are in nanoseconds. The counters of workers
+// are reset when they start the implicit task of a region, the master keeps
+// accumulating and the team records its counters at the fork.
+typedef struct kmp_region_stats {
+  kmp_uint64 busy_time; // time spent in the implicit task
+  kmp_uint64 barrier_time; // time spent in explicit barriers
+  kmp_uint64 ntasks; // number of explicit tasks executed
+} kmp_region_stats_t;
+
 // OpenMP thread data structures
 
 typedef struct KMP_ALIGN_CACHE kmp_base_info {
@@ -2565,6 +2581,7 @@ typedef struct KMP_ALIGN_CACHE kmp_base_info {
   kmp_uint64 th_bar_min_time; /* minimum arrival time at the barrier */
   kmp_uint64 th_frame_time; /* frame timestamp */
 #endif /* USE_ITT_BUILD */
+  kmp_region_stats_t th_region_stats;
   kmp_local_t th_local;
   struct private_common *th_pri_head;
 
@@ -2717,6 +2734,8 @@ typedef struct KMP_ALIGN_CACHE kmp_base_team {
 #if USE_ITT_BUILD
   kmp_uint64 t_region_time; // region begin timestamp
 #endif /* USE_ITT_BUILD */
+  kmp_uint64 t_region_stats_start; // region begin time for KMP_REGION_STATS
+  kmp_region_stats_t t_region_stats_master; // master counters at the fork
 
   // Master write, workers read
   // --------------------------------------------------------------------------
@@ -2849,6 +2868,8 @@ extern int __kmp_duplicate_library_ok;
 extern int __kmp_forkjoin_frames;
 extern int __kmp_forkjoin_frames_mode;
 #endif
+extern int __kmp_region_stats;
+extern char *__kmp_region_stats_file;
 extern PACKED_REDUCTION_METHOD_T __kmp_force_reduction_method;
 extern int __kmp_determ_red;
 
@@ -3434,6 +3455,7 @@ extern void __kmp_affinity_uninitialize(void);
 extern void __kmp_affinity_set_init_mask(
     int gtid, int isa_root); /* set affinity according to KMP_AFFINITY */
 extern void __kmp_affinity_set_place(int gtid);
+extern int __kmp_affinity_get_place_pkg(int place);
 extern void __kmp_affinity_determine_capable(const char *env_var);
 extern int __kmp_aux_set_affinity(void **mask);
 extern int __kmp_aux_get_affinity(void **mask);
@@ -3454,6 +3476,11 @@ extern size_t __kmp_aux_capture_affinity(int gtid, const char *format,
 extern void __kmp_aux_display_affinity(int gtid, const char *format);
 
 extern void __kmp_cleanup_hierarchy();
+
+extern void __kmp_region_stats_fork(kmp_info_t *master_th, kmp_team_t *team);
+extern void __kmp_region_stats_join(kmp_info_t *master_th, kmp_team_t *team,
+                                    kmp_uint64 master_end);
+extern void __kmp_region_stats_fini();
 extern void __kmp_get_hierarchy(kmp_uint32 nproc, kmp_bstate_t *thr_bar);
 
 #if KMP_USE_FUTEX
@@ -3494,6 +3521,7 @@ extern void __kmp_lock_suspend_mx(kmp_info_t *th);
 extern void __kmp_unlock_suspend_mx(kmp_info_t *th);
 
 extern void __kmp_elapsed(double *);
+extern kmp_uint64 __kmp_now_nsec();
 extern void __kmp_elapsed_tick(double *);
 
 extern void __kmp_enable(int old_state);
@@ -4008,6 +4008,9 @@ static int __kmp_affinity_max_proc_per_core(const AddrUnsPair *address2os,
 static AddrUnsPair *address2os = NULL;
 static int *procarr = NULL;
 static int __kmp_aff_depth = 0;
+// The package of the hardware threads of each place, or -1 if the place spans
+// several packages. Used to keep task stealing within a package.
+static int *__kmp_affinity_place_pkgs = NULL;
 
 #if KMP_USE_HIER_SCHED
 #define KMP_EXIT_AFF_NONE                                                      \
@@ -4577,6 +4580,36 @@ static void __kmp_aux_affinity_initialize(void) {
 }
 #undef KMP_EXIT_AFF_NONE
 
+static void __kmp_affinity_find_place_pkgs() {
+  if (__kmp_affinity_place_pkgs != NULL || address2os == NULL ||
+      __kmp_affinity_masks == NULL)
+    return;
+  __kmp_affinity_place_pkgs =
+      (int *)__kmp_allocate(sizeof(int) * __kmp_affinity_num_masks);
+  for (unsigned place = 0; place < __kmp_affinity_num_masks; ++place) {
+    kmp_affin_mask_t *mask = KMP_CPU_INDEX(__kmp_affinity_masks, place);
+    int pkg = -1;
+    for (int i = 0; i < __kmp_avail_proc; ++i) {
+      if (!KMP_CPU_ISSET(address2os[i].second, mask))
+        continue;
+      int label = address2os[i].first.labels[0];
+      if (pkg != -1 && pkg != label) {
+        pkg = -1;
+        break;
+      }
+      pkg = label;
+    }
+    __kmp_affinity_place_pkgs[place] = pkg;
+  }
+}
+
+int __kmp_affinity_get_place_pkg(int place) {
+  if (__kmp_affinity_place_pkgs == NULL || place < 0 ||
+      (unsigned)place >= __kmp_affinity_num_masks)
+    return -1;
+  return __kmp_affinity_place_pkgs[place];
+}
+
 void __kmp_affinity_initialize(void) {
   // Much of the code above was written assuming that if a machine was not
   // affinity capable, then __kmp_affinity_type == affinity_none.  We now
@@ -4594,6 +4627,7 @@ void __kmp_affinity_initialize(void) {
     __kmp_affinity_type = affinity_none;
   }
   __kmp_aux_affinity_initialize();
+  __kmp_affinity_find_place_pkgs();
   if (disabled) {
     __kmp_affinity_type = affinity_disabled;
   }
@@ -4623,6 +4657,10 @@ void __kmp_affinity_uninitialize(void) {
     __kmp_free(procarr);
     procarr = NULL;
   }
+  if (__kmp_affinity_place_pkgs != NULL) {
+    __kmp_free(__kmp_affinity_place_pkgs);
+    __kmp_affinity_place_pkgs = NULL;
+  }
 #if KMP_USE_HWLOC
   if (__kmp_hwloc_topology != NULL) {
     hwloc_topology_destroy(__kmp_hwloc_topology);
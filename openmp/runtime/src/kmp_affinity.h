@@ -785,6 +785,11 @@ public:
     for (kmp_uint32 d = 0; d < depth - 1; ++d) { // optimize hierarchy width
       while (numPerLevel[d] > branch ||
              (d == 0 && numPerLevel[d] > maxLeaves)) { // max 4 on level 0!
+        // Rounding an odd level up would make the subtrees above it straddle
+        // the cores, packages, etc. of the machine, keep such a level wide
+        // instead when it was derived from the topology.
+        if (adr2os && d > 0 && (numPerLevel[d] & 1))
+          break;
         if (numPerLevel[d] & 1)
           numPerLevel[d]++;
         numPerLevel[d] = numPerLevel[d] >> 1;
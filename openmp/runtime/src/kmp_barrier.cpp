@@ -1597,6 +1597,14 @@ static int __kmp_barrier_template(enum barrier_type bt, int gtid, int is_split,
 int __kmp_barrier(enum barrier_type bt, int gtid, int is_split,
                   size_t reduce_size, void *reduce_data,
                   void (*reduce)(void *, void *)) {
+  if (UNLIKELY(__kmp_region_stats)) {
+    kmp_uint64 start = __kmp_now_nsec();
+    int status = __kmp_barrier_template<>(bt, gtid, is_split, reduce_size,
+                                          reduce_data, reduce);
+    __kmp_threads[gtid]->th.th_region_stats.barrier_time +=
+        __kmp_now_nsec() - start;
+    return status;
+  }
   return __kmp_barrier_template<>(bt, gtid, is_split, reduce_size, reduce_data,
                                   reduce);
 }
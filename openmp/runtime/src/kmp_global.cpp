@@ -336,6 +336,7 @@ KMP_BUILD_ASSERT(sizeof(kmp_tasking_flags_t) == 4);
 
 int __kmp_task_stealing_constraint = 1; /* Constrain task stealing by default */
 int __kmp_enable_task_throttling = 1;
+int __kmp_task_steal_locality = 1; /* Steal within the package first */
 
 #ifdef DEBUG_SUSPEND
 int __kmp_suspend_count = 0;
@@ -347,6 +348,8 @@ int __kmp_duplicate_library_ok = 0;
 int __kmp_forkjoin_frames = 1;
 int __kmp_forkjoin_frames_mode = 3;
 #endif
+int __kmp_region_stats = FALSE; /* Time parallel regions */
+char *__kmp_region_stats_file = NULL; /* NULL or "-" means stderr */
 PACKED_REDUCTION_METHOD_T __kmp_force_reduction_method =
     reduction_method_not_defined;
 int __kmp_determ_red = FALSE;
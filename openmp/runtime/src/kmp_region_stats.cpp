@@ -0,0 +1,187 @@
+/*
+ * kmp_region_stats.cpp -- Timing and imbalance statistics of parallel regions.
+ */
+
+//===----------------------------------------------------------------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+
+// When KMP_REGION_STATS is set, the master of every parallel region (except
+// those of teams constructs) accumulates at the join the measurements of the
+// threads of its team into a record per region. The records are written as CSV
+// to KMP_REGION_STATS_FILE at shutdown, one line per region:
+//
+//   region       source location (file:function:line) of the region
+//   calls        number of executions of the region
+//   threads      largest number of threads that executed the region
+//   wall_s       time between the fork and the end of the join
+//   busy_s       time of the average thread until it reached the join barrier
+//   max_busy_s   time of the slowest thread until it reached the join barrier
+//   imbalance    1 - busy_s / max_busy_s, i.e. the fraction of the time of
+//                the slowest thread the others spend waiting for it
+//   join_wait_s  time spent by all of the threads in the join barrier
+//   barrier_s    time spent by all of the threads in explicit barriers
+//   tasks        number of explicit tasks executed
+//
+// Times are in seconds and summed over the executions of the region. Threads
+// execute the remaining tasks of the region in the join barrier, this time is
+// counted as join wait.
+
+#include "kmp.h"
+#include "kmp_io.h"
+#include "kmp_str.h"
+
+#define KMP_REGION_STATS_BUCKETS 256
+
+typedef struct kmp_region_record {
+  struct kmp_region_record *next;
+  microtask_t pkfn; // outlined function of the region
+  const char *psource; // source location of the region
+  kmp_uint64 calls;
+  int max_nproc;
+  kmp_uint64 wall_time;
+  kmp_uint64 avg_busy_time;
+  kmp_uint64 max_busy_time;
+  kmp_uint64 join_wait_time;
+  kmp_uint64 barrier_time;
+  kmp_uint64 ntasks;
+} kmp_region_record_t;
+
+static kmp_region_record_t *__kmp_region_records[KMP_REGION_STATS_BUCKETS];
+static kmp_int32 __kmp_region_nrecords = 0;
+static KMP_BOOTSTRAP_LOCK_INIT(__kmp_region_stats_lock);
+
+// Returns the record of the region of outlined function pkfn at psource,
+// creating it if needed. Must be called with __kmp_region_stats_lock held.
+static kmp_region_record_t *__kmp_region_stats_find(microtask_t pkfn,
+                                                    const char *psource) {
+  size_t bucket =
+      ((kmp_uintptr_t)pkfn ^ (kmp_uintptr_t)psource) / sizeof(void *) %
+      KMP_REGION_STATS_BUCKETS;
+  kmp_region_record_t *record;
+  for (record = __kmp_region_records[bucket]; record; record = record->next)
+    if (record->pkfn == pkfn && record->psource == psource)
+      return record;
+  record = (kmp_region_record_t *)__kmp_allocate(sizeof(kmp_region_record_t));
+  record->pkfn = pkfn;
+  record->psource = psource;
+  record->next = __kmp_region_records[bucket];
+  __kmp_region_records[bucket] = record;
+  ++__kmp_region_nrecords;
+  return record;
+}
+
+void __kmp_region_stats_fork(kmp_info_t *master_th, kmp_team_t *team) {
+  team->t.t_region_stats_master = master_th->th.th_region_stats;
+  team->t.t_region_stats_start = __kmp_now_nsec();
+}
+
+void __kmp_region_stats_join(kmp_info_t *master_th, kmp_team_t *team,
+                             kmp_uint64 master_end) {
+  kmp_uint64 start = team->t.t_region_stats_start;
+  kmp_uint64 wall = __kmp_now_nsec() - start;
+  kmp_uint64 busy = 0, max_busy = 0, join_wait = 0, barrier = 0, ntasks = 0;
+  int nproc = team->t.t_nproc;
+
+  // All of the workers reached the join barrier and finished the tasks of the
+  // region, their counters are stable.
+  for (int i = 0; i < nproc; ++i) {
+    kmp_info_t *thr = team->t.t_threads[i];
+    kmp_region_stats_t stats = thr->th.th_region_stats;
+    if (thr == master_th) {
+      const kmp_region_stats_t &base = team->t.t_region_stats_master;
+      stats.busy_time = master_end - start;
+      stats.barrier_time -= base.barrier_time;
+      stats.ntasks -= base.ntasks;
+    }
+    busy += stats.busy_time;
+    if (stats.busy_time > max_busy)
+      max_busy = stats.busy_time;
+    if (wall > stats.busy_time)
+      join_wait += wall - stats.busy_time;
+    barrier += stats.barrier_time;
+    ntasks += stats.ntasks;
+  }
+
+  ident_t *loc = team->t.t_ident;
+  __kmp_acquire_bootstrap_lock(&__kmp_region_stats_lock);
+  kmp_region_record_t *record =
+      __kmp_region_stats_find(team->t.t_pkfn, loc ? loc->psource : NULL);
+  ++record->calls;
+  if (nproc > record->max_nproc)
+    record->max_nproc = nproc;
+  record->wall_time += wall;
+  record->avg_busy_time += busy / nproc;
+  record->max_busy_time += max_busy;
+  record->join_wait_time += join_wait;
+  record->barrier_time += barrier;
+  record->ntasks += ntasks;
+  __kmp_release_bootstrap_lock(&__kmp_region_stats_lock);
+}
+
+// Sorts the records by decreasing wall time.
+static int __kmp_region_stats_compare(const void *lhs, const void *rhs) {
+  kmp_uint64 lhs_time = (*(kmp_region_record_t *const *)lhs)->wall_time;
+  kmp_uint64 rhs_time = (*(kmp_region_record_t *const *)rhs)->wall_time;
+  return lhs_time > rhs_time ? -1 : lhs_time < rhs_time ? 1 : 0;
+}
+
+static double __kmp_region_stats_sec(kmp_uint64 nsec) {
+  return (double)nsec / KMP_NSEC_PER_SEC;
+}
+
+void __kmp_region_stats_fini() {
+  if (__kmp_region_nrecords == 0)
+    return;
+
+  kmp_region_record_t **records = (kmp_region_record_t **)__kmp_allocate(
+      __kmp_region_nrecords * sizeof(kmp_region_record_t *));
+  int n = 0;
+  for (int i = 0; i < KMP_REGION_STATS_BUCKETS; ++i)
+    for (kmp_region_record_t *r = __kmp_region_records[i]; r; r = r->next)
+      records[n++] = r;
+  qsort(records, n, sizeof(*records), __kmp_region_stats_compare);
+
+  kmp_safe_raii_file_t statsFile;
+  if (__kmp_region_stats_file == NULL ||
+      strcmp(__kmp_region_stats_file, "-") == 0) {
+    statsFile.set_stderr();
+  } else {
+    char buffer[256];
+    __kmp_expand_file_name(buffer, sizeof(buffer), __kmp_region_stats_file);
+    statsFile.open(buffer, "w", "KMP_REGION_STATS_FILE");
+  }
+
+  fprintf(statsFile, "region,calls,threads,wall_s,busy_s,max_busy_s,imbalance,"
+                     "join_wait_s,barrier_s,tasks\n");
+  for (int i = 0; i < n; ++i) {
+    kmp_region_record_t *r = records[i];
+    kmp_str_loc_t loc = __kmp_str_loc_init(r->psource, false);
+    double imbalance =
+        r->max_busy_time
+            ? 1.0 - (double)r->avg_busy_time / (double)r->max_busy_time
+            : 0.0;
+    fprintf(statsFile,
+            "%s:%s:%d,%" KMP_UINT64_SPEC ",%d,%.6f,%.6f,%.6f,%.4f,%.6f,%.6f,"
+            "%" KMP_UINT64_SPEC "\n",
+            loc.file ? loc.file : "unknown", loc.func ? loc.func : "unknown",
+            loc.line, r->calls, r->max_nproc,
+            __kmp_region_stats_sec(r->wall_time),
+            __kmp_region_stats_sec(r->avg_busy_time),
+            __kmp_region_stats_sec(r->max_busy_time), imbalance,
+            __kmp_region_stats_sec(r->join_wait_time),
+            __kmp_region_stats_sec(r->barrier_time), r->ntasks);
+    __kmp_str_loc_free(&loc);
+  }
+
+  for (int i = 0; i < n; ++i)
+    __kmp_free(records[i]);
+  __kmp_free(records);
+  for (int i = 0; i < KMP_REGION_STATS_BUCKETS; ++i)
+    __kmp_region_records[i] = NULL;
+  __kmp_region_nrecords = 0;
+}
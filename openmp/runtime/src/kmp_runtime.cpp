@@ -2210,6 +2210,9 @@ int __kmp_fork_call(ident_t *loc, int gtid,
     }
 #endif /* USE_ITT_BUILD */
 
+    if (__kmp_region_stats)
+      __kmp_region_stats_fork(master_th, team);
+
     // AC: skip __kmp_internal_fork at teams construct, let only master
     // threads execute
     if (ap) {
@@ -2361,6 +2364,7 @@ void __kmp_join_call(ident_t *loc, int gtid
   }
 
   master_active = team->t.t_master_active;
+  kmp_uint64 region_stats_end = __kmp_region_stats ? __kmp_now_nsec() : 0;
 
   if (!exit_teams) {
     // AC: No barrier for internal teams at exit from teams construct.
@@ -2373,6 +2377,9 @@ void __kmp_join_call(ident_t *loc, int gtid
 
   KMP_MB();
 
+  if (__kmp_region_stats && !exit_teams && !master_th->th.th_teams_microtask)
+    __kmp_region_stats_join(master_th, team, region_stats_end);
+
 #if OMPT_SUPPORT
   ompt_data_t *parallel_data = &(team->t.ompt_team_info.parallel_data);
   void *codeptr = team->t.ompt_team_info.master_return_address;
@@ -7205,6 +7212,14 @@ int __kmp_invoke_task_func(int gtid) {
   KMP_SET_THREAD_STATE(IMPLICIT_TASK);
 #endif
 
+  // The master measures its time in the region from the fork to the join.
+  kmp_uint64 region_stats_start = 0;
+  if (__kmp_region_stats && !KMP_MASTER_TID(tid)) {
+    this_thr->th.th_region_stats.barrier_time = 0;
+    this_thr->th.th_region_stats.ntasks = 0;
+    region_stats_start = __kmp_now_nsec();
+  }
+
   rc = __kmp_invoke_microtask((microtask_t)TCR_SYNC_PTR(team->t.t_pkfn), gtid,
                               tid, (int)team->t.t_argc, (void **)team->t.t_argv
 #if OMPT_SUPPORT
@@ -7217,6 +7232,10 @@ int __kmp_invoke_task_func(int gtid) {
    this_thr->th.ompt_thread_info.parallel_flags |= ompt_parallel_team;
 #endif
 
+  if (__kmp_region_stats && !KMP_MASTER_TID(tid))
+    this_thr->th.th_region_stats.busy_time =
+        __kmp_now_nsec() - region_stats_start;
+
 #if KMP_STATS_ENABLED
   if (previous_state == stats_state_e::TEAMS_REGION) {
     KMP_SET_THREAD_STATE(previous_state);
@@ -7669,6 +7688,9 @@ void __kmp_cleanup(void) {
   __kmp_print_speculative_stats();
 #endif
 #endif
+  __kmp_region_stats_fini();
+  KMP_INTERNAL_FREE(__kmp_region_stats_file);
+  __kmp_region_stats_file = NULL;
   KMP_INTERNAL_FREE(__kmp_nested_nth.nth);
   __kmp_nested_nth.nth = NULL;
   __kmp_nested_nth.size = 0;
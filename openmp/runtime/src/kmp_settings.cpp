@@ -4620,6 +4620,34 @@ static void __kmp_stg_print_forkjoin_frames_mode(kmp_str_buf_t *buffer,
 } // __kmp_stg_print_forkjoin_frames
 #endif /* USE_ITT_BUILD */
 
+// -----------------------------------------------------------------------------
+// KMP_REGION_STATS, KMP_REGION_STATS_FILE
+
+static void __kmp_stg_parse_region_stats(char const *name, char const *value,
+                                         void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_region_stats);
+} // __kmp_stg_parse_region_stats
+
+static void __kmp_stg_print_region_stats(kmp_str_buf_t *buffer,
+                                         char const *name, void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_region_stats);
+} // __kmp_stg_print_region_stats
+
+static void __kmp_stg_parse_region_stats_file(char const *name,
+                                              char const *value, void *data) {
+  __kmp_stg_parse_str(name, value, &__kmp_region_stats_file);
+} // __kmp_stg_parse_region_stats_file
+
+static void __kmp_stg_print_region_stats_file(kmp_str_buf_t *buffer,
+                                              char const *name, void *data) {
+  if (__kmp_region_stats_file == NULL ||
+      __kmp_str_match("-", 0, __kmp_region_stats_file)) {
+    __kmp_stg_print_str(buffer, name, "stderr");
+  } else {
+    __kmp_stg_print_str(buffer, name, __kmp_region_stats_file);
+  }
+} // __kmp_stg_print_region_stats_file
+
 // -----------------------------------------------------------------------------
 // KMP_ENABLE_TASK_THROTTLING
 
@@ -4634,6 +4662,19 @@ static void __kmp_stg_print_task_throttling(kmp_str_buf_t *buffer,
   __kmp_stg_print_bool(buffer, name, __kmp_enable_task_throttling);
 } // __kmp_stg_print_task_throttling
 
+// -----------------------------------------------------------------------------
+// KMP_TASK_STEAL_LOCALITY
+
+static void __kmp_stg_parse_task_steal_locality(char const *name,
+                                                char const *value, void *data) {
+  __kmp_stg_parse_bool(name, value, &__kmp_task_steal_locality);
+} // __kmp_stg_parse_task_steal_locality
+
+static void __kmp_stg_print_task_steal_locality(kmp_str_buf_t *buffer,
+                                                char const *name, void *data) {
+  __kmp_stg_print_bool(buffer, name, __kmp_task_steal_locality);
+} // __kmp_stg_print_task_steal_locality
+
 #if KMP_HAVE_MWAIT || KMP_HAVE_UMWAIT
 // -----------------------------------------------------------------------------
 // KMP_USER_LEVEL_MWAIT
@@ -4985,8 +5026,14 @@ static kmp_setting_t __kmp_stg_table[] = {
     {"KMP_FORKJOIN_FRAMES_MODE", __kmp_stg_parse_forkjoin_frames_mode,
      __kmp_stg_print_forkjoin_frames_mode, NULL, 0, 0},
 #endif
+    {"KMP_REGION_STATS", __kmp_stg_parse_region_stats,
+     __kmp_stg_print_region_stats, NULL, 0, 0},
+    {"KMP_REGION_STATS_FILE", __kmp_stg_parse_region_stats_file,
+     __kmp_stg_print_region_stats_file, NULL, 0, 0},
     {"KMP_ENABLE_TASK_THROTTLING", __kmp_stg_parse_task_throttling,
      __kmp_stg_print_task_throttling, NULL, 0, 0},
+    {"KMP_TASK_STEAL_LOCALITY", __kmp_stg_parse_task_steal_locality,
+     __kmp_stg_print_task_steal_locality, NULL, 0, 0},
 
     {"OMP_DISPLAY_ENV", __kmp_stg_parse_omp_display_env,
      __kmp_stg_print_omp_display_env, NULL, 0, 0},
@@ -1451,6 +1451,9 @@ static void __kmp_invoke_task(kmp_int32 gtid, kmp_task_t *task,
     return;
   }
 
+  if (UNLIKELY(__kmp_region_stats))
+    __kmp_threads[gtid]->th.th_region_stats.ntasks++;
+
 #if OMPT_SUPPORT
   // For untied tasks, the first task executed only calls __kmpc_omp_task and
   // does not execute code.
@@ -2795,6 +2798,36 @@ static kmp_task_t *__kmp_steal_task(kmp_info_t *victim_thr, kmp_int32 gtid,
   return task;
 }
 
+// __kmp_get_victim_tid: Pick a random thread of the task team, other than tid,
+// to steal tasks from. When the threads are bound to places, victims bound to
+// the same package as tid are preferred, since stealing from a remote package
+// moves the task and its data across sockets: as many random steals are tried
+// within the package as it has threads before one targets any thread.
+static inline kmp_int32 __kmp_get_victim_tid(kmp_info_t *thread, kmp_int32 tid,
+                                             kmp_int32 nthreads,
+                                             kmp_thread_data_t *threads_data) {
+  kmp_base_thread_data_t *my_td = &threads_data[tid].td;
+  kmp_int32 victim_tid = 0;
+  if (my_td->td_pkg_nthreads > 1 &&
+      my_td->td_pkg_steals++ < my_td->td_pkg_nthreads) {
+    // Draw until a thread of the package is found, at worst fall back to the
+    // last random thread.
+    for (kmp_int32 i = 0; i < nthreads; ++i) {
+      victim_tid = __kmp_get_random(thread) % (nthreads - 1);
+      if (victim_tid >= tid)
+        ++victim_tid; // Adjusts random distribution to exclude self
+      if (threads_data[victim_tid].td.td_pkg == my_td->td_pkg)
+        break;
+    }
+    return victim_tid;
+  }
+  my_td->td_pkg_steals = 0;
+  victim_tid = __kmp_get_random(thread) % (nthreads - 1);
+  if (victim_tid >= tid)
+    ++victim_tid; // Adjusts random distribution to exclude self
+  return victim_tid;
+}
+
 // __kmp_execute_tasks_template: Choose and execute tasks until either the
 // condition is statisfied (return true) or there are none left (return false).
 //
@@ -2862,10 +2895,8 @@ static inline int __kmp_execute_tasks_template(
             // Pick a random thread. Initial plan was to cycle through all the
             // threads, and only return if we tried to steal from every thread,
             // and failed.  Arch says that's not such a great idea.
-            victim_tid = __kmp_get_random(thread) % (nthreads - 1);
-            if (victim_tid >= tid) {
-              ++victim_tid; // Adjusts random distribution to exclude self
-            }
+            victim_tid =
+                __kmp_get_victim_tid(thread, tid, nthreads, threads_data);
             // Found a potential victim
             other_thread = threads_data[victim_tid].td.td_thr;
             // There is a slight chance that __kmp_enable_tasking() did not wake
@@ -2901,6 +2932,7 @@ static inline int __kmp_execute_tasks_template(
                                   is_constrained);
         }
         if (task != NULL) { // set last stolen to victim
+          threads_data[tid].td.td_pkg_steals = 0;
           if (threads_data[tid].td.td_deque_last_stolen != victim_tid) {
             threads_data[tid].td.td_deque_last_stolen = victim_tid;
             // The pre-refactored code did not try more than 1 successful new
@@ -3310,6 +3342,24 @@ static int __kmp_realloc_task_threads_data(kmp_info_t *thread,
         // parallel region will exhibit the same behavior as previous region.
         thread_data->td.td_deque_last_stolen = -1;
       }
+      thread_data->td.td_pkg = -1;
+#if KMP_AFFINITY_SUPPORTED
+      if (__kmp_task_steal_locality)
+        thread_data->td.td_pkg = __kmp_affinity_get_place_pkg(
+            team->t.t_threads[i]->th.th_current_place);
+#endif
+    }
+    // Count the threads bound to the same package as each thread, to know
+    // whether random steals within the package may find a victim.
+    for (i = 0; i < nthreads; i++) {
+      kmp_thread_data_t *thread_data = &(*threads_data_p)[i];
+      thread_data->td.td_pkg_nthreads = 0;
+      thread_data->td.td_pkg_steals = 0;
+      if (thread_data->td.td_pkg < 0)
+        continue;
+      for (int j = 0; j < nthreads; j++)
+        if ((*threads_data_p)[j].td.td_pkg == thread_data->td.td_pkg)
+          thread_data->td.td_pkg_nthreads++;
     }
 
     KMP_MB();
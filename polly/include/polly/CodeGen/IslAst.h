@@ -98,6 +98,10 @@ public:
     /// Flag to mark parallel loops which break reductions.
     bool IsReductionParallel = false;
 
+    /// Flag to mark parallel loops that do too little work to be worth
+    /// starting threads for.
+    bool IsTooCheapToParallelize = false;
+
     /// The minimal dependence distance for non parallel loops.
     isl::pw_aff MinimalDependenceDistance;
 
@@ -25,7 +25,10 @@
 #include "polly/ScopInfo.h"
 #include "polly/Support/GICHelper.h"
 #include "polly/Support/ISLTools.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Pass.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Timer.h"
 #include "isl/aff.h"
 #include "isl/ctx.h"
 #include "isl/flow.h"
@@ -46,6 +49,12 @@ static cl::opt<int> OptComputeOut(
              "computational steps (0 means no bound)"),
     cl::Hidden, cl::init(500000), cl::ZeroOrMore, cl::cat(PollyCategory));
 
+static cl::opt<bool> OptSplitPerArray(
+    "polly-dependences-split-per-array",
+    cl::desc("When the dependence analysis hits its bound, retry it for each "
+             "array on its own, instead of giving up on the SCoP"),
+    cl::Hidden, cl::init(true), cl::ZeroOrMore, cl::cat(PollyCategory));
+
 static cl::opt<bool> LegalityCheckDisabled(
     "disable-polly-legality", cl::desc("Disable polly legality check"),
     cl::Hidden, cl::init(false), cl::ZeroOrMore, cl::cat(PollyCategory));
@@ -82,6 +91,13 @@ static cl::opt<Dependences::AnalysisLevel> OptAnalysisLevel(
     cl::Hidden, cl::init(Dependences::AL_Statement), cl::ZeroOrMore,
     cl::cat(PollyCategory));
 
+STATISTIC(NumComputeOut, "Number of dependence analyses that hit their bound");
+STATISTIC(NumSplitPerArray,
+          "Number of dependence analyses completed array by array");
+STATISTIC(NumArraysMemoryBased,
+          "Number of arrays with memory-based instead of value-based "
+          "dependences");
+
 //===----------------------------------------------------------------------===//
 
 /// Tag the @p Relation domain with @p TagId
@@ -308,69 +324,20 @@ static __isl_give isl_union_flow *buildFlow(__isl_keep isl_union_map *Snk,
   return Flow;
 }
 
-void Dependences::calculateDependences(Scop &S) {
-  isl_union_map *Read, *MustWrite, *MayWrite, *ReductionTagMap;
-  isl_schedule *Schedule;
-  isl_union_set *TaggedStmtDomain;
-
-  LLVM_DEBUG(dbgs() << "Scop: \n" << S << "\n");
-
-  collectInfo(S, Read, MustWrite, MayWrite, ReductionTagMap, TaggedStmtDomain,
-              Level);
-
-  bool HasReductions = !isl_union_map_is_empty(ReductionTagMap);
-
-  LLVM_DEBUG(dbgs() << "Read: " << Read << '\n';
-             dbgs() << "MustWrite: " << MustWrite << '\n';
-             dbgs() << "MayWrite: " << MayWrite << '\n';
-             dbgs() << "ReductionTagMap: " << ReductionTagMap << '\n';
-             dbgs() << "TaggedStmtDomain: " << TaggedStmtDomain << '\n';);
-
-  Schedule = S.getScheduleTree().release();
-
-  if (!HasReductions) {
-    isl_union_map_free(ReductionTagMap);
-    // Tag the schedule tree if we want fine-grain dependence info
-    if (Level > AL_Statement) {
-      auto TaggedMap =
-          isl_union_set_unwrap(isl_union_set_copy(TaggedStmtDomain));
-      auto Tags = isl_union_map_domain_map_union_pw_multi_aff(TaggedMap);
-      Schedule = isl_schedule_pullback_union_pw_multi_aff(Schedule, Tags);
-    }
-  } else {
-    isl_union_map *IdentityMap;
-    isl_union_pw_multi_aff *ReductionTags, *IdentityTags, *Tags;
-
-    // Extract Reduction tags from the combined access domains in the given
-    // SCoP. The result is a map that maps each tagged element in the domain to
-    // the memory location it accesses. ReductionTags = {[Stmt[i] ->
-    // Array[f(i)]] -> Stmt[i] }
-    ReductionTags =
-        isl_union_map_domain_map_union_pw_multi_aff(ReductionTagMap);
-
-    // Compute an identity map from each statement in domain to itself.
-    // IdentityTags = { [Stmt[i] -> Stmt[i] }
-    IdentityMap = isl_union_set_identity(isl_union_set_copy(TaggedStmtDomain));
-    IdentityTags = isl_union_pw_multi_aff_from_union_map(IdentityMap);
-
-    Tags = isl_union_pw_multi_aff_union_add(ReductionTags, IdentityTags);
-
-    // By pulling back Tags from Schedule, we have a schedule tree that can
-    // be used to compute normal dependences, as well as 'tagged' reduction
-    // dependences.
-    Schedule = isl_schedule_pullback_union_pw_multi_aff(Schedule, Tags);
-  }
-
-  LLVM_DEBUG(dbgs() << "Read: " << Read << "\n";
-             dbgs() << "MustWrite: " << MustWrite << "\n";
-             dbgs() << "MayWrite: " << MayWrite << "\n";
-             dbgs() << "Schedule: " << Schedule << "\n");
-
-  isl_union_map *StrictWAW = nullptr;
+/// Compute the RAW, WAW and WAR dependences, and the WAW dependences without
+/// intermediate reads in @p StrictWAW, between the accesses @p Read,
+/// @p MustWrite and @p MayWrite, using at most OptComputeOut operations.
+///
+/// Returns false, and no dependences, if the bound was hit.
+static bool computeFlowDependences(
+    isl_ctx *Ctx, AnalysisType Type, __isl_keep isl_union_map *Read,
+    __isl_keep isl_union_map *MustWrite, __isl_keep isl_union_map *MayWrite,
+    __isl_keep isl_schedule *Schedule, isl_union_map *&RAW,
+    isl_union_map *&WAW, isl_union_map *&WAR, isl_union_map *&StrictWAW) {
   {
-    IslMaxOperationsGuard MaxOpGuard(IslCtx.get(), OptComputeOut);
+    IslMaxOperationsGuard MaxOpGuard(Ctx, OptComputeOut);
 
-    RAW = WAW = WAR = RED = nullptr;
+    RAW = WAW = WAR = StrictWAW = nullptr;
     isl_union_map *Write = isl_union_map_union(isl_union_map_copy(MustWrite),
                                                isl_union_map_copy(MayWrite));
 
@@ -437,7 +404,7 @@ void Dependences::calculateDependences(Scop &S) {
     StrictWAW = isl_union_flow_get_must_dependence(Flow);
     isl_union_flow_free(Flow);
 
-    if (OptAnalysisType == VALUE_BASED_ANALYSIS) {
+    if (Type == VALUE_BASED_ANALYSIS) {
       Flow = buildFlow(Read, MustWrite, MayWrite, nullptr, Schedule);
       RAW = isl_union_flow_get_may_dependence(Flow);
       isl_union_flow_free(Flow);
@@ -466,10 +433,6 @@ void Dependences::calculateDependences(Scop &S) {
     }
 
     isl_union_map_free(Write);
-    isl_union_map_free(MustWrite);
-    isl_union_map_free(MayWrite);
-    isl_union_map_free(Read);
-    isl_schedule_free(Schedule);
 
     RAW = isl_union_map_coalesce(RAW);
     WAW = isl_union_map_coalesce(WAW);
@@ -478,15 +441,165 @@ void Dependences::calculateDependences(Scop &S) {
     // End of max_operations scope.
   }
 
-  if (isl_ctx_last_error(IslCtx.get()) == isl_error_quota) {
+  if (isl_ctx_last_error(Ctx) == isl_error_quota) {
     isl_union_map_free(RAW);
     isl_union_map_free(WAW);
     isl_union_map_free(WAR);
     isl_union_map_free(StrictWAW);
     RAW = WAW = WAR = StrictWAW = nullptr;
-    isl_ctx_reset_error(IslCtx.get());
+    isl_ctx_reset_error(Ctx);
+    return false;
+  }
+  return true;
+}
+
+/// Compute the dependences like computeFlowDependences, but for each array of
+/// @p S on its own, each one with its own bound on the number of operations.
+///
+/// Accesses to different arrays never depend on each other, so the union of
+/// the dependences of all arrays is exact. If the value-based analysis of an
+/// array hits the bound, its memory-based analysis is used instead, which is
+/// cheaper and overapproximates the dependences. Returns false, and no
+/// dependences, if even that hits the bound.
+static bool computeFlowDependencesPerArray(
+    Scop &S, isl_ctx *Ctx, __isl_keep isl_union_map *Read,
+    __isl_keep isl_union_map *MustWrite, __isl_keep isl_union_map *MayWrite,
+    __isl_keep isl_schedule *Schedule, isl_union_map *&RAW,
+    isl_union_map *&WAW, isl_union_map *&WAR, isl_union_map *&StrictWAW) {
+  isl_space *Space = S.getParamSpace().release();
+  RAW = isl_union_map_empty(isl_space_copy(Space));
+  WAW = isl_union_map_empty(isl_space_copy(Space));
+  WAR = isl_union_map_empty(isl_space_copy(Space));
+  StrictWAW = isl_union_map_empty(Space);
+
+  for (ScopArrayInfo *SAI : S.arrays()) {
+    isl_union_set *Array =
+        isl_union_set_from_set(isl_set_universe(SAI->getSpace().release()));
+    isl_union_map *ArrayRead = isl_union_map_intersect_range(
+        isl_union_map_copy(Read), isl_union_set_copy(Array));
+    isl_union_map *ArrayMustWrite = isl_union_map_intersect_range(
+        isl_union_map_copy(MustWrite), isl_union_set_copy(Array));
+    isl_union_map *ArrayMayWrite =
+        isl_union_map_intersect_range(isl_union_map_copy(MayWrite), Array);
+
+    isl_union_map *ArrayRAW, *ArrayWAW, *ArrayWAR, *ArrayStrictWAW;
+    bool Done = computeFlowDependences(
+        Ctx, OptAnalysisType, ArrayRead, ArrayMustWrite, ArrayMayWrite,
+        Schedule, ArrayRAW, ArrayWAW, ArrayWAR, ArrayStrictWAW);
+    if (!Done && OptAnalysisType == VALUE_BASED_ANALYSIS) {
+      Done = computeFlowDependences(
+          Ctx, MEMORY_BASED_ANALYSIS, ArrayRead, ArrayMustWrite, ArrayMayWrite,
+          Schedule, ArrayRAW, ArrayWAW, ArrayWAR, ArrayStrictWAW);
+      if (Done)
+        NumArraysMemoryBased++;
+    }
+
+    isl_union_map_free(ArrayRead);
+    isl_union_map_free(ArrayMustWrite);
+    isl_union_map_free(ArrayMayWrite);
+
+    if (!Done) {
+      isl_union_map_free(RAW);
+      isl_union_map_free(WAW);
+      isl_union_map_free(WAR);
+      isl_union_map_free(StrictWAW);
+      RAW = WAW = WAR = StrictWAW = nullptr;
+      return false;
+    }
+
+    RAW = isl_union_map_union(RAW, ArrayRAW);
+    WAW = isl_union_map_union(WAW, ArrayWAW);
+    WAR = isl_union_map_union(WAR, ArrayWAR);
+    StrictWAW = isl_union_map_union(StrictWAW, ArrayStrictWAW);
+  }
+
+  RAW = isl_union_map_coalesce(RAW);
+  WAW = isl_union_map_coalesce(WAW);
+  WAR = isl_union_map_coalesce(WAR);
+  return true;
+}
+
+void Dependences::calculateDependences(Scop &S) {
+  isl_union_map *Read, *MustWrite, *MayWrite, *ReductionTagMap;
+  isl_schedule *Schedule;
+  isl_union_set *TaggedStmtDomain;
+
+  // With -time-passes, report the time spent on each SCoP.
+  std::string ScopName = S.getFunction().getName().str() + ":" + S.getNameStr();
+  NamedRegionTimer T(ScopName, "Dependences of " + ScopName,
+                     "polly-dependences", "Polly Dependence Analysis",
+                     TimePassesIsEnabled);
+
+  LLVM_DEBUG(dbgs() << "Scop: \n" << S << "\n");
+
+  collectInfo(S, Read, MustWrite, MayWrite, ReductionTagMap, TaggedStmtDomain,
+              Level);
+
+  bool HasReductions = !isl_union_map_is_empty(ReductionTagMap);
+
+  LLVM_DEBUG(dbgs() << "Read: " << Read << '\n';
+             dbgs() << "MustWrite: " << MustWrite << '\n';
+             dbgs() << "MayWrite: " << MayWrite << '\n';
+             dbgs() << "ReductionTagMap: " << ReductionTagMap << '\n';
+             dbgs() << "TaggedStmtDomain: " << TaggedStmtDomain << '\n';);
+
+  Schedule = S.getScheduleTree().release();
+
+  if (!HasReductions) {
+    isl_union_map_free(ReductionTagMap);
+    // Tag the schedule tree if we want fine-grain dependence info
+    if (Level > AL_Statement) {
+      auto TaggedMap =
+          isl_union_set_unwrap(isl_union_set_copy(TaggedStmtDomain));
+      auto Tags = isl_union_map_domain_map_union_pw_multi_aff(TaggedMap);
+      Schedule = isl_schedule_pullback_union_pw_multi_aff(Schedule, Tags);
+    }
+  } else {
+    isl_union_map *IdentityMap;
+    isl_union_pw_multi_aff *ReductionTags, *IdentityTags, *Tags;
+
+    // Extract Reduction tags from the combined access domains in the given
+    // SCoP. The result is a map that maps each tagged element in the domain to
+    // the memory location it accesses. ReductionTags = {[Stmt[i] ->
+    // Array[f(i)]] -> Stmt[i] }
+    ReductionTags =
+        isl_union_map_domain_map_union_pw_multi_aff(ReductionTagMap);
+
+    // Compute an identity map from each statement in domain to itself.
+    // IdentityTags = { [Stmt[i] -> Stmt[i] }
+    IdentityMap = isl_union_set_identity(isl_union_set_copy(TaggedStmtDomain));
+    IdentityTags = isl_union_pw_multi_aff_from_union_map(IdentityMap);
+
+    Tags = isl_union_pw_multi_aff_union_add(ReductionTags, IdentityTags);
+
+    // By pulling back Tags from Schedule, we have a schedule tree that can
+    // be used to compute normal dependences, as well as 'tagged' reduction
+    // dependences.
+    Schedule = isl_schedule_pullback_union_pw_multi_aff(Schedule, Tags);
   }
 
+  LLVM_DEBUG(dbgs() << "Read: " << Read << "\n";
+             dbgs() << "MustWrite: " << MustWrite << "\n";
+             dbgs() << "MayWrite: " << MayWrite << "\n";
+             dbgs() << "Schedule: " << Schedule << "\n");
+
+  isl_union_map *StrictWAW = nullptr;
+  RED = nullptr;
+  if (!computeFlowDependences(IslCtx.get(), OptAnalysisType, Read, MustWrite,
+                              MayWrite, Schedule, RAW, WAW, WAR, StrictWAW)) {
+    NumComputeOut++;
+    if (OptSplitPerArray &&
+        computeFlowDependencesPerArray(S, IslCtx.get(), Read, MustWrite,
+                                       MayWrite, Schedule, RAW, WAW, WAR,
+                                       StrictWAW))
+      NumSplitPerArray++;
+  }
+
+  isl_union_map_free(MustWrite);
+  isl_union_map_free(MayWrite);
+  isl_union_map_free(Read);
+  isl_schedule_free(Schedule);
+
   // Drop out early, as the remaining computations are only needed for
   // reduction dependences or dependences that are finer than statement
   // level dependences.
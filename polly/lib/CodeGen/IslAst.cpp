@@ -35,6 +35,7 @@
 #include "polly/ScopInfo.h"
 #include "polly/ScopPass.h"
 #include "polly/Support/GICHelper.h"
+#include "polly/Support/ISLTools.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/IR/Function.h"
 #include "llvm/Support/Debug.h"
@@ -75,6 +76,12 @@ static cl::opt<bool> PollyParallelForce(
         "Force generation of thread parallel code ignoring any cost model"),
     cl::init(false), cl::ZeroOrMore, cl::cat(PollyCategory));
 
+static cl::opt<int> PollyParallelMinWork(
+    "polly-parallel-min-work",
+    cl::desc("Do not generate thread parallel code for loops that are known "
+             "to execute fewer instructions than this (0 disables the check)"),
+    cl::init(100000), cl::ZeroOrMore, cl::cat(PollyCategory));
+
 static cl::opt<bool> UseContext("polly-ast-use-context",
                                 cl::desc("Use context"), cl::Hidden,
                                 cl::init(true), cl::ZeroOrMore,
@@ -96,6 +103,8 @@ STATISTIC(NumInnermostParallel, "Number of innermost parallel for-loops");
 STATISTIC(NumOutermostParallel, "Number of outermost parallel for-loops");
 STATISTIC(NumReductionParallel, "Number of reduction-parallel for-loops");
 STATISTIC(NumExecutedInParallel, "Number of for-loops executed in parallel");
+STATISTIC(NumTooCheapToParallelize,
+          "Number of parallel for-loops too cheap to execute in parallel");
 STATISTIC(NumIfConditions, "Number of if-conditions");
 
 namespace polly {
@@ -250,12 +259,73 @@ static bool astScheduleDimIsParallel(__isl_keep isl_ast_build *Build,
   return true;
 }
 
+/// Return the number of points in the bounding box of @p Set, or None if one
+/// of its dimensions is not bounded by constants.
+static Optional<double> getBoundingBoxSize(isl::set Set) {
+  double Size = 1;
+  for (unsigned i = 0; i < Set.dim(isl::dim::set); i++) {
+    isl::val Min = getConstant(Set.dim_min(i), false, true);
+    isl::val Max = getConstant(Set.dim_max(i), true, false);
+    if (Min.is_null() || Max.is_null() || !Min.is_int() || !Max.is_int())
+      return None;
+    Size *= Max.get_num_si() - Min.get_num_si() + 1;
+  }
+  return Size;
+}
+
+/// Return the number of instructions of one instance of @p Stmt.
+static unsigned getNumInstructions(ScopStmt *Stmt) {
+  if (Stmt->isBlockStmt())
+    return std::max<size_t>(Stmt->getInstructions().size(), 1);
+  unsigned NumInsts = 0;
+  for (BasicBlock *BB : Stmt->getRegion()->blocks())
+    NumInsts += BB->size();
+  return NumInsts;
+}
+
+/// Check if the for node that is about to be built executes so few
+/// instructions that starting threads for it costs more than it saves.
+///
+/// The work of the loop is the sum, over the statements that it contains, of
+/// the instances that one execution of the loop runs times the instructions
+/// of the statement. The instances are approximated by the bounding box of
+/// the statement domain, divided by the iterations of the enclosing loops.
+/// Loops with bounds that are not constant are assumed to be expensive, as
+/// their trip count is only known at run time.
+static bool isTooCheapToParallelize(__isl_keep isl_ast_build *Build) {
+  if (PollyParallelMinWork <= 0)
+    return false;
+
+  isl::union_map Schedule = isl::manage(isl_ast_build_get_schedule(Build));
+  double Work = 0;
+  bool IsBounded = true;
+  Schedule.foreach_map([&](isl::map Map) -> isl::stat {
+    isl::set Iterations = Map.range();
+    unsigned Depth = Iterations.dim(isl::dim::set);
+    Optional<double> Instances = getBoundingBoxSize(Map.domain());
+    Optional<double> OuterIterations = getBoundingBoxSize(
+        Iterations.project_out(isl::dim::set, Depth - 1, 1));
+    if (!Instances || !OuterIterations) {
+      IsBounded = false;
+      return isl::stat::error();
+    }
+    isl::id Id = Map.get_tuple_id(isl::dim::in);
+    ScopStmt *Stmt = static_cast<ScopStmt *>(Id.get_user());
+    Work += *Instances / std::max(*OuterIterations, 1.0) *
+            (Stmt ? getNumInstructions(Stmt) : 1);
+    return isl::stat::ok();
+  });
+
+  return IsBounded && Work < PollyParallelMinWork;
+}
+
 // This method is executed before the construction of a for node. It creates
 // an isl_id that is used to annotate the subsequently generated ast for nodes.
 //
 // In this function we also run the following analyses:
 //
 // - Detection of openmp parallel loops
+// - Estimation of whether such loops do enough work to run them in parallel
 //
 static __isl_give isl_id *astBuildBeforeFor(__isl_keep isl_ast_build *Build,
                                             void *User) {
@@ -273,6 +343,9 @@ static __isl_give isl_id *astBuildBeforeFor(__isl_keep isl_ast_build *Build,
     BuildInfo->InParallelFor = Payload->IsOutermostParallel =
         Payload->IsParallel;
 
+  if (Payload->IsOutermostParallel && PollyParallel && !PollyParallelForce)
+    Payload->IsTooCheapToParallelize = isTooCheapToParallelize(Build);
+
   return Id;
 }
 
@@ -489,6 +562,9 @@ static void walkAstForStatistics(__isl_keep isl_ast_node *Ast) {
             NumReductionParallel++;
           if (IslAstInfo::isExecutedInParallel(Node))
             NumExecutedInParallel++;
+          if (IslAstInfo::isOutermostParallel(Node) &&
+              IslAstInfo::getNodePayload(Node)->IsTooCheapToParallelize)
+            NumTooCheapToParallelize++;
           break;
 
         case isl_ast_node_if:
@@ -637,6 +713,11 @@ bool IslAstInfo::isExecutedInParallel(__isl_keep isl_ast_node *Node) {
   if (!PollyParallelForce && isInnermost(Node))
     return false;
 
+  // Do not parallelize loops that are known to do little work either.
+  IslAstUserPayload *Payload = getNodePayload(Node);
+  if (Payload && Payload->IsTooCheapToParallelize)
+    return false;
+
   return isOutermostParallel(Node) && !isReductionParallel(Node);
 }
 